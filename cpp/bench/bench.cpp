@@ -0,0 +1,152 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "bench.h"
+#include "poisson_p1.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/defines.h>
+#include <dolfinx/fem/utils.h>
+#include <dolfinx/generation/BoxMesh.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+using namespace dolfinx;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+double median(std::vector<double> x)
+{
+  assert(!x.empty());
+  std::sort(x.begin(), x.end());
+  const std::size_t m = x.size() / 2;
+  return x.size() % 2 == 1 ? x[m] : 0.5 * (x[m - 1] + x[m]);
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+bench::Runner::Runner(MPI_Comm comm, const Options& options)
+    : _comm(comm), _options(options)
+{
+  if (_options.n < 1)
+    throw std::runtime_error("Number of cells must be positive.");
+  if (_options.repeat < 1)
+    throw std::runtime_error("Number of repetitions must be positive.");
+}
+//-----------------------------------------------------------------------------
+int bench::Runner::n() const
+{
+  if (!_options.weak)
+    return _options.n;
+  const int size = dolfinx::MPI::size(_comm);
+  return std::max(1, (int)std::lround(_options.n * std::cbrt((double)size)));
+}
+//-----------------------------------------------------------------------------
+bool bench::Runner::selected(const std::string& name) const
+{
+  return name.find(_options.filter) != std::string::npos;
+}
+//-----------------------------------------------------------------------------
+void bench::Runner::run(const std::string& name, std::int64_t size,
+                        const std::string& unit,
+                        const std::function<void()>& setup,
+                        const std::function<void()>& kernel)
+{
+  if (!selected(name))
+    return;
+
+  Result result{name, size, unit, {}};
+  for (int i = 0; i < _options.warmup + _options.repeat; ++i)
+  {
+    setup();
+    MPI_Barrier(_comm);
+    const double t0 = MPI_Wtime();
+    kernel();
+    const double t_local = MPI_Wtime() - t0;
+    double t = 0.0;
+    MPI_Allreduce(&t_local, &t, 1, MPI_DOUBLE, MPI_MAX, _comm);
+    if (i >= _options.warmup)
+      result.times.push_back(t);
+  }
+
+  if (dolfinx::MPI::rank(_comm) == 0)
+  {
+    const auto [tmin, tmax]
+        = std::minmax_element(result.times.begin(), result.times.end());
+    std::cout << std::left << std::setw(44) << name << std::right
+              << std::setw(12) << size << " " << std::left << std::setw(6)
+              << unit << std::right << std::scientific
+              << std::setprecision(3) << std::setw(12) << *tmin
+              << std::setw(12) << median(result.times) << std::setw(12)
+              << *tmax << std::defaultfloat << std::endl;
+  }
+  _results.push_back(std::move(result));
+}
+//-----------------------------------------------------------------------------
+void bench::Runner::run(const std::string& name, std::int64_t size,
+                        const std::string& unit,
+                        const std::function<void()>& kernel)
+{
+  run(name, size, unit, [] {}, kernel);
+}
+//-----------------------------------------------------------------------------
+void bench::Runner::write_json(const std::string& filename) const
+{
+  if (dolfinx::MPI::rank(_comm) != 0)
+    return;
+
+  std::ofstream file(filename);
+  if (!file)
+    throw std::runtime_error("Unable to open " + filename + " for writing.");
+  file << std::setprecision(9);
+  file << "{\n";
+  file << "  \"version\": \"" << dolfinx::version() << "\",\n";
+  file << "  \"git_commit\": \"" << dolfinx::git_commit_hash() << "\",\n";
+  file << "  \"scalar\": \""
+       << (dolfinx::has_petsc_complex() ? "complex" : "real") << "\",\n";
+  file << "  \"debug\": " << (dolfinx::has_debug() ? "true" : "false")
+       << ",\n";
+  file << "  \"processes\": " << dolfinx::MPI::size(_comm) << ",\n";
+  file << "  \"hardware_threads\": " << std::thread::hardware_concurrency()
+       << ",\n";
+  file << "  \"scaling\": \"" << (_options.weak ? "weak" : "strong")
+       << "\",\n";
+  file << "  \"n\": " << n() << ",\n";
+  file << "  \"repeat\": " << _options.repeat << ",\n";
+  file << "  \"warmup\": " << _options.warmup << ",\n";
+  file << "  \"benchmarks\": [";
+  for (std::size_t i = 0; i < _results.size(); ++i)
+  {
+    const Result& r = _results[i];
+    file << (i == 0 ? "\n" : ",\n");
+    file << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size
+         << ", \"unit\": \"" << r.unit << "\", \"times\": [";
+    for (std::size_t j = 0; j < r.times.size(); ++j)
+      file << (j == 0 ? "" : ", ") << r.times[j];
+    file << "], \"min\": "
+         << *std::min_element(r.times.begin(), r.times.end())
+         << ", \"median\": " << median(r.times) << "}";
+  }
+  file << "\n  ]\n}\n";
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<mesh::Mesh> bench::create_mesh(MPI_Comm comm, int n)
+{
+  auto cmap = fem::create_coordinate_map(create_coordinate_map_poisson_p1);
+  const std::size_t m = n;
+  return std::make_shared<mesh::Mesh>(generation::BoxMesh::create(
+      comm, {Eigen::Vector3d(0.0, 0.0, 0.0), Eigen::Vector3d(1.0, 1.0, 1.0)},
+      {m, m, m}, cmap, mesh::GhostMode::none));
+}
+//-----------------------------------------------------------------------------
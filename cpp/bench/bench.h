@@ -0,0 +1,134 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace dolfinx::mesh
+{
+class Mesh;
+}
+
+namespace bench
+{
+
+/// Options of a benchmark run
+struct Options
+{
+  /// Weak scaling if true, i.e. the problem size grows with the number
+  /// of processes. Otherwise strong scaling (fixed problem size).
+  bool weak = false;
+
+  /// Number of cells in each direction of the unit cube meshes. For
+  /// weak scaling, the number on one process.
+  int n = 16;
+
+  /// Number of timed repetitions of each benchmark
+  int repeat = 5;
+
+  /// Number of untimed repetitions before the timed repetitions
+  int warmup = 1;
+
+  /// If not empty, only run the benchmarks whose names contain it
+  std::string filter;
+
+  /// If not empty, write the results to this file (JSON)
+  std::string json;
+};
+
+/// The timings of a benchmark
+struct Result
+{
+  /// Name of the benchmark
+  std::string name;
+
+  /// The global size of the problem
+  std::int64_t size;
+
+  /// The unit of the size, e.g. "dofs" or "cells"
+  std::string unit;
+
+  /// The wall time in seconds of each timed repetition, the maximum
+  /// over the processes
+  std::vector<double> times;
+};
+
+/// Runs benchmarks and collects their results. The timed part (kernel)
+/// of each repetition of a benchmark is preceded by an untimed setup
+/// and a barrier, and its time is the time of the slowest process.
+
+class Runner
+{
+public:
+  /// Create a runner
+  /// @param[in] comm The communicator of the benchmarks
+  /// @param[in] options The options of the run
+  Runner(MPI_Comm comm, const Options& options);
+
+  /// The communicator of the benchmarks
+  MPI_Comm comm() const { return _comm; }
+
+  /// The options of the run
+  const Options& options() const { return _options; }
+
+  /// The number of cells in each direction of the unit cube meshes,
+  /// scaled with the cube root of the number of processes for weak
+  /// scaling
+  int n() const;
+
+  /// Return true if a benchmark is selected by the filter
+  bool selected(const std::string& name) const;
+
+  /// Run a benchmark, if selected
+  /// @param[in] name The name of the benchmark
+  /// @param[in] size The global size of the problem
+  /// @param[in] unit The unit of the size
+  /// @param[in] setup Called before each repetition, untimed
+  /// @param[in] kernel The timed part of a repetition
+  void run(const std::string& name, std::int64_t size,
+           const std::string& unit, const std::function<void()>& setup,
+           const std::function<void()>& kernel);
+
+  /// Run a benchmark without setup, if selected
+  void run(const std::string& name, std::int64_t size,
+           const std::string& unit, const std::function<void()>& kernel);
+
+  /// The results of the benchmarks that have been run
+  const std::vector<Result>& results() const { return _results; }
+
+  /// Write the results in JSON (on rank 0), with the options of the run
+  /// and the configuration of the library
+  void write_json(const std::string& filename) const;
+
+private:
+  MPI_Comm _comm;
+  Options _options;
+  std::vector<Result> _results;
+};
+
+/// Create a mesh of the unit cube with n x n x n x 6 tetrahedra
+std::shared_ptr<dolfinx::mesh::Mesh> create_mesh(MPI_Comm comm, int n);
+
+/// Benchmarks of the mesh data structures: IndexMap scatter, entity
+/// creation, BoundingBoxTree build and queries and refinement
+void mesh_benchmarks(Runner& runner);
+
+/// Benchmarks of the finite element data structures and assembly:
+/// DofMap build, sparsity pattern build, and matrix and vector assembly
+/// of the Poisson equation and of linear elasticity with P1, P2 and P3
+/// elements
+void fem_benchmarks(Runner& runner);
+
+/// Benchmarks of XDMF output and input
+void io_benchmarks(Runner& runner);
+
+} // namespace bench
@@ -0,0 +1,148 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "bench.h"
+#include "elasticity_p1.h"
+#include "elasticity_p2.h"
+#include "elasticity_p3.h"
+#include "poisson_p1.h"
+#include "poisson_p2.h"
+#include "poisson_p3.h"
+#include <cstdlib>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/fem/DirichletBC.h>
+#include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/Form.h>
+#include <dolfinx/fem/assembler.h>
+#include <dolfinx/fem/petsc.h>
+#include <dolfinx/fem/utils.h>
+#include <dolfinx/function/Function.h>
+#include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/la/PETScMatrix.h>
+#include <dolfinx/la/PETScVector.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <string>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+// A bilinear and a linear form and their function space, generated by
+// FFCX
+struct Problem
+{
+  std::string name;
+  ufc_function_space* (*space)(const char*);
+  ufc_form* (*a)();
+  ufc_form* (*L)();
+};
+
+const std::vector<Problem> problems
+    = {{"Poisson P1", create_functionspace_form_poisson_p1_a,
+        create_form_poisson_p1_a, create_form_poisson_p1_L},
+       {"Poisson P2", create_functionspace_form_poisson_p2_a,
+        create_form_poisson_p2_a, create_form_poisson_p2_L},
+       {"Poisson P3", create_functionspace_form_poisson_p3_a,
+        create_form_poisson_p3_a, create_form_poisson_p3_L},
+       {"Elasticity P1", create_functionspace_form_elasticity_p1_a,
+        create_form_elasticity_p1_a, create_form_elasticity_p1_L},
+       {"Elasticity P2", create_functionspace_form_elasticity_p2_a,
+        create_form_elasticity_p2_a, create_form_elasticity_p2_L},
+       {"Elasticity P3", create_functionspace_form_elasticity_p3_a,
+        create_form_elasticity_p3_a, create_form_elasticity_p3_L}};
+} // namespace
+
+//-----------------------------------------------------------------------------
+void bench::fem_benchmarks(Runner& runner)
+{
+  MPI_Comm comm = runner.comm();
+  std::shared_ptr<mesh::Mesh> mesh = create_mesh(comm, runner.n());
+
+  // Create the entities of all dimensions up front, such that the
+  // DofMap benchmarks of the higher degrees do not time their creation
+  const int tdim = mesh->topology().dim();
+  for (int d = 1; d < tdim; ++d)
+    mesh->topology_mutable().create_entities(d);
+
+  for (const Problem& p : problems)
+  {
+    bool selected = false;
+    for (const std::string b : {"DofMap build ", "SparsityPattern build ",
+                                "Assemble matrix ", "Assemble vector "})
+    {
+      selected = selected or runner.selected(b + p.name);
+    }
+    if (!selected)
+      continue;
+
+    auto V = fem::create_functionspace(p.space, "u", mesh);
+    std::shared_ptr<const common::IndexMap> map = V->dofmap()->index_map;
+    const std::int64_t num_dofs = map->size_global() * map->block_size();
+
+    // Build of the dofmap from the UFC dofmap, bypassing the cache of
+    // shared dofmaps
+    ufc_function_space* space = p.space("u");
+    ufc_dofmap* ufc_map = space->create_dofmap();
+    runner.run("DofMap build " + p.name, num_dofs, "dofs",
+               [comm, &mesh, ufc_map]() {
+                 fem::DofMap dofmap = fem::create_dofmap(
+                     comm, *ufc_map, mesh->topology_mutable());
+               });
+    std::free(ufc_map);
+    std::free(space);
+
+    auto a = fem::create_form<PetscScalar>(p.a, {V, V});
+    auto L = fem::create_form<PetscScalar>(p.L, {V});
+    auto f = std::make_shared<function::Function<PetscScalar>>(V);
+    VecSet(f->vector(), 1.0);
+    VecGhostUpdateBegin(f->vector(), INSERT_VALUES, SCATTER_FORWARD);
+    VecGhostUpdateEnd(f->vector(), INSERT_VALUES, SCATTER_FORWARD);
+    L->set_coefficients({{"f", f}});
+
+    // Build and assembly of the sparsity pattern
+    runner.run("SparsityPattern build " + p.name, num_dofs, "dofs", [&a]() {
+      la::SparsityPattern pattern = fem::create_sparsity_pattern(*a);
+      pattern.assemble();
+    });
+
+    // Matrix assembly, including the finalisation of the PETSc matrix
+    const std::vector<std::shared_ptr<const fem::DirichletBC<PetscScalar>>>
+        bcs;
+    if (runner.selected("Assemble matrix " + p.name))
+    {
+      la::PETScMatrix A = fem::create_matrix(*a);
+      runner.run(
+          "Assemble matrix " + p.name, num_dofs, "dofs",
+          [&A]() { MatZeroEntries(A.mat()); },
+          [&A, &a, &bcs]() {
+            fem::assemble_matrix(fem::add_fn_petsc(A.mat(), *a), *a, bcs);
+            MatAssemblyBegin(A.mat(), MAT_FINAL_ASSEMBLY);
+            MatAssemblyEnd(A.mat(), MAT_FINAL_ASSEMBLY);
+          });
+    }
+
+    // Vector assembly, including the accumulation of the ghost
+    // contributions
+    la::PETScVector b(*map);
+    runner.run(
+        "Assemble vector " + p.name, num_dofs, "dofs",
+        [&b]() {
+          Vec b_local;
+          VecGhostGetLocalForm(b.vec(), &b_local);
+          VecSet(b_local, 0.0);
+          VecGhostRestoreLocalForm(b.vec(), &b_local);
+        },
+        [&b, &L]() {
+          fem::assemble_vector_petsc(b.vec(), *L);
+          VecGhostUpdateBegin(b.vec(), ADD_VALUES, SCATTER_REVERSE);
+          VecGhostUpdateEnd(b.vec(), ADD_VALUES, SCATTER_REVERSE);
+        });
+  }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,68 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "bench.h"
+#include "poisson_p1.h"
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/fem/CoordinateElement.h>
+#include <dolfinx/fem/utils.h>
+#include <dolfinx/function/Function.h>
+#include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/io/XDMFFile.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+
+using namespace dolfinx;
+
+//-----------------------------------------------------------------------------
+void bench::io_benchmarks(Runner& runner)
+{
+  MPI_Comm comm = runner.comm();
+  std::shared_ptr<mesh::Mesh> mesh = create_mesh(comm, runner.n());
+  const int tdim = mesh->topology().dim();
+  const std::int64_t num_cells
+      = mesh->topology().index_map(tdim)->size_global();
+
+  // Write a mesh, and read it back (including its partitioning and
+  // distribution)
+  const std::string mesh_file = "bench_mesh.xdmf";
+  runner.run("XDMF write mesh", num_cells, "cells",
+             [comm, &mesh, &mesh_file]() {
+               io::XDMFFile file(comm, mesh_file, "w");
+               file.write_mesh(*mesh);
+             });
+  if (runner.selected("XDMF read mesh"))
+  {
+    {
+      io::XDMFFile file(comm, mesh_file, "w");
+      file.write_mesh(*mesh);
+    }
+    const fem::CoordinateElement cmap
+        = fem::create_coordinate_map(create_coordinate_map_poisson_p1);
+    runner.run("XDMF read mesh", num_cells, "cells",
+               [comm, &cmap, &mesh_file]() {
+                 io::XDMFFile file(comm, mesh_file, "r");
+                 mesh::Mesh m
+                     = file.read_mesh(cmap, mesh::GhostMode::none, "mesh");
+               });
+  }
+
+  // Write a mesh with a P1 function
+  if (runner.selected("XDMF write function"))
+  {
+    auto V = fem::create_functionspace(create_functionspace_form_poisson_p1_a,
+                                       "u", mesh);
+    function::Function<PetscScalar> u(V);
+    const std::int64_t num_dofs = V->dofmap()->index_map->size_global();
+    runner.run("XDMF write function P1", num_dofs, "dofs",
+               [comm, &mesh, &u]() {
+                 io::XDMFFile file(comm, "bench_function.xdmf", "w");
+                 file.write_mesh(*mesh);
+                 file.write_function(u, 0.0);
+               });
+  }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,101 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Benchmarks of the hot paths of DOLFINX. Run with --help for the
+// options, e.g.
+//
+//     mpirun -np 4 ./dolfinx-bench --scaling weak --n 16 --json out.json
+
+#include "bench.h"
+#include <cstdlib>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/SubSystemsManager.h>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+const char* usage
+    = "Usage: dolfinx-bench [options]\n"
+      "  --scaling strong|weak  Fixed global problem size (strong, default)\n"
+      "                         or fixed size per process (weak)\n"
+      "  --n N                  Cells in each direction of the unit cube,\n"
+      "                         on one process for weak scaling (16)\n"
+      "  --repeat R             Timed repetitions of each benchmark (5)\n"
+      "  --warmup W             Untimed repetitions before timing (1)\n"
+      "  --filter S             Run only the benchmarks whose names\n"
+      "                         contain S\n"
+      "  --json FILE            Write the results to FILE (JSON)\n";
+//-----------------------------------------------------------------------------
+bench::Options parse(int argc, char* argv[])
+{
+  bench::Options options;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--help")
+    {
+      std::cout << usage;
+      std::exit(0);
+    }
+    if (i + 1 == argc)
+      throw std::runtime_error("Missing value of option " + arg + ".");
+
+    const std::string value = argv[++i];
+    if (arg == "--scaling")
+    {
+      if (value != "strong" and value != "weak")
+        throw std::runtime_error("Unknown scaling " + value + ".");
+      options.weak = value == "weak";
+    }
+    else if (arg == "--n")
+      options.n = std::stoi(value);
+    else if (arg == "--repeat")
+      options.repeat = std::stoi(value);
+    else if (arg == "--warmup")
+      options.warmup = std::stoi(value);
+    else if (arg == "--filter")
+      options.filter = value;
+    else if (arg == "--json")
+      options.json = value;
+    else
+      throw std::runtime_error("Unknown option " + arg + ".");
+  }
+  return options;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  dolfinx::common::SubSystemsManager::init_mpi(argc, argv);
+  dolfinx::common::SubSystemsManager::init_petsc();
+
+  {
+    bench::Runner runner(MPI_COMM_WORLD, parse(argc, argv));
+    if (dolfinx::MPI::rank(MPI_COMM_WORLD) == 0)
+    {
+      std::cout << "Processes: " << dolfinx::MPI::size(MPI_COMM_WORLD)
+                << ", scaling: "
+                << (runner.options().weak ? "weak" : "strong")
+                << ", cells in each direction: " << runner.n() << std::endl;
+      std::cout << "benchmark, size, min, median and max time (s)"
+                << std::endl;
+    }
+
+    bench::mesh_benchmarks(runner);
+    bench::fem_benchmarks(runner);
+    bench::io_benchmarks(runner);
+
+    if (!runner.options().json.empty())
+      runner.write_json(runner.options().json);
+  }
+
+  dolfinx::common::SubSystemsManager::finalize_petsc();
+  return 0;
+}
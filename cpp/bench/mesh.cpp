@@ -0,0 +1,94 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "bench.h"
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/geometry/BoundingBoxTree.h>
+#include <dolfinx/geometry/utils.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <dolfinx/refinement/refine.h>
+#include <random>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+// Number of scatters in the timed part of the scatter benchmark, which
+// is too fast to time a single scatter reliably
+constexpr int num_scatters = 100;
+} // namespace
+
+//-----------------------------------------------------------------------------
+void bench::mesh_benchmarks(Runner& runner)
+{
+  MPI_Comm comm = runner.comm();
+  const int n = runner.n();
+  std::shared_ptr<mesh::Mesh> mesh = create_mesh(comm, n);
+  const int tdim = mesh->topology().dim();
+  const std::int64_t num_cells
+      = mesh->topology().index_map(tdim)->size_global();
+
+  // Forward scatter of a value per vertex to the ghost vertices
+  {
+    std::shared_ptr<const common::IndexMap> map
+        = mesh->topology().index_map(0);
+    std::vector<double> owned(map->size_local(), 1.0);
+    std::vector<double> ghosts(map->num_ghosts());
+    runner.run("IndexMap scatter_fwd (100 scatters)", map->size_global(),
+               "verts", [&map, &owned, &ghosts]() {
+                 for (int i = 0; i < num_scatters; ++i)
+                   map->scatter_fwd(owned, ghosts, 1);
+               });
+  }
+
+  // Creation of the edges and facets of a new mesh
+  for (int dim : {1, tdim - 1})
+  {
+    std::shared_ptr<mesh::Mesh> m;
+    const std::string name = dim == 1 ? "edges" : "facets";
+    runner.run(
+        "Topology create_entities (" + name + ")", num_cells, "cells",
+        [&m, comm, n]() { m = create_mesh(comm, n); },
+        [&m, dim]() { m->topology_mutable().create_entities(dim); });
+  }
+
+  // Build of a bounding box tree of the cells, and collisions of the
+  // points of a fixed random sample (with n^3 points in total) with it
+  runner.run("BoundingBoxTree build", num_cells, "cells", [&mesh, tdim]() {
+    geometry::BoundingBoxTree tree(*mesh, tdim);
+  });
+  if (runner.selected("BoundingBoxTree collisions"))
+  {
+    const int size = dolfinx::MPI::size(comm);
+    const int rank = dolfinx::MPI::rank(comm);
+    const std::int64_t num_points = (std::int64_t)n * n * n;
+    const std::array range
+        = dolfinx::MPI::local_range(rank, num_points, size);
+    std::mt19937 gen(rank);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> points(
+        range[1] - range[0], 3);
+    for (Eigen::Index i = 0; i < points.size(); ++i)
+      points.data()[i] = dist(gen);
+
+    geometry::BoundingBoxTree tree(*mesh, tdim);
+    runner.run("BoundingBoxTree collisions", num_points, "points",
+               [&tree, &points]() {
+                 graph::AdjacencyList<std::int32_t> collisions
+                     = geometry::compute_collisions(tree, points, 1);
+               });
+  }
+
+  // Uniform refinement, without redistribution of the refined mesh
+  mesh->topology_mutable().create_entities(1);
+  runner.run("Refine uniform", num_cells, "cells", [&mesh]() {
+    mesh::Mesh refined = refinement::refine(*mesh, false);
+  });
+}
+//-----------------------------------------------------------------------------
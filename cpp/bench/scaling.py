@@ -0,0 +1,63 @@
+# Copyright (C) 2020 Garth N. Wells
+#
+# This file is part of DOLFINX (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+"""Run the benchmarks on increasing numbers of processes and collect the
+results, with the parallel efficiency of each benchmark, in one JSON
+file. For strong scaling the efficiency on p processes is
+t(p0) p0 / (t(p) p), and for weak scaling t(p0) / t(p), where p0 is the
+smallest number of processes and t is the median time."""
+
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import tempfile
+
+parser = argparse.ArgumentParser(description="Strong and weak scaling driver of the DOLFINX benchmarks")
+parser.add_argument("--np", type=int, nargs="+", default=[1, 2, 4], help="Numbers of processes")
+parser.add_argument("--scaling", choices=["strong", "weak"], default="strong", help="Scaling mode")
+parser.add_argument("--n", type=int, default=16, help="Cells in each direction (on one process for weak scaling)")
+parser.add_argument("--repeat", type=int, default=5, help="Timed repetitions of each benchmark")
+parser.add_argument("--filter", type=str, default="", help="Run only the benchmarks whose names contain this")
+parser.add_argument("--mpirun", type=str, default="mpirun -np {np}", help="MPI launcher, with {np} for the processes")
+parser.add_argument("--bench", type=str, default="./dolfinx-bench", help="Benchmark executable")
+parser.add_argument("--output", type=str, default="scaling.json", help="Output file (JSON)")
+args = parser.parse_args()
+
+runs = []
+with tempfile.TemporaryDirectory() as tmpdir:
+    for num_procs in sorted(args.np):
+        filename = os.path.join(tmpdir, "bench_{}.json".format(num_procs))
+        cmd = shlex.split(args.mpirun.format(np=num_procs)) + [
+            args.bench, "--scaling", args.scaling, "--n", str(args.n), "--repeat", str(args.repeat),
+            "--filter", args.filter, "--json", filename]
+        print(" ".join(cmd), flush=True)
+        subprocess.run(cmd, check=True)
+        with open(filename) as f:
+            runs.append(json.load(f))
+
+# The median times of each benchmark by number of processes
+base = runs[0]
+p0 = base["processes"]
+t0 = {b["name"]: b["median"] for b in base["benchmarks"]}
+for run in runs:
+    p = run["processes"]
+    for b in run["benchmarks"]:
+        if b["name"] in t0 and b["median"] > 0.0:
+            scale = p0 / p if args.scaling == "strong" else 1.0
+            b["efficiency"] = t0[b["name"]] / b["median"] * scale
+
+with open(args.output, "w") as f:
+    json.dump({"scaling": args.scaling, "n": args.n, "runs": runs}, f, indent=2)
+
+names = [b["name"] for b in base["benchmarks"]]
+print("{:<44}".format("efficiency") + "".join("{:>8d}".format(run["processes"]) for run in runs))
+for name in names:
+    row = "{:<44}".format(name)
+    for run in runs:
+        e = next((b.get("efficiency") for b in run["benchmarks"] if b["name"] == name), None)
+        row += "{:>8.2f}".format(e) if e is not None else "{:>8}".format("-")
+    print(row)
@@ -24,10 +24,10 @@ import shutil
 import sys
 
 # Subdirectories
-sub_directories = ["demo", "test"]
+sub_directories = ["demo", "test", "bench"]
 
 # Copy all files with the following suffixes
-suffix_patterns = ["txt", "h", "hpp", "c", "cpp", "ufl", "xdmf", "h5"]
+suffix_patterns = ["txt", "h", "hpp", "c", "cpp", "ufl", "xdmf", "h5", "py"]
 
 suffix_pattern = re.compile("(%s)," % ("|".join("[\w-]+\.%s" % pattern
                                                 for pattern in suffix_patterns)))
@@ -25,7 +25,7 @@ from ffcx.main import main as ffcx_main
 complex_mode = (sys.argv[-1] == "1")
 
 # Directories to scan
-subdirs = ["demo", "test"]
+subdirs = ["demo", "test", "bench"]
 
 # Compile all form files
 topdir = os.getcwd()
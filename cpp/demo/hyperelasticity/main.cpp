@@ -1,9 +1,42 @@
+// Hyperelasticity (C++)
+// =====================
+//
+// This demo solves a hyperelastic problem on the unit cube, clamped at
+// the left end and rotated at the right end, with Newton's method. The
+// rotation (60 degrees) can be applied in load steps, and the demo
+// reports for each load step the number of Newton and Krylov
+// iterations, the wall times of the residual (F) and Jacobian (J)
+// assembly, the preconditioner setup and the linear solves, and the
+// memory high-water mark, such that it can be used as a benchmark of a
+// nonlinear solve. The options are (see ``--help``)::
+//
+//     mpirun -np 8 ./demo_hyperelasticity --n 32 --steps 4 \
+//         --solver krylov --json hyperelasticity.json
+//
+// The times and the memory high-water mark are the maximum over the
+// processes. The linear solver is
+// configured with the PETSc options with the prefix ``nls_solve_``.
+//
+// .. code-block:: cpp
+
 #include "hyperelasticity.h"
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdlib>
 #include <dolfinx.h>
+#include <dolfinx/common/MemoryUsage.h>
+#include <dolfinx/common/defines.h>
 #include <dolfinx/fem/assembler.h>
 #include <dolfinx/fem/petsc.h>
 #include <dolfinx/la/Vector.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 using namespace dolfinx;
 
@@ -97,12 +130,180 @@ private:
   la::PETScMatrix _matA;
 };
 
+namespace
+{
+// Options of a run
+struct Options
+{
+  // Number of cells in each direction of the unit cube
+  std::size_t n = 10;
+
+  // Number of load steps of the rotation
+  int steps = 1;
+
+  // Linear solver of the Newton iterations, "lu" or "krylov"
+  std::string solver = "lu";
+
+  // If not empty, write the solution to this file (VTK)
+  std::string vtk = "u.pvd";
+
+  // If not empty, write the report to this file (JSON)
+  std::string json;
+};
+
+const char* usage
+    = "Usage: demo_hyperelasticity [options] [PETSc options]\n"
+      "  --n N                Cells in each direction of the cube (10)\n"
+      "  --steps S            Load steps of the rotation (1)\n"
+      "  --solver lu|krylov   Direct solver (default) or conjugate\n"
+      "                       gradients with algebraic multigrid\n"
+      "  --vtk FILE           Write the solution to FILE (u.pvd), or\n"
+      "                       nothing if FILE is empty\n"
+      "  --json FILE          Write the report to FILE\n";
+
+// The statistics of a load step
+struct Step
+{
+  int newton_iterations = 0;
+  int krylov_iterations = 0;
+
+  // Wall times of the residual assembly, the Jacobian assembly, the
+  // preconditioner setup, the linear solves, the solution updates and
+  // the load step
+  std::array<double, 6> times = {};
+
+  // Memory high-water mark at the end of the load step (bytes)
+  std::int64_t memory_peak = 0;
+};
+
+const std::array<std::string, 6> step_phases
+    = {"residual", "jacobian", "preconditioner", "linear_solve", "update",
+       "total"};
+
+//-----------------------------------------------------------------------------
+// Parse the options of the run. Arguments that do not start with "--"
+// are left to PETSc.
+Options parse(int argc, char* argv[])
+{
+  Options options;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--help")
+    {
+      std::cout << usage;
+      std::exit(0);
+    }
+    if (arg.rfind("--", 0) != 0)
+      continue;
+    if (i + 1 == argc)
+      throw std::runtime_error("Missing value of option " + arg + ".");
+
+    const std::string value = argv[++i];
+    if (arg == "--n")
+      options.n = std::stoul(value);
+    else if (arg == "--steps")
+      options.steps = std::stoi(value);
+    else if (arg == "--solver")
+    {
+      if (value != "lu" and value != "krylov")
+        throw std::runtime_error("Unknown solver " + value + ".");
+      options.solver = value;
+    }
+    else if (arg == "--vtk")
+      options.vtk = value;
+    else if (arg == "--json")
+      options.json = value;
+    else
+      throw std::runtime_error("Unknown option " + arg + ".");
+  }
+
+  if (options.n < 1)
+    throw std::runtime_error("Number of cells must be positive.");
+  if (options.steps < 1)
+    throw std::runtime_error("Number of load steps must be positive.");
+  return options;
+}
+//-----------------------------------------------------------------------------
+// Return true if a PETSc option is set, e.g. on the command line
+bool has_option(const std::string& option)
+{
+  PetscBool set = PETSC_FALSE;
+  PetscOptionsHasName(nullptr, nullptr, ("-" + option).c_str(), &set);
+  return set;
+}
+//-----------------------------------------------------------------------------
+// Collect the statistics of the Newton solve of a load step, reduced
+// over the processes (on rank 0)
+Step reduce_step(MPI_Comm comm, const nls::NewtonSolver& solver,
+                 int newton_iterations, double time)
+{
+  Step step;
+  step.newton_iterations = newton_iterations;
+  step.krylov_iterations = solver.krylov_iterations();
+  std::array<double, 6> times = {};
+  for (const auto& s : solver.statistics())
+  {
+    times[0] += s.residual;
+    times[1] += s.jacobian;
+    times[2] += s.preconditioner;
+    times[3] += s.linear_solve;
+    times[4] += s.update;
+  }
+  times[5] = time;
+  MPI_Reduce(times.data(), step.times.data(), times.size(), MPI_DOUBLE,
+             MPI_MAX, 0, comm);
+
+  const std::int64_t peak = common::MemoryUsage::read().peak;
+  MPI_Reduce(&peak, &step.memory_peak, 1, MPI_INT64_T, MPI_MAX, 0, comm);
+  return step;
+}
+//-----------------------------------------------------------------------------
+// Write the report of the load steps (JSON)
+void write_json(const std::string& filename, const Options& options,
+                int size, std::int64_t num_dofs, const std::vector<Step>& steps)
+{
+  std::ofstream file(filename);
+  if (!file)
+    throw std::runtime_error("Unable to open " + filename + " for writing.");
+  file << std::setprecision(9);
+  file << "{\n";
+  file << "  \"version\": \"" << dolfinx::version() << "\",\n";
+  file << "  \"git_commit\": \"" << dolfinx::git_commit_hash() << "\",\n";
+  file << "  \"scalar\": \""
+       << (dolfinx::has_petsc_complex() ? "complex" : "real") << "\",\n";
+  file << "  \"debug\": " << (dolfinx::has_debug() ? "true" : "false")
+       << ",\n";
+  file << "  \"processes\": " << size << ",\n";
+  file << "  \"hardware_threads\": " << std::thread::hardware_concurrency()
+       << ",\n";
+  file << "  \"n\": " << options.n << ",\n";
+  file << "  \"dofs\": " << num_dofs << ",\n";
+  file << "  \"solver\": \"" << options.solver << "\",\n";
+  file << "  \"steps\": [";
+  for (std::size_t i = 0; i < steps.size(); ++i)
+  {
+    const Step& s = steps[i];
+    file << (i == 0 ? "\n" : ",\n");
+    file << "    {\"newton_iterations\": " << s.newton_iterations
+         << ", \"krylov_iterations\": " << s.krylov_iterations;
+    for (std::size_t j = 0; j < step_phases.size(); ++j)
+      file << ", \"" << step_phases[j] << "\": " << s.times[j];
+    file << ", \"memory_peak\": " << s.memory_peak << "}";
+  }
+  file << "\n  ]\n}\n";
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 int main(int argc, char* argv[])
 {
   common::SubSystemsManager::init_logging(argc, argv);
   common::SubSystemsManager::init_petsc(argc, argv);
 
   {
+    const Options options = parse(argc, argv);
+
     // Inside the ``main`` function, we begin by defining a tetrahedral mesh
     // of the domain and the function space on this mesh. Here, we choose to
     // create a unit cube mesh with 25 ( = 24 + 1) vertices in one direction
@@ -117,7 +318,7 @@ int main(int argc, char* argv[])
         = fem::create_coordinate_map(create_coordinate_map_hyperelasticity);
     auto mesh = std::make_shared<mesh::Mesh>(generation::BoxMesh::create(
         MPI_COMM_WORLD, {Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1)},
-        {10, 10, 10}, cmap, mesh::GhostMode::none));
+        {options.n, options.n, options.n}, cmap, mesh::GhostMode::none));
 
     auto V = fem::create_functionspace(
         create_functionspace_form_hyperelasticity_F, "u", mesh);
@@ -129,35 +330,36 @@ int main(int argc, char* argv[])
         = fem::create_form<PetscScalar>(create_form_hyperelasticity_J, {V, V});
     auto L = fem::create_form<PetscScalar>(create_form_hyperelasticity_F, {V});
 
+    // The rotation of the right end by an angle theta, which is
+    // increased to the final angle (60 degrees) in the load steps
     auto u_rotation = std::make_shared<function::Function<PetscScalar>>(V);
-    u_rotation->interpolate([](auto& x) {
-      const double scale = 0.005;
-
-      // Center of rotation
-      const double y0 = 0.5;
-      const double z0 = 0.5;
-
-      // Large angle of rotation (60 degrees)
-      const double theta = 1.04719755;
-
-      Eigen::Array<PetscScalar, 3, Eigen::Dynamic, Eigen::RowMajor> values(
-          3, x.cols());
-      for (int i = 0; i < x.cols(); ++i)
-      {
-        // New coordinates
-        double y
-            = y0 + (x(1, i) - y0) * cos(theta) - (x(2, i) - z0) * sin(theta);
-        double z
-            = z0 + (x(1, i) - y0) * sin(theta) + (x(2, i) - z0) * cos(theta);
-
-        // Rotate at right end
-        values(0, i) = 0.0;
-        values(1, i) = scale * (y - x(1, i));
-        values(2, i) = scale * (z - x(2, i));
-      }
-
-      return values;
-    });
+    auto rotation = [](double theta) {
+      return [theta](auto& x) {
+        const double scale = 0.005;
+
+        // Center of rotation
+        const double y0 = 0.5;
+        const double z0 = 0.5;
+
+        Eigen::Array<PetscScalar, 3, Eigen::Dynamic, Eigen::RowMajor> values(
+            3, x.cols());
+        for (int i = 0; i < x.cols(); ++i)
+        {
+          // New coordinates
+          double y = y0 + (x(1, i) - y0) * cos(theta)
+                     - (x(2, i) - z0) * sin(theta);
+          double z = z0 + (x(1, i) - y0) * sin(theta)
+                     + (x(2, i) - z0) * cos(theta);
+
+          // Rotate at right end
+          values(0, i) = 0.0;
+          values(1, i) = scale * (y - x(1, i));
+          values(2, i) = scale * (z - x(2, i));
+        }
+
+        return values;
+      };
+    };
 
     auto u_clamp = std::make_shared<function::Function<PetscScalar>>(V);
     u_clamp->interpolate([](auto& x) {
@@ -186,13 +388,81 @@ int main(int argc, char* argv[])
                        std::make_shared<const fem::DirichletBC<PetscScalar>>(
                            u_rotation, bdofs_right)});
 
+    // The options of the Krylov solver that are not set on the command
+    // line, which are checked before the Newton solver sets its default
+    // (direct) solver
+    std::vector<std::pair<std::string, std::string>> krylov_options;
+    if (options.solver == "krylov")
+    {
+      for (auto [option, value] :
+           std::vector<std::pair<std::string, std::string>>{
+               {"nls_solve_ksp_type", "cg"},
+               {"nls_solve_pc_type", "gamg"},
+               {"nls_solve_ksp_rtol", "1.0e-10"}})
+      {
+        if (!has_option(option))
+          krylov_options.push_back({option, value});
+      }
+    }
+
     HyperElasticProblem problem(u, L, a, bcs);
     nls::NewtonSolver newton_solver(MPI_COMM_WORLD);
-    newton_solver.solve(problem, u->vector());
+    if (options.solver == "krylov")
+    {
+      for (auto& [option, value] : krylov_options)
+        la::PETScOptions::set(option, value);
+      newton_solver.get_krylov_solver().set_from_options();
+    }
+
+    // Apply the rotation in load steps, each starting from the solution
+    // of the previous step
+    const double theta = 1.04719755;
+    std::vector<Step> steps;
+    for (int i = 1; i <= options.steps; ++i)
+    {
+      u_rotation->interpolate(rotation(theta * i / options.steps));
+      MPI_Barrier(MPI_COMM_WORLD);
+      common::Timer timer("Hyperelasticity: load step");
+      const int newton_iterations
+          = newton_solver.solve(problem, u->vector()).first;
+      steps.push_back(reduce_step(MPI_COMM_WORLD, newton_solver,
+                                  newton_iterations, timer.stop()));
+    }
+
+    // Report the statistics of the load steps
+    std::shared_ptr<const common::IndexMap> map = V->dofmap()->index_map;
+    const std::int64_t num_dofs = map->size_global() * map->block_size();
+    const int size = dolfinx::MPI::size(MPI_COMM_WORLD);
+    if (dolfinx::MPI::rank(MPI_COMM_WORLD) == 0)
+    {
+      std::cout << "Processes: " << size << ", dofs: " << num_dofs
+                << ", solver: " << options.solver << std::endl;
+      std::cout << "step, Newton and Krylov iterations, max time (s) of "
+                   "F, J, PC setup, solve and step, peak memory (MB)"
+                << std::endl;
+      for (std::size_t i = 0; i < steps.size(); ++i)
+      {
+        const Step& s = steps[i];
+        std::cout << std::setw(4) << i + 1 << std::setw(6)
+                  << s.newton_iterations << std::setw(8)
+                  << s.krylov_iterations << std::scientific
+                  << std::setprecision(3);
+        for (int j : {0, 1, 2, 3, 5})
+          std::cout << std::setw(11) << s.times[j];
+        std::cout << std::defaultfloat << std::setw(10)
+                  << s.memory_peak / (1024 * 1024) << std::endl;
+      }
+
+      if (!options.json.empty())
+        write_json(options.json, options, size, num_dofs, steps);
+    }
 
     // Save solution in VTK format
-    io::VTKFile file("u.pvd");
-    file.write(*u);
+    if (!options.vtk.empty())
+    {
+      io::VTKFile file(options.vtk);
+      file.write(*u);
+    }
   }
 
   common::SubSystemsManager::finalize_petsc();
@@ -0,0 +1,343 @@
+// Poisson scaling benchmark (C++)
+// ===============================
+//
+// This demo is a weak and strong scaling benchmark of the solution of
+// the Poisson equation
+//
+// .. math::
+//    - \nabla^{2} u &= f \quad {\rm in} \ \Omega = [0,1]^3, \\
+//      u &= 0 \quad {\rm on} \ \{x = 0\}, \\
+//
+// with piecewise linear elements on a :cpp:class:`BoxMesh` of
+// tetrahedra. It can be used as an acceptance test of a new machine:
+//
+// * With ``--scaling weak`` (default), ``--dofs`` is the target number
+//   of degrees of freedom per process, and the problem grows with the
+//   number of processes
+// * With ``--scaling strong``, ``--dofs`` is the target number of
+//   degrees of freedom of the problem
+//
+// The resolution of the mesh is chosen such that the number of degrees
+// of freedom, :math:`(n + 1)^3` for an :math:`n \times n \times n`
+// mesh, is closest to the target. By default the mesh is structured
+// (see :cpp:func:`generation::create_structured_mesh`), such that the
+// mesh creation does not use a graph partitioner
+// (``--mesh partitioned`` to use it).
+//
+// The setup (mesh, function space, boundary conditions and forms), the
+// assembly and the solve are timed with :cpp:class:`common::Timer`
+// after a barrier, and the minimum, average and maximum times over the
+// processes are printed and, with ``--json FILE``, written to a JSON
+// file. The linear system is solved with the conjugate gradient method
+// preconditioned by algebraic multigrid, which can be changed with the
+// PETSc options with the prefix ``poisson_``, e.g.
+//
+//     mpirun -np 64 ./demo_poisson_scaling --scaling weak --dofs 500000 \
+//         --json weak_64.json -poisson_ksp_rtol 1e-10
+//
+// .. code-block:: cpp
+
+#include "poisson_scaling.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <dolfinx.h>
+#include <dolfinx/common/defines.h>
+#include <dolfinx/fem/petsc.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+// Options of a run
+struct Options
+{
+  // Weak scaling if true, otherwise strong scaling
+  bool weak = true;
+
+  // Target number of degrees of freedom per process (weak scaling) or
+  // of the problem (strong scaling)
+  std::int64_t dofs = 10000;
+
+  // Create a structured mesh, otherwise partition the mesh
+  bool structured = true;
+
+  // If not empty, write the report to this file (JSON)
+  std::string json;
+};
+
+// The time of a phase of the run, reduced over the processes
+struct Phase
+{
+  std::string name;
+  double min, avg, max;
+};
+
+const char* usage
+    = "Usage: demo_poisson_scaling [options] [PETSc options]\n"
+      "  --scaling weak|strong        Fixed size per process (weak,\n"
+      "                               default) or fixed global size\n"
+      "  --dofs N                     Target degrees of freedom per\n"
+      "                               process (weak) or in total (strong)\n"
+      "  --mesh structured|partitioned  Mesh creation (structured)\n"
+      "  --json FILE                  Write the timing report to FILE\n";
+
+//-----------------------------------------------------------------------------
+// Parse the options of the run. Arguments that do not start with "--"
+// are left to PETSc.
+Options parse(int argc, char* argv[])
+{
+  Options options;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--help")
+    {
+      std::cout << usage;
+      std::exit(0);
+    }
+    if (arg.rfind("--", 0) != 0)
+      continue;
+    if (i + 1 == argc)
+      throw std::runtime_error("Missing value of option " + arg + ".");
+
+    const std::string value = argv[++i];
+    if (arg == "--scaling")
+    {
+      if (value != "strong" and value != "weak")
+        throw std::runtime_error("Unknown scaling " + value + ".");
+      options.weak = value == "weak";
+    }
+    else if (arg == "--dofs")
+      options.dofs = std::stoll(value);
+    else if (arg == "--mesh")
+    {
+      if (value != "structured" and value != "partitioned")
+        throw std::runtime_error("Unknown mesh " + value + ".");
+      options.structured = value == "structured";
+    }
+    else if (arg == "--json")
+      options.json = value;
+    else
+      throw std::runtime_error("Unknown option " + arg + ".");
+  }
+
+  if (options.dofs < 1)
+    throw std::runtime_error("Number of dofs must be positive.");
+  return options;
+}
+//-----------------------------------------------------------------------------
+// The number of cells in each direction of the cube mesh with the
+// number of P1 dofs, (n + 1)^3, closest to a target
+std::size_t mesh_resolution(std::int64_t num_dofs)
+{
+  const long n = std::lround(std::cbrt(static_cast<double>(num_dofs)) - 1.0);
+  return std::max(1L, n);
+}
+//-----------------------------------------------------------------------------
+// Reduce the time of the calling process to the minimum, average and
+// maximum over the processes (on rank 0)
+Phase reduce(MPI_Comm comm, const std::string& name, double t)
+{
+  double tmin = 0.0, tmax = 0.0, tsum = 0.0;
+  MPI_Reduce(&t, &tmin, 1, MPI_DOUBLE, MPI_MIN, 0, comm);
+  MPI_Reduce(&t, &tmax, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+  MPI_Reduce(&t, &tsum, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+  return {name, tmin, tsum / dolfinx::MPI::size(comm), tmax};
+}
+//-----------------------------------------------------------------------------
+// Set a PETSc option, unless it is set on the command line
+void set_default_option(const std::string& option, const std::string& value)
+{
+  PetscBool set = PETSC_FALSE;
+  PetscOptionsHasName(nullptr, nullptr, ("-" + option).c_str(), &set);
+  if (!set)
+    la::PETScOptions::set(option, value);
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  common::SubSystemsManager::init_logging(argc, argv);
+  common::SubSystemsManager::init_petsc(argc, argv);
+
+  {
+    MPI_Comm comm = MPI_COMM_WORLD;
+    const int size = dolfinx::MPI::size(comm);
+    const int rank = dolfinx::MPI::rank(comm);
+    const Options options = parse(argc, argv);
+    const std::int64_t target
+        = options.weak ? options.dofs * size : options.dofs;
+    const std::size_t n = mesh_resolution(target);
+
+    // Time a phase of the run on each process, after a barrier such
+    // that the imbalance of the previous phase is not included
+    std::vector<Phase> phases;
+    auto timed = [comm, &phases](const std::string& name, auto&& f) {
+      MPI_Barrier(comm);
+      common::Timer timer("Poisson scaling: " + name);
+      f();
+      phases.push_back(reduce(comm, name, timer.stop()));
+    };
+
+    // Setup
+    std::shared_ptr<mesh::Mesh> mesh;
+    timed("create mesh", [&]() {
+      auto cmap
+          = fem::create_coordinate_map(create_coordinate_map_poisson_scaling);
+      mesh = std::make_shared<mesh::Mesh>(generation::BoxMesh::create(
+          comm,
+          {Eigen::Vector3d(0.0, 0.0, 0.0), Eigen::Vector3d(1.0, 1.0, 1.0)},
+          {n, n, n}, cmap, mesh::GhostMode::none, options.structured));
+    });
+
+    std::shared_ptr<function::FunctionSpace> V;
+    timed("create function space", [&]() {
+      V = fem::create_functionspace(
+          create_functionspace_form_poisson_scaling_a, "u", mesh);
+    });
+
+    std::vector<std::shared_ptr<const fem::DirichletBC<PetscScalar>>> bc;
+    timed("create boundary conditions", [&]() {
+      auto u0 = std::make_shared<function::Function<PetscScalar>>(V);
+      const auto bdofs = fem::locate_dofs_geometrical({*V}, [](auto& x) {
+        return x.row(0).abs() < 10.0 * std::numeric_limits<double>::epsilon();
+      });
+      bc.push_back(
+          std::make_shared<const fem::DirichletBC<PetscScalar>>(u0, bdofs));
+    });
+
+    std::shared_ptr<fem::Form<PetscScalar>> a, L;
+    timed("create forms", [&]() {
+      a = fem::create_form<PetscScalar>(create_form_poisson_scaling_a, {V, V});
+      L = fem::create_form<PetscScalar>(create_form_poisson_scaling_L, {V});
+      auto f = std::make_shared<function::Function<PetscScalar>>(V);
+      f->interpolate([](auto& x) {
+        auto dx = Eigen::square(x - 0.5);
+        return 10.0 * Eigen::exp(-(dx.row(0) + dx.row(1) + dx.row(2)) / 0.02);
+      });
+      L->set_coefficients({{"f", f}});
+    });
+
+    // Assembly
+    std::shared_ptr<la::PETScMatrix> A;
+    timed("create matrix", [&]() {
+      A = std::make_shared<la::PETScMatrix>(fem::create_matrix(*a));
+    });
+
+    timed("assemble matrix", [&]() {
+      MatZeroEntries(A->mat());
+      fem::assemble_matrix(la::PETScMatrix::add_fn(A->mat()), *a, bc);
+      fem::add_diagonal(la::PETScMatrix::add_fn(A->mat()), *V, bc);
+      MatAssemblyBegin(A->mat(), MAT_FINAL_ASSEMBLY);
+      MatAssemblyEnd(A->mat(), MAT_FINAL_ASSEMBLY);
+    });
+
+    la::PETScVector b(*V->dofmap()->index_map);
+    timed("assemble vector", [&]() {
+      VecSet(b.vec(), 0.0);
+      fem::assemble_vector_petsc(b.vec(), *L);
+      fem::apply_lifting_petsc(b.vec(), {a}, {{bc}}, {}, 1.0);
+      VecGhostUpdateBegin(b.vec(), ADD_VALUES, SCATTER_REVERSE);
+      VecGhostUpdateEnd(b.vec(), ADD_VALUES, SCATTER_REVERSE);
+      fem::set_bc_petsc(b.vec(), bc, nullptr);
+    });
+
+    // Solve
+    la::PETScKrylovSolver solver(comm);
+    solver.set_options_prefix("poisson_");
+    set_default_option("poisson_ksp_type", "cg");
+    set_default_option("poisson_pc_type", "gamg");
+    set_default_option("poisson_ksp_rtol", "1.0e-8");
+    solver.set_from_options();
+    solver.set_operator(A->mat());
+
+    function::Function<PetscScalar> u(V);
+    timed("set up solver", [&]() { solver.set_up(); });
+    int num_iterations = 0;
+    timed("solve",
+          [&]() { num_iterations = solver.solve(u.vector(), b.vec()); });
+
+    // Report
+    std::shared_ptr<const common::IndexMap> map = V->dofmap()->index_map;
+    const std::int64_t num_dofs = map->size_global();
+    const std::int64_t num_cells
+        = mesh->topology().index_map(3)->size_global();
+    std::int64_t local_dofs = map->size_local(), min_dofs = 0, max_dofs = 0;
+    MPI_Reduce(&local_dofs, &min_dofs, 1, MPI_INT64_T, MPI_MIN, 0, comm);
+    MPI_Reduce(&local_dofs, &max_dofs, 1, MPI_INT64_T, MPI_MAX, 0, comm);
+
+    if (rank == 0)
+    {
+      std::cout << "Processes: " << size
+                << ", scaling: " << (options.weak ? "weak" : "strong")
+                << ", cells in each direction: " << n << std::endl;
+      std::cout << "Dofs: " << num_dofs << " (" << min_dofs << " to "
+                << max_dofs << " per process), cells: " << num_cells
+                << ", iterations: " << num_iterations << std::endl;
+      std::cout << "phase, min, avg and max time (s)" << std::endl;
+      for (const Phase& p : phases)
+      {
+        std::cout << std::left << std::setw(28) << p.name << std::right
+                  << std::scientific << std::setprecision(3) << std::setw(12)
+                  << p.min << std::setw(12) << p.avg << std::setw(12)
+                  << p.max << std::defaultfloat << std::endl;
+      }
+
+      if (!options.json.empty())
+      {
+        std::ofstream file(options.json);
+        if (!file)
+        {
+          throw std::runtime_error("Unable to open " + options.json
+                                   + " for writing.");
+        }
+        file << std::setprecision(9);
+        file << "{\n";
+        file << "  \"version\": \"" << dolfinx::version() << "\",\n";
+        file << "  \"git_commit\": \"" << dolfinx::git_commit_hash()
+             << "\",\n";
+        file << "  \"scalar\": \""
+             << (dolfinx::has_petsc_complex() ? "complex" : "real")
+             << "\",\n";
+        file << "  \"debug\": " << (dolfinx::has_debug() ? "true" : "false")
+             << ",\n";
+        file << "  \"processes\": " << size << ",\n";
+        file << "  \"hardware_threads\": "
+             << std::thread::hardware_concurrency() << ",\n";
+        file << "  \"scaling\": \"" << (options.weak ? "weak" : "strong")
+             << "\",\n";
+        file << "  \"target_dofs\": " << target << ",\n";
+        file << "  \"mesh\": \""
+             << (options.structured ? "structured" : "partitioned")
+             << "\",\n";
+        file << "  \"n\": " << n << ",\n";
+        file << "  \"cells\": " << num_cells << ",\n";
+        file << "  \"dofs\": " << num_dofs << ",\n";
+        file << "  \"dofs_per_process\": {\"min\": " << min_dofs
+             << ", \"max\": " << max_dofs << "},\n";
+        file << "  \"iterations\": " << num_iterations << ",\n";
+        file << "  \"phases\": [";
+        for (std::size_t i = 0; i < phases.size(); ++i)
+        {
+          const Phase& p = phases[i];
+          file << (i == 0 ? "\n" : ",\n");
+          file << "    {\"name\": \"" << p.name << "\", \"min\": " << p.min
+               << ", \"avg\": " << p.avg << ", \"max\": " << p.max << "}";
+        }
+        file << "\n  ]\n}\n";
+      }
+    }
+  }
+
+  common::SubSystemsManager::finalize_petsc();
+  return 0;
+}
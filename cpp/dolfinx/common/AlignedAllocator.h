@@ -0,0 +1,100 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace dolfinx::common
+{
+
+/// Alignment (bytes) of aligned arrays. It is the size of a cache line
+/// on common processors, and a multiple of the width of the widest SIMD
+/// registers (AVX-512).
+constexpr std::size_t cache_line_size = 64;
+
+/// Allocator for std::containers that aligns the storage to
+/// @p Alignment bytes, e.g. for arrays that are passed to vectorised
+/// kernels.
+template <typename T, std::size_t Alignment = cache_line_size>
+class AlignedAllocator
+{
+public:
+  static_assert(Alignment >= alignof(T) and (Alignment & (Alignment - 1)) == 0,
+                "Alignment must be a power of two and at least alignof(T)");
+
+  /// Value type
+  using value_type = T;
+
+  /// Allocator for type U with the same alignment
+  template <typename U>
+  struct rebind
+  {
+    /// The allocator type
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  /// Create allocator
+  AlignedAllocator() noexcept = default;
+
+  /// Create allocator from an allocator for another type
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+  {
+  }
+
+  /// Allocate aligned storage for n values
+  T* allocate(std::size_t n)
+  {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw std::bad_array_new_length();
+    return static_cast<T*>(
+        ::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  /// Free storage allocated by allocate
+  void deallocate(T* p, std::size_t) noexcept
+  {
+    ::operator delete(p, std::align_val_t(Alignment));
+  }
+
+  /// Allocators with the same alignment are interchangeable
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept
+  {
+    return true;
+  }
+
+  /// Allocators with the same alignment are interchangeable
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept
+  {
+    return false;
+  }
+};
+
+/// std::vector with storage aligned to a cache line
+template <typename T>
+using aligned_vector = std::vector<T, AlignedAllocator<T>>;
+
+/// Round the size of an array up to a whole number of cache lines, such
+/// that loads and stores of full SIMD registers at the end of the array
+/// stay within its (aligned) storage
+/// @param[in] n The number of values
+/// @return The padded number of values
+template <typename T>
+constexpr std::size_t padded_size(std::size_t n)
+{
+  constexpr std::size_t m = cache_line_size / sizeof(T) > 0
+                                ? cache_line_size / sizeof(T)
+                                : 1;
+  return ((n + m - 1) / m) * m;
+}
+
+} // namespace dolfinx::common
@@ -0,0 +1,97 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "CommProfiler.h"
+#include <dolfinx/common/MPI.h>
+#include <iostream>
+#include <mutex>
+
+using namespace dolfinx;
+using namespace dolfinx::common;
+
+namespace
+{
+// The records of the call sites, and the mutex that guards them
+std::map<std::string, CommProfiler::Record>& records()
+{
+  static std::map<std::string, CommProfiler::Record> r;
+  return r;
+}
+std::mutex& records_mutex()
+{
+  static std::mutex m;
+  return m;
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+CommProfiler::Scope::~Scope()
+{
+  if (_active)
+  {
+    const std::chrono::duration<double> time
+        = std::chrono::steady_clock::now() - _start;
+    CommProfiler::record(_site, _neighbours, _bytes_sent, _bytes_received,
+                         time.count());
+  }
+}
+//-----------------------------------------------------------------------------
+void CommProfiler::set_enabled(bool enabled)
+{
+  _enabled.store(enabled, std::memory_order_relaxed);
+}
+//-----------------------------------------------------------------------------
+void CommProfiler::record(const std::string& site, std::int64_t neighbours,
+                          std::int64_t bytes_sent,
+                          std::int64_t bytes_received, double time)
+{
+  std::lock_guard<std::mutex> lock(records_mutex());
+  Record& r = ::records()[site];
+  r.calls += 1;
+  r.neighbours += neighbours;
+  r.bytes_sent += bytes_sent;
+  r.bytes_received += bytes_received;
+  r.time += time;
+}
+//-----------------------------------------------------------------------------
+std::map<std::string, CommProfiler::Record> CommProfiler::records()
+{
+  std::lock_guard<std::mutex> lock(records_mutex());
+  return ::records();
+}
+//-----------------------------------------------------------------------------
+void CommProfiler::clear()
+{
+  std::lock_guard<std::mutex> lock(records_mutex());
+  ::records().clear();
+}
+//-----------------------------------------------------------------------------
+Table CommProfiler::table()
+{
+  // The values are doubles, such that all columns are reduced by
+  // Table::reduce
+  Table table("Summary of communication");
+  for (auto& [site, r] : records())
+  {
+    table.set(site, "calls", static_cast<double>(r.calls));
+    table.set(site, "neighbours", static_cast<double>(r.neighbours));
+    table.set(site, "bytes sent", static_cast<double>(r.bytes_sent));
+    table.set(site, "bytes recv", static_cast<double>(r.bytes_received));
+    table.set(site, "time", r.time);
+    table.set(site, "time/call", r.time / static_cast<double>(r.calls));
+  }
+  return table;
+}
+//-----------------------------------------------------------------------------
+void CommProfiler::list(MPI_Comm comm)
+{
+  const Table local = table();
+  const Table avg = local.reduce(comm, Table::Reduction::average);
+  const Table max = local.reduce(comm, Table::Reduction::max);
+  if (dolfinx::MPI::rank(comm) == 0)
+    std::cout << "\n" << avg.str() << "\n\n" << max.str() << std::endl;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <dolfinx/common/Table.h>
+#include <map>
+#include <mpi.h>
+#include <string>
+
+namespace dolfinx::common
+{
+
+/// Opt-in profiler of the communication of the library. The
+/// communication call sites (e.g. MPI::sparse_exchange, the scatters of
+/// IndexMap, the ghost updates of PETScVector and HDF5 writes) record
+/// the number of calls, the number of neighbour ranks, the bytes sent
+/// and received and the time spent in the call, per named call site.
+/// Recording is disabled by default, and then only costs the check of
+/// a flag.
+
+class CommProfiler
+{
+public:
+  /// The communication of a call site on this process
+  struct Record
+  {
+    /// Number of calls
+    std::int64_t calls = 0;
+
+    /// Sum over the calls of the number of destination ranks
+    std::int64_t neighbours = 0;
+
+    /// Total bytes sent and received (written and read for I/O)
+    std::int64_t bytes_sent = 0, bytes_received = 0;
+
+    /// Total time in the calls in seconds (for split-phase
+    /// communication, the time waiting for its completion)
+    double time = 0.0;
+  };
+
+  /// Records a call by its lifetime: the time of the call is the time
+  /// between the construction and the destruction. The sizes are set
+  /// when they are known.
+  class Scope
+  {
+  public:
+    /// Start recording a call at a call site, if the profiler is
+    /// enabled
+    /// @param[in] site The name of the call site, which must be valid
+    ///   for the lifetime of the scope
+    Scope(const char* site)
+        : _site(site), _active(CommProfiler::enabled())
+    {
+      if (_active)
+        _start = std::chrono::steady_clock::now();
+    }
+
+    // Copy constructor
+    Scope(const Scope&) = delete;
+
+    /// Stop recording and register the call
+    ~Scope();
+
+    /// Set the sizes of the communication of the call
+    /// @param[in] neighbours The number of destination ranks
+    /// @param[in] bytes_sent The number of bytes sent
+    /// @param[in] bytes_received The number of bytes received
+    void set(std::int64_t neighbours, std::int64_t bytes_sent,
+             std::int64_t bytes_received)
+    {
+      _neighbours = neighbours;
+      _bytes_sent = bytes_sent;
+      _bytes_received = bytes_received;
+    }
+
+  private:
+    const char* _site;
+    bool _active;
+    std::chrono::steady_clock::time_point _start;
+    std::int64_t _neighbours = 0, _bytes_sent = 0, _bytes_received = 0;
+  };
+
+  /// Enable or disable recording
+  static void set_enabled(bool enabled);
+
+  /// Return true if recording is enabled
+  static bool enabled() { return _enabled.load(std::memory_order_relaxed); }
+
+  /// Register a call at a call site. The call is thread-safe.
+  /// @param[in] site The name of the call site
+  /// @param[in] neighbours The number of destination ranks
+  /// @param[in] bytes_sent The number of bytes sent
+  /// @param[in] bytes_received The number of bytes received
+  /// @param[in] time The time of the call in seconds
+  static void record(const std::string& site, std::int64_t neighbours,
+                     std::int64_t bytes_sent, std::int64_t bytes_received,
+                     double time);
+
+  /// Return the records of the call sites on this process
+  static std::map<std::string, Record> records();
+
+  /// Remove all records
+  static void clear();
+
+  /// Return the records of this process as a table, with a row per
+  /// call site
+  static Table table();
+
+  /// Print the records reduced over the processes, as a table of the
+  /// average and a table of the maximum of each value (collective)
+  /// @param[in] comm The MPI communicator
+  static void list(MPI_Comm comm);
+
+private:
+  // True if calls are recorded
+  inline static std::atomic<bool> _enabled{false};
+};
+
+} // namespace dolfinx::common
@@ -0,0 +1,209 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <mpi.h>
+#include <type_traits>
+
+namespace dolfinx::common
+{
+
+/// Exact (binned) sum of floating point numbers. Each number is split
+/// into integer pieces of fixed binary exponent ranges (bins), such
+/// that the sum is computed without rounding. The sum hence does not
+/// depend on the order in which numbers are added, or on how the
+/// numbers are split between partial sums (threads and processes), and
+/// the value of the sum is reproducible to the last bit.
+///
+/// Adding a number costs a few integer operations. The rounded value
+/// of the sum is accurate to about one unit in the last place. If a
+/// non-finite number (inf or nan) is added, the value is the
+/// (non-finite) plain floating point sum of the non-finite numbers.
+///
+/// @tparam T The scalar type (real or complex, single or double
+///   precision). Real and imaginary parts are summed separately.
+template <typename T>
+class ExactSum
+{
+public:
+  /// Create a zero sum
+  ExactSum() = default;
+
+  /// Add a number to the sum
+  ExactSum& operator+=(T x)
+  {
+    _sums[0].add(std::real(x));
+    if constexpr (!std::is_floating_point_v<T>)
+      _sums[1].add(std::imag(x));
+    return *this;
+  }
+
+  /// Add another (e.g. partial) sum to the sum
+  ExactSum& operator+=(const ExactSum& other)
+  {
+    _sums[0].add(other._sums[0]);
+    _sums[1].add(other._sums[1]);
+    return *this;
+  }
+
+  /// The value of the sum, rounded to T
+  T value() const
+  {
+    if constexpr (std::is_floating_point_v<T>)
+      return _sums[0].value();
+    else
+    {
+      using U = typename T::value_type;
+      return T(static_cast<U>(_sums[0].value()),
+               static_cast<U>(_sums[1].value()));
+    }
+  }
+
+  /// Sum the sums of all processes. This is collective, and the exact
+  /// sum is the same on all processes.
+  /// @param[in] comm The MPI communicator
+  void allreduce(MPI_Comm comm)
+  {
+    _sums[0].allreduce(comm);
+    if constexpr (!std::is_floating_point_v<T>)
+      _sums[1].allreduce(comm);
+  }
+
+private:
+  // Exact sum of doubles. The sum is sum_i bins[i] 2^(32 i - bias),
+  // where the pieces of a double are < 2^32 in magnitude. Floats are
+  // exactly representable as doubles.
+  class Real
+  {
+  public:
+    void add(double x)
+    {
+      if (x == 0.0)
+        return;
+      if (!std::isfinite(x))
+      {
+        _nonfinite += x;
+        _has_nonfinite = 1;
+        return;
+      }
+
+      // x = m 2^e, where m is an integer with |m| < 2^53. The least
+      // significant bit of m is at position e + bias of the bins.
+      int e;
+      const double f = std::frexp(x, &e);
+      const std::int64_t m = static_cast<std::int64_t>(std::ldexp(f, 53));
+      const std::uint64_t u = m < 0 ? -m : m;
+      const std::int64_t sign = m < 0 ? -1 : 1;
+      const int pos = e - 53 + bias;
+      const int b = pos / 32;
+      const int shift = pos % 32;
+
+      // Split m into 32-bit pieces of the bins b, b + 1 and b + 2
+      const std::uint64_t mask = 0xffffffff;
+      const std::uint64_t high = u >> (32 - shift);
+      _bins[b] += sign * static_cast<std::int64_t>((u << shift) & mask);
+      _bins[b + 1] += sign * static_cast<std::int64_t>(high & mask);
+      _bins[b + 2] += sign * static_cast<std::int64_t>(high >> 32);
+
+      // Carry before the bins can overflow
+      if (++_count == max_count)
+        normalise();
+    }
+
+    void add(const Real& other)
+    {
+      for (int i = 0; i < num_bins; ++i)
+        _bins[i] += other._bins[i];
+      _nonfinite += other._nonfinite;
+      _has_nonfinite |= other._has_nonfinite;
+      _count += other._count;
+      if (_count >= max_count)
+        normalise();
+    }
+
+    double value() const
+    {
+      if (_has_nonfinite)
+        return _nonfinite;
+
+      // Sum the (normalised, non-negative) bins of the magnitude from
+      // the least significant bin, such that each addition rounds at
+      // most once
+      Real r = *this;
+      r.normalise();
+      const bool negative = r._bins[num_bins - 1] < 0;
+      if (negative)
+      {
+        for (std::int64_t& b : r._bins)
+          b = -b;
+        r.normalise();
+      }
+
+      double v = 0.0;
+      for (int i = 0; i < num_bins; ++i)
+      {
+        if (r._bins[i] != 0)
+          v += std::ldexp(static_cast<double>(r._bins[i]), 32 * i - bias);
+      }
+      return negative ? -v : v;
+    }
+
+    void allreduce(MPI_Comm comm)
+    {
+      // After normalisation the bins are < 2^32 in magnitude, so the
+      // sum over processes does not overflow
+      normalise();
+      MPI_Allreduce(MPI_IN_PLACE, _bins.data(), num_bins, MPI_INT64_T,
+                    MPI_SUM, comm);
+      MPI_Allreduce(MPI_IN_PLACE, &_nonfinite, 1, MPI_DOUBLE, MPI_SUM, comm);
+      MPI_Allreduce(MPI_IN_PLACE, &_has_nonfinite, 1, MPI_INT, MPI_LOR,
+                    comm);
+      normalise();
+    }
+
+  private:
+    // Move the carries of the bins up, such that all bins except the
+    // most significant are in [0, 2^32). The resulting representation
+    // of the sum is unique.
+    void normalise()
+    {
+      const std::int64_t base = std::int64_t(1) << 32;
+      for (int i = 0; i < num_bins - 1; ++i)
+      {
+        const std::int64_t carry
+            = _bins[i] >= 0 ? _bins[i] / base : -((-_bins[i] - 1) / base) - 1;
+        _bins[i] -= carry * base;
+        _bins[i + 1] += carry;
+      }
+      _count = 1;
+    }
+
+    // Position offset of the least significant bit of the smallest
+    // subnormal double (2^-1074), such that all positions are positive
+    static constexpr int bias = 1074 + 53;
+
+    // Bins for the bit positions [0, 2151] of doubles, with headroom
+    // for carries
+    static constexpr int num_bins = 70;
+
+    // Number of additions after which carries are moved up
+    static constexpr std::int64_t max_count = std::int64_t(1) << 30;
+
+    std::array<std::int64_t, num_bins> _bins = {};
+    std::int64_t _count = 0;
+    double _nonfinite = 0.0;
+    int _has_nonfinite = 0;
+  };
+
+  std::array<Real, 2> _sums;
+};
+
+} // namespace dolfinx::common
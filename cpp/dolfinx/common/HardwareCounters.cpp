@@ -0,0 +1,125 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "HardwareCounters.h"
+#include <vector>
+
+#ifdef HAS_PERF_EVENT
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace dolfinx;
+using namespace dolfinx::common;
+
+namespace
+{
+#ifdef HAS_PERF_EVENT
+//-----------------------------------------------------------------------------
+// The counters of a thread, as a perf_event group. The events that
+// could be opened are read in the order of the group, and mapped to
+// their positions in HardwareCounters::Event.
+struct CounterGroup
+{
+  CounterGroup()
+  {
+    constexpr std::array<std::uint64_t, HardwareCounters::num_events> config
+        = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+           PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES,
+           PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < HardwareCounters::num_events; ++i)
+    {
+      perf_event_attr attr = {};
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(perf_event_attr);
+      attr.config = config[i];
+      attr.read_format = PERF_FORMAT_GROUP;
+      attr.disabled = leader < 0 ? 1 : 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+
+      // Count the calling thread on any CPU
+      const int fd = syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+      if (fd >= 0)
+      {
+        if (leader < 0)
+          leader = fd;
+        fds.push_back(fd);
+        events.push_back(i);
+      }
+    }
+
+    if (leader >= 0)
+    {
+      ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+  }
+
+  ~CounterGroup()
+  {
+    for (int fd : fds)
+      close(fd);
+  }
+
+  std::array<std::uint64_t, HardwareCounters::num_events> read()
+  {
+    std::array<std::uint64_t, HardwareCounters::num_events> counts = {};
+    if (leader < 0)
+      return counts;
+
+    // Group read: the number of events followed by the values
+    std::array<std::uint64_t, HardwareCounters::num_events + 1> data;
+    if (::read(leader, data.data(), sizeof(data)) > 0)
+    {
+      for (std::size_t i = 0; i < events.size() and i < data[0]; ++i)
+        counts[events[i]] = data[i + 1];
+    }
+    return counts;
+  }
+
+  int leader = -1;
+  std::vector<int> fds, events;
+};
+//-----------------------------------------------------------------------------
+CounterGroup& counter_group()
+{
+  thread_local CounterGroup group;
+  return group;
+}
+//-----------------------------------------------------------------------------
+#endif
+} // namespace
+
+//-----------------------------------------------------------------------------
+std::array<const char*, HardwareCounters::num_events>
+HardwareCounters::names()
+{
+  return {"cycles", "instructions", "cache refs", "cache misses",
+          "branch misses"};
+}
+//-----------------------------------------------------------------------------
+bool HardwareCounters::available()
+{
+#ifdef HAS_PERF_EVENT
+  return counter_group().leader >= 0;
+#else
+  return false;
+#endif
+}
+//-----------------------------------------------------------------------------
+std::array<std::uint64_t, HardwareCounters::num_events>
+HardwareCounters::read()
+{
+#ifdef HAS_PERF_EVENT
+  return counter_group().read();
+#else
+  return {};
+#endif
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,57 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace dolfinx::common
+{
+
+/// Hardware performance counters of the calling thread, read with the
+/// Linux perf_event interface (if DOLFINX is built with HAS_PERF_EVENT).
+/// The counters are opened on the first read on each thread, as one
+/// group, such that they are read together by one system call. Events
+/// that the processor (or the perf_event_paranoid setting) does not
+/// allow are read as zero.
+///
+/// Floating point operation counts are not included: they are
+/// processor specific raw events on most processors.
+
+namespace HardwareCounters
+{
+
+/// The counted events
+enum class Event : int
+{
+  cycles = 0,           // CPU cycles
+  instructions = 1,     // Retired instructions
+  cache_references = 2, // Last level cache references
+  cache_misses = 3,     // Last level cache misses
+  branch_misses = 4     // Mispredicted branches
+};
+
+/// Number of counted events
+constexpr int num_events = 5;
+
+/// Size of a cache line in bytes, to estimate the memory traffic from
+/// the last level cache misses
+constexpr int cache_line_size = 64;
+
+/// Return the names of the events
+std::array<const char*, num_events> names();
+
+/// Return true if the counters of the calling thread can be read, i.e.
+/// at least one event could be opened
+bool available();
+
+/// Read the counters of the calling thread
+/// @return The count of each event since the counters were opened
+std::array<std::uint64_t, num_events> read();
+
+} // namespace HardwareCounters
+} // namespace dolfinx::common
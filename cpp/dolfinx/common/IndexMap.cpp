@@ -7,6 +7,7 @@
 #include "IndexMap.h"
 #include <algorithm>
 #include <numeric>
+#include <set>
 #include <unordered_map>
 
 using namespace dolfinx;
@@ -15,6 +16,34 @@ using namespace dolfinx::common;
 namespace
 {
 //-----------------------------------------------------------------------------
+// Build the compressed shared index data from a list of (local index,
+// rank) pairs. The pairs are sorted and duplicates are removed.
+IndexMap::SharedIndices
+create_shared_indices(std::vector<std::pair<std::int32_t, int>>& pairs)
+{
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  std::vector<std::int32_t> indices, offsets{0};
+  std::vector<int> ranks;
+  ranks.reserve(pairs.size());
+  for (const auto& [idx, rank] : pairs)
+  {
+    if (indices.empty() or indices.back() != idx)
+    {
+      if (!indices.empty())
+        offsets.push_back(ranks.size());
+      indices.push_back(idx);
+    }
+    ranks.push_back(rank);
+  }
+  if (!indices.empty())
+    offsets.push_back(ranks.size());
+
+  return {std::move(indices),
+          graph::AdjacencyList<int>(std::move(ranks), std::move(offsets))};
+}
+//-----------------------------------------------------------------------------
 void local_to_global_impl(
     Eigen::Ref<Eigen::Array<std::int64_t, Eigen::Dynamic, 1>> global,
     const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
@@ -53,6 +82,23 @@ void local_to_global_impl(
   }
 }
 //-----------------------------------------------------------------------------
+// Start the communication of a scatter with a plan
+template <typename T>
+void start_scatter(IndexMap::ScatterRequest<T>& request, MPI_Comm comm)
+{
+  if (request.persistent)
+    MPI_Start(&request.request);
+  else
+  {
+    MPI_Ineighbor_alltoallv(
+        request.send_data.data(), request.send_sizes.data(),
+        request.displs_send.data(), dolfinx::MPI::mpi_type<T>(),
+        request.recv_data.data(), request.recv_sizes.data(),
+        request.displs_recv.data(), dolfinx::MPI::mpi_type<T>(), comm,
+        &request.request);
+  }
+}
+//-----------------------------------------------------------------------------
 
 /// Compute the owning rank of ghost indices
 std::vector<int> get_ghost_ranks(
@@ -600,6 +646,23 @@ const std::vector<std::int32_t>& IndexMap::shared_indices() const
   return _shared_indices;
 }
 //-----------------------------------------------------------------------------
+const std::vector<std::int32_t>& IndexMap::shared_indices_offsets() const
+{
+  return _shared_disp;
+}
+//-----------------------------------------------------------------------------
+std::size_t IndexMap::memory_usage() const
+{
+  return sizeof(*this) + _ghosts.size() * sizeof(std::int64_t)
+         + _ghost_owners.size() * sizeof(std::int32_t)
+         + _shared_indices.capacity() * sizeof(std::int32_t)
+         + _shared_disp.capacity() * sizeof(std::int32_t)
+         + (_shared_index_ranks
+                ? _shared_index_ranks->indices.capacity() * sizeof(std::int32_t)
+                      + _shared_index_ranks->ranks.memory_usage()
+                : 0);
+}
+//-----------------------------------------------------------------------------
 Eigen::Array<int, Eigen::Dynamic, 1> IndexMap::ghost_owner_rank() const
 {
   int indegree(-1), outdegree(-2), weighted(-1);
@@ -648,8 +711,11 @@ MPI_Comm IndexMap::comm(Direction dir) const
   }
 }
 //----------------------------------------------------------------------------
-std::map<std::int32_t, std::set<int>> IndexMap::compute_shared_indices() const
+const IndexMap::SharedIndices& IndexMap::shared_index_ranks() const
 {
+  if (_shared_index_ranks)
+    return *_shared_index_ranks;
+
   // Get number of neighbors and neighbor ranks
   int indegree(-1), outdegree(-2), weighted(-1);
   MPI_Dist_graph_neighbors_count(_comm_owner_to_ghost.comm(), &indegree,
@@ -659,18 +725,17 @@ std::map<std::int32_t, std::set<int>> IndexMap::compute_shared_indices() const
                            neighbors_in.data(), MPI_UNWEIGHTED, outdegree,
                            neighbors_out.data(), MPI_UNWEIGHTED);
 
-  std::map<std::int32_t, std::set<int>> shared_indices;
-
-  // Build map from owned local index to ranks that ghost the index
+  // Build (owned local index, rank) pairs for the ranks that ghost
+  // the index
+  std::vector<std::pair<std::int32_t, int>> pairs;
+  pairs.reserve(_shared_indices.size() + _ghosts.size());
   for (std::size_t p = 0; p < _shared_disp.size() - 1; ++p)
   {
     const int rank_global = neighbors_out[p];
     for (int i = _shared_disp[p]; i < _shared_disp[p + 1]; ++i)
-    {
-      int idx = _shared_indices[i];
-      shared_indices[idx].insert(rank_global);
-    }
+      pairs.push_back({_shared_indices[i], rank_global});
   }
+  const SharedIndices owned = create_shared_indices(pairs);
 
   // Ghost indices know the owner rank, but they don't know about other
   // ranks that also ghost the index. If an index is a ghost on more
@@ -683,19 +748,20 @@ std::map<std::int32_t, std::set<int>> IndexMap::compute_shared_indices() const
   {
     for (int i = _shared_disp[p]; i < _shared_disp[p + 1]; ++i)
     {
-      int idx = _shared_indices[i];
-      assert(shared_indices.find(idx) != shared_indices.end());
-      if (auto it = shared_indices.find(idx); it->second.size() > 1)
+      const std::int32_t idx = _shared_indices[i];
+      const std::int32_t pos = owned.find(idx);
+      assert(pos != -1);
+      if (auto ranks = owned.ranks.links(pos); ranks.rows() > 1)
       {
         // Add global index
         fwd_sharing_data.push_back(idx + _local_range[0]);
 
         // Add number of sharing ranks
-        fwd_sharing_data.push_back(shared_indices[idx].size());
+        fwd_sharing_data.push_back(ranks.rows());
 
         // Add sharing ranks
-        fwd_sharing_data.insert(fwd_sharing_data.end(), it->second.begin(),
-                                it->second.end());
+        fwd_sharing_data.insert(fwd_sharing_data.end(), ranks.data(),
+                                ranks.data() + ranks.rows());
       }
     }
 
@@ -733,7 +799,7 @@ std::map<std::int32_t, std::set<int>> IndexMap::compute_shared_indices() const
   // For my ghosts, add owning rank to list of sharing ranks
   const std::int32_t size_local = this->size_local();
   for (int i = 0; i < _ghosts.size(); ++i)
-    shared_indices[size_local + i].insert(neighbors_in[_ghost_owners[i]]);
+    pairs.push_back({size_local + i, neighbors_in[_ghost_owners[i]]});
 
   // Build map from global index to local index for ghosts
   std::unordered_map<std::int64_t, std::int32_t> ghosts;
@@ -756,12 +822,14 @@ std::map<std::int32_t, std::set<int>> IndexMap::compute_shared_indices() const
     for (int j = 0; j < set_size; j++)
     {
       if (recv_data[i + 2 + j] != myrank)
-        shared_indices[idx].insert(recv_data[i + 2 + +j]);
+        pairs.push_back({idx, static_cast<int>(recv_data[i + 2 + j])});
     }
     i += set_size + 2;
   }
 
-  return shared_indices;
+  _shared_index_ranks
+      = std::make_shared<const SharedIndices>(create_shared_indices(pairs));
+  return *_shared_index_ranks;
 }
 //-----------------------------------------------------------------------------
 void IndexMap::scatter_fwd(const std::vector<std::int64_t>& local_data,
@@ -776,6 +844,19 @@ void IndexMap::scatter_fwd(const std::vector<std::int32_t>& local_data,
   scatter_fwd_impl(local_data, remote_data, n);
 }
 //-----------------------------------------------------------------------------
+void IndexMap::scatter_fwd(const std::vector<double>& local_data,
+                           std::vector<double>& remote_data, int n) const
+{
+  scatter_fwd_impl(local_data, remote_data, n);
+}
+//-----------------------------------------------------------------------------
+void IndexMap::scatter_fwd(const std::vector<std::complex<double>>& local_data,
+                           std::vector<std::complex<double>>& remote_data,
+                           int n) const
+{
+  scatter_fwd_impl(local_data, remote_data, n);
+}
+//-----------------------------------------------------------------------------
 std::vector<std::int64_t>
 IndexMap::scatter_fwd(const std::vector<std::int64_t>& local_data, int n) const
 {
@@ -806,122 +887,177 @@ void IndexMap::scatter_rev(std::vector<std::int32_t>& local_data,
   scatter_rev_impl(local_data, remote_data, n, op);
 }
 //-----------------------------------------------------------------------------
+void IndexMap::scatter_rev(std::vector<double>& local_data,
+                           const std::vector<double>& remote_data, int n,
+                           IndexMap::Mode op) const
+{
+  scatter_rev_impl(local_data, remote_data, n, op);
+}
+//-----------------------------------------------------------------------------
+void IndexMap::scatter_rev(
+    std::vector<std::complex<double>>& local_data,
+    const std::vector<std::complex<double>>& remote_data, int n,
+    IndexMap::Mode op) const
+{
+  scatter_rev_impl(local_data, remote_data, n, op);
+}
+//-----------------------------------------------------------------------------
 template <typename T>
-void IndexMap::scatter_fwd_impl(const std::vector<T>& local_data,
-                                std::vector<T>& remote_data, int n) const
+void IndexMap::create_scatter_plan(ScatterRequest<T>& request, int n,
+                                   Direction dir) const
 {
+  if (request.n == n and request.direction == dir)
+    return;
+
+  // Release the persistent request of an old plan
+  if (request.persistent and request.request != MPI_REQUEST_NULL)
+    MPI_Request_free(&request.request);
+  request.persistent = false;
+
+  MPI_Comm comm = dir == Direction::forward ? _comm_owner_to_ghost.comm()
+                                            : _comm_ghost_to_owner.comm();
 
   // Get number of neighbors
   int indegree(-1), outdegree(-2), weighted(-1);
-  MPI_Dist_graph_neighbors_count(_comm_owner_to_ghost.comm(), &indegree,
-                                 &outdegree, &weighted);
+  MPI_Dist_graph_neighbors_count(comm, &indegree, &outdegree, &weighted);
 
-  // Get neighbor processes
-  std::vector<int> neighbors_in(indegree), neighbors_out(outdegree);
-  MPI_Dist_graph_neighbors(_comm_owner_to_ghost.comm(), indegree,
-                           neighbors_in.data(), MPI_UNWEIGHTED, outdegree,
-                           neighbors_out.data(), MPI_UNWEIGHTED);
+  // Number of (blocked) ghost indices on each owning rank, and number
+  // of shared (blocked) indices for each ghosting rank
+  const int num_owners = dir == Direction::forward ? indegree : outdegree;
+  const int num_sharers = dir == Direction::forward ? outdegree : indegree;
+  std::vector<std::int32_t> ghost_sizes(num_owners, 0);
+  for (std::int32_t i = 0; i < _ghosts.size(); ++i)
+    ghost_sizes[_ghost_owners[i]] += n;
+  std::vector<std::int32_t> shared_sizes(num_sharers);
+  for (int i = 0; i < num_sharers; ++i)
+    shared_sizes[i] = (_shared_disp[i + 1] - _shared_disp[i]) * n;
+
+  // Position of each ghost index in the buffer for the owning ranks
+  std::vector<std::int32_t> ghost_disp(num_owners + 1, 0);
+  std::partial_sum(ghost_sizes.begin(), ghost_sizes.end(),
+                   ghost_disp.begin() + 1);
+  request.ghost_pos.resize(_ghosts.size());
+  for (std::int32_t i = 0; i < _ghosts.size(); ++i)
+  {
+    const int np = _ghost_owners[i];
+    request.ghost_pos[i] = ghost_disp[np] / n;
+    ghost_disp[np] += n;
+  }
 
-  const std::int32_t _size_local = size_local();
-  assert((int)local_data.size() == n * _size_local);
-  remote_data.resize(n * _ghosts.size());
+  if (dir == Direction::forward)
+  {
+    request.send_sizes = std::move(shared_sizes);
+    request.recv_sizes = std::move(ghost_sizes);
+  }
+  else
+  {
+    request.send_sizes = std::move(ghost_sizes);
+    request.recv_sizes = std::move(shared_sizes);
+  }
 
-  // Create displacement vectors
-  std::vector<std::int32_t> sizes_recv(indegree, 0);
-  for (std::int32_t i = 0; i < _ghosts.size(); ++i)
-    sizes_recv[_ghost_owners[i]] += n;
-
-  std::vector displs_send = _shared_disp;
-  std::transform(displs_send.begin(), displs_send.end(), displs_send.begin(),
-                 std::bind(std::multiplies<T>(), std::placeholders::_1, n));
-  std::vector<std::int32_t> sizes_send(outdegree, 0);
-  std::adjacent_difference(displs_send.begin() + 1, displs_send.end(),
-                           sizes_send.begin());
-  std::vector<std::int32_t> displs_recv(indegree + 1, 0);
-  std::partial_sum(sizes_recv.begin(), sizes_recv.end(),
-                   displs_recv.begin() + 1);
+  // Create displacement vectors and buffers
+  request.displs_send.assign(outdegree + 1, 0);
+  std::partial_sum(request.send_sizes.begin(), request.send_sizes.end(),
+                   request.displs_send.begin() + 1);
+  request.displs_recv.assign(indegree + 1, 0);
+  std::partial_sum(request.recv_sizes.begin(), request.recv_sizes.end(),
+                   request.displs_recv.begin() + 1);
+  request.send_data.resize(request.displs_send.back());
+  request.recv_data.resize(request.displs_recv.back());
+
+  request.direction = dir;
+  request.n = n;
+
+#if MPI_VERSION >= 4
+  // Create a persistent request for the communication
+  MPI_Neighbor_alltoallv_init(
+      request.send_data.data(), request.send_sizes.data(),
+      request.displs_send.data(), MPI::mpi_type<T>(),
+      request.recv_data.data(), request.recv_sizes.data(),
+      request.displs_recv.data(), MPI::mpi_type<T>(), comm, MPI_INFO_NULL,
+      &request.request);
+  request.persistent = true;
+#endif
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void IndexMap::scatter_fwd_begin(const T* local_data, int n,
+                                 ScatterRequest<T>& request) const
+{
+  assert(request.persistent or request.request == MPI_REQUEST_NULL);
+  create_scatter_plan(request, n, Direction::forward);
 
   // Copy into sending buffer
-  std::vector<T> data_to_send(displs_send.back());
   for (std::size_t i = 0; i < _shared_indices.size(); ++i)
   {
     const int index = _shared_indices[i];
-    for (int j = 0; j < n; ++j)
-      data_to_send[i * n + j] = local_data[index * n + j];
+    std::copy_n(local_data + index * n, n, request.send_data.data() + i * n);
   }
 
-  // Send/receive data
-  std::vector<T> data_to_recv(displs_recv.back());
-  MPI_Neighbor_alltoallv(
-      data_to_send.data(), sizes_send.data(), displs_send.data(),
-      MPI::mpi_type<T>(), data_to_recv.data(), sizes_recv.data(),
-      displs_recv.data(), MPI::mpi_type<T>(), _comm_owner_to_ghost.comm());
+  // Start sending and receiving data
+  start_scatter(request, _comm_owner_to_ghost.comm());
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void IndexMap::scatter_fwd_end(T* remote_data,
+                               ScatterRequest<T>& request) const
+{
+  assert(request.direction == Direction::forward);
+  const int n = request.n;
+
+  // Wait for the data
+  {
+    common::CommProfiler::Scope profile("IndexMap::scatter_fwd");
+    profile.set(request.send_sizes.size(),
+                sizeof(T) * request.send_data.size(),
+                sizeof(T) * request.recv_data.size());
+    MPI_Wait(&request.request, MPI_STATUS_IGNORE);
+  }
 
   // Copy into ghost area ("remote_data")
-  std::vector<std::int32_t> displs(displs_recv);
-  for (int i = 0; i < _ghosts.size(); ++i)
+  const std::vector<std::int32_t>& ghost_pos = request.ghost_pos;
+  for (std::size_t i = 0; i < ghost_pos.size(); ++i)
   {
-    const int np = _ghost_owners[i];
-    for (int j = 0; j < n; ++j)
-      remote_data[i * n + j] = data_to_recv[displs[np] + j];
-    displs[np] += n;
+    std::copy_n(request.recv_data.data() + ghost_pos[i] * n, n,
+                remote_data + i * n);
   }
 }
 //-----------------------------------------------------------------------------
 template <typename T>
-void IndexMap::scatter_rev_impl(std::vector<T>& local_data,
-                                const std::vector<T>& remote_data, int n,
-                                IndexMap::Mode op) const
+void IndexMap::scatter_rev_begin(const T* remote_data, int n,
+                                 ScatterRequest<T>& request) const
 {
-  assert((std::int32_t)remote_data.size() == n * num_ghosts());
-  local_data.resize(n * size_local(), 0);
-
-  // Get number of neighbors
-  int indegree(-1), outdegree(-2), weighted(-1);
-  MPI_Dist_graph_neighbors_count(_comm_ghost_to_owner.comm(), &indegree,
-                                 &outdegree, &weighted);
-
-  // Get neighbor processes
-  std::vector<int> neighbors_in(indegree), neighbors_out(outdegree);
-  MPI_Dist_graph_neighbors(_comm_ghost_to_owner.comm(), indegree,
-                           neighbors_in.data(), MPI_UNWEIGHTED, outdegree,
-                           neighbors_out.data(), MPI_UNWEIGHTED);
-
-  // Compute number of items to send to each process
-  std::vector<std::int32_t> send_sizes(outdegree, 0);
-  std::vector<std::int32_t> recv_sizes(indegree, 0);
-  for (int i = 0; i < _ghosts.size(); ++i)
-    send_sizes[_ghost_owners[i]] += n;
+  assert(request.persistent or request.request == MPI_REQUEST_NULL);
+  create_scatter_plan(request, n, Direction::reverse);
 
-  // Create displacement vectors
-  std::vector<std::int32_t> displs_send(outdegree + 1, 0);
-  std::vector<std::int32_t> displs_recv(indegree + 1, 0);
-  for (int i = 0; i < indegree; ++i)
+  // Fill sending data
+  const std::vector<std::int32_t>& ghost_pos = request.ghost_pos;
+  for (std::size_t i = 0; i < ghost_pos.size(); ++i)
   {
-    recv_sizes[i] = (_shared_disp[i + 1] - _shared_disp[i]) * n;
-    displs_recv[i + 1] = displs_recv[i] + recv_sizes[i];
+    std::copy_n(remote_data + i * n, n,
+                request.send_data.data() + ghost_pos[i] * n);
   }
 
-  for (int i = 0; i < outdegree; ++i)
-    displs_send[i + 1] = displs_send[i] + send_sizes[i];
+  // Start sending and receiving data
+  start_scatter(request, _comm_ghost_to_owner.comm());
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void IndexMap::scatter_rev_end(T* local_data, IndexMap::Mode op,
+                               ScatterRequest<T>& request) const
+{
+  assert(request.direction == Direction::reverse);
+  const int n = request.n;
 
-  // Fill sending data
-  std::vector<T> send_data(displs_send.back());
-  std::vector<std::int32_t> displs(displs_send);
-  for (std::int32_t i = 0; i < _ghosts.size(); ++i)
+  // Wait for the data
   {
-    const int np = _ghost_owners[i];
-    for (std::int32_t j = 0; j < n; ++j)
-      send_data[displs[np] + j] = remote_data[i * n + j];
-    displs[np] += n;
+    common::CommProfiler::Scope profile("IndexMap::scatter_rev");
+    profile.set(request.send_sizes.size(),
+                sizeof(T) * request.send_data.size(),
+                sizeof(T) * request.recv_data.size());
+    MPI_Wait(&request.request, MPI_STATUS_IGNORE);
   }
-
-  // Send and receive data
-  std::vector<T> recv_data(displs_recv.back());
-  MPI_Neighbor_alltoallv(
-      send_data.data(), send_sizes.data(), displs_send.data(),
-      MPI::mpi_type<T>(), recv_data.data(), recv_sizes.data(),
-      displs_recv.data(), MPI::mpi_type<T>(), _comm_ghost_to_owner.comm());
+  const std::vector<T>& recv_data = request.recv_data;
 
   // Copy or accumulate into "local_data"
   if (op == Mode::insert)
@@ -944,3 +1080,45 @@ void IndexMap::scatter_rev_impl(std::vector<T>& local_data,
   }
 }
 //-----------------------------------------------------------------------------
+template <typename T>
+void IndexMap::scatter_fwd_impl(const std::vector<T>& local_data,
+                                std::vector<T>& remote_data, int n) const
+{
+  assert((std::int32_t)local_data.size() == n * size_local());
+  remote_data.resize(n * _ghosts.size());
+  ScatterRequest<T> request;
+  scatter_fwd_begin(local_data.data(), n, request);
+  scatter_fwd_end(remote_data.data(), request);
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void IndexMap::scatter_rev_impl(std::vector<T>& local_data,
+                                const std::vector<T>& remote_data, int n,
+                                IndexMap::Mode op) const
+{
+  assert((std::int32_t)remote_data.size() == n * num_ghosts());
+  local_data.resize(n * size_local(), 0);
+  ScatterRequest<T> request;
+  scatter_rev_begin(remote_data.data(), n, request);
+  scatter_rev_end(local_data.data(), op, request);
+}
+//-----------------------------------------------------------------------------
+// Explicit instantiations of the split-phase scatters
+/// @cond
+#define INSTANTIATE_SCATTER(T)                                                 \
+  template void IndexMap::scatter_fwd_begin(const T*, int,                     \
+                                            ScatterRequest<T>&) const;         \
+  template void IndexMap::scatter_fwd_end(T*, ScatterRequest<T>&) const;       \
+  template void IndexMap::scatter_rev_begin(const T*, int,                     \
+                                            ScatterRequest<T>&) const;         \
+  template void IndexMap::scatter_rev_end(T*, IndexMap::Mode,                  \
+                                          ScatterRequest<T>&) const;
+INSTANTIATE_SCATTER(std::int32_t)
+INSTANTIATE_SCATTER(std::int64_t)
+INSTANTIATE_SCATTER(float)
+INSTANTIATE_SCATTER(double)
+INSTANTIATE_SCATTER(std::complex<float>)
+INSTANTIATE_SCATTER(std::complex<double>)
+#undef INSTANTIATE_SCATTER
+/// @endcond
+//-----------------------------------------------------------------------------
@@ -7,11 +7,16 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <algorithm>
 #include <array>
+#include <complex>
 #include <cstdint>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/graph/AdjacencyList.h>
 #include <map>
+#include <memory>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 namespace dolfinx::common
@@ -59,6 +64,130 @@ public:
     symmetric // Symmetric. NOTE: To be removed
   };
 
+  /// Local indices (owned and ghost) that are shared with other ranks,
+  /// and the ranks that share each index, in compressed (CSR) form
+  struct SharedIndices
+  {
+    /// Sorted list of the shared local indices
+    std::vector<std::int32_t> indices;
+
+    /// Ranks (on the global communicator) other than the caller that
+    /// share each index, i.e. ranks.links(i) are the ranks that share
+    /// indices[i]. The ranks of an index are sorted.
+    graph::AdjacencyList<int> ranks;
+
+    /// Position of a local index in indices
+    /// @param[in] idx The local index
+    /// @return The position of @p idx in indices, or -1 if @p idx is
+    ///   not shared
+    std::int32_t find(std::int32_t idx) const
+    {
+      auto it = std::lower_bound(indices.begin(), indices.end(), idx);
+      if (it != indices.end() and *it == idx)
+        return std::distance(indices.begin(), it);
+      else
+        return -1;
+    }
+  };
+
+  /// Scatter plan and communication state of a split-phase
+  /// (non-blocking) scatter, see scatter_fwd_begin and
+  /// scatter_rev_begin. The plan (buffer sizes, displacements and
+  /// pack/unpack positions) is created by the first scatter and reused
+  /// by later scatters with the same direction and number of items per
+  /// index, so a request should be kept and reused for repeated
+  /// scatters of the same kind. If the MPI library supports MPI-4
+  /// persistent neighbourhood collectives the plan also holds a
+  /// persistent MPI request. A request must only be used with one
+  /// IndexMap. The buffers must not be modified until the scatter has
+  /// been completed.
+  template <typename T>
+  struct ScatterRequest
+  {
+    /// Create an empty request. The plan is created by the first
+    /// scatter.
+    ScatterRequest() = default;
+
+    /// Copy constructor. The plan is not copied (a persistent MPI
+    /// request refers to the buffers of the original), and the copy
+    /// creates a new plan when it is first used.
+    ScatterRequest(const ScatterRequest&) {}
+
+    /// Move constructor
+    ScatterRequest(ScatterRequest&& r) noexcept
+        : request(r.request), direction(r.direction), n(r.n),
+          persistent(r.persistent), send_data(std::move(r.send_data)),
+          recv_data(std::move(r.recv_data)),
+          send_sizes(std::move(r.send_sizes)),
+          displs_send(std::move(r.displs_send)),
+          recv_sizes(std::move(r.recv_sizes)),
+          displs_recv(std::move(r.displs_recv)),
+          ghost_pos(std::move(r.ghost_pos))
+    {
+      r.request = MPI_REQUEST_NULL;
+      r.n = 0;
+      r.persistent = false;
+    }
+
+    /// Destructor
+    ~ScatterRequest()
+    {
+      if (persistent and request != MPI_REQUEST_NULL)
+        MPI_Request_free(&request);
+    }
+
+    /// Assignment operator (disabled)
+    ScatterRequest& operator=(const ScatterRequest&) = delete;
+
+    /// Move assignment operator
+    ScatterRequest& operator=(ScatterRequest&& r) noexcept
+    {
+      ScatterRequest tmp(std::move(r));
+      std::swap(request, tmp.request);
+      std::swap(direction, tmp.direction);
+      std::swap(n, tmp.n);
+      std::swap(persistent, tmp.persistent);
+      send_data.swap(tmp.send_data);
+      recv_data.swap(tmp.recv_data);
+      send_sizes.swap(tmp.send_sizes);
+      displs_send.swap(tmp.displs_send);
+      recv_sizes.swap(tmp.recv_sizes);
+      displs_recv.swap(tmp.displs_recv);
+      ghost_pos.swap(tmp.ghost_pos);
+      return *this;
+    }
+
+    /// MPI request of the neighbourhood communication. For a persistent
+    /// plan it is an inactive persistent request between scatters.
+    MPI_Request request = MPI_REQUEST_NULL;
+
+    /// Direction of the plan
+    Direction direction = Direction::forward;
+
+    /// Number of data items per index of the plan, 0 if no plan has
+    /// been created
+    int n = 0;
+
+    /// True if request is a persistent MPI request
+    bool persistent = false;
+
+    /// Send buffer, ordered by destination rank
+    std::vector<T> send_data;
+
+    /// Receive buffer, ordered by source rank
+    std::vector<T> recv_data;
+
+    /// Send and receive sizes and displacements
+    std::vector<std::int32_t> send_sizes, displs_send, recv_sizes,
+        displs_recv;
+
+    /// Position (in blocks of n items) of each ghost index in the
+    /// buffer that is exchanged with the owning ranks, i.e. the
+    /// receive buffer of a forward and the send buffer of a reverse
+    /// scatter
+    std::vector<std::int32_t> ghost_pos;
+  };
+
   /// Create an non-overlapping index map with local_size owned blocks on this
   /// process.
   ///
@@ -198,6 +327,20 @@ public:
   /// @return List of indices that are ghosted on other processes
   const std::vector<std::int32_t>& shared_indices() const;
 
+  /// Offsets of the indices in shared_indices() that are ghosted on
+  /// each destination rank of the forward (owner to ghost)
+  /// communicator, i.e. the indices that are ghosted on the ith
+  /// destination rank are shared_indices()[j] for offsets[i] <= j <
+  /// offsets[i + 1]
+  /// @return The offsets (number of destination ranks plus one)
+  const std::vector<std::int32_t>& shared_indices_offsets() const;
+
+  /// Memory used by the process-local data of the map (ghost indices,
+  /// ghost owners and shared indices). Memory used by the MPI
+  /// communicators is not included.
+  /// @return Memory usage in bytes
+  std::size_t memory_usage() const;
+
   /// Owner rank (on global communicator) of each ghost entry
   Eigen::Array<int, Eigen::Dynamic, 1> ghost_owner_rank() const;
 
@@ -206,13 +349,15 @@ public:
   Eigen::Array<std::int64_t, Eigen::Dynamic, 1>
   indices(bool unroll_block) const;
 
-  /// @todo Aim to remove this function? If it's kept, should it work
-  /// with neighborhood ranks?
+  /// Local indices (owned and ghost) that are shared with other ranks,
+  /// and the sharing ranks. An owned index is shared with the ranks
+  /// that have it as a ghost, and a ghost index with its owner and the
+  /// other ranks that have it as a ghost. The data is computed on first
+  /// call and cached.
   ///
-  /// Compute map from each local (owned) index to the set of ranks that
-  /// have the index as a ghost
-  /// @return shared indices
-  std::map<std::int32_t, std::set<int>> compute_shared_indices() const;
+  /// @note Collective on first call
+  /// @return The shared indices and their sharing ranks
+  const SharedIndices& shared_index_ranks() const;
 
   /// Send n values for each index that is owned to processes that have
   /// the index as a ghost. The size of the input array local_data must
@@ -265,6 +410,33 @@ public:
   std::vector<std::int32_t>
   scatter_fwd(const std::vector<std::int32_t>& local_data, int n) const;
 
+  /// Send n values for each index that is owned to processes that have
+  /// the index as a ghost. The size of the input array local_data must
+  /// be the same as n * size_local().
+  ///
+  /// @param[in] local_data Local data associated with each owned local
+  ///   index to be sent to process where the data is ghosted. Size must
+  ///   be n * size_local().
+  /// @param[in,out] remote_data Ghost data on this process received
+  ///   from the owning process. Size will be n * num_ghosts().
+  /// @param[in] n Number of data items per index
+  void scatter_fwd(const std::vector<double>& local_data,
+                   std::vector<double>& remote_data, int n) const;
+
+  /// Send n values for each index that is owned to processes that have
+  /// the index as a ghost. The size of the input array local_data must
+  /// be the same as n * size_local().
+  ///
+  /// @param[in] local_data Local data associated with each owned local
+  ///   index to be sent to process where the data is ghosted. Size must
+  ///   be n * size_local().
+  /// @param[in,out] remote_data Ghost data on this process received
+  ///   from the owning process. Size will be n * num_ghosts().
+  /// @param[in] n Number of data items per index
+  void scatter_fwd(const std::vector<std::complex<double>>& local_data,
+                   std::vector<std::complex<double>>& remote_data,
+                   int n) const;
+
   /// Send n values for each ghost index to owning to the process
   ///
   /// @param[in,out] local_data Local data associated with each owned
@@ -291,6 +463,88 @@ public:
                    const std::vector<std::int32_t>& remote_data, int n,
                    IndexMap::Mode op) const;
 
+  /// Send n values for each ghost index to owning to the process
+  ///
+  /// @param[in,out] local_data Local data associated with each owned
+  ///   local index to be sent to process where the data is ghosted.
+  ///   Size must be n * size_local().
+  /// @param[in] remote_data Ghost data on this process received from
+  ///   the owning process. Size will be n * num_ghosts().
+  /// @param[in] n Number of data items per index
+  /// @param[in] op Sum or set received values in local_data
+  void scatter_rev(std::vector<double>& local_data,
+                   const std::vector<double>& remote_data, int n,
+                   IndexMap::Mode op) const;
+
+  /// Send n values for each ghost index to owning to the process
+  ///
+  /// @param[in,out] local_data Local data associated with each owned
+  ///   local index to be sent to process where the data is ghosted.
+  ///   Size must be n * size_local().
+  /// @param[in] remote_data Ghost data on this process received from
+  ///   the owning process. Size will be n * num_ghosts().
+  /// @param[in] n Number of data items per index
+  /// @param[in] op Sum or set received values in local_data
+  void scatter_rev(std::vector<std::complex<double>>& local_data,
+                   const std::vector<std::complex<double>>& remote_data,
+                   int n, IndexMap::Mode op) const;
+
+  /// Start a non-blocking forward scatter, i.e. start sending n
+  /// values for each owned index to the processes that have the index
+  /// as a ghost. The values are copied into a send buffer, so
+  /// local_data can be modified after the call. Complete with
+  /// scatter_fwd_end. Local work can be done in between to overlap it
+  /// with the communication.
+  ///
+  /// @note Collective
+  /// @param[in] local_data Data for each owned index, an array of size
+  ///   n * size_local()
+  /// @param[in] n Number of data items per index
+  /// @param[in,out] request The scatter plan and communication state.
+  ///   A plan is created if it does not hold one for this scatter.
+  template <typename T>
+  void scatter_fwd_begin(const T* local_data, int n,
+                         ScatterRequest<T>& request) const;
+
+  /// Complete a non-blocking forward scatter started with
+  /// scatter_fwd_begin
+  ///
+  /// @param[out] remote_data Data for each ghost index received from
+  ///   the owning processes, an array of size n * num_ghosts(), e.g.
+  ///   the ghost region of a vector
+  /// @param[in,out] request The communication state from
+  ///   scatter_fwd_begin
+  template <typename T>
+  void scatter_fwd_end(T* remote_data, ScatterRequest<T>& request) const;
+
+  /// Start a non-blocking reverse scatter, i.e. start sending n values
+  /// for each ghost index to the owning process. The values are copied
+  /// into a send buffer, so remote_data can be modified after the
+  /// call. Complete with scatter_rev_end. Local work can be done in
+  /// between to overlap it with the communication.
+  ///
+  /// @note Collective
+  /// @param[in] remote_data Data for each ghost index, an array of size
+  ///   n * num_ghosts(), e.g. the ghost region of a vector
+  /// @param[in] n Number of data items per index
+  /// @param[in,out] request The scatter plan and communication state.
+  ///   A plan is created if it does not hold one for this scatter.
+  template <typename T>
+  void scatter_rev_begin(const T* remote_data, int n,
+                         ScatterRequest<T>& request) const;
+
+  /// Complete a non-blocking reverse scatter started with
+  /// scatter_rev_begin
+  ///
+  /// @param[in,out] local_data Data for each owned index, an array of
+  ///   size n * size_local()
+  /// @param[in] op Sum or set received values in local_data
+  /// @param[in,out] request The communication state from
+  ///   scatter_rev_begin
+  template <typename T>
+  void scatter_rev_end(T* local_data, IndexMap::Mode op,
+                       ScatterRequest<T>& request) const;
+
 private:
   int _block_size;
 
@@ -344,6 +598,16 @@ private:
   // rank i, where i is the ith outgoing edge on _comm_owner_to_ghost.
   std::vector<std::int32_t> _shared_disp;
 
+  // Shared (owned and ghost) indices and their sharing ranks (cache,
+  // computed on first use)
+  mutable std::shared_ptr<const SharedIndices> _shared_index_ranks;
+
+  // Create the plan of request for a scatter in direction dir with n
+  // data items per index, unless request already holds such a plan
+  template <typename T>
+  void create_scatter_plan(ScatterRequest<T>& request, int n,
+                           Direction dir) const;
+
   template <typename T>
   void scatter_fwd_impl(const std::vector<T>& local_data,
                         std::vector<T>& remote_data, int n) const;
@@ -139,21 +139,68 @@ int dolfinx::MPI::index_owner(int size, std::size_t index, std::size_t N)
 std::vector<int> dolfinx::MPI::compute_graph_edges(MPI_Comm comm,
                                                    const std::set<int>& edges)
 {
-  // Send '1' to ranks that I have a edge to
-  std::vector<std::uint8_t> edge_count(dolfinx::MPI::size(comm), 0);
-  for (auto e : edges)
-    edge_count[e] = 1;
-  std::vector<std::uint8_t> in_edge_count(dolfinx::MPI::size(comm), -1);
-  MPI_Alltoall(edge_count.data(), 1, MPI_UINT8_T, in_edge_count.data(), 1,
-               MPI_UINT8_T, comm);
+  // Non-blocking consensus (NBX) algorithm, see T. Hoefler, C. Siebert
+  // and A. Lumsdaine, "Scalable communication protocols for dynamic
+  // sparse data exchange", PPoPP 2010. A synchronous send is posted to
+  // each rank that I have an edge to. Incoming messages are received
+  // until all my sends have been matched, after which a non-blocking
+  // barrier is entered. When the barrier completes all messages have
+  // been received. The messages are exchanged on a duplicate of the
+  // communicator so that they cannot be matched by a later call on a
+  // rank that is slow to detect the completion of the barrier.
+  MPI_Comm comm_nbx;
+  MPI_Comm_dup(comm, &comm_nbx);
+  constexpr int tag = 0;
+  std::uint8_t send_value = 1;
+  std::vector<MPI_Request> send_requests(edges.size());
+  std::size_t r = 0;
+  for (int e : edges)
+  {
+    MPI_Issend(&send_value, 1, MPI_UINT8_T, e, tag, comm_nbx,
+               &send_requests[r++]);
+  }
 
-  // Build list of rank that had an edge to me
   std::vector<int> edges1;
-  for (std::size_t i = 0; i < in_edge_count.size(); ++i)
+  MPI_Request barrier_request;
+  bool barrier_active = false;
+  while (true)
   {
-    if (in_edge_count[i] > 0)
-      edges1.push_back(i);
+    // Receive an incoming edge, if any
+    int flag = 0;
+    MPI_Status status;
+    MPI_Iprobe(MPI_ANY_SOURCE, tag, comm_nbx, &flag, &status);
+    if (flag)
+    {
+      std::uint8_t recv_value;
+      MPI_Recv(&recv_value, 1, MPI_UINT8_T, status.MPI_SOURCE, tag,
+               comm_nbx, MPI_STATUS_IGNORE);
+      edges1.push_back(status.MPI_SOURCE);
+    }
+
+    if (barrier_active)
+    {
+      int barrier_done = 0;
+      MPI_Test(&barrier_request, &barrier_done, MPI_STATUS_IGNORE);
+      if (barrier_done)
+        break;
+    }
+    else
+    {
+      int sends_done = 0;
+      MPI_Testall(send_requests.size(), send_requests.data(), &sends_done,
+                  MPI_STATUSES_IGNORE);
+      if (sends_done)
+      {
+        MPI_Ibarrier(comm_nbx, &barrier_request);
+        barrier_active = true;
+      }
+    }
   }
+
+  MPI_Comm_free(&comm_nbx);
+
+  // Build list of rank that had an edge to me
+  std::sort(edges1.begin(), edges1.end());
   return edges1;
 }
 //-----------------------------------------------------------------------------
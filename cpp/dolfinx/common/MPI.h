@@ -11,6 +11,7 @@
 #include <cassert>
 #include <complex>
 #include <cstdint>
+#include <dolfinx/common/CommProfiler.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <iostream>
 #include <numeric>
@@ -69,18 +70,43 @@ public:
   static int size(MPI_Comm comm);
 
   /// Send in_values[p0] to process p0 and receive values from process
-  /// p1 in out_values[p1]
+  /// p1 in out_values[p1]. Only ranks that exchange data communicate
+  /// (see sparse_exchange), but the send and receive lists have a node
+  /// per rank, which costs O(size) memory on each rank. Use
+  /// sparse_exchange if the destinations are known.
   template <typename T>
   static graph::AdjacencyList<T>
   all_to_all(MPI_Comm comm, const graph::AdjacencyList<T>& send_data);
 
+  /// Sparse dynamic data exchange: send send_data.links(i) to rank
+  /// dests[i] and receive the messages that other ranks send to this
+  /// rank, without knowing the sources in advance. The messages carry
+  /// the data in the non-blocking consensus (NBX) algorithm of
+  /// compute_graph_edges, such that the cost scales with the number of
+  /// messages rather than the size of the communicator. Empty messages
+  /// are not sent.
+  ///
+  /// @note This function is collective
+  ///
+  /// @param[in] comm The MPI communicator
+  /// @param[in] dests The destination ranks, without duplicates
+  /// @param[in] send_data The data for each destination rank
+  /// @return The ranks that sent data to this rank in ascending order,
+  ///   and the data received from each of them
+  template <typename T>
+  static std::pair<std::vector<int>, graph::AdjacencyList<T>>
+  sparse_exchange(MPI_Comm comm, const std::vector<int>& dests,
+                  const graph::AdjacencyList<T>& send_data);
+
   /// @todo Experimental. Maybe be moved or removed.
   ///
   /// Compute communication graph edges. The caller provides edges that
   /// it can define, and will receive edges to it that are defined by
   /// other ranks.
   ///
-  /// @note This function involves global communication
+  /// @note This function is collective, but the cost scales with the
+  ///   number of edges rather than the size of the communicator (it
+  ///   uses the non-blocking consensus algorithm)
   ///
   /// @param[in] comm The MPI communicator
   /// @param[in] edges Communication edges between the caller and the
@@ -152,6 +178,11 @@ inline MPI_Datatype MPI::mpi_type<double>()
   return MPI_DOUBLE;
 }
 template <>
+inline MPI_Datatype MPI::mpi_type<std::complex<float>>()
+{
+  return MPI_C_FLOAT_COMPLEX;
+}
+template <>
 inline MPI_Datatype MPI::mpi_type<std::complex<double>>()
 {
   return MPI_DOUBLE_COMPLEX;
@@ -203,37 +234,120 @@ graph::AdjacencyList<T>
 dolfinx::MPI::all_to_all(MPI_Comm comm,
                          const graph::AdjacencyList<T>& send_data)
 {
+  const int comm_size = MPI::size(comm);
+  assert(send_data.num_nodes() == comm_size);
+
+  // Send the data for rank p to rank p. Empty messages are skipped.
+  std::vector<int> ranks(comm_size);
+  std::iota(ranks.begin(), ranks.end(), 0);
+  auto [srcs, recv_data] = sparse_exchange(comm, ranks, send_data);
+
+  // Compute receive offset for all ranks. The sources are sorted, so
+  // the data is received in rank order.
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> recv_offset
+      = Eigen::Array<std::int32_t, Eigen::Dynamic, 1>::Zero(comm_size + 1);
+  for (std::size_t i = 0; i < srcs.size(); ++i)
+    recv_offset[srcs[i] + 1] = recv_data.num_links(i);
+  std::partial_sum(recv_offset.data(), recv_offset.data() + recv_offset.rows(),
+                   recv_offset.data());
+
+  return graph::AdjacencyList<T>(recv_data.array(), std::move(recv_offset));
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+std::pair<std::vector<int>, graph::AdjacencyList<T>>
+dolfinx::MPI::sparse_exchange(MPI_Comm comm, const std::vector<int>& dests,
+                              const graph::AdjacencyList<T>& send_data)
+{
+  common::CommProfiler::Scope profile("MPI::sparse_exchange");
+  assert(send_data.num_nodes() == (std::int32_t)dests.size());
   const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& send_offsets
       = send_data.offsets();
   const Eigen::Array<T, Eigen::Dynamic, 1>& values_in = send_data.array();
 
-  const int comm_size = MPI::size(comm);
-  assert(send_data.num_nodes() == comm_size);
+  // Non-blocking consensus (NBX) as in compute_graph_edges, with the
+  // data in the synchronous sends. A send completes when it has been
+  // matched by a receive, so once all sends of all ranks have completed
+  // (barrier) all messages have been received.
+  MPI_Comm comm_nbx;
+  MPI_Comm_dup(comm, &comm_nbx);
+  constexpr int tag = 0;
+  std::vector<MPI_Request> send_requests;
+  send_requests.reserve(dests.size());
+  for (std::size_t i = 0; i < dests.size(); ++i)
+  {
+    const int count = send_offsets[i + 1] - send_offsets[i];
+    if (count > 0)
+    {
+      send_requests.emplace_back();
+      MPI_Issend(values_in.data() + send_offsets[i], count, mpi_type<T>(),
+                 dests[i], tag, comm_nbx, &send_requests.back());
+    }
+  }
 
-  // Data size per destination rank
-  std::vector<int> send_size(comm_size);
-  std::adjacent_difference(send_offsets.data() + 1,
-                           send_offsets.data() + send_offsets.rows(),
-                           send_size.begin());
-
-  // Get received data sizes from each rank
-  std::vector<int> recv_size(comm_size);
-  MPI_Alltoall(send_size.data(), 1, mpi_type<int>(), recv_size.data(), 1,
-               mpi_type<int>(), comm);
-
-  // Compute receive offset
-  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> recv_offset(comm_size + 1);
-  recv_offset(0) = 0;
-  std::partial_sum(recv_size.begin(), recv_size.end(), recv_offset.data() + 1);
-
-  // Send/receive data
-  Eigen::Array<T, Eigen::Dynamic, 1> recv_values(recv_offset(comm_size));
-  MPI_Alltoallv(values_in.data(), send_size.data(), send_offsets.data(),
-                mpi_type<T>(), recv_values.data(), recv_size.data(),
-                recv_offset.data(), mpi_type<T>(), comm);
-
-  return graph::AdjacencyList<T>(std::move(recv_values),
-                                 std::move(recv_offset));
+  std::vector<std::pair<int, Eigen::Array<T, Eigen::Dynamic, 1>>> messages;
+  MPI_Request barrier_request;
+  bool barrier_active = false;
+  while (true)
+  {
+    // Receive an incoming message, if any
+    int flag = 0;
+    MPI_Status status;
+    MPI_Iprobe(MPI_ANY_SOURCE, tag, comm_nbx, &flag, &status);
+    if (flag)
+    {
+      int count = 0;
+      MPI_Get_count(&status, mpi_type<T>(), &count);
+      Eigen::Array<T, Eigen::Dynamic, 1> buffer(count);
+      MPI_Recv(buffer.data(), count, mpi_type<T>(), status.MPI_SOURCE, tag,
+               comm_nbx, MPI_STATUS_IGNORE);
+      messages.emplace_back(status.MPI_SOURCE, std::move(buffer));
+    }
+
+    if (barrier_active)
+    {
+      int barrier_done = 0;
+      MPI_Test(&barrier_request, &barrier_done, MPI_STATUS_IGNORE);
+      if (barrier_done)
+        break;
+    }
+    else
+    {
+      int sends_done = 0;
+      MPI_Testall(send_requests.size(), send_requests.data(), &sends_done,
+                  MPI_STATUSES_IGNORE);
+      if (sends_done)
+      {
+        MPI_Ibarrier(comm_nbx, &barrier_request);
+        barrier_active = true;
+      }
+    }
+  }
+  MPI_Comm_free(&comm_nbx);
+
+  // Order the messages by source rank
+  std::sort(messages.begin(), messages.end(),
+            [](auto& a, auto& b) { return a.first < b.first; });
+  std::vector<int> srcs(messages.size());
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> recv_offsets(messages.size()
+                                                             + 1);
+  recv_offsets[0] = 0;
+  for (std::size_t i = 0; i < messages.size(); ++i)
+  {
+    srcs[i] = messages[i].first;
+    recv_offsets[i + 1] = recv_offsets[i] + messages[i].second.rows();
+  }
+  Eigen::Array<T, Eigen::Dynamic, 1> recv_values(recv_offsets[messages.size()]);
+  for (std::size_t i = 0; i < messages.size(); ++i)
+  {
+    recv_values.segment(recv_offsets[i], messages[i].second.rows())
+        = messages[i].second;
+  }
+  profile.set(send_requests.size(), sizeof(T) * values_in.rows(),
+              sizeof(T) * recv_values.rows());
+
+  return {std::move(srcs), graph::AdjacencyList<T>(std::move(recv_values),
+                                                   std::move(recv_offsets))};
 }
 //-----------------------------------------------------------------------------
 template <typename T>
@@ -242,6 +356,8 @@ dolfinx::MPI::neighbor_all_to_all(MPI_Comm neighbor_comm,
                                   const std::vector<int>& send_offsets,
                                   const std::vector<T>& send_data)
 {
+  common::CommProfiler::Scope profile("MPI::neighbor_all_to_all");
+
   // Get neighbor processes
   int indegree(-1), outdegree(-2), weighted(-1);
   MPI_Dist_graph_neighbors_count(neighbor_comm, &indegree, &outdegree,
@@ -271,6 +387,8 @@ dolfinx::MPI::neighbor_all_to_all(MPI_Comm neighbor_comm,
       send_data.data(), send_sizes.data(), send_offsets.data(),
       MPI::mpi_type<T>(), recv_data.data(), recv_sizes.data(),
       recv_offsets.data(), MPI::mpi_type<T>(), neighbor_comm);
+  profile.set(outdegree, sizeof(T) * send_data.size(),
+              sizeof(T) * recv_data.rows());
 
   return graph::AdjacencyList<T>(std::move(recv_data), std::move(recv_offsets));
 }
@@ -0,0 +1,47 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "MemoryUsage.h"
+#include <algorithm>
+#include <fstream>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace dolfinx;
+using namespace dolfinx::common;
+
+//-----------------------------------------------------------------------------
+MemoryUsage::Sample MemoryUsage::read()
+{
+  Sample sample;
+#ifdef __linux__
+  // The second field is the resident set size in pages
+  std::ifstream statm("/proc/self/statm");
+  std::int64_t size = 0, resident = 0;
+  if (statm >> size >> resident)
+    sample.resident = resident * sysconf(_SC_PAGESIZE);
+#endif
+
+  // ru_maxrss is in bytes on macOS, and in kilobytes elsewhere
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+  {
+#ifdef __APPLE__
+    sample.peak = usage.ru_maxrss;
+#else
+    sample.peak = 1024 * static_cast<std::int64_t>(usage.ru_maxrss);
+#endif
+  }
+
+  return sample;
+}
+//-----------------------------------------------------------------------------
+MemoryUsage::Change MemoryUsage::change(const Sample& a, const Sample& b)
+{
+  return {b.resident - a.resident, std::max<std::int64_t>(b.peak - a.peak, 0),
+          b.peak};
+}
+//-----------------------------------------------------------------------------
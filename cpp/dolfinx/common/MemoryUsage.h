@@ -0,0 +1,56 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+
+namespace dolfinx::common
+{
+
+/// Memory usage of the calling process, sampled from the operating
+/// system. The resident set size (the physical memory of the process)
+/// is read from /proc/self/statm on Linux, and the high-water mark of
+/// the resident set size (its peak since the process started) with
+/// getrusage. The values are sizes in bytes, and zero where they
+/// cannot be read.
+
+namespace MemoryUsage
+{
+
+/// A sample of the memory usage of the process
+struct Sample
+{
+  /// Resident set size
+  std::int64_t resident = 0;
+
+  /// High-water mark of the resident set size
+  std::int64_t peak = 0;
+};
+
+/// The change of the memory usage of the process over an interval
+struct Change
+{
+  /// Increase of the resident set size, i.e. the memory allocated (and
+  /// touched) and not freed in the interval
+  std::int64_t resident = 0;
+
+  /// Increase of the high-water mark, i.e. the amount by which the
+  /// interval raised the peak memory usage of the process
+  std::int64_t peak_increase = 0;
+
+  /// High-water mark at the end of the interval
+  std::int64_t peak = 0;
+};
+
+/// Read the memory usage of the process
+Sample read();
+
+/// Return the change of the memory usage from sample a to sample b
+Change change(const Sample& a, const Sample& b);
+
+} // namespace MemoryUsage
+} // namespace dolfinx::common
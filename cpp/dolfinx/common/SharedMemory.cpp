@@ -0,0 +1,74 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "SharedMemory.h"
+#include <stdexcept>
+
+using namespace dolfinx;
+using namespace dolfinx::common;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Create the communicator of the processes of comm that can share
+// memory with this process
+MPI_Comm create_node_comm(MPI_Comm comm)
+{
+  MPI_Comm node_comm;
+  int err = MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED,
+                                dolfinx::MPI::rank(comm), MPI_INFO_NULL,
+                                &node_comm);
+  if (err != MPI_SUCCESS)
+  {
+    throw std::runtime_error(
+        "Creation of shared memory communicator failed (MPI_Comm_split_type)");
+  }
+  return node_comm;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+SharedMemory::SharedMemory(MPI_Comm comm, std::size_t size)
+    : _node_comm(create_node_comm(comm), false), _size(size)
+{
+  // The first process of the node allocates the memory, and the other
+  // processes query its address
+  const bool root = is_node_root();
+  int err = MPI_Win_allocate_shared(root ? size : 0, 1, MPI_INFO_NULL,
+                                    _node_comm.comm(), &_data, &_win);
+  if (err != MPI_SUCCESS)
+  {
+    throw std::runtime_error(
+        "Allocation of shared memory failed (MPI_Win_allocate_shared)");
+  }
+
+  if (!root)
+  {
+    MPI_Aint root_size;
+    int disp_unit;
+    MPI_Win_shared_query(_win, 0, &root_size, &disp_unit, &_data);
+  }
+}
+//-----------------------------------------------------------------------------
+SharedMemory::~SharedMemory() { MPI_Win_free(&_win); }
+//-----------------------------------------------------------------------------
+bool SharedMemory::is_node_root() const
+{
+  return dolfinx::MPI::rank(_node_comm.comm()) == 0;
+}
+//-----------------------------------------------------------------------------
+void SharedMemory::synchronize() const
+{
+  // Order the writes to the memory before the barrier and the reads
+  // after it (see the MPI-3 unified memory model)
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, _win);
+  MPI_Win_sync(_win);
+  MPI_Barrier(_node_comm.comm());
+  MPI_Win_sync(_win);
+  MPI_Win_unlock_all(_win);
+}
+//-----------------------------------------------------------------------------
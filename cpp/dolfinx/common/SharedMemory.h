@@ -0,0 +1,85 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <dolfinx/common/MPI.h>
+
+namespace dolfinx::common
+{
+
+/// Memory that is shared by the processes of a shared memory node, for
+/// read-only data that would otherwise be replicated on every process
+/// (e.g. the tree of the bounding boxes of all processes, see
+/// geometry::BoundingBoxTree::create_process_tree). The memory is
+/// allocated once per node, by the first process of the node, in an
+/// MPI-3 shared memory window (MPI_Win_allocate_shared) on the
+/// processes of a communicator that can share memory
+/// (MPI_COMM_TYPE_SHARED).
+///
+/// The data is typically written by the first process of the node
+/// (see is_node_root), followed by a call to synchronize, after which
+/// it is read by all processes of the node.
+///
+/// @note Creation and destruction are collective on the processes of
+///   the communicator that share a node
+
+class SharedMemory
+{
+public:
+  /// Allocate shared memory (collective)
+  /// @param[in] comm The MPI communicator. The memory is shared by the
+  ///   processes of the communicator on the same node
+  /// @param[in] size The size of the memory in bytes. It must be the
+  ///   same on the processes of a node.
+  SharedMemory(MPI_Comm comm, std::size_t size);
+
+  // Copying is not allowed
+  SharedMemory(const SharedMemory&) = delete;
+
+  // Copying is not allowed
+  SharedMemory& operator=(const SharedMemory&) = delete;
+
+  /// Destructor (frees the window, collective on the node)
+  ~SharedMemory();
+
+  /// The shared memory
+  /// @return Pointer to the memory, which is the same memory on all
+  ///   processes of the node
+  template <typename T>
+  T* data() const
+  {
+    return static_cast<T*>(_data);
+  }
+
+  /// The size of the memory in bytes
+  std::size_t size() const { return _size; }
+
+  /// True if this process is the first process of its node, which e.g.
+  /// writes the data
+  bool is_node_root() const;
+
+  /// Make the writes of a process to the memory visible to all
+  /// processes of the node (collective on the node)
+  void synchronize() const;
+
+  /// The communicator of the processes that share the memory
+  MPI_Comm node_comm() const { return _node_comm.comm(); }
+
+private:
+  // Communicator of the processes of the node
+  dolfinx::MPI::Comm _node_comm;
+
+  // Shared memory window
+  MPI_Win _win;
+
+  // The shared memory
+  void* _data = nullptr;
+  std::size_t _size;
+};
+
+} // namespace dolfinx::common
@@ -5,11 +5,16 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "SubSystemsManager.h"
+#include "ThreadPool.h"
+#include "TimeLogManager.h"
+#include <algorithm>
+#include <cstdlib>
 #include <dolfinx/common/log.h>
 #include <iostream>
 #include <mpi.h>
 #include <petscsys.h>
 #include <string>
+#include <thread>
 
 #ifdef HAS_SLEPC
 #include <slepcsys.h>
@@ -82,7 +87,13 @@ void SubSystemsManager::finalize_mpi()
     int mpi_finalized;
     MPI_Finalized(&mpi_finalized);
     if (!mpi_finalized)
+    {
+      // Write the trace of the timings, if requested
+      const std::string& trace_file = TimeLogManager::logger().trace_file();
+      if (!trace_file.empty())
+        TimeLogManager::logger().write_trace(MPI_COMM_WORLD, trace_file);
       MPI_Finalize();
+    }
     else
     {
       // Use std::cout since log system may fail because MPI has been shut down.
@@ -101,6 +112,48 @@ void SubSystemsManager::finalize_petsc()
 #endif
 }
 //-----------------------------------------------------------------------------
+void SubSystemsManager::init_threads(int num_threads)
+{
+  // The number of processes on the node of this process
+  int num_local_processes = 1;
+  if (mpi_initialized() and !mpi_finalized())
+  {
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0,
+                        MPI_INFO_NULL, &node_comm);
+    MPI_Comm_size(node_comm, &num_local_processes);
+    MPI_Comm_free(&node_comm);
+  }
+
+  // The processors of the node that this process may use. A process
+  // that is bound to a subset of the processors of the node has them
+  // to itself, otherwise the processors are shared by the processes of
+  // the node.
+  const int num_node_processors = std::max(
+      1, static_cast<int>(std::thread::hardware_concurrency()));
+  const int num_processors = ThreadPool::num_processors();
+  const bool bound = num_processors < num_node_processors;
+  const int available
+      = bound ? num_processors
+              : std::max(1, num_node_processors / num_local_processes);
+
+  if (num_threads < 1)
+  {
+    num_threads = std::getenv("DOLFINX_NUM_THREADS")
+                      ? ThreadPool::default_num_threads()
+                      : available;
+  }
+  if (num_threads > available)
+  {
+    LOG(WARNING) << "The " << num_threads << " threads of each of the "
+                 << num_local_processes << " processes on the node "
+                 << "oversubscribe the " << available
+                 << " processors available to a process.";
+  }
+
+  ThreadPool::set_num_threads(num_threads);
+}
+//-----------------------------------------------------------------------------
 bool SubSystemsManager::mpi_initialized()
 {
   // This function is not affected if MPI_Finalize has been called. It
@@ -33,6 +33,18 @@ void init_petsc();
 /// arguments
 void init_petsc(int argc, char* argv[]);
 
+/// Initialise the thread pool of the library (see ThreadPool), with a
+/// number of threads per process. If MPI is initialised, the call is
+/// collective on MPI_COMM_WORLD: if the processes are not bound to
+/// subsets of the processors (e.g. by the MPI launcher), the default
+/// number of threads is the number of processors of a node divided by
+/// the number of processes on the node, and a warning is logged if the
+/// threads of the processes of a node oversubscribe its processors.
+/// @param[in] num_threads The number of threads per process, including
+///   the calling thread. If less than one, the value of the environment
+///   variable DOLFINX_NUM_THREADS or the default is used.
+void init_threads(int num_threads = 0);
+
 /// Check if MPI has been initialised (returns true if MPI has been
 /// initialised, even if it is later finalised)
 bool mpi_initialized();
@@ -41,7 +53,8 @@ bool mpi_initialized();
 /// finalised)
 bool mpi_finalized();
 
-/// Finalize MPI
+/// Finalize MPI, after writing the trace of the timings if a trace
+/// file is set (see TimeLogger::set_trace)
 void finalize_mpi();
 
 /// Finalize PETSc
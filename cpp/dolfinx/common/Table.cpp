@@ -90,6 +90,10 @@ Table Table::reduce(MPI_Comm comm, Table::Reduction reduction) const
     new_title = "[MPI_MAX] ";
     op_impl = [](double y, double x) { return std::max(y, x); };
     break;
+  case Table::Reduction::sum:
+    new_title = "[MPI_SUM] ";
+    op_impl = [](double y, double x) { return y + x; };
+    break;
   default:
     throw std::runtime_error("Cannot perform reduction of Table. Requested "
                              "reduction not implemented");
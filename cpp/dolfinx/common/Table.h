@@ -29,13 +29,14 @@ class TableEntry;
 class Table
 {
 public:
-  /// Types of MPI reduction available for Table, to get the max, min or
-  /// average values over an MPI_Comm
+  /// Types of MPI reduction available for Table, to get the max, min,
+  /// average or sum of values over an MPI_Comm
   enum class Reduction
   {
     average,
     max,
-    min
+    min,
+    sum
   };
 
   /// Create empty table
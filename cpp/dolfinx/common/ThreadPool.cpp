@@ -0,0 +1,156 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "ThreadPool.h"
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using namespace dolfinx::common;
+
+namespace
+{
+// The pool of the library, guarded by pool_mutex
+std::unique_ptr<ThreadPool> pool;
+std::mutex pool_mutex;
+} // namespace
+
+//-----------------------------------------------------------------------------
+ThreadPool::ThreadPool(int num_threads)
+{
+  if (num_threads < 1)
+    throw std::runtime_error("Number of threads must be positive.");
+  _workers.reserve(num_threads - 1);
+  for (int i = 1; i < num_threads; ++i)
+    _workers.emplace_back(&ThreadPool::work, this);
+}
+//-----------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _cv.notify_all();
+  for (auto& t : _workers)
+    t.join();
+}
+//-----------------------------------------------------------------------------
+ThreadPool& ThreadPool::instance()
+{
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (!pool)
+    pool = std::make_unique<ThreadPool>(default_num_threads());
+  return *pool;
+}
+//-----------------------------------------------------------------------------
+void ThreadPool::set_num_threads(int num_threads)
+{
+  if (num_threads < 1)
+    num_threads = default_num_threads();
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (pool and pool->num_threads() == num_threads)
+    return;
+  pool.reset();
+  pool = std::make_unique<ThreadPool>(num_threads);
+}
+//-----------------------------------------------------------------------------
+int ThreadPool::default_num_threads()
+{
+  if (const char* env = std::getenv("DOLFINX_NUM_THREADS"))
+  {
+    try
+    {
+      const int n = std::stoi(env);
+      if (n > 0)
+        return n;
+    }
+    catch (const std::exception&)
+    {
+    }
+    throw std::runtime_error("Invalid DOLFINX_NUM_THREADS: "
+                             + std::string(env));
+  }
+  return num_processors();
+}
+//-----------------------------------------------------------------------------
+int ThreadPool::num_processors()
+{
+#ifdef __linux__
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0)
+    return std::max(1, CPU_COUNT(&cpus));
+#endif
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+//-----------------------------------------------------------------------------
+void ThreadPool::enqueue(std::shared_ptr<Job> job)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _jobs.push_back(std::move(job));
+  }
+  _cv.notify_all();
+}
+//-----------------------------------------------------------------------------
+void ThreadPool::run(Job& job)
+{
+  int i;
+  while ((i = job.next.fetch_add(1)) < job.num_chunks)
+  {
+    std::exception_ptr error;
+    try
+    {
+      job.fn(i);
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(job.mutex);
+    if (error and !job.error)
+      job.error = error;
+    if (++job.done == job.num_chunks)
+      job.finished.notify_all();
+  }
+}
+//-----------------------------------------------------------------------------
+void ThreadPool::wait(Job& job)
+{
+  std::unique_lock<std::mutex> lock(job.mutex);
+  job.finished.wait(lock, [&job]() { return job.done == job.num_chunks; });
+  if (job.error)
+    std::rethrow_exception(job.error);
+}
+//-----------------------------------------------------------------------------
+void ThreadPool::work()
+{
+  while (true)
+  {
+    std::shared_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cv.wait(lock, [this]() { return _stop or !_jobs.empty(); });
+      if (_jobs.empty())
+        return;
+      job = _jobs.front();
+    }
+
+    run(*job);
+
+    // All chunks of the job have been claimed
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_jobs.empty() and _jobs.front() == job)
+      _jobs.pop_front();
+  }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,187 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace dolfinx::common
+{
+
+/// A pool of worker threads, shared by the modules of the library that
+/// use threads (see common::parallel_for), such that the number of
+/// threads of a process is controlled in one place.
+///
+/// Work is submitted as jobs of independent chunks. The threads that
+/// take part in a job, including the thread that submits it, claim its
+/// chunks until all have been claimed. The submitting thread never
+/// waits for an unclaimed chunk, so jobs may be submitted from within
+/// chunks (nested parallelism) without deadlock, and a pool without
+/// workers runs all chunks on the calling thread.
+
+class ThreadPool
+{
+public:
+  /// Create a pool
+  /// @param[in] num_threads The number of threads of the pool,
+  ///   including the thread that submits work, i.e. num_threads - 1
+  ///   workers are started
+  explicit ThreadPool(int num_threads);
+
+  // Copying a pool is not allowed
+  ThreadPool(const ThreadPool&) = delete;
+
+  // Copying a pool is not allowed
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// Destructor (stops and joins the workers after the submitted work
+  /// is done)
+  ~ThreadPool();
+
+  /// The number of threads of the pool, including the thread that
+  /// submits work
+  int num_threads() const { return _workers.size() + 1; }
+
+  /// Call fn(i, begin, end) for contiguous chunks [begin, end) of the
+  /// range [0, n), with (at most) @p num_chunks chunks executed
+  /// concurrently on the threads of the pool. The index i is the
+  /// (deterministic) chunk number. Returns when all chunks have been
+  /// processed. The first exception thrown by a chunk is rethrown.
+  template <typename Fn>
+  void parallel_for(int num_chunks, std::int32_t n, const Fn& fn)
+  {
+    num_chunks = std::max(1, std::min(num_chunks, n));
+    auto chunk = [&fn, n, num_chunks](int i) {
+      const std::int32_t c0 = (i * std::int64_t(n)) / num_chunks;
+      const std::int32_t c1 = ((i + 1) * std::int64_t(n)) / num_chunks;
+      fn(i, c0, c1);
+    };
+    if (num_chunks == 1 or _workers.empty())
+    {
+      for (int i = 0; i < num_chunks; ++i)
+        chunk(i);
+      return;
+    }
+
+    auto job = std::make_shared<Job>(chunk, num_chunks);
+    enqueue(job);
+    run(*job);
+    wait(*job);
+  }
+
+  /// Run a task on a worker of the pool. The task runs on the calling
+  /// thread if the pool has no workers. A task should not wait for
+  /// another task, which may not have started if all workers are busy.
+  /// @param[in] fn The task, a callable without arguments
+  /// @return The future result of the task
+  template <typename Fn>
+  std::future<std::invoke_result_t<std::decay_t<Fn>>> submit(Fn&& fn)
+  {
+    using R = std::invoke_result_t<std::decay_t<Fn>>;
+    auto task
+        = std::make_shared<std::packaged_task<R()>>(std::forward<Fn>(fn));
+    std::future<R> result = task->get_future();
+    if (_workers.empty())
+      (*task)();
+    else
+      enqueue(std::make_shared<Job>([task](int) { (*task)(); }, 1));
+    return result;
+  }
+
+  /// Return the pool of the library, which is created on first use
+  /// with default_num_threads() threads if it has not been set up by
+  /// set_num_threads (e.g. by SubSystemsManager::init_threads)
+  static ThreadPool& instance();
+
+  /// Replace the pool of the library by a pool with a given number of
+  /// threads. Must not be called while work is submitted to the pool.
+  /// @param[in] num_threads The number of threads. If less than one,
+  ///   default_num_threads() is used.
+  static void set_num_threads(int num_threads);
+
+  /// The default number of threads of a process: the value of the
+  /// environment variable DOLFINX_NUM_THREADS if it is set, and
+  /// otherwise the number of processors that the process may run on
+  /// (its CPU affinity, e.g. as bound by the MPI launcher)
+  static int default_num_threads();
+
+  /// The number of processors that the calling process may run on
+  static int num_processors();
+
+private:
+  // A job of independent chunks
+  struct Job
+  {
+    Job(std::function<void(int)> fn, int num_chunks)
+        : fn(std::move(fn)), num_chunks(num_chunks)
+    {
+    }
+
+    // Process chunk i
+    std::function<void(int)> fn;
+
+    // Number of chunks
+    const int num_chunks;
+
+    // Next chunk to claim
+    std::atomic<int> next{0};
+
+    // Number of processed chunks, and the first exception of a chunk
+    // (guarded by mutex)
+    int done = 0;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+
+  // Add a job to the queue of the workers
+  void enqueue(std::shared_ptr<Job> job);
+
+  // Process chunks of a job until all chunks have been claimed
+  static void run(Job& job);
+
+  // Wait until all chunks of a job have been processed, and rethrow the
+  // first exception of a chunk
+  static void wait(Job& job);
+
+  // The loop of a worker
+  void work();
+
+  std::vector<std::thread> _workers;
+
+  // Jobs with chunks that may not have been claimed, guarded by
+  // _mutex
+  std::deque<std::shared_ptr<Job>> _jobs;
+  bool _stop = false;
+  std::mutex _mutex;
+  std::condition_variable _cv;
+};
+
+/// Call fn(i, begin, end) for contiguous chunks [begin, end) of the
+/// range [0, n), with (at most) @p num_threads chunks executed
+/// concurrently on the threads of the pool of the library (see
+/// ThreadPool::parallel_for). The index i is the (deterministic) chunk
+/// number, e.g. to index per-thread data. Returns when all chunks have
+/// been processed.
+template <typename Fn>
+void parallel_for(int num_threads, std::int32_t n, const Fn& fn)
+{
+  ThreadPool::instance().parallel_for(num_threads, n, fn);
+}
+
+} // namespace dolfinx::common
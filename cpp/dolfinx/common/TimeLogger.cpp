@@ -5,98 +5,511 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "TimeLogger.h"
+#include <algorithm>
+#include <array>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/log.h>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <utility>
 #include <variant>
 #include <vector>
 
 using namespace dolfinx;
 using namespace dolfinx::common;
 
+/// The task tree of a thread, the tasks running on the thread (the
+/// last is the innermost) and the recorded events (name, begin, end)
+struct TimeLogger::ThreadTasks
+{
+  std::mutex mutex;
+  Task root;
+  std::vector<Task*> running;
+  int id = 0;
+  std::vector<std::tuple<const std::string*,
+                         std::chrono::steady_clock::time_point,
+                         std::chrono::steady_clock::time_point>>
+      events;
+};
+
+namespace
+{
 //-----------------------------------------------------------------------------
-void TimeLogger::register_timing(std::string task, double wall, double user,
-                                 double system)
+// Add the timings of a task tree b to a task tree a
+void add(TimeLogger::Task& a, const TimeLogger::Task& b)
+{
+  a.count += b.count;
+  a.wall += b.wall;
+  a.user += b.user;
+  a.system += b.system;
+  for (std::size_t i = 0; i < a.counters.size(); ++i)
+    a.counters[i] += b.counters[i];
+  a.memory_resident += b.memory_resident;
+  a.memory_peak_increase += b.memory_peak_increase;
+  a.memory_peak = std::max(a.memory_peak, b.memory_peak);
+  for (auto& [name, task] : b.subtasks)
+    add(a.subtasks[name], task);
+}
+//-----------------------------------------------------------------------------
+// Call f(path, task) for the tasks of a task tree in depth-first order
+void visit(const TimeLogger::Task& root,
+           const std::function<void(const std::vector<std::string>&,
+                                    const TimeLogger::Task&)>& f)
+{
+  std::vector<std::string> path;
+  std::function<void(const TimeLogger::Task&)> _visit
+      = [&](const TimeLogger::Task& task) {
+          for (auto& [name, subtask] : task.subtasks)
+          {
+            path.push_back(name);
+            f(path, subtask);
+            _visit(subtask);
+            path.pop_back();
+          }
+        };
+  _visit(root);
+}
+//-----------------------------------------------------------------------------
+std::string join(const std::vector<std::string>& path)
+{
+  std::string s;
+  for (std::size_t i = 0; i < path.size(); ++i)
+    s += (i > 0 ? TimeLogger::separator : "") + path[i];
+  return s;
+}
+//-----------------------------------------------------------------------------
+// The column name prefixes of the requested timing types, with the
+// positions of the types in (wall, user, system)
+std::vector<std::pair<std::string, int>>
+columns(const std::set<TimingType>& type)
+{
+  std::vector<std::pair<std::string, int>> cols;
+  if (type.find(TimingType::wall) != type.end())
+    cols.push_back({"wall", 0});
+  if (type.find(TimingType::user) != type.end())
+    cols.push_back({"usr", 1});
+  if (type.find(TimingType::system) != type.end())
+    cols.push_back({"sys", 2});
+  return cols;
+}
+//-----------------------------------------------------------------------------
+// Quote a string for JSON
+std::string json_string(const std::string& str)
+{
+  std::stringstream s;
+  s << '"';
+  for (char c : str)
+  {
+    if (c == '"' or c == '\\')
+      s << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      s << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+        << static_cast<int>(c) << std::dec;
+    }
+    else
+      s << c;
+  }
+  s << '"';
+  return s.str();
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+void TimeLogger::set_enabled(bool enabled)
+{
+  _enabled.store(enabled, std::memory_order_relaxed);
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::set_cpu_times(bool enabled)
+{
+  _cpu_times.store(enabled, std::memory_order_relaxed);
+}
+//-----------------------------------------------------------------------------
+bool TimeLogger::set_counters(bool enabled)
+{
+  _counters.store(enabled, std::memory_order_relaxed);
+  return HardwareCounters::available();
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::set_memory(bool enabled)
+{
+  _memory.store(enabled, std::memory_order_relaxed);
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::set_trace(bool enabled, std::string filename)
+{
+  _trace.store(enabled, std::memory_order_relaxed);
+  _trace_file = filename;
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::write_trace(MPI_Comm comm, const std::string& filename)
+{
+  // Align the clocks of the processes at a barrier, and shift the times
+  // such that the first event over all processes is at time zero
+  MPI_Barrier(comm);
+  const auto t0 = std::chrono::steady_clock::now();
+  const int rank = dolfinx::MPI::rank(comm);
+  std::lock_guard<std::mutex> lock(_mutex);
+  double first_local = 0.0;
+  for (auto& thread : _threads)
+  {
+    std::lock_guard<std::mutex> thread_lock(thread->mutex);
+    for (auto& [name, begin, end] : thread->events)
+    {
+      first_local = std::min(
+          first_local, std::chrono::duration<double>(begin - t0).count());
+    }
+  }
+  double first = 0.0;
+  MPI_Allreduce(&first_local, &first, 1, MPI_DOUBLE, MPI_MIN, comm);
+
+  // Complete ("X") events with times in microseconds, and the names of
+  // the process and threads as metadata ("M") events
+  std::stringstream s;
+  s << std::fixed << std::setprecision(3);
+  s << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << rank
+    << ", \"args\": {\"name\": \"rank " << rank << "\"}}";
+  for (auto& thread : _threads)
+  {
+    std::lock_guard<std::mutex> thread_lock(thread->mutex);
+    s << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << rank
+      << ", \"tid\": " << thread->id << ", \"args\": {\"name\": \"thread "
+      << thread->id << "\"}}";
+    for (auto& [name, begin, end] : thread->events)
+    {
+      const double ts
+          = 1e6 * (std::chrono::duration<double>(begin - t0).count() - first);
+      const double dur
+          = 1e6 * std::chrono::duration<double>(end - begin).count();
+      s << ",\n{\"name\": " << json_string(*name)
+        << ", \"cat\": \"dolfinx\", \"ph\": \"X\", \"pid\": " << rank
+        << ", \"tid\": " << thread->id << ", \"ts\": " << ts
+        << ", \"dur\": " << dur << "}";
+    }
+  }
+  const std::string events = s.str();
+
+  // Gather to rank 0
+  const int mpi_size = dolfinx::MPI::size(comm);
+  std::vector<int> counts(mpi_size), offsets(mpi_size + 1, 0);
+  const int size = events.size();
+  MPI_Gather(&size, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, comm);
+  std::partial_sum(counts.begin(), counts.end(), offsets.begin() + 1);
+  std::vector<char> events_all(offsets.back());
+  MPI_Gatherv(events.data(), events.size(), MPI_CHAR, events_all.data(),
+              counts.data(), offsets.data(), MPI_CHAR, 0, comm);
+  if (rank > 0)
+    return;
+
+  std::ofstream file(filename);
+  if (!file)
+    throw std::runtime_error("Cannot open trace file \"" + filename + "\".");
+  file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+  for (int p = 0; p < mpi_size; ++p)
+  {
+    file << (p > 0 ? ",\n" : "");
+    file.write(events_all.data() + offsets[p], counts[p]);
+  }
+  file << "\n]}\n";
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<TimeLogger::ThreadTasks> TimeLogger::thread_tasks()
+{
+  thread_local std::pair<const TimeLogger*, std::shared_ptr<ThreadTasks>>
+      tasks(nullptr, nullptr);
+  if (tasks.first != this)
+  {
+    tasks = {this, std::make_shared<ThreadTasks>()};
+    std::lock_guard<std::mutex> lock(_mutex);
+    tasks.second->id = _threads.size();
+    _threads.push_back(tasks.second);
+  }
+  return tasks.second;
+}
+//-----------------------------------------------------------------------------
+TimeLogger::RunningTask TimeLogger::begin_task(const std::string& task)
+{
+  std::shared_ptr<ThreadTasks> thread = thread_tasks();
+  std::lock_guard<std::mutex> lock(thread->mutex);
+  Task* parent = thread->running.empty() ? &thread->root
+                                         : thread->running.back();
+  auto it = parent->subtasks.try_emplace(task).first;
+  thread->running.push_back(&it->second);
+  return {thread, &it->second, &it->first};
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::end_task(
+    const RunningTask& task, double wall, double user, double system,
+    const std::array<std::uint64_t, HardwareCounters::num_events>& counters,
+    const MemoryUsage::Change& memory)
 {
+  assert(task.thread);
+  assert(task.task);
   assert(wall >= 0.0);
   assert(user >= 0.0);
   assert(system >= 0.0);
 
-  // Print a message
-  std::string line = "Elapsed wall, usr, sys time: " + std::to_string(wall)
-                     + ", " + std::to_string(user) + ", "
-                     + std::to_string(system) + " (" + task + ")";
-  DLOG(INFO) << line;
+  DLOG(INFO) << "Elapsed wall, usr, sys time: " << wall << ", " << user
+             << ", " << system;
 
-  // Store values for summary
-  if (auto it = _timings.find(task); it != _timings.end())
+  // Store values for summary, and remove the task from the running
+  // tasks (not necessarily the innermost, if timers are not nested)
+  std::lock_guard<std::mutex> lock(task.thread->mutex);
+  task.task->count += 1;
+  task.task->wall += wall;
+  task.task->user += user;
+  task.task->system += system;
+  for (std::size_t i = 0; i < counters.size(); ++i)
+    task.task->counters[i] += counters[i];
+  task.task->memory_resident += memory.resident;
+  task.task->memory_peak_increase += memory.peak_increase;
+  task.task->memory_peak = std::max(task.task->memory_peak, memory.peak);
+  if (trace())
   {
-    std::get<0>(it->second) += 1;
-    std::get<1>(it->second) += wall;
-    std::get<2>(it->second) += user;
-    std::get<3>(it->second) += system;
+    // The event ends now, and began the wall time before
+    const auto end = std::chrono::steady_clock::now();
+    const auto begin
+        = end
+          - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>(wall));
+    task.thread->events.emplace_back(task.name, begin, end);
+  }
+  std::vector<Task*>& running = task.thread->running;
+  if (auto it = std::find(running.rbegin(), running.rend(), task.task);
+      it != running.rend())
+  {
+    running.erase(std::next(it).base());
   }
-  else
-    _timings.insert({task, {1, wall, user, system}});
+}
+//-----------------------------------------------------------------------------
+void TimeLogger::register_timing(std::string task, double wall, double user,
+                                 double system)
+{
+  end_task(begin_task(task), wall, user, system);
+}
+//-----------------------------------------------------------------------------
+TimeLogger::Task TimeLogger::merge()
+{
+  Task root;
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (auto& thread : _threads)
+  {
+    std::lock_guard<std::mutex> thread_lock(thread->mutex);
+    add(root, thread->root);
+  }
+  return root;
 }
 //-----------------------------------------------------------------------------
 void TimeLogger::list_timings(MPI_Comm mpi_comm, std::set<TimingType> type)
 {
-  // Format and reduce to rank 0
-  Table timings = this->timings(type);
-  timings = timings.reduce(mpi_comm, Table::Reduction::average);
-  const std::string str = "\n" + timings.str();
+  // Pack the task paths (names terminated by '\0', and an empty name
+  // at the end of a path) and the (count, wall, user, system) timings
+  // with the (resident, peak increase, peak) memory
+  const Task root = merge();
+  std::string keys;
+  std::vector<double> values;
+  visit(root, [&](const std::vector<std::string>& path, const Task& task) {
+    for (auto& name : path)
+      keys += name + '\0';
+    keys += '\0';
+    values.insert(values.end(),
+                  {(double)task.count, task.wall, task.user, task.system,
+                   (double)task.memory_resident,
+                   (double)task.memory_peak_increase,
+                   (double)task.memory_peak});
+  });
+
+  // Gather to rank 0
+  const int mpi_size = dolfinx::MPI::size(mpi_comm);
+  const int rank = dolfinx::MPI::rank(mpi_comm);
+  std::vector<int> counts(mpi_size), offsets(mpi_size + 1, 0);
+  const int num_keys = keys.size();
+  MPI_Gather(&num_keys, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, mpi_comm);
+  std::partial_sum(counts.begin(), counts.end(), offsets.begin() + 1);
+  std::vector<char> keys_all(offsets.back());
+  MPI_Gatherv(keys.data(), keys.size(), MPI_CHAR, keys_all.data(),
+              counts.data(), offsets.data(), MPI_CHAR, 0, mpi_comm);
+
+  std::vector<int> value_counts(mpi_size), value_offsets(mpi_size + 1, 0);
+  const int num_values = values.size();
+  MPI_Gather(&num_values, 1, MPI_INT, value_counts.data(), 1, MPI_INT, 0,
+             mpi_comm);
+  std::partial_sum(value_counts.begin(), value_counts.end(),
+                   value_offsets.begin() + 1);
+  std::vector<double> values_all(value_offsets.back());
+  MPI_Gatherv(values.data(), values.size(), MPI_DOUBLE, values_all.data(),
+              value_counts.data(), value_offsets.data(), MPI_DOUBLE, 0,
+              mpi_comm);
+
+  // Reduce the hardware counts and rates of each task (collective)
+  Table counters("Summary of hardware counters");
+  if (this->counters())
+  {
+    using HardwareCounters::Event;
+    const std::array names = HardwareCounters::names();
+    visit(root, [&](const std::vector<std::string>& path, const Task& task) {
+      if (task.count == 0)
+        return;
+      const std::string row = join(path);
+      auto count = [&task](Event e) -> double {
+        return task.counters[static_cast<int>(e)];
+      };
+      for (int i = 0; i < HardwareCounters::num_events; ++i)
+        counters.set(row, names[i], count(static_cast<Event>(i)));
+      const double cycles = count(Event::cycles);
+      const double refs = count(Event::cache_references);
+      counters.set(row, "IPC",
+                   cycles > 0 ? count(Event::instructions) / cycles : 0.0);
+      counters.set(row, "miss ratio",
+                   refs > 0 ? count(Event::cache_misses) / refs : 0.0);
+      counters.set(row, "miss GB/s",
+                   task.wall > 0 ? 1e-9 * HardwareCounters::cache_line_size
+                                       * count(Event::cache_misses)
+                                       / task.wall
+                                 : 0.0);
+    });
+    counters = counters.reduce(mpi_comm, Table::Reduction::average);
+  }
+
+  if (rank > 0)
+    return;
+
+  // Reduce the timings of each task over the processes that ran it. A
+  // map with the paths as keys is in depth-first order.
+  struct Reduced
+  {
+    int num_ranks = 0;
+    int reps = 0;
+    std::array<double, 3> avg = {0.0, 0.0, 0.0}, tot = {0.0, 0.0, 0.0};
+    std::array<double, 3> min
+        = {std::numeric_limits<double>::max(),
+           std::numeric_limits<double>::max(),
+           std::numeric_limits<double>::max()};
+    std::array<double, 3> max = {0.0, 0.0, 0.0};
+    double resident = 0.0, peak_increase = 0.0, peak = 0.0;
+  };
+  std::map<std::vector<std::string>, Reduced> tasks;
+  const double* v = values_all.data();
+  for (auto it = keys_all.begin(); it != keys_all.end();)
+  {
+    std::vector<std::string> path;
+    for (auto end = std::find(it, keys_all.end(), '\0'); end != it;
+         end = std::find(it, keys_all.end(), '\0'))
+    {
+      path.emplace_back(it, end);
+      it = std::next(end);
+    }
+    it = std::next(it);
 
-  // Print just on rank 0
-  if (dolfinx::MPI::rank(mpi_comm) == 0)
-    std::cout << str << std::endl;
+    Reduced& task = tasks[path];
+    const int count = v[0];
+    task.num_ranks += 1;
+    task.reps = std::max(task.reps, count);
+    for (int i = 0; i < 3; ++i)
+    {
+      task.avg[i] += count > 0 ? v[i + 1] / count : 0.0;
+      task.tot[i] += v[i + 1];
+      task.min[i] = std::min(task.min[i], v[i + 1]);
+      task.max[i] = std::max(task.max[i], v[i + 1]);
+    }
+    task.resident += v[4];
+    task.peak_increase = std::max(task.peak_increase, v[5]);
+    task.peak = std::max(task.peak, v[6]);
+    v += 7;
+  }
+  assert(v == values_all.data() + values_all.size());
+
+  // The averages are over the processes that ran the task, and the
+  // total, min and max columns are the total times of the processes
+  Table table("[MPI_AVG, MPI_MIN, MPI_MAX] Summary of timings");
+  for (auto& [path, task] : tasks)
+  {
+    const std::string row = join(path);
+    const double w = 1.0 / task.num_ranks;
+    table.set(row, "reps", std::variant<std::string, int, double>(task.reps));
+    for (auto& [prefix, i] : columns(type))
+    {
+      table.set(row, prefix + " avg", w * task.avg[i]);
+      table.set(row, prefix + " tot", w * task.tot[i]);
+      table.set(row, prefix + " min", task.min[i]);
+      table.set(row, prefix + " max", task.max[i]);
+    }
+    if (this->memory())
+    {
+      table.set(row, "mem peak MB", 1e-6 * task.peak);
+      table.set(row, "mem +peak MB", 1e-6 * task.peak_increase);
+      table.set(row, "mem +rss MB", 1e-6 * w * task.resident);
+    }
+  }
+
+  std::string str = "\n" + table.str();
+  if (this->counters())
+    str += "\n\n" + counters.str();
+  std::cout << str << std::endl;
 }
 //-----------------------------------------------------------------------------
 Table TimeLogger::timings(std::set<TimingType> type)
 {
   // Generate log::timing table
   Table table("Summary of timings");
-
-  bool time_wall = type.find(TimingType::wall) != type.end();
-  bool time_user = type.find(TimingType::user) != type.end();
-  bool time_sys = type.find(TimingType::system) != type.end();
-
-  for (auto& it : _timings)
-  {
-    const std::string task = it.first;
-    const auto [num_timings, wall, usr, sys] = it.second;
+  const Task root = merge();
+  visit(root, [&](const std::vector<std::string>& path, const Task& task) {
+    const std::string row = join(path);
     // NB - the cast to std::variant should not be needed: needed by Intel
     // compiler.
-    table.set(task, "reps",
-              std::variant<std::string, int, double>(num_timings));
-    if (time_wall)
+    table.set(row, "reps", std::variant<std::string, int, double>(task.count));
+    const std::array<double, 3> values = {task.wall, task.user, task.system};
+    for (auto& [prefix, i] : columns(type))
     {
-      table.set(task, "wall avg", wall / static_cast<double>(num_timings));
-      table.set(task, "wall tot", wall);
+      // A task without timings is still running (a parent of timed
+      // tasks)
+      table.set(row, prefix + " avg",
+                task.count > 0 ? values[i] / static_cast<double>(task.count)
+                               : 0.0);
+      table.set(row, prefix + " tot", values[i]);
     }
-    if (time_user)
+    if (memory())
     {
-      table.set(task, "usr avg", usr / static_cast<double>(num_timings));
-      table.set(task, "usr tot", usr);
+      table.set(row, "mem peak MB", 1e-6 * task.memory_peak);
+      table.set(row, "mem +peak MB", 1e-6 * task.memory_peak_increase);
+      table.set(row, "mem +rss MB", 1e-6 * task.memory_resident);
     }
-    if (time_sys)
-    {
-      table.set(task, "sys avg", sys / static_cast<double>(num_timings));
-      table.set(task, "sys tot", sys);
-    }
-  }
+  });
 
   return table;
 }
 //-----------------------------------------------------------------------------
 std::tuple<int, double, double, double> TimeLogger::timing(std::string task)
 {
-  // Find timing
-  auto it = _timings.find(task);
-  if (it == _timings.end())
+  // Sum the timings of the tasks with the name or path
+  bool found = false;
+  std::tuple<int, double, double, double> t = {0, 0.0, 0.0, 0.0};
+  const Task root = merge();
+  visit(root, [&](const std::vector<std::string>& path, const Task& _task) {
+    if (path.back() == task or join(path) == task)
+    {
+      found = true;
+      std::get<0>(t) += _task.count;
+      std::get<1>(t) += _task.wall;
+      std::get<2>(t) += _task.user;
+      std::get<3>(t) += _task.system;
+    }
+  });
+
+  if (!found)
   {
     throw std::runtime_error("No timings registered for task \"" + task
                              + "\".");
   }
-  return it->second;
+  return t;
 }
 //-----------------------------------------------------------------------------
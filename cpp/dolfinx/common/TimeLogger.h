@@ -6,25 +6,80 @@
 
 #pragma once
 
+#include "HardwareCounters.h"
+#include "MemoryUsage.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <dolfinx/common/Table.h>
 #include <dolfinx/common/timing.h>
 #include <map>
 #include <memory>
 #include <mpi.h>
+#include <mutex>
 #include <ostream>
 #include <set>
 #include <string>
 #include <thread>
 #include <tuple>
+#include <vector>
 
 namespace dolfinx::common
 {
 
 /// Timer logging
+///
+/// Timings are accumulated per thread in a tree of tasks: a task that
+/// is started while another task is running on the same thread is a
+/// sub-task of the running task, e.g. "Build sparsity" while
+/// "Assemble matrix" is running. A task is identified by its path in
+/// the tree, "Assemble matrix > Build sparsity". The trees of the
+/// threads are merged when the timings are summarised.
 
 class TimeLogger
 {
 public:
+  /// Timings of a task and of its sub-tasks
+  struct Task
+  {
+    /// Number of timings
+    int count = 0;
+
+    /// Total wall, user and system time in seconds
+    double wall = 0.0, user = 0.0, system = 0.0;
+
+    /// Total counts of the hardware events (see set_counters)
+    std::array<std::uint64_t, HardwareCounters::num_events> counters = {};
+
+    /// Total increase of the resident set size, total increase of the
+    /// high-water mark of the process and the largest high-water mark
+    /// at the end of a timing, in bytes (see set_memory)
+    std::int64_t memory_resident = 0, memory_peak_increase = 0,
+                 memory_peak = 0;
+
+    /// The sub-tasks by name
+    std::map<std::string, Task> subtasks;
+  };
+
+  /// The tasks of a thread (implementation detail)
+  struct ThreadTasks;
+
+  /// A task that is running on a thread, returned by begin_task
+  struct RunningTask
+  {
+    /// The tasks of the thread that started the task
+    std::shared_ptr<ThreadTasks> thread;
+
+    /// The task
+    Task* task = nullptr;
+
+    /// The name of the task
+    const std::string* name = nullptr;
+  };
+
+  /// Separator of the names of the tasks in a task path
+  static constexpr const char* separator = " > ";
+
   /// Constructor
   TimeLogger() = default;
 
@@ -37,28 +92,154 @@ public:
   /// Destructor
   ~TimeLogger() = default;
 
-  /// Register timing (for later summary)
+  /// Enable or disable the logging of timings. If disabled, timers
+  /// still measure their wall time (see Timer::elapsed), but nothing is
+  /// registered, which removes all but the cost of reading the clock.
+  static void set_enabled(bool enabled);
+
+  /// Return true if the logging of timings is enabled
+  static bool enabled() { return _enabled.load(std::memory_order_relaxed); }
+
+  /// Enable or disable the measurement of user and system time by
+  /// timers (disabled by default). The times are sampled with a system
+  /// call (getrusage) at the start and stop of each timer, and are
+  /// reported as zero if disabled.
+  static void set_cpu_times(bool enabled);
+
+  /// Return true if user and system times are measured
+  static bool cpu_times()
+  {
+    return _cpu_times.load(std::memory_order_relaxed);
+  }
+
+  /// Enable or disable the sampling of hardware performance counters
+  /// (cycles, instructions, cache references and misses, branch
+  /// misses, see HardwareCounters) by timers with a task (disabled by
+  /// default). The counters of the thread that runs a timer are read at
+  /// the start and stop of the timer, with a system call each.
+  /// @param[in] enabled True to sample the counters
+  /// @return True if the counters can be read on the calling thread
+  static bool set_counters(bool enabled);
+
+  /// Return true if hardware counters are sampled
+  static bool counters() { return _counters.load(std::memory_order_relaxed); }
+
+  /// Enable or disable the sampling of the memory usage of the process
+  /// (see MemoryUsage) by timers with a task (disabled by default). The
+  /// memory is read at the start and stop of each timer, which costs a
+  /// file read and a system call. The memory of the process is
+  /// attributed to the tasks that are running when it changes, i.e. the
+  /// peak memory of a task includes memory allocated by other threads
+  /// while the task runs.
+  static void set_memory(bool enabled);
+
+  /// Return true if the memory usage is sampled
+  static bool memory() { return _memory.load(std::memory_order_relaxed); }
+
+  /// Enable or disable the recording of the begin and end of each
+  /// timing (disabled by default), as events with timestamps per
+  /// process and thread (see write_trace). The events are kept in
+  /// memory until the logger is destroyed.
+  /// @param[in] enabled True to record the events
+  /// @param[in] filename If not empty, the file to which the trace is
+  ///   written by SubSystemsManager::finalize_mpi
+  void set_trace(bool enabled, std::string filename = "");
+
+  /// Return true if events are recorded
+  static bool trace() { return _trace.load(std::memory_order_relaxed); }
+
+  /// Return the file to which the trace is written at finalisation
+  const std::string& trace_file() const { return _trace_file; }
+
+  /// Write the recorded events of all processes in the Chrome trace
+  /// event format (JSON), which can be viewed in chrome://tracing or
+  /// Perfetto, with a process per rank and a thread per thread of each
+  /// rank (collective). The clocks of the processes are aligned at a
+  /// barrier at the call, such that the events of the ranks line up to
+  /// within the latency of the barrier, e.g. to show which ranks wait
+  /// in a communication.
+  /// @param[in] comm The MPI communicator
+  /// @param[in] filename The name of the file, written by rank 0
+  void write_trace(MPI_Comm comm, const std::string& filename);
+
+  /// Start a task on the calling thread, as a sub-task of the tasks
+  /// running on the thread. The call is thread-safe.
+  /// @param[in] task The name of the task
+  /// @return The running task, to pass to end_task
+  RunningTask begin_task(const std::string& task);
+
+  /// Stop a running task and add a timing to it, with the counts of
+  /// the hardware events and the change of the memory usage in the
+  /// timing. The call is thread-safe.
+  void end_task(
+      const RunningTask& task, double wall, double user, double system,
+      const std::array<std::uint64_t, HardwareCounters::num_events>& counters
+      = {},
+      const MemoryUsage::Change& memory = {});
+
+  /// Register timing (for later summary), as a sub-task of the tasks
+  /// running on the calling thread. The call is thread-safe.
   void register_timing(std::string task, double wall, double user,
                        double system);
 
-  /// Return a summary of timings and tasks in a Table
+  /// Return a summary of timings and tasks in a Table, with a row for
+  /// each task path in depth-first order
   Table timings(std::set<TimingType> type);
 
-  /// List a summary of timings and tasks. ``MPI_AVG`` reduction is
-  /// printed.
+  /// List a summary of timings and tasks, in depth-first order of the
+  /// task tree. The total times of each task are reduced over the
+  /// processes to the average, minimum and maximum (collective). If
+  /// hardware counters are sampled, a table of the counts of each task
+  /// and of derived rates (instructions per cycle, cache miss ratio and
+  /// the memory bandwidth of the cache misses) averaged over the
+  /// processes follows. If the memory usage is sampled, the timings
+  /// table has columns of the high-water mark of the process at the
+  /// end of the task (maximum over the processes), of the increase of
+  /// the high-water mark in the task (the peak memory attributed to the
+  /// task, maximum over the processes) and of the memory retained by
+  /// the task (average over the processes), in megabytes.
   /// @param mpi_comm MPI Communicator
   /// @param type Set of possible timings: wall, user or system
   void list_timings(MPI_Comm mpi_comm, std::set<TimingType> type);
 
   /// Return timing
-  /// @param[in] task The task name to retrieve the timing for
+  /// @param[in] task The task name to retrieve the timing for. The
+  ///   timings of all tasks with the name (at any depth) or with the
+  ///   path are summed.
   /// @returns Values (count, total wall time, total user time, total
   /// system time) for given task.
   std::tuple<int, double, double, double> timing(std::string task);
 
 private:
-  // List of timings for tasks, map from string to (num_timings,
-  // total_wall_time, total_user_time, total_system_time)
-  std::map<std::string, std::tuple<int, double, double, double>> _timings;
+  // Return the tasks of the calling thread, and register them on first
+  // use
+  std::shared_ptr<ThreadTasks> thread_tasks();
+
+  // Merge the task trees of all threads
+  Task merge();
+
+  // The tasks of all threads that have registered timings
+  std::vector<std::shared_ptr<ThreadTasks>> _threads;
+
+  // Guards _threads
+  std::mutex _mutex;
+
+  // True if timings are registered
+  inline static std::atomic<bool> _enabled{true};
+
+  // True if user and system times are measured
+  inline static std::atomic<bool> _cpu_times{false};
+
+  // True if hardware counters are sampled
+  inline static std::atomic<bool> _counters{false};
+
+  // True if the memory usage is sampled
+  inline static std::atomic<bool> _memory{false};
+
+  // True if the events of the timings are recorded
+  inline static std::atomic<bool> _trace{false};
+
+  // The file to which the trace is written at finalisation
+  std::string _trace_file;
 };
 } // namespace dolfinx::common
@@ -6,28 +6,51 @@
 
 #include "Timer.h"
 #include "TimeLogManager.h"
+#include <stdexcept>
+#include <sys/resource.h>
 
 using namespace dolfinx;
 using namespace dolfinx::common;
 
+namespace
+{
 //-----------------------------------------------------------------------------
-Timer::Timer() : Timer::Timer("")
+// Get the user and system times of the process in seconds
+std::array<double, 2> cpu_times()
 {
-  // Do nothing
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return {usage.ru_utime.tv_sec + 1e-6 * usage.ru_utime.tv_usec,
+          usage.ru_stime.tv_sec + 1e-6 * usage.ru_stime.tv_usec};
 }
 //-----------------------------------------------------------------------------
-Timer::Timer(const std::string& task) : _task(task)
+} // namespace
+
+//-----------------------------------------------------------------------------
+Timer::Timer() : Timer::Timer("")
 {
   // Do nothing
 }
 //-----------------------------------------------------------------------------
+Timer::Timer(const std::string& task) : _task(task) { start(); }
+//-----------------------------------------------------------------------------
 Timer::~Timer()
 {
-  if (!_timer.is_stopped())
+  if (!_stopped)
     stop();
 }
 //-----------------------------------------------------------------------------
-void Timer::start() { _timer.start(); }
+void Timer::start()
+{
+  // Restarting a running logging timer does not start a new task
+  if (!_task.empty() and !_running.task and TimeLogger::enabled())
+    _running = TimeLogManager::logger().begin_task(_task);
+  _wall = std::chrono::steady_clock::duration::zero();
+  _cpu = {0.0, 0.0};
+  _counts = {};
+  _memory = {};
+  start_clocks();
+}
 //-----------------------------------------------------------------------------
 void Timer::resume()
 {
@@ -37,24 +60,71 @@ void Timer::resume()
         "Resuming is not well-defined for logging timer. Only "
         "non-logging timer can be resumed");
   }
-  _timer.resume();
+  if (_stopped)
+    start_clocks();
 }
 //-----------------------------------------------------------------------------
 double Timer::stop()
 {
-  _timer.stop();
+  if (!_stopped)
+  {
+    _wall += std::chrono::steady_clock::now() - _start;
+    if (_cpu_timed)
+    {
+      const std::array<double, 2> t = cpu_times();
+      _cpu[0] += t[0] - _cpu_start[0];
+      _cpu[1] += t[1] - _cpu_start[1];
+    }
+    if (_counted)
+    {
+      const std::array counts = HardwareCounters::read();
+      for (std::size_t i = 0; i < counts.size(); ++i)
+        _counts[i] += counts[i] - _counts_start[i];
+    }
+    if (_memory_sampled)
+      _memory = MemoryUsage::change(_memory_start, MemoryUsage::read());
+    _stopped = true;
+  }
+
   const auto [wall, user, system] = this->elapsed();
-  if (!_task.empty())
-    TimeLogManager::logger().register_timing(_task, wall, user, system);
+  if (_running.task)
+  {
+    TimeLogManager::logger().end_task(_running, wall, user, system, _counts,
+                                      _memory);
+    _running = TimeLogger::RunningTask();
+  }
   return wall;
 }
 //-----------------------------------------------------------------------------
 std::array<double, 3> Timer::elapsed() const
 {
-  const boost::timer::cpu_times elapsed = _timer.elapsed();
-  const double wall = static_cast<double>(elapsed.wall) * 1e-9;
-  const double user = static_cast<double>(elapsed.user) * 1e-9;
-  const double system = static_cast<double>(elapsed.system) * 1e-9;
-  return {wall, user, system};
+  std::chrono::steady_clock::duration wall = _wall;
+  std::array<double, 2> cpu = _cpu;
+  if (!_stopped)
+  {
+    wall += std::chrono::steady_clock::now() - _start;
+    if (_cpu_timed)
+    {
+      const std::array<double, 2> t = cpu_times();
+      cpu[0] += t[0] - _cpu_start[0];
+      cpu[1] += t[1] - _cpu_start[1];
+    }
+  }
+  return {std::chrono::duration<double>(wall).count(), cpu[0], cpu[1]};
+}
+//-----------------------------------------------------------------------------
+void Timer::start_clocks()
+{
+  _stopped = false;
+  _cpu_timed = TimeLogger::cpu_times();
+  if (_cpu_timed)
+    _cpu_start = cpu_times();
+  _counted = _running.task and TimeLogger::counters();
+  if (_counted)
+    _counts_start = HardwareCounters::read();
+  _memory_sampled = _running.task and TimeLogger::memory();
+  if (_memory_sampled)
+    _memory_start = MemoryUsage::read();
+  _start = std::chrono::steady_clock::now();
 }
 //-----------------------------------------------------------------------------
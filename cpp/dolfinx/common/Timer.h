@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include "TimeLogger.h"
 #include <array>
-#include <boost/timer/timer.hpp>
+#include <chrono>
+#include <cstdint>
 #include <string>
 
 namespace dolfinx::common
@@ -26,6 +28,16 @@ namespace dolfinx::common
 /// Timings are stored globally and a summary may be printed by calling
 ///
 ///   list_timings();
+///
+/// A timer with a task that is started while another timer with a task
+/// is running on the same thread times a sub-task of the running task
+/// (see TimeLogger). The wall time is measured with a steady clock.
+/// User and system times are only measured if enabled (see
+/// TimeLogger::set_cpu_times), and registering timings can be disabled
+/// for low-overhead timers in inner loops (see
+/// TimeLogger::set_enabled). Timers with a task can also sample
+/// hardware performance counters (see TimeLogger::set_counters) and
+/// the memory usage of the process (see TimeLogger::set_memory).
 
 class Timer
 {
@@ -53,10 +65,37 @@ public:
   std::array<double, 3> elapsed() const;
 
 private:
+  // Start the clocks
+  void start_clocks();
+
   // Name of task
   std::string _task;
 
-  // Implementation of timer
-  boost::timer::cpu_timer _timer;
+  // The task in the logger, if running and logged
+  TimeLogger::RunningTask _running;
+
+  // True if the timer is stopped
+  bool _stopped = true;
+
+  // Start of the current interval, and accumulated wall time
+  std::chrono::steady_clock::time_point _start;
+  std::chrono::steady_clock::duration _wall{0};
+
+  // User and system times at the start of the current interval, and
+  // accumulated times (seconds), if measured in the current interval
+  bool _cpu_timed = false;
+  std::array<double, 2> _cpu_start = {0.0, 0.0}, _cpu = {0.0, 0.0};
+
+  // Hardware counts at the start of the current interval, and
+  // accumulated counts, if sampled in the current interval
+  bool _counted = false;
+  std::array<std::uint64_t, HardwareCounters::num_events> _counts_start = {},
+                                                           _counts = {};
+
+  // Memory usage at the start of the current interval, and its change
+  // over the timing, if sampled
+  bool _memory_sampled = false;
+  MemoryUsage::Sample _memory_start;
+  MemoryUsage::Change _memory;
 };
 } // namespace dolfinx::common
@@ -64,3 +64,21 @@ bool dolfinx::has_kahip()
 #endif
 }
 //-------------------------------------------------------------------------
+bool dolfinx::has_adios2()
+{
+#ifdef HAS_ADIOS2
+  return true;
+#else
+  return false;
+#endif
+}
+//-------------------------------------------------------------------------
+bool dolfinx::has_zlib()
+{
+#ifdef HAS_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+//-------------------------------------------------------------------------
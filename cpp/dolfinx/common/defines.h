@@ -41,4 +41,10 @@ bool has_parmetis();
 /// Return true if DOLFINX is compiled with KaHIP
 bool has_kahip();
 
+/// Return true if DOLFINX is compiled with ADIOS2
+bool has_adios2();
+
+/// Return true if DOLFINX is compiled with zlib
+bool has_zlib();
+
 } // namespace dolfinx
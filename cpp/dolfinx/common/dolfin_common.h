@@ -12,9 +12,16 @@ namespace dolfinx
 
 // DOLFINX common
 
+#include <dolfinx/common/AlignedAllocator.h>
+#include <dolfinx/common/CommProfiler.h>
+#include <dolfinx/common/ExactSum.h>
+#include <dolfinx/common/HardwareCounters.h>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/MemoryUsage.h>
+#include <dolfinx/common/SharedMemory.h>
 #include <dolfinx/common/SubSystemsManager.h>
 #include <dolfinx/common/Table.h>
+#include <dolfinx/common/ThreadPool.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/defines.h>
 #include <dolfinx/common/init.h>
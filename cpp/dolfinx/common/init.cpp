@@ -14,5 +14,6 @@ void dolfinx::init(int argc, char* argv[])
   common::SubSystemsManager::init_logging(argc, argv);
   LOG(INFO) << "Initializing DOLFINX version" << DOLFINX_VERSION;
   common::SubSystemsManager::init_petsc(argc, argv);
+  common::SubSystemsManager::init_threads();
 }
 //-----------------------------------------------------------------------------
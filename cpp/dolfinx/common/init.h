@@ -9,8 +9,8 @@
 namespace dolfinx
 {
 
-/// Initialize DOLFINX (and PETSc) with command-line arguments. This
-/// should not be needed in most cases since the initialization is
-/// otherwise handled automatically.
+/// Initialize DOLFINX (PETSc and the thread pool) with command-line
+/// arguments. This should not be needed in most cases since the
+/// initialization is otherwise handled automatically.
 void init(int argc, char* argv[]);
 } // namespace dolfinx
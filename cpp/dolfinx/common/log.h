@@ -10,3 +10,35 @@
 #define LOGURU_REPLACE_GLOG 1
 
 #include "loguru.hpp"
+
+/// The least important verbosity that is compiled in, e.g.
+/// loguru::Verbosity_WARNING, set by the CMake option DOLFINX_LOG_LEVEL.
+/// Messages of a less important verbosity expand to a statement that is
+/// removed by the compiler: their arguments are not evaluated and there
+/// is no run-time check of the verbosity. Defaults to all verbosities.
+#ifndef DOLFINX_LOG_LEVEL
+#define DOLFINX_LOG_LEVEL loguru::Verbosity_MAX
+#endif
+
+// Replace the stream logging macros of loguru by macros that test the
+// compile-time level before the run-time verbosity cutoff
+
+/// Log a message with a verbosity, e.g. VLOG(1) << "message"
+#undef VLOG
+#define VLOG(verbosity)                                                        \
+  ((verbosity) > DOLFINX_LOG_LEVEL                                             \
+   or (verbosity) > loguru::current_verbosity_cutoff())                        \
+      ? (void)0                                                                \
+      : loguru::Voidify() & loguru::StreamLogger(verbosity, __FILE__, __LINE__)
+
+/// Log a message with a named verbosity, e.g. LOG(INFO) << "message"
+#undef LOG
+#define LOG(verbosity_name) VLOG(loguru::Verbosity_##verbosity_name)
+
+/// Log a message with a named verbosity in debug builds only
+#undef DLOG
+#if LOGURU_DEBUG_LOGGING
+#define DLOG(verbosity_name) LOG(verbosity_name)
+#else
+#define DLOG(verbosity_name) DLOG_S(verbosity_name)
+#endif
@@ -34,3 +34,33 @@ std::tuple<std::size_t, double, double, double> dolfinx::timing(std::string task
   return TimeLogManager::logger().timing(task);
 }
 //-----------------------------------------------------------------------------
+void dolfinx::set_timing_enabled(bool enabled)
+{
+  TimeLogger::set_enabled(enabled);
+}
+//-----------------------------------------------------------------------------
+void dolfinx::set_cpu_timing(bool enabled)
+{
+  TimeLogger::set_cpu_times(enabled);
+}
+//-----------------------------------------------------------------------------
+void dolfinx::set_trace(bool enabled, std::string filename)
+{
+  TimeLogManager::logger().set_trace(enabled, filename);
+}
+//-----------------------------------------------------------------------------
+void dolfinx::write_trace(MPI_Comm comm, std::string filename)
+{
+  TimeLogManager::logger().write_trace(comm, filename);
+}
+//-----------------------------------------------------------------------------
+bool dolfinx::set_hardware_counters(bool enabled)
+{
+  return TimeLogger::set_counters(enabled);
+}
+//-----------------------------------------------------------------------------
+void dolfinx::set_memory_tracking(bool enabled)
+{
+  TimeLogger::set_memory(enabled);
+}
+//-----------------------------------------------------------------------------
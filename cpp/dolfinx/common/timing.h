@@ -33,8 +33,8 @@ enum class TimingType : std::int32_t
 /// @returns Table with timings
 Table timings(std::set<TimingType> type);
 
-/// List a summary of timings and tasks. ``MPI_AVG`` reduction is
-/// printed.
+/// List a summary of timings and tasks, with the average, minimum and
+/// maximum over the processes (collective).
 /// @param[in] mpi_comm MPI Communicator
 /// @param[in] type Subset of { TimingType::wall, TimingType::user,
 ///                 TimingType::system }
@@ -47,4 +47,45 @@ void list_timings(MPI_Comm mpi_comm, std::set<TimingType> type);
 ///          time) for the task
 std::tuple<std::size_t, double, double, double> timing(std::string task);
 
+/// Enable or disable the registration of timings by timers with a task
+/// name (enabled by default). Timers still measure wall time if
+/// disabled.
+/// @param[in] enabled True to register timings
+void set_timing_enabled(bool enabled);
+
+/// Enable or disable the measurement of user and system times by
+/// timers (disabled by default, as it needs a system call at the start
+/// and stop of each timer)
+/// @param[in] enabled True to measure user and system times
+void set_cpu_timing(bool enabled);
+
+/// Enable or disable the sampling of hardware performance counters by
+/// timers with a task, which are tabulated per task by list_timings
+/// (disabled by default)
+/// @param[in] enabled True to sample the counters
+/// @return True if the counters can be read on the calling thread
+bool set_hardware_counters(bool enabled);
+
+/// Enable or disable the sampling of the memory usage of the process by
+/// timers with a task, to attribute the peak memory of the process to
+/// tasks such as mesh creation, partitioning and the dofmap build. The
+/// peak and retained memory of each task are tabulated by list_timings
+/// (disabled by default).
+/// @param[in] enabled True to sample the memory usage
+void set_memory_tracking(bool enabled);
+
+/// Enable or disable the recording of the begin and end of each timing
+/// with timestamps, for a timeline of the tasks of all processes and
+/// threads (see write_trace)
+/// @param[in] enabled True to record the timings
+/// @param[in] filename If not empty, the trace is written to the file
+///   (for MPI_COMM_WORLD) when MPI is finalised by DOLFINX
+void set_trace(bool enabled, std::string filename = "");
+
+/// Write the recorded timings of all processes as a Chrome trace (JSON),
+/// to view in chrome://tracing or Perfetto (collective)
+/// @param[in] comm MPI communicator
+/// @param[in] filename The name of the file
+void write_trace(MPI_Comm comm, std::string filename);
+
 } // namespace dolfinx
@@ -22,6 +22,29 @@ CoordinateElement::CoordinateElement(
       _is_affine(is_affine),
       _evaluate_basis_derivatives(evaluate_basis_derivatives)
 {
+  // Check if an affine map has the vertex basis of the linear simplex,
+  // phi_0 = 1 - sum_i X_i and phi_i = X_(i - 1), in which case the map
+  // x = x_0 + sum_i X_i (x_(i + 1) - x_0) is computed in closed form
+  if (_is_affine and _evaluate_basis_derivatives
+      and _dof_layout.num_dofs() == _tdim + 1)
+  {
+    const int d = _tdim + 1;
+    Eigen::VectorXd X0 = Eigen::VectorXd::Zero(_tdim);
+    Eigen::VectorXd phi(d);
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        dphi(d, _tdim);
+    _evaluate_basis_derivatives(phi.data(), 0, 1, X0.data());
+    _evaluate_basis_derivatives(dphi.data(), 1, 1, X0.data());
+
+    Eigen::VectorXd phi_ref = Eigen::VectorXd::Zero(d);
+    phi_ref[0] = 1.0;
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        dphi_ref(d, _tdim);
+    dphi_ref.row(0).setConstant(-1.0);
+    dphi_ref.bottomRows(_tdim).setIdentity();
+    _affine_simplex = (phi - phi_ref).cwiseAbs().maxCoeff() < 1.0e-12
+                      and (dphi - dphi_ref).cwiseAbs().maxCoeff() < 1.0e-12;
+  }
 }
 //-----------------------------------------------------------------------------
 std::string CoordinateElement::signature() const { return _signature; }
@@ -97,17 +120,32 @@ void CoordinateElement::compute_reference_geometry(
   if (_is_affine)
   {
     Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, 3, 1> x0(_gdim);
-    Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, 3, 1> X0(_tdim);
-    X0.setZero();
-    // Compute physical coordinates at X=0.
-    _evaluate_basis_derivatives(phi.data(), 0, 1, X0.data());
-    x0 = cell_geometry.matrix().transpose() * phi;
-
-    // Compute Jacobian and inverse
-    _evaluate_basis_derivatives(dphi.data(), 1, 1, X0.data());
     Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor, 3, 3>
         J0(_gdim, _tdim);
-    J0 = cell_geometry.matrix().transpose() * dphi;
+    if (_affine_simplex)
+    {
+      // Closed form: x0 is the first vertex and the columns of J are
+      // the edges from the first vertex
+      x0 = cell_geometry.row(0).matrix().transpose();
+      for (int j = 0; j < _tdim; ++j)
+        J0.col(j) = (cell_geometry.row(j + 1) - cell_geometry.row(0))
+                        .matrix()
+                        .transpose();
+    }
+    else
+    {
+      Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, 3, 1> X0(
+          _tdim);
+      X0.setZero();
+
+      // Compute physical coordinates at X=0.
+      _evaluate_basis_derivatives(phi.data(), 0, 1, X0.data());
+      x0 = cell_geometry.matrix().transpose() * phi;
+
+      // Compute Jacobian and inverse
+      _evaluate_basis_derivatives(dphi.data(), 1, 1, X0.data());
+      J0 = cell_geometry.matrix().transpose() * dphi;
+    }
     Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor, 3, 3>
         K0(_tdim, _gdim);
     if (_gdim == _tdim)
@@ -144,6 +182,11 @@ void CoordinateElement::compute_reference_geometry(
     Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, 3, 1> Xk(_tdim,
                                                                        1);
 
+    // Start the iteration for the first point at the midpoint of the
+    // reference cell, and for the following points (which are usually
+    // close, e.g. the points of a cell in Function::eval) at the
+    // reference coordinates of the previous point
+    Xk.setConstant(mesh::is_simplex(_cell) ? 1.0 / (_tdim + 1) : 0.5);
     for (int ip = 0; ip < num_points; ++ip)
     {
       Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic,
@@ -152,8 +195,6 @@ void CoordinateElement::compute_reference_geometry(
       Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic,
                                Eigen::RowMajor>>
           Kview(K.data() + ip * _gdim * _tdim, _tdim, _gdim);
-      // TODO: Xk - use cell midpoint instead?
-      Xk.setZero();
       const int max_its = 10;
       int k;
       for (k = 0; k < max_its; ++k)
@@ -73,7 +73,10 @@ public:
           cell_geometry) const;
 
   /// Compute reference coordinates X, and J, detJ and K for physical
-  /// coordinates x
+  /// coordinates x in a cell. For affine maps the pull-back is computed
+  /// directly, using the cell vertices for the linear simplex. For
+  /// other maps Newton's method is used for each point, starting from
+  /// the reference coordinates of the previous point.
   void compute_reference_geometry(
       Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>& X,
       Eigen::Tensor<double, 3, Eigen::RowMajor>& J,
@@ -102,6 +105,10 @@ private:
   // Flag denoting affine map
   bool _is_affine;
 
+  // Flag denoting an affine map with the vertex basis of the linear
+  // simplex, which is computed in closed form from the cell vertices
+  bool _affine_simplex = false;
+
   // Function to evaluate the basis on the underlying element
   // @param basis_values Returned values
   // @param order
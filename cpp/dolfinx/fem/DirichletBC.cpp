@@ -17,6 +17,7 @@
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/Topology.h>
 #include <dolfinx/mesh/cell_types.h>
+#include <dolfinx/mesh/utils.h>
 #include <map>
 #include <numeric>
 #include <utility>
@@ -381,16 +382,28 @@ _locate_dofs_topological(const function::FunctionSpace& V, const int entity_dim,
   return _dofs;
 }
 //-----------------------------------------------------------------------------
+// Get the cached coordinates of the dof blocks of a space (see
+// function::FunctionSpace::dof_coordinates), padded to three rows for
+// the marker
+Eigen::Array<double, 3, Eigen::Dynamic, Eigen::RowMajor>
+padded_dof_coordinates(const function::FunctionSpace& V)
+{
+  std::shared_ptr<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                     Eigen::RowMajor>>
+      x = V.dof_coordinates();
+  Eigen::Array<double, 3, Eigen::Dynamic, Eigen::RowMajor> coordinates
+      = Eigen::Array<double, 3, Eigen::Dynamic, Eigen::RowMajor>::Zero(
+          3, x->rows());
+  coordinates.topRows(x->cols()) = x->transpose();
+  return coordinates;
+}
+//-----------------------------------------------------------------------------
 Eigen::Array<std::int32_t, Eigen::Dynamic, 2> _locate_dofs_geometrical(
     const std::vector<std::reference_wrapper<function::FunctionSpace>>& V,
     const std::function<Eigen::Array<bool, Eigen::Dynamic, 1>(
         const Eigen::Ref<const Eigen::Array<double, 3, Eigen::Dynamic,
                                             Eigen::RowMajor>>&)>& marker)
 {
-  // FIXME: Calling V.tabulate_dof_coordinates() is very expensive,
-  // especially when we usually want the boundary dofs only. Add
-  // interface that computes dofs coordinates only for specified cell.
-
   // Get function spaces
   const function::FunctionSpace& V0 = V.at(0).get();
   const function::FunctionSpace& V1 = V.at(1).get();
@@ -411,13 +424,11 @@ Eigen::Array<std::int32_t, Eigen::Dynamic, 2> _locate_dofs_geometrical(
                              "one be a subelement of another.");
   }
 
-  // Compute dof coordinates
-  const Eigen::Array<double, 3, Eigen::Dynamic, Eigen::RowMajor> dof_coordinates
-      = V1.tabulate_dof_coordinates().transpose();
-
-  // Evaluate marker for each dof coordinate
-  const Eigen::Array<bool, Eigen::Dynamic, 1> marked_dofs
-      = marker(dof_coordinates);
+  // Evaluate marker for the (cached) coordinate of each dof block
+  assert(V1.element());
+  const int bs = V1.element()->block_size();
+  const Eigen::Array<bool, Eigen::Dynamic, 1> marked_blocks
+      = marker(padded_dof_coordinates(V1));
 
   // Get dofmaps
   std::shared_ptr<const fem::DofMap> dofmap0 = V0.dofmap();
@@ -437,7 +448,7 @@ Eigen::Array<std::int32_t, Eigen::Dynamic, 2> _locate_dofs_geometrical(
     // Loop over cell dofs and add to bc_dofs if marked.
     for (Eigen::Index i = 0; i < cell_dofs1.rows(); ++i)
     {
-      if (marked_dofs[cell_dofs1[i]])
+      if (marked_blocks[cell_dofs1[i] / bs])
       {
         bc_dofs.push_back(
             {(std::int32_t)cell_dofs0[i], (std::int32_t)cell_dofs1[i]});
@@ -466,24 +477,127 @@ Eigen::Array<std::int32_t, Eigen::Dynamic, 1> _locate_dofs_geometrical(
         const Eigen::Ref<const Eigen::Array<double, 3, Eigen::Dynamic,
                                             Eigen::RowMajor>>&)>& marker)
 {
-  // FIXME: Calling V.tabulate_dof_coordinates() is very expensive,
-  // especially when we usually want the boundary dofs only. Add
-  // interface that computes dofs coordinates only for specified cell.
+  // Compute marker for the (cached) coordinate of each dof block
+  assert(V.element());
+  const int bs = V.element()->block_size();
+  const Eigen::Array<bool, Eigen::Dynamic, 1> marked_blocks
+      = marker(padded_dof_coordinates(V));
 
-  // Compute dof coordinates
-  const Eigen::Array<double, 3, Eigen::Dynamic, Eigen::RowMajor> dof_coordinates
-      = V.tabulate_dof_coordinates().transpose();
+  std::vector<std::int32_t> dofs;
+  dofs.reserve(bs * marked_blocks.count());
+  for (Eigen::Index i = 0; i < marked_blocks.rows(); ++i)
+  {
+    if (marked_blocks[i])
+      for (int j = 0; j < bs; ++j)
+        dofs.push_back(bs * i + j);
+  }
 
-  // Compute marker for each dof coordinate
-  const Eigen::Array<bool, Eigen::Dynamic, 1> marked_dofs
-      = marker(dof_coordinates);
+  return Eigen::Map<Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>(dofs.data(),
+                                                                   dofs.size());
+}
+//-----------------------------------------------------------------------------
+// Evaluate the marker at the coordinates of the dof blocks of the
+// (non-sub) space V in the closure of the exterior facets. Returns the
+// markers of all blocks of V (false for the interior blocks).
+std::vector<bool> mark_boundary_blocks(
+    const function::FunctionSpace& V,
+    const std::function<Eigen::Array<bool, Eigen::Dynamic, 1>(
+        const Eigen::Ref<const Eigen::Array<double, 3, Eigen::Dynamic,
+                                            Eigen::RowMajor>>&)>& marker)
+{
+  assert(V.mesh());
+  assert(V.element());
+  assert(V.dofmap());
+  const mesh::Mesh& mesh = *V.mesh();
+  const int tdim = mesh.topology().dim();
+  const int bs = V.element()->block_size();
+
+  // Get the dofs in the closure of the exterior facets, including the
+  // dofs whose boundary facets are on other processes
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1> facets
+      = mesh::exterior_facet_indices(mesh);
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1> boundary_dofs
+      = _locate_dofs_topological(V, tdim - 1, facets, true);
+
+  // Get the distinct dof blocks (the dofs are sorted)
+  std::vector<std::int32_t> blocks;
+  for (Eigen::Index i = 0; i < boundary_dofs.rows(); ++i)
+  {
+    const std::int32_t block = boundary_dofs[i] / bs;
+    if (blocks.empty() or blocks.back() != block)
+      blocks.push_back(block);
+  }
+
+  // Evaluate marker at the coordinates of the blocks only
+  const Eigen::Array<double, 3, Eigen::Dynamic, Eigen::RowMajor> x
+      = V.tabulate_scalar_subspace_dof_coordinates(blocks).transpose();
+  const Eigen::Array<bool, Eigen::Dynamic, 1> marked = marker(x);
+  if (marked.rows() != x.cols())
+    throw std::runtime_error("Length of array of markers is wrong.");
+
+  assert(V.dofmap()->index_map);
+  const common::IndexMap& map = *V.dofmap()->index_map;
+  std::vector<bool> marked_blocks(
+      map.block_size() * (map.size_local() + map.num_ghosts()) / bs, false);
+  for (std::size_t i = 0; i < blocks.size(); ++i)
+    marked_blocks[blocks[i]] = marked[i];
+  return marked_blocks;
+}
+//-----------------------------------------------------------------------------
+Eigen::Array<std::int32_t, Eigen::Dynamic, 2> _locate_boundary_dofs_geometrical(
+    const std::vector<std::reference_wrapper<function::FunctionSpace>>& V,
+    const std::function<Eigen::Array<bool, Eigen::Dynamic, 1>(
+        const Eigen::Ref<const Eigen::Array<double, 3, Eigen::Dynamic,
+                                            Eigen::RowMajor>>&)>& marker)
+{
+  const function::FunctionSpace& V1 = V.at(1).get();
+  assert(V1.mesh());
+  assert(V1.element());
+  const int tdim = V1.mesh()->topology().dim();
+  const int bs = V1.element()->block_size();
+
+  // Evaluate marker at the boundary dof blocks of V1
+  const std::vector<bool> marked_blocks = mark_boundary_blocks(V1, marker);
+
+  // Keep the boundary dof pairs whose dof in V1 is marked
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 2> boundary_dofs
+      = _locate_dofs_topological(V, tdim - 1,
+                                 mesh::exterior_facet_indices(*V1.mesh()),
+                                 true);
+  std::vector<std::array<std::int32_t, 2>> bc_dofs;
+  for (Eigen::Index i = 0; i < boundary_dofs.rows(); ++i)
+  {
+    if (marked_blocks[boundary_dofs(i, 1) / bs])
+      bc_dofs.push_back({boundary_dofs(i, 0), boundary_dofs(i, 1)});
+  }
+
+  // Copy to Eigen array
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 2> dofs(bc_dofs.size(), 2);
+  for (std::size_t i = 0; i < bc_dofs.size(); ++i)
+  {
+    dofs(i, 0) = bc_dofs[i][0];
+    dofs(i, 1) = bc_dofs[i][1];
+  }
+
+  return dofs;
+}
+//-----------------------------------------------------------------------------
+Eigen::Array<std::int32_t, Eigen::Dynamic, 1> _locate_boundary_dofs_geometrical(
+    const function::FunctionSpace& V,
+    const std::function<Eigen::Array<bool, Eigen::Dynamic, 1>(
+        const Eigen::Ref<const Eigen::Array<double, 3, Eigen::Dynamic,
+                                            Eigen::RowMajor>>&)>& marker)
+{
+  assert(V.element());
+  const int bs = V.element()->block_size();
+  const std::vector<bool> marked_blocks = mark_boundary_blocks(V, marker);
 
   std::vector<std::int32_t> dofs;
-  dofs.reserve(marked_dofs.count());
-  for (Eigen::Index i = 0; i < marked_dofs.rows(); ++i)
+  for (std::size_t i = 0; i < marked_blocks.size(); ++i)
   {
-    if (marked_dofs[i])
-      dofs.push_back(i);
+    if (marked_blocks[i])
+      for (int j = 0; j < bs; ++j)
+        dofs.push_back(bs * i + j);
   }
 
   return Eigen::Map<Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>(dofs.data(),
@@ -511,10 +625,15 @@ fem::locate_dofs_geometrical(
     const std::vector<std::reference_wrapper<function::FunctionSpace>>& V,
     const std::function<Eigen::Array<bool, Eigen::Dynamic, 1>(
         const Eigen::Ref<const Eigen::Array<double, 3, Eigen::Dynamic,
-                                            Eigen::RowMajor>>&)>& marker)
+                                            Eigen::RowMajor>>&)>& marker,
+    bool boundary_only)
 {
-  if (V.size() == 2)
+  if (V.size() == 2 and boundary_only)
+    return _locate_boundary_dofs_geometrical(V, marker);
+  else if (V.size() == 2)
     return _locate_dofs_geometrical(V, marker);
+  else if (V.size() == 1 and boundary_only)
+    return _locate_boundary_dofs_geometrical(V[0].get(), marker);
   else if (V.size() == 1)
     return _locate_dofs_geometrical(V[0].get(), marker);
   else
@@ -7,10 +7,16 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <algorithm>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/FiniteElement.h>
 #include <dolfinx/function/Function.h>
+#include <dolfinx/function/FunctionSpace.h>
 #include <dolfinx/la/utils.h>
 #include <functional>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 namespace dolfinx
@@ -75,6 +81,12 @@ locate_dofs_topological(
 ///     will be located. The spaces must share the same mesh and
 ///     element type.
 /// @param[in] marker Function marking tabulated degrees of freedom
+/// @param[in] boundary_only If true, only the degrees of freedom in the
+///     closure of the exterior facets of the mesh are candidates, and
+///     the marker is evaluated at the coordinates of these degrees of
+///     freedom only. This avoids the tabulation of the coordinates of
+///     all degrees of freedom when the marker describes (part of) the
+///     boundary.
 /// @return Array of local DOF indices in the spaces V[0] (and V[1] is
 ///     two spaces are passed in). If two spaces are passed in, the (i,
 ///     0) entry is the DOF index in the space V[0] and (i, 1) is the
@@ -84,7 +96,8 @@ locate_dofs_geometrical(
     const std::vector<std::reference_wrapper<function::FunctionSpace>>& V,
     const std::function<Eigen::Array<bool, Eigen::Dynamic, 1>(
         const Eigen::Ref<const Eigen::Array<double, 3, Eigen::Dynamic,
-                                            Eigen::RowMajor>>&)>& marker);
+                                            Eigen::RowMajor>>&)>& marker,
+    bool boundary_only = false);
 
 /// Interface for setting (strong) Dirichlet boundary conditions
 ///
@@ -95,7 +108,9 @@ locate_dofs_geometrical(
 ///
 /// A DirichletBC is specified by the function g, the function space
 /// (trial space) and degrees of freedom to which the boundary condition
-/// applies.
+/// applies. For time-dependent conditions, the boundary values can be
+/// updated from an expression evaluated at the constrained dofs only
+/// (see update).
 
 template <typename T>
 class DirichletBC
@@ -122,6 +137,7 @@ public:
     auto* it = std::lower_bound(_dofs.col(0).data(),
                                 _dofs.col(0).data() + _dofs.rows(), owned_size);
     _owned_indices = std::distance(_dofs.col(0).data(), it);
+    compute_cells();
   }
 
   /// Create boundary condition
@@ -145,6 +161,7 @@ public:
     auto* it = std::lower_bound(_dofs.col(0).data(),
                                 _dofs.col(0).data() + _dofs.rows(), owned_size);
     _owned_indices = std::distance(_dofs.col(0).data(), it);
+    compute_cells();
   }
 
   /// Copy constructor
@@ -183,6 +200,12 @@ public:
     return _dofs;
   }
 
+  /// Get the cells (local and ghost) that have at least one dof to
+  /// which the boundary condition is applied, e.g. to skip the
+  /// boundary condition checks for other cells in assembly
+  /// @return The sorted cell indices
+  const std::vector<std::int32_t>& cells() const { return _cells; }
+
   /// Get array of dof indices owned by this process to which a
   /// Dirichlet BC is applied. The array is sorted and does not contain
   /// ghost entries.
@@ -192,6 +215,48 @@ public:
     return _dofs.block<Eigen::Dynamic, 2>(0, 0, _owned_indices, 2);
   }
 
+  /// Update the boundary values from an expression evaluated only at
+  /// the coordinates of the constrained dofs, e.g. for each step of a
+  /// time-dependent problem. The coordinates are computed on the first
+  /// call and cached, so the cost of later calls is proportional to the
+  /// number of constrained dofs. The updated values are used by set and
+  /// dof_values in place of the values of the function value(), which
+  /// is not modified.
+  /// @param[in] f The expression, as for function::Function::interpolate.
+  ///   It is evaluated at points x (shape (3, num_points)) and returns
+  ///   the values (shape (value_size, num_points)).
+  void update(
+      const std::function<
+          Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>(
+              const Eigen::Ref<const Eigen::Array<double, 3, Eigen::Dynamic,
+                                                  Eigen::RowMajor>>&)>& f)
+  {
+    if (_values.size() != (std::size_t)_dofs.rows())
+      tabulate_points();
+
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        values
+        = f(_points);
+
+    // Vector-valued results for scalar expressions may have a single
+    // column (see function::interpolate)
+    const bool column = values.cols() == 1 and values.rows() != 1;
+    const Eigen::Index num_points = column ? values.rows() : values.cols();
+    if (num_points != _points.cols())
+    {
+      throw std::runtime_error("Number of computed values is not equal to the "
+                               "number of evaluation points.");
+    }
+    const int value_size = column ? 1 : values.rows();
+    for (std::size_t i = 0; i < _values.size(); ++i)
+    {
+      if (_components[i] >= value_size)
+        throw std::runtime_error("Values shape is incorrect.");
+      _values[i] = column ? values(_point_index[i], 0)
+                          : values(_components[i], _point_index[i]);
+    }
+  }
+
   /// Set bc entries in x to scale*x_bc
   /// @todo Clarify w.r.t ghosts
   void set(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> x,
@@ -203,7 +268,7 @@ public:
     for (Eigen::Index i = 0; i < _dofs.rows(); ++i)
     {
       if (_dofs(i, 0) < x.rows())
-        x[_dofs(i, 0)] = scale * g[_dofs(i, 1)];
+        x[_dofs(i, 0)] = scale * g_value(g, i);
     }
   }
 
@@ -220,7 +285,7 @@ public:
     for (Eigen::Index i = 0; i < _dofs.rows(); ++i)
     {
       if (_dofs(i, 0) < x.rows())
-        x[_dofs(i, 0)] = scale * (g[_dofs(i, 1)] - x0[_dofs(i, 0)]);
+        x[_dofs(i, 0)] = scale * (g_value(g, i) - x0[_dofs(i, 0)]);
     }
   }
 
@@ -232,13 +297,16 @@ public:
     assert(_g);
     auto& g = _g->x()->array();
     for (Eigen::Index i = 0; i < _dofs.rows(); ++i)
-      values[_dofs(i, 0)] = g[_dofs(i, 1)];
+      values[_dofs(i, 0)] = g_value(g, i);
   }
 
   /// Set markers[i] = true if dof i has a boundary condition applied.
   /// Value of markers[i] is not changed otherwise.
+  /// @param[in,out] markers The markers, e.g. a std::vector<bool> or
+  ///   std::vector<std::int8_t>
   /// @todo Clarify w.r.t ghosts
-  void mark_dofs(std::vector<bool>& markers) const
+  template <typename U>
+  void mark_dofs(U& markers) const
   {
     for (Eigen::Index i = 0; i < _dofs.rows(); ++i)
     {
@@ -248,6 +316,63 @@ public:
   }
 
 private:
+  // Value for row i of _dofs, from update if it has been called and
+  // from the coefficients g of _g otherwise
+  T g_value(const Eigen::Matrix<T, Eigen::Dynamic, 1>& g, Eigen::Index i) const
+  {
+    return _values.empty() ? g[_dofs(i, 1)] : _values[i];
+  }
+
+  // Compute the cells with constrained dofs
+  void compute_cells()
+  {
+    std::shared_ptr<const DofMap> dofmap = _function_space->dofmap();
+    assert(dofmap);
+    std::shared_ptr<const common::IndexMap> map = dofmap->index_map;
+    assert(map);
+    std::vector<bool> markers(
+        map->block_size() * (map->size_local() + map->num_ghosts()), false);
+    mark_dofs(markers);
+    _cells = cells_with_marked_dofs(*dofmap, markers);
+  }
+
+  // Compute the evaluation points and components of the constrained
+  // dofs of the space of _g, for update
+  void tabulate_points()
+  {
+    assert(_g);
+    std::shared_ptr<const function::FunctionSpace> V = _g->function_space();
+    assert(V);
+    std::shared_ptr<const FiniteElement> element = V->element();
+    assert(element);
+    if (element->family() == "Mixed")
+    {
+      throw std::runtime_error("Cannot update boundary values of a function "
+                               "in a mixed space.");
+    }
+
+    // The dof bs * j + k of the space of _g is component k at the
+    // point of dof j of its scalar subspace
+    const int bs = element->block_size();
+    std::vector<std::int32_t> nodes(_dofs.rows());
+    for (Eigen::Index i = 0; i < _dofs.rows(); ++i)
+      nodes[i] = _dofs(i, 1) / bs;
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    _points = V->tabulate_scalar_subspace_dof_coordinates(nodes).transpose();
+
+    _point_index.resize(_dofs.rows());
+    _components.resize(_dofs.rows());
+    for (Eigen::Index i = 0; i < _dofs.rows(); ++i)
+    {
+      _point_index[i] = std::distance(
+          nodes.begin(),
+          std::lower_bound(nodes.begin(), nodes.end(), _dofs(i, 1) / bs));
+      _components[i] = _dofs(i, 1) % bs;
+    }
+    _values.resize(_dofs.rows());
+  }
+
   // The function space (possibly a sub function space)
   std::shared_ptr<const function::FunctionSpace> _function_space;
 
@@ -260,6 +385,18 @@ private:
 
   // The first _owned_indices in _dofs are owned by this process
   int _owned_indices = -1;
+
+  // Cells with at least one constrained dof
+  std::vector<std::int32_t> _cells;
+
+  // Evaluation points of the constrained dofs of the space of _g, and
+  // the point and value component of row i of _dofs (see update)
+  Eigen::Array<double, 3, Eigen::Dynamic, Eigen::RowMajor> _points;
+  std::vector<std::int32_t> _point_index;
+  std::vector<int> _components;
+
+  // Boundary values set by update, empty if update has not been called
+  std::vector<T> _values;
 };
 } // namespace fem
 } // namespace dolfinx
@@ -5,148 +5,413 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "DiscreteOperators.h"
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/fem/CoordinateElement.h>
 #include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/ElementDofLayout.h>
+#include <dolfinx/fem/FiniteElement.h>
 #include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/la/PETScMatrix.h>
-#include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/la/PETScVector.h>
 #include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <dolfinx/mesh/cell_types.h>
+#include <numeric>
+#include <stdexcept>
+#include <unsupported/Eigen/CXX11/Tensor>
 #include <vector>
 
 using namespace dolfinx;
 using namespace dolfinx::fem;
 
-// //-----------------------------------------------------------------------------
-// la::PETScMatrix
-// DiscreteOperators::build_gradient(const function::FunctionSpace& V0,
-//                                   const function::FunctionSpace& V1)
-// {
-//   // TODO: This function would be significantly simplified if it was
-//   // easier to build matrix sparsity patterns.
-
-//   // Get mesh
-//   assert(V0.mesh());
-//   const mesh::Mesh& mesh = *(V0.mesh());
-
-//   // Check that mesh is the same for both function spaces
-//   assert(V1.mesh());
-//   if (&mesh != V1.mesh().get())
-//   {
-//     throw std::runtime_error(
-//         "Ccompute discrete gradient operator. Function spaces "
-//         "do not share the same mesh");
-//   }
-
-//   // Check that V0 is a (lowest-order) edge basis
-//   mesh.topology_mutable().create_entities(1);
-//   if (V0.dim() != mesh.num_entities_global(1))
-//   {
-//     throw std::runtime_error(
-//         "Cannot compute discrete gradient operator. Function "
-//         "spaces is not a lowest-order edge space");
-//   }
-
-//   // Check that V1 is a linear nodal basis
-//   if (V1.dim() != mesh.num_entities_global(0))
-//   {
-//     throw std::runtime_error(
-//         "Cannot compute discrete gradient operator. Function "
-//         "space is not a linear nodal function space");
-//   }
-
-//   // Build maps from entities to local dof indices
-//   const Eigen::Array<std::int32_t, Eigen::Dynamic, 1> edge_to_dof
-//       = V0.dofmap()->dofs(mesh.topology(), 1);
-//   const Eigen::Array<std::int32_t, Eigen::Dynamic, 1> vertex_to_dof
-//       = V1.dofmap()->dofs(mesh.topology(), 0);
-
-//   // Build maps from local dof numbering to global
-//   Eigen::Array<std::int64_t, Eigen::Dynamic, 1> local_to_global_map0
-//       = V0.dofmap()->index_map->indices(true);
-//   Eigen::Array<std::int64_t, Eigen::Dynamic, 1> local_to_global_map1
-//       = V1.dofmap()->index_map->indices(true);
-
-//   // Initialize edge -> vertex connections
-//   mesh.create_connectivity(1, 0);
-
-//   // Copy index maps from dofmaps
-//   std::array<std::shared_ptr<const common::IndexMap>, 2> index_maps
-//       = {{V0.dofmap()->index_map, V1.dofmap()->index_map}};
-//   std::vector<std::array<std::int64_t, 2>> local_range
-//       = {{index_maps[0]->block_size * index_maps[0]->local_range()[0],
-//           index_maps[0]->block_size * index_maps[0]->local_range()[1]},
-//          {index_maps[1]->block_size * index_maps[1]->local_range()[0],
-//           index_maps[1]->block_size * index_maps[1]->local_range()[1]}};
-
-//   // Initialise sparsity pattern
-//   la::SparsityPattern pattern(mesh.mpi_comm(), index_maps);
-
-//   // Build sparsity pattern
-//   std::vector<PetscInt> rows;
-//   std::vector<PetscInt> cols;
-//   for (auto& edge : mesh::MeshRange(mesh, 1))
-//   {
-//     // Row index (global indices)
-//     const std::int64_t row = local_to_global_map0[edge_to_dof[edge.index()]];
-//     rows.push_back(row);
-
-//     if (row >= local_range[0][0] and row < local_range[0][1])
-//     {
-//       // Column indices (global indices)
-//       const mesh::MeshEntity v0(mesh, 0, edge.entities(0)[0]);
-//       const mesh::MeshEntity v1(mesh, 0, edge.entities(0)[1]);
-//       std::size_t col0 = local_to_global_map1[vertex_to_dof[v0.index()]];
-//       std::size_t col1 = local_to_global_map1[vertex_to_dof[v1.index()]];
-//       cols.push_back(col0);
-//       cols.push_back(col1);
-//     }
-//   }
-
-//   Eigen::Map<const Eigen::Array<PetscInt, Eigen::Dynamic, 1>> _rows(
-//       rows.data(), rows.size());
-//   Eigen::Map<const Eigen::Array<PetscInt, Eigen::Dynamic, 1>> _cols(
-//       cols.data(), cols.size());
-//   pattern.insert_global(_rows, _cols);
-//   pattern.assemble();
-
-//   // Create matrix
-//   la::PETScMatrix A(mesh.mpi_comm(), pattern);
-
-//   // Build discrete gradient operator/matrix
-//   const std::vector<std::int64_t>& global_indices
-//       = mesh.topology().global_indices(0);
-//   for (auto& edge : mesh::MeshRange(mesh, 1))
-//   {
-//     PetscInt row;
-//     PetscInt cols[2];
-//     PetscScalar values[2];
-
-//     row = local_to_global_map0[edge_to_dof[edge.index()]];
-
-//     mesh::MeshEntity v0(mesh, 0, edge.entities(0)[0]);
-//     mesh::MeshEntity v1(mesh, 0, edge.entities(0)[1]);
-
-//     cols[0] = local_to_global_map1[vertex_to_dof[v0.index()]];
-//     cols[1] = local_to_global_map1[vertex_to_dof[v1.index()]];
-//     if (global_indices[v1.index()] < global_indices[v0.index()])
-//     {
-//       values[0] = 1.0;
-//       values[1] = -1.0;
-//     }
-//     else
-//     {
-//       values[0] = -1.0;
-//       values[1] = 1.0;
-//     }
-
-//     // Set values in matrix
-//     A.set(values, 1, &row, 2, cols);
-//   }
-
-//   // Finalise matrix
-//   A.apply(la::PETScMatrix::AssemblyType::FINAL);
-
-//   return A;
-// }
-// //-----------------------------------------------------------------------------
+namespace
+{
+//-----------------------------------------------------------------------------
+// Create a PETSc MPIAIJ matrix from the CSR arrays of the owned rows,
+// with global column indices. The arrays are copied.
+la::PETScMatrix create_matrix(MPI_Comm comm, const common::IndexMap& map0,
+                              const common::IndexMap& map1,
+                              std::vector<PetscInt>& row_ptr,
+                              std::vector<PetscInt>& cols,
+                              std::vector<PetscScalar>& values)
+{
+  const PetscInt m = map0.block_size() * map0.size_local();
+  const PetscInt n = map1.block_size() * map1.size_local();
+  const PetscInt M = map0.block_size() * map0.size_global();
+  const PetscInt N = map1.block_size() * map1.size_global();
+  assert((PetscInt)row_ptr.size() == m + 1);
+
+  Mat A;
+  PetscErrorCode ierr = MatCreateMPIAIJWithArrays(
+      comm, m, n, M, N, row_ptr.data(), cols.data(), values.data(), &A);
+  if (ierr != 0)
+    la::petsc_error(ierr, __FILE__, "MatCreateMPIAIJWithArrays");
+
+  return la::PETScMatrix(A, false);
+}
+//-----------------------------------------------------------------------------
+// Sort the entries of each row of a CSR matrix by column index
+void sort_rows(const std::vector<PetscInt>& row_ptr,
+               std::vector<PetscInt>& cols, std::vector<PetscScalar>& values)
+{
+  std::vector<int> perm;
+  std::vector<PetscInt> row_cols;
+  std::vector<PetscScalar> row_values;
+  for (std::size_t i = 0; i + 1 < row_ptr.size(); ++i)
+  {
+    const PetscInt offset = row_ptr[i];
+    const int num_entries = row_ptr[i + 1] - offset;
+    perm.resize(num_entries);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::sort(perm.begin(), perm.end(), [&cols, offset](int a, int b) {
+      return cols[offset + a] < cols[offset + b];
+    });
+    row_cols.assign(cols.begin() + offset,
+                    cols.begin() + offset + num_entries);
+    row_values.assign(values.begin() + offset,
+                      values.begin() + offset + num_entries);
+    for (int k = 0; k < num_entries; ++k)
+    {
+      cols[offset + k] = row_cols[perm[k]];
+      values[offset + k] = row_values[perm[k]];
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+// Get the dof of each entity of dimension dim for a space with one dof
+// per entity of dimension dim
+std::vector<std::int32_t> entity_to_dof(const mesh::Mesh& mesh,
+                                        const fem::DofMap& dofmap, int dim)
+{
+  const int tdim = mesh.topology().dim();
+  auto c_to_e = mesh.topology().connectivity(tdim, dim);
+  assert(c_to_e);
+  auto map_e = mesh.topology().index_map(dim);
+  assert(map_e);
+  auto map_c = mesh.topology().index_map(tdim);
+  assert(map_c);
+
+  const int num_cell_entities = c_to_e->num_links(0);
+  std::vector<int> local_dofs(num_cell_entities);
+  for (int e = 0; e < num_cell_entities; ++e)
+    local_dofs[e] = dofmap.element_dof_layout->entity_dofs(dim, e)[0];
+
+  std::vector<std::int32_t> dofs(map_e->size_local() + map_e->num_ghosts(),
+                                 -1);
+  const std::int32_t num_cells = map_c->size_local() + map_c->num_ghosts();
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    auto entities = c_to_e->links(c);
+    auto cell_dofs = dofmap.cell_dofs(c);
+    for (int e = 0; e < num_cell_entities; ++e)
+      dofs[entities[e]] = cell_dofs[local_dofs[e]];
+  }
+
+  return dofs;
+}
+//-----------------------------------------------------------------------------
+// Check that the dofs of a space are one scalar dof per entity of
+// dimension dim
+bool has_entity_dofs(const function::FunctionSpace& V, int dim)
+{
+  assert(V.element());
+  assert(V.dofmap());
+  const fem::ElementDofLayout& layout = *V.dofmap()->element_dof_layout;
+  const mesh::CellType cell_type = V.mesh()->topology().cell_type();
+  return V.element()->block_size() == 1
+         and layout.num_entity_dofs(dim) == 1
+         and layout.num_dofs() == mesh::cell_num_entities(cell_type, dim);
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+la::PETScMatrix
+DiscreteOperators::build_gradient(const function::FunctionSpace& V0,
+                                  const function::FunctionSpace& V1)
+{
+  common::Timer t0("Build discrete gradient");
+
+  // Check that mesh is the same for both function spaces
+  assert(V0.mesh());
+  assert(V1.mesh());
+  const mesh::Mesh& mesh = *V0.mesh();
+  if (&mesh != V1.mesh().get())
+  {
+    throw std::runtime_error(
+        "Cannot compute discrete gradient operator. Function spaces "
+        "do not share the same mesh");
+  }
+
+  // Check that V0 is a (lowest-order) edge basis, and that V1 is a
+  // linear nodal basis
+  const int tdim = mesh.topology().dim();
+  mesh.topology_mutable().create_entities(1);
+  mesh.topology_mutable().create_connectivity(tdim, 1);
+  mesh.topology_mutable().create_connectivity(1, 0);
+  if (!has_entity_dofs(V0, 1) or V0.element()->value_size() == 1)
+  {
+    throw std::runtime_error(
+        "Cannot compute discrete gradient operator. Function "
+        "space is not a lowest-order edge space");
+  }
+  if (!has_entity_dofs(V1, 0) or V1.element()->value_size() != 1)
+  {
+    throw std::runtime_error(
+        "Cannot compute discrete gradient operator. Function "
+        "space is not a linear nodal function space");
+  }
+
+  // Map the owned edge dofs (rows) to edges, and the vertices to dofs
+  std::shared_ptr<const common::IndexMap> map0 = V0.dofmap()->index_map;
+  std::shared_ptr<const common::IndexMap> map1 = V1.dofmap()->index_map;
+  assert(map0);
+  assert(map1);
+  const std::int32_t num_rows = map0->size_local();
+  const std::vector<std::int32_t> edge_to_dof
+      = entity_to_dof(mesh, *V0.dofmap(), 1);
+  std::vector<std::int32_t> row_to_edge(num_rows, -1);
+  for (std::size_t e = 0; e < edge_to_dof.size(); ++e)
+    if (edge_to_dof[e] < num_rows)
+      row_to_edge[edge_to_dof[e]] = e;
+  const std::vector<std::int32_t> vertex_to_dof
+      = entity_to_dof(mesh, *V1.dofmap(), 0);
+
+  // Build the rows from the edge-vertex connectivity. Each row has the
+  // two entries of the vertices of its edge, ordered by column.
+  auto e_to_v = mesh.topology().connectivity(1, 0);
+  assert(e_to_v);
+  const std::vector<std::int64_t> global_vertices
+      = mesh.topology().index_map(0)->global_indices(false);
+  const std::vector<std::int64_t> global_cols = map1->global_indices(false);
+  std::vector<PetscInt> row_ptr(num_rows + 1);
+  std::vector<PetscInt> cols(2 * num_rows);
+  std::vector<PetscScalar> values(2 * num_rows);
+  for (std::int32_t i = 0; i < num_rows; ++i)
+  {
+    assert(row_to_edge[i] >= 0);
+    auto vertices = e_to_v->links(row_to_edge[i]);
+    std::array<std::int32_t, 2> v = {vertices[0], vertices[1]};
+    if (global_vertices[v[1]] < global_vertices[v[0]])
+      std::swap(v[0], v[1]);
+    std::array<PetscInt, 2> c = {(PetscInt)global_cols[vertex_to_dof[v[0]]],
+                                 (PetscInt)global_cols[vertex_to_dof[v[1]]]};
+    std::array<PetscScalar, 2> a = {-1.0, 1.0};
+    if (c[1] < c[0])
+    {
+      std::swap(c[0], c[1]);
+      std::swap(a[0], a[1]);
+    }
+
+    row_ptr[i] = 2 * i;
+    std::copy(c.begin(), c.end(), cols.begin() + 2 * i);
+    std::copy(a.begin(), a.end(), values.begin() + 2 * i);
+  }
+  row_ptr[num_rows] = 2 * num_rows;
+
+  return create_matrix(mesh.mpi_comm(), *map0, *map1, row_ptr, cols, values);
+}
+//-----------------------------------------------------------------------------
+la::PETScMatrix
+DiscreteOperators::build_interpolation(const function::FunctionSpace& V0,
+                                       const function::FunctionSpace& V1)
+{
+  common::Timer t0("Build discrete interpolation operator");
+
+  // Check that mesh is the same for both function spaces
+  assert(V0.mesh());
+  assert(V1.mesh());
+  const mesh::Mesh& mesh = *V0.mesh();
+  if (&mesh != V1.mesh().get())
+  {
+    throw std::runtime_error(
+        "Cannot compute discrete interpolation operator. Function spaces "
+        "do not share the same mesh");
+  }
+
+  // Check the elements, and use the sub-elements of blocked (vector and
+  // tensor) elements
+  std::shared_ptr<const fem::FiniteElement> element0 = V0.element();
+  std::shared_ptr<const fem::FiniteElement> element1 = V1.element();
+  assert(element0);
+  assert(element1);
+  const int bs = element0->block_size();
+  if (element1->block_size() != bs)
+  {
+    throw std::runtime_error(
+        "Cannot compute discrete interpolation operator. Elements have "
+        "different block sizes");
+  }
+  if (bs == 1
+      and (element0->num_sub_elements() > 0
+           or element1->num_sub_elements() > 0))
+  {
+    throw std::runtime_error(
+        "Cannot compute discrete interpolation operator. Mixed elements "
+        "are not supported");
+  }
+  if (bs > 1)
+  {
+    element0 = element0->extract_sub_element({0});
+    element1 = element1->extract_sub_element({0});
+  }
+  const int value_size = element0->value_size();
+  if (element1->value_size() != value_size)
+  {
+    throw std::runtime_error(
+        "Cannot compute discrete interpolation operator. Elements have "
+        "different value sizes");
+  }
+
+  // The positions of the dofs of each component in the cell dofs
+  std::shared_ptr<const fem::DofMap> dofmap0 = V0.dofmap();
+  std::shared_ptr<const fem::DofMap> dofmap1 = V1.dofmap();
+  assert(dofmap0);
+  assert(dofmap1);
+  std::vector<std::vector<int>> pos0(bs), pos1(bs);
+  for (int k = 0; k < bs; ++k)
+  {
+    if (bs == 1)
+    {
+      pos0[k].resize(element0->space_dimension());
+      std::iota(pos0[k].begin(), pos0[k].end(), 0);
+      pos1[k].resize(element1->space_dimension());
+      std::iota(pos1[k].begin(), pos1[k].end(), 0);
+    }
+    else
+    {
+      pos0[k] = dofmap0->element_dof_layout->sub_view({k});
+      pos1[k] = dofmap1->element_dof_layout->sub_view({k});
+    }
+  }
+
+  // Tabulate the basis of V1 at the dof points of V0 on the reference
+  // cell
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+      X = element0->dof_reference_coordinates();
+  const int num_points = X.rows();
+  const int space_dim0 = element0->space_dimension();
+  const int space_dim1 = element1->space_dimension();
+  std::shared_ptr<const Eigen::Tensor<double, 3, Eigen::RowMajor>>
+      reference_basis = element1->tabulate_reference_basis(X);
+
+  // Geometry data
+  const int gdim = mesh.geometry().dim();
+  const int tdim = mesh.topology().dim();
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
+  const int num_dofs_g = x_dofmap.num_links(0);
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
+      = mesh.geometry().x();
+  const fem::CoordinateElement& cmap = mesh.geometry().cmap();
+  mesh.topology_mutable().create_cell_permutation_info();
+  const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info
+      = mesh.topology().get_cell_permutation_info();
+
+  // Work arrays
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      coordinate_dofs(num_dofs_g, gdim);
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> x(
+      num_points, gdim);
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Xc(
+      num_points, tdim);
+  Eigen::Tensor<double, 3, Eigen::RowMajor> J(num_points, gdim, tdim);
+  Eigen::Tensor<double, 3, Eigen::RowMajor> K(num_points, tdim, gdim);
+  Eigen::Array<double, Eigen::Dynamic, 1> detJ(num_points);
+  Eigen::Tensor<double, 3, Eigen::RowMajor> basis(num_points, space_dim1,
+                                                  value_size);
+  Eigen::Array<PetscScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      basis_values(num_points, value_size);
+  Eigen::Array<PetscScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor>
+      A_cell(space_dim0, space_dim1);
+
+  // Compute each owned row on the first cell that contains its dof. The
+  // rows are appended in the order in which they are computed, and
+  // reordered at the end.
+  std::shared_ptr<const common::IndexMap> map0 = dofmap0->index_map;
+  std::shared_ptr<const common::IndexMap> map1 = dofmap1->index_map;
+  assert(map0);
+  assert(map1);
+  const std::int32_t num_rows = map0->block_size() * map0->size_local();
+  const std::vector<std::int64_t> global_cols = map1->global_indices(false);
+  std::vector<std::int32_t> row_offset(num_rows, -1), row_size(num_rows, 0);
+  std::vector<PetscInt> unordered_cols;
+  std::vector<PetscScalar> unordered_values;
+  constexpr double tol = 1e-12;
+
+  auto map_c = mesh.topology().index_map(tdim);
+  assert(map_c);
+  const std::int32_t num_cells = map_c->size_local() + map_c->num_ghosts();
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    auto dofs0 = dofmap0->cell_dofs(c);
+    bool has_new_rows = false;
+    for (Eigen::Index i = 0; i < dofs0.size() and !has_new_rows; ++i)
+      has_new_rows = dofs0[i] < num_rows and row_offset[dofs0[i]] < 0;
+    if (!has_new_rows)
+      continue;
+
+    // Push the basis of V1 forward to the cell, and apply the dof
+    // functionals of V0 to each basis function
+    auto x_dofs = x_dofmap.links(c);
+    for (int i = 0; i < num_dofs_g; ++i)
+      coordinate_dofs.row(i) = x_g.row(x_dofs[i]).head(gdim);
+    cmap.push_forward(x, X, coordinate_dofs);
+    cmap.compute_reference_geometry(Xc, J, detJ, K, x, coordinate_dofs);
+    element1->transform_reference_basis(basis, *reference_basis, X, J, detJ,
+                                        K, cell_info[c]);
+    for (int j = 0; j < space_dim1; ++j)
+    {
+      for (int p = 0; p < num_points; ++p)
+        for (int k = 0; k < value_size; ++k)
+          basis_values(p, k) = basis(p, j, k);
+      element0->transform_values(A_cell.col(j).data(), basis_values,
+                                 coordinate_dofs);
+    }
+
+    auto dofs1 = dofmap1->cell_dofs(c);
+    for (int k = 0; k < bs; ++k)
+    {
+      for (int i = 0; i < space_dim0; ++i)
+      {
+        const std::int32_t row = dofs0[pos0[k][i]];
+        if (row >= num_rows or row_offset[row] >= 0)
+          continue;
+        row_offset[row] = unordered_cols.size();
+        for (int j = 0; j < space_dim1; ++j)
+        {
+          if (std::abs(A_cell(i, j)) > tol)
+          {
+            unordered_cols.push_back(global_cols[dofs1[pos1[k][j]]]);
+            unordered_values.push_back(A_cell(i, j));
+          }
+        }
+        row_size[row] = unordered_cols.size() - row_offset[row];
+      }
+    }
+  }
+
+  // Reorder the rows
+  std::vector<PetscInt> row_ptr(num_rows + 1, 0);
+  for (std::int32_t i = 0; i < num_rows; ++i)
+    row_ptr[i + 1] = row_ptr[i] + row_size[i];
+  std::vector<PetscInt> cols(row_ptr.back());
+  std::vector<PetscScalar> values(row_ptr.back());
+  for (std::int32_t i = 0; i < num_rows; ++i)
+  {
+    if (row_offset[i] < 0)
+      continue;
+    std::copy_n(unordered_cols.begin() + row_offset[i], row_size[i],
+                cols.begin() + row_ptr[i]);
+    std::copy_n(unordered_values.begin() + row_offset[i], row_size[i],
+                values.begin() + row_ptr[i]);
+  }
+  sort_rows(row_ptr, cols, values);
+
+  return create_matrix(mesh.mpi_comm(), *map0, *map1, row_ptr, cols, values);
+}
+//-----------------------------------------------------------------------------
@@ -28,9 +28,14 @@ namespace fem
 
 /// This class computes discrete gradient operators (matrices) that map
 /// derivatives of finite element functions into other finite element
-/// spaces. An example of where discrete gradient operators are required
-/// is the creation of algebraic multigrid solvers for H(curl) and
-/// H(div) problems.
+/// spaces, and discrete interpolation operators between finite element
+/// spaces. Examples of where these operators are required are the
+/// creation of algebraic multigrid solvers for H(curl) and H(div)
+/// problems (auxiliary space methods), and p-multigrid.
+///
+/// The operators are built directly as compressed sparse row arrays of
+/// the owned rows, without a sparsity pattern or the insertion of
+/// values row by row, and are distributed like the dofs of the spaces.
 
 /// @warning This class is highly experimental and likely to change. It
 /// will eventually be expanded to provide the discrete curl and
@@ -42,13 +47,33 @@ public:
   /// Build the discrete gradient operator A that takes a
   /// \f$w \in H^1\f$ (P1, nodal Lagrange) to \f$v \in H(curl)\f$
   /// (lowest order Nedelec), i.e. v = Aw. V0 is the H(curl) space,
-  /// and V1 is the P1 Lagrange space.
+  /// and V1 is the P1 Lagrange space. The row of an edge has the
+  /// entries -1 and 1 in the columns of its vertices, with the edge
+  /// directed from the vertex with the lower global index to the
+  /// vertex with the higher global index.
   ///
   /// @param[in] V0 H(curl) space
   /// @param[in] V1 P1 Lagrange space
   /// @return The discrete operator matrix
   static la::PETScMatrix build_gradient(const function::FunctionSpace& V0,
                                         const function::FunctionSpace& V1);
+
+  /// Build the interpolation operator A that takes the coefficients of
+  /// a function \f$w \in V_1\f$ to the coefficients of its
+  /// interpolant \f$v \in V_0\f$, i.e. v = Aw. The row of a dof of V0
+  /// is the dof functional applied to the basis functions of V1 on a
+  /// cell that contains the dof, so V1 must be continuous at the dof
+  /// points of V0 (e.g. a P1 space and a P2 space for p-multigrid).
+  /// Entries that are zero to round-off are not stored.
+  ///
+  /// @param[in] V0 The space to interpolate into. Its dofs must be
+  ///   point evaluations (see FiniteElement::dof_reference_coordinates).
+  /// @param[in] V1 The space to interpolate from, on the same mesh and
+  ///   with the same value shape and block size as V0
+  /// @return The discrete operator matrix
+  static la::PETScMatrix
+  build_interpolation(const function::FunctionSpace& V0,
+                      const function::FunctionSpace& V1);
 };
 } // namespace fem
 } // namespace dolfinx
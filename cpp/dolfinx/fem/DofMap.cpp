@@ -198,10 +198,79 @@ DofMap::DofMap(std::shared_ptr<const ElementDofLayout> element_dof_layout,
                std::shared_ptr<const common::IndexMap> index_map,
                const graph::AdjacencyList<std::int32_t>& dofmap)
     : element_dof_layout(element_dof_layout), index_map(index_map),
-      _dofmap(dofmap)
+      _dofmap(0), _bs(1), _unrolled(std::make_unique<UnrolledList>())
 {
-  // Dofmap data is copied as the types for dofmap and _dofmap may
-  // differ, typically 32- vs 64-bit integers
+  assert(element_dof_layout);
+  assert(index_map);
+  const int bs = index_map->block_size();
+  bool blocked = bs > 1 and element_dof_layout->block_size() == bs;
+
+  // Check that the cell dofs consist of complete blocks
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& dofs = dofmap.array();
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& offsets
+      = dofmap.offsets();
+  for (std::int32_t c = 0; blocked and c < dofmap.num_nodes(); ++c)
+  {
+    if ((offsets[c + 1] - offsets[c]) % bs != 0)
+      blocked = false;
+    for (std::int32_t i = offsets[c]; blocked and i < offsets[c + 1]; i += bs)
+    {
+      if (dofs[i] % bs != 0)
+        blocked = false;
+      for (int k = 1; blocked and k < bs; ++k)
+        blocked = dofs[i + k] == dofs[i] + k;
+    }
+  }
+
+  if (blocked)
+  {
+    _bs = bs;
+    Eigen::Array<std::int32_t, Eigen::Dynamic, 1> blocks(dofs.rows() / bs);
+    for (Eigen::Index i = 0; i < blocks.rows(); ++i)
+      blocks[i] = dofs[bs * i] / bs;
+    _dofmap = graph::AdjacencyList<std::int32_t>(
+        std::move(blocks),
+        Eigen::Array<std::int32_t, Eigen::Dynamic, 1>(offsets / bs));
+  }
+  else
+    _dofmap = dofmap;
+}
+//-----------------------------------------------------------------------------
+DofMap::DofMap(std::shared_ptr<const ElementDofLayout> element_dof_layout,
+               std::shared_ptr<const common::IndexMap> index_map,
+               graph::AdjacencyList<std::int32_t>&& dofmap, int bs)
+    : element_dof_layout(element_dof_layout), index_map(index_map),
+      _dofmap(std::move(dofmap)), _bs(bs),
+      _unrolled(std::make_unique<UnrolledList>())
+{
+  assert(index_map);
+  assert(bs == 1 or index_map->block_size() == bs);
+}
+//-----------------------------------------------------------------------------
+const graph::AdjacencyList<std::int32_t>& DofMap::list() const
+{
+  if (_bs == 1)
+    return _dofmap;
+
+  const graph::AdjacencyList<std::int32_t>* list = _unrolled->list.load();
+  if (list)
+    return *list;
+
+  std::lock_guard<std::mutex> lock(_unrolled->mutex);
+  if (!_unrolled->data)
+  {
+    const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& blocks
+        = _dofmap.array();
+    Eigen::Array<std::int32_t, Eigen::Dynamic, 1> dofs(blocks.rows() * _bs);
+    for (Eigen::Index i = 0; i < blocks.rows(); ++i)
+      for (int k = 0; k < _bs; ++k)
+        dofs[_bs * i + k] = _bs * blocks[i] + k;
+    _unrolled->data = std::make_unique<graph::AdjacencyList<std::int32_t>>(
+        std::move(dofs), Eigen::Array<std::int32_t, Eigen::Dynamic, 1>(
+                             _bs * _dofmap.offsets()));
+    _unrolled->list = _unrolled->data.get();
+  }
+  return *_unrolled->data;
 }
 //-----------------------------------------------------------------------------
 DofMap DofMap::extract_sub_dofmap(const std::vector<int>& component) const
@@ -217,7 +286,8 @@ DofMap DofMap::extract_sub_dofmap(const std::vector<int>& component) const
   const std::vector sub_element_map_view
       = this->element_dof_layout->sub_view(component);
 
-  // Build dofmap by extracting from parent
+  // Build dofmap by extracting from parent (unrolling the parent cell
+  // blocks)
   const int num_cells = this->_dofmap.num_nodes();
   const std::int32_t dofs_per_cell = sub_element_map_view.size();
   Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
@@ -226,13 +296,22 @@ DofMap DofMap::extract_sub_dofmap(const std::vector<int>& component) const
   {
     auto cell_dmap_parent = this->_dofmap.links(c);
     for (std::int32_t i = 0; i < dofs_per_cell; ++i)
-      dofmap(c, i) = cell_dmap_parent[sub_element_map_view[i]];
+    {
+      const int j = sub_element_map_view[i];
+      dofmap(c, i) = _bs * cell_dmap_parent[j / _bs] + j % _bs;
+    }
   }
 
   return DofMap(sub_element_dof_layout, this->index_map,
                 graph::AdjacencyList<std::int32_t>(dofmap));
 }
 //-----------------------------------------------------------------------------
+std::size_t DofMap::memory_usage() const
+{
+  const graph::AdjacencyList<std::int32_t>* list = _unrolled->list.load();
+  return _dofmap.memory_usage() + (list ? list->memory_usage() : 0);
+}
+//-----------------------------------------------------------------------------
 std::pair<std::unique_ptr<DofMap>, std::vector<std::int32_t>>
 DofMap::collapse(MPI_Comm comm, const mesh::Topology& topology) const
 {
@@ -255,9 +334,10 @@ DofMap::collapse(MPI_Comm comm, const mesh::Topology& topology) const
     // Parent does not have block structure but sub-map does, so build
     // new submap to get block structure for collapsed dofmap.
     auto [index_map, dofmap]
-        = DofMapBuilder::build(comm, topology, *collapsed_dof_layout);
+        = DofMapBuilder::build_blocked(comm, topology, *collapsed_dof_layout);
+    const int bs = collapsed_dof_layout->block_size();
     dofmap_new = std::make_unique<DofMap>(element_dof_layout, index_map,
-                                          std::move(dofmap));
+                                          std::move(dofmap), bs);
   }
   else
   {
@@ -277,18 +357,44 @@ DofMap::collapse(MPI_Comm comm, const mesh::Topology& topology) const
   const int tdim = topology.dim();
   auto cells = topology.connectivity(tdim, 0);
   assert(cells);
+  const int bs_view = _bs;
+  const int bs_new = dofmap_new->bs();
+  const graph::AdjacencyList<std::int32_t>& blocks_new
+      = dofmap_new->list_blocked();
   for (int c = 0; c < cells->num_nodes(); ++c)
   {
-    auto cell_dofs_view = this->cell_dofs(c);
-    auto cell_dofs = dofmap_new->cell_dofs(c);
-    assert(cell_dofs_view.rows() == cell_dofs.rows());
-    for (Eigen::Index i = 0; i < cell_dofs_view.rows(); ++i)
+    auto cell_blocks_view = _dofmap.links(c);
+    auto cell_blocks = blocks_new.links(c);
+    assert(bs_view * cell_blocks_view.rows() == bs_new * cell_blocks.rows());
+    for (Eigen::Index i = 0; i < bs_new * cell_blocks.rows(); ++i)
     {
-      assert(cell_dofs[i] < (int)collapsed_map.size());
-      collapsed_map[cell_dofs[i]] = cell_dofs_view[i];
+      const std::int32_t dof = bs_new * cell_blocks[i / bs_new] + i % bs_new;
+      assert(dof < (int)collapsed_map.size());
+      collapsed_map[dof]
+          = bs_view * cell_blocks_view[i / bs_view] + i % bs_view;
     }
   }
 
   return {std::move(dofmap_new), std::move(collapsed_map)};
 }
 //-----------------------------------------------------------------------------
+std::vector<std::int32_t>
+fem::cells_with_marked_dofs(const DofMap& dofmap,
+                            const std::vector<bool>& markers)
+{
+  const graph::AdjacencyList<std::int32_t>& blocks = dofmap.list_blocked();
+  const int bs = dofmap.bs();
+  std::vector<std::int32_t> cells;
+  for (std::int32_t c = 0; c < blocks.num_nodes(); ++c)
+  {
+    auto cell_blocks = blocks.links(c);
+    bool marked = false;
+    for (Eigen::Index i = 0; i < cell_blocks.rows() and !marked; ++i)
+      for (int k = 0; k < bs and !marked; ++k)
+        marked = markers[bs * cell_blocks[i] + k];
+    if (marked)
+      cells.push_back(c);
+  }
+  return cells;
+}
+//-----------------------------------------------------------------------------
@@ -7,10 +7,12 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <atomic>
 #include <cstdlib>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -55,23 +57,52 @@ graph::AdjacencyList<std::int32_t>
 transpose_dofmap(graph::AdjacencyList<std::int32_t>& dofmap,
                  std::int32_t num_cells);
 
+/// Unroll the block indices of a cell into dof indices, i.e. set
+/// dofs[bs * i + k] = bs * blocks[i] + k
+/// @param[in] blocks The block indices
+/// @param[in] bs The block size
+/// @param[out] dofs The dof indices. Must have size bs * blocks.size().
+template <typename U>
+void unroll_dofs(const U& blocks, int bs, std::vector<std::int32_t>& dofs)
+{
+  assert((int)dofs.size() == bs * blocks.size());
+  for (Eigen::Index i = 0; i < blocks.size(); ++i)
+    for (int k = 0; k < bs; ++k)
+      dofs[bs * i + k] = bs * blocks[i] + k;
+}
+
 /// Degree-of-freedom map
 ///
 /// This class handles the mapping of degrees of freedom. It builds a
 /// dof map based on an ElementDofLayout on a specific mesh topology. It
 /// will reorder the dofs when running in parallel. Sub-dofmaps, both
 /// views and copies, are supported.
+///
+/// If the block size bs() is greater than one, only the block indices
+/// of the cells are stored (see list_blocked), and the (unrolled) cell
+/// dofs of list() and cell_dofs() are created on first use.
 
 class DofMap
 {
 public:
   /// Create a DofMap from the layout of dofs on a reference element, an
   /// IndexMap defining the distribution of dofs across processes and a
-  /// vector of indices
+  /// vector of indices. The dofs are stored as blocks if they consist of
+  /// complete blocks of the index map (see bs).
   DofMap(std::shared_ptr<const ElementDofLayout> element_dof_layout,
          std::shared_ptr<const common::IndexMap> index_map,
          const graph::AdjacencyList<std::int32_t>& dofmap);
 
+  /// Create a DofMap from the block indices of the cells
+  /// @param[in] element_dof_layout The layout of dofs on a cell
+  /// @param[in] index_map The index map, with block size @p bs
+  /// @param[in] dofmap The block indices of each cell. The cell dof bs
+  ///   * j + k is bs * dofmap.links(c)[j] + k.
+  /// @param[in] bs The block size
+  DofMap(std::shared_ptr<const ElementDofLayout> element_dof_layout,
+         std::shared_ptr<const common::IndexMap> index_map,
+         graph::AdjacencyList<std::int32_t>&& dofmap, int bs);
+
   // Copy constructor
   DofMap(const DofMap& dofmap) = delete;
 
@@ -94,7 +125,7 @@ public:
   Eigen::Array<std::int32_t, Eigen::Dynamic, 1>::ConstSegmentReturnType
   cell_dofs(int cell) const
   {
-    return _dofmap.links(cell);
+    return list().links(cell);
   }
 
   /// Extract subdofmap component
@@ -110,9 +141,35 @@ public:
   std::pair<std::unique_ptr<DofMap>, std::vector<std::int32_t>>
   collapse(MPI_Comm comm, const mesh::Topology& topology) const;
 
-  /// Get dofmap data
+  /// Get dofmap data. If bs() is greater than one, the list is
+  /// unrolled from the block indices on first use and kept, see
+  /// list_blocked.
   /// @return The adjacency list with dof indices for each cell
-  const graph::AdjacencyList<std::int32_t>& list() const { return _dofmap; }
+  const graph::AdjacencyList<std::int32_t>& list() const;
+
+  /// Get the block indices of the cells. Cell dof bs() * j + k is bs()
+  /// * list_blocked().links(c)[j] + k. If bs() is one, this is list().
+  /// @return The adjacency list with block indices for each cell
+  const graph::AdjacencyList<std::int32_t>& list_blocked() const
+  {
+    return _dofmap;
+  }
+
+  /// Block size of the cell dofs. If it is greater than one, the cell
+  /// dofs consist of complete blocks of the index map, i.e. cell dof bs
+  /// * j + k is bs * node + k for the jth node of the cell, and the
+  /// dofs can be inserted blockwise into a matrix or vector.
+  /// @return The block size of the index map if the element and index
+  ///   map block sizes agree and the cell dofs are blocked, and one
+  ///   otherwise (e.g. for the dofmap of a subspace of a vector-valued
+  ///   space)
+  int bs() const { return _bs; }
+
+  /// Memory used by the cell dofs, including the unrolled cell dofs if
+  /// they have been created. The element dof layout and the index map
+  /// are not included since they may be shared with other dofmaps.
+  /// @return Memory usage in bytes
+  std::size_t memory_usage() const;
 
   /// Layout of dofs on an element
   std::shared_ptr<const ElementDofLayout> element_dof_layout;
@@ -121,7 +178,27 @@ public:
   std::shared_ptr<const common::IndexMap> index_map;
 
 private:
-  // Cell-local-to-dof map (dofs for cell dofmap[cell])
+  // Cell-local-to-dof map (blocks for cell dofmap[cell])
   graph::AdjacencyList<std::int32_t> _dofmap;
+
+  // Block size of _dofmap
+  int _bs;
+
+  // Unrolled cell dofs, created on first use if _bs > 1
+  struct UnrolledList
+  {
+    std::mutex mutex;
+    std::atomic<const graph::AdjacencyList<std::int32_t>*> list{nullptr};
+    std::unique_ptr<const graph::AdjacencyList<std::int32_t>> data;
+  };
+  std::unique_ptr<UnrolledList> _unrolled;
 };
+
+/// Find the cells that have at least one marked dof
+/// @param[in] dofmap The dofmap
+/// @param[in] markers Dof markers. Dof i is marked if markers[i] is
+///   true.
+/// @return The (sorted) cells with at least one marked dof
+std::vector<std::int32_t>
+cells_with_marked_dofs(const DofMap& dofmap, const std::vector<bool>& markers);
 } // namespace dolfinx::fem
\ No newline at end of file
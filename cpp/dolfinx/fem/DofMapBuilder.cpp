@@ -20,6 +20,7 @@
 #include <iterator>
 #include <memory>
 #include <random>
+#include <set>
 #include <unordered_map>
 #include <utility>
 
@@ -120,10 +121,16 @@ build_basic_dofmap(const mesh::Topology& topology,
   const std::vector<std::vector<std::set<int>>>& entity_dofs
       = element_dof_layout.entity_dofs_all();
 
-  // Compute cell dof permutations
+  // Compute cell dof permutations. The permutations of the dofs on
+  // reoriented entities are applied here, once, so that they are not
+  // required when tabulating element tensors.
+  const bool needs_permutations = element_dof_layout.needs_permutations();
   const Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
       permutations
-      = fem::compute_dof_permutations(topology, element_dof_layout);
+      = needs_permutations
+            ? fem::compute_dof_permutations(topology, element_dof_layout)
+            : Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic,
+                           Eigen::RowMajor>();
 
   // Storage for local-to-global map
   std::vector<std::int64_t> local_to_global(local_size);
@@ -183,7 +190,9 @@ build_basic_dofmap(const mesh::Topology& topology,
           const std::int32_t count = std::distance(e_dofs->begin(), dof_local);
           const std::int32_t dof
               = offset_local + num_entity_dofs * e_index_local + count;
-          dofs[cell_ptr[c] + permutations(c, *dof_local)] = dof;
+          const int p
+              = needs_permutations ? permutations(c, *dof_local) : *dof_local;
+          dofs[cell_ptr[c] + p] = dof;
           local_to_global[dof]
               = offset_global + num_entity_dofs * e_index_global + count;
           dof_entity[dof] = {d, e_index_local};
@@ -200,6 +209,68 @@ build_basic_dofmap(const mesh::Topology& topology,
 }
 //-----------------------------------------------------------------------------
 
+/// Compute a reordering of the owned nodes of a dofmap from the graph
+/// of the owned nodes, with two nodes linked if they share a cell
+///
+/// @param [in] dofmap The basic dofmap data
+/// @param [in] original_to_contiguous The contiguous index of each
+///   owned node, and -1 for unowned nodes
+/// @param [in] owned_size The number of owned nodes
+/// @param [in] ordering DofOrdering::gps or DofOrdering::cuthill_mckee
+/// @return The new index of each owned node (contiguous index)
+std::vector<int>
+reorder_graph(const graph::AdjacencyList<std::int32_t>& dofmap,
+              const std::vector<int>& original_to_contiguous,
+              std::int32_t owned_size, DofOrdering ordering)
+{
+  // Build local graph, based on dof map with contiguous numbering
+  // (unowned dofs excluded)
+  std::vector<std::vector<std::int32_t>> graph_data(owned_size);
+  for (std::int32_t cell = 0; cell < dofmap.num_nodes(); ++cell)
+  {
+    auto nodes = dofmap.links(cell);
+    for (std::int32_t i = 0; i < nodes.rows(); ++i)
+    {
+      const std::int32_t node_i = original_to_contiguous[nodes[i]];
+
+      // Skip unowned node
+      if (node_i == -1)
+        continue;
+
+      for (std::int32_t j = 0; j < nodes.rows(); ++j)
+      {
+        // Skip diagonal
+        if (i == j)
+          continue;
+
+        const std::int32_t node_j = original_to_contiguous[nodes[j]];
+        if (node_j != -1)
+          graph_data[node_i].push_back(node_j);
+      }
+    }
+  }
+
+  // Eliminate duplicates and create AdjacencyList
+  for (auto& node : graph_data)
+  {
+    std::sort(node.begin(), node.end());
+    node.erase(std::unique(node.begin(), node.end()), node.end());
+  }
+  const graph::AdjacencyList<std::int32_t> graph(graph_data);
+  std::vector<std::vector<std::int32_t>>().swap(graph_data);
+
+  switch (ordering)
+  {
+  case DofOrdering::gps:
+    return std::get<0>(graph::SCOTCH::compute_gps(graph));
+  case DofOrdering::cuthill_mckee:
+    return graph::BoostGraphOrdering::compute_cuthill_mckee(graph, true);
+  default:
+    throw std::runtime_error("Unknown graph dof ordering.");
+  }
+}
+//-----------------------------------------------------------------------------
+
 /// Compute re-ordering map from old local index to new local index. The
 /// M dofs owned by this process are reordered for locality and fill the
 /// positions [0, ..., M). Dof owned by another process are placed at
@@ -208,12 +279,15 @@ build_basic_dofmap(const mesh::Topology& topology,
 ///
 /// @param [in] dofmap The basic dofmap data
 /// @param [in] topology The mesh topology
+/// @param [in] ordering The strategy for ordering the owned dofs
+/// @param [in] cell_order The cell order for DofOrdering::cell
 /// @return The pair (old-to-new local index map, M), where M is the
 ///   number of dofs owned by this process
 std::pair<std::vector<std::int32_t>, std::int32_t> compute_reordering_map(
     const graph::AdjacencyList<std::int32_t>& dofmap,
     const std::vector<std::pair<std::int8_t, std::int32_t>>& dof_entity,
-    const mesh::Topology& topology)
+    const mesh::Topology& topology, DofOrdering ordering,
+    const std::vector<std::int32_t>& cell_order)
 {
   // Get ownership offset for each dimension
   const int D = topology.dim();
@@ -246,63 +320,49 @@ std::pair<std::vector<std::int32_t>, std::int32_t> compute_reordering_map(
       original_to_contiguous[i] = owned_size++;
   }
 
-  // Build local graph, based on dof map with contiguous numbering
-  // (unowned dofs excluded)
-  std::vector<std::vector<std::int32_t>> graph_data(owned_size);
-  for (std::int32_t cell = 0; cell < dofmap.num_nodes(); ++cell)
+  // Reorder owned nodes
+  std::vector<int> node_remap;
+  switch (ordering)
   {
-    auto nodes = dofmap.links(cell);
-    for (std::int32_t i = 0; i < nodes.rows(); ++i)
+  case DofOrdering::cell:
+  {
+    if (!cell_order.empty()
+        and (std::int32_t)cell_order.size() != dofmap.num_nodes())
     {
-      const std::int32_t node_i = original_to_contiguous[nodes[i]];
-
-      // Skip unowned node
-      if (node_i == -1)
-        continue;
+      throw std::runtime_error("Cell order has wrong size.");
+    }
 
-      for (std::int32_t j = 0; j < nodes.rows(); ++j)
+    // Number nodes in order of first appearance in the cells
+    node_remap.resize(owned_size, -1);
+    std::int32_t count = 0;
+    for (std::int32_t c = 0; c < dofmap.num_nodes(); ++c)
+    {
+      auto nodes = dofmap.links(cell_order.empty() ? c : cell_order[c]);
+      for (std::int32_t i = 0; i < nodes.rows(); ++i)
       {
-        // Skip diagonal
-        if (i == j)
-          continue;
-
-        const std::int32_t node_j = original_to_contiguous[nodes[j]];
-        if (node_j != -1)
-          graph_data[node_i].push_back(node_j);
+        const std::int32_t node = original_to_contiguous[nodes[i]];
+        if (node != -1 and node_remap[node] == -1)
+          node_remap[node] = count++;
       }
     }
+    if (count != owned_size)
+      throw std::runtime_error("Cell order does not contain all cells.");
+    break;
   }
-
-  // Eliminate duplicates and create AdjacencyList
-  for (auto& node : graph_data)
-  {
-    std::sort(node.begin(), node.end());
-    node.erase(std::unique(node.begin(), node.end()), node.end());
-  }
-  const graph::AdjacencyList<std::int32_t> graph(graph_data);
-  std::vector<std::vector<std::int32_t>>().swap(graph_data);
-
-  // Reorder owned nodes
-  const std::string ordering_library = "SCOTCH";
-  std::vector<int> node_remap;
-  if (ordering_library == "Boost")
-    node_remap = graph::BoostGraphOrdering::compute_cuthill_mckee(graph, true);
-  else if (ordering_library == "SCOTCH")
-    std::tie(node_remap, std::ignore) = graph::SCOTCH::compute_gps(graph);
-  else if (ordering_library == "random")
+  case DofOrdering::random:
   {
     // NOTE: Randomised dof ordering should only be used for
     // testing/benchmarking
-    node_remap.resize(graph.num_nodes());
+    node_remap.resize(owned_size);
     std::iota(node_remap.begin(), node_remap.end(), 0);
     std::random_device rd;
     std::default_random_engine g(rd());
     std::shuffle(node_remap.begin(), node_remap.end(), g);
+    break;
   }
-  else
-  {
-    throw std::runtime_error("Requested library '" + ordering_library
-                             + "' is unknown");
+  default:
+    node_remap = reorder_graph(dofmap, original_to_contiguous, owned_size,
+                               ordering);
   }
 
   // Reconstruct remaped nodes, and place un-owned nodes at the end
@@ -323,8 +383,13 @@ std::pair<std::vector<std::int32_t>, std::int32_t> compute_reordering_map(
 }
 //-----------------------------------------------------------------------------
 
-/// Get global indices for unowned dofs
+/// Get global indices for unowned dofs. The owner of a mesh entity
+/// sends the (old, new) global indices of the dofs of the entity to the
+/// ranks that ghost the entity, using a neighbourhood communicator that
+/// is the union of the forward communicators of the entity index maps.
+/// The data for all entity dimensions is exchanged in one round.
 /// @param [in] topology The mesh topology
+/// @param [in] element_dof_layout The layout of dofs on a cell
 /// @param [in] num_owned The number of nodes owned by this process
 /// @param [in] process_offset The node offset for this process, i.e.
 ///   the global index of owned node i is i + process_offset
@@ -337,8 +402,8 @@ std::pair<std::vector<std::int32_t>, std::int32_t> compute_reordering_map(
 /// @returns The (0) global indices for unowned dofs, (1) owner rank of each
 ///   unowned dof
 std::pair<std::vector<std::int64_t>, std::vector<int>> get_global_indices(
-    const mesh::Topology& topology, const std::int32_t num_owned,
-    const std::int64_t process_offset,
+    const mesh::Topology& topology, const ElementDofLayout& element_dof_layout,
+    const std::int32_t num_owned, const std::int64_t process_offset,
     const std::vector<std::int64_t>& global_indices_old,
     const std::vector<std::int32_t>& old_to_new,
     const std::vector<std::pair<std::int8_t, std::int32_t>>& dof_entity)
@@ -347,135 +412,138 @@ std::pair<std::vector<std::int64_t>, std::vector<int>> get_global_indices(
 
   const int D = topology.dim();
 
-  // Build list flag for owned mesh entities that are shared, i.e. are a
-  // ghost on a neighbor
-  std::vector<std::vector<bool>> shared_entity(D + 1);
-  for (std::size_t d = 0; d < shared_entity.size(); ++d)
+  // Dimensions of the mesh entities that have dofs
+  std::vector<int> dims;
+  for (int d = 0; d <= D; ++d)
   {
-    auto map = topology.index_map(d);
-    if (map)
+    if (element_dof_layout.num_entity_dofs(d) > 0)
     {
-      shared_entity[d] = std::vector<bool>(map->size_local(), false);
-      const std::vector<std::int32_t>& forward_indices = map->shared_indices();
-      for (auto entity : forward_indices)
-        shared_entity[d][entity] = true;
+      assert(topology.index_map(d));
+      dims.push_back(d);
     }
   }
 
-  // Build list of (global old, global new) index pairs for dofs that
-  // are ghosted on other processes
-  std::vector<std::vector<std::int64_t>> global(D + 1);
-
-  // Loop over all dofs
-  for (std::size_t i = 0; i < dof_entity.size(); ++i)
+  // Build list of dofs of each owned mesh entity, for each dimension
+  std::vector<std::vector<std::int32_t>> entity_dofs(D + 1);
+  std::vector<std::vector<std::int32_t>> entity_dof_offsets(D + 1);
+  for (int d : dims)
+    entity_dof_offsets[d].assign(topology.index_map(d)->size_local() + 1, 0);
+  for (const auto& [d, entity] : dof_entity)
   {
-    // Topological dimension of mesh entity that dof is associated with
-    const int d = dof_entity[i].first;
-
-    // Index of mesh entity that dof is associated with
-    const int entity = dof_entity[i].second;
-    if (entity < (int)shared_entity[d].size() and shared_entity[d][entity])
+    if (std::size_t(entity) + 1 < entity_dof_offsets[d].size())
+      ++entity_dof_offsets[d][entity + 1];
+  }
+  for (int d : dims)
+  {
+    std::vector<std::int32_t>& offsets = entity_dof_offsets[d];
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    entity_dofs[d].resize(offsets.back());
+  }
+  {
+    std::vector<std::vector<std::int32_t>> pos(D + 1);
+    for (int d : dims)
+      pos[d].assign(entity_dof_offsets[d].begin(), entity_dof_offsets[d].end());
+    for (std::size_t i = 0; i < dof_entity.size(); ++i)
     {
-      global[d].push_back(global_indices_old[i]);
-      global[d].push_back(old_to_new[i] + process_offset);
+      const auto [d, entity] = dof_entity[i];
+      if (std::size_t(entity) + 1 < entity_dof_offsets[d].size())
+        entity_dofs[d][pos[d][entity]++] = i;
     }
   }
 
-  std::vector<int> requests_dim;
-  std::vector<MPI_Request> requests(D + 1);
-  std::vector<MPI_Comm> comm(D + 1, MPI_COMM_NULL);
-  std::vector<std::vector<std::int64_t>> all_dofs_received(D + 1);
-  std::vector<std::vector<int>> recv_offsets(D + 1);
-  for (int d = 0; d <= D; ++d)
+  // Get the ranks that ghost owned entities (destinations) and the
+  // owners of ghost entities (sources), over all dimensions
+  std::vector<std::vector<int>> dest_ranks(D + 1);
+  std::set<int> src_set, dest_set;
+  for (int d : dims)
+  {
+    auto [src, dest] = dolfinx::MPI::neighbors(
+        topology.index_map(d)->comm(common::IndexMap::Direction::forward));
+    src_set.insert(src.begin(), src.end());
+    dest_set.insert(dest.begin(), dest.end());
+    dest_ranks[d] = std::move(dest);
+  }
+  const std::vector<int> sources(src_set.begin(), src_set.end());
+  const std::vector<int> destinations(dest_set.begin(), dest_set.end());
+
+  // Pack (global old, global new) index pairs of the dofs of owned
+  // entities for each rank that ghosts the entity
+  std::vector<std::vector<std::int64_t>> send_pairs(destinations.size());
+  for (int d : dims)
   {
-    // FIXME: This should check which dimension are needed by the dofmap
     auto map = topology.index_map(d);
-    if (map)
+    const std::vector<std::int32_t>& shared = map->shared_indices();
+    const std::vector<std::int32_t>& shared_offsets
+        = map->shared_indices_offsets();
+    const std::vector<std::int32_t>& offsets = entity_dof_offsets[d];
+    for (std::size_t p = 0; p < dest_ranks[d].size(); ++p)
     {
-      comm[d] = map->comm(common::IndexMap::Direction::symmetric);
-
-      // Get number of neighbors
-      int indegree(-1), outdegree(-2), weighted(-1);
-      MPI_Dist_graph_neighbors_count(comm[d], &indegree, &outdegree, &weighted);
-
-      // Number and values to send and receive
-      const int num_indices = global[d].size();
-      std::vector<int> num_indices_recv(indegree);
-      MPI_Neighbor_allgather(&num_indices, 1, MPI_INT, num_indices_recv.data(),
-                             1, MPI_INT, comm[d]);
-
-      // Compute displacements for data to receive. Last entry has total
-      // number of received items.
-      std::vector<int>& disp = recv_offsets[d];
-      disp.resize(indegree + 1);
-      std::partial_sum(num_indices_recv.begin(), num_indices_recv.end(),
-                       disp.begin() + 1);
-
-      // TODO: use MPI_Ineighbor_alltoallv
-      // Send global index of dofs with bcs to all neighbors
-      std::vector<std::int64_t>& dofs_received = all_dofs_received[d];
-      dofs_received.resize(disp.back());
-      MPI_Ineighbor_allgatherv(global[d].data(), global[d].size(), MPI_INT64_T,
-                               dofs_received.data(), num_indices_recv.data(),
-                               disp.data(), MPI_INT64_T, comm[d],
-                               &requests[requests_dim.size()]);
-      requests_dim.push_back(d);
+      auto it = std::lower_bound(destinations.begin(), destinations.end(),
+                                 dest_ranks[d][p]);
+      assert(it != destinations.end() and *it == dest_ranks[d][p]);
+      std::vector<std::int64_t>& pairs
+          = send_pairs[std::distance(destinations.begin(), it)];
+      for (int j = shared_offsets[p]; j < shared_offsets[p + 1]; ++j)
+      {
+        const std::int32_t entity = shared[j];
+        for (int k = offsets[entity]; k < offsets[entity + 1]; ++k)
+        {
+          const std::int32_t dof = entity_dofs[d][k];
+          pairs.push_back(global_indices_old[dof]);
+          pairs.push_back(old_to_new[dof] + process_offset);
+        }
+      }
     }
   }
 
-  // Build  [local_new - num_owned] -> global old array  broken down by
-  // dimension
-  std::vector<std::vector<std::int64_t>> local_new_to_global_old(D + 1);
-  for (std::size_t i = 0; i < global_indices_old.size(); ++i)
+  std::vector<int> send_offsets{0};
+  std::vector<std::int64_t> send_data;
+  for (const std::vector<std::int64_t>& pairs : send_pairs)
   {
-    const int d = dof_entity[i].first;
-    std::int32_t local_new = old_to_new[i] - num_owned;
-    if (local_new >= 0)
-    {
-      local_new_to_global_old[d].push_back(global_indices_old[i]);
-      local_new_to_global_old[d].push_back(local_new);
-    }
+    send_data.insert(send_data.end(), pairs.begin(), pairs.end());
+    send_offsets.push_back(send_data.size());
+  }
+
+  // Send the index pairs to the neighbours
+  MPI_Comm neighbor_comm;
+  MPI_Dist_graph_create_adjacent(topology.mpi_comm(), sources.size(),
+                                 sources.data(), MPI_UNWEIGHTED,
+                                 destinations.size(), destinations.data(),
+                                 MPI_UNWEIGHTED, MPI_INFO_NULL, false,
+                                 &neighbor_comm);
+  const graph::AdjacencyList<std::int64_t> recv_pairs
+      = dolfinx::MPI::neighbor_all_to_all(neighbor_comm, send_offsets,
+                                          send_data);
+  MPI_Comm_free(&neighbor_comm);
+
+  // Build (global old) -> (global new, owner) map for received dofs
+  std::unordered_map<std::int64_t, std::pair<std::int64_t, int>>
+      global_old_new;
+  global_old_new.reserve(recv_pairs.array().rows() / 2);
+  for (int p = 0; p < recv_pairs.num_nodes(); ++p)
+  {
+    auto pairs = recv_pairs.links(p);
+    for (Eigen::Index j = 0; j < pairs.rows(); j += 2)
+      global_old_new.insert({pairs[j], {pairs[j + 1], sources[p]}});
   }
 
+  // Get new global index and owner of unowned dofs
   std::vector<std::int64_t> local_to_global_new(old_to_new.size() - num_owned);
   std::vector<int> local_to_global_new_owner(old_to_new.size() - num_owned);
-  for (std::size_t i = 0; i < requests_dim.size(); ++i)
+  for (std::size_t i = 0; i < global_indices_old.size(); ++i)
   {
-    int idx, d;
-    MPI_Waitany(requests_dim.size(), requests.data(), &idx, MPI_STATUS_IGNORE);
-    d = requests_dim[idx];
-
-    MPI_Comm neighbor_comm
-        = topology.index_map(d)->comm(common::IndexMap::Direction::symmetric);
-    auto [neighbors, neighbors1] = dolfinx::MPI::neighbors(neighbor_comm);
-    assert(neighbors == neighbors1);
-
-    // Build (global old, global new) map for dofs of dimension d
-    std::unordered_map<std::int64_t, std::pair<int64_t, int>> global_old_new;
-    std::vector<std::int64_t>& dofs_received = all_dofs_received[d];
-    std::vector<int>& offsets = recv_offsets[d];
-    for (std::size_t j = 0; j < dofs_received.size(); j += 2)
-    {
-      const auto pos = std::upper_bound(offsets.begin(), offsets.end(), j);
-      const int owner = std::distance(offsets.begin(), pos) - 1;
-      global_old_new.insert(
-          {dofs_received[j], {dofs_received[j + 1], neighbors[owner]}});
-    }
-
-    // Build the dimension d part of local_to_global_new vector
-    std::vector<std::int64_t>& local_new_to_global_old_d
-        = local_new_to_global_old[d];
-    for (std::size_t i = 0; i < local_new_to_global_old_d.size(); i += 2)
+    const std::int32_t local_new = old_to_new[i] - num_owned;
+    if (local_new >= 0)
     {
-      auto it = global_old_new.find(local_new_to_global_old_d[i]);
+      auto it = global_old_new.find(global_indices_old[i]);
       assert(it != global_old_new.end());
-      local_to_global_new[local_new_to_global_old_d[i + 1]] = it->second.first;
-      local_to_global_new_owner[local_new_to_global_old_d[i + 1]]
-          = it->second.second;
+      local_to_global_new[local_new] = it->second.first;
+      local_to_global_new_owner[local_new] = it->second.second;
     }
   }
 
-  return {local_to_global_new, local_to_global_new_owner};
+  return {std::move(local_to_global_new),
+          std::move(local_to_global_new_owner)};
 }
 //-----------------------------------------------------------------------------
 
@@ -483,8 +551,10 @@ std::pair<std::vector<std::int64_t>, std::vector<int>> get_global_indices(
 
 //-----------------------------------------------------------------------------
 std::pair<std::shared_ptr<common::IndexMap>, graph::AdjacencyList<std::int32_t>>
-DofMapBuilder::build(MPI_Comm comm, const mesh::Topology& topology,
-                     const ElementDofLayout& element_dof_layout)
+DofMapBuilder::build_blocked(MPI_Comm comm, const mesh::Topology& topology,
+                             const ElementDofLayout& element_dof_layout,
+                             DofOrdering ordering,
+                             const std::vector<std::int32_t>& cell_order)
 {
   common::Timer t0("Init dofmap");
 
@@ -514,7 +584,8 @@ DofMapBuilder::build(MPI_Comm comm, const mesh::Topology& topology,
   // Build re-ordering map for data locality and get number of owned
   // nodes
   const auto [old_to_new, num_owned]
-      = compute_reordering_map(node_graph0, dof_entity0, topology);
+      = compute_reordering_map(node_graph0, dof_entity0, topology, ordering,
+                               cell_order);
 
   // Compute process offset for owned nodes
   const std::int64_t process_offset
@@ -522,8 +593,9 @@ DofMapBuilder::build(MPI_Comm comm, const mesh::Topology& topology,
 
   // Get global indices for unowned dofs
   const auto [local_to_global_unowned, local_to_global_owner]
-      = get_global_indices(topology, num_owned, process_offset,
-                           local_to_global0, old_to_new, dof_entity0);
+      = get_global_indices(topology, element_dof_layout, num_owned,
+                           process_offset, local_to_global0, old_to_new,
+                           dof_entity0);
   assert(local_to_global_unowned.size() == local_to_global_owner.size());
 
   // Create IndexMap for dofs range on this process
@@ -535,33 +607,38 @@ DofMapBuilder::build(MPI_Comm comm, const mesh::Topology& topology,
       local_to_global_unowned, local_to_global_owner, element_block_size);
   assert(index_map);
 
+  // Build re-ordered dofmap of nodes (blocks)
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& old_nodes
+      = node_graph0.array();
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> nodes(old_nodes.rows());
+  for (Eigen::Index i = 0; i < old_nodes.rows(); ++i)
+    nodes[i] = old_to_new[old_nodes[i]];
+  return {std::move(index_map),
+          graph::AdjacencyList<std::int32_t>(std::move(nodes),
+                                             node_graph0.offsets())};
+}
+//-----------------------------------------------------------------------------
+std::pair<std::shared_ptr<common::IndexMap>, graph::AdjacencyList<std::int32_t>>
+DofMapBuilder::build(MPI_Comm comm, const mesh::Topology& topology,
+                     const ElementDofLayout& element_dof_layout,
+                     DofOrdering ordering,
+                     const std::vector<std::int32_t>& cell_order)
+{
+  auto [index_map, nodes] = build_blocked(comm, topology, element_dof_layout,
+                                          ordering, cell_order);
+
   // FIXME: There is an assumption here on the dof order for an element.
   //        It should come from the ElementDofLayout.
-  // Build re-ordered dofmap, accounting for block size
-  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> dofmap(
-      node_graph0.array().rows() * element_block_size);
-
-  for (std::int32_t cell = 0; cell < node_graph0.num_nodes(); ++cell)
-  {
-    const std::int32_t local_dim0 = node_graph0.num_links(cell);
-    auto old_nodes = node_graph0.links(cell);
-    for (std::int32_t j = 0; j < local_dim0; ++j)
-    {
-      const std::int32_t old_node = old_nodes[j];
-      const std::int32_t new_node = old_to_new[old_node];
-      for (std::int32_t block = 0; block < element_block_size; ++block)
-      {
-        dofmap[element_block_size * local_dim0 * cell + element_block_size * j
-               + block]
-            = element_block_size * new_node + block;
-      }
-    }
-  }
-  assert(dofmap.rows() % node_graph0.num_nodes() == 0);
-  Eigen::Map<Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic,
-                          Eigen::RowMajor>>
-      _dofmap(dofmap.data(), node_graph0.num_nodes(),
-              dofmap.rows() / node_graph0.num_nodes());
-  return {std::move(index_map), graph::AdjacencyList<std::int32_t>(_dofmap)};
+  // Unroll the nodes, accounting for block size
+  const int bs = element_dof_layout.block_size();
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& blocks = nodes.array();
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> dofmap(blocks.rows() * bs);
+  for (Eigen::Index i = 0; i < blocks.rows(); ++i)
+    for (int k = 0; k < bs; ++k)
+      dofmap[bs * i + k] = bs * blocks[i] + k;
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets = bs * nodes.offsets();
+  return {std::move(index_map),
+          graph::AdjacencyList<std::int32_t>(std::move(dofmap),
+                                             std::move(offsets))};
 }
 //-----------------------------------------------------------------------------
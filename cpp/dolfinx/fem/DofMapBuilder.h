@@ -29,20 +29,60 @@ namespace fem
 {
 class ElementDofLayout;
 
+/// Strategies for ordering the dofs owned by a process for data
+/// locality
+enum class DofOrdering : int
+{
+  /// Gibbs-Poole-Stockmeyer ordering (SCOTCH) of the dof graph
+  gps,
+  /// Reverse Cuthill-McKee ordering (Boost) of the dof graph
+  cuthill_mckee,
+  /// Number the dofs in order of first appearance in the cells, with
+  /// the cells in a given order (default is the local cell order). A
+  /// Hilbert curve order of the dofs is obtained with the cell order
+  /// from mesh::Partitioning::compute_hilbert_order.
+  cell,
+  /// Random ordering, for testing and benchmarking only
+  random
+};
+
 /// Builds a DofMap on a mesh::Mesh
 
 namespace DofMapBuilder
 {
 
+/// Build dofmap with the nodes (blocks) of the cells. The cell dof bs
+/// * j + k is bs * node + k for the jth node of a cell, with bs the
+/// element block size.
+/// @param[in] comm MPI communicator
+/// @param[in] topology The mesh topology
+/// @param[in] element_dof_layout The element dof layout for the function
+/// space
+/// @param[in] ordering The strategy for ordering the owned dofs
+/// @param[in] cell_order The order of the (local) cells, see build
+/// @return The index map and the local node indices of each cell
+std::pair<std::shared_ptr<common::IndexMap>, graph::AdjacencyList<std::int32_t>>
+build_blocked(MPI_Comm comm, const mesh::Topology& topology,
+              const ElementDofLayout& element_dof_layout,
+              DofOrdering ordering = DofOrdering::gps,
+              const std::vector<std::int32_t>& cell_order = {});
+
 /// Build dofmap
 /// @param[in] comm MPI communicator
 /// @param[in] topology The mesh topology
 /// @param[in] element_dof_layout The element dof layout for the function
 /// space
+/// @param[in] ordering The strategy for ordering the owned dofs
+/// @param[in] cell_order The order of the (local) cells for
+///   DofOrdering::cell. If empty, the local cell order is used. The
+///   same cell order gives consistent dof orderings for different
+///   function spaces on a mesh, and is computed once.
 /// @return The index map and local to global DOF data for the DOF map.
 std::pair<std::shared_ptr<common::IndexMap>, graph::AdjacencyList<std::int32_t>>
 build(MPI_Comm comm, const mesh::Topology& topology,
-      const ElementDofLayout& element_dof_layout);
+      const ElementDofLayout& element_dof_layout,
+      DofOrdering ordering = DofOrdering::gps,
+      const std::vector<std::int32_t>& cell_order = {});
 
 } // namespace DofMapBuilder
 } // namespace fem
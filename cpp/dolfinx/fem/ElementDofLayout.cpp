@@ -96,6 +96,20 @@ ElementDofLayout::ElementDofLayout(
                              + std::to_string(_base_permutations.rows()) + " x "
                              + std::to_string(_base_permutations.cols()) + ".");
   }
+
+  // Check for base permutations that reorder the dofs
+  _needs_permutations = false;
+  for (Eigen::Index i = 0; i < _base_permutations.rows(); ++i)
+  {
+    for (Eigen::Index j = 0; j < _base_permutations.cols(); ++j)
+    {
+      if (_base_permutations(i, j) != j)
+      {
+        _needs_permutations = true;
+        break;
+      }
+    }
+  }
 }
 //-----------------------------------------------------------------------------
 ElementDofLayout ElementDofLayout::copy() const
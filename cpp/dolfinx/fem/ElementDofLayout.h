@@ -143,12 +143,19 @@ public:
   bool is_view() const;
 
   /// Returns the base permutations of the DoFs, as computed by FFCx
-  Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+  const Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
   base_permutations() const
   {
     return _base_permutations;
   }
 
+  /// Check if any of the base permutations reorders the dofs. If not,
+  /// the dofs of a cell do not depend on the orientation of its
+  /// entities (e.g. for P1 and P2 Lagrange elements) and no cell dof
+  /// permutations need to be computed when building a dofmap.
+  /// @return True if a base permutation is not the identity
+  bool needs_permutations() const { return _needs_permutations; }
+
 private:
   // Block size
   int _block_size;
@@ -179,6 +186,9 @@ private:
   // The base permutations of the DoFs
   Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
       _base_permutations;
+
+  // True if a base permutation is not the identity
+  bool _needs_permutations;
 };
 
 } // namespace fem
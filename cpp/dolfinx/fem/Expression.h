@@ -0,0 +1,215 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "FormCoefficients.h"
+#include "utils.h"
+#include <Eigen/Dense>
+#include <cstdint>
+#include <dolfinx/function/Constant.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <ufc.h>
+#include <vector>
+
+namespace dolfinx::fem
+{
+
+/// An expression (e.g. derived from UFL) that is evaluated at a fixed
+/// set of points on the reference cell, on any number of cells of a
+/// mesh. The kernel computes the values of the expression at all points
+/// of a cell from the expansion coefficients of the coefficients, the
+/// constants and the coordinate dofs of the cell, as the cell kernels of
+/// a Form do. Evaluation on many cells (eval) reuses the cached packed
+/// coefficients (see FormCoefficients::pack) and the cell coordinate
+/// access of assembly.
+
+template <typename T>
+class Expression
+{
+public:
+  /// Create an expression
+  /// @param[in] coefficients The coefficients of the expression
+  /// @param[in] constants The constants of the expression
+  /// @param[in] mesh The mesh
+  /// @param[in] X The points on the reference cell, with shape
+  ///   (num_points, tdim)
+  /// @param[in] fn The kernel. It is called as fn(values, w, c,
+  ///   coordinate_dofs) and computes the num_points * value_size values
+  ///   (point-major) on a cell.
+  /// @param[in] value_size The number of values of the expression at a
+  ///   point
+  Expression(
+      const FormCoefficients<T>& coefficients,
+      const std::vector<std::shared_ptr<const function::Constant<T>>>&
+          constants,
+      std::shared_ptr<const mesh::Mesh> mesh,
+      const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic,
+                                          Eigen::Dynamic, Eigen::RowMajor>>& X,
+      const std::function<void(T*, const T*, const T*, const double*)> fn,
+      int value_size)
+      : _coefficients(coefficients), _constants(constants), _mesh(mesh),
+        _x(X), _fn(fn), _value_size(value_size)
+  {
+    assert(mesh);
+    if (X.cols() != mesh->topology().dim())
+    {
+      throw std::runtime_error("Dimension of the reference points does not "
+                               "match the topological dimension.");
+    }
+  }
+
+  /// Move constructor
+  Expression(Expression&& e) = default;
+
+  /// Destructor
+  ~Expression() = default;
+
+  /// Evaluate the expression on cells
+  /// @param[in] cells The cells to evaluate on
+  /// @param[out] values The values, with shape (num_cells, num_points *
+  ///   value_size). Row i holds the values at all points (point-major)
+  ///   of cell cells[i].
+  void eval(
+      const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+          cells,
+      Eigen::Ref<Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic,
+                              Eigen::RowMajor>>
+          values) const
+  {
+    const int num_values = num_points() * _value_size;
+    if (values.rows() != cells.rows() or values.cols() != num_values)
+      throw std::runtime_error("Wrong shape of the expression values.");
+
+    // Pack the coefficients (cached) and constants
+    const int tdim = _mesh->topology().dim();
+    const std::int32_t num_cells
+        = _mesh->topology().index_map(tdim)->size_local()
+          + _mesh->topology().index_map(tdim)->num_ghosts();
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs
+        = _coefficients.pack(num_cells);
+    std::vector<T> constants;
+    for (const auto& constant : _constants)
+    {
+      assert(constant);
+      const std::vector<T>& array = constant->value;
+      constants.insert(constants.end(), array.begin(), array.end());
+    }
+
+    impl::CellCoordinates cell_coordinates(_mesh->geometry());
+    Eigen::Array<T, Eigen::Dynamic, 1> w(coeffs.cols());
+    for (Eigen::Index i = 0; i < cells.rows(); ++i)
+    {
+      const std::int32_t c = cells[i];
+      assert(c < num_cells);
+      const double* coordinate_dofs = cell_coordinates(c);
+      w = coeffs.row(c);
+      values.row(i).setZero();
+      _fn(values.row(i).data(), w.data(), constants.data(), coordinate_dofs);
+    }
+  }
+
+  /// The coefficients
+  const FormCoefficients<T>& coefficients() const { return _coefficients; }
+
+  /// The coefficients
+  FormCoefficients<T>& coefficients() { return _coefficients; }
+
+  /// The constants
+  const std::vector<std::shared_ptr<const function::Constant<T>>>&
+  constants() const
+  {
+    return _constants;
+  }
+
+  /// The mesh
+  std::shared_ptr<const mesh::Mesh> mesh() const { return _mesh; }
+
+  /// The points on the reference cell, with shape (num_points, tdim)
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                     Eigen::RowMajor>&
+  x() const
+  {
+    return _x;
+  }
+
+  /// Number of points on the reference cell
+  int num_points() const { return _x.rows(); }
+
+  /// Number of values of the expression at a point
+  int value_size() const { return _value_size; }
+
+  /// The kernel
+  const std::function<void(T*, const T*, const T*, const double*)>&
+  get_tabulate_expression() const
+  {
+    return _fn;
+  }
+
+private:
+  // Coefficients, with the cache of the packed coefficients
+  FormCoefficients<T> _coefficients;
+
+  // Constants
+  std::vector<std::shared_ptr<const function::Constant<T>>> _constants;
+
+  // The mesh
+  std::shared_ptr<const mesh::Mesh> _mesh;
+
+  // Reference points (num_points, tdim)
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> _x;
+
+  // The kernel
+  std::function<void(T*, const T*, const T*, const double*)> _fn;
+
+  // Number of values at a point
+  int _value_size;
+};
+
+/// Create an Expression from a UFC expression
+/// @param[in] expression The UFC expression
+/// @param[in] coefficients The coefficients of the expression, in the
+///   order of the original (UFL) coefficients
+/// @param[in] constants The constants of the expression, in the order of
+///   the original (UFL) constants
+/// @param[in] mesh The mesh
+/// @return The expression
+template <typename T>
+Expression<T> create_expression(
+    const ufc_expression& expression,
+    const std::vector<std::shared_ptr<const function::Function<T>>>&
+        coefficients,
+    const std::vector<std::shared_ptr<const function::Constant<T>>>&
+        constants,
+    std::shared_ptr<const mesh::Mesh> mesh)
+{
+  static_assert(std::is_same<T, ufc_scalar_t>::value,
+                "UFC kernels are only available for ufc_scalar_t.");
+
+  FormCoefficients<T> w({});
+  for (int i = 0; i < expression.num_coefficients; ++i)
+  {
+    const int pos = expression.original_coefficient_positions[i];
+    if (pos >= (int)coefficients.size())
+      throw std::runtime_error("Missing coefficient of expression.");
+    w.set(i, coefficients[pos]);
+  }
+
+  const Eigen::Map<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                      Eigen::RowMajor>>
+      X(expression.points, expression.num_points,
+        expression.topological_dimension);
+  return Expression<T>(w, constants, mesh, X, expression.tabulate_expression,
+                       expression.num_components);
+}
+
+} // namespace dolfinx::fem
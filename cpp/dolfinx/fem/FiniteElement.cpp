@@ -6,6 +6,7 @@
 
 #include "FiniteElement.h"
 #include <dolfinx/common/log.h>
+#include <algorithm>
 #include <dolfinx/mesh/utils.h>
 #include <functional>
 #include <iostream>
@@ -15,6 +16,28 @@
 using namespace dolfinx;
 using namespace dolfinx::fem;
 
+namespace
+{
+// Maximum number of point sets in the tabulation cache that have not
+// been pretabulated
+constexpr std::size_t max_tabulations = 16;
+
+//-----------------------------------------------------------------------------
+// Hash of the coordinates of a point set
+std::size_t
+hash_points(const Eigen::Ref<const Eigen::Array<
+                double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>& X)
+{
+  std::size_t h = std::hash<Eigen::Index>{}(X.rows());
+  h ^= std::hash<Eigen::Index>{}(X.cols()) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  for (Eigen::Index i = 0; i < X.rows(); ++i)
+    for (Eigen::Index j = 0; j < X.cols(); ++j)
+      h ^= std::hash<double>{}(X(i, j)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  return h;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 //-----------------------------------------------------------------------------
 FiniteElement::FiniteElement(const ufc_finite_element& ufc_element)
     : _signature(ufc_element.signature), _family(ufc_element.family),
@@ -137,6 +160,122 @@ void FiniteElement::evaluate_reference_basis_derivatives(
   }
 }
 //-----------------------------------------------------------------------------
+std::shared_ptr<const Eigen::Tensor<double, 3, Eigen::RowMajor>>
+FiniteElement::tabulate_reference_basis(
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                        Eigen::RowMajor>>& X) const
+{
+  std::lock_guard<std::mutex> lock(_tabulations_mutex);
+  Tabulation* tab = find_tabulation(X, true);
+  assert(tab);
+  if (!tab->values)
+  {
+    auto values = std::make_shared<Eigen::Tensor<double, 3, Eigen::RowMajor>>(
+        X.rows(), _space_dim, _reference_value_size);
+    evaluate_reference_basis(*values, X);
+    tab->values = values;
+  }
+
+  return tab->values;
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<const Eigen::Tensor<double, 4, Eigen::RowMajor>>
+FiniteElement::tabulate_reference_basis_derivatives(
+    int order,
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                        Eigen::RowMajor>>& X) const
+{
+  std::lock_guard<std::mutex> lock(_tabulations_mutex);
+  Tabulation* tab = find_tabulation(X, true);
+  assert(tab);
+  auto& derivs = tab->derivatives[order];
+  if (!derivs)
+  {
+    int num_derivatives = 1;
+    for (int i = 0; i < order; ++i)
+      num_derivatives *= _tdim;
+    auto values = std::make_shared<Eigen::Tensor<double, 4, Eigen::RowMajor>>(
+        X.rows(), _space_dim, _reference_value_size, num_derivatives);
+    evaluate_reference_basis_derivatives(*values, order, X);
+    derivs = values;
+  }
+
+  return derivs;
+}
+//-----------------------------------------------------------------------------
+void FiniteElement::pretabulate(
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                        Eigen::RowMajor>>& X,
+    int order) const
+{
+  tabulate_reference_basis(X);
+  for (int i = 1; i <= order; ++i)
+    tabulate_reference_basis_derivatives(i, X);
+
+  std::lock_guard<std::mutex> lock(_tabulations_mutex);
+  Tabulation* tab = find_tabulation(X, true);
+  assert(tab);
+  tab->pinned = true;
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<const Eigen::Tensor<double, 3, Eigen::RowMajor>>
+FiniteElement::cached_reference_basis(
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                        Eigen::RowMajor>>& X) const
+{
+  std::lock_guard<std::mutex> lock(_tabulations_mutex);
+  if (const Tabulation* tab = find_tabulation(X, false))
+    return tab->values;
+  return nullptr;
+}
+//-----------------------------------------------------------------------------
+std::size_t FiniteElement::num_tabulations() const
+{
+  std::lock_guard<std::mutex> lock(_tabulations_mutex);
+  return _tabulations.size();
+}
+//-----------------------------------------------------------------------------
+void FiniteElement::clear_tabulations() const
+{
+  std::lock_guard<std::mutex> lock(_tabulations_mutex);
+  _tabulations.clear();
+}
+//-----------------------------------------------------------------------------
+FiniteElement::Tabulation* FiniteElement::find_tabulation(
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                        Eigen::RowMajor>>& X,
+    bool insert) const
+{
+  if (X.cols() != _tdim)
+  {
+    throw std::runtime_error("Dimension of the reference points does not "
+                             "match the element.");
+  }
+
+  const std::size_t hash = hash_points(X);
+  for (Tabulation& tab : _tabulations)
+  {
+    if (tab.hash == hash and tab.X.rows() == X.rows() and (tab.X == X).all())
+      return &tab;
+  }
+
+  if (!insert)
+    return nullptr;
+
+  // Evict the oldest point set that has not been pretabulated
+  if (std::count_if(_tabulations.begin(), _tabulations.end(),
+                    [](const Tabulation& t) { return !t.pinned; })
+      >= (std::ptrdiff_t)max_tabulations)
+  {
+    auto it = std::find_if(_tabulations.begin(), _tabulations.end(),
+                           [](const Tabulation& t) { return !t.pinned; });
+    _tabulations.erase(it);
+  }
+
+  _tabulations.push_back({hash, X, nullptr, {}, false});
+  return &_tabulations.back();
+}
+//-----------------------------------------------------------------------------
 void FiniteElement::transform_reference_basis(
     Eigen::Tensor<double, 3, Eigen::RowMajor>& values,
     const Eigen::Tensor<double, 3, Eigen::RowMajor>& reference_values,
@@ -6,10 +6,14 @@
 
 #pragma once
 
+#include <Eigen/Dense>
+#include <cstddef>
 #include <dolfinx/common/types.h>
 #include <dolfinx/mesh/cell_types.h>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <unsupported/Eigen/CXX11/Tensor>
 #include <vector>
 
@@ -84,6 +88,59 @@ public:
       const Eigen::Ref<const Eigen::Array<
           double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>& X) const;
 
+  /// Tabulate all basis functions at points in the reference cell. The
+  /// tabulation is cached for the point set (identified by the
+  /// coordinates of the points), so that tabulating again at the same
+  /// points (e.g. quadrature points, dof coordinates or repeated probe
+  /// locations) does not call the generated code. The cache holds a
+  /// limited number of point sets, except those passed to pretabulate.
+  /// @param[in] X The points in the reference cell (num_points, tdim)
+  /// @return The values [num_points][num_dofs][reference_value_size]
+  std::shared_ptr<const Eigen::Tensor<double, 3, Eigen::RowMajor>>
+  tabulate_reference_basis(
+      const Eigen::Ref<const Eigen::Array<
+          double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>& X) const;
+
+  /// Tabulate all basis function derivatives of given order at points
+  /// in the reference cell, using the tabulation cache (see
+  /// tabulate_reference_basis)
+  /// @param[in] order The order of the derivatives
+  /// @param[in] X The points in the reference cell (num_points, tdim)
+  /// @return The derivatives
+  ///   [num_points][num_dofs][reference_value_size][num_derivatives]
+  std::shared_ptr<const Eigen::Tensor<double, 4, Eigen::RowMajor>>
+  tabulate_reference_basis_derivatives(
+      int order, const Eigen::Ref<const Eigen::Array<
+                     double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>&
+                     X) const;
+
+  /// Tabulate the basis functions, and their derivatives up to the given
+  /// order, at a fixed set of points in the reference cell, and keep the
+  /// tabulation in the cache until clear_tabulations is called
+  /// @param[in] X The points in the reference cell (num_points, tdim)
+  /// @param[in] order The highest order of the derivatives
+  void pretabulate(
+      const Eigen::Ref<const Eigen::Array<
+          double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>& X,
+      int order = 0) const;
+
+  /// Return the cached tabulation of the basis functions at points in
+  /// the reference cell, without tabulating if the points are not in
+  /// the cache
+  /// @param[in] X The points in the reference cell (num_points, tdim)
+  /// @return The values [num_points][num_dofs][reference_value_size],
+  ///   or nullptr if the basis has not been tabulated at @p X
+  std::shared_ptr<const Eigen::Tensor<double, 3, Eigen::RowMajor>>
+  cached_reference_basis(
+      const Eigen::Ref<const Eigen::Array<
+          double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>& X) const;
+
+  /// Number of point sets in the tabulation cache
+  std::size_t num_tabulations() const;
+
+  /// Clear the tabulation cache, including the pretabulated point sets
+  void clear_tabulations() const;
+
   /// Push basis functions forward to physical element
   void transform_reference_basis(
       Eigen::Tensor<double, 3, Eigen::RowMajor>& values,
@@ -176,5 +233,30 @@ private:
   // Block size for VectorElements and TensorElements
   // This gives the number of DOFs colocated at each point
   int _block_size;
+
+  // Tabulation of the basis (and derivatives of each order) at a point
+  // set
+  struct Tabulation
+  {
+    std::size_t hash;
+    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> X;
+    std::shared_ptr<const Eigen::Tensor<double, 3, Eigen::RowMajor>> values;
+    std::map<int, std::shared_ptr<const Eigen::Tensor<double, 4,
+                                                      Eigen::RowMajor>>>
+        derivatives;
+    bool pinned;
+  };
+
+  // Find (or, if insert is true, create) the tabulation for a point set.
+  // Requires _tabulations_mutex to be locked.
+  Tabulation*
+  find_tabulation(const Eigen::Ref<const Eigen::Array<
+                      double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>&
+                      X,
+                  bool insert) const;
+
+  // Cached tabulations, in the order of creation
+  mutable std::vector<Tabulation> _tabulations;
+  mutable std::mutex _tabulations_mutex;
 };
 } // namespace dolfinx::fem
@@ -8,6 +8,8 @@
 
 #include "FormCoefficients.h"
 #include "FormIntegrals.h"
+#include <Eigen/Dense>
+#include <algorithm>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/fem/DofMap.h>
 #include <functional>
@@ -226,6 +228,20 @@ public:
       _integrals.set_default_domains(*_mesh);
   }
 
+  /// Register a batched 'tabulate_tensor' function for the existing
+  /// integral with ID i. Batched functions are used by the serial
+  /// assemblers, which gather @p batch_size entities per call. See
+  /// FormIntegrals::get_tabulate_tensor_batched for the data layout.
+  void set_tabulate_tensor_batched(
+      IntegralType type, int i,
+      const std::function<void(T*, const T*, const T*, const double*,
+                               const int*, const std::uint8_t*,
+                               const std::uint32_t*)>& fn,
+      int batch_size)
+  {
+    _integrals.set_tabulate_tensor_batched(type, i, fn, batch_size);
+  }
+
   /// Access coefficients
   FormCoefficients<T>& coefficients() { return _coefficients; }
 
@@ -235,6 +251,40 @@ public:
   /// Access form integrals
   const FormIntegrals<T>& integrals() const { return _integrals; }
 
+  /// Set the number of threads used to assemble cell integrals. If
+  /// greater than one, the cells of each integral are coloured such
+  /// that cells of the same colour do not share test space degrees of
+  /// freedom, and the cells of each colour are assembled concurrently.
+  /// The colouring is computed on first use and cached.
+  /// @param[in] num_threads The number of threads
+  void set_num_threads(int num_threads)
+  {
+    if (num_threads < 1)
+      throw std::runtime_error("Number of threads must be positive");
+    _num_threads = num_threads;
+  }
+
+  /// Number of threads used to assemble cell integrals
+  /// @return The number of threads
+  int num_threads() const { return _num_threads; }
+
+  /// Enable or disable the reuse of element tensors for cells that are
+  /// translations of each other (see compute_cell_classes). If enabled,
+  /// the serial matrix assembler tabulates the element tensors of the
+  /// cell integrals once per class of translated cells and inserts them
+  /// for all cells of the class. The classes are computed on first use
+  /// and cached. This is valid only if the cell integrals do not depend
+  /// on coefficients or on the position of a cell (e.g. through
+  /// ufl.SpatialCoordinate), and is useful for constant-coefficient
+  /// forms on structured meshes. Disabled by default.
+  /// @param[in] reuse True to enable reuse
+  void set_reuse_cell_tensors(bool reuse) { _reuse_cell_tensors = reuse; }
+
+  /// Check if element tensors are reused for translated cells (see
+  /// set_reuse_cell_tensors)
+  /// @return True if reuse is enabled
+  bool reuse_cell_tensors() const { return _reuse_cell_tensors; }
+
   /// Access constants
   /// @return Vector of attached constants with their names. Names are
   ///   used to set constants in user's c++ code. Index in the vector is
@@ -257,6 +307,34 @@ public:
     return _constants;
   }
 
+  /// Get the values of the constants, packed into one array in the
+  /// order of constants(). The array persists on the form, and the
+  /// values are copied into it on each call. It is only reallocated
+  /// if the total size of the constants has changed. The call is not
+  /// thread-safe.
+  /// @return The packed constant values. The reference is valid until
+  ///   the constants are packed again.
+  const Eigen::Array<T, Eigen::Dynamic, 1>& packed_constants() const
+  {
+    std::size_t size = 0;
+    for (const auto& constant : _constants)
+    {
+      assert(constant.second);
+      size += constant.second->value.size();
+    }
+    if ((std::size_t)_constant_values.size() != size)
+      _constant_values.resize(size);
+
+    T* values = _constant_values.data();
+    for (const auto& constant : _constants)
+    {
+      const std::vector<T>& value = constant.second->value;
+      values = std::copy(value.begin(), value.end(), values);
+    }
+
+    return _constant_values;
+  }
+
 private:
   // Integrals associated with the Form
   FormIntegrals<T> _integrals;
@@ -269,11 +347,20 @@ private:
       std::pair<std::string, std::shared_ptr<const function::Constant<T>>>>
       _constants;
 
+  // Packed constant values (see packed_constants)
+  mutable Eigen::Array<T, Eigen::Dynamic, 1> _constant_values;
+
   // Function spaces (one for each argument)
   std::vector<std::shared_ptr<const function::FunctionSpace>> _function_spaces;
 
   // The mesh (needed for functionals when we don't have any spaces)
   std::shared_ptr<const mesh::Mesh> _mesh;
+
+  // Number of threads used for cell assembly
+  int _num_threads = 1;
+
+  // Reuse element tensors for translated cells
+  bool _reuse_cell_tensors = false;
 };
 
 } // namespace fem
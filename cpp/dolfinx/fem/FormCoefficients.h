@@ -6,8 +6,13 @@
 
 #pragma once
 
+#include <Eigen/Dense>
 #include <algorithm>
+#include <cstdint>
+#include <dolfinx/fem/DofMap.h>
 #include <dolfinx/function/Function.h>
+#include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/function/QuadratureData.h>
 #include <memory>
 #include <string>
 #include <utility>
@@ -27,7 +32,9 @@ namespace fem
 class FiniteElement;
 
 /// Storage for the coefficients of a Form consisting of Function and
-/// the Element objects they are defined on.
+/// the Element objects they are defined on. A coefficient may instead
+/// be quadrature data (see function::QuadratureData), which is packed
+/// without dofmap indirection.
 
 template <typename T>
 class FormCoefficients
@@ -47,6 +54,7 @@ public:
       _names.push_back(std::get<1>(c));
       _coefficients.push_back(std::get<2>(c));
     }
+    _quadrature_data.resize(_coefficients.size());
   }
 
   /// Get number of coefficients
@@ -58,11 +66,17 @@ public:
   std::vector<int> offsets() const
   {
     std::vector<int> n{0};
-    for (const auto& c : _coefficients)
+    for (std::size_t i = 0; i < _coefficients.size(); ++i)
     {
-      if (!c)
+      if (const auto& q = _quadrature_data[i])
+        n.push_back(n.back() + q->values().cols());
+      else if (const auto& c = _coefficients[i])
+      {
+        n.push_back(n.back()
+                    + c->function_space()->element()->space_dimension());
+      }
+      else
         throw std::runtime_error("Not all form coefficients have been set.");
-      n.push_back(n.back() + c->function_space()->element()->space_dimension());
     }
     return n;
   }
@@ -72,26 +86,148 @@ public:
            const std::shared_ptr<const function::Function<T>>& coefficient)
   {
     if (i >= (int)_coefficients.size())
-      _coefficients.resize(i + 1);
+      resize(i + 1);
     _coefficients[i] = coefficient;
+    _quadrature_data[i] = nullptr;
+    if (i < (int)_packed_versions.size())
+      _packed_versions[i] = -1;
+  }
+
+  /// Set coefficient with index i to be quadrature data. The number of
+  /// values per cell must match the size of the expansion coefficients
+  /// expected by the kernels.
+  void set(int i, const std::shared_ptr<const function::QuadratureData<T>>&
+                      coefficient)
+  {
+    if (i >= (int)_coefficients.size())
+      resize(i + 1);
+    _coefficients[i] = nullptr;
+    _quadrature_data[i] = coefficient;
+    if (i < (int)_packed_versions.size())
+      _packed_versions[i] = -1;
   }
 
   /// Set coefficient with name to be a Function
   void set(const std::string& name,
            const std::shared_ptr<const function::Function<T>>& coefficient)
   {
-    const int i = get_index(name);
-    if (i >= (int)_coefficients.size())
-      _coefficients.resize(i + 1);
-    _coefficients[i] = coefficient;
+    set(get_index(name), coefficient);
+  }
+
+  /// Set coefficient with name to be quadrature data
+  void set(const std::string& name,
+           const std::shared_ptr<const function::QuadratureData<T>>&
+               coefficient)
+  {
+    set(get_index(name), coefficient);
   }
 
   /// Get the Function coefficient i
+  /// @return The Function, or nullptr if coefficient i is not a
+  ///   Function
   std::shared_ptr<const function::Function<T>> get(int i) const
   {
     return _coefficients.at(i);
   }
 
+  /// Get the quadrature data coefficient i
+  /// @return The quadrature data, or nullptr if coefficient i is not
+  ///   quadrature data
+  std::shared_ptr<const function::QuadratureData<T>>
+  get_quadrature_data(int i) const
+  {
+    return _quadrature_data.at(i);
+  }
+
+  /// Pack the coefficients of all cells ready for assembly. The packed
+  /// array is cached, and only the columns of coefficients that have
+  /// been modified (see function::Function::version) or replaced since
+  /// the previous call are repacked. The cache is not thread-safe.
+  /// @param[in] num_cells Number of (owned and ghost) cells of the mesh
+  /// @param[in] cells The (sorted) cells to pack, e.g. the cells
+  ///   referenced by the integrals of a form (see
+  ///   FormIntegrals::active_cells), or nullptr to pack all cells. The
+  ///   rows of the other cells are not set. All coefficients are
+  ///   repacked if the list differs from the previous call.
+  /// @return The packed coefficients. Row c holds the expansion
+  ///   coefficients of all coefficients on cell c, see offsets().
+  const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+  pack(std::int32_t num_cells,
+       std::shared_ptr<const std::vector<std::int32_t>> cells
+       = nullptr) const
+  {
+    const std::vector<int> offsets = this->offsets();
+    if (_packed.rows() != num_cells or _packed.cols() != offsets.back()
+        or cells != _packed_cells)
+    {
+      _packed.resize(num_cells, offsets.back());
+      _packed_versions.assign(_coefficients.size(), -1);
+      _packed_cells = cells;
+    }
+
+    // Call fn(cell) for each cell to pack
+    auto for_each_cell = [num_cells, &cells](auto fn) {
+      if (cells)
+        std::for_each(cells->begin(), cells->end(), fn);
+      else
+        for (std::int32_t cell = 0; cell < num_cells; ++cell)
+          fn(cell);
+    };
+
+    for (std::size_t i = 0; i < _coefficients.size(); ++i)
+    {
+      if (const auto& q = _quadrature_data[i])
+      {
+        // Copy the cell rows of the quadrature data
+        const std::int64_t version = q->version();
+        if (version == _packed_versions[i])
+          continue;
+        const auto& values = q->values();
+        if (values.rows() < num_cells)
+        {
+          throw std::runtime_error(
+              "Quadrature data is not defined on all cells.");
+        }
+        if (cells)
+        {
+          for (std::int32_t cell : *cells)
+          {
+            _packed.row(cell).segment(offsets[i], values.cols())
+                = values.row(cell);
+          }
+        }
+        else
+        {
+          _packed.block(0, offsets[i], num_cells, values.cols())
+              = values.topRows(num_cells);
+        }
+        _packed_versions[i] = version;
+        continue;
+      }
+
+      const std::int64_t version = _coefficients[i]->version();
+      if (version == _packed_versions[i])
+        continue;
+
+      const fem::DofMap& dofmap
+          = *_coefficients[i]->function_space()->dofmap();
+      const Eigen::Matrix<T, Eigen::Dynamic, 1>& v
+          = _coefficients[i]->x()->array();
+      const graph::AdjacencyList<std::int32_t>& blocks
+          = dofmap.list_blocked();
+      const int bs = dofmap.bs();
+      for_each_cell([&](std::int32_t cell) {
+        auto dofs = blocks.links(cell);
+        for (Eigen::Index k = 0; k < dofs.size(); ++k)
+          for (int j = 0; j < bs; ++j)
+            _packed(cell, bs * k + j + offsets[i]) = v[bs * dofs[k] + j];
+      });
+      _packed_versions[i] = version;
+    }
+
+    return _packed;
+  }
+
   /// Original position of coefficient in UFL form
   /// @return The position of coefficient i in original ufl form
   ///   coefficients.
@@ -119,14 +255,36 @@ public:
   }
 
 private:
+  // Resize the coefficient storage
+  void resize(int n)
+  {
+    _coefficients.resize(n);
+    _quadrature_data.resize(n);
+  }
+
   // Functions for the coefficients
   std::vector<std::shared_ptr<const function::Function<T>>> _coefficients;
 
+  // Quadrature data for the coefficients (nullptr if a coefficient is a
+  // Function)
+  std::vector<std::shared_ptr<const function::QuadratureData<T>>>
+      _quadrature_data;
+
   // Copy of 'original positions' in UFL form
   std::vector<int> _original_pos;
 
   // Names of coefficients
   std::vector<std::string> _names;
+
+  // Cached packed coefficients, and the version of each coefficient
+  // when it was packed (-1 if not packed)
+  mutable Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      _packed;
+  mutable std::vector<std::int64_t> _packed_versions;
+
+  // The cells of the cached packed coefficients (nullptr for all
+  // cells)
+  mutable std::shared_ptr<const std::vector<std::int32_t>> _packed_cells;
 };
 } // namespace fem
 } // namespace dolfinx
@@ -6,9 +6,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <dolfinx/common/AlignedAllocator.h>
+#include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/mesh/MeshTags.h>
 #include <functional>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -77,6 +81,21 @@ public:
     return _integrals.at(static_cast<int>(type)).at(i).tabulate;
   }
 
+  /// Get the 'tabulate_tensor' function pointer for integral i of given
+  /// type. The pointer is available if the function was set from a
+  /// plain function pointer, e.g. a UFC 'tabulate_tensor' function. The
+  /// assemblers call it directly, and fall back to the (slower)
+  /// std::function returned by get_tabulate_tensor() for other
+  /// callables.
+  /// @param[in] type Integral type
+  /// @param[in] i Integral number
+  /// @return Function pointer, or nullptr if the function is not a
+  ///   plain function pointer
+  auto get_tabulate_tensor_ptr(IntegralType type, int i) const
+  {
+    return _integrals.at(static_cast<int>(type)).at(i).tabulate_ptr;
+  }
+
   /// @todo Should this be removed
   ///
   /// Set the function for 'tabulate_tensor' for integral i of
@@ -107,8 +126,76 @@ public:
       ++pos;
     }
 
+    // Keep the function pointer if fn wraps one
+    void (*const* ptr)(T*, const T*, const T*, const double*, const int*,
+                       const std::uint8_t*, const std::uint32_t)
+        = fn.template target<void (*)(T*, const T*, const T*, const double*,
+                                      const int*, const std::uint8_t*,
+                                      const std::uint32_t)>();
+
     // Insert new Integral
-    integrals.insert(integrals.begin() + pos, {fn, i, {}});
+    _active_cells = nullptr;
+    integrals.insert(integrals.begin() + pos,
+                     {fn, ptr ? *ptr : nullptr, nullptr, 0, i, {}, {},
+                      nullptr});
+  }
+
+  /// Get the batched 'tabulate_tensor' function for integral i of
+  /// given type. A batched function computes the element tensors of
+  /// batch_size() entities in one call. All arrays except the constants
+  /// use an interleaved (structure-of-arrays) layout, i.e. entry k for
+  /// entity l of the batch is stored at position k * batch_size() + l.
+  /// The cell permutation data is passed as one value per entity.
+  /// @param[in] type Integral type
+  /// @param[in] i Integral number
+  /// @return Batched function, which is empty if the integral has no
+  ///   batched implementation
+  const std::function<void(T*, const T*, const T*, const double*, const int*,
+                           const std::uint8_t*, const std::uint32_t*)>&
+  get_tabulate_tensor_batched(IntegralType type, int i) const
+  {
+    return _integrals.at(static_cast<int>(type)).at(i).tabulate_batched;
+  }
+
+  /// Get the number of entities processed by one call to the batched
+  /// 'tabulate_tensor' function for integral i of given type
+  /// @param[in] type Integral type
+  /// @param[in] i Integral number
+  /// @return Batch size, or 0 if there is no batched function
+  int batch_size(IntegralType type, int i) const
+  {
+    return _integrals.at(static_cast<int>(type)).at(i).batch_size;
+  }
+
+  /// Set a batched 'tabulate_tensor' function for the existing integral
+  /// with ID i of given type. See get_tabulate_tensor_batched() for the
+  /// data layout.
+  /// @param[in] type Integral type
+  /// @param[in] i Integral ID
+  /// @param[in] fn Batched tabulate function
+  /// @param[in] batch_size Number of entities processed by one call to
+  ///   @p fn
+  void set_tabulate_tensor_batched(
+      IntegralType type, int i,
+      const std::function<void(T*, const T*, const T*, const double*,
+                               const int*, const std::uint8_t*,
+                               const std::uint32_t*)>& fn,
+      int batch_size)
+  {
+    if (batch_size < 1)
+      throw std::runtime_error("Batch size must be positive");
+
+    std::vector<struct FormIntegrals::Integral>& integrals
+        = _integrals.at(static_cast<int>(type));
+    auto it = std::find_if(integrals.begin(), integrals.end(),
+                           [i](const auto& q) { return q.id == i; });
+    if (it == integrals.end())
+    {
+      throw std::runtime_error("Integral with ID " + std::to_string(i)
+                               + " does not exist");
+    }
+    it->tabulate_batched = fn;
+    it->batch_size = fn ? batch_size : 0;
   }
 
   /// Get types of integrals in the form
@@ -160,6 +247,86 @@ public:
     return _integrals.at(static_cast<int>(type)).at(i).active_entities;
   }
 
+  /// Get the attached cells and local facet indices of the active
+  /// facets of the ith facet integral of type t, computed when the
+  /// domains are set. For exterior facet integrals the data for facet
+  /// j is (cell, local_facet) at positions [2 * j, 2 * j + 2), and for
+  /// interior facet integrals (cell0, local_facet0, cell1,
+  /// local_facet1) at positions [4 * j, 4 * j + 4).
+  /// @param[in] type Integral type (exterior or interior facet)
+  /// @param[in] i Integral number
+  /// @return Flattened cell and local facet data of the active facets
+  const std::vector<std::int32_t>& facet_domains(IntegralType type,
+                                                 int i) const
+  {
+    return _integrals.at(static_cast<int>(type)).at(i).facet_data;
+  }
+
+  /// Get the cached colouring of the active entities for the ith
+  /// integral of type t. The colouring is an adjacency list from
+  /// colour to the entities of that colour. For interior facet
+  /// integrals the links of a colour are the attached cells and local
+  /// facet indices of its facets, in the layout of facet_domains (see
+  /// compute_interior_facet_colouring).
+  /// @param[in] type Integral type
+  /// @param[in] i Integral number
+  /// @return The colouring, or nullptr if no colouring has been cached
+  std::shared_ptr<const graph::AdjacencyList<std::int32_t>>
+  colouring(IntegralType type, int i) const
+  {
+    return _integrals.at(static_cast<int>(type)).at(i).colouring;
+  }
+
+  /// Cache a colouring of the active entities for the ith integral of
+  /// type t. The cache is cleared when the integration domains are
+  /// changed.
+  /// @param[in] type Integral type
+  /// @param[in] i Integral number
+  /// @param[in] colouring Adjacency list from colour to entities
+  void set_colouring(
+      IntegralType type, int i,
+      std::shared_ptr<const graph::AdjacencyList<std::int32_t>> colouring)
+      const
+  {
+    _integrals.at(static_cast<int>(type)).at(i).colouring = colouring;
+  }
+
+  /// Get the cached cell classes (see compute_cell_classes) of the
+  /// active entities for the ith integral of type t, and the version of
+  /// the geometry coordinates (see mesh::Geometry::x_version) they were
+  /// computed for
+  /// @param[in] type Integral type
+  /// @param[in] i Integral number
+  /// @return The classes, or nullptr if no classes have been cached,
+  ///   and the geometry version
+  std::pair<std::shared_ptr<const graph::AdjacencyList<std::int32_t>>,
+            std::uint64_t>
+  cell_classes(IntegralType type, int i) const
+  {
+    const struct Integral& integral
+        = _integrals.at(static_cast<int>(type)).at(i);
+    return {integral.cell_classes, integral.cell_classes_version};
+  }
+
+  /// Cache the cell classes of the active entities for the ith integral
+  /// of type t. The cache is cleared when the integration domains are
+  /// changed.
+  /// @param[in] type Integral type
+  /// @param[in] i Integral number
+  /// @param[in] classes Adjacency list from class to entities
+  /// @param[in] x_version The version of the geometry coordinates the
+  ///   classes were computed for
+  void set_cell_classes(
+      IntegralType type, int i,
+      std::shared_ptr<const graph::AdjacencyList<std::int32_t>> classes,
+      std::uint64_t x_version) const
+  {
+    const struct Integral& integral
+        = _integrals.at(static_cast<int>(type)).at(i);
+    integral.cell_classes = classes;
+    integral.cell_classes_version = x_version;
+  }
+
   /// Set the valid domains for the integrals of a given type from a
   /// MeshTags "marker". Note the MeshTags is not stored, so if there
   /// any changes to the integration domain this must be called again.
@@ -171,6 +338,7 @@ public:
         = _integrals.at(static_cast<int>(type));
     if (integrals.size() == 0)
       return;
+    _active_cells = nullptr;
 
     std::shared_ptr<const mesh::Mesh> mesh = marker.mesh();
     const mesh::Topology& topology = mesh->topology();
@@ -190,6 +358,8 @@ public:
       throw std::runtime_error("Invalid MeshTags dimension:"
                                + std::to_string(marker.dim()));
     }
+    if (type == IntegralType::interior_facet)
+      check_interior_facet_ghosts(*mesh);
 
     // Create a reverse map
     std::map<int, int> id_to_integral;
@@ -198,80 +368,61 @@ public:
       if (integrals[i].id != -1)
       {
         integrals[i].active_entities.clear();
+        integrals[i].colouring = nullptr;
+        integrals[i].cell_classes = nullptr;
         id_to_integral.insert({integrals[i].id, i});
       }
     }
 
-    // Get mesh tag data
-    const std::vector<int>& values = marker.values();
-    const std::vector<std::int32_t>& tagged_entities = marker.indices();
+    // Get mesh tag data, with the tagged entities grouped by value
+    const std::vector<int>& values = marker.unique_values();
+    const graph::AdjacencyList<std::int32_t>& value_index
+        = marker.value_index();
     assert(topology.index_map(dim));
-    const auto entity_end
-        = std::lower_bound(tagged_entities.begin(), tagged_entities.end(),
-                           topology.index_map(dim)->size_local());
-
-    if (type == IntegralType::exterior_facet)
+    const std::int32_t num_entities = topology.index_map(dim)->size_local();
+    const std::vector<std::int32_t>* exterior
+        = type == IntegralType::exterior_facet ? &topology.exterior_facets()
+                                               : nullptr;
+    auto f_to_c = topology.connectivity(tdim - 1, tdim);
+    for (auto [id, i] : id_to_integral)
     {
-      auto f_to_c = topology.connectivity(tdim - 1, tdim);
-      assert(f_to_c);
-      if (type == IntegralType::exterior_facet)
+      auto it = std::lower_bound(values.begin(), values.end(), id);
+      if (it == values.end() or *it != id)
+        continue;
+
+      // Tagged entities are sorted, use owned entities only
+      auto tagged = value_index.links(std::distance(values.begin(), it));
+      const std::int32_t* entity_end = std::lower_bound(
+          tagged.data(), tagged.data() + tagged.rows(), num_entities);
+      std::vector<std::int32_t>& active = integrals[i].active_entities;
+      for (const std::int32_t* e = tagged.data(); e != entity_end; ++e)
       {
-        // Only need to consider shared facets when there are no ghost cells
-        assert(topology.index_map(tdim));
-        std::set<std::int32_t> fwd_shared;
-        if (topology.index_map(tdim)->num_ghosts() == 0)
+        if (type == IntegralType::exterior_facet)
         {
-          fwd_shared.insert(
-              topology.index_map(tdim - 1)->shared_indices().begin(),
-              topology.index_map(tdim - 1)->shared_indices().end());
+          assert(exterior);
+          if (std::binary_search(exterior->begin(), exterior->end(), *e))
+            active.push_back(*e);
         }
-
-        for (auto f = tagged_entities.begin(); f != entity_end; ++f)
+        else if (type == IntegralType::interior_facet)
         {
-          const std::size_t i = std::distance(tagged_entities.cbegin(), f);
-
-          // All "owned" facets connected to one cell, that are not shared,
-          // should be external.
-          if (f_to_c->num_links(*f) == 1
-              and fwd_shared.find(*f) == fwd_shared.end())
-          {
-            if (auto it = id_to_integral.find(values[i]);
-                it != id_to_integral.end())
-            {
-              integrals[it->second].active_entities.push_back(*f);
-            }
-          }
+          assert(f_to_c);
+          if (f_to_c->num_links(*e) == 2)
+            active.push_back(*e);
         }
-      }
-      else if (type == IntegralType::interior_facet)
-      {
-        for (auto f = tagged_entities.begin(); f != entity_end; ++f)
+        else
         {
-          if (f_to_c->num_links(*f) == 2)
-          {
-            const std::size_t i = std::distance(tagged_entities.cbegin(), f);
-            if (const auto it = id_to_integral.find(values[i]);
-                it != id_to_integral.end())
-            {
-              integrals[it->second].active_entities.push_back(*f);
-            }
-          }
+          // For cell and vertex integrals use all markers (but not on
+          // ghost entities)
+          active.push_back(*e);
         }
       }
     }
-    else
+
+    if (type == IntegralType::exterior_facet
+        or type == IntegralType::interior_facet)
     {
-      // For cell and vertex integrals use all markers (but not on ghost
-      // entities)
-      for (auto e = tagged_entities.begin(); e != entity_end; ++e)
-      {
-        const std::size_t i = std::distance(tagged_entities.cbegin(), e);
-        if (const auto it = id_to_integral.find(values[i]);
-            it != id_to_integral.end())
-        {
-          integrals[it->second].active_entities.push_back(*e);
-        }
-      }
+      for (struct Integral& integral : integrals)
+        compute_facet_data(integral, type, *mesh);
     }
   }
 
@@ -282,6 +433,7 @@ public:
   /// @param[in] mesh Mesh
   void set_default_domains(const mesh::Mesh& mesh)
   {
+    _active_cells = nullptr;
     const mesh::Topology& topology = mesh.topology();
     const int tdim = topology.dim();
     std::vector<struct Integral>& cell_integrals
@@ -291,6 +443,8 @@ public:
     if (cell_integrals.size() > 0 and cell_integrals[0].id == -1)
     {
       const int num_cells = topology.index_map(tdim)->size_local();
+      cell_integrals[0].colouring = nullptr;
+      cell_integrals[0].cell_classes = nullptr;
       cell_integrals[0].active_entities.resize(num_cells);
       std::iota(cell_integrals[0].active_entities.begin(),
                 cell_integrals[0].active_entities.end(), 0);
@@ -304,28 +458,13 @@ public:
     {
       // If there is a default integral, define it only on surface facets
       exf_integrals[0].active_entities.clear();
+      exf_integrals[0].colouring = nullptr;
+      exf_integrals[0].cell_classes = nullptr;
 
-      // Get number of facets owned by this process
       mesh.topology_mutable().create_connectivity(tdim - 1, tdim);
-      auto f_to_c = topology.connectivity(tdim - 1, tdim);
-      assert(topology.index_map(tdim - 1));
-      std::set<std::int32_t> fwd_shared_facets;
-
-      // Only need to consider shared facets when there are no ghost cells
-      if (topology.index_map(tdim)->num_ghosts() == 0)
-      {
-        fwd_shared_facets.insert(
-            topology.index_map(tdim - 1)->shared_indices().begin(),
-            topology.index_map(tdim - 1)->shared_indices().end());
-      }
-
-      const int num_facets = topology.index_map(tdim - 1)->size_local();
-      for (int f = 0; f < num_facets; ++f)
-      {
-        if (f_to_c->num_links(f) == 1
-            and fwd_shared_facets.find(f) == fwd_shared_facets.end())
-          exf_integrals[0].active_entities.push_back(f);
-      }
+      exf_integrals[0].active_entities = topology.exterior_facets();
+      compute_facet_data(exf_integrals[0], IntegralType::exterior_facet,
+                         mesh);
     }
 
     // Interior facets. If there is a default integral, define it only on
@@ -336,10 +475,13 @@ public:
     {
       // If there is a default integral, define it only on interior facets
       inf_integrals[0].active_entities.clear();
+      inf_integrals[0].colouring = nullptr;
+      inf_integrals[0].cell_classes = nullptr;
 
       // Get number of facets owned by this process
       mesh.topology_mutable().create_connectivity(tdim - 1, tdim);
       assert(topology.index_map(tdim - 1));
+      check_interior_facet_ghosts(mesh);
       const int num_facets = topology.index_map(tdim - 1)->size_local();
       auto f_to_c = topology.connectivity(tdim - 1, tdim);
       inf_integrals[0].active_entities.reserve(num_facets);
@@ -348,15 +490,98 @@ public:
         if (f_to_c->num_links(f) == 2)
           inf_integrals[0].active_entities.push_back(f);
       }
+      compute_facet_data(inf_integrals[0], IntegralType::interior_facet,
+                         mesh);
     }
   }
 
+  /// Get the cells referenced by the integrals of all types, i.e. the
+  /// cells of the cell integrals and the cells attached to the active
+  /// facets of the facet integrals. The list is computed on first call
+  /// and cached until the integrals or their domains change.
+  /// @param[in] num_cells The number of (owned and ghost) cells of the
+  ///   mesh
+  /// @return The sorted list of cells, or nullptr if there are vertex
+  ///   integrals, which may reference any cell
+  std::shared_ptr<const std::vector<std::int32_t>>
+  active_cells(std::int32_t num_cells) const
+  {
+    if (!_integrals[static_cast<int>(IntegralType::vertex)].empty())
+      return nullptr;
+    if (_active_cells)
+      return _active_cells;
+
+    std::vector<std::int8_t> marker(num_cells, false);
+    for (const struct Integral& integral :
+         _integrals[static_cast<int>(IntegralType::cell)])
+    {
+      for (std::int32_t c : integral.active_entities)
+        marker[c] = true;
+    }
+
+    // The facet data holds (cell, local facet) pairs
+    for (auto type :
+         {IntegralType::exterior_facet, IntegralType::interior_facet})
+    {
+      for (const struct Integral& integral :
+           _integrals[static_cast<int>(type)])
+      {
+        for (std::size_t i = 0; i < integral.facet_data.size(); i += 2)
+          marker[integral.facet_data[i]] = true;
+      }
+    }
+
+    auto cells = std::make_shared<std::vector<std::int32_t>>();
+    for (std::int32_t c = 0; c < num_cells; ++c)
+      if (marker[c])
+        cells->push_back(c);
+    _active_cells = cells;
+    return _active_cells;
+  }
+
+  /// Alignment (bytes) of the element tensor and the coordinate dofs
+  /// passed to the 'tabulate_tensor' functions by the (non-batched)
+  /// cell and facet assemblers. The arrays are also padded to a
+  /// multiple of this size, so that kernels can use aligned loads and
+  /// stores of full SIMD registers without a scalar remainder loop. The
+  /// coordinate dofs of the two cells of an interior facet are stored
+  /// contiguously, i.e. the second cell is not aligned. Coefficients
+  /// and constants are not aligned.
+  static constexpr std::size_t workspace_alignment = common::cache_line_size;
+
   /// Get bool indicating whether permutation data needs to be passed
   /// into these integrals
   /// @return True if cell permutation data is required
   bool needs_permutation_data() const { return _needs_permutation_data; }
 
 private:
+  // Check that a distributed mesh has the ghost cells needed by
+  // interior facet integrals (collective). Without ghost cells, the
+  // facets on the process boundaries have one cell on each process and
+  // would be missed. Ghost-free (owner-computes) assembly is supported
+  // for cell and exterior facet integrals.
+  static void check_interior_facet_ghosts(const mesh::Mesh& mesh)
+  {
+    const mesh::Topology& topology = mesh.topology();
+    const int tdim = topology.dim();
+    int missing = 0;
+    if (topology.index_map(tdim)->num_ghosts() == 0)
+    {
+      auto facet_map = topology.index_map(tdim - 1);
+      assert(facet_map);
+      missing = facet_map->num_ghosts() > 0
+                or !facet_map->shared_indices().empty();
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &missing, 1, MPI_INT, MPI_LOR,
+                  mesh.mpi_comm());
+    if (missing)
+    {
+      throw std::runtime_error(
+          "Interior facet integrals on a distributed mesh require ghost "
+          "cells (GhostMode::shared_facet).");
+    }
+  }
+
   // Collect together the function, id, and indices of entities to
   // integrate on
   struct Integral
@@ -364,10 +589,70 @@ private:
     std::function<void(T*, const T*, const T*, const double*, const int*,
                        const std::uint8_t*, const std::uint32_t)>
         tabulate;
+
+    // The function pointer wrapped by tabulate, or nullptr if tabulate
+    // does not wrap a plain function pointer
+    void (*tabulate_ptr)(T*, const T*, const T*, const double*, const int*,
+                         const std::uint8_t*, const std::uint32_t);
+
+    // Optional batched tabulate function and its batch size (0 if not
+    // set)
+    std::function<void(T*, const T*, const T*, const double*, const int*,
+                       const std::uint8_t*, const std::uint32_t*)>
+        tabulate_batched;
+    int batch_size;
+
     int id;
     std::vector<std::int32_t> active_entities;
+
+    // Attached cells and local facet indices of active_entities for
+    // facet integrals (see facet_domains)
+    std::vector<std::int32_t> facet_data;
+
+    // Cached colouring of active_entities (colour -> entities)
+    mutable std::shared_ptr<const graph::AdjacencyList<std::int32_t>>
+        colouring;
+
+    // Cached classes of translated cells of active_entities (class ->
+    // entities), and the geometry version they were computed for
+    mutable std::shared_ptr<const graph::AdjacencyList<std::int32_t>>
+        cell_classes;
+    mutable std::uint64_t cell_classes_version = 0;
   };
 
+  // Compute the attached cells and local facet indices of the active
+  // facets of a facet integral
+  static void compute_facet_data(struct Integral& integral, IntegralType type,
+                                 const mesh::Mesh& mesh)
+  {
+    const int tdim = mesh.topology().dim();
+    mesh.topology_mutable().create_connectivity(tdim - 1, tdim);
+    mesh.topology_mutable().create_connectivity(tdim, tdim - 1);
+    auto f_to_c = mesh.topology().connectivity(tdim - 1, tdim);
+    assert(f_to_c);
+    auto c_to_f = mesh.topology().connectivity(tdim, tdim - 1);
+    assert(c_to_f);
+
+    const int num_cells = type == IntegralType::interior_facet ? 2 : 1;
+    integral.facet_data.clear();
+    integral.facet_data.reserve(2 * num_cells
+                                * integral.active_entities.size());
+    for (std::int32_t f : integral.active_entities)
+    {
+      auto cells = f_to_c->links(f);
+      assert(cells.rows() >= num_cells);
+      for (int i = 0; i < num_cells; ++i)
+      {
+        auto facets = c_to_f->links(cells[i]);
+        const auto* it
+            = std::find(facets.data(), facets.data() + facets.rows(), f);
+        assert(it != (facets.data() + facets.rows()));
+        integral.facet_data.push_back(cells[i]);
+        integral.facet_data.push_back(std::distance(facets.data(), it));
+      }
+    }
+  }
+
   // Array of vectors of integrals, arranged by type (see Type enum, and
   // struct Integral above)
   std::array<std::vector<struct Integral>, 4> _integrals;
@@ -375,6 +660,9 @@ private:
   // A bool indicating whether permutation data needs to be passed into
   // these integrals
   bool _needs_permutation_data;
+
+  // Cached cells referenced by the integrals (see active_cells)
+  mutable std::shared_ptr<const std::vector<std::int32_t>> _active_cells;
 };
 } // namespace fem
 } // namespace dolfinx
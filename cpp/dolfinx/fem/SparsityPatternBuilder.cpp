@@ -10,31 +10,151 @@
 #include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/la/SparsityPattern.h>
 #include <dolfinx/mesh/Topology.h>
+#include <stdexcept>
 
 using namespace dolfinx;
 using namespace dolfinx::fem;
 
+namespace
+{
+//-----------------------------------------------------------------------------
+// Get the block sizes of the (blocked) cell dofs of the dofmaps, and
+// check that they match a blocked pattern
+std::array<int, 2>
+insert_block_sizes(const la::SparsityPattern& pattern,
+                   const std::array<const DofMap*, 2>& dofmaps)
+{
+  std::array<int, 2> bs;
+  for (int i = 0; i < 2; ++i)
+  {
+    bs[i] = dofmaps[i]->bs();
+    if (pattern.blocked() and bs[i] != pattern.index_map(i)->block_size())
+    {
+      throw std::runtime_error("Cannot insert into blocked sparsity pattern. "
+                               "Dofmap does not consist of complete blocks.");
+    }
+  }
+  return bs;
+}
+//-----------------------------------------------------------------------------
+// Insert the entries coupling the blocks (rows) and (cols) of the cell
+// dofs, with block sizes bs. The block indices are inserted into a
+// blocked pattern, and the unrolled dofs otherwise.
+void insert_dofs(
+    la::SparsityPattern& pattern, const std::array<int, 2>& bs,
+    const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+        rows,
+    const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+        cols)
+{
+  if (pattern.blocked() or (bs[0] == 1 and bs[1] == 1))
+  {
+    pattern.insert(rows, cols);
+    return;
+  }
+
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> dof_rows(bs[0] * rows.rows());
+  for (Eigen::Index i = 0; i < rows.rows(); ++i)
+    for (int k = 0; k < bs[0]; ++k)
+      dof_rows[bs[0] * i + k] = bs[0] * rows[i] + k;
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> dof_cols(bs[1] * cols.rows());
+  for (Eigen::Index i = 0; i < cols.rows(); ++i)
+    for (int k = 0; k < bs[1]; ++k)
+      dof_cols[bs[1] * i + k] = bs[1] * cols[i] + k;
+  pattern.insert(dof_rows, dof_cols);
+}
+//-----------------------------------------------------------------------------
+// Get the block sizes of the cell dofs of each block of a block system
+std::vector<std::vector<std::array<int, 2>>> insert_block_sizes(
+    const std::vector<std::vector<la::SparsityPattern*>>& patterns,
+    const std::array<std::vector<const DofMap*>, 2>& dofmaps)
+{
+  assert(patterns.size() == dofmaps[0].size());
+  std::vector<std::vector<std::array<int, 2>>> bs(patterns.size());
+  for (std::size_t i = 0; i < patterns.size(); ++i)
+  {
+    assert(patterns[i].size() == dofmaps[1].size());
+    bs[i].resize(patterns[i].size(), {1, 1});
+    for (std::size_t j = 0; j < patterns[i].size(); ++j)
+    {
+      if (patterns[i][j])
+      {
+        assert(dofmaps[0][i]);
+        assert(dofmaps[1][j]);
+        bs[i][j] = insert_block_sizes(*patterns[i][j],
+                                      {dofmaps[0][i], dofmaps[1][j]});
+      }
+    }
+  }
+  return bs;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 //-----------------------------------------------------------------------------
 void SparsityPatternBuilder::cells(
     la::SparsityPattern& pattern, const mesh::Topology& topology,
-    const std::array<const fem::DofMap*, 2> dofmaps)
+    const std::array<const fem::DofMap*, 2> dofmaps, int num_threads)
 {
-  assert(dofmaps[0]);
-  assert(dofmaps[1]);
   const int D = topology.dim();
   auto cells = topology.connectivity(D, 0);
   assert(cells);
-  for (int c = 0; c < cells->num_nodes(); ++c)
-    pattern.insert(dofmaps[0]->cell_dofs(c), dofmaps[1]->cell_dofs(c));
+  const graph::AdjacencyList<std::int32_t>& rows = dofmaps[0]->list_blocked();
+  const graph::AdjacencyList<std::int32_t>& cols = dofmaps[1]->list_blocked();
+  if (rows.num_nodes() != cells->num_nodes()
+      or cols.num_nodes() != cells->num_nodes())
+  {
+    throw std::runtime_error("Number of dofmap cells and mesh cells differ.");
+  }
+  pattern.insert_entities(rows, cols, insert_block_sizes(pattern, dofmaps),
+                          num_threads);
 }
 //-----------------------------------------------------------------------------
 void SparsityPatternBuilder::interior_facets(
     la::SparsityPattern& pattern, const mesh::Topology& topology,
     const std::array<const fem::DofMap*, 2> dofmaps)
 {
-  assert(dofmaps[0]);
-  assert(dofmaps[1]);
-
+  interior_facets({{&pattern}}, topology, {{{dofmaps[0]}, {dofmaps[1]}}});
+}
+//-----------------------------------------------------------------------------
+void SparsityPatternBuilder::exterior_facets(
+    la::SparsityPattern& pattern, const mesh::Topology& topology,
+    const std::array<const fem::DofMap*, 2> dofmaps)
+{
+  exterior_facets({{&pattern}}, topology, {{{dofmaps[0]}, {dofmaps[1]}}});
+}
+//-----------------------------------------------------------------------------
+void SparsityPatternBuilder::cells(
+    const std::vector<std::vector<la::SparsityPattern*>>& patterns,
+    const mesh::Topology& topology,
+    const std::array<std::vector<const fem::DofMap*>, 2>& dofmaps)
+{
+  const int D = topology.dim();
+  auto cells = topology.connectivity(D, 0);
+  assert(cells);
+  const std::vector bs = insert_block_sizes(patterns, dofmaps);
+  for (int c = 0; c < cells->num_nodes(); ++c)
+  {
+    for (std::size_t i = 0; i < patterns.size(); ++i)
+    {
+      auto rows = dofmaps[0][i]->list_blocked().links(c);
+      for (std::size_t j = 0; j < patterns[i].size(); ++j)
+      {
+        if (patterns[i][j])
+        {
+          insert_dofs(*patterns[i][j], bs[i][j], rows,
+                      dofmaps[1][j]->list_blocked().links(c));
+        }
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void SparsityPatternBuilder::interior_facets(
+    const std::vector<std::vector<la::SparsityPattern*>>& patterns,
+    const mesh::Topology& topology,
+    const std::array<std::vector<const fem::DofMap*>, 2>& dofmaps)
+{
   const int D = topology.dim();
   if (!topology.connectivity(D - 1, 0))
     throw std::runtime_error("Topology facets have not been created.");
@@ -43,8 +163,12 @@ void SparsityPatternBuilder::interior_facets(
   if (!connectivity)
     throw std::runtime_error("Facet-cell connectivity has not been computed.");
 
-  // Array to store macro-dofs, if required (for interior facets)
-  std::array<Eigen::Array<std::int32_t, Eigen::Dynamic, 1>, 2> macro_dofs;
+  // Arrays to store the macro-dofs of each field
+  std::array<std::vector<Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>, 2>
+      macro_dofs;
+  for (int d = 0; d < 2; ++d)
+    macro_dofs[d].resize(dofmaps[d].size());
+  const std::vector bs = insert_block_sizes(patterns, dofmaps);
 
   // Loop over owned facets
   auto map = topology.index_map(D - 1);
@@ -59,28 +183,44 @@ void SparsityPatternBuilder::interior_facets(
     if (cells.rows() == 1)
       continue;
 
-    // Tabulate dofs for each dimension on macro element
+    // Tabulate dofs for each field on macro element
     assert(cells.rows() == 2);
     const int cell0 = cells[0];
     const int cell1 = cells[1];
-    for (std::size_t i = 0; i < 2; i++)
+    for (int d = 0; d < 2; ++d)
     {
-      auto cell_dofs0 = dofmaps[i]->cell_dofs(cell0);
-      auto cell_dofs1 = dofmaps[i]->cell_dofs(cell1);
-      macro_dofs[i].resize(cell_dofs0.size() + cell_dofs1.size());
-      std::copy(cell_dofs0.data(), cell_dofs0.data() + cell_dofs0.size(),
-                macro_dofs[i].data());
-      std::copy(cell_dofs1.data(), cell_dofs1.data() + cell_dofs1.size(),
-                macro_dofs[i].data() + cell_dofs0.size());
+      for (std::size_t i = 0; i < dofmaps[d].size(); ++i)
+      {
+        if (!dofmaps[d][i])
+          continue;
+        auto cell_dofs0 = dofmaps[d][i]->list_blocked().links(cell0);
+        auto cell_dofs1 = dofmaps[d][i]->list_blocked().links(cell1);
+        Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& dofs
+            = macro_dofs[d][i];
+        dofs.resize(cell_dofs0.size() + cell_dofs1.size());
+        dofs.head(cell_dofs0.size()) = cell_dofs0;
+        dofs.tail(cell_dofs1.size()) = cell_dofs1;
+      }
     }
 
-    pattern.insert(macro_dofs[0], macro_dofs[1]);
+    for (std::size_t i = 0; i < patterns.size(); ++i)
+    {
+      for (std::size_t j = 0; j < patterns[i].size(); ++j)
+      {
+        if (patterns[i][j])
+        {
+          insert_dofs(*patterns[i][j], bs[i][j], macro_dofs[0][i],
+                      macro_dofs[1][j]);
+        }
+      }
+    }
   }
 }
 //-----------------------------------------------------------------------------
 void SparsityPatternBuilder::exterior_facets(
-    la::SparsityPattern& pattern, const mesh::Topology& topology,
-    const std::array<const fem::DofMap*, 2> dofmaps)
+    const std::vector<std::vector<la::SparsityPattern*>>& patterns,
+    const mesh::Topology& topology,
+    const std::array<std::vector<const fem::DofMap*>, 2>& dofmaps)
 {
   const int D = topology.dim();
   if (!topology.connectivity(D - 1, 0))
@@ -95,6 +235,7 @@ void SparsityPatternBuilder::exterior_facets(
   assert(map);
   assert(map->block_size() == 1);
   const std::int32_t num_facets = map->size_local();
+  const std::vector bs = insert_block_sizes(patterns, dofmaps);
   for (int f = 0; f < num_facets; ++f)
   {
     // Proceed to next facet if we have an interior facet
@@ -103,8 +244,18 @@ void SparsityPatternBuilder::exterior_facets(
 
     auto cells = connectivity->links(f);
     assert(cells.rows() == 1);
-    pattern.insert(dofmaps[0]->cell_dofs(cells[0]),
-                   dofmaps[1]->cell_dofs(cells[0]));
+    for (std::size_t i = 0; i < patterns.size(); ++i)
+    {
+      auto rows = dofmaps[0][i]->list_blocked().links(cells[0]);
+      for (std::size_t j = 0; j < patterns[i].size(); ++j)
+      {
+        if (patterns[i][j])
+        {
+          insert_dofs(*patterns[i][j], bs[i][j], rows,
+                      dofmaps[1][j]->list_blocked().links(cells[0]));
+        }
+      }
+    }
   }
 }
 //-----------------------------------------------------------------------------
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 #include <dolfinx/la/SparsityPattern.h>
 
 namespace dolfinx
@@ -25,14 +26,23 @@ namespace fem
 {
 class DofMap;
 
-/// Functions to compute the sparsity pattern based on DOF maps
+/// Functions to compute the sparsity pattern based on DOF maps. If the
+/// pattern is blocked, the cell dofs must consist of complete blocks
+/// (see DofMap::bs) and their block indices are inserted.
 
 namespace SparsityPatternBuilder
 {
 
-/// Iterate over cells and insert entries into sparsity pattern
+/// Insert the entries of the cells into sparsity pattern (see
+/// la::SparsityPattern::insert_entities)
+/// @param[in,out] pattern The sparsity pattern
+/// @param[in] topology The mesh topology
+/// @param[in] dofmaps The dofmaps of the rows and columns
+/// @param[in] num_threads The number of threads used to compress the
+///   rows of the pattern
 void cells(la::SparsityPattern& pattern, const mesh::Topology& topology,
-           const std::array<const fem::DofMap*, 2> dofmaps);
+           const std::array<const fem::DofMap*, 2> dofmaps,
+           int num_threads = 1);
 
 /// Iterate over interior facets and insert entries into sparsity pattern
 void interior_facets(la::SparsityPattern& pattern,
@@ -44,6 +54,33 @@ void exterior_facets(la::SparsityPattern& pattern,
                      const mesh::Topology& topology,
                      const std::array<const fem::DofMap*, 2> dofmaps);
 
+/// Iterate over cells once and insert the entries of all blocks of a
+/// block system into sparsity patterns
+/// @param[in,out] patterns The pattern of each block (i, j), coupling
+///   dofmaps[0][i] and dofmaps[1][j], or nullptr to skip the block. A
+///   pattern can be shared by several blocks, e.g. a stacked pattern
+///   with dofmaps renumbered to its local indices.
+/// @param[in] topology The mesh topology
+/// @param[in] dofmaps The dofmaps of the row (dofmaps[0]) and column
+///   (dofmaps[1]) fields
+void cells(const std::vector<std::vector<la::SparsityPattern*>>& patterns,
+           const mesh::Topology& topology,
+           const std::array<std::vector<const fem::DofMap*>, 2>& dofmaps);
+
+/// Iterate over interior facets once and insert the entries of all
+/// blocks of a block system into sparsity patterns (see cells)
+void interior_facets(
+    const std::vector<std::vector<la::SparsityPattern*>>& patterns,
+    const mesh::Topology& topology,
+    const std::array<std::vector<const fem::DofMap*>, 2>& dofmaps);
+
+/// Iterate over exterior facets once and insert the entries of all
+/// blocks of a block system into sparsity patterns (see cells)
+void exterior_facets(
+    const std::vector<std::vector<la::SparsityPattern*>>& patterns,
+    const mesh::Topology& topology,
+    const std::array<std::vector<const fem::DofMap*>, 2>& dofmaps);
+
 } // namespace SparsityPatternBuilder
 } // namespace fem
 } // namespace dolfinx
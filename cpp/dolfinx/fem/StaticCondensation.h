@@ -0,0 +1,680 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DirichletBC.h"
+#include "DofMap.h"
+#include "ElementDofLayout.h"
+#include "Form.h"
+#include "FormIntegrals.h"
+#include "utils.h"
+#include <Eigen/Dense>
+#include <array>
+#include <cstdint>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/function/Constant.h>
+#include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+namespace dolfinx::fem
+{
+
+/// Static condensation of the cell-interior dofs of the linear system
+/// A u = b of a bilinear form a and a linear form L.
+///
+/// The interior dofs of a cell (ElementDofLayout::entity_dofs(tdim,
+/// 0)) couple only to the dofs of the same cell, and are eliminated
+/// cell by cell before insertion into the global system. With the cell
+/// dofs split into interface (b) and interior (i) dofs, the condensed
+/// element matrix is the Schur complement S = A_bb - A_bi A_ii^{-1}
+/// A_ib and the condensed element vector is b_b - A_bi A_ii^{-1} b_i.
+/// The condensed system is assembled over the interface dofs only (see
+/// dofmap), which for high-order continuous elements is much smaller
+/// than the full system, and the interior dofs are recovered from the
+/// interface solution with recover.
+///
+/// The forms must have cell integrals only, and the test and trial
+/// spaces of a and the test space of L must have the same dofmap.
+/// Dirichlet boundary conditions must not constrain interior dofs.
+template <typename T>
+class StaticCondensation
+{
+public:
+  /// Create the condensed dof numbering of a linear system (collective)
+  /// @param[in] a The bilinear form
+  /// @param[in] L The linear form
+  StaticCondensation(std::shared_ptr<const Form<T>> a,
+                     std::shared_ptr<const Form<T>> L)
+      : _a(a), _L(L)
+  {
+    common::Timer timer("Create static condensation");
+    assert(a);
+    assert(L);
+    if (a->rank() != 2 or L->rank() != 1)
+    {
+      throw std::runtime_error(
+          "Static condensation requires a bilinear and a linear form");
+    }
+
+    _dofmap_full = a->function_space(0)->dofmap();
+    assert(_dofmap_full);
+    if (a->function_space(1)->dofmap() != _dofmap_full
+        or L->function_space(0)->dofmap() != _dofmap_full)
+    {
+      throw std::runtime_error("Static condensation requires the same "
+                               "dofmap for the test and trial spaces");
+    }
+
+    for (const Form<T>* form : {a.get(), L.get()})
+    {
+      for (IntegralType type : form->integrals().types())
+      {
+        if (type != IntegralType::cell
+            and form->integrals().num_integrals(type) > 0)
+        {
+          throw std::runtime_error(
+              "Static condensation supports only cell integrals");
+        }
+      }
+    }
+
+    std::shared_ptr<const common::IndexMap> map = _dofmap_full->index_map;
+    assert(map);
+    const int bs = _dofmap_full->bs();
+    if (bs != map->block_size())
+    {
+      throw std::runtime_error(
+          "Static condensation requires a blocked dofmap");
+    }
+
+    std::shared_ptr<const mesh::Mesh> mesh = a->mesh();
+    assert(mesh);
+    const int tdim = mesh->topology().dim();
+    const ElementDofLayout& layout = *_dofmap_full->element_dof_layout;
+
+    // Split the cell dofs into interface and interior dofs. The dofs of
+    // a node (block) are either all interior or all interface dofs.
+    const int num_cell_nodes = layout.num_dofs() / bs;
+    std::vector<bool> interior_node(num_cell_nodes, false);
+    for (int d : layout.entity_dofs(tdim, 0))
+      interior_node[d / bs] = true;
+    for (int j = 0; j < num_cell_nodes; ++j)
+    {
+      if (interior_node[j])
+        _interior_nodes.push_back(j);
+      else
+        _interface_nodes.push_back(j);
+      for (int k = 0; k < bs; ++k)
+        (interior_node[j] ? _interior : _interface).push_back(bs * j + k);
+    }
+
+    // Mark the interior nodes of the (owned and ghost) cells
+    const graph::AdjacencyList<std::int32_t>& cell_nodes
+        = _dofmap_full->list_blocked();
+    const std::int32_t size_local = map->size_local();
+    const std::int32_t num_ghosts = map->num_ghosts();
+    std::vector<bool> is_interior(size_local + num_ghosts, false);
+    for (std::int32_t c = 0; c < cell_nodes.num_nodes(); ++c)
+    {
+      auto nodes = cell_nodes.links(c);
+      for (int j : _interior_nodes)
+        is_interior[nodes[j]] = true;
+    }
+
+    // Number the owned interface nodes, and get the numbers of the
+    // ghosts from their owners. The interior nodes of a cell are owned
+    // by the owner of the cell, which therefore marks the node as
+    // interior too.
+    _node_to_interface.resize(size_local + num_ghosts, -1);
+    std::int32_t num_owned = 0;
+    for (std::int32_t i = 0; i < size_local; ++i)
+      if (!is_interior[i])
+        _node_to_interface[i] = num_owned++;
+
+    MPI_Comm comm = mesh->mpi_comm();
+    const std::int64_t offset
+        = dolfinx::MPI::global_offset(comm, num_owned, true);
+    std::vector<std::int64_t> global(size_local, -1);
+    for (std::int32_t i = 0; i < size_local; ++i)
+      if (_node_to_interface[i] >= 0)
+        global[i] = offset + _node_to_interface[i];
+    const std::vector<std::int64_t> ghost_global = map->scatter_fwd(global, 1);
+    const Eigen::Array<int, Eigen::Dynamic, 1> ghost_owners
+        = map->ghost_owner_rank();
+
+    std::vector<std::int64_t> ghosts;
+    std::vector<int> owners;
+    std::int32_t num_interface = num_owned;
+    for (std::int32_t i = 0; i < num_ghosts; ++i)
+    {
+      if (ghost_global[i] >= 0)
+      {
+        _node_to_interface[size_local + i] = num_interface++;
+        ghosts.push_back(ghost_global[i]);
+        owners.push_back(ghost_owners[i]);
+      }
+    }
+
+    const std::vector<int> dest = dolfinx::MPI::compute_graph_edges(
+        comm, std::set<int>(owners.begin(), owners.end()));
+    _index_map = std::make_shared<common::IndexMap>(comm, num_owned, dest,
+                                                    ghosts, owners, bs);
+
+    // Interface dofmap
+    Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        interface_cells(cell_nodes.num_nodes(), _interface_nodes.size());
+    for (std::int32_t c = 0; c < cell_nodes.num_nodes(); ++c)
+    {
+      auto nodes = cell_nodes.links(c);
+      for (std::size_t j = 0; j < _interface_nodes.size(); ++j)
+        interface_cells(c, j) = _node_to_interface[nodes[_interface_nodes[j]]];
+    }
+    _dofmap = std::make_shared<DofMap>(
+        std::make_shared<ElementDofLayout>(
+            interface_layout(layout, mesh->topology().cell_type())),
+        _index_map, graph::AdjacencyList<std::int32_t>(interface_cells), bs);
+  }
+
+  /// The mesh of the forms
+  std::shared_ptr<const mesh::Mesh> mesh() const { return _a->mesh(); }
+
+  /// The index map of the interface dofs, i.e. of the condensed system
+  std::shared_ptr<const common::IndexMap> index_map() const
+  {
+    return _index_map;
+  }
+
+  /// The dofmap of the interface dofs, i.e. of the condensed system
+  std::shared_ptr<const DofMap> dofmap() const { return _dofmap; }
+
+  /// Create the sparsity pattern of the condensed matrix. The pattern
+  /// is not finalised, i.e. the caller is responsible for calling
+  /// SparsityPattern::assemble.
+  /// @param[in] blocked Create the pattern in block form (see
+  ///   fem::create_sparsity_pattern)
+  la::SparsityPattern create_sparsity_pattern(bool blocked = false) const
+  {
+    return fem::create_sparsity_pattern(_a->mesh()->topology(),
+                                        {_dofmap.get(), _dofmap.get()},
+                                        {IntegralType::cell}, blocked);
+  }
+
+  /// Assemble the condensed matrix. The rows and columns of the
+  /// interface dofs with Dirichlet conditions are zeroed (the diagonal
+  /// is not set, see add_diagonal). The matrix is not finalised.
+  /// @param[in] mat_add The inserter int(std::int32_t m, const
+  ///   std::int32_t* rows, std::int32_t n, const std::int32_t* cols,
+  ///   const T* vals) with (unrolled) local indices of the interface
+  ///   dofs (see index_map), adding the row-major values vals
+  /// @param[in] bcs The Dirichlet boundary conditions
+  template <typename U>
+  void assemble_matrix(
+      const U& mat_add,
+      const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs) const
+  {
+    common::Timer timer("Assemble condensed matrix");
+    const std::vector<bool> bc = bc_markers(bcs);
+    CellTabulator tabulate(*this, false);
+    CellSystem cell;
+    for (std::int32_t c : tabulate.cells())
+    {
+      tabulate(c, cell);
+      if (cell.has_bc)
+      {
+        for (std::size_t i = 0; i < _interface.size(); ++i)
+        {
+          if (bc[cell.dofs[i]])
+          {
+            cell.S.row(i).setZero();
+            cell.S.col(i).setZero();
+          }
+        }
+      }
+      mat_add(cell.idofs.size(), cell.idofs.data(), cell.idofs.size(),
+              cell.idofs.data(), cell.S.data());
+    }
+  }
+
+  /// Add a value to the diagonal of the condensed matrix for the owned
+  /// interface dofs with Dirichlet conditions, e.g. after assemble_matrix
+  /// @param[in] mat_add The inserter (see assemble_matrix)
+  /// @param[in] bcs The Dirichlet boundary conditions
+  /// @param[in] diagonal The value to add to the diagonal
+  template <typename U>
+  void add_diagonal(
+      const U& mat_add,
+      const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+      T diagonal = 1.0) const
+  {
+    if (bcs.empty())
+      return;
+    const std::vector<bool> marked = bc_markers(bcs);
+    const int bs = _index_map->block_size();
+    const std::int32_t size_owned = bs * _index_map->size_local();
+    for (std::size_t i = 0; i < _node_to_interface.size(); ++i)
+    {
+      const std::int32_t node = _node_to_interface[i];
+      for (int k = 0; k < bs; ++k)
+      {
+        const std::int32_t dof = bs * node + k;
+        if (node >= 0 and dof < size_owned and marked[bs * i + k])
+          mat_add(1, &dof, 1, &dof, &diagonal);
+      }
+    }
+  }
+
+  /// Assemble the condensed vector, with the lifting of the Dirichlet
+  /// conditions applied, i.e. b_b - S g for the condensed matrix S and
+  /// the boundary values g. Entries for ghost dofs are computed, and
+  /// the values of the constrained dofs are not set (see set_bc).
+  /// @param[in,out] b The vector over the owned and ghost interface
+  ///   dofs
+  /// @param[in] bcs The Dirichlet boundary conditions
+  void assemble_vector(
+      Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
+      const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs) const
+  {
+    common::Timer timer("Assemble condensed vector");
+    const std::vector<bool> marked = bc_markers(bcs);
+    Eigen::Matrix<T, Eigen::Dynamic, 1> g;
+    if (!bcs.empty())
+    {
+      g.setZero(marked.size());
+      for (const auto& bc : bcs)
+        bc->dof_values(g);
+    }
+
+    CellTabulator tabulate(*this, true);
+    CellSystem cell;
+    for (std::int32_t c : tabulate.cells())
+    {
+      tabulate(c, cell);
+      if (cell.has_bc)
+      {
+        for (std::size_t j = 0; j < _interface.size(); ++j)
+          if (marked[cell.dofs[j]])
+            cell.r -= cell.S.col(j) * g[cell.dofs[j]];
+      }
+      for (std::size_t i = 0; i < cell.idofs.size(); ++i)
+        b[cell.idofs[i]] += cell.r[i];
+    }
+  }
+
+  /// Set the entries of the owned interface dofs with Dirichlet
+  /// conditions to scale * g, with g the boundary values
+  /// @param[in,out] b The vector over the owned (and ghost) interface
+  ///   dofs
+  /// @param[in] bcs The Dirichlet boundary conditions
+  /// @param[in] scale The scaling of the boundary values
+  void set_bc(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
+              const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+              double scale = 1.0) const
+  {
+    if (bcs.empty())
+      return;
+    const std::vector<bool> marked = bc_markers(bcs);
+    Eigen::Matrix<T, Eigen::Dynamic, 1> g
+        = Eigen::Matrix<T, Eigen::Dynamic, 1>::Zero(marked.size());
+    for (const auto& bc : bcs)
+      bc->dof_values(g);
+
+    const int bs = _index_map->block_size();
+    const std::int32_t size_owned = bs * _index_map->size_local();
+    for (std::size_t i = 0; i < _node_to_interface.size(); ++i)
+    {
+      const std::int32_t node = _node_to_interface[i];
+      for (int k = 0; k < bs; ++k)
+        if (node >= 0 and bs * node + k < size_owned and marked[bs * i + k])
+          b[bs * node + k] = scale * g[bs * i + k];
+    }
+  }
+
+  /// Recover the full solution from the solution of the condensed
+  /// system. The interface dofs of x are set to the values of @p
+  /// x_interface and the interior dofs of the assembled cells to
+  /// A_ii^{-1} (b_i - A_ib x_b), for which the element tensors are
+  /// computed again. Interior dofs that are ghosts are updated only if
+  /// their cell is assembled here, e.g. call scatter_fwd on the
+  /// function afterwards.
+  /// @param[in] x_interface The solution of the condensed system over
+  ///   the owned and ghost interface dofs
+  /// @param[in,out] x The vector over the owned and ghost dofs of the
+  ///   function space
+  void recover(const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>&
+                   x_interface,
+               Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> x) const
+  {
+    common::Timer timer("Recover condensed dofs");
+    const int bs = _index_map->block_size();
+    for (std::size_t i = 0; i < _node_to_interface.size(); ++i)
+    {
+      const std::int32_t node = _node_to_interface[i];
+      if (node >= 0)
+      {
+        for (int k = 0; k < bs; ++k)
+          x[bs * i + k] = x_interface[bs * node + k];
+      }
+    }
+
+    if (_interior.empty())
+      return;
+
+    CellTabulator tabulate(*this, true);
+    CellSystem cell;
+    Eigen::Matrix<T, Eigen::Dynamic, 1> xb(_interface.size());
+    for (std::int32_t c : tabulate.cells())
+    {
+      tabulate(c, cell);
+      for (std::size_t j = 0; j < cell.idofs.size(); ++j)
+        xb[j] = x_interface[cell.idofs[j]];
+      const Eigen::Matrix<T, Eigen::Dynamic, 1> xi = cell.h - cell.K * xb;
+      for (std::size_t i = 0; i < _interior.size(); ++i)
+        x[cell.dofs[_interface.size() + i]] = xi[i];
+    }
+  }
+
+private:
+  // Condensed tensors of a cell
+  struct CellSystem
+  {
+    // Dofs of the cell in the full space, interface dofs followed by
+    // interior dofs
+    std::vector<std::int32_t> dofs;
+
+    // Interface dofs of the cell in the condensed space
+    std::vector<std::int32_t> idofs;
+
+    // True if an interface dof of the cell has a Dirichlet condition
+    bool has_bc = false;
+
+    // Schur complement S = A_bb - A_bi K (row-major, for insertion)
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> S;
+
+    // Condensed vector r = b_b - A_bi h
+    Eigen::Matrix<T, Eigen::Dynamic, 1> r;
+
+    // K = A_ii^{-1} A_ib and h = A_ii^{-1} b_i
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> K;
+    Eigen::Matrix<T, Eigen::Dynamic, 1> h;
+  };
+
+  // Computes the element tensors of the cell integrals of a (and L) and
+  // condenses them
+  class CellTabulator
+  {
+  public:
+    CellTabulator(const StaticCondensation& sc, bool with_L)
+        : _sc(sc), _forms({sc._a.get(), with_L ? sc._L.get() : nullptr}),
+          _cell_coordinates(sc._a->mesh()->geometry())
+    {
+      std::shared_ptr<const mesh::Mesh> mesh = sc._a->mesh();
+      const int tdim = mesh->topology().dim();
+      const std::int32_t num_cells
+          = mesh->topology().index_map(tdim)->size_local()
+            + mesh->topology().index_map(tdim)->num_ghosts();
+
+      std::vector<bool> active(num_cells, false);
+      bool needs_permutation_data = false;
+      for (std::size_t k = 0; k < _forms.size(); ++k)
+      {
+        if (!_forms[k])
+          continue;
+        if (!_forms[k]->all_constants_set())
+          throw std::runtime_error("Unset constant in Form");
+        _coeffs[k] = &pack_coefficients(*_forms[k]);
+        _constants[k] = &pack_constants(*_forms[k]);
+
+        const FormIntegrals<T>& integrals = _forms[k]->integrals();
+        needs_permutation_data = needs_permutation_data
+                                 or integrals.needs_permutation_data();
+        for (int i = 0; i < integrals.num_integrals(IntegralType::cell); ++i)
+        {
+          std::vector<bool> marker(num_cells, false);
+          for (std::int32_t c :
+               integrals.integral_domains(IntegralType::cell, i))
+          {
+            marker[c] = true;
+            active[c] = true;
+          }
+          _markers[k].push_back(std::move(marker));
+        }
+      }
+
+      for (std::int32_t c = 0; c < num_cells; ++c)
+        if (active[c])
+          _cells.push_back(c);
+
+      if (needs_permutation_data)
+      {
+        mesh->topology_mutable().create_cell_permutation_info();
+        _cell_info = mesh->topology().get_cell_permutation_info();
+      }
+      else
+        _cell_info.setZero(num_cells);
+
+      const int ndofs = sc._interface.size() + sc._interior.size();
+      _Ae.resize(ndofs, ndofs);
+      _be.resize(ndofs);
+    }
+
+    // The cells of the integrals
+    const std::vector<std::int32_t>& cells() const { return _cells; }
+
+    // Compute the condensed tensors of cell c
+    void operator()(std::int32_t c, CellSystem& cell)
+    {
+      const double* coordinate_dofs = _cell_coordinates(c);
+      _Ae.setZero();
+      _be.setZero();
+      for (std::size_t k = 0; k < _forms.size(); ++k)
+      {
+        if (!_forms[k])
+          continue;
+        T* A = k == 0 ? _Ae.data() : _be.data();
+        const FormIntegrals<T>& integrals = _forms[k]->integrals();
+        for (std::size_t i = 0; i < _markers[k].size(); ++i)
+        {
+          if (_markers[k][i][c])
+          {
+            const auto& fn
+                = integrals.get_tabulate_tensor(IntegralType::cell, i);
+            fn(A, _coeffs[k]->row(c).data(), _constants[k]->data(),
+               coordinate_dofs, nullptr, nullptr, _cell_info[c]);
+          }
+        }
+      }
+
+      // Dofs of the cell
+      const std::vector<int>& ib = _sc._interface;
+      const std::vector<int>& ii = _sc._interior;
+      const int bs = _sc._index_map->block_size();
+      auto nodes = _sc._dofmap_full->list_blocked().links(c);
+      auto inodes = _sc._dofmap->list_blocked().links(c);
+      cell.dofs.resize(ib.size() + ii.size());
+      cell.idofs.resize(ib.size());
+      for (std::size_t j = 0; j < ib.size(); ++j)
+      {
+        cell.dofs[j] = bs * nodes[ib[j] / bs] + ib[j] % bs;
+        cell.idofs[j] = bs * inodes[j / bs] + j % bs;
+      }
+      for (std::size_t j = 0; j < ii.size(); ++j)
+        cell.dofs[ib.size() + j] = bs * nodes[ii[j] / bs] + ii[j] % bs;
+      cell.has_bc = false;
+      if (!_sc._bc_cells.empty())
+        cell.has_bc = _sc._bc_cells[c];
+
+      // Blocks of the element tensors
+      const int nb = ib.size();
+      const int ni = ii.size();
+      Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> Abb(nb, nb),
+          Abi(nb, ni), Aib(ni, nb), Aii(ni, ni);
+      Eigen::Matrix<T, Eigen::Dynamic, 1> bb(nb), bi(ni);
+      for (int i = 0; i < nb; ++i)
+      {
+        bb[i] = _be[ib[i]];
+        for (int j = 0; j < nb; ++j)
+          Abb(i, j) = _Ae(ib[i], ib[j]);
+        for (int j = 0; j < ni; ++j)
+          Abi(i, j) = _Ae(ib[i], ii[j]);
+      }
+      for (int i = 0; i < ni; ++i)
+      {
+        bi[i] = _be[ii[i]];
+        for (int j = 0; j < nb; ++j)
+          Aib(i, j) = _Ae(ii[i], ib[j]);
+        for (int j = 0; j < ni; ++j)
+          Aii(i, j) = _Ae(ii[i], ii[j]);
+      }
+
+      // Eliminate the interior dofs
+      if (ni > 0)
+      {
+        Eigen::PartialPivLU<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>>
+            lu(Aii);
+        cell.K = lu.solve(Aib);
+        cell.h = lu.solve(bi);
+        cell.S = Abb - Abi * cell.K;
+        cell.r = bb - Abi * cell.h;
+      }
+      else
+      {
+        cell.K.resize(0, nb);
+        cell.h.resize(0);
+        cell.S = Abb;
+        cell.r = bb;
+      }
+    }
+
+  private:
+    const StaticCondensation& _sc;
+    std::array<const Form<T>*, 2> _forms;
+    std::array<const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic,
+                                  Eigen::RowMajor>*,
+               2>
+        _coeffs = {nullptr, nullptr};
+    std::array<const Eigen::Array<T, Eigen::Dynamic, 1>*, 2> _constants
+        = {nullptr, nullptr};
+    std::array<std::vector<std::vector<bool>>, 2> _markers;
+    std::vector<std::int32_t> _cells;
+    Eigen::Array<std::uint32_t, Eigen::Dynamic, 1> _cell_info;
+    impl::CellCoordinates _cell_coordinates;
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> _Ae;
+    Eigen::Matrix<T, Eigen::Dynamic, 1> _be;
+  };
+
+  // Mark the (unrolled) dofs of the full space with Dirichlet
+  // conditions, and the cells with a constrained dof
+  std::vector<bool> bc_markers(
+      const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs) const
+  {
+    const int bs = _index_map->block_size();
+    std::vector<bool> markers(bs * _node_to_interface.size(), false);
+    for (const auto& bc : bcs)
+    {
+      assert(bc);
+      bc->mark_dofs(markers);
+    }
+
+    for (std::size_t i = 0; i < _node_to_interface.size(); ++i)
+    {
+      for (int k = 0; k < bs; ++k)
+      {
+        if (_node_to_interface[i] < 0 and markers[bs * i + k])
+        {
+          throw std::runtime_error("Dirichlet conditions cannot be applied "
+                                   "to condensed (cell-interior) dofs");
+        }
+      }
+    }
+
+    _bc_cells.clear();
+    if (!bcs.empty())
+    {
+      const graph::AdjacencyList<std::int32_t>& nodes
+          = _dofmap_full->list_blocked();
+      _bc_cells.resize(nodes.num_nodes(), false);
+      for (std::int32_t c = 0; c < nodes.num_nodes(); ++c)
+        for (int j : _interface_nodes)
+          for (int k = 0; k < bs; ++k)
+            if (markers[bs * nodes.links(c)[j] + k])
+              _bc_cells[c] = true;
+    }
+    return markers;
+  }
+
+  // The layout of the interface dofs of a cell, i.e. of the layout of
+  // the full space without the interior dofs
+  ElementDofLayout interface_layout(const ElementDofLayout& layout,
+                                    mesh::CellType cell_type) const
+  {
+    std::vector<int> new_index(layout.num_dofs(), -1);
+    for (std::size_t i = 0; i < _interface.size(); ++i)
+      new_index[_interface[i]] = i;
+
+    std::vector<std::vector<std::set<int>>> entity_dofs;
+    for (const std::vector<std::set<int>>& dofs_d : layout.entity_dofs_all())
+    {
+      std::vector<std::set<int>>& new_dofs_d = entity_dofs.emplace_back();
+      for (const std::set<int>& dofs : dofs_d)
+      {
+        std::set<int>& new_dofs = new_dofs_d.emplace_back();
+        for (int d : dofs)
+          if (new_index[d] >= 0)
+            new_dofs.insert(new_index[d]);
+      }
+    }
+
+    // Restrict the permutations to the interface dofs. The dofs of an
+    // entity are permuted among themselves.
+    const Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        perms = layout.base_permutations();
+    const int num_cols
+        = perms.cols() == layout.num_dofs() ? _interface.size() : 0;
+    Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        new_perms(perms.rows(), num_cols);
+    for (Eigen::Index p = 0; p < new_perms.rows(); ++p)
+      for (Eigen::Index i = 0; i < new_perms.cols(); ++i)
+        new_perms(p, i) = new_index[perms(p, _interface[i])];
+
+    return ElementDofLayout(layout.block_size(), entity_dofs, {}, {},
+                            cell_type, new_perms);
+  }
+
+  // The forms
+  std::shared_ptr<const Form<T>> _a, _L;
+
+  // The dofmap of the full space
+  std::shared_ptr<const DofMap> _dofmap_full;
+
+  // Cell-local (unrolled) interface and interior dofs, and the
+  // interface and interior nodes (blocks)
+  std::vector<int> _interface, _interior;
+  std::vector<int> _interface_nodes, _interior_nodes;
+
+  // Map from the (block) index of the full space to the (block) index
+  // of the interface dofs, -1 for interior dofs
+  std::vector<std::int32_t> _node_to_interface;
+
+  // Index map and dofmap of the interface dofs
+  std::shared_ptr<const common::IndexMap> _index_map;
+  std::shared_ptr<const DofMap> _dofmap;
+
+  // Cells with a constrained interface dof, for the current boundary
+  // conditions
+  mutable std::vector<bool> _bc_cells;
+};
+
+} // namespace dolfinx::fem
@@ -0,0 +1,153 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "SumFactorisation.h"
+#include "FiniteElement.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+using namespace dolfinx;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Compute the Gauss-Legendre points and weights on [0, 1] (ascending)
+std::pair<std::vector<double>, std::vector<double>> gauss_legendre(int m)
+{
+  const double pi = std::acos(-1.0);
+  std::vector<double> points(m), weights(m);
+  for (int i = 0; i < m; ++i)
+  {
+    // Newton iteration for the ith root of the Legendre polynomial P_m
+    // on [-1, 1], starting from the Chebyshev-like guess
+    double x = -std::cos(pi * (i + 0.75) / (m + 0.5));
+    double dp = 0;
+    for (int it = 0; it < 100; ++it)
+    {
+      double p0 = 1, p1 = x;
+      for (int k = 2; k <= m; ++k)
+      {
+        const double p2 = ((2 * k - 1) * x * p1 - (k - 1) * p0) / k;
+        p0 = p1;
+        p1 = p2;
+      }
+      dp = m * (x * p1 - p0) / (x * x - 1);
+      const double dx = p1 / dp;
+      x -= dx;
+      if (std::abs(dx) < 1.0e-15)
+        break;
+    }
+
+    points[i] = 0.5 * (1 + x);
+    weights[i] = 1.0 / ((1 - x * x) * dp * dp);
+  }
+
+  return {std::move(points), std::move(weights)};
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+fem::TensorProductTabulation
+fem::tabulate_tensor_product(const FiniteElement& element, int num_points)
+{
+  const mesh::CellType cell = element.cell_shape();
+  if (cell != mesh::CellType::quadrilateral
+      and cell != mesh::CellType::hexahedron)
+  {
+    throw std::runtime_error("Tensor-product tabulation requires a "
+                             "quadrilateral or hexahedral element.");
+  }
+  if (element.value_size() != 1 or element.num_sub_elements() > 0)
+    throw std::runtime_error("Tensor-product tabulation requires a scalar "
+                             "element.");
+  if (num_points < 1)
+    throw std::runtime_error("Number of points must be positive.");
+
+  // Get the 1D nodes from the dof coordinates
+  const int tdim = mesh::cell_dim(cell);
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+      X = element.dof_reference_coordinates();
+  const int num_dofs = element.space_dimension();
+  std::vector<double> nodes;
+  nodes.reserve(num_dofs);
+  for (int i = 0; i < num_dofs; ++i)
+    nodes.push_back(X(i, 0));
+  std::sort(nodes.begin(), nodes.end());
+  constexpr double eps = 1.0e-10;
+  nodes.erase(std::unique(nodes.begin(), nodes.end(),
+                          [](double a, double b) { return b - a < eps; }),
+              nodes.end());
+  const int n = nodes.size();
+  if (std::pow(n, tdim) != num_dofs)
+    throw std::runtime_error("Element is not a tensor-product element.");
+
+  // Map the lexicographic indices to the element dofs
+  TensorProductTabulation tab;
+  tab.dofs.assign(num_dofs, -1);
+  for (int i = 0; i < num_dofs; ++i)
+  {
+    int index = 0;
+    for (int e = tdim - 1; e >= 0; --e)
+    {
+      auto it = std::lower_bound(nodes.begin(), nodes.end(), X(i, e) - eps);
+      if (it == nodes.end() or std::abs(*it - X(i, e)) > eps)
+        throw std::runtime_error("Element is not a tensor-product element.");
+      index = n * index + std::distance(nodes.begin(), it);
+    }
+    if (tab.dofs[index] != -1)
+      throw std::runtime_error("Element is not a tensor-product element.");
+    tab.dofs[index] = i;
+  }
+
+  // Evaluate the element basis on the points of the edge along X0
+  // through the first node, where the basis functions with
+  // lexicographic index (i, 0, 0) reduce to the 1D basis functions
+  std::tie(tab.points, tab.weights) = gauss_legendre(num_points);
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> P(
+      num_points, tdim);
+  P.fill(nodes[0]);
+  for (int q = 0; q < num_points; ++q)
+    P(q, 0) = tab.points[q];
+  std::shared_ptr<const Eigen::Tensor<double, 3, Eigen::RowMajor>> _values
+      = element.tabulate_reference_basis(P);
+  std::shared_ptr<const Eigen::Tensor<double, 4, Eigen::RowMajor>> _derivs
+      = element.tabulate_reference_basis_derivatives(1, P);
+  const Eigen::Tensor<double, 3, Eigen::RowMajor>& values = *_values;
+  const Eigen::Tensor<double, 4, Eigen::RowMajor>& derivs = *_derivs;
+  tab.phi.resize(num_points, n);
+  tab.dphi.resize(num_points, n);
+  for (int q = 0; q < num_points; ++q)
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      tab.phi(q, i) = values(q, tab.dofs[i], 0);
+      tab.dphi(q, i) = derivs(q, tab.dofs[i], 0, 0);
+    }
+  }
+
+  // Check the tensor-product structure at a point that is not on the
+  // edge
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Y(
+      1, tdim);
+  for (int e = 0; e < tdim; ++e)
+    Y(0, e) = tab.points[(num_points - 1 - e) % num_points];
+  Eigen::Tensor<double, 3, Eigen::RowMajor> values_Y(1, num_dofs, 1);
+  element.evaluate_reference_basis(values_Y, Y);
+  for (int i = 0; i < num_dofs; ++i)
+  {
+    double phi = 1;
+    for (int e = 0, index = i; e < tdim; ++e, index /= n)
+      phi *= tab.phi((num_points - 1 - e) % num_points, index % n);
+    if (std::abs(phi - values_Y(0, tab.dofs[i], 0)) > 1.0e-8)
+      throw std::runtime_error("Element is not a tensor-product element.");
+  }
+
+  return tab;
+}
+//-----------------------------------------------------------------------------
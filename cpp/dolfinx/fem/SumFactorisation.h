@@ -0,0 +1,469 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DofMap.h"
+#include "utils.h"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <dolfinx/mesh/cell_types.h>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace dolfinx::fem
+{
+class FiniteElement;
+
+/// One-dimensional tabulation of a tensor-product (Q) Lagrange element
+/// on a quadrilateral or hexahedron. The basis function of the element
+/// with lexicographic index (i0, i1, i2) is the product
+/// phi_i0(X0) phi_i1(X1) phi_i2(X2) of one-dimensional basis functions.
+struct TensorProductTabulation
+{
+  /// Gauss-Legendre points on [0, 1]
+  std::vector<double> points;
+
+  /// Gauss-Legendre weights on [0, 1]
+  std::vector<double> weights;
+
+  /// Values of the 1D basis functions, phi(q, i) = phi_i(points[q])
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> phi;
+
+  /// Derivatives of the 1D basis functions, dphi(q, i) =
+  /// phi_i'(points[q])
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> dphi;
+
+  /// Map from the lexicographic index i0 + n i1 + n^2 i2, with n the
+  /// number of 1D basis functions, to the element dof
+  std::vector<int> dofs;
+};
+
+/// Tabulate the 1D basis functions of a tensor-product Lagrange element
+/// at Gauss-Legendre points. The 1D basis is obtained by evaluating
+/// the element basis on an edge of the reference cell, and the
+/// tensor-product structure of the element is checked.
+/// @param[in] element A scalar Lagrange element on a quadrilateral or
+///   hexahedron
+/// @param[in] num_points The number of Gauss-Legendre points in each
+///   direction
+/// @return The tabulation
+TensorProductTabulation tabulate_tensor_product(const FiniteElement& element,
+                                                int num_points);
+
+namespace impl
+{
+/// Apply a matrix along direction @p dir of a dense tensor of rank
+/// three or less, i.e. out[.., i, ..] = sum_j A(i, j) in[.., j, ..],
+/// with direction 0 the fastest index
+/// @param[in] A The matrix (row-major). It is m x n, or n x m if
+///   @p transpose is true, in which case its transpose is applied.
+/// @param[in] m The size of the output along @p dir
+/// @param[in] n The size of the input along @p dir
+/// @param[in] transpose True if the transpose of A is applied
+/// @param[in] dir The direction
+/// @param[in] shape The shape of the input. Unused directions have
+///   size 1.
+/// @param[in] in The input
+/// @param[out] out The output, with the shape of the input except for
+///   size m along @p dir
+template <typename T>
+void contract(const double* A, int m, int n, bool transpose, int dir,
+              const std::array<int, 3>& shape, const T* in, T* out)
+{
+  int pre = 1, post = 1;
+  for (int e = 0; e < dir; ++e)
+    pre *= shape[e];
+  for (int e = dir + 1; e < 3; ++e)
+    post *= shape[e];
+
+  for (int k = 0; k < post; ++k)
+  {
+    for (int i = 0; i < m; ++i)
+    {
+      T* _out = out + (k * m + i) * pre;
+      std::fill(_out, _out + pre, T(0));
+      for (int j = 0; j < n; ++j)
+      {
+        const double a = transpose ? A[j * m + i] : A[i * n + j];
+        const T* _in = in + (k * n + j) * pre;
+        for (int p = 0; p < pre; ++p)
+          _out[p] += a * _in[p];
+      }
+    }
+  }
+}
+} // namespace impl
+
+/// Matrix-free operator for the bilinear form
+///
+///   a(u, v) = int kappa grad(u) . grad(v) + sigma u v dx
+///
+/// on a mesh of quadrilaterals or hexahedra with a scalar
+/// tensor-product Lagrange space, using sum factorisation. The action
+/// and the diagonal of the operator on a cell cost O(p^(d + 1))
+/// operations for degree p in dimension d, instead of O(p^(2d)) for the
+/// element matrix of a generated kernel. The geometric factors at the
+/// quadrature points are computed on construction. The geometry must
+/// be (multi)linear, i.e. the coordinate element must have degree one.
+template <typename T>
+class SumFactorisedOperator
+{
+public:
+  /// Create the operator
+  /// @param[in] V The function space (test and trial)
+  /// @param[in] kappa The coefficient of the stiffness term
+  /// @param[in] sigma The coefficient of the mass term
+  /// @param[in] num_points The number of Gauss-Legendre points in each
+  ///   direction. If 0, the degree of V plus one is used, which is
+  ///   exact for affine cells.
+  SumFactorisedOperator(std::shared_ptr<const function::FunctionSpace> V,
+                        double kappa, double sigma, int num_points = 0)
+      : _V(V), _kappa(kappa), _sigma(sigma)
+  {
+    assert(V);
+    assert(V->element());
+    assert(V->mesh());
+    const mesh::Mesh& mesh = *V->mesh();
+    _tdim = mesh.topology().dim();
+    const mesh::CellType cell = mesh.topology().cell_type();
+    if (cell != mesh::CellType::quadrilateral
+        and cell != mesh::CellType::hexahedron)
+    {
+      throw std::runtime_error(
+          "Sum factorisation requires quadrilateral or hexahedral cells.");
+    }
+    if (mesh.geometry().dim() != _tdim)
+    {
+      throw std::runtime_error("Sum factorisation requires the geometric "
+                               "and topological dimensions to be equal.");
+    }
+
+    // Tabulate the 1D basis functions
+    const int n = std::round(
+        std::pow(V->element()->space_dimension(), 1.0 / _tdim));
+    _tab = tabulate_tensor_product(*V->element(),
+                                   num_points > 0 ? num_points : n);
+    _n = _tab.phi.cols();
+    _nq = _tab.points.size();
+
+    compute_geometric_factors();
+  }
+
+  /// Get the function space
+  /// @return The function space
+  std::shared_ptr<const function::FunctionSpace> function_space() const
+  {
+    return _V;
+  }
+
+  /// Get the 1D tabulation of the element
+  /// @return The tabulation
+  const TensorProductTabulation& tabulation() const { return _tab; }
+
+  /// Compute y += A x, where A is the matrix of the operator, over the
+  /// owned cells. The vectors x and y hold the owned and ghost entries
+  /// in local indexing. Ghost contributions to y are not sent to the
+  /// owner.
+  /// @param[in,out] y The output vector
+  /// @param[in] x The input vector
+  /// @param[in] bc Boundary condition markers. The rows and columns of
+  ///   A for marked dofs are zeroed.
+  void apply(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> y,
+             const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x,
+             const BCMarkers& bc) const
+  {
+    const graph::AdjacencyList<std::int32_t>& dofmap
+        = _V->dofmap()->list_blocked();
+    const int size_u = std::pow(_n, _tdim);
+    const int size_q = std::pow(_nq, _tdim);
+    const int num_factors = geometric_factors_size();
+    const double* B = _tab.phi.data();
+    const double* D = _tab.dphi.data();
+
+    std::vector<T> u(size_u), v(size_u), val(size_q);
+    std::array<std::vector<T>, 3> grad;
+    for (int d = 0; d < _tdim; ++d)
+      grad[d].resize(size_q);
+    std::vector<T> work0(std::max(size_u, size_q)),
+        work1(std::max(size_u, size_q));
+
+    for (std::int32_t c = 0; c < _num_cells; ++c)
+    {
+      auto dofs = dofmap.links(c);
+      const bool has_bc = !bc.cells.empty() and bc.cells[c];
+      for (int i = 0; i < size_u; ++i)
+      {
+        const std::int32_t dof = dofs[_tab.dofs[i]];
+        u[i] = (has_bc and bc.dofs[dof]) ? T(0) : x[dof];
+      }
+
+      // Values and reference gradients at the quadrature points
+      interpolate(B, B, B, u.data(), val.data(), work0, work1);
+      for (int d = 0; d < _tdim; ++d)
+      {
+        interpolate(d == 0 ? D : B, d == 1 ? D : B, d == 2 ? D : B,
+                    u.data(), grad[d].data(), work0, work1);
+      }
+
+      // Apply the geometric factors
+      const double* G = _G.data() + std::size_t(c) * size_q * num_factors;
+      for (int q = 0; q < size_q; ++q)
+      {
+        const double* Gq = G + q * num_factors;
+        const std::array<T, 3> g
+            = {grad[0][q], _tdim > 1 ? grad[1][q] : T(0),
+               _tdim > 2 ? grad[2][q] : T(0)};
+        for (int a = 0; a < _tdim; ++a)
+        {
+          T f = 0;
+          for (int b = 0; b < _tdim; ++b)
+            f += Gq[factor(a, b)] * g[b];
+          grad[a][q] = _kappa * f;
+        }
+        val[q] *= _sigma * Gq[num_factors - 1];
+      }
+
+      // Integrate against the test functions
+      integrate(B, B, B, val.data(), v.data(), work0, work1, false);
+      for (int d = 0; d < _tdim; ++d)
+      {
+        integrate(d == 0 ? D : B, d == 1 ? D : B, d == 2 ? D : B,
+                  grad[d].data(), v.data(), work0, work1, true);
+      }
+
+      for (int i = 0; i < size_u; ++i)
+      {
+        const std::int32_t dof = dofs[_tab.dofs[i]];
+        if (!(has_bc and bc.dofs[dof]))
+          y[dof] += v[i];
+      }
+    }
+  }
+
+  /// Add the diagonal of the matrix A of the operator, over the owned
+  /// cells, to d. Ghost contributions to d are not sent to the owner.
+  /// @param[in,out] d The vector, with owned and ghost entries
+  /// @param[in] bc Boundary condition markers. The diagonal entries of
+  ///   marked dofs are not changed.
+  void diagonal(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> d,
+                const BCMarkers& bc) const
+  {
+    const graph::AdjacencyList<std::int32_t>& dofmap
+        = _V->dofmap()->list_blocked();
+    const int size_u = std::pow(_n, _tdim);
+    const int size_q = std::pow(_nq, _tdim);
+    const int num_factors = geometric_factors_size();
+
+    // Element-wise products of the 1D tabulations
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>
+        BB = _tab.phi * _tab.phi, BD = _tab.phi * _tab.dphi,
+        DD = _tab.dphi * _tab.dphi;
+    auto product = [&](int a, int b, int e) {
+      if (e == a and e == b)
+        return DD.data();
+      else if (e == a or e == b)
+        return BD.data();
+      else
+        return BB.data();
+    };
+
+    std::vector<T> f(size_q), v(size_u);
+    std::vector<T> work0(std::max(size_u, size_q)),
+        work1(std::max(size_u, size_q));
+    for (std::int32_t c = 0; c < _num_cells; ++c)
+    {
+      const double* G = _G.data() + std::size_t(c) * size_q * num_factors;
+      for (int q = 0; q < size_q; ++q)
+        f[q] = _sigma * G[q * num_factors + num_factors - 1];
+      integrate(BB.data(), BB.data(), BB.data(), f.data(), v.data(), work0,
+                work1, false);
+      for (int a = 0; a < _tdim; ++a)
+      {
+        for (int b = a; b < _tdim; ++b)
+        {
+          const double scale = (a == b ? 1.0 : 2.0) * _kappa;
+          for (int q = 0; q < size_q; ++q)
+            f[q] = scale * G[q * num_factors + factor(a, b)];
+          integrate(product(a, b, 0), product(a, b, 1), product(a, b, 2),
+                    f.data(), v.data(), work0, work1, true);
+        }
+      }
+
+      auto dofs = dofmap.links(c);
+      const bool has_bc = !bc.cells.empty() and bc.cells[c];
+      for (int i = 0; i < size_u; ++i)
+      {
+        const std::int32_t dof = dofs[_tab.dofs[i]];
+        if (!(has_bc and bc.dofs[dof]))
+          d[dof] += v[i];
+      }
+    }
+  }
+
+private:
+  // Number of geometric factors per quadrature point: the symmetric
+  // tensor |det J| w K K^T and |det J| w
+  int geometric_factors_size() const { return _tdim * (_tdim + 1) / 2 + 1; }
+
+  // Position of entry (a, b) of the symmetric tensor in the geometric
+  // factors of a quadrature point
+  int factor(int a, int b) const
+  {
+    if (a > b)
+      std::swap(a, b);
+    return a * _tdim - a * (a - 1) / 2 + (b - a);
+  }
+
+  // Evaluate the tensor-product function with coefficients u (n^d) at
+  // the quadrature points (nq^d), applying the 1D matrices M0, M1, M2
+  // (nq x n) in the three directions
+  void interpolate(const double* M0, const double* M1, const double* M2,
+                   const T* u, T* out, std::vector<T>& work0,
+                   std::vector<T>& work1) const
+  {
+    const std::array<const double*, 3> M = {M0, M1, M2};
+    std::array<int, 3> shape = {1, 1, 1};
+    for (int e = 0; e < _tdim; ++e)
+      shape[e] = _n;
+    const T* in = u;
+    for (int e = 0; e < _tdim; ++e)
+    {
+      T* _out = (e == _tdim - 1) ? out : (e % 2 == 0 ? work0 : work1).data();
+      impl::contract(M[e], _nq, _n, false, e, shape, in, _out);
+      shape[e] = _nq;
+      in = _out;
+    }
+  }
+
+  // Integrate the values f (nq^d) at the quadrature points against the
+  // tensor-product functions, applying the transposes of the 1D
+  // matrices M0, M1, M2 (nq x n), and set (or add to) v (n^d)
+  void integrate(const double* M0, const double* M1, const double* M2,
+                 const T* f, T* v, std::vector<T>& work0,
+                 std::vector<T>& work1, bool add) const
+  {
+    const std::array<const double*, 3> M = {M0, M1, M2};
+    std::array<int, 3> shape = {1, 1, 1};
+    for (int e = 0; e < _tdim; ++e)
+      shape[e] = _nq;
+    const T* in = f;
+    for (int e = 0; e < _tdim; ++e)
+    {
+      T* _out = (e % 2 == 0 ? work0 : work1).data();
+      impl::contract(M[e], _n, _nq, true, e, shape, in, _out);
+      shape[e] = _n;
+      in = _out;
+    }
+
+    const int size_u = std::pow(_n, _tdim);
+    if (add)
+      std::transform(v, v + size_u, in, v, std::plus<T>());
+    else
+      std::copy(in, in + size_u, v);
+  }
+
+  // Compute the geometric factors at the quadrature points of the
+  // owned cells
+  void compute_geometric_factors()
+  {
+    const mesh::Mesh& mesh = *_V->mesh();
+    const mesh::Geometry& geometry = mesh.geometry();
+    _num_cells = mesh.topology().index_map(_tdim)->size_local();
+    const int num_nodes = 1 << _tdim;
+    if (geometry.dofmap().num_nodes() > 0
+        and geometry.dofmap().num_links(0) != num_nodes)
+    {
+      throw std::runtime_error(
+          "Sum factorisation requires a (multi)linear geometry.");
+    }
+
+    const int size_q = std::pow(_nq, _tdim);
+    const int num_factors = geometric_factors_size();
+    _G.resize(std::size_t(_num_cells) * size_q * num_factors);
+    impl::CellCoordinates cell_coordinates(geometry);
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> J(_tdim, _tdim);
+    for (std::int32_t c = 0; c < _num_cells; ++c)
+    {
+      // Node coordinates in lexicographic (tensor-product) order
+      const double* x = cell_coordinates(c);
+      for (int q = 0; q < size_q; ++q)
+      {
+        std::array<int, 3> qi = {q % _nq, (q / _nq) % _nq, q / (_nq * _nq)};
+        std::array<double, 3> X = {0, 0, 0};
+        double w = 1;
+        for (int e = 0; e < _tdim; ++e)
+        {
+          X[e] = _tab.points[qi[e]];
+          w *= _tab.weights[qi[e]];
+        }
+
+        // Jacobian of the (multi)linear map
+        J.setZero();
+        for (int node = 0; node < num_nodes; ++node)
+        {
+          for (int b = 0; b < _tdim; ++b)
+          {
+            double dN = 1;
+            for (int e = 0; e < _tdim; ++e)
+            {
+              const bool upper = (node >> e) & 1;
+              if (e == b)
+                dN *= upper ? 1.0 : -1.0;
+              else
+                dN *= upper ? X[e] : 1.0 - X[e];
+            }
+            for (int a = 0; a < _tdim; ++a)
+              J(a, b) += x[node * _tdim + a] * dN;
+          }
+        }
+
+        const double detJ = std::abs(J.determinant());
+        const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> K
+            = J.inverse();
+        const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> KKt
+            = K * K.transpose();
+        double* G = _G.data() + (std::size_t(c) * size_q + q) * num_factors;
+        for (int a = 0; a < _tdim; ++a)
+          for (int b = a; b < _tdim; ++b)
+            G[factor(a, b)] = detJ * w * KKt(a, b);
+        G[num_factors - 1] = detJ * w;
+      }
+    }
+  }
+
+  // Function space
+  std::shared_ptr<const function::FunctionSpace> _V;
+
+  // Coefficients of the stiffness and mass terms
+  double _kappa, _sigma;
+
+  // 1D tabulation
+  TensorProductTabulation _tab;
+
+  // Topological dimension, number of 1D basis functions and number of
+  // 1D quadrature points
+  int _tdim, _n, _nq;
+
+  // Number of owned cells
+  std::int32_t _num_cells;
+
+  // Geometric factors (cell, quadrature point, factor)
+  std::vector<double> _G;
+};
+
+} // namespace dolfinx::fem
@@ -10,6 +10,9 @@
 #include "Form.h"
 #include "utils.h"
 #include <Eigen/Dense>
+#include <algorithm>
+#include <dolfinx/common/ThreadPool.h>
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/function/FunctionSpace.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/la/utils.h>
@@ -17,68 +20,288 @@
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/Topology.h>
 #include <functional>
+#include <mutex>
+#include <type_traits>
 #include <vector>
 
 namespace dolfinx::fem::impl
 {
 
+/// Add the element matrix of cell c using the inserter mat_set. If the
+/// inserter accepts the cell index as an additional first argument,
+/// e.g. to look up precomputed positions in the matrix storage, it is
+/// called with the cell index. Otherwise the cell index is dropped.
+template <typename T, typename U>
+int insert_cell(const U& mat_set, std::int32_t c, std::int32_t m,
+                const std::int32_t* rows, std::int32_t n,
+                const std::int32_t* cols, const T* vals)
+{
+  if constexpr (std::is_invocable_v<const U&, std::int32_t, std::int32_t,
+                                    const std::int32_t*, std::int32_t,
+                                    const std::int32_t*, const T*>)
+  {
+    return mat_set(c, m, rows, n, cols, vals);
+  }
+  else
+    return mat_set(m, rows, n, cols, vals);
+}
+
+/// Check if cell c has a dof with a boundary condition applied
+inline bool has_bc(const BCMarkers& bc, std::int32_t c)
+{
+  return !bc.cells.empty() and bc.cells[c];
+}
+
+/// Zero the rows and columns of an element matrix for dofs with
+/// boundary conditions applied. The rows (columns) are only checked if
+/// @p rows (@p cols) is true, i.e. if the cell has a constrained dof
+/// (see has_bc). The rows and columns are zeroed by multiplying with
+/// 0/1 masks rather than by branching on each dof.
+/// @param[in,out] Ae The element matrix (row-major)
+/// @param[in] bc0 The row markers
+/// @param[in] bc1 The column markers
+/// @param[in] dofs0 The (unrolled) row dofs of the element matrix
+/// @param[in] dofs1 The (unrolled) column dofs of the element matrix
+/// @param[in] rows True if the rows should be checked
+/// @param[in] cols True if the columns should be checked
+template <typename Matrix>
+void zero_bc_entries(Matrix& Ae, const BCMarkers& bc0, const BCMarkers& bc1,
+                     const std::int32_t* dofs0, const std::int32_t* dofs1,
+                     bool rows, bool cols)
+{
+  using T = typename Matrix::Scalar;
+  if (rows)
+  {
+    Eigen::Array<T, Eigen::Dynamic, 1> mask(Ae.rows());
+    for (Eigen::Index i = 0; i < Ae.rows(); ++i)
+      mask[i] = static_cast<T>(1 - bc0.dofs[dofs0[i]]);
+    Ae.array().colwise() *= mask;
+  }
+  if (cols)
+  {
+    Eigen::Array<T, 1, Eigen::Dynamic> mask(Ae.cols());
+    for (Eigen::Index j = 0; j < Ae.cols(); ++j)
+      mask[j] = static_cast<T>(1 - bc1.dofs[dofs1[j]]);
+    Ae.array().rowwise() *= mask;
+  }
+}
+
 /// The matrix A must already be initialised. The matrix may be a proxy,
 /// i.e. a view into a larger matrix, and assembly is performed using
 /// local indices. Rows (bc0) and columns (bc1) with Dirichlet
 /// conditions are zeroed. Markers (bc0 and bc1) can be empty if not bcs
-/// are applied. Matrix is not finalised.
+/// are applied (see BCMarkers). Matrix is not finalised.
+///
+/// The inserter type U is a template parameter so that inserters can
+/// be inlined into the assembly loops. Any callable with the signature
+/// int(std::int32_t m, const std::int32_t* rows, std::int32_t n, const
+/// std::int32_t* cols, const T* vals) may be used. Inserters that in
+/// addition accept the cell index as first argument are called with it
+/// for cell integrals in serial assembly (see insert_cell).
 
-template <typename T>
+template <typename T, typename U>
 void assemble_matrix(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set_values,
-    const Form<T>& a, const std::vector<bool>& bc0,
-    const std::vector<bool>& bc1);
+    const U& mat_set_values,
+    const Form<T>& a, const BCMarkers& bc0,
+    const BCMarkers& bc1);
 
-/// Execute kernel over cells and accumulate result in matrix
+/// Assemble bilinear form using packed coefficients (see
+/// pack_coefficients). See assemble_matrix above for the other
+/// arguments.
+/// @param[in] num_threads The number of threads, or 0 to use the
+///   number of threads of the form (see Form::set_num_threads)
+template <typename T, typename U>
+void assemble_matrix(
+    const U& mat_set_values, const Form<T>& a,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const BCMarkers& bc0, const BCMarkers& bc1, int num_threads = 0);
+
+/// Assemble the exterior and interior facet integrals of a bilinear
+/// form into a matrix. See assemble_matrix for the arguments.
+/// @param[in] mat_set_values The matrix inserter
+/// @param[in] a The bilinear form
+/// @param[in] coeffs The packed coefficients of a
+/// @param[in] constants The packed constants of a
+/// @param[in] cell_info The cell permutation data
+/// @param[in] bc0 The row boundary condition markers
+/// @param[in] bc1 The column boundary condition markers
+/// @param[in] num_threads The number of threads, or 0 to use the
+///   number of threads of the form
+template <typename T, typename U>
+void assemble_matrix_facets(
+    const U& mat_set_values, const Form<T>& a,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
+    const BCMarkers& bc0, const BCMarkers& bc1, int num_threads = 0);
+
+/// Compute y += A x, where A is the matrix of the bilinear form a,
+/// cell by cell without storing A. The vectors x and y hold the owned
+/// and ghost entries of the trial and test space, respectively, in
+/// local indexing. Rows (bc0) and columns (bc1) of A with Dirichlet
+/// conditions are zeroed. Ghost contributions to y are not sent to the
+/// owner.
+template <typename T>
+void assemble_action(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> y, const Form<T>& a,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x,
+    const BCMarkers& bc0, const BCMarkers& bc1);
+
+/// Add the diagonal of the matrix A of the bilinear form a to d without
+/// storing A. The test and trial space must be the same. Rows (bc0) and
+/// columns (bc1) of A with Dirichlet conditions are zeroed. Ghost
+/// contributions to d are not sent to the owner.
+template <typename T>
+void assemble_diagonal(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> d,
+                       const Form<T>& a, const BCMarkers& bc0,
+                       const BCMarkers& bc1);
+
+/// Add the row sums of the matrix A of the bilinear form a (the lumped
+/// diagonal) to d without storing A. Rows (bc0) and columns (bc1) of A
+/// with Dirichlet conditions are zeroed. Ghost contributions to d are
+/// not sent to the owner.
 template <typename T>
+void assemble_lumped(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> d,
+                     const Form<T>& a, const BCMarkers& bc0,
+                     const BCMarkers& bc1);
+
+/// Execute kernel over cells and accumulate result in matrix
+template <typename T, typename U, typename Kernel>
 void assemble_cells(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set_values,
+    const U& mat_set_values,
+    const mesh::Geometry& geometry,
+    const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+        active_cells,
+    const graph::AdjacencyList<std::int32_t>& dofmap0,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1,
+    const Kernel& kernel,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info);
+
+/// Execute kernel once per class of translated cells (see
+/// compute_cell_classes) and accumulate the element tensor of the class
+/// in the matrix for each cell of the class. The kernel must not depend
+/// on coefficients.
+template <typename T, typename U, typename Kernel>
+void assemble_cells_classes(
+    const U& mat_set_values, const mesh::Geometry& geometry,
+    const graph::AdjacencyList<std::int32_t>& classes,
+    const graph::AdjacencyList<std::int32_t>& dofmap0,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1, const Kernel& kernel,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info);
+
+/// Execute kernel over coloured cells and accumulate result in matrix.
+/// The cells of each colour are divided between @p num_threads threads.
+/// Calls to @p mat_set_values are serialised, since inserters such as
+/// MatSetValuesLocal are not thread-safe.
+template <typename T, typename U, typename Kernel>
+void assemble_cells_threaded(
+    const U& mat_set_values,
+    const mesh::Geometry& geometry,
+    const graph::AdjacencyList<std::int32_t>& colouring, int num_threads,
+    const graph::AdjacencyList<std::int32_t>& dofmap0,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1,
+    const Kernel& kernel,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info);
+
+/// Execute batched kernel over cells and accumulate result in matrix.
+/// The cells are processed in batches of @p batch_size, see
+/// FormIntegrals::get_tabulate_tensor_batched for the data layout.
+template <typename T, typename U>
+void assemble_cells_batched(
+    const U& mat_set_values,
     const mesh::Geometry& geometry,
     const std::vector<std::int32_t>& active_cells,
     const graph::AdjacencyList<std::int32_t>& dofmap0,
-    const graph::AdjacencyList<std::int32_t>& dofmap1,
-    const std::vector<bool>& bc0, const std::vector<bool>& bc1,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1,
     const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& kernel,
+                             const std::uint8_t*, const std::uint32_t*)>&
+        kernel,
+    int batch_size,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info);
 
-/// Execute kernel over exterior facets and  accumulate result in Mat
-template <typename T>
+/// Execute kernel over exterior facets and  accumulate result in Mat.
+/// The facets are given by their attached cell and local facet index
+/// (see FormIntegrals::facet_domains).
+template <typename T, typename U, typename Kernel>
 void assemble_exterior_facets(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set_values,
-    const mesh::Mesh& mesh, const std::vector<std::int32_t>& active_facets,
+    const U& mat_set_values,
+    const mesh::Mesh& mesh, const std::vector<std::int32_t>& facets,
     const graph::AdjacencyList<std::int32_t>& dofmap0,
-    const graph::AdjacencyList<std::int32_t>& dofmap1,
-    const std::vector<bool>& bc0, const std::vector<bool>& bc1,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& fn,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1,
+    const Kernel& fn,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const Eigen::Array<T, Eigen::Dynamic, 1> constants,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
     const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms);
 
-/// Execute kernel over interior facets and  accumulate result in Mat
-template <typename T>
-void assemble_interior_facets(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set_values,
-    const mesh::Mesh& mesh, const std::vector<std::int32_t>& active_facets,
-    const DofMap& dofmap0, const DofMap& dofmap1, const std::vector<bool>& bc0,
-    const std::vector<bool>& bc1,
+/// Execute batched kernel over exterior facets and accumulate result
+/// in Mat. The facets are processed in batches of @p batch_size.
+template <typename T, typename U>
+void assemble_exterior_facets_batched(
+    const U& mat_set_values,
+    const mesh::Mesh& mesh, const std::vector<std::int32_t>& facets,
+    const graph::AdjacencyList<std::int32_t>& dofmap0,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1,
     const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& kernel,
+                             const std::uint8_t*, const std::uint32_t*)>&
+        kernel,
+    int batch_size,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
+    const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms);
+
+/// Execute kernel over interior facets and  accumulate result in Mat.
+/// The facets are given by their two attached cells and local facet
+/// indices (see FormIntegrals::facet_domains).
+template <typename T, typename U, typename Kernel>
+void assemble_interior_facets(
+    const U& mat_set_values,
+    const mesh::Mesh& mesh,
+    const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+        facets,
+    const DofMap& dofmap0, const DofMap& dofmap1, const BCMarkers& bc0,
+    const BCMarkers& bc1,
+    const Kernel& kernel,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const std::vector<int>& offsets,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
+    const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms);
+
+/// Execute kernel over coloured interior facets and accumulate result
+/// in matrix. The facets of each colour (see
+/// compute_interior_facet_colouring) are divided between @p num_threads
+/// threads. Calls to @p mat_set_values are serialised.
+template <typename T, typename U, typename Kernel>
+void assemble_interior_facets_threaded(
+    const U& mat_set_values,
+    const mesh::Mesh& mesh,
+    const graph::AdjacencyList<std::int32_t>& colouring, int num_threads,
+    const DofMap& dofmap0, const DofMap& dofmap1, const BCMarkers& bc0,
+    const BCMarkers& bc1,
+    const Kernel& kernel,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const std::vector<int>& offsets,
@@ -87,13 +310,25 @@ void assemble_interior_facets(
     const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms);
 
 //-----------------------------------------------------------------------------
-template <typename T>
+template <typename T, typename U>
+void assemble_matrix(
+    const U& mat_set_values,
+    const Form<T>& a, const BCMarkers& bc0,
+    const BCMarkers& bc1)
+{
+  impl::assemble_matrix(mat_set_values, a, pack_coefficients(a), bc0, bc1);
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename U>
 void assemble_matrix(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set_values,
-    const Form<T>& a, const std::vector<bool>& bc0,
-    const std::vector<bool>& bc1)
+    const U& mat_set_values, const Form<T>& a,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const BCMarkers& bc0, const BCMarkers& bc1, int num_threads)
 {
+  if (num_threads < 1)
+    num_threads = a.num_threads();
+
   std::shared_ptr<const mesh::Mesh> mesh = a.mesh();
   assert(mesh);
   const int tdim = mesh->topology().dim();
@@ -105,22 +340,20 @@ void assemble_matrix(
   std::shared_ptr<const fem::DofMap> dofmap1 = a.function_space(1)->dofmap();
   assert(dofmap0);
   assert(dofmap1);
-  const graph::AdjacencyList<std::int32_t>& dofs0 = dofmap0->list();
-  const graph::AdjacencyList<std::int32_t>& dofs1 = dofmap1->list();
+  const graph::AdjacencyList<std::int32_t>& dofs0 = dofmap0->list_blocked();
+  const graph::AdjacencyList<std::int32_t>& dofs1 = dofmap1->list_blocked();
+  const int bs0 = dofmap0->bs();
+  const int bs1 = dofmap1->bs();
 
   // Prepare constants
   if (!a.all_constants_set())
     throw std::runtime_error("Unset constant in Form");
-  const Eigen::Array<T, Eigen::Dynamic, 1> constants = pack_constants(a);
-
-  // Prepare coefficients
-  const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> coeffs
-      = pack_coefficients(a);
+  const Eigen::Array<T, Eigen::Dynamic, 1>& constants = pack_constants(a);
 
   const FormIntegrals<T>& integrals = a.integrals();
   const bool needs_permutation_data = integrals.needs_permutation_data();
   if (needs_permutation_data)
-    mesh->topology_mutable().create_entity_permutations();
+    mesh->topology_mutable().create_cell_permutation_info();
   const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info
       = needs_permutation_data
             ? mesh->topology().get_cell_permutation_info()
@@ -128,20 +361,102 @@ void assemble_matrix(
 
   for (int i = 0; i < integrals.num_integrals(IntegralType::cell); ++i)
   {
-    const auto& fn = integrals.get_tabulate_tensor(IntegralType::cell, i);
-    const std::vector<std::int32_t>& active_cells
-        = integrals.integral_domains(IntegralType::cell, i);
-    impl::assemble_cells<T>(mat_set_values, mesh->geometry(), active_cells,
-                            dofs0, dofs1, bc0, bc1, fn, coeffs, constants,
-                            cell_info);
+    const int batch_size = integrals.batch_size(IntegralType::cell, i);
+    if (a.reuse_cell_tensors() and num_threads == 1)
+    {
+      if (coeffs.cols() > 0)
+      {
+        throw std::runtime_error("Element tensors cannot be reused for "
+                                 "forms with coefficients.");
+      }
+      const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1> no_info;
+      std::shared_ptr<const graph::AdjacencyList<std::int32_t>> classes
+          = impl::cell_classes(a, i,
+                               needs_permutation_data ? cell_info : no_info);
+      impl::dispatch_kernel(
+          integrals, IntegralType::cell, i, [&](const auto& fn) {
+            impl::assemble_cells_classes<T>(mat_set_values, mesh->geometry(),
+                                            *classes, dofs0, dofs1, bs0, bs1,
+                                            bc0, bc1, fn, constants,
+                                            cell_info);
+          });
+    }
+    else if (batch_size > 0 and num_threads == 1)
+    {
+      const auto& fn_batched
+          = integrals.get_tabulate_tensor_batched(IntegralType::cell, i);
+      impl::assemble_cells_batched<T>(
+          mat_set_values, mesh->geometry(),
+          integrals.integral_domains(IntegralType::cell, i), dofs0, dofs1,
+          bs0, bs1, bc0, bc1, fn_batched, batch_size, coeffs, constants,
+          cell_info);
+    }
+    else if (num_threads > 1)
+    {
+      impl::dispatch_kernel(
+          integrals, IntegralType::cell, i, [&](const auto& fn) {
+            impl::assemble_cells_threaded<T>(
+                mat_set_values, mesh->geometry(), *impl::cell_colouring(a, i),
+                num_threads, dofs0, dofs1, bs0, bs1, bc0, bc1, fn, coeffs,
+                constants, cell_info);
+          });
+    }
+    else
+    {
+      const std::vector<std::int32_t>& active_cells
+          = integrals.integral_domains(IntegralType::cell, i);
+      const Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>
+          cells(active_cells.data(), active_cells.size());
+      impl::dispatch_kernel(
+          integrals, IntegralType::cell, i, [&](const auto& fn) {
+            impl::assemble_cells<T>(mat_set_values, mesh->geometry(), cells,
+                                    dofs0, dofs1, bs0, bs1, bc0, bc1, fn,
+                                    coeffs, constants, cell_info);
+          });
+    }
   }
 
+  impl::assemble_matrix_facets(mat_set_values, a, coeffs, constants,
+                               cell_info, bc0, bc1, num_threads);
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename U>
+void assemble_matrix_facets(
+    const U& mat_set_values, const Form<T>& a,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
+    const BCMarkers& bc0, const BCMarkers& bc1, int num_threads)
+{
+  if (num_threads < 1)
+    num_threads = a.num_threads();
+
+  std::shared_ptr<const mesh::Mesh> mesh = a.mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+  const std::int32_t num_cells
+      = mesh->topology().connectivity(tdim, 0)->num_nodes();
+
+  std::shared_ptr<const fem::DofMap> dofmap0 = a.function_space(0)->dofmap();
+  std::shared_ptr<const fem::DofMap> dofmap1 = a.function_space(1)->dofmap();
+  assert(dofmap0);
+  assert(dofmap1);
+  const graph::AdjacencyList<std::int32_t>& dofs0 = dofmap0->list_blocked();
+  const graph::AdjacencyList<std::int32_t>& dofs1 = dofmap1->list_blocked();
+  const int bs0 = dofmap0->bs();
+  const int bs1 = dofmap1->bs();
+
+  const FormIntegrals<T>& integrals = a.integrals();
+  const bool needs_permutation_data = integrals.needs_permutation_data();
   if (integrals.num_integrals(IntegralType::exterior_facet) > 0
       or integrals.num_integrals(IntegralType::interior_facet) > 0)
   {
     // FIXME: cleanup these calls? Some of the happen internally again.
     mesh->topology_mutable().create_entities(tdim - 1);
     mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
+    if (needs_permutation_data)
+      mesh->topology_mutable().create_facet_permutations();
 
     const int facets_per_cell
         = mesh::cell_num_entities(mesh->topology().cell_type(), tdim - 1);
@@ -154,199 +469,395 @@ void assemble_matrix(
     for (int i = 0; i < integrals.num_integrals(IntegralType::exterior_facet);
          ++i)
     {
-      const auto& fn
-          = integrals.get_tabulate_tensor(IntegralType::exterior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = integrals.integral_domains(IntegralType::exterior_facet, i);
-      impl::assemble_exterior_facets<T>(mat_set_values, *mesh, active_facets,
-                                        dofs0, dofs1, bc0, bc1, fn, coeffs,
-                                        constants, cell_info, perms);
+      const std::vector<std::int32_t>& facets
+          = integrals.facet_domains(IntegralType::exterior_facet, i);
+      if (const int batch_size
+          = integrals.batch_size(IntegralType::exterior_facet, i);
+          batch_size > 0)
+      {
+        impl::assemble_exterior_facets_batched<T>(
+            mat_set_values, *mesh, facets, dofs0, dofs1, bs0, bs1, bc0, bc1,
+            integrals.get_tabulate_tensor_batched(IntegralType::exterior_facet,
+                                                  i),
+            batch_size, coeffs, constants, cell_info, perms);
+      }
+      else
+      {
+        impl::dispatch_kernel(
+            integrals, IntegralType::exterior_facet, i, [&](const auto& fn) {
+              impl::assemble_exterior_facets<T>(
+                  mat_set_values, *mesh, facets, dofs0, dofs1, bs0, bs1, bc0,
+                  bc1, fn, coeffs, constants, cell_info, perms);
+            });
+      }
     }
 
     const std::vector<int> c_offsets = a.coefficients().offsets();
     for (int i = 0; i < integrals.num_integrals(IntegralType::interior_facet);
          ++i)
     {
-      const auto& fn
-          = integrals.get_tabulate_tensor(IntegralType::interior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = integrals.integral_domains(IntegralType::interior_facet, i);
-      impl::assemble_interior_facets<T>(
-          mat_set_values, *mesh, active_facets, *dofmap0, *dofmap1, bc0, bc1,
-          fn, coeffs, c_offsets, constants, cell_info, perms);
+      if (num_threads > 1)
+      {
+        impl::dispatch_kernel(
+            integrals, IntegralType::interior_facet, i, [&](const auto& fn) {
+              impl::assemble_interior_facets_threaded<T>(
+                  mat_set_values, *mesh, *impl::interior_facet_colouring(a, i),
+                  num_threads, *dofmap0, *dofmap1, bc0, bc1, fn, coeffs,
+                  c_offsets, constants, cell_info, perms);
+            });
+      }
+      else
+      {
+        const std::vector<std::int32_t>& active_facets
+            = integrals.facet_domains(IntegralType::interior_facet, i);
+        const Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>
+            facets(active_facets.data(), active_facets.size());
+        impl::dispatch_kernel(
+            integrals, IntegralType::interior_facet, i, [&](const auto& fn) {
+              impl::assemble_interior_facets<T>(
+                  mat_set_values, *mesh, facets, *dofmap0, *dofmap1, bc0, bc1,
+                  fn, coeffs, c_offsets, constants, cell_info, perms);
+            });
+      }
     }
   }
 }
 //-----------------------------------------------------------------------------
-template <typename T>
+template <typename T, typename U, typename Kernel>
 void assemble_cells(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set,
+    const U& mat_set,
     const mesh::Geometry& geometry,
-    const std::vector<std::int32_t>& active_cells,
+    const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+        active_cells,
     const graph::AdjacencyList<std::int32_t>& dofmap0,
-    const graph::AdjacencyList<std::int32_t>& dofmap1,
-    const std::vector<bool>& bc0, const std::vector<bool>& bc1,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& kernel,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1,
+    const Kernel& kernel,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info)
 {
-  const int gdim = geometry.dim();
+  common::Timer timer("Assemble cells (matrix)");
 
   // Prepare cell geometry
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
-
-  // FIXME: Add proper interface for num coordinate dofs
-  const int num_dofs_g = x_dofmap.num_links(0);
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
-      = geometry.x();
+  impl::CellCoordinates cell_coordinates(geometry);
 
   // Data structures used in assembly
-  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      coordinate_dofs(num_dofs_g, gdim);
-  const int num_dofs0 = dofmap0.links(0).size();
-  const int num_dofs1 = dofmap1.links(0).size();
-  Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Ae(
-      num_dofs0, num_dofs1);
+  const int num_dofs0 = bs0 * dofmap0.links(0).size();
+  const int num_dofs1 = bs1 * dofmap1.links(0).size();
+  std::vector<std::int32_t> dofs0(num_dofs0), dofs1(num_dofs1);
+  ElementTensor<T> Ae(num_dofs0, num_dofs1);
+  auto _Ae = Ae.matrix();
 
   // Iterate over active cells
-  for (std::int32_t c : active_cells)
+  for (Eigen::Index index = 0; index < active_cells.rows(); ++index)
   {
-    // Get cell coordinates/geometry
-    auto x_dofs = x_dofmap.links(c);
-    for (int i = 0; i < x_dofs.rows(); ++i)
-      for (int j = 0; j < gdim; ++j)
-        coordinate_dofs(i, j) = x_g(x_dofs[i], j);
+    const std::int32_t c = active_cells[index];
 
     // Tabulate tensor
-    std::fill(Ae.data(), Ae.data() + num_dofs0 * num_dofs1, 0);
+    Ae.set_zero();
     kernel(Ae.data(), coeffs.row(c).data(), constants.data(),
-           coordinate_dofs.data(), nullptr, nullptr, cell_info[c]);
+           cell_coordinates(c), nullptr, nullptr, cell_info[c]);
 
     // Zero rows/columns for essential bcs
-    auto dofs0 = dofmap0.links(c);
-    auto dofs1 = dofmap1.links(c);
-    if (!bc0.empty())
+    unroll_dofs(dofmap0.links(c), bs0, dofs0);
+    unroll_dofs(dofmap1.links(c), bs1, dofs1);
+    zero_bc_entries(_Ae, bc0, bc1, dofs0.data(), dofs1.data(),
+                    has_bc(bc0, c), has_bc(bc1, c));
+
+    impl::insert_cell<T>(mat_set, c, dofs0.size(), dofs0.data(),
+                         dofs1.size(), dofs1.data(), Ae.data());
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename U, typename Kernel>
+void assemble_cells_classes(
+    const U& mat_set, const mesh::Geometry& geometry,
+    const graph::AdjacencyList<std::int32_t>& classes,
+    const graph::AdjacencyList<std::int32_t>& dofmap0,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1, const Kernel& kernel,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info)
+{
+  // Prepare cell geometry
+  impl::CellCoordinates cell_coordinates(geometry);
+
+  // Data structures used in assembly
+  const int num_dofs0 = bs0 * dofmap0.links(0).size();
+  const int num_dofs1 = bs1 * dofmap1.links(0).size();
+  std::vector<std::int32_t> dofs0(num_dofs0), dofs1(num_dofs1);
+  Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> A0(
+      num_dofs0, num_dofs1),
+      Ae(num_dofs0, num_dofs1);
+
+  for (std::int32_t k = 0; k < classes.num_nodes(); ++k)
+  {
+    auto cells = classes.links(k);
+    if (cells.rows() == 0)
+      continue;
+
+    // Tabulate tensor on the first cell of the class
+    const std::int32_t c0 = cells[0];
+    A0.setZero();
+    kernel(A0.data(), nullptr, constants.data(), cell_coordinates(c0),
+           nullptr, nullptr, cell_info[c0]);
+
+    for (Eigen::Index i = 0; i < cells.rows(); ++i)
     {
-      for (Eigen::Index i = 0; i < Ae.rows(); ++i)
+      const std::int32_t c = cells[i];
+      unroll_dofs(dofmap0.links(c), bs0, dofs0);
+      unroll_dofs(dofmap1.links(c), bs1, dofs1);
+      const bool bc0_c = has_bc(bc0, c), bc1_c = has_bc(bc1, c);
+      const T* Ae_ptr = A0.data();
+      if (bc0_c or bc1_c)
       {
-        if (bc0[dofs0[i]])
-          Ae.row(i).setZero();
+        // Zero rows/columns for essential bcs
+        Ae = A0;
+        zero_bc_entries(Ae, bc0, bc1, dofs0.data(), dofs1.data(), bc0_c,
+                        bc1_c);
+        Ae_ptr = Ae.data();
       }
+
+      impl::insert_cell<T>(mat_set, c, dofs0.size(), dofs0.data(),
+                           dofs1.size(), dofs1.data(), Ae_ptr);
     }
-    if (!bc1.empty())
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename U, typename Kernel>
+void assemble_cells_threaded(
+    const U& mat_set_values,
+    const mesh::Geometry& geometry,
+    const graph::AdjacencyList<std::int32_t>& colouring, int num_threads,
+    const graph::AdjacencyList<std::int32_t>& dofmap0,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1,
+    const Kernel& kernel,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info)
+{
+  // Build the geometry cell coordinate cache (if enabled) before
+  // threads access it
+  geometry.cell_coordinates();
+
+  std::mutex mutex;
+  auto mat_set_serial
+      = [&mutex, &mat_set_values](std::int32_t m, const std::int32_t* rows,
+                                  std::int32_t n, const std::int32_t* cols,
+                                  const T* vals) {
+          std::lock_guard<std::mutex> lock(mutex);
+          return mat_set_values(m, rows, n, cols, vals);
+        };
+
+  for (std::int32_t colour = 0; colour < colouring.num_nodes(); ++colour)
+  {
+    auto cells = colouring.links(colour);
+    common::parallel_for(
+        num_threads, cells.rows(), [&](int, std::int32_t c0, std::int32_t c1) {
+          impl::assemble_cells<T>(mat_set_serial, geometry,
+                                  cells.segment(c0, c1 - c0), dofmap0,
+                                  dofmap1, bs0, bs1, bc0, bc1, kernel,
+                                  coeffs, constants, cell_info);
+        });
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename U>
+void assemble_cells_batched(
+    const U& mat_set,
+    const mesh::Geometry& geometry,
+    const std::vector<std::int32_t>& active_cells,
+    const graph::AdjacencyList<std::int32_t>& dofmap0,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1,
+    const std::function<void(T*, const T*, const T*, const double*, const int*,
+                             const std::uint8_t*, const std::uint32_t*)>&
+        kernel,
+    int batch_size,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info)
+{
+  // Data structures used in assembly
+  std::vector<double> coordinate_dofs;
+  std::vector<T> w;
+  std::vector<std::uint32_t> info;
+  const int num_dofs0 = bs0 * dofmap0.links(0).size();
+  const int num_dofs1 = bs1 * dofmap1.links(0).size();
+  std::vector<std::int32_t> dofs0(num_dofs0), dofs1(num_dofs1);
+  std::vector<T> Ab(num_dofs0 * num_dofs1 * batch_size);
+  Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Ae(
+      num_dofs0, num_dofs1);
+
+  // Iterate over batches of active cells
+  const std::int32_t num_cells = active_cells.size();
+  for (std::int32_t c0 = 0; c0 < num_cells; c0 += batch_size)
+  {
+    const int n = std::min(batch_size, num_cells - c0);
+    impl::pack_cell_batch<T>(active_cells.data() + c0, n, batch_size,
+                             geometry, coeffs, cell_info, coordinate_dofs, w,
+                             info);
+
+    // Tabulate tensors
+    std::fill(Ab.begin(), Ab.end(), 0);
+    kernel(Ab.data(), w.data(), constants.data(), coordinate_dofs.data(),
+           nullptr, nullptr, info.data());
+
+    // Scatter element tensors
+    for (int l = 0; l < n; ++l)
     {
-      for (Eigen::Index j = 0; j < Ae.cols(); ++j)
-      {
-        if (bc1[dofs1[j]])
-          Ae.col(j).setZero();
-      }
-    }
+      for (Eigen::Index k = 0; k < Ae.size(); ++k)
+        Ae.data()[k] = Ab[k * batch_size + l];
+
+      // Zero rows/columns for essential bcs
+      const std::int32_t c = active_cells[c0 + l];
+      unroll_dofs(dofmap0.links(c), bs0, dofs0);
+      unroll_dofs(dofmap1.links(c), bs1, dofs1);
+      zero_bc_entries(Ae, bc0, bc1, dofs0.data(), dofs1.data(),
+                      has_bc(bc0, c), has_bc(bc1, c));
 
-    mat_set(dofs0.size(), dofs0.data(), dofs1.size(), dofs1.data(), Ae.data());
+      impl::insert_cell<T>(mat_set, c, dofs0.size(), dofs0.data(),
+                           dofs1.size(), dofs1.data(), Ae.data());
+    }
   }
 }
 //-----------------------------------------------------------------------------
-template <typename T>
+template <typename T, typename U, typename Kernel>
 void assemble_exterior_facets(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set_values,
-    const mesh::Mesh& mesh, const std::vector<std::int32_t>& active_facets,
+    const U& mat_set_values,
+    const mesh::Mesh& mesh, const std::vector<std::int32_t>& facets,
     const graph::AdjacencyList<std::int32_t>& dofmap0,
-    const graph::AdjacencyList<std::int32_t>& dofmap1,
-    const std::vector<bool>& bc0, const std::vector<bool>& bc1,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& kernel,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1,
+    const Kernel& kernel,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const Eigen::Array<T, Eigen::Dynamic, 1> constants,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
     const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms)
 {
-  const int gdim = mesh.geometry().dim();
-  const int tdim = mesh.topology().dim();
-
   // Prepare cell geometry
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
-
-  // FIXME: Add proper interface for num coordinate dofs
-  const int num_dofs_g = x_dofmap.num_links(0);
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
-      = mesh.geometry().x();
+  impl::CellCoordinates cell_coordinates(mesh.geometry());
 
   // Data structures used in assembly
-  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      coordinate_dofs(num_dofs_g, gdim);
-  const int num_dofs0 = dofmap0.links(0).size();
-  const int num_dofs1 = dofmap1.links(0).size();
-  Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Ae(
-      num_dofs0, num_dofs1);
+  const int num_dofs0 = bs0 * dofmap0.links(0).size();
+  const int num_dofs1 = bs1 * dofmap1.links(0).size();
+  std::vector<std::int32_t> dofs0(num_dofs0), dofs1(num_dofs1);
+  ElementTensor<T> Ae(num_dofs0, num_dofs1);
+  auto _Ae = Ae.matrix();
 
   // Iterate over all facets
-  auto f_to_c = mesh.topology().connectivity(tdim - 1, tdim);
-  assert(f_to_c);
-  auto c_to_f = mesh.topology().connectivity(tdim, tdim - 1);
-  assert(c_to_f);
-  for (std::int32_t f : active_facets)
+  for (std::size_t index = 0; index < facets.size(); index += 2)
   {
-    auto cells = f_to_c->links(f);
-    assert(cells.rows() == 1);
-
-    // Get local index of facet with respect to the cell
-    auto facets = c_to_f->links(cells[0]);
-    const auto* it = std::find(facets.data(), facets.data() + facets.rows(), f);
-    assert(it != (facets.data() + facets.rows()));
-    const int local_facet = std::distance(facets.data(), it);
+    // Get attached cell and local index of facet with respect to the
+    // cell
+    const std::int32_t cell = facets[index];
+    const int local_facet = facets[index + 1];
 
     // Get cell vertex coordinates
-    auto x_dofs = x_dofmap.links(cells[0]);
-    for (int i = 0; i < num_dofs_g; ++i)
-      for (int j = 0; j < gdim; ++j)
-        coordinate_dofs(i, j) = x_g(x_dofs[i], j);
+    const double* coordinate_dofs = cell_coordinates(cell);
 
     // Tabulate tensor
-    std::fill(Ae.data(), Ae.data() + num_dofs0 * num_dofs1, 0);
-    kernel(Ae.data(), coeffs.row(cells[0]).data(), constants.data(),
-           coordinate_dofs.data(), &local_facet, &perms(local_facet, cells[0]),
-           cell_info[cells[0]]);
+    Ae.set_zero();
+    kernel(Ae.data(), coeffs.row(cell).data(), constants.data(),
+           coordinate_dofs, &local_facet, &perms(local_facet, cell),
+           cell_info[cell]);
 
     // Zero rows/columns for essential bcs
-    auto dmap0 = dofmap0.links(cells[0]);
-    auto dmap1 = dofmap1.links(cells[0]);
-    if (!bc0.empty())
+    unroll_dofs(dofmap0.links(cell), bs0, dofs0);
+    unroll_dofs(dofmap1.links(cell), bs1, dofs1);
+    zero_bc_entries(_Ae, bc0, bc1, dofs0.data(), dofs1.data(),
+                    has_bc(bc0, cell), has_bc(bc1, cell));
+
+    mat_set_values(dofs0.size(), dofs0.data(), dofs1.size(), dofs1.data(),
+                   Ae.data());
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename U>
+void assemble_exterior_facets_batched(
+    const U& mat_set_values,
+    const mesh::Mesh& mesh, const std::vector<std::int32_t>& facets,
+    const graph::AdjacencyList<std::int32_t>& dofmap0,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1,
+    const std::function<void(T*, const T*, const T*, const double*, const int*,
+                             const std::uint8_t*, const std::uint32_t*)>&
+        kernel,
+    int batch_size,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
+    const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms)
+{
+  // Data structures used in assembly
+  std::vector<double> coordinate_dofs;
+  std::vector<T> w;
+  std::vector<std::uint32_t> info;
+  std::vector<std::int32_t> cells(batch_size);
+  std::vector<int> local_facets(batch_size);
+  std::vector<std::uint8_t> perm(batch_size);
+  const int num_dofs0 = bs0 * dofmap0.links(0).size();
+  const int num_dofs1 = bs1 * dofmap1.links(0).size();
+  std::vector<std::int32_t> dofs0(num_dofs0), dofs1(num_dofs1);
+  std::vector<T> Ab(num_dofs0 * num_dofs1 * batch_size);
+  Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Ae(
+      num_dofs0, num_dofs1);
+
+  // Iterate over batches of facets
+  const std::int32_t num_facets = facets.size() / 2;
+  for (std::int32_t f0 = 0; f0 < num_facets; f0 += batch_size)
+  {
+    const int n = std::min(batch_size, num_facets - f0);
+    for (int l = 0; l < batch_size; ++l)
     {
-      for (Eigen::Index i = 0; i < Ae.rows(); ++i)
-      {
-        if (bc0[dmap0[i]])
-          Ae.row(i).setZero();
-      }
+      // Unused lanes repeat the first facet of the batch
+      const std::int32_t f = f0 + (l < n ? l : 0);
+      cells[l] = facets[2 * f];
+      local_facets[l] = facets[2 * f + 1];
+      perm[l] = perms(local_facets[l], cells[l]);
     }
-    if (!bc1.empty())
+    impl::pack_cell_batch<T>(cells.data(), n, batch_size, mesh.geometry(),
+                             coeffs, cell_info, coordinate_dofs, w, info);
+
+    // Tabulate tensors
+    std::fill(Ab.begin(), Ab.end(), 0);
+    kernel(Ab.data(), w.data(), constants.data(), coordinate_dofs.data(),
+           local_facets.data(), perm.data(), info.data());
+
+    // Scatter element tensors
+    for (int l = 0; l < n; ++l)
     {
-      for (Eigen::Index j = 0; j < Ae.cols(); ++j)
-      {
-        if (bc1[dmap1[j]])
-          Ae.col(j).setZero();
-      }
-    }
+      for (Eigen::Index k = 0; k < Ae.size(); ++k)
+        Ae.data()[k] = Ab[k * batch_size + l];
 
-    mat_set_values(dmap0.size(), dmap0.data(), dmap1.size(), dmap1.data(),
-                   Ae.data());
+      // Zero rows/columns for essential bcs
+      unroll_dofs(dofmap0.links(cells[l]), bs0, dofs0);
+      unroll_dofs(dofmap1.links(cells[l]), bs1, dofs1);
+      zero_bc_entries(Ae, bc0, bc1, dofs0.data(), dofs1.data(),
+                      has_bc(bc0, cells[l]), has_bc(bc1, cells[l]));
+
+      mat_set_values(dofs0.size(), dofs0.data(), dofs1.size(), dofs1.data(),
+                     Ae.data());
+    }
   }
 }
 //-----------------------------------------------------------------------------
-template <typename T>
+template <typename T, typename U, typename Kernel>
 void assemble_interior_facets(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_set_values,
-    const mesh::Mesh& mesh, const std::vector<std::int32_t>& active_facets,
-    const DofMap& dofmap0, const DofMap& dofmap1, const std::vector<bool>& bc0,
-    const std::vector<bool>& bc1,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& fn,
+    const U& mat_set_values,
+    const mesh::Mesh& mesh,
+    const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+        facets,
+    const DofMap& dofmap0, const DofMap& dofmap1, const BCMarkers& bc0,
+    const BCMarkers& bc1,
+    const Kernel& fn,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const std::vector<int>& offsets,
@@ -354,77 +865,60 @@ void assemble_interior_facets(
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
     const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms)
 {
-  const int gdim = mesh.geometry().dim();
-  const int tdim = mesh.topology().dim();
-
   // Prepare cell geometry
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
-
-  // FIXME: Add proper interface for num coordinate dofs
-  const int num_dofs_g = x_dofmap.num_links(0);
-
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
-      = mesh.geometry().x();
+  impl::CellCoordinates cell_coordinates(mesh.geometry());
+  const int num_dofs_g = cell_coordinates.num_dofs();
+  const int gdim = cell_coordinates.dim();
 
   // Data structures used in assembly
-  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      coordinate_dofs(2 * num_dofs_g, gdim);
-  Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Ae;
+  common::aligned_vector<double> coordinate_dofs(
+      common::padded_size<double>(2 * num_dofs_g * gdim), 0);
+  ElementTensor<T> Ae;
   Eigen::Array<T, Eigen::Dynamic, 1> coeff_array(2 * offsets.back());
   assert(offsets.back() == coeffs.cols());
 
   // Temporaries for joint dofmaps
   Eigen::Array<std::int32_t, Eigen::Dynamic, 1> dmapjoint0, dmapjoint1;
+  const int bs0 = dofmap0.bs();
+  const int bs1 = dofmap1.bs();
 
   // Iterate over all facets
-  auto c = mesh.topology().connectivity(tdim - 1, tdim);
-  assert(c);
-  auto c_to_f = mesh.topology().connectivity(tdim, tdim - 1);
-  assert(c_to_f);
-  for (std::int32_t facet_index : active_facets)
+  for (Eigen::Index index = 0; index < facets.size(); index += 4)
   {
-    // Create attached cells
-    auto cells = c->links(facet_index);
-    assert(cells.rows() == 2);
-
-    // Get local index of facet with respect to the cell
-    auto facets0 = c_to_f->links(cells[0]);
-    const auto* it0 = std::find(facets0.data(), facets0.data() + facets0.rows(),
-                                facet_index);
-    assert(it0 != (facets0.data() + facets0.rows()));
-    const int local_facet0 = std::distance(facets0.data(), it0);
-    auto facets1 = c_to_f->links(cells[1]);
-    const auto* it1 = std::find(facets1.data(), facets1.data() + facets1.rows(),
-                                facet_index);
-    assert(it1 != (facets1.data() + facets1.rows()));
-    const int local_facet1 = std::distance(facets1.data(), it1);
-
-    const std::array local_facet{local_facet0, local_facet1};
+    // Get attached cells and local index of facet with respect to each
+    // cell
+    const std::array cells{facets[index], facets[index + 2]};
+    const std::array<int, 2> local_facet{facets[index + 1],
+                                         facets[index + 3]};
 
     // Get cell geometry
-    auto x_dofs0 = x_dofmap.links(cells[0]);
-    auto x_dofs1 = x_dofmap.links(cells[1]);
-    for (int i = 0; i < num_dofs_g; ++i)
-    {
-      for (int j = 0; j < gdim; ++j)
-      {
-        coordinate_dofs(i, j) = x_g(x_dofs0[i], j);
-        coordinate_dofs(i + num_dofs_g, j) = x_g(x_dofs1[i], j);
-      }
-    }
+    std::copy_n(cell_coordinates(cells[0]), num_dofs_g * gdim,
+                coordinate_dofs.data());
+    std::copy_n(cell_coordinates(cells[1]), num_dofs_g * gdim,
+                coordinate_dofs.data() + num_dofs_g * gdim);
 
-    // Get dof maps for cells and pack
-    auto dmap0_cell0 = dofmap0.cell_dofs(cells[0]);
-    auto dmap0_cell1 = dofmap0.cell_dofs(cells[1]);
-    dmapjoint0.resize(dmap0_cell0.size() + dmap0_cell1.size());
-    dmapjoint0.head(dmap0_cell0.size()) = dmap0_cell0;
-    dmapjoint0.tail(dmap0_cell1.size()) = dmap0_cell1;
+    // Get dof maps (blocks) for cells and pack unrolled
+    auto dmap0_cell0 = dofmap0.list_blocked().links(cells[0]);
+    auto dmap0_cell1 = dofmap0.list_blocked().links(cells[1]);
+    dmapjoint0.resize(bs0 * (dmap0_cell0.size() + dmap0_cell1.size()));
+    for (Eigen::Index i = 0; i < dmap0_cell0.size(); ++i)
+      for (int k = 0; k < bs0; ++k)
+        dmapjoint0[bs0 * i + k] = bs0 * dmap0_cell0[i] + k;
+    for (Eigen::Index i = 0; i < dmap0_cell1.size(); ++i)
+      for (int k = 0; k < bs0; ++k)
+        dmapjoint0[bs0 * (i + dmap0_cell0.size()) + k]
+            = bs0 * dmap0_cell1[i] + k;
 
-    auto dmap1_cell0 = dofmap1.cell_dofs(cells[0]);
-    auto dmap1_cell1 = dofmap1.cell_dofs(cells[1]);
-    dmapjoint1.resize(dmap1_cell0.size() + dmap1_cell1.size());
-    dmapjoint1.head(dmap1_cell0.size()) = dmap1_cell0;
-    dmapjoint1.tail(dmap1_cell1.size()) = dmap1_cell1;
+    auto dmap1_cell0 = dofmap1.list_blocked().links(cells[0]);
+    auto dmap1_cell1 = dofmap1.list_blocked().links(cells[1]);
+    dmapjoint1.resize(bs1 * (dmap1_cell0.size() + dmap1_cell1.size()));
+    for (Eigen::Index i = 0; i < dmap1_cell0.size(); ++i)
+      for (int k = 0; k < bs1; ++k)
+        dmapjoint1[bs1 * i + k] = bs1 * dmap1_cell0[i] + k;
+    for (Eigen::Index i = 0; i < dmap1_cell1.size(); ++i)
+      for (int k = 0; k < bs1; ++k)
+        dmapjoint1[bs1 * (i + dmap1_cell0.size()) + k]
+            = bs1 * dmap1_cell1[i] + k;
 
     // Layout for the restricted coefficients is flattened
     // w[coefficient][restriction][dof]
@@ -443,33 +937,131 @@ void assemble_interior_facets(
     }
 
     // Tabulate tensor
-    Ae.setZero(dmapjoint0.size(), dmapjoint1.size());
+    Ae.set_zero(dmapjoint0.size(), dmapjoint1.size());
     const std::array perm{perms(local_facet[0], cells[0]),
                           perms(local_facet[1], cells[1])};
     fn(Ae.data(), coeff_array.data(), constants.data(), coordinate_dofs.data(),
        local_facet.data(), perm.data(), cell_info[cells[0]]);
 
     // Zero rows/columns for essential bcs
-    if (!bc0.empty())
+    auto _Ae = Ae.matrix();
+    zero_bc_entries(_Ae, bc0, bc1, dmapjoint0.data(), dmapjoint1.data(),
+                    has_bc(bc0, cells[0]) or has_bc(bc0, cells[1]),
+                    has_bc(bc1, cells[0]) or has_bc(bc1, cells[1]));
+
+    mat_set_values(dmapjoint0.size(), dmapjoint0.data(), dmapjoint1.size(),
+                   dmapjoint1.data(), Ae.data());
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename U, typename Kernel>
+void assemble_interior_facets_threaded(
+    const U& mat_set_values,
+    const mesh::Mesh& mesh,
+    const graph::AdjacencyList<std::int32_t>& colouring, int num_threads,
+    const DofMap& dofmap0, const DofMap& dofmap1, const BCMarkers& bc0,
+    const BCMarkers& bc1,
+    const Kernel& kernel,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const std::vector<int>& offsets,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
+    const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms)
+{
+  // Build the geometry cell coordinate cache (if enabled) before
+  // threads access it
+  mesh.geometry().cell_coordinates();
+
+  std::mutex mutex;
+  auto mat_set_serial
+      = [&mutex, &mat_set_values](std::int32_t m, const std::int32_t* rows,
+                                  std::int32_t n, const std::int32_t* cols,
+                                  const T* vals) {
+          std::lock_guard<std::mutex> lock(mutex);
+          return mat_set_values(m, rows, n, cols, vals);
+        };
+
+  // The links of a colour hold four values per facet
+  for (std::int32_t colour = 0; colour < colouring.num_nodes(); ++colour)
+  {
+    auto facets = colouring.links(colour);
+    common::parallel_for(
+        num_threads, facets.rows() / 4,
+        [&](int, std::int32_t f0, std::int32_t f1) {
+          impl::assemble_interior_facets<T>(
+              mat_set_serial, mesh, facets.segment(4 * f0, 4 * (f1 - f0)),
+              dofmap0, dofmap1, bc0, bc1, kernel, coeffs, offsets, constants,
+              cell_info, perms);
+        });
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void assemble_action(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> y, const Form<T>& a,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x,
+    const BCMarkers& bc0, const BCMarkers& bc1)
+{
+  // Multiply each element matrix with the local entries of x instead of
+  // inserting it into a matrix
+  auto action = [&y, &x](std::int32_t m, const std::int32_t* rows,
+                         std::int32_t n, const std::int32_t* cols,
+                         const T* vals) {
+    for (std::int32_t i = 0; i < m; ++i)
     {
-      for (Eigen::Index i = 0; i < dmapjoint0.size(); ++i)
-      {
-        if (bc0[dmapjoint0[i]])
-          Ae.row(i).setZero();
-      }
+      T yi = 0;
+      for (std::int32_t j = 0; j < n; ++j)
+        yi += vals[i * n + j] * x[cols[j]];
+      y[rows[i]] += yi;
     }
-    if (!bc1.empty())
+    return 0;
+  };
+  impl::assemble_matrix<T>(action, a, bc0, bc1);
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void assemble_diagonal(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> d,
+                       const Form<T>& a, const BCMarkers& bc0,
+                       const BCMarkers& bc1)
+{
+  // Keep only the element matrix entries that are on the diagonal of
+  // the global matrix
+  auto diagonal = [&d](std::int32_t m, const std::int32_t* rows,
+                       std::int32_t n, const std::int32_t* cols,
+                       const T* vals) {
+    for (std::int32_t i = 0; i < m; ++i)
     {
-      for (Eigen::Index j = 0; j < dmapjoint1.size(); ++j)
+      for (std::int32_t j = 0; j < n; ++j)
       {
-        if (bc1[dmapjoint1[j]])
-          Ae.col(j).setZero();
+        if (rows[i] == cols[j])
+          d[rows[i]] += vals[i * n + j];
       }
     }
-
-    mat_set_values(dmapjoint0.size(), dmapjoint0.data(), dmapjoint1.size(),
-                   dmapjoint1.data(), Ae.data());
-  }
+    return 0;
+  };
+  impl::assemble_matrix<T>(diagonal, a, bc0, bc1);
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void assemble_lumped(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> d,
+                     const Form<T>& a, const BCMarkers& bc0,
+                     const BCMarkers& bc1)
+{
+  // Sum the rows of each element matrix instead of inserting it into a
+  // matrix
+  auto lumped = [&d](std::int32_t m, const std::int32_t* rows,
+                     std::int32_t n, const std::int32_t*, const T* vals) {
+    for (std::int32_t i = 0; i < m; ++i)
+    {
+      T di = 0;
+      for (std::int32_t j = 0; j < n; ++j)
+        di += vals[i * n + j];
+      d[rows[i]] += di;
+    }
+    return 0;
+  };
+  impl::assemble_matrix<T>(lumped, a, bc0, bc1);
 }
 //-----------------------------------------------------------------------------
 
@@ -9,7 +9,9 @@
 #include "Form.h"
 #include "utils.h"
 #include <Eigen/Dense>
+#include <algorithm>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/ThreadPool.h>
 #include <dolfinx/common/types.h>
 #include <dolfinx/function/Constant.h>
 #include <dolfinx/function/FunctionSpace.h>
@@ -17,45 +19,69 @@
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/Topology.h>
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace dolfinx::fem::impl
 {
 
 /// Assemble functional into an scalar
+/// @tparam Sum The type of the sum of the contributions of the cells
+///   and facets, e.g. T or common::ExactSum<T>
+template <typename T, typename Sum = T>
+Sum assemble_scalar(const fem::Form<T>& M);
+
+/// Assemble functional into an scalar using packed coefficients
+/// (see pack_coefficients)
+/// @tparam Sum The type of the sum of the contributions of the cells
+///   and facets, e.g. T or common::ExactSum<T>
+template <typename T, typename Sum = T>
+Sum assemble_scalar(
+    const fem::Form<T>& M,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs);
+
+/// Assemble several functionals into scalars. Integrals of the
+/// functionals over the same mesh and the same cells or exterior facets
+/// are evaluated in a single loop over the domain, in which the
+/// coordinates of each cell are accessed once.
+/// @param[in] M The forms (functionals) to assemble
+/// @return The contributions of the local process to the functionals
 template <typename T>
-T assemble_scalar(const fem::Form<T>& M);
+std::vector<T> assemble_scalars(const std::vector<const fem::Form<T>*>& M);
 
 /// Assemble functional over cells
-template <typename T>
-T assemble_cells(
+template <typename T, typename Sum = T, typename Kernel>
+Sum assemble_cells(
     const mesh::Geometry& geometry,
-    const std::vector<std::int32_t>& active_cells,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& fn,
+    const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+        active_cells,
+    const Kernel& fn,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const std::vector<T>& constant_values,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info);
 
-/// Execute kernel over exterior facets and accumulate result
-template <typename T>
-T assemble_exterior_facets(
-    const mesh::Mesh& mesh, const std::vector<std::int32_t>& active_cells,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& fn,
+/// Execute kernel over exterior facets and accumulate result. The
+/// facets are given by their attached cell and local facet index (see
+/// FormIntegrals::facet_domains).
+template <typename T, typename Sum = T, typename Kernel>
+Sum assemble_exterior_facets(
+    const mesh::Mesh& mesh, const std::vector<std::int32_t>& facets,
+    const Kernel& fn,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const std::vector<T>& constant_values,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
     const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms);
 
-/// Assemble functional over interior facets
-template <typename T>
-T assemble_interior_facets(
-    const mesh::Mesh& mesh, const std::vector<std::int32_t>& active_cells,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& fn,
+/// Assemble functional over interior facets. The facets are given by
+/// their attached cells and local facet indices (see
+/// FormIntegrals::facet_domains).
+template <typename T, typename Sum = T, typename Kernel>
+Sum assemble_interior_facets(
+    const mesh::Mesh& mesh, const std::vector<std::int32_t>& facets,
+    const Kernel& fn,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const std::vector<int>& offsets, const std::vector<T>& constant_values,
@@ -63,8 +89,32 @@ T assemble_interior_facets(
     const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms);
 
 //-----------------------------------------------------------------------------
-template <typename T>
-T assemble_scalar(const fem::Form<T>& M)
+/// Execute the kernel of a functional for one cell or facet and add the
+/// result to a sum. Plain sums are accumulated in place by the kernel.
+template <typename T, typename Sum, typename Kernel, typename... Args>
+void add_kernel(Sum& value, const Kernel& fn, const Args&... args)
+{
+  if constexpr (std::is_same_v<Sum, T>)
+    fn(&value, args...);
+  else
+  {
+    T v(0);
+    fn(&v, args...);
+    value += v;
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename Sum>
+Sum assemble_scalar(const fem::Form<T>& M)
+{
+  return impl::assemble_scalar<T, Sum>(M, pack_coefficients(M));
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename Sum>
+Sum assemble_scalar(
+    const fem::Form<T>& M,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs)
 {
   std::shared_ptr<const mesh::Mesh> mesh = M.mesh();
   assert(mesh);
@@ -86,27 +136,49 @@ T assemble_scalar(const fem::Form<T>& M)
                            array.data() + array.size());
   }
 
-  // Prepare coefficients
-  const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> coeffs
-      = pack_coefficients(M);
-
   const FormIntegrals<T>& integrals = M.integrals();
   const bool needs_permutation_data = integrals.needs_permutation_data();
   if (needs_permutation_data)
-    mesh->topology_mutable().create_entity_permutations();
+    mesh->topology_mutable().create_cell_permutation_info();
   const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info
       = needs_permutation_data
             ? mesh->topology().get_cell_permutation_info()
             : Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>(num_cells);
 
-  T value(0);
+  Sum value{};
   for (int i = 0; i < integrals.num_integrals(IntegralType::cell); ++i)
   {
-    const auto& fn = integrals.get_tabulate_tensor(IntegralType::cell, i);
     const std::vector<std::int32_t>& active_cells
         = integrals.integral_domains(IntegralType::cell, i);
-    value += fem::impl::assemble_cells(mesh->geometry(), active_cells, fn,
-                                       coeffs, constant_values, cell_info);
+    const Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>
+        cells(active_cells.data(), active_cells.size());
+    impl::dispatch_kernel(
+        integrals, IntegralType::cell, i, [&](const auto& fn) {
+          if (M.num_threads() > 1)
+          {
+            // Each thread accumulates into its own value, and the
+            // values are summed in the order of the chunks. The
+            // geometry cell coordinate cache (if enabled) is built
+            // before threads access it.
+            std::vector<Sum> values(M.num_threads(), Sum{});
+            mesh->geometry().cell_coordinates();
+            common::parallel_for(
+                M.num_threads(), cells.rows(),
+                [&](int thread, std::int32_t c0, std::int32_t c1) {
+                  values[thread] = fem::impl::assemble_cells<T, Sum>(
+                      mesh->geometry(), cells.segment(c0, c1 - c0), fn,
+                      coeffs, constant_values, cell_info);
+                });
+            for (const Sum& v : values)
+              value += v;
+          }
+          else
+          {
+            value += fem::impl::assemble_cells<T, Sum>(
+                mesh->geometry(), cells, fn, coeffs, constant_values,
+                cell_info);
+          }
+        });
   }
 
   if (integrals.num_integrals(IntegralType::exterior_facet) > 0
@@ -115,6 +187,8 @@ T assemble_scalar(const fem::Form<T>& M)
     // FIXME: cleanup these calls? Some of these happen internally again.
     mesh->topology_mutable().create_entities(tdim - 1);
     mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
+    if (needs_permutation_data)
+      mesh->topology_mutable().create_facet_permutations();
 
     const int facets_per_cell
         = mesh::cell_num_entities(mesh->topology().cell_type(), tdim - 1);
@@ -127,25 +201,27 @@ T assemble_scalar(const fem::Form<T>& M)
     for (int i = 0; i < integrals.num_integrals(IntegralType::exterior_facet);
          ++i)
     {
-      const auto& fn
-          = integrals.get_tabulate_tensor(IntegralType::exterior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = integrals.integral_domains(IntegralType::exterior_facet, i);
-      value += fem::impl::assemble_exterior_facets(
-          *mesh, active_facets, fn, coeffs, constant_values, cell_info, perms);
+      const std::vector<std::int32_t>& facets
+          = integrals.facet_domains(IntegralType::exterior_facet, i);
+      impl::dispatch_kernel(
+          integrals, IntegralType::exterior_facet, i, [&](const auto& fn) {
+            value += fem::impl::assemble_exterior_facets<T, Sum>(
+                *mesh, facets, fn, coeffs, constant_values, cell_info, perms);
+          });
     }
 
     const std::vector<int> c_offsets = M.coefficients().offsets();
     for (int i = 0; i < integrals.num_integrals(IntegralType::interior_facet);
          ++i)
     {
-      const auto& fn
-          = integrals.get_tabulate_tensor(IntegralType::interior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = integrals.integral_domains(IntegralType::interior_facet, i);
-      value += fem::impl::assemble_interior_facets(
-          *mesh, active_facets, fn, coeffs, c_offsets, constant_values,
-          cell_info, perms);
+      const std::vector<std::int32_t>& facets
+          = integrals.facet_domains(IntegralType::interior_facet, i);
+      impl::dispatch_kernel(
+          integrals, IntegralType::interior_facet, i, [&](const auto& fn) {
+            value += fem::impl::assemble_interior_facets<T, Sum>(
+                *mesh, facets, fn, coeffs, c_offsets, constant_values,
+                cell_info, perms);
+          });
     }
   }
 
@@ -153,171 +229,255 @@ T assemble_scalar(const fem::Form<T>& M)
 }
 //-----------------------------------------------------------------------------
 template <typename T>
-T assemble_cells(
+std::vector<T> assemble_scalars(const std::vector<const fem::Form<T>*>& M)
+{
+  // Packed data of each form
+  std::vector<const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic,
+                                 Eigen::RowMajor>*>
+      coeffs(M.size());
+  std::vector<std::vector<T>> constant_values(M.size());
+  std::vector<Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>> cell_info(
+      M.size());
+  std::vector<Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>>
+      perms(M.size());
+
+  // Group the cell and exterior facet integrals of all forms by mesh
+  // and domain. Each group holds its (form, integral) indices.
+  struct Group
+  {
+    const mesh::Mesh* mesh;
+    const std::vector<std::int32_t>* domain;
+    std::vector<std::array<int, 2>> integrals;
+  };
+  std::vector<Group> cell_groups, facet_groups;
+  auto add_to_group = [](std::vector<Group>& groups, const mesh::Mesh* mesh,
+                         const std::vector<std::int32_t>& domain, int k,
+                         int i) {
+    auto it = std::find_if(groups.begin(), groups.end(), [&](auto& g) {
+      return g.mesh == mesh and *g.domain == domain;
+    });
+    if (it == groups.end())
+      groups.push_back({mesh, &domain, {{k, i}}});
+    else
+      it->integrals.push_back({k, i});
+  };
+
+  std::vector<T> values(M.size(), 0);
+  for (std::size_t k = 0; k < M.size(); ++k)
+  {
+    assert(M[k]);
+    std::shared_ptr<const mesh::Mesh> mesh = M[k]->mesh();
+    assert(mesh);
+    const int tdim = mesh->topology().dim();
+    const std::int32_t num_cells
+        = mesh->topology().connectivity(tdim, 0)->num_nodes();
+
+    // Prepare constants
+    if (!M[k]->all_constants_set())
+      throw std::runtime_error("Unset constant in Form");
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants
+        = pack_constants(*M[k]);
+    constant_values[k].assign(constants.data(),
+                              constants.data() + constants.size());
+    coeffs[k] = &pack_coefficients(*M[k]);
+
+    const FormIntegrals<T>& integrals = M[k]->integrals();
+    const bool needs_permutation_data = integrals.needs_permutation_data();
+    if (needs_permutation_data)
+      mesh->topology_mutable().create_cell_permutation_info();
+    cell_info[k] = needs_permutation_data
+                       ? mesh->topology().get_cell_permutation_info()
+                       : Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>(
+                           num_cells);
+
+    for (int i = 0; i < integrals.num_integrals(IntegralType::cell); ++i)
+    {
+      add_to_group(cell_groups, mesh.get(),
+                   integrals.integral_domains(IntegralType::cell, i), k, i);
+    }
+
+    if (integrals.num_integrals(IntegralType::exterior_facet) > 0
+        or integrals.num_integrals(IntegralType::interior_facet) > 0)
+    {
+      mesh->topology_mutable().create_entities(tdim - 1);
+      mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
+      if (needs_permutation_data)
+        mesh->topology_mutable().create_facet_permutations();
+
+      const int facets_per_cell
+          = mesh::cell_num_entities(mesh->topology().cell_type(), tdim - 1);
+      perms[k] = needs_permutation_data
+                     ? mesh->topology().get_facet_permutations()
+                     : Eigen::Array<std::uint8_t, Eigen::Dynamic,
+                                    Eigen::Dynamic>(facets_per_cell,
+                                                    num_cells);
+    }
+
+    for (int i = 0; i < integrals.num_integrals(IntegralType::exterior_facet);
+         ++i)
+    {
+      add_to_group(facet_groups, mesh.get(),
+                   integrals.facet_domains(IntegralType::exterior_facet, i),
+                   k, i);
+    }
+
+    // Interior facet integrals are assembled per form
+    const std::vector<int> c_offsets = M[k]->coefficients().offsets();
+    for (int i = 0; i < integrals.num_integrals(IntegralType::interior_facet);
+         ++i)
+    {
+      const std::vector<std::int32_t>& facets
+          = integrals.facet_domains(IntegralType::interior_facet, i);
+      impl::dispatch_kernel(
+          integrals, IntegralType::interior_facet, i, [&](const auto& fn) {
+            values[k] += fem::impl::assemble_interior_facets<T>(
+                *mesh, facets, fn, *coeffs[k], c_offsets, constant_values[k],
+                cell_info[k], perms[k]);
+          });
+    }
+  }
+
+  // Iterate over the cells of each group
+  for (const Group& group : cell_groups)
+  {
+    impl::CellCoordinates cell_coordinates(group.mesh->geometry());
+    for (std::int32_t c : *group.domain)
+    {
+      const double* coordinate_dofs = cell_coordinates(c);
+      for (auto [k, i] : group.integrals)
+      {
+        const auto& fn
+            = M[k]->integrals().get_tabulate_tensor(IntegralType::cell, i);
+        fn(&values[k], coeffs[k]->row(c).data(), constant_values[k].data(),
+           coordinate_dofs, nullptr, nullptr, cell_info[k][c]);
+      }
+    }
+  }
+
+  // Iterate over the exterior facets of each group
+  for (const Group& group : facet_groups)
+  {
+    impl::CellCoordinates cell_coordinates(group.mesh->geometry());
+    const std::vector<std::int32_t>& facets = *group.domain;
+    for (std::size_t index = 0; index < facets.size(); index += 2)
+    {
+      const std::int32_t cell = facets[index];
+      const int local_facet = facets[index + 1];
+      const double* coordinate_dofs = cell_coordinates(cell);
+      for (auto [k, i] : group.integrals)
+      {
+        const auto& fn = M[k]->integrals().get_tabulate_tensor(
+            IntegralType::exterior_facet, i);
+        fn(&values[k], coeffs[k]->row(cell).data(),
+           constant_values[k].data(), coordinate_dofs, &local_facet,
+           &perms[k](local_facet, cell), cell_info[k][cell]);
+      }
+    }
+  }
+
+  return values;
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename Sum, typename Kernel>
+Sum assemble_cells(
     const mesh::Geometry& geometry,
-    const std::vector<std::int32_t>& active_cells,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& fn,
+    const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+        active_cells,
+    const Kernel& fn,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const std::vector<T>& constant_values,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info)
 {
-  const int gdim = geometry.dim();
-
   // Prepare cell geometry
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
-
-  // FIXME: Add proper interface for num coordinate dofs
-  const int num_dofs_g = x_dofmap.num_links(0);
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
-      = geometry.x();
-
-  // Create data structures used in assembly
-  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      coordinate_dofs(num_dofs_g, gdim);
+  impl::CellCoordinates cell_coordinates(geometry);
 
   // Iterate over all cells
-  T value(0);
-  for (std::int32_t c : active_cells)
+  Sum value{};
+  for (Eigen::Index index = 0; index < active_cells.rows(); ++index)
   {
+    const std::int32_t c = active_cells[index];
+
     // Get cell coordinates/geometry
-    auto x_dofs = x_dofmap.links(c);
-    for (int i = 0; i < num_dofs_g; ++i)
-      for (int j = 0; j < gdim; ++j)
-        coordinate_dofs(i, j) = x_g(x_dofs[i], j);
+    const double* coordinate_dofs = cell_coordinates(c);
 
     auto coeff_cell = coeffs.row(c);
-    fn(&value, coeff_cell.data(), constant_values.data(),
-       coordinate_dofs.data(), nullptr, nullptr, cell_info[c]);
+    add_kernel<T>(value, fn, coeff_cell.data(), constant_values.data(),
+                  coordinate_dofs, nullptr, nullptr, cell_info[c]);
   }
 
   return value;
 }
 //-----------------------------------------------------------------------------
-template <typename T>
-T assemble_exterior_facets(
-    const mesh::Mesh& mesh, const std::vector<std::int32_t>& active_facets,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& fn,
+template <typename T, typename Sum, typename Kernel>
+Sum assemble_exterior_facets(
+    const mesh::Mesh& mesh, const std::vector<std::int32_t>& facets,
+    const Kernel& fn,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const std::vector<T>& constant_values,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
     const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms)
 {
-  const int gdim = mesh.geometry().dim();
-  const int tdim = mesh.topology().dim();
-
   // Prepare cell geometry
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
-
-  // FIXME: Add proper interface for num coordinate dofs
-  const int num_dofs_g = x_dofmap.num_links(0);
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
-      = mesh.geometry().x();
-
-  // Creat data structures used in assembly
-  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      coordinate_dofs(num_dofs_g, gdim);
-
-  auto f_to_c = mesh.topology().connectivity(tdim - 1, tdim);
-  assert(f_to_c);
-  auto c_to_f = mesh.topology().connectivity(tdim, tdim - 1);
-  assert(c_to_f);
+  impl::CellCoordinates cell_coordinates(mesh.geometry());
 
   // Iterate over all facets
-  T value(0);
-  for (std::int32_t facet : active_facets)
+  Sum value{};
+  for (std::size_t index = 0; index < facets.size(); index += 2)
   {
-    // Create attached cell
-    assert(f_to_c->num_links(facet) == 1);
-    const int cell = f_to_c->links(facet)[0];
-
-    // Get local index of facet with respect to the cell
-    auto facets = c_to_f->links(cell);
-    const auto* it
-        = std::find(facets.data(), facets.data() + facets.rows(), facet);
-    assert(it != (facets.data() + facets.rows()));
-    const int local_facet = std::distance(facets.data(), it);
-
-    auto x_dofs = x_dofmap.links(cell);
-    for (int i = 0; i < num_dofs_g; ++i)
-      for (int j = 0; j < gdim; ++j)
-        coordinate_dofs(i, j) = x_g(x_dofs[i], j);
+    // Get attached cell and local index of facet with respect to the
+    // cell
+    const std::int32_t cell = facets[index];
+    const int local_facet = facets[index + 1];
+
+    const double* coordinate_dofs = cell_coordinates(cell);
 
     auto coeff_cell = coeffs.row(cell);
-    fn(&value, coeff_cell.data(), constant_values.data(),
-       coordinate_dofs.data(), &local_facet, &perms(local_facet, cell),
-       cell_info[cell]);
+    add_kernel<T>(value, fn, coeff_cell.data(), constant_values.data(),
+                  coordinate_dofs, &local_facet, &perms(local_facet, cell),
+                  cell_info[cell]);
   }
 
   return value;
 }
 //-----------------------------------------------------------------------------
-template <typename T>
-T assemble_interior_facets(
-    const mesh::Mesh& mesh, const std::vector<std::int32_t>& active_facets,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& fn,
+template <typename T, typename Sum, typename Kernel>
+Sum assemble_interior_facets(
+    const mesh::Mesh& mesh, const std::vector<std::int32_t>& facets,
+    const Kernel& fn,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const std::vector<int>& offsets, const std::vector<T>& constant_values,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
     const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms)
 {
-  const int gdim = mesh.geometry().dim();
-  const int tdim = mesh.topology().dim();
-
   // Prepare cell geometry
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
-
-  // FIXME: Add proper interface for num coordinate dofs
-  const int num_dofs_g = x_dofmap.num_links(0);
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
-      = mesh.geometry().x();
+  impl::CellCoordinates cell_coordinates(mesh.geometry());
+  const int num_dofs_g = cell_coordinates.num_dofs();
+  const int gdim = cell_coordinates.dim();
 
-  // Creat data structures used in assembly
+  // Create data structures used in assembly
   Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
       coordinate_dofs(2 * num_dofs_g, gdim);
   Eigen::Array<T, Eigen::Dynamic, 1> coeff_array(2 * offsets.back());
   assert(offsets.back() == coeffs.cols());
 
-  auto f_to_c = mesh.topology().connectivity(tdim - 1, tdim);
-  assert(f_to_c);
-  auto c_to_f = mesh.topology().connectivity(tdim, tdim - 1);
-  assert(c_to_f);
-
   // Iterate over all facets
-  T value(0);
-  for (std::int32_t f : active_facets)
+  Sum value{};
+  for (std::size_t index = 0; index < facets.size(); index += 4)
   {
-    // Create attached cell
-    auto cells = f_to_c->links(f);
-    assert(cells.rows() == 2);
-
-    // Get local index of facet with respect to the cell
-    std::array<int, 2> local_facet;
-    for (int i = 0; i < 2; ++i)
-    {
-      auto facets = c_to_f->links(cells[i]);
-      const auto* it
-          = std::find(facets.data(), facets.data() + facets.rows(), f);
-      assert(it != (facets.data() + facets.rows()));
-      local_facet[i] = std::distance(facets.data(), it);
-    }
+    // Get attached cells and local index of facet with respect to each
+    // cell
+    const std::array cells{facets[index], facets[index + 2]};
+    const std::array<int, 2> local_facet{facets[index + 1],
+                                         facets[index + 3]};
 
     // Get cell geometry
-    auto x_dofs0 = x_dofmap.links(cells[0]);
-    auto x_dofs1 = x_dofmap.links(cells[1]);
-    for (int i = 0; i < num_dofs_g; ++i)
-    {
-      for (int j = 0; j < gdim; ++j)
-      {
-        coordinate_dofs(i, j) = x_g(x_dofs0[i], j);
-        coordinate_dofs(i + num_dofs_g, j) = x_g(x_dofs1[i], j);
-      }
-    }
+    std::copy_n(cell_coordinates(cells[0]), num_dofs_g * gdim,
+                coordinate_dofs.data());
+    std::copy_n(cell_coordinates(cells[1]), num_dofs_g * gdim,
+                coordinate_dofs.data() + num_dofs_g * gdim);
 
     // Layout for the restricted coefficients is flattened
     // w[coefficient][restriction][dof]
@@ -337,9 +497,9 @@ T assemble_interior_facets(
 
     const std::array perm{perms(local_facet[0], cells[0]),
                           perms(local_facet[1], cells[1])};
-    fn(&value, coeff_array.data(), constant_values.data(),
-       coordinate_dofs.data(), local_facet.data(), perm.data(),
-       cell_info[cells[0]]);
+    add_kernel<T>(value, fn, coeff_array.data(), constant_values.data(),
+                  coordinate_dofs.data(), local_facet.data(), perm.data(),
+                  cell_info[cells[0]]);
   }
 
   return value;
@@ -0,0 +1,264 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "DofMap.h"
+#include "Form.h"
+#include "assemble_matrix_impl.h"
+#include "assemble_vector_impl.h"
+#include "utils.h"
+#include <Eigen/Dense>
+#include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace dolfinx::fem::impl
+{
+
+/// Assemble a bilinear and a linear form with the same test space into
+/// a matrix and a vector, with lifting of the boundary conditions on
+/// the trial space, i.e.
+///
+///   b <- b + L - scale * A (g - x0)
+///
+/// where g holds the boundary condition values. The cell integrals of
+/// a and L with the same integral ID are assembled in a single loop
+/// over the cells, in which the geometry of each cell is gathered once
+/// and the bilinear form kernel is used for both the matrix and the
+/// lifting. Facet integrals are assembled in separate loops. Rows
+/// (bc0) and columns (bc1) of the matrix with Dirichlet conditions are
+/// zeroed, and the lifting is only applied for the columns marked by
+/// bc1. The diagonal of the matrix is not set, and the boundary
+/// condition rows of the vector are not set.
+/// @param[in] mat_set_values The matrix inserter, see assemble_matrix
+/// @param[in,out] b The vector (owned and ghost entries). It is not
+///   zeroed, and ghost contributions are not sent to the owner.
+/// @param[in] a The bilinear form
+/// @param[in] L The linear form
+/// @param[in] bc0 The row boundary condition markers
+/// @param[in] bc1 The column boundary condition markers
+/// @param[in] bc_values1 The boundary condition values for the dofs of
+///   the trial space. Only the entries marked by bc1 are used.
+/// @param[in] x0 The vector used in the lifting. If empty, it is
+///   treated as zero.
+/// @param[in] scale The scaling of the lifting
+template <typename T, typename U>
+void assemble_system(
+    const U& mat_set_values, Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
+    const Form<T>& a, const Form<T>& L, const BCMarkers& bc0,
+    const BCMarkers& bc1,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& bc_values1,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x0,
+    double scale);
+
+/// Execute the kernels of a bilinear form and (optionally) a linear
+/// form over cells, and accumulate the results in a matrix and a
+/// vector with lifting of the boundary conditions. See assemble_system
+/// for the boundary condition arguments.
+/// @param[in] kernel_L The linear form kernel, or nullptr if only the
+///   bilinear form is integrated over the cells
+template <typename T, typename U, typename KernelA, typename KernelL>
+void assemble_cells_system(
+    const U& mat_set, Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
+    const mesh::Geometry& geometry,
+    const std::vector<std::int32_t>& active_cells,
+    const graph::AdjacencyList<std::int32_t>& dofmap0,
+    const graph::AdjacencyList<std::int32_t>& dofmap1, int bs0, int bs1,
+    const BCMarkers& bc0, const BCMarkers& bc1,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& bc_values1,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x0,
+    double scale, const KernelA& kernel_a,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs_a,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants_a,
+    const KernelL* kernel_L,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs_L,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constants_L,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info)
+{
+  // Prepare cell geometry
+  impl::CellCoordinates cell_coordinates(geometry);
+
+  // Data structures used in assembly
+  const int num_dofs0 = bs0 * dofmap0.links(0).size();
+  const int num_dofs1 = bs1 * dofmap1.links(0).size();
+  std::vector<std::int32_t> dofs0(num_dofs0), dofs1(num_dofs1);
+  Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Ae(
+      num_dofs0, num_dofs1);
+  Eigen::Matrix<T, Eigen::Dynamic, 1> be(num_dofs0);
+
+  for (std::int32_t c : active_cells)
+  {
+    const double* coordinate_dofs = cell_coordinates(c);
+
+    // Tabulate tensors
+    Ae.setZero();
+    kernel_a(Ae.data(), coeffs_a.row(c).data(), constants_a.data(),
+             coordinate_dofs, nullptr, nullptr, cell_info[c]);
+    be.setZero();
+    if (kernel_L)
+    {
+      (*kernel_L)(be.data(), coeffs_L.row(c).data(), constants_L.data(),
+                  coordinate_dofs, nullptr, nullptr, cell_info[c]);
+    }
+
+    // Lift the boundary conditions, and zero rows/columns for essential
+    // bcs
+    unroll_dofs(dofmap0.links(c), bs0, dofs0);
+    unroll_dofs(dofmap1.links(c), bs1, dofs1);
+    const bool cell_has_bc1 = has_bc(bc1, c);
+    if (cell_has_bc1)
+    {
+      for (int j = 0; j < num_dofs1; ++j)
+      {
+        const std::int32_t jj = dofs1[j];
+        if (bc1.dofs[jj])
+        {
+          const T g = x0.rows() > 0 ? bc_values1[jj] - x0[jj] : bc_values1[jj];
+          be -= Ae.col(j) * (scale * g);
+        }
+      }
+    }
+    zero_bc_entries(Ae, bc0, bc1, dofs0.data(), dofs1.data(), has_bc(bc0, c),
+                    cell_has_bc1);
+
+    impl::insert_cell<T>(mat_set, c, dofs0.size(), dofs0.data(),
+                         dofs1.size(), dofs1.data(), Ae.data());
+    for (int i = 0; i < num_dofs0; ++i)
+      b[dofs0[i]] += be[i];
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename U>
+void assemble_system(
+    const U& mat_set_values, Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
+    const Form<T>& a, const Form<T>& L, const BCMarkers& bc0,
+    const BCMarkers& bc1,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& bc_values1,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x0,
+    double scale)
+{
+  if (a.rank() != 2 or L.rank() != 1)
+    throw std::runtime_error("Expected a bilinear and a linear form.");
+  if (a.mesh() != L.mesh())
+    throw std::runtime_error("Forms are not defined on the same mesh.");
+  if (*a.function_space(0) != *L.function_space(0))
+    throw std::runtime_error("Forms do not have the same test space.");
+
+  std::shared_ptr<const mesh::Mesh> mesh = a.mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+  const std::int32_t num_cells
+      = mesh->topology().connectivity(tdim, 0)->num_nodes();
+
+  // Get dofmap data
+  std::shared_ptr<const fem::DofMap> dofmap0 = a.function_space(0)->dofmap();
+  std::shared_ptr<const fem::DofMap> dofmap1 = a.function_space(1)->dofmap();
+  assert(dofmap0);
+  assert(dofmap1);
+  const graph::AdjacencyList<std::int32_t>& dofs0 = dofmap0->list_blocked();
+  const graph::AdjacencyList<std::int32_t>& dofs1 = dofmap1->list_blocked();
+  const int bs0 = dofmap0->bs();
+  const int bs1 = dofmap1->bs();
+
+  // Prepare constants and coefficients
+  if (!a.all_constants_set() or !L.all_constants_set())
+    throw std::runtime_error("Unset constant in Form");
+  const Eigen::Array<T, Eigen::Dynamic, 1>& constants_a = pack_constants(a);
+  const Eigen::Array<T, Eigen::Dynamic, 1>& constants_L = pack_constants(L);
+  const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+      coeffs_a
+      = pack_coefficients(a);
+  const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+      coeffs_L
+      = pack_coefficients(L);
+
+  const FormIntegrals<T>& integrals_a = a.integrals();
+  const FormIntegrals<T>& integrals_L = L.integrals();
+  const bool needs_permutation_data = integrals_a.needs_permutation_data()
+                                      or integrals_L.needs_permutation_data();
+  if (needs_permutation_data)
+    mesh->topology_mutable().create_cell_permutation_info();
+  const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info
+      = needs_permutation_data
+            ? mesh->topology().get_cell_permutation_info()
+            : Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>(num_cells);
+
+  // Cell integrals of a, fused with the cell integral of L with the
+  // same ID
+  const std::vector<int> ids_a = integrals_a.integral_ids(IntegralType::cell);
+  const std::vector<int> ids_L = integrals_L.integral_ids(IntegralType::cell);
+  for (std::size_t i = 0; i < ids_a.size(); ++i)
+  {
+    const std::vector<std::int32_t>& cells
+        = integrals_a.integral_domains(IntegralType::cell, i);
+    auto it = std::find(ids_L.begin(), ids_L.end(), ids_a[i]);
+    impl::dispatch_kernel(
+        integrals_a, IntegralType::cell, i, [&](const auto& fn_a) {
+          if (it == ids_L.end())
+          {
+            using Kernel = std::decay_t<decltype(fn_a)>;
+            impl::assemble_cells_system<T, U, Kernel, Kernel>(
+                mat_set_values, b, mesh->geometry(), cells, dofs0, dofs1,
+                bs0, bs1, bc0, bc1, bc_values1, x0, scale, fn_a, coeffs_a,
+                constants_a, nullptr, coeffs_L, constants_L, cell_info);
+            return;
+          }
+
+          impl::dispatch_kernel(
+              integrals_L, IntegralType::cell,
+              std::distance(ids_L.begin(), it), [&](const auto& fn_L) {
+                impl::assemble_cells_system<T>(
+                    mat_set_values, b, mesh->geometry(), cells, dofs0, dofs1,
+                    bs0, bs1, bc0, bc1, bc_values1, x0, scale, fn_a,
+                    coeffs_a, constants_a, &fn_L, coeffs_L, constants_L,
+                    cell_info);
+              });
+        });
+  }
+
+  // Cell integrals of L without a matching integral of a
+  for (std::size_t i = 0; i < ids_L.size(); ++i)
+  {
+    if (std::find(ids_a.begin(), ids_a.end(), ids_L[i]) != ids_a.end())
+      continue;
+    const std::vector<std::int32_t>& active_cells
+        = integrals_L.integral_domains(IntegralType::cell, i);
+    const Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>
+        cells(active_cells.data(), active_cells.size());
+    impl::dispatch_kernel(
+        integrals_L, IntegralType::cell, i, [&](const auto& fn_L) {
+          impl::assemble_cells<T>(b, mesh->geometry(), cells, dofs0, bs0,
+                                  fn_L, coeffs_L, constants_L, cell_info);
+        });
+  }
+
+  // Facet integrals
+  impl::assemble_matrix_facets(mat_set_values, a, coeffs_a, constants_a,
+                               cell_info, bc0, bc1);
+  impl::assemble_vector_facets(b, L, coeffs_L, constants_L, cell_info);
+  if (!bc1.dofs.empty()
+      and integrals_a.num_integrals(IntegralType::exterior_facet) > 0)
+  {
+    const std::vector<bool> bc_markers1(bc1.dofs.begin(), bc1.dofs.end());
+    std::vector<std::int32_t> bc_cells1;
+    for (std::size_t c = 0; c < bc1.cells.size(); ++c)
+      if (bc1.cells[c])
+        bc_cells1.push_back(c);
+    _lift_bc_exterior_facets(b, a, bc_values1, bc_markers1, bc_cells1, x0,
+                             scale);
+  }
+}
+//-----------------------------------------------------------------------------
+
+} // namespace dolfinx::fem::impl
@@ -11,11 +11,16 @@
 #include "Form.h"
 #include "utils.h"
 #include <Eigen/Dense>
+#include <algorithm>
+#include <array>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/ThreadPool.h>
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/common/types.h>
 #include <dolfinx/function/Constant.h>
 #include <dolfinx/function/FunctionSpace.h>
 #include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/la/Vector.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/Topology.h>
@@ -36,41 +41,161 @@ template <typename T>
 void assemble_vector(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
                      const Form<T>& L);
 
-/// Execute kernel over cells and accumulate result in vector
+/// Assemble linear form into an Eigen vector using packed coefficients
+/// @param[in,out] b The vector to be assembled. It will not be zeroed before
+///   assembly.
+/// @param[in] L The linear forms to assemble into b
+/// @param[in] coeffs The packed coefficients of L (see
+///   pack_coefficients)
+template <typename T>
+void assemble_vector(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const Form<T>& L,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs);
+
+/// Assemble linear form into the owned and ghost entries of a vector
+/// and sum the ghost contributions into the owning processes
+/// (collective). The cells with ghost dofs, the facet integrals and
+/// @p boundary_work are assembled first. The reverse scatter of the
+/// ghost entries is then started, and the cells with only owned dofs
+/// are assembled while the data is communicated. Cell integrals are
+/// assembled without threads.
+/// @param[in,out] b The vector. Owned entries are not zeroed. Ghost
+///   entries are zeroed before assembly, and hold the local
+///   contributions on return.
+/// @param[in] L The linear form to assemble into b
+/// @param[in] coeffs The packed coefficients of L (see
+///   pack_coefficients)
+/// @param[in] boundary_work Additional contributions to b that are
+///   added before the ghost entries are sent, called as
+///   boundary_work(b.array()), e.g. lifting of boundary conditions
+template <typename T, typename U>
+void assemble_vector_overlap(
+    la::Vector<T>& b, const Form<T>& L,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const U& boundary_work);
+
+/// Assemble the exterior and interior facet integrals of a linear form
+/// into an Eigen vector
+/// @param[in,out] b The vector to be assembled. It will not be zeroed
+///   before assembly.
+/// @param[in] L The linear form
+/// @param[in] coeffs The packed coefficients of L
+/// @param[in] constant_values The packed constants of L
+/// @param[in] cell_info The cell permutation data
 template <typename T>
+void assemble_vector_facets(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const Form<T>& L,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info);
+
+/// Execute kernel over cells and accumulate result in vector
+template <typename T, typename Kernel>
 void assemble_cells(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
+    const mesh::Geometry& geometry,
+    const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+        active_cells,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
+    const Kernel& kernel,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info);
+
+/// Execute kernel over coloured cells and accumulate result in vector.
+/// The cells of each colour are divided between @p num_threads threads.
+/// Cells of the same colour must not share dofs.
+template <typename T, typename Kernel>
+void assemble_cells_threaded(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
+    const mesh::Geometry& geometry,
+    const graph::AdjacencyList<std::int32_t>& colouring, int num_threads,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
+    const Kernel& kernel,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info);
+
+/// Execute batched kernel over cells and accumulate result in vector.
+/// The cells are processed in batches of @p batch_size, see
+/// FormIntegrals::get_tabulate_tensor_batched for the data layout.
+template <typename T>
+void assemble_cells_batched(
     Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
     const mesh::Geometry& geometry,
     const std::vector<std::int32_t>& active_cells,
-    const graph::AdjacencyList<std::int32_t>& dofmap,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
     const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& kernel,
+                             const std::uint8_t*, const std::uint32_t*)>&
+        kernel,
+    int batch_size,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info);
 
-/// Execute kernel over cells and accumulate result in vector
-template <typename T>
+/// Execute kernel over exterior facets and accumulate result in vector.
+/// The facets are given by their attached cell and local facet index
+/// (see FormIntegrals::facet_domains).
+template <typename T, typename Kernel>
 void assemble_exterior_facets(
     Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const mesh::Mesh& mesh,
-    const std::vector<std::int32_t>& active_facets,
-    const graph::AdjacencyList<std::int32_t>& dofmap,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& fn,
+    const std::vector<std::int32_t>& facets,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
+    const Kernel& fn,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
     const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms);
 
-/// Assemble linear form interior facet integrals into an Eigen vector
+/// Execute batched kernel over exterior facets and accumulate result
+/// in vector. The facets are processed in batches of @p batch_size.
 template <typename T>
-void assemble_interior_facets(
+void assemble_exterior_facets_batched(
     Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const mesh::Mesh& mesh,
-    const std::vector<std::int32_t>& active_facets, const fem::DofMap& dofmap,
+    const std::vector<std::int32_t>& facets,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
     const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& fn,
+                             const std::uint8_t*, const std::uint32_t*)>&
+        kernel,
+    int batch_size,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
+    const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms);
+
+/// Assemble linear form interior facet integrals into an Eigen vector.
+/// The facets are given by their two attached cells and local facet
+/// indices (see FormIntegrals::facet_domains).
+template <typename T, typename Kernel>
+void assemble_interior_facets(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const mesh::Mesh& mesh,
+    const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+        facets,
+    const fem::DofMap& dofmap, const Kernel& fn,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const std::vector<int>& offsets,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
+    const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms);
+
+/// Assemble linear form interior facet integrals into an Eigen vector
+/// with several threads. The facets of each colour (see
+/// compute_interior_facet_colouring) share no dofs and are divided
+/// between @p num_threads threads.
+template <typename T, typename Kernel>
+void assemble_interior_facets_threaded(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const mesh::Mesh& mesh,
+    const graph::AdjacencyList<std::int32_t>& colouring, int num_threads,
+    const fem::DofMap& dofmap, const Kernel& fn,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const std::vector<int>& offsets,
@@ -140,12 +265,37 @@ void lift_bc(
     const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x0,
     double scale);
 
+/// Modify RHS vector to account for boundary condition such that: b <-
+////
+///     b - scale * A (x_bc - x0)
+////
+/// Only the cells in @p bc_cells1 are visited.
+/// @param[in,out] b The vector to be modified
+/// @param[in] a The bilinear form that generates A
+/// @param[in] bc_values1 The boundary condition 'values'
+/// @param[in] bc_markers1 The indices (columns of A, rows of x) to
+///                        which bcs belong
+/// @param[in] bc_cells1 The sorted cells that have at least one dof
+///                      marked in @p bc_markers1 (see
+///                      DirichletBC::cells)
+/// @param[in] x0 The array used in the lifting. If empty, x0 = 0.
+/// @param[in] scale Scaling to apply
+template <typename T>
+void lift_bc(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const Form<T>& a,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& bc_values1,
+    const std::vector<bool>& bc_markers1,
+    const std::vector<std::int32_t>& bc_cells1,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x0,
+    double scale);
+
 // Implementation of bc application
 template <typename T>
 void _lift_bc_cells(
     Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const Form<T>& a,
     const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& bc_values1,
     const std::vector<bool>& bc_markers1,
+    const std::vector<std::int32_t>& bc_cells1,
     const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x0,
     double scale)
 {
@@ -155,7 +305,9 @@ void _lift_bc_cells(
   std::shared_ptr<const mesh::Mesh> mesh = a.mesh();
   assert(mesh);
 
-  mesh->topology_mutable().create_entity_permutations();
+  const bool needs_permutation_data = a.integrals().needs_permutation_data();
+  if (needs_permutation_data)
+    mesh->topology_mutable().create_cell_permutation_info();
 
   // Get dofmap for columns and rows of a
   assert(a.function_space(0));
@@ -166,7 +318,8 @@ void _lift_bc_cells(
   assert(dofmap1);
 
   // Prepare coefficients
-  Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> coeffs
+  const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+      coeffs
       = pack_coefficients(a);
 
   const std::function<void(T*, const T*, const T*, const double*, const int*,
@@ -174,66 +327,57 @@ void _lift_bc_cells(
       = a.integrals().get_tabulate_tensor(IntegralType::cell, 0);
 
   // Prepare cell geometry
-  const int gdim = mesh->geometry().dim();
-  const graph::AdjacencyList<std::int32_t>& x_dofmap
-      = mesh->geometry().dofmap();
-
-  // FIXME: Add proper interface for num coordinate dofs
-  const int num_dofs_g = x_dofmap.num_links(0);
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
-      = mesh->geometry().x();
+  impl::CellCoordinates cell_coordinates(mesh->geometry());
 
   // Data structures used in bc application
-  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      coordinate_dofs(num_dofs_g, gdim);
   Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Ae;
   Eigen::Matrix<T, Eigen::Dynamic, 1> be;
+  const int bs0 = dofmap0->bs();
+  const int bs1 = dofmap1->bs();
+  std::vector<std::int32_t> dofs0, dofs1;
 
   // Prepare constants
   if (!a.all_constants_set())
     throw std::runtime_error("Unset constant in Form");
-  const Eigen::Array<T, Eigen::Dynamic, 1> constant_values = pack_constants(a);
-
-  const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info
-      = mesh->topology().get_cell_permutation_info();
+  const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values = pack_constants(a);
 
-  // Iterate over all cells
+  // Iterate over the owned cells with a bc applied
   const int tdim = mesh->topology().dim();
   auto map = mesh->topology().index_map(tdim);
   assert(map);
   const int num_cells = map->size_local();
-  for (int c = 0; c < num_cells; ++c)
-  {
-    // Get dof maps for cell
-    auto dmap1 = dofmap1->cell_dofs(c);
 
-    // Check if bc is applied to cell
-    bool has_bc = false;
-    for (Eigen::Index j = 0; j < dmap1.size(); ++j)
-    {
-      if (bc_markers1[dmap1[j]])
-      {
-        has_bc = true;
-        break;
-      }
-    }
+  const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info
+      = needs_permutation_data
+            ? mesh->topology().get_cell_permutation_info()
+            : Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>(num_cells);
+  for (std::int32_t c : bc_cells1)
+  {
+    // Cells are sorted, so the remaining cells are ghosts
+    if (c >= num_cells)
+      break;
 
-    if (!has_bc)
-      continue;
+    // Get dof maps for cell
+    auto blocks1 = dofmap1->list_blocked().links(c);
+    dofs1.resize(bs1 * blocks1.size());
+    unroll_dofs(blocks1, bs1, dofs1);
+    Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>> dmap1(
+        dofs1.data(), dofs1.size());
 
     // Get cell vertex coordinates
-    auto x_dofs = x_dofmap.links(c);
-    for (int i = 0; i < num_dofs_g; ++i)
-      for (int j = 0; j < gdim; ++j)
-        coordinate_dofs(i, j) = x_g(x_dofs[i], j);
+    const double* coordinate_dofs = cell_coordinates(c);
 
     // Size data structure for assembly
-    auto dmap0 = dofmap0->cell_dofs(c);
+    auto blocks0 = dofmap0->list_blocked().links(c);
+    dofs0.resize(bs0 * blocks0.size());
+    unroll_dofs(blocks0, bs0, dofs0);
+    Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>> dmap0(
+        dofs0.data(), dofs0.size());
 
     auto coeff_array = coeffs.row(c);
     Ae.setZero(dmap0.size(), dmap1.size());
     fn(Ae.data(), coeff_array.data(), constant_values.data(),
-       coordinate_dofs.data(), nullptr, nullptr, cell_info[c]);
+       coordinate_dofs, nullptr, nullptr, cell_info[c]);
 
     // Size data structure for assembly
     be.setZero(dmap0.size());
@@ -260,6 +404,7 @@ void _lift_bc_exterior_facets(
     Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const Form<T>& a,
     const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& bc_values1,
     const std::vector<bool>& bc_markers1,
+    const std::vector<std::int32_t>& bc_cells1,
     const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x0,
     double scale)
 {
@@ -269,16 +414,17 @@ void _lift_bc_exterior_facets(
   std::shared_ptr<const mesh::Mesh> mesh = a.mesh();
   assert(mesh);
 
-  mesh->topology_mutable().create_entity_permutations();
-
-  const int gdim = mesh->geometry().dim();
   const int tdim = mesh->topology().dim();
 
   // FIXME: cleanup these calls? Some of the happen internally again.
   mesh->topology_mutable().create_entities(tdim - 1);
   mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
-  // FIXME: Why again -- appears already See 8 lines above.
-  mesh->topology_mutable().create_entity_permutations();
+  const bool needs_permutation_data = a.integrals().needs_permutation_data();
+  if (needs_permutation_data)
+  {
+    mesh->topology_mutable().create_cell_permutation_info();
+    mesh->topology_mutable().create_facet_permutations();
+  }
 
   // Get dofmap for columns and rows of a
   assert(a.function_space(0));
@@ -289,7 +435,8 @@ void _lift_bc_exterior_facets(
   assert(dofmap1);
 
   // Prepare coefficients
-  Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> coeffs
+  const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+      coeffs
       = pack_coefficients(a);
 
   const std::function<void(T*, const T*, const T*, const double*, const int*,
@@ -297,23 +444,19 @@ void _lift_bc_exterior_facets(
       = a.integrals().get_tabulate_tensor(IntegralType::exterior_facet, 0);
 
   // Prepare cell geometry
-  const graph::AdjacencyList<std::int32_t>& x_dofmap
-      = mesh->geometry().dofmap();
-  // FIXME: Add proper interface for num coordinate dofs
-  const int num_dofs_g = x_dofmap.num_links(0);
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
-      = mesh->geometry().x();
+  impl::CellCoordinates cell_coordinates(mesh->geometry());
 
   // Data structures used in bc application
-  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      coordinate_dofs(num_dofs_g, gdim);
   Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Ae;
   Eigen::Matrix<T, Eigen::Dynamic, 1> be;
+  const int bs0 = dofmap0->bs();
+  const int bs1 = dofmap1->bs();
+  std::vector<std::int32_t> dofs0, dofs1;
 
   // Prepare constants
   if (!a.all_constants_set())
     throw std::runtime_error("Unset constant in Form");
-  const Eigen::Array<T, Eigen::Dynamic, 1> constant_values = pack_constants(a);
+  const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values = pack_constants(a);
 
   // Iterate over owned facets
   const mesh::Topology& topology = mesh->topology();
@@ -324,10 +467,18 @@ void _lift_bc_exterior_facets(
   auto map = topology.index_map(tdim - 1);
   assert(map);
 
+  const std::int32_t num_cells = topology.connectivity(tdim, 0)->num_nodes();
+  const int facets_per_cell
+      = mesh::cell_num_entities(topology.cell_type(), tdim - 1);
   const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms
-      = mesh->topology().get_facet_permutations();
+      = needs_permutation_data
+            ? topology.get_facet_permutations()
+            : Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>(
+                facets_per_cell, num_cells);
   const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info
-      = mesh->topology().get_cell_permutation_info();
+      = needs_permutation_data
+            ? topology.get_cell_permutation_info()
+            : Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>(num_cells);
 
   std::set<std::int32_t> fwd_shared_facets;
   // Only need to consider shared facets when there are no ghost cells
@@ -338,52 +489,26 @@ void _lift_bc_exterior_facets(
         topology.index_map(tdim - 1)->shared_indices().end());
   }
 
-  for (int f = 0; f < map->size_local(); ++f)
-  {
-    // Move to next facet if this one is an interior facet
-    // Interior facets have two attached cells. If on a process boundary,
-    // and owned locally, then they are "forward shared".
-    if (connectivity->num_links(f) == 2
-        or fwd_shared_facets.find(f) != fwd_shared_facets.end())
-      continue;
-
-    // Create attached cell
-    assert(connectivity->num_links(f) == 1);
-    const std::int32_t cell = connectivity->links(f)[0];
-
-    // Get local index of facet with respect to the cell
-    auto facets = c_to_f->links(cell);
-    const auto* it = std::find(facets.data(), facets.data() + facets.rows(), f);
-    assert(it != (facets.data() + facets.rows()));
-    const int local_facet = std::distance(facets.data(), it);
-
+  // Compute the lifting contribution of a facet
+  auto lift_facet = [&](std::int32_t cell, int local_facet) {
     const std::uint8_t perm = perms(local_facet, cell);
 
     // Get dof maps for cell
-    auto dmap1 = dofmap1->cell_dofs(cell);
-
-    // Check if bc is applied to cell
-    bool has_bc = false;
-    for (Eigen::Index j = 0; j < dmap1.size(); ++j)
-    {
-      if (bc_markers1[dmap1[j]])
-      {
-        has_bc = true;
-        break;
-      }
-    }
-
-    if (!has_bc)
-      continue;
+    auto blocks1 = dofmap1->list_blocked().links(cell);
+    dofs1.resize(bs1 * blocks1.size());
+    unroll_dofs(blocks1, bs1, dofs1);
+    Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>> dmap1(
+        dofs1.data(), dofs1.size());
 
     // Get cell vertex coordinates
-    auto x_dofs = x_dofmap.links(cell);
-    for (int i = 0; i < num_dofs_g; ++i)
-      for (int j = 0; j < gdim; ++j)
-        coordinate_dofs(i, j) = x_g(x_dofs[i], j);
+    const double* coordinate_dofs = cell_coordinates(cell);
 
     // Size data structure for assembly
-    auto dmap0 = dofmap0->cell_dofs(cell);
+    auto blocks0 = dofmap0->list_blocked().links(cell);
+    dofs0.resize(bs0 * blocks0.size());
+    unroll_dofs(blocks0, bs0, dofs0);
+    Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>> dmap0(
+        dofs0.data(), dofs0.size());
 
     // TODO: Move gathering of coefficients outside of main assembly
     // loop
@@ -391,7 +516,7 @@ void _lift_bc_exterior_facets(
     auto coeff_array = coeffs.row(cell);
     Ae.setZero(dmap0.size(), dmap1.size());
     fn(Ae.data(), coeff_array.data(), constant_values.data(),
-       coordinate_dofs.data(), &local_facet, &perm, cell_info[cell]);
+       coordinate_dofs, &local_facet, &perm, cell_info[cell]);
 
     // Size data structure for assembly
     be.setZero(dmap0.size());
@@ -410,13 +535,44 @@ void _lift_bc_exterior_facets(
 
     for (Eigen::Index k = 0; k < dmap0.size(); ++k)
       b[dmap0[k]] += be[k];
+  };
+
+  // Iterate over the owned exterior facets of the cells with a bc
+  // applied. An exterior facet has one attached cell, so each facet is
+  // visited once.
+  for (std::int32_t cell : bc_cells1)
+  {
+    auto facets = c_to_f->links(cell);
+    for (int local_facet = 0; local_facet < facets.rows(); ++local_facet)
+    {
+      // Move to next facet if this one is a ghost or an interior facet.
+      // Interior facets have two attached cells. If on a process
+      // boundary, and owned locally, then they are "forward shared".
+      const std::int32_t f = facets[local_facet];
+      if (f >= map->size_local() or connectivity->num_links(f) == 2
+          or fwd_shared_facets.find(f) != fwd_shared_facets.end())
+      {
+        continue;
+      }
+      assert(connectivity->num_links(f) == 1);
+
+      lift_facet(cell, local_facet);
+    }
   }
 }
-
 //-----------------------------------------------------------------------------
 template <typename T>
 void assemble_vector(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
                      const Form<T>& L)
+{
+  impl::assemble_vector(b, L, pack_coefficients(L));
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void assemble_vector(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const Form<T>& L,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs)
 {
   std::shared_ptr<const mesh::Mesh> mesh = L.mesh();
   assert(mesh);
@@ -428,21 +584,18 @@ void assemble_vector(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
   assert(L.function_space(0));
   std::shared_ptr<const fem::DofMap> dofmap = L.function_space(0)->dofmap();
   assert(dofmap);
-  const graph::AdjacencyList<std::int32_t>& dofs = dofmap->list();
+  const graph::AdjacencyList<std::int32_t>& dofs = dofmap->list_blocked();
+  const int bs = dofmap->bs();
 
   // Prepare constants
   if (!L.all_constants_set())
     throw std::runtime_error("Unset constant in Form");
-  const Eigen::Array<T, Eigen::Dynamic, 1> constant_values = pack_constants(L);
-
-  // Prepare coefficients
-  const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> coeffs
-      = pack_coefficients(L);
+  const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values = pack_constants(L);
 
   const FormIntegrals<T>& integrals = L.integrals();
   const bool needs_permutation_data = integrals.needs_permutation_data();
   if (needs_permutation_data)
-    mesh->topology_mutable().create_entity_permutations();
+    mesh->topology_mutable().create_cell_permutation_info();
   const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info
       = needs_permutation_data
             ? mesh->topology().get_cell_permutation_info()
@@ -450,19 +603,74 @@ void assemble_vector(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
 
   for (int i = 0; i < integrals.num_integrals(IntegralType::cell); ++i)
   {
-    const auto& fn = integrals.get_tabulate_tensor(IntegralType::cell, i);
-    const std::vector<std::int32_t>& active_cells
-        = integrals.integral_domains(IntegralType::cell, i);
-    fem::impl::assemble_cells(b, mesh->geometry(), active_cells, dofs, fn,
-                              coeffs, constant_values, cell_info);
+    const int batch_size = integrals.batch_size(IntegralType::cell, i);
+    if (batch_size > 0 and L.num_threads() == 1)
+    {
+      const auto& fn_batched
+          = integrals.get_tabulate_tensor_batched(IntegralType::cell, i);
+      fem::impl::assemble_cells_batched(
+          b, mesh->geometry(),
+          integrals.integral_domains(IntegralType::cell, i), dofs, bs,
+          fn_batched, batch_size, coeffs, constant_values, cell_info);
+    }
+    else if (L.num_threads() > 1)
+    {
+      impl::dispatch_kernel(
+          integrals, IntegralType::cell, i, [&](const auto& fn) {
+            fem::impl::assemble_cells_threaded(
+                b, mesh->geometry(), *impl::cell_colouring(L, i),
+                L.num_threads(), dofs, bs, fn, coeffs, constant_values,
+                cell_info);
+          });
+    }
+    else
+    {
+      const std::vector<std::int32_t>& active_cells
+          = integrals.integral_domains(IntegralType::cell, i);
+      const Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>
+          cells(active_cells.data(), active_cells.size());
+      impl::dispatch_kernel(
+          integrals, IntegralType::cell, i, [&](const auto& fn) {
+            fem::impl::assemble_cells(b, mesh->geometry(), cells, dofs, bs,
+                                      fn, coeffs, constant_values,
+                                      cell_info);
+          });
+    }
   }
 
+  impl::assemble_vector_facets(b, L, coeffs, constant_values, cell_info);
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void assemble_vector_facets(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const Form<T>& L,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = L.mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+  const std::int32_t num_cells
+      = mesh->topology().connectivity(tdim, 0)->num_nodes();
+
+  assert(L.function_space(0));
+  std::shared_ptr<const fem::DofMap> dofmap = L.function_space(0)->dofmap();
+  assert(dofmap);
+  const graph::AdjacencyList<std::int32_t>& dofs = dofmap->list_blocked();
+  const int bs = dofmap->bs();
+
+  const FormIntegrals<T>& integrals = L.integrals();
+  const bool needs_permutation_data = integrals.needs_permutation_data();
   if (integrals.num_integrals(IntegralType::exterior_facet) > 0
       or integrals.num_integrals(IntegralType::interior_facet) > 0)
   {
     // FIXME: cleanup these calls? Some of the happen internally again.
     mesh->topology_mutable().create_entities(tdim - 1);
     mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
+    if (needs_permutation_data)
+      mesh->topology_mutable().create_facet_permutations();
 
     const int facets_per_cell
         = mesh::cell_num_entities(mesh->topology().cell_type(), tdim - 1);
@@ -474,214 +682,410 @@ void assemble_vector(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
     for (int i = 0; i < integrals.num_integrals(IntegralType::exterior_facet);
          ++i)
     {
-      const auto& fn
-          = integrals.get_tabulate_tensor(IntegralType::exterior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = integrals.integral_domains(IntegralType::exterior_facet, i);
-      fem::impl::assemble_exterior_facets(b, *mesh, active_facets, dofs, fn,
-                                          coeffs, constant_values, cell_info,
-                                          perms);
+      const std::vector<std::int32_t>& facets
+          = integrals.facet_domains(IntegralType::exterior_facet, i);
+      if (const int batch_size
+          = integrals.batch_size(IntegralType::exterior_facet, i);
+          batch_size > 0)
+      {
+        fem::impl::assemble_exterior_facets_batched(
+            b, *mesh, facets, dofs, bs,
+            integrals.get_tabulate_tensor_batched(IntegralType::exterior_facet,
+                                                  i),
+            batch_size, coeffs, constant_values, cell_info, perms);
+      }
+      else
+      {
+        impl::dispatch_kernel(
+            integrals, IntegralType::exterior_facet, i, [&](const auto& fn) {
+              fem::impl::assemble_exterior_facets(b, *mesh, facets, dofs, bs,
+                                                  fn, coeffs, constant_values,
+                                                  cell_info, perms);
+            });
+      }
     }
 
     const std::vector<int> c_offsets = L.coefficients().offsets();
     for (int i = 0; i < integrals.num_integrals(IntegralType::interior_facet);
          ++i)
     {
-      const auto& fn
-          = integrals.get_tabulate_tensor(IntegralType::interior_facet, i);
-      const std::vector<std::int32_t>& active_facets
-          = integrals.integral_domains(IntegralType::interior_facet, i);
-      fem::impl::assemble_interior_facets(b, *mesh, active_facets, *dofmap, fn,
-                                          coeffs, c_offsets, constant_values,
-                                          cell_info, perms);
+      if (L.num_threads() > 1)
+      {
+        impl::dispatch_kernel(
+            integrals, IntegralType::interior_facet, i, [&](const auto& fn) {
+              fem::impl::assemble_interior_facets_threaded(
+                  b, *mesh, *impl::interior_facet_colouring(L, i),
+                  L.num_threads(), *dofmap, fn, coeffs, c_offsets,
+                  constant_values, cell_info, perms);
+            });
+      }
+      else
+      {
+        const std::vector<std::int32_t>& active_facets
+            = integrals.facet_domains(IntegralType::interior_facet, i);
+        const Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>
+            facets(active_facets.data(), active_facets.size());
+        impl::dispatch_kernel(
+            integrals, IntegralType::interior_facet, i, [&](const auto& fn) {
+              fem::impl::assemble_interior_facets(
+                  b, *mesh, facets, *dofmap, fn, coeffs, c_offsets,
+                  constant_values, cell_info, perms);
+            });
+      }
     }
   }
 }
 //-----------------------------------------------------------------------------
-template <typename T>
+template <typename T, typename U>
+void assemble_vector_overlap(
+    la::Vector<T>& b, const Form<T>& L,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const U& boundary_work)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = L.mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+  const std::int32_t num_cells
+      = mesh->topology().connectivity(tdim, 0)->num_nodes();
+
+  // Get dofmap data
+  assert(L.function_space(0));
+  std::shared_ptr<const fem::DofMap> dofmap = L.function_space(0)->dofmap();
+  assert(dofmap);
+  const graph::AdjacencyList<std::int32_t>& dofs = dofmap->list_blocked();
+  const int bs = dofmap->bs();
+  assert(b.map());
+  const std::int32_t size_owned
+      = b.map()->block_size() * b.map()->size_local();
+
+  // Prepare constants
+  if (!L.all_constants_set())
+    throw std::runtime_error("Unset constant in Form");
+  const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values = pack_constants(L);
+
+  const FormIntegrals<T>& integrals = L.integrals();
+  const bool needs_permutation_data = integrals.needs_permutation_data();
+  if (needs_permutation_data)
+    mesh->topology_mutable().create_cell_permutation_info();
+  const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info
+      = needs_permutation_data
+            ? mesh->topology().get_cell_permutation_info()
+            : Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>(num_cells);
+
+  Eigen::Matrix<T, Eigen::Dynamic, 1>& _b = b.array();
+  auto assemble_cell_list = [&](int i, const std::vector<std::int32_t>& cells) {
+    if (const int batch_size = integrals.batch_size(IntegralType::cell, i);
+        batch_size > 0)
+    {
+      fem::impl::assemble_cells_batched<T>(
+          _b, mesh->geometry(), cells, dofs, bs,
+          integrals.get_tabulate_tensor_batched(IntegralType::cell, i),
+          batch_size, coeffs, constant_values, cell_info);
+    }
+    else
+    {
+      impl::dispatch_kernel(
+          integrals, IntegralType::cell, i, [&](const auto& fn) {
+            fem::impl::assemble_cells<T>(
+                _b, mesh->geometry(),
+                Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>(
+                    cells.data(), cells.size()),
+                dofs, bs, fn, coeffs, constant_values, cell_info);
+          });
+    }
+  };
+
+  // Split the cells of each cell integral into cells with ghost dofs
+  // and cells with only owned dofs
+  const int num_cell_integrals = integrals.num_integrals(IntegralType::cell);
+  std::vector<std::array<std::vector<std::int32_t>, 2>> split_cells(
+      num_cell_integrals);
+  for (int i = 0; i < num_cell_integrals; ++i)
+  {
+    split_cells[i] = split_cells_by_ownership(
+        integrals.integral_domains(IntegralType::cell, i), dofs,
+        size_owned / bs);
+  }
+
+  // Assemble the contributions to ghost entries
+  _b.tail(_b.size() - size_owned).setZero();
+  for (int i = 0; i < num_cell_integrals; ++i)
+    assemble_cell_list(i, split_cells[i][0]);
+  impl::assemble_vector_facets<T>(_b, L, coeffs, constant_values, cell_info);
+  boundary_work(_b);
+
+  // Send the ghost contributions and assemble the cells with only owned
+  // dofs while the data is communicated
+  b.scatter_rev_begin();
+  for (int i = 0; i < num_cell_integrals; ++i)
+    assemble_cell_list(i, split_cells[i][1]);
+  b.scatter_rev_end(common::IndexMap::Mode::add);
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename Kernel>
 void assemble_cells(
     Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
     const mesh::Geometry& geometry,
-    const std::vector<std::int32_t>& active_cells,
-    const graph::AdjacencyList<std::int32_t>& dofmap,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& kernel,
+    const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+        active_cells,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
+    const Kernel& kernel,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info)
 {
-  const int gdim = geometry.dim();
+  common::Timer timer("Assemble cells (vector)");
 
   // Prepare cell geometry
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
-
-  // FIXME: Add proper interface for num coordinate dofs
-  const int num_dofs_g = x_dofmap.num_links(0);
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
-      = geometry.x();
+  impl::CellCoordinates cell_coordinates(geometry);
 
   // FIXME: Add proper interface for num_dofs
   // Create data structures used in assembly
-  const int num_dofs = dofmap.links(0).size();
-  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      coordinate_dofs(num_dofs_g, gdim);
-  Eigen::Matrix<T, Eigen::Dynamic, 1> be(num_dofs);
+  const int num_dofs = bs * dofmap.links(0).size();
+  ElementTensor<T> be(num_dofs, 1);
 
   // Iterate over active cells
-  for (std::int32_t c : active_cells)
+  for (Eigen::Index index = 0; index < active_cells.rows(); ++index)
   {
+    const std::int32_t c = active_cells[index];
+
     // Get cell coordinates/geometry
-    auto x_dofs = x_dofmap.links(c);
-    for (int i = 0; i < num_dofs_g; ++i)
-      for (int j = 0; j < gdim; ++j)
-        coordinate_dofs(i, j) = x_g(x_dofs[i], j);
+    const double* coordinate_dofs = cell_coordinates(c);
 
     // Tabulate vector for cell
-    std::fill(be.data(), be.data() + num_dofs, 0);
+    be.set_zero();
     kernel(be.data(), coeffs.row(c).data(), constant_values.data(),
-           coordinate_dofs.data(), nullptr, nullptr, cell_info[c]);
+           coordinate_dofs, nullptr, nullptr, cell_info[c]);
 
     // Scatter cell vector to 'global' vector array
     auto dofs = dofmap.links(c);
-    for (Eigen::Index i = 0; i < num_dofs; ++i)
-      b[dofs[i]] += be[i];
+    for (Eigen::Index i = 0; i < dofs.size(); ++i)
+      for (int k = 0; k < bs; ++k)
+        b[bs * dofs[i] + k] += be.data()[bs * i + k];
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename Kernel>
+void assemble_cells_threaded(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
+    const mesh::Geometry& geometry,
+    const graph::AdjacencyList<std::int32_t>& colouring, int num_threads,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
+    const Kernel& kernel,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info)
+{
+  // Build the geometry cell coordinate cache (if enabled) before
+  // threads access it
+  geometry.cell_coordinates();
+
+  for (std::int32_t colour = 0; colour < colouring.num_nodes(); ++colour)
+  {
+    auto cells = colouring.links(colour);
+    common::parallel_for(
+        num_threads, cells.rows(), [&](int, std::int32_t c0, std::int32_t c1) {
+          impl::assemble_cells<T>(b, geometry, cells.segment(c0, c1 - c0),
+                                  dofmap, bs, kernel, coeffs,
+                                  constant_values, cell_info);
+        });
   }
 }
 //-----------------------------------------------------------------------------
 template <typename T>
+void assemble_cells_batched(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
+    const mesh::Geometry& geometry,
+    const std::vector<std::int32_t>& active_cells,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
+    const std::function<void(T*, const T*, const T*, const double*, const int*,
+                             const std::uint8_t*, const std::uint32_t*)>&
+        kernel,
+    int batch_size,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info)
+{
+  // Create data structures used in assembly
+  const int num_dofs = bs * dofmap.links(0).size();
+  std::vector<double> coordinate_dofs;
+  std::vector<T> w;
+  std::vector<std::uint32_t> info;
+  std::vector<T> bb(num_dofs * batch_size);
+
+  // Iterate over batches of active cells
+  const std::int32_t num_cells = active_cells.size();
+  for (std::int32_t c0 = 0; c0 < num_cells; c0 += batch_size)
+  {
+    const int n = std::min(batch_size, num_cells - c0);
+    impl::pack_cell_batch<T>(active_cells.data() + c0, n, batch_size,
+                             geometry, coeffs, cell_info, coordinate_dofs, w,
+                             info);
+
+    // Tabulate vectors for cells in batch
+    std::fill(bb.begin(), bb.end(), 0);
+    kernel(bb.data(), w.data(), constant_values.data(),
+           coordinate_dofs.data(), nullptr, nullptr, info.data());
+
+    // Scatter cell vectors to 'global' vector array
+    for (int l = 0; l < n; ++l)
+    {
+      auto dofs = dofmap.links(active_cells[c0 + l]);
+      for (Eigen::Index i = 0; i < dofs.size(); ++i)
+        for (int k = 0; k < bs; ++k)
+          b[bs * dofs[i] + k] += bb[(bs * i + k) * batch_size + l];
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename Kernel>
 void assemble_exterior_facets(
     Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const mesh::Mesh& mesh,
-    const std::vector<std::int32_t>& active_facets,
-    const graph::AdjacencyList<std::int32_t>& dofmap,
-    const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& fn,
+    const std::vector<std::int32_t>& facets,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
+    const Kernel& fn,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
     const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
     const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms)
 {
-  const int gdim = mesh.geometry().dim();
-  const int tdim = mesh.topology().dim();
-
   // Prepare cell geometry
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
-
-  // FIXME: Add proper interface for num coordinate dofs
-  const int num_dofs_g = x_dofmap.num_links(0);
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
-      = mesh.geometry().x();
+  impl::CellCoordinates cell_coordinates(mesh.geometry());
 
   // FIXME: Add proper interface for num_dofs
   // Create data structures used in assembly
-  const int num_dofs = dofmap.links(0).size();
-  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      coordinate_dofs(num_dofs_g, gdim);
-  Eigen::Matrix<T, Eigen::Dynamic, 1> be(num_dofs);
-
-  auto f_to_c = mesh.topology().connectivity(tdim - 1, tdim);
-  assert(f_to_c);
-  auto c_to_f = mesh.topology().connectivity(tdim, tdim - 1);
-  assert(c_to_f);
-  for (const auto& f : active_facets)
-  {
-    // Get index of first attached cell
-    assert(f_to_c->num_links(f) > 0);
-    const std::int32_t cell = f_to_c->links(f)[0];
+  const int num_dofs = bs * dofmap.links(0).size();
+  ElementTensor<T> be(num_dofs, 1);
 
-    // Get local index of facet with respect to the cell
-    auto facets = c_to_f->links(cell);
-    const auto* it = std::find(facets.data(), facets.data() + facets.rows(), f);
-    assert(it != (facets.data() + facets.rows()));
-    const int local_facet = std::distance(facets.data(), it);
+  for (std::size_t index = 0; index < facets.size(); index += 2)
+  {
+    // Get attached cell and local index of facet with respect to the
+    // cell
+    const std::int32_t cell = facets[index];
+    const int local_facet = facets[index + 1];
 
     // Get cell coordinates/geometry
-    auto x_dofs = x_dofmap.links(cell);
-    for (int i = 0; i < num_dofs_g; ++i)
-      for (int j = 0; j < gdim; ++j)
-        coordinate_dofs(i, j) = x_g(x_dofs[i], j);
+    const double* coordinate_dofs = cell_coordinates(cell);
 
     // Tabulate element vector
-    std::fill(be.data(), be.data() + num_dofs, 0);
+    be.set_zero();
     fn(be.data(), coeffs.row(cell).data(), constant_values.data(),
-       coordinate_dofs.data(), &local_facet, &perms(local_facet, cell),
+       coordinate_dofs, &local_facet, &perms(local_facet, cell),
        cell_info[cell]);
 
     // Add element vector to global vector
     auto dofs = dofmap.links(cell);
-    for (Eigen::Index i = 0; i < num_dofs; ++i)
-      b[dofs[i]] += be[i];
+    for (Eigen::Index i = 0; i < dofs.size(); ++i)
+      for (int k = 0; k < bs; ++k)
+        b[bs * dofs[i] + k] += be.data()[bs * i + k];
   }
 }
 //-----------------------------------------------------------------------------
 template <typename T>
-void assemble_interior_facets(
+void assemble_exterior_facets_batched(
     Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const mesh::Mesh& mesh,
-    const std::vector<std::int32_t>& active_facets, const fem::DofMap& dofmap,
+    const std::vector<std::int32_t>& facets,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int bs,
     const std::function<void(T*, const T*, const T*, const double*, const int*,
-                             const std::uint8_t*, const std::uint32_t)>& fn,
+                             const std::uint8_t*, const std::uint32_t*)>&
+        kernel,
+    int batch_size,
     const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         coeffs,
-    const std::vector<int>& offsets,
     const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
     const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms)
 {
-  const int gdim = mesh.geometry().dim();
-  const int tdim = mesh.topology().dim();
+  // Create data structures used in assembly
+  const int num_dofs = bs * dofmap.links(0).size();
+  std::vector<double> coordinate_dofs;
+  std::vector<T> w;
+  std::vector<std::uint32_t> info;
+  std::vector<std::int32_t> cells(batch_size);
+  std::vector<int> local_facets(batch_size);
+  std::vector<std::uint8_t> perm(batch_size);
+  std::vector<T> bb(num_dofs * batch_size);
+
+  const std::int32_t num_facets = facets.size() / 2;
+  for (std::int32_t f0 = 0; f0 < num_facets; f0 += batch_size)
+  {
+    const int n = std::min(batch_size, num_facets - f0);
+    for (int l = 0; l < batch_size; ++l)
+    {
+      // Unused lanes repeat the first facet of the batch
+      const std::int32_t f = f0 + (l < n ? l : 0);
+      cells[l] = facets[2 * f];
+      local_facets[l] = facets[2 * f + 1];
+      perm[l] = perms(local_facets[l], cells[l]);
+    }
+    impl::pack_cell_batch<T>(cells.data(), n, batch_size, mesh.geometry(),
+                             coeffs, cell_info, coordinate_dofs, w, info);
 
-  // Prepare cell geometry
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
-  // FIXME: Add proper interface for num coordinate dofs
+    // Tabulate element vectors
+    std::fill(bb.begin(), bb.end(), 0);
+    kernel(bb.data(), w.data(), constant_values.data(),
+           coordinate_dofs.data(), local_facets.data(), perm.data(),
+           info.data());
 
-  const int num_dofs_g = x_dofmap.num_links(0);
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
-      = mesh.geometry().x();
+    // Add element vectors to global vector
+    for (int l = 0; l < n; ++l)
+    {
+      auto dofs = dofmap.links(cells[l]);
+      for (Eigen::Index i = 0; i < dofs.size(); ++i)
+        for (int k = 0; k < bs; ++k)
+          b[bs * dofs[i] + k] += bb[(bs * i + k) * batch_size + l];
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename Kernel>
+void assemble_interior_facets(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const mesh::Mesh& mesh,
+    const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
+        facets,
+    const fem::DofMap& dofmap, const Kernel& fn,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const std::vector<int>& offsets,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
+    const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms)
+{
+  // Prepare cell geometry
+  impl::CellCoordinates cell_coordinates(mesh.geometry());
+  const int num_dofs_g = cell_coordinates.num_dofs();
+  const int gdim = cell_coordinates.dim();
+  const int bs = dofmap.bs();
 
   // Creat data structures used in assembly
-  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      coordinate_dofs(2 * num_dofs_g, gdim);
-  Eigen::Matrix<T, Eigen::Dynamic, 1> be;
+  common::aligned_vector<double> coordinate_dofs(
+      common::padded_size<double>(2 * num_dofs_g * gdim), 0);
+  ElementTensor<T> be;
   Eigen::Array<T, Eigen::Dynamic, 1> coeff_array(2 * offsets.back());
   assert(offsets.back() == coeffs.cols());
 
-  auto f_to_c = mesh.topology().connectivity(tdim - 1, tdim);
-  assert(f_to_c);
-  auto c_to_f = mesh.topology().connectivity(tdim, tdim - 1);
-  assert(c_to_f);
-  for (const auto& f : active_facets)
+  for (Eigen::Index index = 0; index < facets.size(); index += 4)
   {
-    // Get attached cell indices
-    auto cells = f_to_c->links(f);
-    assert(cells.rows() == 2);
-
-    // Create attached cells
-    std::array<int, 2> local_facet;
-    for (int i = 0; i < 2; ++i)
-    {
-      auto facets = c_to_f->links(cells[i]);
-      const auto* it
-          = std::find(facets.data(), facets.data() + facets.rows(), f);
-      assert(it != (facets.data() + facets.rows()));
-      local_facet[i] = std::distance(facets.data(), it);
-    }
+    // Get attached cells and local index of facet with respect to each
+    // cell
+    const std::array cells{facets[index], facets[index + 2]};
+    const std::array<int, 2> local_facet{facets[index + 1],
+                                         facets[index + 3]};
 
     // Get cell geometry
-    auto x_dofs0 = x_dofmap.links(cells[0]);
-    auto x_dofs1 = x_dofmap.links(cells[1]);
-    for (int i = 0; i < num_dofs_g; ++i)
-    {
-      for (int j = 0; j < gdim; ++j)
-      {
-        coordinate_dofs(i, j) = x_g(x_dofs0[i], j);
-        coordinate_dofs(i + num_dofs_g, j) = x_g(x_dofs1[i], j);
-      }
-    }
+    std::copy_n(cell_coordinates(cells[0]), num_dofs_g * gdim,
+                coordinate_dofs.data());
+    std::copy_n(cell_coordinates(cells[1]), num_dofs_g * gdim,
+                coordinate_dofs.data() + num_dofs_g * gdim);
 
-    // Get dofmaps for cell
-    auto dmap0 = dofmap.cell_dofs(cells[0]);
-    auto dmap1 = dofmap.cell_dofs(cells[1]);
+    // Get dofmaps (blocks) for cell
+    auto dmap0 = dofmap.list_blocked().links(cells[0]);
+    auto dmap1 = dofmap.list_blocked().links(cells[1]);
 
     // Layout for the restricted coefficients is flattened
     // w[coefficient][restriction][dof]
@@ -700,7 +1104,7 @@ void assemble_interior_facets(
     }
 
     // Tabulate element vector
-    be.setZero(dmap0.size() + dmap1.size());
+    be.set_zero(bs * (dmap0.size() + dmap1.size()), 1);
 
     const std::array perm{perms(local_facet[0], cells[0]),
                           perms(local_facet[1], cells[1])};
@@ -710,9 +1114,41 @@ void assemble_interior_facets(
 
     // Add element vector to global vector
     for (Eigen::Index i = 0; i < dmap0.size(); ++i)
-      b[dmap0[i]] += be[i];
+      for (int k = 0; k < bs; ++k)
+        b[bs * dmap0[i] + k] += be.data()[bs * i + k];
     for (Eigen::Index i = 0; i < dmap1.size(); ++i)
-      b[dmap1[i]] += be[i + dmap0.size()];
+      for (int k = 0; k < bs; ++k)
+        b[bs * dmap1[i] + k] += be.data()[bs * (i + dmap0.size()) + k];
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T, typename Kernel>
+void assemble_interior_facets_threaded(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const mesh::Mesh& mesh,
+    const graph::AdjacencyList<std::int32_t>& colouring, int num_threads,
+    const fem::DofMap& dofmap, const Kernel& fn,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const std::vector<int>& offsets,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& constant_values,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
+    const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>& perms)
+{
+  // Build the geometry cell coordinate cache (if enabled) before
+  // threads access it
+  mesh.geometry().cell_coordinates();
+
+  // The links of a colour hold four values per facet
+  for (std::int32_t colour = 0; colour < colouring.num_nodes(); ++colour)
+  {
+    auto facets = colouring.links(colour);
+    common::parallel_for(
+        num_threads, facets.rows() / 4,
+        [&](int, std::int32_t f0, std::int32_t f1) {
+          impl::assemble_interior_facets<T>(
+              b, mesh, facets.segment(4 * f0, 4 * (f1 - f0)), dofmap, fn,
+              coeffs, offsets, constant_values, cell_info, perms);
+        });
   }
 }
 //-----------------------------------------------------------------------------
@@ -752,17 +1188,32 @@ void apply_lifting(
           = map1->block_size() * (map1->size_local() + map1->num_ghosts());
       bc_markers1.assign(crange, false);
       bc_values1 = Eigen::Matrix<T, Eigen::Dynamic, 1>::Zero(crange);
+      std::vector<std::int32_t> bc_cells1;
       for (const std::shared_ptr<const DirichletBC<T>>& bc : bcs1[j])
       {
         bc->mark_dofs(bc_markers1);
         bc->dof_values(bc_values1);
+        const std::vector<std::int32_t>& cells = bc->cells();
+        bc_cells1.insert(bc_cells1.end(), cells.begin(), cells.end());
+      }
+      if (bcs1[j].size() > 1)
+      {
+        std::sort(bc_cells1.begin(), bc_cells1.end());
+        bc_cells1.erase(std::unique(bc_cells1.begin(), bc_cells1.end()),
+                        bc_cells1.end());
       }
 
       // Modify (apply lifting) vector
       if (!x0.empty())
-        lift_bc<T>(b, *a[j], bc_values1, bc_markers1, x0[j], scale);
+      {
+        lift_bc<T>(b, *a[j], bc_values1, bc_markers1, bc_cells1, x0[j],
+                   scale);
+      }
       else
-        lift_bc<T>(b, *a[j], bc_values1, bc_markers1, scale);
+      {
+        const Eigen::Matrix<T, Eigen::Dynamic, 1> zero(0);
+        lift_bc<T>(b, *a[j], bc_values1, bc_markers1, bc_cells1, zero, scale);
+      }
     }
   }
 }
@@ -774,10 +1225,22 @@ void lift_bc(
     const std::vector<bool>& bc_markers1, double scale)
 {
   const Eigen::Matrix<T, Eigen::Dynamic, 1> x0(0);
-  if (a.integrals().num_integrals(fem::IntegralType::cell) > 0)
-    _lift_bc_cells<T>(b, a, bc_values1, bc_markers1, x0, scale);
-  if (a.integrals().num_integrals(fem::IntegralType::exterior_facet) > 0)
-    _lift_bc_exterior_facets<T>(b, a, bc_values1, bc_markers1, x0, scale);
+  lift_bc<T>(b, a, bc_values1, bc_markers1, x0, scale);
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void lift_bc(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const Form<T>& a,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& bc_values1,
+    const std::vector<bool>& bc_markers1,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x0,
+    double scale)
+{
+  assert(a.function_space(1));
+  assert(a.function_space(1)->dofmap());
+  const std::vector<std::int32_t> bc_cells1
+      = cells_with_marked_dofs(*a.function_space(1)->dofmap(), bc_markers1);
+  lift_bc<T>(b, a, bc_values1, bc_markers1, bc_cells1, x0, scale);
 }
 //-----------------------------------------------------------------------------
 template <typename T>
@@ -785,13 +1248,19 @@ void lift_bc(
     Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const Form<T>& a,
     const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& bc_values1,
     const std::vector<bool>& bc_markers1,
+    const std::vector<std::int32_t>& bc_cells1,
     const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x0,
     double scale)
 {
+  if (bc_cells1.empty())
+    return;
   if (a.integrals().num_integrals(fem::IntegralType::cell) > 0)
-    _lift_bc_cells(b, a, bc_values1, bc_markers1, x0, scale);
+    _lift_bc_cells(b, a, bc_values1, bc_markers1, bc_cells1, x0, scale);
   if (a.integrals().num_integrals(fem::IntegralType::exterior_facet) > 0)
-    _lift_bc_exterior_facets(b, a, bc_values1, bc_markers1, x0, scale);
+  {
+    _lift_bc_exterior_facets(b, a, bc_values1, bc_markers1, bc_cells1, x0,
+                             scale);
+  }
 }
 //-----------------------------------------------------------------------------
 } // namespace dolfinx::fem::impl
@@ -8,15 +8,27 @@
 
 #include "assemble_matrix_impl.h"
 #include "assemble_scalar_impl.h"
+#include "assemble_system_impl.h"
 #include "assemble_vector_impl.h"
+#include "SumFactorisation.h"
 #include <Eigen/Dense>
+#include <array>
+#include <dolfinx/common/ExactSum.h>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/function/QuadratureData.h>
+#include <dolfinx/la/Vector.h>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace dolfinx
 {
 namespace function
 {
+template <typename T>
+class Function;
 class FunctionSpace;
 } // namespace function
 
@@ -40,6 +52,64 @@ T assemble_scalar(const Form<T>& M)
   return fem::impl::assemble_scalar(M);
 }
 
+/// Assemble functional into scalar using packed coefficients, e.g. to
+/// reuse the coefficients for several forms with the same
+/// coefficients. The caller is responsible for accumulation across
+/// processes.
+/// @param[in] M The form (functional) to assemble
+/// @param[in] coeffs The packed coefficients of M (see
+///   pack_coefficients)
+/// @return The contribution to the form (functional) from the local
+///   process
+template <typename T>
+T assemble_scalar(
+    const Form<T>& M,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs)
+{
+  return fem::impl::assemble_scalar(M, coeffs);
+}
+
+/// Assemble functional into scalar and sum the result across
+/// processes with a reproducible reduction. The contributions of the
+/// cells and facets are summed exactly (see common::ExactSum), on each
+/// thread and across threads and processes, and the exact sum is
+/// rounded once. The value is hence the same to the last bit for any
+/// number of threads and processes and any ordering of the cells,
+/// unlike the plain floating point sum of assemble_scalar. This is
+/// collective.
+/// @param[in] M The form (functional) to assemble
+/// @return The value of the form (functional), on all processes
+template <typename T>
+T assemble_scalar_reproducible(const Form<T>& M)
+{
+  common::ExactSum<T> value
+      = fem::impl::assemble_scalar<T, common::ExactSum<T>>(M);
+  assert(M.mesh());
+  value.allreduce(M.mesh()->mpi_comm());
+  return value.value();
+}
+
+/// Assemble several functionals into scalars and sum the results
+/// across processes. Integrals over the same mesh and domain share the
+/// access to the cell geometry, and the process contributions of all
+/// functionals are summed in a single collective reduction. All forms
+/// must be defined on meshes with the same communicator.
+/// @param[in] M The forms (functionals) to assemble
+/// @return The values of the forms (functionals), on all processes
+template <typename T>
+std::vector<T> assemble_scalars(const std::vector<const Form<T>*>& M)
+{
+  std::vector<T> values = fem::impl::assemble_scalars(M);
+  if (!M.empty())
+  {
+    assert(M[0]->mesh());
+    MPI_Allreduce(MPI_IN_PLACE, values.data(), values.size(),
+                  MPI::mpi_type<T>(), MPI_SUM, M[0]->mesh()->mpi_comm());
+  }
+  return values;
+}
+
 // -- Vectors ----------------------------------------------------------------
 
 /// Assemble linear form into an Eigen vector
@@ -53,6 +123,95 @@ void assemble_vector(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
   fem::impl::assemble_vector(b, L);
 }
 
+/// Assemble linear form into an Eigen vector using packed coefficients
+/// @param[in,out] b The Eigen vector to be assembled. It will not be
+///   zeroed before assembly.
+/// @param[in] L The linear forms to assemble into b
+/// @param[in] coeffs The packed coefficients of L (see
+///   pack_coefficients)
+template <typename T>
+void assemble_vector(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b, const Form<T>& L,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs)
+{
+  fem::impl::assemble_vector(b, L, coeffs);
+}
+
+/// Assemble linear forms into Eigen vectors, one vector per form. This
+/// is equivalent to calling assemble_vector for each form, but reduces
+/// the overhead of many calls for small forms, e.g. from Python.
+/// @param[in,out] b The vectors (owned and ghost entries), one for each
+///   form. They are not zeroed before assembly.
+/// @param[in] L The linear forms
+template <typename T>
+void assemble_vectors(
+    const std::vector<Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>>>& b,
+    const std::vector<const Form<T>*>& L)
+{
+  if (b.size() != L.size())
+    throw std::runtime_error("Number of vectors and forms do not match.");
+
+  for (std::size_t i = 0; i < L.size(); ++i)
+  {
+    assert(L[i]);
+    std::shared_ptr<const common::IndexMap> map
+        = L[i]->function_spaces().at(0)->dofmap()->index_map;
+    if (b[i].rows()
+        != map->block_size() * (map->size_local() + map->num_ghosts()))
+    {
+      throw std::runtime_error("Size of vector " + std::to_string(i)
+                               + " does not match the linear form.");
+    }
+  }
+
+  for (std::size_t i = 0; i < L.size(); ++i)
+    fem::impl::assemble_vector(b[i], *L[i]);
+}
+
+/// Assemble linear form into a distributed vector and sum the ghost
+/// contributions into the owning processes (collective). The reverse
+/// scatter of the ghost contributions is overlapped with the assembly
+/// of the cells that have only owned dofs.
+/// @param[in,out] b The vector. Owned entries are not zeroed. Ghost
+///   entries are overwritten.
+/// @param[in] L The linear form to assemble into b
+template <typename T>
+void assemble_vector(la::Vector<T>& b, const Form<T>& L)
+{
+  fem::impl::assemble_vector_overlap(
+      b, L, pack_coefficients(L),
+      [](Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>>) {});
+}
+
+/// Assemble linear form into a distributed vector, modify it for
+/// boundary conditions as in apply_lifting, and sum the ghost
+/// contributions into the owning processes (collective). The reverse
+/// scatter of the ghost contributions is overlapped with the assembly
+/// of the cells that have only owned dofs.
+/// @param[in,out] b The vector. Owned entries are not zeroed. Ghost
+///   entries are overwritten.
+/// @param[in] L The linear form to assemble into b
+/// @param[in] a The bilinear forms for lifting (see apply_lifting)
+/// @param[in] bcs1 The boundary conditions on the trial spaces of @p a
+/// @param[in] x0 The vectors x0_j (see apply_lifting)
+/// @param[in] scale The scaling of the lifting
+template <typename T>
+void assemble_vector(
+    la::Vector<T>& b, const Form<T>& L,
+    const std::vector<std::shared_ptr<const Form<T>>>& a,
+    const std::vector<std::vector<std::shared_ptr<const DirichletBC<T>>>>& bcs1,
+    const std::vector<Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>>&
+        x0,
+    double scale)
+{
+  fem::impl::assemble_vector_overlap(
+      b, L, pack_coefficients(L),
+      [&](Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> _b) {
+        fem::impl::apply_lifting(_b, a, bcs1, x0, scale);
+      });
+}
+
 // FIXME: clarify how x0 is used
 // FIXME: if bcs entries are set
 
@@ -85,50 +244,87 @@ void apply_lifting(
 
 // -- Matrices ---------------------------------------------------------------
 
-// Experimental
-/// Assemble bilinear form into a matrix
-/// @param[in] mat_add The function for adding values into the matrix
-/// @param[in] a The bilinear from to assemble
-/// @param[in] bcs Boundary conditions to apply. For boundary condition
-///  dofs the row and column are zeroed. The diagonal  entry is not set.
+namespace impl
+{
+/// Build the Dirichlet boundary condition markers of a function space.
+/// The markers are empty if no boundary condition applies to the
+/// space. The cell markers are built from the cells cached by the
+/// boundary conditions (see DirichletBC::cells).
 template <typename T>
-void assemble_matrix(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_add,
-    const Form<T>& a,
-    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+BCMarkers
+bc_markers(const function::FunctionSpace& V,
+           const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
 {
-
-  // Index maps for dof ranges
-  auto map0 = a.function_space(0)->dofmap()->index_map;
-  auto map1 = a.function_space(1)->dofmap()->index_map;
-
-  // Build dof markers
-  std::vector<bool> dof_marker0, dof_marker1;
-  std::int32_t dim0
-      = map0->block_size() * (map0->size_local() + map0->num_ghosts());
-  std::int32_t dim1
-      = map1->block_size() * (map1->size_local() + map1->num_ghosts());
+  BCMarkers markers;
+  std::shared_ptr<const DofMap> dofmap = V.dofmap();
+  std::shared_ptr<const common::IndexMap> map = dofmap->index_map;
+  const std::int32_t dim
+      = map->block_size() * (map->size_local() + map->num_ghosts());
   for (std::size_t k = 0; k < bcs.size(); ++k)
   {
     assert(bcs[k]);
     assert(bcs[k]->function_space());
-    if (a.function_space(0)->contains(*bcs[k]->function_space()))
-    {
-      dof_marker0.resize(dim0, false);
-      bcs[k]->mark_dofs(dof_marker0);
-    }
-    if (a.function_space(1)->contains(*bcs[k]->function_space()))
+    if (V.contains(*bcs[k]->function_space()))
     {
-      dof_marker1.resize(dim1, false);
-      bcs[k]->mark_dofs(dof_marker1);
+      markers.dofs.resize(dim, 0);
+      markers.cells.resize(dofmap->list_blocked().num_nodes(), 0);
+      bcs[k]->mark_dofs(markers.dofs);
+      for (std::int32_t c : bcs[k]->cells())
+        markers.cells[c] = 1;
     }
   }
 
-  // Assemble
+  return markers;
+}
+
+/// Build the row (0) and column (1) Dirichlet boundary condition
+/// markers of a bilinear form, see bc_markers above
+template <typename T>
+std::array<BCMarkers, 2>
+bc_markers(const Form<T>& a,
+           const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+{
+  return {bc_markers(*a.function_space(0), bcs),
+          bc_markers(*a.function_space(1), bcs)};
+}
+} // namespace impl
+
+// Experimental
+/// Assemble bilinear form into a matrix
+/// @param[in] mat_add The function for adding values into the matrix.
+///   Any callable with the signature int(std::int32_t, const
+///   std::int32_t*, std::int32_t, const std::int32_t*, const T*) can be
+///   used. It is a template parameter so that it can be inlined.
+/// @param[in] a The bilinear from to assemble
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+///  dofs the row and column are zeroed. The diagonal  entry is not set.
+template <typename T, typename U>
+void assemble_matrix(
+    const U& mat_add, const Form<T>& a,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+{
+  const auto [dof_marker0, dof_marker1] = impl::bc_markers(a, bcs);
   impl::assemble_matrix(mat_add, a, dof_marker0, dof_marker1);
 }
 
+/// Assemble bilinear form into a matrix using packed coefficients
+/// @param[in] mat_add The function for adding values into the matrix
+/// @param[in] a The bilinear from to assemble
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+///  dofs the row and column are zeroed. The diagonal  entry is not set.
+/// @param[in] coeffs The packed coefficients of a (see
+///   pack_coefficients)
+template <typename T, typename U>
+void assemble_matrix(
+    const U& mat_add, const Form<T>& a,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs)
+{
+  const auto [dof_marker0, dof_marker1] = impl::bc_markers(a, bcs);
+  impl::assemble_matrix(mat_add, a, coeffs, dof_marker0, dof_marker1);
+}
+
 /// Assemble bilinear form into a matrix. Matrix must already be
 /// initialised. Does not zero or finalise the matrix.
 /// @param[in] mat_add The function for adding values into the matrix
@@ -139,15 +335,16 @@ void assemble_matrix(
 /// @param[in] dof_marker1 Boundary condition markers for the columns.
 ///   If bc[i] is true then rows i in A will be zeroed. The index i is a
 ///   local index.
-template <typename T>
-void assemble_matrix(
-    const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
-                            const std::int32_t*, const T*)>& mat_add,
-    const Form<T>& a, const std::vector<bool>& dof_marker0,
-    const std::vector<bool>& dof_marker1)
+template <typename T, typename U>
+void assemble_matrix(const U& mat_add, const Form<T>& a,
+                     const std::vector<bool>& dof_marker0,
+                     const std::vector<bool>& dof_marker1)
 
 {
-  impl::assemble_matrix(mat_add, a, dof_marker0, dof_marker1);
+  impl::assemble_matrix(
+      mat_add, a,
+      create_bc_markers(*a.function_space(0)->dofmap(), dof_marker0),
+      create_bc_markers(*a.function_space(1)->dofmap(), dof_marker1));
 }
 
 /// Adds a value to the diagonal of a matrix for specified rows. It is
@@ -205,6 +402,302 @@ void add_diagonal(
   }
 }
 
+// -- Systems ----------------------------------------------------------------
+
+/// Assemble a bilinear form into a matrix and a linear form into a
+/// vector in a single pass over the cells, with lifting of the
+/// boundary conditions such that
+///
+///   b <- b + L - scale * A (g - x0)
+///
+/// where g holds the boundary condition values. This is equivalent to
+/// assemble_matrix, assemble_vector and apply_lifting, but the
+/// geometry of each cell is gathered once, the coefficients are packed
+/// once per form and the lifting is computed from the element matrix
+/// of each cell. The matrix is not finalised, its diagonal is not set
+/// (see add_diagonal), the ghost contributions to b are not sent to
+/// the owner and the boundary condition rows of b are not set (see
+/// set_bc).
+/// @param[in] mat_add The function for adding values into the matrix,
+///   see assemble_matrix
+/// @param[in,out] b The vector (owned and ghost entries). It is not
+///   zeroed before assembly.
+/// @param[in] a The bilinear form
+/// @param[in] L The linear form, with the same test space as @p a
+/// @param[in] bcs Boundary conditions to apply
+/// @param[in] x0 The vector used in the lifting, typically the current
+///   solution in a Newton method. If empty, it is treated as zero.
+/// @param[in] scale The scaling of the lifting
+/// @param[in] symmetric If true, the rows and columns of boundary
+///   condition dofs are zeroed and the boundary conditions are lifted,
+///   so that the matrix is symmetric if a is symmetric. If false, only
+///   the rows are zeroed and no lifting is applied.
+template <typename T, typename U>
+void assemble_system(
+    const U& mat_add, Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> b,
+    const Form<T>& a, const Form<T>& L,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x0,
+    double scale = 1.0, bool symmetric = true)
+{
+  const BCMarkers bc0 = impl::bc_markers(*a.function_space(0), bcs);
+  BCMarkers bc1;
+  Eigen::Matrix<T, Eigen::Dynamic, 1> bc_values1;
+  if (symmetric)
+  {
+    bc1 = impl::bc_markers(*a.function_space(1), bcs);
+    if (!bc1.dofs.empty())
+    {
+      bc_values1 = Eigen::Matrix<T, Eigen::Dynamic, 1>::Zero(bc1.dofs.size());
+      for (const std::shared_ptr<const DirichletBC<T>>& bc : bcs)
+      {
+        if (a.function_space(1)->contains(*bc->function_space()))
+          bc->dof_values(bc_values1);
+      }
+    }
+  }
+
+  impl::assemble_system<T>(mat_add, b, a, L, bc0, bc1, bc_values1, x0, scale);
+}
+
+// -- Matrix-free ------------------------------------------------------------
+
+/// Compute y += A x, where A is the matrix of the bilinear form a, cell
+/// by cell without storing A. The element matrices are computed with
+/// the form kernels and multiplied with the local entries of x.
+/// @param[in,out] y The vector for the test space, with owned and ghost
+///   entries. It is not zeroed. Ghost contributions are not sent to the
+///   owner.
+/// @param[in] a The bilinear form
+/// @param[in] x The vector for the trial space, with owned and
+///   (up-to-date) ghost entries
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+///   dofs the row and column of A are zeroed. The diagonal entry is not
+///   set.
+template <typename T>
+void assemble_action(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> y, const Form<T>& a,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+{
+  const auto [dof_marker0, dof_marker1] = impl::bc_markers(a, bcs);
+  impl::assemble_action<T>(y, a, x, dof_marker0, dof_marker1);
+}
+
+/// Compute the owned entries of y += A u, where A is the matrix of the
+/// bilinear form a, without storing A. Ghost contributions are summed
+/// into the owning processes via the index map of y (collective).
+/// @param[in] a The bilinear form
+/// @param[in] u The function in the trial space of @p a. Its ghost
+///   entries must be up-to-date.
+/// @param[in,out] y The vector for the test space of @p a. Owned
+///   entries are not zeroed. Ghost entries are overwritten.
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+///   dofs the row and column of A are zeroed. The diagonal entry is not
+///   set.
+template <typename T>
+void assemble_action(
+    const Form<T>& a, const function::Function<T>& u, la::Vector<T>& y,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+{
+  assert(u.x());
+  assert(y.map());
+  const std::int32_t size_owned
+      = y.map()->block_size() * y.map()->size_local();
+  Eigen::Matrix<T, Eigen::Dynamic, 1>& _y = y.array();
+  _y.tail(_y.size() - size_owned).setZero();
+  fem::assemble_action<T>(_y, a, u.x()->array(), bcs);
+  y.scatter_rev(common::IndexMap::Mode::add);
+}
+
+/// Add the diagonal of the matrix A of the bilinear form a to d without
+/// storing A, e.g. for Jacobi or Chebyshev smoothing in matrix-free
+/// solvers. The test and trial spaces of @p a must be the same.
+/// @param[in,out] d The vector for the test space, with owned and ghost
+///   entries. It is not zeroed. Ghost contributions are not sent to the
+///   owner.
+/// @param[in] a The bilinear form
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+///   dofs the row and column of A are zeroed. The diagonal entry is not
+///   set.
+template <typename T>
+void assemble_diagonal(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> d, const Form<T>& a,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+{
+  if (!(*a.function_space(0) == *a.function_space(1)))
+  {
+    throw std::runtime_error(
+        "Diagonal assembly requires the same test and trial space.");
+  }
+  const auto [dof_marker0, dof_marker1] = impl::bc_markers(a, bcs);
+  impl::assemble_diagonal<T>(d, a, dof_marker0, dof_marker1);
+}
+
+/// Compute the owned entries of the diagonal of the matrix A of the
+/// bilinear form a without storing A or a sparsity pattern. Ghost
+/// contributions are summed into the owning processes via the index
+/// map of d (collective). The test and trial spaces of @p a must be
+/// the same.
+/// @param[in] a The bilinear form
+/// @param[in,out] d The vector for the test space of @p a. Owned
+///   entries are not zeroed. Ghost entries are overwritten.
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+///   dofs the row and column of A are zeroed. The diagonal entry is not
+///   set.
+template <typename T>
+void assemble_diagonal(
+    const Form<T>& a, la::Vector<T>& d,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+{
+  assert(d.map());
+  const std::int32_t size_owned
+      = d.map()->block_size() * d.map()->size_local();
+  Eigen::Matrix<T, Eigen::Dynamic, 1>& _d = d.array();
+  _d.tail(_d.size() - size_owned).setZero();
+  fem::assemble_diagonal<T>(_d, a, bcs);
+  d.scatter_rev(common::IndexMap::Mode::add);
+}
+
+/// Add the row sums of the matrix A of the bilinear form a (the lumped
+/// diagonal, e.g. of a mass matrix for explicit dynamics) to d without
+/// storing A.
+/// @param[in,out] d The vector for the test space, with owned and ghost
+///   entries. It is not zeroed. Ghost contributions are not sent to the
+///   owner.
+/// @param[in] a The bilinear form
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+///   dofs the row and column of A are zeroed before the rows are
+///   summed.
+template <typename T>
+void assemble_lumped(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> d, const Form<T>& a,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+{
+  const auto [dof_marker0, dof_marker1] = impl::bc_markers(a, bcs);
+  impl::assemble_lumped<T>(d, a, dof_marker0, dof_marker1);
+}
+
+/// Compute the owned entries of the row sums of the matrix A of the
+/// bilinear form a without storing A or a sparsity pattern. Ghost
+/// contributions are summed into the owning processes via the index
+/// map of d (collective).
+/// @param[in] a The bilinear form
+/// @param[in,out] d The vector for the test space of @p a. Owned
+///   entries are not zeroed. Ghost entries are overwritten.
+/// @param[in] bcs Boundary conditions to apply, see assemble_lumped
+template <typename T>
+void assemble_lumped(
+    const Form<T>& a, la::Vector<T>& d,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+{
+  assert(d.map());
+  const std::int32_t size_owned
+      = d.map()->block_size() * d.map()->size_local();
+  Eigen::Matrix<T, Eigen::Dynamic, 1>& _d = d.array();
+  _d.tail(_d.size() - size_owned).setZero();
+  fem::assemble_lumped<T>(_d, a, bcs);
+  d.scatter_rev(common::IndexMap::Mode::add);
+}
+
+/// Compute y += A x, where A is the matrix of a sum-factorised
+/// operator, without storing A. See assemble_action for bilinear forms
+/// for the layout of x and y.
+/// @param[in,out] y The vector for the test space, with owned and ghost
+///   entries. Ghost contributions are not sent to the owner.
+/// @param[in] a The operator
+/// @param[in] x The vector for the trial space, with owned and
+///   (up-to-date) ghost entries
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+///   dofs the row and column of A are zeroed. The diagonal entry is not
+///   set.
+template <typename T>
+void assemble_action(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> y,
+    const SumFactorisedOperator<T>& a,
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& x,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+{
+  assert(a.function_space());
+  a.apply(y, x, impl::bc_markers(*a.function_space(), bcs));
+}
+
+/// Add the diagonal of the matrix A of a sum-factorised operator to d
+/// without storing A. See assemble_diagonal for bilinear forms.
+/// @param[in,out] d The vector, with owned and ghost entries. Ghost
+///   contributions are not sent to the owner.
+/// @param[in] a The operator
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+///   dofs the row and column of A are zeroed. The diagonal entry is not
+///   set.
+template <typename T>
+void assemble_diagonal(
+    Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> d,
+    const SumFactorisedOperator<T>& a,
+    const std::vector<std::shared_ptr<const DirichletBC<T>>>& bcs)
+{
+  assert(a.function_space());
+  a.diagonal(d, impl::bc_markers(*a.function_space(), bcs));
+}
+
+// -- Quadrature data --------------------------------------------------------
+
+/// Update quadrature data in place by executing the cell kernels of a
+/// form. For each cell of each cell integral, the kernel is called with
+/// the row of @p q for the cell as the output (element tensor) array,
+/// so that the kernel writes the new values at the quadrature points.
+/// The coefficients are packed before the update, so @p q may itself
+/// be a coefficient of the form, in which case the kernel receives the
+/// previous values. Ghost cells are not updated unless they are in the
+/// integral domains.
+/// @param[in,out] q The quadrature data
+/// @param[in] form The form whose cell kernels compute the values. The
+///   size of the kernel output must be the number of values per cell
+///   of @p q.
+template <typename T>
+void update_quadrature_data(function::QuadratureData<T>& q,
+                            const Form<T>& form)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = form.mesh();
+  assert(mesh);
+  if (mesh.get() != q.mesh().get())
+  {
+    throw std::runtime_error(
+        "Quadrature data and form are not defined on the same mesh.");
+  }
+  if (!form.all_constants_set())
+    throw std::runtime_error("Unset constant in Form");
+
+  const Eigen::Array<T, Eigen::Dynamic, 1>& constants = pack_constants(form);
+  const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+      coeffs
+      = pack_coefficients(form);
+
+  const int tdim = mesh->topology().dim();
+  const std::int32_t num_cells
+      = mesh->topology().connectivity(tdim, 0)->num_nodes();
+  const FormIntegrals<T>& integrals = form.integrals();
+  const bool needs_permutation_data = integrals.needs_permutation_data();
+  if (needs_permutation_data)
+    mesh->topology_mutable().create_cell_permutation_info();
+  const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info
+      = needs_permutation_data
+            ? mesh->topology().get_cell_permutation_info()
+            : Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>(num_cells);
+
+  impl::CellCoordinates cell_coordinates(mesh->geometry());
+  typename function::QuadratureData<T>::array_type& values = q.values();
+  for (int i = 0; i < integrals.num_integrals(IntegralType::cell); ++i)
+  {
+    const auto& fn = integrals.get_tabulate_tensor(IntegralType::cell, i);
+    for (std::int32_t c : integrals.integral_domains(IntegralType::cell, i))
+    {
+      fn(values.row(c).data(), coeffs.row(c).data(), constants.data(),
+         cell_coordinates(c), nullptr, nullptr, cell_info[c]);
+    }
+  }
+}
+
 // -- Setting bcs ------------------------------------------------------------
 
 // FIXME: Move these function elsewhere?
@@ -284,6 +284,21 @@ Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
 fem::compute_dof_permutations(const mesh::Topology& topology,
                               const fem::ElementDofLayout& dof_layout)
 {
+  // Without base permutations that reorder the dofs, the permutation
+  // on each cell is the identity and the entity orderings are not
+  // required
+  const int D = topology.dim();
+  auto cells = topology.connectivity(D, 0);
+  assert(cells);
+  if (!dof_layout.needs_permutations())
+  {
+    Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> p(
+        cells->num_nodes(), dof_layout.num_dofs());
+    p.rowwise() = Eigen::Array<int, 1, Eigen::Dynamic>::LinSpaced(
+        dof_layout.num_dofs(), 0, dof_layout.num_dofs() - 1);
+    return p;
+  }
+
   // Build ordering in each cell. It stores the number of times each row
   // of _permutations should be applied on each cell Will have shape
   // (number of cells) × (number of permutations)
@@ -319,7 +334,7 @@ fem::compute_dof_permutations(const mesh::Topology& topology,
   // permutations) × (number of dofs on reference) where (number of
   // permutations) = (num_edges) for 2D cells and (num_edges + 2*num_faces)
   // for 3D cells
-  const Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+  const Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
       permutations = dof_layout.base_permutations();
   const int pcols = permutations.cols();
 
@@ -15,8 +15,11 @@ namespace dolfinx
 #include <dolfinx/fem/DirichletBC.h>
 #include <dolfinx/fem/DiscreteOperators.h>
 #include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/Expression.h>
 #include <dolfinx/fem/FiniteElement.h>
 #include <dolfinx/fem/Form.h>
 #include <dolfinx/fem/SparsityPatternBuilder.h>
+#include <dolfinx/fem/StaticCondensation.h>
+#include <dolfinx/fem/SumFactorisation.h>
 #include <dolfinx/fem/assembler.h>
 #include <dolfinx/fem/utils.h>
@@ -7,28 +7,504 @@
 #include "petsc.h"
 #include "SparsityPatternBuilder.h"
 #include "assembler.h"
+#include <algorithm>
+#include <chrono>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/TimeLogManager.h>
+#include <dolfinx/common/TimeLogger.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/fem/DofMap.h>
 #include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/la/Vector.h>
+#include <dolfinx/la/utils.h>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
 
 using namespace dolfinx;
 
+namespace
+{
+//-----------------------------------------------------------------------------
+// Get the diagonal and off-diagonal blocks of a (Seq or MPI) AIJ
+// matrix. For a SeqAIJ matrix the off-diagonal block is nullptr.
+std::tuple<Mat, Mat, const PetscInt*> get_aij_blocks(Mat A)
+{
+  PetscBool is_mpiaij = PETSC_FALSE, is_seqaij = PETSC_FALSE;
+  PetscObjectTypeCompare((PetscObject)A, MATMPIAIJ, &is_mpiaij);
+  PetscObjectTypeCompare((PetscObject)A, MATSEQAIJ, &is_seqaij);
+  Mat Ad = nullptr, Ao = nullptr;
+  const PetscInt* garray = nullptr;
+  if (is_mpiaij)
+  {
+    PetscErrorCode ierr = MatMPIAIJGetSeqAIJ(A, &Ad, &Ao, &garray);
+    if (ierr != 0)
+      la::petsc_error(ierr, __FILE__, "MatMPIAIJGetSeqAIJ");
+  }
+  else if (is_seqaij)
+    Ad = A;
+  else
+  {
+    throw std::runtime_error(
+        "Matrix position maps are supported for AIJ matrices only");
+  }
+
+  return {Ad, Ao, garray};
+}
+//-----------------------------------------------------------------------------
+// Key of the machine for stored assembly strategies: the host name of
+// rank 0, and the numbers of hardware threads and of processes
+std::string machine_key(MPI_Comm comm)
+{
+  std::array<char, 256> host = {};
+  gethostname(host.data(), host.size() - 1);
+  MPI_Bcast(host.data(), host.size(), MPI_CHAR, 0, comm);
+  return std::string(host.data()) + " "
+         + std::to_string(std::thread::hardware_concurrency()) + " "
+         + std::to_string(dolfinx::MPI::size(comm));
+}
+//-----------------------------------------------------------------------------
+// Key of a form for stored assembly strategies: the element signatures
+// of the spaces, the cell type and the integrals (ids and batch sizes)
+std::string form_key(const fem::Form<PetscScalar>& a)
+{
+  std::string key = mesh::to_string(a.mesh()->topology().cell_type());
+  for (int i = 0; i < a.rank(); ++i)
+    key += " " + a.function_space(i)->element()->signature();
+  const fem::FormIntegrals<PetscScalar>& integrals = a.integrals();
+  for (auto type : {fem::IntegralType::cell, fem::IntegralType::exterior_facet,
+                    fem::IntegralType::interior_facet})
+  {
+    key += " |";
+    const std::vector<int> ids = integrals.integral_ids(type);
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+      key += " " + std::to_string(ids[i]) + ":"
+             + std::to_string(integrals.batch_size(type, i));
+    }
+  }
+  return key;
+}
+//-----------------------------------------------------------------------------
+// Matrix inserter that adds cell element matrices directly to the
+// values of an AIJ matrix using precomputed positions. Unowned rows and
+// entries that are not identified by a cell are added via
+// MatSetValuesLocal.
+class PositionMapInserter
+{
+public:
+  PositionMapInserter(Mat A, const fem::MatrixPositionMap& map,
+                      PetscScalar* values_diag, PetscScalar* values_offdiag)
+      : _map(map), _values_diag(values_diag),
+        _values_offdiag(values_offdiag),
+        _mat_add(la::PETScMatrix::add_fn(A))
+  {
+    // Do nothing
+  }
+
+  // Add block of values
+  int operator()(std::int32_t m, const std::int32_t* rows, std::int32_t n,
+                 const std::int32_t* cols, const PetscScalar* vals) const
+  {
+    return _mat_add(m, rows, n, cols, vals);
+  }
+
+  // Add element matrix of cell c
+  int operator()(std::int32_t c, std::int32_t m, const std::int32_t* rows,
+                 std::int32_t n, const std::int32_t* cols,
+                 const PetscScalar* vals) const
+  {
+    auto pos = _map.positions.links(c);
+    assert(pos.rows() == m * n);
+    const std::int32_t num_diag = _map.num_diagonal;
+    for (std::int32_t i = 0; i < m; ++i)
+    {
+      const std::int32_t* pos_i = pos.data() + i * n;
+      const PetscScalar* vals_i = vals + i * n;
+      if (pos_i[0] < 0)
+        _mat_add(1, rows + i, n, cols, vals_i);
+      else
+      {
+        for (std::int32_t j = 0; j < n; ++j)
+        {
+          if (const std::int32_t p = pos_i[j]; p < num_diag)
+            _values_diag[p] += vals_i[j];
+          else
+            _values_offdiag[p - num_diag] += vals_i[j];
+        }
+      }
+    }
+    return 0;
+  }
+
+private:
+  const fem::MatrixPositionMap& _map;
+  PetscScalar* _values_diag;
+  PetscScalar* _values_offdiag;
+  std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
+                    const std::int32_t*, const PetscScalar*)>
+      _mat_add;
+};
+//-----------------------------------------------------------------------------
+// Context of a matrix-free (MATSHELL) operator. The action (y += A x)
+// and diagonal (y += diag(A)) callbacks hold the operator and boundary
+// condition markers. The work vectors hold the owned and ghost entries
+// of the trial (x) and test (y) space.
+struct MatrixFreeContext
+{
+  using Array = Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>;
+  std::function<void(Eigen::Ref<Array>, const Eigen::Ref<const Array>&)>
+      action;
+  std::function<void(Eigen::Ref<Array>)> get_diagonal;
+  std::vector<std::int32_t> bc_rows;
+  PetscScalar diagonal;
+  la::Vector<PetscScalar> x, y;
+};
+//-----------------------------------------------------------------------------
+MatrixFreeContext& get_context(Mat A)
+{
+  void* ctx = nullptr;
+  PetscErrorCode ierr = MatShellGetContext(A, &ctx);
+  if (ierr != 0)
+    la::petsc_error(ierr, __FILE__, "MatShellGetContext");
+  assert(ctx);
+  return *static_cast<MatrixFreeContext*>(ctx);
+}
+//-----------------------------------------------------------------------------
+// Sum the ghost entries of the work vector y into the owners and copy
+// the owned entries into z. Boundary condition rows are set to the
+// diagonal value times the entries of b.
+void finalise_shell_output(MatrixFreeContext& ctx, Vec z,
+                           const PetscScalar* b)
+{
+  ctx.y.scatter_rev(common::IndexMap::Mode::add);
+  PetscScalar* _z = nullptr;
+  VecGetArray(z, &_z);
+  PetscInt n = 0;
+  VecGetLocalSize(z, &n);
+  std::copy(ctx.y.array().data(), ctx.y.array().data() + n, _z);
+  for (std::int32_t row : ctx.bc_rows)
+    _z[row] = b ? ctx.diagonal * b[row] : ctx.diagonal;
+  VecRestoreArray(z, &_z);
+}
+//-----------------------------------------------------------------------------
+PetscErrorCode mat_mult_shell(Mat A, Vec x, Vec y)
+{
+  MatrixFreeContext& ctx = get_context(A);
+
+  // Copy owned entries of x and update ghosts
+  const PetscScalar* _x = nullptr;
+  VecGetArrayRead(x, &_x);
+  PetscInt n = 0;
+  VecGetLocalSize(x, &n);
+  std::copy(_x, _x + n, ctx.x.array().data());
+  ctx.x.scatter_fwd();
+
+  ctx.y.array().setZero();
+  ctx.action(ctx.y.array(), ctx.x.array());
+  finalise_shell_output(ctx, y, ctx.x.array().data());
+  VecRestoreArrayRead(x, &_x);
+
+  return 0;
+}
+//-----------------------------------------------------------------------------
+PetscErrorCode mat_get_diagonal_shell(Mat A, Vec d)
+{
+  MatrixFreeContext& ctx = get_context(A);
+  ctx.y.array().setZero();
+  ctx.get_diagonal(ctx.y.array());
+  finalise_shell_output(ctx, d, nullptr);
+  return 0;
+}
+//-----------------------------------------------------------------------------
+PetscErrorCode mat_destroy_shell(Mat A)
+{
+  delete &get_context(A);
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// Get the owned dofs of the boundary conditions on V
+std::vector<std::int32_t> bc_rows(
+    const function::FunctionSpace& V,
+    const std::vector<std::shared_ptr<const fem::DirichletBC<PetscScalar>>>&
+        bcs)
+{
+  std::vector<std::int32_t> rows;
+  for (const auto& bc : bcs)
+  {
+    assert(bc);
+    if (V.contains(*bc->function_space()))
+    {
+      auto dofs = bc->dofs_owned().col(0);
+      rows.insert(rows.end(), dofs.data(), dofs.data() + dofs.rows());
+    }
+  }
+  return rows;
+}
+//-----------------------------------------------------------------------------
+// Create a MATSHELL operator that takes ownership of the context. The
+// diagonal is supported if the context has a diagonal callback.
+la::PETScOperator create_shell(MPI_Comm comm, const common::IndexMap& map0,
+                               const common::IndexMap& map1,
+                               MatrixFreeContext* ctx)
+{
+  const int bs0 = map0.block_size();
+  const int bs1 = map1.block_size();
+  Mat A = nullptr;
+  PetscErrorCode ierr = MatCreateShell(
+      comm, bs0 * map0.size_local(), bs1 * map1.size_local(),
+      bs0 * map0.size_global(), bs1 * map1.size_global(), ctx, &A);
+  if (ierr != 0)
+  {
+    delete ctx;
+    la::petsc_error(ierr, __FILE__, "MatCreateShell");
+  }
+
+  MatShellSetOperation(A, MATOP_MULT, (void (*)(void))mat_mult_shell);
+  MatShellSetOperation(A, MATOP_DESTROY, (void (*)(void))mat_destroy_shell);
+  if (ctx->get_diagonal)
+  {
+    MatShellSetOperation(A, MATOP_GET_DIAGONAL,
+                         (void (*)(void))mat_get_diagonal_shell);
+  }
+
+  return la::PETScOperator(A, false);
+}
+//-----------------------------------------------------------------------------
+// Create a copy of a dofmap with the (unrolled) dofs renumbered to the
+// local indices of a stacked sparsity pattern, with the owned dofs
+// from offset and the ghost dofs from ghost_offset
+std::shared_ptr<const fem::DofMap>
+create_stacked_dofmap(const fem::DofMap& dofmap,
+                      std::shared_ptr<const common::IndexMap> stacked_map,
+                      std::int32_t offset, std::int32_t ghost_offset)
+{
+  assert(dofmap.index_map);
+  const std::int32_t size_local
+      = dofmap.index_map->block_size() * dofmap.index_map->size_local();
+  const graph::AdjacencyList<std::int32_t>& list = dofmap.list();
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> dofs = list.array();
+  for (Eigen::Index i = 0; i < dofs.rows(); ++i)
+  {
+    dofs[i] = dofs[i] < size_local ? offset + dofs[i]
+                                   : ghost_offset + dofs[i] - size_local;
+  }
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets = list.offsets();
+  return std::make_shared<fem::DofMap>(
+      dofmap.element_dof_layout, stacked_map,
+      graph::AdjacencyList<std::int32_t>(std::move(dofs), std::move(offsets)),
+      1);
+}
+//-----------------------------------------------------------------------------
+// Insert the entries of the blocks of a block system into sparsity
+// patterns, with one pass over the cells and over the interior and
+// exterior facets for all blocks (see
+// fem::SparsityPatternBuilder::cells)
+void build_block_sparsity_patterns(
+    const mesh::Mesh& mesh,
+    const Eigen::Ref<
+        const Eigen::Array<const fem::Form<PetscScalar>*, Eigen::Dynamic,
+                           Eigen::Dynamic, Eigen::RowMajor>>& a,
+    const std::vector<std::vector<la::SparsityPattern*>>& patterns,
+    const std::array<std::vector<const fem::DofMap*>, 2>& dofmaps)
+{
+  // The patterns of the blocks with integrals of each type
+  std::map<fem::IntegralType, std::vector<std::vector<la::SparsityPattern*>>>
+      type_patterns;
+  for (int i = 0; i < a.rows(); ++i)
+  {
+    for (int j = 0; j < a.cols(); ++j)
+    {
+      if (!a(i, j))
+        continue;
+      for (auto type : a(i, j)->integrals().types())
+      {
+        auto it = type_patterns
+                      .try_emplace(type, a.rows(),
+                                   std::vector<la::SparsityPattern*>(
+                                       a.cols(), nullptr))
+                      .first;
+        it->second[i][j] = patterns[i][j];
+      }
+    }
+  }
+
+  const int tdim = mesh.topology().dim();
+  for (auto& [type, p] : type_patterns)
+  {
+    if (type == fem::IntegralType::cell)
+      fem::SparsityPatternBuilder::cells(p, mesh.topology(), dofmaps);
+    else if (type == fem::IntegralType::interior_facet)
+    {
+      mesh.topology_mutable().create_entities(tdim - 1);
+      mesh.topology_mutable().create_connectivity(tdim - 1, tdim);
+      fem::SparsityPatternBuilder::interior_facets(p, mesh.topology(),
+                                                   dofmaps);
+    }
+    else if (type == fem::IntegralType::exterior_facet)
+    {
+      mesh.topology_mutable().create_entities(tdim - 1);
+      mesh.topology_mutable().create_connectivity(tdim - 1, tdim);
+      fem::SparsityPatternBuilder::exterior_facets(p, mesh.topology(),
+                                                   dofmaps);
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+// Fix the non-zero structure of a matrix created from a (finalised)
+// sparsity pattern by inserting zeros at the entries of the owned rows
+// of the pattern and assembling the matrix
+void insert_pattern_zeros(Mat A, const la::SparsityPattern& pattern)
+{
+  const std::array<std::int64_t, 2> range0 = pattern.local_range(0);
+  const std::array<std::int64_t, 2> range1 = pattern.local_range(1);
+  const graph::AdjacencyList<std::int32_t>& diagonal
+      = pattern.diagonal_pattern();
+  const graph::AdjacencyList<std::int64_t>& off_diagonal
+      = pattern.off_diagonal_pattern();
+  const int bs = pattern.blocked() ? pattern.index_map(0)->block_size() : 1;
+
+  PetscErrorCode ierr;
+  std::vector<PetscInt> cols;
+  std::vector<PetscScalar> zeros;
+  for (std::int32_t i = 0; i < diagonal.num_nodes(); ++i)
+  {
+    const PetscInt row = range0[0] + i;
+    auto cols_diagonal = diagonal.links(i);
+    auto cols_off_diagonal = off_diagonal.links(i);
+    cols.clear();
+    for (Eigen::Index j = 0; j < cols_diagonal.rows(); ++j)
+      cols.push_back(range1[0] + cols_diagonal[j]);
+    for (Eigen::Index j = 0; j < cols_off_diagonal.rows(); ++j)
+      cols.push_back(cols_off_diagonal[j]);
+    zeros.assign(bs * bs * cols.size(), 0);
+    if (bs > 1)
+    {
+      ierr = MatSetValuesBlocked(A, 1, &row, cols.size(), cols.data(),
+                                 zeros.data(), INSERT_VALUES);
+    }
+    else
+    {
+      ierr = MatSetValues(A, 1, &row, cols.size(), cols.data(), zeros.data(),
+                          INSERT_VALUES);
+    }
+    if (ierr != 0)
+      la::petsc_error(ierr, __FILE__, "MatSetValues");
+  }
+
+  ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
+  if (ierr != 0)
+    la::petsc_error(ierr, __FILE__, "MatAssemblyBegin");
+  ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY);
+  if (ierr != 0)
+    la::petsc_error(ierr, __FILE__, "MatAssemblyEnd");
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 //-----------------------------------------------------------------------------
-la::PETScMatrix dolfinx::fem::create_matrix(const Form<PetscScalar>& a)
+la::PETScMatrix dolfinx::fem::create_matrix(const Form<PetscScalar>& a,
+                                            const std::string& type)
 {
-  // Build sparsitypattern
-  la::SparsityPattern pattern = fem::create_sparsity_pattern(a);
+  // An unassembled (MATIS) matrix is built from the pattern of the
+  // local matrix, without communication
+  if (type == MATIS)
+  {
+    la::SparsityPattern pattern = fem::create_local_sparsity_pattern(a, true);
+    pattern.assemble();
+
+    common::Timer t1("Init tensor");
+    std::array index_maps{a.function_space(0)->dofmap()->index_map,
+                          a.function_space(1)->dofmap()->index_map};
+    Mat A = la::create_petsc_matrix_is(a.mesh()->mpi_comm(), index_maps,
+                                       pattern);
+    t1.stop();
+    return la::PETScMatrix(A, false);
+  }
+
+  // Build sparsitypattern, in block form if possible
+  la::SparsityPattern pattern = fem::create_sparsity_pattern(a, true);
 
   // Finalise communication
   pattern.assemble();
 
   // Initialize matrix
   common::Timer t1("Init tensor");
-  la::PETScMatrix A(a.mesh()->mpi_comm(), pattern);
+  la::PETScMatrix A(a.mesh()->mpi_comm(), pattern, type);
   t1.stop();
 
   return A;
 }
 //-----------------------------------------------------------------------------
+std::shared_ptr<const la::SparsityPattern>
+fem::MatrixCache::sparsity_pattern(const Form<PetscScalar>& a)
+{
+  return entry(a).pattern;
+}
+//-----------------------------------------------------------------------------
+la::PETScMatrix fem::MatrixCache::create_matrix(const Form<PetscScalar>& a,
+                                                const std::string& type)
+{
+  // The non-zero structure of unassembled (MATIS) matrices is not
+  // cached
+  if (type == MATIS)
+    return fem::create_matrix(a, type);
+
+  Entry& e = entry(a);
+  auto it = e.matrices.find(type);
+  if (it == e.matrices.end())
+  {
+    common::Timer t1("Init tensor");
+    la::PETScMatrix A(a.mesh()->mpi_comm(), *e.pattern, type);
+    insert_pattern_zeros(A.mat(), *e.pattern);
+    it = e.matrices.emplace(type, std::move(A)).first;
+  }
+
+  common::Timer t2("Duplicate tensor");
+  Mat B = nullptr;
+  PetscErrorCode ierr
+      = MatDuplicate(it->second.mat(), MAT_DO_NOT_COPY_VALUES, &B);
+  if (ierr != 0)
+    la::petsc_error(ierr, __FILE__, "MatDuplicate");
+  return la::PETScMatrix(B, false);
+}
+//-----------------------------------------------------------------------------
+std::size_t fem::MatrixCache::size() const { return _entries.size(); }
+//-----------------------------------------------------------------------------
+void fem::MatrixCache::clear() { _entries.clear(); }
+//-----------------------------------------------------------------------------
+fem::MatrixCache::Entry& fem::MatrixCache::entry(const Form<PetscScalar>& a)
+{
+  if (a.rank() != 2)
+  {
+    throw std::runtime_error(
+        "Cannot create sparsity pattern. Form is not a bilinear form");
+  }
+
+  assert(a.function_space(0));
+  assert(a.function_space(1));
+  std::shared_ptr<const fem::DofMap> dofmap0 = a.function_space(0)->dofmap();
+  std::shared_ptr<const fem::DofMap> dofmap1 = a.function_space(1)->dofmap();
+  const Key key{dofmap0.get(), dofmap1.get(), a.integrals().types()};
+  if (auto it = _entries.find(key); it != _entries.end())
+    return it->second;
+
+  // Build sparsity pattern, in block form if possible (see
+  // fem::create_matrix)
+  la::SparsityPattern pattern = fem::create_sparsity_pattern(a, true);
+  pattern.assemble();
+  Entry e{dofmap0, dofmap1,
+          std::make_shared<const la::SparsityPattern>(std::move(pattern)),
+          {}};
+  return _entries.emplace(key, std::move(e)).first->second;
+}
+//-----------------------------------------------------------------------------
 la::PETScMatrix fem::create_matrix_block(
     const Eigen::Ref<
         const Eigen::Array<const fem::Form<PetscScalar>*, Eigen::Dynamic,
@@ -39,51 +515,7 @@ la::PETScMatrix fem::create_matrix_block(
 
   std::shared_ptr mesh = V[0][0]->mesh();
   assert(mesh);
-  const int tdim = mesh->topology().dim();
-
-  // Build sparsity pattern for each block
-  std::vector<std::vector<std::unique_ptr<la::SparsityPattern>>> patterns(
-      V[0].size());
-  for (std::size_t row = 0; row < V[0].size(); ++row)
-  {
-    for (std::size_t col = 0; col < V[1].size(); ++col)
-    {
-      const std::array<std::shared_ptr<const common::IndexMap>, 2> index_maps
-          = {{V[0][row]->dofmap()->index_map, V[1][col]->dofmap()->index_map}};
-      if (a(row, col))
-      {
-        // Create sparsity pattern for block
-        patterns[row].push_back(std::make_unique<la::SparsityPattern>(
-            mesh->mpi_comm(), index_maps));
-
-        // Build sparsity pattern for block
-        std::array dofmaps{V[0][row]->dofmap().get(),
-                           V[1][col]->dofmap().get()};
-        assert(patterns[row].back());
-        auto& sp = patterns[row].back();
-        assert(sp);
-        const FormIntegrals<PetscScalar>& integrals = a(row, col)->integrals();
-        if (integrals.num_integrals(IntegralType::cell) > 0)
-          SparsityPatternBuilder::cells(*sp, mesh->topology(), dofmaps);
-        if (integrals.num_integrals(IntegralType::interior_facet) > 0)
-        {
-          mesh->topology_mutable().create_entities(tdim - 1);
-          SparsityPatternBuilder::interior_facets(*sp, mesh->topology(),
-                                                  dofmaps);
-        }
-        if (integrals.num_integrals(IntegralType::exterior_facet) > 0)
-        {
-          mesh->topology_mutable().create_entities(tdim - 1);
-          SparsityPatternBuilder::exterior_facets(*sp, mesh->topology(),
-                                                  dofmaps);
-        }
-      }
-      else
-        patterns[row].push_back(nullptr);
-    }
-  }
 
-  // Compute offsets for the fields
   std::array<std::vector<std::reference_wrapper<const common::IndexMap>>, 2>
       maps;
   for (std::size_t d = 0; d < 2; ++d)
@@ -92,20 +524,45 @@ la::PETScMatrix fem::create_matrix_block(
       maps[d].push_back(*space->dofmap()->index_map.get());
   }
 
-  // FIXME: This is computed again inside the SparsityPattern
-  // constructor, but we also need to outside to build the PETSc
-  // local-to-global map. Compute outside and pass into SparsityPattern
-  // constructor.
-  auto [rank_offset, local_offset, ghosts, owner]
-      = common::stack_index_maps(maps[0]);
+  // Create the stacked sparsity pattern, and renumber the dofmaps of
+  // the fields to the local indices of the pattern, such that the
+  // entries of all blocks are inserted directly by one pass over the
+  // mesh and communicated by one exchange
+  common::Timer t0("Build sparsity");
+  la::SparsityPattern pattern(mesh->mpi_comm(), maps);
+  std::array<std::vector<std::int32_t>, 2> offsets, ghost_offsets;
+  std::array<std::vector<std::shared_ptr<const fem::DofMap>>, 2>
+      stacked_dofmaps;
+  std::array<std::vector<const fem::DofMap*>, 2> dofmaps;
+  for (int d = 0; d < 2; ++d)
+  {
+    std::int32_t offset = 0;
+    std::int32_t ghost_offset = 0;
+    for (const common::IndexMap& map : maps[d])
+      ghost_offset += map.block_size() * map.size_local();
+    for (std::size_t f = 0; f < maps[d].size(); ++f)
+    {
+      const common::IndexMap& map = maps[d][f];
+      offsets[d].push_back(offset);
+      ghost_offsets[d].push_back(ghost_offset);
+      stacked_dofmaps[d].push_back(
+          create_stacked_dofmap(*V[d][f]->dofmap(), pattern.index_map(d),
+                                offset, ghost_offset));
+      dofmaps[d].push_back(stacked_dofmaps[d].back().get());
+      offset += map.block_size() * map.size_local();
+      ghost_offset += map.block_size() * map.num_ghosts();
+    }
+  }
 
-  // Create merged sparsity pattern
-  std::vector<std::vector<const la::SparsityPattern*>> p(V[0].size());
-  for (std::size_t row = 0; row < V[0].size(); ++row)
-    for (std::size_t col = 0; col < V[1].size(); ++col)
-      p[row].push_back(patterns[row][col].get());
-  la::SparsityPattern pattern(mesh->mpi_comm(), p, maps);
+  std::vector<std::vector<la::SparsityPattern*>> patterns(
+      a.rows(), std::vector<la::SparsityPattern*>(a.cols(), nullptr));
+  for (int i = 0; i < a.rows(); ++i)
+    for (int j = 0; j < a.cols(); ++j)
+      if (a(i, j))
+        patterns[i][j] = &pattern;
+  build_block_sparsity_patterns(*mesh, a, patterns, dofmaps);
   pattern.assemble();
+  t0.stop();
 
   // FIXME: Add option to pass customised local-to-global map to PETSc
   // Mat constructor.
@@ -114,20 +571,22 @@ la::PETScMatrix fem::create_matrix_block(
   la::PETScMatrix A(mesh->mpi_comm(), pattern);
 
   // Create row and column local-to-global maps (field0, field1, field2,
-  // etc), i.e. ghosts of field0 appear before owned indices of field1
+  // etc), i.e. ghosts of field0 appear before owned indices of field1,
+  // from the global indices of the stacked index maps
   std::array<std::vector<PetscInt>, 2> _maps;
   for (int d = 0; d < 2; ++d)
   {
+    const std::vector global = pattern.index_map(d)->global_indices(false);
     for (std::size_t f = 0; f < maps[d].size(); ++f)
     {
       const common::IndexMap& map = maps[d][f].get();
       const int bs = map.block_size();
       const std::int32_t size_local = bs * map.size_local();
-      const std::vector global = map.global_indices(false);
+      const std::int32_t num_ghosts = bs * map.num_ghosts();
       for (std::int32_t i = 0; i < size_local; ++i)
-        _maps[d].push_back(i + rank_offset + local_offset[f]);
-      for (std::size_t i = size_local; i < global.size(); ++i)
-        _maps[d].push_back(ghosts[f][i - size_local]);
+        _maps[d].push_back(global[offsets[d][f] + i]);
+      for (std::int32_t i = 0; i < num_ghosts; ++i)
+        _maps[d].push_back(global[ghost_offsets[d][f] + i]);
     }
   }
 
@@ -149,6 +608,154 @@ la::PETScMatrix fem::create_matrix_block(
   return A;
 }
 //-----------------------------------------------------------------------------
+std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
+                  const std::int32_t*, const PetscScalar*)>
+fem::add_fn_petsc(Mat A, const Form<PetscScalar>& a)
+{
+  assert(a.function_space(0));
+  assert(a.function_space(1));
+  const int bs = a.function_space(0)->dofmap()->bs();
+  if (bs > 1 and a.function_space(1)->dofmap()->bs() == bs)
+  {
+    // Check that the matrix supports insertion of blocks of size bs
+    ISLocalToGlobalMapping l2g0 = nullptr, l2g1 = nullptr;
+    MatGetLocalToGlobalMapping(A, &l2g0, &l2g1);
+    PetscInt bs0 = 1, bs1 = 1;
+    if (l2g0 and l2g1)
+    {
+      ISLocalToGlobalMappingGetBlockSize(l2g0, &bs0);
+      ISLocalToGlobalMappingGetBlockSize(l2g1, &bs1);
+    }
+    if (bs0 == bs and bs1 == bs)
+      return la::PETScMatrix::add_block_fn(A, bs);
+  }
+
+  return la::PETScMatrix::add_fn(A);
+}
+//-----------------------------------------------------------------------------
+fem::MatrixPositionMap
+fem::create_matrix_position_map(Mat A, const Form<PetscScalar>& a)
+{
+  common::Timer t0("Create matrix position map");
+
+  assert(a.rank() == 2);
+  assert(a.function_space(0));
+  assert(a.function_space(1));
+  std::shared_ptr<const fem::DofMap> dofmap0 = a.function_space(0)->dofmap();
+  std::shared_ptr<const fem::DofMap> dofmap1 = a.function_space(1)->dofmap();
+  assert(dofmap0);
+  assert(dofmap1);
+  const graph::AdjacencyList<std::int32_t>& dofs0 = dofmap0->list();
+  const graph::AdjacencyList<std::int32_t>& dofs1 = dofmap1->list();
+  const std::int32_t num_cells = dofs0.num_nodes();
+
+  // Fix the non-zero structure by inserting zeros for all cells
+  PetscBool assembled = PETSC_FALSE;
+  MatAssembled(A, &assembled);
+  if (!assembled)
+  {
+    const auto mat_add = la::PETScMatrix::add_fn(A);
+    std::vector<PetscScalar> zeros;
+    for (std::int32_t c = 0; c < num_cells; ++c)
+    {
+      auto cell_dofs0 = dofs0.links(c);
+      auto cell_dofs1 = dofs1.links(c);
+      zeros.resize(cell_dofs0.size() * cell_dofs1.size(), 0);
+      mat_add(cell_dofs0.size(), cell_dofs0.data(), cell_dofs1.size(),
+              cell_dofs1.data(), zeros.data());
+    }
+    MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY);
+  }
+
+  // Get CSR structure of the diagonal and off-diagonal blocks
+  auto [Ad, Ao, garray] = get_aij_blocks(A);
+  PetscInt num_rows = 0, num_garray = 0;
+  const PetscInt *rp_d = nullptr, *cols_d = nullptr;
+  const PetscInt *rp_o = nullptr, *cols_o = nullptr;
+  PetscBool done = PETSC_FALSE;
+  MatGetRowIJ(Ad, 0, PETSC_FALSE, PETSC_FALSE, &num_rows, &rp_d, &cols_d,
+              &done);
+  if (!done)
+    throw std::runtime_error("Unable to access matrix CSR structure");
+  if (Ao)
+  {
+    MatGetRowIJ(Ao, 0, PETSC_FALSE, PETSC_FALSE, &num_rows, &rp_o, &cols_o,
+                &done);
+    if (!done)
+      throw std::runtime_error("Unable to access matrix CSR structure");
+    MatGetSize(Ao, nullptr, &num_garray);
+  }
+  const std::int32_t num_diagonal = rp_d[num_rows];
+
+  // Get ownership ranges and local-to-global maps
+  PetscInt row0 = 0, row1 = 0, col0 = 0, col1 = 0;
+  MatGetOwnershipRange(A, &row0, &row1);
+  MatGetOwnershipRangeColumn(A, &col0, &col1);
+  ISLocalToGlobalMapping l2g0 = nullptr, l2g1 = nullptr;
+  MatGetLocalToGlobalMapping(A, &l2g0, &l2g1);
+
+  // Find position of (owned local row, global column) in value arrays
+  auto find_position = [&](PetscInt row, PetscInt col) -> std::int32_t {
+    if (col >= col0 and col < col1)
+    {
+      const PetscInt* it = std::lower_bound(
+          cols_d + rp_d[row], cols_d + rp_d[row + 1], col - col0);
+      if (it != cols_d + rp_d[row + 1] and *it == col - col0)
+        return std::distance(cols_d, it);
+    }
+    else if (Ao)
+    {
+      // Off-diagonal block columns are indices into garray
+      const PetscInt* g = std::lower_bound(garray, garray + num_garray, col);
+      const PetscInt c = std::distance(garray, g);
+      const PetscInt* it = std::lower_bound(cols_o + rp_o[row],
+                                            cols_o + rp_o[row + 1], c);
+      if (g != garray + num_garray and *g == col
+          and it != cols_o + rp_o[row + 1] and *it == c)
+      {
+        return num_diagonal + std::distance(cols_o, it);
+      }
+    }
+    throw std::runtime_error("Matrix entry is not in the sparsity pattern");
+  };
+
+  // Compute positions for each cell
+  std::vector<std::int32_t> positions, offsets(num_cells + 1, 0);
+  std::vector<PetscInt> rows, cols;
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    auto cell_dofs0 = dofs0.links(c);
+    auto cell_dofs1 = dofs1.links(c);
+    rows.assign(cell_dofs0.data(), cell_dofs0.data() + cell_dofs0.size());
+    cols.assign(cell_dofs1.data(), cell_dofs1.data() + cell_dofs1.size());
+    ISLocalToGlobalMappingApply(l2g0, rows.size(), rows.data(), rows.data());
+    ISLocalToGlobalMappingApply(l2g1, cols.size(), cols.data(), cols.data());
+    for (PetscInt row : rows)
+    {
+      if (row >= row0 and row < row1)
+      {
+        for (PetscInt col : cols)
+          positions.push_back(find_position(row - row0, col));
+      }
+      else
+        positions.insert(positions.end(), cols.size(), -1);
+    }
+    offsets[c + 1] = positions.size();
+  }
+
+  MatRestoreRowIJ(Ad, 0, PETSC_FALSE, PETSC_FALSE, &num_rows, &rp_d, &cols_d,
+                  &done);
+  if (Ao)
+  {
+    MatRestoreRowIJ(Ao, 0, PETSC_FALSE, PETSC_FALSE, &num_rows, &rp_o,
+                    &cols_o, &done);
+  }
+
+  return {graph::AdjacencyList<std::int32_t>(positions, offsets),
+          num_diagonal};
+}
+//-----------------------------------------------------------------------------
 la::PETScMatrix fem::create_matrix_nest(
     const Eigen::Ref<
         const Eigen::Array<const fem::Form<PetscScalar>*, Eigen::Dynamic,
@@ -157,25 +764,74 @@ la::PETScMatrix fem::create_matrix_nest(
   // Extract and check row/column ranges
   auto V = function::common_function_spaces(extract_function_spaces(a));
 
-  // Loop over each form and create matrix
+  std::shared_ptr mesh = V[0][0]->mesh();
+  assert(mesh);
+
+  // Create the pattern of each block, in block form if possible (see
+  // create_sparsity_pattern)
+  common::Timer t0("Build sparsity");
+  std::array<std::vector<const fem::DofMap*>, 2> dofmaps;
+  for (int d = 0; d < 2; ++d)
+    for (auto space : V[d])
+      dofmaps[d].push_back(space->dofmap().get());
+  std::vector<std::vector<std::unique_ptr<la::SparsityPattern>>> _patterns(
+      a.rows());
+  std::vector<std::vector<la::SparsityPattern*>> patterns(
+      a.rows(), std::vector<la::SparsityPattern*>(a.cols(), nullptr));
+  for (int i = 0; i < a.rows(); ++i)
+  {
+    _patterns[i].resize(a.cols());
+    for (int j = 0; j < a.cols(); ++j)
+    {
+      if (a(i, j))
+      {
+        const int bs = dofmaps[0][i]->bs();
+        const bool blocked = bs > 1 and dofmaps[1][j]->bs() == bs;
+        _patterns[i][j] = std::make_unique<la::SparsityPattern>(
+            mesh->mpi_comm(),
+            std::array{dofmaps[0][i]->index_map, dofmaps[1][j]->index_map},
+            blocked);
+        patterns[i][j] = _patterns[i][j].get();
+      }
+    }
+  }
+
+  // Insert the entries of all blocks by one pass over the mesh, and
+  // communicate the off-process entries of the blocks of a block row
+  // (same row index map) by one exchange
+  build_block_sparsity_patterns(*mesh, a, patterns, dofmaps);
+  for (int i = 0; i < a.rows(); ++i)
+  {
+    std::vector<la::SparsityPattern*> row;
+    std::copy_if(patterns[i].begin(), patterns[i].end(),
+                 std::back_inserter(row),
+                 [](auto pattern) { return pattern != nullptr; });
+    la::SparsityPattern::assemble(row);
+  }
+  t0.stop();
+
+  // Create the matrix of each block
   Eigen::Array<std::shared_ptr<la::PETScMatrix>, Eigen::Dynamic, Eigen::Dynamic,
                Eigen::RowMajor>
       mats(a.rows(), a.cols());
   Eigen::Array<Mat, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> petsc_mats(
       a.rows(), a.cols());
+  common::Timer t1("Init tensor");
   for (int i = 0; i < a.rows(); ++i)
   {
     for (int j = 0; j < a.cols(); ++j)
     {
-      if (a(i, j))
+      if (patterns[i][j])
       {
-        mats(i, j) = std::make_shared<la::PETScMatrix>(create_matrix(*a(i, j)));
+        mats(i, j) = std::make_shared<la::PETScMatrix>(mesh->mpi_comm(),
+                                                       *patterns[i][j]);
         petsc_mats(i, j) = mats(i, j)->mat();
       }
       else
         petsc_mats(i, j) = nullptr;
     }
   }
+  t1.stop();
 
   // Initialise block (MatNest) matrix
   Mat _A;
@@ -263,6 +919,313 @@ void fem::assemble_vector_petsc(Vec b, const Form<PetscScalar>& L)
   VecGhostRestoreLocalForm(b, &b_local);
 }
 //-----------------------------------------------------------------------------
+void fem::assemble_matrix_petsc(
+    Mat A, const Form<PetscScalar>& a,
+    const std::vector<std::shared_ptr<const DirichletBC<PetscScalar>>>& bcs,
+    const MatrixPositionMap& map)
+{
+  assert(a.function_space(0));
+  if (map.positions.num_nodes()
+      != a.function_space(0)->dofmap()->list().num_nodes())
+  {
+    throw std::runtime_error("Matrix position map does not match form");
+  }
+
+  auto [Ad, Ao, garray] = get_aij_blocks(A);
+  PetscScalar *values_diag = nullptr, *values_offdiag = nullptr;
+  MatSeqAIJGetArray(Ad, &values_diag);
+  if (Ao)
+    MatSeqAIJGetArray(Ao, &values_offdiag);
+
+  PositionMapInserter mat_add(A, map, values_diag, values_offdiag);
+  fem::assemble_matrix(mat_add, a, bcs);
+
+  MatSeqAIJRestoreArray(Ad, &values_diag);
+  if (Ao)
+    MatSeqAIJRestoreArray(Ao, &values_offdiag);
+}
+//-----------------------------------------------------------------------------
+fem::AssemblyPlan::AssemblyPlan(
+    std::shared_ptr<const Form<PetscScalar>> a,
+    const std::vector<std::shared_ptr<const DirichletBC<PetscScalar>>>& bcs,
+    Mat A, PetscScalar diagonal)
+    : _form(a), _A(la::PETScMatrix(A, true)), _diagonal(diagonal)
+{
+  common::Timer t0("Create assembly plan");
+
+  assert(a);
+  if (a->rank() != 2)
+    throw std::runtime_error("Matrix assembly plan requires a bilinear form");
+
+  _bc = impl::bc_markers(*a, bcs);
+  if (*a->function_space(0) == *a->function_space(1))
+    _bc_rows = bc_rows(*a->function_space(0), bcs);
+
+  // Create the topology data required by the integrals, so that it is
+  // not checked for in each execution
+  std::shared_ptr<const mesh::Mesh> mesh = a->mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+  const FormIntegrals<PetscScalar>& integrals = a->integrals();
+  if (integrals.needs_permutation_data())
+    mesh->topology_mutable().create_cell_permutation_info();
+  if (integrals.num_integrals(IntegralType::exterior_facet) > 0
+      or integrals.num_integrals(IntegralType::interior_facet) > 0)
+  {
+    mesh->topology_mutable().create_entities(tdim - 1);
+    mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
+    if (integrals.needs_permutation_data())
+      mesh->topology_mutable().create_facet_permutations();
+  }
+
+  // Cell element matrices are added to AIJ matrices by position
+  PetscBool is_mpiaij = PETSC_FALSE, is_seqaij = PETSC_FALSE;
+  PetscObjectTypeCompare((PetscObject)A, MATMPIAIJ, &is_mpiaij);
+  PetscObjectTypeCompare((PetscObject)A, MATSEQAIJ, &is_seqaij);
+  if (is_mpiaij or is_seqaij)
+    _position_map = create_matrix_position_map(A, *a);
+  _mat_add = add_fn_petsc(A, *a);
+}
+//-----------------------------------------------------------------------------
+fem::AssemblyPlan::AssemblyPlan(std::shared_ptr<const Form<PetscScalar>> L,
+                                Vec b)
+    : _form(L), _b(la::PETScVector(b, true))
+{
+  assert(L);
+  if (L->rank() != 1)
+    throw std::runtime_error("Vector assembly plan requires a linear form");
+}
+//-----------------------------------------------------------------------------
+void fem::AssemblyPlan::execute()
+{
+  common::Timer t0("Execute assembly plan");
+
+  if (_b)
+  {
+    Vec b_local;
+    VecGhostGetLocalForm(_b->vec(), &b_local);
+    VecSet(b_local, 0.0);
+    VecGhostRestoreLocalForm(_b->vec(), &b_local);
+    assemble_vector_petsc(_b->vec(), *_form);
+    return;
+  }
+
+  assert(_A);
+  Mat A = _A->mat();
+  PetscErrorCode ierr = MatZeroEntries(A);
+  if (ierr != 0)
+    la::petsc_error(ierr, __FILE__, "MatZeroEntries");
+
+  const Eigen::Array<PetscScalar, Eigen::Dynamic, Eigen::Dynamic,
+                     Eigen::RowMajor>& coeffs
+      = pack_coefficients(*_form);
+  if (_position_map and _strategy.positions)
+  {
+    auto [Ad, Ao, garray] = get_aij_blocks(A);
+    PetscScalar *values_diag = nullptr, *values_offdiag = nullptr;
+    MatSeqAIJGetArray(Ad, &values_diag);
+    if (Ao)
+      MatSeqAIJGetArray(Ao, &values_offdiag);
+
+    PositionMapInserter mat_add(A, *_position_map, values_diag,
+                                values_offdiag);
+    impl::assemble_matrix(mat_add, *_form, coeffs, _bc[0], _bc[1],
+                          _strategy.num_threads);
+
+    MatSeqAIJRestoreArray(Ad, &values_diag);
+    if (Ao)
+      MatSeqAIJRestoreArray(Ao, &values_offdiag);
+  }
+  else
+  {
+    impl::assemble_matrix(_mat_add, *_form, coeffs, _bc[0], _bc[1],
+                          _strategy.num_threads);
+  }
+
+  // The diagonal entries are added one by one, i.e. not in blocks
+  const auto add_diagonal = la::PETScMatrix::add_fn(A);
+  for (std::int32_t row : _bc_rows)
+    add_diagonal(1, &row, 1, &row, &_diagonal);
+}
+//-----------------------------------------------------------------------------
+fem::AssemblyStrategy fem::AssemblyPlan::autotune(int max_threads,
+                                                  int num_repeats,
+                                                  const std::string& filename)
+{
+  if (!_A)
+    throw std::runtime_error("Autotuning requires a matrix assembly plan");
+  if (max_threads < 1 or num_repeats < 1)
+    throw std::runtime_error("Invalid number of threads or repeats");
+
+  common::Timer t0("Autotune assembly plan");
+  MPI_Comm comm = _form->mesh()->mpi_comm();
+  const int rank = MPI::rank(comm);
+  const std::string key = machine_key(comm) + " " + form_key(*_form);
+
+  // Look up a stored strategy on rank 0: {found, threads, positions}
+  std::array<int, 3> stored = {0, 0, 1};
+  if (rank == 0 and !filename.empty())
+  {
+    std::ifstream file(filename);
+    std::string line;
+    while (std::getline(file, line))
+    {
+      const std::size_t tab = line.rfind('\t');
+      if (tab != std::string::npos and line.substr(0, tab) == key)
+      {
+        std::istringstream s(line.substr(tab + 1));
+        if (s >> stored[1] >> stored[2])
+          stored[0] = 1;
+      }
+    }
+  }
+  MPI_Bcast(stored.data(), stored.size(), MPI_INT, 0, comm);
+
+  double best_time = 0.0;
+  if (stored[0])
+  {
+    _strategy.num_threads = stored[1];
+    _strategy.positions = stored[2] and _position_map.has_value();
+    execute();
+  }
+  else
+  {
+    // Numbers of threads 1, 2, 4, ..., and max_threads
+    std::vector<int> num_threads;
+    for (int n = 1; n < max_threads; n *= 2)
+      num_threads.push_back(n);
+    num_threads.push_back(max_threads);
+
+    std::vector<AssemblyStrategy> candidates;
+    for (int n : num_threads)
+    {
+      if (_position_map)
+        candidates.push_back({n, true});
+      candidates.push_back({n, false});
+    }
+
+    // Time the executions with the finalisation of the matrix, which
+    // includes sending the entries of unowned rows. The slowest process
+    // determines the time of a strategy.
+    best_time = std::numeric_limits<double>::max();
+    AssemblyStrategy best = candidates.front();
+    for (const AssemblyStrategy& candidate : candidates)
+    {
+      _strategy = candidate;
+      double time = std::numeric_limits<double>::max();
+      for (int i = 0; i < num_repeats; ++i)
+      {
+        const auto start = std::chrono::steady_clock::now();
+        execute();
+        _A->apply(la::PETScMatrix::AssemblyType::FINAL);
+        const std::chrono::duration<double> elapsed
+            = std::chrono::steady_clock::now() - start;
+        time = std::min(time, elapsed.count());
+      }
+      MPI_Allreduce(MPI_IN_PLACE, &time, 1, MPI_DOUBLE, MPI_MAX, comm);
+      if (time < best_time)
+      {
+        best_time = time;
+        best = candidate;
+      }
+    }
+    _strategy = best;
+    execute();
+
+    if (rank == 0 and !filename.empty())
+    {
+      std::ofstream file(filename, std::ios::app);
+      file << key << '\t' << _strategy.num_threads << ' '
+           << _strategy.positions << '\n';
+    }
+  }
+
+  std::string name
+      = "Assembly plan strategy: threads="
+        + std::to_string(_strategy.num_threads)
+        + (_strategy.positions ? ", positions" : ", MatSetValues");
+  if (stored[0])
+    name += " (stored)";
+  common::TimeLogManager::logger().register_timing(name, best_time, 0.0, 0.0);
+
+  return _strategy;
+}
+//-----------------------------------------------------------------------------
+std::size_t fem::AssemblyPlan::memory_usage() const
+{
+  std::size_t size = _bc_rows.capacity() * sizeof(std::int32_t);
+  for (const BCMarkers& bc : _bc)
+    size += bc.dofs.capacity() + bc.cells.capacity();
+  if (_position_map)
+    size += _position_map->positions.memory_usage();
+  return size;
+}
+//-----------------------------------------------------------------------------
+la::PETScOperator fem::create_matrix_free_operator(
+    std::shared_ptr<const Form<PetscScalar>> a,
+    const std::vector<std::shared_ptr<const DirichletBC<PetscScalar>>>& bcs,
+    PetscScalar diagonal)
+{
+  assert(a);
+  if (a->rank() != 2)
+    throw std::runtime_error("Matrix-free operator requires a bilinear form");
+  std::shared_ptr<const common::IndexMap> map0
+      = a->function_space(0)->dofmap()->index_map;
+  std::shared_ptr<const common::IndexMap> map1
+      = a->function_space(1)->dofmap()->index_map;
+  assert(map0);
+  assert(map1);
+
+  using Array = MatrixFreeContext::Array;
+  auto [bc0, bc1] = impl::bc_markers(*a, bcs);
+  const bool square = *a->function_space(0) == *a->function_space(1);
+  auto ctx = new MatrixFreeContext{
+      [a, bc0 = bc0, bc1 = bc1](Eigen::Ref<Array> y,
+                                const Eigen::Ref<const Array>& x) {
+        impl::assemble_action<PetscScalar>(y, *a, x, bc0, bc1);
+      },
+      nullptr,
+      square ? bc_rows(*a->function_space(0), bcs)
+             : std::vector<std::int32_t>(),
+      diagonal,
+      la::Vector<PetscScalar>(map1),
+      la::Vector<PetscScalar>(map0)};
+  if (square)
+  {
+    ctx->get_diagonal = [a, bc0 = bc0, bc1 = bc1](Eigen::Ref<Array> d) {
+      impl::assemble_diagonal<PetscScalar>(d, *a, bc0, bc1);
+    };
+  }
+
+  return create_shell(a->mesh()->mpi_comm(), *map0, *map1, ctx);
+}
+//-----------------------------------------------------------------------------
+la::PETScOperator fem::create_matrix_free_operator(
+    std::shared_ptr<const SumFactorisedOperator<PetscScalar>> a,
+    const std::vector<std::shared_ptr<const DirichletBC<PetscScalar>>>& bcs,
+    PetscScalar diagonal)
+{
+  assert(a);
+  std::shared_ptr<const function::FunctionSpace> V = a->function_space();
+  assert(V);
+  std::shared_ptr<const common::IndexMap> map = V->dofmap()->index_map;
+  assert(map);
+
+  using Array = MatrixFreeContext::Array;
+  BCMarkers bc = impl::bc_markers(*V, bcs);
+  auto ctx = new MatrixFreeContext{
+      [a, bc](Eigen::Ref<Array> y, const Eigen::Ref<const Array>& x) {
+        a->apply(y, x, bc);
+      },
+      [a, bc](Eigen::Ref<Array> d) { a->diagonal(d, bc); },
+      bc_rows(*V, bcs),
+      diagonal,
+      la::Vector<PetscScalar>(map),
+      la::Vector<PetscScalar>(map)};
+
+  return create_shell(V->mesh()->mpi_comm(), *map, *map, ctx);
+}
+//-----------------------------------------------------------------------------
 void fem::apply_lifting_petsc(
     Vec b, const std::vector<std::shared_ptr<const Form<PetscScalar>>>& a,
     const std::vector<
@@ -310,6 +1273,45 @@ void fem::apply_lifting_petsc(
   VecGhostRestoreLocalForm(b, &b_local);
 }
 //-----------------------------------------------------------------------------
+void fem::assemble_system_petsc(
+    Mat A, Vec b, const Form<PetscScalar>& a, const Form<PetscScalar>& L,
+    const std::vector<std::shared_ptr<const DirichletBC<PetscScalar>>>& bcs,
+    Vec x0, double scale, bool symmetric)
+{
+  Vec b_local;
+  VecGhostGetLocalForm(b, &b_local);
+  PetscInt n = 0;
+  VecGetSize(b_local, &n);
+  PetscScalar* array = nullptr;
+  VecGetArray(b_local, &array);
+  Eigen::Map<Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>> _b(array, n);
+
+  if (x0)
+  {
+    Vec x0_local;
+    VecGhostGetLocalForm(x0, &x0_local);
+    PetscInt n0 = 0;
+    VecGetSize(x0_local, &n0);
+    const PetscScalar* x0_array = nullptr;
+    VecGetArrayRead(x0_local, &x0_array);
+    Eigen::Map<const Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>> _x0(
+        x0_array, n0);
+    fem::assemble_system<PetscScalar>(fem::add_fn_petsc(A, a), _b, a, L, bcs,
+                                      _x0, scale, symmetric);
+    VecRestoreArrayRead(x0_local, &x0_array);
+    VecGhostRestoreLocalForm(x0, &x0_local);
+  }
+  else
+  {
+    fem::assemble_system<PetscScalar>(
+        fem::add_fn_petsc(A, a), _b, a, L, bcs,
+        Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>(), scale, symmetric);
+  }
+
+  VecRestoreArray(b_local, &array);
+  VecGhostRestoreLocalForm(b, &b_local);
+}
+//-----------------------------------------------------------------------------
 void fem::set_bc_petsc(
     Vec b,
     const std::vector<std::shared_ptr<const DirichletBC<PetscScalar>>>& bcs,
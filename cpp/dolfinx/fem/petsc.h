@@ -6,10 +6,19 @@
 
 #pragma once
 
+#include "utils.h"
+#include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/la/PETScMatrix.h>
+#include <dolfinx/la/PETScOperator.h>
 #include <dolfinx/la/PETScVector.h>
+#include <functional>
+#include <map>
 #include <memory>
+#include <optional>
 #include <petscvec.h>
+#include <set>
+#include <string>
+#include <tuple>
 #include <vector>
 
 namespace dolfinx
@@ -19,17 +28,36 @@ namespace function
 class FunctionSpace;
 } // namespace function
 
+namespace la
+{
+class SparsityPattern;
+} // namespace la
+
 namespace fem
 {
+class DofMap;
+enum class IntegralType : std::int8_t;
 template <typename T>
 class DirichletBC;
 template <typename T>
 class Form;
+template <typename T>
+class SumFactorisedOperator;
 
-/// Create a matrix
+/// Create a matrix. If the dofmaps of the test and trial spaces
+/// consist of complete blocks of the same size (see DofMap::bs), the
+/// sparsity pattern is built in block form and the matrix has this
+/// block size, e.g. for a "baij" matrix. For the type "is" an
+/// unassembled (MATIS) matrix is created (see
+/// la::create_petsc_matrix_is), into which each process assembles the
+/// local matrix of its owned and ghost cells without communication,
+/// e.g. for the BDDC preconditioner.
 /// @param[in] a  A bilinear form
+/// @param[in] type The PETSc matrix type, e.g. "baij". If empty the
+///   default type is used.
 /// @return A matrix. The matrix is not zeroed.
-la::PETScMatrix create_matrix(const Form<PetscScalar>& a);
+la::PETScMatrix create_matrix(const Form<PetscScalar>& a,
+                              const std::string& type = std::string());
 
 /// Initialise monolithic matrix for an array for bilinear forms. Matrix
 /// is not zeroed.
@@ -44,6 +72,231 @@ la::PETScMatrix create_matrix_nest(
         const Eigen::Array<const fem::Form<PetscScalar>*, Eigen::Dynamic,
                            Eigen::Dynamic, Eigen::RowMajor>>& a);
 
+/// Cache of the sparsity patterns and non-zero structures of matrices,
+/// shared by bilinear forms with the same test and trial dofmaps and
+/// the same types of integrals, e.g. a mass and a stiffness matrix, or
+/// a Jacobian and its preconditioner.
+///
+/// The first matrix for a (dofmaps, integral types, matrix type) key
+/// is created from the sparsity pattern, and its non-zero structure is
+/// fixed by inserting zeros and assembling it. This matrix is kept by
+/// the cache, and later matrices for the key are created from it by
+/// MatDuplicate without building a sparsity pattern. The cache holds
+/// references to the dofmaps of its keys.
+class MatrixCache
+{
+public:
+  /// Create an empty cache
+  MatrixCache() = default;
+
+  /// Move constructor
+  MatrixCache(MatrixCache&& cache) = default;
+
+  /// Destructor
+  ~MatrixCache() = default;
+
+  /// Move assignment
+  MatrixCache& operator=(MatrixCache&& cache) = default;
+
+  /// Get the (finalised) sparsity pattern of a bilinear form, in block
+  /// form if possible (see create_matrix). The pattern is built on the
+  /// first request for the dofmaps and integral types of the form.
+  /// @param[in] a A bilinear form
+  /// @return The sparsity pattern
+  std::shared_ptr<const la::SparsityPattern>
+  sparsity_pattern(const Form<PetscScalar>& a);
+
+  /// Create a matrix for a bilinear form (see fem::create_matrix),
+  /// duplicating the non-zero structure of the cached matrix for the
+  /// form if there is one (collective). The entries of a duplicated
+  /// matrix are zero. Unassembled (MATIS) matrices are not cached.
+  /// @param[in] a A bilinear form
+  /// @param[in] type The PETSc matrix type, e.g. "baij". If empty the
+  ///   default type is used.
+  /// @return A matrix
+  la::PETScMatrix create_matrix(const Form<PetscScalar>& a,
+                                const std::string& type = std::string());
+
+  /// Number of cached sparsity patterns
+  std::size_t size() const;
+
+  /// Remove all patterns and matrices from the cache
+  void clear();
+
+private:
+  // Test and trial dofmaps and the integral types of a form
+  using Key = std::tuple<const DofMap*, const DofMap*, std::set<IntegralType>>;
+
+  struct Entry
+  {
+    // The dofmaps are held to guarantee that their addresses are not
+    // reused while they are a key of the cache
+    std::shared_ptr<const DofMap> dofmap0, dofmap1;
+    std::shared_ptr<const la::SparsityPattern> pattern;
+
+    // Assembled matrices with the structure of the pattern, by type
+    std::map<std::string, la::PETScMatrix> matrices;
+  };
+
+  // Get the entry of a form, building its sparsity pattern if needed
+  Entry& entry(const Form<PetscScalar>& a);
+
+  std::map<Key, Entry> _entries;
+};
+
+/// Positions of the entries of the cell element matrices of a bilinear
+/// form in the value arrays of a PETSc AIJ matrix. Positions in [0,
+/// num_diagonal) refer to the values of the diagonal block, positions
+/// p >= num_diagonal to value p - num_diagonal of the off-diagonal
+/// block. Entries in rows that are not owned by this process are
+/// marked by -1.
+struct MatrixPositionMap
+{
+  /// Positions of the (row-major) element matrix entries of each cell
+  graph::AdjacencyList<std::int32_t> positions;
+
+  /// Number of values in the diagonal block
+  std::int32_t num_diagonal = 0;
+};
+
+/// Compute the positions of the cell element matrix entries of a
+/// bilinear form in a PETSc AIJ matrix. If the matrix has not been
+/// assembled, zeros are inserted for all cells and the matrix is
+/// assembled to fix its non-zero structure (collective). The map
+/// remains valid as long as the non-zero structure of the matrix is not
+/// changed.
+/// @param[in] A A (Seq or MPI) AIJ matrix created for the form @p a,
+///   e.g. by create_matrix
+/// @param[in] a The bilinear form
+/// @return The position map
+MatrixPositionMap create_matrix_position_map(Mat A,
+                                             const Form<PetscScalar>& a);
+
+/// Persistent plan for the repeated assembly of a form into the same
+/// PETSc matrix or vector, e.g. in a time-stepping loop in which only
+/// the coefficients and constants of the form change. The data that
+/// assemble_matrix derives on each call is computed once when the plan
+/// is created: the boundary condition markers and rows, the topology
+/// data (facets and permutation data) required by the integrals, the
+/// matrix insertion function and, for AIJ matrices, the positions of
+/// the element matrix entries in the matrix (see
+/// create_matrix_position_map). Executing the plan only packs the
+/// coefficients and constants that have been modified (see
+/// pack_coefficients) and runs the kernels.
+///
+/// The plan is invalid if the boundary conditions, the dofmaps or the
+/// non-zero structure of the matrix change.
+/// Strategy for the execution of a matrix assembly plan
+struct AssemblyStrategy
+{
+  /// Number of threads for the cell and interior facet loops. If less
+  /// than one, the number of threads of the form is used.
+  int num_threads = 0;
+
+  /// Add element matrices with the matrix position map (AIJ matrices),
+  /// rather than with MatSetValues
+  bool positions = true;
+};
+
+class AssemblyPlan
+{
+public:
+  /// Create a plan for the assembly of a bilinear form into a matrix.
+  /// This is collective if the non-zero structure of an AIJ matrix has
+  /// not been fixed by assembly (see create_matrix_position_map).
+  /// @param[in] a The bilinear form. It is held by the plan.
+  /// @param[in] bcs Boundary conditions to apply. For boundary
+  ///   condition dofs the row and column are zeroed. If the test and
+  ///   trial spaces are the same, @p diagonal is added to the diagonal
+  ///   of owned boundary condition rows (see add_diagonal).
+  /// @param[in] A The matrix, e.g. created by create_matrix. It is held
+  ///   by the plan.
+  /// @param[in] diagonal The diagonal value for boundary condition rows
+  AssemblyPlan(
+      std::shared_ptr<const Form<PetscScalar>> a,
+      const std::vector<std::shared_ptr<const DirichletBC<PetscScalar>>>&
+          bcs,
+      Mat A, PetscScalar diagonal = 1.0);
+
+  /// Create a plan for the assembly of a linear form into a ghosted
+  /// vector
+  /// @param[in] L The linear form. It is held by the plan.
+  /// @param[in] b The ghosted vector. It is held by the plan.
+  AssemblyPlan(std::shared_ptr<const Form<PetscScalar>> L, Vec b);
+
+  /// Move constructor
+  AssemblyPlan(AssemblyPlan&& plan) = default;
+
+  /// Destructor
+  ~AssemblyPlan() = default;
+
+  /// Move assignment
+  AssemblyPlan& operator=(AssemblyPlan&& plan) = default;
+
+  /// Zero the tensor and assemble the form into it. For a matrix, the
+  /// boundary condition diagonal is added and the matrix is not
+  /// finalised. For a vector, the ghost contributions are not
+  /// accumulated (see assemble_vector_petsc).
+  void execute();
+
+  /// Choose the fastest strategy for the execution of a matrix
+  /// assembly plan, by timing the execution with 1, 2, 4, ...,
+  /// @p max_threads threads, with and without the matrix position map.
+  /// The choice is the same on all processes (collective). If
+  /// @p filename is given, the strategies are stored in this file for
+  /// each form and machine, and a stored strategy is used without
+  /// timing. The chosen strategy is registered in the timing table. The
+  /// matrix holds the assembled form afterwards, as after execute.
+  /// @param[in] max_threads Maximum number of threads to try
+  /// @param[in] num_repeats Number of timed executions of each strategy
+  /// @param[in] filename File of stored strategies, or empty
+  /// @return The chosen strategy, which is used by execute
+  AssemblyStrategy autotune(int max_threads = 1, int num_repeats = 1,
+                            const std::string& filename = "");
+
+  /// The strategy for the execution of a matrix assembly plan
+  const AssemblyStrategy& strategy() const { return _strategy; }
+
+  /// Set the strategy for the execution of a matrix assembly plan
+  void set_strategy(const AssemblyStrategy& strategy)
+  {
+    _strategy = strategy;
+  }
+
+  /// The form of the plan
+  std::shared_ptr<const Form<PetscScalar>> form() const { return _form; }
+
+  /// Memory used by the precomputed data of the plan, in bytes. The
+  /// form and the tensor are not included.
+  std::size_t memory_usage() const;
+
+private:
+  // The form
+  std::shared_ptr<const Form<PetscScalar>> _form;
+
+  // The target matrix (bilinear forms) or vector (linear forms)
+  std::optional<la::PETScMatrix> _A;
+  std::optional<la::PETScVector> _b;
+
+  // Row (0) and column (1) boundary condition markers, and the owned
+  // boundary condition rows for the diagonal
+  std::array<BCMarkers, 2> _bc;
+  std::vector<std::int32_t> _bc_rows;
+  PetscScalar _diagonal = 1.0;
+
+  // Function for adding values to _A
+  std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
+                    const std::int32_t*, const PetscScalar*)>
+      _mat_add;
+
+  // Positions of the element matrix entries in _A, if it is an AIJ
+  // matrix
+  std::optional<MatrixPositionMap> _position_map;
+
+  // Strategy for the execution of a matrix assembly plan
+  AssemblyStrategy _strategy;
+};
+
 /// Initialise monolithic vector. Vector is not zeroed.
 la::PETScVector create_vector_block(
     const std::vector<std::reference_wrapper<const common::IndexMap>>& maps);
@@ -65,6 +318,96 @@ create_vector_nest(const std::vector<const common::IndexMap*>& maps);
 /// @param[in] L The linear form to assemble
 void assemble_vector_petsc(Vec b, const Form<PetscScalar>& L);
 
+// -- Matrices ---------------------------------------------------------------
+
+/// Return a function for adding element matrices of a bilinear form to
+/// a PETSc matrix. If the dofmaps of the test and trial spaces consist
+/// of complete blocks of size bs (see DofMap::bs) and the
+/// local-to-global maps of @p A have block size bs, e.g. for a matrix
+/// created by create_matrix, element blocks are added with
+/// MatSetValuesBlockedLocal (see la::PETScMatrix::add_block_fn).
+/// Otherwise the values are added with MatSetValuesLocal.
+/// @param[in] A The matrix
+/// @param[in] a The bilinear form
+/// @return The function for adding values
+std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
+                  const std::int32_t*, const PetscScalar*)>
+add_fn_petsc(Mat A, const Form<PetscScalar>& a);
+
+/// Assemble bilinear form into a PETSc AIJ matrix using a precomputed
+/// position map. Cell contributions to owned rows are added directly to
+/// the matrix values, without searching the sparsity pattern.
+/// Contributions to unowned rows and facet integrals are added via
+/// MatSetValuesLocal. The matrix is not zeroed and not finalised.
+/// @param[in,out] A The matrix, with the non-zero structure for which
+///   @p map was computed
+/// @param[in] a The bilinear form to assemble
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+///   dofs the row and column are zeroed. The diagonal entry is not set.
+/// @param[in] map Positions of the cell element matrix entries in @p A
+void assemble_matrix_petsc(
+    Mat A, const Form<PetscScalar>& a,
+    const std::vector<std::shared_ptr<const DirichletBC<PetscScalar>>>& bcs,
+    const MatrixPositionMap& map);
+
+// -- Systems ----------------------------------------------------------------
+
+/// Assemble a bilinear form into a PETSc matrix and a linear form into
+/// a ghosted PETSc vector in a single pass over the cells, with lifting
+/// of the boundary conditions, i.e. b <- b + L - scale * A (g - x0). See
+/// fem::assemble_system. The matrix is not finalised and its diagonal
+/// is not set. Ghost contributions to b are not accumulated, and the
+/// boundary condition rows of b are not set.
+/// @param[in,out] A The matrix
+/// @param[in,out] b The ghosted vector. It is not zeroed.
+/// @param[in] a The bilinear form
+/// @param[in] L The linear form
+/// @param[in] bcs Boundary conditions to apply
+/// @param[in] x0 The ghosted vector used in the lifting, with
+///   up-to-date ghost entries. If nullptr, it is treated as zero.
+/// @param[in] scale The scaling of the lifting
+/// @param[in] symmetric True if the columns of boundary condition dofs
+///   are zeroed and the boundary conditions are lifted
+void assemble_system_petsc(
+    Mat A, Vec b, const Form<PetscScalar>& a, const Form<PetscScalar>& L,
+    const std::vector<std::shared_ptr<const DirichletBC<PetscScalar>>>& bcs,
+    Vec x0, double scale, bool symmetric);
+
+// -- Matrix-free ------------------------------------------------------------
+
+/// Create a matrix-free (PETSc MATSHELL) operator for a bilinear form.
+/// Matrix-vector products are computed cell by cell with
+/// assemble_action, and the matrix is never stored. The ghost entries
+/// of the input vector and the ghost contributions to the output vector
+/// are communicated via the dof index maps of the form. The operator
+/// can be used in PETScKrylovSolver.
+/// @param[in] a The bilinear form. It is held by the operator.
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+///   dofs the row and column are zeroed. If the test and trial spaces
+///   are the same, @p diagonal is set on the diagonal of owned
+///   boundary condition rows, as with add_diagonal.
+/// @param[in] diagonal The diagonal value for boundary condition rows
+/// @return The operator. If the test and trial spaces are the same it
+///   also supports MatGetDiagonal, e.g. for Jacobi or Chebyshev
+///   smoothing.
+la::PETScOperator create_matrix_free_operator(
+    std::shared_ptr<const Form<PetscScalar>> a,
+    const std::vector<std::shared_ptr<const DirichletBC<PetscScalar>>>& bcs,
+    PetscScalar diagonal = 1.0);
+
+/// Create a matrix-free (PETSc MATSHELL) operator for a sum-factorised
+/// operator. See create_matrix_free_operator for bilinear forms.
+/// @param[in] a The operator. It is held by the PETSc operator.
+/// @param[in] bcs Boundary conditions to apply. For boundary condition
+///   dofs the row and column are zeroed, and @p diagonal is set on the
+///   diagonal of owned boundary condition rows.
+/// @param[in] diagonal The diagonal value for boundary condition rows
+/// @return The operator. It supports MatGetDiagonal.
+la::PETScOperator create_matrix_free_operator(
+    std::shared_ptr<const SumFactorisedOperator<PetscScalar>> a,
+    const std::vector<std::shared_ptr<const DirichletBC<PetscScalar>>>& bcs,
+    PetscScalar diagonal = 1.0);
+
 // FIXME: clarify how x0 is used
 // FIXME: if bcs entries are set
 
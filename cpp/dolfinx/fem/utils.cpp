@@ -6,8 +6,12 @@
 
 #include "utils.h"
 #include <Eigen/Dense>
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/ThreadPool.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/common/types.h>
@@ -19,12 +23,20 @@
 #include <dolfinx/function/Constant.h>
 #include <dolfinx/function/Function.h>
 #include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/graph/colouring.h>
+#include <dolfinx/graph/subdomains.h>
 #include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/mesh/GraphBuilder.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/Topology.h>
 #include <dolfinx/mesh/TopologyComputation.h>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <set>
 #include <string>
+#include <tuple>
 #include <ufc.h>
 
 using namespace dolfinx;
@@ -55,45 +67,534 @@ int get_num_permutations(const mesh::CellType cell_type)
     return 0;
   }
 }
+//-----------------------------------------------------------------------------
+// Insert the entries of the integrals into a sparsity pattern
+void insert_integrals(la::SparsityPattern& pattern,
+                      const mesh::Topology& topology,
+                      const std::array<const fem::DofMap*, 2>& dofmaps,
+                      const std::set<fem::IntegralType>& integrals,
+                      int num_threads)
+{
+  for (auto type : integrals)
+  {
+    if (type == fem::IntegralType::cell)
+    {
+      fem::SparsityPatternBuilder::cells(pattern, topology,
+                                         {{dofmaps[0], dofmaps[1]}},
+                                         num_threads);
+    }
+    else if (type == fem::IntegralType::interior_facet)
+    {
+      fem::SparsityPatternBuilder::interior_facets(pattern, topology,
+                                                   {{dofmaps[0], dofmaps[1]}});
+    }
+    else if (type == fem::IntegralType::exterior_facet)
+    {
+      fem::SparsityPatternBuilder::exterior_facets(pattern, topology,
+                                                   {{dofmaps[0], dofmaps[1]}});
+    }
+  }
+}
+//-----------------------------------------------------------------------------
 } // namespace
 
 //-----------------------------------------------------------------------------
 la::SparsityPattern
 fem::create_sparsity_pattern(const mesh::Topology& topology,
                              const std::array<const DofMap*, 2>& dofmaps,
-                             const std::set<IntegralType>& integrals)
+                             const std::set<IntegralType>& integrals,
+                             bool blocked, int num_threads)
 {
   common::Timer t0("Build sparsity");
 
   // Get common::IndexMaps for each dimension
   std::array index_maps{dofmaps[0]->index_map, dofmaps[1]->index_map};
 
-  // Create and build sparsity pattern
+  // Use block form only if both dofmaps consist of complete blocks of
+  // the same size
   assert(dofmaps[0]);
+  assert(dofmaps[1]);
+  const int bs = dofmaps[0]->bs();
+  blocked = blocked and bs > 1 and dofmaps[1]->bs() == bs;
+
+  // Create and build sparsity pattern
   assert(dofmaps[0]->index_map);
-  la::SparsityPattern pattern(dofmaps[0]->index_map->comm(), index_maps);
-  for (auto type : integrals)
+  la::SparsityPattern pattern(dofmaps[0]->index_map->comm(), index_maps,
+                              blocked);
+  insert_integrals(pattern, topology, dofmaps, integrals, num_threads);
+
+  t0.stop();
+
+  return pattern;
+}
+//-----------------------------------------------------------------------------
+la::SparsityPattern
+fem::create_local_sparsity_pattern(const mesh::Topology& topology,
+                                   const std::array<const DofMap*, 2>& dofmaps,
+                                   const std::set<IntegralType>& integrals,
+                                   bool blocked, int num_threads)
+{
+  common::Timer t0("Build local sparsity");
+
+  assert(dofmaps[0]);
+  assert(dofmaps[1]);
+  const int bs = dofmaps[0]->bs();
+  blocked = blocked and bs > 1 and dofmaps[1]->bs() == bs;
+
+  // Serial index maps with the owned and ghost indices of the dofmaps
+  // as owned indices, so that the entries of all local rows are kept
+  std::array<std::shared_ptr<const common::IndexMap>, 2> index_maps;
+  for (int i = 0; i < 2; ++i)
   {
-    if (type == fem::IntegralType::cell)
+    std::shared_ptr<const common::IndexMap> map = dofmaps[i]->index_map;
+    assert(map);
+    index_maps[i] = std::make_shared<common::IndexMap>(
+        MPI_COMM_SELF, map->size_local() + map->num_ghosts(),
+        map->block_size());
+  }
+
+  la::SparsityPattern pattern(MPI_COMM_SELF, index_maps, blocked);
+  insert_integrals(pattern, topology, dofmaps, integrals, num_threads);
+
+  t0.stop();
+
+  return pattern;
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int64_t>
+fem::compute_subdomain_dofs(const function::FunctionSpace& V,
+                            int num_subdomains, int overlap)
+{
+  common::Timer timer("Compute subdomain dofs");
+
+  // Owned cells (local vertex indices)
+  const mesh::Topology& topology = V.mesh()->topology();
+  const int tdim = topology.dim();
+  const std::int32_t num_owned = topology.index_map(tdim)->size_local();
+  std::shared_ptr<const graph::AdjacencyList<std::int32_t>> c_to_v
+      = topology.connectivity(tdim, 0);
+  assert(c_to_v);
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& offsets
+      = c_to_v->offsets();
+  const graph::AdjacencyList<std::int64_t> cells(
+      Eigen::Array<std::int64_t, Eigen::Dynamic, 1>(
+          c_to_v->array().head(offsets[num_owned]).cast<std::int64_t>()),
+      Eigen::Array<std::int32_t, Eigen::Dynamic, 1>(
+          offsets.head(num_owned + 1)));
+
+  // Partition the dual graph of the owned cells
+  const auto [dual_graph, facet_cell_map, num_edges]
+      = mesh::GraphBuilder::compute_local_dual_graph(cells,
+                                                     topology.cell_type());
+  const graph::AdjacencyList<std::int32_t> subdomains
+      = graph::compute_subdomains(
+          graph::AdjacencyList<std::int32_t>(dual_graph), num_subdomains,
+          overlap);
+
+  // Dofs of the subdomains, with global indices
+  const graph::AdjacencyList<std::int32_t> dofs
+      = graph::compute_subdomain_indices(subdomains, V.dofmap()->list());
+  Eigen::Array<std::int64_t, Eigen::Dynamic, 1> global_dofs
+      = V.dofmap()->index_map->local_to_global(dofs.array(), false);
+  return graph::AdjacencyList<std::int64_t>(std::move(global_dofs),
+                                            dofs.offsets());
+}
+//-----------------------------------------------------------------------------
+std::pair<graph::AdjacencyList<std::int32_t>,
+          graph::AdjacencyList<std::int32_t>>
+fem::compute_patches(const function::FunctionSpace& V, int dim, bool interior,
+                     int num_threads)
+{
+  common::Timer timer("Compute patches");
+
+  assert(V.mesh());
+  const mesh::Topology& topology = V.mesh()->topology();
+  const int tdim = topology.dim();
+  std::shared_ptr<const common::IndexMap> map = topology.index_map(dim);
+  if (!map)
+  {
+    throw std::runtime_error("Mesh entities of dimension "
+                             + std::to_string(dim) + " have not been created.");
+  }
+  std::shared_ptr<const graph::AdjacencyList<std::int32_t>> e_to_c;
+  if (dim < tdim)
+  {
+    e_to_c = topology.connectivity(dim, tdim);
+    if (!e_to_c)
     {
-      SparsityPatternBuilder::cells(pattern, topology,
-                                    {{dofmaps[0], dofmaps[1]}});
+      throw std::runtime_error("Connectivity (" + std::to_string(dim) + ", "
+                               + std::to_string(tdim)
+                               + ") has not been computed.");
     }
-    else if (type == fem::IntegralType::interior_facet)
+  }
+
+  assert(V.dofmap());
+  const graph::AdjacencyList<std::int32_t>& dofmap = V.dofmap()->list();
+
+  // Number of cells that contain each dof, to find the dofs in the
+  // interior of a patch
+  std::vector<std::int32_t> num_dof_cells;
+  if (interior)
+  {
+    const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& dofs
+        = dofmap.array();
+    num_dof_cells.resize(dofs.rows() > 0 ? dofs.maxCoeff() + 1 : 0, 0);
+    for (Eigen::Index i = 0; i < dofs.rows(); ++i)
+      ++num_dof_cells[dofs[i]];
+  }
+
+  // Build the patches of each chunk of entities, with the number of
+  // cells and dofs of each patch
+  const std::int32_t num_patches = map->size_local();
+  std::vector<std::int32_t> cell_offsets(num_patches + 1, 0);
+  std::vector<std::int32_t> dof_offsets(num_patches + 1, 0);
+  const int num_chunks = std::max(1, std::min(num_threads, num_patches));
+  std::vector<std::vector<std::int32_t>> chunk_cells(num_chunks),
+      chunk_dofs(num_chunks);
+  common::parallel_for(
+      num_threads, num_patches,
+      [&](int chunk, std::int32_t p0, std::int32_t p1) {
+        std::vector<std::int32_t>& cells = chunk_cells[chunk];
+        std::vector<std::int32_t>& dofs = chunk_dofs[chunk];
+        std::vector<std::int32_t> patch_dofs;
+        for (std::int32_t p = p0; p < p1; ++p)
+        {
+          // Cells of the patch
+          const std::size_t c0 = cells.size();
+          if (e_to_c)
+          {
+            auto e_cells = e_to_c->links(p);
+            cells.insert(cells.end(), e_cells.data(),
+                         e_cells.data() + e_cells.rows());
+          }
+          else
+            cells.push_back(p);
+          cell_offsets[p + 1] = cells.size() - c0;
+
+          // Dofs of the patch cells. A dof is in the interior of the
+          // patch if all cells that contain it are in the patch.
+          patch_dofs.clear();
+          for (std::size_t i = c0; i < cells.size(); ++i)
+          {
+            auto cell_dofs = dofmap.links(cells[i]);
+            patch_dofs.insert(patch_dofs.end(), cell_dofs.data(),
+                              cell_dofs.data() + cell_dofs.rows());
+          }
+          std::sort(patch_dofs.begin(), patch_dofs.end());
+          const std::size_t d0 = dofs.size();
+          for (auto it = patch_dofs.begin(); it != patch_dofs.end();)
+          {
+            auto it1 = std::upper_bound(it, patch_dofs.end(), *it);
+            if (!interior or std::distance(it, it1) == num_dof_cells[*it])
+              dofs.push_back(*it);
+            it = it1;
+          }
+          dof_offsets[p + 1] = dofs.size() - d0;
+        }
+      });
+
+  // Concatenate the patches of the chunks
+  std::partial_sum(cell_offsets.begin(), cell_offsets.end(),
+                   cell_offsets.begin());
+  std::partial_sum(dof_offsets.begin(), dof_offsets.end(),
+                   dof_offsets.begin());
+  std::vector<std::int32_t> cells, dofs;
+  cells.reserve(cell_offsets.back());
+  dofs.reserve(dof_offsets.back());
+  for (int i = 0; i < num_chunks; ++i)
+  {
+    cells.insert(cells.end(), chunk_cells[i].begin(), chunk_cells[i].end());
+    dofs.insert(dofs.end(), chunk_dofs[i].begin(), chunk_dofs[i].end());
+  }
+
+  return {graph::AdjacencyList<std::int32_t>(std::move(cells),
+                                             std::move(cell_offsets)),
+          graph::AdjacencyList<std::int32_t>(std::move(dofs),
+                                             std::move(dof_offsets))};
+}
+//-----------------------------------------------------------------------------
+std::array<std::vector<std::int32_t>, 2>
+fem::split_cells_by_ownership(const std::vector<std::int32_t>& cells,
+                              const graph::AdjacencyList<std::int32_t>& dofmap,
+                              std::int32_t size_owned)
+{
+  std::array<std::vector<std::int32_t>, 2> split;
+  for (std::int32_t c : cells)
+  {
+    auto dofs = dofmap.links(c);
+    const bool has_ghost = (dofs >= size_owned).any();
+    split[has_ghost ? 0 : 1].push_back(c);
+  }
+  return split;
+}
+//-----------------------------------------------------------------------------
+fem::BCMarkers fem::create_bc_markers(const DofMap& dofmap,
+                                     const std::vector<bool>& markers)
+{
+  BCMarkers bc;
+  if (markers.empty())
+    return bc;
+
+  bc.dofs.assign(markers.begin(), markers.end());
+  bc.cells.assign(dofmap.list_blocked().num_nodes(), 0);
+  for (std::int32_t c : cells_with_marked_dofs(dofmap, markers))
+    bc.cells[c] = 1;
+  return bc;
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t>
+fem::compute_cell_colouring(const std::vector<std::int32_t>& cells,
+                            const graph::AdjacencyList<std::int32_t>& dofmap,
+                            int num_threads)
+{
+  common::Timer t0("Compute cell colouring");
+
+  const std::int32_t num_cells = cells.size();
+  const std::int32_t num_dofs
+      = dofmap.array().size() > 0 ? dofmap.array().maxCoeff() + 1 : 0;
+
+  // Build map from dof to the (positions in cells of the) cells that
+  // contain the dof
+  std::vector<std::int32_t> offsets(num_dofs + 1, 0);
+  for (std::int32_t c : cells)
+  {
+    auto dofs = dofmap.links(c);
+    for (Eigen::Index i = 0; i < dofs.rows(); ++i)
+      ++offsets[dofs[i] + 1];
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<std::int32_t> dof_to_cell(offsets.back());
+  std::vector<std::int32_t> pos(offsets.begin(), offsets.end() - 1);
+  for (std::int32_t i = 0; i < num_cells; ++i)
+  {
+    auto dofs = dofmap.links(cells[i]);
+    for (Eigen::Index j = 0; j < dofs.rows(); ++j)
+      dof_to_cell[pos[dofs[j]]++] = i;
+  }
+
+  // Build cell-to-cell graph (cells are connected if they share a dof)
+  std::vector<std::vector<std::int32_t>> graph(num_cells);
+  for (std::int32_t i = 0; i < num_cells; ++i)
+  {
+    auto dofs = dofmap.links(cells[i]);
+    std::vector<std::int32_t>& edges = graph[i];
+    for (Eigen::Index j = 0; j < dofs.rows(); ++j)
     {
-      SparsityPatternBuilder::interior_facets(pattern, topology,
-                                              {{dofmaps[0], dofmaps[1]}});
+      edges.insert(edges.end(), dof_to_cell.begin() + offsets[dofs[j]],
+                   dof_to_cell.begin() + offsets[dofs[j] + 1]);
     }
-    else if (type == fem::IntegralType::exterior_facet)
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  }
+
+  // Colour graph
+  const std::vector<std::int32_t> colours = graph::compute_colouring(
+      graph::AdjacencyList<std::int32_t>(graph), num_threads);
+  const std::int32_t num_colours
+      = colours.empty()
+            ? 0
+            : *std::max_element(colours.begin(), colours.end()) + 1;
+
+  // Group cells by colour
+  std::vector<std::int32_t> colour_offsets(num_colours + 1, 0);
+  for (int colour : colours)
+    ++colour_offsets[colour + 1];
+  std::partial_sum(colour_offsets.begin(), colour_offsets.end(),
+                   colour_offsets.begin());
+  std::vector<std::int32_t> coloured_cells(num_cells);
+  pos.assign(colour_offsets.begin(), colour_offsets.end() - 1);
+  for (std::int32_t i = 0; i < num_cells; ++i)
+    coloured_cells[pos[colours[i]]++] = cells[i];
+
+  return graph::AdjacencyList<std::int32_t>(coloured_cells, colour_offsets);
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> fem::compute_interior_facet_colouring(
+    const std::vector<std::int32_t>& facets,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int num_threads)
+{
+  common::Timer t0("Compute interior facet colouring");
+
+  // Build map from facet (position in facets) to the dofs of its two
+  // cells, and colour the facets as cells of this map
+  assert(facets.size() % 4 == 0);
+  const std::int32_t num_facets = facets.size() / 4;
+  std::vector<std::int32_t> facet_dofs, offsets(num_facets + 1, 0);
+  for (std::int32_t f = 0; f < num_facets; ++f)
+  {
+    for (int k = 0; k < 2; ++k)
     {
-      SparsityPatternBuilder::exterior_facets(pattern, topology,
-                                              {{dofmaps[0], dofmaps[1]}});
+      auto dofs = dofmap.links(facets[4 * f + 2 * k]);
+      facet_dofs.insert(facet_dofs.end(), dofs.data(),
+                        dofs.data() + dofs.rows());
     }
+    std::sort(facet_dofs.begin() + offsets[f], facet_dofs.end());
+    facet_dofs.erase(
+        std::unique(facet_dofs.begin() + offsets[f], facet_dofs.end()),
+        facet_dofs.end());
+    offsets[f + 1] = facet_dofs.size();
   }
 
-  t0.stop();
+  std::vector<std::int32_t> positions(num_facets);
+  std::iota(positions.begin(), positions.end(), 0);
+  const graph::AdjacencyList<std::int32_t> colouring = compute_cell_colouring(
+      positions,
+      graph::AdjacencyList<std::int32_t>(std::move(facet_dofs),
+                                         std::move(offsets)),
+      num_threads);
 
-  return pattern;
+  // Gather the facet data of the facets of each colour
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& colour_offsets
+      = colouring.offsets();
+  std::vector<std::int32_t> coloured_facets;
+  coloured_facets.reserve(facets.size());
+  for (Eigen::Index i = 0; i < colouring.array().rows(); ++i)
+  {
+    const std::int32_t f = colouring.array()[i];
+    coloured_facets.insert(coloured_facets.end(), facets.begin() + 4 * f,
+                           facets.begin() + 4 * f + 4);
+  }
+  std::vector<std::int32_t> facet_offsets(colour_offsets.rows());
+  for (Eigen::Index i = 0; i < colour_offsets.rows(); ++i)
+    facet_offsets[i] = 4 * colour_offsets[i];
+
+  return graph::AdjacencyList<std::int32_t>(std::move(coloured_facets),
+                                            std::move(facet_offsets));
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> fem::compute_cell_classes(
+    const std::vector<std::int32_t>& cells, const mesh::Geometry& geometry,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
+    double tol)
+{
+  common::Timer t0("Compute cell classes");
+
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x
+      = geometry.x();
+  const int gdim = geometry.dim();
+  const int num_cells = cells.size();
+
+  // Compute the largest extent of a cell relative to its first
+  // coordinate dof, which sets the scale of the tolerance
+  double h = 0.0;
+  for (std::int32_t c : cells)
+  {
+    auto x_dofs = x_dofmap.links(c);
+    for (Eigen::Index i = 1; i < x_dofs.rows(); ++i)
+    {
+      h = std::max(h, (x.row(x_dofs[i]) - x.row(x_dofs[0]))
+                          .head(gdim)
+                          .abs()
+                          .maxCoeff());
+    }
+  }
+  const double eps = h > 0.0 ? tol * h : tol;
+
+  // Classify cells by their rounded relative coordinate dofs and
+  // permutation data
+  std::map<std::vector<std::int64_t>, std::int32_t> key_to_class;
+  std::vector<std::int32_t> classes(num_cells);
+  std::vector<std::int64_t> key;
+  for (int i = 0; i < num_cells; ++i)
+  {
+    const std::int32_t c = cells[i];
+    auto x_dofs = x_dofmap.links(c);
+    key.clear();
+    for (Eigen::Index j = 1; j < x_dofs.rows(); ++j)
+      for (int k = 0; k < gdim; ++k)
+        key.push_back(std::llround((x(x_dofs[j], k) - x(x_dofs[0], k)) / eps));
+    if (cell_info.rows() > 0)
+      key.push_back(cell_info[c]);
+    auto it = key_to_class
+                  .insert({key, static_cast<std::int32_t>(key_to_class.size())})
+                  .first;
+    classes[i] = it->second;
+  }
+
+  // Group cells by class
+  const std::int32_t num_classes = key_to_class.size();
+  std::vector<std::int32_t> offsets(num_classes + 1, 0);
+  for (std::int32_t c : classes)
+    ++offsets[c + 1];
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<std::int32_t> grouped_cells(num_cells);
+  std::vector<std::int32_t> pos(offsets.begin(), offsets.end() - 1);
+  for (std::int32_t i = 0; i < num_cells; ++i)
+    grouped_cells[pos[classes[i]]++] = cells[i];
+
+  return graph::AdjacencyList<std::int32_t>(grouped_cells, offsets);
+}
+//-----------------------------------------------------------------------------
+Table fem::compute_partition_report(
+    const mesh::Mesh& mesh,
+    const std::vector<std::shared_ptr<const function::FunctionSpace>>& spaces)
+{
+  Table table("Partition report");
+  auto add_row = [&table](const std::string& row, const common::IndexMap& map) {
+    const int bs = map.block_size();
+    const double owned = bs * map.size_local();
+    const double ghost = bs * map.num_ghosts();
+    const auto [src, dest] = dolfinx::MPI::neighbors(map.comm());
+    std::set<int> neighbours(src.begin(), src.end());
+    neighbours.insert(dest.begin(), dest.end());
+    table.set(row, "owned", owned);
+    table.set(row, "ghost", ghost);
+    table.set(row, "ghost/owned", owned > 0 ? ghost / owned : 0.0);
+    table.set(row, "neighbours", (double)neighbours.size());
+    table.set(row, "scatter_fwd [bytes]",
+              (double)(map.shared_indices().size() * bs * sizeof(double)));
+  };
+
+  const mesh::Topology& topology = mesh.topology();
+  const int tdim = topology.dim();
+  std::shared_ptr<const common::IndexMap> map_c = topology.index_map(tdim);
+  assert(map_c);
+  add_row("cells", *map_c);
+  std::shared_ptr<const common::IndexMap> map_v = topology.index_map(0);
+  assert(map_v);
+  add_row("vertices", *map_v);
+  for (std::size_t i = 0; i < spaces.size(); ++i)
+  {
+    assert(spaces[i]);
+    add_row("space " + std::to_string(i),
+            *spaces[i]->dofmap()->index_map);
+  }
+
+  // Count the facets of owned cells that are shared with a cell on
+  // another process. Without ghost cells, these are the facets with
+  // one cell that are not exterior facets.
+  mesh::Topology& topology_mutable = mesh.topology_mutable();
+  topology_mutable.create_entities(tdim - 1);
+  topology_mutable.create_connectivity(tdim - 1, tdim);
+  auto f_to_c = topology.connectivity(tdim - 1, tdim);
+  assert(f_to_c);
+  std::shared_ptr<const common::IndexMap> map_f = topology.index_map(tdim - 1);
+  assert(map_f);
+  const std::int32_t num_owned_cells = map_c->size_local();
+  std::int32_t num_ghost_cells = map_c->num_ghosts();
+  MPI_Allreduce(MPI_IN_PLACE, &num_ghost_cells, 1, MPI_INT32_T, MPI_MAX,
+                mesh.mpi_comm());
+  const std::vector<std::int32_t>& exterior = topology.exterior_facets();
+  std::int32_t edge_cut = 0;
+  for (std::int32_t f = 0; f < f_to_c->num_nodes(); ++f)
+  {
+    auto cells = f_to_c->links(f);
+    const int num_owned = (cells < num_owned_cells).count();
+    if (num_ghost_cells > 0)
+    {
+      if (cells.rows() == 2 and num_owned == 1)
+        ++edge_cut;
+    }
+    else if (cells.rows() == 1
+             and !std::binary_search(exterior.begin(), exterior.end(), f))
+    {
+      ++edge_cut;
+    }
+  }
+  table.set("cells", "edge cut", (double)edge_cut);
+
+  return table;
 }
 //-----------------------------------------------------------------------------
 fem::ElementDofLayout
@@ -177,7 +678,8 @@ fem::create_element_dof_layout(const ufc_dofmap& dofmap,
 }
 //-----------------------------------------------------------------------------
 fem::DofMap fem::create_dofmap(MPI_Comm comm, const ufc_dofmap& ufc_dofmap,
-                               mesh::Topology& topology)
+                               mesh::Topology& topology, DofOrdering ordering,
+                               const std::vector<std::int32_t>& cell_order)
 {
   auto element_dof_layout = std::make_shared<ElementDofLayout>(
       create_element_dof_layout(ufc_dofmap, topology.cell_type()));
@@ -201,9 +703,53 @@ fem::DofMap fem::create_dofmap(MPI_Comm comm, const ufc_dofmap& ufc_dofmap,
     }
   }
 
-  auto [index_map, dofmap]
-      = DofMapBuilder::build(comm, topology, *element_dof_layout);
-  return DofMap(element_dof_layout, index_map, std::move(dofmap));
+  auto [index_map, dofmap] = DofMapBuilder::build_blocked(
+      comm, topology, *element_dof_layout, ordering, cell_order);
+  const int bs = element_dof_layout->block_size();
+  return DofMap(element_dof_layout, index_map, std::move(dofmap), bs);
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<const fem::DofMap>
+fem::create_shared_dofmap(MPI_Comm comm, const ufc_dofmap& ufc_dofmap,
+                          mesh::Topology& topology, DofOrdering ordering,
+                          const std::vector<std::int32_t>& cell_order)
+{
+  if (!cell_order.empty() or !ufc_dofmap.signature)
+  {
+    return std::make_shared<const DofMap>(
+        create_dofmap(comm, ufc_dofmap, topology, ordering, cell_order));
+  }
+
+  // Cache of dof maps in use, keyed by (topology id, ufc_dofmap
+  // signature, ordering)
+  using Key = std::tuple<std::size_t, std::string, int>;
+  static std::map<Key, std::weak_ptr<const DofMap>> cache;
+  static std::mutex cache_mutex;
+
+  const Key key(topology.id(), ufc_dofmap.signature,
+                static_cast<int>(ordering));
+  std::shared_ptr<const DofMap> dofmap;
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    for (auto it = cache.begin(); it != cache.end();)
+      it = it->second.expired() ? cache.erase(it) : std::next(it);
+    if (auto it = cache.find(key); it != cache.end())
+      dofmap = it->second.lock();
+  }
+
+  // The dof map is only reused if it is in use on all processes, since
+  // creating a dof map is collective
+  const int found_local = dofmap ? 1 : 0;
+  int found = 0;
+  MPI_Allreduce(&found_local, &found, 1, MPI_INT, MPI_MIN, comm);
+  if (found)
+    return dofmap;
+
+  dofmap = std::make_shared<const DofMap>(
+      create_dofmap(comm, ufc_dofmap, topology, ordering));
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  cache[key] = dofmap;
+  return dofmap;
 }
 //-----------------------------------------------------------------------------
 fem::CoordinateElement
@@ -252,8 +798,8 @@ fem::create_functionspace(ufc_function_space* (*fptr)(const char*),
   ufc_finite_element* ufc_element = space->create_element();
   auto V = std::make_shared<function::FunctionSpace>(
       mesh, std::make_shared<fem::FiniteElement>(*ufc_element),
-      std::make_shared<fem::DofMap>(
-          fem::create_dofmap(mesh->mpi_comm(), *ufc_map, mesh->topology())));
+      fem::create_shared_dofmap(mesh->mpi_comm(), *ufc_map,
+                                mesh->topology()));
   std::free(ufc_element);
   std::free(ufc_map);
   std::free(space);
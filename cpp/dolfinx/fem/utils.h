@@ -8,15 +8,22 @@
 
 #include "CoordinateElement.h"
 #include "DofMap.h"
+#include "DofMapBuilder.h"
 #include "ElementDofLayout.h"
+#include <array>
+#include <dolfinx/common/AlignedAllocator.h>
+#include <dolfinx/common/Table.h>
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/common/types.h>
 #include <dolfinx/fem/Form.h>
 #include <dolfinx/function/Function.h>
 #include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/cell_types.h>
 #include <memory>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <ufc.h>
 #include <utility>
 #include <vector>
@@ -73,13 +80,13 @@ extract_function_spaces(
   return spaces;
 }
 
-/// Create a sparsity pattern for a given form. The pattern is not
-/// finalised, i.e. the caller is responsible for calling
-/// SparsityPattern::assemble.
-/// @param[in] a A bilinear form
-/// @return The corresponding sparsity pattern
+namespace impl
+{
+/// Get the integral types of a bilinear form for building its sparsity
+/// pattern, and create the facet connectivity needed by the facet
+/// integrals
 template <typename T>
-la::SparsityPattern create_sparsity_pattern(const Form<T>& a)
+std::set<IntegralType> sparsity_integral_types(const Form<T>& a)
 {
   if (a.rank() != 2)
   {
@@ -87,12 +94,8 @@ la::SparsityPattern create_sparsity_pattern(const Form<T>& a)
         "Cannot create sparsity pattern. Form is not a bilinear form");
   }
 
-  // Get dof maps and mesh
-  std::array dofmaps{a.function_space(0)->dofmap().get(),
-                     a.function_space(1)->dofmap().get()};
   std::shared_ptr mesh = a.mesh();
   assert(mesh);
-
   const std::set<IntegralType> types = a.integrals().types();
   if (types.find(IntegralType::interior_facet) != types.end()
       or types.find(IntegralType::exterior_facet) != types.end())
@@ -102,17 +105,233 @@ la::SparsityPattern create_sparsity_pattern(const Form<T>& a)
     mesh->topology_mutable().create_entities(tdim - 1);
     mesh->topology_mutable().create_connectivity(tdim - 1, tdim);
   }
-
-  return create_sparsity_pattern(mesh->topology(), dofmaps, types);
+  return types;
 }
+} // namespace impl
 
 /// Create a sparsity pattern for a given form. The pattern is not
 /// finalised, i.e. the caller is responsible for calling
 /// SparsityPattern::assemble.
+/// @param[in] a A bilinear form
+/// @param[in] blocked If true and the dofmaps of the test and trial
+///   spaces consist of complete blocks of the same size bs > 1 (see
+///   DofMap::bs), the pattern is created in block form
+/// @return The corresponding sparsity pattern
+template <typename T>
+la::SparsityPattern create_sparsity_pattern(const Form<T>& a,
+                                            bool blocked = false)
+{
+  const std::set<IntegralType> types = impl::sparsity_integral_types(a);
+  std::array dofmaps{a.function_space(0)->dofmap().get(),
+                     a.function_space(1)->dofmap().get()};
+  return create_sparsity_pattern(a.mesh()->topology(), dofmaps, types,
+                                 blocked, a.num_threads());
+}
+
+/// Create the sparsity pattern of the local (subdomain) matrix of a
+/// bilinear form, e.g. for an unassembled (MATIS) matrix. See
+/// create_local_sparsity_pattern(const mesh::Topology&, const
+/// std::array<const DofMap*, 2>&, const std::set<IntegralType>&, bool,
+/// int).
+/// @param[in] a A bilinear form
+/// @param[in] blocked Create the pattern in block form if possible (see
+///   create_sparsity_pattern)
+/// @return The local sparsity pattern
+template <typename T>
+la::SparsityPattern create_local_sparsity_pattern(const Form<T>& a,
+                                                  bool blocked = false)
+{
+  const std::set<IntegralType> types = impl::sparsity_integral_types(a);
+  std::array dofmaps{a.function_space(0)->dofmap().get(),
+                     a.function_space(1)->dofmap().get()};
+  return create_local_sparsity_pattern(a.mesh()->topology(), dofmaps, types,
+                                       blocked, a.num_threads());
+}
+
+/// Create a sparsity pattern for a given form. The pattern is not
+/// finalised, i.e. the caller is responsible for calling
+/// SparsityPattern::assemble. See create_sparsity_pattern(const
+/// Form<T>&, bool) for the meaning of blocked. The rows of the cell
+/// entries are compressed by @p num_threads threads.
 la::SparsityPattern
 create_sparsity_pattern(const mesh::Topology& topology,
                         const std::array<const DofMap*, 2>& dofmaps,
-                        const std::set<IntegralType>& integrals);
+                        const std::set<IntegralType>& integrals,
+                        bool blocked = false, int num_threads = 1);
+
+/// Create the sparsity pattern of the local (subdomain) matrix on this
+/// process. The rows and columns are the local (owned and ghost)
+/// indices of the dofmaps, and the pattern holds the entries of the
+/// integrals of this process only, i.e. no entries are communicated.
+/// The pattern is on MPI_COMM_SELF and is not finalised. See
+/// create_sparsity_pattern for the arguments.
+la::SparsityPattern
+create_local_sparsity_pattern(const mesh::Topology& topology,
+                              const std::array<const DofMap*, 2>& dofmaps,
+                              const std::set<IntegralType>& integrals,
+                              bool blocked = false, int num_threads = 1);
+
+/// Colour a list of cells such that no two cells of the same colour
+/// share a degree of freedom
+/// @param[in] cells The cells to colour
+/// @param[in] dofmap The dofmap (cell -> dofs) used to determine which
+///   cells are connected
+/// @param[in] num_threads The number of threads used to colour the
+///   cell graph (see graph::compute_colouring)
+/// @return Adjacency list from colour to the cells of that colour. The
+///   cells for each colour are in the order in which they appear in
+///   @p cells.
+graph::AdjacencyList<std::int32_t>
+compute_cell_colouring(const std::vector<std::int32_t>& cells,
+                       const graph::AdjacencyList<std::int32_t>& dofmap,
+                       int num_threads = 1);
+
+/// Colour the facets of an interior facet integral such that no two
+/// facets of the same colour share a degree of freedom, i.e. the
+/// facets of a colour can be assembled concurrently. The dofs of a
+/// facet are the dofs of its two attached cells.
+/// @param[in] facets The attached cells and local facet indices of the
+///   facets (see FormIntegrals::facet_domains)
+/// @param[in] dofmap The dofmap (cell -> dofs) used to determine which
+///   facets are connected
+/// @param[in] num_threads The number of threads used to colour the
+///   facet graph (see graph::compute_colouring)
+/// @return Adjacency list from colour to the attached cells and local
+///   facet indices of the facets of that colour, in the layout of @p
+///   facets. The facets of each colour are in the order in which they
+///   appear in @p facets.
+graph::AdjacencyList<std::int32_t>
+compute_interior_facet_colouring(
+    const std::vector<std::int32_t>& facets,
+    const graph::AdjacencyList<std::int32_t>& dofmap, int num_threads = 1);
+
+/// Group a list of cells into classes of cells that are translations
+/// of each other, i.e. cells whose coordinate dofs relative to the
+/// first coordinate dof agree (up to a tolerance) and which have the
+/// same permutation data. On structured meshes the number of classes
+/// is typically small.
+/// @param[in] cells The cells to classify
+/// @param[in] geometry The mesh geometry
+/// @param[in] cell_info The cell permutation data. Pass an empty array
+///   if permutation data is not used.
+/// @param[in] tol Tolerance, relative to the largest extent of a cell
+/// @return Adjacency list from class to the cells of that class. The
+///   cells of each class are in the order in which they appear in @p
+///   cells.
+graph::AdjacencyList<std::int32_t>
+compute_cell_classes(const std::vector<std::int32_t>& cells,
+                     const mesh::Geometry& geometry,
+                     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>&
+                         cell_info,
+                     double tol = 1.0e-10);
+
+/// Compute a report on the quality of the cell partition of a mesh,
+/// for the cells and vertices of the mesh and the dofs of function
+/// spaces on the mesh, on this process (collective). The table has the
+/// rows "cells", "vertices" and "space i" for the ith space in @p
+/// spaces, and the columns
+///
+/// - "owned", "ghost": the numbers of owned and ghost indices
+/// - "ghost/owned": the ratio of ghost to owned indices
+/// - "neighbours": the number of neighbour processes of the index map
+/// - "scatter_fwd [bytes]": the number of bytes sent by scatter_fwd
+///   for one double per (unblocked) index
+///
+/// and the "cells" row has the column "edge cut": the number of facets
+/// shared by an owned cell and a cell on another process. The sum over
+/// all processes is twice the edge cut of the cell partition. All
+/// values are doubles, and the table is aggregated over the processes
+/// with Table::reduce.
+/// @param[in] mesh The mesh. The facets and the facet-cell connectivity
+///   are created if they do not exist.
+/// @param[in] spaces Function spaces on @p mesh
+/// @return The report for this process
+Table compute_partition_report(
+    const mesh::Mesh& mesh,
+    const std::vector<std::shared_ptr<const function::FunctionSpace>>& spaces
+    = {});
+
+/// Compute overlapping subdomains of the owned cells of a function
+/// space, and return the dofs of each subdomain, e.g. for the local
+/// subdomains of the PETSc additive Schwarz preconditioners (PCASM,
+/// PCGASM). The facet-connected graph of the owned cells on this
+/// process is partitioned into @p num_subdomains parts (see
+/// graph::compute_subdomains), and each part is extended by @p overlap
+/// layers of cells.
+/// @param[in] V The function space
+/// @param[in] num_subdomains The number of subdomains on this process
+/// @param[in] overlap The number of layers of cells added to each part
+/// @return Adjacency list from subdomain to its (sorted, unblocked)
+///   global dof indices. The dofs include the ghost dofs of the cells
+///   in the subdomain.
+graph::AdjacencyList<std::int64_t>
+compute_subdomain_dofs(const function::FunctionSpace& V, int num_subdomains,
+                       int overlap = 1);
+
+/// Compute the patches of the owned mesh entities of a dimension, e.g.
+/// for patch (PETSc PCPATCH) or Vanka smoothers. The patch of an entity
+/// is the set of cells that contain it, e.g. the star of a vertex
+/// (dim = 0), and the patch of a cell (dim = tdim) is the cell. The
+/// patch dofs are the dofs of the patch cells, or only the dofs that
+/// belong to no other cells (the interior of the patch), e.g. for a
+/// vertex star smoother. Patches of entities at a process boundary
+/// are complete only if the mesh has the cells of the entities as
+/// ghosts (e.g. mesh::GhostMode::shared_vertex for vertex stars).
+/// @param[in] V The function space
+/// @param[in] dim The topological dimension of the entities. The
+///   entity-cell connectivity must have been computed if dim is less
+///   than the cell dimension.
+/// @param[in] interior If true, only include the dofs of the interior
+///   of each patch
+/// @param[in] num_threads The number of threads
+/// @return Adjacency lists from the owned entities to the cells of
+///   their patches (0) and to the (sorted, unblocked) local dof indices
+///   of their patches (1)
+std::pair<graph::AdjacencyList<std::int32_t>,
+          graph::AdjacencyList<std::int32_t>>
+compute_patches(const function::FunctionSpace& V, int dim,
+                bool interior = false, int num_threads = 1);
+
+/// Split a list of cells into the cells that have at least one ghost
+/// dof and the cells whose dofs are all owned. Used to overlap the
+/// communication of ghost contributions with assembly.
+/// @param[in] cells The cells to split
+/// @param[in] dofmap The dofmap (cell -> dofs)
+/// @param[in] size_owned Number of owned dofs. Dofs with index >=
+///   size_owned are ghosts.
+/// @return The cells with ghost dofs (0) and the cells with only owned
+///   dofs (1), each in the order in which they appear in @p cells
+std::array<std::vector<std::int32_t>, 2>
+split_cells_by_ownership(const std::vector<std::int32_t>& cells,
+                         const graph::AdjacencyList<std::int32_t>& dofmap,
+                         std::int32_t size_owned);
+
+/// Dirichlet boundary condition markers of the rows or columns of a
+/// matrix in assembly. The markers are bytes rather than bits so that
+/// they can be read without bit manipulation, and cells without
+/// constrained dofs are flagged so that their element matrices are not
+/// checked.
+struct BCMarkers
+{
+  /// Dof markers (local, unrolled indices). dofs[i] is 1 if dof i has
+  /// a boundary condition applied and 0 otherwise. Empty if no
+  /// boundary condition applies.
+  std::vector<std::int8_t> dofs;
+
+  /// Cell markers. cells[c] is 1 if cell c has at least one dof with a
+  /// boundary condition applied and 0 otherwise. Empty if no boundary
+  /// condition applies.
+  std::vector<std::int8_t> cells;
+};
+
+/// Create boundary condition markers from dof markers
+/// @param[in] dofmap The dofmap for the dofs
+/// @param[in] markers Dof markers (local, unrolled indices). Dof i has
+///   a boundary condition applied if markers[i] is true. Can be empty
+///   if no boundary condition applies.
+/// @return The dof and cell markers
+BCMarkers create_bc_markers(const DofMap& dofmap,
+                            const std::vector<bool>& markers);
 
 /// Create an ElementDofLayout from a ufc_dofmap
 ElementDofLayout create_element_dof_layout(const ufc_dofmap& dofmap,
@@ -124,8 +343,30 @@ ElementDofLayout create_element_dof_layout(const ufc_dofmap& dofmap,
 /// @param[in] comm MPI communicator
 /// @param[in] dofmap The ufc_dofmap
 /// @param[in] topology The mesh topology
+/// @param[in] ordering The strategy for ordering the owned dofs
+/// @param[in] cell_order The order of the cells for DofOrdering::cell,
+///   see DofMapBuilder::build
 DofMap create_dofmap(MPI_Comm comm, const ufc_dofmap& dofmap,
-                     mesh::Topology& topology);
+                     mesh::Topology& topology,
+                     DofOrdering ordering = DofOrdering::gps,
+                     const std::vector<std::int32_t>& cell_order = {});
+
+/// Create dof map on mesh from a ufc_dofmap, or return a dof map
+/// created earlier for the same topology, ufc_dofmap signature and
+/// ordering that is still in use (collective). Function spaces with
+/// identical dof layouts on a mesh can then share one DofMap and
+/// IndexMap. A dof map with a @p cell_order is not shared.
+/// @param[in] comm MPI communicator
+/// @param[in] dofmap The ufc_dofmap
+/// @param[in] topology The mesh topology
+/// @param[in] ordering The strategy for ordering the owned dofs
+/// @param[in] cell_order The order of the cells for DofOrdering::cell,
+///   see DofMapBuilder::build
+std::shared_ptr<const DofMap>
+create_shared_dofmap(MPI_Comm comm, const ufc_dofmap& dofmap,
+                     mesh::Topology& topology,
+                     DofOrdering ordering = DofOrdering::gps,
+                     const std::vector<std::int32_t>& cell_order = {});
 
 /// Extract coefficients from a UFC form
 template <typename T>
@@ -168,6 +409,10 @@ Form<T> create_form(
     const ufc_form& ufc_form,
     const std::vector<std::shared_ptr<const function::FunctionSpace>>& spaces)
 {
+  static_assert(std::is_same<T, ufc_scalar_t>::value,
+                "UFC kernels are only available for ufc_scalar_t. Assemble "
+                "into a matrix of another scalar type via the insertion "
+                "function, e.g. la::MatrixCSR::mat_add_values.");
   assert(ufc_form.rank == (int)spaces.size());
 
   // Check argument function spaces
@@ -308,66 +553,286 @@ create_functionspace(ufc_function_space* (*fptr)(const char*),
                      std::shared_ptr<mesh::Mesh> mesh);
 
 // NOTE: This is subject to change
-/// Pack form coefficients ready for assembly
+/// Pack form coefficients ready for assembly. The packed array is
+/// cached on the form, and only coefficients that have been modified
+/// since the previous call are repacked (see FormCoefficients::pack).
+/// Only the cells referenced by the integrals of the form are packed
+/// (see FormIntegrals::active_cells), once for all integral types.
+/// @param[in] form The form
+/// @return The packed coefficients, with one row per (owned and ghost)
+///   cell. The rows of cells that are not referenced by the integrals
+///   are not set. The reference is valid until the form coefficients
+///   are packed again.
 template <typename T>
-Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
 pack_coefficients(const fem::Form<T>& form)
 {
-  // Get form coefficient offsets amd dofmaps
-  const fem::FormCoefficients<T>& coefficients = form.coefficients();
-  const std::vector<int>& offsets = coefficients.offsets();
-  std::vector<const fem::DofMap*> dofmaps(coefficients.size());
-  std::vector<Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>> v;
-  for (int i = 0; i < coefficients.size(); ++i)
-  {
-    dofmaps[i] = coefficients.get(i)->function_space()->dofmap().get();
-    v.emplace_back(coefficients.get(i)->x()->array());
-  }
-
-  // Get mesh
+  common::Timer timer("Pack coefficients");
   std::shared_ptr<const mesh::Mesh> mesh = form.mesh();
   assert(mesh);
   const int tdim = mesh->topology().dim();
   const std::int32_t num_cells
       = mesh->topology().index_map(tdim)->size_local()
         + mesh->topology().index_map(tdim)->num_ghosts();
+  return form.coefficients().pack(num_cells,
+                                  form.integrals().active_cells(num_cells));
+}
+
+// NOTE: This is subject to change
+/// Pack form constants ready for assembly. The values are copied into
+/// storage that persists on the form (see Form::packed_constants).
+/// @param[in] form The form
+/// @return The packed constants. The reference is valid until the form
+///   constants are packed again.
+template <typename T>
+const Eigen::Array<T, Eigen::Dynamic, 1>&
+pack_constants(const fem::Form<T>& form)
+{
+  return form.packed_constants();
+}
+
+namespace impl
+{
+/// Call fn(kernel) with the 'tabulate_tensor' function of integral i
+/// of the given type. The kernel is the plain function pointer if it
+/// is available (see FormIntegrals::get_tabulate_tensor_ptr), so that
+/// the assembly loops instantiated by @p fn call it without the
+/// std::function indirection, and the std::function otherwise.
+template <typename T, typename Fn>
+void dispatch_kernel(const FormIntegrals<T>& integrals, IntegralType type,
+                     int i, const Fn& fn)
+{
+  if (auto kernel = integrals.get_tabulate_tensor_ptr(type, i))
+    fn(kernel);
+  else
+    fn(integrals.get_tabulate_tensor(type, i));
+}
 
-  // Copy data into coefficient array
-  Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> c(
-      num_cells, offsets.back());
-  if (coefficients.size() > 0)
+/// Get the colouring of the cells of the ith cell integral of a form
+/// with respect to the test space dofmap. The colouring is computed on
+/// first call and cached by the form integrals.
+template <typename T>
+std::shared_ptr<const graph::AdjacencyList<std::int32_t>>
+cell_colouring(const Form<T>& form, int i)
+{
+  const FormIntegrals<T>& integrals = form.integrals();
+  std::shared_ptr<const graph::AdjacencyList<std::int32_t>> colouring
+      = integrals.colouring(IntegralType::cell, i);
+  if (!colouring)
   {
-    for (int cell = 0; cell < num_cells; ++cell)
-    {
-      for (std::size_t coeff = 0; coeff < dofmaps.size(); ++coeff)
-      {
-        auto dofs = dofmaps[coeff]->cell_dofs(cell);
-        const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& _v
-            = v[coeff];
-        for (Eigen::Index k = 0; k < dofs.size(); ++k)
-          c(cell, k + offsets[coeff]) = _v[dofs[k]];
-      }
-    }
+    assert(form.rank() > 0);
+    colouring = std::make_shared<graph::AdjacencyList<std::int32_t>>(
+        compute_cell_colouring(
+            integrals.integral_domains(IntegralType::cell, i),
+            form.function_space(0)->dofmap()->list_blocked(),
+            form.num_threads()));
+    integrals.set_colouring(IntegralType::cell, i, colouring);
   }
+  return colouring;
+}
 
-  return c;
+/// Get the colouring of the facets of the ith interior facet integral
+/// of a form with respect to the test space dofmap (see
+/// compute_interior_facet_colouring). The colouring is computed on
+/// first call and cached by the form integrals.
+template <typename T>
+std::shared_ptr<const graph::AdjacencyList<std::int32_t>>
+interior_facet_colouring(const Form<T>& form, int i)
+{
+  const FormIntegrals<T>& integrals = form.integrals();
+  std::shared_ptr<const graph::AdjacencyList<std::int32_t>> colouring
+      = integrals.colouring(IntegralType::interior_facet, i);
+  if (!colouring)
+  {
+    assert(form.rank() > 0);
+    colouring = std::make_shared<graph::AdjacencyList<std::int32_t>>(
+        compute_interior_facet_colouring(
+            integrals.facet_domains(IntegralType::interior_facet, i),
+            form.function_space(0)->dofmap()->list_blocked(),
+            form.num_threads()));
+    integrals.set_colouring(IntegralType::interior_facet, i, colouring);
+  }
+  return colouring;
 }
 
-// NOTE: This is subject to change
-/// Pack form constants ready for assembly
+/// Get the classes of translated cells of the ith cell integral of a
+/// form, computing them if they are not cached or if the geometry has
+/// changed since they were computed
+/// @param[in] form The form
+/// @param[in] i The index of the cell integral
+/// @param[in] cell_info The cell permutation data, or an empty array
+/// @return Adjacency list from class to cells
+template <typename T>
+std::shared_ptr<const graph::AdjacencyList<std::int32_t>>
+cell_classes(const Form<T>& form, int i,
+             const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info)
+{
+  const FormIntegrals<T>& integrals = form.integrals();
+  const mesh::Geometry& geometry = form.mesh()->geometry();
+  auto [classes, version] = integrals.cell_classes(IntegralType::cell, i);
+  if (!classes or version != geometry.x_version())
+  {
+    classes = std::make_shared<graph::AdjacencyList<std::int32_t>>(
+        compute_cell_classes(integrals.integral_domains(IntegralType::cell, i),
+                             geometry, cell_info));
+    integrals.set_cell_classes(IntegralType::cell, i, classes,
+                               geometry.x_version());
+  }
+  return classes;
+}
+
+/// Access to the coordinate dofs of cells as row-major (num_dofs x
+/// gdim) arrays, the layout passed to kernels. If the geometry caches
+/// packed cell coordinates (see mesh::Geometry::cell_coordinates), the
+/// data is read directly from the cache. Otherwise it is gathered from
+/// the geometry into a work array. In both cases the coordinate dofs
+/// are aligned and padded as described by
+/// FormIntegrals::workspace_alignment.
+class CellCoordinates
+{
+public:
+  /// Create cell coordinate access for a geometry. Builds the geometry
+  /// cell coordinate cache if it is enabled and out of date, and must
+  /// therefore not be called concurrently in that case.
+  /// @param[in] geometry The geometry
+  explicit CellCoordinates(const mesh::Geometry& geometry)
+      : _x_dofmap(geometry.dofmap()), _x(geometry.x()),
+        _cache(geometry.cell_coordinates()),
+        _stride(geometry.cell_coordinates_stride()), _gdim(geometry.dim()),
+        _num_dofs(_x_dofmap.num_nodes() > 0 ? _x_dofmap.num_links(0) : 0)
+  {
+    if (!_cache)
+      _work.resize(_stride, 0);
+  }
+
+  /// Get the coordinate dofs of a cell
+  /// @param[in] c The cell index
+  /// @return Pointer to the coordinate dofs. It is valid until the next
+  ///   call.
+  const double* operator()(std::int32_t c)
+  {
+    if (_cache)
+      return _cache->data() + std::size_t(c) * _stride;
+
+    auto x_dofs = _x_dofmap.links(c);
+    for (int i = 0; i < _num_dofs; ++i)
+      for (int j = 0; j < _gdim; ++j)
+        _work[i * _gdim + j] = _x(x_dofs[i], j);
+    return _work.data();
+  }
+
+  /// Number of coordinate dofs per cell
+  int num_dofs() const { return _num_dofs; }
+
+  /// Geometric dimension
+  int dim() const { return _gdim; }
+
+private:
+  const graph::AdjacencyList<std::int32_t>& _x_dofmap;
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& _x;
+  const common::aligned_vector<double>* _cache;
+  std::size_t _stride;
+  int _gdim, _num_dofs;
+  common::aligned_vector<double> _work;
+};
+
+/// Work array for the element tensors passed to kernels. The storage
+/// is aligned and padded as described by
+/// FormIntegrals::workspace_alignment, so that kernels can use aligned
+/// loads and stores of full SIMD registers. The padding is zeroed with
+/// the tensor and is not read by the assemblers.
 template <typename T>
-Eigen::Array<T, Eigen::Dynamic, 1> pack_constants(const fem::Form<T>& form)
+class ElementTensor
 {
-  std::vector<T> constant_values;
-  for (auto& constant : form.constants())
+public:
+  /// Row-major view of the tensor as an (aligned) Eigen matrix
+  using Matrix
+      = Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic,
+                                 Eigen::RowMajor>,
+                   Eigen::Aligned64>;
+
+  /// Create an empty tensor
+  ElementTensor() = default;
+
+  /// Create a zero (rows x cols) tensor
+  ElementTensor(int rows, int cols) { set_zero(rows, cols); }
+
+  /// Set the size of the tensor and zero it
+  void set_zero(int rows, int cols)
   {
-    const std::vector<T>& array = constant.second->value;
-    constant_values.insert(constant_values.end(), array.begin(), array.end());
+    resize(rows, cols);
+    set_zero();
   }
 
-  return Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>(
-      constant_values.data(), constant_values.size(), 1);
+  /// Zero the tensor
+  void set_zero() { std::fill(_data.begin(), _data.end(), 0); }
+
+  /// Pointer to the values
+  T* data() { return _data.data(); }
+
+  /// Number of values (without the padding)
+  std::size_t size() const { return std::size_t(_rows) * _cols; }
+
+  /// Row-major view of the tensor, which is invalidated by a change of
+  /// the size
+  Matrix matrix() { return Matrix(_data.data(), _rows, _cols); }
+
+private:
+  void resize(int rows, int cols)
+  {
+    _rows = rows;
+    _cols = cols;
+    _data.resize(common::padded_size<T>(size()));
+  }
+
+  int _rows = 0, _cols = 0;
+  common::aligned_vector<T> _data;
+};
+
+/// Pack the coordinate dofs, coefficients and permutation data of the
+/// cells cells[0], ..., cells[n - 1] into the interleaved
+/// (structure-of-arrays) layout used by batched kernels, i.e. entry k
+/// of cell l is stored at position k * batch_size + l. Unused lanes
+/// (l >= n) are filled with the data of cells[0] so that the kernel
+/// always operates on valid input.
+/// @param[in] cells Cells in the batch
+/// @param[in] n Number of cells in the batch (n <= batch_size)
+/// @param[in] batch_size Width of the batch
+/// @param[in] geometry Mesh geometry
+/// @param[in] coeffs Packed coefficients, one row per cell
+/// @param[in] cell_info Cell permutation data
+/// @param[out] coordinate_dofs Interleaved coordinate dofs
+/// @param[out] w Interleaved coefficients
+/// @param[out] info Cell permutation data of each lane
+template <typename T>
+void pack_cell_batch(
+    const std::int32_t* cells, int n, int batch_size,
+    const mesh::Geometry& geometry,
+    const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        coeffs,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info,
+    std::vector<double>& coordinate_dofs, std::vector<T>& w,
+    std::vector<std::uint32_t>& info)
+{
+  assert(n > 0 and n <= batch_size);
+  CellCoordinates cell_coordinates(geometry);
+  const int num_entries = cell_coordinates.num_dofs() * cell_coordinates.dim();
+
+  coordinate_dofs.resize(num_entries * batch_size);
+  w.resize(coeffs.cols() * batch_size);
+  info.resize(batch_size);
+  for (int l = 0; l < batch_size; ++l)
+  {
+    const std::int32_t c = l < n ? cells[l] : cells[0];
+    const double* x = cell_coordinates(c);
+    for (int k = 0; k < num_entries; ++k)
+      coordinate_dofs[k * batch_size + l] = x[k];
+    for (Eigen::Index k = 0; k < coeffs.cols(); ++k)
+      w[k * batch_size + l] = coeffs(c, k);
+    info[l] = cell_info[c];
+  }
 }
+} // namespace impl
 
 } // namespace fem
 } // namespace dolfinx
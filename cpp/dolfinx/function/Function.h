@@ -13,14 +13,18 @@
 #include <dolfinx/common/UniqueIdGenerator.h>
 #include <dolfinx/common/types.h>
 #include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/ElementDofLayout.h>
 #include <dolfinx/fem/FiniteElement.h>
 #include <dolfinx/la/PETScVector.h>
 #include <dolfinx/la/Vector.h>
+#include <dolfinx/la/VectorPool.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/Topology.h>
+#include <algorithm>
 #include <functional>
 #include <memory>
+#include <numeric>
 #include <petscvec.h>
 #include <string>
 #include <vector>
@@ -55,6 +59,25 @@ public:
     _x->array().setZero();
   }
 
+  /// Create function on given function space, with the vector of
+  /// expansion coefficients taken from a pool. The vector is returned
+  /// to the pool when it is no longer used, which avoids repeated
+  /// allocation for temporary functions.
+  /// @param[in] V The function space
+  /// @param[in] pool The pool of vectors
+  Function(std::shared_ptr<const FunctionSpace> V,
+           la::VectorPool<la::Vector<T>>& pool)
+      : _id(common::UniqueIdGenerator::id()), _function_space(V),
+        _x(pool.get(V->dofmap()->index_map))
+  {
+    if (!V->component().empty())
+    {
+      throw std::runtime_error("Cannot create Function from subspace. Consider "
+                               "collapsing the function space");
+    }
+    _x->array().setZero();
+  }
+
   /// Create function on given function space with a given vector
   ///
   /// *Warning: This constructor is intended for internal library use only*
@@ -109,9 +132,9 @@ public:
   /// @return New collapsed Function
   Function collapse() const
   {
-    // Create new collapsed FunctionSpace
+    // Get the (cached) collapsed FunctionSpace
     const auto [function_space_new, collapsed_map]
-        = _function_space->collapse();
+        = _function_space->collapsed();
 
     // Create new vector
     assert(function_space_new);
@@ -119,18 +142,23 @@ public:
         function_space_new->dofmap()->index_map);
 
     // Copy values into new vector
-    const Eigen::Matrix<T, Eigen::Dynamic, 1>& x_old = _x->array();
-    Eigen::Matrix<T, Eigen::Dynamic, 1>& x_new = vector_new->array();
-    for (std::size_t i = 0; i < collapsed_map.size(); ++i)
-    {
-      assert((int)i < x_new.size());
-      assert(collapsed_map[i] < x_old.size());
-      x_new[i] = x_old[collapsed_map[i]];
-    }
+    assert(vector_new->array().size() == (int)collapsed_map->size());
+    la::VectorView<T>(_x, collapsed_map).get(vector_new->array());
 
     return Function(function_space_new, vector_new);
   }
 
+  /// View of the expansion coefficients of a subfunction in the order
+  /// of the dofs of the collapsed space (see FunctionSpace::collapsed),
+  /// without copying the coefficients
+  /// @return The view into the vector of the Function
+  la::VectorView<T> collapsed_view() const
+  {
+    const auto [function_space_new, collapsed_map]
+        = _function_space->collapsed();
+    return la::VectorView<T>(_x, collapsed_map);
+  }
+
   /// Return shared pointer to function space
   /// @return The function space
   std::shared_ptr<const FunctionSpace> function_space() const
@@ -171,6 +199,33 @@ public:
     }
   }
 
+  /// Modification counter of the expansion coefficients. It changes
+  /// when the coefficients are modified through x() (see
+  /// la::Vector::version) or through the PETSc Vec returned by
+  /// vector(), including its local form and ghost updates.
+  /// @return The modification counter
+  std::int64_t version() const
+  {
+    std::int64_t version = _x->version();
+    if (_petsc_vector)
+    {
+      // Changes to the local (ghosted) form are not always reflected
+      // in the state of the global Vec
+      PetscObjectState state = 0;
+      PetscObjectStateGet((PetscObject)_petsc_vector, &state);
+      version += state;
+      Vec x_local = nullptr;
+      VecGhostGetLocalForm(_petsc_vector, &x_local);
+      if (x_local)
+      {
+        PetscObjectStateGet((PetscObject)x_local, &state);
+        version += state;
+      }
+      VecGhostRestoreLocalForm(_petsc_vector, &x_local);
+    }
+    return version;
+  }
+
   /// Underlying vector
   std::shared_ptr<const la::Vector<T>> x() const { return _x; }
 
@@ -192,7 +247,12 @@ public:
     function::interpolate(*this, f);
   }
 
-  /// Evaluate the Function at points
+  /// Evaluate the Function at points. The points are grouped by cell,
+  /// and all points in a cell are mapped to the reference cell and
+  /// tabulated in one call. The work arrays are reused for cells with
+  /// the same number of points. For mixed spaces, each (possibly
+  /// blocked) sub-element is evaluated directly from the dofs of the
+  /// cell, without creating sub-functions.
   ///
   /// @param[in] x The coordinates of the points. It has shape
   ///   (num_points, 3).
@@ -210,9 +270,6 @@ public:
            Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
            u) const
   {
-    // TODO: This could be easily made more efficient by exploiting points
-    // being ordered by the cell to which they belong.
-
     if (x.rows() != cells.rows())
     {
       throw std::runtime_error(
@@ -246,110 +303,130 @@ public:
     // Get coordinate map
     const fem::CoordinateElement& cmap = mesh->geometry().cmap();
 
-    // Get element
+    // Get element and dofmap
     assert(_function_space->element());
     std::shared_ptr<const fem::FiniteElement> element
         = _function_space->element();
     assert(element);
-    const int block_size = element->block_size();
-    const int reference_value_size
-        = element->reference_value_size() / block_size;
-    const int value_size = element->value_size() / block_size;
-    const int space_dimension = element->space_dimension() / block_size;
-
-    // If the space has sub elements, concatenate the evaluations on the sub
-    // elements
-    const int num_sub_elements = element->num_sub_elements();
-    if (num_sub_elements > 1 && num_sub_elements != block_size)
-    {
-      if (block_size != 1)
-        throw std::runtime_error(
-            "Blocked elements of mixed spaces are not yet supported.");
-      int offset = 0;
-      for (int sub_e = 0; sub_e < num_sub_elements; ++sub_e)
-      {
-        std::shared_ptr<const fem::FiniteElement> sub_element
-            = element->extract_sub_element({sub_e});
-
-        const int sub_value_size = sub_element->value_size();
-        const Function sub_f = sub(sub_e);
-        Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> sub_u(
-            u.rows(), sub_value_size);
-        sub_f.eval(x, cells, sub_u);
-
-        for (int i = 0; i < sub_value_size; ++i)
-          u.col(offset + i) = sub_u.col(i);
-        offset += sub_value_size;
-      }
-      return;
-    }
-    // Prepare geometry data structures
-    Eigen::Tensor<double, 3, Eigen::RowMajor> J(1, gdim, tdim);
-    Eigen::Array<double, Eigen::Dynamic, 1> detJ(1);
-    Eigen::Tensor<double, 3, Eigen::RowMajor> K(1, tdim, gdim);
-    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> X(
-        1, tdim);
-
-    // Prepare basis function data structures
-    Eigen::Tensor<double, 3, Eigen::RowMajor> basis_reference_values(
-        1, space_dimension, reference_value_size);
-    Eigen::Tensor<double, 3, Eigen::RowMajor> basis_values(1, space_dimension,
-                                                           value_size);
-
-    // Create work vector for expansion coefficients
-    Eigen::Matrix<T, 1, Eigen::Dynamic> coefficients(space_dimension
-                                                     * block_size);
-
-    // Get dofmap
     std::shared_ptr<const fem::DofMap> dofmap = _function_space->dofmap();
     assert(dofmap);
-
-    mesh->topology_mutable().create_entity_permutations();
+    assert(dofmap->element_dof_layout);
+
+    // Collect the (non-mixed) sub-elements with the positions of their
+    // dofs in the cell dofs and the offsets of their values
+    std::vector<EvalElement> elements;
+    std::vector<int> cell_dofs(element->space_dimension());
+    std::iota(cell_dofs.begin(), cell_dofs.end(), 0);
+    int value_offset = 0;
+    collect_eval_elements(element, *dofmap->element_dof_layout, cell_dofs,
+                          value_offset, elements);
+
+    // Group the points by cell (counting sort), and order the cells by
+    // their number of points so that work arrays are resized only when
+    // the number of points changes
+    std::int32_t num_cells = 0;
+    for (Eigen::Index p = 0; p < cells.rows(); ++p)
+      num_cells = std::max(num_cells, cells[p] + 1);
+    std::vector<std::int32_t> offsets(num_cells + 1, 0);
+    for (Eigen::Index p = 0; p < cells.rows(); ++p)
+      if (cells[p] >= 0)
+        ++offsets[cells[p] + 1];
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<std::int32_t> points(offsets.back());
+    {
+      std::vector<std::int32_t> pos(offsets.begin(), offsets.end() - 1);
+      for (Eigen::Index p = 0; p < cells.rows(); ++p)
+        if (cells[p] >= 0)
+          points[pos[cells[p]]++] = p;
+    }
+    std::vector<std::int32_t> active_cells;
+    for (std::int32_t c = 0; c < num_cells; ++c)
+      if (offsets[c + 1] > offsets[c])
+        active_cells.push_back(c);
+    std::stable_sort(active_cells.begin(), active_cells.end(),
+                     [&offsets](std::int32_t c0, std::int32_t c1) {
+                       return offsets[c0 + 1] - offsets[c0]
+                              < offsets[c1 + 1] - offsets[c1];
+                     });
+
+    // Geometry work arrays, sized for the current number of points
+    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> xp,
+        X;
+    Eigen::Tensor<double, 3, Eigen::RowMajor> J, K;
+    Eigen::Array<double, Eigen::Dynamic, 1> detJ;
+
+    // Only the cell permutation info is needed to push forward the
+    // basis functions
+    mesh->topology_mutable().create_cell_permutation_info();
     const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info
         = mesh->topology().get_cell_permutation_info();
 
-    // Loop over points
+    // Loop over cells
     u.setZero();
     const Eigen::Matrix<T, Eigen::Dynamic, 1>& _v = _x->array();
-    for (Eigen::Index p = 0; p < cells.rows(); ++p)
+    Eigen::Index num_points = -1;
+    for (std::int32_t c : active_cells)
     {
-      const int cell_index = cells(p);
-
-      // Skip negative cell indices
-      if (cell_index < 0)
-        continue;
+      const Eigen::Index n = offsets[c + 1] - offsets[c];
+      const std::int32_t* cell_points = points.data() + offsets[c];
+      if (n != num_points)
+      {
+        num_points = n;
+        xp.resize(n, gdim);
+        X.resize(n, tdim);
+        J.resize(n, gdim, tdim);
+        K.resize(n, tdim, gdim);
+        detJ.resize(n);
+        for (EvalElement& e : elements)
+        {
+          e.basis_reference_values.resize(n, e.space_dimension,
+                                          e.reference_value_size);
+          e.basis_values.resize(n, e.space_dimension, e.value_size);
+        }
+      }
 
-      // Get cell geometry (coordinate dofs)
-      auto x_dofs = x_dofmap.links(cell_index);
+      // Get cell geometry (coordinate dofs) and the points in the cell
+      auto x_dofs = x_dofmap.links(c);
       for (int i = 0; i < num_dofs_g; ++i)
         coordinate_dofs.row(i) = x_g.row(x_dofs[i]).head(gdim);
+      for (Eigen::Index q = 0; q < n; ++q)
+        xp.row(q) = x.row(cell_points[q]).head(gdim);
 
       // Compute reference coordinates X, and J, detJ and K
-      cmap.compute_reference_geometry(X, J, detJ, K, x.row(p).head(gdim),
-                                      coordinate_dofs);
-
-      // Compute basis on reference element
-      element->evaluate_reference_basis(basis_reference_values, X);
-
-      // Push basis forward to physical element
-      element->transform_reference_basis(basis_values, basis_reference_values,
-                                         X, J, detJ, K, cell_info[cell_index]);
-
-      // Get degrees of freedom for current cell
-      auto dofs = dofmap->cell_dofs(cell_index);
-      for (Eigen::Index i = 0; i < dofs.size(); ++i)
-        coefficients[i] = _v[dofs[i]];
+      cmap.compute_reference_geometry(X, J, detJ, K, xp, coordinate_dofs);
 
-      // Compute expansion
-      for (int block = 0; block < block_size; ++block)
+      auto dofs = dofmap->cell_dofs(c);
+      for (EvalElement& e : elements)
       {
-        for (int i = 0; i < space_dimension; ++i)
+        // Compute basis on reference element (unless it has been
+        // pretabulated at the points) and push forward to physical
+        // element
+        std::shared_ptr<const Eigen::Tensor<double, 3, Eigen::RowMajor>>
+            cached = e.element->cached_reference_basis(X);
+        if (!cached)
+          e.element->evaluate_reference_basis(e.basis_reference_values, X);
+        e.element->transform_reference_basis(
+            e.basis_values, cached ? *cached : e.basis_reference_values, X, J,
+            detJ, K, cell_info[c]);
+
+        // Get degrees of freedom of the element
+        for (std::size_t i = 0; i < e.dofs.size(); ++i)
+          e.coefficients[i] = _v[dofs[e.dofs[i]]];
+
+        // Compute expansion
+        const int bs = e.block_size;
+        for (Eigen::Index q = 0; q < n; ++q)
         {
-          for (int j = 0; j < value_size; ++j)
+          auto u_p = u.row(cell_points[q]);
+          for (int block = 0; block < bs; ++block)
           {
-            // TODO: Find an Eigen shortcut for this operation
-            u.row(p)[j * block_size + block]
-                += coefficients[i * block_size + block] * basis_values(0, i, j);
+            for (int i = 0; i < e.space_dimension; ++i)
+            {
+              const T w = e.coefficients[i * bs + block];
+              for (int j = 0; j < e.value_size; ++j)
+                u_p[e.value_offset + j * bs + block]
+                    += w * e.basis_values(q, i, j);
+            }
           }
         }
       }
@@ -419,6 +496,69 @@ public:
   std::size_t id() const { return _id; }
 
 private:
+  // A (non-mixed, possibly blocked) element of the function space and
+  // work arrays used by eval
+  struct EvalElement
+  {
+    std::shared_ptr<const fem::FiniteElement> element;
+
+    // Positions of the element dofs in the dofs of a cell
+    std::vector<int> dofs;
+
+    // Offset of the element values in the values of the function
+    int value_offset;
+
+    // Sizes per block
+    int block_size, space_dimension, reference_value_size, value_size;
+
+    Eigen::Tensor<double, 3, Eigen::RowMajor> basis_reference_values,
+        basis_values;
+    Eigen::Matrix<T, Eigen::Dynamic, 1> coefficients;
+  };
+
+  // Collect the non-mixed sub-elements of an element (recursively),
+  // with the positions of their dofs in the cell dofs
+  static void
+  collect_eval_elements(std::shared_ptr<const fem::FiniteElement> element,
+                        const fem::ElementDofLayout& layout,
+                        const std::vector<int>& dofs, int& value_offset,
+                        std::vector<EvalElement>& elements)
+  {
+    const int block_size = element->block_size();
+    const int num_sub_elements = element->num_sub_elements();
+    if (num_sub_elements > 1 and num_sub_elements != block_size)
+    {
+      if (block_size != 1)
+      {
+        throw std::runtime_error(
+            "Blocked elements of mixed spaces are not yet supported.");
+      }
+      for (int i = 0; i < num_sub_elements; ++i)
+      {
+        const std::vector<int> sub_view = layout.sub_view({i});
+        std::vector<int> sub_dofs(sub_view.size());
+        for (std::size_t j = 0; j < sub_view.size(); ++j)
+          sub_dofs[j] = dofs[sub_view[j]];
+        collect_eval_elements(element->extract_sub_element({i}),
+                              *layout.sub_dofmap({i}), sub_dofs,
+                              value_offset, elements);
+      }
+      return;
+    }
+
+    EvalElement e;
+    e.element = element;
+    e.dofs = dofs;
+    e.value_offset = value_offset;
+    e.block_size = block_size;
+    e.space_dimension = element->space_dimension() / block_size;
+    e.reference_value_size = element->reference_value_size() / block_size;
+    e.value_size = element->value_size() / block_size;
+    e.coefficients.resize(dofs.size());
+    elements.push_back(std::move(e));
+    value_offset += element->value_size();
+  }
+
   // ID
   std::size_t _id;
 
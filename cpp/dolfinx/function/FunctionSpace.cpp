@@ -24,15 +24,14 @@ using namespace dolfinx::function;
 
 namespace
 {
-Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>
+// Tabulate the coordinates (num_dofs, gdim) of the dofs of the scalar
+// subspace
+Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
 internal_tabulate_dof_coordinates(
     std::shared_ptr<const mesh::Mesh> mesh,
     std::shared_ptr<const fem::FiniteElement> element,
-    std::shared_ptr<const fem::DofMap> dofmap, int repeats)
+    std::shared_ptr<const fem::DofMap> dofmap)
 {
-  // This function tabulates the DOF coordinates, with each coordinated repeated
-  // the given number of times
-
   // Geometric dimension
   assert(mesh);
   assert(element);
@@ -70,9 +69,9 @@ internal_tabulate_dof_coordinates(
       = mesh->geometry().x();
 
   // Array to hold coordinates to return
-  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> x
-      = Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>::Zero(
-          local_size * repeats, 3);
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> x
+      = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                     Eigen::RowMajor>::Zero(local_size, gdim);
 
   // Loop over cells and tabulate dofs
   Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
@@ -98,18 +97,12 @@ internal_tabulate_dof_coordinates(
     cmap.push_forward(coordinates, X, coordinate_dofs);
 
     // Copy dof coordinates into vector
+    // FIXME: this depends on the dof layout
+    // TODO: cell_dofs should return values for scalar subspace, rather
+    // than fixing that here.
     for (Eigen::Index i = 0; i < scalar_dofs; ++i)
-    {
-      // FIXME: this depends on the dof layout
-      for (int j = 0; j < repeats; ++j)
-      {
-        x.row(dofs[i * element_block_size] / element_block_size * repeats + j)
-            .head(gdim)
-            = coordinates.row(i);
-      }
-      // TODO: cell_dofs should return values for scalar subspace, rather than
-      // fixing that here.
-    }
+      x.row(dofs[i * element_block_size] / element_block_size)
+          = coordinates.row(i);
   }
 
   return x;
@@ -157,12 +150,9 @@ FunctionSpace::sub(const std::vector<int>& component) const
   assert(_element);
   assert(_dofmap);
 
-  // Check if sub space is already in the cache and not expired
+  // Check if sub space is already in the cache
   if (auto it = _subspaces.find(component); it != _subspaces.end())
-  {
-    if (auto s = it->second.lock())
-      return s;
-  }
+    return it->second;
 
   // Extract sub-element
   std::shared_ptr<const fem::FiniteElement> element
@@ -182,28 +172,41 @@ FunctionSpace::sub(const std::vector<int>& component) const
                                component.end());
 
   // Insert new subspace into cache
-  _subspaces.emplace(sub_space->_component, sub_space);
+  _subspaces.emplace(component, sub_space);
 
   return sub_space;
 }
 //-----------------------------------------------------------------------------
 std::pair<std::shared_ptr<FunctionSpace>, std::vector<std::int32_t>>
 FunctionSpace::collapse() const
+{
+  auto [collapsed_space, collapsed_map] = collapsed();
+  return {collapsed_space, *collapsed_map};
+}
+//-----------------------------------------------------------------------------
+std::pair<std::shared_ptr<FunctionSpace>,
+          std::shared_ptr<const std::vector<std::int32_t>>>
+FunctionSpace::collapsed() const
 {
   if (_component.empty())
     throw std::runtime_error("Function space is not a subspace");
 
-  // Create collapsed DofMap
-  std::shared_ptr<fem::DofMap> collapsed_dofmap;
-  std::vector<std::int32_t> collapsed_dofs;
-  std::tie(collapsed_dofmap, collapsed_dofs)
-      = _dofmap->collapse(_mesh->mpi_comm(), _mesh->topology());
-
-  // Create new FunctionSpace and return
-  auto collapsed_sub_space
-      = std::make_shared<FunctionSpace>(_mesh, _element, collapsed_dofmap);
+  if (!_collapsed_space)
+  {
+    // Create collapsed DofMap
+    std::shared_ptr<fem::DofMap> collapsed_dofmap;
+    std::vector<std::int32_t> collapsed_dofs;
+    std::tie(collapsed_dofmap, collapsed_dofs)
+        = _dofmap->collapse(_mesh->mpi_comm(), _mesh->topology());
+
+    // Create new FunctionSpace
+    _collapsed_space
+        = std::make_shared<FunctionSpace>(_mesh, _element, collapsed_dofmap);
+    _collapsed_map = std::make_shared<const std::vector<std::int32_t>>(
+        std::move(collapsed_dofs));
+  }
 
-  return {std::move(collapsed_sub_space), std::move(collapsed_dofs)};
+  return {_collapsed_space, _collapsed_map};
 }
 //-----------------------------------------------------------------------------
 bool FunctionSpace::has_element(const fem::FiniteElement& element) const
@@ -215,6 +218,38 @@ std::vector<int> FunctionSpace::component() const { return _component; }
 //-----------------------------------------------------------------------------
 Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>
 FunctionSpace::tabulate_dof_coordinates() const
+{
+  // Repeat the coordinates of the scalar subspace for each component of
+  // the block
+  std::shared_ptr<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                     Eigen::RowMajor>>
+      x = dof_coordinates();
+  const int bs = _element->block_size();
+  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> coords
+      = Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>::Zero(
+          x->rows() * bs, 3);
+  for (Eigen::Index i = 0; i < x->rows(); ++i)
+    for (int j = 0; j < bs; ++j)
+      coords.row(i * bs + j).head(x->cols()) = x->row(i);
+  return coords;
+}
+//-----------------------------------------------------------------------------
+Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>
+FunctionSpace::tabulate_scalar_subspace_dof_coordinates() const
+{
+  std::shared_ptr<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                     Eigen::RowMajor>>
+      x = dof_coordinates();
+  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> coords
+      = Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>::Zero(
+          x->rows(), 3);
+  coords.leftCols(x->cols()) = *x;
+  return coords;
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+FunctionSpace::dof_coordinates() const
 {
   if (!_component.empty())
   {
@@ -222,12 +257,22 @@ FunctionSpace::tabulate_dof_coordinates() const
         "Cannot tabulate coordinates for a FunctionSpace that is a subspace.");
   }
 
-  return internal_tabulate_dof_coordinates(_mesh, _element, _dofmap,
-                                           _element->block_size());
+  assert(_mesh);
+  const std::uint64_t x_version = _mesh->geometry().x_version();
+  if (!_dof_coordinates or _dof_coordinates_version != x_version)
+  {
+    _dof_coordinates = std::make_shared<const Eigen::Array<
+        double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(
+        internal_tabulate_dof_coordinates(_mesh, _element, _dofmap));
+    _dof_coordinates_version = x_version;
+  }
+
+  return _dof_coordinates;
 }
 //-----------------------------------------------------------------------------
 Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>
-FunctionSpace::tabulate_scalar_subspace_dof_coordinates() const
+FunctionSpace::tabulate_scalar_subspace_dof_coordinates(
+    const std::vector<std::int32_t>& dofs) const
 {
   if (!_component.empty())
   {
@@ -235,7 +280,88 @@ FunctionSpace::tabulate_scalar_subspace_dof_coordinates() const
         "Cannot tabulate coordinates for a FunctionSpace that is a subspace.");
   }
 
-  return internal_tabulate_dof_coordinates(_mesh, _element, _dofmap, 1);
+  assert(_mesh);
+  assert(_element);
+  assert(_dofmap);
+  const int gdim = _mesh->geometry().dim();
+  const int tdim = _mesh->topology().dim();
+  const int bs = _dofmap->bs();
+  const int element_block_size = _element->block_size();
+  const int scalar_dofs = _element->space_dimension() / element_block_size;
+  std::shared_ptr<const common::IndexMap> index_map = _dofmap->index_map;
+  assert(index_map);
+  const std::int32_t local_size
+      = index_map->block_size()
+        * (index_map->size_local() + index_map->num_ghosts())
+        / element_block_size;
+
+  // Position in dofs of each requested dof of the scalar subspace (-1
+  // if not requested or not yet computed)
+  std::vector<std::int32_t> position(local_size, -1);
+  for (std::size_t i = 0; i < dofs.size(); ++i)
+  {
+    if (dofs[i] < 0 or dofs[i] >= local_size)
+      throw std::runtime_error("Dof index out of range.");
+    if (position[dofs[i]] >= 0)
+      throw std::runtime_error("Dof indices are not distinct.");
+    position[dofs[i]] = i;
+  }
+
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>& X
+      = _element->dof_reference_coordinates();
+  const fem::CoordinateElement& cmap = _mesh->geometry().cmap();
+  const graph::AdjacencyList<std::int32_t>& x_dofmap
+      = _mesh->geometry().dofmap();
+  const int num_dofs_g = x_dofmap.num_links(0);
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+      x_g
+      = _mesh->geometry().x();
+
+  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> x
+      = Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>::Zero(
+          dofs.size(), 3);
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      coordinates(scalar_dofs, gdim);
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      coordinate_dofs(num_dofs_g, gdim);
+  std::vector<std::int32_t> cell_nodes(scalar_dofs);
+
+  auto map = _mesh->topology().index_map(tdim);
+  assert(map);
+  const int num_cells = map->size_local() + map->num_ghosts();
+  const graph::AdjacencyList<std::int32_t>& blocks = _dofmap->list_blocked();
+  std::size_t num_found = 0;
+  for (int c = 0; c < num_cells and num_found < dofs.size(); ++c)
+  {
+    // Get the scalar subspace dofs of the cell (the first dof of each
+    // block of the element), and skip the cell if none are requested
+    auto cell_blocks = blocks.links(c);
+    bool requested = false;
+    for (int i = 0; i < scalar_dofs; ++i)
+    {
+      const int j = i * element_block_size;
+      cell_nodes[i] = (bs * cell_blocks[j / bs] + j % bs) / element_block_size;
+      requested = requested or position[cell_nodes[i]] >= 0;
+    }
+    if (!requested)
+      continue;
+
+    auto x_dofs = x_dofmap.links(c);
+    for (int i = 0; i < num_dofs_g; ++i)
+      coordinate_dofs.row(i) = x_g.row(x_dofs[i]).head(gdim);
+    cmap.push_forward(coordinates, X, coordinate_dofs);
+    for (int i = 0; i < scalar_dofs; ++i)
+    {
+      if (std::int32_t& p = position[cell_nodes[i]]; p >= 0)
+      {
+        x.row(p).head(gdim) = coordinates.row(i);
+        p = -1;
+        ++num_found;
+      }
+    }
+  }
+
+  return x;
 }
 //-----------------------------------------------------------------------------
 std::size_t FunctionSpace::id() const { return _id; }
@@ -252,6 +378,71 @@ std::shared_ptr<const fem::DofMap> FunctionSpace::dofmap() const
   return _dofmap;
 }
 //-----------------------------------------------------------------------------
+std::shared_ptr<const InterpolationPlan>
+FunctionSpace::interpolation_plan() const
+{
+  assert(_mesh);
+  const std::uint64_t x_version = _mesh->geometry().x_version();
+  if (_interpolation_plan and _interpolation_plan->x_version == x_version)
+    return _interpolation_plan;
+
+  auto plan = std::make_shared<InterpolationPlan>();
+  std::shared_ptr<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                     Eigen::RowMajor>>
+      x = dof_coordinates();
+  plan->points.setZero(3, x->rows());
+  plan->points.topRows(x->cols()) = x->transpose();
+  plan->x_version = x_version;
+
+  assert(_element);
+  if (_element->family() == "Mixed")
+  {
+    // Map the values of the sub-elements (components value_offset, ...,
+    // value_offset + block size - 1) at the points of the mixed space to
+    // the dofs
+    assert(_dofmap);
+    const int tdim = _mesh->topology().dim();
+    auto map = _mesh->topology().index_map(tdim);
+    assert(map);
+    const int num_cells = map->size_local() + map->num_ghosts();
+    const std::int32_t num_dofs = plan->points.cols();
+    plan->value_rows.resize(num_dofs);
+    plan->value_cols.resize(num_dofs);
+    int value_offset = 0;
+    for (int i = 0; i < _element->num_sub_elements(); ++i)
+    {
+      const std::vector<int> component = {i};
+      const fem::DofMap sub_dofmap = _dofmap->extract_sub_dofmap(component);
+      const int bs = _element->extract_sub_element(component)->block_size();
+      for (int c = 0; c < num_cells; ++c)
+      {
+        auto cell_dofs = sub_dofmap.cell_dofs(c);
+        for (Eigen::Index dof = 0; dof < cell_dofs.rows() / bs; ++dof)
+        {
+          for (int b = 0; b < bs; ++b)
+          {
+            plan->value_rows[cell_dofs[bs * dof + b]] = value_offset + b;
+            plan->value_cols[cell_dofs[bs * dof + b]] = cell_dofs[bs * dof];
+          }
+        }
+      }
+      value_offset += bs;
+    }
+  }
+
+  _interpolation_plan = plan;
+  return _interpolation_plan;
+}
+//-----------------------------------------------------------------------------
+std::size_t FunctionSpace::memory_usage() const
+{
+  assert(_dofmap);
+  std::size_t bytes = _dofmap->memory_usage();
+  if (_dofmap->index_map)
+    bytes += _dofmap->index_map->memory_usage();
+  return bytes;
+}
+//-----------------------------------------------------------------------------
 bool FunctionSpace::contains(const FunctionSpace& V) const
 {
   // Is the root space same?
@@ -8,6 +8,7 @@
 
 #include <Eigen/Dense>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
@@ -30,6 +31,24 @@ class Mesh;
 namespace function
 {
 
+/// Precomputed data for interpolating expressions into a function
+/// space (see FunctionSpace::interpolation_plan and interpolate)
+struct InterpolationPlan
+{
+  /// Coordinates (3, num_points) of the dofs of the scalar subspace, at
+  /// which expressions are evaluated
+  Eigen::Array<double, 3, Eigen::Dynamic, Eigen::RowMajor> points;
+
+  /// For mixed spaces, the value component (row) and the point (column)
+  /// of the evaluated expression that give the value of each dof. Empty
+  /// for other spaces.
+  std::vector<std::int32_t> value_rows, value_cols;
+
+  /// Version of the mesh geometry (see mesh::Geometry::x_version) the
+  /// points were computed for
+  std::uint64_t x_version = 0;
+};
+
 /// This class represents a finite element function space defined by a
 /// mesh, a finite element, and a local-to-global map of the degrees of
 /// freedom (dofmap).
@@ -83,11 +102,20 @@ public:
   bool contains(const FunctionSpace& V) const;
 
   /// Collapse a subspace and return a new function space and a map from
-  /// new to old dofs
+  /// new to old dofs. The collapsed space is computed once and cached
+  /// (see collapsed).
   /// @return The new function space and a map rom new to old dofs
   std::pair<std::shared_ptr<FunctionSpace>, std::vector<std::int32_t>>
   collapse() const;
 
+  /// Collapse a subspace, and cache the new function space and the map
+  /// from new to old dofs. Subsequent calls return the cached space and
+  /// map without copying.
+  /// @return The new function space and a map from new to old dofs
+  std::pair<std::shared_ptr<FunctionSpace>,
+            std::shared_ptr<const std::vector<std::int32_t>>>
+  collapsed() const;
+
   /// Check if function space has given element
   /// @param[in] element The finite element
   /// @return  True if the function space has the given element
@@ -98,7 +126,8 @@ public:
   ///         W.sub(1).sub(0) == [1, 0]
   std::vector<int> component() const;
 
-  /// Tabulate the physical coordinates of all dofs on this process.
+  /// Tabulate the physical coordinates of all dofs on this process. The
+  /// coordinates are expanded from the cache of dof_coordinates.
   /// @return The dof coordinates [([x0, y0, z0], [x1, y1, z1], ...)
   Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>
   tabulate_dof_coordinates() const;
@@ -111,6 +140,37 @@ public:
   Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>
   tabulate_scalar_subspace_dof_coordinates() const;
 
+  /// Get the physical coordinates of all dofs of the scalar subspace on
+  /// this process (see tabulate_scalar_subspace_dof_coordinates), with
+  /// one column per geometric dimension. The coordinate of dof i of a
+  /// space with element block size bs is in row i / bs. The coordinates
+  /// are computed on first use and cached, and recomputed if the mesh
+  /// geometry has changed. The call is not thread-safe when the
+  /// coordinates are (re)computed.
+  /// @return The dof coordinates (num_dofs / bs, gdim)
+  std::shared_ptr<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                     Eigen::RowMajor>>
+  dof_coordinates() const;
+
+  /// Tabulate the physical coordinates of a subset of the dofs of the
+  /// scalar subspace on this process (see
+  /// tabulate_scalar_subspace_dof_coordinates). Only the cells that
+  /// contain at least one of the dofs are visited for the push forward.
+  /// @param[in] dofs Distinct indices of dofs of the scalar subspace
+  /// @return The coordinates of dofs[i] in row i
+  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>
+  tabulate_scalar_subspace_dof_coordinates(
+      const std::vector<std::int32_t>& dofs) const;
+
+  /// Get the interpolation plan of the space, i.e. the points at
+  /// which expressions are evaluated for interpolation and, for mixed
+  /// spaces, the map from the evaluated values to the dofs. The plan is
+  /// computed on first use and cached, and recomputed if the mesh
+  /// geometry has changed. The call is not thread-safe when the plan is
+  /// (re)computed.
+  /// @return The interpolation plan
+  std::shared_ptr<const InterpolationPlan> interpolation_plan() const;
+
   /// Unique identifier
   std::size_t id() const;
 
@@ -123,6 +183,12 @@ public:
   /// The dofmap
   std::shared_ptr<const fem::DofMap> dofmap() const;
 
+  /// Memory used by the dofmap and its index map. The mesh and the
+  /// finite element are not included. Subspaces share the index map of
+  /// their parent space.
+  /// @return Memory usage in bytes
+  std::size_t memory_usage() const;
+
 private:
   // The mesh
   std::shared_ptr<const mesh::Mesh> _mesh;
@@ -142,8 +208,24 @@ private:
   // The identifier of root space
   std::size_t _root_space_id;
 
-  // Cache of subspaces
-  mutable std::map<std::vector<int>, std::weak_ptr<FunctionSpace>> _subspaces;
+  // Cache of subspaces. The subspaces are kept alive so that their
+  // collapsed spaces remain cached.
+  mutable std::map<std::vector<int>, std::shared_ptr<FunctionSpace>>
+      _subspaces;
+
+  // Cached collapsed space and map from collapsed to subspace dofs
+  mutable std::shared_ptr<FunctionSpace> _collapsed_space;
+  mutable std::shared_ptr<const std::vector<std::int32_t>> _collapsed_map;
+
+  // Cached coordinates of the dofs of the scalar subspace, and the
+  // geometry version they were computed for
+  mutable std::shared_ptr<const Eigen::Array<double, Eigen::Dynamic,
+                                             Eigen::Dynamic, Eigen::RowMajor>>
+      _dof_coordinates;
+  mutable std::uint64_t _dof_coordinates_version = 0;
+
+  // Cached interpolation plan
+  mutable std::shared_ptr<const InterpolationPlan> _interpolation_plan;
 };
 
 /// Extract FunctionSpaces for (0) rows blocks and (1) columns blocks
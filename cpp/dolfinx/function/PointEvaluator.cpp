@@ -0,0 +1,195 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "PointEvaluator.h"
+#include <algorithm>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/geometry/utils.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <numeric>
+
+using namespace dolfinx;
+using namespace dolfinx::function;
+
+//-----------------------------------------------------------------------------
+PointEvaluator::PointEvaluator(std::shared_ptr<const mesh::Mesh> mesh)
+    : _mesh(mesh), _tree(*mesh, mesh->topology().dim()),
+      _x_version(mesh->geometry().x_version()),
+      _neighbor_comm(MPI_COMM_NULL, false)
+{
+  set_points(Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>(0, 3));
+}
+//-----------------------------------------------------------------------------
+void PointEvaluator::set_points(
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>& x)
+{
+  _points = x;
+  update();
+}
+//-----------------------------------------------------------------------------
+void PointEvaluator::update()
+{
+  common::Timer timer("Compute point ownership");
+
+  MPI_Comm comm = _mesh->mpi_comm();
+  const int comm_size = dolfinx::MPI::size(comm);
+  const int tdim = _mesh->topology().dim();
+  if (_x_version != _mesh->geometry().x_version())
+  {
+    // Refit the tree to the moved geometry, and rebuild it if the
+    // boxes overlap much more than when it was built
+    _tree.refit(*_mesh, 2.0);
+    _x_version = _mesh->geometry().x_version();
+  }
+
+  // Send each point to the processes whose bounding box contains it
+  const std::int32_t num_points = _points.rows();
+  std::vector<std::vector<std::int32_t>> sent(comm_size);
+  for (std::int32_t p = 0; p < num_points; ++p)
+  {
+    const Eigen::Vector3d xp = _points.row(p).transpose().matrix();
+    for (int rank : geometry::compute_process_collisions(_tree, xp))
+      sent[rank].push_back(p);
+  }
+  std::vector<std::int32_t> offsets(comm_size + 1, 0);
+  for (int r = 0; r < comm_size; ++r)
+    offsets[r + 1] = offsets[r] + sent[r].size();
+  Eigen::Array<double, Eigen::Dynamic, 1> send_x(3 * offsets.back());
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> send_x_offsets(comm_size + 1);
+  for (int r = 0; r < comm_size; ++r)
+  {
+    send_x_offsets[r] = 3 * offsets[r];
+    for (std::size_t i = 0; i < sent[r].size(); ++i)
+      send_x.segment(3 * (offsets[r] + i), 3) = _points.row(sent[r][i]);
+  }
+  send_x_offsets[comm_size] = 3 * offsets.back();
+  const graph::AdjacencyList<double> recv_x = dolfinx::MPI::all_to_all(
+      comm, graph::AdjacencyList<double>(send_x, send_x_offsets));
+
+  // Find the owned cells that contain the received points
+  std::shared_ptr<const common::IndexMap> cell_map
+      = _mesh->topology().index_map(tdim);
+  assert(cell_map);
+  const std::int32_t num_owned_cells = cell_map->size_local();
+  const Eigen::Array<double, Eigen::Dynamic, 1>& recv_x_array = recv_x.array();
+  const std::int32_t num_recv = recv_x_array.rows() / 3;
+  std::vector<int> recv_cells(num_recv, -1);
+  for (std::int32_t p = 0; p < num_recv; ++p)
+  {
+    const Eigen::Vector3d xp = recv_x_array.segment(3 * p, 3).matrix();
+    const std::vector<int> cells = geometry::select_colliding_cells(
+        *_mesh, geometry::compute_collisions(_tree, xp), xp, 0);
+    for (int c : cells)
+    {
+      if (c < num_owned_cells)
+      {
+        recv_cells[p] = c;
+        break;
+      }
+    }
+  }
+
+  // Reply whether the points were found
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> recv_offsets
+      = recv_x.offsets() / 3;
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> found(num_recv);
+  for (std::int32_t p = 0; p < num_recv; ++p)
+    found[p] = recv_cells[p] >= 0;
+  const graph::AdjacencyList<std::int32_t> replies = dolfinx::MPI::all_to_all(
+      comm, graph::AdjacencyList<std::int32_t>(found, recv_offsets));
+
+  // Assign each point to the lowest rank that found it, and tell the
+  // ranks which of the points they found they own
+  _found.assign(num_points, false);
+  std::vector<int> owner(num_points, -1);
+  for (int r = 0; r < comm_size; ++r)
+  {
+    auto reply = replies.links(r);
+    assert(reply.rows() == (Eigen::Index)sent[r].size());
+    for (std::size_t i = 0; i < sent[r].size(); ++i)
+    {
+      const std::int32_t p = sent[r][i];
+      if (reply[i] and owner[p] < 0)
+        owner[p] = r;
+    }
+  }
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> accept(offsets.back());
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> accept_offsets(comm_size + 1);
+  std::vector<int> owners, owner_offsets = {0};
+  _recv_positions.assign(num_points, -1);
+  for (int r = 0; r < comm_size; ++r)
+  {
+    accept_offsets[r] = offsets[r];
+    std::int32_t num_owned = 0;
+    for (std::size_t i = 0; i < sent[r].size(); ++i)
+    {
+      const std::int32_t p = sent[r][i];
+      accept[offsets[r] + i] = owner[p] == r;
+      if (owner[p] == r)
+      {
+        _found[p] = true;
+        _recv_positions[p] = owner_offsets.back() + num_owned++;
+      }
+    }
+    if (num_owned > 0)
+    {
+      owners.push_back(r);
+      owner_offsets.push_back(owner_offsets.back() + num_owned);
+    }
+  }
+  accept_offsets[comm_size] = offsets.back();
+  const graph::AdjacencyList<std::int32_t> accepted = dolfinx::MPI::all_to_all(
+      comm, graph::AdjacencyList<std::int32_t>(accept, accept_offsets));
+
+  // Store the owned points, grouped by requesting rank
+  std::vector<int> requesters;
+  _requester_offsets = {0};
+  std::vector<std::int32_t> owned;
+  for (int r = 0; r < comm_size; ++r)
+  {
+    auto a = accepted.links(r);
+    const std::size_t size0 = owned.size();
+    for (Eigen::Index i = 0; i < a.rows(); ++i)
+      if (a[i])
+        owned.push_back(recv_offsets[r] + i);
+    if (owned.size() > size0)
+    {
+      requesters.push_back(r);
+      _requester_offsets.push_back(owned.size());
+    }
+  }
+  _owned_points.resize(owned.size(), 3);
+  _owned_cells.resize(owned.size());
+  for (std::size_t i = 0; i < owned.size(); ++i)
+  {
+    _owned_points.row(i) = recv_x_array.segment(3 * owned[i], 3).transpose();
+    _owned_cells[i] = recv_cells[owned[i]];
+  }
+
+  // Create the neighbourhood communicator for sending values from the
+  // owners to the requesting ranks
+  MPI_Comm neighbor_comm;
+  MPI_Dist_graph_create_adjacent(comm, owners.size(), owners.data(),
+                                 MPI_UNWEIGHTED, requesters.size(),
+                                 requesters.data(), MPI_UNWEIGHTED,
+                                 MPI_INFO_NULL, false, &neighbor_comm);
+  _neighbor_comm = dolfinx::MPI::Comm(neighbor_comm, false);
+}
+//-----------------------------------------------------------------------------
+PointEvaluator
+function::create_interpolation_evaluator(const FunctionSpace& V,
+                                         std::shared_ptr<const mesh::Mesh> mesh)
+{
+  PointEvaluator evaluator(mesh);
+  evaluator.set_points(V.interpolation_plan()->points.transpose());
+  return evaluator;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,195 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "FunctionSpace.h"
+#include <Eigen/Dense>
+#include <cstdint>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/fem/FiniteElement.h>
+#include <dolfinx/geometry/BoundingBoxTree.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace dolfinx
+{
+namespace function
+{
+
+template <typename T>
+class Function;
+
+/// Evaluation of functions at arbitrary points in parallel. Each
+/// process passes its own points (set_points), and for each point the
+/// process and the owned cell that contain it are found. Functions are
+/// then evaluated at the points on the owning processes, and the
+/// values are returned to the processes that passed the points, in
+/// their order (eval).
+///
+/// The bounding box tree of the mesh, the owners of the points and the
+/// communication pattern are cached, so that evaluating functions
+/// repeatedly at the same points (e.g. probes) only requires the
+/// evaluation and one neighbourhood exchange of the values. The
+/// ownership is recomputed if the mesh geometry changes.
+class PointEvaluator
+{
+public:
+  /// Create a point evaluator for a mesh (collective). Builds the
+  /// bounding box tree of the mesh cells.
+  /// @param[in] mesh The mesh
+  explicit PointEvaluator(std::shared_ptr<const mesh::Mesh> mesh);
+
+  /// Move constructor
+  PointEvaluator(PointEvaluator&& evaluator) = default;
+
+  /// Destructor
+  ~PointEvaluator() = default;
+
+  /// Move assignment
+  PointEvaluator& operator=(PointEvaluator&& evaluator) = default;
+
+  /// Set the points to evaluate at and find their owners (collective).
+  /// A point that lies in cells on several processes is assigned to
+  /// the lowest rank.
+  /// @param[in] x The coordinates of the points on this process. It
+  ///   has shape (num_points, 3).
+  void set_points(
+      const Eigen::Ref<
+          const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>& x);
+
+  /// The mesh
+  std::shared_ptr<const mesh::Mesh> mesh() const { return _mesh; }
+
+  /// Number of points set on this process
+  std::int32_t num_points() const { return _points.rows(); }
+
+  /// Check which points have been found in the mesh. Functions are
+  /// zero at points that have not been found.
+  /// @return True for each point (on this process) that lies in a cell
+  ///   of the mesh
+  const std::vector<bool>& found() const { return _found; }
+
+  /// Evaluate a function at the points (collective)
+  /// @param[in] u The function. It must be defined on the mesh of the
+  ///   evaluator.
+  /// @return The values (num_points, value_size) at the points on this
+  ///   process
+  template <typename T>
+  Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+  eval(const Function<T>& u)
+  {
+    std::shared_ptr<const FunctionSpace> V = u.function_space();
+    assert(V);
+    if (V->mesh() != _mesh)
+      throw std::runtime_error("Function is not defined on the mesh of the "
+                               "point evaluator.");
+    if (_x_version != _mesh->geometry().x_version())
+      update();
+
+    // Evaluate at the owned points
+    assert(V->element());
+    const int value_size = V->element()->value_size();
+    Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        owned_values(_owned_cells.rows(), value_size);
+    u.eval(_owned_points, _owned_cells, owned_values);
+
+    // Send the values to the processes that passed the points
+    std::vector<int> send_offsets(_requester_offsets.size());
+    for (std::size_t i = 0; i < send_offsets.size(); ++i)
+      send_offsets[i] = _requester_offsets[i] * value_size;
+    std::vector<T> send_values(owned_values.data(),
+                               owned_values.data() + owned_values.size());
+    const graph::AdjacencyList<T> recv_values = MPI::neighbor_all_to_all(
+        _neighbor_comm.comm(), send_offsets, send_values);
+
+    // Unpack the values in the order of the points
+    const Eigen::Array<T, Eigen::Dynamic, 1>& recv = recv_values.array();
+    Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> values
+        = Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>::Zero(_points.rows(), value_size);
+    for (Eigen::Index p = 0; p < _points.rows(); ++p)
+    {
+      if (const std::int32_t pos = _recv_positions[p]; pos >= 0)
+        values.row(p) = recv.segment(pos * value_size, value_size).transpose();
+    }
+
+    return values;
+  }
+
+private:
+  // Find the owners of the points and build the communication pattern
+  // (collective)
+  void update();
+
+  // The mesh
+  std::shared_ptr<const mesh::Mesh> _mesh;
+
+  // Bounding box tree of the mesh cells
+  geometry::BoundingBoxTree _tree;
+
+  // Version of the geometry the tree and the ownership were computed
+  // for
+  std::uint64_t _x_version;
+
+  // Points on this process, and for each point whether it was found
+  // and its position in the received values (-1 if not found)
+  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> _points;
+  std::vector<bool> _found;
+  std::vector<std::int32_t> _recv_positions;
+
+  // Points (passed by any process) owned by this process, grouped by
+  // the rank that passed them, and the cells that contain them
+  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> _owned_points;
+  Eigen::Array<int, Eigen::Dynamic, 1> _owned_cells;
+
+  // Offsets of the owned points of each requesting rank (in the order
+  // of the destinations of _neighbor_comm)
+  std::vector<int> _requester_offsets;
+
+  // Neighbourhood communicator from the owners (sources) to the
+  // requesting ranks (destinations)
+  dolfinx::MPI::Comm _neighbor_comm;
+};
+
+/// Create a point evaluator on a mesh for the interpolation points of a
+/// function space on another mesh (see FunctionSpace::interpolation_plan
+/// and interpolate), to interpolate functions on @p mesh into @p V
+/// (collective)
+/// @param[in] V The function space to interpolate into
+/// @param[in] mesh The mesh of the functions to be interpolated
+/// @return The point evaluator
+PointEvaluator
+create_interpolation_evaluator(const FunctionSpace& V,
+                               std::shared_ptr<const mesh::Mesh> mesh);
+
+/// Evaluate a function at arbitrary points in parallel (collective).
+/// See PointEvaluator, which should be used to evaluate at the same
+/// points repeatedly.
+/// @param[in] u The function
+/// @param[in] x The coordinates of the points on this process. It has
+///   shape (num_points, 3).
+/// @return The values (num_points, value_size) at the points on this
+///   process. Values at points outside the mesh are zero.
+template <typename T>
+Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+eval_distributed(
+    const Function<T>& u,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>& x)
+{
+  assert(u.function_space());
+  PointEvaluator evaluator(u.function_space()->mesh());
+  evaluator.set_points(x);
+  return evaluator.eval(u);
+}
+
+} // namespace function
+} // namespace dolfinx
@@ -0,0 +1,128 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <cassert>
+#include <cstdint>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <memory>
+#include <stdexcept>
+
+namespace dolfinx::function
+{
+
+/// Data stored at the quadrature points of the cells of a mesh, e.g.
+/// the history variables of a plasticity or damage model. The values
+/// are stored contiguously with one row per (owned and ghost) cell,
+/// and the values at a quadrature point are contiguous, i.e. row c
+/// holds value_size() values for each of num_points() points.
+///
+/// Quadrature data can be attached to a Form as a coefficient (see
+/// fem::FormCoefficients::set). The row of a cell is then passed to
+/// the kernels as the expansion coefficients of the coefficient,
+/// without dofmap indirection.
+template <typename T>
+class QuadratureData
+{
+public:
+  /// Storage type of the values
+  using array_type
+      = Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+  /// Create quadrature data on the cells of a mesh
+  /// @param[in] mesh The mesh
+  /// @param[in] num_points The number of quadrature points per cell
+  /// @param[in] value_size The number of values per quadrature point
+  /// @param[in] value The initial value
+  QuadratureData(std::shared_ptr<const mesh::Mesh> mesh, int num_points,
+                 int value_size, T value = T(0))
+      : _mesh(mesh), _num_points(num_points), _value_size(value_size)
+  {
+    assert(mesh);
+    if (num_points < 1 or value_size < 1)
+    {
+      throw std::runtime_error("Number of quadrature points and value size "
+                               "must be positive.");
+    }
+
+    const int tdim = mesh->topology().dim();
+    std::shared_ptr<const common::IndexMap> map
+        = mesh->topology().index_map(tdim);
+    assert(map);
+    _values = array_type::Constant(map->size_local() + map->num_ghosts(),
+                                   num_points * value_size, value);
+  }
+
+  /// Move constructor
+  QuadratureData(QuadratureData&& q) = default;
+
+  /// Destructor
+  ~QuadratureData() = default;
+
+  /// Move assignment
+  QuadratureData& operator=(QuadratureData&& q) = default;
+
+  /// The mesh
+  std::shared_ptr<const mesh::Mesh> mesh() const { return _mesh; }
+
+  /// Number of quadrature points per cell
+  int num_points() const { return _num_points; }
+
+  /// Number of values per quadrature point
+  int value_size() const { return _value_size; }
+
+  /// Get the values (const version)
+  const array_type& values() const { return _values; }
+
+  /// Get the values. Increases the modification counter (see
+  /// version).
+  array_type& values()
+  {
+    ++_version;
+    return _values;
+  }
+
+  /// Update the values of the ghost cells with the values from the
+  /// owning processes (collective)
+  void scatter_fwd()
+  {
+    const int tdim = _mesh->topology().dim();
+    std::shared_ptr<const common::IndexMap> map
+        = _mesh->topology().index_map(tdim);
+    assert(map);
+    common::IndexMap::ScatterRequest<T> request;
+    map->scatter_fwd_begin(_values.data(), _values.cols(), request);
+    map->scatter_fwd_end(_values.data() + map->size_local() * _values.cols(),
+                         request);
+    ++_version;
+  }
+
+  /// Modification counter. It is increased by each non-const access to
+  /// the values, and is used to detect changes, e.g. by
+  /// fem::FormCoefficients::pack. Modifications through a reference
+  /// obtained from values() before the counter was read are not
+  /// detected.
+  /// @return The modification counter
+  std::int64_t version() const { return _version; }
+
+private:
+  // The mesh
+  std::shared_ptr<const mesh::Mesh> _mesh;
+
+  // Number of quadrature points per cell and values per point
+  int _num_points, _value_size;
+
+  // Values (cell, point * value_size + component)
+  array_type _values;
+
+  // Modification counter
+  std::int64_t _version = 0;
+};
+} // namespace dolfinx::function
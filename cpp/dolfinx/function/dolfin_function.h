@@ -15,3 +15,5 @@ namespace dolfinx
 
 #include <dolfinx/function/Function.h>
 #include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/function/PointEvaluator.h>
+#include <dolfinx/function/QuadratureData.h>
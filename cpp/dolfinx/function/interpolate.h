@@ -8,7 +8,9 @@
 
 #include "Function.h"
 #include "FunctionSpace.h"
+#include "PointEvaluator.h"
 #include <Eigen/Dense>
+#include <algorithm>
 #include <dolfinx/fem/DofMap.h>
 #include <dolfinx/fem/FiniteElement.h>
 #include <dolfinx/mesh/Mesh.h>
@@ -20,12 +22,29 @@ namespace dolfinx::function
 template <typename T>
 class Function;
 
-/// Interpolate a Function (on possibly non-matching meshes)
+/// Interpolate a Function (on possibly non-matching meshes). On the
+/// same mesh, a Function in another (scalar, vector or tensor)
+/// Lagrange-type space is interpolated with the local interpolation
+/// matrix of the pair of elements, which is the same for all cells.
 /// @param[in,out] u The function to interpolate into
 /// @param[in] v The function to be interpolated
 template <typename T>
 void interpolate(Function<T>& u, const Function<T>& v);
 
+/// Interpolate a Function on another mesh using a point evaluator
+/// created by create_interpolation_evaluator (collective). The
+/// evaluator caches the owners of the interpolation points, so that
+/// repeated interpolation between the same meshes requires only the
+/// evaluation of @p v and one neighbourhood exchange. It must be
+/// recreated if the mesh of @p u changes.
+/// @param[in,out] u The function to interpolate into
+/// @param[in] v The function to be interpolated
+/// @param[in] evaluator The point evaluator on the mesh of @p v with
+///   the interpolation points of the space of @p u
+template <typename T>
+void interpolate(Function<T>& u, const Function<T>& v,
+                 PointEvaluator& evaluator);
+
 /// Interpolate an expression
 /// @param[in,out] u The function to interpolate into
 /// @param[in] f The expression to be interpolated
@@ -37,6 +56,21 @@ void interpolate(
             const Eigen::Ref<const Eigen::Array<double, 3, Eigen::Dynamic,
                                                 Eigen::RowMajor>>&)>& f);
 
+/// Interpolate an expression using a precomputed interpolation plan
+/// (see FunctionSpace::interpolation_plan). The expression is evaluated
+/// at the points of the plan.
+/// @param[in,out] u The function to interpolate into
+/// @param[in] f The expression to be interpolated
+/// @param[in] plan The interpolation plan of the function space of @p u
+template <typename T>
+void interpolate(
+    Function<T>& u,
+    const std::function<
+        Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>(
+            const Eigen::Ref<const Eigen::Array<double, 3, Eigen::Dynamic,
+                                                Eigen::RowMajor>>&)>& f,
+    const InterpolationPlan& plan);
+
 /// Interpolate an expression f(x). This interface uses an expression
 /// function f that has an in/out argument for the expression values. It
 /// is primarily to support C code implementations of the expression,
@@ -70,25 +104,217 @@ void interpolate_values(
       values.data(), coefficients.rows());
 }
 
+// Interpolate from the values (value_size, num_points) of an expression
+// or function at the points of an interpolation plan
 template <typename T>
-void interpolate_from_any(Function<T>& u, const Function<T>& v)
+void interpolate_point_values(
+    Function<T>& u,
+    const Eigen::Ref<const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic,
+                                        Eigen::RowMajor>>& values,
+    const InterpolationPlan& plan)
 {
-  assert(v.function_space());
+  assert(u.function_space());
   const auto element = u.function_space()->element();
   assert(element);
-  if (!v.function_space()->has_element(*element))
+  std::vector<int> vshape(element->value_rank(), 1);
+  for (std::size_t i = 0; i < vshape.size(); ++i)
+    vshape[i] = element->value_dimension(i);
+  const int value_size = std::accumulate(std::begin(vshape), std::end(vshape),
+                                         1, std::multiplies<>());
+
+  if (element->family() == "Mixed")
   {
-    throw std::runtime_error("Restricting finite elements function in "
-                             "different elements not supported.");
+    // Extract the correct components of the result for each subelement
+    // of the MixedElement
+    assert(plan.value_rows.size() == (std::size_t)values.cols());
+    Eigen::Array<T, 1, Eigen::Dynamic> mixed_values(plan.value_rows.size());
+    for (std::size_t i = 0; i < plan.value_rows.size(); ++i)
+      mixed_values(i) = values(plan.value_rows[i], plan.value_cols[i]);
+    detail::interpolate_values<T>(u, mixed_values);
+    return;
   }
 
+  // Note: pybind11 maps 1D NumPy arrays to column vectors for
+  // Eigen::Array<T, Eigen::Dynamic,Eigen::Dynamic, Eigen::RowMajor>
+  // types, therefore we need to handle vectors as a special case.
+  if (values.cols() == 1 and values.rows() != 1)
+  {
+    if (values.rows() != plan.points.cols())
+    {
+      throw std::runtime_error("Number of computed values is not equal to the "
+                               "number of evaluation points. (1)");
+    }
+    detail::interpolate_values<T>(u, values);
+  }
+  else
+  {
+    if (values.rows() != value_size)
+      throw std::runtime_error("Values shape is incorrect. (2)");
+    if (values.cols() != plan.points.cols())
+    {
+      throw std::runtime_error("Number of computed values is not equal to the "
+                               "number of evaluation points. (2)");
+    }
+
+    detail::interpolate_values<T>(u, values.transpose());
+  }
+}
+
+template <typename T>
+void interpolate_nonmatching(Function<T>& u, const Function<T>& v,
+                             PointEvaluator& evaluator)
+{
+  assert(u.function_space());
+  assert(v.function_space());
+  std::shared_ptr<const InterpolationPlan> plan
+      = u.function_space()->interpolation_plan();
+  if (evaluator.mesh() != v.function_space()->mesh()
+      or evaluator.num_points() != plan->points.cols())
+  {
+    throw std::runtime_error("Point evaluator does not match the meshes of "
+                             "the functions.");
+  }
+
+  const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> values
+      = evaluator.eval(v).transpose();
+  interpolate_point_values<T>(u, values, *plan);
+}
+
+// Check if a Function in the space of element_v can be interpolated
+// into the space of element_u on the same mesh with a local
+// interpolation matrix, i.e. if both elements are (blocked) scalar
+// elements with point evaluation dofs and the same block size
+inline bool
+has_local_interpolation_matrix(const fem::FiniteElement& element_u,
+                               const fem::FiniteElement& element_v)
+{
+  const int bs = element_u.block_size();
+  if (element_u.family() == "Mixed" or element_v.family() == "Mixed"
+      or element_v.block_size() != bs)
+  {
+    return false;
+  }
+
+  if (bs == 1)
+    return element_u.value_size() == 1 and element_v.value_size() == 1;
+  else
+  {
+    return element_u.extract_sub_element({0})->value_size() == 1
+           and element_v.extract_sub_element({0})->value_size() == 1;
+  }
+}
+
+// Interpolate v into u on the same mesh with the local interpolation
+// matrix M, with M(i, j) the value of basis function j of (the scalar
+// element of) v at the reference point of dof i of u. The matrix is
+// the same for all cells, as the dofmaps already apply the dof
+// permutations of the cells and the basis functions of scalar elements
+// are not transformed. The interpolation is done as a local matvec
+// for batches of cells, followed by a scatter to the dofs of u.
+template <typename T>
+void interpolate_same_mesh(Function<T>& u, const Function<T>& v)
+{
+  assert(u.function_space());
+  assert(v.function_space());
+  std::shared_ptr<const fem::FiniteElement> element_u
+      = u.function_space()->element();
+  std::shared_ptr<const fem::FiniteElement> element_v
+      = v.function_space()->element();
+  assert(element_u);
+  assert(element_v);
+  const int bs = element_u->block_size();
+  if (bs > 1)
+  {
+    element_u = element_u->extract_sub_element({0});
+    element_v = element_v->extract_sub_element({0});
+  }
+
+  // Local interpolation matrix. The tabulation is cached by the
+  // element, so that it is computed once for a pair of elements.
+  std::shared_ptr<const Eigen::Tensor<double, 3, Eigen::RowMajor>> tab
+      = element_v->tabulate_reference_basis(
+          element_u->dof_reference_coordinates());
+  const Eigen::Index num_dofs_u = tab->dimension(0);
+  const Eigen::Index num_dofs_v = tab->dimension(1);
+  const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> Mt
+      = Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic,
+                                       Eigen::RowMajor>>(tab->data(),
+                                                         num_dofs_u, num_dofs_v)
+            .transpose()
+            .template cast<T>();
+
+  std::shared_ptr<const mesh::Mesh> mesh = u.function_space()->mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+  auto map = mesh->topology().index_map(tdim);
+  assert(map);
+  const std::int32_t num_cells = map->size_local() + map->num_ghosts();
+
+  std::shared_ptr<const fem::DofMap> dofmap_u = u.function_space()->dofmap();
+  std::shared_ptr<const fem::DofMap> dofmap_v = v.function_space()->dofmap();
+  assert(dofmap_u);
+  assert(dofmap_v);
+  Eigen::Matrix<T, Eigen::Dynamic, 1>& u_array = u.x()->array();
+  const Eigen::Matrix<T, Eigen::Dynamic, 1>& v_array = v.x()->array();
+
+  // Coefficients of v (rows: cell and component, columns: dofs of the
+  // scalar element) and the interpolated values of u for a batch of
+  // cells
+  constexpr std::int32_t batch_size = 128;
+  Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> vc(
+      batch_size * bs, num_dofs_v);
+  Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> uc(
+      batch_size * bs, num_dofs_u);
+  for (std::int32_t c0 = 0; c0 < num_cells; c0 += batch_size)
+  {
+    const std::int32_t n = std::min(batch_size, num_cells - c0);
+    for (std::int32_t c = 0; c < n; ++c)
+    {
+      auto dofs_v = dofmap_v->cell_dofs(c0 + c);
+      for (Eigen::Index j = 0; j < num_dofs_v; ++j)
+        for (int k = 0; k < bs; ++k)
+          vc(c * bs + k, j) = v_array[dofs_v[bs * j + k]];
+    }
+
+    uc.topRows(n * bs).noalias() = vc.topRows(n * bs) * Mt;
+
+    for (std::int32_t c = 0; c < n; ++c)
+    {
+      auto dofs_u = dofmap_u->cell_dofs(c0 + c);
+      for (Eigen::Index i = 0; i < num_dofs_u; ++i)
+        for (int k = 0; k < bs; ++k)
+          u_array[dofs_u[bs * i + k]] = uc(c * bs + k, i);
+    }
+  }
+}
+
+template <typename T>
+void interpolate_from_any(Function<T>& u, const Function<T>& v)
+{
+  assert(v.function_space());
   const auto mesh = u.function_space()->mesh();
   assert(mesh);
   assert(v.function_space()->mesh());
   if (mesh->id() != v.function_space()->mesh()->id())
   {
-    throw std::runtime_error(
-        "Interpolation on different meshes not supported (yet).");
+    PointEvaluator evaluator
+        = create_interpolation_evaluator(*u.function_space(),
+                                         v.function_space()->mesh());
+    interpolate_nonmatching(u, v, evaluator);
+    return;
+  }
+  const auto element = u.function_space()->element();
+  assert(element);
+  if (!v.function_space()->has_element(*element))
+  {
+    if (has_local_interpolation_matrix(*element,
+                                       *v.function_space()->element()))
+    {
+      interpolate_same_mesh(u, v);
+      return;
+    }
+    throw std::runtime_error("Restricting finite elements function in "
+                             "different elements not supported.");
   }
   const int tdim = mesh->topology().dim();
 
@@ -156,6 +382,13 @@ void interpolate(Function<T>& u, const Function<T>& v)
 }
 //----------------------------------------------------------------------------
 template <typename T>
+void interpolate(Function<T>& u, const Function<T>& v,
+                 PointEvaluator& evaluator)
+{
+  detail::interpolate_nonmatching(u, v, evaluator);
+}
+//----------------------------------------------------------------------------
+template <typename T>
 void interpolate(
     Function<T>& u,
     const std::function<
@@ -163,85 +396,23 @@ void interpolate(
             const Eigen::Ref<const Eigen::Array<double, 3, Eigen::Dynamic,
                                                 Eigen::RowMajor>>&)>& f)
 {
-  // u.function_space()->interpolate(u.x()->array(), f);
   assert(u.function_space());
-
+  interpolate(u, f, *u.function_space()->interpolation_plan());
+}
+//----------------------------------------------------------------------------
+template <typename T>
+void interpolate(
+    Function<T>& u,
+    const std::function<
+        Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>(
+            const Eigen::Ref<const Eigen::Array<double, 3, Eigen::Dynamic,
+                                                Eigen::RowMajor>>&)>& f,
+    const InterpolationPlan& plan)
+{
   // Evaluate expression at dof points
-  const Eigen::Array<double, 3, Eigen::Dynamic, Eigen::RowMajor> x
-      = u.function_space()
-            ->tabulate_scalar_subspace_dof_coordinates()
-            .transpose();
   const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> values
-      = f(x);
-
-  const auto element = u.function_space()->element();
-  assert(element);
-  std::vector<int> vshape(element->value_rank(), 1);
-  for (std::size_t i = 0; i < vshape.size(); ++i)
-    vshape[i] = element->value_dimension(i);
-  const int value_size = std::accumulate(std::begin(vshape), std::end(vshape),
-                                         1, std::multiplies<>());
-
-  auto mesh = u.function_space()->mesh();
-  assert(mesh);
-  const int tdim = mesh->topology().dim();
-  if (element->family() == "Mixed")
-  {
-    // Extract the correct components of the result for each subelement of the
-    // MixedElement
-    std::shared_ptr<const fem::DofMap> dofmap = u.function_space()->dofmap();
-    auto map = mesh->topology().index_map(tdim);
-    assert(map);
-    const int num_cells = map->size_local() + map->num_ghosts();
-
-    Eigen::Array<T, 1, Eigen::Dynamic> mixed_values(values.cols());
-    int value_offset = 0;
-    for (int i = 0; i < element->num_sub_elements(); ++i)
-    {
-      const std::vector<int> component = {i};
-      const fem::DofMap sub_dofmap = dofmap->extract_sub_dofmap(component);
-      std::shared_ptr<const fem::FiniteElement> sub_element
-          = element->extract_sub_element(component);
-      const int element_block_size = sub_element->block_size();
-      for (std::size_t cell = 0; cell < num_cells; ++cell)
-      {
-        const auto cell_dofs = sub_dofmap.cell_dofs(cell);
-        const std::size_t scalar_dofs = cell_dofs.rows() / element_block_size;
-        for (std::size_t dof = 0; dof < scalar_dofs; ++dof)
-          for (int b = 0; b < element_block_size; ++b)
-            mixed_values(cell_dofs[element_block_size * dof + b])
-                = values(value_offset + b, cell_dofs[element_block_size * dof]);
-      }
-      value_offset += element_block_size;
-    }
-    detail::interpolate_values<T>(u, mixed_values);
-    return;
-  }
-
-  // Note: pybind11 maps 1D NumPy arrays to column vectors for
-  // Eigen::Array<T, Eigen::Dynamic,Eigen::Dynamic, Eigen::RowMajor>
-  // types, therefore we need to handle vectors as a special case.
-  if (values.cols() == 1 and values.rows() != 1)
-  {
-    if (values.rows() != x.cols())
-    {
-      throw std::runtime_error("Number of computed values is not equal to the "
-                               "number of evaluation points. (1)");
-    }
-    detail::interpolate_values<T>(u, values);
-  }
-  else
-  {
-    if (values.rows() != value_size)
-      throw std::runtime_error("Values shape is incorrect. (2)");
-    if (values.cols() != x.cols())
-    {
-      throw std::runtime_error("Number of computed values is not equal to the "
-                               "number of evaluation points. (2)");
-    }
-
-    detail::interpolate_values<T>(u, values.transpose());
-  }
+      = f(plan.points);
+  detail::interpolate_point_values<T>(u, values, plan);
 }
 //----------------------------------------------------------------------------
 template <typename T>
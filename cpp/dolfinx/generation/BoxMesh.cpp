@@ -5,6 +5,7 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "BoxMesh.h"
+#include "utils.h"
 #include <Eigen/Dense>
 #include <cfloat>
 #include <cmath>
@@ -20,6 +21,22 @@ using namespace dolfinx::generation;
 namespace
 {
 //-----------------------------------------------------------------------------
+void check_box(const std::array<Eigen::Vector3d, 2>& p,
+               std::array<std::size_t, 3> n)
+{
+  if (((p[0] - p[1]).array().abs() < 2.0 * DBL_EPSILON).any())
+  {
+    throw std::runtime_error(
+        "Box seems to have zero width, height or depth. Check dimensions");
+  }
+
+  if (n[0] < 1 || n[1] < 1 || n[2] < 1)
+  {
+    throw std::runtime_error(
+        "BoxMesh has non-positive number of vertices in some dimension");
+  }
+}
+//-----------------------------------------------------------------------------
 Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>
 create_geom(MPI_Comm comm, const std::array<Eigen::Vector3d, 2>& p,
             std::array<std::size_t, 3> n)
@@ -53,19 +70,7 @@ create_geom(MPI_Comm comm, const std::array<Eigen::Vector3d, 2>& p,
   const double f = z1;
   const double ef = (f - e) / static_cast<double>(nz);
 
-  if (std::abs(x0 - x1) < 2.0 * DBL_EPSILON
-      || std::abs(y0 - y1) < 2.0 * DBL_EPSILON
-      || std::abs(z0 - z1) < 2.0 * DBL_EPSILON)
-  {
-    throw std::runtime_error(
-        "Box seems to have zero width, height or depth. Check dimensions");
-  }
-
-  if (nx < 1 || ny < 1 || nz < 1)
-  {
-    throw std::runtime_error(
-        "BoxMesh has non-positive number of vertices in some dimension");
-  }
+  check_box(p, n);
 
   Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> geom(
       range_p[1] - range_p[0], 3);
@@ -184,6 +189,47 @@ mesh::Mesh build_hex(MPI_Comm comm, const std::array<Eigen::Vector3d, 2>& p,
                            element, geom, ghost_mode);
 }
 //-----------------------------------------------------------------------------
+mesh::Mesh build_structured(MPI_Comm comm,
+                            const std::array<Eigen::Vector3d, 2>& p,
+                            std::array<std::size_t, 3> n,
+                            const fem::CoordinateElement& element,
+                            const mesh::GhostMode ghost_mode)
+{
+  check_box(p, n);
+  const std::int64_t nx = n[0];
+  const std::int64_t ny = n[1];
+  const bool tet = element.cell_shape() == mesh::CellType::tetrahedron;
+  auto grid_cell
+      = [nx, ny, tet](const std::array<std::int64_t, 3>& c,
+                      Eigen::Ref<Eigen::Array<std::int64_t, Eigen::Dynamic,
+                                              Eigen::Dynamic, Eigen::RowMajor>>
+                          cells) {
+          const std::int64_t v0 = (c[2] * (ny + 1) + c[1]) * (nx + 1) + c[0];
+          const std::int64_t v1 = v0 + 1;
+          const std::int64_t v2 = v0 + (nx + 1);
+          const std::int64_t v3 = v1 + (nx + 1);
+          const std::int64_t v4 = v0 + (nx + 1) * (ny + 1);
+          const std::int64_t v5 = v1 + (nx + 1) * (ny + 1);
+          const std::int64_t v6 = v2 + (nx + 1) * (ny + 1);
+          const std::int64_t v7 = v3 + (nx + 1) * (ny + 1);
+          if (tet)
+          {
+            cells.row(0) << v0, v1, v3, v7;
+            cells.row(1) << v0, v1, v7, v5;
+            cells.row(2) << v0, v5, v7, v4;
+            cells.row(3) << v0, v3, v2, v7;
+            cells.row(4) << v0, v6, v4, v7;
+            cells.row(5) << v0, v2, v6, v7;
+          }
+          else
+            cells.row(0) << v0, v4, v2, v6, v1, v5, v3, v7;
+        };
+
+  return generation::create_structured_mesh(
+      comm, p, {nx, ny, (std::int64_t)n[2]}, element, tet ? 6 : 1, grid_cell,
+      ghost_mode);
+}
+//-----------------------------------------------------------------------------
 
 } // namespace
 
@@ -192,9 +238,16 @@ mesh::Mesh BoxMesh::create(MPI_Comm comm,
                            const std::array<Eigen::Vector3d, 2>& p,
                            std::array<std::size_t, 3> n,
                            const fem::CoordinateElement& element,
-                           const mesh::GhostMode ghost_mode)
+                           const mesh::GhostMode ghost_mode,
+                           bool structured)
 {
-  if (element.cell_shape() == mesh::CellType::tetrahedron)
+  if (structured
+      and (element.cell_shape() == mesh::CellType::tetrahedron
+           or element.cell_shape() == mesh::CellType::hexahedron))
+  {
+    return build_structured(comm, p, n, element, ghost_mode);
+  }
+  else if (element.cell_shape() == mesh::CellType::tetrahedron)
     return build_tet(comm, p, n, element, ghost_mode);
   else if (element.cell_shape() == mesh::CellType::hexahedron)
     return build_hex(comm, p, n, element, ghost_mode);
@@ -40,12 +40,17 @@ public:
   /// @param[in] n Number of cells in each direction.
   /// @param[in] element Element that describes the geometry of a cell
   /// @param[in] ghost_mode Ghost mode
+  /// @param[in] structured If true, the cells are partitioned by index
+  ///   blocks of the grid, and each process creates the cells of its
+  ///   block (see generation::create_structured_mesh). Otherwise, the
+  ///   cells are partitioned by the graph partitioner.
   /// @return Mesh
   static mesh::Mesh create(MPI_Comm comm,
                            const std::array<Eigen::Vector3d, 2>& p,
                            std::array<std::size_t, 3> n,
                            const fem::CoordinateElement& element,
-                           const mesh::GhostMode ghost_mode);
+                           const mesh::GhostMode ghost_mode,
+                           bool structured = false);
 };
 } // namespace generation
 } // namespace dolfinx
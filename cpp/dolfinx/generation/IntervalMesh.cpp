@@ -9,18 +9,70 @@
 #include <Eigen/Dense>
 #include <cfloat>
 #include <cmath>
+#include <numeric>
 #include <dolfinx/fem/ElementDofLayout.h>
 #include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <stdexcept>
 
 using namespace dolfinx;
 using namespace dolfinx::generation;
 
 namespace
 {
-mesh::Mesh build(MPI_Comm comm, std::size_t nx, std::array<double, 2> x,
+//-----------------------------------------------------------------------------
+// Check that the nodes are strictly increasing
+void check_nodes(const std::vector<double>& x)
+{
+  if (x.size() < 2)
+    throw std::runtime_error("Number of interval nodes must be at least 2");
+
+  for (std::size_t i = 1; i < x.size(); ++i)
+  {
+    if (x[i] - x[i - 1] < DBL_EPSILON)
+    {
+      throw std::runtime_error(
+          "Interval nodes must be strictly increasing. Check your nodes.");
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+// Create the intervals between consecutive nodes
+graph::AdjacencyList<std::int64_t> create_cells(std::size_t nx)
+{
+  Eigen::Array<std::int64_t, Eigen::Dynamic, 2, Eigen::RowMajor> topo(nx, 2);
+  for (std::size_t ix = 0; ix < nx; ix++)
+    topo.row(ix) << ix, ix + 1;
+  return graph::AdjacencyList<std::int64_t>(topo);
+}
+//-----------------------------------------------------------------------------
+mesh::Mesh build(MPI_Comm comm, const std::vector<double>& x,
                  const fem::CoordinateElement& element,
                  const mesh::GhostMode ghost_mode)
 {
+  const std::size_t nx = x.size() - 1;
+  if (dolfinx::MPI::size(comm) == 1)
+  {
+    // Fast path for a communicator with a single process: the cells are
+    // created in place, without partitioning or communication
+    graph::AdjacencyList<std::int64_t> cells = create_cells(nx);
+    std::vector<std::int64_t> original_cell_index(nx);
+    std::iota(original_cell_index.begin(), original_cell_index.end(), 0);
+
+    const mesh::NodeFetcher fetch_nodes
+        = [&x](const std::vector<std::int64_t>& indices) {
+            Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                         Eigen::RowMajor>
+                coords(indices.size(), 1);
+            for (std::size_t i = 0; i < indices.size(); ++i)
+              coords(i, 0) = x[indices[i]];
+            return coords;
+          };
+
+    return mesh::create_mesh_with_ghosts(
+        comm, cells, original_cell_index, {}, element, fetch_nodes, ghost_mode);
+  }
+
   // Receive mesh according to parallel policy
   if (dolfinx::MPI::rank(comm) != 0)
   {
@@ -30,9 +82,25 @@ mesh::Mesh build(MPI_Comm comm, std::size_t nx, std::array<double, 2> x,
                              element, geom, ghost_mode);
   }
 
+  // Create vertices
+  const Eigen::Array<double, Eigen::Dynamic, 1> geom
+      = Eigen::Map<const Eigen::Array<double, Eigen::Dynamic, 1>>(x.data(),
+                                                                  x.size());
+
+  return mesh::create_mesh(comm, create_cells(nx), element, geom,
+                           ghost_mode);
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+mesh::Mesh IntervalMesh::create(MPI_Comm comm, std::size_t n,
+                                std::array<double, 2> x,
+                                const fem::CoordinateElement& element,
+                                const mesh::GhostMode ghost_mode)
+{
   const double a = x[0];
   const double b = x[1];
-  const double ab = (b - a) / static_cast<double>(nx);
 
   if (std::abs(a - b) < DBL_EPSILON)
   {
@@ -46,30 +114,22 @@ mesh::Mesh build(MPI_Comm comm, std::size_t nx, std::array<double, 2> x,
         "Interval length is negative. Check order of arguments.");
   }
 
-  if (nx < 1)
+  if (n < 1)
     throw std::runtime_error("Number of points on interval must be at least 1");
 
-  // Create vertices
-  Eigen::Array<double, Eigen::Dynamic, 1> geom((nx + 1), 1);
-  for (std::size_t ix = 0; ix <= nx; ix++)
-    geom(ix, 0) = a + ab * static_cast<double>(ix);
-
-  // Create intervals
-  Eigen::Array<std::int64_t, Eigen::Dynamic, 2, Eigen::RowMajor> topo(nx, 2);
-  for (std::size_t ix = 0; ix < nx; ix++)
-    topo.row(ix) << ix, ix + 1;
+  const double ab = (b - a) / static_cast<double>(n);
+  std::vector<double> nodes(n + 1);
+  for (std::size_t ix = 0; ix <= n; ix++)
+    nodes[ix] = a + ab * static_cast<double>(ix);
 
-  return mesh::create_mesh(comm, graph::AdjacencyList<std::int64_t>(topo),
-                           element, geom, ghost_mode);
+  return build(comm, nodes, element, ghost_mode);
 }
-} // namespace
-
 //-----------------------------------------------------------------------------
-mesh::Mesh IntervalMesh::create(MPI_Comm comm, std::size_t n,
-                                std::array<double, 2> x,
+mesh::Mesh IntervalMesh::create(MPI_Comm comm, const std::vector<double>& x,
                                 const fem::CoordinateElement& element,
                                 const mesh::GhostMode ghost_mode)
 {
-  return build(comm, n, x, element, ghost_mode);
+  check_nodes(x);
+  return build(comm, x, element, ghost_mode);
 }
 //-----------------------------------------------------------------------------
@@ -9,6 +9,7 @@
 #include <array>
 #include <cstddef>
 #include <dolfinx/mesh/Mesh.h>
+#include <vector>
 
 namespace dolfinx
 {
@@ -22,7 +23,10 @@ namespace generation
 
 /// Interval mesh of the 1D line [a,b].  Given the number of cells
 /// (n) in the axial direction, the total number of intervals will
-/// be n and the total number of vertices will be (n + 1).
+/// be n and the total number of vertices will be (n + 1). On a
+/// communicator with a single process, e.g. MPI_COMM_SELF, the mesh is
+/// created without partitioning or collective communication, which
+/// makes creating many small meshes cheap.
 
 class IntervalMesh
 {
@@ -38,6 +42,18 @@ public:
                            std::array<double, 2> x,
                            const fem::CoordinateElement& element,
                            const mesh::GhostMode ghost_mode);
+
+  /// Factory for a mesh with given, e.g. graded, node positions
+  /// @param[in] comm MPI communicator to build the mesh on
+  /// @param[in] x The node positions, strictly increasing. Cell i is
+  ///   [x[i], x[i + 1]]. In parallel, the cells are created from the
+  ///   nodes on rank 0 and then distributed.
+  /// @param[in] element Element that describes the geometry of a cell
+  /// @param[in] ghost_mode Ghosting mode
+  /// @return A mesh
+  static mesh::Mesh create(MPI_Comm comm, const std::vector<double>& x,
+                           const fem::CoordinateElement& element,
+                           const mesh::GhostMode ghost_mode);
 };
 } // namespace generation
 } // namespace dolfinx
@@ -5,6 +5,7 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "RectangleMesh.h"
+#include "utils.h"
 #include <Eigen/Dense>
 #include <cfloat>
 #include <cmath>
@@ -257,14 +258,93 @@ mesh::Mesh build_quad(MPI_Comm comm, const std::array<Eigen::Vector3d, 2>& p,
                            element, geom, ghost_mode);
 }
 //-----------------------------------------------------------------------------
+namespace
+{
+mesh::Mesh build_structured(MPI_Comm comm,
+                            const std::array<Eigen::Vector3d, 2>& p,
+                            std::array<std::size_t, 2> n,
+                            const fem::CoordinateElement& element,
+                            const mesh::GhostMode ghost_mode,
+                            const std::string& diagonal)
+{
+  if (diagonal != "left" && diagonal != "right" && diagonal != "right/left"
+      && diagonal != "left/right")
+  {
+    throw std::runtime_error(
+        "Unknown mesh diagonal definition for a structured mesh.");
+  }
+
+  if (std::abs(p[0][0] - p[1][0]) < DBL_EPSILON
+      || std::abs(p[0][1] - p[1][1]) < DBL_EPSILON)
+  {
+    throw std::runtime_error("Rectangle seems to have zero width, height or "
+                             "depth. Check dimensions");
+  }
+
+  if (n[0] < 1 || n[1] < 1)
+  {
+    throw std::runtime_error(
+        "Rectangle has non-positive number of vertices in some dimension: "
+        "number of vertices must be at least 1 in each dimension");
+  }
+
+  const std::int64_t nx = n[0];
+  const bool tri = element.cell_shape() == mesh::CellType::triangle;
+  auto grid_cell
+      = [nx, tri, diagonal](
+            const std::array<std::int64_t, 3>& c,
+            Eigen::Ref<Eigen::Array<std::int64_t, Eigen::Dynamic,
+                                    Eigen::Dynamic, Eigen::RowMajor>>
+                cells) {
+          const std::int64_t v0 = c[1] * (nx + 1) + c[0];
+          const std::int64_t v1 = v0 + 1;
+          const std::int64_t v2 = v0 + (nx + 1);
+          const std::int64_t v3 = v1 + (nx + 1);
+          if (!tri)
+          {
+            cells.row(0) << v0, v2, v1, v3;
+            return;
+          }
+
+          // The alternating diagonals start with "left" ("right/left") or
+          // "right" ("left/right") at (0, 0)
+          bool left = diagonal == "left";
+          if (diagonal == "right/left")
+            left = (c[0] + c[1]) % 2 == 0;
+          else if (diagonal == "left/right")
+            left = (c[0] + c[1]) % 2 == 1;
+          if (left)
+          {
+            cells.row(0) << v0, v1, v2;
+            cells.row(1) << v1, v2, v3;
+          }
+          else
+          {
+            cells.row(0) << v0, v1, v3;
+            cells.row(1) << v0, v2, v3;
+          }
+        };
+
+  return generation::create_structured_mesh(
+      comm, p, {nx, (std::int64_t)n[1], 1}, element, tri ? 2 : 1, grid_cell,
+      ghost_mode);
+}
+} // namespace
+//-----------------------------------------------------------------------------
 mesh::Mesh RectangleMesh::create(MPI_Comm comm,
                                  const std::array<Eigen::Vector3d, 2>& p,
                                  std::array<std::size_t, 2> n,
                                  const fem::CoordinateElement& element,
                                  const mesh::GhostMode ghost_mode,
-                                 std::string diagonal)
+                                 std::string diagonal, bool structured)
 {
-  if (element.cell_shape() == mesh::CellType::triangle)
+  if (structured
+      and (element.cell_shape() == mesh::CellType::triangle
+           or element.cell_shape() == mesh::CellType::quadrilateral))
+  {
+    return build_structured(comm, p, n, element, ghost_mode, diagonal);
+  }
+  else if (element.cell_shape() == mesh::CellType::triangle)
     return build_tri(comm, p, n, element, ghost_mode, diagonal);
   else if (element.cell_shape() == mesh::CellType::quadrilateral)
     return build_quad(comm, p, n, element, ghost_mode);
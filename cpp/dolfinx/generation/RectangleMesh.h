@@ -36,11 +36,17 @@ public:
   /// @param[in] ghost_mode Mesh ghosting mode
   /// @param[in] diagonal Direction of diagonals: "left", "right",
   ///   "left/right", "crossed"
+  /// @param[in] structured If true, the cells are partitioned by index
+  ///   blocks of the grid, and each process creates the cells of its
+  ///   block (see generation::create_structured_mesh). Otherwise, the
+  ///   cells are created on process 0 and partitioned by the graph
+  ///   partitioner. The "crossed" diagonals are not supported.
   /// @return Mesh
   static mesh::Mesh
   create(MPI_Comm comm, const std::array<Eigen::Vector3d, 2>& p,
          std::array<std::size_t, 2> n, const fem::CoordinateElement& element,
-         const mesh::GhostMode ghost_mode, std::string diagonal = "right");
+         const mesh::GhostMode ghost_mode, std::string diagonal = "right",
+         bool structured = false);
 };
 } // namespace generation
 } // namespace dolfinx
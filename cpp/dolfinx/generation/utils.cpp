@@ -0,0 +1,175 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "utils.h"
+#include <algorithm>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/fem/CoordinateElement.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/cell_types.h>
+#include <numeric>
+#include <vector>
+
+using namespace dolfinx;
+
+//-----------------------------------------------------------------------------
+std::array<int, 3>
+generation::grid_blocks(int size, const std::array<std::int64_t, 3>& n,
+                        int tdim)
+{
+  // Balanced factorisation of the number of processes, in non-increasing
+  // order
+  std::array<int, 3> factors = {0, 0, 0};
+  MPI_Dims_create(size, tdim, factors.data());
+
+  // Give the largest number of blocks to the direction with the most
+  // grid cells
+  std::array<int, 3> axes = {0, 1, 2};
+  std::stable_sort(axes.begin(), axes.begin() + tdim,
+                   [&n](int a, int b) { return n[a] > n[b]; });
+  std::array<int, 3> blocks = {1, 1, 1};
+  for (int i = 0; i < tdim; ++i)
+    blocks[axes[i]] = factors[i];
+  return blocks;
+}
+//-----------------------------------------------------------------------------
+mesh::Mesh generation::create_structured_mesh(
+    MPI_Comm comm, const std::array<Eigen::Vector3d, 2>& p,
+    const std::array<std::int64_t, 3>& n,
+    const fem::CoordinateElement& element, int cells_per_grid_cell,
+    const GridCellFunction& grid_cell, mesh::GhostMode ghost_mode)
+{
+  common::Timer timer("Build structured mesh");
+
+  const int tdim = mesh::cell_dim(element.cell_shape());
+  const int num_vertices = mesh::num_cell_vertices(element.cell_shape());
+  const int size = dolfinx::MPI::size(comm);
+  const int rank = dolfinx::MPI::rank(comm);
+
+  // Number of vertices in each direction
+  std::array<std::int64_t, 3> nv;
+  for (int a = 0; a < 3; ++a)
+    nv[a] = a < tdim ? n[a] + 1 : 1;
+
+  // Block of grid cells of this process, and owner of a grid cell
+  const std::array<int, 3> blocks = grid_blocks(size, n, tdim);
+  const std::array<int, 3> b
+      = {rank % blocks[0], (rank / blocks[0]) % blocks[1],
+         rank / (blocks[0] * blocks[1])};
+  std::array<std::array<std::int64_t, 2>, 3> range;
+  for (int a = 0; a < 3; ++a)
+    range[a] = dolfinx::MPI::local_range(b[a], n[a], blocks[a]);
+  auto owner = [&blocks, &n](const std::array<std::int64_t, 3>& c) {
+    std::array<int, 3> bc;
+    for (int a = 0; a < 3; ++a)
+      bc[a] = dolfinx::MPI::index_owner(blocks[a], c[a], n[a]);
+    return (bc[2] * blocks[1] + bc[1]) * blocks[0] + bc[0];
+  };
+
+  // Create the cells of the block, with a global index from the index
+  // of their grid cell
+  const std::int64_t num_grid_cells = (range[0][1] - range[0][0])
+                                      * (range[1][1] - range[1][0])
+                                      * (range[2][1] - range[2][0]);
+  std::vector<std::int64_t> cell_data, original_cell_index;
+  cell_data.reserve(num_grid_cells * cells_per_grid_cell * num_vertices);
+  original_cell_index.reserve(num_grid_cells * cells_per_grid_cell);
+  Eigen::Array<std::int64_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      sub_cells(cells_per_grid_cell, num_vertices);
+  auto add_cell = [&](const std::array<std::int64_t, 3>& c, int i) {
+    cell_data.insert(cell_data.end(), sub_cells.row(i).data(),
+                     sub_cells.row(i).data() + num_vertices);
+    original_cell_index.push_back(((c[2] * n[1] + c[1]) * n[0] + c[0])
+                                      * cells_per_grid_cell
+                                  + i);
+  };
+  std::array<std::int64_t, 3> c;
+  for (c[2] = range[2][0]; c[2] < range[2][1]; ++c[2])
+  {
+    for (c[1] = range[1][0]; c[1] < range[1][1]; ++c[1])
+    {
+      for (c[0] = range[0][0]; c[0] < range[0][1]; ++c[0])
+      {
+        grid_cell(c, sub_cells);
+        for (int i = 0; i < cells_per_grid_cell; ++i)
+          add_cell(c, i);
+      }
+    }
+  }
+
+  // Create the ghost cells, which are the cells of the layers of grid
+  // cells next to the faces of the block that have a facet on the face.
+  // They are created for all ghost modes, as they are used to determine
+  // the shared vertices.
+  std::vector<int> ghost_owners;
+  for (int a = 0; a < tdim and num_grid_cells > 0; ++a)
+  {
+    const std::int64_t stride = a == 0 ? 1 : (a == 1 ? nv[0] : nv[0] * nv[1]);
+    for (int side = 0; side < 2; ++side)
+    {
+      // The layer of grid cells, and the vertex index of the face
+      const std::int64_t layer = side == 0 ? range[a][0] - 1 : range[a][1];
+      const std::int64_t face = side == 0 ? range[a][0] : range[a][1];
+      if (layer < 0 or layer >= n[a])
+        continue;
+
+      std::array<std::array<std::int64_t, 2>, 3> r = range;
+      r[a] = {layer, layer + 1};
+      for (c[2] = r[2][0]; c[2] < r[2][1]; ++c[2])
+      {
+        for (c[1] = r[1][0]; c[1] < r[1][1]; ++c[1])
+        {
+          for (c[0] = r[0][0]; c[0] < r[0][1]; ++c[0])
+          {
+            grid_cell(c, sub_cells);
+            const int r_owner = owner(c);
+            for (int i = 0; i < cells_per_grid_cell; ++i)
+            {
+              int num_on_face = 0;
+              for (int j = 0; j < num_vertices; ++j)
+                num_on_face += (sub_cells(i, j) / stride) % nv[a] == face;
+              if (num_on_face >= tdim)
+              {
+                add_cell(c, i);
+                ghost_owners.push_back(r_owner);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // The coordinates of the vertices follow from their grid index
+  const Eigen::Vector3d x0 = p[0].cwiseMin(p[1]);
+  const Eigen::Vector3d x1 = p[0].cwiseMax(p[1]);
+  mesh::NodeFetcher fetch_nodes = [tdim, nv, x0, x1,
+                                   n](const std::vector<std::int64_t>& nodes) {
+    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> x(
+        nodes.size(), tdim);
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+    {
+      std::int64_t v = nodes[i];
+      for (int a = 0; a < tdim; ++a)
+      {
+        x(i, a) = x0[a] + (x1[a] - x0[a]) * static_cast<double>(v % nv[a])
+                              / static_cast<double>(n[a]);
+        v /= nv[a];
+      }
+    }
+    return x;
+  };
+
+  const Eigen::Map<const Eigen::Array<std::int64_t, Eigen::Dynamic,
+                                      Eigen::Dynamic, Eigen::RowMajor>>
+      cells(cell_data.data(), original_cell_index.size(), num_vertices);
+  return mesh::create_mesh_with_ghosts(
+      comm, graph::AdjacencyList<std::int64_t>(cells), original_cell_index,
+      ghost_owners, element, fetch_nodes, ghost_mode);
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,75 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <array>
+#include <cstdint>
+#include <dolfinx/mesh/Mesh.h>
+#include <functional>
+#include <mpi.h>
+
+namespace dolfinx
+{
+
+namespace fem
+{
+class CoordinateElement;
+}
+
+namespace generation
+{
+
+/// Function that computes the cells (vertex indices) of a grid cell of
+/// a structured mesh, one row per cell, given the index (ix, iy, iz) of
+/// the grid cell. The vertex (jx, jy, jz) of the grid has index (jz *
+/// (ny + 1) + jy) * (nx + 1) + jx, with jz = 0 for a 2D grid.
+using GridCellFunction = std::function<void(
+    const std::array<std::int64_t, 3>& index,
+    Eigen::Ref<
+        Eigen::Array<std::int64_t, Eigen::Dynamic, Eigen::Dynamic,
+                     Eigen::RowMajor>>
+        cells)>;
+
+/// Compute the number of blocks of a partition of a structured grid
+/// into one block of grid cells per process, with the number of blocks
+/// in each direction balanced against the number of grid cells
+/// @param[in] size The number of processes
+/// @param[in] n The number of grid cells in each direction. The
+///   directions of a 2D grid are (nx, ny, 1).
+/// @param[in] tdim The dimension of the grid
+/// @return The number of blocks in each direction
+std::array<int, 3> grid_blocks(int size, const std::array<std::int64_t, 3>& n,
+                               int tdim);
+
+/// Create a mesh of a structured grid of the box spanned by two points,
+/// with the cells partitioned by index blocks of the grid (see
+/// grid_blocks). Each process creates the cells of its block and the
+/// layer of ghost cells around it (see mesh::create_mesh_with_ghosts),
+/// and the coordinates of the vertices are computed from their grid
+/// index, so neither a graph partitioner nor the distribution of cells
+/// and coordinates is required. Collective.
+/// @param[in] comm The MPI communicator
+/// @param[in] p Two opposite corners of the box
+/// @param[in] n The number of grid cells in each direction. The
+///   directions of a 2D grid are (nx, ny, 1).
+/// @param[in] element The coordinate element of the (linear) cells
+/// @param[in] cells_per_grid_cell The number of cells of a grid cell
+/// @param[in] grid_cell Function that computes the cells of a grid
+///   cell
+/// @param[in] ghost_mode The type of ghost cells
+/// @return A mesh
+mesh::Mesh create_structured_mesh(MPI_Comm comm,
+                                  const std::array<Eigen::Vector3d, 2>& p,
+                                  const std::array<std::int64_t, 3>& n,
+                                  const fem::CoordinateElement& element,
+                                  int cells_per_grid_cell,
+                                  const GridCellFunction& grid_cell,
+                                  mesh::GhostMode ghost_mode);
+
+} // namespace generation
+} // namespace dolfinx
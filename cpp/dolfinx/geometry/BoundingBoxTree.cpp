@@ -5,12 +5,26 @@
 
 #include "BoundingBoxTree.h"
 #include "utils.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/SharedMemory.h>
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/utils.h>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 using namespace dolfinx;
 using namespace dolfinx::geometry;
@@ -18,7 +32,8 @@ using namespace dolfinx::geometry;
 namespace
 {
 //-----------------------------------------------------------------------------
-// Compute bounding box of mesh entity
+// Compute bounding box of mesh entity. The connectivities (dim, tdim),
+// (tdim, 0) and (dim, 0) must have been created.
 Eigen::Array<double, 2, 3, Eigen::RowMajor>
 compute_bbox_of_entity(const mesh::Mesh& mesh, int dim, std::int32_t index)
 {
@@ -26,7 +41,6 @@ compute_bbox_of_entity(const mesh::Mesh& mesh, int dim, std::int32_t index)
   const int tdim = mesh.topology().dim();
   const mesh::Geometry& geometry = mesh.geometry();
   const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
-  mesh.topology_mutable().create_connectivity(dim, tdim);
 
   // Find attached cell
   auto e_to_c = mesh.topology().connectivity(dim, tdim);
@@ -69,25 +83,6 @@ compute_bbox_of_entity(const mesh::Mesh& mesh, int dim, std::int32_t index)
   return b;
 }
 //-----------------------------------------------------------------------------
-// Compute bounding box of points
-Eigen::Array<double, 2, 3, Eigen::RowMajor>
-compute_bbox_of_points(const std::vector<Eigen::Vector3d>& points,
-                       const std::vector<int>::iterator& begin,
-                       const std::vector<int>::iterator& end)
-{
-  Eigen::Array<double, 2, 3, Eigen::RowMajor> b;
-  b.row(0) = points[*begin];
-  b.row(1) = points[*begin];
-  for (auto it = begin; it != end; ++it)
-  {
-    const Eigen::Vector3d& p = points[*it];
-    b.row(0) = b.row(0).min(p.transpose().array());
-    b.row(1) = b.row(1).max(p.transpose().array());
-  }
-
-  return b;
-}
-//-----------------------------------------------------------------------------
 // Compute bounding box of bounding boxes
 Eigen::Array<double, 2, 3, Eigen::RowMajor> compute_bbox_of_bboxes(
     const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& leaf_bboxes,
@@ -106,46 +101,173 @@ Eigen::Array<double, 2, 3, Eigen::RowMajor> compute_bbox_of_bboxes(
 
   return b;
 }
+//-----------------------------------------------------------------------------
+// Cost measure of a bounding box for the surface area heuristic (the
+// surface area, or the sum of the extents for flat boxes)
+double sah_measure(const Eigen::Array<double, 2, 3, Eigen::RowMajor>& b)
+{
+  const Eigen::Array3d d = (b.row(1) - b.row(0)).transpose();
+  const double area = d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+  return area > 0.0 ? area : d.sum();
+}
+//-----------------------------------------------------------------------------
+// Partition the boxes [begin, end) of a node using the binned surface
+// area heuristic, i.e. minimise the sum over the two children of the
+// number of boxes times the surface area. Returns end if the centroids
+// cannot be split.
+std::vector<int>::iterator sah_partition(
+    const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& leaf_bboxes,
+    const std::vector<int>::iterator begin,
+    const std::vector<int>::iterator end)
+{
+  constexpr int num_bins = 16;
+
+  // Bounds of the box centroids (times two)
+  Eigen::Array<double, 2, 3, Eigen::RowMajor> c;
+  c.row(0) = leaf_bboxes.row(2 * (*begin)) + leaf_bboxes.row(2 * (*begin) + 1);
+  c.row(1) = c.row(0);
+  for (auto it = begin; it != end; ++it)
+  {
+    const Eigen::Array<double, 1, 3> x
+        = leaf_bboxes.row(2 * (*it)) + leaf_bboxes.row(2 * (*it) + 1);
+    c.row(0) = c.row(0).min(x);
+    c.row(1) = c.row(1).max(x);
+  }
+
+  Eigen::Array<double, 2, 3, Eigen::RowMajor>::Index axis;
+  const double extent = (c.row(1) - c.row(0)).maxCoeff(&axis);
+  if (extent <= 0.0)
+    return end;
+
+  // Bin the boxes by the centroid along the axis
+  auto bin = [&leaf_bboxes, &c, axis, extent](int i) {
+    const double x = leaf_bboxes(2 * i, axis) + leaf_bboxes(2 * i + 1, axis);
+    const int k = num_bins * (x - c(0, axis)) / extent;
+    return std::min(k, num_bins - 1);
+  };
+  std::array<int, num_bins> count;
+  count.fill(0);
+  std::array<Eigen::Array<double, 2, 3, Eigen::RowMajor>, num_bins> bounds;
+  for (auto it = begin; it != end; ++it)
+  {
+    const int k = bin(*it);
+    const auto b = leaf_bboxes.block<2, 3>(2 * (*it), 0);
+    if (count[k]++ == 0)
+      bounds[k] = b;
+    else
+    {
+      bounds[k].row(0) = bounds[k].row(0).min(b.row(0));
+      bounds[k].row(1) = bounds[k].row(1).max(b.row(1));
+    }
+  }
+
+  // Cost of the boxes in bins [k, num_bins) (right of the split k)
+  std::array<double, num_bins> cost_right;
+  {
+    Eigen::Array<double, 2, 3, Eigen::RowMajor> b;
+    int n = 0;
+    for (int k = num_bins - 1; k > 0; --k)
+    {
+      if (count[k] > 0)
+      {
+        if (n == 0)
+          b = bounds[k];
+        else
+        {
+          b.row(0) = b.row(0).min(bounds[k].row(0));
+          b.row(1) = b.row(1).max(bounds[k].row(1));
+        }
+        n += count[k];
+      }
+      cost_right[k] = n > 0 ? n * sah_measure(b) : 0.0;
+    }
+  }
+
+  // Find the split with the lowest cost that leaves boxes on both sides
+  const int num_boxes = end - begin;
+  int split = -1;
+  double cost_min = std::numeric_limits<double>::max();
+  Eigen::Array<double, 2, 3, Eigen::RowMajor> b;
+  for (int k = 1, n = 0; k < num_bins; ++k)
+  {
+    if (count[k - 1] > 0)
+    {
+      if (n == 0)
+        b = bounds[k - 1];
+      else
+      {
+        b.row(0) = b.row(0).min(bounds[k - 1].row(0));
+        b.row(1) = b.row(1).max(bounds[k - 1].row(1));
+      }
+      n += count[k - 1];
+    }
+    if (n == 0 or n == num_boxes)
+      continue;
+    if (const double cost = n * sah_measure(b) + cost_right[k];
+        cost < cost_min)
+    {
+      cost_min = cost;
+      split = k;
+    }
+  }
+
+  if (split < 0)
+    return end;
+  return std::partition(begin, end,
+                        [&bin, split](int i) { return bin(i) < split; });
+}
 //------------------------------------------------------------------------------
-int _build_from_leaf(
+// Build the (sub)tree for the boxes [partition_begin, partition_end).
+// A tree with n leaves has 2n - 1 nodes, which are stored in post-order
+// (the root last) in rows [offset, offset + 2n - 1) of bboxes and
+// bbox_coordinates. Subtrees of large nodes are built concurrently
+// on (at most) num_threads threads.
+void _build_from_leaf(
     const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& leaf_bboxes,
     const std::vector<int>::iterator partition_begin,
-    const std::vector<int>::iterator partition_end,
-    std::vector<std::array<int, 2>>& bboxes,
-    std::vector<double>& bbox_coordinates)
+    const std::vector<int>::iterator partition_end, int offset,
+    int num_threads, bool sah,
+    Eigen::Array<int, Eigen::Dynamic, 2, Eigen::RowMajor>& bboxes,
+    Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& bbox_coordinates)
 {
   assert(partition_begin < partition_end);
 
-  if (partition_end - partition_begin == 1)
-  {
-    // Reached leaf
+  // Minimum number of boxes of a node to build its subtrees
+  // concurrently
+  constexpr int min_parallel = 8192;
 
-    // Get bounding box coordinates for leaf
+  const int num_boxes = partition_end - partition_begin;
+  const int node = offset + 2 * num_boxes - 2;
+  if (num_boxes == 1)
+  {
+    // Reached leaf. Store bounding box data:
+    // bbox[0] = node; // child_0 == node denotes a leaf
+    // bbox[1] = entity_index; // index of entity contained in leaf
     const int entity_index = *partition_begin;
-    Eigen::Array<double, 2, 3, Eigen::RowMajor> b
+    bboxes.row(node) << node, entity_index;
+    bbox_coordinates.block<2, 3>(2 * node, 0)
         = leaf_bboxes.block<2, 3>(2 * entity_index, 0);
+    return;
+  }
 
-    // Store bounding box data
-    // bbox[0] = num_bboxes(); // child_0 == node denotes a leaf
-    // bbox[1] = entity_index; // index of entity contained in leaf
-    // return add_bbox(bbox, b);
-    // return add_bbox({num_bboxes(), entity_index}, b);
-    bboxes.push_back({(int)bboxes.size(), entity_index});
-    bbox_coordinates.insert(bbox_coordinates.end(), b.data(), b.data() + 3);
-    bbox_coordinates.insert(bbox_coordinates.end(), b.data() + 3, b.data() + 6);
-    return bboxes.size() - 1;
+  // Compute bounding box of all bounding boxes
+  bbox_coordinates.block<2, 3>(2 * node, 0)
+      = compute_bbox_of_bboxes(leaf_bboxes, partition_begin, partition_end);
+
+  // Split the bounding boxes using the surface area heuristic, or at
+  // the median along the longest axis
+  auto partition_middle = partition_end;
+  if (sah)
+  {
+    partition_middle
+        = sah_partition(leaf_bboxes, partition_begin, partition_end);
   }
-  else
+  if (partition_middle == partition_end)
   {
-    // Compute bounding box of all bounding boxes
-    Eigen::Array<double, 2, 3, Eigen::RowMajor> b
-        = compute_bbox_of_bboxes(leaf_bboxes, partition_begin, partition_end);
-
-    // Sort bounding boxes along longest axis
     Eigen::Array<double, 2, 3, Eigen::RowMajor>::Index axis;
-    (b.row(1) - b.row(0)).maxCoeff(&axis);
-    auto partition_middle
-        = partition_begin + (partition_end - partition_begin) / 2;
+    (bbox_coordinates.row(2 * node + 1) - bbox_coordinates.row(2 * node))
+        .maxCoeff(&axis);
+    partition_middle = partition_begin + num_boxes / 2;
     std::nth_element(partition_begin, partition_middle, partition_end,
                      [&leaf_bboxes, axis](int i, int j) -> bool {
                        const double bi = leaf_bboxes(i * 2, axis)
@@ -154,98 +276,352 @@ int _build_from_leaf(
                                          + leaf_bboxes(j * 2 + 1, axis);
                        return (bi < bj);
                      });
+  }
 
-    // Split bounding boxes into two groups and call recursively
-    std::array bbox{_build_from_leaf(leaf_bboxes, partition_begin,
-                                     partition_middle, bboxes,
-                                     bbox_coordinates),
-                    _build_from_leaf(leaf_bboxes, partition_middle,
-                                     partition_end, bboxes, bbox_coordinates)};
+  // Build the two subtrees, concurrently for large nodes
+  const int num_left = partition_middle - partition_begin;
+  const int offset_right = offset + 2 * num_left - 1;
+  auto build_left = [&](int n) {
+    _build_from_leaf(leaf_bboxes, partition_begin, partition_middle, offset, n,
+                     sah, bboxes, bbox_coordinates);
+  };
+  auto build_right = [&](int n) {
+    _build_from_leaf(leaf_bboxes, partition_middle, partition_end,
+                     offset_right, n, sah, bboxes, bbox_coordinates);
+  };
+  if (num_threads > 1 and num_boxes >= min_parallel)
+  {
+    std::thread t(build_left, num_threads / 2);
+    build_right(num_threads - num_threads / 2);
+    t.join();
+  }
+  else
+  {
+    build_left(1);
+    build_right(1);
+  }
 
-    // Store bounding box data. Note that root box will be added last.
-    bboxes.push_back(bbox);
-    bbox_coordinates.insert(bbox_coordinates.end(), b.data(), b.data() + 3);
-    bbox_coordinates.insert(bbox_coordinates.end(), b.data() + 3, b.data() + 6);
-    return bboxes.size() - 1;
+  // Store bounding box data. Note that root box is stored last.
+  bboxes.row(node) << offset + 2 * num_left - 2, node - 1;
+}
+//-----------------------------------------------------------------------------
+// Call fn(i) for the chunks i = 0, ..., num_chunks - 1, each on its own
+// thread (chunk 0 on the calling thread)
+template <typename Fn>
+void run_chunks(int num_chunks, const Fn& fn)
+{
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_chunks; ++i)
+    threads.emplace_back(fn, i);
+  fn(0);
+  for (auto& t : threads)
+    t.join();
+}
+//-----------------------------------------------------------------------------
+// Spread the lowest 21 bits of x to every third bit
+std::uint64_t expand_bits(std::uint64_t x)
+{
+  x &= 0x1fffff;
+  x = (x | x << 32) & 0x1f00000000ffff;
+  x = (x | x << 16) & 0x1f0000ff0000ff;
+  x = (x | x << 8) & 0x100f00f00f00f00f;
+  x = (x | x << 4) & 0x10c30c30c30c30c3;
+  x = (x | x << 2) & 0x1249249249249249;
+  return x;
+}
+//-----------------------------------------------------------------------------
+// Compute the Morton codes (21 bits per axis) of the centres of the
+// leaf boxes, relative to the box of all centres, on num_chunks threads
+std::vector<std::uint64_t> morton_codes(
+    const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& leaf_bboxes,
+    int num_chunks)
+{
+  const std::int32_t n = leaf_bboxes.rows() / 2;
+  auto chunk = [n, num_chunks](int i) {
+    return std::array<std::int32_t, 2>{
+        std::int32_t((i * std::int64_t(n)) / num_chunks),
+        std::int32_t(((i + 1) * std::int64_t(n)) / num_chunks)};
+  };
+
+  // Compute the box of the (doubled) centres
+  std::vector<Eigen::Array<double, 2, 3, Eigen::RowMajor>> bounds(num_chunks);
+  run_chunks(num_chunks, [&](int i) {
+    bounds[i].row(0).setConstant(std::numeric_limits<double>::max());
+    bounds[i].row(1).setConstant(std::numeric_limits<double>::lowest());
+    const auto [e0, e1] = chunk(i);
+    for (std::int32_t e = e0; e < e1; ++e)
+    {
+      auto c = leaf_bboxes.row(2 * e) + leaf_bboxes.row(2 * e + 1);
+      bounds[i].row(0) = bounds[i].row(0).min(c);
+      bounds[i].row(1) = bounds[i].row(1).max(c);
+    }
+  });
+  Eigen::Array<double, 2, 3, Eigen::RowMajor> b = bounds[0];
+  for (int i = 1; i < num_chunks; ++i)
+  {
+    b.row(0) = b.row(0).min(bounds[i].row(0));
+    b.row(1) = b.row(1).max(bounds[i].row(1));
   }
+  const Eigen::Array<double, 1, 3> extent = b.row(1) - b.row(0);
+  const Eigen::Array<double, 1, 3> scale
+      = (extent > 0.0).select(double((1 << 21) - 1) / extent, 0.0);
+
+  // Quantise the centres and interleave the bits of the axes
+  std::vector<std::uint64_t> codes(n);
+  run_chunks(num_chunks, [&](int i) {
+    const auto [e0, e1] = chunk(i);
+    for (std::int32_t e = e0; e < e1; ++e)
+    {
+      const Eigen::Array<double, 1, 3> q
+          = (leaf_bboxes.row(2 * e) + leaf_bboxes.row(2 * e + 1) - b.row(0))
+            * scale;
+      codes[e] = expand_bits(q[0]) | expand_bits(q[1]) << 1
+                 | expand_bits(q[2]) << 2;
+    }
+  });
+
+  return codes;
+}
+//-----------------------------------------------------------------------------
+// Sort the leaves by their Morton codes with a (stable) least
+// significant digit radix sort on 8-bit digits. The digits of the
+// chunks of the codes are counted and scattered on num_chunks threads.
+// Returns the leaves in the order of their codes and the sorted codes.
+std::pair<std::vector<int>, std::vector<std::uint64_t>>
+radix_sort(std::vector<std::uint64_t> codes, int num_chunks)
+{
+  const std::int32_t n = codes.size();
+  auto chunk = [n, num_chunks](int i) {
+    return std::array<std::int32_t, 2>{
+        std::int32_t((i * std::int64_t(n)) / num_chunks),
+        std::int32_t(((i + 1) * std::int64_t(n)) / num_chunks)};
+  };
+
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::vector<std::uint64_t> codes_tmp(n);
+  std::vector<int> order_tmp(n);
+  std::vector<std::array<std::int32_t, 256>> counts(num_chunks);
+  for (int shift = 0; shift < 64; shift += 8)
+  {
+    // Count the digits in each chunk
+    run_chunks(num_chunks, [&](int i) {
+      counts[i].fill(0);
+      const auto [j0, j1] = chunk(i);
+      for (std::int32_t j = j0; j < j1; ++j)
+        ++counts[i][(codes[j] >> shift) & 0xff];
+    });
+
+    // Compute the positions of the digits of each chunk (digit major),
+    // and skip the pass if all codes have the same digit
+    std::int32_t pos = 0;
+    bool skip = false;
+    for (int d = 0; d < 256; ++d)
+    {
+      const std::int32_t pos0 = pos;
+      for (int i = 0; i < num_chunks; ++i)
+        pos += std::exchange(counts[i][d], pos);
+      skip = skip or pos - pos0 == n;
+    }
+    if (skip)
+      continue;
+
+    run_chunks(num_chunks, [&](int i) {
+      const auto [j0, j1] = chunk(i);
+      for (std::int32_t j = j0; j < j1; ++j)
+      {
+        const std::int32_t k = counts[i][(codes[j] >> shift) & 0xff]++;
+        codes_tmp[k] = codes[j];
+        order_tmp[k] = order[j];
+      }
+    });
+    std::swap(codes, codes_tmp);
+    std::swap(order, order_tmp);
+  }
+
+  return {std::move(order), std::move(codes)};
+}
+//-----------------------------------------------------------------------------
+// Build the (sub)tree for the leaves [begin, end) of the leaves sorted
+// by Morton code (order). The leaves are split at the highest bit of
+// the codes that differs, or in the middle if all codes are equal. The
+// nodes are stored as in _build_from_leaf, and the box of a node is
+// computed from the boxes of its children. Subtrees of large nodes are
+// built concurrently on (at most) num_threads threads.
+void _build_linear(
+    const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& leaf_bboxes,
+    const std::vector<int>& order, const std::vector<std::uint64_t>& codes,
+    int begin, int end, int offset, int num_threads,
+    Eigen::Array<int, Eigen::Dynamic, 2, Eigen::RowMajor>& bboxes,
+    Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& bbox_coordinates)
+{
+  assert(begin < end);
+
+  // Minimum number of boxes of a node to build its subtrees
+  // concurrently
+  constexpr int min_parallel = 8192;
+
+  const int num_boxes = end - begin;
+  const int node = offset + 2 * num_boxes - 2;
+  if (num_boxes == 1)
+  {
+    const int entity_index = order[begin];
+    bboxes.row(node) << node, entity_index;
+    bbox_coordinates.block<2, 3>(2 * node, 0)
+        = leaf_bboxes.block<2, 3>(2 * entity_index, 0);
+    return;
+  }
+
+  // Split the leaves at the highest bit that differs. The codes are
+  // sorted, so the leaves with the bit set are at the end.
+  int middle = begin + num_boxes / 2;
+  if (const std::uint64_t diff = codes[begin] ^ codes[end - 1]; diff != 0)
+  {
+    std::uint64_t mask = std::uint64_t(1) << 63;
+    while (!(diff & mask))
+      mask >>= 1;
+    middle = std::partition_point(
+                 codes.begin() + begin, codes.begin() + end,
+                 [mask](std::uint64_t code) { return !(code & mask); })
+             - codes.begin();
+  }
+
+  // Build the two subtrees, concurrently for large nodes
+  const int num_left = middle - begin;
+  const int offset_right = offset + 2 * num_left - 1;
+  auto build_left = [&](int n) {
+    _build_linear(leaf_bboxes, order, codes, begin, middle, offset, n, bboxes,
+                  bbox_coordinates);
+  };
+  auto build_right = [&](int n) {
+    _build_linear(leaf_bboxes, order, codes, middle, end, offset_right, n,
+                  bboxes, bbox_coordinates);
+  };
+  if (num_threads > 1 and num_boxes >= min_parallel)
+  {
+    std::thread t(build_left, num_threads / 2);
+    build_right(num_threads - num_threads / 2);
+    t.join();
+  }
+  else
+  {
+    build_left(1);
+    build_right(1);
+  }
+
+  // Compute the bounding box from the boxes of the children
+  const int left = offset + 2 * num_left - 2;
+  bbox_coordinates.row(2 * node)
+      = bbox_coordinates.row(2 * left).min(bbox_coordinates.row(2 * node - 2));
+  bbox_coordinates.row(2 * node + 1) = bbox_coordinates.row(2 * left + 1).max(
+      bbox_coordinates.row(2 * node - 1));
+  bboxes.row(node) << left, node - 1;
 }
 //-----------------------------------------------------------------------------
 std::tuple<Eigen::Array<int, Eigen::Dynamic, 2, Eigen::RowMajor>,
            Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>
 build_from_leaf(
-    const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& leaf_bboxes)
+    const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& leaf_bboxes,
+    int num_threads = 1, BuildMethod method = BuildMethod::median)
 {
   assert(leaf_bboxes.size() % 2 == 0);
-  std::vector<int> partition(leaf_bboxes.rows() / 2);
-  std::iota(partition.begin(), partition.end(), 0);
+  const int num_leaves = leaf_bboxes.rows() / 2;
 
-  std::vector<std::array<int, 2>> bboxes;
-  std::vector<double> bbox_coordinates;
-  _build_from_leaf(leaf_bboxes, partition.begin(), partition.end(), bboxes,
-                   bbox_coordinates);
+  // The tree has 2n - 1 nodes for n leaves
+  const int num_nodes = std::max(2 * num_leaves - 1, 0);
+  Eigen::Array<int, Eigen::Dynamic, 2, Eigen::RowMajor> bboxes(num_nodes, 2);
+  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> bbox_coordinates(
+      2 * num_nodes, 3);
+  if (num_leaves == 0)
+    return {std::move(bboxes), std::move(bbox_coordinates)};
 
-  Eigen::Array<int, Eigen::Dynamic, 2, Eigen::RowMajor> bbox_array(
-      bboxes.size(), 2);
-  for (std::size_t i = 0; i < bboxes.size(); ++i)
+  if (method == BuildMethod::linear)
+  {
+    const int num_chunks
+        = std::max(1, std::min(num_threads, num_leaves / 8192));
+    const auto [order, codes]
+        = radix_sort(morton_codes(leaf_bboxes, num_chunks), num_chunks);
+    _build_linear(leaf_bboxes, order, codes, 0, num_leaves, 0, num_threads,
+                  bboxes, bbox_coordinates);
+  }
+  else
   {
-    bbox_array(i, 0) = bboxes[i][0];
-    bbox_array(i, 1) = bboxes[i][1];
+    std::vector<int> partition(num_leaves);
+    std::iota(partition.begin(), partition.end(), 0);
+    _build_from_leaf(leaf_bboxes, partition.begin(), partition.end(), 0,
+                     num_threads, method == BuildMethod::sah, bboxes,
+                     bbox_coordinates);
   }
-  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> bbox_coord_array(
-      bbox_coordinates.size() / 3, 3);
-  std::copy(bbox_coordinates.begin(), bbox_coordinates.end(),
-            bbox_coord_array.data());
 
-  return {bbox_array, bbox_coord_array};
+  return {std::move(bboxes), std::move(bbox_coordinates)};
 }
 //-----------------------------------------------------------------------------
-int _build_from_point(const std::vector<Eigen::Vector3d>& points,
-                      const std::vector<int>::iterator begin,
-                      const std::vector<int>::iterator end,
-                      std::vector<std::array<int, 2>>& bboxes,
-                      std::vector<double>& bbox_coordinates)
+// Recompute the boxes of the (sub)tree with root node, whose nodes are
+// stored in rows [offset, node] (see _build_from_leaf), from the mesh
+// entities of the leaves. Subtrees of large nodes are refitted
+// concurrently on (at most) num_threads threads.
+void refit_subtree(
+    const mesh::Mesh& mesh, int dim, int node, int offset, int num_threads,
+    const Eigen::Array<int, Eigen::Dynamic, 2, Eigen::RowMajor>& bboxes,
+    Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& bbox_coordinates)
 {
-  assert(begin < end);
+  // Minimum number of nodes of a subtree to refit its subtrees
+  // concurrently
+  constexpr int min_parallel = 16384;
 
-  // Reached leaf
-  if (end - begin == 1)
+  if (bboxes(node, 0) == node)
   {
-    // Store bounding box data
-    const int point_index = *begin;
-    const int c0 = bboxes.size(); // child_0 == node denotes a leaf
-    const int c1 = point_index;   // index of entity contained in leaf
-    bboxes.push_back({c0, c1});
-    bbox_coordinates.insert(bbox_coordinates.end(), points[point_index].data(),
-                            points[point_index].data() + 3);
-    bbox_coordinates.insert(bbox_coordinates.end(), points[point_index].data(),
-                            points[point_index].data() + 3);
-    return bboxes.size() - 1;
+    bbox_coordinates.block<2, 3>(2 * node, 0)
+        = compute_bbox_of_entity(mesh, dim, bboxes(node, 1));
+    return;
   }
 
-  // Compute bounding box of all points
-  Eigen::Array<double, 2, 3, Eigen::RowMajor> b
-      = compute_bbox_of_points(points, begin, end);
-
-  // Sort bounding boxes along longest axis
-  auto middle = begin + (end - begin) / 2;
-  Eigen::Array<double, 2, 3, Eigen::RowMajor>::Index axis;
-  (b.row(1) - b.row(0)).maxCoeff(&axis);
-  std::nth_element(begin, middle, end, [&points, &axis](int i, int j) -> bool {
-    const double* pi = points[i].data();
-    const double* pj = points[j].data();
-    return pi[axis] < pj[axis];
-  });
-
-  // Split bounding boxes into two groups and call recursively
-  std::array bbox{
-      _build_from_point(points, begin, middle, bboxes, bbox_coordinates),
-      _build_from_point(points, middle, end, bboxes, bbox_coordinates)};
+  // The left subtree is stored in rows [offset, left], and the right
+  // subtree in rows [left + 1, node - 1]
+  const int left = bboxes(node, 0);
+  const int right = bboxes(node, 1);
+  assert(right == node - 1);
+  if (num_threads > 1 and node - offset + 1 >= min_parallel)
+  {
+    std::thread t(refit_subtree, std::cref(mesh), dim, left, offset,
+                  num_threads / 2, std::cref(bboxes),
+                  std::ref(bbox_coordinates));
+    refit_subtree(mesh, dim, right, left + 1, num_threads - num_threads / 2,
+                  bboxes, bbox_coordinates);
+    t.join();
+  }
+  else
+  {
+    refit_subtree(mesh, dim, left, offset, 1, bboxes, bbox_coordinates);
+    refit_subtree(mesh, dim, right, left + 1, 1, bboxes, bbox_coordinates);
+  }
 
-  // Store bounding box data. Note that root box will be added last
-  bboxes.push_back(bbox);
-  bbox_coordinates.insert(bbox_coordinates.end(), b.data(), b.data() + 3);
-  bbox_coordinates.insert(bbox_coordinates.end(), b.data() + 3, b.data() + 6);
-  return bboxes.size() - 1;
+  bbox_coordinates.row(2 * node) = bbox_coordinates.row(2 * left).min(
+      bbox_coordinates.row(2 * right));
+  bbox_coordinates.row(2 * node + 1) = bbox_coordinates.row(2 * left + 1).max(
+      bbox_coordinates.row(2 * right + 1));
+}
+//-----------------------------------------------------------------------------
+// Compute the bounding box of the geometry nodes on this process. The
+// box of a process without nodes is empty (the lower corner is above
+// the upper corner), so that it does not collide with anything.
+Eigen::Array<double, 2, 3, Eigen::RowMajor>
+compute_bbox_of_geometry(const mesh::Geometry& geometry)
+{
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x
+      = geometry.x();
+  Eigen::Array<double, 2, 3, Eigen::RowMajor> b;
+  if (x.rows() == 0)
+  {
+    b.row(0).setConstant(std::numeric_limits<double>::max());
+    b.row(1).setConstant(std::numeric_limits<double>::lowest());
+  }
+  else
+  {
+    b.row(0) = x.colwise().minCoeff();
+    b.row(1) = x.colwise().maxCoeff();
+  }
+  return b;
 }
 //-----------------------------------------------------------------------------
 } // namespace
@@ -254,12 +630,27 @@ int _build_from_point(const std::vector<Eigen::Vector3d>& points,
 BoundingBoxTree::BoundingBoxTree(
     const Eigen::Array<int, Eigen::Dynamic, 2, Eigen::RowMajor>& bboxes,
     const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& bbox_coords)
-    : _tdim(0), _bboxes(bboxes), _bbox_coordinates(bbox_coords)
+    : _tdim(0), _method(BuildMethod::median), _bboxes(bboxes),
+      _bbox_coordinates(bbox_coords)
+{
+  set_nodes();
+}
+//-----------------------------------------------------------------------------
+BoundingBoxTree::BoundingBoxTree(
+    std::shared_ptr<const common::SharedMemory> memory, int num_nodes)
+    : _tdim(0), _method(BuildMethod::median), _shared_memory(memory),
+      _num_nodes(num_nodes)
 {
-  // Do nothing
+  assert(_shared_memory);
+  _nodes = _shared_memory->data<const int>();
+  _node_coordinates = reinterpret_cast<const double*>(_nodes + 2 * num_nodes);
 }
 //-----------------------------------------------------------------------------
-BoundingBoxTree::BoundingBoxTree(const mesh::Mesh& mesh, int tdim) : _tdim(tdim)
+BoundingBoxTree::BoundingBoxTree(const mesh::Mesh& mesh, int tdim,
+                                 int num_threads, BuildMethod method,
+                                 bool neighbour_processes, bool shared_memory)
+    : _tdim(tdim), _method(method), _neighbour_processes(neighbour_processes),
+      _shared_process_tree(shared_memory)
 {
   // Check dimension
   if (tdim < 1 or tdim > mesh.topology().dim())
@@ -268,78 +659,266 @@ BoundingBoxTree::BoundingBoxTree(const mesh::Mesh& mesh, int tdim) : _tdim(tdim)
                              + std::to_string(mesh.topology().dim()));
   }
 
-  // Initialize entities of given dimension if they don't exist
+  // Initialize entities of given dimension if they don't exist, and the
+  // connectivity to the cells
   mesh.topology_mutable().create_entities(tdim);
+  mesh.topology_mutable().create_connectivity(tdim, mesh.topology().dim());
 
-  // Create bounding boxes for all mesh entities (leaves)
+  // Create bounding boxes for all mesh entities (leaves), in chunks on
+  // (at most) num_threads threads
   auto map = mesh.topology().index_map(tdim);
   assert(map);
   const std::int32_t num_leaves = map->size_local() + map->num_ghosts();
   Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> leaf_bboxes(
       2 * num_leaves, 3);
-  for (int e = 0; e < num_leaves; ++e)
-    leaf_bboxes.block<2, 3>(2 * e, 0) = compute_bbox_of_entity(mesh, tdim, e);
+  auto compute_leaves = [&mesh, &leaf_bboxes, tdim](std::int32_t e0,
+                                                    std::int32_t e1) {
+    for (std::int32_t e = e0; e < e1; ++e)
+      leaf_bboxes.block<2, 3>(2 * e, 0) = compute_bbox_of_entity(mesh, tdim, e);
+  };
+  const int n = std::max(1, std::min(num_threads, num_leaves / 8192));
+  std::vector<std::thread> threads;
+  for (int i = 1; i < n; ++i)
+  {
+    threads.emplace_back(compute_leaves, (i * std::int64_t(num_leaves)) / n,
+                         ((i + 1) * std::int64_t(num_leaves)) / n);
+  }
+  compute_leaves(0, num_leaves / n);
+  for (auto& t : threads)
+    t.join();
 
-  // Recursively build the bounding box tree from the leaves
-  std::tie(_bboxes, _bbox_coordinates) = build_from_leaf(leaf_bboxes);
+  // Build the bounding box tree from the leaves
+  std::tie(_bboxes, _bbox_coordinates)
+      = build_from_leaf(leaf_bboxes, num_threads, method);
+  set_nodes();
+  _build_cost = sah_cost();
 
   LOG(INFO) << "Computed bounding box tree with " << num_bboxes()
             << " nodes for " << num_leaves << " entities.";
 
   // Build tree for each process
-  MPI_Comm comm = mesh.mpi_comm();
-  const int mpi_size = MPI::size(comm);
-  if (mpi_size > 1)
+  create_global_tree(mesh);
+}
+//-----------------------------------------------------------------------------
+BoundingBoxTree::BoundingBoxTree(const std::vector<Eigen::Vector3d>& points,
+                                 int num_threads)
+    : _tdim(0), _method(BuildMethod::median)
+{
+  // Create (degenerate) bounding boxes of the points (leaves)
+  const int num_leaves = points.size();
+  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> leaf_bboxes(
+      2 * num_leaves, 3);
+  for (int i = 0; i < num_leaves; ++i)
   {
-    // Send root node coordinates to all processes
-    const auto send_bbox = _bbox_coordinates.bottomRows(2);
-    Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> recv_bbox(
-        mpi_size * 2, 3);
-    MPI_Allgather(send_bbox.data(), 6, MPI_DOUBLE, recv_bbox.data(), 6,
-                  MPI_DOUBLE, comm);
+    leaf_bboxes.row(2 * i) = points[i].transpose().array();
+    leaf_bboxes.row(2 * i + 1) = points[i].transpose().array();
+  }
+
+  // Build the bounding box tree from the leaves
+  std::tie(_bboxes, _bbox_coordinates)
+      = build_from_leaf(leaf_bboxes, num_threads);
+  set_nodes();
 
-    auto [global_bboxes, global_coords] = build_from_leaf(recv_bbox);
-    global_tree.reset(new BoundingBoxTree(global_bboxes, global_coords));
+  LOG(INFO) << "Computed bounding box tree with " << num_bboxes()
+            << " nodes for " << num_leaves << " points.";
+}
+//-----------------------------------------------------------------------------
+BoundingBoxTree::BoundingBoxTree(
+    const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>&
+        leaf_bboxes,
+    int num_threads)
+    : _tdim(0), _method(BuildMethod::median)
+{
+  if (leaf_bboxes.rows() % 2 != 0)
+    throw std::runtime_error("Leaf bounding boxes must have two rows each.");
 
-    LOG(INFO) << "Computed global bounding box tree with "
-              << global_tree->num_bboxes() << " boxes.";
+  std::tie(_bboxes, _bbox_coordinates)
+      = build_from_leaf(leaf_bboxes, num_threads);
+  set_nodes();
+
+  LOG(INFO) << "Computed bounding box tree with " << num_bboxes()
+            << " nodes for " << leaf_bboxes.rows() / 2 << " boxes.";
+}
+//-----------------------------------------------------------------------------
+bool BoundingBoxTree::refit(const mesh::Mesh& mesh, double rebuild_factor,
+                            int num_threads)
+{
+  if (_tdim == 0)
+    throw std::runtime_error("Only trees of mesh entities can be refitted.");
+
+  mesh.topology_mutable().create_entities(_tdim);
+  mesh.topology_mutable().create_connectivity(_tdim, mesh.topology().dim());
+  auto map = mesh.topology().index_map(_tdim);
+  assert(map);
+  const std::int32_t num_leaves = map->size_local() + map->num_ghosts();
+  if (_bboxes.rows() != std::max(2 * num_leaves - 1, 0))
+  {
+    throw std::runtime_error("Number of mesh entities does not match the "
+                             "bounding box tree.");
+  }
+
+  common::Timer timer("Refit bounding box tree");
+  if (_bboxes.rows() > 0)
+  {
+    refit_subtree(mesh, _tdim, _bboxes.rows() - 1, 0, num_threads, _bboxes,
+                  _bbox_coordinates);
   }
+
+  // Rebuild the tree if its quality has degraded
+  if (rebuild_factor > 0.0 and sah_cost() > rebuild_factor * _build_cost)
+  {
+    LOG(INFO) << "Rebuilding bounding box tree (cost " << sah_cost()
+              << ", cost when built " << _build_cost << ").";
+    *this = BoundingBoxTree(mesh, _tdim, num_threads, _method,
+                            _neighbour_processes, _shared_process_tree);
+    return true;
+  }
+
+  create_global_tree(mesh);
+  return false;
 }
 //-----------------------------------------------------------------------------
-BoundingBoxTree::BoundingBoxTree(const std::vector<Eigen::Vector3d>& points)
-    : _tdim(0)
+double BoundingBoxTree::sah_cost() const
 {
-  // Create leaf partition (to be sorted)
-  const int num_leaves = points.size();
-  std::vector<int> leaf_partition(num_leaves);
-  std::iota(leaf_partition.begin(), leaf_partition.end(), 0);
+  if (_num_nodes == 0)
+    return 0.0;
 
-  // Recursively build the bounding box tree from the leaves
-  std::vector<std::array<int, 2>> bboxes;
-  std::vector<double> bbox_coordinates;
-  _build_from_point(points, leaf_partition.begin(), leaf_partition.end(),
-                    bboxes, bbox_coordinates);
+  auto measure = [this](int node) { return sah_measure(get_bbox(node)); };
+  double cost = 0.0;
+  for (int node = 0; node < _num_nodes; ++node)
+    if (bbox(node)[0] != node)
+      cost += measure(node);
 
-  _bboxes.resize(bboxes.size(), 2);
-  for (std::size_t i = 0; i < bboxes.size(); ++i)
+  const double root = measure(_num_nodes - 1);
+  return root > 0.0 ? cost / root : 0.0;
+}
+//-----------------------------------------------------------------------------
+void BoundingBoxTree::create_global_tree(const mesh::Mesh& mesh)
+{
+  if (MPI::size(mesh.mpi_comm()) > 1)
   {
-    _bboxes(i, 0) = bboxes[i][0];
-    _bboxes(i, 1) = bboxes[i][1];
+    global_tree = create_process_tree(mesh, _neighbour_processes,
+                                      _shared_process_tree);
   }
-  _bbox_coordinates
-      = Eigen::Map<Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>(
-          bbox_coordinates.data(), bbox_coordinates.size() / 3, 3);
+}
+//-----------------------------------------------------------------------------
+std::shared_ptr<const BoundingBoxTree>
+BoundingBoxTree::create_process_tree(const mesh::Mesh& mesh, bool neighbours,
+                                     bool shared_memory)
+{
+  // Cache of the process trees of meshes, with the box of the geometry
+  // on this process that each tree was created for. The trees are held
+  // by the bounding box trees that share them.
+  struct Entry
+  {
+    std::weak_ptr<const BoundingBoxTree> tree;
+    Eigen::Array<double, 2, 3, Eigen::RowMajor> bbox;
+  };
+  static std::mutex mutex;
+  static std::map<std::tuple<std::size_t, bool, bool>, Entry> cache;
 
-  LOG(INFO) << "Computed bounding box tree with " << num_bboxes()
-            << " nodes for " << num_leaves << " points.";
+  MPI_Comm comm = mesh.mpi_comm();
+  const Eigen::Array<double, 2, 3, Eigen::RowMajor> bbox
+      = compute_bbox_of_geometry(mesh.geometry());
+
+  // Reuse the cached tree if it is valid on all processes
+  shared_memory = shared_memory and !neighbours;
+  const std::tuple<std::size_t, bool, bool> key(mesh.id(), neighbours,
+                                                shared_memory);
+  std::shared_ptr<const BoundingBoxTree> tree;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = cache.begin(); it != cache.end();)
+      it = it->second.tree.expired() ? cache.erase(it) : std::next(it);
+    if (auto it = cache.find(key);
+        it != cache.end() and (it->second.bbox == bbox).all())
+    {
+      tree = it->second.tree.lock();
+    }
+  }
+  int valid = tree ? 1 : 0;
+  MPI_Allreduce(MPI_IN_PLACE, &valid, 1, MPI_INT, MPI_MIN, comm);
+  if (valid)
+    return tree;
+
+  // Gather the boxes of all processes, or of the neighbours
+  std::vector<int> ranks;
+  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> recv_bbox;
+  if (neighbours)
+  {
+    auto map = mesh.topology().index_map(0);
+    assert(map);
+    MPI_Comm neighbour_comm
+        = map->comm(common::IndexMap::Direction::symmetric);
+    const std::vector<int> sources
+        = std::get<0>(MPI::neighbors(neighbour_comm));
+    ranks.push_back(MPI::rank(comm));
+    ranks.insert(ranks.end(), sources.begin(), sources.end());
+    recv_bbox.resize(2 * ranks.size(), 3);
+    recv_bbox.topRows(2) = bbox;
+    MPI_Neighbor_allgather(bbox.data(), 6, MPI_DOUBLE, recv_bbox.data() + 6,
+                           6, MPI_DOUBLE, neighbour_comm);
+  }
+  else
+  {
+    ranks.resize(MPI::size(comm));
+    std::iota(ranks.begin(), ranks.end(), 0);
+    recv_bbox.resize(2 * ranks.size(), 3);
+    MPI_Allgather(bbox.data(), 6, MPI_DOUBLE, recv_bbox.data(), 6, MPI_DOUBLE,
+                  comm);
+  }
+
+  // Build the tree, with the ranks as the entities of the leaves
+  auto build = [&recv_bbox, &ranks]() {
+    auto nodes = build_from_leaf(recv_bbox);
+    auto& bboxes = std::get<0>(nodes);
+    for (int node = 0; node < bboxes.rows(); ++node)
+      if (bboxes(node, 0) == node)
+        bboxes(node, 1) = ranks[bboxes(node, 1)];
+    return nodes;
+  };
+
+  if (shared_memory)
+  {
+    // Build the tree on the first process of each node, in the memory
+    // shared by the processes of the node
+    const int num_nodes = 2 * ranks.size() - 1;
+    auto memory = std::make_shared<common::SharedMemory>(
+        comm, num_nodes * (2 * sizeof(int) + 6 * sizeof(double)));
+    if (memory->is_node_root())
+    {
+      auto [bboxes, coords] = build();
+      assert(bboxes.rows() == num_nodes);
+      int* nodes = memory->data<int>();
+      std::copy_n(bboxes.data(), bboxes.size(), nodes);
+      std::copy_n(coords.data(), coords.size(),
+                  reinterpret_cast<double*>(nodes + 2 * num_nodes));
+    }
+    memory->synchronize();
+    tree = std::shared_ptr<const BoundingBoxTree>(
+        new BoundingBoxTree(memory, num_nodes));
+  }
+  else
+  {
+    auto [bboxes, coords] = build();
+    tree = std::shared_ptr<const BoundingBoxTree>(
+        new BoundingBoxTree(bboxes, coords));
+  }
+
+  LOG(INFO) << "Computed global bounding box tree with " << tree->num_bboxes()
+            << " boxes.";
+
+  std::lock_guard<std::mutex> lock(mutex);
+  cache[key] = {tree, bbox};
+  return tree;
 }
 //-----------------------------------------------------------------------------
-int BoundingBoxTree::num_bboxes() const { return _bboxes.rows(); }
+int BoundingBoxTree::num_bboxes() const { return _num_nodes; }
 //-----------------------------------------------------------------------------
 std::string BoundingBoxTree::str() const
 {
   std::stringstream s;
-  tree_print(s, _bboxes.rows() - 1);
+  tree_print(s, _num_nodes - 1);
   return s.str();
 }
 //-----------------------------------------------------------------------------
@@ -349,17 +928,18 @@ void BoundingBoxTree::tree_print(std::stringstream& s, int i) const
 {
   s << "[";
   for (int j = 0; j < 3; ++j)
-    s << _bbox_coordinates(i, j) << " ";
+    s << _node_coordinates[3 * i + j] << " ";
   s << "]\n";
 
-  if (_bboxes(i, 0) == i)
-    s << "leaf containing entity (" << _bboxes(i, 1) << ")";
+  const std::array<int, 2> b = bbox(i);
+  if (b[0] == i)
+    s << "leaf containing entity (" << b[1] << ")";
   else
   {
     s << "{";
-    tree_print(s, _bboxes(i, 0));
+    tree_print(s, b[0]);
     s << ", \n";
-    tree_print(s, _bboxes(i, 1));
+    tree_print(s, b[1]);
     s << "}\n";
   }
 }
@@ -367,6 +947,14 @@ void BoundingBoxTree::tree_print(std::stringstream& s, int i) const
 Eigen::Array<double, 2, 3, Eigen::RowMajor>
 BoundingBoxTree::get_bbox(int node) const
 {
-  return _bbox_coordinates.block<2, 3>(2 * node, 0);
+  return Eigen::Map<const Eigen::Array<double, 2, 3, Eigen::RowMajor>>(
+      _node_coordinates + 6 * node);
+}
+//-----------------------------------------------------------------------------
+void BoundingBoxTree::set_nodes()
+{
+  _nodes = _bboxes.data();
+  _node_coordinates = _bbox_coordinates.data();
+  _num_nodes = _bboxes.rows();
 }
 //-----------------------------------------------------------------------------
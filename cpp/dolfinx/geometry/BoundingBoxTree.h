@@ -15,6 +15,11 @@ namespace dolfinx
 {
 
 // Forward declarations
+namespace common
+{
+class SharedMemory;
+} // namespace common
+
 namespace mesh
 {
 class Mesh;
@@ -23,6 +28,19 @@ class Mesh;
 namespace geometry
 {
 
+/// Methods for building a BoundingBoxTree
+enum class BuildMethod : int
+{
+  median, ///< Split the nodes at the median along the longest axis
+  sah,    ///< Split the nodes using the (binned) surface area heuristic,
+          ///< which gives a tree that is cheaper to query but more
+          ///< expensive to build
+  linear  ///< Build a linear bounding volume hierarchy from the Morton
+          ///< codes of the box centres. It is the fastest to build,
+          ///< e.g. to rebuild the tree after the mesh has changed, but
+          ///< gives a tree that is more expensive to query.
+};
+
 /// Axis-Aligned bounding box binary tree. It is used to find entities
 /// in a collection (often a mesh::Mesh).
 
@@ -34,12 +52,39 @@ public:
   /// @param[in] mesh The mesh for building the bounding box tree
   /// @param[in] tdim The topological dimension of the mesh entities to
   ///                 by the bounding box tree for
-  BoundingBoxTree(const mesh::Mesh& mesh, int tdim);
+  /// @param[in] num_threads Number of threads to compute the entity
+  ///                 bounding boxes and to build subtrees concurrently
+  /// @param[in] method The method for building the tree
+  /// @param[in] neighbour_processes If true, the tree of the process
+  ///                 boxes (global_tree) only has the boxes of this
+  ///                 process and its neighbours (see
+  ///                 create_process_tree)
+  /// @param[in] shared_memory If true, the tree of the process boxes
+  ///                 is stored once per shared memory node (see
+  ///                 create_process_tree)
+  BoundingBoxTree(const mesh::Mesh& mesh, int tdim, int num_threads = 1,
+                  BuildMethod method = BuildMethod::median,
+                  bool neighbour_processes = false,
+                  bool shared_memory = false);
 
   /// Constructor
   /// @param[in] points Cloud of points to build the bounding box tree
   ///                   around
-  BoundingBoxTree(const std::vector<Eigen::Vector3d>& points);
+  /// @param[in] num_threads Number of threads to build subtrees
+  ///                   concurrently
+  BoundingBoxTree(const std::vector<Eigen::Vector3d>& points,
+                  int num_threads = 1);
+
+  /// Constructor
+  /// @param[in] leaf_bboxes Bounding boxes of the leaves, where rows
+  ///                   2i and 2i + 1 are the lower and upper corners of
+  ///                   the box of leaf (entity) i
+  /// @param[in] num_threads Number of threads to build subtrees
+  ///                   concurrently
+  explicit BoundingBoxTree(
+      const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>&
+          leaf_bboxes,
+      int num_threads = 1);
 
   /// Move constructor
   BoundingBoxTree(BoundingBoxTree&& tree) = default;
@@ -53,12 +98,58 @@ public:
   /// Destructor
   ~BoundingBoxTree() = default;
 
+  /// Create the tree of the bounding boxes of the mesh geometry on the
+  /// processes (collective). The entity of a leaf is the rank of its
+  /// process. The tree is cached for the mesh and shared by the trees
+  /// of its entities (see global_tree), and is reused as long as the
+  /// box of the geometry has not changed on any process, which only
+  /// requires a reduction of one integer instead of the exchange of the
+  /// boxes of all processes.
+  /// @param[in] mesh The mesh
+  /// @param[in] neighbours If true, the tree only has the boxes of this
+  ///   process and the processes that share vertices with it, which are
+  ///   exchanged with the neighbours only. This avoids storing the
+  ///   boxes of all processes on every process for large numbers of
+  ///   processes, but collisions with processes that are not
+  ///   neighbours are not found.
+  /// @param[in] shared_memory If true (and neighbours is false), the
+  ///   tree is built and stored once per shared memory node, by the
+  ///   first process of the node, and is read by the other processes of
+  ///   the node (see common::SharedMemory). The tree is then destroyed
+  ///   collectively by the processes of the node.
+  /// @return The tree of the process boxes
+  static std::shared_ptr<const BoundingBoxTree>
+  create_process_tree(const mesh::Mesh& mesh, bool neighbours = false,
+                      bool shared_memory = false);
+
   /// Return bounding box coordinates for a given node in the tree
   /// @param[in] node The bounding box node index
   /// @return The bounding box where row(0) is the lower corner and
   ///         row(1) is the upper corner
   Eigen::Array<double, 2, 3, Eigen::RowMajor> get_bbox(int node) const;
 
+  /// Recompute the bounding boxes after the mesh geometry has moved
+  /// (collective). The leaf boxes are computed from the current
+  /// geometry and the boxes of the other nodes are updated bottom-up,
+  /// keeping the structure of the tree. The topology of the mesh must
+  /// not have changed since the tree was built.
+  /// @param[in] mesh The mesh the tree was built for
+  /// @param[in] rebuild_factor If positive, the tree is rebuilt from
+  ///                 scratch when its cost (see sah_cost) exceeds the
+  ///                 cost when it was built by this factor, i.e. when
+  ///                 the boxes overlap too much after the motion
+  /// @param[in] num_threads Number of threads to refit subtrees
+  ///                 concurrently
+  /// @return True if the tree was rebuilt
+  bool refit(const mesh::Mesh& mesh, double rebuild_factor = 0.0,
+             int num_threads = 1);
+
+  /// Cost of querying the tree estimated by the surface area
+  /// heuristic, i.e. the sum of the surface areas of the boxes of the
+  /// interior nodes relative to the surface area of the root box
+  /// @return The cost
+  double sah_cost() const;
+
   /// Return number of bounding boxes
   int num_bboxes() const;
 
@@ -76,8 +167,8 @@ public:
   ///         index of the cell that it bounds,
   std::array<int, 2> bbox(int node) const
   {
-    assert(node < (int)_bboxes.rows());
-    return {_bboxes(node, 0), _bboxes(node, 1)};
+    assert(node < _num_nodes);
+    return {_nodes[2 * node], _nodes[2 * node + 1]};
   }
 
 private:
@@ -87,9 +178,33 @@ private:
       const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>&
           bbox_coords);
 
+  // Constructor for a tree of num_nodes nodes in shared memory, where
+  // the (parent-child-entity) relations are followed by the bounding
+  // box coordinates
+  BoundingBoxTree(std::shared_ptr<const common::SharedMemory> memory,
+                  int num_nodes);
+
+  // Point the node views to _bboxes and _bbox_coordinates
+  void set_nodes();
+
+  // Create the tree of the root boxes of all processes (collective)
+  void create_global_tree(const mesh::Mesh& mesh);
+
   // Topological dimension of leaf entities
   int _tdim;
 
+  // Method the tree is built with
+  BuildMethod _method;
+
+  // True if the process tree only has the neighbour processes
+  bool _neighbour_processes = false;
+
+  // True if the process tree is stored in shared memory
+  bool _shared_process_tree = false;
+
+  // Cost (see sah_cost) when the tree was built
+  double _build_cost = 0.0;
+
   // Print out recursively, for debugging
   void tree_print(std::stringstream& s, int i) const;
 
@@ -99,10 +214,21 @@ private:
   // List of bounding box coordinates
   Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> _bbox_coordinates;
 
+  // Shared memory of the nodes, if the tree is stored in shared memory
+  // instead of _bboxes and _bbox_coordinates
+  std::shared_ptr<const common::SharedMemory> _shared_memory;
+
+  // Views of the nodes (row-major relations and coordinates), in
+  // _bboxes and _bbox_coordinates or in _shared_memory. The views
+  // remain valid when the tree is moved.
+  const int* _nodes = nullptr;
+  const double* _node_coordinates = nullptr;
+  int _num_nodes = 0;
+
 public:
-  /// Global tree for mesh ownership of each process (same on all
-  /// processes)
-  std::unique_ptr<BoundingBoxTree> global_tree;
+  /// Global tree for mesh ownership of each process (see
+  /// create_process_tree). It is shared between the trees of a mesh.
+  std::shared_ptr<const BoundingBoxTree> global_tree;
 };
 } // namespace geometry
 } // namespace dolfinx
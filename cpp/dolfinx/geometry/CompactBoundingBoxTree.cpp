@@ -0,0 +1,127 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "CompactBoundingBoxTree.h"
+#include "BoundingBoxTree.h"
+#include <algorithm>
+#include <cmath>
+#include <dolfinx/common/log.h>
+#include <limits>
+
+using namespace dolfinx;
+using namespace dolfinx::geometry;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Round down to single precision
+float round_down(double x)
+{
+  float y = x;
+  if (y > x)
+    y = std::nextafter(y, -std::numeric_limits<float>::infinity());
+  return y;
+}
+//-----------------------------------------------------------------------------
+// Round up to single precision
+float round_up(double x)
+{
+  float y = x;
+  if (y < x)
+    y = std::nextafter(y, std::numeric_limits<float>::infinity());
+  return y;
+}
+//-----------------------------------------------------------------------------
+// Surface area of a bounding box
+double area(const Eigen::Array<double, 2, 3, Eigen::RowMajor>& b)
+{
+  const Eigen::Array3d d = (b.row(1) - b.row(0)).transpose();
+  return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+CompactBoundingBoxTree::CompactBoundingBoxTree(const BoundingBoxTree& tree)
+    : _tdim(tree.tdim())
+{
+  if (tree.num_bboxes() > 0)
+  {
+    _nodes.reserve(tree.num_bboxes() / 2 + 1);
+    add_node(tree, tree.num_bboxes() - 1);
+  }
+
+  LOG(INFO) << "Computed compact bounding box tree with " << num_nodes()
+            << " nodes (" << bytes() << " bytes).";
+}
+//-----------------------------------------------------------------------------
+std::int32_t CompactBoundingBoxTree::add_node(const BoundingBoxTree& tree,
+                                              int node)
+{
+  auto is_leaf = [&tree](int n) { return tree.bbox(n)[0] == n; };
+
+  // Collapse the binary subtree into (at most) width children, by
+  // repeatedly replacing the interior node with the largest box by its
+  // children
+  std::vector<int> children;
+  if (is_leaf(node))
+    children.push_back(node);
+  else
+  {
+    const std::array bbox = tree.bbox(node);
+    children.assign(bbox.begin(), bbox.end());
+  }
+  while ((int)children.size() < width)
+  {
+    auto it = children.end();
+    double a_max = -1.0;
+    for (auto c = children.begin(); c != children.end(); ++c)
+    {
+      if (double a = area(tree.get_bbox(*c)); !is_leaf(*c) and a > a_max)
+      {
+        a_max = a;
+        it = c;
+      }
+    }
+    if (it == children.end())
+      break;
+    const std::array bbox = tree.bbox(*it);
+    *it = bbox[0];
+    children.insert(it + 1, bbox[1]);
+  }
+
+  // Add the node, with empty boxes for unused children
+  const std::int32_t index = _nodes.size();
+  _nodes.emplace_back();
+  for (int j = 0; j < 3; ++j)
+  {
+    _nodes[index].lower[j].fill(std::numeric_limits<float>::infinity());
+    _nodes[index].upper[j].fill(-std::numeric_limits<float>::infinity());
+  }
+  _nodes[index].child.fill(0);
+
+  // Add the children. The boxes are extended by the tolerance of the
+  // point queries on the binary tree, and rounded outwards.
+  const double rtol = 1e-14;
+  for (std::size_t k = 0; k < children.size(); ++k)
+  {
+    const int c = children[k];
+    const Eigen::Array<double, 2, 3, Eigen::RowMajor> b = tree.get_bbox(c);
+    for (int j = 0; j < 3; ++j)
+    {
+      const double eps = rtol * (b(1, j) - b(0, j));
+      _nodes[index].lower[j][k] = round_down(b(0, j) - eps);
+      _nodes[index].upper[j][k] = round_up(b(1, j) + eps);
+    }
+
+    const std::int32_t child
+        = is_leaf(c) ? -(tree.bbox(c)[1] + 1) : add_node(tree, c);
+    _nodes[index].child[k] = child;
+  }
+
+  return index;
+}
+//-----------------------------------------------------------------------------
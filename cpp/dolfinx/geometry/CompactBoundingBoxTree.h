@@ -0,0 +1,101 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dolfinx::geometry
+{
+class BoundingBoxTree;
+
+/// Compact, wide (4-ary) bounding box tree for fast collision queries
+/// with points. It is created from a (binary) BoundingBoxTree by
+/// collapsing the binary nodes into nodes with up to four children.
+/// The boxes of the children of a node are stored in single precision,
+/// rounded outwards so that they contain the boxes of the binary tree
+/// (with the tolerance of its queries), as a structure of arrays, so
+/// that a point is tested against all children of a node at once.
+///
+/// The tree needs less than half of the memory of the binary tree, and
+/// because the depth is halved, point queries visit fewer nodes. Point
+/// queries return the same entities as for the binary tree, but in an
+/// unspecified order.
+
+class CompactBoundingBoxTree
+{
+public:
+  /// Number of children of a node
+  static constexpr int width = 4;
+
+  /// Node of the tree. Child k of the node has the box
+  /// [lower[0][k], upper[0][k]] x [lower[1][k], upper[1][k]] x
+  /// [lower[2][k], upper[2][k]]. The child is the node child[k] if
+  /// child[k] >= 0, and a leaf containing the entity -(child[k] + 1)
+  /// otherwise. Unused children have empty boxes.
+  struct Node
+  {
+    /// Lower corners of the boxes of the children
+    std::array<std::array<float, width>, 3> lower;
+
+    /// Upper corners of the boxes of the children
+    std::array<std::array<float, width>, 3> upper;
+
+    /// Children
+    std::array<std::int32_t, width> child;
+  };
+
+  /// Create a compact tree from a bounding box tree
+  /// @param[in] tree The bounding box tree
+  explicit CompactBoundingBoxTree(const BoundingBoxTree& tree);
+
+  /// Move constructor
+  CompactBoundingBoxTree(CompactBoundingBoxTree&& tree) = default;
+
+  /// Copy constructor
+  CompactBoundingBoxTree(const CompactBoundingBoxTree& tree) = delete;
+
+  /// Move assignment
+  CompactBoundingBoxTree& operator=(CompactBoundingBoxTree&& tree) = default;
+
+  /// Destructor
+  ~CompactBoundingBoxTree() = default;
+
+  /// Number of nodes. The root is node 0.
+  std::int32_t num_nodes() const { return _nodes.size(); }
+
+  /// Get a node
+  /// @param[in] i The node index
+  /// @return The node
+  const Node& node(std::int32_t i) const
+  {
+    assert(i < (std::int32_t)_nodes.size());
+    return _nodes[i];
+  }
+
+  /// Topological dimension of leaf entities
+  int tdim() const { return _tdim; }
+
+  /// Memory used by the nodes of the tree
+  /// @return The number of bytes
+  std::size_t bytes() const { return _nodes.size() * sizeof(Node); }
+
+private:
+  // Add the node that collapses the binary subtree with root node
+  std::int32_t add_node(const BoundingBoxTree& tree, int node);
+
+  // Nodes (pre-order, the root first)
+  std::vector<Node> _nodes;
+
+  // Topological dimension of leaf entities
+  int _tdim;
+};
+
+} // namespace dolfinx::geometry
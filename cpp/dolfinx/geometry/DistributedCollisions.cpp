@@ -0,0 +1,181 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "DistributedCollisions.h"
+#include "BoundingBoxTree.h"
+#include "utils.h"
+#include <algorithm>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <stdexcept>
+
+using namespace dolfinx;
+using namespace dolfinx::geometry;
+
+//-----------------------------------------------------------------------------
+DistributedCollisions::DistributedCollisions(MPI_Comm comm)
+    : _comm(comm), _forward_comm(MPI_COMM_NULL, false),
+      _reverse_comm(MPI_COMM_NULL, false)
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+std::vector<std::array<int, 3>>
+DistributedCollisions::compute(const BoundingBoxTree& tree0,
+                               const BoundingBoxTree& tree1)
+{
+  common::Timer timer("Compute distributed collisions");
+
+  MPI_Comm comm = _comm.comm();
+  const int rank = dolfinx::MPI::rank(comm);
+  std::vector<std::array<int, 3>> collisions;
+  if (dolfinx::MPI::size(comm) == 1)
+  {
+    if (tree0.num_bboxes() > 0 and tree1.num_bboxes() > 0)
+    {
+      for (auto [e0, e1] : compute_collisions(tree0, tree1))
+        collisions.push_back({e0, rank, e1});
+    }
+    std::sort(collisions.begin(), collisions.end());
+    return collisions;
+  }
+
+  const int mpi_size = dolfinx::MPI::size(comm);
+  if (!tree0.global_tree or !tree1.global_tree)
+  {
+    throw std::runtime_error("Bounding box trees must be built for meshes on "
+                             "the communicator.");
+  }
+  if (tree0.global_tree->num_bboxes() != 2 * mpi_size - 1
+      or tree1.global_tree->num_bboxes() != 2 * mpi_size - 1)
+  {
+    throw std::runtime_error("Distributed collisions require the boxes of "
+                             "all processes (see create_process_tree).");
+  }
+
+  // Find the pairs of processes whose boxes overlap (the same on all
+  // processes), and update the neighbourhood communicators if they have
+  // changed
+  std::vector<int> dests, srcs;
+  for (auto [r0, r1] :
+       compute_collisions(*tree0.global_tree, *tree1.global_tree))
+  {
+    if (r0 == rank)
+      dests.push_back(r1);
+    if (r1 == rank)
+      srcs.push_back(r0);
+  }
+  std::sort(dests.begin(), dests.end());
+  dests.erase(std::unique(dests.begin(), dests.end()), dests.end());
+  std::sort(srcs.begin(), srcs.end());
+  srcs.erase(std::unique(srcs.begin(), srcs.end()), srcs.end());
+  if (dests != _dests or srcs != _srcs
+      or _forward_comm.comm() == MPI_COMM_NULL)
+  {
+    _dests = dests;
+    _srcs = srcs;
+    MPI_Comm forward, reverse;
+    MPI_Dist_graph_create_adjacent(comm, _srcs.size(), _srcs.data(),
+                                   MPI_UNWEIGHTED, _dests.size(),
+                                   _dests.data(), MPI_UNWEIGHTED,
+                                   MPI_INFO_NULL, false, &forward);
+    MPI_Dist_graph_create_adjacent(comm, _dests.size(), _dests.data(),
+                                   MPI_UNWEIGHTED, _srcs.size(), _srcs.data(),
+                                   MPI_UNWEIGHTED, MPI_INFO_NULL, false,
+                                   &reverse);
+    _forward_comm = dolfinx::MPI::Comm(forward, false);
+    _reverse_comm = dolfinx::MPI::Comm(reverse, false);
+  }
+
+  // Send the leaf boxes of the first mesh that overlap the process box
+  // of the second mesh on a rank to that rank
+  std::vector<std::vector<int>> sent(_dests.size());
+  if (tree0.num_bboxes() > 0)
+  {
+    for (auto [e0, r1] : compute_collisions(tree0, *tree1.global_tree))
+    {
+      auto it = std::lower_bound(_dests.begin(), _dests.end(), r1);
+      if (it != _dests.end() and *it == r1)
+        sent[std::distance(_dests.begin(), it)].push_back(e0);
+    }
+  }
+  std::vector<int> send_offsets = {0};
+  std::vector<int> send_entities;
+  for (const std::vector<int>& entities : sent)
+  {
+    send_entities.insert(send_entities.end(), entities.begin(),
+                         entities.end());
+    send_offsets.push_back(send_entities.size());
+  }
+  std::vector<int> send_box_offsets(send_offsets.size());
+  std::transform(send_offsets.begin(), send_offsets.end(),
+                 send_box_offsets.begin(), [](int n) { return 6 * n; });
+  std::vector<double> send_boxes(6 * send_entities.size());
+  if (!send_entities.empty())
+  {
+    // The leaves are not stored in the order of the entities, so map
+    // the entities to the leaf nodes
+    std::vector<int> leaves((tree0.num_bboxes() + 1) / 2, -1);
+    for (int node = 0; node < tree0.num_bboxes(); ++node)
+      if (const std::array<int, 2> bbox = tree0.bbox(node); bbox[0] == node)
+        leaves[bbox[1]] = node;
+    for (std::size_t i = 0; i < send_entities.size(); ++i)
+    {
+      const Eigen::Array<double, 2, 3, Eigen::RowMajor> b
+          = tree0.get_bbox(leaves[send_entities[i]]);
+      std::copy(b.data(), b.data() + 6, send_boxes.begin() + 6 * i);
+    }
+  }
+  const graph::AdjacencyList<int> recv_entities
+      = dolfinx::MPI::neighbor_all_to_all(_forward_comm.comm(), send_offsets,
+                                          send_entities);
+  const graph::AdjacencyList<double> recv_boxes
+      = dolfinx::MPI::neighbor_all_to_all(_forward_comm.comm(),
+                                          send_box_offsets, send_boxes);
+
+  // Collide the received boxes with the local tree of the second mesh,
+  // and return the colliding pairs to the sources of the boxes
+  const Eigen::Array<int, Eigen::Dynamic, 1>& recv_offsets
+      = recv_entities.offsets();
+  const std::int32_t num_recv = recv_entities.array().rows();
+  std::vector<std::vector<int>> replies(_srcs.size());
+  if (num_recv > 0 and tree1.num_bboxes() > 0)
+  {
+    const Eigen::Map<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>
+        boxes(recv_boxes.array().data(), 2 * num_recv, 3);
+    BoundingBoxTree recv_tree(boxes);
+    for (auto [i, e1] : compute_collisions(recv_tree, tree1))
+    {
+      const int* it = std::upper_bound(
+          recv_offsets.data(), recv_offsets.data() + recv_offsets.rows(), i);
+      const int src = std::distance(recv_offsets.data(), it) - 1;
+      replies[src].push_back(recv_entities.array()[i]);
+      replies[src].push_back(e1);
+    }
+  }
+  std::vector<int> reply_offsets = {0};
+  std::vector<int> reply_data;
+  for (const std::vector<int>& reply : replies)
+  {
+    reply_data.insert(reply_data.end(), reply.begin(), reply.end());
+    reply_offsets.push_back(reply_data.size());
+  }
+  const graph::AdjacencyList<int> pairs = dolfinx::MPI::neighbor_all_to_all(
+      _reverse_comm.comm(), reply_offsets, reply_data);
+
+  // Unpack the colliding pairs received from the destinations
+  for (std::size_t k = 0; k < _dests.size(); ++k)
+  {
+    auto p = pairs.links(k);
+    for (Eigen::Index i = 0; i < p.rows(); i += 2)
+      collisions.push_back({p[i], _dests[k], p[i + 1]});
+  }
+  std::sort(collisions.begin(), collisions.end());
+
+  return collisions;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,83 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <array>
+#include <dolfinx/common/MPI.h>
+#include <vector>
+
+namespace dolfinx::geometry
+{
+class BoundingBoxTree;
+
+/// Collision detection between the entities of two distributed meshes
+/// (e.g. for contact between two bodies), given the bounding box trees
+/// of the meshes on each process.
+///
+/// The bounding boxes of the processes (see BoundingBoxTree::global_tree)
+/// of the first mesh are intersected with those of the second mesh to
+/// find the pairs of processes that may have colliding entities. Each
+/// process then sends the leaf boxes of its entities of the first mesh
+/// that overlap the process box of the second mesh on a rank to that
+/// rank only, where they are collided with the local tree of the second
+/// mesh, and the colliding pairs are returned.
+///
+/// The neighbourhood communicators for the process pairs are cached,
+/// and are reused as long as the process boxes overlap in the same way,
+/// e.g. in quasi-static contact where the trees are refitted (see
+/// BoundingBoxTree::refit) after small motions.
+class DistributedCollisions
+{
+public:
+  /// Create collision detection on a communicator
+  /// @param[in] comm The communicator of the meshes
+  explicit DistributedCollisions(MPI_Comm comm);
+
+  /// Move constructor
+  DistributedCollisions(DistributedCollisions&& collisions) = default;
+
+  /// Destructor
+  ~DistributedCollisions() = default;
+
+  /// Move assignment
+  DistributedCollisions& operator=(DistributedCollisions&& collisions)
+      = default;
+
+  /// Compute the colliding entities of two meshes (collective)
+  /// @param[in] tree0 The bounding box tree of the entities of the
+  ///   first mesh on this process
+  /// @param[in] tree1 The bounding box tree of the entities of the
+  ///   second mesh on this process
+  /// @return The colliding pairs (entity0, rank, entity1) of an entity
+  ///   of the first mesh on this process (local index) and an entity of
+  ///   the second mesh on the process rank (local index on that
+  ///   process), sorted. Ghost entities are included, so a pair of
+  ///   physical entities may be found on several processes.
+  std::vector<std::array<int, 3>> compute(const BoundingBoxTree& tree0,
+                                          const BoundingBoxTree& tree1);
+
+  /// Ranks that the boxes of the first mesh are sent to
+  const std::vector<int>& destinations() const { return _dests; }
+
+  /// Ranks that send boxes of the first mesh to this process
+  const std::vector<int>& sources() const { return _srcs; }
+
+private:
+  // Communicator
+  dolfinx::MPI::Comm _comm;
+
+  // Ranks whose process box of the second mesh overlaps the process box
+  // of the first mesh on this rank (destinations), and vice versa
+  // (sources)
+  std::vector<int> _dests, _srcs;
+
+  // Neighbourhood communicators from the sources to the destinations
+  // (boxes), and from the destinations to the sources (colliding pairs)
+  dolfinx::MPI::Comm _forward_comm, _reverse_comm;
+};
+
+} // namespace dolfinx::geometry
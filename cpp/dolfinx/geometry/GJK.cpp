@@ -15,13 +15,13 @@ using namespace dolfinx;
 
 namespace
 {
+// Simplex (at most four points), with fixed size storage
+using Simplex = Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor, 4, 3>;
+
 // Find the resulting sub-simplex of the input simplex which is nearest to the
 // origin. Also, return the shortest vector from the origin to the resulting
 // simplex.
-std::pair<Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>,
-          Eigen::Vector3d>
-nearest_simplex(
-    const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor, 4, 3>& s)
+std::pair<Simplex, Eigen::Vector3d> nearest_simplex(const Simplex& s)
 {
   if (s.rows() == 2)
   {
@@ -62,7 +62,7 @@ nearest_simplex(
     }
 
     // Test ACD, ABD and/or ABC.
-    Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> smin;
+    Simplex smin;
     Eigen::Vector3d vmin = {0, 0, 0};
     static const int facets[3][3] = {{0, 1, 3}, {0, 2, 3}, {1, 2, 3}};
     double qmin = std::numeric_limits<double>::max();
@@ -70,7 +70,7 @@ nearest_simplex(
     {
       if (f_inside[i + 1] == false)
       {
-        Eigen::Matrix<double, 3, 3, Eigen::RowMajor> M;
+        Simplex M(3, 3);
         M << s.row(facets[i][0]), s.row(facets[i][1]), s.row(facets[i][2]);
         auto [snew, v] = nearest_simplex(M);
         const double q = v.squaredNorm();
@@ -119,8 +119,7 @@ nearest_simplex(
   s.rowwise().squaredNorm().minCoeff(&i);
   Eigen::Vector3d vmin = s.row(i);
   double qmin = vmin.squaredNorm();
-  Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> smin
-      = vmin.transpose();
+  Simplex smin = vmin.transpose();
 
   // Check if edges are closer
   static const int f[3][2] = {{0, 1}, {0, 2}, {1, 2}};
@@ -146,9 +145,9 @@ nearest_simplex(
 }
 //-------------------------------------------------------------------------------
 // Support function, finds point p in bd which maximises p.v
-Eigen::Vector3d
-support(const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>& bd,
-        const Eigen::Vector3d& v)
+Eigen::Vector3d support(const Eigen::Ref<const Eigen::Matrix<
+                            double, Eigen::Dynamic, 3, Eigen::RowMajor>>& bd,
+                        const Eigen::Vector3d& v)
 {
   int i = 0;
   double qmax = bd.row(0) * v;
@@ -166,8 +165,11 @@ support(const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>& bd,
 } // namespace
 //-----------------------------------------------------
 Eigen::Vector3d geometry::compute_distance_gjk(
-    const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>& p,
-    const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>& q)
+    const Eigen::Ref<
+        const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>>& p,
+    const Eigen::Ref<
+        const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>>& q,
+    double max_distance)
 {
   const int maxk = 10; // Maximum number of iterations of the GJK algorithm
 
@@ -176,8 +178,7 @@ Eigen::Vector3d geometry::compute_distance_gjk(
 
   // Initialise vector and simplex
   Eigen::Vector3d v = p.row(0) - q.row(0);
-  Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor, 4, 3> s
-      = v.transpose();
+  Simplex s = v.transpose();
 
   // Begin GJK iteration
   int k;
@@ -202,6 +203,14 @@ Eigen::Vector3d geometry::compute_distance_gjk(
     if (vw < (eps * vnorm2) or vw < eps)
       break;
 
+    // Early exit if the bodies are separated by more than max_distance
+    // (v.w / |v| is a lower bound of the distance)
+    if (const double vdotw = v.dot(w);
+        vdotw > 0.0 and vdotw * vdotw > max_distance * max_distance * vnorm2)
+    {
+      break;
+    }
+
     // Add new vertex to simplex
     s.conservativeResize(s.rows() + 1, 3);
     s.bottomRows(1) = w.transpose();
@@ -219,3 +228,4 @@ Eigen::Vector3d geometry::compute_distance_gjk(
   // Compute and return distance
   return v;
 }
+//-----------------------------------------------------
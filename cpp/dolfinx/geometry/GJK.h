@@ -7,6 +7,12 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
 
 namespace dolfinx
 {
@@ -17,9 +23,90 @@ namespace geometry
 /// set of points, using the Gilbert–Johnson–Keerthi (GJK) distance algorithm.
 /// @param[in] p Body 1 list of points
 /// @param[in] q Body 2 list of points
+/// @param[in] max_distance If the distance between the bodies is larger
+///   than max_distance, the iteration may stop early, returning a
+///   vector with norm larger than max_distance (but not necessarily the
+///   shortest vector)
 /// @return shortest vector between bodies
-Eigen::Vector3d
-compute_distance_gjk(const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>& p,
-           const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>& q);
+Eigen::Vector3d compute_distance_gjk(
+    const Eigen::Ref<
+        const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>>& p,
+    const Eigen::Ref<
+        const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>>& q,
+    double max_distance = std::numeric_limits<double>::infinity());
+
+/// Calculate the distances between many pairs of convex bodies with
+/// fixed numbers of points (e.g. the cells of candidate pairs from
+/// compute_collisions of two bounding box trees), on (at most)
+/// num_threads threads. Pairs whose bounding boxes are further apart
+/// than max_distance are not passed to GJK.
+/// @tparam N Number of points of the bodies in p
+/// @tparam M Number of points of the bodies in q
+/// @param[in] p The points of the bodies, with the N points of body i in
+///   row i (x0, y0, z0, x1, ...)
+/// @param[in] q The points of the bodies, with the M points of body j in
+///   row j
+/// @param[in] pairs The pairs (i, j) of bodies
+/// @param[in] max_distance For pairs further apart than max_distance
+///   the computation may stop early, returning a vector with norm
+///   larger than max_distance (see compute_distance_gjk)
+/// @param[in] num_threads Number of threads
+/// @return The shortest vectors between the bodies of each pair, with
+///   shape (num_pairs, 3)
+template <int N, int M>
+Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> compute_distances_gjk(
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3 * N, Eigen::RowMajor>>& p,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3 * M, Eigen::RowMajor>>& q,
+    const std::vector<std::array<int, 2>>& pairs,
+    double max_distance = std::numeric_limits<double>::infinity(),
+    int num_threads = 1)
+{
+  const std::int32_t num_pairs = pairs.size();
+  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> v(num_pairs, 3);
+  auto compute = [&](std::int32_t i0, std::int32_t i1) {
+    for (std::int32_t i = i0; i < i1; ++i)
+    {
+      const auto [a, b] = pairs[i];
+      Eigen::Map<const Eigen::Matrix<double, N, 3, Eigen::RowMajor>> pa(
+          p.row(a).data());
+      Eigen::Map<const Eigen::Matrix<double, M, 3, Eigen::RowMajor>> qb(
+          q.row(b).data());
+
+      // Separation test of the bounding boxes. The vector between the
+      // boxes is shorter than the shortest vector between the bodies.
+      const Eigen::Array<double, 1, 3> gap
+          = (qb.colwise().minCoeff() - pa.colwise().maxCoeff())
+                .array()
+                .max((pa.colwise().minCoeff() - qb.colwise().maxCoeff())
+                         .array())
+                .max(0.0);
+      if (gap.matrix().squaredNorm() > max_distance * max_distance)
+      {
+        v.row(i) = gap;
+        continue;
+      }
+
+      v.row(i) = compute_distance_gjk(pa, qb, max_distance).transpose();
+    }
+  };
+
+  // Compute on contiguous ranges of pairs
+  constexpr std::int32_t min_chunk = 1024;
+  const int n = std::max(1, std::min<int>(num_threads, num_pairs / min_chunk));
+  std::vector<std::thread> threads;
+  for (int i = 1; i < n; ++i)
+  {
+    threads.emplace_back(compute, (i * std::int64_t(num_pairs)) / n,
+                         ((i + 1) * std::int64_t(num_pairs)) / n);
+  }
+  compute(0, num_pairs / n);
+  for (auto& t : threads)
+    t.join();
+
+  return v;
+}
+
 } // namespace geometry
-} // namespace dolfinx
\ No newline at end of file
+} // namespace dolfinx
@@ -12,4 +12,6 @@ namespace dolfinx
 // DOLFINX geometry interface
 
 #include <dolfinx/geometry/BoundingBoxTree.h>
+#include <dolfinx/geometry/CompactBoundingBoxTree.h>
+#include <dolfinx/geometry/DistributedCollisions.h>
 #include <dolfinx/geometry/GJK.h>
@@ -7,12 +7,20 @@
 
 #include "utils.h"
 #include "BoundingBoxTree.h"
+#include "CompactBoundingBoxTree.h"
 #include "GJK.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/cell_types.h>
 #include <dolfinx/mesh/utils.h>
+#include <limits>
+#include <thread>
 
 using namespace dolfinx;
 
@@ -162,6 +170,155 @@ void _compute_collisions_point(const geometry::BoundingBoxTree& tree,
   }
 }
 //-----------------------------------------------------------------------------
+// Number of points that are traversed together in batched collision
+// queries
+constexpr int packet_size = 8;
+
+// Compute collisions with a packet of (at most packet_size) points,
+// traversing the tree once for the packet. The box tests are computed
+// for all points of the packet at once (on columns of the points, which
+// vectorise), and only nodes whose box contains at least one point of
+// the packet are descended. For each point, the entities are found in
+// the same order as by _compute_collisions_point.
+void _compute_collisions_packet(
+    const geometry::BoundingBoxTree& tree,
+    const Eigen::Array<double, packet_size, 3>& p, int num_points,
+    std::vector<std::pair<int, std::uint32_t>>& stack,
+    std::array<std::vector<std::int32_t>, packet_size>& entities)
+{
+  const double rtol = 1e-14;
+  const std::uint32_t all = (std::uint32_t(1) << num_points) - 1;
+  stack.assign(1, {tree.num_bboxes() - 1, all});
+  while (!stack.empty())
+  {
+    const auto [node, mask] = stack.back();
+    stack.pop_back();
+
+    // Test the points against the box of the node
+    const Eigen::Array<double, 2, 3, Eigen::RowMajor> b = tree.get_bbox(node);
+    const Eigen::Array<double, 1, 3> eps0 = rtol * (b.row(1) - b.row(0));
+    Eigen::Array<bool, packet_size, 1> inside
+        = (p.col(0) >= b(0, 0) - eps0[0]) and (p.col(0) <= b(1, 0) + eps0[0]);
+    for (int j = 1; j < 3; ++j)
+    {
+      inside = inside and (p.col(j) >= b(0, j) - eps0[j])
+               and (p.col(j) <= b(1, j) + eps0[j]);
+    }
+    std::uint32_t hits = 0;
+    for (int k = 0; k < packet_size; ++k)
+      hits |= std::uint32_t(inside[k]) << k;
+    hits &= mask;
+    if (hits == 0)
+      continue;
+
+    const std::array bbox = tree.bbox(node);
+    if (is_leaf(bbox, node))
+    {
+      // child_1 denotes entity for leaves
+      for (int k = 0; k < num_points; ++k)
+        if (hits & (std::uint32_t(1) << k))
+          entities[k].push_back(bbox[1]);
+    }
+    else
+    {
+      // Descend the first child first
+      stack.push_back({bbox[1], hits});
+      stack.push_back({bbox[0], hits});
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+// Compute collisions with a point on a compact tree, appending the
+// entities to a list. The point is tested against the boxes of all
+// children of a node at once.
+void _compute_collisions_compact(const geometry::CompactBoundingBoxTree& tree,
+                                 const Eigen::Vector3d& p,
+                                 std::vector<std::int32_t>& stack,
+                                 std::vector<std::int32_t>& entities)
+{
+  constexpr int width = geometry::CompactBoundingBoxTree::width;
+  if (tree.num_nodes() == 0)
+    return;
+
+  stack.assign(1, 0);
+  while (!stack.empty())
+  {
+    const geometry::CompactBoundingBoxTree::Node& node
+        = tree.node(stack.back());
+    stack.pop_back();
+
+    std::array<bool, width> inside;
+    for (int k = 0; k < width; ++k)
+    {
+      inside[k] = (p[0] >= node.lower[0][k]) & (p[0] <= node.upper[0][k])
+                  & (p[1] >= node.lower[1][k]) & (p[1] <= node.upper[1][k])
+                  & (p[2] >= node.lower[2][k]) & (p[2] <= node.upper[2][k]);
+    }
+
+    for (int k = width - 1; k >= 0; --k)
+    {
+      if (inside[k])
+      {
+        if (const std::int32_t c = node.child[k]; c < 0)
+          entities.push_back(-(c + 1));
+        else
+          stack.push_back(c);
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+// Compute the collisions of a batch of points, processed as work items
+// (e.g. packets of points) [0, num_items) on (at most) num_threads
+// threads, on contiguous ranges of (at least min_chunk) items.
+// compute(i0, i1) returns the entities of the points of the items [i0,
+// i1) and the number of entities of each point.
+template <typename Fn>
+graph::AdjacencyList<std::int32_t>
+compute_batch(std::int32_t num_items, std::int32_t num_points, int num_threads,
+              std::int32_t min_chunk, const Fn& compute)
+{
+  const int n = std::max(1, std::min<int>(num_threads, num_items / min_chunk));
+  std::vector<std::pair<std::vector<std::int32_t>, std::vector<std::int32_t>>>
+      results(n);
+  std::vector<std::thread> threads;
+  for (int i = 1; i < n; ++i)
+  {
+    const std::int32_t i0 = (i * std::int64_t(num_items)) / n;
+    const std::int32_t i1 = ((i + 1) * std::int64_t(num_items)) / n;
+    threads.emplace_back(
+        [&compute, &results, i, i0, i1]() { results[i] = compute(i0, i1); });
+  }
+  results[0] = compute(0, num_items / n);
+  for (auto& t : threads)
+    t.join();
+
+  // Build the adjacency list from the results of the threads, which
+  // are for consecutive ranges of points
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets(num_points + 1);
+  offsets[0] = 0;
+  std::int32_t pos = 0;
+  for (const auto& r : results)
+  {
+    for (std::int32_t num_entities : r.second)
+    {
+      offsets[pos + 1] = offsets[pos] + num_entities;
+      ++pos;
+    }
+  }
+  assert(pos == num_points);
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> data(offsets[num_points]);
+  for (std::size_t i = 0, offset = 0; i < results.size(); ++i)
+  {
+    std::copy(results[i].first.begin(), results[i].first.end(),
+              data.data() + offset);
+    offset += results[i].first.size();
+  }
+
+  return graph::AdjacencyList<std::int32_t>(std::move(data),
+                                            std::move(offsets));
+}
+//-----------------------------------------------------------------------------
 // Compute collisions with tree (recursive)
 void _compute_collisions_tree(const geometry::BoundingBoxTree& A,
                               const geometry::BoundingBoxTree& B, int node_A,
@@ -216,7 +373,341 @@ void _compute_collisions_tree(const geometry::BoundingBoxTree& A,
   // the logic is easier to follow.
 }
 //-----------------------------------------------------------------------------
+// Compute the squared distance from a point to a mesh entity. The
+// connectivities (dim, tdim) and (tdim, dim) must have been computed.
+double _squared_distance(const mesh::Mesh& mesh, int dim, std::int32_t index,
+                         const Eigen::Vector3d& p)
+{
+  const int tdim = mesh.topology().dim();
+  const mesh::Geometry& geometry = mesh.geometry();
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+
+  if (dim == tdim)
+  {
+    auto dofs = x_dofmap.links(index);
+    Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> nodes(dofs.size(),
+                                                                    3);
+    for (int i = 0; i < dofs.size(); i++)
+      nodes.row(i) = geometry.node(dofs(i));
+
+    return geometry::compute_distance_gjk(p.transpose(), nodes).squaredNorm();
+  }
+  else
+  {
+    // Find attached cell
+    auto e_to_c = mesh.topology().connectivity(dim, tdim);
+    assert(e_to_c);
+    assert(e_to_c->num_links(index) > 0);
+    const std::int32_t c = e_to_c->links(index)[0];
+
+    // Find local number of entity wrt cell
+    auto c_to_e = mesh.topology().connectivity(tdim, dim);
+    assert(c_to_e);
+    auto cell_entities = c_to_e->links(c);
+    const auto* it0
+        = std::find(cell_entities.data(),
+                    cell_entities.data() + cell_entities.rows(), index);
+    assert(it0 != (cell_entities.data() + cell_entities.rows()));
+    const int local_cell_entity = std::distance(cell_entities.data(), it0);
+
+    // Tabulate geometry dofs for the entity
+    auto dofs = x_dofmap.links(c);
+    const Eigen::Array<int, Eigen::Dynamic, 1> entity_dofs
+        = geometry.cmap().dof_layout().entity_closure_dofs(dim,
+                                                           local_cell_entity);
+    Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> nodes(
+        entity_dofs.size(), 3);
+    for (int i = 0; i < entity_dofs.size(); i++)
+      nodes.row(i) = geometry.node(dofs(entity_dofs(i)));
+
+    return geometry::compute_distance_gjk(p.transpose(), nodes).squaredNorm();
+  }
+}
+//-----------------------------------------------------------------------------
+// Compute the k leaves of a tree closest to a point (best first). The
+// squared distance from the point to the entity of a leaf is computed
+// by leaf_distance(node, entity, point). The nodes to visit are kept in
+// a heap ordered by the distance to their boxes and the k closest
+// leaves found so far in a bounded heap with the farthest at the front.
+// The heaps are passed in to reuse their storage between points. On
+// return, closest holds the (squared distance, entity) of the (at most
+// k) closest leaves, sorted by distance.
+template <typename Fn>
+void _compute_closest_k(const geometry::BoundingBoxTree& tree,
+                        const Eigen::Vector3d& point, int k,
+                        const Fn& leaf_distance,
+                        std::vector<std::pair<double, int>>& queue,
+                        std::vector<std::pair<double, int>>& closest)
+{
+  auto farther = [](const std::pair<double, int>& a,
+                    const std::pair<double, int>& b) {
+    return a.first > b.first;
+  };
+  auto push = [&tree, &point, &queue, &farther](int node) {
+    queue.emplace_back(
+        geometry::compute_squared_distance_bbox(tree.get_bbox(node), point),
+        node);
+    std::push_heap(queue.begin(), queue.end(), farther);
+  };
+
+  queue.clear();
+  closest.clear();
+  push(tree.num_bboxes() - 1);
+  while (!queue.empty())
+  {
+    std::pop_heap(queue.begin(), queue.end(), farther);
+    const auto [r2, node] = queue.back();
+    queue.pop_back();
+
+    // All remaining boxes are farther away than the k closest leaves
+    if ((int)closest.size() == k and r2 >= closest.front().first)
+      break;
+
+    const std::array bbox = tree.bbox(node);
+    if (is_leaf(bbox, node))
+    {
+      const double d2 = leaf_distance(node, bbox[1], point);
+      if ((int)closest.size() < k)
+      {
+        closest.emplace_back(d2, bbox[1]);
+        std::push_heap(closest.begin(), closest.end());
+      }
+      else if (d2 < closest.front().first)
+      {
+        std::pop_heap(closest.begin(), closest.end());
+        closest.back() = {d2, bbox[1]};
+        std::push_heap(closest.begin(), closest.end());
+      }
+    }
+    else
+    {
+      push(bbox[0]);
+      push(bbox[1]);
+    }
+  }
+
+  std::sort_heap(closest.begin(), closest.end());
+}
+//-----------------------------------------------------------------------------
+// Compute the k closest leaves of a tree to each point of a batch (see
+// _compute_closest_k) on (at most) num_threads threads, on contiguous
+// ranges of points
+template <typename Fn>
+std::pair<Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>,
+          Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+compute_closest_batch(
+    const geometry::BoundingBoxTree& tree,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>&
+        points,
+    int k, int num_threads, const Fn& leaf_distance)
+{
+  if (k < 1)
+    throw std::runtime_error("Number of closest entities must be positive.");
 
+  const std::int32_t num_points = points.rows();
+  Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      entities = Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic,
+                              Eigen::RowMajor>::Constant(num_points, k, -1);
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      distances = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                               Eigen::RowMajor>::
+          Constant(num_points, k, std::numeric_limits<double>::infinity());
+  if (tree.num_bboxes() == 0)
+    return {std::move(entities), std::move(distances)};
+
+  // Compute the closest leaves of the points [p0, p1)
+  auto compute = [&](std::int32_t p0, std::int32_t p1) {
+    std::vector<std::pair<double, int>> queue, closest;
+    for (std::int32_t i = p0; i < p1; ++i)
+    {
+      _compute_closest_k(tree, points.row(i).transpose().matrix(), k,
+                         leaf_distance, queue, closest);
+      for (std::size_t j = 0; j < closest.size(); ++j)
+      {
+        distances(i, j) = std::sqrt(closest[j].first);
+        entities(i, j) = closest[j].second;
+      }
+    }
+  };
+
+  const int n = std::max(1, std::min<int>(num_threads, num_points / 256));
+  std::vector<std::thread> threads;
+  for (int i = 1; i < n; ++i)
+  {
+    threads.emplace_back(compute, (i * std::int64_t(num_points)) / n,
+                         ((i + 1) * std::int64_t(num_points)) / n);
+  }
+  compute(0, num_points / n);
+  for (auto& t : threads)
+    t.join();
+
+  return {std::move(entities), std::move(distances)};
+}
+//-----------------------------------------------------------------------------
+// Test whether a point lies in simplex cells with affine geometry,
+// vectorised over the cells. The barycentric coordinates of the point
+// (of its projection onto the cell for manifolds) are computed in
+// closed form for all cells at once. Returns true for the cells that
+// contain the point up to the tolerance tol, relative to the cell size.
+Eigen::Array<bool, Eigen::Dynamic, 1>
+points_in_simplices(const mesh::Geometry& geometry, int tdim,
+                    const std::vector<int>& cells, const Eigen::Vector3d& p,
+                    double tol)
+{
+  using Array = Eigen::Array<double, Eigen::Dynamic, 3>;
+  const Eigen::Index num_cells = cells.size();
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x
+      = geometry.x();
+
+  // Gather the vectors from the first vertex of the cells to the point
+  // and to the other vertices (edges)
+  Array d(num_cells, 3);
+  std::array<Array, 3> e;
+  for (int k = 0; k < tdim; ++k)
+    e[k].resize(num_cells, 3);
+  for (Eigen::Index i = 0; i < num_cells; ++i)
+  {
+    auto dofs = x_dofmap.links(cells[i]);
+    d.row(i) = p.transpose().array() - x.row(dofs[0]);
+    for (int k = 0; k < tdim; ++k)
+      e[k].row(i) = x.row(dofs[k + 1]) - x.row(dofs[0]);
+  }
+
+  auto dot = [](const Array& a, const Array& b) -> Eigen::ArrayXd {
+    return (a * b).rowwise().sum();
+  };
+  auto cross = [](const Array& a, const Array& b) {
+    Array c(a.rows(), 3);
+    c.col(0) = a.col(1) * b.col(2) - a.col(2) * b.col(1);
+    c.col(1) = a.col(2) * b.col(0) - a.col(0) * b.col(2);
+    c.col(2) = a.col(0) * b.col(1) - a.col(1) * b.col(0);
+    return c;
+  };
+
+  // Compute the barycentric coordinates of the vertices 1, ..., tdim
+  // and the squared distance r2 from the point to the affine hull of
+  // the cell
+  std::array<Eigen::ArrayXd, 3> lambda;
+  Eigen::ArrayXd r2 = Eigen::ArrayXd::Zero(num_cells);
+  const int gdim = geometry.dim();
+  if (tdim == 3)
+  {
+    const Eigen::ArrayXd det = dot(e[0], cross(e[1], e[2]));
+    lambda[0] = dot(d, cross(e[1], e[2])) / det;
+    lambda[1] = dot(d, cross(e[2], e[0])) / det;
+    lambda[2] = dot(d, cross(e[0], e[1])) / det;
+  }
+  else if (tdim == 2 and gdim == 2)
+  {
+    const Eigen::ArrayXd det
+        = e[0].col(0) * e[1].col(1) - e[0].col(1) * e[1].col(0);
+    lambda[0] = (d.col(0) * e[1].col(1) - d.col(1) * e[1].col(0)) / det;
+    lambda[1] = (e[0].col(0) * d.col(1) - e[0].col(1) * d.col(0)) / det;
+    r2 = d.col(2).square();
+  }
+  else if (tdim == 1 and gdim == 1)
+  {
+    lambda[0] = d.col(0) / e[0].col(0);
+    r2 = d.col(1).square() + d.col(2).square();
+  }
+  else if (tdim == 2)
+  {
+    // Solve the normal equations of the projection onto the plane of
+    // the cell
+    const Eigen::ArrayXd g00 = dot(e[0], e[0]), g01 = dot(e[0], e[1]),
+                         g11 = dot(e[1], e[1]);
+    const Eigen::ArrayXd b0 = dot(e[0], d), b1 = dot(e[1], d);
+    const Eigen::ArrayXd det = g00 * g11 - g01 * g01;
+    lambda[0] = (g11 * b0 - g01 * b1) / det;
+    lambda[1] = (g00 * b1 - g01 * b0) / det;
+    const Array r = d - e[0].colwise() * lambda[0] - e[1].colwise() * lambda[1];
+    r2 = dot(r, r);
+  }
+  else
+  {
+    lambda[0] = dot(e[0], d) / dot(e[0], e[0]);
+    const Array r = d - e[0].colwise() * lambda[0];
+    r2 = dot(r, r);
+  }
+
+  // Check the barycentric coordinates and the distance to the cell,
+  // relative to the size (the longest edge from the first vertex)
+  Eigen::ArrayXd h2 = dot(e[0], e[0]);
+  Eigen::ArrayXd lambda0 = 1.0 - lambda[0];
+  Eigen::Array<bool, Eigen::Dynamic, 1> inside = lambda[0] >= -tol;
+  for (int k = 1; k < tdim; ++k)
+  {
+    h2 = h2.max(dot(e[k], e[k]));
+    lambda0 -= lambda[k];
+    inside = inside and lambda[k] >= -tol;
+  }
+  return inside and lambda0 >= -tol and r2 <= tol * tol * h2;
+}
+//-----------------------------------------------------------------------------
+// Test whether a point lies in a quadrilateral or hexahedron cell with
+// Q1 geometry (and gdim equal to tdim), by computing the reference
+// coordinates of the point with Newton's method. Returns 1 if the cell
+// contains the point up to the tolerance tol (relative to the cell
+// size), 0 if it does not and -1 if Newton's method did not converge.
+int point_in_tensor_cell(const mesh::Geometry& geometry, int tdim, int c,
+                         const Eigen::Vector3d& p, double tol)
+{
+  // The bits of the index of a vertex are its reference coordinates
+  auto dofs = geometry.dofmap().links(c);
+  const int num_vertices = 1 << tdim;
+  Eigen::Matrix<double, 8, 3> v;
+  for (int i = 0; i < num_vertices; ++i)
+    v.row(i) = geometry.node(dofs[i]);
+  const double h = (v.row(num_vertices - 1) - v.row(0)).norm();
+
+  // Points outside the plane of a quadrilateral
+  if (tdim == 2 and std::abs(p[2] - v(0, 2)) > tol * h)
+    return 0;
+
+  Eigen::Vector3d X(0.5, 0.5, tdim == 3 ? 0.5 : 0.0);
+  for (int it = 0; it < 16; ++it)
+  {
+    // Compute the residual x(X) - p and the Jacobian
+    Eigen::Vector3d F = -p;
+    Eigen::Matrix3d J = Eigen::Matrix3d::Zero();
+    for (int i = 0; i < num_vertices; ++i)
+    {
+      std::array<double, 3> f = {1.0, 1.0, 1.0};
+      for (int j = 0; j < tdim; ++j)
+        f[j] = (i >> j & 1) ? X[j] : 1.0 - X[j];
+      F += f[0] * f[1] * f[2] * v.row(i).transpose();
+      for (int j = 0; j < tdim; ++j)
+      {
+        double dphi = (i >> j & 1) ? 1.0 : -1.0;
+        for (int k = 0; k < tdim; ++k)
+          if (k != j)
+            dphi *= f[k];
+        J.col(j) += dphi * v.row(i).transpose();
+      }
+    }
+    if (tdim == 2)
+    {
+      F[2] = 0.0;
+      J(2, 2) = 1.0;
+    }
+
+    const Eigen::Vector3d dX = J.inverse() * F;
+    X -= dX;
+    if (!dX.allFinite())
+      return -1;
+    else if (dX.squaredNorm() < 1e-24)
+    {
+      const auto Xt = X.head(tdim).array();
+      return (Xt >= -tol).all() and (Xt <= 1.0 + tol).all();
+    }
+  }
+
+  return -1;
+}
+//-----------------------------------------------------------------------------
 } // namespace
 
 //-----------------------------------------------------------------------------
@@ -261,6 +752,90 @@ std::vector<int> geometry::compute_collisions(const BoundingBoxTree& tree,
   return entities;
 }
 //-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> geometry::compute_collisions(
+    const BoundingBoxTree& tree,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>&
+        points,
+    int num_threads)
+{
+  const std::int32_t num_points = points.rows();
+  const std::int32_t num_packets
+      = (num_points + packet_size - 1) / packet_size;
+
+  // Compute the collisions of the packets [p0, p1)
+  auto compute = [&tree, &points, num_points](std::int32_t p0,
+                                              std::int32_t p1) {
+    std::vector<std::int32_t> data;
+    std::vector<std::int32_t> num_entities;
+    if (tree.num_bboxes() == 0)
+    {
+      num_entities.resize(std::min(p1 * packet_size, num_points)
+                              - std::min(p0 * packet_size, num_points),
+                          0);
+      return std::pair(std::move(data), std::move(num_entities));
+    }
+
+    Eigen::Array<double, packet_size, 3> p
+        = Eigen::Array<double, packet_size, 3>::Zero();
+    std::vector<std::pair<int, std::uint32_t>> stack;
+    std::array<std::vector<std::int32_t>, packet_size> entities;
+    for (std::int32_t packet = p0; packet < p1; ++packet)
+    {
+      const std::int32_t i0 = packet * packet_size;
+      const int n = std::min(packet_size, num_points - i0);
+      p.topRows(n) = points.middleRows(i0, n);
+      for (int k = 0; k < packet_size; ++k)
+        entities[k].clear();
+      _compute_collisions_packet(tree, p, n, stack, entities);
+      for (int k = 0; k < n; ++k)
+      {
+        data.insert(data.end(), entities[k].begin(), entities[k].end());
+        num_entities.push_back(entities[k].size());
+      }
+    }
+    return std::pair(std::move(data), std::move(num_entities));
+  };
+
+  return compute_batch(num_packets, num_points, num_threads, 256, compute);
+}
+//-----------------------------------------------------------------------------
+std::vector<int>
+geometry::compute_collisions(const CompactBoundingBoxTree& tree,
+                             const Eigen::Vector3d& p)
+{
+  std::vector<std::int32_t> stack;
+  std::vector<int> entities;
+  _compute_collisions_compact(tree, p, stack, entities);
+  return entities;
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> geometry::compute_collisions(
+    const CompactBoundingBoxTree& tree,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>&
+        points,
+    int num_threads)
+{
+  // Compute the collisions of the points [p0, p1)
+  auto compute = [&tree, &points](std::int32_t p0, std::int32_t p1) {
+    std::vector<std::int32_t> data;
+    std::vector<std::int32_t> num_entities;
+    std::vector<std::int32_t> stack;
+    for (std::int32_t i = p0; i < p1; ++i)
+    {
+      const std::size_t size = data.size();
+      _compute_collisions_compact(tree, points.row(i).transpose().matrix(),
+                                  stack, data);
+      num_entities.push_back(data.size() - size);
+    }
+    return std::pair(std::move(data), std::move(num_entities));
+  };
+
+  return compute_batch(points.rows(), points.rows(), num_threads, 2048,
+                       compute);
+}
+//-----------------------------------------------------------------------------
 std::vector<int>
 geometry::compute_process_collisions(const geometry::BoundingBoxTree& tree,
                                      const Eigen::Vector3d& p)
@@ -339,75 +914,165 @@ geometry::compute_closest_point(const BoundingBoxTree& tree,
   return {closest_point, sqrt(R2)};
 }
 //-----------------------------------------------------------------------------
-double geometry::squared_distance(const mesh::Mesh& mesh, int dim,
-                                  std::int32_t index, const Eigen::Vector3d& p)
+std::pair<
+    Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>,
+    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+geometry::compute_closest_points(
+    const BoundingBoxTree& tree,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>&
+        points,
+    int k, int num_threads)
 {
-  const int tdim = mesh.topology().dim();
-  const mesh::Geometry& geometry = mesh.geometry();
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
-
-  if (dim == tdim)
+  if (tree.tdim() != 0)
   {
-    auto dofs = x_dofmap.links(index);
-    Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> nodes(dofs.size(),
-                                                                    3);
-    for (int i = 0; i < dofs.size(); i++)
-      nodes.row(i) = geometry.node(dofs(i));
-
-    return geometry::compute_distance_gjk(p.transpose(), nodes).squaredNorm();
+    throw std::runtime_error("Cannot compute closest points. "
+                             "Search tree has not been built for point cloud");
   }
-  else
+
+  // The leaf boxes of a point cloud are the points
+  auto distance = [&tree](int node, int, const Eigen::Vector3d& p) {
+    return (tree.get_bbox(node).row(0).transpose().matrix() - p)
+        .squaredNorm();
+  };
+  return compute_closest_batch(tree, points, k, num_threads, distance);
+}
+//-----------------------------------------------------------------------------
+std::pair<
+    Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>,
+    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+geometry::compute_closest_entities(
+    const BoundingBoxTree& tree, const mesh::Mesh& mesh,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>&
+        points,
+    int k, int num_threads)
+{
+  // Create the connectivity needed by the distance computations before
+  // the threads are started
+  const int dim = tree.tdim();
+  const int tdim = mesh.topology().dim();
+  if (dim != tdim)
   {
-    // Find attached cell
     mesh.topology_mutable().create_connectivity(dim, tdim);
-    auto e_to_c = mesh.topology().connectivity(dim, tdim);
-    assert(e_to_c);
-    assert(e_to_c->num_links(index) > 0);
-    const std::int32_t c = e_to_c->links(index)[0];
-
-    // Find local number of entity wrt cell
     mesh.topology_mutable().create_connectivity(tdim, dim);
-    auto c_to_e = mesh.topology_mutable().connectivity(tdim, dim);
-    assert(c_to_e);
-    auto cell_entities = c_to_e->links(c);
-    const auto* it0
-        = std::find(cell_entities.data(),
-                    cell_entities.data() + cell_entities.rows(), index);
-    assert(it0 != (cell_entities.data() + cell_entities.rows()));
-    const int local_cell_entity = std::distance(cell_entities.data(), it0);
-
-    // Tabulate geometry dofs for the entity
-    auto dofs = x_dofmap.links(c);
-    const Eigen::Array<int, Eigen::Dynamic, 1> entity_dofs
-        = geometry.cmap().dof_layout().entity_closure_dofs(dim,
-                                                           local_cell_entity);
-    Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> nodes(
-        entity_dofs.size(), 3);
-    for (int i = 0; i < entity_dofs.size(); i++)
-      nodes.row(i) = geometry.node(dofs(entity_dofs(i)));
+  }
 
-    return geometry::compute_distance_gjk(p.transpose(), nodes).squaredNorm();
+  auto distance = [&mesh, dim](int, int entity, const Eigen::Vector3d& p) {
+    return _squared_distance(mesh, dim, entity, p);
+  };
+  return compute_closest_batch(tree, points, k, num_threads, distance);
+}
+//-----------------------------------------------------------------------------
+double geometry::squared_distance(const mesh::Mesh& mesh, int dim,
+                                  std::int32_t index, const Eigen::Vector3d& p)
+{
+  const int tdim = mesh.topology().dim();
+  if (dim != tdim)
+  {
+    mesh.topology_mutable().create_connectivity(dim, tdim);
+    mesh.topology_mutable().create_connectivity(tdim, dim);
   }
+  return _squared_distance(mesh, dim, index, p);
 }
 //-------------------------------------------------------------------------------
 std::vector<int>
 geometry::select_colliding_cells(const dolfinx::mesh::Mesh& mesh,
                                  const std::vector<int>& candidate_cells,
-                                 const Eigen::Vector3d& point, int n)
+                                 const Eigen::Vector3d& point, int n,
+                                 double tol)
 {
-  const double eps2 = 1e-20;
-  const int tdim = mesh.topology().dim();
   std::vector<int> result;
-  for (int c : candidate_cells)
+  if (candidate_cells.empty())
+    return result;
+
+  const int tdim = mesh.topology().dim();
+  const mesh::Geometry& geometry = mesh.geometry();
+  const mesh::CellType type = mesh.topology().cell_type();
+  const bool affine = geometry.dofmap().num_links(0)
+                      == mesh::num_cell_vertices(type);
+
+  // Test the candidates with the closed-form tests of simplices and Q1
+  // cells, and with the distance computed by GJK otherwise
+  Eigen::Array<bool, Eigen::Dynamic, 1> inside;
+  if (affine and mesh::is_simplex(type))
+    inside = points_in_simplices(geometry, tdim, candidate_cells, point, tol);
+  else
+  {
+    const bool tensor = affine and tdim == geometry.dim()
+                        and (type == mesh::CellType::quadrilateral
+                             or type == mesh::CellType::hexahedron);
+    inside.resize(candidate_cells.size());
+    for (std::size_t i = 0; i < candidate_cells.size(); ++i)
+    {
+      const int c = candidate_cells[i];
+      const int in
+          = tensor ? point_in_tensor_cell(geometry, tdim, c, point, tol) : -1;
+      if (in >= 0)
+        inside[i] = in;
+      else
+      {
+        // Compare with the size of the box of the cell nodes
+        auto dofs = geometry.dofmap().links(c);
+        Eigen::Array<double, 2, 3, Eigen::RowMajor> b;
+        b.row(0) = geometry.x().row(dofs[0]);
+        b.row(1) = b.row(0);
+        for (Eigen::Index k = 1; k < dofs.rows(); ++k)
+        {
+          b.row(0) = b.row(0).min(geometry.x().row(dofs[k]));
+          b.row(1) = b.row(1).max(geometry.x().row(dofs[k]));
+        }
+        const double h2 = (b.row(1) - b.row(0)).matrix().squaredNorm();
+        inside[i] = _squared_distance(mesh, tdim, c, point) <= tol * tol * h2;
+      }
+    }
+  }
+
+  for (std::size_t i = 0; i < candidate_cells.size(); ++i)
   {
-    const double d2 = squared_distance(mesh, tdim, c, point);
-    if (d2 < eps2)
+    if (inside[i])
     {
-      result.push_back(c);
+      result.push_back(candidate_cells[i]);
       if ((int)result.size() == n)
         return result;
     }
   }
   return result;
 }
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> geometry::select_colliding_cells(
+    const dolfinx::mesh::Mesh& mesh,
+    const graph::AdjacencyList<std::int32_t>& candidate_cells,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>&
+        points,
+    int n, double tol, int num_threads)
+{
+  if (candidate_cells.num_nodes() != points.rows())
+  {
+    throw std::runtime_error(
+        "Number of points and of lists of candidate cells must be equal.");
+  }
+
+  // Select the cells of the points [p0, p1)
+  auto compute = [&](std::int32_t p0, std::int32_t p1) {
+    std::vector<std::int32_t> data;
+    std::vector<std::int32_t> num_cells;
+    num_cells.reserve(p1 - p0);
+    std::vector<int> candidates;
+    for (std::int32_t p = p0; p < p1; ++p)
+    {
+      auto links = candidate_cells.links(p);
+      candidates.assign(links.data(), links.data() + links.rows());
+      const std::vector<int> cells = select_colliding_cells(
+          mesh, candidates, points.row(p).transpose(), n, tol);
+      data.insert(data.end(), cells.begin(), cells.end());
+      num_cells.push_back(cells.size());
+    }
+    return std::pair(std::move(data), std::move(num_cells));
+  };
+
+  return compute_batch(points.rows(), points.rows(), num_threads, 256,
+                       compute);
+}
 //-------------------------------------------------------------------------------
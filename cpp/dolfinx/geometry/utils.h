@@ -7,6 +7,8 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <cstdint>
+#include <dolfinx/graph/AdjacencyList.h>
 #include <utility>
 #include <vector>
 
@@ -20,6 +22,7 @@ class Mesh;
 namespace geometry
 {
 class BoundingBoxTree;
+class CompactBoundingBoxTree;
 
 /// Create a boundary box tree for cell midpoints
 /// @param[in] mesh The mesh build tree of cell midpoints from
@@ -40,6 +43,45 @@ compute_collisions(const BoundingBoxTree& tree0, const BoundingBoxTree& tree1);
 std::vector<int> compute_collisions(const BoundingBoxTree& tree,
                                     const Eigen::Vector3d& p);
 
+/// Compute all collisions between bounding boxes and a batch of
+/// points. Packets of points are traversed together, testing a box
+/// against all points of a packet at once, and the packets are
+/// distributed over the threads.
+/// @param[in] tree The bounding box tree
+/// @param[in] points The points, with shape (num_points, 3)
+/// @param[in] num_threads Number of threads
+/// @return For each point, the bounding box leaves that contain it (in
+///   the same order as for a single point)
+graph::AdjacencyList<std::int32_t> compute_collisions(
+    const BoundingBoxTree& tree,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>&
+        points,
+    int num_threads = 1);
+
+/// Compute all collisions between the boxes of a compact tree and a
+/// point
+/// @param[in] tree The compact bounding box tree
+/// @param[in] p The point
+/// @return The entities whose bounding boxes contain the point (in an
+///   unspecified order)
+std::vector<int> compute_collisions(const CompactBoundingBoxTree& tree,
+                                    const Eigen::Vector3d& p);
+
+/// Compute all collisions between the boxes of a compact tree and a
+/// batch of points, on (at most) num_threads threads
+/// @param[in] tree The compact bounding box tree
+/// @param[in] points The points, with shape (num_points, 3)
+/// @param[in] num_threads Number of threads
+/// @return For each point, the entities whose bounding boxes contain it
+///   (in an unspecified order)
+graph::AdjacencyList<std::int32_t> compute_collisions(
+    const CompactBoundingBoxTree& tree,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>&
+        points,
+    int num_threads = 1);
+
 /// Compute all collisions between processes and Point returning a
 /// list of process ranks
 std::vector<int> compute_process_collisions(const BoundingBoxTree& tree,
@@ -60,6 +102,50 @@ compute_closest_entity(const BoundingBoxTree& tree,
 std::pair<int, double> compute_closest_point(const BoundingBoxTree& tree,
                                              const Eigen::Vector3d& p);
 
+/// Compute the k closest points of a point cloud to each point of a
+/// batch. The nodes of the tree are visited in order of the distance to
+/// their boxes, which stops when the remaining boxes are farther away
+/// than the k closest points found, and the points of the batch are
+/// distributed over the threads.
+/// @param[in] tree The bounding box tree. It must have been initialised
+///   with topological dimension 0.
+/// @param[in] points The points, with shape (num_points, 3)
+/// @param[in] k The number of closest points to find
+/// @param[in] num_threads Number of threads
+/// @return (point indices, distances), each with shape (num_points, k)
+///   and sorted by distance. If the tree has fewer than k points, the
+///   remaining indices are -1 and the distances are infinity.
+std::pair<
+    Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>,
+    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+compute_closest_points(
+    const BoundingBoxTree& tree,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>&
+        points,
+    int k = 1, int num_threads = 1);
+
+/// Compute the k closest mesh entities to each point of a batch (see
+/// compute_closest_points). The distances to the entities are computed
+/// with geometry::squared_distance.
+/// @param[in] tree The bounding box tree of the entities of the mesh
+/// @param[in] mesh The mesh
+/// @param[in] points The points, with shape (num_points, 3)
+/// @param[in] k The number of closest entities to find
+/// @param[in] num_threads Number of threads
+/// @return (entity indices, distances), each with shape (num_points, k)
+///   and sorted by distance. If the tree has fewer than k entities, the
+///   remaining indices are -1 and the distances are infinity.
+std::pair<
+    Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>,
+    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+compute_closest_entities(
+    const BoundingBoxTree& tree, const mesh::Mesh& mesh,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>&
+        points,
+    int k = 1, int num_threads = 1);
+
 /// Compute squared distance between point and bounding box wih index
 /// "node". Returns zero if point is inside box.
 double compute_squared_distance_bbox(
@@ -85,13 +171,42 @@ double squared_distance(const mesh::Mesh& mesh, int dim, std::int32_t index,
 /// From the given Mesh, select up to n cells from the list which actually
 /// collide with point p. n may be zero (selects all valid cells). Less than n
 /// cells may be returned.
+///
+/// For cells with affine (linear) geometry, the test is done in closed
+/// form: from the barycentric coordinates of the point for simplices,
+/// computed for all candidates at once, and from the reference
+/// coordinates computed by Newton's method for quadrilaterals and
+/// hexahedra. Other cells are tested with the distance computed by GJK
+/// (see squared_distance).
 /// @param[in] mesh Mesh
 /// @param[in] candidate_cells List of cell indices to test
 /// @param[in] point Point to check for collision
 /// @param[in] n Maximum number of positive results to return
+/// @param[in] tol Tolerance relative to the cell size, i.e. for the
+///   reference (barycentric) coordinates of the point
 /// @return List of cells which collide with point
 std::vector<int> select_colliding_cells(const dolfinx::mesh::Mesh& mesh,
                                         const std::vector<int>& candidate_cells,
-                                        const Eigen::Vector3d& point, int n);
+                                        const Eigen::Vector3d& point, int n,
+                                        double tol = 1e-10);
+
+/// Select the cells that collide with each point of a batch from its
+/// candidate cells (see select_colliding_cells for a single point). The
+/// points are distributed over the threads.
+/// @param[in] mesh Mesh
+/// @param[in] candidate_cells The candidate cells of each point, e.g.
+///   from compute_collisions with a batch of points
+/// @param[in] points The points, with shape (num_points, 3)
+/// @param[in] n Maximum number of cells for each point
+/// @param[in] tol Tolerance relative to the cell size
+/// @param[in] num_threads Number of threads
+/// @return For each point, the cells which collide with the point
+graph::AdjacencyList<std::int32_t> select_colliding_cells(
+    const dolfinx::mesh::Mesh& mesh,
+    const graph::AdjacencyList<std::int32_t>& candidate_cells,
+    const Eigen::Ref<
+        const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>>&
+        points,
+    int n, double tol = 1e-10, int num_threads = 1);
 } // namespace geometry
 } // namespace dolfinx
@@ -22,6 +22,11 @@ namespace dolfinx::graph
 /// contiguous list of nodes [0, 1, 2, ..., n) it stores the connected
 /// nodes. The representation is strictly local, i.e. it is not parallel
 /// aware.
+///
+/// If all nodes have the same number of links (see degree), e.g. for
+/// cell-vertex connectivity and dofmaps, this is detected on
+/// construction and the links of a node are located by a
+/// multiplication instead of a lookup in the offsets.
 
 template <typename T>
 class AdjacencyList
@@ -30,7 +35,8 @@ public:
   /// Construct trivial adjacency list where each of the n nodes is
   /// connected to itself
   /// @param [in] n Number of nodes
-  explicit AdjacencyList(const std::int32_t n) : _array(n), _offsets(n + 1)
+  explicit AdjacencyList(const std::int32_t n)
+      : _array(n), _offsets(n + 1), _degree(1)
   {
     std::iota(_array.data(), _array.data() + n, 0);
     std::iota(_offsets.data(), _offsets.data() + n + 1, 0);
@@ -45,13 +51,16 @@ public:
                                              std::decay_t<V>>::value,
                              int> = 0>
   AdjacencyList(U&& data, V&& offsets)
-      : _array(std::forward<U>(data)), _offsets(std::forward<V>(offsets))
+      : _array(std::forward<U>(data)), _offsets(std::forward<V>(offsets)),
+        _degree(compute_degree(_offsets))
   {
     // Do nothing
   }
 
   /// Construct adjacency list from arrays of data  (non-Eigen data
-  /// types)
+  /// types). The data is copied, and the storage of data passed as an
+  /// rvalue (e.g. a std::vector) is released after the copy. Pass Eigen
+  /// arrays as rvalues to avoid the copy.
   /// @param [in] data Adjacency array
   /// @param [in] offsets The index to the adjacency list in the data
   ///   array for node i
@@ -64,7 +73,12 @@ public:
   {
     assert(offsets.back() == (std::int32_t)data.size());
     std::copy(data.begin(), data.end(), _array.data());
+    if constexpr (!std::is_lvalue_reference<U>::value)
+      std::decay_t<U>().swap(data);
     std::copy(offsets.begin(), offsets.end(), _offsets.data());
+    if constexpr (!std::is_lvalue_reference<V>::value)
+      std::decay_t<V>().swap(offsets);
+    _degree = compute_degree(_offsets);
   }
 
   /// Construct adjacency list for a problem with a fixed number of
@@ -74,7 +88,8 @@ public:
   explicit AdjacencyList(
       const Eigen::Ref<const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic,
                                           Eigen::RowMajor>>& matrix)
-      : _array(matrix.rows() * matrix.cols()), _offsets(matrix.rows() + 1)
+      : _array(matrix.rows() * matrix.cols()), _offsets(matrix.rows() + 1),
+        _degree(matrix.cols())
   {
     const std::int32_t num_links = matrix.cols();
     for (Eigen::Index e = 0; e < _offsets.rows(); e++)
@@ -94,21 +109,15 @@ public:
   explicit AdjacencyList(const std::vector<X>& data) : _offsets(data.size() + 1)
   {
     // Initialize offsets and compute total size
-    std::int32_t size = 0;
+    _offsets[0] = 0;
     for (std::size_t e = 0; e < data.size(); e++)
-    {
-      _offsets[e] = size;
-      size += data[e].size();
-    }
-    _offsets[data.size()] = size;
-
-    std::vector<T> c;
-    c.reserve(size);
-    for (auto e = data.begin(); e != data.end(); ++e)
-      c.insert(c.end(), e->begin(), e->end());
-
-    _array = Eigen::Array<T, Eigen::Dynamic, 1>(c.size());
-    std::copy(c.begin(), c.end(), _array.data());
+      _offsets[e + 1] = _offsets[e] + data[e].size();
+
+    // Copy the links of each node into place
+    _array.resize(_offsets[data.size()]);
+    for (std::size_t e = 0; e < data.size(); e++)
+      std::copy(data[e].begin(), data[e].end(), _array.data() + _offsets[e]);
+    _degree = compute_degree(_offsets);
   }
 
   /// Copy constructor
@@ -143,15 +152,25 @@ public:
   int num_links(int node) const
   {
     assert((node + 1) < _offsets.rows());
+    if (_degree >= 0)
+      return _degree;
     return _offsets[node + 1] - _offsets[node];
   }
 
+  /// Number of links of every node, if all nodes have the same number
+  /// of links
+  /// @return The number of links of each node, or -1 if the number of
+  ///   links differs between nodes
+  int degree() const { return _degree; }
+
   /// Links (edges) for given node
   /// @param [in] node Node index
   /// @return Array of outgoing links for the node. The length will be
   ///   AdjacencyList:num_links(node).
   typename Eigen::Array<T, Eigen::Dynamic, 1>::SegmentReturnType links(int node)
   {
+    if (_degree >= 0)
+      return _array.segment(node * _degree, _degree);
     return _array.segment(_offsets[node], _offsets[node + 1] - _offsets[node]);
   }
 
@@ -162,13 +181,15 @@ public:
   typename Eigen::Array<T, Eigen::Dynamic, 1>::ConstSegmentReturnType
   links(int node) const
   {
+    if (_degree >= 0)
+      return _array.segment(node * _degree, _degree);
     return _array.segment(_offsets[node], _offsets[node + 1] - _offsets[node]);
   }
 
   /// TODO: attempt to remove
   const std::int32_t* links_ptr(int node) const
   {
-    return &_array[_offsets[node]];
+    return _degree >= 0 ? &_array[node * _degree] : &_array[_offsets[node]];
   }
 
   /// Return contiguous array of links for all nodes (const version)
@@ -180,6 +201,14 @@ public:
     return _offsets;
   }
 
+  /// Memory used by the links and offsets
+  /// @return Memory usage in bytes
+  std::size_t memory_usage() const
+  {
+    return sizeof(*this) + _array.size() * sizeof(T)
+           + _offsets.size() * sizeof(std::int32_t);
+  }
+
   /// Hash of graph
   std::size_t hash() const
   {
@@ -198,10 +227,28 @@ public:
   }
 
 private:
+  // Return the number of links of every node if it is the same for all
+  // nodes, otherwise -1
+  static int
+  compute_degree(const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& offsets)
+  {
+    if (offsets.rows() < 2)
+      return 0;
+    const std::int32_t d = offsets[1] - offsets[0];
+    for (Eigen::Index i = 1; i < offsets.rows() - 1; ++i)
+      if (offsets[i + 1] - offsets[i] != d)
+        return -1;
+    return d;
+  }
+
   // Connections for all entities stored as a contiguous array
   Eigen::Array<T, Eigen::Dynamic, 1> _array;
 
   // Position of first connection for each entity (using local index)
   Eigen::Array<std::int32_t, Eigen::Dynamic, 1> _offsets;
+
+  // Number of links of every node if it is the same for all nodes,
+  // otherwise -1
+  int _degree = -1;
 }; // namespace graph
 } // namespace dolfinx::graph
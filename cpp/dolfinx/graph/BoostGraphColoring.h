@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include "Graph.h"
+#include "AdjacencyList.h"
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/compressed_sparse_row_graph.hpp>
 #include <boost/graph/sequential_vertex_coloring.hpp>
@@ -17,8 +17,6 @@
 namespace dolfinx
 {
 
-class Mesh;
-
 namespace graph
 {
 
@@ -29,12 +27,16 @@ class BoostGraphColoring
 
 public:
   /// Compute vertex colors
+  /// @param[in] graph The graph. Links from a node to itself are
+  ///   ignored.
+  /// @param[out] colors The color of each node
+  /// @return The number of colors
   template <typename ColorType>
   static std::size_t
-  compute_local_vertex_coloring(const Graph& graph,
+  compute_local_vertex_coloring(const AdjacencyList<std::int32_t>& graph,
                                 std::vector<ColorType>& colors)
   {
-    Timer timer("Boost graph coloring (from dolfinx::graph)");
+    common::Timer timer("Boost graph coloring (from dolfinx::graph)");
 
     // Typedef for Boost compressed sparse row graph
     typedef boost::compressed_sparse_row_graph<
@@ -42,27 +44,21 @@ public:
         BoostGraph;
 
     // Number of vertices
-    const std::size_t n = graph.size();
-
-    // Count number of edges
-    Graph::const_iterator vertex;
-    std::size_t num_edges = 0;
-    for (vertex = graph.begin(); vertex != graph.end(); ++vertex)
-      num_edges += vertex->size();
+    const std::size_t n = graph.num_nodes();
 
     // Build list of graph edges
     std::vector<std::pair<std::size_t, std::size_t>> edges;
-    edges.reserve(num_edges);
-    graph_set_type::const_iterator edge;
-    for (vertex = graph.begin(); vertex != graph.end(); ++vertex)
+    edges.reserve(graph.array().size());
+    for (std::int32_t v = 0; v < graph.num_nodes(); ++v)
     {
-      for (edge = vertex->begin(); edge != vertex->end(); ++edge)
+      auto links = graph.links(v);
+      for (Eigen::Index e = 0; e < links.rows(); ++e)
       {
-        const std::size_t vertex_index = vertex - graph.begin();
-        if (vertex_index != (std::size_t)*edge)
-          edges.push_back(std::pair(vertex_index, *edge));
+        if (v != links[e])
+          edges.push_back(std::pair(v, links[e]));
       }
     }
+
     // Build Boost graph
     const BoostGraph g(boost::edges_are_unsorted_multi_pass, edges.begin(),
                        edges.end(), n);
@@ -79,7 +75,7 @@ public:
   static std::size_t
   compute_local_vertex_coloring(const T& graph, std::vector<ColorType>& colors)
   {
-    Timer timer("Boost graph coloring");
+    common::Timer timer("Boost graph coloring");
 
     // Number of vertices in graph
     const std::size_t num_vertices = boost::num_vertices(graph);
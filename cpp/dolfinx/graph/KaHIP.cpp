@@ -20,16 +20,25 @@ using namespace dolfinx;
 
 graph::AdjacencyList<std::int32_t> dolfinx::graph::KaHIP::partition(
     MPI_Comm mpi_comm, int nparts,
-    const graph::AdjacencyList<unsigned long long>& adj_graph, bool ghosting)
+    const graph::AdjacencyList<unsigned long long>& adj_graph, bool ghosting,
+    const std::vector<unsigned long long>& node_weights)
 {
   common::Timer timer("Compute graph partition (KaHIP)");
 
   const std::int32_t num_processes = dolfinx::MPI::size(mpi_comm);
   const std::int32_t process_number = dolfinx::MPI::rank(mpi_comm);
 
-  // Graph does not have vertex or adjacency weights, so we use null
-  // pointers as arguments.
-  unsigned long long* vwgt{nullptr};
+  // Graph does not have adjacency weights, so we use a null pointer as
+  // argument. The vertex weights are null (unit weights) if not given.
+  if (!node_weights.empty()
+      and (std::int32_t)node_weights.size() != adj_graph.num_nodes())
+  {
+    throw std::runtime_error("Number of node weights and nodes differ.");
+  }
+  unsigned long long* vwgt
+      = node_weights.empty()
+            ? nullptr
+            : const_cast<unsigned long long*>(node_weights.data());
   unsigned long long* adjcwgt{nullptr};
 
   // TODO: Allow the user to set the parameters
@@ -161,17 +170,31 @@ graph::AdjacencyList<std::int32_t> dolfinx::graph::KaHIP::partition(
   }
 
   // Convert to offset format for AdjacencyList
-  std::vector<std::int32_t> dests;
-  std::vector<std::int32_t> offsets = {0};
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets(ncells + 1);
+  offsets[0] = 0;
   for (std::int32_t i = 0; i < ncells; ++i)
   {
-    dests.push_back(part[i]);
-    if (auto it = local_node_to_dests.find(i); it != local_node_to_dests.end())
-      dests.insert(dests.end(), it->second.begin(), it->second.end());
-    offsets.push_back(dests.size());
+    offsets[i + 1] = offsets[i] + 1;
+    if (const auto it = local_node_to_dests.find(i);
+        it != local_node_to_dests.end())
+    {
+      offsets[i + 1] += it->second.size();
+    }
+  }
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> dests(offsets[ncells]);
+  for (std::int32_t i = 0; i < ncells; ++i)
+  {
+    dests[offsets[i]] = part[i];
+    if (const auto it = local_node_to_dests.find(i);
+        it != local_node_to_dests.end())
+    {
+      std::copy(it->second.begin(), it->second.end(),
+                dests.data() + offsets[i] + 1);
+    }
   }
 
-  return graph::AdjacencyList<std::int32_t>(dests, offsets);
+  return graph::AdjacencyList<std::int32_t>(std::move(dests),
+                                            std::move(offsets));
 }
 
 #endif
@@ -9,15 +9,18 @@
 #include <cstdint>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <mpi.h>
+#include <vector>
 
 // Interface to KaHIP parallel partitioner
 namespace dolfinx::graph::KaHIP
 {
 #ifdef HAS_KAHIP
-// Standard KaHIP partition
+// Standard KaHIP partition. If node_weights is not empty it holds the
+// weight of each node on this process, otherwise unit weights are used.
 AdjacencyList<std::int32_t>
 partition(MPI_Comm mpi_comm, int nparts,
-          const AdjacencyList<unsigned long long>& adj_graph, bool ghosting);
+          const AdjacencyList<unsigned long long>& adj_graph, bool ghosting,
+          const std::vector<unsigned long long>& node_weights = {});
 
 #endif
 } // namespace dolfinx::graph::KaHIP
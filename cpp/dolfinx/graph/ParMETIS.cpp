@@ -124,7 +124,8 @@ std::vector<int> refine(MPI_Comm mpi_comm,
 //-----------------------------------------------------------------------------
 graph::AdjacencyList<std::int32_t> dolfinx::graph::ParMETIS::partition(
     MPI_Comm mpi_comm, idx_t nparts,
-    const graph::AdjacencyList<idx_t>& adj_graph, bool ghosting)
+    const graph::AdjacencyList<idx_t>& adj_graph, bool ghosting,
+    const std::vector<idx_t>& node_weights)
 {
   common::Timer timer("Compute graph partition (ParMETIS)");
 
@@ -141,9 +142,17 @@ graph::AdjacencyList<std::int32_t> dolfinx::graph::ParMETIS::partition(
   // Strange weight arrays needed by ParMETIS
   idx_t ncon = 1;
 
-  // Prepare remaining arguments for ParMETIS
-  idx_t* elmwgt = nullptr;
-  idx_t wgtflag = 0;
+  // Prepare remaining arguments for ParMETIS. Vertex weights only are
+  // used (wgtflag = 2) if node weights are given.
+  if (!node_weights.empty()
+      and (idx_t)node_weights.size() != adj_graph.num_nodes())
+  {
+    throw std::runtime_error("Number of node weights and nodes differ.");
+  }
+  idx_t* elmwgt = node_weights.empty()
+                      ? nullptr
+                      : const_cast<idx_t*>(node_weights.data());
+  idx_t wgtflag = node_weights.empty() ? 0 : 2;
   idx_t edgecut = 0;
   idx_t numflag = 0;
   std::vector<real_t> tpwgts(ncon * nparts, 1.0 / static_cast<real_t>(nparts));
@@ -269,20 +278,31 @@ graph::AdjacencyList<std::int32_t> dolfinx::graph::ParMETIS::partition(
   }
 
   // Convert to offset format for AdjacencyList
-  std::vector<std::int32_t> dests;
-  std::vector<std::int32_t> offsets = {0};
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets(ncells + 1);
+  offsets[0] = 0;
+  for (std::int32_t i = 0; i < ncells; ++i)
+  {
+    offsets[i + 1] = offsets[i] + 1;
+    if (const auto it = local_node_to_dests.find(i);
+        it != local_node_to_dests.end())
+    {
+      offsets[i + 1] += it->second.size();
+    }
+  }
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> dests(offsets[ncells]);
   for (std::int32_t i = 0; i < ncells; ++i)
   {
-    dests.push_back(part[i]);
+    dests[offsets[i]] = part[i];
     if (const auto it = local_node_to_dests.find(i);
         it != local_node_to_dests.end())
     {
-      dests.insert(dests.end(), it->second.begin(), it->second.end());
+      std::copy(it->second.begin(), it->second.end(),
+                dests.data() + offsets[i] + 1);
     }
-    offsets.push_back(dests.size());
   }
 
-  return graph::AdjacencyList<std::int32_t>(dests, offsets);
+  return graph::AdjacencyList<std::int32_t>(std::move(dests),
+                                            std::move(offsets));
 }
 //-----------------------------------------------------------------------------
 #endif
@@ -21,10 +21,13 @@
 namespace dolfinx::graph::ParMETIS
 {
 #ifdef HAS_PARMETIS
-// Standard ParMETIS partition
-AdjacencyList<std::int32_t> partition(MPI_Comm mpi_comm, idx_t nparts,
-                                      const AdjacencyList<idx_t>& adj_graph,
-                                      bool ghosting);
+// Standard ParMETIS partition. If node_weights is not empty it holds
+// the weight of each node on this process, otherwise unit weights are
+// used.
+AdjacencyList<std::int32_t>
+partition(MPI_Comm mpi_comm, idx_t nparts,
+          const AdjacencyList<idx_t>& adj_graph, bool ghosting,
+          const std::vector<idx_t>& node_weights = {});
 
 #endif
 } // namespace dolfinx::graph::ParMETIS
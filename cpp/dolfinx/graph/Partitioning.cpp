@@ -76,22 +76,13 @@ Partitioning::reorder_global_indices(
     }
   }
 
-  // Send/receive number of indices to communicate to each process
-  std::vector<int> number_recv(size);
-  MPI_Alltoall(number_send.data(), 1, MPI_INT, number_recv.data(), 1, MPI_INT,
-               comm);
-
-  // Compute receive displacements
-  std::vector<int> disp_recv(size + 1, 0);
-  std::partial_sum(number_recv.begin(), number_recv.end(),
-                   disp_recv.begin() + 1);
-
-  // Send/receive global indices
-  std::vector<std::int64_t> vertices_recv(disp_recv.back());
-  MPI_Alltoallv(indices_send.data(), number_send.data(), disp_send.data(),
-                MPI::mpi_type<std::int64_t>(), vertices_recv.data(),
-                number_recv.data(), disp_recv.data(),
-                MPI::mpi_type<std::int64_t>(), comm);
+  // Send/receive global indices (sparse exchange)
+  const graph::AdjacencyList<std::int64_t> recv_list = dolfinx::MPI::all_to_all(
+      comm, graph::AdjacencyList<std::int64_t>(indices_send, disp_send));
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& vertices_recv
+      = recv_list.array();
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& disp_recv
+      = recv_list.offsets();
 
   // Build list of sharing processes for each vertex
   const std::array range
@@ -123,7 +114,7 @@ Partitioning::reorder_global_indices(
   std::unique_ptr<const graph::AdjacencyList<int>> sharing_processes;
   {
     // Pack process that share each vertex
-    std::vector<int> data_send, disp_send(size + 1, 0), num_send(size);
+    std::vector<int> data_send, disp_send(size + 1, 0);
     for (int p = 0; p < size; ++p)
     {
       for (int j = disp_recv[p]; j < disp_recv[p + 1]; ++j)
@@ -135,27 +126,19 @@ Partitioning::reorder_global_indices(
         data_send.insert(data_send.end(), it->second.begin(), it->second.end());
       }
       disp_send[p + 1] = data_send.size();
-      num_send[p] = disp_send[p + 1] - disp_send[p];
     }
 
-    // Send/receive number of process that 'share' each vertex
-    std::vector<int> num_recv(size);
-    MPI_Alltoall(num_send.data(), 1, MPI_INT, num_recv.data(), 1, MPI_INT,
-                 comm);
-
-    // Compute receive displacements
-    std::vector<int> disp_recv(size + 1, 0);
-    std::partial_sum(num_recv.begin(), num_recv.end(), disp_recv.begin() + 1);
-
-    // Send/receive sharing data
-    std::vector<int> data_recv(disp_recv.back(), -1);
-    MPI_Alltoallv(data_send.data(), num_send.data(), disp_send.data(),
-                  MPI::mpi_type<int>(), data_recv.data(), num_recv.data(),
-                  disp_recv.data(), MPI::mpi_type<int>(), comm);
+    // Send/receive sharing data (sparse exchange)
+    const graph::AdjacencyList<int> sharing_recv = dolfinx::MPI::all_to_all(
+        comm, graph::AdjacencyList<int>(data_send, disp_send));
+    const Eigen::Array<int, Eigen::Dynamic, 1>& data_recv
+        = sharing_recv.array();
+    const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& disp_recv
+        = sharing_recv.offsets();
 
     // Unpack data
     std::vector<int> processes, process_offsets(1, 0);
-    for (std::size_t p = 0; p < disp_recv.size() - 1; ++p)
+    for (int p = 0; p < size; ++p)
     {
       for (int i = disp_recv[p]; i < disp_recv[p + 1];)
       {
@@ -438,23 +421,14 @@ Partitioning::distribute(MPI_Comm comm,
   }
 
   // Compute send array displacements
-  std::vector<int> disp_send(size + 1, 0);
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> disp_send(size + 1);
+  disp_send[0] = 0;
   std::partial_sum(num_per_dest_send.begin(), num_per_dest_send.end(),
-                   disp_send.begin() + 1);
-
-  // Send/receive number of items to communicate
-  std::vector<int> num_per_dest_recv(size, 0);
-  MPI_Alltoall(num_per_dest_send.data(), 1, MPI_INT, num_per_dest_recv.data(),
-               1, MPI_INT, comm);
-
-  // Compute receive array displacements
-  std::vector<int> disp_recv(size + 1, 0);
-  std::partial_sum(num_per_dest_recv.begin(), num_per_dest_recv.end(),
-                   disp_recv.begin() + 1);
+                   disp_send.data() + 1);
 
   // Prepare send buffer
-  std::vector<int> offset = disp_send;
-  std::vector<std::int64_t> data_send(disp_send.back());
+  std::vector<int> offset(disp_send.data(), disp_send.data() + size);
+  Eigen::Array<std::int64_t, Eigen::Dynamic, 1> data_send(disp_send[size]);
   for (int i = 0; i < list.num_nodes(); ++i)
   {
     const auto& dests = destinations.links(i);
@@ -470,64 +444,67 @@ Partitioning::distribute(MPI_Comm comm,
     }
   }
 
-  // Send/receive data
-  std::vector<std::int64_t> data_recv(disp_recv.back());
-  MPI_Alltoallv(data_send.data(), num_per_dest_send.data(), disp_send.data(),
-                MPI_INT64_T, data_recv.data(), num_per_dest_recv.data(),
-                disp_recv.data(), MPI_INT64_T, comm);
+  // Send/receive data. Only the processes that exchange cells
+  // communicate. The send buffer is moved into the list and released
+  // after the exchange.
+  const graph::AdjacencyList<std::int64_t> recv_list = dolfinx::MPI::all_to_all(
+      comm, graph::AdjacencyList<std::int64_t>(std::move(data_send),
+                                               std::move(disp_send)));
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& data_recv
+      = recv_list.array();
+
+  // Count the owned and ghost nodes, and their links
+  const int mpi_rank = MPI::rank(comm);
+  std::int32_t num_owned = 0, num_ghosts = 0;
+  std::int32_t num_owned_links = 0, num_ghost_links = 0;
+  for (Eigen::Index i = 0; i < data_recv.rows(); i += 3 + data_recv[i + 2])
+  {
+    if (data_recv[i] == mpi_rank)
+    {
+      ++num_owned;
+      num_owned_links += data_recv[i + 2];
+    }
+    else
+    {
+      ++num_ghosts;
+      num_ghost_links += data_recv[i + 2];
+    }
+  }
 
-  // Unpack receive buffer
-  int mpi_rank = MPI::rank(comm);
-  std::vector<std::int64_t> array;
-  std::vector<std::int64_t> ghost_array;
-  std::vector<std::int64_t> global_indices;
-  std::vector<std::int64_t> ghost_global_indices;
-  std::vector<std::int32_t> list_offset = {0};
-  std::vector<std::int32_t> ghost_list_offset = {0};
-  std::vector<int> src;
-  std::vector<int> ghost_src;
-  std::vector<int> ghost_index_owner;
-
-  for (std::size_t p = 0; p < disp_recv.size() - 1; ++p)
+  // Unpack receive buffer, with all ghost nodes at the end of the list
+  Eigen::Array<std::int64_t, Eigen::Dynamic, 1> array(num_owned_links
+                                                      + num_ghost_links);
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> list_offset(num_owned
+                                                            + num_ghosts + 1);
+  std::vector<std::int64_t> global_indices(num_owned + num_ghosts);
+  std::vector<int> src(num_owned + num_ghosts);
+  std::vector<int> ghost_index_owner(num_ghosts);
+  list_offset[0] = 0;
+  list_offset[num_owned] = num_owned_links;
+  std::int32_t owned_pos = 0, ghost_pos = num_owned;
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& disp_recv
+      = recv_list.offsets();
+  for (int p = 0; p < size; ++p)
   {
     for (int i = disp_recv[p]; i < disp_recv[p + 1];)
     {
-      if (data_recv[i] == mpi_rank)
-      {
-        src.push_back(p);
-        i++; // index_owner.push_back(data_recv[i++]);
-        global_indices.push_back(data_recv[i++]);
-        const std::int64_t num_links = data_recv[i++];
-        for (int j = 0; j < num_links; ++j)
-          array.push_back(data_recv[i++]);
-        list_offset.push_back(list_offset.back() + num_links);
-      }
-      else
-      {
-        ghost_src.push_back(p);
-        ghost_index_owner.push_back(data_recv[i++]);
-        ghost_global_indices.push_back(data_recv[i++]);
-        const std::int64_t num_links = data_recv[i++];
-        for (int j = 0; j < num_links; ++j)
-          ghost_array.push_back(data_recv[i++]);
-        ghost_list_offset.push_back(ghost_list_offset.back() + num_links);
-      }
+      const bool owned = data_recv[i] == mpi_rank;
+      const std::int32_t pos = owned ? owned_pos++ : ghost_pos++;
+      if (!owned)
+        ghost_index_owner[pos - num_owned] = data_recv[i];
+      src[pos] = p;
+      global_indices[pos] = data_recv[i + 1];
+      const std::int32_t num_links = data_recv[i + 2];
+      i += 3;
+      array.segment(list_offset[pos], num_links)
+          = data_recv.segment(i, num_links);
+      list_offset[pos + 1] = list_offset[pos] + num_links;
+      i += num_links;
     }
   }
 
-  // Attach all ghost cells at the end of the list
-  src.insert(src.end(), ghost_src.begin(), ghost_src.end());
-  global_indices.insert(global_indices.end(), ghost_global_indices.begin(),
-                        ghost_global_indices.end());
-  array.insert(array.end(), ghost_array.begin(), ghost_array.end());
-  int ghost_offset = list_offset.back();
-  list_offset.pop_back();
-  for (int& offset : ghost_list_offset)
-    offset += ghost_offset;
-  list_offset.insert(list_offset.end(), ghost_list_offset.begin(),
-                     ghost_list_offset.end());
-
-  return {graph::AdjacencyList<std::int64_t>(array, list_offset),
+  return {graph::AdjacencyList<std::int64_t>(std::move(array),
+                                             std::move(list_offset)),
           std::move(src), std::move(global_indices),
           std::move(ghost_index_owner)};
 }
@@ -203,51 +203,50 @@ Partitioning::distribute_data(
     indices_send[disp_tmp[owner]++] = indices[i];
   }
 
-  // Send/receive number of indices to communicate to each process
-  std::vector<int> number_index_recv(size);
-  MPI_Alltoall(number_index_send.data(), 1, MPI_INT, number_index_recv.data(),
-               1, MPI_INT, comm);
-
-  // Compute receive displacements
-  std::vector<int> disp_index_recv(size + 1, 0);
-  std::partial_sum(number_index_recv.begin(), number_index_recv.end(),
-                   disp_index_recv.begin() + 1);
-
-  // Send/receive global indices
-  std::vector<std::int64_t> indices_recv(disp_index_recv.back());
-  MPI_Alltoallv(indices_send.data(), number_index_send.data(),
-                disp_index_send.data(), MPI_INT64_T, indices_recv.data(),
-                number_index_recv.data(), disp_index_recv.data(), MPI_INT64_T,
-                comm);
-
-  const int item_size = x.cols();
-  assert(item_size != 0);
-  // Pack point data to send back (transpose)
-  Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> x_return(
-      indices_recv.size(), item_size);
-  for (int p = 0; p < size; ++p)
+  // The owners to request data from, and the offsets of their requests
+  std::vector<int> owners;
+  std::vector<std::int32_t> disp_owner_send(1, 0);
+  for (int q = 0; q < size; ++q)
   {
-    for (int i = disp_index_recv[p]; i < disp_index_recv[p + 1]; ++i)
+    if (number_index_send[q] > 0)
     {
-      const std::int32_t index_local = indices_recv[i] - global_offsets[rank];
-      assert(index_local >= 0);
-      x_return.row(i) = x.row(index_local);
+      owners.push_back(q);
+      disp_owner_send.push_back(disp_index_send[q + 1]);
     }
   }
 
-  MPI_Datatype compound_type;
-  MPI_Type_contiguous(item_size, dolfinx::MPI::mpi_type<T>(), &compound_type);
-  MPI_Type_commit(&compound_type);
+  // Send/receive global indices (sparse exchange with the owners)
+  const auto [requesters, indices_recv] = dolfinx::MPI::sparse_exchange(
+      comm, owners,
+      graph::AdjacencyList<std::int64_t>(indices_send, disp_owner_send));
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& disp_index_recv
+      = indices_recv.offsets();
 
-  // Send back point data
-  Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> my_x(
-      disp_index_send.back(), item_size);
-  MPI_Alltoallv(x_return.data(), number_index_recv.data(),
-                disp_index_recv.data(), compound_type, my_x.data(),
-                number_index_send.data(), disp_index_send.data(), compound_type,
-                comm);
+  const int item_size = x.cols();
+  assert(item_size != 0);
+  // Pack point data to send back (transpose)
+  Eigen::Array<T, Eigen::Dynamic, 1> x_return(indices_recv.array().rows()
+                                              * item_size);
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> disp_return
+      = disp_index_recv * item_size;
+  for (int i = 0; i < indices_recv.array().rows(); ++i)
+  {
+    const std::int32_t index_local
+        = indices_recv.array()[i] - global_offsets[rank];
+    assert(index_local >= 0);
+    x_return.segment(i * item_size, item_size) = x.row(index_local).transpose();
+  }
 
-  return my_x;
+  // Send back point data to the requesting ranks. The owners reply in
+  // ascending rank order, which is the order of the requests.
+  const auto [repliers, x_recv] = dolfinx::MPI::sparse_exchange(
+      comm, requesters,
+      graph::AdjacencyList<T>(std::move(x_return), std::move(disp_return)));
+  assert(repliers == owners);
+  assert(x_recv.array().rows() == disp_index_send.back() * item_size);
+  return Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic,
+                                       Eigen::RowMajor>>(
+      x_recv.array().data(), disp_index_send.back(), item_size);
 }
 
 } // namespace dolfinx::graph
@@ -270,20 +270,85 @@ dolfinx::graph::SCOTCH::partition(const MPI_Comm mpi_comm, const int nparts,
   }
 
   // Convert to offset format for AdjacencyList
-  std::vector<std::int32_t> dests;
-  std::vector<std::int32_t> offsets = {0};
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets(vertlocnbr + 1);
+  offsets[0] = 0;
   for (SCOTCH_Num i = 0; i < vertlocnbr; ++i)
   {
-    dests.push_back(cell_partition[i]);
+    offsets[i + 1] = offsets[i] + 1;
     if (auto it = local_node_to_dests.find(i); it != local_node_to_dests.end())
-      dests.insert(dests.end(), it->second.begin(), it->second.end());
-    offsets.push_back(dests.size());
+      offsets[i + 1] += it->second.size();
+  }
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> dests(offsets[vertlocnbr]);
+  for (SCOTCH_Num i = 0; i < vertlocnbr; ++i)
+  {
+    dests[offsets[i]] = cell_partition[i];
+    if (auto it = local_node_to_dests.find(i); it != local_node_to_dests.end())
+      std::copy(it->second.begin(), it->second.end(),
+                dests.data() + offsets[i] + 1);
   }
 
   // Clean up SCOTCH objects
   SCOTCH_dgraphExit(&dgrafdat);
   SCOTCH_stratExit(&strat);
 
-  return graph::AdjacencyList<std::int32_t>(dests, offsets);
+  return graph::AdjacencyList<std::int32_t>(std::move(dests),
+                                            std::move(offsets));
+}
+//-----------------------------------------------------------------------------
+std::vector<std::int32_t>
+dolfinx::graph::SCOTCH::partition_local(
+    const AdjacencyList<std::int32_t>& graph, int nparts)
+{
+  common::Timer timer("Compute SCOTCH local graph partition");
+
+  const SCOTCH_Num vertnbr = graph.num_nodes();
+  if (nparts <= 1 or vertnbr == 0)
+    return std::vector<std::int32_t>(vertnbr, 0);
+
+  // Copy graph into array with SCOTCH_Num types
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& data = graph.array();
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& offsets
+      = graph.offsets();
+  const std::vector<SCOTCH_Num> verttab(offsets.data(),
+                                        offsets.data() + offsets.rows());
+  const std::vector<SCOTCH_Num> edgetab(data.data(), data.data() + data.rows());
+
+  SCOTCH_Graph scotch_graph;
+  if (SCOTCH_graphInit(&scotch_graph) != 0)
+    throw std::runtime_error("Error initializing SCOTCH graph");
+
+  const SCOTCH_Num baseval = 0;
+  const SCOTCH_Num edgenbr = verttab.back();
+  if (SCOTCH_graphBuild(&scotch_graph, baseval, vertnbr, verttab.data(),
+                        nullptr, nullptr, nullptr, edgenbr, edgetab.data(),
+                        nullptr))
+  {
+    throw std::runtime_error("Error building SCOTCH graph");
+  }
+
+// Check graph data for consistency
+#ifdef DEBUG
+  if (SCOTCH_graphCheck(&scotch_graph))
+    throw std::runtime_error("Consistency error in SCOTCH graph");
+#endif
+
+  SCOTCH_Strat strat;
+  SCOTCH_stratInit(&strat);
+
+  // Reset SCOTCH random number generator to produce deterministic
+  // partitions
+  SCOTCH_randomReset();
+
+  std::vector<SCOTCH_Num> parttab(vertnbr);
+  common::Timer timer1("SCOTCH: call SCOTCH_graphPart");
+  if (SCOTCH_graphPart(&scotch_graph, nparts, &strat, parttab.data()))
+    throw std::runtime_error("Error during SCOTCH partitioning");
+  timer1.stop();
+
+  // Clean up SCOTCH objects
+  SCOTCH_graphExit(&scotch_graph);
+  SCOTCH_stratExit(&strat);
+
+  return std::vector<std::int32_t>(parttab.begin(), parttab.end());
 }
 //-----------------------------------------------------------------------------
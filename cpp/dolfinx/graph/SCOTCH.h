@@ -60,4 +60,12 @@ std::pair<std::vector<int>, std::vector<int>>
 compute_reordering(const AdjacencyList<std::int32_t>& graph,
                    std::string scotch_strategy = "");
 
+/// Compute a partition of a (local) graph on this process
+/// @param[in] graph Input graph. The graph must be symmetric and
+///   without links from a node to itself.
+/// @param[in] nparts Number of parts to divide the graph nodes into
+/// @return The part of each node
+std::vector<std::int32_t>
+partition_local(const AdjacencyList<std::int32_t>& graph, int nparts);
+
 } // namespace dolfinx::graph::SCOTCH
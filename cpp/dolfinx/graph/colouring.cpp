@@ -0,0 +1,212 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "colouring.h"
+#include "AdjacencyList.h"
+#include <algorithm>
+#include <atomic>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/ThreadPool.h>
+#include <dolfinx/common/Timer.h>
+#include <functional>
+#include <numeric>
+
+using namespace dolfinx;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Call fn(thread, i0, i1) for chunks [i0, i1) of the range [0, n) on
+// (at most) num_threads threads of the thread pool. Small ranges are
+// not split.
+template <typename Fn>
+void parallel_for(int num_threads, std::int32_t n, const Fn& fn)
+{
+  constexpr std::int32_t min_chunk = 1024;
+  common::parallel_for(std::min(num_threads, n / min_chunk), n, fn);
+}
+//-----------------------------------------------------------------------------
+// Pseudo-random priority of a node with global index i (SplitMix64)
+std::uint64_t priority(std::int64_t i)
+{
+  std::uint64_t z = static_cast<std::uint64_t>(i) + 0x9e3779b97f4a7c15;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+//-----------------------------------------------------------------------------
+// Colour the first num_owned nodes of a graph with the Jones-Plassmann
+// algorithm. Nodes [num_owned, num_nodes) are ghosts, coloured by
+// update_ghosts(colours) after each round. The function done(n) returns
+// true when no process has uncoloured nodes, with n the number of
+// uncoloured nodes on this process.
+std::vector<std::int32_t> jones_plassmann(
+    const graph::AdjacencyList<std::int32_t>& graph, std::int32_t num_owned,
+    const std::vector<std::int64_t>& global_indices, int num_threads,
+    const std::function<void(std::vector<std::int32_t>&)>& update_ghosts,
+    const std::function<bool(std::int32_t)>& done)
+{
+  const std::int32_t num_nodes = global_indices.size();
+  std::vector<std::uint64_t> p(num_nodes);
+  for (std::int32_t i = 0; i < num_nodes; ++i)
+    p[i] = priority(global_indices[i]);
+  auto higher = [&p, &global_indices](std::int32_t a, std::int32_t b) {
+    return p[a] > p[b]
+           or (p[a] == p[b] and global_indices[a] > global_indices[b]);
+  };
+
+  // Count the links of each owned node to nodes of higher priority,
+  // and build the transpose graph (node -> owned nodes linked to it)
+  std::vector<std::atomic<std::int32_t>> count(num_owned);
+  std::vector<std::int32_t> offsets(num_nodes + 1, 0);
+  std::int32_t max_degree = 0;
+  for (std::int32_t v = 0; v < num_owned; ++v)
+  {
+    auto links = graph.links(v);
+    std::int32_t c = 0;
+    for (Eigen::Index j = 0; j < links.rows(); ++j)
+    {
+      if (links[j] != v)
+      {
+        ++offsets[links[j] + 1];
+        if (higher(links[j], v))
+          ++c;
+      }
+    }
+    count[v] = c;
+    max_degree = std::max<std::int32_t>(max_degree, links.rows());
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<std::int32_t> transpose(offsets.back());
+  {
+    std::vector<std::int32_t> pos(offsets.begin(), offsets.end() - 1);
+    for (std::int32_t v = 0; v < num_owned; ++v)
+    {
+      auto links = graph.links(v);
+      for (Eigen::Index j = 0; j < links.rows(); ++j)
+        if (links[j] != v)
+          transpose[pos[links[j]]++] = v;
+    }
+  }
+
+  std::vector<std::int32_t> frontier;
+  for (std::int32_t v = 0; v < num_owned; ++v)
+    if (count[v] == 0)
+      frontier.push_back(v);
+
+  std::vector<std::int32_t> colours(num_nodes, -1);
+  std::vector<std::vector<std::int32_t>> next(std::max(num_threads, 1));
+  std::int32_t num_uncoloured = num_owned;
+  while (true)
+  {
+    // Colour the frontier. The nodes of the frontier are not linked,
+    // and their linked nodes of higher priority are coloured.
+    parallel_for(
+        num_threads, frontier.size(),
+        [&](int, std::int32_t i0, std::int32_t i1) {
+          std::vector<bool> used(max_degree + 1);
+          for (std::int32_t i = i0; i < i1; ++i)
+          {
+            const std::int32_t v = frontier[i];
+            auto links = graph.links(v);
+            std::fill(used.begin(), used.end(), false);
+            for (Eigen::Index j = 0; j < links.rows(); ++j)
+            {
+              const std::int32_t c = colours[links[j]];
+              if (links[j] != v and c >= 0 and c <= max_degree)
+                used[c] = true;
+            }
+            colours[v] = std::distance(
+                used.begin(), std::find(used.begin(), used.end(), false));
+          }
+        });
+    num_uncoloured -= frontier.size();
+
+    // Get the colours of the ghosts, and add the ghosts that were
+    // coloured in this round to the newly coloured nodes
+    std::vector<std::int32_t> coloured = frontier;
+    if (num_nodes > num_owned)
+    {
+      const std::vector<std::int32_t> prev(colours.begin() + num_owned,
+                                           colours.end());
+      update_ghosts(colours);
+      for (std::int32_t i = num_owned; i < num_nodes; ++i)
+        if (prev[i - num_owned] < 0 and colours[i] >= 0)
+          coloured.push_back(i);
+    }
+
+    if (done(num_uncoloured))
+      break;
+
+    // Nodes whose linked nodes of higher priority are now all coloured
+    parallel_for(num_threads, coloured.size(),
+                 [&](int t, std::int32_t i0, std::int32_t i1) {
+                   next[t].clear();
+                   for (std::int32_t i = i0; i < i1; ++i)
+                   {
+                     const std::int32_t u = coloured[i];
+                     for (std::int32_t k = offsets[u]; k < offsets[u + 1];
+                          ++k)
+                     {
+                       const std::int32_t w = transpose[k];
+                       if (higher(u, w) and --count[w] == 0)
+                         next[t].push_back(w);
+                     }
+                   }
+                 });
+    frontier.clear();
+    for (std::vector<std::int32_t>& n : next)
+    {
+      frontier.insert(frontier.end(), n.begin(), n.end());
+      n.clear();
+    }
+  }
+
+  return colours;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+std::vector<std::int32_t>
+graph::compute_colouring(const AdjacencyList<std::int32_t>& graph,
+                         int num_threads)
+{
+  common::Timer timer("Compute graph colouring");
+  std::vector<std::int64_t> indices(graph.num_nodes());
+  std::iota(indices.begin(), indices.end(), 0);
+  return jones_plassmann(
+      graph, graph.num_nodes(), indices, num_threads,
+      [](std::vector<std::int32_t>&) {},
+      [](std::int32_t num_uncoloured) { return num_uncoloured == 0; });
+}
+//-----------------------------------------------------------------------------
+std::vector<std::int32_t>
+graph::compute_colouring(const AdjacencyList<std::int32_t>& graph,
+                         const common::IndexMap& map, int num_threads)
+{
+  common::Timer timer("Compute distributed graph colouring");
+  const std::int32_t num_owned = map.size_local();
+  if (graph.num_nodes() < num_owned)
+    throw std::runtime_error("Graph has fewer nodes than the index map.");
+
+  auto update_ghosts = [&map, num_owned](std::vector<std::int32_t>& colours) {
+    std::vector<std::int32_t> owned(colours.begin(),
+                                    colours.begin() + num_owned);
+    const std::vector<std::int32_t> ghosts = map.scatter_fwd(owned, 1);
+    std::copy(ghosts.begin(), ghosts.end(), colours.begin() + num_owned);
+  };
+  auto done = [comm = map.comm()](std::int32_t num_uncoloured) {
+    std::int32_t n = 0;
+    MPI_Allreduce(&num_uncoloured, &n, 1, MPI_INT32_T, MPI_SUM, comm);
+    return n == 0;
+  };
+
+  return jones_plassmann(graph, num_owned, map.global_indices(true),
+                         num_threads, update_ghosts, done);
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,62 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace dolfinx
+{
+namespace common
+{
+class IndexMap;
+}
+
+namespace graph
+{
+template <typename T>
+class AdjacencyList;
+
+/// Compute a colouring of the nodes of a graph such that no two linked
+/// nodes have the same colour, using the Jones-Plassmann algorithm.
+/// Each node has a pseudo-random priority computed from its index, and
+/// receives the smallest colour not used by its linked nodes of higher
+/// priority. The nodes whose linked nodes of higher priority are all
+/// coloured are coloured concurrently. The colouring is the same as for
+/// a serial greedy colouring in order of priority, and therefore does
+/// not depend on @p num_threads.
+///
+/// @param[in] graph The graph. Links from a node to itself are ignored.
+/// @param[in] num_threads The number of threads to use
+/// @return The colour of each node. The colours are numbered from zero.
+std::vector<std::int32_t>
+compute_colouring(const AdjacencyList<std::int32_t>& graph,
+                  int num_threads = 1);
+
+/// Compute a colouring of the nodes of a distributed graph such that
+/// no two linked nodes have the same colour (collective). The nodes are
+/// the (blocked) indices of @p map. Each process colours its owned
+/// nodes with the Jones-Plassmann algorithm (see compute_colouring),
+/// with the priorities computed from the global node indices, and the
+/// colours of the ghost nodes are received from their owners after each
+/// round. The colouring does not depend on the number of threads.
+///
+/// @param[in] graph The graph for the owned nodes, i.e. the first
+///   map.size_local() nodes. Other nodes are ignored. Links are local
+///   indices of @p map, and may be ghost indices. The graph must be
+///   symmetric: if an owned node i is linked to a ghost node j, then on
+///   the owner of j, node j must be linked to the ghost of i.
+/// @param[in] map The index map for the nodes
+/// @param[in] num_threads The number of threads to use on each process
+/// @return The colour of each (owned and ghost) node. The colours are
+///   numbered from zero, and are the same on all processes.
+std::vector<std::int32_t>
+compute_colouring(const AdjacencyList<std::int32_t>& graph,
+                  const common::IndexMap& map, int num_threads = 1);
+
+} // namespace graph
+} // namespace dolfinx
@@ -13,3 +13,5 @@ namespace dolfinx
 // DOLFINX graph interface
 
 #include <dolfinx/graph/BoostGraphOrdering.h>
+#include <dolfinx/graph/colouring.h>
+#include <dolfinx/graph/subdomains.h>
@@ -0,0 +1,98 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "subdomains.h"
+#include "AdjacencyList.h"
+#include "SCOTCH.h"
+#include <algorithm>
+#include <dolfinx/common/Timer.h>
+#include <vector>
+
+using namespace dolfinx;
+
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t>
+graph::compute_subdomains(const AdjacencyList<std::int32_t>& graph,
+                          int num_subdomains, int overlap)
+{
+  common::Timer timer("Compute graph subdomains");
+  if (num_subdomains < 1)
+    throw std::runtime_error("Number of subdomains must be positive.");
+
+  const std::int32_t num_nodes = graph.num_nodes();
+  const std::vector<std::int32_t> part
+      = SCOTCH::partition_local(graph, num_subdomains);
+
+  // Nodes of each part
+  std::vector<std::vector<std::int32_t>> subdomains(num_subdomains);
+  for (std::int32_t i = 0; i < num_nodes; ++i)
+    subdomains[part[i]].push_back(i);
+
+  // Add layers of linked nodes. marker[i] is the last subdomain that
+  // node i was added to.
+  std::vector<std::int32_t> marker(num_nodes, -1);
+  for (int s = 0; s < num_subdomains; ++s)
+  {
+    std::vector<std::int32_t>& nodes = subdomains[s];
+    for (std::int32_t i : nodes)
+      marker[i] = s;
+    std::size_t layer_begin = 0;
+    for (int l = 0; l < overlap; ++l)
+    {
+      const std::size_t layer_end = nodes.size();
+      for (std::size_t i = layer_begin; i < layer_end; ++i)
+      {
+        auto links = graph.links(nodes[i]);
+        for (Eigen::Index j = 0; j < links.rows(); ++j)
+        {
+          if (marker[links[j]] != s)
+          {
+            marker[links[j]] = s;
+            nodes.push_back(links[j]);
+          }
+        }
+      }
+      layer_begin = layer_end;
+    }
+    std::sort(nodes.begin(), nodes.end());
+  }
+
+  return AdjacencyList<std::int32_t>(subdomains);
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t>
+graph::compute_subdomain_indices(
+    const AdjacencyList<std::int32_t>& subdomains,
+    const AdjacencyList<std::int32_t>& node_indices)
+{
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& all
+      = node_indices.array();
+  const std::int32_t num_indices = all.rows() > 0 ? all.maxCoeff() + 1 : 0;
+
+  // marker[i] is the last subdomain that index i was added to
+  std::vector<std::int32_t> marker(num_indices, -1);
+  std::vector<std::vector<std::int32_t>> indices(subdomains.num_nodes());
+  for (std::int32_t s = 0; s < subdomains.num_nodes(); ++s)
+  {
+    auto nodes = subdomains.links(s);
+    for (Eigen::Index i = 0; i < nodes.rows(); ++i)
+    {
+      auto idx = node_indices.links(nodes[i]);
+      for (Eigen::Index j = 0; j < idx.rows(); ++j)
+      {
+        if (marker[idx[j]] != s)
+        {
+          marker[idx[j]] = s;
+          indices[s].push_back(idx[j]);
+        }
+      }
+    }
+    std::sort(indices[s].begin(), indices[s].end());
+  }
+
+  return AdjacencyList<std::int32_t>(indices);
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,42 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+
+namespace dolfinx::graph
+{
+template <typename T>
+class AdjacencyList;
+
+/// Divide the nodes of a (local) graph into overlapping subdomains,
+/// e.g. for additive Schwarz preconditioners. The graph is partitioned
+/// with SCOTCH into @p num_subdomains parts, and each part is extended
+/// by @p overlap layers of linked nodes.
+///
+/// @param[in] graph The graph. The graph must be symmetric and without
+///   links from a node to itself.
+/// @param[in] num_subdomains The number of subdomains
+/// @param[in] overlap The number of layers of linked nodes added to
+///   each part
+/// @return Adjacency list from subdomain to its (sorted) nodes
+AdjacencyList<std::int32_t>
+compute_subdomains(const AdjacencyList<std::int32_t>& graph,
+                   int num_subdomains, int overlap = 1);
+
+/// Compute the indices of subdomains, where the indices of a subdomain
+/// are the union of the indices of its nodes, e.g. the dofs of the
+/// cells in the subdomain
+/// @param[in] subdomains Adjacency list from subdomain to nodes, see
+///   compute_subdomains
+/// @param[in] node_indices Adjacency list from node to indices
+/// @return Adjacency list from subdomain to its (sorted) indices
+AdjacencyList<std::int32_t>
+compute_subdomain_indices(const AdjacencyList<std::int32_t>& subdomains,
+                          const AdjacencyList<std::int32_t>& node_indices);
+
+} // namespace dolfinx::graph
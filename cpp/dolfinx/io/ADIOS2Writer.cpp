@@ -0,0 +1,335 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#ifdef HAS_ADIOS2
+
+#include "ADIOS2Writer.h"
+#include "cells.h"
+#include <adios2.h>
+#include <algorithm>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/fem/CoordinateElement.h>
+#include <dolfinx/fem/FiniteElement.h>
+#include <dolfinx/function/Function.h>
+#include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <dolfinx/mesh/cell_types.h>
+
+using namespace dolfinx;
+using namespace dolfinx::io;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Get the VTK (arbitrary order Lagrange) cell type of a mesh
+std::uint32_t vtk_cell_type(mesh::CellType cell_type)
+{
+  // https://vtk.org/doc/nightly/html/vtkCellType_8h_source.html
+  switch (cell_type)
+  {
+  case mesh::CellType::interval:
+    return 68;
+  case mesh::CellType::triangle:
+    return 69;
+  case mesh::CellType::quadrilateral:
+    return 70;
+  case mesh::CellType::tetrahedron:
+    return 71;
+  case mesh::CellType::hexahedron:
+    return 72;
+  default:
+    throw std::runtime_error("Unknown cell type");
+  }
+}
+//-----------------------------------------------------------------------------
+// Get the names of the arrays of a function (real and imaginary parts
+// for complex values)
+std::vector<std::string>
+array_names(const function::Function<PetscScalar>& u)
+{
+#ifdef PETSC_USE_COMPLEX
+  return {u.name + "_real", u.name + "_imag"};
+#else
+  return {u.name};
+#endif
+}
+//-----------------------------------------------------------------------------
+// Create the VTX schema (a VTK XML UnstructuredGrid that refers to the
+// ADIOS2 variables) for point data arrays
+std::string vtx_schema(const std::vector<std::string>& point_data)
+{
+  std::string schema = R"(
+<VTKFile type="UnstructuredGrid" version="0.1">
+  <UnstructuredGrid>
+    <Piece NumberOfPoints="NumberOfNodes" NumberOfCells="NumberOfCells">
+      <Points>
+        <DataArray Name="geometry" />
+      </Points>
+      <Cells>
+        <DataArray Name="connectivity" />
+        <DataArray Name="types" />
+      </Cells>
+      <PointData>
+)";
+  for (const std::string& name : point_data)
+    schema += "        <DataArray Name=\"" + name + "\" />\n";
+  schema += R"(        <DataArray Name="TIME">
+          step
+        </DataArray>
+      </PointData>
+    </Piece>
+  </UnstructuredGrid>
+</VTKFile>
+)";
+  return schema;
+}
+//-----------------------------------------------------------------------------
+// Get a variable, defining it if it does not exist, and select the
+// local block of a local array
+template <typename T>
+adios2::Variable<T> define_variable(adios2::IO& io, const std::string& name,
+                                    const adios2::Dims& shape = {},
+                                    const adios2::Dims& count = {})
+{
+  if (adios2::Variable<T> var = io.InquireVariable<T>(name))
+  {
+    if (!count.empty())
+      var.SetSelection({adios2::Dims(count.size(), 0), count});
+    return var;
+  }
+  return io.DefineVariable<T>(name, shape, {},
+                              count.empty() ? adios2::Dims() : count);
+}
+//-----------------------------------------------------------------------------
+// Pad the point values of 2D vectors and tensors to 3D, as expected by
+// VTK
+Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+pad_values(const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                              Eigen::RowMajor>& values,
+           int rank)
+{
+  if (rank == 1 and values.cols() == 2)
+  {
+    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        padded = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                              Eigen::RowMajor>::Zero(values.rows(), 3);
+    padded.leftCols(2) = values;
+    return padded;
+  }
+  else if (rank == 2 and values.cols() == 4)
+  {
+    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        padded = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                              Eigen::RowMajor>::Zero(values.rows(), 9);
+    for (int i = 0; i < 2; ++i)
+      padded.middleCols(3 * i, 2) = values.middleCols(2 * i, 2);
+    return padded;
+  }
+  else
+    return values;
+}
+//-----------------------------------------------------------------------------
+// Get the common mesh of functions
+std::shared_ptr<const mesh::Mesh> common_mesh(
+    const std::vector<std::shared_ptr<const function::Function<PetscScalar>>>&
+        u)
+{
+  if (u.empty())
+    throw std::runtime_error("No functions to write.");
+  std::shared_ptr<const mesh::Mesh> mesh = u.front()->function_space()->mesh();
+  for (auto& v : u)
+  {
+    assert(v);
+    if (v->function_space()->mesh() != mesh)
+      throw std::runtime_error("Functions must be defined on the same mesh.");
+  }
+  return mesh;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+ADIOS2Writer::ADIOS2Writer(MPI_Comm comm, const std::string& filename,
+                           std::shared_ptr<const mesh::Mesh> mesh,
+                           const std::string& engine, int num_aggregators,
+                           bool async,
+                           const std::map<std::string, std::string>& parameters)
+    : _mesh(mesh), _adios(std::make_unique<adios2::ADIOS>(comm))
+{
+  assert(_mesh);
+  if (engine != "BP4" and engine != "BP5")
+    throw std::runtime_error("Unknown ADIOS2 engine '" + engine + "'.");
+  if (async and engine != "BP5")
+  {
+    throw std::runtime_error(
+        "Asynchronous writes require the ADIOS2 BP5 engine.");
+  }
+
+  _io = std::make_unique<adios2::IO>(_adios->DeclareIO("ADIOS2Writer"));
+  _io->SetEngine(engine);
+  if (num_aggregators > 0)
+    _io->SetParameter("NumAggregators", std::to_string(num_aggregators));
+  if (async)
+    _io->SetParameter("AsyncWrite", "true");
+  for (const auto& [key, value] : parameters)
+    _io->SetParameter(key, value);
+
+  _engine = std::make_unique<adios2::Engine>(
+      _io->Open(filename, adios2::Mode::Write));
+}
+//-----------------------------------------------------------------------------
+ADIOS2Writer::ADIOS2Writer(
+    MPI_Comm comm, const std::string& filename,
+    const std::vector<std::shared_ptr<const function::Function<PetscScalar>>>&
+        u,
+    const std::string& engine, int num_aggregators, bool async,
+    const std::map<std::string, std::string>& parameters)
+    : ADIOS2Writer(comm, filename, common_mesh(u), engine, num_aggregators,
+                   async, parameters)
+{
+  _u = u;
+}
+//-----------------------------------------------------------------------------
+ADIOS2Writer::ADIOS2Writer(ADIOS2Writer&& writer) = default;
+//-----------------------------------------------------------------------------
+ADIOS2Writer::~ADIOS2Writer() { close(); }
+//-----------------------------------------------------------------------------
+ADIOS2Writer& ADIOS2Writer::operator=(ADIOS2Writer&& writer)
+{
+  close();
+  _mesh = std::move(writer._mesh);
+  _u = std::move(writer._u);
+  _x_version = writer._x_version;
+  _mesh_written = writer._mesh_written;
+  _adios = std::move(writer._adios);
+  _io = std::move(writer._io);
+  _engine = std::move(writer._engine);
+  return *this;
+}
+//-----------------------------------------------------------------------------
+void ADIOS2Writer::close()
+{
+  if (_engine and *_engine)
+    _engine->Close();
+  _engine.reset();
+}
+//-----------------------------------------------------------------------------
+void ADIOS2Writer::write(double t)
+{
+  common::Timer timer("Write ADIOS2 step");
+  if (!_engine)
+    throw std::runtime_error("ADIOS2 file has been closed.");
+
+  // Define the VTX schema before the first step
+  if (!_io->InquireAttribute<std::string>("vtk.xml"))
+  {
+    std::vector<std::string> point_data;
+    for (auto& u : _u)
+    {
+      const std::vector<std::string> names = array_names(*u);
+      point_data.insert(point_data.end(), names.begin(), names.end());
+    }
+    _io->DefineAttribute<std::string>("vtk.xml", vtx_schema(point_data));
+  }
+
+  _engine->BeginStep();
+  adios2::Variable<double> var_step = define_variable<double>(*_io, "step");
+  _engine->Put<double>(var_step, t);
+
+  if (!_mesh_written or _x_version != _mesh->geometry().x_version())
+    write_mesh();
+
+  // Compute and write the point values. The data of deferred puts must
+  // be kept until the end of the step.
+  std::vector<Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                           Eigen::RowMajor>>
+      data;
+  data.reserve(2 * _u.size());
+  for (auto& u : _u)
+  {
+    const Eigen::Array<PetscScalar, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>
+        values = u->compute_point_values();
+    const int rank = u->function_space()->element()->value_rank();
+    const std::vector<std::string> names = array_names(*u);
+#ifdef PETSC_USE_COMPLEX
+    data.push_back(pad_values(values.real(), rank));
+    data.push_back(pad_values(values.imag(), rank));
+#else
+    data.push_back(pad_values(values, rank));
+#endif
+    for (std::size_t i = 0; i < names.size(); ++i)
+    {
+      const auto& x = data[data.size() - names.size() + i];
+      adios2::Variable<double> var = define_variable<double>(
+          *_io, names[i], {},
+          {static_cast<std::size_t>(x.rows()),
+           static_cast<std::size_t>(x.cols())});
+      _engine->Put<double>(var, x.data());
+    }
+  }
+
+  _engine->EndStep();
+}
+//-----------------------------------------------------------------------------
+void ADIOS2Writer::write_mesh()
+{
+  const mesh::Geometry& geometry = _mesh->geometry();
+  const mesh::Topology& topology = _mesh->topology();
+  const int tdim = topology.dim();
+  const std::int32_t num_cells = topology.index_map(tdim)->size_local();
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  const int num_nodes = geometry.cmap().dof_layout().num_dofs();
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x
+      = geometry.x();
+
+  // Connectivity in VTK ordering, with the number of nodes of each
+  // cell as the first entry of its row
+  const std::vector vtk_map = io::cells::transpose(
+      io::cells::perm_vtk(topology.cell_type(), num_nodes));
+  Eigen::Array<std::int64_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      cells(num_cells, num_nodes + 1);
+  cells.col(0) = num_nodes;
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    auto nodes = x_dofmap.links(c);
+    for (int i = 0; i < num_nodes; ++i)
+      cells(c, i + 1) = nodes[vtk_map[i]];
+  }
+
+  adios2::Variable<std::uint64_t> var_num_nodes
+      = define_variable<std::uint64_t>(*_io, "NumberOfNodes",
+                                       {adios2::LocalValueDim});
+  adios2::Variable<std::uint64_t> var_num_cells
+      = define_variable<std::uint64_t>(*_io, "NumberOfCells",
+                                       {adios2::LocalValueDim});
+  adios2::Variable<std::uint32_t> var_types
+      = define_variable<std::uint32_t>(*_io, "types");
+  adios2::Variable<double> var_x = define_variable<double>(
+      *_io, "geometry", {}, {static_cast<std::size_t>(x.rows()), 3});
+  adios2::Variable<std::int64_t> var_cells = define_variable<std::int64_t>(
+      *_io, "connectivity", {},
+      {static_cast<std::size_t>(num_cells),
+       static_cast<std::size_t>(num_nodes + 1)});
+
+  // Data that is not kept until the end of the step is put
+  // synchronously
+  _engine->Put<std::uint64_t>(var_num_nodes, x.rows(), adios2::Mode::Sync);
+  _engine->Put<std::uint64_t>(var_num_cells, num_cells, adios2::Mode::Sync);
+  _engine->Put<std::uint32_t>(var_types, vtk_cell_type(topology.cell_type()),
+                              adios2::Mode::Sync);
+  _engine->Put<double>(var_x, x.data());
+  _engine->Put<std::int64_t>(var_cells, cells.data(), adios2::Mode::Sync);
+
+  _x_version = geometry.x_version();
+  _mesh_written = true;
+}
+//-----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,134 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#ifdef HAS_ADIOS2
+
+#include <cstdint>
+#include <dolfinx/common/MPI.h>
+#include <map>
+#include <memory>
+#include <petscsys.h>
+#include <string>
+#include <vector>
+
+namespace adios2
+{
+class ADIOS;
+class IO;
+class Engine;
+} // namespace adios2
+
+namespace dolfinx
+{
+namespace function
+{
+template <typename T>
+class Function;
+}
+
+namespace mesh
+{
+class Mesh;
+}
+
+namespace io
+{
+
+/// Output of meshes and functions with ADIOS2 (https://adios2.rtfd.io)
+/// in the VTX schema, which is read by ParaView.
+///
+/// Each call to write adds an ADIOS2 step with the values of the
+/// functions at the nodes of the mesh geometry. The geometry and the
+/// topology of the mesh are written in the first step only, and again
+/// if the mesh geometry has been changed (see mesh::Geometry::x_version).
+/// Each process writes its owned cells and the geometry nodes of its
+/// cells as a block. The functions must be Lagrange functions of the
+/// degree of the mesh geometry (e.g. P1 on an affine mesh) for the
+/// point values to be exact; other functions are evaluated at the
+/// geometry nodes. Complex functions are written as two real arrays
+/// (real and imaginary parts).
+
+class ADIOS2Writer
+{
+public:
+  /// Create a writer for a mesh (collective)
+  /// @param[in] comm The MPI communicator
+  /// @param[in] filename Name of the output file (directory), e.g.
+  ///   "u.bp"
+  /// @param[in] mesh The mesh
+  /// @param[in] engine The ADIOS2 engine ("BP4" or "BP5")
+  /// @param[in] num_aggregators Number of processes that write to the
+  ///   file system (0 for the ADIOS2 default)
+  /// @param[in] async Drain the buffered data to the file system
+  ///   asynchronously, overlapped with computation (BP5 engine only)
+  /// @param[in] parameters Further ADIOS2 engine parameters
+  ADIOS2Writer(MPI_Comm comm, const std::string& filename,
+               std::shared_ptr<const mesh::Mesh> mesh,
+               const std::string& engine = "BP4", int num_aggregators = 0,
+               bool async = false,
+               const std::map<std::string, std::string>& parameters = {});
+
+  /// Create a writer for functions on the same mesh (collective)
+  /// @param[in] comm The MPI communicator
+  /// @param[in] filename Name of the output file (directory), e.g.
+  ///   "u.bp"
+  /// @param[in] u The functions. The names of the functions must be
+  ///   unique.
+  /// @param[in] engine The ADIOS2 engine ("BP4" or "BP5")
+  /// @param[in] num_aggregators Number of processes that write to the
+  ///   file system (0 for the ADIOS2 default)
+  /// @param[in] async Drain the buffered data to the file system
+  ///   asynchronously, overlapped with computation (BP5 engine only)
+  /// @param[in] parameters Further ADIOS2 engine parameters
+  ADIOS2Writer(
+      MPI_Comm comm, const std::string& filename,
+      const std::vector<std::shared_ptr<const function::Function<PetscScalar>>>&
+          u,
+      const std::string& engine = "BP4", int num_aggregators = 0,
+      bool async = false,
+      const std::map<std::string, std::string>& parameters = {});
+
+  /// Move constructor
+  ADIOS2Writer(ADIOS2Writer&& writer);
+
+  /// Destructor. Closes the file.
+  ~ADIOS2Writer();
+
+  /// Move assignment
+  ADIOS2Writer& operator=(ADIOS2Writer&& writer);
+
+  /// Write a step with the current values of the functions (collective)
+  /// @param[in] t The time of the step
+  void write(double t);
+
+  /// Close the file (collective). Further writes are not possible.
+  void close();
+
+private:
+  // Write the mesh geometry and topology (in the current step)
+  void write_mesh();
+
+  // The mesh and the functions
+  std::shared_ptr<const mesh::Mesh> _mesh;
+  std::vector<std::shared_ptr<const function::Function<PetscScalar>>> _u;
+
+  // Version of the geometry that was last written, and whether the
+  // mesh has been written
+  std::uint64_t _x_version = 0;
+  bool _mesh_written = false;
+
+  // ADIOS2 objects
+  std::unique_ptr<adios2::ADIOS> _adios;
+  std::unique_ptr<adios2::IO> _io;
+  std::unique_ptr<adios2::Engine> _engine;
+};
+
+} // namespace io
+} // namespace dolfinx
+
+#endif
@@ -0,0 +1,175 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "AsyncXDMFFile.h"
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/common/log.h>
+#include <dolfinx/function/Function.h>
+#include <dolfinx/la/Vector.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <stdexcept>
+
+using namespace dolfinx;
+using namespace dolfinx::io;
+
+//-----------------------------------------------------------------------------
+AsyncXDMFFile::AsyncXDMFFile(MPI_Comm comm, const std::string filename,
+                             const std::string file_mode,
+                             const XDMFFile::Encoding encoding,
+                             const HDF5Properties& properties,
+                             std::size_t max_queue_size)
+    : _max_queue_size(max_queue_size)
+{
+  if (max_queue_size == 0)
+    throw std::runtime_error("Queue size of AsyncXDMFFile must be positive.");
+
+  // The I/O thread calls MPI (and MPI-IO) concurrently with the
+  // calling thread
+  int provided;
+  MPI_Query_thread(&provided);
+  if (provided < MPI_THREAD_MULTIPLE)
+  {
+    throw std::runtime_error(
+        "AsyncXDMFFile requires MPI to be initialised with "
+        "MPI_THREAD_MULTIPLE.");
+  }
+
+  _file = std::make_unique<XDMFFile>(comm, filename, file_mode, encoding,
+                                     properties);
+  _thread = std::thread(&AsyncXDMFFile::run, this);
+}
+//-----------------------------------------------------------------------------
+AsyncXDMFFile::~AsyncXDMFFile()
+{
+  stop();
+  if (_error)
+    LOG(ERROR) << "Asynchronous output to XDMF file failed.";
+}
+//-----------------------------------------------------------------------------
+void AsyncXDMFFile::write_mesh(const mesh::Mesh& mesh, const std::string xpath)
+{
+  flush();
+  if (!_file)
+    throw std::runtime_error("Cannot write to a closed AsyncXDMFFile.");
+  _file->write_mesh(mesh, xpath);
+}
+//-----------------------------------------------------------------------------
+void AsyncXDMFFile::write_function(const function::Function<PetscScalar>& u,
+                                   double t)
+{
+  common::Timer timer("Queue function for asynchronous XDMF output");
+  check_error();
+  if (!_file)
+    throw std::runtime_error("Cannot write to a closed AsyncXDMFFile.");
+
+  // Copy the expansion coefficients (including ghosts)
+  auto x = std::make_shared<la::Vector<PetscScalar>>(*u.x());
+  auto v = std::make_unique<function::Function<PetscScalar>>(
+      u.function_space(), x);
+  v->name = u.name;
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _cv_done.wait(lock, [this] {
+    return _queue.size() < _max_queue_size or _error;
+  });
+  if (_error)
+  {
+    lock.unlock();
+    check_error();
+  }
+  _queue.emplace_back(std::move(v), t);
+  lock.unlock();
+  _cv_task.notify_one();
+}
+//-----------------------------------------------------------------------------
+void AsyncXDMFFile::flush()
+{
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv_done.wait(lock, [this] {
+      return (_queue.empty() and !_busy) or _error;
+    });
+  }
+  check_error();
+}
+//-----------------------------------------------------------------------------
+void AsyncXDMFFile::close()
+{
+  stop();
+  check_error();
+  if (_file)
+  {
+    _file->close();
+    _file.reset();
+  }
+}
+//-----------------------------------------------------------------------------
+MPI_Comm AsyncXDMFFile::comm() const
+{
+  if (!_file)
+    throw std::runtime_error("AsyncXDMFFile has been closed.");
+  return _file->comm();
+}
+//-----------------------------------------------------------------------------
+void AsyncXDMFFile::run()
+{
+  while (true)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv_task.wait(lock, [this] { return !_queue.empty() or _stop; });
+    if (_queue.empty())
+      return;
+
+    // Take the snapshot off the queue only when it has been written, so
+    // that the queue bounds the number of snapshots held
+    std::pair<std::unique_ptr<function::Function<PetscScalar>>, double>& task
+        = _queue.front();
+    _busy = true;
+    lock.unlock();
+
+    std::exception_ptr error;
+    try
+    {
+      _file->write_function(*task.first, task.second);
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    _queue.pop_front();
+    _busy = false;
+    if (error)
+      _error = error;
+    lock.unlock();
+    _cv_done.notify_all();
+  }
+}
+//-----------------------------------------------------------------------------
+void AsyncXDMFFile::stop()
+{
+  if (!_thread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _cv_task.notify_one();
+  _thread.join();
+}
+//-----------------------------------------------------------------------------
+void AsyncXDMFFile::check_error()
+{
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::swap(error, _error);
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+//-----------------------------------------------------------------------------
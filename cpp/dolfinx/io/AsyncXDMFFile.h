@@ -0,0 +1,134 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "XDMFFile.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <petscsys.h>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace dolfinx
+{
+namespace function
+{
+template <typename T>
+class Function;
+}
+
+namespace mesh
+{
+class Mesh;
+}
+
+namespace io
+{
+
+/// Asynchronous output of time series of functions to an XDMF file.
+///
+/// write_function takes a snapshot of the expansion coefficients of a
+/// function and returns, and the snapshot is written (point values
+/// computed, reordered and written through HDF5) by an I/O thread while
+/// the caller continues. At most max_queue_size() snapshots are
+/// pending; write_function blocks while the queue is full (with the
+/// default size of two, the output of a step overlaps with the
+/// computation of the next step). flush() waits until all pending
+/// snapshots have been written.
+///
+/// The file is written on a duplicate of the communicator, and the MPI
+/// library must support MPI_THREAD_MULTIPLE. The calls are collective
+/// and must be made in the same order on all processes. The mesh of a
+/// function must not be changed while snapshots of the function are
+/// pending. Errors of the I/O thread are raised by the next call.
+
+class AsyncXDMFFile
+{
+public:
+  /// Open a file for writing (collective)
+  /// @param[in] comm The MPI communicator
+  /// @param[in] filename Name of the XDMF file
+  /// @param[in] file_mode The file mode (w, a)
+  /// @param[in] encoding The encoding of the data
+  /// @param[in] properties Properties of the HDF5 file and the datasets
+  /// @param[in] max_queue_size Maximum number of pending snapshots
+  AsyncXDMFFile(MPI_Comm comm, const std::string filename,
+                const std::string file_mode,
+                const XDMFFile::Encoding encoding = XDMFFile::default_encoding,
+                const HDF5Properties& properties = {},
+                std::size_t max_queue_size = 2);
+
+  /// Destructor. Writes the pending snapshots and closes the file.
+  ~AsyncXDMFFile();
+
+  /// Save a mesh (collective). Pending snapshots are written first, and
+  /// the mesh is written before this function returns.
+  /// @param[in] mesh The mesh
+  /// @param[in] xpath XPath where Mesh Grid will be written
+  void write_mesh(const mesh::Mesh& mesh,
+                  const std::string xpath = "/Xdmf/Domain");
+
+  /// Queue a snapshot of a function for output (collective). Blocks
+  /// while the queue is full.
+  /// @param[in] u The function
+  /// @param[in] t The time stamp to associate with the function
+  void write_function(const function::Function<PetscScalar>& u, double t);
+
+  /// Wait until all pending snapshots have been written (collective)
+  void flush();
+
+  /// Write the pending snapshots, stop the I/O thread and close the
+  /// file (collective). Further writes are not possible.
+  void close();
+
+  /// Maximum number of pending snapshots
+  std::size_t max_queue_size() const { return _max_queue_size; }
+
+  /// Get the MPI communicator
+  /// @return The MPI communicator of the file
+  MPI_Comm comm() const;
+
+private:
+  // Loop of the I/O thread
+  void run();
+
+  // Wait for the pending snapshots and stop the I/O thread
+  void stop();
+
+  // Rethrow (and clear) an error of the I/O thread
+  void check_error();
+
+  // The file. It is used by the I/O thread while the thread runs.
+  std::unique_ptr<XDMFFile> _file;
+
+  // Pending snapshots and their time stamps
+  std::deque<std::pair<std::unique_ptr<function::Function<PetscScalar>>,
+                       double>>
+      _queue;
+  std::size_t _max_queue_size;
+
+  // True while the I/O thread writes a snapshot
+  bool _busy = false;
+
+  // True when the I/O thread should exit after the pending snapshots
+  bool _stop = false;
+
+  // Error raised by the I/O thread
+  std::exception_ptr _error;
+
+  std::mutex _mutex;
+  std::condition_variable _cv_task, _cv_done;
+  std::thread _thread;
+};
+
+} // namespace io
+} // namespace dolfinx
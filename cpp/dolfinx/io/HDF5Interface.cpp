@@ -6,7 +6,10 @@
 
 #include "HDF5Interface.h"
 #include <boost/filesystem.hpp>
+#include <algorithm>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Timer.h>
+#include <numeric>
 
 #define HDF5_MAXSTRLEN 80
 
@@ -57,7 +60,8 @@ bool has_group(const hid_t handle, const std::string& group_name)
 
 //-----------------------------------------------------------------------------
 hid_t HDF5Interface::open_file(MPI_Comm mpi_comm, const std::string& filename,
-                               const std::string& mode, const bool use_mpi_io)
+                               const std::string& mode, const bool use_mpi_io,
+                               const HDF5Properties& properties)
 {
   // Set parallel access with communicator
   const hid_t plist_id = H5Pcreate(H5P_FILE_ACCESS);
@@ -67,12 +71,22 @@ hid_t HDF5Interface::open_file(MPI_Comm mpi_comm, const std::string& filename,
   {
     MPI_Info info;
     MPI_Info_create(&info);
+    for (const auto& [key, value] : properties.mpi_hints)
+      MPI_Info_set(info, key.c_str(), value.c_str());
     if (H5Pset_fapl_mpio(plist_id, mpi_comm, info) < 0)
       throw std::runtime_error("Call to H5Pset_fapl_mpio unsuccessful");
     MPI_Info_free(&info);
   }
 #endif
 
+  if (properties.alignment > 1
+      and H5Pset_alignment(plist_id, properties.alignment_threshold,
+                           properties.alignment)
+              < 0)
+  {
+    throw std::runtime_error("Call to H5Pset_alignment unsuccessful");
+  }
+
   hid_t file_id = -1;
   if (mode == "w") // Create file for write, overwriting any existing file
   {
@@ -244,3 +258,85 @@ bool HDF5Interface::get_mpi_atomicity(const hid_t handle)
   return static_cast<bool>(atomic);
 }
 //-----------------------------------------------------------------------------
+std::pair<std::vector<std::array<std::int64_t, 2>>, std::vector<char>>
+HDF5Interface::aggregate_rows(const hid_t handle, const void* data,
+                              const std::array<std::int64_t, 2>& range,
+                              std::size_t row_bytes, int aggregation)
+{
+#ifdef H5_HAVE_PARALLEL
+  common::Timer timer("Aggregate HDF5 data");
+
+  // Get the communicator of the file
+  const hid_t fapl = H5Fget_access_plist(handle);
+  assert(fapl != HDF5_FAIL);
+  MPI_Comm comm;
+  MPI_Info info;
+  if (H5Pget_fapl_mpio(fapl, &comm, &info) < 0)
+    throw std::runtime_error("HDF5 file has not been opened with MPI-IO");
+  H5Pclose(fapl);
+  if (info != MPI_INFO_NULL)
+    MPI_Info_free(&info);
+
+  // Split the processes into aggregation groups
+  const int rank = dolfinx::MPI::rank(comm);
+  MPI_Comm group;
+  if (aggregation < 0)
+  {
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL,
+                        &group);
+  }
+  else
+    MPI_Comm_split(comm, rank / aggregation, rank, &group);
+  MPI_Comm_free(&comm);
+  const int group_size = dolfinx::MPI::size(group);
+  const bool root = dolfinx::MPI::rank(group) == 0;
+
+  // Gather the ranges of the processes of the group
+  std::vector<std::int64_t> ranges(2 * group_size);
+  MPI_Gather(range.data(), 2, MPI_INT64_T, ranges.data(), 2, MPI_INT64_T, 0,
+             group);
+
+  // Place the rows of the processes in increasing order of the ranges,
+  // which is the order in which the selected rows are written
+  std::vector<int> order, counts, displs;
+  std::vector<std::array<std::int64_t, 2>> blocks;
+  int num_rows = 0;
+  if (root)
+  {
+    order.resize(group_size);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&ranges](int p0, int p1) {
+      return ranges[2 * p0] < ranges[2 * p1];
+    });
+    counts.resize(group_size);
+    displs.resize(group_size);
+    for (int p : order)
+    {
+      counts[p] = ranges[2 * p + 1] - ranges[2 * p];
+      displs[p] = num_rows;
+      num_rows += counts[p];
+      if (counts[p] == 0)
+        continue;
+      if (!blocks.empty() and blocks.back()[1] == ranges[2 * p])
+        blocks.back()[1] = ranges[2 * p + 1];
+      else
+        blocks.push_back({ranges[2 * p], ranges[2 * p + 1]});
+    }
+  }
+
+  // Gather the rows
+  MPI_Datatype row_type;
+  MPI_Type_contiguous(row_bytes, MPI_BYTE, &row_type);
+  MPI_Type_commit(&row_type);
+  std::vector<char> buffer(num_rows * row_bytes);
+  MPI_Gatherv(data, range[1] - range[0], row_type, buffer.data(),
+              counts.data(), displs.data(), row_type, 0, group);
+  MPI_Type_free(&row_type);
+  MPI_Comm_free(&group);
+
+  return {std::move(blocks), std::move(buffer)};
+#else
+  throw std::runtime_error("HDF5 library has not been configured with MPI");
+#endif
+}
+//-----------------------------------------------------------------------------
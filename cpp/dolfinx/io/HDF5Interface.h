@@ -6,13 +6,18 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstdint>
+#include <dolfinx/common/CommProfiler.h>
 #include <dolfinx/common/log.h>
 #include <hdf5.h>
 #include <mpi.h>
+#include <stdexcept>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace dolfinx
@@ -21,6 +26,50 @@ namespace dolfinx
 namespace io
 {
 
+/// Properties of the datasets written to a HDF5 file and of the access
+/// to the file. The defaults are contiguous datasets without compression
+/// and collective MPI-IO transfers.
+struct HDF5Properties
+{
+  /// Number of rows of the chunks of datasets. 0 for contiguous
+  /// (unchunked) datasets, -1 to use a chunk size of half the rows,
+  /// limited to between 1024 and 1048576 rows.
+  std::int64_t chunk_size = 0;
+
+  /// Level (1-9) of deflate (gzip) compression of datasets, or 0 for no
+  /// compression. Compressed datasets are chunked, with an automatic
+  /// chunk size if chunk_size is 0. Compression of datasets written
+  /// with MPI-IO requires collective transfers.
+  int deflate = 0;
+
+  /// Apply the byte shuffle filter before compression
+  bool shuffle = false;
+
+  /// Objects in the file larger than alignment_threshold bytes are
+  /// aligned to multiples of alignment bytes (see H5Pset_alignment),
+  /// e.g. the stripe size of a parallel file system
+  std::int64_t alignment = 1;
+
+  /// Minimum size (bytes) of the objects that are aligned
+  std::int64_t alignment_threshold = 1;
+
+  /// MPI-IO hints (key, value) passed to MPI_File_open, e.g.
+  /// ("cb_nodes", "8"), ("striping_unit", "1048576") or
+  /// ("romio_cb_write", "enable")
+  std::vector<std::pair<std::string, std::string>> mpi_hints;
+
+  /// Use collective (true) or independent (false) MPI-IO data transfers
+  bool collective = true;
+
+  /// Aggregation of the data written with MPI-IO: the data of a group
+  /// of processes is gathered to the first process of the group, which
+  /// writes it as one selection, such that fewer processes access the
+  /// file. The value is the number of consecutive processes of a
+  /// group, or -1 for one group per shared memory node. 0 or 1 for no
+  /// aggregation.
+  int aggregation = 0;
+};
+
 /// This class provides an interface to some HDF5 functionality
 
 class HDF5Interface
@@ -32,8 +81,11 @@ public:
   /// @param[in] filename Name of the HDF5 file to open
   /// @param[in] mode Mode in which to open the file (w, r, a)
   /// @param[in] use_mpi_io True if MPI-IO should be used
+  /// @param[in] properties The file access properties (alignment and
+  ///   MPI-IO hints)
   static hid_t open_file(MPI_Comm mpi_comm, const std::string& filename,
-                         const std::string& mode, const bool use_mpi_io);
+                         const std::string& mode, const bool use_mpi_io,
+                         const HDF5Properties& properties = {});
 
   /// Close HDF5 file
   /// @param[in] handle HDF5 file handle
@@ -57,13 +109,15 @@ public:
   /// @param[in] range The local range on this processor
   /// @param[in] global_size The global shape shape of the array
   /// @param[in] use_mpi_io True if MPI-IO should be used
-  /// @param[in] use_chunking True if chunking should be used
+  /// @param[in] properties The dataset properties (chunking,
+  ///   compression and data transfer)
   template <typename T>
   static void write_dataset(const hid_t handle, const std::string& dataset_path,
                             const T* data,
                             const std::array<std::int64_t, 2>& range,
                             const std::vector<std::int64_t>& global_size,
-                            bool use_mpi_io, bool use_chunking);
+                            bool use_mpi_io,
+                            const HDF5Properties& properties = {});
 
   /// Read data from a HDF5 dataset "dataset_path" as defined by range
   /// blocks on each process.
@@ -78,6 +132,18 @@ public:
                                      const std::string& dataset_path,
                                      const std::array<std::int64_t, 2>& range);
 
+  /// Read rows of a two-dimensional HDF5 dataset "dataset_path". The
+  /// contiguous runs of rows are read as one selection.
+  ///
+  /// @param[in] handle HDF5 file handle
+  /// @param[in] dataset_path Path for the dataset in the HDF5 file
+  /// @param[in] rows The rows to read, sorted and unique
+  /// @return Flattened (row-major) array of the values of the rows
+  template <typename T>
+  static std::vector<T>
+  read_dataset_rows(const hid_t handle, const std::string& dataset_path,
+                    const std::vector<std::int64_t>& rows);
+
   /// Check for existence of dataset in HDF5 file
   /// @param[in] handle HDF5 file handle
   /// @param[in] dataset_path Data set path
@@ -106,6 +172,17 @@ public:
   static bool get_mpi_atomicity(const hid_t handle);
 
 private:
+  // Gather the rows written by the processes of an aggregation group
+  // (see HDF5Properties::aggregation) to the first process of the
+  // group (collective on the communicator of the file). Returns the
+  // ranges of rows written by this process, in increasing order, and
+  // the gathered rows in the same order (empty except on the first
+  // process of a group).
+  static std::pair<std::vector<std::array<std::int64_t, 2>>, std::vector<char>>
+  aggregate_rows(const hid_t handle, const void* data,
+                 const std::array<std::int64_t, 2>& range,
+                 std::size_t row_bytes, int aggregation);
+
   /// Add group to HDF5 file
   /// @param[in] handle HDF5 file handle
   /// @param[in] dataset_path Data set path to add
@@ -161,7 +238,8 @@ template <typename T>
 inline void HDF5Interface::write_dataset(
     const hid_t file_handle, const std::string& dataset_path, const T* data,
     const std::array<std::int64_t, 2>& range,
-    const std::vector<int64_t>& global_size, bool use_mpi_io, bool use_chunking)
+    const std::vector<int64_t>& global_size, bool use_mpi_io,
+    const HDF5Properties& properties)
 {
   // Data rank
   const std::size_t rank = global_size.size();
@@ -194,23 +272,49 @@ inline void HDF5Interface::write_dataset(
   const hid_t filespace0 = H5Screate_simple(rank, dimsf.data(), nullptr);
   assert(filespace0 != HDF5_FAIL);
 
-  // Set chunking parameters
-  hid_t chunking_properties;
+  // Set chunking and compression parameters. Datasets with no entries
+  // cannot be chunked.
+  std::int64_t chunk_size = properties.chunk_size;
+  if (properties.deflate > 0 and chunk_size == 0)
+    chunk_size = -1;
+  const bool use_chunking = chunk_size != 0 and dimsf[0] > 0
+                            and (rank == 1 or dimsf[1] > 0);
+  hid_t chunking_properties = H5P_DEFAULT;
   if (use_chunking)
   {
-    // Set chunk size and limit to 1kB min/1MB max
-    hsize_t chunk_size = dimsf[0] / 2;
-    if (chunk_size > 1048576)
-      chunk_size = 1048576;
-    if (chunk_size < 1024)
-      chunk_size = 1024;
-
-    hsize_t chunk_dims[2] = {chunk_size, dimsf[1]};
+    if (chunk_size < 0)
+    {
+      // Set chunk size and limit to 1kB min/1MB max
+      chunk_size = std::min<std::int64_t>(dimsf[0] / 2, 1048576);
+      chunk_size = std::max<std::int64_t>(chunk_size, 1024);
+    }
+
+    // Chunks of fixed size datasets cannot be larger than the dataset
+    std::vector<hsize_t> chunk_dims = dimsf;
+    chunk_dims[0] = std::min<hsize_t>(chunk_size, dimsf[0]);
     chunking_properties = H5Pcreate(H5P_DATASET_CREATE);
-    H5Pset_chunk(chunking_properties, rank, chunk_dims);
+    status = H5Pset_chunk(chunking_properties, rank, chunk_dims.data());
+    assert(status != HDF5_FAIL);
+
+    if (properties.shuffle)
+    {
+      status = H5Pset_shuffle(chunking_properties);
+      assert(status != HDF5_FAIL);
+    }
+
+    if (properties.deflate > 0)
+    {
+      if (!H5Zfilter_avail(H5Z_FILTER_DEFLATE))
+        throw std::runtime_error("HDF5 deflate filter is not available");
+      if (use_mpi_io and !properties.collective)
+      {
+        throw std::runtime_error("Compressed HDF5 datasets require collective "
+                                 "MPI-IO transfers");
+      }
+      status = H5Pset_deflate(chunking_properties, properties.deflate);
+      assert(status != HDF5_FAIL);
+    }
   }
-  else
-    chunking_properties = H5P_DEFAULT;
 
   // Check that group exists and recursively create if required
   const std::string group_name(dataset_path, 0, dataset_path.rfind('/'));
@@ -226,14 +330,48 @@ inline void HDF5Interface::write_dataset(
   status = H5Sclose(filespace0);
   assert(status != HDF5_FAIL);
 
+  // Gather the data of the processes of an aggregation group
+  const std::size_t row_size = rank == 1 ? 1 : dimsf[1];
+  std::vector<std::array<std::int64_t, 2>> blocks = {range};
+  std::vector<char> buffer;
+  const void* values = data;
+  if (use_mpi_io and properties.aggregation != 0
+      and properties.aggregation != 1 and row_size > 0)
+  {
+    std::tie(blocks, buffer)
+        = aggregate_rows(file_handle, data, range, row_size * sizeof(T),
+                         properties.aggregation);
+    values = buffer.data();
+  }
+
   // Create a local data space
+  count[0] = 0;
+  for (const std::array<std::int64_t, 2>& block : blocks)
+    count[0] += block[1] - block[0];
   const hid_t memspace = H5Screate_simple(rank, count.data(), nullptr);
   assert(memspace != HDF5_FAIL);
 
-  // Create a file dataspace within the global space - a hyperslab
+  // Create a file dataspace within the global space - a hyperslab for
+  // each block of rows
   const hid_t filespace1 = H5Dget_space(dset_id);
-  status = H5Sselect_hyperslab(filespace1, H5S_SELECT_SET, offset.data(),
-                               nullptr, count.data(), nullptr);
+  if (blocks.size() == 1)
+  {
+    offset[0] = blocks[0][0];
+    status = H5Sselect_hyperslab(filespace1, H5S_SELECT_SET, offset.data(),
+                                 nullptr, count.data(), nullptr);
+  }
+  else
+  {
+    status = H5Sselect_none(filespace1);
+    for (const std::array<std::int64_t, 2>& block : blocks)
+    {
+      offset[0] = block[0];
+      count[0] = block[1] - block[0];
+      status = H5Sselect_hyperslab(filespace1, H5S_SELECT_OR, offset.data(),
+                                   nullptr, count.data(), nullptr);
+      assert(status != HDF5_FAIL);
+    }
+  }
   assert(status != HDF5_FAIL);
 
   // Set parallel access
@@ -241,7 +379,9 @@ inline void HDF5Interface::write_dataset(
   if (use_mpi_io)
   {
 #ifdef H5_HAVE_PARALLEL
-    status = H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
+    status = H5Pset_dxpl_mpio(plist_id, properties.collective
+                                            ? H5FD_MPIO_COLLECTIVE
+                                            : H5FD_MPIO_INDEPENDENT);
     assert(status != HDF5_FAIL);
 #else
     throw std::runtime_error("HDF5 library has not been configured with MPI");
@@ -249,8 +389,16 @@ inline void HDF5Interface::write_dataset(
   }
 
   // Write local dataset into selected hyperslab
-  status = H5Dwrite(dset_id, h5type, memspace, filespace1, plist_id, data);
-  assert(status != HDF5_FAIL);
+  {
+    common::CommProfiler::Scope profile("HDF5Interface::write_dataset");
+    std::int64_t num_values = 1;
+    for (hsize_t c : count)
+      num_values *= c;
+    profile.set(0, sizeof(T) * num_values, 0);
+    status
+        = H5Dwrite(dset_id, h5type, memspace, filespace1, plist_id, values);
+    assert(status != HDF5_FAIL);
+  }
 
   if (use_chunking)
   {
@@ -353,6 +501,79 @@ HDF5Interface::read_dataset(const hid_t file_handle,
   return data;
 }
 //---------------------------------------------------------------------------
+template <typename T>
+inline std::vector<T>
+HDF5Interface::read_dataset_rows(const hid_t file_handle,
+                                 const std::string& dataset_path,
+                                 const std::vector<std::int64_t>& rows)
+{
+  assert(std::is_sorted(rows.begin(), rows.end()));
+
+  // Open the dataset
+  const hid_t dset_id
+      = H5Dopen2(file_handle, dataset_path.c_str(), H5P_DEFAULT);
+  assert(dset_id != HDF5_FAIL);
+
+  // Open dataspace
+  const hid_t dataspace = H5Dget_space(dset_id);
+  assert(dataspace != HDF5_FAIL);
+  if (H5Sget_simple_extent_ndims(dataspace) != 2)
+  {
+    throw std::runtime_error("Dataset " + dataset_path
+                             + " is not two-dimensional.");
+  }
+  std::array<hsize_t, 2> shape;
+  H5Sget_simple_extent_dims(dataspace, shape.data(), nullptr);
+  if (!rows.empty()
+      and (rows.front() < 0 or rows.back() >= (std::int64_t)shape[0]))
+  {
+    throw std::runtime_error("Row of dataset " + dataset_path
+                             + " is out of range.");
+  }
+
+  // Select the union of the runs of consecutive rows
+  herr_t status = H5Sselect_none(dataspace);
+  assert(status != HDF5_FAIL);
+  for (std::size_t i = 0; i < rows.size();)
+  {
+    std::size_t j = i + 1;
+    while (j < rows.size() and rows[j] == rows[j - 1] + 1)
+      ++j;
+    const std::array<hsize_t, 2> offset = {(hsize_t)rows[i], 0};
+    const std::array<hsize_t, 2> count = {(hsize_t)(j - i), shape[1]};
+    status = H5Sselect_hyperslab(dataspace, H5S_SELECT_OR, offset.data(),
+                                 nullptr, count.data(), nullptr);
+    assert(status != HDF5_FAIL);
+    i = j;
+  }
+
+  // Create a memory dataspace. The selected rows are read in the order
+  // of the file.
+  const std::array<hsize_t, 2> count = {(hsize_t)rows.size(), shape[1]};
+  const hid_t memspace = H5Screate_simple(2, count.data(), nullptr);
+  assert(memspace != HDF5_FAIL);
+  if (rows.empty())
+  {
+    status = H5Sselect_none(memspace);
+    assert(status != HDF5_FAIL);
+  }
+
+  std::vector<T> data(count[0] * count[1]);
+  const hid_t h5type = hdf5_type<T>();
+  status
+      = H5Dread(dset_id, h5type, memspace, dataspace, H5P_DEFAULT, data.data());
+  assert(status != HDF5_FAIL);
+
+  status = H5Sclose(dataspace);
+  assert(status != HDF5_FAIL);
+  status = H5Sclose(memspace);
+  assert(status != HDF5_FAIL);
+  status = H5Dclose(dset_id);
+  assert(status != HDF5_FAIL);
+
+  return data;
+}
+//---------------------------------------------------------------------------
 /// @endcond
 } // namespace io
 } // namespace dolfinx
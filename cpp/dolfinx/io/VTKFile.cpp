@@ -19,7 +19,6 @@
 #include <dolfinx/la/PETScVector.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
-#include <iomanip>
 #include <ostream>
 #include <sstream>
 #include <vector>
@@ -29,16 +28,20 @@ using namespace dolfinx::io;
 
 namespace
 {
-void write_function(const function::Function<PetscScalar>& u,
+template <typename T>
+void write_function(VTKWriter& writer, const function::Function<T>& u,
                     const std::string filename, const std::size_t counter,
                     double time);
-void write_mesh(const mesh::Mesh& mesh, const std::string filename,
-                const std::size_t counter, double time);
-std::string init(const mesh::Mesh& mesh, const std::string filename,
-                 const std::size_t counter, std::size_t dim);
-void results_write(const function::Function<PetscScalar>& u, std::string file);
-void write_point_data(const function::Function<PetscScalar>& u,
-                      const mesh::Mesh& mesh, std::string file);
+void write_mesh(VTKWriter& writer, const mesh::Mesh& mesh,
+                const std::string filename, const std::size_t counter,
+                double time);
+std::string init(const VTKWriter& writer, const mesh::Mesh& mesh,
+                 const std::string filename, const std::size_t counter,
+                 std::size_t dim, std::int32_t num_points);
+bool dof_layout_output(const function::FunctionSpace& V);
+template <typename T>
+void results_write(VTKWriter& writer, const function::Function<T>& u,
+                   std::string file);
 void pvd_file_write(std::size_t step, double time, const std::string filename,
                     std::string file);
 void pvtu_write_function(std::size_t dim, std::size_t rank,
@@ -49,12 +52,12 @@ void pvtu_write_function(std::size_t dim, std::size_t rank,
 void pvtu_write_mesh(const std::string filename,
                      const std::string pvtu_filename, const std::size_t counter,
                      const std::size_t num_processes);
-void pvtu_write(const function::Function<PetscScalar>& u,
-                const std::string filename, const std::string pvtu_filename,
-                const std::size_t counter);
-void vtk_header_open(std::size_t num_vertices, std::size_t num_cells,
-                     const std::string vtu_filename);
-void vtk_header_close(std::string file);
+template <typename T>
+void pvtu_write(const function::Function<T>& u, const std::string filename,
+                const std::string pvtu_filename, const std::size_t counter);
+void vtk_header_open(const VTKWriter& writer, std::size_t num_vertices,
+                     std::size_t num_cells, const std::string vtu_filename);
+void vtk_header_close(VTKWriter& writer, std::string file);
 std::string vtu_name(const int process, const int num_processes,
                      const int counter, const std::string filename,
                      const std::string ext);
@@ -63,8 +66,8 @@ std::string strip_path(const std::string filename, const std::string file);
 void pvtu_write_mesh(pugi::xml_node xml_node);
 
 //----------------------------------------------------------------------------
-void vtk_header_open(std::size_t num_vertices, std::size_t num_cells,
-                     const std::string vtu_filename)
+void vtk_header_open(const VTKWriter& writer, std::size_t num_vertices,
+                     std::size_t num_cells, const std::string vtu_filename)
 {
   // Open file
   std::ofstream file(vtu_filename.c_str(), std::ios::app);
@@ -74,7 +77,7 @@ void vtk_header_open(std::size_t num_vertices, std::size_t num_cells,
 
   // Write headers
   file << "<?xml version=\"1.0\"?>" << std::endl;
-  file << R"(<VTKFile type="UnstructuredGrid"  version="0.1" )"
+  file << R"(<VTKFile type="UnstructuredGrid"  )" << writer.file_attributes()
        << ">" << std::endl;
   file << "<UnstructuredGrid>" << std::endl;
   file << "<Piece  NumberOfPoints=\"" << num_vertices << "\" NumberOfCells=\""
@@ -84,10 +87,10 @@ void vtk_header_open(std::size_t num_vertices, std::size_t num_cells,
   file.close();
 }
 //----------------------------------------------------------------------------
-void vtk_header_close(std::string vtu_filename)
+void vtk_header_close(VTKWriter& writer, std::string vtu_filename)
 {
   // Open file
-  std::ofstream file(vtu_filename.c_str(), std::ios::app);
+  std::ofstream file(vtu_filename.c_str(), std::ios::app | std::ios::binary);
   file.precision(16);
   if (!file.is_open())
   {
@@ -95,9 +98,9 @@ void vtk_header_close(std::string vtu_filename)
   }
 
   // Close headers
-  file << "</Piece>" << std::endl
-       << "</UnstructuredGrid>" << std::endl
-       << "</VTKFile>";
+  file << "</Piece>" << std::endl << "</UnstructuredGrid>" << std::endl;
+  writer.write_appended_data(file);
+  file << "</VTKFile>";
 
   // Close file
   file.close();
@@ -146,8 +149,9 @@ std::string strip_path(const std::string filename, const std::string file)
   return fname;
 }
 //----------------------------------------------------------------------------
-std::string init(const mesh::Mesh& mesh, const std::string filename,
-                 const std::size_t counter, std::size_t cell_dim)
+std::string init(const VTKWriter& writer, const mesh::Mesh& mesh,
+                 const std::string filename, const std::size_t counter,
+                 std::size_t cell_dim, std::int32_t num_points)
 {
   // Get MPI communicators
   const MPI_Comm mpi_comm = mesh.mpi_comm();
@@ -162,16 +166,59 @@ std::string init(const mesh::Mesh& mesh, const std::string filename,
   const std::size_t num_cells
       = mesh.topology().index_map(cell_dim)->size_local();
 
-  // Number of points in mesh (can be more than the number of vertices)
-  const int num_nodes = mesh.geometry().x().rows();
-
   // Write headers
-  vtk_header_open(num_nodes, num_cells, vtu_filename);
+  vtk_header_open(writer, num_points, num_cells, vtu_filename);
 
   return vtu_filename;
 }
 //----------------------------------------------------------------------------
-void write_function(const function::Function<PetscScalar>& u,
+bool dof_layout_output(const function::FunctionSpace& V)
+{
+  // Sub-spaces share the dof array of the parent space
+  if (!V.component().empty())
+    return false;
+
+  std::shared_ptr<const fem::FiniteElement> element = V.element();
+  assert(element);
+  const std::string family = element->family();
+  if (family != "Lagrange" and family != "P" and family != "Q"
+      and family != "Discontinuous Lagrange" and family != "DG"
+      and family != "DQ")
+  {
+    return false;
+  }
+
+  // The components of the values must be the dofs at a node (not the
+  // case for symmetric tensors)
+  const int bs = element->block_size();
+  if (bs != element->value_size())
+    return false;
+
+  // Piecewise constant functions are written as cell data
+  const int n = element->space_dimension() / bs;
+  if (n == 1)
+    return false;
+
+  // Check that VTK has a Lagrange cell with n nodes
+  assert(V.mesh());
+  switch (V.mesh()->topology().cell_type())
+  {
+  case mesh::CellType::interval:
+  case mesh::CellType::quadrilateral:
+    return true;
+  case mesh::CellType::triangle:
+    return n <= 55;
+  case mesh::CellType::tetrahedron:
+    return n == 4 or n == 10 or n == 20;
+  case mesh::CellType::hexahedron:
+    return n == 8 or n == 27;
+  default:
+    return false;
+  }
+}
+//----------------------------------------------------------------------------
+template <typename T>
+void write_function(VTKWriter& writer, const function::Function<T>& u,
                     const std::string filename, const std::size_t counter,
                     double time)
 {
@@ -182,15 +229,30 @@ void write_function(const function::Function<PetscScalar>& u,
   // Get MPI communicator
   const MPI_Comm mpi_comm = mesh->mpi_comm();
 
+  // Lagrange functions are written at the dofs, as the nodes of
+  // Lagrange cells of the degree of the function space. Other functions
+  // are written at the geometry nodes (or cells) of the mesh.
+  std::shared_ptr<const function::FunctionSpace> V = u.function_space();
+  const bool dof_layout = dof_layout_output(*V);
+  const std::int32_t num_points = dof_layout
+                                      ? V->dof_coordinates()->rows()
+                                      : mesh->geometry().x().rows();
+
   // Get vtu file name and initialise
+  const int tdim = mesh->topology().dim();
   std::string vtu_filename
-      = init(*mesh, filename, counter, mesh->topology().dim());
-
-  // Write mesh
-  VTKWriter::write_mesh(*mesh, mesh->topology().dim(), vtu_filename);
+      = init(writer, *mesh, filename, counter, tdim, num_points);
 
-  // Write results
-  results_write(u, vtu_filename);
+  if (dof_layout)
+  {
+    writer.write_dof_layout(*V, vtu_filename);
+    writer.write_dof_data(u, vtu_filename);
+  }
+  else
+  {
+    writer.write_mesh(*mesh, tdim, vtu_filename);
+    results_write(writer, u, vtu_filename);
+  }
 
   // Parallel-specific files
   const std::size_t num_processes = dolfinx::MPI::size(mpi_comm);
@@ -204,15 +266,16 @@ void write_function(const function::Function<PetscScalar>& u,
     pvd_file_write(counter, time, filename, vtu_filename);
 
   // Finalise and write pvd files
-  vtk_header_close(vtu_filename);
+  vtk_header_close(writer, vtu_filename);
 
   DLOG(INFO) << "Saved function \""
              << "u"
              << "\" to file \"" << filename << "\" in VTK format.";
 }
 //----------------------------------------------------------------------------
-void write_mesh(const mesh::Mesh& mesh, const std::string filename,
-                const std::size_t counter, double time)
+void write_mesh(VTKWriter& writer, const mesh::Mesh& mesh,
+                const std::string filename, const std::size_t counter,
+                double time)
 {
   common::Timer t("Write mesh to PVD/VTK file");
 
@@ -221,10 +284,11 @@ void write_mesh(const mesh::Mesh& mesh, const std::string filename,
 
   // Get vtu file name and initialise out files
   std::string vtu_filename
-      = init(mesh, filename, counter, mesh.topology().dim());
+      = init(writer, mesh, filename, counter, mesh.topology().dim(),
+             mesh.geometry().x().rows());
 
   // Write local mesh to vtu file
-  VTKWriter::write_mesh(mesh, mesh.topology().dim(), vtu_filename);
+  writer.write_mesh(mesh, mesh.topology().dim(), vtu_filename);
 
   // Parallel-specific files
   const std::size_t num_processes = dolfinx::MPI::size(mpi_comm);
@@ -238,12 +302,13 @@ void write_mesh(const mesh::Mesh& mesh, const std::string filename,
     pvd_file_write(counter, time, filename, vtu_filename);
 
   // Finalise
-  vtk_header_close(vtu_filename);
+  vtk_header_close(writer, vtu_filename);
 
   DLOG(INFO) << "Saved mesh in VTK format to file:" << filename;
 }
 //----------------------------------------------------------------------------
-void results_write(const function::Function<PetscScalar>& u,
+template <typename T>
+void results_write(VTKWriter& writer, const function::Function<T>& u,
                    std::string vtu_filename)
 {
   // Get rank of function::Function
@@ -291,102 +356,9 @@ void results_write(const function::Function<PetscScalar>& u,
   assert(dofmap);
   assert(dofmap->element_dof_layout);
   if (dofmap->element_dof_layout->num_dofs() == cell_based_dim)
-    VTKWriter::write_cell_data(u, vtu_filename);
+    writer.write_cell_data(u, vtu_filename);
   else
-    write_point_data(u, *mesh, vtu_filename);
-}
-//----------------------------------------------------------------------------
-void write_point_data(const function::Function<PetscScalar>& u,
-                      const mesh::Mesh& mesh, std::string vtu_filename)
-{
-  const int rank = u.function_space()->element()->value_rank();
-
-  // Get number of components
-  const int dim = u.function_space()->element()->value_size();
-
-  // Open file
-  std::ofstream fp(vtu_filename.c_str(), std::ios_base::app);
-  fp.precision(16);
-
-  // Get function values at vertices
-  Eigen::Array<PetscScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      values = u.compute_point_values();
-
-  if (rank == 0)
-  {
-    fp << "<PointData  Scalars=\""
-       << "u"
-       << "\"> " << std::endl;
-    fp << R"(<DataArray  type="Float64"  Name=")"
-       << "u"
-       << "\"  format=\""
-       << "ascii"
-       << "\">";
-  }
-  else if (rank == 1)
-  {
-    fp << "<PointData  Vectors=\""
-       << "u"
-       << "\"> " << std::endl;
-    fp << R"(<DataArray  type="Float64"  Name=")"
-       << "u"
-       << R"("  NumberOfComponents="3" format=")"
-       << "ascii"
-       << "\">";
-  }
-  else if (rank == 2)
-  {
-    fp << "<PointData  Tensors=\""
-       << "u"
-       << "\"> " << std::endl;
-    fp << R"(<DataArray  type="Float64"  Name=")"
-       << "u"
-       << R"("  NumberOfComponents="9" format=")"
-       << "ascii"
-       << "\">";
-  }
-
-  std::ostringstream ss;
-  ss << std::scientific;
-  ss << std::setprecision(16);
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& points
-      = mesh.geometry().x();
-  for (int i = 0; i < points.rows(); ++i)
-  {
-    if (rank == 1 and dim == 2)
-    {
-      // Append 0.0 to 2D vectors to make them 3D
-      for (int j = 0; j < 2; j++)
-        ss << values(i, j) << " ";
-      ss << 0.0 << "  ";
-    }
-    else if (rank == 2 and dim == 4)
-    {
-      // Pad 2D tensors with 0.0 to make them 3D
-      for (int j = 0; j < 2; j++)
-      {
-        ss << values(i, (2 * j + 0)) << " ";
-        ss << values(i, (2 * j + 1)) << " ";
-        ss << 0.0 << " ";
-      }
-      ss << 0.0 << " ";
-      ss << 0.0 << " ";
-      ss << 0.0 << "  ";
-    }
-    else
-    {
-      // Write all components
-      for (int j = 0; j < dim; j++)
-        ss << values(i, j) << " ";
-      ss << " ";
-    }
-  }
-
-  // Send to file
-  fp << ss.str();
-
-  fp << "</DataArray> " << std::endl;
-  fp << "</PointData> " << std::endl;
+    writer.write_point_data(u, vtu_filename);
 }
 //----------------------------------------------------------------------------
 void pvd_file_write(std::size_t step, double time, const std::string filename,
@@ -558,9 +530,9 @@ void pvtu_write_mesh(const std::string filename, const std::string fname,
   xml_doc.save_file(fname.c_str(), "  ");
 }
 //----------------------------------------------------------------------------
-void pvtu_write(const function::Function<PetscScalar>& u,
-                const std::string filename, const std::string fname,
-                const std::size_t counter)
+template <typename T>
+void pvtu_write(const function::Function<T>& u, const std::string filename,
+                const std::string fname, const std::size_t counter)
 {
   assert(u.function_space()->element());
   const int rank = u.function_space()->element()->value_rank();
@@ -586,8 +558,9 @@ void pvtu_write(const function::Function<PetscScalar>& u,
     cell_based_dim *= mesh->topology().dim();
   assert(u.function_space()->dofmap());
   assert(u.function_space()->dofmap()->element_dof_layout);
-  if (u.function_space()->dofmap()->element_dof_layout->num_dofs()
-      == cell_based_dim)
+  if (!dof_layout_output(*u.function_space())
+      and u.function_space()->dofmap()->element_dof_layout->num_dofs()
+              == cell_based_dim)
   {
     data_type = "cell";
   }
@@ -601,32 +574,47 @@ void pvtu_write(const function::Function<PetscScalar>& u,
 } // namespace
 
 //----------------------------------------------------------------------------
-VTKFile::VTKFile(const std::string filename) : _filename(filename), _counter(0)
+VTKFile::VTKFile(const std::string filename, VTKWriter::Encoding encoding,
+                 bool compress)
+    : _filename(filename), _counter(0), _writer(encoding, compress)
 {
   // Do nothing
 }
 //----------------------------------------------------------------------------
 void VTKFile::write(const mesh::Mesh& mesh)
 {
-  write_mesh(mesh, _filename, _counter, _counter);
+  write_mesh(_writer, mesh, _filename, _counter, _counter);
+  ++_counter;
+}
+//----------------------------------------------------------------------------
+void VTKFile::write(const function::Function<double>& u)
+{
+  write_function(_writer, u, _filename, _counter, _counter);
   ++_counter;
 }
 //----------------------------------------------------------------------------
-void VTKFile::write(const function::Function<PetscScalar>& u)
+void VTKFile::write(const function::Function<std::complex<double>>& u)
 {
-  write_function(u, _filename, _counter, _counter);
+  write_function(_writer, u, _filename, _counter, _counter);
   ++_counter;
 }
 //----------------------------------------------------------------------------
 void VTKFile::write(const mesh::Mesh& mesh, double time)
 {
-  write_mesh(mesh, _filename, _counter, time);
+  write_mesh(_writer, mesh, _filename, _counter, time);
   ++_counter;
 }
 //----------------------------------------------------------------------------
-void VTKFile::write(const function::Function<PetscScalar>& u, double time)
+void VTKFile::write(const function::Function<double>& u, double time)
+{
+  write_function(_writer, u, _filename, _counter, time);
+  ++_counter;
+}
+//----------------------------------------------------------------------------
+void VTKFile::write(const function::Function<std::complex<double>>& u,
+                    double time)
 {
-  write_function(u, _filename, _counter, time);
+  write_function(_writer, u, _filename, _counter, time);
   ++_counter;
 }
 //----------------------------------------------------------------------------
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "VTKWriter.h"
+#include <complex>
 #include <fstream>
 #include <petscsys.h>
 #include <string>
@@ -37,12 +39,29 @@ namespace io
 
 /// XML format is suitable for visualisation of higher order geometries.
 /// It is not suitable to checkpointing as it may decimate some data.
+/// Data arrays are written in ASCII by default. Binary (raw or base64
+/// encoded, optionally zlib compressed) output is much smaller and
+/// faster to write and to read, and is stored in the AppendedData
+/// section of the .vtu files.
+///
+/// (Discontinuous) Lagrange functions of degree one or higher are
+/// written at their dofs, as VTK Lagrange cells of the degree of the
+/// function space, directly from the expansion coefficients (without
+/// interpolation to the mesh geometry). The cells are then represented
+/// at the degree of the function, e.g. a P1 function on a curved mesh
+/// is shown on straight-sided cells. Other functions are written at the
+/// geometry nodes or as cell data.
 
 class VTKFile
 {
 public:
   /// Create VTK file
-  VTKFile(const std::string filename);
+  /// @param[in] filename Name of the .pvd file
+  /// @param[in] encoding The encoding of the data arrays
+  /// @param[in] compress Compress binary data arrays with zlib
+  VTKFile(const std::string filename,
+          VTKWriter::Encoding encoding = VTKWriter::Encoding::ascii,
+          bool compress = false);
 
   /// Destructor
   ~VTKFile() = default;
@@ -51,19 +70,28 @@ public:
   void write(const mesh::Mesh& mesh);
 
   /// Output function::Function
-  void write(const function::Function<PetscScalar>& u);
+  void write(const function::Function<double>& u);
+
+  /// Output complex function::Function (real part)
+  void write(const function::Function<std::complex<double>>& u);
 
   /// Output mesh::Mesh and timestep
   void write(const mesh::Mesh& mesh, double t);
 
   /// Output function::Function and timestep
-  void write(const function::Function<PetscScalar>& u, double t);
+  void write(const function::Function<double>& u, double t);
+
+  /// Output complex function::Function (real part) and timestep
+  void write(const function::Function<std::complex<double>>& u, double t);
 
 private:
   const std::string _filename;
 
   // Counter for the number of times various data has been written
   std::size_t _counter;
+
+  // Writer of the .vtu files
+  VTKWriter _writer;
 };
 } // namespace io
 } // namespace dolfinx
@@ -6,6 +6,8 @@
 
 #include "VTKWriter.h"
 #include "cells.h"
+#include <algorithm>
+#include <complex>
 #include <cstdint>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/log.h>
@@ -22,7 +24,12 @@
 #include <iomanip>
 #include <ostream>
 #include <sstream>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
 
 using namespace dolfinx;
 using namespace dolfinx::io;
@@ -59,55 +66,183 @@ std::int8_t get_vtk_cell_type(const mesh::Mesh& mesh, int cell_dim)
   }
 }
 //----------------------------------------------------------------------------
-// Write cell data (ascii)
-std::string ascii_cell_data(const mesh::Mesh& mesh,
-                            const std::vector<std::size_t>& offset,
-                            const std::vector<PetscScalar>& values,
-                            std::size_t data_dim, std::size_t rank)
+// Get the map from VTK node index i to DOLFINX node index map[i] of a
+// cell with num_nodes nodes
+std::vector<std::uint8_t> vtk_node_map(mesh::CellType cell_type,
+                                       int num_nodes)
 {
-  std::ostringstream ss;
-  ss << std::scientific;
-  ss << std::setprecision(16);
-  auto cell_offset = offset.begin();
-  const int tdim = mesh.topology().dim();
-  const int num_cells = mesh.topology().index_map(tdim)->size_local();
-  for (int i = 0; i < num_cells; ++i)
+  std::vector map
+      = io::cells::transpose(io::cells::perm_vtk(cell_type, num_nodes));
+
+  // TODO: Remove when when paraview issue 19433 is resolved
+  // (https://gitlab.kitware.com/paraview/paraview/issues/19433)
+  if (cell_type == dolfinx::mesh::CellType::hexahedron and num_nodes == 27)
+  {
+    map = {0,  9, 12, 3,  1, 10, 13, 4,  18, 15, 21, 6,  19, 16,
+           22, 7, 2,  11, 5, 14, 8,  17, 20, 23, 24, 25, 26};
+  }
+
+  return map;
+}
+//----------------------------------------------------------------------------
+// Write the Cells element of cells with num_nodes nodes each, given in
+// VTK order
+void write_cells(VTKWriter& writer, std::ostream& file,
+                 const std::vector<std::int32_t>& connectivity, int num_cells,
+                 int num_nodes, std::int8_t vtk_cell_type)
+{
+  file << "<Cells>" << std::endl;
+  writer.write_data_array(file, R"(Name="connectivity")", connectivity);
+
+  // Write offset into connectivity array for the end of each cell
+  std::vector<std::int32_t> offsets(num_cells);
+  for (int c = 0; c < num_cells; ++c)
+    offsets[c] = (c + 1) * num_nodes;
+  writer.write_data_array(file, R"(Name="offsets")", offsets);
+
+  // Write cell type
+  writer.write_data_array(file, R"(Name="types")",
+                          std::vector<std::int8_t>(num_cells, vtk_cell_type));
+  file << "</Cells>" << std::endl;
+}
+//----------------------------------------------------------------------------
+// Write the opening tag of a PointData or CellData element for a
+// function and get the attributes of its DataArray
+std::string open_data(std::ostream& file, const std::string& element,
+                      int rank)
+{
+  if (rank == 0)
+  {
+    file << "<" << element << "  Scalars=\"u\"> " << std::endl;
+    return R"(Name="u")";
+  }
+  else if (rank == 1)
+  {
+    file << "<" << element << "  Vectors=\"u\"> " << std::endl;
+    return R"(Name="u"  NumberOfComponents="3")";
+  }
+  else
   {
-    if (rank == 1 && data_dim == 2)
+    file << "<" << element << "  Tensors=\"u\"> " << std::endl;
+    return R"(Name="u"  NumberOfComponents="9")";
+  }
+}
+//----------------------------------------------------------------------------
+// Pad the values of 2D vectors and tensors with zeros to make them 3D
+template <typename T>
+std::vector<double> pad_values(const T* values, int num_points, int data_dim,
+                               int rank)
+{
+  std::vector<double> padded;
+  for (int p = 0; p < num_points; ++p)
+  {
+    const T* v = values + p * data_dim;
+    if (rank == 1 and data_dim == 2)
     {
       // Append 0.0 to 2D vectors to make them 3D
-      ss << values[*cell_offset] << "  " << values[*cell_offset + 1] << " "
-         << 0.0;
+      padded.insert(padded.end(), {std::real(v[0]), std::real(v[1]), 0.0});
     }
-    else if (rank == 2 && data_dim == 4)
+    else if (rank == 2 and data_dim == 4)
     {
       // Pad with 0.0 to 2D tensors to make them 3D
-      for (std::size_t i = 0; i < 2; i++)
-      {
-        ss << values[*cell_offset + 2 * i] << " ";
-        ss << values[*cell_offset + 2 * i + 1] << " ";
-        ss << 0.0 << " ";
-      }
-      ss << 0.0 << " ";
-      ss << 0.0 << " ";
-      ss << 0.0;
+      padded.insert(padded.end(), {std::real(v[0]), std::real(v[1]), 0.0,
+                                   std::real(v[2]), std::real(v[3]), 0.0,
+                                   0.0, 0.0, 0.0});
     }
     else
     {
       // Write all components
-      for (std::size_t i = 0; i < data_dim; i++)
-        ss << values[*cell_offset + i] << " ";
+      for (int i = 0; i < data_dim; ++i)
+        padded.push_back(std::real(v[i]));
+    }
+  }
+  return padded;
+}
+//----------------------------------------------------------------------------
+// Encode bytes in base64
+std::string base64_encode(const std::uint8_t* data, std::size_t size)
+{
+  static const char table[]
+      = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string encoded;
+  encoded.reserve(4 * ((size + 2) / 3));
+  for (std::size_t i = 0; i < size; i += 3)
+  {
+    const std::uint32_t b0 = data[i];
+    const std::uint32_t b1 = i + 1 < size ? data[i + 1] : 0;
+    const std::uint32_t b2 = i + 2 < size ? data[i + 2] : 0;
+    const std::uint32_t b = (b0 << 16) | (b1 << 8) | b2;
+    encoded.push_back(table[(b >> 18) & 63]);
+    encoded.push_back(table[(b >> 12) & 63]);
+    encoded.push_back(i + 1 < size ? table[(b >> 6) & 63] : '=');
+    encoded.push_back(i + 2 < size ? table[b & 63] : '=');
+  }
+  return encoded;
+}
+//----------------------------------------------------------------------------
+// Append the bytes of an array of 64-bit integers to a buffer
+void append_bytes(std::vector<std::uint8_t>& buffer,
+                  const std::vector<std::uint64_t>& values)
+{
+  const std::uint8_t* bytes
+      = reinterpret_cast<const std::uint8_t*>(values.data());
+  buffer.insert(buffer.end(), bytes, bytes + values.size() * 8);
+}
+//----------------------------------------------------------------------------
+// Block size (bytes) of compressed data arrays
+constexpr std::size_t compression_block_size = 32768;
+
+// Compress data in blocks with zlib. Returns the VTK compression
+// header (number of blocks, block size, size of the last block and the
+// compressed sizes of the blocks) and the compressed blocks.
+std::pair<std::vector<std::uint64_t>, std::vector<std::uint8_t>>
+compress_blocks([[maybe_unused]] const std::uint8_t* data,
+                [[maybe_unused]] std::size_t size)
+{
+#ifdef HAS_ZLIB
+  const std::size_t num_blocks
+      = (size + compression_block_size - 1) / compression_block_size;
+  std::vector<std::uint64_t> header
+      = {num_blocks, compression_block_size,
+         num_blocks > 0 ? size - (num_blocks - 1) * compression_block_size
+                        : 0};
+  std::vector<std::uint8_t> compressed;
+  for (std::size_t b = 0; b < num_blocks; ++b)
+  {
+    const std::size_t offset = b * compression_block_size;
+    const uLong block_size = std::min(compression_block_size, size - offset);
+    uLongf compressed_size = compressBound(block_size);
+    const std::size_t pos = compressed.size();
+    compressed.resize(pos + compressed_size);
+    if (compress2(compressed.data() + pos, &compressed_size, data + offset,
+                  block_size, Z_DEFAULT_COMPRESSION)
+        != Z_OK)
+    {
+      throw std::runtime_error("zlib compression of VTK data failed.");
     }
-    ss << "  ";
-    ++cell_offset;
+    compressed.resize(pos + compressed_size);
+    header.push_back(compressed_size);
   }
+  return {std::move(header), std::move(compressed)};
+#else
+  throw std::runtime_error("Compressed VTK output requires zlib.");
+#endif
+}
+//-----------------------------------------------------------------------------
+} // namespace
 
-  return ss.str();
+//----------------------------------------------------------------------------
+VTKWriter::VTKWriter(Encoding encoding, bool compress)
+    : _encoding(encoding), _compress(compress)
+{
+#ifndef HAS_ZLIB
+  if (_compress)
+    throw std::runtime_error("Compressed VTK output requires zlib.");
+#endif
 }
 //----------------------------------------------------------------------------
-// mesh::Mesh writer (ascii)
-void write_ascii_mesh(const mesh::Mesh& mesh, int cell_dim,
-                      std::string filename)
+void VTKWriter::write_mesh(const mesh::Mesh& mesh, std::size_t cell_dim,
+                           std::string filename)
 {
   const int num_cells = mesh.topology().index_map(cell_dim)->size_local();
 
@@ -115,7 +250,7 @@ void write_ascii_mesh(const mesh::Mesh& mesh, int cell_dim,
   const std::int8_t vtk_cell_type = get_vtk_cell_type(mesh, cell_dim);
 
   // Open file
-  std::ofstream file(filename.c_str(), std::ios::app);
+  std::ofstream file(filename.c_str(), std::ios::app | std::ios::binary);
   file.precision(16);
   if (!file.is_open())
   {
@@ -124,29 +259,22 @@ void write_ascii_mesh(const mesh::Mesh& mesh, int cell_dim,
 
   // Write vertex positions
   file << "<Points>" << std::endl;
-  file << R"(<DataArray  type="Float64"  NumberOfComponents="3"  format=")"
-       << "ascii"
-       << "\">";
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> points
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& points
       = mesh.geometry().x();
-  for (int i = 0; i < points.rows(); ++i)
-    file << points(i, 0) << " " << points(i, 1) << " " << points(i, 2) << "  ";
-  file << "</DataArray>" << std::endl << "</Points>" << std::endl;
+  write_data_array(file, R"(NumberOfComponents="3")",
+                   std::vector<double>(points.data(),
+                                       points.data() + points.size()));
+  file << "</Points>" << std::endl;
 
   // Write cell connectivity
-  file << "<Cells>" << std::endl;
-  file << R"(<DataArray  type="Int32"  Name="connectivity"  format=")"
-       << "ascii"
-       << "\">";
-
+  std::vector<std::int32_t> connectivity;
   int num_nodes;
   const int tdim = mesh.topology().dim();
   if (cell_dim == 0)
   {
     // Special case when only points should be visualized
     for (int i = 0; i < points.rows(); ++i)
-      file << i << " ";
-    file << "</DataArray>" << std::endl;
+      connectivity.push_back(i);
     num_nodes = 1;
   }
   else if (cell_dim == tdim)
@@ -159,104 +287,30 @@ void write_ascii_mesh(const mesh::Mesh& mesh, int cell_dim,
     num_nodes = x_dofmap.num_links(0);
 
     // Get map from VTK index i to DOLFIN index j
-    std::vector map = io::cells::transpose(
-        io::cells::perm_vtk(mesh.topology().cell_type(), num_nodes));
-
-    // TODO: Remove when when paraview issue 19433 is resolved
-    // (https://gitlab.kitware.com/paraview/paraview/issues/19433)
-    if (mesh.topology().cell_type() == dolfinx::mesh::CellType::hexahedron
-        and num_nodes == 27)
-    {
-      map = {0,  9, 12, 3,  1, 10, 13, 4,  18, 15, 21, 6,  19, 16,
-             22, 7, 2,  11, 5, 14, 8,  17, 20, 23, 24, 25, 26};
-    }
+    const std::vector<std::uint8_t> map
+        = vtk_node_map(mesh.topology().cell_type(), num_nodes);
 
-    for (int c = 0; c < x_dofmap.num_nodes(); ++c)
+    connectivity.reserve(num_cells * num_nodes);
+    for (int c = 0; c < num_cells; ++c)
     {
       auto x_dofs = x_dofmap.links(c);
       for (int i = 0; i < x_dofs.rows(); ++i)
-        file << x_dofs(map[i]) << " ";
-      file << " ";
+        connectivity.push_back(x_dofs(map[i]));
     }
-    file << "</DataArray>" << std::endl;
   }
   else
   {
     throw std::runtime_error(
         "VTK outout for mesh_entities for dim<tdim is not implemented yet.");
-
-    // Build a map from topology to geometry
-    auto c_to_v = mesh.topology().connectivity(tdim, 0);
-    assert(c_to_v);
-    auto map = mesh.topology().index_map(0);
-    assert(map);
-    const std::int32_t num_mesh_vertices
-        = map->size_local() + map->num_ghosts();
-
-    auto x_dofmap = mesh.geometry().dofmap();
-    std::vector<std::int32_t> vertex_to_node(num_mesh_vertices);
-    for (int c = 0; c < c_to_v->num_nodes(); ++c)
-    {
-      auto vertices = c_to_v->links(c);
-      auto x_dofs = x_dofmap.links(c);
-      for (int i = 0; i < vertices.rows(); ++i)
-        vertex_to_node[vertices[i]] = x_dofs(i);
-    }
-
-    const mesh::CellType e_type
-        = mesh::cell_entity_type(mesh.topology().cell_type(), cell_dim);
-    // FIXME : Need to implement re-mapping for higher order
-    // geometries (aka line segments). CoordinateDofs needs to be
-    // extended to have connections to facets.
-    const int num_vertices = mesh::num_cell_vertices(e_type);
-    const std::vector map_vtk
-        = io::cells::transpose(io::cells::perm_vtk(e_type, num_vertices));
-    auto e_to_v = mesh.topology().connectivity(cell_dim, 0);
-    assert(e_to_v);
-    for (int e = 0; e < e_to_v->num_nodes(); ++e)
-    {
-      auto vertices = e_to_v->links(e);
-      for (int i = 0; i < num_vertices; ++i)
-        file << vertex_to_node[vertices(map_vtk[i])] << " ";
-      file << " ";
-    }
-    file << "</DataArray>" << std::endl;
-    // Change number of nodes to fix offset
-    num_nodes = num_vertices;
   }
-
-  // Write offset into connectivity array for the end of each cell
-  file << R"(<DataArray  type="Int32"  Name="offsets"  format=")"
-       << "ascii"
-       << "\">";
-  for (int offsets = 1; offsets <= num_cells; offsets++)
-    file << offsets * num_nodes << " ";
-  file << "</DataArray>" << std::endl;
-
-  // Write cell type
-  file << R"(<DataArray  type="Int8"  Name="types"  format=")"
-       << "ascii"
-       << "\">";
-  for (int types = 0; types < num_cells; types++)
-    file << std::to_string(vtk_cell_type) << " ";
-  file << "</DataArray>" << std::endl;
-  file << "</Cells>" << std::endl;
+  write_cells(*this, file, connectivity, num_cells, num_nodes, vtk_cell_type);
 
   // Close file
   file.close();
 }
-//-----------------------------------------------------------------------------
-
-} // namespace
-
-//----------------------------------------------------------------------------
-void VTKWriter::write_mesh(const mesh::Mesh& mesh, std::size_t cell_dim,
-                           std::string filename)
-{
-  write_ascii_mesh(mesh, cell_dim, filename);
-}
 //----------------------------------------------------------------------------
-void VTKWriter::write_cell_data(const function::Function<PetscScalar>& u,
+template <typename T>
+void VTKWriter::write_cell_data(const function::Function<T>& u,
                                 std::string filename)
 {
   assert(u.function_space());
@@ -266,7 +320,6 @@ void VTKWriter::write_cell_data(const function::Function<PetscScalar>& u,
   assert(dofmap);
   const int tdim = mesh->topology().dim();
   const std::int32_t num_cells = mesh->topology().index_map(tdim)->size_local();
-  std::string encode_string = "ascii";
 
   // Get rank of function::Function
   const int rank = u.function_space()->element()->value_rank();
@@ -280,18 +333,17 @@ void VTKWriter::write_cell_data(const function::Function<PetscScalar>& u,
   const int data_dim = u.function_space()->element()->value_size();
 
   // Open file
-  std::ofstream fp(filename.c_str(), std::ios_base::app);
+  std::ofstream fp(filename.c_str(), std::ios_base::app | std::ios::binary);
   fp.precision(16);
 
   // Write headers
+  std::string attributes;
   if (rank == 0)
   {
     fp << "<CellData  Scalars=\""
        << "u"
        << "\"> " << std::endl;
-    fp << R"(<DataArray  type="Float64"  Name=")"
-       << "u"
-       << "\"  format=\"" << encode_string << "\">";
+    attributes = R"(Name="u")";
   }
   else if (rank == 1)
   {
@@ -304,9 +356,7 @@ void VTKWriter::write_cell_data(const function::Function<PetscScalar>& u,
     fp << "<CellData  Vectors=\""
        << "u"
        << "\"> " << std::endl;
-    fp << R"(<DataArray  type="Float64"  Name=")"
-       << "u"
-       << R"("  NumberOfComponents="3" format=")" << encode_string << "\">";
+    attributes = R"(Name="u"  NumberOfComponents="3")";
   }
   else if (rank == 2)
   {
@@ -318,41 +368,245 @@ void VTKWriter::write_cell_data(const function::Function<PetscScalar>& u,
     fp << "<CellData  Tensors=\""
        << "u"
        << "\"> " << std::endl;
-    fp << R"(<DataArray  type="Float64"  Name=")"
-       << "u"
-       << R"("  NumberOfComponents="9" format=")" << encode_string << "\">";
+    attributes = R"(Name="u"  NumberOfComponents="9")";
   }
 
-  // Allocate memory for function values at cell centres
-  const std::size_t size = num_cells * data_dim;
-
-  // Build lists of dofs and create map
-  std::vector<std::int32_t> dof_set;
-  std::vector<std::size_t> offset(size + 1);
-  auto cell_offset = offset.begin();
+  // Get the values of the (cell-wise constant) function on each cell
   assert(dofmap->element_dof_layout);
   const int num_dofs_cell = dofmap->element_dof_layout->num_dofs();
+  std::vector<T> values;
+  values.reserve(num_cells * num_dofs_cell);
+  const Eigen::Matrix<T, Eigen::Dynamic, 1>& _x = u.x()->array();
   for (int c = 0; c < num_cells; ++c)
   {
-    // Tabulate dofs
     auto dofs = dofmap->cell_dofs(c);
     for (int i = 0; i < num_dofs_cell; ++i)
-      dof_set.push_back(dofs[i]);
-
-    // Add local dimension to cell offset and increment
-    *(cell_offset + 1) = *(cell_offset) + num_dofs_cell;
-    ++cell_offset;
+      values.push_back(_x[dofs[i]]);
   }
 
-  // Get  values
-  std::vector<PetscScalar> values(dof_set.size());
-  const Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>& _x = u.x()->array();
-  for (std::size_t i = 0; i < dof_set.size(); ++i)
-    values[i] = _x[dof_set[i]];
-
   // Get cell data
-  fp << ascii_cell_data(*mesh, offset, values, data_dim, rank);
-  fp << "</DataArray> " << std::endl;
+  write_data_array(fp, attributes,
+                   pad_values(values.data(), num_cells, data_dim, rank));
   fp << "</CellData> " << std::endl;
 }
 //----------------------------------------------------------------------------
+template <typename T>
+void VTKWriter::write_point_data(const function::Function<T>& u,
+                                 std::string filename)
+{
+  const int rank = u.function_space()->element()->value_rank();
+
+  // Get number of components
+  const int dim = u.function_space()->element()->value_size();
+
+  // Open file
+  std::ofstream fp(filename.c_str(), std::ios_base::app | std::ios::binary);
+  fp.precision(16);
+
+  // Get function values at vertices
+  Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> values
+      = u.compute_point_values();
+
+  const std::string attributes = open_data(fp, "PointData", rank);
+  write_data_array(fp, attributes,
+                   pad_values(values.data(), values.rows(), dim, rank));
+  fp << "</PointData> " << std::endl;
+}
+//----------------------------------------------------------------------------
+void VTKWriter::write_dof_layout(const function::FunctionSpace& V,
+                                 std::string filename)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = V.mesh();
+  assert(mesh);
+  std::shared_ptr<const fem::FiniteElement> element = V.element();
+  assert(element);
+  std::shared_ptr<const fem::DofMap> dofmap = V.dofmap();
+  assert(dofmap);
+  const int tdim = mesh->topology().dim();
+  const int num_cells = mesh->topology().index_map(tdim)->size_local();
+
+  // Open file
+  std::ofstream file(filename.c_str(), std::ios::app | std::ios::binary);
+  file.precision(16);
+  if (!file.is_open())
+    throw std::runtime_error("Unable to open file:" + filename);
+
+  // Write the coordinates of the dofs of the scalar subspace (the nodes
+  // of the space), padded to 3D
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> x
+      = V.tabulate_scalar_subspace_dof_coordinates();
+  file << "<Points>" << std::endl;
+  write_data_array(file, R"(NumberOfComponents="3")",
+                   std::vector<double>(x.data(), x.data() + x.size()));
+  file << "</Points>" << std::endl;
+
+  // Node j of a cell is the node of cell dof ebs * j, where cell dof i
+  // is bs * links[i / bs] + i % bs
+  const int ebs = element->block_size();
+  const int num_nodes = element->space_dimension() / ebs;
+  const int bs = dofmap->bs();
+  const graph::AdjacencyList<std::int32_t>& list = dofmap->list_blocked();
+  const std::vector<std::uint8_t> map
+      = vtk_node_map(mesh->topology().cell_type(), num_nodes);
+  std::vector<std::int32_t> connectivity;
+  connectivity.reserve(num_cells * num_nodes);
+  for (int c = 0; c < num_cells; ++c)
+  {
+    auto links = list.links(c);
+    for (int i = 0; i < num_nodes; ++i)
+    {
+      const int dof = ebs * map[i];
+      connectivity.push_back((bs * links[dof / bs] + dof % bs) / ebs);
+    }
+  }
+  write_cells(*this, file, connectivity, num_cells, num_nodes,
+              get_vtk_cell_type(*mesh, tdim));
+}
+//----------------------------------------------------------------------------
+template <typename T>
+void VTKWriter::write_dof_data(const function::Function<T>& u,
+                               std::string filename)
+{
+  assert(u.function_space());
+  std::shared_ptr<const fem::FiniteElement> element
+      = u.function_space()->element();
+  assert(element);
+  const int rank = element->value_rank();
+  const int dim = element->value_size();
+
+  // Open file
+  std::ofstream fp(filename.c_str(), std::ios_base::app | std::ios::binary);
+  fp.precision(16);
+
+  // The values of the components at node j are the dofs dim * j, ...,
+  // dim * j + dim - 1
+  const Eigen::Matrix<T, Eigen::Dynamic, 1>& x = u.x()->array();
+  const std::string attributes = open_data(fp, "PointData", rank);
+  write_data_array(fp, attributes,
+                   pad_values(x.data(), x.rows() / dim, dim, rank));
+  fp << "</PointData> " << std::endl;
+}
+//----------------------------------------------------------------------------
+void VTKWriter::write_data_array(std::ostream& file,
+                                 const std::string& attributes,
+                                 const std::vector<double>& data)
+{
+  _write_data_array(file, "Float64", attributes, data);
+}
+//----------------------------------------------------------------------------
+void VTKWriter::write_data_array(std::ostream& file,
+                                 const std::string& attributes,
+                                 const std::vector<std::int32_t>& data)
+{
+  _write_data_array(file, "Int32", attributes, data);
+}
+//----------------------------------------------------------------------------
+void VTKWriter::write_data_array(std::ostream& file,
+                                 const std::string& attributes,
+                                 const std::vector<std::int8_t>& data)
+{
+  _write_data_array(file, "Int8", attributes, data);
+}
+//----------------------------------------------------------------------------
+template <typename T>
+void VTKWriter::_write_data_array(std::ostream& file, const std::string& type,
+                                  const std::string& attributes,
+                                  const std::vector<T>& data)
+{
+  file << "<DataArray  type=\"" << type << "\"  " << attributes;
+  if (_encoding == Encoding::ascii)
+  {
+    file << "  format=\"ascii\">";
+    for (const T& v : data)
+    {
+      if constexpr (std::is_same<T, std::int8_t>::value)
+        file << static_cast<int>(v) << " ";
+      else
+        file << v << " ";
+    }
+    file << "</DataArray>" << std::endl;
+    return;
+  }
+
+  // Binary data is written to the appended data section, with the
+  // offset of the array in the section
+  file << "  format=\"appended\"  offset=\"" << _appended.size() << "\"/>"
+       << std::endl;
+
+  const std::uint8_t* bytes
+      = reinterpret_cast<const std::uint8_t*>(data.data());
+  const std::size_t size = data.size() * sizeof(T);
+  std::vector<std::uint8_t> header, block;
+  if (_compress)
+  {
+    auto [compression_header, compressed] = compress_blocks(bytes, size);
+    append_bytes(header, compression_header);
+    block = std::move(compressed);
+  }
+  else
+  {
+    append_bytes(header, {size});
+    block.assign(bytes, bytes + size);
+  }
+
+  if (_encoding == Encoding::raw)
+  {
+    _appended.append(header.begin(), header.end());
+    _appended.append(block.begin(), block.end());
+  }
+  else if (_compress)
+  {
+    // The header and the compressed blocks are encoded separately
+    _appended += base64_encode(header.data(), header.size());
+    _appended += base64_encode(block.data(), block.size());
+  }
+  else
+  {
+    header.insert(header.end(), block.begin(), block.end());
+    _appended += base64_encode(header.data(), header.size());
+  }
+}
+//----------------------------------------------------------------------------
+std::string VTKWriter::file_attributes() const
+{
+  if (_encoding == Encoding::ascii)
+    return R"(version="0.1")";
+
+  const std::uint16_t one = 1;
+  const bool little_endian = *reinterpret_cast<const std::uint8_t*>(&one) == 1;
+  std::string attributes = R"(version="1.0"  byte_order=")";
+  attributes += little_endian ? "LittleEndian" : "BigEndian";
+  attributes += R"("  header_type="UInt64")";
+  if (_compress)
+    attributes += R"(  compressor="vtkZLibDataCompressor")";
+  return attributes;
+}
+//----------------------------------------------------------------------------
+void VTKWriter::write_appended_data(std::ostream& file)
+{
+  if (_encoding == Encoding::ascii)
+    return;
+
+  file << "<AppendedData  encoding=\""
+       << (_encoding == Encoding::raw ? "raw" : "base64") << "\">"
+       << std::endl
+       << "_";
+  file.write(_appended.data(), _appended.size());
+  file << std::endl << "</AppendedData>" << std::endl;
+  _appended.clear();
+}
+//----------------------------------------------------------------------------
+// Explicit instantiations of the function data writers
+/// @cond
+#define INSTANTIATE_WRITERS(T)                                                 \
+  template void VTKWriter::write_cell_data(const function::Function<T>&,       \
+                                           std::string);                       \
+  template void VTKWriter::write_point_data(const function::Function<T>&,      \
+                                            std::string);                      \
+  template void VTKWriter::write_dof_data(const function::Function<T>&,        \
+                                          std::string);
+INSTANTIATE_WRITERS(double)
+INSTANTIATE_WRITERS(std::complex<double>)
+#undef INSTANTIATE_WRITERS
+/// @endcond
+//----------------------------------------------------------------------------
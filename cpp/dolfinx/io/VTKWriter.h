@@ -7,6 +7,7 @@
 #pragma once
 
 #include <cstdint>
+#include <ostream>
 #include <petscsys.h>
 #include <string>
 #include <vector>
@@ -17,6 +18,7 @@ namespace function
 {
 template <typename T>
 class Function;
+class FunctionSpace;
 }
 namespace mesh
 {
@@ -28,16 +30,106 @@ namespace io
 
 /// Write VTK mesh::Mesh representation
 
+/// ASCII data arrays are written inline in the DataArray elements of a
+/// .vtu file. Binary (raw or base64 encoded, optionally zlib
+/// compressed) data arrays are collected by the writer and written to
+/// the AppendedData section at the end of the file (see
+/// write_appended_data).
+
 class VTKWriter
 {
 public:
+  /// Encoding of the data arrays
+  enum class Encoding
+  {
+    ascii,
+    base64,
+    raw
+  };
+
+  /// Create a writer
+  /// @param[in] encoding The encoding of the data arrays
+  /// @param[in] compress Compress binary data arrays with zlib
+  explicit VTKWriter(Encoding encoding = Encoding::ascii,
+                     bool compress = false);
+
   /// mesh::Mesh writer
-  static void write_mesh(const mesh::Mesh& mesh, std::size_t cell_dim,
-                         std::string file);
+  void write_mesh(const mesh::Mesh& mesh, std::size_t cell_dim,
+                  std::string file);
+
+  /// Cell data writer. The real part of complex values is written.
+  /// Instantiated for double and std::complex<double>.
+  template <typename T>
+  void write_cell_data(const function::Function<T>& u, std::string file);
+
+  /// Point data writer (values at the geometry nodes). The real part
+  /// of complex values is written. Instantiated for double and
+  /// std::complex<double>.
+  template <typename T>
+  void write_point_data(const function::Function<T>& u, std::string file);
+
+  /// Write the Points and Cells of the dof layout of a (discontinuous)
+  /// Lagrange function space, i.e. the points are the dofs of the
+  /// scalar subspace (owned and ghost) and the cells are VTK Lagrange
+  /// cells of the degree of the space
+  /// @param[in] V The function space
+  /// @param[in] file The name of the .vtu file
+  void write_dof_layout(const function::FunctionSpace& V, std::string file);
+
+  /// Point data writer for the dof layout (see write_dof_layout). The
+  /// values are the expansion coefficients of the function, without
+  /// interpolation (real part for complex values). Instantiated for
+  /// double and std::complex<double>.
+  /// @param[in] u The function
+  /// @param[in] file The name of the .vtu file
+  template <typename T>
+  void write_dof_data(const function::Function<T>& u, std::string file);
+
+  /// Write a DataArray element
+  /// @param[in] file The stream of the .vtu file
+  /// @param[in] attributes Attributes of the element (other than
+  ///   type and format), e.g. `Name="u" NumberOfComponents="3"`
+  /// @param[in] data The values
+  void write_data_array(std::ostream& file, const std::string& attributes,
+                        const std::vector<double>& data);
+
+  /// Write a DataArray element
+  /// @param[in] file The stream of the .vtu file
+  /// @param[in] attributes Attributes of the element (other than
+  ///   type and format)
+  /// @param[in] data The values
+  void write_data_array(std::ostream& file, const std::string& attributes,
+                        const std::vector<std::int32_t>& data);
+
+  /// Write a DataArray element
+  /// @param[in] file The stream of the .vtu file
+  /// @param[in] attributes Attributes of the element (other than
+  ///   type and format)
+  /// @param[in] data The values
+  void write_data_array(std::ostream& file, const std::string& attributes,
+                        const std::vector<std::int8_t>& data);
+
+  /// Attributes of the VTKFile element for the encoding (version, byte
+  /// order, header type and compressor)
+  std::string file_attributes() const;
+
+  /// Write the AppendedData section with the binary data arrays
+  /// written since the last call, if any, and clear the data
+  /// @param[in] file The stream of the .vtu file
+  void write_appended_data(std::ostream& file);
+
+private:
+  // Write a DataArray element of a VTK type
+  template <typename T>
+  void _write_data_array(std::ostream& file, const std::string& type,
+                         const std::string& attributes,
+                         const std::vector<T>& data);
+
+  Encoding _encoding;
+  bool _compress;
 
-  /// Cell data writer
-  static void write_cell_data(const function::Function<PetscScalar>& u,
-                              std::string file);
+  // Encoded binary data arrays of the AppendedData section
+  std::string _appended;
 };
 } // namespace io
 } // namespace dolfinx
@@ -6,6 +6,7 @@
 
 #include "XDMFFile.h"
 #include "cells.h"
+#include "partition_cache.h"
 #include "pugixml.hpp"
 #include "xdmf_function.h"
 #include "xdmf_mesh.h"
@@ -21,15 +22,62 @@
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
 #include <dolfinx/mesh/utils.h>
+#include <fstream>
 
 using namespace dolfinx;
 using namespace dolfinx::io;
 
+namespace
+{
+// Closing tags that follow the last time step of a time series Grid
+// that is the last Grid of the domain, as written by
+// pugi::xml_document::save_file with an indent of two spaces
+const std::string series_tail = "    </Grid>\n  </Domain>\n</Xdmf>\n";
+
+//-----------------------------------------------------------------------------
+// Get the offset of the closing tags of the last time series in a
+// file, or -1 if the file does not end with them
+std::int64_t find_series_end(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+  const std::int64_t size = file.tellg();
+  if (!file or size < (std::int64_t)series_tail.size())
+    return -1;
+
+  std::string tail(series_tail.size(), ' ');
+  file.seekg(size - series_tail.size());
+  file.read(&tail[0], tail.size());
+  if (!file or tail != series_tail)
+    return -1;
+  return size - series_tail.size();
+}
+//-----------------------------------------------------------------------------
+// Write a time step Grid to the end of a time series at offset pos of
+// a file, followed by the closing tags. Returns the new offset of the
+// closing tags, or -1 on failure.
+std::int64_t append_series_step(const std::string& filename,
+                                std::int64_t pos, const pugi::xml_node& grid)
+{
+  std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+  if (!file)
+    return -1;
+  file.seekp(pos);
+  grid.print(file, "  ", pugi::format_default, pugi::encoding_auto, 3);
+  const std::int64_t end = file.tellp();
+  file << series_tail;
+  file.flush();
+  return file ? end : -1;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 //-----------------------------------------------------------------------------
 XDMFFile::XDMFFile(MPI_Comm comm, const std::string filename,
-                   const std::string file_mode, const Encoding encoding)
+                   const std::string file_mode, const Encoding encoding,
+                   const HDF5Properties& properties)
     : _mpi_comm(comm), _filename(filename), _file_mode(file_mode),
-      _xml_doc(new pugi::xml_document), _encoding(encoding)
+      _xml_doc(new pugi::xml_document), _encoding(encoding),
+      _h5_properties(properties)
 {
   // Handle HDF5 and XDMF files with the file mode. At the end of this
   // we will have _hdf5_file and _xml_doc both pointing to a valid and
@@ -44,7 +92,7 @@ XDMFFile::XDMFFile(MPI_Comm comm, const std::string filename,
     const std::string hdf5_filename = xdmf_utils::get_hdf5_filename(_filename);
     const bool mpi_io = MPI::size(_mpi_comm.comm()) > 1 ? true : false;
     _h5_id = HDF5Interface::open_file(_mpi_comm.comm(), hdf5_filename,
-                                      file_mode, mpi_io);
+                                      file_mode, mpi_io, _h5_properties);
     assert(_h5_id > 0);
     LOG(INFO) << "Opened HDF5 file with id \"" << _h5_id << "\"";
   }
@@ -125,21 +173,25 @@ void XDMFFile::close()
 //-----------------------------------------------------------------------------
 void XDMFFile::write_mesh(const mesh::Mesh& mesh, const std::string xpath)
 {
+  restore_xml();
   pugi::xml_node node = _xml_doc->select_node(xpath.c_str()).node();
   if (!node)
     throw std::runtime_error("XML node '" + xpath + "' not found.");
 
   // Add the mesh Grid to the domain
-  xdmf_mesh::add_mesh(_mpi_comm.comm(), node, _h5_id, mesh, mesh.name);
+  xdmf_mesh::add_mesh(_mpi_comm.comm(), node, _h5_id, mesh, mesh.name,
+                      _h5_properties);
 
   // Save XML file (on process 0 only)
   if (MPI::rank(_mpi_comm.comm()) == 0)
     _xml_doc->save_file(_filename.c_str(), "  ");
+  _series_name.clear();
 }
 //-----------------------------------------------------------------------------
 void XDMFFile::write_geometry(const mesh::Geometry& geometry,
                               const std::string name, const std::string xpath)
 {
+  restore_xml();
   pugi::xml_node node = _xml_doc->select_node(xpath.c_str()).node();
   if (!node)
     throw std::runtime_error("XML node '" + xpath + "' not found.");
@@ -152,28 +204,60 @@ void XDMFFile::write_geometry(const mesh::Geometry& geometry,
 
   const std::string path_prefix = "/Geometry/" + name;
   xdmf_mesh::add_geometry_data(_mpi_comm.comm(), grid_node, _h5_id, path_prefix,
-                               geometry);
+                               geometry, _h5_properties);
 
   // Save XML file (on process 0 only)
   if (MPI::rank(_mpi_comm.comm()) == 0)
     _xml_doc->save_file(_filename.c_str(), "  ");
+  _series_name.clear();
 }
 //-----------------------------------------------------------------------------
 mesh::Mesh XDMFFile::read_mesh(const fem::CoordinateElement& element,
                                const mesh::GhostMode& mode,
                                const std::string name,
-                               const std::string xpath) const
+                               const std::string xpath,
+                               const std::string partition_file) const
 {
-  // Read mesh data
-  const Eigen::Array<std::int64_t, Eigen::Dynamic, Eigen::Dynamic,
-                     Eigen::RowMajor>
-      cells = XDMFFile::read_topology_data(name, xpath);
+  // Read topology data
+  graph::AdjacencyList<std::int64_t> cells_adj(
+      XDMFFile::read_topology_data(name, xpath));
+
+  if (partition_file.empty())
+  {
+    pugi::xml_node node = _xml_doc->select_node(xpath.c_str()).node();
+    assert(node);
+    pugi::xml_node grid_node
+        = node.select_node(("Grid[@Name='" + name + "']").c_str()).node();
+    assert(grid_node);
+
+    // Read the nodes of the distributed cells directly from the HDF5
+    // file, instead of reading all nodes and distributing them
+    const mesh::NodeFetcher fetch_nodes
+        = xdmf_mesh::geometry_reader(_h5_id, grid_node);
+    if (fetch_nodes)
+    {
+      mesh::Mesh mesh = mesh::create_mesh_fetching_nodes(
+          _mpi_comm.comm(), cells_adj, element, fetch_nodes, mode);
+      mesh.name = name;
+      return mesh;
+    }
+
+    const auto x = XDMFFile::read_geometry_data(name, xpath);
+    mesh::Mesh mesh
+        = mesh::create_mesh(_mpi_comm.comm(), cells_adj, element, x, mode);
+    mesh.name = name;
+    return mesh;
+  }
+
+  // The partition cache is keyed by a hash of the input geometry
   const auto x = XDMFFile::read_geometry_data(name, xpath);
 
-  // Create mesh
-  graph::AdjacencyList<std::int64_t> cells_adj(cells);
+  // Reuse the stored cell partition, or compute and store it
+  const graph::AdjacencyList<std::int32_t> dest
+      = partition_cache::cell_destinations(_mpi_comm.comm(), partition_file,
+                                           cells_adj, element, x);
   mesh::Mesh mesh
-      = mesh::create_mesh(_mpi_comm.comm(), cells_adj, element, x, mode);
+      = mesh::create_mesh(_mpi_comm.comm(), cells_adj, element, x, mode, dest);
   mesh.name = name;
   return mesh;
 }
@@ -210,9 +294,30 @@ XDMFFile::read_geometry_data(const std::string name,
   return xdmf_mesh::read_geometry_data(_mpi_comm.comm(), _h5_id, grid_node);
 }
 //-----------------------------------------------------------------------------
-void XDMFFile::write_function(const function::Function<PetscScalar>& function,
+void XDMFFile::write_function(const function::Function<double>& function,
                               const double t, const std::string mesh_xpath)
 {
+  _write_function(function, t, mesh_xpath);
+}
+//-----------------------------------------------------------------------------
+void XDMFFile::write_function(
+    const function::Function<std::complex<double>>& function, const double t,
+    const std::string mesh_xpath)
+{
+  _write_function(function, t, mesh_xpath);
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void XDMFFile::_write_function(const function::Function<T>& function,
+                               const double t, const std::string mesh_xpath)
+{
+  // If the time series was the last Grid written, the time step is
+  // appended to the end of the file. Otherwise the whole document is
+  // written.
+  const bool append = !_series_name.empty() and _series_name == function.name;
+  if (!append)
+    restore_xml();
+
   const std::string timegrid_xpath
       = "/Xdmf/Domain/Grid[@GridType='Collection'][@Name='" + function.name
         + "']";
@@ -253,17 +358,53 @@ void XDMFFile::write_function(const function::Function<PetscScalar>& function,
   assert(time_node);
 
   // Add the mesh Grid to the domain
-  xdmf_function::add_function(_mpi_comm.comm(), function, t, grid_node, _h5_id);
+  xdmf_function::add_function(_mpi_comm.comm(), function, t, grid_node, _h5_id,
+                              _h5_properties);
+
+  pugi::xml_node domain_node = _xml_doc->select_node("/Xdmf/Domain").node();
+  const bool last = domain_node.last_child() == timegrid_node;
 
   // Save XML file (on process 0 only)
+  bool prune = last;
   if (MPI::rank(_mpi_comm.comm()) == 0)
-    _xml_doc->save_file(_filename.c_str(), "  ");
+  {
+    if (append and _series_end >= 0)
+    {
+      _series_end = append_series_step(_filename, _series_end, grid_node);
+      if (_series_end < 0)
+        throw std::runtime_error("Failed to append time step to XDMF file.");
+    }
+    else
+    {
+      _xml_doc->save_file(_filename.c_str(), "  ");
+      _series_end = last ? find_series_end(_filename) : -1;
+    }
+
+    // Written time steps can only be removed from the document if the
+    // next step can be appended to the file
+    prune = _series_end >= 0;
+    _xml_pruned = _xml_pruned or prune;
+  }
+
+  // Remove the written time steps from the document to keep its size
+  // bounded
+  if (prune)
+  {
+    while (pugi::xml_node step = timegrid_node.child("Grid"))
+      timegrid_node.remove_child(step);
+  }
+
+  if (last)
+    _series_name = function.name;
+  else
+    _series_name.clear();
 }
 //-----------------------------------------------------------------------------
 void XDMFFile::write_meshtags(const mesh::MeshTags<std::int32_t>& meshtags,
                               const std::string geometry_xpath,
                               const std::string xpath)
 {
+  restore_xml();
   pugi::xml_node node = _xml_doc->select_node(xpath.c_str()).node();
   if (!node)
     throw std::runtime_error("XML node '" + xpath + "' not found.");
@@ -278,11 +419,12 @@ void XDMFFile::write_meshtags(const mesh::MeshTags<std::int32_t>& meshtags,
   geo_ref_node.append_attribute("xpointer") = geo_ref_path.c_str();
   assert(geo_ref_node);
   xdmf_meshtags::add_meshtags(_mpi_comm.comm(), meshtags, grid_node, _h5_id,
-                              meshtags.name);
+                              meshtags.name, _h5_properties);
 
   // Save XML file (on process 0 only)
   if (MPI::rank(_mpi_comm.comm()) == 0)
     _xml_doc->save_file(_filename.c_str(), "  ");
+  _series_name.clear();
 }
 //-----------------------------------------------------------------------------
 mesh::MeshTags<std::int32_t>
@@ -357,6 +499,7 @@ void XDMFFile::write_information(const std::string name,
                                  const std::string value,
                                  const std::string xpath)
 {
+  restore_xml();
   pugi::xml_node node = _xml_doc->select_node(xpath.c_str()).node();
   if (!node)
     throw std::runtime_error("XML node '" + xpath + "' not found.");
@@ -369,6 +512,7 @@ void XDMFFile::write_information(const std::string name,
   // Save XML file (on process 0 only)
   if (MPI::rank(_mpi_comm.comm()) == 0)
     _xml_doc->save_file(_filename.c_str(), "  ");
+  _series_name.clear();
 }
 //-----------------------------------------------------------------------------
 std::string XDMFFile::read_information(const std::string name,
@@ -390,3 +534,16 @@ std::string XDMFFile::read_information(const std::string name,
 //-----------------------------------------------------------------------------
 MPI_Comm XDMFFile::comm() const { return _mpi_comm.comm(); }
 //-----------------------------------------------------------------------------
+void XDMFFile::restore_xml()
+{
+  if (!_xml_pruned)
+    return;
+
+  pugi::xml_parse_result result = _xml_doc->load_file(
+      _filename.c_str(), pugi::parse_default | pugi::parse_doctype);
+  if (!result)
+    throw std::runtime_error("Failed to re-read XDMF file '" + _filename
+                             + "'.");
+  _xml_pruned = false;
+}
+//-----------------------------------------------------------------------------
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "HDF5Interface.h"
+#include <complex>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/mesh/cell_types.h>
 #include <memory>
@@ -54,6 +55,13 @@ namespace io
 ///
 /// XDMF is not suitable for higher order geometries, as their currently
 /// only supports 1st and 2nd order geometries.
+///
+/// Time series (write_function) are written incrementally: when the
+/// Grid collection of a function is the last Grid of the domain, each
+/// new time step is appended to the end of the XML file, before the
+/// closing tags, instead of re-writing the whole document, and the
+/// step is removed from the document held in memory. The document is
+/// re-read from file before other objects are written.
 
 class XDMFFile
 {
@@ -69,9 +77,17 @@ public:
   static const Encoding default_encoding = Encoding::HDF5;
 
   /// Constructor
+  /// @param[in] comm The MPI communicator
+  /// @param[in] filename Name of the XDMF file
+  /// @param[in] file_mode The file mode (r, w, a)
+  /// @param[in] encoding The encoding of the data
+  /// @param[in] properties Properties of the HDF5 file and the datasets
+  ///   written to it (chunking, compression, alignment and MPI-IO
+  ///   hints)
   XDMFFile(MPI_Comm comm, const std::string filename,
            const std::string file_mode,
-           const Encoding encoding = default_encoding);
+           const Encoding encoding = default_encoding,
+           const HDF5Properties& properties = {});
 
   /// Destructor
   ~XDMFFile();
@@ -96,17 +112,26 @@ public:
   void write_geometry(const mesh::Geometry& geometry, const std::string name,
                       const std::string xpath = "/Xdmf/Domain");
 
-  /// Read in Mesh
+  /// Read in Mesh. Each process reads a block of cells, and the cells
+  /// are partitioned and distributed. The geometry nodes stored in HDF5
+  /// are then read by each process for its cells only, instead of being
+  /// read in blocks and distributed.
   /// @param[in] element Element that describes the geometry of a cell
   /// @param[in] mode The type of ghosting/halo to use for the mesh when
   ///   distributed in parallel
   /// @param[in] name
   /// @param[in] xpath XPath where Mesh Grid is located
+  /// @param[in] partition_file If not empty, the name of a HDF5 file
+  ///   that stores the cell partition (see io::partition_cache). If the
+  ///   file holds a partition of the same mesh data for the same number
+  ///   of processes, it is used and no partitioner is called. Otherwise
+  ///   the computed partition is written to the file.
   /// @return A Mesh distributed on the same communicator as the
   ///   XDMFFile
   mesh::Mesh read_mesh(const fem::CoordinateElement& element,
                        const mesh::GhostMode& mode, const std::string name,
-                       const std::string xpath = "/Xdmf/Domain") const;
+                       const std::string xpath = "/Xdmf/Domain",
+                       const std::string partition_file = "") const;
 
   /// Read Topology data for Mesh
   /// @param[in] name Name of the mesh (Grid)
@@ -136,11 +161,23 @@ public:
   /// @param[in] t The time stamp to associate with the Function
   /// @param[in] mesh_xpath XPath for a Grid under which Function will
   ///   be inserted
-  void write_function(const function::Function<PetscScalar>& function,
+  void write_function(const function::Function<double>& function,
                       const double t,
                       const std::string mesh_xpath
                       = "/Xdmf/Domain/Grid[@GridType='Uniform'][1]");
 
+  /// Write complex Function, as two attributes with the real and the
+  /// imaginary parts
+  /// @param[in] function The Function to write to file
+  /// @param[in] t The time stamp to associate with the Function
+  /// @param[in] mesh_xpath XPath for a Grid under which Function will
+  ///   be inserted
+  void write_function(
+      const function::Function<std::complex<double>>& function,
+      const double t,
+      const std::string mesh_xpath
+      = "/Xdmf/Domain/Grid[@GridType='Uniform'][1]");
+
   /// Write MeshTags
   /// @param[in] meshtags
   /// @param[in] geometry_xpath XPath where Geometry is already stored
@@ -177,6 +214,11 @@ public:
   MPI_Comm comm() const;
 
 private:
+  // Write Function of real or complex values
+  template <typename T>
+  void _write_function(const function::Function<T>& function, const double t,
+                       const std::string mesh_xpath);
+
   // MPI communicator
   dolfinx::MPI::Comm _mpi_comm;
 
@@ -194,6 +236,22 @@ private:
   std::unique_ptr<pugi::xml_document> _xml_doc;
 
   Encoding _encoding;
+
+  // Properties of the HDF5 file and datasets
+  HDF5Properties _h5_properties;
+
+  // Re-read the XML document from file if time steps have been removed
+  // from it (process 0 only)
+  void restore_xml();
+
+  // Name of the time series (Grid collection) whose closing tag is at
+  // the end of the XML file, and the offset of the closing tags in the
+  // file (process 0 only, -1 if unknown)
+  std::string _series_name;
+  std::int64_t _series_end = -1;
+
+  // True if written time steps have been removed from _xml_doc
+  bool _xml_pruned = false;
 };
 
 } // namespace io
@@ -0,0 +1,449 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "binary_mesh.h"
+#include <algorithm>
+#include <cstring>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/common/log.h>
+#include <dolfinx/fem/CoordinateElement.h>
+#include <dolfinx/fem/ElementDofLayout.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Topology.h>
+#include <fcntl.h>
+#include <map>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace dolfinx;
+using namespace dolfinx::io;
+
+namespace
+{
+// File identification (the bytes of "DLFXMESH") and format version
+constexpr char magic[8] = {'D', 'L', 'F', 'X', 'M', 'E', 'S', 'H'};
+constexpr std::int64_t version = 1;
+
+// Number of 64-bit values of the header
+constexpr int header_size = 9;
+
+// Positions of the values in the header
+enum Header : int
+{
+  cell_type_pos = 2,
+  gdim_pos,
+  num_nodes_per_cell_pos,
+  num_parts_pos,
+  num_cells_pos,
+  num_nodes_pos,
+  ghosts_pos
+};
+
+// Byte offsets of the arrays in a file
+struct Layout
+{
+  std::size_t cells, x, dest_offsets, dest, end;
+};
+//-----------------------------------------------------------------------------
+Layout compute_layout(std::int64_t num_parts, std::int64_t num_cells,
+                      std::int64_t num_nodes_per_cell, std::int64_t num_nodes,
+                      std::int64_t gdim, std::int64_t num_dest)
+{
+  Layout layout;
+  layout.cells = sizeof(std::int64_t) * (header_size + 2 * (num_parts + 1));
+  layout.x = layout.cells
+             + sizeof(std::int64_t) * num_cells * num_nodes_per_cell;
+  layout.dest_offsets = layout.x + sizeof(double) * num_nodes * gdim;
+  layout.dest = layout.dest_offsets + sizeof(std::int64_t) * (num_cells + 1);
+  layout.end = layout.dest + sizeof(std::int32_t) * num_dest;
+  return layout;
+}
+//-----------------------------------------------------------------------------
+// Write bytes at an offset of a file (not collective). Large blocks are
+// written in pieces, since MPI counts are int.
+void write_at(MPI_File fh, std::size_t offset, const void* data,
+              std::size_t bytes)
+{
+  constexpr std::size_t max_bytes = 1 << 30;
+  const char* p = static_cast<const char*>(data);
+  while (bytes > 0)
+  {
+    const std::size_t n = std::min(bytes, max_bytes);
+    if (MPI_File_write_at(fh, offset, p, n, MPI_BYTE, MPI_STATUS_IGNORE)
+        != MPI_SUCCESS)
+    {
+      throw std::runtime_error("Writing binary mesh file failed.");
+    }
+    offset += n;
+    p += n;
+    bytes -= n;
+  }
+}
+//-----------------------------------------------------------------------------
+// Compute the offsets of the blocks of the processes (exclusive prefix
+// sums, with the total as last value)
+std::vector<std::int64_t> block_offsets(MPI_Comm comm, std::int64_t n)
+{
+  std::vector<std::int64_t> offsets(dolfinx::MPI::size(comm) + 1, 0);
+  MPI_Allgather(&n, 1, MPI_INT64_T, offsets.data() + 1, 1, MPI_INT64_T, comm);
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  return offsets;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+binary_mesh::MappedFile::MappedFile(const std::string& filename)
+{
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Cannot open binary mesh file " + filename);
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+  {
+    close(fd);
+    throw std::runtime_error("Cannot open binary mesh file " + filename);
+  }
+  _size = st.st_size;
+  if (_size < header_size * sizeof(std::int64_t))
+  {
+    close(fd);
+    throw std::runtime_error("File " + filename
+                             + " is not a binary mesh file.");
+  }
+
+  void* data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    throw std::runtime_error("Cannot map binary mesh file " + filename);
+  _data = static_cast<const char*>(data);
+  _header = reinterpret_cast<const std::int64_t*>(_data);
+
+  if (std::memcmp(_data, magic, sizeof(magic)) != 0 or _header[1] != version)
+  {
+    munmap(const_cast<char*>(_data), _size);
+    throw std::runtime_error("File " + filename
+                             + " is not a binary mesh file (version "
+                             + std::to_string(version) + ").");
+  }
+
+  // Check the size of the arrays
+  const std::int64_t num_parts = _header[num_parts_pos];
+  const std::int64_t num_cells = _header[num_cells_pos];
+  std::size_t end = sizeof(std::int64_t) * (header_size + 2 * (num_parts + 1));
+  Layout layout{};
+  if (num_parts > 0 and end <= _size)
+  {
+    layout = compute_layout(num_parts, num_cells,
+                            _header[num_nodes_per_cell_pos],
+                            _header[num_nodes_pos], _header[gdim_pos], 0);
+    end = layout.dest;
+  }
+  if (num_parts <= 0 or end > _size)
+  {
+    munmap(const_cast<char*>(_data), _size);
+    throw std::runtime_error("Binary mesh file " + filename
+                             + " is truncated.");
+  }
+  const std::int64_t num_dest = reinterpret_cast<const std::int64_t*>(
+      _data + layout.dest_offsets)[num_cells];
+  if (compute_layout(num_parts, num_cells, _header[num_nodes_per_cell_pos],
+                     _header[num_nodes_pos], _header[gdim_pos], num_dest)
+          .end
+      > _size)
+  {
+    munmap(const_cast<char*>(_data), _size);
+    throw std::runtime_error("Binary mesh file " + filename
+                             + " is truncated.");
+  }
+
+  _cells = layout.cells;
+  _x = layout.x;
+  _dest_offsets = layout.dest_offsets;
+  _dest = layout.dest;
+}
+//-----------------------------------------------------------------------------
+binary_mesh::MappedFile::~MappedFile()
+{
+  munmap(const_cast<char*>(_data), _size);
+}
+//-----------------------------------------------------------------------------
+mesh::CellType binary_mesh::MappedFile::cell_type() const
+{
+  return static_cast<mesh::CellType>(_header[cell_type_pos]);
+}
+//-----------------------------------------------------------------------------
+int binary_mesh::MappedFile::gdim() const { return _header[gdim_pos]; }
+//-----------------------------------------------------------------------------
+int binary_mesh::MappedFile::num_parts() const
+{
+  return _header[num_parts_pos];
+}
+//-----------------------------------------------------------------------------
+bool binary_mesh::MappedFile::has_ghosts() const
+{
+  return _header[ghosts_pos] != 0;
+}
+//-----------------------------------------------------------------------------
+std::array<std::int64_t, 2>
+binary_mesh::MappedFile::cell_range(int part) const
+{
+  if (part < 0 or part >= num_parts())
+    throw std::runtime_error("Part of binary mesh file is out of range.");
+  const std::int64_t* offsets = _header + header_size;
+  return {offsets[part], offsets[part + 1]};
+}
+//-----------------------------------------------------------------------------
+std::array<std::int64_t, 2>
+binary_mesh::MappedFile::node_range(int part) const
+{
+  if (part < 0 or part >= num_parts())
+    throw std::runtime_error("Part of binary mesh file is out of range.");
+  const std::int64_t* offsets = _header + header_size + num_parts() + 1;
+  return {offsets[part], offsets[part + 1]};
+}
+//-----------------------------------------------------------------------------
+Eigen::Map<const Eigen::Array<std::int64_t, Eigen::Dynamic, Eigen::Dynamic,
+                              Eigen::RowMajor>>
+binary_mesh::MappedFile::cells() const
+{
+  return Eigen::Map<const Eigen::Array<std::int64_t, Eigen::Dynamic,
+                                       Eigen::Dynamic, Eigen::RowMajor>>(
+      reinterpret_cast<const std::int64_t*>(_data + _cells),
+      _header[num_cells_pos], _header[num_nodes_per_cell_pos]);
+}
+//-----------------------------------------------------------------------------
+Eigen::Map<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                              Eigen::RowMajor>>
+binary_mesh::MappedFile::x() const
+{
+  return Eigen::Map<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                       Eigen::RowMajor>>(
+      reinterpret_cast<const double*>(_data + _x), _header[num_nodes_pos],
+      _header[gdim_pos]);
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> binary_mesh::MappedFile::destinations(
+    const std::array<std::int64_t, 2>& range) const
+{
+  if (range[0] < 0 or range[1] < range[0]
+      or range[1] > _header[num_cells_pos])
+  {
+    throw std::runtime_error("Cells of binary mesh file are out of range.");
+  }
+
+  const std::int64_t* offsets
+      = reinterpret_cast<const std::int64_t*>(_data + _dest_offsets);
+  const std::int32_t* dest
+      = reinterpret_cast<const std::int32_t*>(_data + _dest);
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> data
+      = Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>(
+          dest + offsets[range[0]], offsets[range[1]] - offsets[range[0]]);
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> local_offsets(
+      range[1] - range[0] + 1);
+  for (Eigen::Index i = 0; i < local_offsets.rows(); ++i)
+    local_offsets[i] = offsets[range[0] + i] - offsets[range[0]];
+  return graph::AdjacencyList<std::int32_t>(std::move(data),
+                                            std::move(local_offsets));
+}
+//-----------------------------------------------------------------------------
+void binary_mesh::write_mesh(const std::string& filename,
+                             const mesh::Mesh& mesh)
+{
+  common::Timer timer("Write binary mesh file");
+
+  MPI_Comm comm = mesh.mpi_comm();
+  const int rank = dolfinx::MPI::rank(comm);
+  const mesh::Topology& topology = mesh.topology();
+  const mesh::Geometry& geometry = mesh.geometry();
+  const int tdim = topology.dim();
+  const int gdim = geometry.dim();
+  std::shared_ptr<const common::IndexMap> map_c = topology.index_map(tdim);
+  std::shared_ptr<const common::IndexMap> map_x = geometry.index_map();
+  assert(map_c);
+  assert(map_x);
+  assert(map_x->block_size() == 1);
+  const std::int32_t num_cells = map_c->size_local();
+  const std::int32_t num_nodes = map_x->size_local();
+  const int num_nodes_per_cell = geometry.cmap().dof_layout().num_dofs();
+
+  // Owned cells, with the geometry nodes by global index
+  const std::vector<std::int64_t> global_nodes = map_x->global_indices(false);
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  std::vector<std::int64_t> cells(num_cells * num_nodes_per_cell);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    auto nodes = x_dofmap.links(c);
+    assert(nodes.rows() == num_nodes_per_cell);
+    for (int i = 0; i < num_nodes_per_cell; ++i)
+      cells[c * num_nodes_per_cell + i] = global_nodes[nodes[i]];
+  }
+
+  // Owned nodes
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      x = geometry.x().topLeftCorner(num_nodes, gdim);
+
+  // Destinations of the owned cells: this process, and the processes
+  // of the ghost cells
+  const common::IndexMap::SharedIndices& shared_cells
+      = map_c->shared_index_ranks();
+  std::vector<std::int64_t> dest_offsets(num_cells + 1, 0);
+  std::vector<std::int32_t> dest;
+  dest.reserve(num_cells);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    dest.push_back(rank);
+    if (const std::int32_t pos = shared_cells.find(c); pos != -1)
+    {
+      auto ranks = shared_cells.ranks.links(pos);
+      dest.insert(dest.end(), ranks.data(), ranks.data() + ranks.rows());
+    }
+    dest_offsets[c + 1] = dest.size();
+  }
+
+  const int has_ghosts_local = map_c->num_ghosts() > 0;
+  int has_ghosts = 0;
+  MPI_Allreduce(&has_ghosts_local, &has_ghosts, 1, MPI_INT, MPI_LOR, comm);
+
+  const std::vector<std::int64_t> cell_offsets
+      = block_offsets(comm, num_cells);
+  const std::vector<std::int64_t> node_offsets
+      = block_offsets(comm, num_nodes);
+  const std::vector<std::int64_t> dest_block_offsets
+      = block_offsets(comm, dest.size());
+  const std::int64_t num_parts = cell_offsets.size() - 1;
+  const Layout layout = compute_layout(
+      num_parts, cell_offsets.back(), num_nodes_per_cell, node_offsets.back(),
+      gdim, dest_block_offsets.back());
+
+  MPI_File fh;
+  if (MPI_File_open(comm, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                    MPI_INFO_NULL, &fh)
+      != MPI_SUCCESS)
+  {
+    throw std::runtime_error("Cannot open binary mesh file " + filename);
+  }
+  MPI_File_set_size(fh, 0);
+
+  if (rank == 0)
+  {
+    // Header and offsets of the parts
+    std::vector<std::int64_t> header(header_size);
+    std::memcpy(header.data(), magic, sizeof(magic));
+    header[1] = version;
+    header[cell_type_pos] = static_cast<std::int64_t>(topology.cell_type());
+    header[gdim_pos] = gdim;
+    header[num_nodes_per_cell_pos] = num_nodes_per_cell;
+    header[num_parts_pos] = num_parts;
+    header[num_cells_pos] = cell_offsets.back();
+    header[num_nodes_pos] = node_offsets.back();
+    header[ghosts_pos] = has_ghosts;
+    header.insert(header.end(), cell_offsets.begin(), cell_offsets.end());
+    header.insert(header.end(), node_offsets.begin(), node_offsets.end());
+    write_at(fh, 0, header.data(), header.size() * sizeof(std::int64_t));
+
+    // Last destination offset
+    const std::int64_t num_dest = dest_block_offsets.back();
+    write_at(fh,
+             layout.dest_offsets
+                 + sizeof(std::int64_t) * cell_offsets.back(),
+             &num_dest, sizeof(std::int64_t));
+  }
+
+  // The blocks of this process
+  write_at(fh,
+           layout.cells
+               + sizeof(std::int64_t) * cell_offsets[rank]
+                     * num_nodes_per_cell,
+           cells.data(), cells.size() * sizeof(std::int64_t));
+  write_at(fh, layout.x + sizeof(double) * node_offsets[rank] * gdim,
+           x.data(), x.size() * sizeof(double));
+  for (std::int32_t c = 0; c < num_cells; ++c)
+    dest_offsets[c] += dest_block_offsets[rank];
+  write_at(fh,
+           layout.dest_offsets + sizeof(std::int64_t) * cell_offsets[rank],
+           dest_offsets.data(), num_cells * sizeof(std::int64_t));
+  write_at(fh,
+           layout.dest + sizeof(std::int32_t) * dest_block_offsets[rank],
+           dest.data(), dest.size() * sizeof(std::int32_t));
+
+  if (MPI_File_close(&fh) != MPI_SUCCESS)
+    throw std::runtime_error("Writing binary mesh file failed.");
+}
+//-----------------------------------------------------------------------------
+mesh::Mesh binary_mesh::read_mesh(MPI_Comm comm, const std::string& filename,
+                                  const fem::CoordinateElement& element,
+                                  mesh::GhostMode ghost_mode)
+{
+  common::Timer timer("Read binary mesh file");
+
+  const MappedFile file(filename);
+  if (file.cell_type() != element.cell_shape())
+    throw std::runtime_error("Cell type of binary mesh file is wrong.");
+  const auto x = file.x();
+  const auto cells_all = file.cells();
+  if (cells_all.cols() != element.dof_layout().num_dofs())
+  {
+    throw std::runtime_error(
+        "Number of nodes per cell of binary mesh file is wrong.");
+  }
+
+  // Nodes are copied from the mapped file for the local cells only
+  const mesh::NodeFetcher fetch_nodes
+      = [&x](const std::vector<std::int64_t>& indices) {
+          if (!indices.empty()
+              and (indices.front() < 0 or indices.back() >= x.rows()))
+          {
+            throw std::runtime_error("Node of binary mesh file is missing.");
+          }
+          Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+              coords(indices.size(), x.cols());
+          for (std::size_t i = 0; i < indices.size(); ++i)
+            coords.row(i) = x.row(indices[i]);
+          return coords;
+        };
+
+  // Restore the distribution of the written mesh, unless ghost cells
+  // are requested and not stored
+  const int rank = dolfinx::MPI::rank(comm);
+  const int size = dolfinx::MPI::size(comm);
+  const bool same_parts
+      = size == file.num_parts()
+        and (ghost_mode == mesh::GhostMode::none or file.has_ghosts());
+  const std::array<std::int64_t, 2> range
+      = same_parts ? file.cell_range(rank)
+                   : dolfinx::MPI::local_range(rank, cells_all.rows(), size);
+  const graph::AdjacencyList<std::int64_t> cells(
+      cells_all.middleRows(range[0], range[1] - range[0]));
+
+  if (size == 1)
+  {
+    const graph::AdjacencyList<std::int32_t> dest(
+        Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic,
+                     Eigen::RowMajor>::Zero(cells.num_nodes(), 1));
+    return mesh::create_mesh_fetching_nodes(comm, cells, element, fetch_nodes,
+                                            ghost_mode, dest);
+  }
+  else if (same_parts)
+  {
+    return mesh::create_mesh_fetching_nodes(comm, cells, element, fetch_nodes,
+                                            ghost_mode,
+                                            file.destinations(range));
+  }
+  else
+  {
+    return mesh::create_mesh_fetching_nodes(comm, cells, element, fetch_nodes,
+                                            ghost_mode);
+  }
+}
+//-----------------------------------------------------------------------------
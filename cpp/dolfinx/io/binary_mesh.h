@@ -0,0 +1,143 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <array>
+#include <cstdint>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/cell_types.h>
+#include <mpi.h>
+#include <string>
+
+namespace dolfinx
+{
+namespace fem
+{
+class CoordinateElement;
+}
+
+/// Native binary mesh files, which are memory mapped for reading
+///
+/// A file stores the owned cells (global geometry node indices, in
+/// DOLFINX ordering) and the owned geometry nodes of each process of a
+/// distributed mesh, concatenated in rank order, i.e. the cells and
+/// nodes of a part (the data of a process) are contiguous. The
+/// destination processes of the cells (owner and ghosting processes)
+/// are stored too, such that a mesh is re-created on the same number of
+/// processes without partitioning. The data are stored in the native
+/// byte order with 8-byte alignment, as laid out in memory.
+///
+/// Layout (all values are 64-bit integers unless noted):
+/// - Header: magic, version, cell type, gdim, nodes per cell, number
+///   of parts, number of cells, number of nodes, 1 if the destinations
+///   include ghosting processes (0 otherwise)
+/// - Cell offsets and node offsets of the parts (number of parts + 1
+///   values each)
+/// - Cells (number of cells x nodes per cell)
+/// - Node coordinates (doubles, number of nodes x gdim)
+/// - Destination offsets of the cells (number of cells + 1)
+/// - Destination processes (32-bit integers)
+
+namespace io::binary_mesh
+{
+
+/// A read-only memory map of a binary mesh file. The arrays are views
+/// of the mapped file and are not copied.
+class MappedFile
+{
+public:
+  /// Map a file
+  /// @param[in] filename The name of the file
+  explicit MappedFile(const std::string& filename);
+
+  /// Copy constructor
+  MappedFile(const MappedFile& file) = delete;
+
+  /// Destructor. Unmaps the file.
+  ~MappedFile();
+
+  /// Assignment
+  MappedFile& operator=(const MappedFile& file) = delete;
+
+  /// The cell type of the mesh
+  mesh::CellType cell_type() const;
+
+  /// The geometric dimension of the mesh
+  int gdim() const;
+
+  /// The number of parts of the mesh (processes that wrote the file)
+  int num_parts() const;
+
+  /// True if the destinations of the cells include the processes of
+  /// the ghost cells
+  bool has_ghosts() const;
+
+  /// The range of the cells of a part
+  /// @param[in] part The part
+  /// @return The range [first, last) of cells
+  std::array<std::int64_t, 2> cell_range(int part) const;
+
+  /// The range of the geometry nodes of a part
+  /// @param[in] part The part
+  /// @return The range [first, last) of the (global) node indices
+  std::array<std::int64_t, 2> node_range(int part) const;
+
+  /// The cells (global node indices) of all parts
+  Eigen::Map<const Eigen::Array<std::int64_t, Eigen::Dynamic, Eigen::Dynamic,
+                                Eigen::RowMajor>>
+  cells() const;
+
+  /// The node coordinates of all parts
+  Eigen::Map<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                Eigen::RowMajor>>
+  x() const;
+
+  /// The destination processes of a range of cells, with the owner
+  /// first
+  /// @param[in] range The range [first, last) of cells
+  /// @return The destination processes of each cell in @p range
+  graph::AdjacencyList<std::int32_t>
+  destinations(const std::array<std::int64_t, 2>& range) const;
+
+private:
+  // Mapped data and its size in bytes
+  const char* _data = nullptr;
+  std::size_t _size = 0;
+
+  // View of the header and the offsets of the parts
+  const std::int64_t* _header = nullptr;
+
+  // Byte offsets of the arrays
+  std::size_t _cells = 0, _x = 0, _dest_offsets = 0, _dest = 0;
+};
+
+/// Write a mesh to a binary mesh file (collective)
+/// @param[in] filename The name of the file. An existing file is
+///   overwritten.
+/// @param[in] mesh The mesh
+void write_mesh(const std::string& filename, const mesh::Mesh& mesh);
+
+/// Read a mesh from a binary mesh file (collective). If the number of
+/// processes is the number of parts of the file, each process reads its
+/// part and the cells are distributed as in the written mesh, without
+/// partitioning (unless ghost cells are requested and the written mesh
+/// has no ghost cells). Otherwise each process reads a block of the
+/// cells and the cells are partitioned. The geometry nodes are read by
+/// each process for its cells only.
+/// @param[in] comm The MPI communicator
+/// @param[in] filename The name of the file
+/// @param[in] element The coordinate element of the mesh
+/// @param[in] ghost_mode The type of ghost cells
+/// @return The mesh
+mesh::Mesh read_mesh(MPI_Comm comm, const std::string& filename,
+                     const fem::CoordinateElement& element,
+                     mesh::GhostMode ghost_mode);
+
+} // namespace io::binary_mesh
+} // namespace dolfinx
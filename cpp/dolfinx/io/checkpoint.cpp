@@ -0,0 +1,552 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "checkpoint.h"
+#include "HDF5Interface.h"
+#include <algorithm>
+#include <array>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/common/log.h>
+#include <dolfinx/fem/CoordinateElement.h>
+#include <dolfinx/fem/DofMap.h>
+#include <dolfinx/function/Function.h>
+#include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/la/Vector.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Topology.h>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+
+using namespace dolfinx;
+using namespace dolfinx::io;
+
+namespace
+{
+// Number of doubles stored for a PetscScalar (two for complex values,
+// which are stored as pairs of the real and imaginary parts)
+constexpr int scalar_width = sizeof(PetscScalar) / sizeof(double);
+//-----------------------------------------------------------------------------
+// Write the blocks of rows of the processes, concatenated in rank
+// order, and the offsets of the blocks (in rows) to the dataset name +
+// "_offsets"
+template <typename T>
+void write_blocks(MPI_Comm comm, hid_t h5_id, const std::string& name,
+                  const T* data, std::int64_t num_rows, int width)
+{
+  const int rank = dolfinx::MPI::rank(comm);
+  const int size = dolfinx::MPI::size(comm);
+  const bool use_mpi_io = size > 1;
+  std::vector<std::int64_t> offsets(size + 1, 0);
+  MPI_Allgather(&num_rows, 1, MPI_INT64_T, offsets.data() + 1, 1, MPI_INT64_T,
+                comm);
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  // HDF5 does not accept a null pointer for an empty block
+  const T dummy = 0;
+  std::vector<std::int64_t> shape = {offsets.back()};
+  if (width > 1)
+    shape.push_back(width);
+  HDF5Interface::write_dataset(h5_id, name, data ? data : &dummy,
+                               {offsets[rank], offsets[rank + 1]}, shape,
+                               use_mpi_io);
+  HDF5Interface::write_dataset(h5_id, name + "_offsets", offsets.data(),
+                               {rank == 0 ? 0 : size + 1, size + 1},
+                               {size + 1}, use_mpi_io);
+}
+//-----------------------------------------------------------------------------
+// Read the block of rows of this process from a dataset written by
+// write_blocks (on the same number of processes)
+template <typename T>
+std::vector<T> read_block(MPI_Comm comm, hid_t h5_id, const std::string& name)
+{
+  const int rank = dolfinx::MPI::rank(comm);
+  const std::vector<std::int64_t> offsets
+      = HDF5Interface::read_dataset<std::int64_t>(h5_id, name + "_offsets",
+                                                  {-1, -1});
+  assert((int)offsets.size() == dolfinx::MPI::size(comm) + 1);
+  return HDF5Interface::read_dataset<T>(h5_id, name,
+                                        {offsets[rank], offsets[rank + 1]});
+}
+//-----------------------------------------------------------------------------
+// Maximum of a value over the processes
+std::int64_t max_all(MPI_Comm comm, std::int64_t value)
+{
+  std::int64_t max = 0;
+  MPI_Allreduce(&value, &max, 1, MPI_INT64_T, MPI_MAX, comm);
+  return max;
+}
+//-----------------------------------------------------------------------------
+// Check if a function is stored in a checkpoint file. The groups are
+// checked level by level, since H5Lexists fails on missing groups.
+bool has_function(hid_t h5_id, const std::string& name)
+{
+  return HDF5Interface::has_dataset(h5_id, "/functions")
+         and HDF5Interface::has_dataset(h5_id, "/functions/" + name);
+}
+//-----------------------------------------------------------------------------
+// Write the ghosts and ghost owners of an index map
+void write_index_map(MPI_Comm comm, hid_t h5_id, const std::string& name,
+                     const common::IndexMap& map)
+{
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& ghosts = map.ghosts();
+  const Eigen::Array<int, Eigen::Dynamic, 1> owners = map.ghost_owner_rank();
+  write_blocks(comm, h5_id, name + "/ghosts", ghosts.data(), ghosts.rows(), 1);
+  write_blocks(comm, h5_id, name + "/ghost_owners", owners.data(),
+               owners.rows(), 1);
+}
+//-----------------------------------------------------------------------------
+// Read an index map written by write_index_map
+std::shared_ptr<common::IndexMap> read_index_map(MPI_Comm comm, hid_t h5_id,
+                                                 const std::string& name,
+                                                 std::int32_t size_local)
+{
+  const std::vector<std::int64_t> ghosts
+      = read_block<std::int64_t>(comm, h5_id, name + "/ghosts");
+  const std::vector<int> owners
+      = read_block<int>(comm, h5_id, name + "/ghost_owners");
+  return std::make_shared<common::IndexMap>(
+      comm, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          comm, std::set<int>(owners.begin(), owners.end())),
+      ghosts, owners, 1);
+}
+//-----------------------------------------------------------------------------
+// Re-create the distributed mesh of a checkpoint on the same number of
+// processes
+mesh::Mesh read_mesh_distributed(MPI_Comm comm, hid_t h5_id,
+                                 const fem::CoordinateElement& element,
+                                 mesh::CellType cell_type, int gdim)
+{
+  const std::vector<std::int64_t> sizes
+      = read_block<std::int64_t>(comm, h5_id, "/mesh/sizes");
+  assert(sizes.size() == 3);
+
+  // Topology
+  mesh::Topology topology(comm, cell_type);
+  const int tdim = topology.dim();
+  auto map_v = read_index_map(comm, h5_id, "/mesh/topology/vertex_map",
+                              sizes[0]);
+  topology.set_index_map(0, map_v);
+  topology.set_connectivity(
+      std::make_shared<graph::AdjacencyList<std::int32_t>>(
+          map_v->size_local() + map_v->num_ghosts()),
+      0, 0);
+
+  auto map_c
+      = read_index_map(comm, h5_id, "/mesh/topology/cell_map", sizes[1]);
+  const std::int32_t num_cells = map_c->size_local() + map_c->num_ghosts();
+  topology.set_index_map(tdim, map_c);
+  const int num_vertices_cell = mesh::num_cell_vertices(cell_type);
+  std::vector<std::int32_t> cell_vertices = read_block<std::int32_t>(
+      comm, h5_id, "/mesh/topology/cell_vertices");
+  assert((int)cell_vertices.size() == num_cells * num_vertices_cell);
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets_v
+      = Eigen::Array<std::int32_t, Eigen::Dynamic, 1>::LinSpaced(
+          num_cells + 1, 0, num_cells * num_vertices_cell);
+  topology.set_connectivity(
+      std::make_shared<graph::AdjacencyList<std::int32_t>>(
+          Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>(
+              cell_vertices.data(), cell_vertices.size()),
+          offsets_v),
+      tdim, 0);
+
+  // Geometry
+  auto map_x
+      = read_index_map(comm, h5_id, "/mesh/geometry/node_map", sizes[2]);
+  const std::vector<std::int32_t> x_dofmap
+      = read_block<std::int32_t>(comm, h5_id, "/mesh/geometry/dofmap");
+  const int num_nodes_cell = num_cells > 0 ? x_dofmap.size() / num_cells : 0;
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets_x
+      = Eigen::Array<std::int32_t, Eigen::Dynamic, 1>::LinSpaced(
+          num_cells + 1, 0, num_cells * num_nodes_cell);
+  graph::AdjacencyList<std::int32_t> dofmap(
+      Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>(
+          x_dofmap.data(), x_dofmap.size()),
+      offsets_x);
+
+  const std::vector<double> x_owned
+      = read_block<double>(comm, h5_id, "/mesh/geometry/x");
+  const std::vector<double> x_ghosts
+      = read_block<double>(comm, h5_id, "/mesh/geometry/x_ghosts");
+  const std::int32_t num_nodes = map_x->size_local() + map_x->num_ghosts();
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> x(
+      num_nodes, gdim);
+  std::copy(x_owned.begin(), x_owned.end(), x.data());
+  std::copy(x_ghosts.begin(), x_ghosts.end(), x.data() + x_owned.size());
+
+  std::vector<std::int64_t> input_global_indices = read_block<std::int64_t>(
+      comm, h5_id, "/mesh/geometry/input_global_indices");
+
+  mesh::Geometry geometry(map_x, std::move(dofmap), element, x,
+                          std::move(input_global_indices));
+  return mesh::Mesh(comm, std::move(topology), std::move(geometry));
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+void io::checkpoint::write_mesh(const std::string& filename,
+                                const mesh::Mesh& mesh)
+{
+  common::Timer timer("Write mesh checkpoint");
+
+  const MPI_Comm comm = mesh.mpi_comm();
+  const int rank = dolfinx::MPI::rank(comm);
+  const int size = dolfinx::MPI::size(comm);
+  const bool use_mpi_io = size > 1;
+  const mesh::Topology& topology = mesh.topology();
+  const mesh::Geometry& geometry = mesh.geometry();
+  const int tdim = topology.dim();
+  const int gdim = geometry.dim();
+  auto map_v = topology.index_map(0);
+  auto map_c = topology.index_map(tdim);
+  auto map_x = geometry.index_map();
+  assert(map_v and map_c and map_x);
+  const std::int32_t num_cells = map_c->size_local() + map_c->num_ghosts();
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  const int num_nodes_cell = num_cells > 0 ? x_dofmap.num_links(0) : 0;
+
+  const hid_t h5_id
+      = HDF5Interface::open_file(comm, filename, "w", use_mpi_io);
+
+  // Number of processes, cell type, geometric dimension and number of
+  // nodes of a cell
+  const std::array<std::int64_t, 4> info
+      = {size, static_cast<std::int64_t>(topology.cell_type()), gdim,
+         max_all(comm, num_nodes_cell)};
+  HDF5Interface::write_dataset(h5_id, "/mesh/info", info.data(),
+                               {rank == 0 ? 0 : 4, 4}, {4}, use_mpi_io);
+
+  // Number of owned vertices, cells and nodes of each process
+  const std::array<std::int64_t, 3> sizes
+      = {map_v->size_local(), map_c->size_local(), map_x->size_local()};
+  write_blocks(comm, h5_id, "/mesh/sizes", sizes.data(), 3, 1);
+
+  // Topology
+  write_index_map(comm, h5_id, "/mesh/topology/vertex_map", *map_v);
+  write_index_map(comm, h5_id, "/mesh/topology/cell_map", *map_c);
+  auto c_to_v = topology.connectivity(tdim, 0);
+  assert(c_to_v);
+  write_blocks(comm, h5_id, "/mesh/topology/cell_vertices",
+               c_to_v->array().data(), c_to_v->array().rows(), 1);
+
+  // Geometry
+  write_index_map(comm, h5_id, "/mesh/geometry/node_map", *map_x);
+  write_blocks(comm, h5_id, "/mesh/geometry/dofmap", x_dofmap.array().data(),
+               x_dofmap.array().rows(), 1);
+  const std::int32_t num_nodes_owned = map_x->size_local();
+  const std::int32_t num_nodes = num_nodes_owned + map_x->num_ghosts();
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      x = geometry.x().leftCols(gdim);
+  write_blocks(comm, h5_id, "/mesh/geometry/x", x.data(), num_nodes_owned,
+               gdim);
+  write_blocks(comm, h5_id, "/mesh/geometry/x_ghosts",
+               x.data() + num_nodes_owned * gdim, num_nodes - num_nodes_owned,
+               gdim);
+  const std::vector<std::int64_t>& input_global_indices
+      = geometry.input_global_indices();
+  write_blocks(comm, h5_id, "/mesh/geometry/input_global_indices",
+               input_global_indices.data(), input_global_indices.size(), 1);
+
+  // Owned cells (global node indices), in the order of their global
+  // indices, for restarts on a different number of processes. With the
+  // owned nodes (x), these are the input data of a mesh.
+  const std::vector<std::int64_t> global_nodes = map_x->global_indices(false);
+  const std::int32_t num_cells_owned = map_c->size_local();
+  std::vector<std::int64_t> cells(num_cells_owned * num_nodes_cell);
+  for (std::int32_t c = 0; c < num_cells_owned; ++c)
+  {
+    auto nodes = x_dofmap.links(c);
+    for (int i = 0; i < num_nodes_cell; ++i)
+      cells[c * num_nodes_cell + i] = global_nodes[nodes[i]];
+  }
+  write_blocks(comm, h5_id, "/mesh/cells", cells.data(), num_cells_owned,
+               num_nodes_cell);
+
+  HDF5Interface::close_file(h5_id);
+}
+//-----------------------------------------------------------------------------
+std::pair<mesh::Mesh, std::vector<std::int64_t>>
+io::checkpoint::read_mesh(MPI_Comm comm, const std::string& filename,
+                          const fem::CoordinateElement& element,
+                          mesh::GhostMode ghost_mode)
+{
+  common::Timer timer("Read mesh checkpoint");
+
+  const int rank = dolfinx::MPI::rank(comm);
+  const int size = dolfinx::MPI::size(comm);
+  const bool use_mpi_io = size > 1;
+  const hid_t h5_id
+      = HDF5Interface::open_file(comm, filename, "r", use_mpi_io);
+
+  const std::vector<std::int64_t> info
+      = HDF5Interface::read_dataset<std::int64_t>(h5_id, "/mesh/info",
+                                                  {-1, -1});
+  assert(info.size() == 4);
+  const mesh::CellType cell_type = static_cast<mesh::CellType>(info[1]);
+  const int gdim = info[2];
+  const int num_nodes_cell = info[3];
+  if (cell_type != element.cell_shape())
+  {
+    throw std::runtime_error(
+        "Cell type of the coordinate element does not match the checkpoint.");
+  }
+
+  if (info[0] == size)
+  {
+    // Same number of processes: re-create the distributed mesh
+    mesh::Mesh mesh
+        = read_mesh_distributed(comm, h5_id, element, cell_type, gdim);
+    HDF5Interface::close_file(h5_id);
+    const int tdim = mesh.topology().dim();
+    std::vector<std::int64_t> cell_index
+        = mesh.topology().index_map(tdim)->global_indices(false);
+    return {std::move(mesh), std::move(cell_index)};
+  }
+
+  // Different number of processes: read a range of the owned cells and
+  // nodes of the written mesh, and partition the mesh
+  LOG(INFO) << "Checkpoint " << filename << " was written on " << info[0]
+            << " processes, partitioning the mesh for " << size
+            << " processes";
+  const std::vector<std::int64_t> shape_cells
+      = HDF5Interface::get_dataset_shape(h5_id, "/mesh/cells");
+  const std::vector<std::int64_t> shape_x
+      = HDF5Interface::get_dataset_shape(h5_id, "/mesh/geometry/x");
+  const std::array<std::int64_t, 2> range_cells
+      = dolfinx::MPI::local_range(rank, shape_cells[0], size);
+  const std::array<std::int64_t, 2> range_x
+      = dolfinx::MPI::local_range(rank, shape_x[0], size);
+  std::vector<std::int64_t> cells_data
+      = HDF5Interface::read_dataset<std::int64_t>(h5_id, "/mesh/cells",
+                                                  range_cells);
+  const std::vector<double> x_data = HDF5Interface::read_dataset<double>(
+      h5_id, "/mesh/geometry/x", range_x);
+  HDF5Interface::close_file(h5_id);
+
+  const std::int32_t num_cells = range_cells[1] - range_cells[0];
+  const graph::AdjacencyList<std::int64_t> cells(
+      Eigen::Map<const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>>(
+          cells_data.data(), cells_data.size()),
+      Eigen::Array<std::int32_t, Eigen::Dynamic, 1>::LinSpaced(
+          num_cells + 1, 0, num_cells * num_nodes_cell));
+  const Eigen::Map<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                      Eigen::RowMajor>>
+      x(x_data.data(), range_x[1] - range_x[0], gdim);
+
+  // The cells are read in the order of their global indices in the
+  // written mesh, so this is their original index
+  return mesh::create_mesh_with_original_index(comm, cells, element, x,
+                                               ghost_mode);
+}
+//-----------------------------------------------------------------------------
+void io::checkpoint::write_function(const std::string& filename,
+                                    const function::Function<PetscScalar>& u,
+                                    const std::string& name)
+{
+  common::Timer timer("Write function checkpoint");
+
+  assert(u.function_space());
+  std::shared_ptr<const mesh::Mesh> mesh = u.function_space()->mesh();
+  std::shared_ptr<const fem::DofMap> dofmap = u.function_space()->dofmap();
+  assert(mesh and dofmap);
+  const MPI_Comm comm = mesh->mpi_comm();
+  const int rank = dolfinx::MPI::rank(comm);
+  const int size = dolfinx::MPI::size(comm);
+  const bool use_mpi_io = size > 1;
+  const int tdim = mesh->topology().dim();
+  auto map_c = mesh->topology().index_map(tdim);
+  assert(map_c);
+  const std::int32_t num_cells_owned = map_c->size_local();
+
+  const graph::AdjacencyList<std::int32_t>& dofs = dofmap->list();
+  const int num_dofs_cell = dofs.num_nodes() > 0 ? dofs.num_links(0) : 0;
+  const Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>& x = u.x()->array();
+
+  const std::string group = "/functions/" + name;
+  const hid_t h5_id
+      = HDF5Interface::open_file(comm, filename, "a", use_mpi_io);
+  if (has_function(h5_id, name))
+  {
+    HDF5Interface::close_file(h5_id);
+    throw std::runtime_error("Function \"" + name
+                             + "\" exists in checkpoint file " + filename);
+  }
+
+  // Number of processes and number of dofs of a cell
+  const std::array<std::int64_t, 2> info
+      = {size, max_all(comm, num_dofs_cell)};
+  HDF5Interface::write_dataset(h5_id, group + "/info", info.data(),
+                               {rank == 0 ? 0 : 2, 2}, {2}, use_mpi_io);
+
+  // Raw coefficients (owned and ghosts) and dofmaps of the processes
+  write_blocks(comm, h5_id, group + "/x",
+               reinterpret_cast<const double*>(x.data()), x.rows(),
+               scalar_width);
+  write_blocks(comm, h5_id, group + "/dofmap", dofs.array().data(),
+               dofs.array().rows(), 1);
+
+  // Coefficients of the owned cells, in the order of their global
+  // indices, for restarts on a different number of processes
+  std::vector<PetscScalar> cell_values(num_cells_owned * num_dofs_cell);
+  for (std::int32_t c = 0; c < num_cells_owned; ++c)
+  {
+    auto cell_dofs = dofs.links(c);
+    for (int i = 0; i < num_dofs_cell; ++i)
+      cell_values[c * num_dofs_cell + i] = x[cell_dofs[i]];
+  }
+  write_blocks(comm, h5_id, group + "/cell_values",
+               reinterpret_cast<const double*>(cell_values.data()),
+               num_cells_owned, num_dofs_cell * scalar_width);
+
+  HDF5Interface::close_file(h5_id);
+}
+//-----------------------------------------------------------------------------
+void io::checkpoint::read_function(
+    const std::string& filename, function::Function<PetscScalar>& u,
+    const std::string& name,
+    const std::vector<std::int64_t>& original_cell_index)
+{
+  common::Timer timer("Read function checkpoint");
+
+  assert(u.function_space());
+  std::shared_ptr<const mesh::Mesh> mesh = u.function_space()->mesh();
+  std::shared_ptr<const fem::DofMap> dofmap = u.function_space()->dofmap();
+  assert(mesh and dofmap);
+  const MPI_Comm comm = mesh->mpi_comm();
+  const int rank = dolfinx::MPI::rank(comm);
+  const int size = dolfinx::MPI::size(comm);
+  const bool use_mpi_io = size > 1;
+  const int tdim = mesh->topology().dim();
+  auto map_c = mesh->topology().index_map(tdim);
+  assert(map_c);
+  const std::int32_t num_cells = map_c->size_local() + map_c->num_ghosts();
+  if ((std::int32_t)original_cell_index.size() != num_cells)
+    throw std::runtime_error("Original cell indices do not match the mesh.");
+
+  const graph::AdjacencyList<std::int32_t>& dofs = dofmap->list();
+  const int num_dofs_cell = num_cells > 0 ? dofs.num_links(0) : 0;
+  Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>& x = u.x()->array();
+
+  const std::string group = "/functions/" + name;
+  const hid_t h5_id
+      = HDF5Interface::open_file(comm, filename, "r", use_mpi_io);
+  if (!has_function(h5_id, name))
+  {
+    HDF5Interface::close_file(h5_id);
+    throw std::runtime_error("Function \"" + name
+                             + "\" not found in checkpoint file " + filename);
+  }
+  const std::vector<std::int64_t> info
+      = HDF5Interface::read_dataset<std::int64_t>(h5_id, group + "/info",
+                                                  {-1, -1});
+  assert(info.size() == 2);
+  if (max_all(comm, num_dofs_cell) != info[1])
+  {
+    HDF5Interface::close_file(h5_id);
+    throw std::runtime_error("Number of dofs of a cell of function \"" + name
+                             + "\" does not match the function space.");
+  }
+
+  // Use the raw coefficients if the mesh is the written mesh, i.e. its
+  // cells are the written cells in the same order
+  const std::int64_t cell_offset = map_c->local_range()[0];
+  bool same_mesh = info[0] == size;
+  for (std::int32_t c = 0; same_mesh and c < map_c->size_local(); ++c)
+    same_mesh = original_cell_index[c] == cell_offset + c;
+  int same_mesh_all = same_mesh;
+  MPI_Allreduce(MPI_IN_PLACE, &same_mesh_all, 1, MPI_INT, MPI_MIN, comm);
+
+  if (same_mesh_all)
+  {
+    const std::vector<double> x_data
+        = read_block<double>(comm, h5_id, group + "/x");
+    const std::vector<std::int32_t> dofs_old
+        = read_block<std::int32_t>(comm, h5_id, group + "/dofmap");
+    HDF5Interface::close_file(h5_id);
+    if ((std::int32_t)dofs_old.size() != num_cells * num_dofs_cell)
+      throw std::runtime_error("Dofmap of checkpoint does not match.");
+
+    const PetscScalar* x_old
+        = reinterpret_cast<const PetscScalar*>(x_data.data());
+    for (std::int32_t c = 0; c < num_cells; ++c)
+    {
+      auto cell_dofs = dofs.links(c);
+      for (int i = 0; i < num_dofs_cell; ++i)
+        x[cell_dofs[i]] = x_old[dofs_old[c * num_dofs_cell + i]];
+    }
+    return;
+  }
+
+  // Different mesh distribution: read a range of the cell-wise
+  // coefficients, and get the coefficients of the cells of this process
+  // from the processes that read them
+  const std::int64_t num_cells_global
+      = HDF5Interface::get_dataset_shape(h5_id, group + "/cell_values")[0];
+  const std::array<std::int64_t, 2> range
+      = dolfinx::MPI::local_range(rank, num_cells_global, size);
+  const std::vector<double> values_data = HDF5Interface::read_dataset<double>(
+      h5_id, group + "/cell_values", range);
+  HDF5Interface::close_file(h5_id);
+  const PetscScalar* values
+      = reinterpret_cast<const PetscScalar*>(values_data.data());
+
+  // Send the original indices of the cells to the processes that hold
+  // their coefficients
+  std::vector<std::int32_t> num_requests(size, 0);
+  std::vector<int> owner(num_cells);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    owner[c] = dolfinx::MPI::index_owner(size, original_cell_index[c],
+                                         num_cells_global);
+    ++num_requests[owner[c]];
+  }
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets(size + 1);
+  offsets[0] = 0;
+  for (int p = 0; p < size; ++p)
+    offsets[p + 1] = offsets[p] + num_requests[p];
+  Eigen::Array<std::int64_t, Eigen::Dynamic, 1> requests(num_cells);
+  std::vector<std::int32_t> position(offsets.data(), offsets.data() + size);
+  std::vector<std::int32_t> request_pos(num_cells);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    request_pos[c] = position[owner[c]]++;
+    requests[request_pos[c]] = original_cell_index[c];
+  }
+  const graph::AdjacencyList<std::int64_t> received = dolfinx::MPI::all_to_all(
+      comm, graph::AdjacencyList<std::int64_t>(requests, offsets));
+
+  // Send back the coefficients of the requested cells
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& received_cells
+      = received.array();
+  Eigen::Array<PetscScalar, Eigen::Dynamic, 1> reply(received_cells.rows()
+                                                     * num_dofs_cell);
+  for (Eigen::Index j = 0; j < received_cells.rows(); ++j)
+  {
+    const std::int64_t local = received_cells[j] - range[0];
+    assert(local >= 0 and local < range[1] - range[0]);
+    std::copy_n(values + local * num_dofs_cell, num_dofs_cell,
+                reply.data() + j * num_dofs_cell);
+  }
+  const graph::AdjacencyList<PetscScalar> cell_values
+      = dolfinx::MPI::all_to_all(comm, graph::AdjacencyList<PetscScalar>(
+                                           reply, received.offsets()
+                                                      * num_dofs_cell));
+
+  // The replies are in the order of the requests
+  const Eigen::Array<PetscScalar, Eigen::Dynamic, 1>& v = cell_values.array();
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    auto cell_dofs = dofs.links(c);
+    for (int i = 0; i < num_dofs_cell; ++i)
+      x[cell_dofs[i]] = v[request_pos[c] * num_dofs_cell + i];
+  }
+}
+//-----------------------------------------------------------------------------
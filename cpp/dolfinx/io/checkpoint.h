@@ -0,0 +1,89 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <dolfinx/mesh/Mesh.h>
+#include <mpi.h>
+#include <petscsys.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dolfinx
+{
+namespace fem
+{
+class CoordinateElement;
+}
+
+namespace function
+{
+template <typename T>
+class Function;
+}
+
+/// Checkpointing of meshes and functions in HDF5 files, for restarts
+///
+/// A checkpoint stores the distributed data of a mesh (the cells,
+/// vertices and geometry nodes of each process with their index maps)
+/// and the raw expansion coefficients and dofmaps of functions, as
+/// blocks of the processes. A restart on the same number of processes
+/// reads the blocks and re-creates the same distributed mesh, without
+/// partitioning, and the coefficients are remapped to the dofs of the
+/// function spaces on the mesh, without interpolation. A restart on a
+/// different number of processes partitions the mesh anew and maps the
+/// coefficients cell by cell. This is exact unless the dofs of a cell
+/// are permuted by the cell orientation (e.g. Lagrange elements of
+/// degree three or higher), since the orientation of the cells depends
+/// on the distribution of the mesh.
+
+namespace io::checkpoint
+{
+
+/// Write a mesh to a new checkpoint file (collective). An existing file
+/// is overwritten.
+/// @param[in] filename The name of the HDF5 file
+/// @param[in] mesh The mesh
+void write_mesh(const std::string& filename, const mesh::Mesh& mesh);
+
+/// Read a mesh from a checkpoint file (collective)
+/// @param[in] comm The MPI communicator
+/// @param[in] filename The name of the HDF5 file
+/// @param[in] element The coordinate element of the mesh
+/// @param[in] ghost_mode The type of ghost cells if the mesh is
+///   partitioned anew. On the same number of processes the ghost cells
+///   of the written mesh are restored.
+/// @return The mesh, and the global index of each (owned and ghost)
+///   cell of the mesh in the written mesh, for read_function
+std::pair<mesh::Mesh, std::vector<std::int64_t>>
+read_mesh(MPI_Comm comm, const std::string& filename,
+          const fem::CoordinateElement& element, mesh::GhostMode ghost_mode);
+
+/// Write a function to a checkpoint file holding its mesh (collective)
+/// @param[in] filename The name of the HDF5 file, written by write_mesh
+/// @param[in] u The function
+/// @param[in] name The name of the function in the file. The name must
+///   not be used by another function in the file.
+void write_function(const std::string& filename,
+                    const function::Function<PetscScalar>& u,
+                    const std::string& name);
+
+/// Read the coefficients of a function from a checkpoint file
+/// (collective)
+/// @param[in] filename The name of the HDF5 file
+/// @param[in,out] u The function, on a space with the element of the
+///   written function on the mesh returned by read_mesh
+/// @param[in] name The name of the function in the file
+/// @param[in] original_cell_index The index of each cell of the mesh
+///   in the written mesh, as returned by read_mesh
+void read_function(const std::string& filename,
+                   function::Function<PetscScalar>& u, const std::string& name,
+                   const std::vector<std::int64_t>& original_cell_index);
+
+} // namespace io::checkpoint
+} // namespace dolfinx
@@ -0,0 +1,184 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "partition_cache.h"
+#include "HDF5Interface.h"
+#include <array>
+#include <boost/filesystem.hpp>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/common/log.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Update a FNV-1a hash with n bytes of data
+std::uint64_t fnv1a(std::uint64_t h, const void* data, std::size_t n)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < n; ++i)
+    h = (h ^ bytes[i]) * 0x100000001b3;
+  return h;
+}
+//-----------------------------------------------------------------------------
+constexpr std::uint64_t fnv1a_basis = 0xcbf29ce484222325;
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+std::uint64_t io::partition_cache::compute_hash(
+    MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>& x)
+{
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& array = cells.array();
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& offsets
+      = cells.offsets();
+  const std::int64_t gdim = x.cols();
+  std::uint64_t h = fnv1a_basis;
+  h = fnv1a(h, array.data(), array.rows() * sizeof(std::int64_t));
+  h = fnv1a(h, offsets.data(), offsets.rows() * sizeof(std::int32_t));
+  h = fnv1a(h, &gdim, sizeof(gdim));
+  h = fnv1a(h, x.data(), x.size() * sizeof(double));
+
+  // Combine the hashes of all processes, in rank order
+  std::vector<std::uint64_t> hashes(dolfinx::MPI::size(comm));
+  MPI_Allgather(&h, 1, MPI_UINT64_T, hashes.data(), 1, MPI_UINT64_T, comm);
+  return fnv1a(fnv1a_basis, hashes.data(),
+               hashes.size() * sizeof(std::uint64_t));
+}
+//-----------------------------------------------------------------------------
+void io::partition_cache::write(MPI_Comm comm, const std::string& filename,
+                                const graph::AdjacencyList<std::int32_t>& dest,
+                                std::uint64_t hash)
+{
+  common::Timer timer("Write cell partition");
+
+  const int rank = dolfinx::MPI::rank(comm);
+  const int size = dolfinx::MPI::size(comm);
+  const std::int64_t num_cells = dest.num_nodes();
+  const std::int64_t num_links = dest.array().rows();
+  const std::int64_t cell_offset
+      = dolfinx::MPI::global_offset(comm, num_cells, true);
+  const std::int64_t link_offset
+      = dolfinx::MPI::global_offset(comm, num_links, true);
+  std::array<std::int64_t, 2> num_global;
+  const std::array<std::int64_t, 2> num_local = {num_cells, num_links};
+  MPI_Allreduce(num_local.data(), num_global.data(), 2, MPI_INT64_T, MPI_SUM,
+                comm);
+
+  std::vector<std::int32_t> num_dest(num_cells);
+  for (std::int32_t i = 0; i < num_cells; ++i)
+    num_dest[i] = dest.num_links(i);
+
+  const bool use_mpi_io = size > 1;
+  const hid_t h5_id
+      = HDF5Interface::open_file(comm, filename, "w", use_mpi_io);
+
+  // Number of processes, hash and number of cells
+  const std::array<std::int64_t, 3> info
+      = {size, static_cast<std::int64_t>(hash), num_global[0]};
+  HDF5Interface::write_dataset(h5_id, "/partition/info", info.data(),
+                               {rank == 0 ? 0 : 3, 3}, {3}, use_mpi_io);
+
+  HDF5Interface::write_dataset(h5_id, "/partition/num_destinations",
+                               num_dest.data(),
+                               {cell_offset, cell_offset + num_cells},
+                               {num_global[0]}, use_mpi_io);
+  HDF5Interface::write_dataset(h5_id, "/partition/destinations",
+                               dest.array().data(),
+                               {link_offset, link_offset + num_links},
+                               {num_global[1]}, use_mpi_io);
+
+  HDF5Interface::close_file(h5_id);
+}
+//-----------------------------------------------------------------------------
+std::optional<graph::AdjacencyList<std::int32_t>>
+io::partition_cache::read(MPI_Comm comm, const std::string& filename,
+                          std::uint64_t hash, std::int32_t num_cells)
+{
+  common::Timer timer("Read cell partition");
+
+  int exists = 0;
+  if (dolfinx::MPI::rank(comm) == 0)
+    exists = boost::filesystem::exists(filename);
+  MPI_Bcast(&exists, 1, MPI_INT, 0, comm);
+  if (!exists)
+    return std::nullopt;
+
+  const int size = dolfinx::MPI::size(comm);
+  const bool use_mpi_io = size > 1;
+  const hid_t h5_id
+      = HDF5Interface::open_file(comm, filename, "r", use_mpi_io);
+
+  // Check that the partition was computed for the same mesh data and
+  // number of processes
+  const std::vector<std::int64_t> info
+      = HDF5Interface::read_dataset<std::int64_t>(h5_id, "/partition/info",
+                                                  {-1, -1});
+  std::int64_t num_cells_global = 0;
+  const std::int64_t num_cells_local = num_cells;
+  MPI_Allreduce(&num_cells_local, &num_cells_global, 1, MPI_INT64_T, MPI_SUM,
+                comm);
+  if (info.size() != 3 or info[0] != size
+      or info[1] != static_cast<std::int64_t>(hash)
+      or info[2] != num_cells_global)
+  {
+    LOG(INFO) << "Cell partition in " << filename << " is out of date";
+    HDF5Interface::close_file(h5_id);
+    return std::nullopt;
+  }
+
+  const std::int64_t cell_offset
+      = dolfinx::MPI::global_offset(comm, num_cells_local, true);
+  const std::vector<std::int32_t> num_dest
+      = HDF5Interface::read_dataset<std::int32_t>(
+          h5_id, "/partition/num_destinations",
+          {cell_offset, cell_offset + num_cells_local});
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets(num_cells + 1);
+  offsets[0] = 0;
+  for (std::int32_t i = 0; i < num_cells; ++i)
+    offsets[i + 1] = offsets[i] + num_dest[i];
+
+  const std::int64_t num_links = offsets[num_cells];
+  const std::int64_t link_offset
+      = dolfinx::MPI::global_offset(comm, num_links, true);
+  const std::vector<std::int32_t> dest
+      = HDF5Interface::read_dataset<std::int32_t>(
+          h5_id, "/partition/destinations",
+          {link_offset, link_offset + num_links});
+  HDF5Interface::close_file(h5_id);
+
+  return graph::AdjacencyList<std::int32_t>(
+      Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>(
+          dest.data(), dest.size()),
+      offsets);
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> io::partition_cache::cell_destinations(
+    MPI_Comm comm, const std::string& filename,
+    const graph::AdjacencyList<std::int64_t>& cells,
+    const fem::CoordinateElement& element,
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>& x,
+    mesh::CellPartitioner partitioner)
+{
+  const std::uint64_t hash = compute_hash(comm, cells, x);
+  std::optional<graph::AdjacencyList<std::int32_t>> dest
+      = read(comm, filename, hash, cells.num_nodes());
+  if (dest)
+    return std::move(*dest);
+
+  graph::AdjacencyList<std::int32_t> dest_new
+      = mesh::compute_cell_destinations(comm, cells, element, x, partitioner);
+  write(comm, filename, dest_new, hash);
+  return dest_new;
+}
+//-----------------------------------------------------------------------------
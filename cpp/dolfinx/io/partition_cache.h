@@ -0,0 +1,93 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <dolfinx/mesh/Mesh.h>
+#include <mpi.h>
+#include <optional>
+#include <string>
+
+namespace dolfinx
+{
+namespace fem
+{
+class CoordinateElement;
+}
+
+namespace graph
+{
+template <typename T>
+class AdjacencyList;
+}
+
+/// Storage of computed cell partitions in HDF5 files, for reuse by
+/// later runs on the same mesh and number of processes
+
+namespace io::partition_cache
+{
+
+/// Compute a hash of the input data of a mesh (collective). The hash
+/// depends on the cells and node coordinates on each process and on
+/// the number of processes, and identifies the input data of a stored
+/// cell partition.
+/// @param[in] comm The MPI communicator
+/// @param[in] cells The cells on this process (node indices)
+/// @param[in] x The node coordinates on this process
+/// @return The hash (the same on all processes)
+std::uint64_t
+compute_hash(MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+             const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                Eigen::RowMajor>& x);
+
+/// Write the destination processes of the cells on each process to a
+/// HDF5 file, overwriting an existing file (collective)
+/// @param[in] comm The MPI communicator
+/// @param[in] filename The name of the HDF5 file
+/// @param[in] dest The destination processes of each cell on this
+///   process, see mesh::compute_cell_destinations
+/// @param[in] hash The hash of the mesh input data, see compute_hash
+void write(MPI_Comm comm, const std::string& filename,
+           const graph::AdjacencyList<std::int32_t>& dest, std::uint64_t hash);
+
+/// Read the destination processes of the cells on this process from a
+/// HDF5 file written by write (collective)
+/// @param[in] comm The MPI communicator
+/// @param[in] filename The name of the HDF5 file
+/// @param[in] hash The hash of the mesh input data, see compute_hash
+/// @param[in] num_cells The number of cells on this process
+/// @return The destination processes of each cell on this process, or
+///   nothing if the file does not exist or was written for a different
+///   mesh, number of processes or number of cells on a process
+std::optional<graph::AdjacencyList<std::int32_t>>
+read(MPI_Comm comm, const std::string& filename, std::uint64_t hash,
+     std::int32_t num_cells);
+
+/// Get the destination processes of the cells of a mesh to be created
+/// by mesh::create_mesh (collective). The destinations are read from a
+/// HDF5 file if it holds a partition of the same mesh data for the same
+/// number of processes, and are otherwise computed by
+/// mesh::compute_cell_destinations and written to the file.
+/// @param[in] comm The MPI communicator
+/// @param[in] filename The name of the HDF5 file
+/// @param[in] cells The cells on this process (node indices)
+/// @param[in] element The coordinate element
+/// @param[in] x The node coordinates on this process
+/// @param[in] partitioner The partitioner used if the destinations are
+///   computed
+/// @return The destination processes of each cell on this process
+graph::AdjacencyList<std::int32_t> cell_destinations(
+    MPI_Comm comm, const std::string& filename,
+    const graph::AdjacencyList<std::int64_t>& cells,
+    const fem::CoordinateElement& element,
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>& x,
+    mesh::CellPartitioner partitioner = mesh::CellPartitioner::graph);
+
+} // namespace io::partition_cache
+} // namespace dolfinx
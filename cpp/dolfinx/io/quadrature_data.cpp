@@ -0,0 +1,97 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "quadrature_data.h"
+#include "HDF5Interface.h"
+#include <algorithm>
+#include <array>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/function/QuadratureData.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+// Number of doubles per scalar (2 for complex values)
+constexpr int scalar_size = sizeof(PetscScalar) / sizeof(double);
+
+//-----------------------------------------------------------------------------
+// Get the index map of the cells of the quadrature data
+std::shared_ptr<const common::IndexMap>
+cell_map(const function::QuadratureData<PetscScalar>& q)
+{
+  std::shared_ptr<const mesh::Mesh> mesh = q.mesh();
+  assert(mesh);
+  const int tdim = mesh->topology().dim();
+  std::shared_ptr<const common::IndexMap> map
+      = mesh->topology().index_map(tdim);
+  assert(map);
+  return map;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+void io::quadrature_data::write(MPI_Comm comm, const std::string& filename,
+                                const std::string& name,
+                                const function::QuadratureData<PetscScalar>& q,
+                                const std::string& mode)
+{
+  common::Timer timer("Write quadrature data");
+
+  std::shared_ptr<const common::IndexMap> map = cell_map(q);
+  const std::int32_t num_cells = map->size_local();
+  const std::array<std::int64_t, 2> range = map->local_range();
+  const std::int64_t num_cols = q.values().cols() * scalar_size;
+
+  const bool use_mpi_io = dolfinx::MPI::size(comm) > 1;
+  const hid_t h5_id
+      = HDF5Interface::open_file(comm, filename, mode, use_mpi_io);
+  HDF5Interface::write_dataset(
+      h5_id, name, reinterpret_cast<const double*>(q.values().data()),
+      {range[0], range[0] + num_cells}, {map->size_global(), num_cols},
+      use_mpi_io);
+  HDF5Interface::close_file(h5_id);
+}
+//-----------------------------------------------------------------------------
+void io::quadrature_data::read(MPI_Comm comm, const std::string& filename,
+                               const std::string& name,
+                               function::QuadratureData<PetscScalar>& q)
+{
+  common::Timer timer("Read quadrature data");
+
+  std::shared_ptr<const common::IndexMap> map = cell_map(q);
+  const std::int32_t num_cells = map->size_local();
+  const std::array<std::int64_t, 2> range = map->local_range();
+  const std::int64_t num_cols = q.values().cols() * scalar_size;
+
+  const bool use_mpi_io = dolfinx::MPI::size(comm) > 1;
+  const hid_t h5_id
+      = HDF5Interface::open_file(comm, filename, "r", use_mpi_io);
+  const std::vector<std::int64_t> shape
+      = HDF5Interface::get_dataset_shape(h5_id, name);
+  if (shape.size() != 2 or shape[0] != map->size_global()
+      or shape[1] != num_cols)
+  {
+    HDF5Interface::close_file(h5_id);
+    throw std::runtime_error("Shape of dataset " + name
+                             + " does not match the quadrature data.");
+  }
+
+  const std::vector<double> values = HDF5Interface::read_dataset<double>(
+      h5_id, name, {range[0], range[0] + num_cells});
+  HDF5Interface::close_file(h5_id);
+
+  std::copy(values.begin(), values.end(),
+            reinterpret_cast<double*>(q.values().data()));
+  q.scatter_fwd();
+}
+//-----------------------------------------------------------------------------
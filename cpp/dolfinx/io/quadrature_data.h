@@ -0,0 +1,56 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <mpi.h>
+#include <petscsys.h>
+#include <string>
+
+namespace dolfinx
+{
+namespace function
+{
+template <typename T>
+class QuadratureData;
+}
+
+/// Checkpointing of quadrature data (see function::QuadratureData) in
+/// HDF5 files
+
+namespace io::quadrature_data
+{
+
+/// Write the values of quadrature data on the owned cells to a dataset
+/// of a HDF5 file (collective). The dataset has one row per cell, in
+/// the order of the global cell indices. Complex values are stored as
+/// pairs of real and imaginary parts.
+/// @param[in] comm The MPI communicator
+/// @param[in] filename The name of the HDF5 file
+/// @param[in] name The path of the dataset in the file, e.g.
+///   "/plastic_strain"
+/// @param[in] q The quadrature data
+/// @param[in] mode The file mode, "w" to create (or overwrite) the file
+///   or "a" to add the dataset to an existing file
+void write(MPI_Comm comm, const std::string& filename,
+           const std::string& name,
+           const function::QuadratureData<PetscScalar>& q,
+           const std::string& mode = "w");
+
+/// Read the values of quadrature data from a dataset of a HDF5 file
+/// written by write (collective). The data must have been written for
+/// the same mesh with the same cell distribution. The values of the
+/// ghost cells are updated from the owning processes.
+/// @param[in] comm The MPI communicator
+/// @param[in] filename The name of the HDF5 file
+/// @param[in] name The path of the dataset in the file
+/// @param[in,out] q The quadrature data. The number of points and values
+///   per point must match the dataset.
+void read(MPI_Comm comm, const std::string& filename, const std::string& name,
+          function::QuadratureData<PetscScalar>& q);
+
+} // namespace io::quadrature_data
+} // namespace dolfinx
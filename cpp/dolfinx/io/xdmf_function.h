@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "HDF5Interface.h"
 #include <hdf5.h>
 #include <mpi.h>
 #include <petscsys.h>
@@ -29,9 +30,13 @@ namespace io
 namespace xdmf_function
 {
 
-/// TODO
-void add_function(MPI_Comm comm, const function::Function<PetscScalar>& u,
-                  const double t, pugi::xml_node& xml_node, const hid_t h5_id);
+/// Add a function to an XDMF Grid node and write its values. Complex
+/// functions are written as two attributes, with the real and the
+/// imaginary parts. Instantiated for double and std::complex<double>.
+template <typename T>
+void add_function(MPI_Comm comm, const function::Function<T>& u,
+                  const double t, pugi::xml_node& xml_node, const hid_t h5_id,
+                  const HDF5Properties& properties = {});
 
 } // namespace xdmf_function
 } // namespace io
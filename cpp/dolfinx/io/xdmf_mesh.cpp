@@ -9,6 +9,7 @@
 #include "pugixml.hpp"
 #include "xdmf_read.h"
 #include "xdmf_utils.h"
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/fem/ElementDofLayout.h>
 
 using namespace dolfinx;
@@ -19,7 +20,8 @@ void xdmf_mesh::add_topology_data(
     MPI_Comm comm, pugi::xml_node& xml_node, const hid_t h5_id,
     const std::string path_prefix, const mesh::Topology& topology,
     const mesh::Geometry& geometry, const int dim,
-    const std::vector<std::int32_t>& active_entities)
+    const std::vector<std::int32_t>& active_entities,
+    const HDF5Properties& properties)
 {
   LOG(INFO) << "Adding topology data to node \"" << xml_node.path('/') << "\"";
 
@@ -134,13 +136,15 @@ void xdmf_mesh::add_topology_data(
 
   const bool use_mpi_io = (dolfinx::MPI::size(comm) > 1);
   xdmf_utils::add_data_item(topology_node, h5_id, h5_path, topology_data,
-                            offset, shape, number_type, use_mpi_io);
+                            offset, shape, number_type, use_mpi_io,
+                            properties);
 }
 //-----------------------------------------------------------------------------
 void xdmf_mesh::add_geometry_data(MPI_Comm comm, pugi::xml_node& xml_node,
                                   const hid_t h5_id,
                                   const std::string path_prefix,
-                                  const mesh::Geometry& geometry)
+                                  const mesh::Geometry& geometry,
+                                  const HDF5Properties& properties)
 {
 
   LOG(INFO) << "Adding geometry data to node \"" << xml_node.path('/') << "\"";
@@ -187,12 +191,13 @@ void xdmf_mesh::add_geometry_data(MPI_Comm comm, pugi::xml_node& xml_node,
       = dolfinx::MPI::global_offset(comm, num_points_local, true);
   const bool use_mpi_io = (dolfinx::MPI::size(comm) > 1);
   xdmf_utils::add_data_item(geometry_node, h5_id, h5_path, x, offset, shape, "",
-                            use_mpi_io);
+                            use_mpi_io, properties);
 }
 //----------------------------------------------------------------------------
 void xdmf_mesh::add_mesh(MPI_Comm comm, pugi::xml_node& xml_node,
                          const hid_t h5_id, const mesh::Mesh& mesh,
-                         const std::string name)
+                         const std::string name,
+                         const HDF5Properties& properties)
 {
   LOG(INFO) << "Adding mesh to node \"" << xml_node.path('/') << "\"";
 
@@ -215,10 +220,11 @@ void xdmf_mesh::add_mesh(MPI_Comm comm, pugi::xml_node& xml_node,
   std::iota(active_cells.begin(), active_cells.end(), 0);
 
   add_topology_data(comm, grid_node, h5_id, path_prefix, mesh.topology(),
-                    mesh.geometry(), tdim, active_cells);
+                    mesh.geometry(), tdim, active_cells, properties);
 
   // Add geometry node and attributes (including writing data)
-  add_geometry_data(comm, grid_node, h5_id, path_prefix, mesh.geometry());
+  add_geometry_data(comm, grid_node, h5_id, path_prefix, mesh.geometry(),
+                    properties);
 }
 //----------------------------------------------------------------------------
 Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
@@ -262,6 +268,37 @@ xdmf_mesh::read_geometry_data(MPI_Comm comm, const hid_t h5_id,
                                                          num_local_nodes, gdim);
 }
 //----------------------------------------------------------------------------
+mesh::NodeFetcher xdmf_mesh::geometry_reader(const hid_t h5_id,
+                                             const pugi::xml_node& node)
+{
+  pugi::xml_node geometry_node = node.child("Geometry");
+  assert(geometry_node);
+  pugi::xml_node geometry_data_node = geometry_node.child("DataItem");
+  assert(geometry_data_node);
+  if (std::string(geometry_data_node.attribute("Format").as_string())
+      != "HDF")
+  {
+    return nullptr;
+  }
+
+  const std::string path = xdmf_utils::get_hdf5_paths(geometry_data_node)[1];
+  const std::vector shape = HDF5Interface::get_dataset_shape(h5_id, path);
+  if (shape.size() != 2)
+    return nullptr;
+
+  const int gdim = shape[1];
+  return [h5_id, path, gdim](const std::vector<std::int64_t>& indices) {
+    common::Timer timer("Read geometry nodes of local cells (XDMF)");
+    const std::vector<double> x
+        = HDF5Interface::read_dataset_rows<double>(h5_id, path, indices);
+    return Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                        Eigen::RowMajor>(
+        Eigen::Map<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                      Eigen::RowMajor>>(x.data(),
+                                                        indices.size(), gdim));
+  };
+}
+//----------------------------------------------------------------------------
 Eigen::Array<std::int64_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
 xdmf_mesh::read_topology_data(MPI_Comm comm, const hid_t h5_id,
                               const pugi::xml_node& node)
@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include "HDF5Interface.h"
 #include <Eigen/Dense>
+#include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/cell_types.h>
 #include <hdf5.h>
 #include <mpi.h>
@@ -36,9 +38,11 @@ namespace io::xdmf_mesh
 /// Add Mesh to xml node
 ///
 /// Creates new Grid with Topology and Geometry xml nodes for mesh. In
-/// HDF file data is stored under path prefix.
+/// HDF file data is stored under path prefix. The HDF5 datasets are
+/// written with the given properties.
 void add_mesh(MPI_Comm comm, pugi::xml_node& xml_node, const hid_t h5_id,
-              const mesh::Mesh& mesh, const std::string path_prefix);
+              const mesh::Mesh& mesh, const std::string path_prefix,
+              const HDF5Properties& properties = {});
 
 /// Add Topology xml node
 /// @param[in] comm
@@ -51,16 +55,19 @@ void add_mesh(MPI_Comm comm, pugi::xml_node& xml_node, const hid_t h5_id,
 /// @param[in] active_entities Local-to-process indices of mesh entities
 ///   whose topology will be saved. This is used to save subsets of
 ///   Mesh.
+/// @param[in] properties Properties of the HDF5 datasets
 void add_topology_data(MPI_Comm comm, pugi::xml_node& xml_node,
                        const hid_t h5_id, const std::string path_prefix,
                        const mesh::Topology& topology,
                        const mesh::Geometry& geometry, const int cell_dim,
-                       const std::vector<std::int32_t>& active_entities);
+                       const std::vector<std::int32_t>& active_entities,
+                       const HDF5Properties& properties = {});
 
 /// Add Geometry xml node
 void add_geometry_data(MPI_Comm comm, pugi::xml_node& xml_node,
                        const hid_t h5_id, const std::string path_prefix,
-                       const mesh::Geometry& geometry);
+                       const mesh::Geometry& geometry,
+                       const HDF5Properties& properties = {});
 
 /// Read Geometry data
 /// @returns geometry
@@ -68,6 +75,13 @@ Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
 read_geometry_data(MPI_Comm comm, const hid_t h5_id,
                    const pugi::xml_node& node);
 
+/// Create a function that reads geometry nodes by global index
+/// directly from the HDF5 file, see mesh::create_mesh_fetching_nodes
+/// @returns The function, or an empty function if the geometry data is
+///   not stored in a two-dimensional HDF5 dataset
+mesh::NodeFetcher geometry_reader(const hid_t h5_id,
+                                  const pugi::xml_node& node);
+
 /// Read Topology data
 /// @returns ((cell type, degree), topology)
 Eigen::Array<std::int64_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
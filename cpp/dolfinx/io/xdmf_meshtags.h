@@ -26,7 +26,8 @@ namespace xdmf_meshtags
 template <typename T>
 void add_meshtags(MPI_Comm comm, const mesh::MeshTags<T>& meshtags,
                   pugi::xml_node& xml_node, const hid_t h5_id,
-                  const std::string name)
+                  const std::string name,
+                  const HDF5Properties& properties = {})
 {
   // Get mesh
   assert(meshtags.mesh());
@@ -36,7 +37,7 @@ void add_meshtags(MPI_Comm comm, const mesh::MeshTags<T>& meshtags,
   const std::string path_prefix = "/MeshTags/" + name;
   xdmf_mesh::add_topology_data(comm, xml_node, h5_id, path_prefix,
                                mesh->topology(), mesh->geometry(), dim,
-                               active_entities);
+                               active_entities, properties);
 
   // Add attribute node with values
   pugi::xml_node attribute_node = xml_node.append_child("Attribute");
@@ -54,7 +55,7 @@ void add_meshtags(MPI_Comm comm, const mesh::MeshTags<T>& meshtags,
   const bool use_mpi_io = (dolfinx::MPI::size(comm) > 1);
   xdmf_utils::add_data_item(attribute_node, h5_id, path_prefix + "/Values",
                             meshtags.values(), offset, {global_num_values, 1},
-                            "", use_mpi_io);
+                            "", use_mpi_io, properties);
 }
 
 } // namespace xdmf_meshtags
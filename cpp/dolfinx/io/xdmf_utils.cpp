@@ -21,6 +21,8 @@
 #include <dolfinx/mesh/Topology.h>
 #include <dolfinx/mesh/cell_types.h>
 #include <dolfinx/mesh/utils.h>
+#include <algorithm>
+#include <complex>
 #include <map>
 
 using namespace dolfinx;
@@ -30,7 +32,8 @@ namespace
 {
 // Get data width - normally the same as u.value_size(), but expand for
 // 2D vector/tensor because XDMF presents everything as 3D
-std::int64_t get_padded_width(const function::Function<PetscScalar>& u)
+template <typename T>
+std::int64_t get_padded_width(const function::Function<T>& u)
 {
   const int width = u.function_space()->element()->value_size();
   const int rank = u.function_space()->element()->value_rank();
@@ -187,12 +190,13 @@ std::int64_t xdmf_utils::get_num_cells(const pugi::xml_node& topology_node)
   return std::max(num_cells_topology, tdims[0]);
 }
 //----------------------------------------------------------------------------
-std::vector<PetscScalar>
-xdmf_utils::get_point_data_values(const function::Function<PetscScalar>& u)
+template <typename T>
+std::vector<T>
+xdmf_utils::get_point_data_values(const function::Function<T>& u)
 {
   std::shared_ptr<const mesh::Mesh> mesh = u.function_space()->mesh();
   assert(mesh);
-  Eigen::Array<PetscScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+  Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
       data_values = u.compute_point_values();
 
   const int width = get_padded_width(u);
@@ -203,7 +207,7 @@ xdmf_utils::get_point_data_values(const function::Function<PetscScalar>& u)
 
   // FIXME: Unpick the below code for the new layout of data from
   //        GenericFunction::compute_vertex_values
-  std::vector<PetscScalar> _data_values(width * num_local_points, 0.0);
+  std::vector<T> _data_values(width * num_local_points, 0.0);
   const int value_rank = u.function_space()->element()->value_rank();
   if (value_rank > 0)
   {
@@ -221,7 +225,7 @@ xdmf_utils::get_point_data_values(const function::Function<PetscScalar>& u)
   }
   else
   {
-    _data_values = std::vector<PetscScalar>(
+    _data_values = std::vector<T>(
         data_values.data(),
         data_values.data() + data_values.rows() * data_values.cols());
   }
@@ -229,8 +233,8 @@ xdmf_utils::get_point_data_values(const function::Function<PetscScalar>& u)
   return _data_values;
 }
 //-----------------------------------------------------------------------------
-std::vector<PetscScalar>
-xdmf_utils::get_cell_data_values(const function::Function<PetscScalar>& u)
+template <typename T>
+std::vector<T> xdmf_utils::get_cell_data_values(const function::Function<T>& u)
 {
   assert(u.function_space()->dofmap());
   const auto mesh = u.function_space()->mesh();
@@ -260,9 +264,9 @@ xdmf_utils::get_cell_data_values(const function::Function<PetscScalar>& u)
   }
 
   // Get values
-  std::vector<PetscScalar> data_values(dof_set.size());
+  std::vector<T> data_values(dof_set.size());
   {
-    const Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>& x = u.x()->array();
+    const Eigen::Matrix<T, Eigen::Dynamic, 1>& x = u.x()->array();
     for (std::size_t i = 0; i < dof_set.size(); ++i)
       data_values[i] = x[dof_set[i]];
   }
@@ -273,7 +277,7 @@ xdmf_utils::get_cell_data_values(const function::Function<PetscScalar>& u)
     data_values.resize(3 * num_local_cells);
     for (int j = (num_local_cells - 1); j >= 0; --j)
     {
-      PetscScalar nd[3] = {data_values[j * 2], data_values[j * 2 + 1], 0};
+      T nd[3] = {data_values[j * 2], data_values[j * 2 + 1], 0};
       std::copy(nd, nd + 3, &data_values[j * 3]);
     }
   }
@@ -282,21 +286,32 @@ xdmf_utils::get_cell_data_values(const function::Function<PetscScalar>& u)
     data_values.resize(9 * num_local_cells);
     for (int j = (num_local_cells - 1); j >= 0; --j)
     {
-      PetscScalar nd[9] = {data_values[j * 4],
-                           data_values[j * 4 + 1],
-                           0,
-                           data_values[j * 4 + 2],
-                           data_values[j * 4 + 3],
-                           0,
-                           0,
-                           0,
-                           0};
+      T nd[9] = {data_values[j * 4],
+                 data_values[j * 4 + 1],
+                 0,
+                 data_values[j * 4 + 2],
+                 data_values[j * 4 + 3],
+                 0,
+                 0,
+                 0,
+                 0};
       std::copy(nd, nd + 9, &data_values[j * 9]);
     }
   }
   return data_values;
 }
 //-----------------------------------------------------------------------------
+/// @cond
+template std::vector<double>
+xdmf_utils::get_point_data_values(const function::Function<double>&);
+template std::vector<std::complex<double>> xdmf_utils::get_point_data_values(
+    const function::Function<std::complex<double>>&);
+template std::vector<double>
+xdmf_utils::get_cell_data_values(const function::Function<double>&);
+template std::vector<std::complex<double>> xdmf_utils::get_cell_data_values(
+    const function::Function<std::complex<double>>&);
+/// @endcond
+//-----------------------------------------------------------------------------
 std::string xdmf_utils::vtk_cell_type_str(mesh::CellType cell_type,
                                           int num_nodes)
 {
@@ -377,174 +392,147 @@ xdmf_utils::extract_local_entities(
   const int num_vertices_per_entity = mesh::cell_num_entities(entity_type, 0);
   assert(entity_vertex_dofs.size() == (std::size_t)num_vertices_per_entity);
 
-  // Throw away input global indices which do not belong to entity vertices
-  // This decreases the amount of data needed in parallel communication
-  Eigen::Array<std::int64_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      entities_vertices(entities.rows(), num_vertices_per_entity);
-  for (Eigen::Index e = 0; e < entities_vertices.rows(); ++e)
-  {
-    for (Eigen::Index i = 0; i < entities_vertices.cols(); ++i)
-      entities_vertices(e, i) = entities(e, entity_vertex_dofs[i]);
-  }
-
-  // -------------------
-  // 1. Send this rank's global "input" nodes indices to the
-  //    'postmaster' rank, and receive global "input" nodes for which
-  //    this rank is the postmaster
-
-  // Get "input" global node indices (as in the input file before any
-  // internal re-ordering)
+  // Input global index (as in the input file before any internal
+  // re-ordering) of the geometry node of each local vertex
   const std::vector<std::int64_t>& nodes_g
       = mesh.geometry().input_global_indices();
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
+  auto vertex_map = mesh.topology().index_map(0);
+  assert(vertex_map);
+  std::vector<std::int64_t> vertex_nodes(vertex_map->size_local()
+                                         + vertex_map->num_ghosts());
+  for (int c = 0; c < c_to_v->num_nodes(); ++c)
+  {
+    auto vertices = c_to_v->links(c);
+    auto x_dofs = x_dofmap.links(c);
+    for (int v = 0; v < vertices.rows(); ++v)
+      vertex_nodes[vertices[v]] = nodes_g[x_dofs[cell_vertex_dofs[v]]];
+  }
 
-  // Send input global indices to 'post master' rank, based on input
-  // global index value
+  // The tagged entities are joined with the local entities by a
+  // distributed hash join on the smallest input vertex index of each
+  // entity (its key). The 'postmaster' rank of a key (determined by
+  // the key value) receives the keys of the local vertices of all
+  // ranks, and the tagged entities with this key, and sends each
+  // entity only to the ranks that have the key vertex (only these can
+  // have the entity). Only vertex nodes are sent, and the sends are
+  // packed such that each step is one all-to-all.
   const std::int64_t num_nodes_g = mesh.geometry().index_map()->size_global();
   const MPI_Comm comm = mesh.mpi_comm();
   const int comm_size = MPI::size(comm);
-  // NOTE: could make this int32_t be sending: index <- index - dest_rank_offset
-  std::vector<std::vector<std::int64_t>> nodes_g_send(comm_size);
-  for (std::int64_t node : nodes_g)
+
+  // -------------------
+  // 1. Send the input indices of the local vertices to the postmaster
+  //    ranks, and receive the vertices for which this rank is the
+  //    postmaster
+  std::vector<std::vector<std::int64_t>> nodes_send(comm_size);
+  for (std::int64_t node : vertex_nodes)
   {
-    // TODO: Optimise this call by adding 'vectorised verion of
-    //       MPI::index_owner
-    // Figure out which process is the postmaster for the input global index
-    const std::int32_t p
-        = dolfinx::MPI::index_owner(comm_size, node, num_nodes_g);
-    nodes_g_send[p].push_back(node);
+    nodes_send[dolfinx::MPI::index_owner(comm_size, node, num_nodes_g)]
+        .push_back(node);
   }
-
-  // Send/receive
-  const graph::AdjacencyList<std::int64_t> nodes_g_recv
-      = MPI::all_to_all(comm, graph::AdjacencyList<std::int64_t>(nodes_g_send));
+  const graph::AdjacencyList<std::int64_t> nodes_recv
+      = MPI::all_to_all(comm, graph::AdjacencyList<std::int64_t>(nodes_send));
+  nodes_send.clear();
 
   // -------------------
-  // 2. Send the entity key (nodes list) and tag to the postmaster based
-  //    on the lowest index node in the entity 'key'
+  // 2. Send the entity (sorted input vertex indices) and tag to the
+  //    postmaster of its smallest vertex, packed as num_vertices + 1
+  //    values per entity
   //
   //    NOTE: Stage 2 doesn't depend on the data received in Step 1, so
-  //    data (i) the communication could be combined, or (ii) the
-  //    communication in Step 1 could be make non-blocking.
-
+  //    the communication could be made non-blocking.
+  const int stride = num_vertices_per_entity + 1;
   std::vector<std::vector<std::int64_t>> entities_send(comm_size);
-  std::vector<std::vector<std::int32_t>> values_send(comm_size);
   std::vector<std::int64_t> entity(num_vertices_per_entity);
-  for (std::int32_t e = 0; e < entities_vertices.rows(); ++e)
+  for (std::int32_t e = 0; e < entities.rows(); ++e)
   {
-    // Copy vertices for entity and sort
-    std::copy(entities_vertices.row(e).data(),
-              entities_vertices.row(e).data() + entities_vertices.cols(),
-              entity.begin());
+    for (int i = 0; i < num_vertices_per_entity; ++i)
+      entity[i] = entities(e, entity_vertex_dofs[i]);
     std::sort(entity.begin(), entity.end());
-
-    // Determine postmaster based on lowest entity node
-    const std::int32_t p
-        = dolfinx::MPI::index_owner(comm_size, entity.front(), num_nodes_g);
-    entities_send[p].insert(entities_send[p].end(), entity.begin(),
-                            entity.end());
-    values_send[p].push_back(values[e]);
+    std::vector<std::int64_t>& send = entities_send[dolfinx::MPI::index_owner(
+        comm_size, entity.front(), num_nodes_g)];
+    send.insert(send.end(), entity.begin(), entity.end());
+    send.push_back(values[e]);
   }
-
-  // TODO: Pack into one MPI call
   const graph::AdjacencyList<std::int64_t> entities_recv = MPI::all_to_all(
       comm, graph::AdjacencyList<std::int64_t>(entities_send));
-  const graph::AdjacencyList<std::int32_t> values_recv
-      = MPI::all_to_all(comm, graph::AdjacencyList<std::int32_t>(values_send));
+  entities_send.clear();
 
   // -------------------
-  // 3. As 'postmaster', send back the entity key (vertex list) and tag
-  //    value to ranks that possibly need the data. Do this based on the
-  //    first node index in the entity key.
-
-  // NOTE: Could: (i) use a std::unordered_multimap, or (ii) only send
-  // owned nodes to the postmaster and use map, unordered_map or
-  // std::vector<pair>>, followed by a neighborhood all_to_all at the
-  // end.
-  //
-  // Build map from global node index to ranks that have the node
-  std::multimap<std::int64_t, int> node_to_rank;
-  for (int p = 0; p < nodes_g_recv.num_nodes(); ++p)
+  // 3. As postmaster, send the received entities and tags to the ranks
+  //    that have the smallest vertex of the entity
+
+  // Sorted (vertex input index, rank) pairs of the received vertices
+  std::vector<std::pair<std::int64_t, int>> node_to_rank;
+  node_to_rank.reserve(nodes_recv.array().rows());
+  for (int p = 0; p < nodes_recv.num_nodes(); ++p)
   {
-    auto nodes = nodes_g_recv.links(p);
-    for (int i = 0; i < nodes.rows(); ++i)
-      node_to_rank.insert({nodes(i), p});
+    auto nodes = nodes_recv.links(p);
+    for (Eigen::Index i = 0; i < nodes.rows(); ++i)
+      node_to_rank.push_back({nodes[i], p});
   }
+  std::sort(node_to_rank.begin(), node_to_rank.end());
 
-  // Figure out which processes are owners of received nodes
-  std::vector<std::vector<std::int64_t>> send_nodes_owned(comm_size);
-  std::vector<std::vector<std::int32_t>> send_vals_owned(comm_size);
-
-  const Eigen::Map<const Eigen::Array<std::int64_t, Eigen::Dynamic,
-                                      Eigen::Dynamic, Eigen::RowMajor>>
-      _entities_recv(entities_recv.array().data(),
-                     entities_recv.array().rows() / num_vertices_per_entity,
-                     num_vertices_per_entity);
-  auto _values_recv = values_recv.array();
-  assert(_values_recv.rows() == _entities_recv.rows());
-  for (int e = 0; e < _entities_recv.rows(); ++e)
+  std::vector<std::vector<std::int64_t>> send_entities_owned(comm_size);
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& _entities_recv
+      = entities_recv.array();
+  for (Eigen::Index e = 0; e < _entities_recv.rows() / stride; ++e)
   {
-    // Find ranks that have node0
-    auto [it0, it1] = node_to_rank.equal_range(_entities_recv(e, 0));
-    for (auto it = it0; it != it1; ++it)
+    const std::int64_t* ent = _entities_recv.data() + e * stride;
+    auto it = std::lower_bound(node_to_rank.begin(), node_to_rank.end(),
+                               std::pair<std::int64_t, int>(ent[0], 0));
+    for (; it != node_to_rank.end() and it->first == ent[0]; ++it)
     {
-      const int p1 = it->second;
-      send_nodes_owned[p1].insert(
-          send_nodes_owned[p1].end(), _entities_recv.row(e).data(),
-          _entities_recv.row(e).data() + _entities_recv.cols());
-      send_vals_owned[p1].push_back(_values_recv(e));
+      send_entities_owned[it->second].insert(
+          send_entities_owned[it->second].end(), ent, ent + stride);
     }
   }
-
-  // TODO: Pack into one MPI call
   const graph::AdjacencyList<std::int64_t> recv_ents = MPI::all_to_all(
-      comm, graph::AdjacencyList<std::int64_t>(send_nodes_owned));
-  const graph::AdjacencyList<std::int32_t> recv_vals = MPI::all_to_all(
-      comm, graph::AdjacencyList<std::int32_t>(send_vals_owned));
+      comm, graph::AdjacencyList<std::int64_t>(send_entities_owned));
+  send_entities_owned.clear();
 
   // -------------------
-  // 4. From the received (key, value) data, determine which keys
-  //    (entities) are on this process.
-
-  // TODO: Rather than using std::map<std::vector<std::int64_t>,
-  //       std::int32_t>, use a rectangular Eigen::Array to avoid the
-  //       cost of std::vector<std::int64_t> allocations, and sort the
-  //       Array by row.
-  //
-  // TODO: We have already received possibly tagged entities from other
-  //       ranks, so we could use the received data to avoid creating
-  //       the std::map for *all* entities and just for candidate
-  //       entities.
-
-  // Build map from input global indices to local vertex numbers
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
-  std::map<std::int64_t, std::int32_t> igi_to_vertex;
-
-  for (int c = 0; c < c_to_v->num_nodes(); ++c)
-  {
-    auto vertices = c_to_v->links(c);
-    auto x_dofs = x_dofmap.links(c);
-    for (int v = 0; v < vertices.rows(); ++v)
-      igi_to_vertex[nodes_g[x_dofs[cell_vertex_dofs[v]]]] = vertices[v];
-  }
-
-  // Apply map and obtain entities defined with local vertex numbers
+  // 4. Map the received entities to local vertex indices. Entities
+  //    with vertices that are not on this rank are not on this rank.
+
+  // Sorted (vertex input index, local vertex index) pairs
+  std::vector<std::pair<std::int64_t, std::int32_t>> node_to_vertex(
+      vertex_nodes.size());
+  for (std::size_t v = 0; v < vertex_nodes.size(); ++v)
+    node_to_vertex[v] = {vertex_nodes[v], static_cast<std::int32_t>(v)};
+  std::sort(node_to_vertex.begin(), node_to_vertex.end());
+
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& _recv_ents
+      = recv_ents.array();
+  const Eigen::Index num_recv = _recv_ents.rows() / stride;
   Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      entities_local(recv_ents.array().rows() / num_vertices_per_entity,
-                     num_vertices_per_entity);
-
-  std::vector<std::int32_t> values_new(recv_vals.array().data(),
-                                       recv_vals.array().data()
-                                           + recv_vals.array().rows());
-  assert(recv_vals.array().rows() == entities_local.rows());
-
-  for (Eigen::Index e = 0; e < entities_local.rows(); ++e)
+      entities_local(num_recv, num_vertices_per_entity);
+  std::vector<std::int32_t> values_new;
+  values_new.reserve(num_recv);
+  Eigen::Index num_local = 0;
+  for (Eigen::Index e = 0; e < num_recv; ++e)
   {
-    for (Eigen::Index i = 0; i < entities_local.cols(); ++i)
+    const std::int64_t* ent = _recv_ents.data() + e * stride;
+    bool local = true;
+    for (int i = 0; i < num_vertices_per_entity and local; ++i)
+    {
+      auto it = std::lower_bound(node_to_vertex.begin(), node_to_vertex.end(),
+                                 std::pair<std::int64_t, std::int32_t>(
+                                     ent[i], 0));
+      if (it == node_to_vertex.end() or it->first != ent[i])
+        local = false;
+      else
+        entities_local(num_local, i) = it->second;
+    }
+
+    if (local)
     {
-      entities_local(e, i)
-          = igi_to_vertex[recv_ents.array()[e * num_vertices_per_entity + i]];
+      values_new.push_back(ent[num_vertices_per_entity]);
+      ++num_local;
     }
   }
+  entities_local.conservativeResize(num_local, num_vertices_per_entity);
 
   return {entities_local, values_new};
 }
@@ -61,13 +61,14 @@ std::vector<std::int64_t> get_dataset_shape(const pugi::xml_node& dataset_node);
 std::int64_t get_num_cells(const pugi::xml_node& topology_node);
 
 /// Get point data values for linear or quadratic mesh into flattened 2D
-/// array
-std::vector<PetscScalar>
-get_point_data_values(const function::Function<PetscScalar>& u);
+/// array. Instantiated for double and std::complex<double>.
+template <typename T>
+std::vector<T> get_point_data_values(const function::Function<T>& u);
 
-/// Get cell data values as a flattened 2D array
-std::vector<PetscScalar>
-get_cell_data_values(const function::Function<PetscScalar>& u);
+/// Get cell data values as a flattened 2D array. Instantiated for
+/// double and std::complex<double>.
+template <typename T>
+std::vector<T> get_cell_data_values(const function::Function<T>& u);
 
 /// Get the VTK string identifier
 std::string vtk_cell_type_str(mesh::CellType cell_type, int num_nodes);
@@ -93,7 +94,8 @@ void add_data_item(pugi::xml_node& xml_node, const hid_t h5_id,
                    const std::string h5_path, const T& x,
                    const std::int64_t offset,
                    const std::vector<std::int64_t> shape,
-                   const std::string number_type, const bool use_mpi_io)
+                   const std::string number_type, const bool use_mpi_io,
+                   const HDF5Properties& properties = {})
 {
   // Add DataItem node
   assert(xml_node);
@@ -148,7 +150,7 @@ void add_data_item(pugi::xml_node& xml_node, const hid_t h5_id,
 
     const std::array local_range{offset, offset + local_shape0};
     HDF5Interface::write_dataset(h5_id, h5_path, x.data(), local_range, shape,
-                                 use_mpi_io, false);
+                                 use_mpi_io, properties);
 
     // Add partitioning attribute to dataset
     // std::vector<std::size_t> partitions;
@@ -0,0 +1,540 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "SparsityPattern.h"
+#include "Vector.h"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <array>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace dolfinx::la
+{
+
+/// Distributed sparse matrix in compressed sparse row (CSR) format
+///
+/// The rows of the row IndexMap that are owned by this process are
+/// stored in a diagonal block (owned columns) and an off-diagonal block
+/// (unowned columns), in the layout of a PETSc MPIAIJ matrix. The ghost
+/// rows of the row IndexMap are stored in a third block, so that values
+/// can be added to all rows using local (process-wise) indices, e.g.
+/// during assembly. The ghost row values are added to the owned rows
+/// of the owning processes by scatter_rev_begin/scatter_rev_end.
+
+template <typename T>
+class MatrixCSR
+{
+public:
+  /// Rows of a block of the matrix in CSR format. Column indices are
+  /// local indices of the column map of the matrix (see column_map),
+  /// and are sorted within each row.
+  struct Block
+  {
+    /// Offsets of the rows into cols and values
+    std::vector<std::int32_t> row_ptr;
+
+    /// Column indices
+    std::vector<std::int32_t> cols;
+
+    /// Values
+    std::vector<T> values;
+  };
+
+  /// Create a matrix with the non-zero structure of a sparsity pattern
+  /// (collective). The matrix is zeroed.
+  /// @param[in] pattern A finalised sparsity pattern. Blocked patterns
+  ///   are not supported.
+  explicit MatrixCSR(const SparsityPattern& pattern);
+
+  // Copy constructor (disabled)
+  MatrixCSR(const MatrixCSR& A) = delete;
+
+  /// Move constructor
+  MatrixCSR(MatrixCSR&& A) = default;
+
+  /// Destructor
+  ~MatrixCSR() = default;
+
+  // Assignment operator (disabled)
+  MatrixCSR& operator=(const MatrixCSR& A) = delete;
+
+  /// Move assignment operator
+  MatrixCSR& operator=(MatrixCSR&& A) = default;
+
+  /// Index map of the rows (dim = 0) and columns (dim = 1) of the
+  /// sparsity pattern. Local indices of add and set refer to these
+  /// maps.
+  std::shared_ptr<const common::IndexMap> index_map(int dim) const
+  {
+    return _index_maps.at(dim);
+  }
+
+  /// Map of the columns of the stored blocks (block size 1). The owned
+  /// columns are the owned columns of index_map(1), and the ghost
+  /// columns are all unowned columns of the stored rows, sorted by
+  /// global index.
+  std::shared_ptr<const common::IndexMap> column_map() const
+  {
+    return _col_map;
+  }
+
+  /// Diagonal block of the owned rows
+  const Block& diagonal() const { return _diagonal; }
+
+  /// Diagonal block of the owned rows
+  Block& diagonal() { return _diagonal; }
+
+  /// Off-diagonal block of the owned rows
+  const Block& off_diagonal() const { return _off_diagonal; }
+
+  /// Off-diagonal block of the owned rows
+  Block& off_diagonal() { return _off_diagonal; }
+
+  /// Ghost rows
+  const Block& ghost() const { return _ghost; }
+
+  /// Set all entries, including the ghost rows, to a value
+  /// @param[in] x The value
+  void set(T x)
+  {
+    std::fill(_diagonal.values.begin(), _diagonal.values.end(), x);
+    std::fill(_off_diagonal.values.begin(), _off_diagonal.values.end(), x);
+    std::fill(_ghost.values.begin(), _ghost.values.end(), x);
+  }
+
+  /// Add a dense block of values to the matrix. The entries must be in
+  /// the sparsity pattern.
+  /// @param[in] nr Number of rows
+  /// @param[in] rows Row indices, local with respect to index_map(0)
+  ///   and including ghost rows
+  /// @param[in] nc Number of columns
+  /// @param[in] cols Column indices, local with respect to index_map(1)
+  /// @param[in] vals The values (row-major, nr x nc)
+  /// @return 0
+  int add(std::int32_t nr, const std::int32_t* rows, std::int32_t nc,
+          const std::int32_t* cols, const T* vals)
+  {
+    insert(nr, rows, nc, cols, vals, [](T& a, T b) { a += b; });
+    return 0;
+  }
+
+  /// Set a dense block of values in the matrix. The entries must be in
+  /// the sparsity pattern.
+  /// @param[in] nr Number of rows
+  /// @param[in] rows Row indices, local with respect to index_map(0)
+  ///   and including ghost rows
+  /// @param[in] nc Number of columns
+  /// @param[in] cols Column indices, local with respect to index_map(1)
+  /// @param[in] vals The values (row-major, nr x nc)
+  /// @return 0
+  int set(std::int32_t nr, const std::int32_t* rows, std::int32_t nc,
+          const std::int32_t* cols, const T* vals)
+  {
+    insert(nr, rows, nc, cols, vals, [](T& a, T b) { a = b; });
+    return 0;
+  }
+
+  /// Get a function that adds values to the matrix, e.g. for passing
+  /// to fem::assemble_matrix. The values may be of another scalar type
+  /// U and are converted to T, e.g. to assemble a form with double
+  /// precision kernels into a single precision matrix for a
+  /// preconditioner.
+  /// @return A function for adding values (see add)
+  template <typename U = T>
+  auto mat_add_values()
+  {
+    return [this](std::int32_t nr, const std::int32_t* rows, std::int32_t nc,
+                  const std::int32_t* cols, const U* vals) {
+      this->insert(nr, rows, nc, cols, vals,
+                   [](T& a, U b) { a += static_cast<T>(b); });
+      return 0;
+    };
+  }
+
+  /// Get a function that sets values in the matrix
+  /// @return A function for setting values (see set)
+  auto mat_set_values()
+  {
+    return [this](std::int32_t nr, const std::int32_t* rows, std::int32_t nc,
+                  const std::int32_t* cols, const T* vals) {
+      return this->set(nr, rows, nc, cols, vals);
+    };
+  }
+
+  /// Start sending the ghost row values to the owning processes
+  /// (collective). The values are copied into a send buffer, so the
+  /// matrix can be modified before the communication is completed with
+  /// scatter_rev_end.
+  void scatter_rev_begin();
+
+  /// Complete the communication started by scatter_rev_begin and add
+  /// the received ghost row values to the owned rows. The ghost rows
+  /// are not modified.
+  void scatter_rev_end();
+
+  /// Add the ghost row values to the owned rows of the owning processes
+  /// (collective)
+  void finalize()
+  {
+    scatter_rev_begin();
+    scatter_rev_end();
+  }
+
+  /// Compute the matrix-vector product y = Ax for the owned rows
+  /// (collective). The ghost values of x are not used; the values of
+  /// the unowned columns are received from the owning processes. The
+  /// ghost entries of y are not modified.
+  /// @param[in] x Vector with the layout of the columns (index_map(1))
+  /// @param[in,out] y Vector with the layout of the rows (index_map(0))
+  /// @param[in] num_threads Number of threads for computing the product
+  void mult(const Vector<T>& x, Vector<T>& y, int num_threads = 1) const;
+
+private:
+  // Add or set (depending on op) the values of a dense block
+  template <typename U, typename Op>
+  void insert(std::int32_t nr, const std::int32_t* rows, std::int32_t nc,
+              const std::int32_t* cols, const U* vals, Op op)
+  {
+    const std::int32_t num_rows = _diagonal.row_ptr.size() - 1;
+    const std::int32_t num_cols = _col_map->size_local();
+    for (std::int32_t i = 0; i < nr; ++i)
+    {
+      const std::int32_t r = rows[i];
+      for (std::int32_t j = 0; j < nc; ++j)
+      {
+        std::int32_t c = cols[j];
+        if (c >= num_cols)
+          c = _ghost_cols[c - num_cols];
+
+        Block& block = r < num_rows
+                           ? (c < num_cols ? _diagonal : _off_diagonal)
+                           : _ghost;
+        const std::int32_t row = r < num_rows ? r : r - num_rows;
+        assert(row + 1 < (std::int32_t)block.row_ptr.size());
+        auto begin = block.cols.begin() + block.row_ptr[row];
+        auto end = block.cols.begin() + block.row_ptr[row + 1];
+        auto it = std::lower_bound(begin, end, c);
+        if (it == end or *it != c)
+          throw std::runtime_error("Entry not in the sparsity pattern.");
+        op(block.values[std::distance(block.cols.begin(), it)],
+           vals[i * nc + j]);
+      }
+    }
+  }
+
+  // Row and column maps of the sparsity pattern
+  std::array<std::shared_ptr<const common::IndexMap>, 2> _index_maps;
+
+  // Map of the columns of the stored blocks
+  std::shared_ptr<const common::IndexMap> _col_map;
+
+  // Column (in _col_map) of each ghost column of index_map(1)
+  std::vector<std::int32_t> _ghost_cols;
+
+  // Blocks of the owned rows and ghost rows
+  Block _diagonal, _off_diagonal, _ghost;
+
+  // Neighbourhood communicator (ghost to owner) of the row map
+  MPI_Comm _comm = MPI_COMM_NULL;
+
+  // Positions in _ghost.values of the values to send, ordered by
+  // destination, and the send sizes and displacements
+  std::vector<std::int32_t> _send_pos, _send_sizes, _send_displs;
+
+  // Positions of the received values in the owned rows. Positions p
+  // below the number of diagonal block values refer to the diagonal
+  // block, others to value p - _diagonal.values.size() of the
+  // off-diagonal block.
+  std::vector<std::int32_t> _recv_pos, _recv_sizes, _recv_displs;
+
+  // Communication buffers and request of a pending reverse scatter
+  std::vector<T> _send_buffer, _recv_buffer;
+  MPI_Request _request = MPI_REQUEST_NULL;
+};
+
+//-----------------------------------------------------------------------------
+template <typename T>
+MatrixCSR<T>::MatrixCSR(const SparsityPattern& pattern)
+    : _index_maps({pattern.index_map(0), pattern.index_map(1)})
+{
+  if (pattern.blocked())
+  {
+    throw std::runtime_error(
+        "Cannot create CSR matrix from a blocked sparsity pattern.");
+  }
+
+  MPI_Comm comm = pattern.mpi_comm();
+  const common::IndexMap& map0 = *_index_maps[0];
+  const common::IndexMap& map1 = *_index_maps[1];
+  const int bs0 = map0.block_size();
+  const int bs1 = map1.block_size();
+  const std::int32_t num_rows = bs0 * map0.size_local();
+  const std::int32_t num_cols = bs1 * map1.size_local();
+  const std::int64_t row_offset = bs0 * map0.local_range()[0];
+  const std::int64_t col_offset = bs1 * map1.local_range()[0];
+
+  const graph::AdjacencyList<std::int32_t>& diagonal
+      = pattern.diagonal_pattern();
+  const graph::AdjacencyList<std::int64_t>& off_diagonal
+      = pattern.off_diagonal_pattern();
+  const graph::AdjacencyList<std::int64_t>& ghost = pattern.ghost_pattern();
+
+  // Global indices of the ghost columns of the column map, and of the
+  // unowned columns of the off-diagonal and ghost row patterns
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& ghosts1
+      = map1.ghosts();
+  std::vector<std::int64_t> ghosts;
+  for (Eigen::Index i = 0; i < ghosts1.rows(); ++i)
+    for (int j = 0; j < bs1; ++j)
+      ghosts.push_back(bs1 * ghosts1[i] + j);
+  ghosts.insert(ghosts.end(), off_diagonal.array().data(),
+                off_diagonal.array().data() + off_diagonal.array().rows());
+  for (Eigen::Index i = 0; i < ghost.array().rows(); ++i)
+  {
+    const std::int64_t col = ghost.array()[i];
+    if (col < col_offset or col >= col_offset + num_cols)
+      ghosts.push_back(col);
+  }
+  std::sort(ghosts.begin(), ghosts.end());
+  ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+
+  // Compute owners of the ghost columns from the ownership ranges
+  const int mpi_size = dolfinx::MPI::size(comm);
+  std::vector<std::int64_t> ranges(mpi_size + 1);
+  MPI_Allgather(&col_offset, 1, MPI_INT64_T, ranges.data(), 1, MPI_INT64_T,
+                comm);
+  ranges.back() = bs1 * map1.size_global();
+  std::vector<int> owners(ghosts.size());
+  for (std::size_t i = 0; i < ghosts.size(); ++i)
+  {
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), ghosts[i]);
+    owners[i] = std::distance(ranges.begin(), it) - 1;
+  }
+  _col_map = std::make_shared<common::IndexMap>(
+      comm, num_cols,
+      dolfinx::MPI::compute_graph_edges(
+          comm, std::set<int>(owners.begin(), owners.end())),
+      ghosts, owners, 1);
+
+  // Local column of a global column
+  auto local_col = [&](std::int64_t col) -> std::int32_t {
+    if (col >= col_offset and col < col_offset + num_cols)
+      return col - col_offset;
+    auto it = std::lower_bound(ghosts.begin(), ghosts.end(), col);
+    assert(it != ghosts.end() and *it == col);
+    return num_cols + std::distance(ghosts.begin(), it);
+  };
+  for (Eigen::Index i = 0; i < ghosts1.rows(); ++i)
+    for (int j = 0; j < bs1; ++j)
+      _ghost_cols.push_back(local_col(bs1 * ghosts1[i] + j));
+
+  // Create blocks. The ghost columns are sorted by global index, so the
+  // rows of the off-diagonal block are sorted by global column.
+  assert(diagonal.num_nodes() == num_rows);
+  _diagonal.row_ptr.assign(diagonal.offsets().data(),
+                           diagonal.offsets().data() + num_rows + 1);
+  _diagonal.cols.assign(diagonal.array().data(),
+                        diagonal.array().data() + diagonal.array().rows());
+  _diagonal.values.resize(_diagonal.cols.size(), 0);
+
+  assert(off_diagonal.num_nodes() == num_rows);
+  _off_diagonal.row_ptr.assign(off_diagonal.offsets().data(),
+                               off_diagonal.offsets().data() + num_rows + 1);
+  for (Eigen::Index i = 0; i < off_diagonal.array().rows(); ++i)
+    _off_diagonal.cols.push_back(local_col(off_diagonal.array()[i]));
+  _off_diagonal.values.resize(_off_diagonal.cols.size(), 0);
+
+  const std::int32_t num_ghost_rows = ghost.num_nodes();
+  assert(num_ghost_rows == bs0 * map0.num_ghosts());
+  _ghost.row_ptr.assign(ghost.offsets().data(),
+                        ghost.offsets().data() + num_ghost_rows + 1);
+  for (Eigen::Index i = 0; i < ghost.array().rows(); ++i)
+    _ghost.cols.push_back(local_col(ghost.array()[i]));
+  for (std::int32_t r = 0; r < num_ghost_rows; ++r)
+  {
+    std::sort(_ghost.cols.begin() + _ghost.row_ptr[r],
+              _ghost.cols.begin() + _ghost.row_ptr[r + 1]);
+  }
+  _ghost.values.resize(_ghost.cols.size(), 0);
+
+  // Get the owning processes of the ghost rows, which are the
+  // destinations of the ghost to owner communicator
+  _comm = map0.comm(common::IndexMap::Direction::reverse);
+  int indegree(-1), outdegree(-2), weighted(-1);
+  MPI_Dist_graph_neighbors_count(_comm, &indegree, &outdegree, &weighted);
+  std::vector<int> sources(indegree), dests(outdegree);
+  MPI_Dist_graph_neighbors(_comm, indegree, sources.data(), MPI_UNWEIGHTED,
+                           outdegree, dests.data(), MPI_UNWEIGHTED);
+  const Eigen::Array<int, Eigen::Dynamic, 1> row_owners
+      = map0.ghost_owner_rank();
+  std::vector<int> row_dest(num_ghost_rows);
+  _send_sizes.assign(outdegree, 0);
+  for (std::int32_t r = 0; r < num_ghost_rows; ++r)
+  {
+    auto it = std::find(dests.begin(), dests.end(), row_owners[r / bs0]);
+    assert(it != dests.end());
+    row_dest[r] = std::distance(dests.begin(), it);
+    _send_sizes[row_dest[r]] += _ghost.row_ptr[r + 1] - _ghost.row_ptr[r];
+  }
+  _send_displs.assign(outdegree + 1, 0);
+  std::partial_sum(_send_sizes.begin(), _send_sizes.end(),
+                   _send_displs.begin() + 1);
+
+  // Pack the positions and (global row, global column) of the ghost row
+  // entries by destination
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& ghosts0
+      = map0.ghosts();
+  _send_pos.resize(_send_displs.back());
+  std::vector<std::int64_t> send_entries(2 * _send_displs.back());
+  std::vector<std::int32_t> offsets(_send_displs.begin(),
+                                    _send_displs.end() - 1);
+  for (std::int32_t r = 0; r < num_ghost_rows; ++r)
+  {
+    const std::int64_t row = bs0 * ghosts0[r / bs0] + r % bs0;
+    for (std::int32_t k = _ghost.row_ptr[r]; k < _ghost.row_ptr[r + 1]; ++k)
+    {
+      const std::int32_t pos = offsets[row_dest[r]]++;
+      _send_pos[pos] = k;
+      send_entries[2 * pos] = row;
+      send_entries[2 * pos + 1] = ghost.array()[k];
+    }
+  }
+
+  // Send the entries to the owners
+  _recv_sizes.resize(indegree);
+  MPI_Neighbor_alltoall(_send_sizes.data(), 1, MPI_INT32_T,
+                        _recv_sizes.data(), 1, MPI_INT32_T, _comm);
+  _recv_displs.assign(indegree + 1, 0);
+  std::partial_sum(_recv_sizes.begin(), _recv_sizes.end(),
+                   _recv_displs.begin() + 1);
+  std::vector<int> send_sizes2(outdegree), send_displs2(outdegree + 1);
+  std::vector<int> recv_sizes2(indegree), recv_displs2(indegree + 1);
+  for (int i = 0; i < outdegree; ++i)
+  {
+    send_sizes2[i] = 2 * _send_sizes[i];
+    send_displs2[i] = 2 * _send_displs[i];
+  }
+  for (int i = 0; i < indegree; ++i)
+  {
+    recv_sizes2[i] = 2 * _recv_sizes[i];
+    recv_displs2[i] = 2 * _recv_displs[i];
+  }
+  std::vector<std::int64_t> recv_entries(2 * _recv_displs.back());
+  MPI_Neighbor_alltoallv(send_entries.data(), send_sizes2.data(),
+                         send_displs2.data(), MPI_INT64_T,
+                         recv_entries.data(), recv_sizes2.data(),
+                         recv_displs2.data(), MPI_INT64_T, _comm);
+
+  // Compute the positions of the received entries in the owned rows
+  _recv_pos.resize(_recv_displs.back());
+  for (std::size_t i = 0; i < _recv_pos.size(); ++i)
+  {
+    const std::int32_t row = recv_entries[2 * i] - row_offset;
+    assert(row >= 0 and row < num_rows);
+    const std::int32_t col = local_col(recv_entries[2 * i + 1]);
+    const Block& block = col < num_cols ? _diagonal : _off_diagonal;
+    auto begin = block.cols.begin() + block.row_ptr[row];
+    auto end = block.cols.begin() + block.row_ptr[row + 1];
+    auto it = std::lower_bound(begin, end, col);
+    if (it == end or *it != col)
+      throw std::runtime_error("Ghost row entry not in sparsity pattern.");
+    _recv_pos[i] = std::distance(block.cols.begin(), it);
+    if (col >= num_cols)
+      _recv_pos[i] += _diagonal.values.size();
+  }
+
+  _send_buffer.resize(_send_pos.size());
+  _recv_buffer.resize(_recv_pos.size());
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void MatrixCSR<T>::scatter_rev_begin()
+{
+  assert(_request == MPI_REQUEST_NULL);
+  for (std::size_t i = 0; i < _send_pos.size(); ++i)
+    _send_buffer[i] = _ghost.values[_send_pos[i]];
+  MPI_Ineighbor_alltoallv(_send_buffer.data(), _send_sizes.data(),
+                          _send_displs.data(), dolfinx::MPI::mpi_type<T>(),
+                          _recv_buffer.data(), _recv_sizes.data(),
+                          _recv_displs.data(), dolfinx::MPI::mpi_type<T>(),
+                          _comm, &_request);
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void MatrixCSR<T>::scatter_rev_end()
+{
+  MPI_Wait(&_request, MPI_STATUS_IGNORE);
+  const std::size_t num_diagonal = _diagonal.values.size();
+  for (std::size_t i = 0; i < _recv_pos.size(); ++i)
+  {
+    const std::size_t pos = _recv_pos[i];
+    if (pos < num_diagonal)
+      _diagonal.values[pos] += _recv_buffer[i];
+    else
+      _off_diagonal.values[pos - num_diagonal] += _recv_buffer[i];
+  }
+}
+//-----------------------------------------------------------------------------
+template <typename T>
+void MatrixCSR<T>::mult(const Vector<T>& x, Vector<T>& y,
+                        int num_threads) const
+{
+  // Get the values of the owned and unowned columns
+  const std::int32_t num_cols = _col_map->size_local();
+  assert(x.array().size() >= num_cols);
+  const T* x_owned = x.array().data();
+  std::vector<T> x_ghost(_col_map->num_ghosts());
+  common::IndexMap::ScatterRequest<T> request;
+  _col_map->scatter_fwd_begin(x_owned, 1, request);
+  _col_map->scatter_fwd_end(x_ghost.data(), request);
+
+  const std::int32_t num_rows = _diagonal.row_ptr.size() - 1;
+  Eigen::Matrix<T, Eigen::Dynamic, 1>& _y = y.array();
+  assert(_y.size() >= num_rows);
+  auto mult_rows = [&](std::int32_t r0, std::int32_t r1) {
+    for (std::int32_t r = r0; r < r1; ++r)
+    {
+      T sum = 0;
+      for (std::int32_t k = _diagonal.row_ptr[r]; k < _diagonal.row_ptr[r + 1];
+           ++k)
+      {
+        sum += _diagonal.values[k] * x_owned[_diagonal.cols[k]];
+      }
+      for (std::int32_t k = _off_diagonal.row_ptr[r];
+           k < _off_diagonal.row_ptr[r + 1]; ++k)
+      {
+        sum += _off_diagonal.values[k]
+               * x_ghost[_off_diagonal.cols[k] - num_cols];
+      }
+      _y[r] = sum;
+    }
+  };
+
+  // Compute contiguous chunks of rows concurrently
+  num_threads = std::max(1, std::min(num_threads, num_rows));
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; ++i)
+  {
+    threads.emplace_back(mult_rows, (i * std::int64_t(num_rows)) / num_threads,
+                         ((i + 1) * std::int64_t(num_rows)) / num_threads);
+  }
+  mult_rows(0, num_rows / num_threads);
+  for (auto& t : threads)
+    t.join();
+}
+//-----------------------------------------------------------------------------
+
+} // namespace dolfinx::la
@@ -8,6 +8,9 @@
 #include "PETScOperator.h"
 #include "VectorSpaceBasis.h"
 #include "utils.h"
+#include <algorithm>
+#include <array>
+#include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
@@ -56,12 +59,216 @@ void PETScKrylovSolver::set_operators(const Mat A, const Mat P)
     petsc_error(ierr, __FILE__, "KSPSetOperators");
 }
 //-----------------------------------------------------------------------------
+void PETScKrylovSolver::set_preconditioner_reuse(PreconditionerReuse reuse)
+{
+  assert(_ksp);
+  PetscErrorCode ierr = KSPSetReusePreconditioner(
+      _ksp, reuse == PreconditionerReuse::full ? PETSC_TRUE : PETSC_FALSE);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPSetReusePreconditioner");
+
+  // Has no effect for preconditioners other than GAMG
+  PC pc;
+  ierr = KSPGetPC(_ksp, &pc);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPGetPC");
+  ierr = PCGAMGSetReuseInterpolation(pc, reuse != PreconditionerReuse::none
+                                             ? PETSC_TRUE
+                                             : PETSC_FALSE);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "PCGAMGSetReuseInterpolation");
+}
+//-----------------------------------------------------------------------------
+void PETScKrylovSolver::set_pipelined(PipelinedMethod method, int restart)
+{
+  assert(_ksp);
+  KSPType type;
+  switch (method)
+  {
+  case PipelinedMethod::cg:
+    type = KSPPIPECG;
+    break;
+  case PipelinedMethod::cr:
+    type = KSPPIPECR;
+    break;
+  case PipelinedMethod::gmres:
+    type = KSPPGMRES;
+    break;
+  case PipelinedMethod::fgmres:
+    type = KSPPIPEFGMRES;
+    break;
+  case PipelinedMethod::bcgs:
+    type = KSPPIPEBCGS;
+    break;
+  case PipelinedMethod::gropp:
+    type = KSPGROPPCG;
+    break;
+  default:
+    throw std::runtime_error("Unknown pipelined Krylov method.");
+  }
+
+  PetscErrorCode ierr = KSPSetType(_ksp, type);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPSetType");
+  if (method == PipelinedMethod::gmres or method == PipelinedMethod::fgmres)
+  {
+    ierr = KSPGMRESSetRestart(_ksp, restart);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "KSPGMRESSetRestart");
+  }
+}
+//-----------------------------------------------------------------------------
+void PETScKrylovSolver::set_fieldsplit(
+    const std::vector<const common::IndexMap*>& maps, FieldSplitType type,
+    const std::vector<std::string>& names)
+{
+  assert(_ksp);
+  if (!names.empty() and names.size() != maps.size())
+  {
+    throw std::runtime_error(
+        "Number of field names does not match the number of fields.");
+  }
+  std::vector<std::string> field_names = names;
+  for (std::size_t i = field_names.size(); i < maps.size(); ++i)
+    field_names.push_back(std::to_string(i));
+
+  MPI_Comm comm = MPI_COMM_NULL;
+  PetscErrorCode ierr = PetscObjectGetComm((PetscObject)_ksp, &comm);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "PetscObjectGetComm");
+  PC pc;
+  ierr = KSPGetPC(_ksp, &pc);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPGetPC");
+
+  // Keep the index sets of the preconditioner if they are the stacked
+  // owned rows of the maps on all processes
+  PetscBool is_fieldsplit = PETSC_FALSE;
+  ierr = PetscObjectTypeCompare((PetscObject)pc, PCFIELDSPLIT, &is_fieldsplit);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "PetscObjectTypeCompare");
+  int match = is_fieldsplit ? 1 : 0;
+  std::int64_t offset = 0;
+  for (const common::IndexMap* map : maps)
+  {
+    assert(map);
+    offset += map->block_size() * map->local_range()[0];
+  }
+  for (std::size_t i = 0; i < maps.size() and match; ++i)
+  {
+    IS is = nullptr;
+    ierr = PCFieldSplitGetIS(pc, field_names[i].c_str(), &is);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "PCFieldSplitGetIS");
+    PetscBool is_stride = PETSC_FALSE;
+    if (is)
+      PetscObjectTypeCompare((PetscObject)is, ISSTRIDE, &is_stride);
+    if (!is_stride)
+    {
+      match = 0;
+      break;
+    }
+    PetscInt size, first, step;
+    ISGetLocalSize(is, &size);
+    ISStrideGetInfo(is, &first, &step);
+    const PetscInt map_size = maps[i]->block_size() * maps[i]->size_local();
+    match = size == map_size and first == offset and step == 1;
+    offset += map_size;
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &match, 1, MPI_INT, MPI_MIN, comm);
+
+  if (!match)
+  {
+    // Changing the type destroys the splits of a field split
+    // preconditioner
+    ierr = PCSetType(pc, PCNONE);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "PCSetType");
+    ierr = PCSetType(pc, PCFIELDSPLIT);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "PCSetType");
+
+    // The preconditioner keeps a reference to the index sets
+    std::vector<IS> is = la::create_petsc_fieldsplit_index_sets(comm, maps);
+    for (std::size_t i = 0; i < is.size(); ++i)
+    {
+      ierr = PCFieldSplitSetIS(pc, field_names[i].c_str(), is[i]);
+      if (ierr != 0)
+        petsc_error(ierr, __FILE__, "PCFieldSplitSetIS");
+      ISDestroy(&is[i]);
+    }
+  }
+
+  const std::array<PCCompositeType, 4> types
+      = {PC_COMPOSITE_ADDITIVE, PC_COMPOSITE_MULTIPLICATIVE,
+         PC_COMPOSITE_SYMMETRIC_MULTIPLICATIVE, PC_COMPOSITE_SCHUR};
+  ierr = PCFieldSplitSetType(pc, types[static_cast<int>(type)]);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "PCFieldSplitSetType");
+}
+//-----------------------------------------------------------------------------
+void PETScKrylovSolver::set_schur_complement(SchurFactorization factorization,
+                                             SchurPreconditioner pre,
+                                             const Mat S)
+{
+  assert(_ksp);
+  if ((pre == SchurPreconditioner::user) != (S != nullptr))
+  {
+    throw std::runtime_error("A Schur complement preconditioner matrix must "
+                             "be given for SchurPreconditioner::user only.");
+  }
+
+  PC pc;
+  PetscErrorCode ierr = KSPGetPC(_ksp, &pc);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPGetPC");
+  PetscBool is_fieldsplit = PETSC_FALSE;
+  PetscObjectTypeCompare((PetscObject)pc, PCFIELDSPLIT, &is_fieldsplit);
+  if (!is_fieldsplit)
+  {
+    throw std::runtime_error(
+        "Cannot set Schur complement. Preconditioner is not a field split "
+        "(see set_fieldsplit).");
+  }
+
+  const std::array<PCFieldSplitSchurFactType, 4> factorizations
+      = {PC_FIELDSPLIT_SCHUR_FACT_DIAG, PC_FIELDSPLIT_SCHUR_FACT_LOWER,
+         PC_FIELDSPLIT_SCHUR_FACT_UPPER, PC_FIELDSPLIT_SCHUR_FACT_FULL};
+  const std::array<PCFieldSplitSchurPreType, 5> pres
+      = {PC_FIELDSPLIT_SCHUR_PRE_SELF, PC_FIELDSPLIT_SCHUR_PRE_SELFP,
+         PC_FIELDSPLIT_SCHUR_PRE_A11, PC_FIELDSPLIT_SCHUR_PRE_USER,
+         PC_FIELDSPLIT_SCHUR_PRE_FULL};
+  ierr = PCFieldSplitSetType(pc, PC_COMPOSITE_SCHUR);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "PCFieldSplitSetType");
+  ierr = PCFieldSplitSetSchurFactType(
+      pc, factorizations[static_cast<int>(factorization)]);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "PCFieldSplitSetSchurFactType");
+  ierr = PCFieldSplitSetSchurPre(pc, pres[static_cast<int>(pre)], S);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "PCFieldSplitSetSchurPre");
+}
+//-----------------------------------------------------------------------------
+double PETScKrylovSolver::set_up()
+{
+  assert(_ksp);
+  common::Timer timer("PETSc Krylov solver: setup");
+  PetscErrorCode ierr = KSPSetUp(_ksp);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPSetUp");
+  return timer.stop();
+}
+//-----------------------------------------------------------------------------
 int PETScKrylovSolver::solve(Vec x, const Vec b, bool transpose)
 {
   common::Timer timer("PETSc Krylov solver");
   assert(x);
   assert(b);
 
+  // Set up the preconditioner, if required, separately for its timing
+  set_up();
+
   // Get PETSc operators
   Mat _A, _P;
   KSPGetOperators(_ksp, &_A, &_P);
@@ -103,15 +310,7 @@ int PETScKrylovSolver::solve(Vec x, const Vec b, bool transpose)
 
   // FIXME: Remove ghost updating?
   // Update ghost values in solution vector
-  Vec xg;
-  VecGhostGetLocalForm(x, &xg);
-  const bool is_ghosted = xg ? true : false;
-  VecGhostRestoreLocalForm(x, &xg);
-  if (is_ghosted)
-  {
-    VecGhostUpdateBegin(x, INSERT_VALUES, SCATTER_FORWARD);
-    VecGhostUpdateEnd(x, INSERT_VALUES, SCATTER_FORWARD);
-  }
+  update_ghosts(x);
 
   // Get the number of iterations
   PetscInt num_iterations = 0;
@@ -161,6 +360,99 @@ int PETScKrylovSolver::solve(Vec x, const Vec b, bool transpose)
   return num_iterations;
 }
 //-----------------------------------------------------------------------------
+int PETScKrylovSolver::solve(const std::vector<Vec>& x,
+                             const std::vector<Vec>& b)
+{
+  common::Timer timer("PETSc Krylov solver (multiple right-hand sides)");
+  if (x.size() != b.size())
+  {
+    throw std::runtime_error("Number of solution vectors and right-hand "
+                             "sides do not match.");
+  }
+  if (b.empty())
+    return 0;
+
+#if PETSC_VERSION_GE(3, 14, 0)
+  PetscErrorCode ierr;
+  PetscInt m = 0, M = 0;
+  VecGetLocalSize(b[0], &m);
+  VecGetSize(b[0], &M);
+  const PetscInt n = b.size();
+
+  // Copy the right-hand sides into the columns of a dense matrix
+  MPI_Comm comm = MPI_COMM_NULL;
+  PetscObjectGetComm((PetscObject)_ksp, &comm);
+  Mat B, X;
+  ierr = MatCreateDense(comm, m, PETSC_DECIDE, M, n, nullptr, &B);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatCreateDense");
+  ierr = MatCreateDense(comm, m, PETSC_DECIDE, M, n, nullptr, &X);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatCreateDense");
+
+  PetscScalar* array = nullptr;
+  MatDenseGetArray(B, &array);
+  for (PetscInt j = 0; j < n; ++j)
+  {
+    const PetscScalar* _b = nullptr;
+    VecGetArrayRead(b[j], &_b);
+    std::copy(_b, _b + m, array + j * m);
+    VecRestoreArrayRead(b[j], &_b);
+  }
+  MatDenseRestoreArray(B, &array);
+
+  ierr = KSPMatSolve(_ksp, B, X);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPMatSolve");
+
+  // Copy the solutions from the columns of X
+  MatDenseGetArray(X, &array);
+  for (PetscInt j = 0; j < n; ++j)
+  {
+    PetscScalar* _x = nullptr;
+    VecGetArray(x[j], &_x);
+    std::copy(array + j * m, array + (j + 1) * m, _x);
+    VecRestoreArray(x[j], &_x);
+    update_ghosts(x[j]);
+  }
+  MatDenseRestoreArray(X, &array);
+
+  MatDestroy(&B);
+  MatDestroy(&X);
+
+  PetscInt num_iterations = 0;
+  ierr = KSPGetIterationNumber(_ksp, &num_iterations);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "KSPGetIterationNumber");
+  return num_iterations;
+#else
+  int num_iterations = 0;
+  for (std::size_t j = 0; j < b.size(); ++j)
+    num_iterations = std::max(num_iterations, solve(x[j], b[j]));
+  return num_iterations;
+#endif
+}
+//-----------------------------------------------------------------------------
+void PETScKrylovSolver::update_ghosts(Vec x)
+{
+  if (_ghost_map)
+  {
+    la::scatter_fwd(*_ghost_map, x, _ghost_request);
+    return;
+  }
+
+  // Update the ghost values of x if it is a ghosted vector
+  Vec xg;
+  VecGhostGetLocalForm(x, &xg);
+  const bool is_ghosted = xg ? true : false;
+  VecGhostRestoreLocalForm(x, &xg);
+  if (is_ghosted)
+  {
+    VecGhostUpdateBegin(x, INSERT_VALUES, SCATTER_FORWARD);
+    VecGhostUpdateEnd(x, INSERT_VALUES, SCATTER_FORWARD);
+  }
+}
+//-----------------------------------------------------------------------------
 void PETScKrylovSolver::set_dm(DM dm)
 {
   assert(_ksp);
@@ -176,6 +468,14 @@ void PETScKrylovSolver::set_dm_active(bool val)
     KSPSetDMActive(_ksp, PETSC_FALSE);
 }
 //-----------------------------------------------------------------------------
+void PETScKrylovSolver::set_ghost_update_map(
+    std::shared_ptr<const common::IndexMap> map)
+{
+  if (map != _ghost_map)
+    _ghost_request = common::IndexMap::ScatterRequest<PetscScalar>();
+  _ghost_map = map;
+}
+//-----------------------------------------------------------------------------
 void PETScKrylovSolver::set_options_prefix(std::string options_prefix)
 {
   // Set options prefix
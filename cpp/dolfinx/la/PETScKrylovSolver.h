@@ -7,11 +7,14 @@
 #pragma once
 
 #include "PETScVector.h"
+#include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
+#include <memory>
 #include <petscksp.h>
 #include <petscmat.h>
 #include <petscvec.h>
 #include <string>
+#include <vector>
 
 namespace dolfinx
 {
@@ -29,6 +32,61 @@ namespace la
 class PETScKrylovSolver
 {
 public:
+  /// Reuse of the preconditioner when the values of the operators
+  /// change between solves, e.g. in time stepping
+  enum class PreconditionerReuse
+  {
+    none,      // Set up the preconditioner when the operators change
+    structure, // Reuse the structure (GAMG interpolation), recompute the
+               // values
+    full       // Reuse the preconditioner until reuse is changed
+  };
+
+  /// Pipelined Krylov methods, which overlap the global reductions of
+  /// an iteration with the matrix-vector product and the
+  /// preconditioner (communication hiding), at the cost of extra
+  /// vector operations and storage, and weaker numerical stability
+  enum class PipelinedMethod
+  {
+    cg,     // Pipelined conjugate gradients (KSPPIPECG)
+    cr,     // Pipelined conjugate residuals (KSPPIPECR)
+    gmres,  // Pipelined GMRES (KSPPGMRES)
+    fgmres, // Pipelined flexible GMRES (KSPPIPEFGMRES)
+    bcgs,   // Pipelined BiCGStab (KSPPIPEBCGS)
+    gropp   // CG with overlapped reductions of Gropp (KSPGROPPCG)
+  };
+
+  /// Combination of the field preconditioners of a field split
+  /// (PCFieldSplitSetType)
+  enum class FieldSplitType
+  {
+    additive,                 // Block Jacobi
+    multiplicative,           // Block Gauss-Seidel
+    symmetric_multiplicative, // Symmetric block Gauss-Seidel
+    schur                     // Schur complement of a two-field split
+  };
+
+  /// Approximate block factorisation of a Schur complement field split
+  /// (PCFieldSplitSetSchurFactType)
+  enum class SchurFactorization
+  {
+    diag,  // Block diagonal
+    lower, // Block lower triangular
+    upper, // Block upper triangular
+    full   // Full block LDU factorisation
+  };
+
+  /// Matrix from which the preconditioner of the Schur complement
+  /// S = A11 - A10 inv(A00) A01 is built (PCFieldSplitSetSchurPre)
+  enum class SchurPreconditioner
+  {
+    self,  // S itself (matrix-free, e.g. with a Krylov solver for S)
+    selfp, // A11 - A10 inv(diag(A00)) A01, assembled
+    a11,   // The A11 block of the preconditioner matrix
+    user,  // A matrix given by the user, e.g. a pressure mass matrix
+    full   // S assembled exactly (expensive, for testing)
+  };
+
   /// Create Krylov solver for a particular method and named
   /// preconditioner
   explicit PETScKrylovSolver(MPI_Comm comm);
@@ -45,10 +103,87 @@ public:
   /// Set operator and preconditioner matrix (Mat)
   void set_operators(const Mat A, const Mat P);
 
+  /// Set the reuse of the preconditioner when the operators change.
+  /// With PreconditionerReuse::full, the preconditioner is set up once
+  /// (KSPSetReusePreconditioner) and used for the following solves.
+  /// With PreconditionerReuse::structure, the preconditioner is set up
+  /// for the new values of the operators, but reuses its structure
+  /// where the preconditioner supports this, e.g. the interpolation
+  /// operators of GAMG (PCGAMGSetReuseInterpolation). A factorisation
+  /// (LU, ILU) reuses its symbolic factorisation in all modes if the
+  /// nonzero pattern is unchanged. Call after the preconditioner type
+  /// is set (e.g. set_from_options).
+  void set_preconditioner_reuse(PreconditionerReuse reuse);
+
+  /// Use a pipelined Krylov method. The reductions are only overlapped
+  /// if the MPI implementation progresses non-blocking collectives
+  /// asynchronously (e.g. MPICH_ASYNC_PROGRESS=1), and they pay off
+  /// when the latency of the global reductions dominates, i.e. on many
+  /// processes with few unknowns per process.
+  /// @param[in] method The method
+  /// @param[in] restart The restart length of the GMRES methods
+  void set_pipelined(PipelinedMethod method, int restart = 30);
+
+  /// Use a field split preconditioner (PCFieldSplit) for a block or
+  /// nested system, with the fields of a list of index maps, e.g. the
+  /// index maps of the dofmaps of the row spaces of
+  /// fem::create_matrix_block or fem::create_matrix_nest. The index sets
+  /// of the fields are created once and kept by the preconditioner, and
+  /// calls with index maps of the same sizes (e.g. before each solve)
+  /// do not recreate them. The solvers of the fields are configured
+  /// with the options prefix "<prefix>fieldsplit_<name>_", e.g.
+  /// -fieldsplit_0_pc_type gamg.
+  /// @param[in] maps The index maps of the fields
+  /// @param[in] type The combination of the field preconditioners
+  /// @param[in] names The names of the fields. If empty, the fields are
+  ///   named by their positions.
+  void set_fieldsplit(const std::vector<const common::IndexMap*>& maps,
+                      FieldSplitType type = FieldSplitType::additive,
+                      const std::vector<std::string>& names = {});
+
+  /// Use a Schur complement field split preconditioner for a two-field
+  /// split (see set_fieldsplit), e.g. for saddle point problems
+  /// @param[in] factorization The approximate block factorisation
+  /// @param[in] pre The matrix of the preconditioner of the Schur
+  ///   complement
+  /// @param[in] S The matrix for SchurPreconditioner::user, e.g. a
+  ///   pressure mass matrix. Must be nullptr for the other types.
+  void set_schur_complement(SchurFactorization factorization,
+                            SchurPreconditioner pre, const Mat S = nullptr);
+
+  /// Set up the solver and the preconditioner for the operators, if
+  /// required. It is called by solve, and may be called before to time
+  /// the setup. The setup is timed as "PETSc Krylov solver: setup"
+  /// (see list_timings).
+  /// @return The wall time of the setup in seconds
+  double set_up();
+
   /// Solve linear system Ax = b and return number of iterations (A^t x
   /// = b if transpose is true)
   int solve(Vec x, const Vec b, bool transpose = false);
 
+  /// Solve the linear systems A x_i = b_i with the same operator for
+  /// several right-hand sides. With PETSc >= 3.14 the systems are
+  /// solved together (KSPMatSolve) on dense blocks of vectors, which
+  /// uses block Krylov methods where the KSP type supports them (e.g.
+  /// -ksp_type hpddm) and otherwise solves the systems one by one.
+  /// With older PETSc versions the systems are solved one by one. The
+  /// preconditioner is set up only once in all cases.
+  /// @param[in,out] x The solution vectors
+  /// @param[in] b The right-hand side vectors, with the same layout as
+  ///   the vectors in @p x
+  /// @return The number of iterations. For solves one by one it is
+  ///   the maximum over the right-hand sides.
+  int solve(const std::vector<Vec>& x, const std::vector<Vec>& b);
+
+  /// Update the ghost entries of the solution vectors after a solve
+  /// with the scatter of an index map (see la::scatter_fwd) in place of
+  /// the PETSc VecScatter of the vectors. The solution vectors must
+  /// have the parallel layout of the index map.
+  /// @param[in] map The index map of the solution vectors, or nullptr
+  ///   to use the PETSc VecScatter (default)
+  void set_ghost_update_map(std::shared_ptr<const common::IndexMap> map);
+
   /// Sets the prefix used by PETSc when searching the PETSc options
   /// database
   void set_options_prefix(std::string options_prefix);
@@ -70,8 +205,16 @@ public:
   void set_dm_active(bool val);
 
 private:
+  // Update the ghost entries of the solution x
+  void update_ghosts(Vec x);
+
   // PETSc solver pointer
   KSP _ksp;
+
+  // Index map for ghost updates of the solution (optional), and the
+  // scatter plan
+  std::shared_ptr<const common::IndexMap> _ghost_map;
+  common::IndexMap::ScatterRequest<PetscScalar> _ghost_request;
 };
 } // namespace la
 } // namespace dolfinx
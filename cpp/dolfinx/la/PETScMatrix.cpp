@@ -6,6 +6,7 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "PETScMatrix.h"
+#include "MatrixCSR.h"
 #include "PETScVector.h"
 #include "VectorSpaceBasis.h"
 #include "utils.h"
@@ -22,7 +23,8 @@ using namespace dolfinx::la;
 
 //-----------------------------------------------------------------------------
 Mat la::create_petsc_matrix(
-    MPI_Comm comm, const dolfinx::la::SparsityPattern& sparsity_pattern)
+    MPI_Comm comm, const dolfinx::la::SparsityPattern& sparsity_pattern,
+    const std::string& type)
 {
   PetscErrorCode ierr;
   Mat A;
@@ -44,6 +46,12 @@ Mat la::create_petsc_matrix(
 
   // Find common block size across rows/columns
   const int bs = (bs0 == bs1 ? bs0 : 1);
+  if (sparsity_pattern.blocked() and bs0 != bs1)
+  {
+    throw std::runtime_error("Cannot create matrix from blocked sparsity "
+                             "pattern with different row and column block "
+                             "sizes.");
+  }
 
   // Set matrix size
   ierr = MatSetSizes(A, m, n, M, N);
@@ -56,27 +64,84 @@ Mat la::create_petsc_matrix(
   const graph::AdjacencyList<std::int64_t>& off_diagonal_pattern
       = sparsity_pattern.off_diagonal_pattern();
 
+  // Set the requested matrix type
+  if (!type.empty())
+  {
+    ierr = MatSetType(A, type.c_str());
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "MatSetType");
+  }
+
   // Apply PETSc options from the options database to the matrix (this
   // includes changing the matrix type to one specified by the user)
   ierr = MatSetFromOptions(A);
   if (ierr != 0)
     petsc_error(ierr, __FILE__, "MatSetFromOptions");
 
-  // Build data to initialise sparsity pattern (modify for block size)
-  std::vector<PetscInt> _nnz_diag(index_maps[0]->size_local() * bs0 / bs),
-      _nnz_offdiag(index_maps[0]->size_local() * bs0 / bs);
+  // Check for symmetric block storage, which holds only the upper
+  // triangle
+  MatType mat_type;
+  ierr = MatGetType(A, &mat_type);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatGetType");
+  const bool upper = std::string(mat_type).find("sbaij") != std::string::npos;
+  if (upper and (M != N or bs0 != bs1))
+  {
+    throw std::runtime_error(
+        "Symmetric matrix storage requires a square matrix with the same "
+        "row and column block sizes.");
+  }
 
-  for (std::size_t i = 0; i < _nnz_diag.size(); ++i)
-    _nnz_diag[i] = diagonal_pattern.links(bs * i).rows() / bs;
-  for (std::size_t i = 0; i < _nnz_offdiag.size(); ++i)
-    _nnz_offdiag[i] = off_diagonal_pattern.links(bs * i).rows() / bs;
+  // Build data to initialise sparsity pattern (modify for block size).
+  // The rows of a blocked pattern are already block rows. For symmetric
+  // storage, only the (block) columns in the upper triangle are
+  // counted. The columns of the off-diagonal part are not owned, so a
+  // column is in the upper triangle if its global index is greater
+  // than that of the row.
+  const std::int32_t num_rows = index_maps[0]->size_local() * bs0 / bs;
+  const std::int64_t row_offset = index_maps[0]->local_range()[0];
+  std::vector<PetscInt> _nnz_diag(num_rows), _nnz_offdiag(num_rows);
+  const int col_bs = sparsity_pattern.blocked() ? 1 : bs;
+  for (std::int32_t i = 0; i < num_rows; ++i)
+  {
+    auto cols_diag = diagonal_pattern.links(col_bs * i);
+    auto cols_offdiag = off_diagonal_pattern.links(col_bs * i);
+    if (upper)
+    {
+      _nnz_diag[i] = (cols_diag >= col_bs * i).count() / col_bs;
+      _nnz_offdiag[i]
+          = (cols_offdiag >= col_bs * (row_offset + i)).count() / col_bs;
+    }
+    else
+    {
+      _nnz_diag[i] = cols_diag.rows() / col_bs;
+      _nnz_offdiag[i] = cols_offdiag.rows() / col_bs;
+    }
+  }
 
   // Allocate space for matrix
-  ierr = MatXAIJSetPreallocation(A, bs, _nnz_diag.data(), _nnz_offdiag.data(),
-                                 nullptr, nullptr);
+  if (upper)
+  {
+    ierr = MatXAIJSetPreallocation(A, bs, nullptr, nullptr, _nnz_diag.data(),
+                                   _nnz_offdiag.data());
+  }
+  else
+  {
+    ierr = MatXAIJSetPreallocation(A, bs, _nnz_diag.data(),
+                                   _nnz_offdiag.data(), nullptr, nullptr);
+  }
   if (ierr != 0)
     petsc_error(ierr, __FILE__, "MatXIJSetPreallocation");
 
+  // Element matrices are inserted in full, and the entries in the lower
+  // triangle are dropped by the symmetric storage
+  if (upper)
+  {
+    ierr = MatSetOption(A, MAT_IGNORE_LOWER_TRIANGULAR, PETSC_TRUE);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "MatSetOption");
+  }
+
   // FIXME: In many cases the rows and columns could shared a common
   // local-to-global map
 
@@ -130,6 +195,161 @@ Mat la::create_petsc_matrix(
   return A;
 }
 //-----------------------------------------------------------------------------
+Mat la::create_petsc_matrix_is(
+    MPI_Comm comm,
+    const std::array<std::shared_ptr<const common::IndexMap>, 2>& index_maps,
+    const SparsityPattern& local_pattern)
+{
+  const int bs0 = index_maps[0]->block_size();
+  const int bs1 = index_maps[1]->block_size();
+  const int bs = (bs0 == bs1 ? bs0 : 1);
+  if (local_pattern.blocked() and bs0 != bs1)
+  {
+    throw std::runtime_error("Cannot create matrix from blocked sparsity "
+                             "pattern with different row and column block "
+                             "sizes.");
+  }
+
+  // The local-to-global maps of the owned and ghost indices define the
+  // subdomain of the process
+  const bool blocked = (bs0 == bs1);
+  std::array<ISLocalToGlobalMapping, 2> local_to_global;
+  for (int i = 0; i < 2; ++i)
+  {
+    const std::vector _map = index_maps[i]->global_indices(blocked);
+    const std::vector<PetscInt> map(_map.begin(), _map.end());
+    PetscErrorCode ierr = ISLocalToGlobalMappingCreate(
+        MPI_COMM_SELF, bs, map.size(), map.data(), PETSC_COPY_VALUES,
+        &local_to_global[i]);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "ISLocalToGlobalMappingCreate");
+  }
+
+  Mat A;
+  PetscErrorCode ierr = MatCreateIS(
+      comm, bs, bs0 * index_maps[0]->size_local(),
+      bs1 * index_maps[1]->size_local(), bs0 * index_maps[0]->size_global(),
+      bs1 * index_maps[1]->size_global(), local_to_global[0],
+      local_to_global[1], &A);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatCreateIS");
+  for (int i = 0; i < 2; ++i)
+  {
+    ierr = ISLocalToGlobalMappingDestroy(&local_to_global[i]);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "ISLocalToGlobalMappingDestroy");
+  }
+
+  // Preallocate the local matrix from the local pattern, in which all
+  // rows and columns are owned (see create_petsc_matrix for the
+  // handling of blocked and unblocked patterns)
+  Mat A_local;
+  ierr = MatISGetLocalMat(A, &A_local);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatISGetLocalMat");
+  const graph::AdjacencyList<std::int32_t>& pattern
+      = local_pattern.diagonal_pattern();
+  const int col_bs = local_pattern.blocked() ? 1 : bs;
+  const std::int32_t num_rows = pattern.num_nodes() / col_bs;
+  std::vector<PetscInt> nnz(num_rows);
+  for (std::int32_t i = 0; i < num_rows; ++i)
+    nnz[i] = pattern.num_links(col_bs * i) / col_bs;
+  ierr = MatXAIJSetPreallocation(A_local, bs, nnz.data(), nullptr, nullptr,
+                                 nullptr);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatXAIJSetPreallocation");
+  ierr = MatSetOption(A_local, MAT_NEW_NONZERO_ALLOCATION_ERR, PETSC_TRUE);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatSetOption");
+  ierr = MatSetOption(A_local, MAT_KEEP_NONZERO_PATTERN, PETSC_TRUE);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatSetOption");
+  ierr = MatISRestoreLocalMat(A, &A_local);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatISRestoreLocalMat");
+
+  return A;
+}
+//-----------------------------------------------------------------------------
+Mat la::create_petsc_matrix(MPI_Comm comm, MatrixCSR<PetscScalar>& A)
+{
+  std::shared_ptr<const common::IndexMap> map0 = A.index_map(0);
+  std::shared_ptr<const common::IndexMap> col_map = A.column_map();
+  assert(map0);
+  assert(col_map);
+  const std::int64_t M = map0->block_size() * map0->size_global();
+  const std::int64_t N = col_map->size_global();
+  const std::int32_t m = map0->block_size() * map0->size_local();
+  const std::int32_t n = col_map->size_local();
+
+  // Copy the row offsets and column indices to PetscInt arrays, with
+  // global column indices for the off-diagonal block. The arrays are
+  // attached to the matrix and destroyed with it.
+  MatrixCSR<PetscScalar>::Block& diagonal = A.diagonal();
+  MatrixCSR<PetscScalar>::Block& off_diagonal = A.off_diagonal();
+  auto indices = new std::array<std::vector<PetscInt>, 4>;
+  (*indices)[0].assign(diagonal.row_ptr.begin(), diagonal.row_ptr.end());
+  (*indices)[1].assign(diagonal.cols.begin(), diagonal.cols.end());
+  (*indices)[2].assign(off_diagonal.row_ptr.begin(),
+                       off_diagonal.row_ptr.end());
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& ghosts
+      = col_map->ghosts();
+  for (std::int32_t c : off_diagonal.cols)
+    (*indices)[3].push_back(ghosts[c - n]);
+
+  PetscErrorCode ierr;
+  Mat _A;
+  ierr = MatCreateMPIAIJWithSplitArrays(
+      comm, m, n, M, N, (*indices)[0].data(), (*indices)[1].data(),
+      diagonal.values.data(), (*indices)[2].data(), (*indices)[3].data(),
+      off_diagonal.values.data(), &_A);
+  if (ierr != 0)
+  {
+    delete indices;
+    petsc_error(ierr, __FILE__, "MatCreateMPIAIJWithSplitArrays");
+  }
+
+  PetscContainer container;
+  ierr = PetscContainerCreate(comm, &container);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "PetscContainerCreate");
+  PetscContainerSetPointer(container, indices);
+  PetscContainerSetUserDestroy(container, [](void* ctx) -> PetscErrorCode {
+    delete static_cast<std::array<std::vector<PetscInt>, 4>*>(ctx);
+    return 0;
+  });
+  PetscObjectCompose((PetscObject)_A, "dolfinx_csr_indices",
+                     (PetscObject)container);
+  PetscContainerDestroy(&container);
+
+  return _A;
+}
+//-----------------------------------------------------------------------------
+void la::set_fast_reassembly(Mat A)
+{
+  assert(A);
+  PetscBool assembled = PETSC_FALSE;
+  PetscErrorCode ierr = MatAssembled(A, &assembled);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatAssembled");
+  if (!assembled)
+  {
+    throw std::runtime_error("Cannot enable fast reassembly of a matrix "
+                             "that has not been assembled.");
+  }
+
+  // Record the off-process communication pattern of the next assembly
+  // and reuse it for later assemblies
+  ierr = MatSetOption(A, MAT_SUBSET_OFF_PROC_ENTRIES, PETSC_TRUE);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatSetOption");
+
+  // The non-zero structure is fixed
+  ierr = MatSetOption(A, MAT_NEW_NONZERO_LOCATION_ERR, PETSC_TRUE);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatSetOption");
+}
+//-----------------------------------------------------------------------------
 MatNullSpace la::create_petsc_nullspace(MPI_Comm comm,
                                         const la::VectorSpaceBasis& nullspace)
 {
@@ -184,8 +404,44 @@ PETScMatrix::add_fn(Mat A)
   };
 }
 //-----------------------------------------------------------------------------
-PETScMatrix::PETScMatrix(MPI_Comm comm, const SparsityPattern& sparsity_pattern)
-    : PETScOperator(create_petsc_matrix(comm, sparsity_pattern), false)
+std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
+                  const std::int32_t*, const PetscScalar*)>
+PETScMatrix::add_block_fn(Mat A, int bs)
+{
+  return [A, bs, cache = std::vector<PetscInt>()](
+             std::int32_t m, const std::int32_t* rows, std::int32_t n,
+             const std::int32_t* cols, const PetscScalar* vals) mutable {
+    assert(m % bs == 0);
+    assert(n % bs == 0);
+
+    // Get block indices of the (complete) blocks of rows and columns
+    const std::int32_t mb = m / bs, nb = n / bs;
+    cache.resize(mb + nb);
+    for (std::int32_t i = 0; i < mb; ++i)
+    {
+      assert(rows[bs * i + bs - 1] == rows[bs * i] + bs - 1);
+      cache[i] = rows[bs * i] / bs;
+    }
+    for (std::int32_t j = 0; j < nb; ++j)
+    {
+      assert(cols[bs * j + bs - 1] == cols[bs * j] + bs - 1);
+      cache[mb + j] = cols[bs * j] / bs;
+    }
+
+    PetscErrorCode ierr;
+    ierr = MatSetValuesBlockedLocal(A, mb, cache.data(), nb,
+                                    cache.data() + mb, vals, ADD_VALUES);
+#ifdef DEBUG
+    if (ierr != 0)
+      la::petsc_error(ierr, __FILE__, "MatSetValuesBlockedLocal");
+#endif
+    return 0;
+  };
+}
+//-----------------------------------------------------------------------------
+PETScMatrix::PETScMatrix(MPI_Comm comm, const SparsityPattern& sparsity_pattern,
+                         const std::string& type)
+    : PETScOperator(create_petsc_matrix(comm, sparsity_pattern, type), false)
 {
   // Do nothing
 }
@@ -236,14 +492,28 @@ void PETScMatrix::apply(AssemblyType type)
   if (type == AssemblyType::FLUSH)
     petsc_type = MAT_FLUSH_ASSEMBLY;
 
+  // Time the phases separately for fast reassembly, to compare with
+  // the full assembly
+  const std::string mode = _fast_reassembly ? " (fast reassembly)" : "";
+
+  common::Timer timer_begin("Apply (PETScMatrix): begin" + mode);
   ierr = MatAssemblyBegin(_matA, petsc_type);
   if (ierr != 0)
     petsc_error(ierr, __FILE__, "MatAssemblyBegin");
+  timer_begin.stop();
+
+  common::Timer timer_end("Apply (PETScMatrix): end" + mode);
   ierr = MatAssemblyEnd(_matA, petsc_type);
   if (ierr != 0)
     petsc_error(ierr, __FILE__, "MatAssemblyEnd");
 }
 //-----------------------------------------------------------------------------
+void PETScMatrix::set_fast_reassembly()
+{
+  la::set_fast_reassembly(_matA);
+  _fast_reassembly = true;
+}
+//-----------------------------------------------------------------------------
 void PETScMatrix::set_options_prefix(std::string options_prefix)
 {
   assert(_matA);
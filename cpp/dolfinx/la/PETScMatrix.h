@@ -11,17 +11,82 @@
 #include "utils.h"
 #include <array>
 #include <functional>
+#include <memory>
 #include <petscmat.h>
 #include <string>
 
+namespace dolfinx::common
+{
+class IndexMap;
+}
+
 namespace dolfinx::la
 {
 class SparsityPattern;
 class VectorSpaceBasis;
+template <typename T>
+class MatrixCSR;
 
 /// Create a PETSc Mat. Caller is responsible for destroying the
 /// returned object.
-Mat create_petsc_matrix(MPI_Comm comm, const SparsityPattern& sparsity_pattern);
+/// @param[in] comm The MPI communicator
+/// @param[in] sparsity_pattern The (finalised) sparsity pattern. If it
+///   is blocked, the row and column block sizes must be equal.
+/// @param[in] type The PETSc matrix type, e.g. "baij" for a block
+///   sparse matrix. If empty the default type is used. The type can be
+///   overridden by the PETSc options database (-mat_type). For
+///   symmetric block storage ("sbaij"), only the upper triangle of the
+///   pattern is allocated and inserted entries in the lower triangle
+///   are ignored.
+/// @return The matrix
+Mat create_petsc_matrix(MPI_Comm comm, const SparsityPattern& sparsity_pattern,
+                        const std::string& type = std::string());
+
+/// Create an unassembled PETSc matrix (MATIS), which is stored as the
+/// local (subdomain) matrices of the processes, e.g. for the BDDC
+/// preconditioner. The local matrix couples the owned and ghost
+/// indices of the index maps, in the local ordering of the maps, such
+/// that values are added with the local indices of the maps
+/// (MatSetValuesLocal, see PETScMatrix::add_fn) and assembly of the
+/// matrix requires no communication. Caller is responsible for
+/// destroying the returned object.
+/// @param[in] comm The MPI communicator
+/// @param[in] index_maps The index maps of the rows and columns
+/// @param[in] local_pattern The (finalised) pattern of the local
+///   matrix, with the local indices of the index maps as rows and
+///   columns (see fem::create_local_sparsity_pattern). If it is
+///   blocked, the row and column block sizes must be equal.
+/// @return The matrix
+Mat create_petsc_matrix_is(
+    MPI_Comm comm,
+    const std::array<std::shared_ptr<const common::IndexMap>, 2>& index_maps,
+    const SparsityPattern& local_pattern);
+
+/// Create a PETSc MPIAIJ matrix that uses the value arrays of the
+/// owned rows of a MatrixCSR (MatCreateMPIAIJWithSplitArrays). The
+/// values are not copied, so values added to @p A are seen by the
+/// PETSc matrix. The column indices are copied. The ghost rows of @p A
+/// are not part of the PETSc matrix and must be accumulated
+/// (MatrixCSR::finalize) before the matrix is used. @p A must outlive
+/// the returned matrix. Caller is responsible for destroying the
+/// returned object.
+/// @param[in] comm The MPI communicator of the index maps of @p A
+/// @param[in] A The matrix
+/// @return The PETSc matrix
+Mat create_petsc_matrix(MPI_Comm comm, MatrixCSR<PetscScalar>& A);
+
+/// Enable fast reassembly of a matrix whose non-zero structure does
+/// not change. The off-process communication pattern of the next final
+/// assembly (MatAssemblyBegin/End) is recorded and reused by all later
+/// assemblies, which skips the negotiation of the stash sizes
+/// (MAT_SUBSET_OFF_PROC_ENTRIES). Later assemblies must therefore only
+/// add values to a subset of the off-process entries of the recorded
+/// assembly, which is the case when the same forms are reassembled.
+/// Adding an entry outside the non-zero structure is an error
+/// (MAT_NEW_NONZERO_LOCATION_ERR).
+/// @param[in] A A matrix that has been assembled (MAT_FINAL_ASSEMBLY)
+///   at least once, which fixes its non-zero structure
+void set_fast_reassembly(Mat A);
 
 /// Create PETSc MatNullSpace. Caller is responsible for destruction
 /// returned object.
@@ -43,8 +108,21 @@ public:
                            const std::int32_t*, const PetscScalar*)>
   add_fn(Mat A);
 
-  /// Create holder of a PETSc Mat object from a sparsity pattern
-  PETScMatrix(MPI_Comm comm, const SparsityPattern& sparsity_pattern);
+  /// Return a function with an interface for adding values to the
+  /// matrix A blockwise (MatSetValuesBlockedLocal). The function takes
+  /// the same (unblocked) local indices as add_fn, but the row and
+  /// column indices must consist of complete blocks of size bs, i.e.
+  /// index bs * j + k must be bs * node + k, as for a dofmap with
+  /// DofMap::bs() equal to bs. The local-to-global maps of A must have
+  /// block size bs.
+  static std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
+                           const std::int32_t*, const PetscScalar*)>
+  add_block_fn(Mat A, int bs);
+
+  /// Create holder of a PETSc Mat object from a sparsity pattern. See
+  /// create_petsc_matrix.
+  PETScMatrix(MPI_Comm comm, const SparsityPattern& sparsity_pattern,
+              const std::string& type = std::string());
 
   /// Create holder of a PETSc Mat object/pointer. The Mat A object
   /// should already be created. If inc_ref_count is true, the reference
@@ -81,8 +159,16 @@ public:
   /// @param type
   ///   FINAL    - corresponds to PETSc MatAssemblyBegin+End(MAT_FINAL_ASSEMBLY)
   ///   FLUSH  - corresponds to PETSc MatAssemblyBegin+End(MAT_FLUSH_ASSEMBLY)
+  ///
+  /// MatAssemblyBegin and MatAssemblyEnd are timed separately, and
+  /// separately for matrices in fast reassembly mode (see
+  /// set_fast_reassembly), so that the time saved by reusing the
+  /// communication pattern is shown by list_timings.
   void apply(AssemblyType type);
 
+  /// Enable fast reassembly of the matrix. See la::set_fast_reassembly.
+  void set_fast_reassembly();
+
   /// Return norm of matrix
   double norm(la::Norm norm_type) const;
 
@@ -106,5 +192,9 @@ public:
   /// Attach 'near' nullspace to matrix (used by preconditioners,
   /// such as smoothed aggregation algerbraic multigrid)
   void set_near_nullspace(const la::VectorSpaceBasis& nullspace);
+
+private:
+  // True if fast reassembly has been enabled
+  bool _fast_reassembly = false;
 };
 } // namespace dolfinx::la
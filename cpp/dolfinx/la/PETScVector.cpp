@@ -9,6 +9,7 @@
 #include "utils.h"
 #include <cstddef>
 #include <cstring>
+#include <dolfinx/common/CommProfiler.h>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
@@ -23,6 +24,58 @@ using namespace dolfinx::la;
       petsc_error(ierr, __FILE__, NAME);                                       \
   } while (0)
 
+namespace
+{
+//-----------------------------------------------------------------------------
+// Number of ghost entries of a ghosted vector with local form xg
+PetscInt num_ghosts(Vec x, Vec xg)
+{
+  PetscInt n = 0, n_local = 0;
+  VecGetLocalSize(x, &n);
+  VecGetLocalSize(xg, &n_local);
+  return n_local - n;
+}
+//-----------------------------------------------------------------------------
+// Get the local form of a ghosted vector x and its array, and check
+// that it has the layout of map
+PetscScalar* get_ghosted_array(const common::IndexMap& map, Vec x, Vec* xg)
+{
+  PetscErrorCode ierr = VecGhostGetLocalForm(x, xg);
+  CHECK_ERROR("VecGhostGetLocalForm");
+  if (!*xg)
+    throw std::runtime_error("Vec is not ghosted.");
+
+  PetscInt n = 0;
+  ierr = VecGetLocalSize(*xg, &n);
+  CHECK_ERROR("VecGetLocalSize");
+  const int bs = map.block_size();
+  if (n != bs * (map.size_local() + map.num_ghosts()))
+  {
+    VecGhostRestoreLocalForm(x, xg);
+    throw std::runtime_error("Local size of Vec does not match index map.");
+  }
+
+  PetscScalar* array = nullptr;
+  ierr = VecGetArray(*xg, &array);
+  CHECK_ERROR("VecGetArray");
+  return array;
+}
+//-----------------------------------------------------------------------------
+// Restore the array and the local form of x from get_ghosted_array,
+// and mark x as modified (the array of the local form is shared with
+// x)
+void restore_ghosted_array(Vec x, Vec* xg, PetscScalar** array)
+{
+  PetscErrorCode ierr = VecRestoreArray(*xg, array);
+  CHECK_ERROR("VecRestoreArray");
+  ierr = VecGhostRestoreLocalForm(x, xg);
+  CHECK_ERROR("VecGhostRestoreLocalForm");
+  ierr = PetscObjectStateIncrease((PetscObject)x);
+  CHECK_ERROR("PetscObjectStateIncrease");
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 //-----------------------------------------------------------------------------
 void la::petsc_error(int error_code, std::string filename,
                      std::string petsc_function)
@@ -42,6 +95,31 @@ void la::petsc_error(int error_code, std::string filename,
                            + std::string(desc));
 }
 //-----------------------------------------------------------------------------
+void la::scatter_fwd(const common::IndexMap& map, Vec x,
+                     common::IndexMap::ScatterRequest<PetscScalar>& request)
+{
+  assert(x);
+  Vec xg;
+  PetscScalar* array = get_ghosted_array(map, x, &xg);
+  const int bs = map.block_size();
+  map.scatter_fwd_begin(array, bs, request);
+  map.scatter_fwd_end(array + bs * map.size_local(), request);
+  restore_ghosted_array(x, &xg, &array);
+}
+//-----------------------------------------------------------------------------
+void la::scatter_rev(const common::IndexMap& map, Vec x,
+                     common::IndexMap::Mode op,
+                     common::IndexMap::ScatterRequest<PetscScalar>& request)
+{
+  assert(x);
+  Vec xg;
+  PetscScalar* array = get_ghosted_array(map, x, &xg);
+  const int bs = map.block_size();
+  map.scatter_rev_begin(array + bs * map.size_local(), bs, request);
+  map.scatter_rev_end(array, op, request);
+  restore_ghosted_array(x, &xg, &array);
+}
+//-----------------------------------------------------------------------------
 std::vector<IS>
 la::create_petsc_index_sets(const std::vector<const common::IndexMap*>& maps)
 {
@@ -63,6 +141,34 @@ la::create_petsc_index_sets(const std::vector<const common::IndexMap*>& maps)
   return is;
 }
 //-----------------------------------------------------------------------------
+std::vector<IS> la::create_petsc_fieldsplit_index_sets(
+    MPI_Comm comm, const std::vector<const common::IndexMap*>& maps)
+{
+  // Offset of the stacked owned rows of this process
+  std::int64_t offset = 0;
+  for (const common::IndexMap* map : maps)
+  {
+    assert(map);
+    offset += map->block_size() * map->local_range()[0];
+  }
+
+  std::vector<IS> is(maps.size());
+  for (std::size_t i = 0; i < maps.size(); ++i)
+  {
+    const int bs = maps[i]->block_size();
+    const PetscInt size = bs * maps[i]->size_local();
+    PetscErrorCode ierr = ISCreateStride(comm, size, offset, 1, &is[i]);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "ISCreateStride");
+    ierr = ISSetBlockSize(is[i], bs);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "ISSetBlockSize");
+    offset += size;
+  }
+
+  return is;
+}
+//-----------------------------------------------------------------------------
 Vec la::create_ghosted_vector(
     const common::IndexMap& map,
     const Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>& x)
@@ -298,6 +404,8 @@ void PETScVector::apply_ghosts()
   CHECK_ERROR("VecGhostGetLocalForm");
   if (xg) // Vec is ghosted
   {
+    common::CommProfiler::Scope profile("PETScVector::apply_ghosts");
+    profile.set(0, sizeof(PetscScalar) * num_ghosts(_x, xg), 0);
     ierr = VecGhostUpdateBegin(_x, ADD_VALUES, SCATTER_REVERSE);
     CHECK_ERROR("VecGhostUpdateBegin");
     ierr = VecGhostUpdateEnd(_x, ADD_VALUES, SCATTER_REVERSE);
@@ -318,6 +426,8 @@ void PETScVector::update_ghosts()
   CHECK_ERROR("VecGhostGetLocalForm");
   if (xg) // Vec is ghosted
   {
+    common::CommProfiler::Scope profile("PETScVector::update_ghosts");
+    profile.set(0, 0, sizeof(PetscScalar) * num_ghosts(_x, xg));
     ierr = VecGhostUpdateBegin(_x, INSERT_VALUES, SCATTER_FORWARD);
     CHECK_ERROR("VecGhostUpdateBegin");
     ierr = VecGhostUpdateEnd(_x, INSERT_VALUES, SCATTER_FORWARD);
@@ -11,14 +11,11 @@
 #include <Eigen/Dense>
 #include <array>
 #include <cstdint>
+#include <dolfinx/common/IndexMap.h>
 #include <petscvec.h>
 
 namespace dolfinx
 {
-namespace common
-{
-class IndexMap;
-}
 namespace la
 {
 
@@ -48,6 +45,18 @@ void petsc_error(int error_code, std::string filename,
 std::vector<IS>
 create_petsc_index_sets(const std::vector<const common::IndexMap*>& maps);
 
+/// Compute the IndexSets (IS) of the fields of a block (monolithic) or
+/// nested matrix or vector with the owned rows of each field stacked
+/// on each process (see fem::create_matrix_block), in global indices,
+/// e.g. for PCFieldSplit. The IS of field i has the block size of
+/// maps[i]. Caller is responsible for destruction of each IS.
+///
+/// @param[in] comm The MPI communicator of the matrix
+/// @param[in] maps The IndexMaps of the fields
+/// @returns Vector of PETSc (stride) Index Sets, created on @p comm
+std::vector<IS> create_petsc_fieldsplit_index_sets(
+    MPI_Comm comm, const std::vector<const common::IndexMap*>& maps);
+
 /// Create a ghosted PETSc Vec. Caller is responsible for destroying the
 /// returned object.
 Vec create_petsc_vector(const common::IndexMap& map);
@@ -71,6 +80,33 @@ void scatter_local_vectors(
     const std::vector<Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>>& x_b,
     const std::vector<const common::IndexMap*>& maps);
 
+/// Update the ghost entries of a ghosted Vec with the values of the
+/// owning processes, using the scatter of an index map (see
+/// common::IndexMap::scatter_fwd_begin) on the local array of the Vec
+/// in place of the PETSc VecScatter (VecGhostUpdateBegin/End). The
+/// plan in the request is created on first use and reused by later
+/// calls.
+/// @param[in] map The index map of the parallel layout of @p x, with
+///   the block size of @p x
+/// @param[in,out] x A ghosted Vec, e.g. created by create_petsc_vector
+///   or create_ghosted_vector
+/// @param[in,out] request The scatter plan and communication state
+void scatter_fwd(const common::IndexMap& map, Vec x,
+                 common::IndexMap::ScatterRequest<PetscScalar>& request);
+
+/// Send the ghost entries of a ghosted Vec to the owning processes and
+/// sum or set them in the owned entries, using the scatter of an index
+/// map (see common::IndexMap::scatter_rev_begin) on the local array of
+/// the Vec in place of the PETSc VecScatter (VecGhostUpdateBegin/End).
+/// The ghost entries are not changed.
+/// @param[in] map The index map of the parallel layout of @p x, with
+///   the block size of @p x
+/// @param[in,out] x A ghosted Vec
+/// @param[in] op Sum or set the received values in the owned entries
+/// @param[in,out] request The scatter plan and communication state
+void scatter_rev(const common::IndexMap& map, Vec x, common::IndexMap::Mode op,
+                 common::IndexMap::ScatterRequest<PetscScalar>& request);
+
 /// It is a simple wrapper for a PETSc vector pointer (Vec). Its main
 /// purpose is to assist memory management of PETSc Vec objects.
 ///
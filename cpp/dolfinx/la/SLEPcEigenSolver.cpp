@@ -12,12 +12,50 @@
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/la/PETScVector.h>
+#include <algorithm>
 #include <petscmat.h>
 #include <slepcversion.h>
 
 using namespace dolfinx;
 using namespace dolfinx::la;
 
+namespace
+{
+//-----------------------------------------------------------------------------
+// Check if a Mat is matrix-free (MATSHELL)
+bool is_shell(Mat A)
+{
+  if (!A)
+    return false;
+  PetscBool shell = PETSC_FALSE;
+  PetscErrorCode ierr = PetscObjectTypeCompare((PetscObject)A, MATSHELL, &shell);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "PetscObjectTypeCompare");
+  return shell;
+}
+//-----------------------------------------------------------------------------
+// Check if a Mat (possibly nullptr) provides its diagonal
+bool has_diagonal(Mat A)
+{
+  if (!A)
+    return true;
+  PetscBool has = PETSC_FALSE;
+  PetscErrorCode ierr = MatHasOperation(A, MATOP_GET_DIAGONAL, &has);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "MatHasOperation");
+  return has;
+}
+//-----------------------------------------------------------------------------
+// Destroy the vectors of an initial space
+void destroy_space(std::vector<Vec>& space)
+{
+  for (Vec& v : space)
+    VecDestroy(&v);
+  space.clear();
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 //-----------------------------------------------------------------------------
 SLEPcEigenSolver::SLEPcEigenSolver(MPI_Comm comm) { EPSCreate(comm, &_eps); }
 //-----------------------------------------------------------------------------
@@ -37,6 +75,7 @@ SLEPcEigenSolver::SLEPcEigenSolver(EPS eps, bool inc_ref_count) : _eps(eps)
 //-----------------------------------------------------------------------------
 SLEPcEigenSolver::~SLEPcEigenSolver()
 {
+  destroy_space(_initial_space);
   if (_eps)
     EPSDestroy(&_eps);
 }
@@ -46,6 +85,57 @@ void SLEPcEigenSolver::set_operators(const Mat A, const Mat B)
   // Set operators
   assert(_eps);
   EPSSetOperators(_eps, A, B);
+
+  // The spectral transformation of matrix-free operators is applied
+  // matrix-free, and its linear systems are solved iteratively
+  if (is_shell(A) or is_shell(B))
+  {
+    ST st;
+    PetscErrorCode ierr = EPSGetST(_eps, &st);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "EPSGetST");
+    ierr = STSetMatMode(st, ST_MATMODE_SHELL);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "STSetMatMode");
+
+    KSP ksp;
+    ierr = STGetKSP(st, &ksp);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "STGetKSP");
+    ierr = KSPSetType(ksp, KSPGMRES);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "KSPSetType");
+    PC pc;
+    ierr = KSPGetPC(ksp, &pc);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "KSPGetPC");
+    ierr = PCSetType(pc, has_diagonal(A) and has_diagonal(B) ? PCJACOBI
+                                                              : PCNONE);
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "PCSetType");
+  }
+}
+//-----------------------------------------------------------------------------
+void SLEPcEigenSolver::set_preconditioner_reuse(
+    PETScKrylovSolver::PreconditionerReuse reuse)
+{
+  assert(_eps);
+  ST st;
+  PetscErrorCode ierr = EPSGetST(_eps, &st);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "EPSGetST");
+  KSP ksp;
+  ierr = STGetKSP(st, &ksp);
+  if (ierr != 0)
+    petsc_error(ierr, __FILE__, "STGetKSP");
+  PETScKrylovSolver(ksp, true).set_preconditioner_reuse(reuse);
+}
+//-----------------------------------------------------------------------------
+void SLEPcEigenSolver::set_warm_start(bool warm_start)
+{
+  _warm_start = warm_start;
+  if (!warm_start)
+    destroy_space(_initial_space);
 }
 //-----------------------------------------------------------------------------
 void SLEPcEigenSolver::solve()
@@ -80,9 +170,35 @@ void SLEPcEigenSolver::solve(std::int64_t n)
   // Set any options from the PETSc database
   EPSSetFromOptions(_eps);
 
+  // Start from the eigenvectors of the previous solve
+  if (_warm_start and !_initial_space.empty())
+  {
+    PetscErrorCode ierr = EPSSetInitialSpace(_eps, _initial_space.size(),
+                                             _initial_space.data());
+    if (ierr != 0)
+      petsc_error(ierr, __FILE__, "EPSSetInitialSpace");
+  }
+
   // Solve eigenvalue problem
   EPSSolve(_eps);
 
+  // Keep the converged eigenvectors for the next solve
+  if (_warm_start)
+  {
+    destroy_space(_initial_space);
+    Mat A, B;
+    EPSGetOperators(_eps, &A, &B);
+    PetscInt num_converged = 0;
+    EPSGetConverged(_eps, &num_converged);
+    for (PetscInt i = 0; i < std::min<PetscInt>(num_converged, n); ++i)
+    {
+      Vec x;
+      MatCreateVecs(A, &x, nullptr);
+      EPSGetEigenvector(_eps, i, x, nullptr);
+      _initial_space.push_back(x);
+    }
+  }
+
   // Check for convergence
   EPSConvergedReason reason;
   EPSGetConvergedReason(_eps, &reason);
@@ -8,6 +8,7 @@
 
 #ifdef HAS_SLEPC
 
+#include "PETScKrylovSolver.h"
 #include "dolfinx/common/MPI.h"
 #include "dolfinx/common/types.h"
 #include <memory>
@@ -15,6 +16,7 @@
 #include <petscvec.h>
 #include <slepceps.h>
 #include <string>
+#include <vector>
 
 namespace dolfinx
 {
@@ -37,10 +39,37 @@ public:
   /// Destructor
   ~SLEPcEigenSolver();
 
+  // Copy constructor (deleted)
+  SLEPcEigenSolver(const SLEPcEigenSolver& solver) = delete;
+
+  // Assignment operator (deleted)
+  SLEPcEigenSolver& operator=(const SLEPcEigenSolver& solver) = delete;
+
   /// Set opeartors (B may be nullptr for regular eigenvalues
-  /// problems)
+  /// problems). The operators may be matrix-free (MATSHELL), e.g.
+  /// created by fem::create_matrix_free. The spectral transformation
+  /// then does not form or factorise A - sigma B, and the linear
+  /// systems of the spectral transformation are solved with GMRES and
+  /// a Jacobi preconditioner (no preconditioner if an operator does
+  /// not provide its diagonal). These defaults can be changed by
+  /// options, e.g. -st_ksp_type cg.
   void set_operators(const Mat A, const Mat B);
 
+  /// Set the reuse of the preconditioner (e.g. the factorisation of
+  /// shift-and-invert) of the spectral transformation when the
+  /// operators change between solves, e.g. for a sequence of similar
+  /// problems (see PETScKrylovSolver::set_preconditioner_reuse). With
+  /// PreconditionerReuse::full, the linear systems are solved exactly
+  /// only with an iterative solver (e.g. -st_ksp_type gmres), as the
+  /// preconditioner is computed from the first operators.
+  void set_preconditioner_reuse(PETScKrylovSolver::PreconditionerReuse reuse);
+
+  /// Use the converged eigenvectors of a solve as the initial space of
+  /// the next solve, which reduces the number of iterations for a
+  /// sequence of similar problems
+  /// @param[in] warm_start True to use the previous eigenvectors
+  void set_warm_start(bool warm_start);
+
   /// Compute all eigenpairs of the matrix A (solve Ax = \lambda x)
   void solve();
 
@@ -80,6 +109,12 @@ public:
 private:
   // SLEPc solver pointer
   EPS _eps;
+
+  // Use the eigenvectors of the previous solve as initial space
+  bool _warm_start = false;
+
+  // Converged eigenvectors of the previous solve (warm start)
+  std::vector<Vec> _initial_space;
 };
 } // namespace la
 } // namespace dolfinx
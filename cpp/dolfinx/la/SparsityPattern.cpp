@@ -6,24 +6,84 @@
 
 #include "SparsityPattern.h"
 #include <algorithm>
+#include <numeric>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/ThreadPool.h>
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/fem/utils.h>
 #include <dolfinx/graph/AdjacencyList.h>
+#include <set>
+#include <tuple>
 
 using namespace dolfinx;
 using namespace dolfinx::la;
 
+namespace
+{
+//-----------------------------------------------------------------------------
+// A stacked index map (block size 1) of the fields of a block system,
+// with the owned entries of the fields followed by the ghosts of the
+// fields
+struct StackedMap
+{
+  std::shared_ptr<const common::IndexMap> map;
+
+  // Offsets of the owned entries of the fields, and the total number
+  // of owned entries
+  std::vector<std::int32_t> local_offset;
+
+  // Offsets of the ghosts of the fields in the ghosts of the map
+  std::vector<std::int32_t> ghost_offset;
+
+  // New global indices of the ghosts of each field
+  std::vector<std::vector<std::int64_t>> ghosts;
+};
+//-----------------------------------------------------------------------------
+StackedMap stack_maps(
+    MPI_Comm comm,
+    const std::vector<std::reference_wrapper<const common::IndexMap>>& maps)
+{
+  StackedMap stacked;
+  std::vector<std::vector<int>> owners;
+  std::tie(std::ignore, stacked.local_offset, stacked.ghosts, owners)
+      = common::stack_index_maps(maps);
+
+  std::vector<std::int64_t> ghosts;
+  std::vector<int> ghost_owners;
+  stacked.ghost_offset.push_back(0);
+  for (std::size_t f = 0; f < maps.size(); ++f)
+  {
+    stacked.ghost_offset.push_back(stacked.ghost_offset.back()
+                                   + stacked.ghosts[f].size());
+    ghosts.insert(ghosts.end(), stacked.ghosts[f].begin(),
+                  stacked.ghosts[f].end());
+    ghost_owners.insert(ghost_owners.end(), owners[f].begin(),
+                        owners[f].end());
+  }
+
+  stacked.map = std::make_shared<common::IndexMap>(
+      comm, stacked.local_offset.back(),
+      dolfinx::MPI::compute_graph_edges(
+          comm, std::set<int>(ghost_owners.begin(), ghost_owners.end())),
+      ghosts, ghost_owners, 1);
+
+  return stacked;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 //-----------------------------------------------------------------------------
 SparsityPattern::SparsityPattern(
     MPI_Comm comm,
-    const std::array<std::shared_ptr<const common::IndexMap>, 2>& index_maps)
-    : _mpi_comm(comm), _index_maps(index_maps)
+    const std::array<std::shared_ptr<const common::IndexMap>, 2>& index_maps,
+    bool blocked)
+    : _mpi_comm(comm), _index_maps(index_maps), _blocked(blocked)
 {
+  const int bs0 = blocked ? 1 : index_maps[0]->block_size();
   const std::int32_t local_size0
-      = index_maps[0]->block_size()
-        * (index_maps[0]->size_local() + index_maps[0]->num_ghosts());
+      = bs0 * (index_maps[0]->size_local() + index_maps[0]->num_ghosts());
   _diagonal_cache.resize(local_size0);
   _off_diagonal_cache.resize(local_size0);
 }
@@ -38,41 +98,17 @@ SparsityPattern::SparsityPattern(
   // FIXME: - Add range/bound checks for each block
   //        - Check for compatible block sizes for each block
 
-  const auto [rank_offset0, local_offset0, ghosts_new0, owners0]
-      = common::stack_index_maps(maps[0]);
-  const auto [rank_offset1, local_offset1, ghosts_new1, owners1]
-      = common::stack_index_maps(maps[1]);
-
-  std::vector<std::int64_t> ghosts0, ghosts1;
-  std::vector<std::int32_t> ghost_offsets0(1, 0);
-  for (const std::vector<std::int64_t>& ghosts : ghosts_new0)
-  {
-    ghost_offsets0.push_back(ghost_offsets0.back() + ghosts.size());
-    ghosts0.insert(ghosts0.end(), ghosts.begin(), ghosts.end());
-  }
-  for (const std::vector<std::int64_t>& ghosts : ghosts_new1)
-    ghosts1.insert(ghosts1.end(), ghosts.begin(), ghosts.end());
-
-  std::vector<int> ghost_owners0, ghost_owners1;
-  for (const std::vector<int>& owners : owners0)
-    ghost_owners0.insert(ghost_owners0.end(), owners.begin(), owners.end());
-  for (const std::vector<int>& owners : owners1)
-    ghost_owners1.insert(ghost_owners1.end(), owners.begin(), owners.end());
-
-  // Create new IndexMaps
-  _index_maps[0] = std::make_shared<common::IndexMap>(
-      comm, local_offset0.back(),
-      dolfinx::MPI::compute_graph_edges(
-          comm, std::set<int>(ghost_owners0.begin(), ghost_owners0.end())),
-      ghosts0, ghost_owners0, 1);
-  _index_maps[1] = std::make_shared<common::IndexMap>(
-      comm, local_offset1.back(),
-      dolfinx::MPI::compute_graph_edges(
-          comm, std::set<int>(ghost_owners1.begin(), ghost_owners1.end())),
-      ghosts1, ghost_owners1, 1);
+  const StackedMap stacked0 = stack_maps(comm, maps[0]);
+  const StackedMap stacked1 = stack_maps(comm, maps[1]);
+  const std::vector<std::int32_t>& local_offset0 = stacked0.local_offset;
+  const std::vector<std::int32_t>& local_offset1 = stacked1.local_offset;
+  const std::vector<std::int32_t>& ghost_offsets0 = stacked0.ghost_offset;
+  const std::vector<std::vector<std::int64_t>>& ghosts_new1 = stacked1.ghosts;
+  _index_maps = {stacked0.map, stacked1.map};
 
   // Size cache arrays
-  const std::int32_t size_row = local_offset0.back() + ghosts0.size();
+  const std::int32_t size_row
+      = local_offset0.back() + stacked0.map->num_ghosts();
   _diagonal_cache.resize(size_row);
   _off_diagonal_cache.resize(size_row);
 
@@ -115,6 +151,12 @@ SparsityPattern::SparsityPattern(
       if (!p)
         continue;
 
+      if (p->_blocked)
+      {
+        throw std::runtime_error("Sub-sparsity pattern is blocked. "
+                                 "Cannot compute stacked pattern.");
+      }
+
       if (p->_diagonal)
       {
         throw std::runtime_error("Sub-sparsity pattern has been finalised. "
@@ -169,9 +211,22 @@ SparsityPattern::SparsityPattern(
   }
 }
 //-----------------------------------------------------------------------------
+SparsityPattern::SparsityPattern(
+    MPI_Comm comm,
+    const std::array<
+        std::vector<std::reference_wrapper<const common::IndexMap>>, 2>& maps)
+    : _mpi_comm(comm)
+{
+  _index_maps = {stack_maps(comm, maps[0]).map, stack_maps(comm, maps[1]).map};
+  const std::int32_t size_row
+      = _index_maps[0]->size_local() + _index_maps[0]->num_ghosts();
+  _diagonal_cache.resize(size_row);
+  _off_diagonal_cache.resize(size_row);
+}
+//-----------------------------------------------------------------------------
 std::array<std::int64_t, 2> SparsityPattern::local_range(int dim) const
 {
-  const int bs = _index_maps.at(dim)->block_size();
+  const int bs = _blocked ? 1 : _index_maps.at(dim)->block_size();
   const std::array lrange = _index_maps[dim]->local_range();
   return {bs * lrange[0], bs * lrange[1]};
 }
@@ -182,6 +237,8 @@ SparsityPattern::index_map(int dim) const
   return _index_maps.at(dim);
 }
 //-----------------------------------------------------------------------------
+bool SparsityPattern::blocked() const { return _blocked; }
+//-----------------------------------------------------------------------------
 void SparsityPattern::insert(
     const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>& rows,
     const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>& cols)
@@ -193,12 +250,12 @@ void SparsityPattern::insert(
   }
 
   assert(_index_maps[0]);
-  const int bs0 = _index_maps[0]->block_size();
+  const int bs0 = _blocked ? 1 : _index_maps[0]->block_size();
   const std::int32_t size0
       = bs0 * (_index_maps[0]->size_local() + _index_maps[0]->num_ghosts());
 
   assert(_index_maps[1]);
-  const int bs1 = _index_maps[1]->block_size();
+  const int bs1 = _blocked ? 1 : _index_maps[1]->block_size();
   const std::int32_t local_size1 = _index_maps[1]->size_local();
   const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& ghosts1
       = _index_maps[1]->ghosts();
@@ -227,6 +284,123 @@ void SparsityPattern::insert(
   }
 }
 //-----------------------------------------------------------------------------
+void SparsityPattern::insert_entities(
+    const graph::AdjacencyList<std::int32_t>& rows,
+    const graph::AdjacencyList<std::int32_t>& cols, std::array<int, 2> bs,
+    int num_threads)
+{
+  if (_diagonal)
+  {
+    throw std::runtime_error(
+        "Cannot insert into sparsity pattern. It has already been assembled");
+  }
+
+  if (rows.num_nodes() != cols.num_nodes())
+    throw std::runtime_error("Number of row and column entities differ.");
+
+  if (_blocked)
+    bs = {1, 1};
+
+  assert(_index_maps[0]);
+  const int bs0 = _blocked ? 1 : _index_maps[0]->block_size();
+  const std::int32_t size0
+      = bs0 * (_index_maps[0]->size_local() + _index_maps[0]->num_ghosts());
+  const std::int32_t num_row_blocks = size0 / bs[0];
+
+  assert(_index_maps[1]);
+  const int bs1 = _blocked ? 1 : _index_maps[1]->block_size();
+  const std::int32_t local_size1 = _index_maps[1]->size_local();
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& ghosts1
+      = _index_maps[1]->ghosts();
+
+  // Count the entities of each row block
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& row_array
+      = rows.array();
+  std::vector<std::int32_t> offsets(num_row_blocks + 1, 0);
+  for (Eigen::Index i = 0; i < row_array.rows(); ++i)
+  {
+    if (row_array[i] < 0 or row_array[i] >= num_row_blocks)
+    {
+      throw std::runtime_error(
+          "Cannot insert rows that do not exist in the IndexMap.");
+    }
+    ++offsets[row_array[i] + 1];
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  // Fill the entities of each row block
+  std::vector<std::int32_t> row_entities(offsets.back());
+  {
+    std::vector<std::int32_t> pos(offsets.begin(), offsets.end() - 1);
+    for (std::int32_t e = 0; e < rows.num_nodes(); ++e)
+    {
+      auto entity_rows = rows.links(e);
+      for (Eigen::Index i = 0; i < entity_rows.rows(); ++i)
+        row_entities[pos[entity_rows[i]]++] = e;
+    }
+  }
+
+  // Compress each row block, and append its (unrolled) columns to the
+  // rows of the block. Each row is written by one thread only.
+  common::parallel_for(
+      num_threads, num_row_blocks,
+      [&](int, std::int32_t r0, std::int32_t r1) {
+        std::vector<std::int32_t> blocks;
+        std::vector<std::int32_t> diagonal;
+        std::vector<std::int64_t> off_diagonal;
+        for (std::int32_t r = r0; r < r1; ++r)
+        {
+          if (offsets[r] == offsets[r + 1])
+            continue;
+
+          blocks.clear();
+          for (std::int32_t k = offsets[r]; k < offsets[r + 1]; ++k)
+          {
+            auto entity_cols = cols.links(row_entities[k]);
+            blocks.insert(blocks.end(), entity_cols.data(),
+                          entity_cols.data() + entity_cols.rows());
+          }
+          std::sort(blocks.begin(), blocks.end());
+          blocks.erase(std::unique(blocks.begin(), blocks.end()),
+                       blocks.end());
+
+          diagonal.clear();
+          off_diagonal.clear();
+          for (std::int32_t block : blocks)
+          {
+            for (int j = 0; j < bs[1]; ++j)
+            {
+              const std::int32_t col = bs[1] * block + j;
+              if (col < bs1 * local_size1)
+                diagonal.push_back(col);
+              else
+              {
+                const std::div_t div = std::div(col, bs1);
+                const std::int64_t block_global
+                    = ghosts1[div.quot - local_size1];
+                off_diagonal.push_back(bs1 * block_global + div.rem);
+              }
+            }
+          }
+
+          for (int i = 0; i < bs[0]; ++i)
+          {
+            const std::int32_t row = bs[0] * r + i;
+            std::vector<std::int32_t>& row_diagonal = _diagonal_cache[row];
+            row_diagonal.reserve(row_diagonal.size() + diagonal.size());
+            row_diagonal.insert(row_diagonal.end(), diagonal.begin(),
+                                diagonal.end());
+            std::vector<std::int64_t>& row_off_diagonal
+                = _off_diagonal_cache[row];
+            row_off_diagonal.reserve(row_off_diagonal.size()
+                                     + off_diagonal.size());
+            row_off_diagonal.insert(row_off_diagonal.end(),
+                                    off_diagonal.begin(), off_diagonal.end());
+          }
+        }
+      });
+}
+//-----------------------------------------------------------------------------
 void SparsityPattern::insert_diagonal(
     const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>& rows)
 {
@@ -237,7 +411,7 @@ void SparsityPattern::insert_diagonal(
   }
 
   assert(_index_maps[0]);
-  const int bs0 = _index_maps[0]->block_size();
+  const int bs0 = _blocked ? 1 : _index_maps[0]->block_size();
   const std::int32_t local_size0
       = bs0 * (_index_maps[0]->size_local() + _index_maps[0]->num_ghosts());
   for (Eigen::Index i = 0; i < rows.rows(); ++i)
@@ -254,64 +428,36 @@ void SparsityPattern::insert_diagonal(
 //-----------------------------------------------------------------------------
 void SparsityPattern::assemble()
 {
-  if (_diagonal)
-    throw std::runtime_error("Sparsity pattern has already been finalised.");
-  assert(!_off_diagonal);
-
-  assert(_index_maps[0]);
-  const int bs0 = _index_maps[0]->block_size();
-  const std::int32_t local_size0 = _index_maps[0]->size_local();
-  const std::int32_t num_ghosts0 = _index_maps[0]->num_ghosts();
-  const std::array local_range0 = _index_maps[0]->local_range();
-  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& ghosts0
-      = _index_maps[0]->ghosts();
-
-  assert(_index_maps[1]);
-  const int bs1 = _index_maps[1]->block_size();
-  const std::int32_t local_size1 = _index_maps[1]->size_local();
-  const std::array local_range1 = _index_maps[1]->local_range();
-  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& ghosts1
-      = _index_maps[1]->ghosts();
-
-  // For each ghost row, pack and send (global row, global col) pairs to
-  // send to neighborhood
-  std::vector<std::int64_t> ghost_data;
-  for (int i = 0; i < num_ghosts0; ++i)
+  SparsityPattern::assemble(std::vector<SparsityPattern*>{this});
+}
+//-----------------------------------------------------------------------------
+void SparsityPattern::assemble(const std::vector<SparsityPattern*>& patterns)
+{
+  if (patterns.empty())
+    return;
+  common::Timer timer("SparsityPattern assemble");
+  for (const SparsityPattern* p : patterns)
   {
-    const std::int64_t row_node_global = ghosts0[i];
-    const std::int32_t row_node_local = local_size0 + i;
-    for (int j = 0; j < bs0; ++j)
+    assert(p);
+    if (p->_diagonal)
+      throw std::runtime_error("Sparsity pattern has already been finalised.");
+    assert(!p->_off_diagonal);
+    if (p->_index_maps[0] != patterns[0]->_index_maps[0])
     {
-      const std::int64_t row_global = bs0 * row_node_global + j;
-      const std::int32_t row_local = bs0 * row_node_local + j;
-      assert((std::size_t)row_local < _diagonal_cache.size());
-      const std::vector<std::int32_t>& cols = _diagonal_cache[row_local];
-      for (std::size_t c = 0; c < cols.size(); ++c)
-      {
-        ghost_data.push_back(row_global);
-
-        // Convert to global column index
-        if (cols[c] < bs1 * local_size1)
-          ghost_data.push_back(cols[c] + bs1 * local_range1[0]);
-        else
-        {
-          const std::div_t div = std::div(cols[c], bs1);
-          const std::int64_t block_global = ghosts1[div.quot - local_size1];
-          ghost_data.push_back(bs1 * block_global + div.rem);
-        }
-      }
-
-      const std::vector<std::int64_t>& cols_off
-          = _off_diagonal_cache[row_local];
-      for (std::size_t c = 0; c < cols_off.size(); ++c)
-      {
-        ghost_data.push_back(row_global);
-        ghost_data.push_back(cols_off[c]);
-      }
+      throw std::runtime_error(
+          "Cannot assemble sparsity patterns with different row maps.");
     }
   }
 
-  MPI_Comm comm = _index_maps[0]->comm(common::IndexMap::Direction::symmetric);
+  // For each ghost row of each pattern, pack (pattern, global row,
+  // global col) triples to send to the neighborhood
+  std::vector<std::int64_t> ghost_data;
+  for (std::size_t i = 0; i < patterns.size(); ++i)
+    patterns[i]->pack_ghost_rows(i, ghost_data);
+
+  assert(patterns[0]->_index_maps[0]);
+  MPI_Comm comm = patterns[0]->_index_maps[0]->comm(
+      common::IndexMap::Direction::symmetric);
   int num_neighbors(-1), outdegree(-2), weighted(-1);
   MPI_Dist_graph_neighbors_count(comm, &num_neighbors, &outdegree, &weighted);
   assert(num_neighbors == outdegree);
@@ -340,26 +486,102 @@ void SparsityPattern::assemble()
                           disp.data(), MPI_INT64_T, comm);
 
   // Add data received from the neighborhood
-  for (std::size_t i = 0; i < ghost_data_received.size(); i += 2)
+  for (std::size_t i = 0; i < ghost_data_received.size(); i += 3)
   {
-    const std::int64_t row = ghost_data_received[i];
+    assert(ghost_data_received[i] < (std::int64_t)patterns.size());
+    SparsityPattern& p = *patterns[ghost_data_received[i]];
+    const int bs0 = p._blocked ? 1 : p._index_maps[0]->block_size();
+    const int bs1 = p._blocked ? 1 : p._index_maps[1]->block_size();
+    const std::array local_range0 = p._index_maps[0]->local_range();
+    const std::array local_range1 = p._index_maps[1]->local_range();
+    const std::int64_t row = ghost_data_received[i + 1];
     if (row >= bs0 * local_range0[0] and row < bs0 * local_range0[1])
     {
       const std::int32_t row_local = row - bs0 * local_range0[0];
-      const std::int64_t col = ghost_data_received[i + 1];
+      const std::int64_t col = ghost_data_received[i + 2];
       if (col >= bs1 * local_range1[0] and col < bs1 * local_range1[1])
       {
         // Convert to local column index
         const std::int32_t J = col - bs1 * local_range1[0];
-        _diagonal_cache[row_local].push_back(J);
+        p._diagonal_cache[row_local].push_back(J);
       }
       else
       {
-        assert(row_local < (std::int32_t)_off_diagonal_cache.size());
-        _off_diagonal_cache[row_local].push_back(col);
+        assert(row_local < (std::int32_t)p._off_diagonal_cache.size());
+        p._off_diagonal_cache[row_local].push_back(col);
+      }
+    }
+  }
+
+  for (SparsityPattern* p : patterns)
+    p->finalise();
+}
+//-----------------------------------------------------------------------------
+void SparsityPattern::pack_ghost_rows(std::int64_t id,
+                                      std::vector<std::int64_t>& data)
+{
+  assert(_index_maps[0]);
+  const int bs0 = _blocked ? 1 : _index_maps[0]->block_size();
+  const std::int32_t local_size0 = _index_maps[0]->size_local();
+  const std::int32_t num_ghosts0 = _index_maps[0]->num_ghosts();
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& ghosts0
+      = _index_maps[0]->ghosts();
+
+  assert(_index_maps[1]);
+  const int bs1 = _blocked ? 1 : _index_maps[1]->block_size();
+  const std::int32_t local_size1 = _index_maps[1]->size_local();
+  const std::array local_range1 = _index_maps[1]->local_range();
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& ghosts1
+      = _index_maps[1]->ghosts();
+
+  // The global columns of the ghost rows are also kept as the ghost
+  // pattern
+  std::vector<std::vector<std::int64_t>> ghost_cache(bs0 * num_ghosts0);
+  for (int i = 0; i < num_ghosts0; ++i)
+  {
+    const std::int64_t row_node_global = ghosts0[i];
+    const std::int32_t row_node_local = local_size0 + i;
+    for (int j = 0; j < bs0; ++j)
+    {
+      const std::int64_t row_global = bs0 * row_node_global + j;
+      const std::int32_t row_local = bs0 * row_node_local + j;
+      assert((std::size_t)row_local < _diagonal_cache.size());
+      std::vector<std::int64_t>& ghost_cols = ghost_cache[bs0 * i + j];
+      const std::vector<std::int32_t>& cols = _diagonal_cache[row_local];
+      for (std::size_t c = 0; c < cols.size(); ++c)
+      {
+        // Convert to global column index
+        if (cols[c] < bs1 * local_size1)
+          ghost_cols.push_back(cols[c] + bs1 * local_range1[0]);
+        else
+        {
+          const std::div_t div = std::div(cols[c], bs1);
+          const std::int64_t block_global = ghosts1[div.quot - local_size1];
+          ghost_cols.push_back(bs1 * block_global + div.rem);
+        }
+      }
+
+      const std::vector<std::int64_t>& cols_off
+          = _off_diagonal_cache[row_local];
+      ghost_cols.insert(ghost_cols.end(), cols_off.begin(), cols_off.end());
+      std::sort(ghost_cols.begin(), ghost_cols.end());
+      ghost_cols.erase(std::unique(ghost_cols.begin(), ghost_cols.end()),
+                       ghost_cols.end());
+      for (std::int64_t col : ghost_cols)
+      {
+        data.push_back(id);
+        data.push_back(row_global);
+        data.push_back(col);
       }
     }
   }
+  _ghost = std::make_shared<graph::AdjacencyList<std::int64_t>>(ghost_cache);
+}
+//-----------------------------------------------------------------------------
+void SparsityPattern::finalise()
+{
+  const int bs0 = _blocked ? 1 : _index_maps[0]->block_size();
+  const std::int32_t local_size0 = _index_maps[0]->size_local();
 
   _diagonal_cache.resize(bs0 * local_size0);
   for (std::vector<std::int32_t>& row : _diagonal_cache)
@@ -406,5 +628,29 @@ SparsityPattern::off_diagonal_pattern() const
   return *_off_diagonal;
 }
 //-----------------------------------------------------------------------------
+const graph::AdjacencyList<std::int64_t>&
+SparsityPattern::ghost_pattern() const
+{
+  if (!_ghost)
+    throw std::runtime_error("Sparsity pattern has not been finalised.");
+  return *_ghost;
+}
+//-----------------------------------------------------------------------------
+std::size_t SparsityPattern::memory_usage() const
+{
+  std::size_t bytes = 0;
+  for (const std::vector<std::int32_t>& row : _diagonal_cache)
+    bytes += sizeof(row) + row.capacity() * sizeof(std::int32_t);
+  for (const std::vector<std::int64_t>& row : _off_diagonal_cache)
+    bytes += sizeof(row) + row.capacity() * sizeof(std::int64_t);
+  if (_diagonal)
+    bytes += _diagonal->memory_usage();
+  if (_off_diagonal)
+    bytes += _off_diagonal->memory_usage();
+  if (_ghost)
+    bytes += _ghost->memory_usage();
+  return bytes;
+}
+//-----------------------------------------------------------------------------
 MPI_Comm SparsityPattern::mpi_comm() const { return _mpi_comm.comm(); }
 //-----------------------------------------------------------------------------
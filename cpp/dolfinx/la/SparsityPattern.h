@@ -7,6 +7,7 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <array>
 #include <dolfinx/common/MPI.h>
 #include <memory>
 #include <string>
@@ -38,9 +39,39 @@ class SparsityPattern
 
 public:
   /// Create an empty sparsity pattern with specified dimensions
+  /// @param[in] comm The MPI communicator
+  /// @param[in] index_maps The index maps for the rows and columns
+  /// @param[in] blocked If true, the pattern is built in block form,
+  ///   i.e. the rows and columns are the (block) indices of the index
+  ///   maps rather than the indices of the individual entries of each
+  ///   block. Each non-zero then represents a dense block of size
+  ///   index_maps[0]->block_size() x index_maps[1]->block_size().
+  SparsityPattern(
+      MPI_Comm comm,
+      const std::array<std::shared_ptr<const common::IndexMap>, 2>& index_maps,
+      bool blocked = false);
+
+  /// Create an empty stacked sparsity pattern for a block system, with
+  /// the rows (columns) of the fields of maps[0] (maps[1]) stacked. The
+  /// index maps of the pattern (block size 1) number the owned entries
+  /// of the fields in order, followed by the ghosts of the fields in
+  /// order, i.e. local entry i of field f (unrolled) has the local index
+  /// offset_f + i if it is owned and ghost_offset_f + i - n_f otherwise,
+  /// where n_f is the number of owned entries of field f, offset_f is
+  /// the number of owned entries of the fields before f, and
+  /// ghost_offset_f is the number of owned entries of all fields plus
+  /// the number of ghosts of the fields before f. Entries of all blocks
+  /// can then be inserted directly, e.g. by a single pass over the
+  /// cells (see fem::SparsityPatternBuilder).
+  ///
+  /// @param[in] comm The MPI communicator
+  /// @param[in] maps Index maps for each row block (maps[0]) and column
+  ///   blocks (maps[1])
   SparsityPattern(
       MPI_Comm comm,
-      const std::array<std::shared_ptr<const common::IndexMap>, 2>& index_maps);
+      const std::array<
+          std::vector<std::reference_wrapper<const common::IndexMap>>, 2>&
+          maps);
 
   /// Create a new sparsity pattern by concatenating sub-patterns, e.g.
   /// pattern =[ pattern00 ][ pattern 01]
@@ -48,7 +79,8 @@ public:
   ///
   /// @param[in] comm The MPI communicator
   /// @param[in] patterns Rectangular array of sparsity pattern. The
-  ///   patterns must not be finalised. Null block are permited
+  ///   patterns must not be finalised or blocked. Null block are
+  ///   permited
   /// @param[in] maps Index maps for each row block (maps[0]) and column
   ///   blocks (maps[1])
   SparsityPattern(
@@ -69,19 +101,45 @@ public:
   /// Move assignment
   SparsityPattern& operator=(SparsityPattern&& pattern) = default;
 
-  /// Return local range for dimension dim
+  /// Return local range for dimension dim (of the blocks if the pattern
+  /// is blocked)
   std::array<std::int64_t, 2> local_range(int dim) const;
 
   /// Return index map for dimension dim
   std::shared_ptr<const common::IndexMap> index_map(int dim) const;
 
-  /// Insert non-zero locations using local (process-wise) indices
+  /// Return true if the pattern is in block form, i.e. the rows and
+  /// columns are the block indices of the index maps
+  bool blocked() const;
+
+  /// Insert non-zero locations using local (process-wise) indices.
+  /// The indices are block indices if the pattern is blocked.
   void
   insert(const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
              rows,
          const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>&
              cols);
 
+  /// Insert the non-zero locations coupling the row and column blocks
+  /// of each entity, e.g. the blocked dofs of each cell, i.e. the
+  /// entries (rows.links(e), cols.links(e)) for all entities e. The
+  /// entities of each row block are first counted and then gathered
+  /// into a single array, such that each row block is compressed
+  /// (sorted and duplicates removed) once before it is added to the
+  /// pattern. The intermediate memory is bounded by the size of the
+  /// entity lists, rather than the number of inserted pairs as for
+  /// insert.
+  /// @param[in] rows The row blocks of each entity (local indices)
+  /// @param[in] cols The column blocks of each entity (local indices)
+  /// @param[in] bs The block sizes of the row and column blocks. The
+  ///   block indices are inserted if the pattern is blocked, and the
+  ///   unrolled indices bs[0] * row + i and bs[1] * col + j otherwise.
+  /// @param[in] num_threads The number of threads used to compress the
+  ///   row blocks
+  void insert_entities(const graph::AdjacencyList<std::int32_t>& rows,
+                       const graph::AdjacencyList<std::int32_t>& cols,
+                       std::array<int, 2> bs, int num_threads = 1);
+
   /// Insert non-zero locations on the diagonal
   /// @param[in] rows The rows in local (process-wise) indices. The
   ///   indices must exist in the row IndexMap.
@@ -92,7 +150,15 @@ public:
   /// Finalize sparsity pattern and communicate off-process entries
   void assemble();
 
-  /// Return number of local nonzeros
+  /// Finalize sparsity patterns with the same row index map, e.g. the
+  /// blocks of a block row of a nested matrix, with a single exchange
+  /// of the off-process entries of all patterns (collective)
+  /// @param[in] patterns The patterns, in the same order on all
+  ///   processes
+  static void assemble(const std::vector<SparsityPattern*>& patterns);
+
+  /// Return number of local nonzeros (non-zero blocks if the pattern is
+  /// blocked)
   std::int64_t num_nonzeros() const;
 
   /// Sparsity pattern for the owned (diagonal) block. Uses local
@@ -103,16 +169,38 @@ public:
   /// indices for the columns.
   const graph::AdjacencyList<std::int64_t>& off_diagonal_pattern() const;
 
+  /// Sparsity pattern for the ghost rows, i.e. the rows that are
+  /// inserted on this process and owned by another process. Uses global
+  /// indices for the columns.
+  const graph::AdjacencyList<std::int64_t>& ghost_pattern() const;
+
+  /// Memory used by the insertion caches (before the pattern is
+  /// finalised) and the diagonal, off-diagonal and ghost patterns. The
+  /// index maps are not included.
+  /// @return Memory usage in bytes
+  std::size_t memory_usage() const;
+
   /// Return MPI communicator
   MPI_Comm mpi_comm() const;
 
 private:
+  // Append the (id, global row, global column) entries of the ghost
+  // rows to data, and keep the ghost pattern
+  void pack_ghost_rows(std::int64_t id, std::vector<std::int64_t>& data);
+
+  // Sort the owned rows, and create the diagonal and off-diagonal
+  // patterns
+  void finalise();
+
   // MPI communicator
   dolfinx::MPI::Comm _mpi_comm;
 
   // common::IndexMaps for each dimension
   std::array<std::shared_ptr<const common::IndexMap>, 2> _index_maps;
 
+  // True if rows and columns are block indices of the index maps
+  bool _blocked = false;
+
   // Caches for diagonal and off-diagonal blocks
   std::vector<std::vector<std::int32_t>> _diagonal_cache;
   std::vector<std::vector<std::int64_t>> _off_diagonal_cache;
@@ -120,6 +208,7 @@ private:
   // Sparsity pattern data (computed once pattern is finalised)
   std::shared_ptr<graph::AdjacencyList<std::int32_t>> _diagonal;
   std::shared_ptr<graph::AdjacencyList<std::int64_t>> _off_diagonal;
+  std::shared_ptr<graph::AdjacencyList<std::int64_t>> _ghost;
 };
 } // namespace la
 } // namespace dolfinx
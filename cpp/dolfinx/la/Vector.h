@@ -6,9 +6,16 @@
 
 #pragma once
 
+#include "utils.h"
 #include <Eigen/Dense>
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
 #include <memory>
+#include <stdexcept>
+#include <vector>
 
 namespace dolfinx::la
 {
@@ -49,8 +56,78 @@ public:
   /// Get local part of the vector (const version)
   const Eigen::Matrix<T, Eigen::Dynamic, 1>& array() const { return _x; }
 
-  /// Get local part of the vector
-  Eigen::Matrix<T, Eigen::Dynamic, 1>& array() { return _x; }
+  /// Get local part of the vector. Increases the modification counter
+  /// (see version).
+  Eigen::Matrix<T, Eigen::Dynamic, 1>& array()
+  {
+    ++_version;
+    return _x;
+  }
+
+  /// Modification counter. It is increased by each non-const access to
+  /// the data and by ghost updates, and can be used to detect changes,
+  /// e.g. for caching data derived from the vector. Modifications
+  /// through a reference obtained from array() before the counter was
+  /// read are not detected.
+  /// @return The modification counter
+  std::int64_t version() const { return _version; }
+
+  /// Update the ghost entries with the values from the owning
+  /// processes (collective)
+  void scatter_fwd()
+  {
+    scatter_fwd_begin();
+    scatter_fwd_end();
+  }
+
+  /// Start sending the owned entries to the processes that have them
+  /// as ghosts (collective). The owned values are copied into a send
+  /// buffer, so the vector can be modified before the scatter is
+  /// completed with scatter_fwd_end.
+  void scatter_fwd_begin()
+  {
+    _map->scatter_fwd_begin(_x.data(), _map->block_size(), _request_fwd);
+  }
+
+  /// Complete a forward scatter started with scatter_fwd_begin, and
+  /// update the ghost entries with the received values
+  void scatter_fwd_end()
+  {
+    const std::int32_t size_owned = _map->block_size() * _map->size_local();
+    _map->scatter_fwd_end(_x.data() + size_owned, _request_fwd);
+    ++_version;
+  }
+
+  /// Send the ghost entries to the owning processes and add them to
+  /// (or insert them into) the owned entries (collective). The ghost
+  /// entries are not modified.
+  /// @param[in] op Add or insert the received values
+  void scatter_rev(common::IndexMap::Mode op)
+  {
+    scatter_rev_begin();
+    scatter_rev_end(op);
+  }
+
+  /// Start sending the ghost entries to the owning processes
+  /// (collective). The ghost values are copied into a send buffer, so
+  /// the vector can be modified before the scatter is completed with
+  /// scatter_rev_end, e.g. to overlap computation with communication.
+  void scatter_rev_begin()
+  {
+    const std::int32_t size_owned = _map->block_size() * _map->size_local();
+    _map->scatter_rev_begin(_x.data() + size_owned, _map->block_size(),
+                            _request_rev);
+  }
+
+  /// Complete a reverse scatter started with scatter_rev_begin, and
+  /// add the received values to (or insert them into) the owned
+  /// entries. The ghost entries are not modified.
+  /// @param[in] op Add or insert the received values
+  void scatter_rev_end(common::IndexMap::Mode op)
+  {
+    _map->scatter_rev_end(_x.data(), op, _request_rev);
+    ++_version;
+  }
 
 private:
   // Map describing the data layout
@@ -58,5 +135,419 @@ private:
 
   // Data
   Eigen::Matrix<T, Eigen::Dynamic, 1> _x;
+
+  // Modification counter
+  std::int64_t _version = 0;
+
+  // Plans and state of the forward and reverse scatters, reused by
+  // repeated scatters
+  common::IndexMap::ScatterRequest<T> _request_fwd, _request_rev;
+};
+
+/// Non-owning view of a subset of the local entries of a vector, e.g.
+/// the entries of a subfunction in the vector of its parent function
+/// (see function::Function::collapsed_view). The view shares the data
+/// of the vector, and the entries are addressed through a list of
+/// indices. If the indices are equally spaced, the view can also be
+/// accessed as a strided Eigen map without copying (see strided).
+
+template <typename T>
+class VectorView
+{
+public:
+  /// Create a view
+  /// @param[in] x The vector
+  /// @param[in] indices Indices of the entries of the view in the local
+  ///   (owned and ghost) array of @p x
+  VectorView(std::shared_ptr<Vector<T>> x,
+             std::shared_ptr<const std::vector<std::int32_t>> indices)
+      : _x(x), _indices(indices)
+  {
+    assert(x);
+    assert(indices);
+
+    // Check for equally spaced indices
+    const std::vector<std::int32_t>& idx = *indices;
+    if (!idx.empty())
+    {
+      _offset = idx[0];
+      _stride = idx.size() > 1 ? idx[1] - idx[0] : 1;
+      for (std::size_t i = 1; i < idx.size(); ++i)
+      {
+        if (idx[i] != _offset + (std::int32_t)i * _stride)
+        {
+          _stride = 0;
+          break;
+        }
+      }
+      if (_stride < 0)
+        _stride = 0;
+    }
+  }
+
+  /// The vector
+  std::shared_ptr<Vector<T>> vector() const { return _x; }
+
+  /// Indices of the entries of the view in the local array of the
+  /// vector
+  const std::vector<std::int32_t>& indices() const { return *_indices; }
+
+  /// Number of entries of the view
+  std::int32_t size() const { return _indices->size(); }
+
+  /// Stride between the entries in the array of the vector, or zero if
+  /// the entries are not equally spaced
+  int stride() const { return _stride; }
+
+  /// Get an entry
+  /// @param[in] i The index of the entry in the view
+  /// @return The entry
+  T operator[](std::int32_t i) const
+  {
+    const Vector<T>& x = *_x;
+    return x.array()[(*_indices)[i]];
+  }
+
+  /// Strided map of the entries, without copying. Throws an exception
+  /// if the entries are not equally spaced.
+  /// @return The entries of the view
+  Eigen::Map<const Eigen::Matrix<T, Eigen::Dynamic, 1>, 0, Eigen::InnerStride<>>
+  strided() const
+  {
+    if (_stride == 0 and !_indices->empty())
+      throw std::runtime_error("Entries of vector view are not equally "
+                               "spaced.");
+    const Vector<T>& x = *_x;
+    return {x.array().data() + _offset, size(),
+            Eigen::InnerStride<>(std::max(_stride, 1))};
+  }
+
+  /// Copy the entries of the view
+  /// @param[out] y Array of size size() to copy the entries into
+  void get(Eigen::Ref<Eigen::Matrix<T, Eigen::Dynamic, 1>> y) const
+  {
+    assert(y.size() == size());
+    if (_stride > 0)
+      y = strided();
+    else
+    {
+      const Vector<T>& x = *_x;
+      const std::vector<std::int32_t>& idx = *_indices;
+      for (std::size_t i = 0; i < idx.size(); ++i)
+        y[i] = x.array()[idx[i]];
+    }
+  }
+
+  /// Copy the entries of the view
+  /// @return The entries
+  Eigen::Matrix<T, Eigen::Dynamic, 1> array() const
+  {
+    Eigen::Matrix<T, Eigen::Dynamic, 1> y(size());
+    get(y);
+    return y;
+  }
+
+  /// Set the entries of the view. Increases the modification counter of
+  /// the vector.
+  /// @param[in] y Array of size size() with the new entries
+  void set(const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>>& y)
+  {
+    assert(y.size() == size());
+    Eigen::Matrix<T, Eigen::Dynamic, 1>& x = _x->array();
+    const std::vector<std::int32_t>& idx = *_indices;
+    for (std::size_t i = 0; i < idx.size(); ++i)
+      x[idx[i]] = y[i];
+  }
+
+private:
+  // The vector
+  std::shared_ptr<Vector<T>> _x;
+
+  // Indices of the entries in the vector
+  std::shared_ptr<const std::vector<std::int32_t>> _indices;
+
+  // Offset and stride of equally spaced indices (stride zero
+  // otherwise)
+  std::int32_t _offset = 0;
+  int _stride = 0;
 };
+
+namespace impl
+{
+/// Owned entries of a vector
+template <typename T>
+auto owned(const Vector<T>& x)
+{
+  const common::IndexMap& map = *x.map();
+  return x.array().head(map.block_size() * map.size_local());
+}
+
+/// Local contribution to a norm of the owned entries of a vector. The
+/// l2 contribution is the squared norm.
+template <typename T>
+auto local_norm(const Vector<T>& x, Norm type)
+{
+  switch (type)
+  {
+  case Norm::l1:
+    return owned(x).cwiseAbs().sum();
+  case Norm::l2:
+    return owned(x).squaredNorm();
+  case Norm::linf:
+    return owned(x).size() > 0 ? owned(x).cwiseAbs().maxCoeff()
+                               : typename Eigen::NumTraits<T>::Real(0);
+  default:
+    throw std::runtime_error("Norm type not supported for la::Vector.");
+  }
+}
+
+/// Local contributions to the inner products of pairs of vectors
+template <typename T>
+std::vector<T> local_inner_products(
+    const std::vector<std::array<const Vector<T>*, 2>>& pairs)
+{
+  std::vector<T> result(pairs.size(), 0);
+  for (std::size_t i = 0; i < pairs.size(); ++i)
+  {
+    assert(pairs[i][0] and pairs[i][1]);
+    result[i] = owned(*pairs[i][0]).dot(owned(*pairs[i][1]));
+  }
+  return result;
+}
+
+/// Local contributions to a norm of several vectors (see local_norm)
+template <typename T>
+std::vector<typename Eigen::NumTraits<T>::Real>
+local_norms(const std::vector<const Vector<T>*>& x, Norm type)
+{
+  std::vector<typename Eigen::NumTraits<T>::Real> result(x.size(), 0);
+  for (std::size_t i = 0; i < x.size(); ++i)
+  {
+    assert(x[i]);
+    result[i] = local_norm(*x[i], type);
+  }
+  return result;
+}
+} // namespace impl
+
+/// A global reduction of local values that has been started without
+/// blocking (MPI_Iallreduce), such that the latency of the reduction
+/// can be hidden behind computation, as in pipelined Krylov methods.
+/// The reduced values are available after wait. The reduction must be
+/// completed on all processes, and is completed by the destructor if
+/// wait has not been called.
+
+template <typename T>
+class Reduction
+{
+public:
+  /// Start a reduction (collective)
+  /// @param[in] comm The communicator
+  /// @param[in] values The local values
+  /// @param[in] op The reduction operation
+  /// @param[in] sqrt If true, the square roots of the reduced values
+  ///   are returned, e.g. for l2 norms
+  Reduction(MPI_Comm comm, std::vector<T>&& values, MPI_Op op,
+            bool sqrt = false)
+      : _values(std::move(values)), _sqrt(sqrt)
+  {
+    MPI_Iallreduce(MPI_IN_PLACE, _values.data(), _values.size(),
+                   dolfinx::MPI::mpi_type<T>(), op, comm, &_request);
+  }
+
+  /// Copy constructor (deleted)
+  Reduction(const Reduction& r) = delete;
+
+  /// Move constructor
+  Reduction(Reduction&& r) noexcept
+      : _values(std::move(r._values)), _request(r._request), _sqrt(r._sqrt)
+  {
+    r._request = MPI_REQUEST_NULL;
+  }
+
+  /// Destructor. Completes the reduction.
+  ~Reduction()
+  {
+    if (_request != MPI_REQUEST_NULL)
+      MPI_Wait(&_request, MPI_STATUS_IGNORE);
+  }
+
+  /// Copy assignment (deleted)
+  Reduction& operator=(const Reduction& r) = delete;
+
+  /// Move assignment (deleted)
+  Reduction& operator=(Reduction&& r) = delete;
+
+  /// Test if the reduction is complete, without blocking. Progresses
+  /// the reduction in MPI implementations without asynchronous
+  /// progress.
+  /// @return True if the reduction is complete
+  bool test()
+  {
+    if (_request == MPI_REQUEST_NULL)
+      return true;
+    int flag = 0;
+    MPI_Test(&_request, &flag, MPI_STATUS_IGNORE);
+    if (flag)
+      finalise();
+    return flag;
+  }
+
+  /// Complete the reduction
+  /// @return The reduced values
+  const std::vector<T>& wait()
+  {
+    if (_request != MPI_REQUEST_NULL)
+    {
+      MPI_Wait(&_request, MPI_STATUS_IGNORE);
+      finalise();
+    }
+    return _values;
+  }
+
+private:
+  // Post-process the reduced values
+  void finalise()
+  {
+    if (_sqrt)
+    {
+      std::transform(_values.begin(), _values.end(), _values.begin(),
+                     [](T v) { return std::sqrt(v); });
+      _sqrt = false;
+    }
+  }
+
+  // Local and, when complete, reduced values
+  std::vector<T> _values;
+
+  // The request of the reduction
+  MPI_Request _request = MPI_REQUEST_NULL;
+
+  // True if the square roots of the reduced values are returned
+  bool _sqrt;
+};
+
+/// Compute the inner products (a_i, b_i) = sum_k conj(a_i[k]) b_i[k]
+/// of several pairs of vectors over the owned entries, with a single
+/// global reduction (collective)
+/// @param[in] pairs The pairs (a_i, b_i) of vectors. The vectors must
+///   have the same layout and the same communicator.
+/// @return The inner products
+template <typename T>
+std::vector<T>
+inner_products(const std::vector<std::array<const Vector<T>*, 2>>& pairs)
+{
+  std::vector<T> result = impl::local_inner_products(pairs);
+  if (pairs.empty())
+    return result;
+
+  // The neighbourhood communicators of the index map contain all
+  // processes of the map
+  MPI_Allreduce(MPI_IN_PLACE, result.data(), result.size(),
+                dolfinx::MPI::mpi_type<T>(), MPI_SUM,
+                pairs[0][0]->map()->comm());
+  return result;
+}
+
+/// Start the computation of the inner products of several pairs of
+/// vectors (see inner_products) with a non-blocking global reduction
+/// (collective). The reduction can overlap with computation, e.g. a
+/// matrix-vector product, and is completed by Reduction::wait.
+/// @param[in] pairs The pairs (a_i, b_i) of vectors. The vectors must
+///   have the same layout and the same communicator, and there must be
+///   at least one pair.
+/// @return The pending reduction of the inner products
+template <typename T>
+Reduction<T> inner_products_begin(
+    const std::vector<std::array<const Vector<T>*, 2>>& pairs)
+{
+  assert(!pairs.empty());
+  return Reduction<T>(pairs[0][0]->map()->comm(),
+                      impl::local_inner_products(pairs), MPI_SUM);
+}
+
+/// Compute the inner product (a, b) = sum_k conj(a[k]) b[k] of two
+/// vectors over the owned entries (collective)
+/// @param[in] a A vector
+/// @param[in] b A vector with the same layout as @p a
+/// @return The inner product
+template <typename T>
+T inner_product(const Vector<T>& a, const Vector<T>& b)
+{
+  return inner_products<T>({{&a, &b}}).front();
+}
+
+/// Compute the same norm of several vectors over the owned entries,
+/// with a single global reduction (collective)
+/// @param[in] x The vectors. The vectors must have the same
+///   communicator.
+/// @param[in] type The norm type (l1, l2 or linf)
+/// @return The norms
+template <typename T>
+std::vector<typename Eigen::NumTraits<T>::Real>
+norms(const std::vector<const Vector<T>*>& x, Norm type = Norm::l2)
+{
+  using U = typename Eigen::NumTraits<T>::Real;
+  std::vector<U> result = impl::local_norms(x, type);
+  if (x.empty())
+    return result;
+
+  MPI_Allreduce(MPI_IN_PLACE, result.data(), result.size(),
+                dolfinx::MPI::mpi_type<U>(),
+                type == Norm::linf ? MPI_MAX : MPI_SUM, x[0]->map()->comm());
+  if (type == Norm::l2)
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](U r) { return std::sqrt(r); });
+  return result;
+}
+
+/// Start the computation of the same norm of several vectors (see
+/// norms) with a non-blocking global reduction (collective). The
+/// reduction is completed by Reduction::wait.
+/// @param[in] x The vectors. The vectors must have the same
+///   communicator, and there must be at least one vector.
+/// @param[in] type The norm type (l1, l2 or linf)
+/// @return The pending reduction of the norms
+template <typename T>
+Reduction<typename Eigen::NumTraits<T>::Real>
+norms_begin(const std::vector<const Vector<T>*>& x, Norm type = Norm::l2)
+{
+  assert(!x.empty());
+  return Reduction<typename Eigen::NumTraits<T>::Real>(
+      x[0]->map()->comm(), impl::local_norms(x, type),
+      type == Norm::linf ? MPI_MAX : MPI_SUM, type == Norm::l2);
+}
+
+/// Compute a norm of a vector over the owned entries (collective)
+/// @param[in] x The vector
+/// @param[in] type The norm type (l1, l2 or linf)
+/// @return The norm
+template <typename T>
+typename Eigen::NumTraits<T>::Real norm(const Vector<T>& x,
+                                        Norm type = Norm::l2)
+{
+  return norms<T>({&x}, type).front();
+}
+
+/// Compute y <- y + alpha x for all local (owned and ghost) entries.
+/// The ghost entries remain consistent if they were consistent for
+/// both vectors.
+/// @param[in,out] y The vector to update
+/// @param[in] alpha The scalar
+/// @param[in] x A vector with the same layout as @p y
+template <typename T>
+void axpy(Vector<T>& y, T alpha, const Vector<T>& x)
+{
+  assert(x.array().size() == y.array().size());
+  y.array() += alpha * x.array();
+}
+
+/// Compute x <- alpha x for all local (owned and ghost) entries
+/// @param[in,out] x The vector to scale
+/// @param[in] alpha The scalar
+template <typename T>
+void scale(Vector<T>& x, T alpha)
+{
+  x.array() *= alpha;
+}
 } // namespace dolfinx::la
@@ -0,0 +1,150 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "PETScVector.h"
+#include "Vector.h"
+#include <cassert>
+#include <cstddef>
+#include <dolfinx/common/IndexMap.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace dolfinx::la
+{
+
+/// Pool of vectors with the layout of an index map, to recycle
+/// temporary vectors (e.g. the vectors of temporary Functions in time
+/// stepping loops) instead of allocating them repeatedly.
+///
+/// A vector obtained from the pool (get) is returned to the pool when
+/// the last reference to it is released, and is handed out again by
+/// later requests for the same index map. The pool keeps at most
+/// max_size() free vectors per index map; further vectors are
+/// destroyed. Vectors may outlive the pool, in which case they are
+/// destroyed when released. The pool is thread-safe.
+///
+/// The vector type V is la::Vector<T> or la::PETScVector (a ghosted
+/// PETSc Vec).
+
+template <typename V>
+class VectorPool
+{
+public:
+  /// Create a pool
+  /// @param[in] max_size The maximum number of free vectors kept per
+  ///   index map
+  explicit VectorPool(std::size_t max_size = 8)
+      : _state(std::make_shared<State>())
+  {
+    _state->max_size = max_size;
+  }
+
+  /// Move constructor
+  VectorPool(VectorPool&& pool) = default;
+
+  /// Destructor
+  ~VectorPool() = default;
+
+  /// Move assignment
+  VectorPool& operator=(VectorPool&& pool) = default;
+
+  /// Get a vector with the layout of an index map. A recycled vector
+  /// is returned if one is available for the map, otherwise a new
+  /// vector is created. The entries of a recycled vector are not
+  /// reset.
+  /// @param[in] map The index map
+  /// @return The vector
+  std::shared_ptr<V> get(std::shared_ptr<const common::IndexMap> map)
+  {
+    assert(map);
+    std::unique_ptr<V> x;
+    {
+      std::lock_guard<std::mutex> lock(_state->mutex);
+      if (auto it = _state->free.find(map.get()); it != _state->free.end())
+      {
+        std::vector<std::unique_ptr<V>>& vectors = it->second.vectors;
+        assert(!vectors.empty());
+        x = std::move(vectors.back());
+        vectors.pop_back();
+        if (vectors.empty())
+          _state->free.erase(it);
+      }
+    }
+
+    if (!x)
+    {
+      if constexpr (std::is_same<V, PETScVector>::value)
+        x = std::make_unique<V>(*map);
+      else
+        x = std::make_unique<V>(map);
+    }
+
+    // Return the vector to the pool when the last reference is
+    // released
+    std::weak_ptr<State> state = _state;
+    return std::shared_ptr<V>(x.release(), [state, map](V* v) {
+      std::unique_ptr<V> _v(v);
+      if (std::shared_ptr<State> s = state.lock())
+      {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        Entry& entry = s->free[map.get()];
+        if (entry.vectors.size() < s->max_size)
+        {
+          entry.map = map;
+          entry.vectors.push_back(std::move(_v));
+        }
+        else if (entry.vectors.empty())
+          s->free.erase(map.get());
+      }
+    });
+  }
+
+  /// Maximum number of free vectors kept per index map
+  std::size_t max_size() const { return _state->max_size; }
+
+  /// Number of free vectors in the pool (for all index maps)
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    std::size_t n = 0;
+    for (auto& e : _state->free)
+      n += e.second.vectors.size();
+    return n;
+  }
+
+  /// Destroy the free vectors in the pool
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    _state->free.clear();
+  }
+
+private:
+  // Free vectors of an index map. The map is held to guarantee that
+  // its address is not reused while it is a key of the pool.
+  struct Entry
+  {
+    std::shared_ptr<const common::IndexMap> map;
+    std::vector<std::unique_ptr<V>> vectors;
+  };
+
+  // State shared with the deleters of the vectors handed out
+  struct State
+  {
+    std::mutex mutex;
+    std::size_t max_size;
+    std::map<const common::IndexMap*, Entry> free;
+  };
+
+  std::shared_ptr<State> _state;
+};
+
+} // namespace dolfinx::la
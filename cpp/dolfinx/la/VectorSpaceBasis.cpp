@@ -6,11 +6,64 @@
 
 #include "VectorSpaceBasis.h"
 #include "PETScVector.h"
+#include <Eigen/Dense>
 #include <cmath>
+#include <dolfinx/common/MPI.h>
 
 using namespace dolfinx;
 using namespace dolfinx::la;
 
+namespace
+{
+//-----------------------------------------------------------------------------
+// Compute the Gram matrix G_ij = (x_j, x_i) of the basis vectors x_i
+// with a single global reduction
+Eigen::Matrix<PetscScalar, Eigen::Dynamic, Eigen::Dynamic>
+gram_matrix(const std::vector<std::shared_ptr<PETScVector>>& basis)
+{
+  const int n = basis.size();
+  Eigen::Matrix<PetscScalar, Eigen::Dynamic, Eigen::Dynamic> G
+      = Eigen::Matrix<PetscScalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(n, n);
+  if (n == 0)
+    return G;
+
+  // Get the local (owned) values of the basis vectors
+  PetscInt size = 0;
+  VecGetLocalSize(basis[0]->vec(), &size);
+  std::vector<const PetscScalar*> x(n);
+  for (int i = 0; i < n; ++i)
+  {
+    assert(basis[i]);
+    VecGetArrayRead(basis[i]->vec(), &x[i]);
+  }
+
+  // Compute the local contributions to the upper triangle
+  for (int i = 0; i < n; ++i)
+  {
+    Eigen::Map<const Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>> xi(x[i],
+                                                                      size);
+    for (int j = i; j < n; ++j)
+    {
+      Eigen::Map<const Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>> xj(
+          x[j], size);
+      G(i, j) = xi.dot(xj);
+    }
+  }
+
+  for (int i = 0; i < n; ++i)
+    VecRestoreArrayRead(basis[i]->vec(), &x[i]);
+
+  MPI_Comm comm = MPI_COMM_NULL;
+  PetscObjectGetComm((PetscObject)basis[0]->vec(), &comm);
+  MPI_Allreduce(MPI_IN_PLACE, G.data(), G.size(),
+                dolfinx::MPI::mpi_type<PetscScalar>(), MPI_SUM, comm);
+  G.triangularView<Eigen::StrictlyLower>() = G.adjoint();
+
+  return G;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 //-----------------------------------------------------------------------------
 VectorSpaceBasis::VectorSpaceBasis(
     const std::vector<std::shared_ptr<PETScVector>>& basis)
@@ -19,45 +72,67 @@ VectorSpaceBasis::VectorSpaceBasis(
   // Do nothing
 }
 //-----------------------------------------------------------------------------
-void VectorSpaceBasis::orthonormalize(double tol)
+void VectorSpaceBasis::orthonormalize(double tol, bool reorthogonalize)
 {
-  // Loop over each vector in basis
-  for (std::size_t i = 0; i < _basis.size(); ++i)
+  const int n = _basis.size();
+  if (n == 0)
+    return;
+
+  PetscInt size = 0;
+  VecGetLocalSize(_basis[0]->vec(), &size);
+  const int num_passes = reorthogonalize ? 2 : 1;
+  for (int pass = 0; pass < num_passes; ++pass)
   {
-    assert(_basis[i]);
-    // Orthogonalize vector i with respect to previously orthonormalized
-    // vectors
-    for (std::size_t j = 0; j < i; ++j)
+    // Cholesky factorisation G = R^H R of the Gram matrix. The diagonal
+    // entry R_ii is the norm of the component of x_i that is orthogonal
+    // to x_0, ..., x_{i-1}.
+    const Eigen::Matrix<PetscScalar, Eigen::Dynamic, Eigen::Dynamic> G
+        = gram_matrix(_basis);
+    Eigen::LLT<Eigen::Matrix<PetscScalar, Eigen::Dynamic, Eigen::Dynamic>>
+        llt(G);
+    const Eigen::Matrix<PetscScalar, Eigen::Dynamic, Eigen::Dynamic> R
+        = llt.matrixU();
+    for (int i = 0; i < n; ++i)
     {
-      PetscScalar dot_ij = 0.0;
-      VecDot(_basis[i]->vec(), _basis[j]->vec(), &dot_ij);
-      VecAXPY(_basis[i]->vec(), -dot_ij, _basis[j]->vec());
+      if (llt.info() != Eigen::Success or std::abs(R(i, i)) < tol)
+      {
+        throw std::runtime_error(
+            "VectorSpaceBasis has linear dependency. Cannot orthogonalize.");
+      }
     }
 
-    // Normalise basis function
-    PetscReal norm = 0.0;
-    VecNormalize(_basis[i]->vec(), &norm);
-    if (norm < tol)
+    // Transform the basis, x <- x R^{-1}, row by row
+    const Eigen::Matrix<PetscScalar, Eigen::Dynamic, Eigen::Dynamic> Rinv
+        = R.triangularView<Eigen::Upper>().solve(
+            Eigen::Matrix<PetscScalar, Eigen::Dynamic, Eigen::Dynamic>::
+                Identity(n, n));
+    std::vector<PetscScalar*> x(n);
+    for (int i = 0; i < n; ++i)
+      VecGetArray(_basis[i]->vec(), &x[i]);
+    Eigen::Matrix<PetscScalar, 1, Eigen::Dynamic> row(n), row_new(n);
+    for (PetscInt k = 0; k < size; ++k)
     {
-      throw std::runtime_error(
-          "VectorSpaceBasis has linear dependency. Cannot orthogonalize.");
+      for (int i = 0; i < n; ++i)
+        row[i] = x[i][k];
+      row_new.noalias() = row * Rinv;
+      for (int i = 0; i < n; ++i)
+        x[i][k] = row_new[i];
     }
+    for (int i = 0; i < n; ++i)
+      VecRestoreArray(_basis[i]->vec(), &x[i]);
   }
 }
 //-----------------------------------------------------------------------------
 bool VectorSpaceBasis::is_orthonormal(double tol) const
 {
-  for (std::size_t i = 0; i < _basis.size(); i++)
+  const Eigen::Matrix<PetscScalar, Eigen::Dynamic, Eigen::Dynamic> G
+      = gram_matrix(_basis);
+  for (int i = 0; i < G.rows(); i++)
   {
-    for (std::size_t j = i; j < _basis.size(); j++)
+    for (int j = i; j < G.cols(); j++)
     {
-      assert(_basis[i]);
-      assert(_basis[j]);
       const double delta_ij = (i == j) ? 1.0 : 0.0;
-      PetscScalar dot_ij = 0.0;
-      VecDot(_basis[i]->vec(), _basis[j]->vec(), &dot_ij);
-
-      if (std::abs(delta_ij - dot_ij) > tol)
+      if (std::abs(delta_ij - G(i, j)) > tol)
         return false;
     }
   }
@@ -67,21 +142,12 @@ bool VectorSpaceBasis::is_orthonormal(double tol) const
 //-----------------------------------------------------------------------------
 bool VectorSpaceBasis::is_orthogonal(double tol) const
 {
-  for (std::size_t i = 0; i < _basis.size(); i++)
-  {
-    for (std::size_t j = i; j < _basis.size(); j++)
-    {
-      assert(_basis[i]);
-      assert(_basis[j]);
-      if (i != j)
-      {
-        PetscScalar dot_ij = 0.0;
-        VecDot(_basis[i]->vec(), _basis[j]->vec(), &dot_ij);
-        if (std::abs(dot_ij) > tol)
-          return false;
-      }
-    }
-  }
+  const Eigen::Matrix<PetscScalar, Eigen::Dynamic, Eigen::Dynamic> G
+      = gram_matrix(_basis);
+  for (int i = 0; i < G.rows(); i++)
+    for (int j = i + 1; j < G.cols(); j++)
+      if (std::abs(G(i, j)) > tol)
+        return false;
 
   return true;
 }
@@ -113,13 +179,23 @@ bool VectorSpaceBasis::in_nullspace(const Mat A, double tol) const
 //-----------------------------------------------------------------------------
 void VectorSpaceBasis::orthogonalize(PETScVector& x) const
 {
+  if (_basis.empty())
+    return;
+
+  std::vector<Vec> y(_basis.size());
   for (std::size_t i = 0; i < _basis.size(); i++)
   {
     assert(_basis[i]);
-    PetscScalar dot = 0.0;
-    VecDot(_basis[i]->vec(), x.vec(), &dot);
-    VecAXPY(x.vec(), -dot, _basis[i]->vec());
+    y[i] = _basis[i]->vec();
   }
+
+  // Compute (x, y_i) for all i with one reduction and subtract the
+  // projections
+  std::vector<PetscScalar> dot(y.size());
+  VecMDot(x.vec(), y.size(), y.data(), dot.data());
+  for (PetscScalar& d : dot)
+    d = -d;
+  VecMAXPY(x.vec(), y.size(), dot.data(), y.data());
 }
 //-----------------------------------------------------------------------------
 int VectorSpaceBasis::dim() const { return _basis.size(); }
@@ -33,21 +33,31 @@ public:
   /// Destructor
   ~VectorSpaceBasis() = default;
 
-  /// Apply the Gram-Schmidt process to orthonormalize the basis. Throws
-  /// an error if a (near) linear dependency is detected. Error is
-  /// thrown if <x_i, x_i> < tol.
-  void orthonormalize(double tol = 1.0e-10);
-
-  /// Test if basis is orthonormal
+  /// Orthonormalize the basis by Cholesky QR. The Gram matrix of the
+  /// basis is computed with a single global reduction, and the basis
+  /// is transformed by the inverse of its Cholesky factor, so that the
+  /// result is the same as for the Gram-Schmidt process. Throws an
+  /// error if a (near) linear dependency is detected, i.e. if the norm
+  /// of the component of x_i that is orthogonal to x_0, ..., x_{i-1}
+  /// is less than tol.
+  /// @param[in] tol Tolerance for detecting linear dependency
+  /// @param[in] reorthogonalize If true, the process is applied twice
+  ///   (CholQR2), which restores orthogonality to machine precision for
+  ///   ill-conditioned bases at the cost of a second reduction
+  void orthonormalize(double tol = 1.0e-10, bool reorthogonalize = true);
+
+  /// Test if basis is orthonormal. Uses a single global reduction.
   bool is_orthonormal(double tol = 1.0e-10) const;
 
-  /// Test if basis is orthogonal
+  /// Test if basis is orthogonal. Uses a single global reduction.
   bool is_orthogonal(double tol = 1.0e-10) const;
 
   /// Test if basis is in null space of A
   bool in_nullspace(const Mat A, double tol = 1.0e-10) const;
 
-  /// Orthogonalize x with respect to basis
+  /// Orthogonalize x with respect to an orthonormal basis. The inner
+  /// products with all basis vectors are computed with a single global
+  /// reduction (VecMDot).
   void orthogonalize(PETScVector& x) const;
 
   /// Number of vectors in the basis
@@ -11,6 +11,7 @@ namespace dolfinx
 
 // DOLFINX la interface
 
+#include <dolfinx/la/MatrixCSR.h>
 #include <dolfinx/la/PETScKrylovSolver.h>
 #include <dolfinx/la/PETScMatrix.h>
 #include <dolfinx/la/PETScOperator.h>
@@ -18,4 +19,5 @@ namespace dolfinx
 #include <dolfinx/la/PETScVector.h>
 #include <dolfinx/la/SLEPcEigenSolver.h>
 #include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/la/VectorPool.h>
 #include <dolfinx/la/VectorSpaceBasis.h>
@@ -31,6 +31,9 @@ std::shared_ptr<const common::IndexMap> Geometry::index_map() const
 //-----------------------------------------------------------------------------
 Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& Geometry::x()
 {
+  _cell_coordinates_valid = false;
+  _hash.reset();
+  ++_x_version;
   return _x;
 }
 //-----------------------------------------------------------------------------
@@ -40,6 +43,49 @@ Geometry::x() const
   return _x;
 }
 //-----------------------------------------------------------------------------
+std::uint64_t Geometry::x_version() const { return _x_version; }
+//-----------------------------------------------------------------------------
+void Geometry::set_cell_coordinates_cache(bool enable)
+{
+  _cache_cell_coordinates = enable;
+  if (!enable)
+  {
+    _cell_coordinates = common::aligned_vector<double>();
+    _cell_coordinates_valid = false;
+  }
+}
+//-----------------------------------------------------------------------------
+const common::aligned_vector<double>* Geometry::cell_coordinates() const
+{
+  if (!_cache_cell_coordinates)
+    return nullptr;
+
+  if (!_cell_coordinates_valid)
+  {
+    const std::int32_t num_cells = _dofmap.num_nodes();
+    const int num_dofs = num_cells > 0 ? _dofmap.num_links(0) : 0;
+    const std::size_t stride = cell_coordinates_stride();
+    _cell_coordinates.assign(num_cells * stride, 0.0);
+    for (std::int32_t c = 0; c < num_cells; ++c)
+    {
+      auto dofs = _dofmap.links(c);
+      double* x_c = _cell_coordinates.data() + c * stride;
+      for (int i = 0; i < num_dofs; ++i)
+        for (int j = 0; j < _dim; ++j)
+          x_c[i * _dim + j] = _x(dofs[i], j);
+    }
+    _cell_coordinates_valid = true;
+  }
+
+  return &_cell_coordinates;
+}
+//-----------------------------------------------------------------------------
+std::size_t Geometry::cell_coordinates_stride() const
+{
+  const int num_dofs = _dofmap.num_nodes() > 0 ? _dofmap.num_links(0) : 0;
+  return common::padded_size<double>(num_dofs * _dim);
+}
+//-----------------------------------------------------------------------------
 const fem::CoordinateElement& Geometry::cmap() const { return _cmap; }
 //-----------------------------------------------------------------------------
 Eigen::Vector3d Geometry::node(int n) const
@@ -49,17 +95,29 @@ Eigen::Vector3d Geometry::node(int n) const
 //-----------------------------------------------------------------------------
 const std::vector<std::int64_t>& Geometry::input_global_indices() const
 {
+  if (_input_global_indices_cleared)
+    throw std::runtime_error("Input global indices have been cleared.");
   return _input_global_indices;
 }
 //-----------------------------------------------------------------------------
+void Geometry::clear_input_global_indices()
+{
+  std::vector<std::int64_t>().swap(_input_global_indices);
+  _input_global_indices_cleared = true;
+}
+//-----------------------------------------------------------------------------
 std::size_t Geometry::hash() const
 {
-  // Compute local hash
-  boost::hash<std::vector<double>> dhash;
-
-  std::vector<double> data(_x.data(), _x.data() + _x.size());
-  const std::size_t local_hash = dhash(data);
-  return local_hash;
+  if (!_hash)
+    _hash = boost::hash_range(_x.data(), _x.data() + _x.size());
+  return *_hash;
+}
+//-----------------------------------------------------------------------------
+std::size_t Geometry::memory_usage() const
+{
+  return _dofmap.memory_usage() + _x.size() * sizeof(double)
+         + _input_global_indices.capacity() * sizeof(std::int64_t)
+         + _cell_coordinates.capacity() * sizeof(double);
 }
 //-----------------------------------------------------------------------------
 
@@ -70,6 +128,20 @@ mesh::Geometry mesh::create_geometry(
     const graph::AdjacencyList<std::int64_t>& cell_nodes,
     const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
                                         Eigen::RowMajor>>& x)
+{
+  //  Fetch node coordinates by global index from other ranks
+  return create_geometry_fetching_nodes(
+      comm, topology, coordinate_element, cell_nodes,
+      [comm, &x](const std::vector<std::int64_t>& indices) {
+        return graph::Partitioning::distribute_data<double>(comm, indices, x);
+      });
+}
+//-----------------------------------------------------------------------------
+mesh::Geometry mesh::create_geometry_fetching_nodes(
+    MPI_Comm comm, const Topology& topology,
+    const fem::CoordinateElement& coordinate_element,
+    const graph::AdjacencyList<std::int64_t>& cell_nodes,
+    const NodeFetcher& fetch_nodes)
 {
   // TODO: make sure required entities are initialised, or extend
   // fem::DofMapBuilder::build to take connectivities
@@ -86,10 +158,12 @@ mesh::Geometry mesh::create_geometry(
   std::sort(indices.begin(), indices.end());
   indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
 
-  //  Fetch node coordinates by global index from other ranks. Order of
-  //  coords matches order of the indices in 'indices'
-  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> coords
-      = graph::Partitioning::distribute_data<double>(comm, indices, x);
+  //  Fetch node coordinates by global index. Order of coords matches
+  //  order of the indices in 'indices'
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      coords = fetch_nodes(indices);
+  if (coords.rows() != (int)indices.size())
+    throw std::runtime_error("Number of fetched geometry nodes is wrong.");
 
   // Compute local-to-global map from local indices in dofmap to the
   // corresponding global indices in cell_nodes
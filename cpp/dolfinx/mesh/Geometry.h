@@ -7,10 +7,13 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <dolfinx/common/AlignedAllocator.h>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/fem/CoordinateElement.h>
 #include <dolfinx/graph/AdjacencyList.h>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -87,9 +90,16 @@ public:
   /// Index map
   std::shared_ptr<const common::IndexMap> index_map() const;
 
-  /// Geometry degrees-of-freedom
+  /// Geometry degrees-of-freedom. Invalidates the cell coordinate
+  /// cache (see cell_coordinates) and increments x_version.
   Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x();
 
+  /// Counter that is incremented on every non-const access to the
+  /// coordinates (see x). It is used to detect changes of the geometry
+  /// in caches of data computed from the coordinates.
+  /// @return The version of the coordinates
+  std::uint64_t x_version() const;
+
   /// Geometry degrees-of-freedom
   const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x() const;
 
@@ -100,14 +110,64 @@ public:
   /// Return coordinate array for node n (index is local to the process)
   Eigen::Vector3d node(int n) const;
 
-  /// Global user indices
+  /// Global user indices. Throws if the indices have been cleared (see
+  /// clear_input_global_indices).
   const std::vector<std::int64_t>& input_global_indices() const;
 
-  /// Hash of coordinate values
-  /// @return A tree-hashed value of the coordinates over all MPI
-  ///   processes
+  /// Release the storage of the global user indices, e.g. once the
+  /// input/output that requires them has been set up. Refinement and
+  /// writing of the mesh require the indices, and are not possible
+  /// after they have been cleared.
+  void clear_input_global_indices();
+
+  /// Copy of the coordinates with only dim() components per node,
+  /// optionally converted to another scalar type, e.g. a single
+  /// precision copy for visualisation or contact search
+  /// @return The coordinates (num_nodes, dim)
+  template <typename T = double>
+  Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+  compact_x() const
+  {
+    return _x.leftCols(_dim).template cast<T>();
+  }
+
+  /// Enable or disable the cache of packed cell coordinate dofs (see
+  /// cell_coordinates). The cache is disabled by default. It is useful
+  /// when the geometry is static and assembled repeatedly.
+  /// @param[in] enable True to enable the cache
+  void set_cell_coordinates_cache(bool enable);
+
+  /// Packed coordinate dofs of all cells, with only dim() components
+  /// per dof. The coordinate dofs of cell c are stored row-major
+  /// (num_dofs x dim()) from position c * cell_coordinates_stride(),
+  /// which is aligned to a cache line, and the padding after the dofs
+  /// of each cell is zero. The cache is (re)built on the first call
+  /// after it has been enabled or after the coordinates have been
+  /// accessed through the non-const x(). The call is not thread-safe
+  /// when the cache is rebuilt.
+  /// @return The packed coordinate dofs, or nullptr if the cache is
+  ///   disabled
+  const common::aligned_vector<double>* cell_coordinates() const;
+
+  /// Distance between the coordinate dofs of consecutive cells in the
+  /// cell coordinate cache (see cell_coordinates), i.e. the number of
+  /// coordinate dofs of a cell padded to a whole number of cache lines
+  /// @return The stride (number of values)
+  std::size_t cell_coordinates_stride() const;
+
+  /// Hash of the coordinate values on this process. The hash is
+  /// computed on the first call and cached until the coordinates are
+  /// accessed for modification (see x). The call is not thread-safe
+  /// when the hash is computed.
+  /// @return A hash of the coordinates
   std::size_t hash() const;
 
+  /// Memory used by the dofmap, the coordinates, the input global
+  /// indices and the cell coordinate cache. The index map is not
+  /// included.
+  /// @return Memory usage in bytes
+  std::size_t memory_usage() const;
+
 private:
   // Geometric dimension
   int _dim;
@@ -124,8 +184,22 @@ private:
   // Coordinates for all points stored as a contiguous array
   Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> _x;
 
-  // Global indices as provided on Geometry creation
+  // Global indices as provided on Geometry creation, and whether they
+  // have been cleared
   std::vector<std::int64_t> _input_global_indices;
+  bool _input_global_indices_cleared = false;
+
+  // Packed cell coordinate dofs cache, and whether it is enabled and
+  // up-to-date
+  mutable common::aligned_vector<double> _cell_coordinates;
+  bool _cache_cell_coordinates = false;
+  mutable bool _cell_coordinates_valid = false;
+
+  // Incremented on each non-const access to _x
+  std::uint64_t _x_version = 0;
+
+  // Cached hash of _x, reset on each non-const access to _x
+  mutable std::optional<std::size_t> _hash;
 };
 
 /// Build Geometry
@@ -137,5 +211,29 @@ mesh::Geometry create_geometry(
     const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
                                         Eigen::RowMajor>>& x);
 
+/// Function that returns the coordinates of geometry nodes by (sorted,
+/// unique) global input index, one row per index. It is called
+/// collectively on all processes.
+using NodeFetcher
+    = std::function<Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                 Eigen::RowMajor>(
+        const std::vector<std::int64_t>& indices)>;
+
+/// Build Geometry, with the coordinates of the nodes of the cells on
+/// this process fetched by a function, e.g. read from a file, instead
+/// of distributed from the processes that hold them
+/// @param[in] comm The MPI communicator
+/// @param[in] topology The mesh topology
+/// @param[in] coordinate_element The coordinate element
+/// @param[in] cells The cells on this process (global node indices)
+/// @param[in] fetch_nodes Function that returns the coordinates of the
+///   nodes of @p cells
+/// @return The geometry
+mesh::Geometry create_geometry_fetching_nodes(
+    MPI_Comm comm, const Topology& topology,
+    const fem::CoordinateElement& coordinate_element,
+    const graph::AdjacencyList<std::int64_t>& cells,
+    const NodeFetcher& fetch_nodes);
+
 } // namespace mesh
 } // namespace dolfinx
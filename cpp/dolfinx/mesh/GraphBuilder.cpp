@@ -6,12 +6,12 @@
 
 #include "GraphBuilder.h"
 #include <algorithm>
-#include <boost/unordered_map.hpp>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/mesh/cell_types.h>
+#include <numeric>
 #include <set>
 #include <unordered_set>
 #include <utility>
@@ -133,18 +133,44 @@ compute_local_dual_graph_keyed(
   return {std::move(local_graph), std::move(facet_cell_map), num_local_edges};
 }
 //-----------------------------------------------------------------------------
+// Maximum number of boundary facets that a process sends in one round
+// of the non-local facet matching. The facets are sent in rounds to
+// bound the size of the send and receive buffers.
+constexpr std::int64_t max_facets_per_round = 1 << 22;
+//-----------------------------------------------------------------------------
+// Hash of the sorted vertex indices of a facet (SplitMix64 mixing)
+std::uint64_t facet_hash(const std::vector<std::int32_t>& facet)
+{
+  std::uint64_t h = 0;
+  for (std::int32_t v : facet)
+  {
+    std::uint64_t z = h + static_cast<std::uint32_t>(v) + 0x9e3779b97f4a7c15;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    h = z ^ (z >> 31);
+  }
+  return h;
+}
+//-----------------------------------------------------------------------------
 // Build nonlocal part of dual graph for mesh and return number of
 // non-local edges. Note: GraphBuilder::compute_local_dual_graph should
 // be called before this function is called. Returns (ghost vertices,
 // num_nonlocal_edges)
+//
+// The facets in facet_cell_map are sent to a match-making process,
+// chosen by a hash of the facet vertices, which matches the facets
+// with equal vertices. The facets are sent in a number of rounds,
+// chosen by the hash, such that no process sends more than
+// max_facets_per_round facets in a round. The local graph and facet
+// map are released as they are consumed.
 std::tuple<std::vector<std::vector<std::int64_t>>, std::int32_t, std::int32_t>
 compute_nonlocal_dual_graph(
     const MPI_Comm mpi_comm,
     const graph::AdjacencyList<std::int64_t>& cell_vertices,
     const mesh::CellType& cell_type,
-    const std::vector<std::pair<std::vector<std::int32_t>, std::int32_t>>&
+    std::vector<std::pair<std::vector<std::int32_t>, std::int32_t>>
         facet_cell_map,
-    const std::vector<std::vector<std::int32_t>>& local_graph)
+    std::vector<std::vector<std::int32_t>> local_graph)
 {
   LOG(INFO) << "Build nonlocal part of mesh dual graph";
   common::Timer timer("Compute non-local part of mesh dual graph");
@@ -162,7 +188,9 @@ compute_nonlocal_dual_graph(
                                          local_graph[i].end());
     std::for_each(graph[i].begin(), graph[i].end(),
                   [offset](auto& n) { n += offset; });
+    std::vector<std::int32_t>().swap(local_graph[i]);
   }
+  std::vector<std::vector<std::int32_t>>().swap(local_graph);
 
   // Get number of MPI processes, and return if mesh is not distributed
   const int num_processes = dolfinx::MPI::size(mpi_comm);
@@ -177,116 +205,170 @@ compute_nonlocal_dual_graph(
   // List of cell vertices
   const int num_vertices_per_facet
       = mesh::num_cell_vertices(mesh::cell_entity_type(cell_type, tdim - 1));
+  const int stride = num_vertices_per_facet + 1;
 
-  //  assert(num_vertices_per_cell == (int)cell_vertices.cols());
-
-  // Compute local edges (cell-cell connections) using global (internal
-  // to this function, not the user numbering) numbering
-
-  // Get global range of vertex indices
-  std::int64_t num_global_vertices = 0;
-  const std::int64_t max_vertex
-      = (cell_vertices.num_nodes() > 0) ? cell_vertices.array().maxCoeff() : 0;
-  MPI_Allreduce(&max_vertex, &num_global_vertices, 1, MPI_INT64_T, MPI_SUM,
+  // Number of rounds, such that no process sends more than
+  // max_facets_per_round facets in a round
+  const std::int64_t num_facets = facet_cell_map.size();
+  std::int64_t max_num_facets = 0;
+  MPI_Allreduce(&num_facets, &max_num_facets, 1, MPI_INT64_T, MPI_MAX,
                 mpi_comm);
-  num_global_vertices += 1;
-
-  // Send facet-cell map to intermediary match-making processes
-  std::vector<std::vector<std::int64_t>> send_buffer(num_processes);
-
-  // Pack map data and send to match-maker process
-  for (const auto& it : facet_cell_map)
+  const int num_rounds
+      = std::max<std::int64_t>(1, (max_num_facets + max_facets_per_round - 1)
+                                      / max_facets_per_round);
+
+  // Sort facets by (round, match-making process), so that the facets
+  // sent in a round are contiguous
+  const std::int64_t num_buckets
+      = static_cast<std::int64_t>(num_rounds) * num_processes;
+  std::vector<std::int32_t> bucket(num_facets);
+  std::vector<std::int32_t> bucket_offsets(num_buckets + 1, 0);
+  for (std::int64_t i = 0; i < num_facets; ++i)
   {
-    // FIXME: Could use a better index? First vertex is slightly
-    //        skewed towards low values - may not be important
-
-    // Use first vertex of facet to partition into blocks
-    const int dest_proc = dolfinx::MPI::index_owner(
-        num_processes, (it.first)[0], num_global_vertices);
-
-    // Pack map into vectors to send
-    send_buffer[dest_proc].insert(send_buffer[dest_proc].end(),
-                                  it.first.begin(), it.first.end());
-
-    // Add offset to cell numbers sent off process
-    send_buffer[dest_proc].push_back(it.second + offset);
+    const std::uint64_t h = facet_hash(facet_cell_map[i].first);
+    const int dest = h % num_processes;
+    const int round = (h / num_processes) % num_rounds;
+    bucket[i] = static_cast<std::int64_t>(round) * num_processes + dest;
+    ++bucket_offsets[bucket[i] + 1];
   }
+  std::partial_sum(bucket_offsets.begin(), bucket_offsets.end(),
+                   bucket_offsets.begin());
+  std::vector<std::int32_t> order(num_facets);
+  {
+    std::vector<std::int32_t> pos(bucket_offsets.begin(),
+                                  bucket_offsets.end() - 1);
+    for (std::int64_t i = 0; i < num_facets; ++i)
+      order[pos[bucket[i]]++] = i;
+  }
+  std::vector<std::int32_t>().swap(bucket);
 
-  // Send data
-  const graph::AdjacencyList<std::int64_t> received_buffer
-      = dolfinx::MPI::all_to_all(
-          mpi_comm, graph::AdjacencyList<std::int64_t>(send_buffer));
-
-  // Clear send buffer
-  send_buffer = std::vector<std::vector<std::int64_t>>(num_processes);
-
-  // Map to connect processes and cells, using facet as key
-  typedef boost::unordered_map<std::vector<std::int64_t>,
-                               std::pair<std::int64_t, std::int64_t>>
-      MatchMap;
-  MatchMap matchmap;
-
-  // Look for matches to send back to other processes
-  std::pair<std::vector<std::int64_t>, std::pair<std::int64_t, std::int64_t>>
-      key;
-  key.first.resize(num_vertices_per_facet);
-  for (int p = 0; p < num_processes; ++p)
+  std::set<std::int64_t> ghost_nodes;
+  std::int32_t num_nonlocal_edges = 0;
+  for (int r = 0; r < num_rounds; ++r)
   {
-    // Unpack into map
-    auto data_p = received_buffer.links(p);
-    for (int i = 0; i < data_p.rows(); i += (num_vertices_per_facet + 1))
+    // Pack the facets of this round (sorted facet vertices and global
+    // cell index) and send to the match-making processes
+    const std::int32_t* round_offsets
+        = bucket_offsets.data() + static_cast<std::int64_t>(r) * num_processes;
+    Eigen::Array<std::int32_t, Eigen::Dynamic, 1> send_offsets(num_processes
+                                                               + 1);
+    for (int p = 0; p <= num_processes; ++p)
+      send_offsets[p] = stride * (round_offsets[p] - round_offsets[0]);
+    Eigen::Array<std::int64_t, Eigen::Dynamic, 1> send_data(
+        send_offsets[num_processes]);
+    for (std::int32_t i = round_offsets[0], pos = 0;
+         i < round_offsets[num_processes]; ++i)
     {
-      // Build map key
-      std::copy(data_p.data() + i, data_p.data() + i + num_vertices_per_facet,
-                key.first.begin());
-      key.second.first = p;
-      key.second.second = data_p[i + num_vertices_per_facet];
-
-      // Perform map insertion/look-up
-      std::pair<MatchMap::iterator, bool> data = matchmap.insert(key);
+      const auto& [facet, cell] = facet_cell_map[order[i]];
+      std::copy(facet.begin(), facet.end(), send_data.data() + pos);
+      send_data[pos + num_vertices_per_facet] = cell + offset;
+      pos += stride;
+    }
 
-      // If data is already in the map, extract data and remove from map
-      if (!data.second)
+    const graph::AdjacencyList<std::int64_t> received
+        = dolfinx::MPI::all_to_all(
+            mpi_comm, graph::AdjacencyList<std::int64_t>(
+                          std::move(send_data), std::move(send_offsets)));
+
+    // Sort the received facets by their vertices, and match equal
+    // facets. The facets are matched in pairs, in order of arrival.
+    const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& data
+        = received.array();
+    const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& recv_offsets
+        = received.offsets();
+    const std::int32_t num_received = data.rows() / stride;
+    std::vector<std::int32_t> perm(num_received);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::stable_sort(perm.begin(), perm.end(),
+                     [&data, stride, n = num_vertices_per_facet](
+                         std::int32_t a, std::int32_t b) {
+                       const std::int64_t* fa = data.data() + a * stride;
+                       const std::int64_t* fb = data.data() + b * stride;
+                       return std::lexicographical_compare(fa, fa + n, fb,
+                                                           fb + n);
+                     });
+
+    // Source process of received facet i
+    auto source = [&recv_offsets, stride](std::int32_t i) {
+      const std::int32_t* it
+          = std::upper_bound(recv_offsets.data(),
+                             recv_offsets.data() + recv_offsets.rows(),
+                             i * stride);
+      return std::distance(recv_offsets.data(), it) - 1;
+    };
+
+    // Matched pairs of received facets
+    std::vector<std::array<std::int32_t, 2>> matches;
+    for (std::int32_t i = 1; i < num_received; ++i)
+    {
+      const std::int64_t* f0 = data.data() + perm[i - 1] * stride;
+      const std::int64_t* f1 = data.data() + perm[i] * stride;
+      if (std::equal(f0, f0 + num_vertices_per_facet, f1))
       {
-        // Found a match of two facets - send back to owners
-        const std::size_t proc1 = data.first->second.first;
-        const std::size_t proc2 = p;
-        const std::size_t cell1 = data.first->second.second;
-        const std::size_t cell2 = key.second.second;
-        send_buffer[proc1].push_back(cell1);
-        send_buffer[proc1].push_back(cell2);
-        send_buffer[proc2].push_back(cell2);
-        send_buffer[proc2].push_back(cell1);
-
-        // Remove facet - saves memory and search time
-        matchmap.erase(data.first);
+        matches.push_back({perm[i - 1], perm[i]});
+        ++i;
+      }
+    }
+    std::vector<std::int32_t>().swap(perm);
+
+    // Send matches (local cell, connected cell) back to the processes
+    // that own the cells
+    Eigen::Array<std::int32_t, Eigen::Dynamic, 1> match_offsets
+        = Eigen::Array<std::int32_t, Eigen::Dynamic, 1>::Zero(num_processes
+                                                              + 1);
+    std::vector<std::array<std::int32_t, 2>> match_procs(matches.size());
+    for (std::size_t i = 0; i < matches.size(); ++i)
+    {
+      match_procs[i] = {(std::int32_t)source(matches[i][0]),
+                        (std::int32_t)source(matches[i][1])};
+      match_offsets[match_procs[i][0] + 1] += 2;
+      match_offsets[match_procs[i][1] + 1] += 2;
+    }
+    std::partial_sum(match_offsets.data(),
+                     match_offsets.data() + match_offsets.rows(),
+                     match_offsets.data());
+    Eigen::Array<std::int64_t, Eigen::Dynamic, 1> match_data(
+        match_offsets[num_processes]);
+    {
+      std::vector<std::int32_t> pos(match_offsets.data(),
+                                    match_offsets.data() + num_processes);
+      for (std::size_t i = 0; i < matches.size(); ++i)
+      {
+        const std::int64_t cell0
+            = data[matches[i][0] * stride + num_vertices_per_facet];
+        const std::int64_t cell1
+            = data[matches[i][1] * stride + num_vertices_per_facet];
+        std::int32_t& pos0 = pos[match_procs[i][0]];
+        match_data[pos0++] = cell0;
+        match_data[pos0++] = cell1;
+        std::int32_t& pos1 = pos[match_procs[i][1]];
+        match_data[pos1++] = cell1;
+        match_data[pos1++] = cell0;
       }
     }
-  }
-
-  // Send matches to other processes
-  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1> cell_list
-      = dolfinx::MPI::all_to_all(
-            mpi_comm, graph::AdjacencyList<std::int64_t>(send_buffer))
-            .array();
 
-  // Ghost nodes: insert connected cells into local map
-  std::set<std::int64_t> ghost_nodes;
-  std::int32_t num_nonlocal_edges = 0;
-  for (int i = 0; i < cell_list.rows(); i += 2)
-  {
-    assert((std::int64_t)cell_list[i] >= offset);
-    assert((std::int64_t)(cell_list[i] - offset)
-           < (std::int64_t)local_graph.size());
+    const Eigen::Array<std::int64_t, Eigen::Dynamic, 1> cell_list
+        = dolfinx::MPI::all_to_all(
+              mpi_comm, graph::AdjacencyList<std::int64_t>(
+                            std::move(match_data), std::move(match_offsets)))
+              .array();
 
-    auto& edges = graph[cell_list[i] - offset];
-    auto it = std::find(edges.begin(), edges.end(), cell_list[i + 1]);
-    if (it == graph[cell_list[i] - offset].end())
+    // Ghost nodes: insert connected cells into local map
+    for (int i = 0; i < cell_list.rows(); i += 2)
     {
-      edges.push_back(cell_list[i + 1]);
-      ++num_nonlocal_edges;
+      assert((std::int64_t)cell_list[i] >= offset);
+      assert((std::int64_t)(cell_list[i] - offset)
+             < (std::int64_t)graph.size());
+
+      auto& edges = graph[cell_list[i] - offset];
+      auto it = std::find(edges.begin(), edges.end(), cell_list[i + 1]);
+      if (it == edges.end())
+      {
+        edges.push_back(cell_list[i + 1]);
+        ++num_nonlocal_edges;
+      }
+      ghost_nodes.insert(cell_list[i + 1]);
     }
-    ghost_nodes.insert(cell_list[i + 1]);
   }
 
   return {std::move(graph), ghost_nodes.size(), num_nonlocal_edges};
@@ -311,7 +393,8 @@ mesh::GraphBuilder::compute_dual_graph(
   // Compute nonlocal part
   auto [graph, num_ghost_nodes, num_nonlocal_edges]
       = compute_nonlocal_dual_graph(mpi_comm, cell_vertices, cell_type,
-                                    facet_cell_map, local_graph);
+                                    std::move(facet_cell_map),
+                                    std::move(local_graph));
 
   return {std::move(graph),
           {num_ghost_nodes, num_local_edges, num_nonlocal_edges}};
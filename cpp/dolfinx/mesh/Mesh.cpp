@@ -7,6 +7,7 @@
 
 #include "Mesh.h"
 #include "Geometry.h"
+#include "GraphBuilder.h"
 #include "Partitioning.h"
 #include "Topology.h"
 #include "TopologyComputation.h"
@@ -19,10 +20,15 @@
 #include <dolfinx/fem/CoordinateElement.h>
 #include <dolfinx/fem/DofMapBuilder.h>
 #include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/graph/BoostGraphOrdering.h>
 #include <dolfinx/graph/Partitioning.h>
 #include <dolfinx/io/cells.h>
 #include <dolfinx/mesh/cell_types.h>
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <tuple>
+#include <unordered_map>
 
 using namespace dolfinx;
 using namespace dolfinx::mesh;
@@ -30,68 +36,136 @@ using namespace dolfinx::mesh;
 namespace
 {
 //-----------------------------------------------------------------------------
-Eigen::ArrayXd cell_h(const mesh::Mesh& mesh)
+Eigen::ArrayXi all_cells(const mesh::Mesh& mesh)
 {
   const int dim = mesh.topology().dim();
   auto map = mesh.topology().index_map(dim);
   assert(map);
-  const std::int32_t num_cells = map->size_local() + map->num_ghosts();
-  if (num_cells == 0)
-    throw std::runtime_error("Cannot compute h min/max. No cells.");
-
-  Eigen::ArrayXi cells(num_cells);
+  Eigen::ArrayXi cells(map->size_local() + map->num_ghosts());
   std::iota(cells.data(), cells.data() + cells.size(), 0);
-  return mesh::h(mesh, cells, dim);
+  return cells;
 }
 //-----------------------------------------------------------------------------
-Eigen::ArrayXd cell_r(const mesh::Mesh& mesh)
+// Reorder the first num_owned cells (cell-node lists and original
+// global indices) using reverse Cuthill-McKee ordering of the local
+// dual graph, such that cells that share a facet are close in memory.
+// Ghost cells are left unchanged.
+std::pair<graph::AdjacencyList<std::int64_t>, std::vector<std::int64_t>>
+reorder_owned_cells(const graph::AdjacencyList<std::int64_t>& cell_nodes,
+                    const std::vector<std::int64_t>& original_cell_index,
+                    std::int32_t num_owned,
+                    const fem::CoordinateElement& element)
 {
-  const int dim = mesh.topology().dim();
-  auto map = mesh.topology().index_map(dim);
-  assert(map);
-  const std::int32_t num_cells = map->size_local() + map->num_ghosts();
-  if (num_cells == 0)
-    throw std::runtime_error("Cannnot compute inradius min/max. No cells.");
+  common::Timer timer("Reorder owned cells for locality");
 
-  Eigen::ArrayXi cells(num_cells);
-  std::iota(cells.data(), cells.data() + cells.size(), 0);
-  return mesh::inradius(mesh, cells);
+  // Compute local dual graph of the owned cells
+  const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>& offsets
+      = cell_nodes.offsets();
+  const graph::AdjacencyList<std::int64_t> owned_cells(
+      Eigen::Array<std::int64_t, Eigen::Dynamic, 1>(
+          cell_nodes.array().head(offsets[num_owned])),
+      Eigen::Array<std::int32_t, Eigen::Dynamic, 1>(
+          offsets.head(num_owned + 1)));
+  const auto [dual_graph, facet_cell_map, num_edges]
+      = mesh::GraphBuilder::compute_local_dual_graph(
+          mesh::extract_topology(element.cell_shape(), element.dof_layout(),
+                                 owned_cells),
+          element.cell_shape());
+
+  // Compute re-ordering (map[old] -> new)
+  const std::vector<int> remap
+      = graph::BoostGraphOrdering::compute_cuthill_mckee(
+          graph::AdjacencyList<std::int32_t>(dual_graph), true);
+
+  // Inverse map (new -> old), ghost cells are unchanged
+  std::vector<std::int32_t> old_index(cell_nodes.num_nodes());
+  for (std::int32_t c = 0; c < num_owned; ++c)
+    old_index[remap[c]] = c;
+  std::iota(old_index.begin() + num_owned, old_index.end(), num_owned);
+
+  // Build re-ordered cell-node lists
+  Eigen::Array<std::int64_t, Eigen::Dynamic, 1> data(
+      cell_nodes.array().rows());
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> new_offsets(offsets.rows());
+  std::vector<std::int64_t> new_original_index(original_cell_index.size());
+  new_offsets[0] = 0;
+  for (std::size_t c = 0; c < old_index.size(); ++c)
+  {
+    auto nodes = cell_nodes.links(old_index[c]);
+    data.segment(new_offsets[c], nodes.rows()) = nodes;
+    new_offsets[c + 1] = new_offsets[c] + nodes.rows();
+    new_original_index[c] = original_cell_index[old_index[c]];
+  }
+
+  return {graph::AdjacencyList<std::int64_t>(std::move(data),
+                                             std::move(new_offsets)),
+          std::move(new_original_index)};
 }
 //-----------------------------------------------------------------------------
-} // namespace
+// Fetch the node coordinates from the processes that hold them, with
+// the nodes numbered globally in rank order
+mesh::NodeFetcher distributed_nodes(
+    MPI_Comm comm, const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                      Eigen::RowMajor>& x)
+{
+  return [comm, &x](const std::vector<std::int64_t>& indices) {
+    return graph::Partitioning::distribute_data<double>(comm, indices, x);
+  };
+}
+//-----------------------------------------------------------------------------
+// Compute the midpoints of the cells (vertex indices) on this process.
+Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+compute_midpoints(const graph::AdjacencyList<std::int64_t>& cells,
+                  const mesh::NodeFetcher& fetch_nodes)
+{
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& array = cells.array();
+  std::vector<std::int64_t> indices(array.data(), array.data() + array.rows());
+  std::sort(indices.begin(), indices.end());
+  indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      coords = fetch_nodes(indices);
 
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      midpoints = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                               Eigen::RowMajor>::Zero(cells.num_nodes(),
+                                                      coords.cols());
+  for (int c = 0; c < cells.num_nodes(); ++c)
+  {
+    auto vertices = cells.links(c);
+    for (int i = 0; i < vertices.rows(); ++i)
+    {
+      const auto it
+          = std::lower_bound(indices.begin(), indices.end(), vertices[i]);
+      midpoints.row(c) += coords.row(std::distance(indices.begin(), it));
+    }
+    midpoints.row(c) /= vertices.rows();
+  }
+
+  return midpoints;
+}
 //-----------------------------------------------------------------------------
-Mesh mesh::create_mesh(MPI_Comm comm,
-                       const graph::AdjacencyList<std::int64_t>& cells,
-                       const fem::CoordinateElement& element,
-                       const Eigen::Array<double, Eigen::Dynamic,
-                                          Eigen::Dynamic, Eigen::RowMajor>& x,
-                       mesh::GhostMode ghost_mode)
+// Create a mesh from the cells of each process, the owned cells
+// followed by the ghost cells (ghosting via facets). Also returns the
+// original index of each cell of the mesh.
+std::pair<Mesh, std::vector<std::int64_t>>
+create_mesh_local(MPI_Comm comm, graph::AdjacencyList<std::int64_t> cell_nodes,
+                  std::vector<std::int64_t> original_cell_index,
+                  const std::vector<int>& ghost_owners,
+                  const fem::CoordinateElement& element,
+                  const mesh::NodeFetcher& fetch_nodes,
+                  mesh::GhostMode ghost_mode, bool reorder_cells)
 {
   if (ghost_mode == mesh::GhostMode::shared_vertex)
     throw std::runtime_error("Ghost mode via vertex currently disabled.");
 
-  // TODO: This step can be skipped for 'P1' elements
-  //
-  // Extract topology data, e.g. just the vertices. For P1 geometry this
-  // should just be the identity operator. For other elements the
-  // filtered lists may have 'gaps', i.e. the indices might not be
-  // contiguous.
-  const graph::AdjacencyList<std::int64_t> cells_topology
-      = mesh::extract_topology(element.cell_shape(), element.dof_layout(),
-                               cells);
-
-  // Compute the destination rank for cells on this process via graph
-  // partitioning. Always get the ghost cells via facet, though these may be
-  // discarded later.
-  const int size = dolfinx::MPI::size(comm);
-  const graph::AdjacencyList<std::int32_t> dest
-      = Partitioning::partition_cells(comm, size, element.cell_shape(),
-                                      cells_topology, GhostMode::shared_facet);
-
-  // Distribute cells to destination rank
-  const auto [cell_nodes, src, original_cell_index, ghost_owners]
-      = graph::Partitioning::distribute(comm, cells, dest);
+  // Re-order owned cells for locality. The geometry nodes and dofmaps
+  // built on the topology are re-ordered separately by DofMapBuilder.
+  if (reorder_cells)
+  {
+    const std::int32_t num_owned = cell_nodes.num_nodes() - ghost_owners.size();
+    std::tie(cell_nodes, original_cell_index) = reorder_owned_cells(
+        cell_nodes, original_cell_index, num_owned, element);
+  }
 
   // Create cells and vertices with the ghosting requested. Input topology
   // includes cells shared via facet, but output will remove these, if not
@@ -130,10 +204,509 @@ Mesh mesh::create_mesh(MPI_Comm comm,
       = cell_nodes.array().head(off1[n_cells_local]);
   graph::AdjacencyList<std::int64_t> cell_nodes_2(data1, off1);
 
-  Geometry geometry
-      = mesh::create_geometry(comm, topology, element, cell_nodes_2, x);
+  Geometry geometry = mesh::create_geometry_fetching_nodes(
+      comm, topology, element, cell_nodes_2, fetch_nodes);
+
+  original_cell_index.resize(n_cells_local);
+  return {Mesh(comm, std::move(topology), std::move(geometry)),
+          std::move(original_cell_index)};
+}
+//-----------------------------------------------------------------------------
+// Create a mesh with the cells distributed to the given destinations.
+// Also returns, for each cell of the mesh, its index in the input cell
+// list, with the cells numbered globally in rank order.
+std::pair<Mesh, std::vector<std::int64_t>> create_mesh_distributed(
+    MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+    const fem::CoordinateElement& element,
+    const mesh::NodeFetcher& fetch_nodes, mesh::GhostMode ghost_mode,
+    bool reorder_cells, const graph::AdjacencyList<std::int32_t>& dest)
+{
+  common::Timer timer("Create distributed mesh");
+  if (dest.num_nodes() != cells.num_nodes())
+    throw std::runtime_error("Number of cell destinations and cells differ.");
+
+  // Distribute cells to destination rank
+  auto [cell_nodes, src, original_cell_index, ghost_owners]
+      = graph::Partitioning::distribute(comm, cells, dest);
+  return create_mesh_local(comm, std::move(cell_nodes),
+                           std::move(original_cell_index), ghost_owners,
+                           element, fetch_nodes, ghost_mode, reorder_cells);
+}
+//-----------------------------------------------------------------------------
+// Compute the destination processes of the cells, see
+// mesh::compute_cell_destinations
+graph::AdjacencyList<std::int32_t>
+cell_destinations(MPI_Comm comm,
+                  const graph::AdjacencyList<std::int64_t>& cells,
+                  const fem::CoordinateElement& element,
+                  const mesh::NodeFetcher& fetch_nodes,
+                  mesh::CellPartitioner partitioner,
+                  const std::vector<std::int32_t>& weights,
+                  int num_ghost_layers = 1)
+{
+  // TODO: This step can be skipped for 'P1' elements
+  //
+  // Extract topology data, e.g. just the vertices. For P1 geometry this
+  // should just be the identity operator. For other elements the
+  // filtered lists may have 'gaps', i.e. the indices might not be
+  // contiguous.
+  const graph::AdjacencyList<std::int64_t> cells_topology
+      = mesh::extract_topology(element.cell_shape(), element.dof_layout(),
+                               cells);
+
+  // Compute the destination rank for cells on this process via graph
+  // or geometric partitioning. Always get the ghost cells via facet,
+  // though these may be discarded later.
+  // Further layers of ghost cells are added to the ghost cells via
+  // facet.
+  const int size = dolfinx::MPI::size(comm);
+  graph::AdjacencyList<std::int32_t> dest(0);
+  switch (partitioner)
+  {
+  case CellPartitioner::hilbert:
+    dest = Partitioning::partition_cells_hilbert(
+        comm, size, element.cell_shape(), cells_topology,
+        compute_midpoints(cells_topology, fetch_nodes),
+        GhostMode::shared_facet, weights);
+    break;
+  case CellPartitioner::hierarchical:
+    dest = Partitioning::partition_cells_hierarchical(
+        comm, element.cell_shape(), cells_topology, GhostMode::shared_facet,
+        weights);
+    break;
+  default:
+    dest = Partitioning::partition_cells(comm, size, element.cell_shape(),
+                                         cells_topology,
+                                         GhostMode::shared_facet, weights);
+  }
+
+  if (num_ghost_layers != 1)
+  {
+    return Partitioning::compute_ghost_layers(
+        comm, element.cell_shape(), cells_topology, dest, num_ghost_layers);
+  }
+  return dest;
+}
+//-----------------------------------------------------------------------------
+// Send a list of values to each rank of a map (rank, values), and
+// return the ranks that sent values to this rank and their values
+std::pair<std::vector<int>, graph::AdjacencyList<std::int64_t>>
+exchange_values(MPI_Comm comm,
+                const std::map<int, std::vector<std::int64_t>>& values)
+{
+  std::vector<int> dests;
+  std::vector<std::vector<std::int64_t>> send_data;
+  for (const auto& [p, v] : values)
+  {
+    dests.push_back(p);
+    send_data.push_back(v);
+  }
+  return dolfinx::MPI::sparse_exchange(
+      comm, dests, graph::AdjacencyList<std::int64_t>(send_data));
+}
+//-----------------------------------------------------------------------------
+// Create the index map of a subset of the (owned and ghost) indices of
+// an index map (block size 1). An index is owned by its owner in the
+// map if the owner has it in its subset, and otherwise by the lowest
+// rank that has it in its subset. Also returns the index in the map of
+// each (owned and ghost) index of the new map.
+std::pair<std::shared_ptr<common::IndexMap>, std::vector<std::int32_t>>
+create_sub_index_map(MPI_Comm comm, const common::IndexMap& map,
+                     const std::vector<std::int32_t>& indices)
+{
+  assert(map.block_size() == 1);
+  const std::int32_t size_local = map.size_local();
+  const std::int64_t offset = map.local_range()[0];
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& ghosts = map.ghosts();
+  const Eigen::Array<int, Eigen::Dynamic, 1> ghost_owners
+      = map.ghost_owner_rank();
+  std::unordered_map<std::int64_t, std::int32_t> global_to_ghost;
+  for (Eigen::Index i = 0; i < ghosts.size(); ++i)
+    global_to_ghost.insert({ghosts[i], size_local + i});
+
+  // Send the ghost indices of the subset to their owners, which
+  // receive the other ranks that have each owned index in their subset
+  std::vector<bool> in_subset(size_local + ghosts.size(), false);
+  std::map<int, std::vector<std::int64_t>> ghost_indices;
+  for (std::int32_t i : indices)
+  {
+    in_subset[i] = true;
+    if (i >= size_local)
+    {
+      ghost_indices[ghost_owners[i - size_local]].push_back(
+          ghosts[i - size_local]);
+    }
+  }
+  std::map<std::int32_t, std::vector<int>> users;
+  {
+    const auto [src, recv] = exchange_values(comm, ghost_indices);
+    for (std::size_t k = 0; k < src.size(); ++k)
+    {
+      for (std::int64_t g : recv.links(k))
+        users[g - offset].push_back(src[k]);
+    }
+  }
+
+  // Owned indices of the new map, and the other ranks that have them.
+  // The indices that are not in the subset of their owner are sent to
+  // their new owner as (index, number of other ranks, other ranks).
+  std::vector<std::int32_t> owned;
+  std::map<std::int32_t, std::vector<int>> owned_users;
+  std::map<int, std::vector<std::int64_t>> moved;
+  for (std::int32_t i = 0; i < size_local; ++i)
+  {
+    if (in_subset[i])
+      owned.push_back(i);
+  }
+  for (auto& [i, u] : users)
+  {
+    if (in_subset[i])
+      owned_users[i] = std::move(u);
+    else
+    {
+      std::vector<std::int64_t>& b = moved[u[0]];
+      b.insert(b.end(), {i + offset, std::int64_t(u.size() - 1)});
+      b.insert(b.end(), u.begin() + 1, u.end());
+    }
+  }
+  {
+    const auto [src, recv] = exchange_values(comm, moved);
+    const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& data = recv.array();
+    for (Eigen::Index j = 0; j < data.size(); j += 2 + data[j + 1])
+    {
+      const std::int32_t i = global_to_ghost.at(data[j]);
+      owned.push_back(i);
+      owned_users[i] = std::vector<int>(data.data() + j + 2,
+                                        data.data() + j + 2 + data[j + 1]);
+    }
+  }
+  std::sort(owned.begin(), owned.end());
+
+  // Send the new global indices of the owned indices to the ranks that
+  // ghost them, as (index in the map, new index)
+  const std::int64_t new_offset
+      = dolfinx::MPI::global_offset(comm, owned.size(), true);
+  std::map<int, std::vector<std::int64_t>> new_indices;
+  for (std::size_t k = 0; k < owned.size(); ++k)
+  {
+    if (auto it = owned_users.find(owned[k]); it != owned_users.end())
+    {
+      const std::int64_t g = owned[k] < size_local
+                                 ? owned[k] + offset
+                                 : ghosts[owned[k] - size_local];
+      for (int p : it->second)
+        new_indices[p].insert(new_indices[p].end(),
+                              {g, new_offset + std::int64_t(k)});
+    }
+  }
+  std::vector<int> dest_ranks;
+  for (const auto& q : new_indices)
+    dest_ranks.push_back(q.first);
+
+  // Ghost indices of the new map, as (index in the map, new global
+  // index, owner), ordered as in the map
+  std::vector<std::tuple<std::int32_t, std::int64_t, int>> new_ghosts;
+  {
+    const auto [src, recv] = exchange_values(comm, new_indices);
+    for (std::size_t k = 0; k < src.size(); ++k)
+    {
+      auto data = recv.links(k);
+      for (Eigen::Index j = 0; j < data.size(); j += 2)
+        new_ghosts.emplace_back(global_to_ghost.at(data[j]), data[j + 1],
+                                src[k]);
+    }
+  }
+  std::sort(new_ghosts.begin(), new_ghosts.end());
+
+  std::vector<std::int32_t> sub_to_map = owned;
+  std::vector<std::int64_t> new_ghost_indices;
+  std::vector<int> new_ghost_owners;
+  for (const auto& [i, g, p] : new_ghosts)
+  {
+    sub_to_map.push_back(i);
+    new_ghost_indices.push_back(g);
+    new_ghost_owners.push_back(p);
+  }
+
+  return {std::make_shared<common::IndexMap>(comm, owned.size(), dest_ranks,
+                                             new_ghost_indices,
+                                             new_ghost_owners, 1),
+          std::move(sub_to_map)};
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+Mesh mesh::create_mesh(MPI_Comm comm,
+                       const graph::AdjacencyList<std::int64_t>& cells,
+                       const fem::CoordinateElement& element,
+                       const Eigen::Array<double, Eigen::Dynamic,
+                                          Eigen::Dynamic, Eigen::RowMajor>& x,
+                       mesh::GhostMode ghost_mode, bool reorder_cells,
+                       mesh::CellPartitioner partitioner)
+{
+  const NodeFetcher fetch_nodes = distributed_nodes(comm, x);
+  const graph::AdjacencyList<std::int32_t> dest
+      = cell_destinations(comm, cells, element, fetch_nodes, partitioner, {});
+  return create_mesh_distributed(comm, cells, element, fetch_nodes,
+                                 ghost_mode, reorder_cells, dest)
+      .first;
+}
+//-----------------------------------------------------------------------------
+Mesh mesh::create_mesh(MPI_Comm comm,
+                       const graph::AdjacencyList<std::int64_t>& cells,
+                       const fem::CoordinateElement& element,
+                       const Eigen::Array<double, Eigen::Dynamic,
+                                          Eigen::Dynamic, Eigen::RowMajor>& x,
+                       mesh::GhostMode ghost_mode,
+                       const graph::AdjacencyList<std::int32_t>& dest,
+                       bool reorder_cells)
+{
+  return create_mesh_distributed(comm, cells, element,
+                                 distributed_nodes(comm, x), ghost_mode,
+                                 reorder_cells, dest)
+      .first;
+}
+//-----------------------------------------------------------------------------
+Mesh mesh::create_mesh_fetching_nodes(
+    MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+    const fem::CoordinateElement& element, const NodeFetcher& fetch_nodes,
+    mesh::GhostMode ghost_mode, mesh::CellPartitioner partitioner)
+{
+  const graph::AdjacencyList<std::int32_t> dest
+      = cell_destinations(comm, cells, element, fetch_nodes, partitioner, {});
+  return create_mesh_distributed(comm, cells, element, fetch_nodes,
+                                 ghost_mode, false, dest)
+      .first;
+}
+//-----------------------------------------------------------------------------
+Mesh mesh::create_mesh_fetching_nodes(
+    MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+    const fem::CoordinateElement& element, const NodeFetcher& fetch_nodes,
+    mesh::GhostMode ghost_mode, const graph::AdjacencyList<std::int32_t>& dest)
+{
+  return create_mesh_distributed(comm, cells, element, fetch_nodes,
+                                 ghost_mode, false, dest)
+      .first;
+}
+//-----------------------------------------------------------------------------
+Mesh mesh::create_mesh_with_ghosts(
+    MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+    const std::vector<std::int64_t>& original_cell_index,
+    const std::vector<int>& ghost_owners,
+    const fem::CoordinateElement& element, const NodeFetcher& fetch_nodes,
+    mesh::GhostMode ghost_mode)
+{
+  common::Timer timer("Create distributed mesh");
+  if ((std::size_t)cells.num_nodes() != original_cell_index.size()
+      or ghost_owners.size() > original_cell_index.size())
+  {
+    throw std::runtime_error(
+        "Number of cells, original cell indices and ghost owners differ.");
+  }
+
+  return create_mesh_local(comm, cells, original_cell_index, ghost_owners,
+                           element, fetch_nodes, ghost_mode, false)
+      .first;
+}
+//-----------------------------------------------------------------------------
+std::pair<Mesh, std::vector<std::int64_t>>
+mesh::create_mesh_with_original_index(
+    MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+    const fem::CoordinateElement& element,
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>& x,
+    mesh::GhostMode ghost_mode, mesh::CellPartitioner partitioner)
+{
+  const NodeFetcher fetch_nodes = distributed_nodes(comm, x);
+  const graph::AdjacencyList<std::int32_t> dest
+      = cell_destinations(comm, cells, element, fetch_nodes, partitioner, {});
+  return create_mesh_distributed(comm, cells, element, fetch_nodes,
+                                 ghost_mode, false, dest);
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> mesh::compute_cell_destinations(
+    MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+    const fem::CoordinateElement& element,
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>& x,
+    mesh::CellPartitioner partitioner,
+    const std::vector<std::int32_t>& weights, int num_ghost_layers)
+{
+  return cell_destinations(comm, cells, element, distributed_nodes(comm, x),
+                           partitioner, weights, num_ghost_layers);
+}
+//-----------------------------------------------------------------------------
+std::pair<Mesh, std::vector<std::int64_t>>
+mesh::rebalance(const Mesh& mesh, const std::vector<std::int32_t>& weights,
+                mesh::GhostMode ghost_mode, mesh::CellPartitioner partitioner)
+{
+  common::Timer timer("Rebalance mesh");
+
+  const Topology& topology = mesh.topology();
+  const Geometry& geometry = mesh.geometry();
+  const int tdim = topology.dim();
+  const std::int32_t num_cells = topology.index_map(tdim)->size_local();
+  if (!weights.empty() and (std::int32_t)weights.size() != num_cells)
+    throw std::runtime_error("Number of cell weights and owned cells differ.");
+
+  // Owned cells, with the geometry nodes by global index
+  std::shared_ptr<const common::IndexMap> map_x = geometry.index_map();
+  assert(map_x);
+  assert(map_x->block_size() == 1);
+  const std::vector<std::int64_t> global_nodes = map_x->global_indices(false);
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+  const std::int32_t num_links = x_dofmap.offsets()[num_cells];
+  Eigen::Array<std::int64_t, Eigen::Dynamic, 1> cell_nodes(num_links);
+  for (std::int32_t i = 0; i < num_links; ++i)
+    cell_nodes[i] = global_nodes[x_dofmap.array()[i]];
+  const graph::AdjacencyList<std::int64_t> cells(
+      std::move(cell_nodes), Eigen::Array<std::int32_t, Eigen::Dynamic, 1>(
+                                 x_dofmap.offsets().head(num_cells + 1)));
 
-  return Mesh(comm, std::move(topology), std::move(geometry));
+  // Owned nodes, which have global indices in rank order
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      x = geometry.x().topLeftCorner(map_x->size_local(), geometry.dim());
+
+  const graph::AdjacencyList<std::int32_t> dest = compute_cell_destinations(
+      mesh.mpi_comm(), cells, geometry.cmap(), x, partitioner, weights);
+  return create_mesh_distributed(mesh.mpi_comm(), cells, geometry.cmap(),
+                                 distributed_nodes(mesh.mpi_comm(), x),
+                                 ghost_mode, false, dest);
+}
+//-----------------------------------------------------------------------------
+std::tuple<Mesh, std::vector<std::int32_t>, std::vector<std::int32_t>,
+           std::vector<std::int32_t>>
+mesh::create_submesh(const Mesh& mesh, int dim,
+                     const std::vector<std::int32_t>& entities,
+                     const fem::CoordinateElement& element)
+{
+  common::Timer timer("Create submesh");
+
+  const Topology& topology = mesh.topology();
+  const Geometry& geometry = mesh.geometry();
+  const int tdim = topology.dim();
+  if (dim < 1 or dim > tdim)
+  {
+    throw std::runtime_error(
+        "Submesh dimension must be between 1 and the topological dimension.");
+  }
+  const mesh::CellType cell_type
+      = mesh::cell_entity_type(topology.cell_type(), dim);
+  if (element.cell_shape() != cell_type)
+    throw std::runtime_error("Coordinate element and submesh cells differ.");
+  const int num_cell_nodes = element.dof_layout().num_dofs();
+  if (dim < tdim
+      and (geometry.cmap().dof_layout().num_dofs()
+               != mesh::num_cell_vertices(topology.cell_type())
+           or num_cell_nodes != mesh::num_cell_vertices(cell_type)))
+  {
+    throw std::runtime_error("Submeshes of lower dimension require a first "
+                             "order geometry.");
+  }
+  if (dim == tdim and num_cell_nodes != geometry.dofmap().num_links(0))
+    throw std::runtime_error("Coordinate element and mesh geometry differ.");
+
+  MPI_Comm comm = mesh.mpi_comm();
+  mesh.topology_mutable().create_entities(dim);
+  mesh.topology_mutable().create_connectivity(dim, 0);
+
+  // Cells of the submesh
+  std::vector<std::int32_t> subset = entities;
+  std::sort(subset.begin(), subset.end());
+  subset.erase(std::unique(subset.begin(), subset.end()), subset.end());
+  auto [cell_map, entity_map]
+      = create_sub_index_map(comm, *topology.index_map(dim), subset);
+
+  // Vertices of the submesh
+  std::shared_ptr<const graph::AdjacencyList<std::int32_t>> e_to_v
+      = topology.connectivity(dim, 0);
+  assert(e_to_v);
+  subset.clear();
+  for (std::int32_t e : entity_map)
+  {
+    auto v = e_to_v->links(e);
+    subset.insert(subset.end(), v.data(), v.data() + v.size());
+  }
+  std::sort(subset.begin(), subset.end());
+  subset.erase(std::unique(subset.begin(), subset.end()), subset.end());
+  auto [vertex_index_map, vertex_map]
+      = create_sub_index_map(comm, *topology.index_map(0), subset);
+
+  // Cell-vertex connectivity, with the vertices of a cell in the order
+  // of the entity vertices of the mesh
+  auto map_v = topology.index_map(0);
+  std::vector<std::int32_t> vertex_to_sub(
+      map_v->size_local() + map_v->num_ghosts(), -1);
+  for (std::size_t i = 0; i < vertex_map.size(); ++i)
+    vertex_to_sub[vertex_map[i]] = i;
+  const int num_cell_vertices = mesh::num_cell_vertices(cell_type);
+  Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      cells(entity_map.size(), num_cell_vertices);
+  for (std::size_t i = 0; i < entity_map.size(); ++i)
+  {
+    auto v = e_to_v->links(entity_map[i]);
+    for (int j = 0; j < num_cell_vertices; ++j)
+      cells(i, j) = vertex_to_sub[v[j]];
+  }
+
+  Topology sub_topology(comm, cell_type);
+  sub_topology.set_index_map(0, vertex_index_map);
+  sub_topology.set_connectivity(
+      std::make_shared<graph::AdjacencyList<std::int32_t>>(vertex_map.size()),
+      0, 0);
+  sub_topology.set_index_map(dim, cell_map);
+  sub_topology.set_connectivity(
+      std::make_shared<graph::AdjacencyList<std::int32_t>>(cells), dim, 0);
+
+  // Geometry nodes of the cells of the submesh
+  Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      cell_nodes(entity_map.size(), num_cell_nodes);
+  if (dim == tdim)
+  {
+    const graph::AdjacencyList<std::int32_t>& x_dofmap = geometry.dofmap();
+    for (std::size_t i = 0; i < entity_map.size(); ++i)
+      cell_nodes.row(i) = x_dofmap.links(entity_map[i]).transpose();
+  }
+  else
+  {
+    const Eigen::Array<std::int32_t, Eigen::Dynamic, 1> entity_list
+        = Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>(
+            entity_map.data(), entity_map.size());
+    cell_nodes = mesh::entities_to_geometry(mesh, dim, entity_list, false);
+  }
+
+  // Geometry of the submesh
+  subset.assign(cell_nodes.data(), cell_nodes.data() + cell_nodes.size());
+  std::sort(subset.begin(), subset.end());
+  subset.erase(std::unique(subset.begin(), subset.end()), subset.end());
+  std::shared_ptr<const common::IndexMap> map_x = geometry.index_map();
+  assert(map_x);
+  auto [x_index_map, node_map] = create_sub_index_map(comm, *map_x, subset);
+
+  std::vector<std::int32_t> node_to_sub(
+      map_x->size_local() + map_x->num_ghosts(), -1);
+  for (std::size_t i = 0; i < node_map.size(); ++i)
+    node_to_sub[node_map[i]] = i;
+  for (Eigen::Index i = 0; i < cell_nodes.size(); ++i)
+    cell_nodes.data()[i] = node_to_sub[cell_nodes.data()[i]];
+
+  const int gdim = geometry.dim();
+  const std::vector<std::int64_t> global_nodes = map_x->global_indices(false);
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> x(
+      node_map.size(), gdim);
+  std::vector<std::int64_t> input_global_indices(node_map.size());
+  for (std::size_t i = 0; i < node_map.size(); ++i)
+  {
+    x.row(i) = geometry.x().row(node_map[i]).head(gdim);
+    input_global_indices[i] = global_nodes[node_map[i]];
+  }
+  Geometry sub_geometry(x_index_map,
+                        graph::AdjacencyList<std::int32_t>(cell_nodes),
+                        element, x, std::move(input_global_indices));
+
+  return {Mesh(comm, std::move(sub_topology), std::move(sub_geometry)),
+          std::move(entity_map), std::move(vertex_map), std::move(node_map)};
 }
 //-----------------------------------------------------------------------------
 
@@ -148,26 +721,84 @@ Geometry& Mesh::geometry() { return _geometry; }
 //-----------------------------------------------------------------------------
 const Geometry& Mesh::geometry() const { return _geometry; }
 //-----------------------------------------------------------------------------
-double Mesh::hmin() const { return cell_h(*this).minCoeff(); }
+double Mesh::hmin() const
+{
+  std::shared_ptr<const Eigen::ArrayXd> h = cell_sizes();
+  if (h->size() == 0)
+    throw std::runtime_error("Cannot compute h min/max. No cells.");
+  return h->minCoeff();
+}
+//-----------------------------------------------------------------------------
+double Mesh::hmax() const
+{
+  std::shared_ptr<const Eigen::ArrayXd> h = cell_sizes();
+  if (h->size() == 0)
+    throw std::runtime_error("Cannot compute h min/max. No cells.");
+  return h->maxCoeff();
+}
+//-----------------------------------------------------------------------------
+double Mesh::rmin() const
+{
+  std::shared_ptr<const Eigen::ArrayXd> r = cell_inradii();
+  if (r->size() == 0)
+    throw std::runtime_error("Cannot compute inradius min/max. No cells.");
+  return r->minCoeff();
+}
 //-----------------------------------------------------------------------------
-double Mesh::hmax() const { return cell_h(*this).maxCoeff(); }
+double Mesh::rmax() const
+{
+  std::shared_ptr<const Eigen::ArrayXd> r = cell_inradii();
+  if (r->size() == 0)
+    throw std::runtime_error("Cannot compute inradius min/max. No cells.");
+  return r->maxCoeff();
+}
 //-----------------------------------------------------------------------------
-double Mesh::rmin() const { return cell_r(*this).minCoeff(); }
+std::shared_ptr<const Eigen::ArrayXd> Mesh::cell_sizes() const
+{
+  if (!_cell_sizes or _cell_sizes_version != _geometry.x_version())
+  {
+    _cell_sizes = std::make_shared<const Eigen::ArrayXd>(
+        mesh::h(*this, all_cells(*this), _topology.dim()));
+    _cell_sizes_version = _geometry.x_version();
+  }
+  return _cell_sizes;
+}
 //-----------------------------------------------------------------------------
-double Mesh::rmax() const { return cell_r(*this).maxCoeff(); }
+std::shared_ptr<const Eigen::ArrayXd> Mesh::cell_inradii() const
+{
+  if (!_cell_inradii or _cell_inradii_version != _geometry.x_version())
+  {
+    _cell_inradii = std::make_shared<const Eigen::ArrayXd>(
+        mesh::inradius(*this, all_cells(*this)));
+    _cell_inradii_version = _geometry.x_version();
+  }
+  return _cell_inradii;
+}
 //-----------------------------------------------------------------------------
 std::size_t Mesh::hash() const
 {
-  // Get local hashes
+  // Get local hashes (cached)
   const std::size_t kt_local = _topology.hash();
   const std::size_t kg_local = _geometry.hash();
 
+  // The cached global hash is valid if the local hashes are unchanged
+  // on all processes
+  const int changed_local
+      = !_hash or (*_hash)[0] != kt_local or (*_hash)[1] != kg_local;
+  int changed = 0;
+  MPI_Allreduce(&changed_local, &changed, 1, MPI_INT, MPI_LOR,
+                _mpi_comm.comm());
+  if (!changed)
+    return (*_hash)[2];
+
   // Compute global hash
   const std::size_t kt = common::hash_global(_mpi_comm.comm(), kt_local);
   const std::size_t kg = common::hash_global(_mpi_comm.comm(), kg_local);
 
   // Compute hash based on the Cantor pairing function
-  return (kt + kg) * (kt + kg + 1) / 2 + kg;
+  const std::size_t k = (kt + kg) * (kt + kg + 1) / 2 + kg;
+  _hash = {kt_local, kg_local, k};
+  return k;
 }
 //-----------------------------------------------------------------------------
 MPI_Comm Mesh::mpi_comm() const { return _mpi_comm.comm(); }
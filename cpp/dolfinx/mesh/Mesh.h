@@ -12,8 +12,13 @@
 #include <Eigen/Dense>
 #include <dolfinx/common/MPI.h>
 #include <dolfinx/common/UniqueIdGenerator.h>
+#include <array>
+#include <memory>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 namespace dolfinx
 {
@@ -40,6 +45,18 @@ enum class GhostMode : int
   shared_vertex
 };
 
+/// Enum for the partitioner used to distribute the cells of a mesh:
+/// graph partitioning (SCOTCH) of the dual graph, a Hilbert
+/// space-filling curve through the cell midpoints, or two-level graph
+/// partitioning across the shared memory nodes and then across the
+/// ranks of each node
+enum class CellPartitioner : int
+{
+  graph,
+  hilbert,
+  hierarchical
+};
+
 /// A Mesh consists of a set of connected and numbered mesh topological
 /// entities, and geometry data
 
@@ -119,8 +136,27 @@ public:
   /// @return The maximum of cells' inscribed sphere radii
   double rmax() const;
 
-  /// Compute hash of mesh, currently based on the has of the mesh
-  /// geometry and mesh topology
+  /// Size (see mesh::h) of all cells on this process, including ghost
+  /// cells. The sizes are computed on first call and cached until the
+  /// coordinates are accessed for modification (see
+  /// Geometry::x_version). Modifications through a reference to the
+  /// coordinates obtained before the sizes were computed are not
+  /// detected.
+  /// @return The cell sizes
+  std::shared_ptr<const Eigen::ArrayXd> cell_sizes() const;
+
+  /// Inradius (see mesh::inradius) of all cells on this process,
+  /// including ghost cells. The inradii are cached in the same way as
+  /// the cell sizes (see cell_sizes).
+  /// @return The cell inradii
+  std::shared_ptr<const Eigen::ArrayXd> cell_inradii() const;
+
+  /// Compute hash of mesh, currently based on the hash of the mesh
+  /// geometry and mesh topology (collective). The hashes of the
+  /// topology and geometry on each process are cached (see
+  /// Topology::hash and Geometry::hash), and the global hash is cached
+  /// until the topology or geometry changes on any process, such that a
+  /// call for an unchanged mesh costs one reduction of a flag.
   /// @return A tree-hashed value of the coordinates over all MPI
   ///         processes
   std::size_t hash() const;
@@ -152,14 +188,220 @@ private:
 
   // Unique identifier
   std::size_t _unique_id = common::UniqueIdGenerator::id();
+
+  // Cached cell sizes and inradii, and the coordinate versions (see
+  // Geometry::x_version) for which they were computed
+  mutable std::shared_ptr<const Eigen::ArrayXd> _cell_sizes, _cell_inradii;
+  mutable std::uint64_t _cell_sizes_version = 0, _cell_inradii_version = 0;
+
+  // Cached global hash (see hash), with the local topology and
+  // geometry hashes for which it was computed
+  mutable std::optional<std::array<std::size_t, 3>> _hash;
 };
 
 /// Create a mesh
+/// @param[in] comm The MPI communicator
+/// @param[in] cells The cells on this process (node indices)
+/// @param[in] element The coordinate element
+/// @param[in] x The node coordinates on this process
+/// @param[in] ghost_mode The type of ghost cells
+/// @param[in] reorder_cells If true, the owned cells on each process
+///   are re-ordered for data locality (reverse Cuthill-McKee ordering of
+///   the local cell-cell graph) after the cells are distributed
+/// @param[in] partitioner The partitioner used to distribute the
+///   cells. The geometric (Hilbert curve) partitioner is faster than
+///   the graph partitioner, but in general gives a larger
+///   communication volume. The hierarchical partitioner reduces the
+///   communication between shared memory nodes.
+/// @return A mesh
+Mesh create_mesh(MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+                 const fem::CoordinateElement& element,
+                 const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                    Eigen::RowMajor>& x,
+                 GhostMode ghost_mode, bool reorder_cells = false,
+                 CellPartitioner partitioner = CellPartitioner::graph);
+
+/// Create a mesh with given destination processes of the cells, e.g.
+/// from a partition computed by compute_cell_destinations in an
+/// earlier run. No partitioner is called.
+/// @param[in] comm The MPI communicator
+/// @param[in] cells The cells on this process (node indices)
+/// @param[in] element The coordinate element
+/// @param[in] x The node coordinates on this process
+/// @param[in] ghost_mode The type of ghost cells
+/// @param[in] dest The destination processes of each cell on this
+///   process, see compute_cell_destinations
+/// @param[in] reorder_cells If true, the owned cells on each process
+///   are re-ordered for data locality
+/// @return A mesh
 Mesh create_mesh(MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
                  const fem::CoordinateElement& element,
                  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
                                     Eigen::RowMajor>& x,
-                 GhostMode ghost_mode);
+                 GhostMode ghost_mode,
+                 const graph::AdjacencyList<std::int32_t>& dest,
+                 bool reorder_cells = false);
+
+/// Create a mesh as create_mesh, with the coordinates of the geometry
+/// nodes fetched by a function once the cells have been distributed,
+/// e.g. read from a file. Only the nodes of the cells on each process
+/// are fetched, and the graph partitioners do not fetch any nodes.
+/// @param[in] comm The MPI communicator
+/// @param[in] cells The cells on this process (node indices)
+/// @param[in] element The coordinate element
+/// @param[in] fetch_nodes Function that returns the coordinates of
+///   nodes by global input index
+/// @param[in] ghost_mode The type of ghost cells
+/// @param[in] partitioner The partitioner used to distribute the cells
+/// @return A mesh
+Mesh create_mesh_fetching_nodes(
+    MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+    const fem::CoordinateElement& element, const NodeFetcher& fetch_nodes,
+    GhostMode ghost_mode, CellPartitioner partitioner = CellPartitioner::graph);
+
+/// Create a mesh as create_mesh_fetching_nodes, with given destination
+/// processes of the cells. No partitioner is called.
+/// @param[in] comm The MPI communicator
+/// @param[in] cells The cells on this process (node indices)
+/// @param[in] element The coordinate element
+/// @param[in] fetch_nodes Function that returns the coordinates of
+///   nodes by global input index
+/// @param[in] ghost_mode The type of ghost cells
+/// @param[in] dest The destination processes of each cell on this
+///   process, see compute_cell_destinations
+/// @return A mesh
+Mesh create_mesh_fetching_nodes(
+    MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+    const fem::CoordinateElement& element, const NodeFetcher& fetch_nodes,
+    GhostMode ghost_mode, const graph::AdjacencyList<std::int32_t>& dest);
+
+/// Create a mesh from cells that are already distributed, e.g. created
+/// directly on each process by a mesh generator. No partitioner is
+/// called and no cells are communicated. The cells of a process are
+/// its owned cells followed by its ghost cells, which must be all cells
+/// of other processes that share a facet with an owned cell (also if
+/// @p ghost_mode is GhostMode::none, when they are used to determine
+/// the shared vertices and then discarded).
+/// @param[in] comm The MPI communicator
+/// @param[in] cells The owned and the ghost cells on this process (node
+///   indices)
+/// @param[in] original_cell_index A global index of each (owned and
+///   ghost) cell, unique across processes, e.g. the index of the cell
+///   in a generated grid
+/// @param[in] ghost_owners The owning process of each ghost cell
+/// @param[in] element The coordinate element
+/// @param[in] fetch_nodes Function that returns the coordinates of
+///   nodes by global input index
+/// @param[in] ghost_mode The type of ghost cells
+/// @return A mesh
+Mesh create_mesh_with_ghosts(
+    MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+    const std::vector<std::int64_t>& original_cell_index,
+    const std::vector<int>& ghost_owners,
+    const fem::CoordinateElement& element, const NodeFetcher& fetch_nodes,
+    GhostMode ghost_mode);
+
+/// Create a mesh as create_mesh, and also return the original index of
+/// each cell, e.g. to map cell-wise input data to the cells of the mesh
+/// @param[in] comm The MPI communicator
+/// @param[in] cells The cells on this process (node indices)
+/// @param[in] element The coordinate element
+/// @param[in] x The node coordinates on this process
+/// @param[in] ghost_mode The type of ghost cells
+/// @param[in] partitioner The partitioner used to distribute the cells
+/// @return The mesh, and the index of each (owned and ghost) cell of
+///   the mesh in the input cells, with the input cells numbered
+///   globally in rank order
+std::pair<Mesh, std::vector<std::int64_t>> create_mesh_with_original_index(
+    MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+    const fem::CoordinateElement& element,
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>& x,
+    GhostMode ghost_mode,
+    CellPartitioner partitioner = CellPartitioner::graph);
+
+/// Compute the destination processes of the cells of a mesh to be
+/// created by create_mesh (collective). The first destination of a
+/// cell is its owner, and the other destinations hold a ghost copy
+/// (ghosting via facets). The destinations depend only on the input
+/// data and the number of processes, and can be stored for reuse.
+///
+/// A mesh with more than one layer of ghost cells is created by
+/// create_mesh with the destinations computed for @p num_ghost_layers
+/// layers and GhostMode::shared_facet.
+/// @param[in] comm The MPI communicator
+/// @param[in] cells The cells on this process (node indices)
+/// @param[in] element The coordinate element
+/// @param[in] x The node coordinates on this process
+/// @param[in] partitioner The partitioner used to distribute the cells
+/// @param[in] weights The weight of each cell on this process, see
+///   mesh::Partitioning::partition_cells
+/// @param[in] num_ghost_layers The number of layers of ghost cells,
+///   see mesh::Partitioning::compute_ghost_layers
+/// @return The destination processes of each cell on this process
+graph::AdjacencyList<std::int32_t> compute_cell_destinations(
+    MPI_Comm comm, const graph::AdjacencyList<std::int64_t>& cells,
+    const fem::CoordinateElement& element,
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>& x,
+    CellPartitioner partitioner = CellPartitioner::graph,
+    const std::vector<std::int32_t>& weights = {}, int num_ghost_layers = 1);
+
+/// Create a copy of a distributed mesh with the cells redistributed by
+/// a weighted partition, e.g. to rebalance the work of an adaptive or
+/// multiphysics computation. Collective.
+///
+/// The returned original index of a cell of the new mesh is its global
+/// index in the cell index map of @p mesh, and the input global
+/// indices of the new geometry (see Geometry::input_global_indices)
+/// are global indices in the geometry index map of @p mesh. Data on
+/// the owned cells or geometry nodes of @p mesh, e.g. cell MeshTags
+/// values and cell-wise or node-wise Function data, can be migrated to
+/// the new mesh with graph::Partitioning::distribute_data.
+///
+/// @param[in] mesh The mesh to redistribute
+/// @param[in] weights The weight of each owned cell of @p mesh, see
+///   mesh::Partitioning::partition_cells. If empty, all cells have
+///   unit weight.
+/// @param[in] ghost_mode The type of ghost cells of the new mesh
+/// @param[in] partitioner The partitioner used to distribute the
+///   cells
+/// @return The new mesh, and the original global index of each (owned
+///   and ghost) cell of the new mesh in the owned cells of @p mesh
+std::pair<Mesh, std::vector<std::int64_t>>
+rebalance(const Mesh& mesh, const std::vector<std::int32_t>& weights,
+          GhostMode ghost_mode,
+          CellPartitioner partitioner = CellPartitioner::graph);
+
+/// Create a mesh of a subset of the entities of a mesh, e.g. of a
+/// subdomain or of the boundary (collective). The submesh keeps the
+/// distribution of @p mesh: no partitioner is called, and an entity,
+/// vertex or geometry node of the submesh is owned by its owner in
+/// @p mesh if the owner has it in the submesh, and otherwise by the
+/// lowest rank that has it. Only the cell-vertex connectivity of the
+/// submesh is created.
+///
+/// The returned maps give the local index in @p mesh of each (owned
+/// and ghost) cell, vertex and geometry node of the submesh, such that
+/// restriction and prolongation of data is an indexed copy. The input
+/// global indices of the submesh geometry are the global indices in the
+/// geometry index map of @p mesh.
+///
+/// @param[in] mesh The mesh
+/// @param[in] dim The topological dimension of the entities
+/// @param[in] entities The local indices of the (owned and ghost)
+///   entities of the submesh on this process, e.g. MeshTags indices
+/// @param[in] element The coordinate element of the submesh cells. If
+///   @p dim is lower than the topological dimension of @p mesh, the
+///   geometry of @p mesh and the element must be first order.
+/// @return The submesh, and the maps from the cells, the vertices and
+///   the geometry nodes of the submesh to the entities of dimension @p
+///   dim, the vertices and the geometry nodes of @p mesh
+std::tuple<Mesh, std::vector<std::int32_t>, std::vector<std::int32_t>,
+           std::vector<std::int32_t>>
+create_submesh(const Mesh& mesh, int dim,
+               const std::vector<std::int32_t>& entities,
+               const fem::CoordinateElement& element);
 
 } // namespace mesh
 } // namespace dolfinx
@@ -11,6 +11,7 @@
 #include "Topology.h"
 #include <algorithm>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/ThreadPool.h>
 #include <dolfinx/common/UniqueIdGenerator.h>
 #include <dolfinx/common/utils.h>
 #include <dolfinx/graph/AdjacencyList.h>
@@ -18,6 +19,7 @@
 #include <dolfinx/io/cells.h>
 #include <map>
 #include <memory>
+#include <numeric>
 #include <utility>
 #include <vector>
 
@@ -77,20 +79,81 @@ public:
   /// Move assignment
   MeshTags& operator=(MeshTags&& tags) = default;
 
-  /// Find all entities with a given tag value
+  /// Find all entities with a given tag value. The entities are looked
+  /// up in the value index (see value_index).
   /// @param[in] value The value
-  /// @return Indices of tagged entities
+  /// @return Indices of tagged entities (sorted)
   const Eigen::Array<std::int32_t, Eigen::Dynamic, 1> find(const T value) const
   {
-    int n = std::count(_values.begin(), _values.end(), value);
-    Eigen::Array<std::int32_t, Eigen::Dynamic, 1> indices(n);
-    int counter = 0;
-    for (std::int32_t i = 0; i < _values.size(); ++i)
+    const graph::AdjacencyList<std::int32_t>& index = value_index();
+    auto it = std::lower_bound(_unique_values.begin(), _unique_values.end(),
+                               value);
+    if (it == _unique_values.end() or *it != value)
+      return Eigen::Array<std::int32_t, Eigen::Dynamic, 1>(0);
+    return index.links(std::distance(_unique_values.begin(), it));
+  }
+
+  /// Find the position of an entity in indices() (and values()) by
+  /// binary search
+  /// @param[in] entity Index of the entity (local-to-process)
+  /// @return The position of the entity, or -1 if the entity is not
+  ///   tagged
+  std::int32_t find_entity(std::int32_t entity) const
+  {
+    auto it = std::lower_bound(_indices.begin(), _indices.end(), entity);
+    if (it == _indices.end() or *it != entity)
+      return -1;
+    return std::distance(_indices.begin(), it);
+  }
+
+  /// Distinct tag values, sorted. The values are computed with the
+  /// value index (see value_index).
+  const std::vector<T>& unique_values() const
+  {
+    value_index();
+    return _unique_values;
+  }
+
+  /// Get the index of the tagged entities by value. Node i of the
+  /// index holds the (sorted) entities with tag value
+  /// unique_values()[i]. The index is built on first use and cached.
+  /// The call is not thread-safe when the index is built.
+  /// @return The entities for each distinct tag value
+  const graph::AdjacencyList<std::int32_t>& value_index() const
+  {
+    if (!_value_index)
     {
-      if (_values[i] == value)
-        indices[counter++] = _indices[i];
+      // Order the tagged entities by value. The sort is stable, so the
+      // entities of each value remain sorted.
+      std::vector<std::int32_t> perm(_values.size());
+      std::iota(perm.begin(), perm.end(), 0);
+      std::stable_sort(perm.begin(), perm.end(),
+                       [&](std::int32_t a, std::int32_t b) {
+                         return _values[a] < _values[b];
+                       });
+
+      _unique_values.clear();
+      std::vector<std::int32_t> entities(perm.size());
+      std::vector<std::int32_t> offsets(1, 0);
+      for (std::size_t i = 0; i < perm.size(); ++i)
+      {
+        const T& value = _values[perm[i]];
+        if (_unique_values.empty() or _unique_values.back() != value)
+        {
+          if (i > 0)
+            offsets.push_back(i);
+          _unique_values.push_back(value);
+        }
+        entities[i] = _indices[perm[i]];
+      }
+      if (!perm.empty())
+        offsets.push_back(perm.size());
+
+      _value_index = std::make_shared<graph::AdjacencyList<std::int32_t>>(
+          std::move(entities), std::move(offsets));
     }
-    return indices;
+
+    return *_value_index;
   }
 
   /// Indices of tagged mesh entities (local-to-process). The indices
@@ -127,67 +190,82 @@ private:
 
   // Values attached to entities
   std::vector<T> _values;
+
+  // Distinct values and the entities for each value (cached)
+  mutable std::vector<T> _unique_values;
+  mutable std::shared_ptr<const graph::AdjacencyList<std::int32_t>>
+      _value_index;
 };
 
-/// Create MeshTags from arrays
+/// Create MeshTags from arrays. Each entity is matched against the
+/// mesh entities connected to one of its vertices, so the cost is
+/// proportional to the number of tagged entities.
 /// @param[in] mesh The Mesh that the tags are associated with
 /// @param[in] dim Topological dimension of tagged entities
 /// @param[in] entities Local vertex indices for tagged entities.
 /// @param[in] values Tag values for each entity in @ entities. The
 ///   length of @ values  must be equal to number of rows in @ entities.
+/// @param[in] num_threads Number of threads for matching the entities
 template <typename T>
 mesh::MeshTags<T>
 create_meshtags(const std::shared_ptr<const mesh::Mesh>& mesh, const int dim,
                 const graph::AdjacencyList<std::int32_t>& entities,
-                const std::vector<T>& values)
+                const std::vector<T>& values, int num_threads = 1)
 {
   assert(mesh);
   if ((std::size_t)entities.num_nodes() != values.size())
     throw std::runtime_error("Number of entities and values must match");
 
-  // Tagged entity topological dimension
-  const auto map_e = mesh->topology().index_map(dim);
-  assert(map_e);
-
   auto e_to_v = mesh->topology().connectivity(dim, 0);
   if (!e_to_v)
     throw std::runtime_error("Missing entity-vertex connectivity.");
+  mesh->topology_mutable().create_connectivity(0, dim);
+  auto v_to_e = mesh->topology().connectivity(0, dim);
+  assert(v_to_e);
 
-  const int num_vertices_per_entity = e_to_v->num_links(0);
-  const int num_entities_mesh = map_e->size_local() + map_e->num_ghosts();
+  // Find the local index of each received entity, or -1 if the entity
+  // is not on this rank. The candidates are the entities connected to
+  // the smallest vertex of the entity.
+  std::vector<std::int32_t> entity_index(entities.num_nodes(), -1);
+  common::parallel_for(
+      num_threads, entities.num_nodes(),
+      [&](int, std::int32_t begin, std::int32_t end) {
+        std::vector<std::int32_t> entity, candidate;
+        for (std::int32_t e = begin; e < end; ++e)
+        {
+          auto vertices = entities.links(e);
+          entity.assign(vertices.data(), vertices.data() + vertices.rows());
+          std::sort(entity.begin(), entity.end());
+          if (entity.empty() or entity[0] < 0
+              or entity[0] >= v_to_e->num_nodes())
+          {
+            continue;
+          }
 
-  std::map<std::vector<std::int32_t>, std::int32_t> entity_key_to_index;
-  std::vector<std::int32_t> key(num_vertices_per_entity);
-  for (int e = 0; e < num_entities_mesh; ++e)
-  {
-    // Prepare a map from ordered local vertex indices to local entity number
-    // This map is used to identify if received entity is owned or ghost
-    auto vertices = e_to_v->links(e);
-    for (int v = 0; v < vertices.rows(); ++v)
-      key[v] = vertices[v];
-    std::sort(key.begin(), key.end());
-    entity_key_to_index.insert({key, e});
-  }
+          auto vertex_entities = v_to_e->links(entity[0]);
+          for (Eigen::Index k = 0; k < vertex_entities.rows(); ++k)
+          {
+            const std::int32_t i = vertex_entities[k];
+            auto v = e_to_v->links(i);
+            candidate.assign(v.data(), v.data() + v.rows());
+            std::sort(candidate.begin(), candidate.end());
+            if (candidate == entity)
+            {
+              entity_index[e] = i;
+              break;
+            }
+          }
+        }
+      });
 
-  // Iterate over all received entities. If entity is on this rank,
-  // store (local entity index, tag value)
+  // Store (local entity index, tag value) of entities on this rank
   std::vector<std::int32_t> indices_new;
   std::vector<T> values_new;
-  std::vector<std::int32_t> entity(num_vertices_per_entity);
-
-  for (Eigen::Index e = 0; e < entities.num_nodes(); ++e)
+  for (std::size_t e = 0; e < entity_index.size(); ++e)
   {
-    // This would fail for mixed cell type meshes
-    assert(num_vertices_per_entity == entities.num_links(e));
-    std::copy(entities.links(e).data(),
-              entities.links(e).data() + num_vertices_per_entity,
-              entity.begin());
-    std::sort(entity.begin(), entity.end());
-
-    if (const auto it = entity_key_to_index.find(entity);
-        it != entity_key_to_index.end())
+    if (entity_index[e] >= 0)
     {
-      indices_new.push_back(it->second);
+      indices_new.push_back(entity_index[e]);
       values_new.push_back(values[e]);
     }
   }
@@ -8,20 +8,244 @@
 #include "Mesh.h"
 #include "Topology.h"
 #include "cell_types.h"
+#include <algorithm>
+#include <array>
+#include <boost/unordered_map.hpp>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/graph/Partitioning.h>
 #include <dolfinx/graph/SCOTCH.h>
 #include <dolfinx/mesh/GraphBuilder.h>
+#include <limits>
+#include <numeric>
 
 using namespace dolfinx;
 using namespace dolfinx::mesh;
 
+namespace
+{
+//-----------------------------------------------------------------------------
+// Compute the index along a Hilbert curve of a point with integer
+// coordinates X (d coordinates with b bits each), see J. Skilling,
+// "Programming the Hilbert curve", AIP Conference Proceedings 707,
+// 2004
+std::uint64_t hilbert_index(std::array<std::uint32_t, 3> X, int d, int b)
+{
+  const std::uint32_t M = 1u << (b - 1);
+
+  // Inverse undo
+  for (std::uint32_t Q = M; Q > 1; Q >>= 1)
+  {
+    const std::uint32_t P = Q - 1;
+    for (int i = 0; i < d; ++i)
+    {
+      if (X[i] & Q)
+        X[0] ^= P;
+      else
+      {
+        const std::uint32_t t = (X[0] ^ X[i]) & P;
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+
+  // Gray encode
+  for (int i = 1; i < d; ++i)
+    X[i] ^= X[i - 1];
+  std::uint32_t t = 0;
+  for (std::uint32_t Q = M; Q > 1; Q >>= 1)
+  {
+    if (X[d - 1] & Q)
+      t ^= Q - 1;
+  }
+  for (int i = 0; i < d; ++i)
+    X[i] ^= t;
+
+  // Interleave the bits, most significant first
+  std::uint64_t h = 0;
+  for (int j = b - 1; j >= 0; --j)
+    for (int i = 0; i < d; ++i)
+      h = (h << 1) | ((X[i] >> j) & 1);
+  return h;
+}
+//-----------------------------------------------------------------------------
+// Compute the Hilbert curve index of each midpoint, with the curve
+// through the bounding box (min_0, min_1, min_2, -max_0, -max_1, -max_2)
+std::vector<std::uint64_t> hilbert_keys(
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic,
+                                        Eigen::Dynamic, Eigen::RowMajor>>&
+        midpoints,
+    const std::array<double, 6>& bbox)
+{
+  // Use the directions in which the midpoints are spread, with the
+  // same number of bits for each direction
+  std::vector<int> axes;
+  for (int i = 0; i < midpoints.cols(); ++i)
+    if (-bbox[3 + i] > bbox[i])
+      axes.push_back(i);
+  const int d = std::max<int>(axes.size(), 1);
+  const int b = std::min(32, 63 / d);
+  const double scale = (std::uint64_t(1) << b) - 1;
+
+  std::vector<std::uint64_t> keys(midpoints.rows(), 0);
+  for (Eigen::Index c = 0; c < midpoints.rows(); ++c)
+  {
+    std::array<std::uint32_t, 3> X = {0, 0, 0};
+    for (std::size_t j = 0; j < axes.size(); ++j)
+    {
+      const int i = axes[j];
+      const double s = (midpoints(c, i) - bbox[i]) / (-bbox[3 + i] - bbox[i]);
+      X[j] = static_cast<std::uint32_t>(s * scale);
+    }
+    keys[c] = hilbert_index(X, d, b);
+  }
+  return keys;
+}
+//-----------------------------------------------------------------------------
+// Compute the destinations of the cells that share a facet with each
+// cell on this process, excluding the destination of the cell itself
+std::vector<std::vector<std::int32_t>>
+compute_ghost_destinations(MPI_Comm comm, const mesh::CellType cell_type,
+                           const graph::AdjacencyList<std::int64_t>& cells,
+                           const std::vector<std::int32_t>& part)
+{
+  const std::int32_t num_cells = cells.num_nodes();
+  std::vector<std::vector<std::int32_t>> ghost_dest(num_cells);
+
+  // Facet neighbors on this process
+  const auto [local_graph, facet_cell_map, num_local_edges]
+      = mesh::GraphBuilder::compute_local_dual_graph(cells, cell_type);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    for (std::int32_t c1 : local_graph[c])
+      if (part[c1] != part[c])
+        ghost_dest[c].push_back(part[c1]);
+  }
+
+  const int num_processes = dolfinx::MPI::size(comm);
+  if (num_processes == 1)
+    return ghost_dest;
+
+  // Send the unmatched facets, with cell index and destination, to a
+  // match-making process determined by the first facet vertex
+  const int tdim = mesh::cell_dim(cell_type);
+  const int num_vertices_per_facet
+      = mesh::num_cell_vertices(mesh::cell_entity_type(cell_type, tdim - 1));
+  const std::int64_t max_vertex
+      = (num_cells > 0) ? cells.array().maxCoeff() : 0;
+  std::int64_t num_global_vertices = 0;
+  MPI_Allreduce(&max_vertex, &num_global_vertices, 1, MPI_INT64_T, MPI_MAX,
+                comm);
+  num_global_vertices += 1;
+
+  std::vector<std::vector<std::int64_t>> send_buffer(num_processes);
+  for (const auto& [facet, c] : facet_cell_map)
+  {
+    const int dest = dolfinx::MPI::index_owner(num_processes, facet[0],
+                                               num_global_vertices);
+    send_buffer[dest].insert(send_buffer[dest].end(), facet.begin(),
+                             facet.end());
+    send_buffer[dest].push_back(c);
+    send_buffer[dest].push_back(part[c]);
+  }
+  const graph::AdjacencyList<std::int64_t> recv_buffer
+      = dolfinx::MPI::all_to_all(
+          comm, graph::AdjacencyList<std::int64_t>(send_buffer));
+
+  // Match facets and send the destination of the other cell back to
+  // the owner of each cell
+  send_buffer = std::vector<std::vector<std::int64_t>>(num_processes);
+  boost::unordered_map<std::vector<std::int64_t>, std::array<std::int64_t, 3>>
+      matchmap;
+  std::vector<std::int64_t> key(num_vertices_per_facet);
+  const int record_size = num_vertices_per_facet + 2;
+  for (int p = 0; p < num_processes; ++p)
+  {
+    auto data_p = recv_buffer.links(p);
+    for (int i = 0; i < data_p.rows(); i += record_size)
+    {
+      std::copy_n(data_p.data() + i, num_vertices_per_facet, key.begin());
+      const std::array<std::int64_t, 3> value
+          = {p, data_p[i + num_vertices_per_facet],
+             data_p[i + num_vertices_per_facet + 1]};
+      if (auto [it, inserted] = matchmap.insert({key, value}); !inserted)
+      {
+        const auto& [p0, c0, dest0] = it->second;
+        send_buffer[p0].insert(send_buffer[p0].end(), {c0, value[2]});
+        send_buffer[p].insert(send_buffer[p].end(), {value[1], dest0});
+        matchmap.erase(it);
+      }
+    }
+  }
+  const graph::AdjacencyList<std::int64_t> matches = dolfinx::MPI::all_to_all(
+      comm, graph::AdjacencyList<std::int64_t>(send_buffer));
+
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& match_data
+      = matches.array();
+  for (Eigen::Index i = 0; i < match_data.rows(); i += 2)
+  {
+    const std::int32_t c = match_data[i];
+    if (match_data[i + 1] != part[c])
+      ghost_dest[c].push_back(match_data[i + 1]);
+  }
+
+  return ghost_dest;
+}
+//-----------------------------------------------------------------------------
+// Pack the destinations of the cells on this process, with the owner
+// part[c] of cell c first, followed by the destinations of its ghost
+// copies (if ghosting is requested)
+graph::AdjacencyList<std::int32_t>
+pack_destinations(MPI_Comm comm, const mesh::CellType cell_type,
+                  const graph::AdjacencyList<std::int64_t>& cells,
+                  const std::vector<std::int32_t>& part,
+                  mesh::GhostMode ghost_mode)
+{
+  // Destinations of the ghost copies
+  std::vector<std::vector<std::int32_t>> ghost_dest;
+  if (ghost_mode != mesh::GhostMode::none)
+    ghost_dest = compute_ghost_destinations(comm, cell_type, cells, part);
+
+  const std::int32_t num_cells = cells.num_nodes();
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets(num_cells + 1);
+  offsets[0] = 0;
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    offsets[c + 1] = offsets[c] + 1;
+    if (!ghost_dest.empty())
+    {
+      std::vector<std::int32_t>& g = ghost_dest[c];
+      std::sort(g.begin(), g.end());
+      g.erase(std::unique(g.begin(), g.end()), g.end());
+      offsets[c + 1] += g.size();
+    }
+  }
+
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> dests(offsets[num_cells]);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    dests[offsets[c]] = part[c];
+    if (!ghost_dest.empty())
+    {
+      std::copy(ghost_dest[c].begin(), ghost_dest[c].end(),
+                dests.data() + offsets[c] + 1);
+    }
+  }
+
+  return graph::AdjacencyList<std::int32_t>(std::move(dests),
+                                            std::move(offsets));
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 //-----------------------------------------------------------------------------
 graph::AdjacencyList<std::int32_t> Partitioning::partition_cells(
     MPI_Comm comm, int n, const mesh::CellType cell_type,
-    const graph::AdjacencyList<std::int64_t>& cells, mesh::GhostMode ghost_mode)
+    const graph::AdjacencyList<std::int64_t>& cells, mesh::GhostMode ghost_mode,
+    const std::vector<std::int32_t>& weights)
 {
   common::Timer timer("Partition cells across processes");
   LOG(INFO) << "Compute partition of cells across processes";
@@ -36,6 +260,8 @@ graph::AdjacencyList<std::int32_t> Partitioning::partition_cells(
           + std::to_string(mesh::num_cell_vertices(cell_type)) + ".");
     }
   }
+  if (!weights.empty() and (std::int32_t)weights.size() != cells.num_nodes())
+    throw std::runtime_error("Number of cell weights and cells differ.");
 
   // Compute distributed dual graph (for the cells on this process)
   const auto [dual_graph, graph_info]
@@ -46,15 +272,342 @@ graph::AdjacencyList<std::int32_t> Partitioning::partition_cells(
       = graph_info;
 
   graph::AdjacencyList<SCOTCH_Num> adj_graph(dual_graph);
-  std::vector<std::size_t> weights;
+  const std::vector<std::size_t> node_weights(weights.begin(), weights.end());
 
   // Just flag any kind of ghosting for now
   bool ghosting = (ghost_mode != mesh::GhostMode::none);
 
   // Call partitioner
   graph::AdjacencyList<std::int32_t> partition = graph::SCOTCH::partition(
-      comm, n, adj_graph, weights, num_ghost_nodes, ghosting);
+      comm, n, adj_graph, node_weights, num_ghost_nodes, ghosting);
 
   return partition;
 }
 //-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> Partitioning::partition_cells_hilbert(
+    MPI_Comm comm, int n, const mesh::CellType cell_type,
+    const graph::AdjacencyList<std::int64_t>& cells,
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic,
+                                        Eigen::Dynamic, Eigen::RowMajor>>&
+        midpoints,
+    mesh::GhostMode ghost_mode, const std::vector<std::int32_t>& weights)
+{
+  common::Timer timer("Partition cells across processes (Hilbert curve)");
+  LOG(INFO) << "Compute geometric partition of cells across processes";
+
+  const std::int32_t num_cells = cells.num_nodes();
+  if (midpoints.rows() != num_cells)
+    throw std::runtime_error("Number of cell midpoints and cells differ.");
+  const int gdim = midpoints.cols();
+  if (gdim > 3)
+    throw std::runtime_error("Geometric dimension greater than 3.");
+  if (!weights.empty() and (std::int32_t)weights.size() != num_cells)
+    throw std::runtime_error("Number of cell weights and cells differ.");
+
+  // Bounding box of all midpoints
+  std::array<double, 6> bbox_local;
+  for (int i = 0; i < 3; ++i)
+  {
+    bbox_local[i] = std::numeric_limits<double>::max();
+    bbox_local[3 + i] = std::numeric_limits<double>::max();
+  }
+  for (int i = 0; i < gdim and num_cells > 0; ++i)
+  {
+    bbox_local[i] = midpoints.col(i).minCoeff();
+    bbox_local[3 + i] = -midpoints.col(i).maxCoeff();
+  }
+  std::array<double, 6> bbox;
+  MPI_Allreduce(bbox_local.data(), bbox.data(), 6, MPI_DOUBLE, MPI_MIN, comm);
+
+  // Compute the (sorted) Hilbert curve index for each cell
+  const std::vector<std::uint64_t> keys = hilbert_keys(midpoints, bbox);
+
+  // Sort the keys, and compute the total weight of the cells with
+  // (sorted) key index less than i
+  std::vector<std::int32_t> order(num_cells);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&keys](auto a, auto b) { return keys[a] < keys[b]; });
+  std::vector<std::uint64_t> sorted_keys(num_cells);
+  std::vector<std::int64_t> weight_sum(num_cells + 1, 0);
+  for (std::int32_t i = 0; i < num_cells; ++i)
+  {
+    sorted_keys[i] = keys[order[i]];
+    weight_sum[i + 1]
+        = weight_sum[i] + (weights.empty() ? 1 : weights[order[i]]);
+  }
+
+  // Find the n - 1 splitting indices on the curve by simultaneous
+  // bisection. Splitter k is the smallest index such that the cells
+  // with a smaller index have at least a fraction k / n of the total
+  // weight W.
+  const std::int64_t weight_local = weight_sum.back();
+  std::int64_t weight_global = 0;
+  MPI_Allreduce(&weight_local, &weight_global, 1, MPI_INT64_T, MPI_SUM, comm);
+  std::vector<std::uint64_t> lo(std::max(n - 1, 0), 0),
+      hi(std::max(n - 1, 0), std::numeric_limits<std::uint64_t>::max());
+  std::vector<std::int64_t> count(lo.size()), count_global(lo.size());
+  bool active = !lo.empty();
+  while (active)
+  {
+    for (std::size_t k = 0; k < lo.size(); ++k)
+    {
+      const std::uint64_t mid = lo[k] + (hi[k] - lo[k]) / 2;
+      count[k] = weight_sum[std::distance(
+          sorted_keys.begin(),
+          std::lower_bound(sorted_keys.begin(), sorted_keys.end(), mid))];
+    }
+    MPI_Allreduce(count.data(), count_global.data(), count.size(),
+                  MPI_INT64_T, MPI_SUM, comm);
+
+    active = false;
+    for (std::size_t k = 0; k < lo.size(); ++k)
+    {
+      if (lo[k] < hi[k])
+      {
+        const std::uint64_t mid = lo[k] + (hi[k] - lo[k]) / 2;
+        const std::int64_t target = ((k + 1) * weight_global) / n;
+        if (count_global[k] >= target)
+          hi[k] = mid;
+        else
+          lo[k] = mid + 1;
+        active = active or (lo[k] < hi[k]);
+      }
+    }
+  }
+
+  // Destination of each cell
+  std::vector<std::int32_t> part(num_cells);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    part[c] = std::distance(lo.begin(),
+                            std::upper_bound(lo.begin(), lo.end(), keys[c]));
+  }
+
+  return pack_destinations(comm, cell_type, cells, part, ghost_mode);
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> Partitioning::partition_cells_hierarchical(
+    MPI_Comm comm, const mesh::CellType cell_type,
+    const graph::AdjacencyList<std::int64_t>& cells, mesh::GhostMode ghost_mode,
+    const std::vector<std::int32_t>& weights)
+{
+  common::Timer timer("Partition cells across processes (hierarchical)");
+  LOG(INFO) << "Compute node-aware partition of cells across processes";
+
+  const std::int32_t num_cells = cells.num_nodes();
+  if (!weights.empty() and (std::int32_t)weights.size() != num_cells)
+    throw std::runtime_error("Number of cell weights and cells differ.");
+
+  // Group the ranks by shared memory node. The ranks in the node
+  // communicator are ordered as in comm.
+  const int rank = dolfinx::MPI::rank(comm);
+  const int size = dolfinx::MPI::size(comm);
+  MPI_Comm node_comm;
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL,
+                      &node_comm);
+
+  // Number the nodes in the order of their lowest rank, and get the
+  // ranks on each node
+  int leader = rank;
+  MPI_Bcast(&leader, 1, MPI_INT, 0, node_comm);
+  std::vector<int> leaders(size);
+  MPI_Allgather(&leader, 1, MPI_INT, leaders.data(), 1, MPI_INT, comm);
+  std::vector<int> node_index(size);
+  std::vector<std::vector<int>> node_ranks;
+  for (int p = 0; p < size; ++p)
+  {
+    if (leaders[p] == p)
+      node_ranks.emplace_back();
+    node_index[p] = (leaders[p] == p) ? node_ranks.size() - 1
+                                      : node_index[leaders[p]];
+    node_ranks[node_index[p]].push_back(p);
+  }
+  const int num_nodes = node_ranks.size();
+
+  // With one node, or one rank per node, the flat partition is already
+  // node-aware
+  if (num_nodes == 1 or num_nodes == size)
+  {
+    MPI_Comm_free(&node_comm);
+    return partition_cells(comm, size, cell_type, cells, ghost_mode, weights);
+  }
+
+  // Partition the cells across the nodes
+  const graph::AdjacencyList<std::int32_t> node_dest = partition_cells(
+      comm, num_nodes, cell_type, cells, mesh::GhostMode::none, weights);
+
+  // Send each cell to a rank on its destination node, spreading the
+  // cells over the ranks of the node
+  std::vector<std::int32_t> send_dest(num_cells);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+  {
+    const std::vector<int>& ranks = node_ranks[node_dest.links(c)[0]];
+    send_dest[c] = ranks[c % ranks.size()];
+  }
+  std::vector<std::int32_t> send_offsets(num_cells + 1);
+  std::iota(send_offsets.begin(), send_offsets.end(), 0);
+  const auto [node_cells, src, original_cell_index, ghost_owners]
+      = graph::Partitioning::distribute(
+          comm, cells,
+          graph::AdjacencyList<std::int32_t>(send_dest, send_offsets));
+
+  // Fetch the weights of the received cells
+  std::vector<std::int32_t> node_weights;
+  std::int32_t has_weights = !weights.empty();
+  MPI_Allreduce(MPI_IN_PLACE, &has_weights, 1, MPI_INT32_T, MPI_MAX, comm);
+  if (has_weights)
+  {
+    Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        w(num_cells, 1);
+    for (std::int32_t c = 0; c < num_cells; ++c)
+      w(c, 0) = weights.empty() ? 1 : weights[c];
+    const Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>
+        w_recv = graph::Partitioning::distribute_data<std::int32_t>(
+            comm, original_cell_index, w);
+    node_weights.assign(w_recv.data(), w_recv.data() + w_recv.rows());
+  }
+
+  // Partition the cells on each node across the ranks of the node
+  const int node_size = dolfinx::MPI::size(node_comm);
+  const graph::AdjacencyList<std::int32_t> rank_dest
+      = partition_cells(node_comm, node_size, cell_type, node_cells,
+                        mesh::GhostMode::none, node_weights);
+  MPI_Comm_free(&node_comm);
+
+  // Send the destination rank of each cell back to the rank it came
+  // from, together with its original index
+  const std::vector<int>& ranks = node_ranks[node_index[rank]];
+  std::vector<std::vector<std::int64_t>> send_data(size);
+  for (std::int32_t c = 0; c < node_cells.num_nodes(); ++c)
+  {
+    send_data[src[c]].push_back(original_cell_index[c]);
+    send_data[src[c]].push_back(ranks[rank_dest.links(c)[0]]);
+  }
+  const Eigen::Array<std::int64_t, Eigen::Dynamic, 1> recv_data
+      = dolfinx::MPI::all_to_all(
+            comm, graph::AdjacencyList<std::int64_t>(send_data))
+            .array();
+
+  const std::int64_t offset
+      = dolfinx::MPI::global_offset(comm, num_cells, true);
+  std::vector<std::int32_t> part(num_cells);
+  for (Eigen::Index i = 0; i < recv_data.rows(); i += 2)
+    part[recv_data[i] - offset] = recv_data[i + 1];
+
+  return pack_destinations(comm, cell_type, cells, part, ghost_mode);
+}
+//-----------------------------------------------------------------------------
+std::vector<std::int32_t> Partitioning::compute_hilbert_order(
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic,
+                                        Eigen::Dynamic, Eigen::RowMajor>>&
+        midpoints)
+{
+  if (midpoints.cols() > 3)
+    throw std::runtime_error("Geometric dimension greater than 3.");
+
+  std::array<double, 6> bbox = {0, 0, 0, 0, 0, 0};
+  for (int i = 0; i < midpoints.cols() and midpoints.rows() > 0; ++i)
+  {
+    bbox[i] = midpoints.col(i).minCoeff();
+    bbox[3 + i] = -midpoints.col(i).maxCoeff();
+  }
+  const std::vector<std::uint64_t> keys = hilbert_keys(midpoints, bbox);
+
+  std::vector<std::int32_t> order(midpoints.rows());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&keys](auto a, auto b) { return keys[a] < keys[b]; });
+  return order;
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> Partitioning::compute_ghost_layers(
+    MPI_Comm comm, const mesh::CellType cell_type,
+    const graph::AdjacencyList<std::int64_t>& cells,
+    const graph::AdjacencyList<std::int32_t>& dest, int num_layers)
+{
+  common::Timer timer("Compute layers of ghost cells");
+  if (num_layers < 1)
+  {
+    throw std::runtime_error("At least one layer of ghost cells is required "
+                             "(use GhostMode::none to discard ghost cells).");
+  }
+
+  const std::int32_t num_cells = cells.num_nodes();
+  if (dest.num_nodes() != num_cells)
+    throw std::runtime_error("Number of cell destinations and cells differ.");
+
+  // Distributed dual graph, with the cells numbered globally in rank
+  // order
+  const std::vector<std::vector<std::int64_t>> graph
+      = mesh::GraphBuilder::compute_dual_graph(comm, cells, cell_type).first;
+  const int num_processes = dolfinx::MPI::size(comm);
+  std::vector<std::int64_t> ranges(num_processes + 1, 0);
+  {
+    std::vector<std::int32_t> sizes(num_processes);
+    MPI_Allgather(&num_cells, 1, MPI_INT32_T, sizes.data(), 1, MPI_INT32_T,
+                  comm);
+    std::partial_sum(sizes.begin(), sizes.end(), ranges.begin() + 1);
+  }
+  const std::int64_t offset = ranges[dolfinx::MPI::rank(comm)];
+
+  // The processes that own a cell within the current number of layers
+  // of each cell, starting from the owner. Each layer adds the
+  // processes of the facet neighbours (of the previous layer).
+  std::vector<std::vector<std::int32_t>> procs(num_cells);
+  for (std::int32_t c = 0; c < num_cells; ++c)
+    procs[c].push_back(dest.links(c)[0]);
+  for (int layer = 0; layer < num_layers; ++layer)
+  {
+    std::vector<std::vector<std::int32_t>> next = procs;
+
+    // Send the processes of each cell to the owners of its non-local
+    // neighbours, as (neighbour, number of processes, processes)
+    std::vector<std::vector<std::int64_t>> send_buffer(num_processes);
+    for (std::int32_t c = 0; c < num_cells; ++c)
+    {
+      for (std::int64_t n : graph[c])
+      {
+        if (n >= offset and n < offset + num_cells)
+        {
+          const std::vector<std::int32_t>& p = procs[n - offset];
+          next[c].insert(next[c].end(), p.begin(), p.end());
+        }
+        else
+        {
+          auto it = std::upper_bound(ranges.begin(), ranges.end(), n);
+          const int q = std::distance(ranges.begin(), it) - 1;
+          std::vector<std::int64_t>& b = send_buffer[q];
+          b.insert(b.end(), {n, std::int64_t(procs[c].size())});
+          b.insert(b.end(), procs[c].begin(), procs[c].end());
+        }
+      }
+    }
+
+    const graph::AdjacencyList<std::int64_t> recv_buffer
+        = dolfinx::MPI::all_to_all(
+            comm, graph::AdjacencyList<std::int64_t>(send_buffer));
+    const Eigen::Array<std::int64_t, Eigen::Dynamic, 1>& recv_data
+        = recv_buffer.array();
+    for (Eigen::Index i = 0; i < recv_data.rows();)
+    {
+      std::vector<std::int32_t>& p = next[recv_data[i] - offset];
+      p.insert(p.end(), recv_data.data() + i + 2,
+               recv_data.data() + i + 2 + recv_data[i + 1]);
+      i += 2 + recv_data[i + 1];
+    }
+
+    // Keep the owner first, followed by the other processes in order
+    for (std::vector<std::int32_t>& p : next)
+    {
+      std::sort(p.begin() + 1, p.end());
+      p.erase(std::unique(p.begin() + 1, p.end()), p.end());
+      p.erase(std::remove(p.begin() + 1, p.end(), p[0]), p.end());
+    }
+    procs = std::move(next);
+  }
+
+  return graph::AdjacencyList<std::int32_t>(procs);
+}
+//-----------------------------------------------------------------------------
@@ -36,11 +36,104 @@ namespace Partitioning
 ///   included.
 /// @param[in] ghost_mode How to overlap the cell partitioning: none,
 ///   shared_facet or shared_vertex
+/// @param[in] weights The (positive) weight of each cell on this
+///   process, e.g. an estimate of its computational cost. The sum of
+///   the weights, rather than the number of cells, is balanced across
+///   the partitions. If empty, all cells have unit weight. If not
+///   empty on one process it must not be empty on any process with
+///   cells.
 /// @return Destination processes for each cell on this process
 graph::AdjacencyList<std::int32_t>
 partition_cells(MPI_Comm comm, int n, const mesh::CellType cell_type,
                 const graph::AdjacencyList<std::int64_t>& cells,
-                mesh::GhostMode ghost_mode);
+                mesh::GhostMode ghost_mode,
+                const std::vector<std::int32_t>& weights = {});
+
+/// Compute destination rank for mesh cells in this rank using a
+/// geometric partitioner. The cells are ordered along a Hilbert
+/// space-filling curve through their midpoints and the curve is split
+/// into @p n parts with (close to) equal total cell weight. No graph
+/// partitioner is called and the distributed dual graph is not built.
+/// If ghosting is requested, the destinations of the ghost copies of
+/// each cell are the destinations of the cells that share a facet with
+/// it.
+///
+/// @param[in] comm MPI Communicator
+/// @param[in] n Number of partitions
+/// @param[in] cell_type Cell type
+/// @param[in] cells Cells on this process, see partition_cells
+/// @param[in] midpoints The midpoints of the cells on this process
+///   (shape = (num_cells, gdim))
+/// @param[in] ghost_mode How to overlap the cell partitioning: none,
+///   shared_facet or shared_vertex
+/// @param[in] weights The weight of each cell on this process, see
+///   partition_cells. If empty, all cells have unit weight.
+/// @return Destination processes for each cell on this process
+graph::AdjacencyList<std::int32_t> partition_cells_hilbert(
+    MPI_Comm comm, int n, const mesh::CellType cell_type,
+    const graph::AdjacencyList<std::int64_t>& cells,
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic,
+                                        Eigen::Dynamic, Eigen::RowMajor>>&
+        midpoints,
+    mesh::GhostMode ghost_mode,
+    const std::vector<std::int32_t>& weights = {});
+
+/// Compute destination rank for mesh cells in this rank using a
+/// two-level (node-aware) graph partitioner. The cells are first
+/// partitioned across the shared memory nodes (see
+/// MPI_Comm_split_type) and then across the ranks of each node, such
+/// that most of the cells that share a facet with a cell on another
+/// rank are on the same node. The levels are balanced assuming that
+/// all nodes hold the same number of ranks.
+///
+/// @param[in] comm MPI Communicator. Each rank of @p comm is a
+///   partition.
+/// @param[in] cell_type Cell type
+/// @param[in] cells Cells on this process, see partition_cells
+/// @param[in] ghost_mode How to overlap the cell partitioning: none,
+///   shared_facet or shared_vertex
+/// @param[in] weights The weight of each cell on this process, see
+///   partition_cells. If empty, all cells have unit weight.
+/// @return Destination processes for each cell on this process
+graph::AdjacencyList<std::int32_t> partition_cells_hierarchical(
+    MPI_Comm comm, const mesh::CellType cell_type,
+    const graph::AdjacencyList<std::int64_t>& cells, mesh::GhostMode ghost_mode,
+    const std::vector<std::int32_t>& weights = {});
+
+/// Compute the destinations of cells with a given number of layers of
+/// ghost cells (collective). A cell is ghosted on a process if it is
+/// connected to a cell owned by the process through at most
+/// @p num_layers facets, e.g. for the patches of high-order
+/// discontinuous Galerkin methods or overlapping smoothers. One layer
+/// gives the ghost cells of GhostMode::shared_facet.
+///
+/// @param[in] comm MPI Communicator
+/// @param[in] cell_type Cell type
+/// @param[in] cells Cells on this process, see partition_cells
+/// @param[in] dest The destinations of each cell on this process, with
+///   the owner first (e.g. computed by partition_cells). Only the owner
+///   is used.
+/// @param[in] num_layers The number of layers of ghost cells (at least
+///   one)
+/// @return The owner of each cell on this process, followed by the
+///   processes that hold a ghost copy in ascending order
+graph::AdjacencyList<std::int32_t>
+compute_ghost_layers(MPI_Comm comm, const mesh::CellType cell_type,
+                     const graph::AdjacencyList<std::int64_t>& cells,
+                     const graph::AdjacencyList<std::int32_t>& dest,
+                     int num_layers);
+
+/// Compute the order of points along a Hilbert space-filling curve
+/// through their bounding box. Ordering the cells of a mesh by their
+/// midpoints gives a local cell order with good data locality, e.g.
+/// for numbering dofs (see fem::DofOrdering::cell).
+///
+/// @param[in] midpoints The points (shape = (num_points, gdim))
+/// @return The point indices, in order along the curve
+std::vector<std::int32_t> compute_hilbert_order(
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic,
+                                        Eigen::Dynamic, Eigen::RowMajor>>&
+        midpoints);
 
 } // namespace Partitioning
 } // namespace dolfinx::mesh
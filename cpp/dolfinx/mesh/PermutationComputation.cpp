@@ -307,17 +307,25 @@ std::pair<Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>,
           Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>>
 PermutationComputation::compute_entity_permutations(
     const mesh::Topology& topology)
+{
+  Eigen::Array<std::uint32_t, Eigen::Dynamic, 1> cell_permutation_info
+      = compute_cell_permutation_info(topology);
+  return {unpack_facet_permutations(topology.cell_type(),
+                                    cell_permutation_info),
+          std::move(cell_permutation_info)};
+}
+//-----------------------------------------------------------------------------
+Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>
+PermutationComputation::compute_cell_permutation_info(
+    const mesh::Topology& topology)
 {
   const int tdim = topology.dim();
   const CellType cell_type = topology.cell_type();
   assert(topology.connectivity(tdim, 0));
   const std::int32_t num_cells = topology.connectivity(tdim, 0)->num_nodes();
-  const int facets_per_cell = cell_num_entities(cell_type, tdim - 1);
 
   Eigen::Array<std::uint32_t, Eigen::Dynamic, 1> cell_permutation_info
       = Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>::Zero(num_cells);
-  Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic> facet_permutations(
-      facets_per_cell, num_cells);
 
   std::int32_t used_bits = 0;
   if (tdim > 2)
@@ -331,12 +339,6 @@ PermutationComputation::compute_entity_permutations(
     // Currently, 3 bits are used for each face. If faces with more than
     // 4 sides are implemented, this will need to be increased.
     used_bits += faces_per_cell * 3;
-    assert(tdim == 3);
-    for (int c = 0; c < num_cells; ++c)
-    {
-      for (int i = 0; i < facets_per_cell; ++i)
-        facet_permutations(i, c) = (cell_permutation_info[c] >> (3 * i)) & 7;
-    }
   }
 
   if (tdim > 1)
@@ -346,18 +348,66 @@ PermutationComputation::compute_entity_permutations(
         = compute_edge_reflections(topology);
     for (int c = 0; c < num_cells; ++c)
       cell_permutation_info[c] |= edge_perm[c].to_ulong() << used_bits;
-
     used_bits += edges_per_cell;
-    if (tdim == 2)
-    {
-      for (int c = 0; c < num_cells; ++c)
-        for (int i = 0; i < facets_per_cell; ++i)
-          facet_permutations(i, c) = edge_perm[c][i];
-    }
   }
 
   assert(used_bits < BITSETSIZE);
 
-  return {std::move(facet_permutations), std::move(cell_permutation_info)};
+  return cell_permutation_info;
+}
+//-----------------------------------------------------------------------------
+Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>
+PermutationComputation::compute_facet_permutations(
+    const mesh::Topology& topology)
+{
+  const int tdim = topology.dim();
+  assert(topology.connectivity(tdim, 0));
+  const std::int32_t num_cells = topology.connectivity(tdim, 0)->num_nodes();
+
+  // Only the permutations of the facets are computed, so the data for
+  // the lower dimensional entities is not required
+  Eigen::Array<std::uint32_t, Eigen::Dynamic, 1> facet_info(num_cells);
+  if (tdim == 3)
+  {
+    Eigen::Array<std::bitset<BITSETSIZE>, Eigen::Dynamic, 1> face_perm
+        = compute_face_permutations(topology);
+    for (int c = 0; c < num_cells; ++c)
+      facet_info[c] = face_perm[c].to_ulong();
+  }
+  else if (tdim == 2)
+  {
+    Eigen::Array<std::bitset<BITSETSIZE>, Eigen::Dynamic, 1> edge_perm
+        = compute_edge_reflections(topology);
+    for (int c = 0; c < num_cells; ++c)
+      facet_info[c] = edge_perm[c].to_ulong();
+  }
+
+  return unpack_facet_permutations(topology.cell_type(), facet_info);
 }
 //-----------------------------------------------------------------------------
+Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>
+PermutationComputation::unpack_facet_permutations(
+    CellType cell_type,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info)
+{
+  const int tdim = cell_dim(cell_type);
+  const int facets_per_cell = cell_num_entities(cell_type, tdim - 1);
+  Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic> facet_permutations
+      = Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>::Zero(
+          facets_per_cell, cell_info.rows());
+  if (tdim < 2)
+    return facet_permutations;
+
+  // The facet data is stored in the lowest bits of the cell data: 3
+  // bits per face (tdim = 3) or 1 bit per edge (tdim = 2)
+  const int bits = tdim == 3 ? 3 : 1;
+  const std::uint32_t mask = (1 << bits) - 1;
+  for (int c = 0; c < cell_info.rows(); ++c)
+  {
+    for (int i = 0; i < facets_per_cell; ++i)
+      facet_permutations(i, c) = (cell_info[c] >> (bits * i)) & mask;
+  }
+  return facet_permutations;
+}
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
@@ -13,6 +13,7 @@
 namespace dolfinx::mesh
 {
 class Topology;
+enum class CellType;
 
 /// Tools for computing mesh entity permutations
 
@@ -76,5 +77,31 @@ std::pair<Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>,
           Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>>
 compute_entity_permutations(const Topology& topology);
 
+/// Compute the cell permutation data only, see
+/// compute_entity_permutations for the encoding. All entities of
+/// dimension 0 < d < tdim must have been created.
+/// @param[in] topology The mesh topology
+/// @return The cell permutation info
+Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>
+compute_cell_permutation_info(const Topology& topology);
+
+/// Compute the facet permutation numbers only, see
+/// compute_entity_permutations for the numbering. Only the facets must
+/// have been created.
+/// @param[in] topology The mesh topology
+/// @return The facet permutations (facets of a cell x cells)
+Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>
+compute_facet_permutations(const Topology& topology);
+
+/// Extract the facet permutation numbers from cell permutation info
+/// (or from data with the same encoding for the facets only)
+/// @param[in] cell_type The cell type
+/// @param[in] cell_info The cell permutation info
+/// @return The facet permutations (facets of a cell x cells)
+Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>
+unpack_facet_permutations(
+    CellType cell_type,
+    const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>& cell_info);
+
 } // namespace PermutationComputation
 } // namespace dolfinx::mesh
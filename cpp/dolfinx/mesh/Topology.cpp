@@ -10,7 +10,9 @@
 #include "TopologyComputation.h"
 #include "utils.h"
 #include <algorithm>
+#include <atomic>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/common/utils.h>
 #include <dolfinx/fem/ElementDofLayout.h>
@@ -18,6 +20,8 @@
 #include <dolfinx/graph/Partitioning.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <numeric>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 
 using namespace dolfinx;
@@ -119,31 +123,12 @@ compute_index_sharing(MPI_Comm comm, std::vector<std::int64_t>& unknown_indices)
 //-----------------------------------------------------------------------------
 std::vector<bool> mesh::compute_boundary_facets(const Topology& topology)
 {
+  const std::vector<std::int32_t>& exterior = topology.exterior_facets();
   const int tdim = topology.dim();
-
-  auto facets = topology.index_map(tdim - 1);
-  if (!facets)
-    throw std::runtime_error("Facets have not been computed.");
-  std::set<std::int32_t> fwd_shared_facets;
-  if (facets->num_ghosts() == 0)
-  {
-    fwd_shared_facets = std::set<std::int32_t>(facets->shared_indices().begin(),
-                                               facets->shared_indices().end());
-  }
-
-  std::shared_ptr<const graph::AdjacencyList<std::int32_t>> fc
-      = topology.connectivity(tdim - 1, tdim);
-  if (!fc)
-    throw std::runtime_error("Facet-cell connectivity missing.");
-  std::vector<bool> _boundary_facet(facets->size_local(), false);
-  for (std::size_t f = 0; f < _boundary_facet.size(); ++f)
-  {
-    if (fc->num_links(f) == 1
-        and fwd_shared_facets.find(f) == fwd_shared_facets.end())
-    {
-      _boundary_facet[f] = true;
-    }
-  }
+  std::vector<bool> _boundary_facet(topology.index_map(tdim - 1)->size_local(),
+                                    false);
+  for (std::int32_t f : exterior)
+    _boundary_facet[f] = true;
 
   return _boundary_facet;
 }
@@ -157,6 +142,8 @@ void Topology::set_index_map(int dim,
 {
   assert(dim < (int)_index_map.size());
   _index_map[dim] = map;
+  if (dim >= this->dim() - 1)
+    _exterior_facets = nullptr;
 }
 //-----------------------------------------------------------------------------
 std::shared_ptr<const common::IndexMap> Topology::index_map(int dim) const
@@ -191,7 +178,7 @@ std::int32_t Topology::create_entities(int dim)
   return index_map->size_local();
 }
 //-----------------------------------------------------------------------------
-void Topology::create_connectivity(int d0, int d1)
+void Topology::create_connectivity(int d0, int d1, int num_threads)
 {
   // Make sure entities exist
   create_entities(d0);
@@ -199,7 +186,7 @@ void Topology::create_connectivity(int d0, int d1)
 
   // Compute connectivity
   const auto [c_d0_d1, c_d1_d0]
-      = TopologyComputation::compute_connectivity(*this, d0, d1);
+      = TopologyComputation::compute_connectivity(*this, d0, d1, num_threads);
 
   // NOTE: that to compute the (d0, d1) connections is it sometimes
   // necessary to compute the (d1, d0) connections. We store the (d1,
@@ -218,37 +205,199 @@ void Topology::create_connectivity(int d0, int d1)
     set_connectivity(c_d0_d1, d0, d1);
   if (c_d1_d0)
     set_connectivity(c_d1_d0, d1, d0);
+
+  if (_connectivity_budget > 0)
+    enforce_connectivity_budget(d0, d1);
+}
+//-----------------------------------------------------------------------------
+ScopedConnectivity::ScopedConnectivity(Topology& topology, int d0, int d1)
+    : _topology(topology), _d0(d0), _d1(d1)
+{
+  const bool c01_exists = topology.connectivity(d0, d1) != nullptr;
+  const bool c10_exists = topology.connectivity(d1, d0) != nullptr;
+  topology.create_connectivity(d0, d1);
+  _c = topology.connectivity(d0, d1);
+  if (!c01_exists)
+    _c01 = _c;
+  if (!c10_exists)
+    _c10 = topology.connectivity(d1, d0);
+}
+//-----------------------------------------------------------------------------
+ScopedConnectivity::~ScopedConnectivity()
+{
+  // Release only if the topology still holds the connectivity created
+  // here
+  if (_c01 and _topology.is_derived_connectivity(_d0, _d1)
+      and _topology.connectivity(_d0, _d1) == _c01)
+  {
+    _topology.release_connectivity(_d0, _d1);
+  }
+  if (_c10 and _topology.is_derived_connectivity(_d1, _d0)
+      and _topology.connectivity(_d1, _d0) == _c10)
+  {
+    _topology.release_connectivity(_d1, _d0);
+  }
+}
+//-----------------------------------------------------------------------------
+const graph::AdjacencyList<std::int32_t>&
+ScopedConnectivity::operator*() const
+{
+  assert(_c);
+  return *_c;
+}
+//-----------------------------------------------------------------------------
+const graph::AdjacencyList<std::int32_t>*
+ScopedConnectivity::operator->() const
+{
+  assert(_c);
+  return _c.get();
+}
+//-----------------------------------------------------------------------------
+bool Topology::is_derived_connectivity(int d0, int d1) const
+{
+  return d1 > 0 and d0 < this->dim();
+}
+//-----------------------------------------------------------------------------
+void Topology::release_connectivity(int d0, int d1)
+{
+  if (!is_derived_connectivity(d0, d1))
+  {
+    throw std::runtime_error("Connectivity " + std::to_string(d0) + "-"
+                             + std::to_string(d1)
+                             + " defines mesh entities and cannot be "
+                               "released.");
+  }
+  _connectivity(d0, d1) = nullptr;
+}
+//-----------------------------------------------------------------------------
+void Topology::release_derived_connectivity()
+{
+  for (int d0 = 0; d0 < _connectivity.rows(); ++d0)
+    for (int d1 = 0; d1 < _connectivity.cols(); ++d1)
+      if (is_derived_connectivity(d0, d1))
+        _connectivity(d0, d1) = nullptr;
+}
+//-----------------------------------------------------------------------------
+void Topology::set_connectivity_budget(std::size_t bytes)
+{
+  _connectivity_budget = bytes;
+}
+//-----------------------------------------------------------------------------
+void Topology::enforce_connectivity_budget(int d0, int d1)
+{
+  // Collect derived connectivities that may be released
+  std::size_t bytes = 0;
+  std::vector<std::tuple<std::size_t, int, int>> candidates;
+  for (int i = 0; i < _connectivity.rows(); ++i)
+  {
+    for (int j = 0; j < _connectivity.cols(); ++j)
+    {
+      if (_connectivity(i, j) and is_derived_connectivity(i, j))
+      {
+        const std::size_t c_bytes = _connectivity(i, j)->memory_usage();
+        bytes += c_bytes;
+        if (i != d0 or j != d1)
+          candidates.emplace_back(c_bytes, i, j);
+      }
+    }
+  }
+
+  // Release largest first
+  std::sort(candidates.rbegin(), candidates.rend());
+  for (auto [c_bytes, i, j] : candidates)
+  {
+    if (bytes <= _connectivity_budget)
+      break;
+    LOG(INFO) << "Release connectivity " << i << " - " << j
+              << " (connectivity budget)";
+    _connectivity(i, j) = nullptr;
+    bytes -= c_bytes;
+  }
 }
 //-----------------------------------------------------------------------------
 void Topology::create_entity_permutations()
+{
+  create_cell_permutation_info();
+  create_facet_permutations();
+}
+//-----------------------------------------------------------------------------
+void Topology::create_cell_permutation_info()
 {
   if (_cell_permutations.size() > 0)
     return;
 
-  const int tdim = this->dim();
-
   // FIXME: Is this always required? Could it be made cheaper by doing a
   // local version? This call does quite a lot of parallel work
   // Create all mesh entities
-  for (int d = 0; d < tdim; ++d)
+  for (int d = 0; d < this->dim(); ++d)
     create_entities(d);
 
-  auto [facet_permutations, cell_permutations]
-      = PermutationComputation::compute_entity_permutations(*this);
-  _facet_permutations = std::move(facet_permutations);
-  _cell_permutations = std::move(cell_permutations);
+  _cell_permutations
+      = PermutationComputation::compute_cell_permutation_info(*this);
 }
 //-----------------------------------------------------------------------------
-void Topology::create_connectivity_all()
+void Topology::create_facet_permutations()
+{
+  if (_facet_permutations.size() > 0)
+    return;
+
+  if (_cell_permutations.size() > 0)
+  {
+    // The facet data is contained in the cell data
+    _facet_permutations = PermutationComputation::unpack_facet_permutations(
+        _cell_type, _cell_permutations);
+    return;
+  }
+
+  const int tdim = this->dim();
+  create_entities(tdim - 1);
+  _facet_permutations
+      = PermutationComputation::compute_facet_permutations(*this);
+}
+//-----------------------------------------------------------------------------
+void Topology::create_connectivity_all(int num_threads)
 {
   // Compute all entities
   for (int d = 0; d <= dim(); d++)
     create_entities(d);
 
-  // Compute all connectivity
-  for (int d0 = 0; d0 <= dim(); d0++)
-    for (int d1 = 0; d1 <= dim(); d1++)
-      create_connectivity(d0, d1);
+  // Compute missing connectivities d0 -> d1 for d0 >= d1 (round 0),
+  // then for d0 < d1 by transposition of d1 -> d0 (round 1). The tasks
+  // within a round only read the topology, and the results are
+  // attached after the round.
+  for (int round = 0; round < 2; ++round)
+  {
+    std::vector<std::array<int, 2>> tasks;
+    for (int d0 = 0; d0 <= dim(); d0++)
+      for (int d1 = 0; d1 <= dim(); d1++)
+        if (((d0 >= d1) == (round == 0)) and !connectivity(d0, d1))
+          tasks.push_back({d0, d1});
+
+    std::vector<std::shared_ptr<graph::AdjacencyList<std::int32_t>>> c(
+        tasks.size());
+    std::atomic<std::size_t> next(0);
+    auto compute = [&]() {
+      for (std::size_t i = next++; i < tasks.size(); i = next++)
+      {
+        c[i] = TopologyComputation::compute_connectivity(
+            *this, tasks[i][0], tasks[i][1], num_threads)[0];
+      }
+    };
+
+    const int n = std::max(1, std::min<int>(num_threads, tasks.size()));
+    std::vector<std::thread> threads;
+    for (int i = 1; i < n; ++i)
+      threads.emplace_back(compute);
+    compute();
+    for (auto& t : threads)
+      t.join();
+
+    for (std::size_t i = 0; i < tasks.size(); ++i)
+      set_connectivity(c[i], tasks[i][0], tasks[i][1]);
+  }
+
+  if (_connectivity_budget > 0)
+    enforce_connectivity_budget(-1, -1);
 }
 //-----------------------------------------------------------------------------
 std::shared_ptr<const graph::AdjacencyList<std::int32_t>>
@@ -265,13 +414,82 @@ void Topology::set_connectivity(
   assert(d0 < _connectivity.rows());
   assert(d1 < _connectivity.cols());
   _connectivity(d0, d1) = c;
+
+  // Facets or cells redefined
+  if ((d0 == this->dim() - 1 and d1 == 0) or (d0 == this->dim() and d1 == 0))
+    _exterior_facets = nullptr;
+
+  // Cells redefined
+  if (d0 == this->dim() and d1 == 0)
+    _hash.reset();
+}
+//-----------------------------------------------------------------------------
+const std::vector<std::int32_t>& Topology::exterior_facets() const
+{
+  if (_exterior_facets)
+    return *_exterior_facets;
+
+  const int tdim = this->dim();
+  auto facet_map = this->index_map(tdim - 1);
+  if (!facet_map)
+    throw std::runtime_error("Facets have not been computed.");
+  // Number of cells of each facet, counted from the cell-facet
+  // connectivity if the facet-cell connectivity is missing
+  std::shared_ptr<const graph::AdjacencyList<std::int32_t>> fc
+      = this->connectivity(tdim - 1, tdim);
+  std::vector<std::int32_t> num_cells;
+  if (!fc)
+  {
+    std::shared_ptr<const graph::AdjacencyList<std::int32_t>> cf
+        = this->connectivity(tdim, tdim - 1);
+    if (!cf)
+      throw std::runtime_error("Facet-cell connectivity missing.");
+    num_cells = TopologyComputation::compute_transpose_num_links(
+        *cf, facet_map->size_local() + facet_map->num_ghosts());
+  }
+
+  // Only need to consider shared facets when there are no ghost cells
+  std::vector<bool> fwd_shared(facet_map->size_local(), false);
+  if (auto cell_map = this->index_map(tdim);
+      !cell_map or cell_map->num_ghosts() == 0)
+  {
+    for (std::int32_t f : facet_map->shared_indices())
+      fwd_shared[f] = true;
+  }
+
+  // All owned facets connected to one cell that are not shared are
+  // exterior
+  auto facets = std::make_shared<std::vector<std::int32_t>>();
+  for (std::int32_t f = 0; f < facet_map->size_local(); ++f)
+    if ((fc ? fc->num_links(f) : num_cells[f]) == 1 and !fwd_shared[f])
+      facets->push_back(f);
+
+  _exterior_facets = facets;
+  return *_exterior_facets;
 }
 //-----------------------------------------------------------------------------
 size_t Topology::hash() const
 {
-  if (!this->connectivity(dim(), 0))
-    throw std::runtime_error("AdjacencyList has not been computed.");
-  return this->connectivity(dim(), 0)->hash();
+  if (!_hash)
+  {
+    if (!this->connectivity(dim(), 0))
+      throw std::runtime_error("AdjacencyList has not been computed.");
+    _hash = this->connectivity(dim(), 0)->hash();
+  }
+  return *_hash;
+}
+//-----------------------------------------------------------------------------
+std::size_t Topology::memory_usage() const
+{
+  std::size_t bytes = _facet_permutations.size() * sizeof(std::uint8_t)
+                      + _cell_permutations.size() * sizeof(std::uint32_t);
+  for (const auto& map : _index_map)
+    if (map)
+      bytes += map->memory_usage();
+  for (Eigen::Index i = 0; i < _connectivity.size(); ++i)
+    if (_connectivity(i))
+      bytes += _connectivity(i)->memory_usage();
+  return bytes;
 }
 //-----------------------------------------------------------------------------
 const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>&
@@ -280,7 +498,8 @@ Topology::get_cell_permutation_info() const
   if (_cell_permutations.size() == 0)
   {
     throw std::runtime_error(
-        "create_entity_permutations must be called before using this data.");
+        "create_cell_permutation_info must be called before using this "
+        "data.");
   }
   return _cell_permutations;
 }
@@ -288,10 +507,10 @@ Topology::get_cell_permutation_info() const
 const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>&
 Topology::get_facet_permutations() const
 {
-  if (_cell_permutations.size() == 0)
+  if (_facet_permutations.size() == 0)
   {
     throw std::runtime_error(
-        "create_entity_permutations must be called before using this data.");
+        "create_facet_permutations must be called before using this data.");
   }
   return _facet_permutations;
 }
@@ -308,6 +527,7 @@ mesh::create_topology(MPI_Comm comm,
                       const CellType& cell_type, mesh::GhostMode ghost_mode)
 {
   LOG(INFO) << "Create topology";
+  common::Timer timer("Create topology");
 
   if (cells.num_nodes() > 0
       and cells.num_links(0) != mesh::num_cell_vertices(cell_type))
@@ -407,10 +627,20 @@ mesh::create_topology(MPI_Comm comm,
   // Get global offset for local indices
   std::int64_t global_offset = dolfinx::MPI::global_offset(comm, nlocal, true);
 
-  // Find all vertex-sharing neighbors, and process-to-neighbor map
+  // Find all vertex-sharing neighbors, and process-to-neighbor map.
+  // With more than one layer of ghost cells, a process that shares
+  // cells with this process need not share a vertex with it, and the
+  // cell-sharing processes are also neighbors.
   std::set<int> vertex_neighbors;
   for (auto q : global_to_procs)
     vertex_neighbors.insert(q.second.begin(), q.second.end());
+  if (ghost_mode != mesh::GhostMode::none)
+  {
+    const auto& cell_ranks = index_map_c->shared_index_ranks().ranks.array();
+    vertex_neighbors.insert(cell_ranks.data(),
+                            cell_ranks.data() + cell_ranks.rows());
+    vertex_neighbors.insert(ghost_owners.begin(), ghost_owners.end());
+  }
   vertex_neighbors.erase(mpi_rank);
   std::vector<int> neighbors(vertex_neighbors.begin(), vertex_neighbors.end());
   std::unordered_map<int, int> proc_to_neighbors;
@@ -475,24 +705,22 @@ mesh::create_topology(MPI_Comm comm,
     // Receive index of ghost vertices that are not on the process
     // boundary from the ghost cell owner. Note: the ghost cell owner
     // might not be the same as the vertex owner.
-    std::map<std::int32_t, std::set<std::int32_t>> shared_cells
-        = index_map_c->compute_shared_indices();
     std::map<std::int64_t, std::set<std::int32_t>> fwd_shared_vertices;
-    for (int i = 0; i < index_map_c->size_local(); ++i)
+    const common::IndexMap::SharedIndices& shared_cells
+        = index_map_c->shared_index_ranks();
+    for (std::size_t k = 0; k < shared_cells.indices.size(); ++k)
     {
-      if (auto it = shared_cells.find(i); it != shared_cells.end())
+      // Shared indices are sorted, with ghosts after owned indices
+      const std::int32_t i = shared_cells.indices[k];
+      if (i >= index_map_c->size_local())
+        break;
+
+      auto ranks = shared_cells.ranks.links(k);
+      auto v = cells.links(i);
+      for (int j = 0; j < v.size(); ++j)
       {
-        auto v = cells.links(i);
-        for (int j = 0; j < v.size(); ++j)
-        {
-          if (auto vit = fwd_shared_vertices.find(v[j]);
-              vit == fwd_shared_vertices.end())
-          {
-            fwd_shared_vertices.insert({v[j], it->second});
-          }
-          else
-            vit->second.insert(it->second.begin(), it->second.end());
-        }
+        fwd_shared_vertices[v[j]].insert(ranks.data(),
+                                         ranks.data() + ranks.rows());
       }
     }
 
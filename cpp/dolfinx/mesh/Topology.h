@@ -11,7 +11,9 @@
 #include <array>
 #include <cstdint>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/UniqueIdGenerator.h>
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace dolfinx
@@ -41,7 +43,8 @@ class Topology;
 
 /// Compute marker for owned facets that are on the exterior of the
 /// domain, i.e. are connected to only one cell. The function does not
-/// require parallel communication.
+/// require parallel communication. The marker is built from the cached
+/// Topology::exterior_facets.
 /// @param[in] topology The topology
 /// @return Vector with length equal to the number of owned facets on
 ///   this this process. True if the ith facet (local index) is on the
@@ -110,7 +113,8 @@ public:
   void set_connectivity(std::shared_ptr<graph::AdjacencyList<std::int32_t>> c,
                         int d0, int d1);
 
-  /// Returns the permutation information
+  /// Returns the permutation information. It must have been computed
+  /// with create_cell_permutation_info or create_entity_permutations.
   const Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>&
   get_cell_permutation_info() const;
 
@@ -121,22 +125,40 @@ public:
   ///   - `n // 2` gives the number of rotations to apply
   ///
   /// Each column of the returned array represents a cell, and each row
-  /// a facet of that cell.
+  /// a facet of that cell. The permutations must have been computed
+  /// with create_facet_permutations or create_entity_permutations.
   /// @return The permutation number
   const Eigen::Array<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic>&
   get_facet_permutations() const;
 
-  /// Return hash based on the hash of cell-vertex connectivity
+  /// Owned facets on the exterior of the domain, i.e. facets that are
+  /// connected to only one cell and, if there are no ghost cells, are
+  /// not shared with another process. The list is computed on the first
+  /// call and cached until the facets or cells are redefined. The call
+  /// is not thread-safe when the list is computed.
+  /// If the facet-cell connectivity has not been computed, the number
+  /// of cells of each facet is counted from the cell-facet
+  /// connectivity, without computing the facet-cell connectivity.
+  /// @return Sorted local indices of the exterior facets
+  /// @throws std::runtime_error if the facets or both the facet-cell
+  ///   and cell-facet connectivities have not been computed
+  const std::vector<std::int32_t>& exterior_facets() const;
+
+  /// Return hash based on the hash of cell-vertex connectivity on this
+  /// process. The hash is computed on the first call and cached until
+  /// the cell-vertex connectivity is set (see set_connectivity). The
+  /// call is not thread-safe when the hash is computed.
   size_t hash() const;
 
+  /// Memory used by the connectivities, the index maps and the entity
+  /// permutation data. See mesh::memory_usage for a break-down.
+  /// @return Memory usage in bytes
+  std::size_t memory_usage() const;
+
   /// Cell type
   /// @return Cell type that the topology is for
   mesh::CellType cell_type() const;
 
-  // TODO: Rework memory management and associated API
-  // Currently, there is no clear caching policy implemented and no way of
-  // discarding cached data.
-
   // creation of entities
   /// Create entities of given topological dimension.
   /// @param[in] dim Topological dimension
@@ -144,28 +166,92 @@ public:
   ///   already existed
   std::int32_t create_entities(int dim);
 
-  /// Create connectivity between given pair of dimensions, d0 -> d1
+  /// Create connectivity between given pair of dimensions, d0 -> d1.
+  /// If a connectivity budget is set (see set_connectivity_budget),
+  /// other derived connectivities may be released afterwards.
+  /// @param[in] d0 Topological dimension
+  /// @param[in] d1 Topological dimension
+  /// @param[in] num_threads Number of threads used to compute the
+  ///   connectivity
+  void create_connectivity(int d0, int d1, int num_threads = 1);
+
+  /// Check if the connectivity d0 -> d1 is derived data, i.e. can be
+  /// released and re-computed by create_connectivity with the same
+  /// entity numbering. The entity-vertex (d, 0) and cell-entity (tdim,
+  /// d) connectivities define the entities and are not derived.
   /// @param[in] d0 Topological dimension
   /// @param[in] d1 Topological dimension
-  void create_connectivity(int d0, int d1);
+  /// @return True if the connectivity is derived
+  bool is_derived_connectivity(int d0, int d1) const;
 
-  /// Compute entity permutations and reflections
+  /// Release the connectivity d0 -> d1 held by the topology. Data
+  /// that is still held by the caller remains valid. The connectivity
+  /// can be re-computed by create_connectivity.
+  /// @param[in] d0 Topological dimension
+  /// @param[in] d1 Topological dimension
+  /// @throws std::runtime_error if the connectivity is not derived
+  ///   (see is_derived_connectivity)
+  void release_connectivity(int d0, int d1);
+
+  /// Release all derived connectivities (see is_derived_connectivity)
+  void release_derived_connectivity();
+
+  /// Set an upper bound for the memory held by derived connectivities
+  /// (see is_derived_connectivity). When create_connectivity takes the
+  /// derived connectivities above the budget, the largest of them,
+  /// other than the requested connectivity, are released until the
+  /// budget is met.
+  /// @param[in] bytes The budget in bytes. Zero means no limit (the
+  ///   default).
+  void set_connectivity_budget(std::size_t bytes);
+
+  /// Compute entity permutations and reflections, i.e. both the cell
+  /// permutation info and the facet permutations
   void create_entity_permutations();
 
-  /// Compute all entities and connectivity
-  void create_connectivity_all();
+  /// Compute the cell permutation info (see get_cell_permutation_info)
+  /// if it has not already been computed. All entities of dimension
+  /// 0 < d < tdim are created (collective).
+  void create_cell_permutation_info();
+
+  /// Compute the facet permutations (see get_facet_permutations) if
+  /// they have not already been computed. Only the facets are created
+  /// (collective), and if the cell permutation info is available the
+  /// facet permutations are extracted from it.
+  void create_facet_permutations();
+
+  /// Compute all entities and connectivity. The entities are created
+  /// first (collective). The connectivities are then computed in two
+  /// rounds of independent, process-local tasks: first the
+  /// connectivities from higher to lower (or equal) dimension, then
+  /// their transposes. The tasks of each round are executed
+  /// concurrently on @p num_threads threads, and each task may use up
+  /// to @p num_threads threads of the thread pool.
+  /// @param[in] num_threads Number of threads
+  void create_connectivity_all(int num_threads = 1);
 
   /// Mesh MPI communicator
   /// @return The communicator on which the topology is distributed
   MPI_Comm mpi_comm() const;
 
+  /// Get unique identifier for the topology
+  /// @returns The unique identifier associated with the object
+  std::size_t id() const { return _unique_id; }
+
 private:
+  // Release derived connectivities (largest first), except d0 -> d1,
+  // until the memory they use is within the budget
+  void enforce_connectivity_budget(int d0, int d1);
+
   // MPI communicator
   dolfinx::MPI::Comm _mpi_comm;
 
   // Cell type
   mesh::CellType _cell_type;
 
+  // Unique identifier
+  std::size_t _unique_id = common::UniqueIdGenerator::id();
+
   // IndexMap to store ghosting for each entity dimension
   std::array<std::shared_ptr<const common::IndexMap>, 4> _index_map;
 
@@ -181,6 +267,57 @@ private:
   // Cell permutation info. See the documentation for
   // get_cell_permutation_info for documentation of how this is encoded.
   Eigen::Array<std::uint32_t, Eigen::Dynamic, 1> _cell_permutations;
+
+  // Memory budget (bytes) for derived connectivities, 0 if unlimited
+  std::size_t _connectivity_budget = 0;
+
+  // Cache of exterior facets (see exterior_facets), nullptr if not
+  // computed
+  mutable std::shared_ptr<const std::vector<std::int32_t>> _exterior_facets;
+
+  // Cache of the hash of the cell-vertex connectivity (see hash)
+  mutable std::optional<std::size_t> _hash;
+};
+
+/// Connectivity that is computed for the lifetime of a scope ("compute,
+/// use, drop"). The constructor creates the connectivity d0 -> d1 if
+/// it does not exist. On destruction, the connectivities that were
+/// created by the constructor are released from the topology if they
+/// are derived (see Topology::is_derived_connectivity).
+class ScopedConnectivity
+{
+public:
+  /// Create the connectivity d0 -> d1 for the lifetime of the object
+  /// @param[in,out] topology The topology. It must outlive the object.
+  /// @param[in] d0 Topological dimension
+  /// @param[in] d1 Topological dimension
+  ScopedConnectivity(Topology& topology, int d0, int d1);
+
+  /// Copy constructor
+  ScopedConnectivity(const ScopedConnectivity& c) = delete;
+
+  /// Assignment
+  ScopedConnectivity& operator=(const ScopedConnectivity& c) = delete;
+
+  /// Destructor. Releases the connectivities created by the constructor.
+  ~ScopedConnectivity();
+
+  /// The connectivity d0 -> d1
+  const graph::AdjacencyList<std::int32_t>& operator*() const;
+
+  /// The connectivity d0 -> d1
+  const graph::AdjacencyList<std::int32_t>* operator->() const;
+
+private:
+  Topology& _topology;
+  int _d0, _d1;
+
+  // Connectivities d0 -> d1 and d1 -> d0 that were created by this
+  // object (nullptr if they existed before)
+  std::shared_ptr<const graph::AdjacencyList<std::int32_t>> _c01, _c10;
+
+  // Connectivity d0 -> d1
+  std::shared_ptr<const graph::AdjacencyList<std::int32_t>> _c;
 };
 
 /// Create distributed topology
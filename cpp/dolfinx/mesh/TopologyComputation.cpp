@@ -13,10 +13,12 @@
 #include <cstdint>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/ThreadPool.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/common/utils.h>
 #include <dolfinx/graph/AdjacencyList.h>
+#include <functional>
 #include <memory>
 #include <numeric>
 #include <random>
@@ -49,32 +51,59 @@ int get_ownership(std::set<int>& processes, std::vector<std::int64_t>& vertices)
   return owner;
 }
 
-/// Takes an array and computes the sort permutation that would reorder
-/// the rows in ascending order
+/// Number the distinct rows of an array in order of first appearance,
+/// using an open addressing hash table of the rows. The cost is linear
+/// in the number of rows, and the table holds one row index per slot.
 /// @param[in] array The input array
-/// @return The permutation vector that would order the rows in
-///   ascending order
+/// @return The number of each row, and the number of distinct rows
 /// @pre Each row of @p array must be sorted
-template <typename T>
-std::vector<int>
-sort_by_perm(const Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic,
-                                Eigen::RowMajor>& array)
+std::pair<std::vector<std::int32_t>, std::int32_t>
+number_unique_rows(const Eigen::Array<std::int32_t, Eigen::Dynamic,
+                                      Eigen::Dynamic, Eigen::RowMajor>& array)
 {
-  // Sort an Eigen::Array by creating a permutation vector
-  std::vector<int> index(array.rows());
-  std::iota(index.begin(), index.end(), 0);
+  const std::int32_t num_rows = array.rows();
   const int cols = array.cols();
 
-  // Lambda with capture for sort comparison
-  const auto cmp = [&array, &cols](int a, int b) {
-    const T* row_a = array.row(a).data();
-    const T* row_b = array.row(b).data();
-    return std::lexicographical_compare(row_a, row_a + cols, row_b,
-                                        row_b + cols);
-  };
+  // Table with a power of two number of slots, at most half full. Each
+  // slot holds the index of the first row with the key, or -1.
+  std::size_t table_size = 1;
+  while (table_size < 2 * static_cast<std::size_t>(num_rows))
+    table_size *= 2;
+  const std::size_t mask = table_size - 1;
+  std::vector<std::int32_t> table(table_size, -1);
+
+  std::vector<std::int32_t> index(num_rows);
+  std::int32_t count = 0;
+  for (std::int32_t i = 0; i < num_rows; ++i)
+  {
+    const std::int32_t* row = array.row(i).data();
+    std::uint64_t h = 0;
+    for (int j = 0; j < cols; ++j)
+    {
+      h ^= static_cast<std::uint32_t>(row[j]);
+      h *= 0x9e3779b97f4a7c15;
+      h ^= h >> 32;
+    }
+
+    // Linear probing
+    for (std::size_t s = h & mask;; s = (s + 1) & mask)
+    {
+      const std::int32_t first = table[s];
+      if (first == -1)
+      {
+        table[s] = i;
+        index[i] = count++;
+        break;
+      }
+      else if (std::equal(row, row + cols, array.row(first).data()))
+      {
+        index[i] = index[first];
+        break;
+      }
+    }
+  }
 
-  std::sort(index.begin(), index.end(), cmp);
-  return index;
+  return {std::move(index), count};
 }
 //-----------------------------------------------------------------------------
 
@@ -150,12 +179,12 @@ get_local_indexing(
 
   //---------
   // Create an expanded neighbor_comm from shared_vertices
-  const std::map<std::int32_t, std::set<std::int32_t>> shared_vertices
-      = vertex_indexmap->compute_shared_indices();
+  const common::IndexMap::SharedIndices& shared_vertices
+      = vertex_indexmap->shared_index_ranks();
 
-  std::set<std::int32_t> neighbor_set;
-  for (auto& q : shared_vertices)
-    neighbor_set.insert(q.second.begin(), q.second.end());
+  const auto& vertex_ranks = shared_vertices.ranks.array();
+  std::set<std::int32_t> neighbor_set(vertex_ranks.data(),
+                                      vertex_ranks.data() + vertex_ranks.rows());
   std::vector<std::int32_t> neighbors(neighbor_set.begin(), neighbor_set.end());
   MPI_Comm neighbor_comm;
   MPI_Dist_graph_create_adjacent(comm, neighbors.size(), neighbors.data(),
@@ -189,10 +218,11 @@ get_local_indexing(
     for (int j = 0; j < num_vertices; ++j)
     {
       const int v = entity_list(i, j);
-      if (auto it = shared_vertices.find(v); it != shared_vertices.end())
+      if (const std::int32_t pos = shared_vertices.find(v); pos != -1)
       {
-        for (std::int32_t p : it->second)
-          ++procs[p];
+        auto ranks = shared_vertices.ranks.links(pos);
+        for (int k = 0; k < ranks.rows(); ++k)
+          ++procs[ranks[k]];
       }
     }
 
@@ -465,9 +495,6 @@ compute_entities_by_key_matching(
   }
   assert(k == entity_list.rows());
 
-  std::vector<std::int32_t> entity_index(entity_list.rows());
-  std::int32_t entity_count = 0;
-
   // Copy list and sort vertices of each entity into order
   Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
       entity_list_sorted = entity_list;
@@ -477,19 +504,9 @@ compute_entities_by_key_matching(
               entity_list_sorted.row(i).data() + num_vertices_per_entity);
   }
 
-  // Sort the list and label uniquely
-  const std::vector sort_order = sort_by_perm<std::int32_t>(entity_list_sorted);
-  std::int32_t last = sort_order[0];
-  entity_index[last] = 0;
-  for (std::size_t i = 1; i < sort_order.size(); ++i)
-  {
-    std::int32_t j = sort_order[i];
-    if ((entity_list_sorted.row(j) != entity_list_sorted.row(last)).any())
-      ++entity_count;
-    entity_index[j] = entity_count;
-    last = j;
-  }
-  ++entity_count;
+  // Label the entities uniquely
+  const auto [entity_index, entity_count]
+      = number_unique_rows(entity_list_sorted);
 
   // Communicate with other processes to find out which entities are
   // ghosted and shared. Remap the numbering so that ghosts are at the
@@ -518,45 +535,90 @@ compute_entities_by_key_matching(
 }
 //-----------------------------------------------------------------------------
 
+/// Count the connections of each d0 entity in the (d1 -> d0)
+/// connectivity, for each of num_chunks contiguous chunks of d1
+/// entities (per-chunk histograms). The chunks are processed
+/// concurrently, and are the chunks of common::parallel_for.
+/// @param[in] c_d1_d0 The connectivity from entities of dimension d1 to
+///   entities of dimension d0
+/// @param[in] num_entities_d0 The number of entities of dimension d0
+/// @param[in] num_chunks The number of chunks
+/// @return The number of connections of each d0 entity (inner index)
+///   in each chunk (outer index)
+std::vector<std::vector<std::int32_t>>
+count_transpose_links(const graph::AdjacencyList<std::int32_t>& c_d1_d0,
+                      std::int32_t num_entities_d0, int num_chunks)
+{
+  std::vector<std::vector<std::int32_t>> counts(num_chunks);
+  common::parallel_for(
+      num_chunks, c_d1_d0.num_nodes(),
+      [&](int t, std::int32_t e1_0, std::int32_t e1_1) {
+        std::vector<std::int32_t>& count = counts[t];
+        count.assign(num_entities_d0, 0);
+        for (std::int32_t e1 = e1_0; e1 < e1_1; ++e1)
+        {
+          auto e = c_d1_d0.links(e1);
+          for (int i = 0; i < e.rows(); ++i)
+            ++count[e[i]];
+        }
+      });
+
+  return counts;
+}
+//-----------------------------------------------------------------------------
+
 /// Compute connectivity from entities of dimension d0 to entities of
-/// dimension d1 using the transpose connectivity (d1 -> d0)
+/// dimension d1 using the transpose connectivity (d1 -> d0). This is a
+/// counting sort of the connections by d0 entity, with the d1 entities
+/// divided into contiguous chunks that are processed concurrently. The
+/// links of each d0 entity are sorted.
 /// @param[in] c_d1_d0 The connectivity from entities of dimension d1 to
 ///   entities of dimension d0
 /// @param[in] num_entities_d0 The number of entities of dimension d0
+/// @param[in] num_threads The number of threads
 /// @return The connectivity from entities of dimension d0 to entities
 ///   of dimension d1
 graph::AdjacencyList<std::int32_t>
 compute_from_transpose(const graph::AdjacencyList<std::int32_t>& c_d1_d0,
-                       const int num_entities_d0, int d0, int d1)
+                       const int num_entities_d0, int d0, int d1,
+                       int num_threads)
 {
   LOG(INFO) << "Computing mesh connectivity " << d0 << " - " << d1
             << "from transpose.";
 
-  // Compute number of connections for each e0
-  std::vector<std::int32_t> num_connections(num_entities_d0, 0);
-  for (int e1 = 0; e1 < c_d1_d0.num_nodes(); ++e1)
+  // Count number of connections for each e0 in each chunk of e1
+  const int num_chunks
+      = std::max(1, std::min(num_threads, c_d1_d0.num_nodes()));
+  std::vector<std::vector<std::int32_t>> pos
+      = count_transpose_links(c_d1_d0, num_entities_d0, num_chunks);
+
+  // Compute offsets, and replace the count of each chunk by the
+  // position of its first connection in the links of e0
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets(num_entities_d0 + 1);
+  offsets[0] = 0;
+  for (std::int32_t e0 = 0; e0 < num_entities_d0; ++e0)
   {
-    auto e = c_d1_d0.links(e1);
-    for (int i = 0; i < e.rows(); ++i)
-      num_connections[e[i]]++;
+    std::int32_t offset = offsets[e0];
+    for (int t = 0; t < num_chunks; ++t)
+      offset += std::exchange(pos[t][e0], offset);
+    offsets[e0 + 1] = offset;
   }
 
-  // Compute offsets
-  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets
-      = Eigen::Array<std::int32_t, Eigen::Dynamic, 1>::Zero(
-          num_connections.size() + 1);
-  std::partial_sum(num_connections.begin(), num_connections.end(),
-                   offsets.data() + 1);
-
-  std::vector<std::int32_t> counter(num_connections.size(), 0);
+  // Fill connections, with the chunks in the same order as when
+  // counting
   Eigen::Array<std::int32_t, Eigen::Dynamic, 1> connections(
-      offsets[offsets.rows() - 1]);
-  for (int e1 = 0; e1 < c_d1_d0.num_nodes(); ++e1)
-  {
-    auto e = c_d1_d0.links(e1);
-    for (int e0 = 0; e0 < e.rows(); ++e0)
-      connections[offsets[e[e0]] + counter[e[e0]]++] = e1;
-  }
+      offsets[num_entities_d0]);
+  common::parallel_for(
+      num_chunks, c_d1_d0.num_nodes(),
+      [&](int t, std::int32_t e1_0, std::int32_t e1_1) {
+        std::vector<std::int32_t>& p = pos[t];
+        for (std::int32_t e1 = e1_0; e1 < e1_1; ++e1)
+        {
+          auto e = c_d1_d0.links(e1);
+          for (int i = 0; i < e.rows(); ++i)
+            connections[p[e[i]]++] = e1;
+        }
+      });
 
   return graph::AdjacencyList<std::int32_t>(std::move(connections),
                                             std::move(offsets));
@@ -569,11 +631,13 @@ compute_from_transpose(const graph::AdjacencyList<std::int32_t>& c_d1_d0,
 /// @param[in] cell_type_d0 The cell type for entities of dimension d0
 /// @param[in] d0 Topological dimension
 /// @param[in] d1 Topological dimension
+/// @param[in] num_threads The number of threads used to look up the d1
+///   entities of the d0 entities
 /// @return The d0 -> d1 connectivity
 graph::AdjacencyList<std::int32_t>
 compute_from_map(const graph::AdjacencyList<std::int32_t>& c_d0_0,
                  const graph::AdjacencyList<std::int32_t>& c_d1_0,
-                 CellType cell_type_d0, int d0, int d1)
+                 CellType cell_type_d0, int d0, int d1, int num_threads)
 {
   assert(d1 > 0);
   assert(d0 > d1);
@@ -594,37 +658,44 @@ compute_from_map(const graph::AdjacencyList<std::int32_t>& c_d0_0,
     entity_to_index.insert({key, e});
   }
 
-  Eigen::Array<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      connections(c_d0_0.num_nodes(),
-                  mesh::cell_num_entities(cell_type_d0, d1));
+  const int num_entities_d0 = mesh::cell_num_entities(cell_type_d0, d1);
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> connections(
+      c_d0_0.num_nodes() * num_entities_d0);
 
-  // Search for d1 entities of d0 in map, and recover index
-  std::vector<std::int32_t> entities;
+  // Search for d1 entities of d0 in map, and recover index. The map is
+  // only read, and chunks of d0 entities are processed concurrently.
   const Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
       e_vertices_ref = mesh::get_entity_vertices(cell_type_d0, d1);
-  Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> keys
-      = e_vertices_ref;
-  for (int e = 0; e < c_d0_0.num_nodes(); ++e)
-  {
-    entities.clear();
-    auto e0 = c_d0_0.links(e);
-    for (Eigen::Index i = 0; i < e_vertices_ref.rows(); ++i)
-      for (Eigen::Index j = 0; j < e_vertices_ref.cols(); ++j)
-        keys(i, j) = e0[e_vertices_ref(i, j)];
-    for (Eigen::Index i = 0; i < keys.rows(); ++i)
-    {
-      std::partial_sort_copy(keys.row(i).data(),
-                             keys.row(i).data() + keys.row(i).cols(),
-                             key.begin(), key.end());
-      const auto it = entity_to_index.find(key);
-      assert(it != entity_to_index.end());
-      entities.push_back(it->second);
-    }
-    for (std::size_t k = 0; k < entities.size(); ++k)
-      connections(e, k) = entities[k];
-  }
+  common::parallel_for(
+      num_threads, c_d0_0.num_nodes(),
+      [&](int, std::int32_t e_0, std::int32_t e_1) {
+        std::vector<std::int32_t> search_key(num_verts_d1);
+        Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+            keys = e_vertices_ref;
+        for (std::int32_t e = e_0; e < e_1; ++e)
+        {
+          auto e0 = c_d0_0.links(e);
+          for (Eigen::Index i = 0; i < e_vertices_ref.rows(); ++i)
+            for (Eigen::Index j = 0; j < e_vertices_ref.cols(); ++j)
+              keys(i, j) = e0[e_vertices_ref(i, j)];
+          for (Eigen::Index i = 0; i < keys.rows(); ++i)
+          {
+            std::partial_sort_copy(keys.row(i).data(),
+                                   keys.row(i).data() + keys.row(i).cols(),
+                                   search_key.begin(), search_key.end());
+            const auto it = entity_to_index.find(search_key);
+            assert(it != entity_to_index.end());
+            connections[e * num_entities_d0 + i] = it->second;
+          }
+        }
+      });
 
-  return graph::AdjacencyList<std::int32_t>(connections);
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets(c_d0_0.num_nodes()
+                                                        + 1);
+  for (Eigen::Index e = 0; e < offsets.rows(); ++e)
+    offsets[e] = e * num_entities_d0;
+  return graph::AdjacencyList<std::int32_t>(std::move(connections),
+                                            std::move(offsets));
 }
 //-----------------------------------------------------------------------------
 } // namespace
@@ -676,7 +747,7 @@ TopologyComputation::compute_entities(MPI_Comm comm, const Topology& topology,
 //-----------------------------------------------------------------------------
 std::array<std::shared_ptr<graph::AdjacencyList<std::int32_t>>, 2>
 TopologyComputation::compute_connectivity(const Topology& topology, int d0,
-                                          int d1)
+                                          int d1, int num_threads)
 {
   LOG(INFO) << "Requesting connectivity " << d0 << " - " << d1;
 
@@ -720,9 +791,10 @@ TopologyComputation::compute_connectivity(const Topology& topology, int d0,
       auto c_d1_d0 = std::make_shared<graph::AdjacencyList<std::int32_t>>(
           compute_from_map(*c_d1_0, *c_d0_0,
                            mesh::cell_entity_type(topology.cell_type(), d1), d1,
-                           d0));
+                           d0, num_threads));
       auto c_d0_d1 = std::make_shared<graph::AdjacencyList<std::int32_t>>(
-          compute_from_transpose(*c_d1_d0, c_d0_0->num_nodes(), d0, d1));
+          compute_from_transpose(*c_d1_d0, c_d0_0->num_nodes(), d0, d1,
+                                 num_threads));
       return {c_d0_d1, c_d1_d0};
     }
     else
@@ -731,7 +803,7 @@ TopologyComputation::compute_connectivity(const Topology& topology, int d0,
       assert(topology.connectivity(d1, d0));
       auto c_d0_d1 = std::make_shared<graph::AdjacencyList<std::int32_t>>(
           compute_from_transpose(*topology.connectivity(d1, d0),
-                                 c_d0_0->num_nodes(), d0, d1));
+                                 c_d0_0->num_nodes(), d0, d1, num_threads));
       return {c_d0_d1, nullptr};
     }
   }
@@ -742,10 +814,27 @@ TopologyComputation::compute_connectivity(const Topology& topology, int d0,
     auto c_d0_d1
         = std::make_shared<graph::AdjacencyList<std::int32_t>>(compute_from_map(
             *c_d0_0, *c_d1_0, mesh::cell_entity_type(topology.cell_type(), d0),
-            d0, d1));
+            d0, d1, num_threads));
     return {c_d0_d1, nullptr};
   }
   else
     throw std::runtime_error("Entity dimension error when computing topology.");
 }
+//-----------------------------------------------------------------------------
+std::vector<std::int32_t> TopologyComputation::compute_transpose_num_links(
+    const graph::AdjacencyList<std::int32_t>& c_d1_d0,
+    std::int32_t num_entities_d0, int num_threads)
+{
+  const int num_chunks
+      = std::max(1, std::min(num_threads, c_d1_d0.num_nodes()));
+  std::vector<std::vector<std::int32_t>> counts
+      = count_transpose_links(c_d1_d0, num_entities_d0, num_chunks);
+  for (int t = 1; t < num_chunks; ++t)
+  {
+    std::transform(counts[0].begin(), counts[0].end(), counts[t].begin(),
+                   counts[0].begin(), std::plus<std::int32_t>());
+  }
+
+  return std::move(counts[0]);
+}
 //--------------------------------------------------------------------------
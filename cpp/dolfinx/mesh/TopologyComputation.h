@@ -12,6 +12,7 @@
 #include <dolfinx/common/MPI.h>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 namespace dolfinx
 {
@@ -55,13 +56,29 @@ compute_entities(MPI_Comm comm, const Topology& topology, int dim);
 /// @param[in] topology The topology
 /// @param[in] d0 The dimension of the nodes in the adjacency list
 /// @param[in] d1 The dimension of the edges in the adjacency list
+/// @param[in] num_threads The number of threads used to compute
+///   transposes and to look up entities by their vertices
 /// @returns The connectivities [(d0, d1), (d1, d0)] if they are
 ///   computed. If (d0, d1) already exists then a nullptr is returned.
 ///   If (d0, d1) is computed and the computation of (d1, d0) was
 ///   required as part of computing (d0, d1), the (d1, d0) is returned
 ///   as the second entry. The second entry is otherwise nullptr.
 std::array<std::shared_ptr<graph::AdjacencyList<std::int32_t>>, 2>
-compute_connectivity(const Topology& topology, int d0, int d1);
+compute_connectivity(const Topology& topology, int d0, int d1,
+                     int num_threads = 1);
+
+/// Compute the number of links of each node of the transpose of an
+/// adjacency list, i.e. the number of d1 entities connected to each d0
+/// entity given the (d1 -> d0) connectivity, without forming the
+/// transpose
+/// @param[in] c_d1_d0 The connectivity from entities of dimension d1 to
+///   entities of dimension d0
+/// @param[in] num_entities_d0 The number of entities of dimension d0
+/// @param[in] num_threads The number of threads
+/// @return The number of d1 entities connected to each d0 entity
+std::vector<std::int32_t>
+compute_transpose_num_links(const graph::AdjacencyList<std::int32_t>& c_d1_d0,
+                            std::int32_t num_entities_d0, int num_threads = 1);
 
 } // namespace TopologyComputation
 } // namespace mesh
@@ -367,23 +367,31 @@ Eigen::ArrayXd mesh::h(const Mesh& mesh,
 
   const mesh::Geometry& geometry = mesh.geometry();
   const graph::AdjacencyList<std::int32_t>& x_dofs = geometry.dofmap();
+  const double* x = geometry.x().data();
 
-  Eigen::ArrayXd h_cells = Eigen::ArrayXd::Zero(entities.rows());
+  Eigen::ArrayXd h_cells(entities.rows());
   assert(num_vertices <= 8);
-  std::array<Eigen::Vector3d, 8> points;
+  std::array<const double*, 8> p;
   for (Eigen::Index e = 0; e < entities.rows(); ++e)
   {
-    // Get the coordinates  of the vertices
-    auto dofs = x_dofs.links(entities[e]);
+    // Get pointers to the coordinates of the vertices
+    const std::int32_t* dofs = x_dofs.links_ptr(entities[e]);
     for (int i = 0; i < num_vertices; ++i)
-      points[i] = geometry.node(dofs[i]);
+      p[i] = x + 3 * dofs[i];
 
-    // Get maximum edge length
+    // Get maximum (squared) distance between any two vertices
+    double h2 = 0.0;
     for (int i = 0; i < num_vertices; ++i)
     {
       for (int j = i + 1; j < num_vertices; ++j)
-        h_cells[e] = std::max(h_cells[e], (points[i] - points[j]).norm());
+      {
+        const double d0 = p[i][0] - p[j][0];
+        const double d1 = p[i][1] - p[j][1];
+        const double d2 = p[i][2] - p[j][2];
+        h2 = std::max(h2, d0 * d0 + d1 * d1 + d2 * d2);
+      }
     }
+    h_cells[e] = std::sqrt(h2);
   }
 
   return h_cells;
@@ -411,37 +419,74 @@ Eigen::ArrayXd mesh::inradius(const mesh::Mesh& mesh,
 
   // Get cell dimension
   const int d = mesh::cell_dim(type);
-  const mesh::Topology& topology = mesh.topology();
-  // FIXME: cleanup these calls as part of topology storage management rework.
-  mesh.topology_mutable().create_entities(d - 1);
-  auto connectivity = topology.connectivity(d, d - 1);
-  assert(connectivity);
-
-  const Eigen::ArrayXd volumes = mesh::volume_entities(mesh, entities, d);
 
+  const mesh::Geometry& geometry = mesh.geometry();
+  const graph::AdjacencyList<std::int32_t>& x_dofs = geometry.dofmap();
+  const double* x = geometry.x().data();
+
+  // Cross product of (b - a) and (c - a)
+  auto cross = [](const double* a, const double* b, const double* c,
+                  double* n) {
+    const double u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    const double v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    n[0] = u[1] * v[2] - u[2] * v[1];
+    n[1] = u[2] * v[0] - u[0] * v[2];
+    n[2] = u[0] * v[1] - u[1] * v[0];
+  };
+  auto norm = [](const double* u) {
+    return std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+  };
+
+  // Compute the volume V and the facet area A of each cell from the
+  // cell vertices, where facet i is opposite vertex i
   Eigen::ArrayXd r(entities.rows());
-  Eigen::ArrayXi facet_list(d + 1);
+  std::array<const double*, 4> p;
   for (Eigen::Index c = 0; c < entities.rows(); ++c)
   {
-    if (volumes[c] == 0.0)
+    const std::int32_t* dofs = x_dofs.links_ptr(entities[c]);
+    for (int i = 0; i <= d; ++i)
+      p[i] = x + 3 * dofs[i];
+
+    double V = 0.0, A = 0.0;
+    if (d == 1)
     {
-      r[c] = 0.0;
-      continue;
+      const double u[3] = {p[1][0] - p[0][0], p[1][1] - p[0][1],
+                           p[1][2] - p[0][2]};
+      V = norm(u);
+      A = 2.0;
+    }
+    else if (d == 2)
+    {
+      double n[3];
+      cross(p[0], p[1], p[2], n);
+      V = 0.5 * norm(n);
+      for (int i = 0; i < 3; ++i)
+      {
+        const double* a = p[(i + 1) % 3];
+        const double* b = p[(i + 2) % 3];
+        const double u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        A += norm(u);
+      }
+    }
+    else if (d == 3)
+    {
+      double n[3];
+      cross(p[0], p[1], p[2], n);
+      V = std::abs(n[0] * (p[3][0] - p[0][0]) + n[1] * (p[3][1] - p[0][1])
+                   + n[2] * (p[3][2] - p[0][2]))
+          / 6.0;
+      for (int i = 0; i < 4; ++i)
+      {
+        cross(p[(i + 1) % 4], p[(i + 2) % 4], p[(i + 3) % 4], n);
+        A += 0.5 * norm(n);
+      }
     }
-
-    auto facets = connectivity->links(entities[c]);
-    for (int i = 0; i <= d; i++)
-      facet_list[i] = facets[i];
-    const double A = volume_entities_tmpl<Eigen::Array<double, 4, 1>>(
-                         mesh, facet_list, d - 1)
-                         .head(d + 1)
-                         .sum();
 
     // See Jonathan Richard Shewchuk: What Is a Good Linear Finite
     // Element?, online:
     // http://www.cs.berkeley.edu/~jrs/papers/elemj.pdf
     // return d * V / A;
-    r[c] = d * volumes[c] / A;
+    r[c] = V == 0.0 ? 0.0 : d * V / A;
   }
 
   return r;
@@ -681,10 +726,11 @@ Eigen::Array<std::int32_t, Eigen::Dynamic, 1> mesh::locate_entities_boundary(
         "Cannot use mesh::locate_entities_boundary (boundary) for cells.");
   }
 
-  // Compute marker for boundary facets
+  // Get boundary facets
   mesh.topology_mutable().create_entities(tdim - 1);
   mesh.topology_mutable().create_connectivity(tdim - 1, tdim);
-  const std::vector boundary_facet = mesh::compute_boundary_facets(topology);
+  const std::vector<std::int32_t>& boundary_facets
+      = topology.exterior_facets();
 
   // Create entities and connectivities
   mesh.topology_mutable().create_entities(dim);
@@ -700,18 +746,15 @@ Eigen::Array<std::int32_t, Eigen::Dynamic, 1> mesh::locate_entities_boundary(
   assert(f_to_e);
   std::unordered_set<std::int32_t> boundary_vertices;
   std::unordered_set<std::int32_t> facet_entities;
-  for (std::size_t f = 0; f < boundary_facet.size(); ++f)
+  for (std::int32_t f : boundary_facets)
   {
-    if (boundary_facet[f])
-    {
-      auto entities = f_to_e->links(f);
-      for (int i = 0; i < entities.size(); ++i)
-        facet_entities.insert(entities[i]);
+    auto entities = f_to_e->links(f);
+    for (int i = 0; i < entities.size(); ++i)
+      facet_entities.insert(entities[i]);
 
-      auto vertices = f_to_v->links(f);
-      for (int i = 0; i < vertices.size(); ++i)
-        boundary_vertices.insert(vertices[i]);
-    }
+    auto vertices = f_to_v->links(f);
+    for (int i = 0; i < vertices.size(); ++i)
+      boundary_vertices.insert(vertices[i]);
   }
 
   // Get geometry data
@@ -859,38 +902,61 @@ mesh::entities_to_geometry(
 Eigen::Array<std::int32_t, Eigen::Dynamic, 1>
 mesh::exterior_facet_indices(const Mesh& mesh)
 {
-  // Note: Possible duplication of mesh::Topology::compute_boundary_facets
-
-  const mesh::Topology& topology = mesh.topology();
-  std::vector<std::int32_t> surface_facets;
+  const int tdim = mesh.topology().dim();
+  mesh.topology_mutable().create_entities(tdim - 1);
+  mesh.topology_mutable().create_connectivity(tdim - 1, tdim);
+  const std::vector<std::int32_t>& surface_facets
+      = mesh.topology().exterior_facets();
 
-  // Get number of facets owned by this process
+  // Copy over to Eigen::Array
+  return Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>(
+      surface_facets.data(), surface_facets.size());
+}
+//------------------------------------------------------------------------------
+Table mesh::memory_usage(const mesh::Mesh& mesh)
+{
+  Table table("Mesh memory usage (bytes)");
+  const Topology& topology = mesh.topology();
   const int tdim = topology.dim();
-  mesh.topology_mutable().create_connectivity(tdim - 1, tdim);
-  auto f_to_c = topology.connectivity(tdim - 1, tdim);
-  assert(topology.index_map(tdim - 1));
-  std::set<std::int32_t> fwd_shared_facets;
 
-  // Only need to consider shared facets when there are no ghost cells
-  if (topology.index_map(tdim)->num_ghosts() == 0)
+  std::size_t topology_bytes = 0;
+  for (int d0 = 0; d0 <= tdim; ++d0)
   {
-    fwd_shared_facets.insert(
-        topology.index_map(tdim - 1)->shared_indices().begin(),
-        topology.index_map(tdim - 1)->shared_indices().end());
+    for (int d1 = 0; d1 <= tdim; ++d1)
+    {
+      if (auto c = topology.connectivity(d0, d1); c)
+      {
+        const std::size_t bytes = c->memory_usage();
+        table.set("Topology connectivity (" + std::to_string(d0) + ", "
+                      + std::to_string(d1) + ")",
+                  "bytes", static_cast<double>(bytes));
+        topology_bytes += bytes;
+      }
+    }
   }
 
-  // Find all owned facets (not ghost) with only one attached cell, which are
-  // also not shared forward (ghost on another process)
-  const int num_facets = topology.index_map(tdim - 1)->size_local();
-  for (int f = 0; f < num_facets; ++f)
+  for (int d = 0; d <= tdim; ++d)
   {
-    if (f_to_c->num_links(f) == 1
-        and fwd_shared_facets.find(f) == fwd_shared_facets.end())
-      surface_facets.push_back(f);
+    if (auto map = topology.index_map(d); map)
+    {
+      const std::size_t bytes = map->memory_usage();
+      table.set("Topology index map " + std::to_string(d), "bytes",
+                static_cast<double>(bytes));
+      topology_bytes += bytes;
+    }
   }
 
-  // Copy over to Eigen::Array
-  return Eigen::Map<Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>(
-      surface_facets.data(), surface_facets.size());
+  table.set("Topology entity permutations", "bytes",
+            static_cast<double>(topology.memory_usage() - topology_bytes));
+
+  const Geometry& geometry = mesh.geometry();
+  table.set("Geometry", "bytes", static_cast<double>(geometry.memory_usage()));
+  if (auto map = geometry.index_map(); map)
+  {
+    table.set("Geometry index map", "bytes",
+              static_cast<double>(map->memory_usage()));
+  }
+
+  return table;
 }
-//------------------------------------------------------------------------------
\ No newline at end of file
+//------------------------------------------------------------------------------
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <dolfinx/common/Table.h>
 #include <dolfinx/graph/AdjacencyList.h>
 
 namespace dolfinx
@@ -132,5 +133,14 @@ entities_to_geometry(
 Eigen::Array<std::int32_t, Eigen::Dynamic, 1>
 exterior_facet_indices(const Mesh& mesh);
 
+/// Break-down of the memory used by a mesh on this process. The table
+/// has a row for each computed connectivity (d0, d1), each entity index
+/// map, the entity permutation data and the geometry, and a column
+/// "bytes". The values are doubles, so the table can be reduced across
+/// processes with Table::reduce to get the min, max or sum.
+/// @param[in] mesh The mesh
+/// @return Table with the memory usage in bytes
+Table memory_usage(const Mesh& mesh);
+
 } // namespace mesh
 } // namespace dolfinx
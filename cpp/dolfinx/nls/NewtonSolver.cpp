@@ -6,20 +6,59 @@
 
 #include "NewtonSolver.h"
 #include "NonlinearProblem.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Table.h>
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/common/log.h>
 #include <dolfinx/la/PETScKrylovSolver.h>
 #include <dolfinx/la/PETScMatrix.h>
 #include <dolfinx/la/PETScOptions.h>
 #include <dolfinx/la/PETScVector.h>
 #include <string>
+#include <tuple>
 
 using namespace dolfinx;
 
+namespace
+{
+//-----------------------------------------------------------------------------
+// Compute the Eisenstat-Walker forcing term of a Newton iteration from
+// the residual norms of the iteration and the previous iteration, the
+// residual norm of the linear solve of the previous iteration (choice
+// 1) and the previous forcing term
+double eisenstat_walker(nls::NewtonSolver::ForcingTerm choice, double eta,
+                        double residual_norm, double residual_norm0,
+                        double linear_residual_norm, double gamma,
+                        double alpha, double threshold, double eta_max)
+{
+  double eta_new, eta_safe;
+  if (choice == nls::NewtonSolver::ForcingTerm::eisenstat_walker_1)
+  {
+    eta_new = std::abs(residual_norm - linear_residual_norm) / residual_norm0;
+    eta_safe = std::pow(eta, 0.5 * (1.0 + std::sqrt(5.0)));
+  }
+  else
+  {
+    eta_new = gamma * std::pow(residual_norm / residual_norm0, alpha);
+    eta_safe = gamma * std::pow(eta, alpha);
+  }
+
+  // Safeguard against a too rapid decrease
+  if (eta_safe > threshold)
+    eta_new = std::max(eta_new, eta_safe);
+
+  return std::min(eta_new, eta_max);
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
 //-----------------------------------------------------------------------------
 nls::NewtonSolver::NewtonSolver(MPI_Comm comm)
     : _krylov_iterations(0), _residual(0.0), _residual0(0.0), _solver(comm),
-      _dx(nullptr), _mpi_comm(comm)
+      _dx(nullptr), _r(nullptr), _x0(nullptr), _mpi_comm(comm)
 {
   // Create linear solver if not already created. Default to LU.
   _solver.set_options_prefix("nls_solve_");
@@ -35,21 +74,42 @@ nls::NewtonSolver::~NewtonSolver()
 {
   if (_dx)
     VecDestroy(&_dx);
+  if (_r)
+    VecDestroy(&_r);
+  if (_x0)
+    VecDestroy(&_x0);
 }
 //-----------------------------------------------------------------------------
 std::pair<int, bool>
 dolfinx::nls::NewtonSolver::solve(NonlinearProblem& nonlinear_problem, Vec x)
 {
-  // Reset iteration counts
+  // Reset iteration counts and statistics. Entry 0 of the statistics
+  // is the initial residual.
   int newton_iteration = 0;
   _krylov_iterations = 0;
+  _statistics.assign(1, IterationStatistics());
 
-  // Compute F(u) (assembled into _b)
+  // Compute F(u) (assembled into _b), and J with F if the Jacobian is
+  // computed in every iteration and the assembly is fused
   Mat A(nullptr), P(nullptr);
   Vec b = nullptr;
+  const bool fuse = fused_assembly and max_jacobian_age <= 1
+                    and max_preconditioner_age <= 1;
+  bool jacobian_computed = false;
+  auto compute_residual = [&]() {
+    common::Timer timer("Newton: assemble residual");
+    nonlinear_problem.form(x);
+    if (fuse)
+    {
+      std::tie(b, A) = nonlinear_problem.FJ(x);
+      jacobian_computed = true;
+    }
+    else
+      b = nonlinear_problem.F(x);
+    _statistics.back().residual = timer.stop();
+  };
 
-  nonlinear_problem.form(x);
-  b = nonlinear_problem.F(x);
+  compute_residual();
   assert(b);
 
   // Check convergence
@@ -68,39 +128,134 @@ dolfinx::nls::NewtonSolver::solve(NonlinearProblem& nonlinear_problem, Vec x)
                              + convergence_criterion);
   }
 
+  // Iterations since the Jacobian and the preconditioner were
+  // rebuilt, and the residual norm for the rate of convergence when
+  // they are reused
+  int jacobian_age = 0, preconditioner_age = 0;
+  bool rebuild = true;
+  const int max_pc_age = std::max(max_preconditioner_age, max_jacobian_age);
+  const bool reuse = max_pc_age > 1;
+
+  // The relative tolerance of the linear solver, which the forcing
+  // terms replace
+  const bool inexact = forcing_term != ForcingTerm::constant;
+  PetscReal ksp_rtol, ksp_atol, ksp_dtol;
+  PetscInt ksp_max_it;
+  KSPGetTolerances(_solver.ksp(), &ksp_rtol, &ksp_atol, &ksp_dtol,
+                   &ksp_max_it);
+  double eta = forcing_eta0;
+
+  PetscReal residual_norm = 0.0, linear_residual_norm = 0.0;
+  if (reuse or inexact or line_search != LineSearch::none)
+    VecNorm(b, NORM_2, &residual_norm);
+
   // Start iterations
   while (!newton_converged and newton_iteration < max_it)
   {
-    // Compute Jacobian
-    A = nonlinear_problem.J(x);
-    assert(A);
-    P = nonlinear_problem.P(x);
-    if (!P)
-      P = A;
+    _statistics.emplace_back();
+    IterationStatistics& statistics = _statistics.back();
+
+    const bool rebuild_preconditioner
+        = rebuild or preconditioner_age >= max_pc_age;
+    const bool rebuild_jacobian
+        = rebuild_preconditioner or jacobian_age >= max_jacobian_age;
+
+    // Compute Jacobian, and the preconditioner operator if it is
+    // rebuilt
+    if (rebuild_jacobian)
+    {
+      common::Timer timer("Newton: assemble Jacobian");
+      if (!jacobian_computed)
+        A = nonlinear_problem.J(x);
+      jacobian_computed = false;
+      assert(A);
+      if (rebuild_preconditioner)
+      {
+        P = nonlinear_problem.P(x);
+        if (!P)
+          P = A;
+      }
+      statistics.jacobian = timer.stop();
+
+      if (!_dx)
+        MatCreateVecs(A, &_dx, nullptr);
 
-    if (!_dx)
-      MatCreateVecs(A, &_dx, nullptr);
+      // Set operators, keeping the preconditioner if it is lagged
+      _solver.set_operators(A, P);
+      KSPSetReusePreconditioner(_solver.ksp(), rebuild_preconditioner
+                                                   ? PETSC_FALSE
+                                                   : PETSC_TRUE);
 
-    // FIXME: check that this is efficient if A and/or P are unchanged
-    // Set operators
-    _solver.set_operators(A, P);
+      // Set up the preconditioner before the solve, for its timing
+      common::Timer timer_pc("Newton: preconditioner setup");
+      _solver.set_up();
+      statistics.preconditioner = timer_pc.stop();
+      jacobian_age = 0;
+      if (rebuild_preconditioner)
+        preconditioner_age = 0;
+    }
+    ++jacobian_age;
+    ++preconditioner_age;
 
     // Perform linear solve and update total number of Krylov iterations
-    _krylov_iterations += _solver.solve(_dx, b);
+    if (inexact)
+      KSPSetTolerances(_solver.ksp(), eta, ksp_atol, ksp_dtol, ksp_max_it);
+    common::Timer timer_solve("Newton: linear solve");
+    statistics.krylov_iterations = _solver.solve(_dx, b);
+    statistics.linear_solve = timer_solve.stop();
+    _krylov_iterations += statistics.krylov_iterations;
 
-    // Update solution
-    update_solution(x, _dx, relaxation_parameter, nonlinear_problem,
-                    newton_iteration);
+    // Residual of the linear solve, before F is recomputed into b
+    if (forcing_term == ForcingTerm::eisenstat_walker_1)
+    {
+      if (!_r)
+        VecDuplicate(b, &_r);
+      MatMult(A, _dx, _r);
+      VecAYPX(_r, -1.0, b);
+      VecNorm(_r, NORM_2, &linear_residual_norm);
+    }
+
+    // Update solution, and compute F (a line search computes F)
+    common::Timer timer_update("Newton: update solution");
+    if (line_search == LineSearch::none)
+    {
+      update_solution(x, _dx, relaxation_parameter, nonlinear_problem,
+                      newton_iteration);
+      statistics.update = timer_update.stop();
+
+      // FIXME: This step is not needed if residual is based on dx and
+      //        this has converged.
+      // FIXME: But, this function call may update internal variables,
+      //        etc.
+      // Compute F
+      compute_residual();
+    }
+    else
+    {
+      b = line_search_update(nonlinear_problem, x, b, residual_norm,
+                             newton_iteration);
+      statistics.update = timer_update.stop();
+    }
 
     // Increment iteration count
     ++newton_iteration;
 
-    // FIXME: This step is not needed if residual is based on dx and
-    //        this has converged.
-    // FIXME: But, this function call may update internal variables, etc.
-    // Compute F
-    nonlinear_problem.form(x);
-    b = nonlinear_problem.F(x);
+    // Rebuild a reused Jacobian and preconditioner if the convergence
+    // stalls, and compute the forcing term of the next iteration
+    rebuild = false;
+    if (reuse or inexact or line_search != LineSearch::none)
+    {
+      const PetscReal residual_norm0 = residual_norm;
+      VecNorm(b, NORM_2, &residual_norm);
+      rebuild = reuse and residual_norm > max_reuse_rate * residual_norm0;
+      if (inexact and residual_norm0 > 0.0)
+      {
+        eta = eisenstat_walker(forcing_term, eta, residual_norm,
+                               residual_norm0, linear_residual_norm,
+                               forcing_gamma, forcing_alpha,
+                               forcing_threshold, forcing_eta_max);
+      }
+    }
 
     // Test for convergence
     if (convergence_criterion == "residual")
@@ -116,6 +271,13 @@ dolfinx::nls::NewtonSolver::solve(NonlinearProblem& nonlinear_problem, Vec x)
       throw std::runtime_error("Unknown convergence criterion string.");
   }
 
+  // Restore the tolerance of the linear solver
+  if (inexact)
+  {
+    KSPSetTolerances(_solver.ksp(), ksp_rtol, ksp_atol, ksp_dtol,
+                     ksp_max_it);
+  }
+
   if (newton_converged)
   {
     if (MPI::rank(_mpi_comm.comm()) == 0)
@@ -150,6 +312,34 @@ double nls::NewtonSolver::residual() const { return _residual; }
 //-----------------------------------------------------------------------------
 double nls::NewtonSolver::residual0() const { return _residual0; }
 //-----------------------------------------------------------------------------
+const std::vector<nls::NewtonSolver::IterationStatistics>&
+nls::NewtonSolver::statistics() const
+{
+  return _statistics;
+}
+//-----------------------------------------------------------------------------
+Table nls::NewtonSolver::statistics_table() const
+{
+  Table table("Newton iterations");
+  for (std::size_t i = 0; i < _statistics.size(); ++i)
+  {
+    const IterationStatistics& s = _statistics[i];
+    const std::string row = "Iteration " + std::to_string(i);
+    table.set(row, "residual", s.residual);
+    table.set(row, "Jacobian", s.jacobian);
+    table.set(row, "preconditioner", s.preconditioner);
+    table.set(row, "linear solve", s.linear_solve);
+    table.set(row, "Krylov iterations", double(s.krylov_iterations));
+    table.set(row, "update", s.update);
+  }
+  return table;
+}
+//-----------------------------------------------------------------------------
+la::PETScKrylovSolver& nls::NewtonSolver::get_krylov_solver()
+{
+  return _solver;
+}
+//-----------------------------------------------------------------------------
 bool nls::NewtonSolver::converged(const Vec r, const NonlinearProblem&,
                                   std::size_t newton_iteration)
 {
@@ -179,6 +369,69 @@ bool nls::NewtonSolver::converged(const Vec r, const NonlinearProblem&,
     return false;
 }
 //-----------------------------------------------------------------------------
+Vec nls::NewtonSolver::line_search_update(NonlinearProblem& nonlinear_problem,
+                                          Vec x, Vec b, double residual_norm,
+                                          std::size_t iteration)
+{
+  if (!_x0)
+    VecDuplicate(x, &_x0);
+  VecCopy(x, _x0);
+
+  // Merit functions at step length zero: |F|^2 and F . dx
+  const double f0 = residual_norm * residual_norm;
+  PetscScalar dot;
+  VecDot(b, _dx, &dot);
+  const double g0 = std::real(dot);
+
+  // Evaluate the residual at x0 - s dx, with the step length s from a
+  // secant iteration for F . dx = 0 (critical point), or reduced to the
+  // safeguarded minimum of a quadratic model of |F(x0 - s dx)|^2
+  // (backtracking)
+  double s = relaxation_parameter, s_prev = 0.0, g_prev = g0;
+  for (int it = 0;; ++it)
+  {
+    VecCopy(_x0, x);
+    update_solution(x, _dx, s, nonlinear_problem, iteration);
+    nonlinear_problem.form(x);
+    b = nonlinear_problem.F(x);
+    if (it + 1 >= line_search_max_it)
+    {
+      LOG(WARNING) << "Line search did not converge in " << line_search_max_it
+                   << " iterations.";
+      break;
+    }
+
+    if (line_search == LineSearch::backtracking)
+    {
+      PetscReal norm;
+      VecNorm(b, NORM_2, &norm);
+      const double f = norm * norm;
+      if (f <= (1.0 - 2.0 * line_search_c * s) * f0)
+        break;
+      const double s_q = f0 * s * s / (f - f0 + 2.0 * f0 * s);
+      s = std::clamp(s_q, 0.1 * s, 0.5 * s);
+    }
+    else
+    {
+      VecDot(b, _dx, &dot);
+      const double g = std::real(dot);
+      if (std::abs(g) <= line_search_rtol * std::abs(g0) or g == g_prev)
+        break;
+      const double s_new = s - g * (s - s_prev) / (g - g_prev);
+      if (!std::isfinite(s_new) or s_new <= 0.0)
+        break;
+      s_prev = s;
+      g_prev = g;
+      s = s_new;
+    }
+  }
+
+  if (report and MPI::rank(_mpi_comm.comm()) == 0)
+    LOG(INFO) << "Newton iteration " << iteration << ": step length " << s;
+
+  return b;
+}
+//-----------------------------------------------------------------------------
 void nls::NewtonSolver::update_solution(Vec x, const Vec dx, double relaxation,
                                         const NonlinearProblem&, std::size_t)
 {
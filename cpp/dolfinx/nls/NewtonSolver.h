@@ -6,11 +6,15 @@
 
 #pragma once
 
+#include <cmath>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Table.h>
 #include <dolfinx/la/PETScKrylovSolver.h>
 #include <memory>
 #include <petscvec.h>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace dolfinx
 {
@@ -31,6 +35,49 @@ class NonlinearProblem;
 class NewtonSolver
 {
 public:
+  /// Forcing terms, i.e. the relative tolerance of the linear solve in
+  /// each Newton iteration (inexact Newton)
+  enum class ForcingTerm
+  {
+    constant,           // The tolerance of the linear solver
+    eisenstat_walker_1, // Eisenstat-Walker choice 1
+    eisenstat_walker_2  // Eisenstat-Walker choice 2
+  };
+
+  /// Line searches for the step length along the Newton direction
+  enum class LineSearch
+  {
+    none,          // Step length relaxation_parameter
+    backtracking,  // Backtracking with the Armijo condition on |F|^2
+    critical_point // Secant iteration for F(x - s dx) . dx = 0
+  };
+
+  /// Wall times (in seconds) of the phases of a Newton iteration, and
+  /// the number of Krylov iterations. The times are also registered in
+  /// the timings (see list_timings) as "Newton: ...".
+  struct IterationStatistics
+  {
+    /// Assembly of the residual F at the new solution (with the
+    /// Jacobian if the assembly is fused)
+    double residual = 0.0;
+
+    /// Assembly of the Jacobian J and the preconditioner operator P
+    double jacobian = 0.0;
+
+    /// Setup of the preconditioner
+    double preconditioner = 0.0;
+
+    /// Linear solve
+    double linear_solve = 0.0;
+
+    /// Number of Krylov iterations of the linear solve
+    int krylov_iterations = 0;
+
+    /// Update of the solution, including the residual evaluations of a
+    /// line search
+    double update = 0.0;
+  };
+
   /// Create nonlinear solver
   /// @param[in] comm The MPI communicator for the solver
   explicit NewtonSolver(MPI_Comm comm);
@@ -60,6 +107,22 @@ public:
   /// @return Initial residual
   double residual0() const;
 
+  /// Return the statistics of the iterations of the last solve. Entry 0
+  /// is the assembly of the initial residual, and entry i the Newton
+  /// iteration i.
+  /// @return The statistics on this process
+  const std::vector<IterationStatistics>& statistics() const;
+
+  /// Return the statistics of the iterations of the last solve as a
+  /// table with a row for each entry of statistics(). The table can be
+  /// reduced over the processes with Table::reduce.
+  /// @return The table of statistics on this process
+  Table statistics_table() const;
+
+  /// Return the linear solver of the Newton iterations
+  /// @return The linear solver
+  la::PETScKrylovSolver& get_krylov_solver();
+
   /// Maximum number of iterations
   int max_it = 50;
 
@@ -82,6 +145,76 @@ public:
   /// Relaxation parameter
   double relaxation_parameter = 1.0;
 
+  /// Maximum number of Newton iterations for which the Jacobian is
+  /// reused before it is recomputed (modified Newton). With 1, the
+  /// Jacobian is computed in every iteration.
+  int max_jacobian_age = 1;
+
+  /// Maximum number of Newton iterations for which the preconditioner
+  /// is reused before it is rebuilt (lagged preconditioner). With 1,
+  /// the preconditioner is rebuilt whenever the Jacobian is computed.
+  /// The preconditioner is reused for at least as many iterations as
+  /// the Jacobian, and the Jacobian is always computed when the
+  /// preconditioner is rebuilt.
+  int max_preconditioner_age = 1;
+
+  /// A reused Jacobian and preconditioner are rebuilt in the next
+  /// iteration if the ratio of the residual norms of consecutive
+  /// iterations exceeds this value, i.e. if the convergence stalls
+  double max_reuse_rate = 0.5;
+
+  /// Forcing term. The Eisenstat-Walker forcing terms (S. C. Eisenstat
+  /// and H. F. Walker, SIAM J. Sci. Comput. 17(1), 1996) set the
+  /// relative tolerance of the linear solver in each iteration from the
+  /// residual norms of the previous iterations, such that the early
+  /// iterations are not oversolved.
+  ForcingTerm forcing_term = ForcingTerm::constant;
+
+  /// Forcing term of the first iteration (Eisenstat-Walker)
+  double forcing_eta0 = 0.3;
+
+  /// Largest forcing term (Eisenstat-Walker)
+  double forcing_eta_max = 0.9;
+
+  /// Parameter gamma of choice 2, eta_k = gamma (|F_k| /
+  /// |F_{k-1}|)^alpha (Eisenstat-Walker)
+  double forcing_gamma = 1.0;
+
+  /// Parameter alpha of choice 2 (Eisenstat-Walker)
+  double forcing_alpha = 0.5 * (1.0 + std::sqrt(5.0));
+
+  /// The forcing term is safeguarded from decreasing faster than the
+  /// previous forcing terms if these exceed this threshold
+  /// (Eisenstat-Walker)
+  double forcing_threshold = 0.1;
+
+  /// Compute the residual and the Jacobian together with
+  /// NonlinearProblem::FJ, e.g. by a fused assembly that visits each
+  /// cell once. Only used if the Jacobian is computed in every
+  /// iteration (no reuse), and not at the trial points of a line
+  /// search. The Jacobian of the converged solution is then computed
+  /// but not used.
+  bool fused_assembly = false;
+
+  /// Line search. The initial step length is relaxation_parameter. A
+  /// backtracking line search reduces the step length until |F|^2 is
+  /// sufficiently reduced (Armijo condition). A critical point line
+  /// search finds the step length s at which F(x - s dx) is orthogonal
+  /// to dx, i.e. a critical point of the energy if F is the derivative
+  /// of an energy. The residual of the last step length is reused by
+  /// the Newton iteration.
+  LineSearch line_search = LineSearch::none;
+
+  /// Maximum number of residual evaluations of a line search
+  int line_search_max_it = 10;
+
+  /// Sufficient decrease parameter of the Armijo condition |F(x - s
+  /// dx)|^2 <= (1 - 2 c s) |F(x)|^2 (backtracking)
+  double line_search_c = 1.0e-4;
+
+  /// Relative tolerance of F(x - s dx) . dx (critical point)
+  double line_search_rtol = 1.0e-2;
+
 protected:
   /// Convergence test. It may be overloaded using virtual inheritance
   /// and this base criterion may be called from derived, both in C++
@@ -109,6 +242,11 @@ protected:
                                std::size_t iteration);
 
 private:
+  // Update the solution by a line search along -dx, and compute F at
+  // the new solution. Returns F.
+  Vec line_search_update(NonlinearProblem& nonlinear_problem, Vec x, Vec b,
+                         double residual_norm, std::size_t iteration);
+
   // Accumulated number of Krylov iterations since solve began
   int _krylov_iterations;
 
@@ -121,6 +259,15 @@ private:
   // Solution vector
   Vec _dx;
 
+  // Work vector for the residual of the linear solve
+  Vec _r;
+
+  // Work vector for the solution at the start of a line search
+  Vec _x0;
+
+  // Statistics of the iterations of the last solve
+  std::vector<IterationStatistics> _statistics;
+
   // MPI communicator
   dolfinx::MPI::Comm _mpi_comm;
 };
@@ -8,6 +8,7 @@
 
 #include <petscmat.h>
 #include <petscvec.h>
+#include <utility>
 
 namespace dolfinx::nls
 {
@@ -39,6 +40,12 @@ public:
   /// Compute J = F' at current point x
   virtual Mat J(const Vec x) = 0;
 
+  /// Compute F and J = F' together at current point x, e.g. by a fused
+  /// assembly (see fem::assemble_system) in which the geometry and the
+  /// coefficients are packed once. The default calls F and J. Used by
+  /// NewtonSolver if NewtonSolver::fused_assembly is true.
+  virtual std::pair<Vec, Mat> FJ(const Vec x) { return {F(x), J(x)}; }
+
   /// Compute J_pc used to precondition J. Not implementing this
   /// or leaving P empty results in system matrix A being used
   /// to construct preconditioner.
@@ -0,0 +1,239 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "MeshHierarchy.h"
+#include "refine.h"
+#include <Eigen/Dense>
+#include <cmath>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/fem/CoordinateElement.h>
+#include <dolfinx/fem/DofMap.h>
+#include <dolfinx/fem/FiniteElement.h>
+#include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/la/PETScMatrix.h>
+#include <dolfinx/la/PETScVector.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <functional>
+#include <petscksp.h>
+#include <stdexcept>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+using namespace dolfinx;
+using namespace dolfinx::refinement;
+
+//-----------------------------------------------------------------------------
+MeshHierarchy::MeshHierarchy(std::shared_ptr<const mesh::Mesh> mesh,
+                             int num_refinements)
+    : _meshes({mesh}), _parents(1)
+{
+  assert(mesh);
+  for (int i = 0; i < num_refinements; ++i)
+  {
+    _meshes.back()->topology_mutable().create_entities(1);
+    auto [refined_mesh, parents] = refine_with_parents(*_meshes.back());
+    _meshes.push_back(
+        std::make_shared<const mesh::Mesh>(std::move(refined_mesh)));
+    _parents.push_back(std::move(parents));
+  }
+}
+//-----------------------------------------------------------------------------
+int MeshHierarchy::num_levels() const { return _meshes.size(); }
+//-----------------------------------------------------------------------------
+std::shared_ptr<const mesh::Mesh> MeshHierarchy::mesh(int level) const
+{
+  return _meshes.at(level);
+}
+//-----------------------------------------------------------------------------
+const std::vector<std::int32_t>& MeshHierarchy::parent_cells(int level) const
+{
+  return parents(level).parent_cell;
+}
+//-----------------------------------------------------------------------------
+const PlazaRefinementND::ParentMaps& MeshHierarchy::parents(int level) const
+{
+  if (level < 1 or level >= (int)_meshes.size())
+    throw std::runtime_error("Level has no parent cells.");
+  return _parents[level];
+}
+//-----------------------------------------------------------------------------
+la::PETScMatrix
+refinement::create_prolongation(const function::FunctionSpace& V0,
+                                const function::FunctionSpace& V1,
+                                const std::vector<std::int32_t>& parent_cells)
+{
+  common::Timer t0("Create prolongation matrix");
+
+  std::shared_ptr<const mesh::Mesh> mesh0 = V0.mesh();
+  assert(mesh0);
+  std::shared_ptr<const mesh::Mesh> mesh1 = V1.mesh();
+  assert(mesh1);
+  std::shared_ptr<const fem::FiniteElement> element0 = V0.element();
+  assert(element0);
+  std::shared_ptr<const fem::FiniteElement> element1 = V1.element();
+  assert(element1);
+  std::shared_ptr<const fem::DofMap> dofmap0 = V0.dofmap();
+  assert(dofmap0);
+  std::shared_ptr<const fem::DofMap> dofmap1 = V1.dofmap();
+  assert(dofmap1);
+
+  // Both spaces must have the same number of components, with the
+  // dofs of the components at each node blocked
+  const int bs = element0->block_size();
+  if (element1->block_size() != bs or dofmap0->bs() != bs
+      or dofmap1->bs() != bs)
+  {
+    throw std::runtime_error("Cannot create prolongation. The spaces must "
+                             "have the same (blocked) components.");
+  }
+
+  const int tdim = mesh1->topology().dim();
+  auto map_c1 = mesh1->topology().index_map(tdim);
+  assert(map_c1);
+  const std::int32_t num_cells1 = map_c1->size_local() + map_c1->num_ghosts();
+  if ((std::int32_t)parent_cells.size() != num_cells1)
+  {
+    throw std::runtime_error("Cannot create prolongation. Number of parent "
+                             "cells and cells differ.");
+  }
+
+  // The basis of a component of the coarse space, and the dofs (nodes)
+  // of the fine space, which are points
+  std::shared_ptr<const fem::FiniteElement> scalar_element0
+      = bs > 1 ? element0->extract_sub_element({0}) : element0;
+  const int num_dofs0 = scalar_element0->space_dimension();
+  const int num_nodes1 = element1->space_dimension() / bs;
+  std::shared_ptr<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                     Eigen::RowMajor>>
+      x1 = V1.dof_coordinates();
+
+  // Coarse geometry
+  const int gdim = mesh0->geometry().dim();
+  const fem::CoordinateElement& cmap = mesh0->geometry().cmap();
+  const graph::AdjacencyList<std::int32_t>& x_dofmap0
+      = mesh0->geometry().dofmap();
+  const int num_dofs_g = x_dofmap0.num_links(0);
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g0
+      = mesh0->geometry().x();
+
+  // Work arrays
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      coordinate_dofs(num_dofs_g, gdim), xp(num_nodes1, gdim),
+      X(num_nodes1, tdim);
+  Eigen::Tensor<double, 3, Eigen::RowMajor> J(num_nodes1, gdim, tdim),
+      K(num_nodes1, tdim, gdim);
+  Eigen::Array<double, Eigen::Dynamic, 1> detJ(num_nodes1);
+  Eigen::Tensor<double, 3, Eigen::RowMajor> basis(num_nodes1, num_dofs0, 1);
+
+  // Compute the (non-zero) entries of each owned row (fine node) once,
+  // in the parent cell of the first cell of the node
+  std::shared_ptr<const common::IndexMap> map1 = dofmap1->index_map;
+  assert(map1);
+  const std::int32_t num_owned_nodes = map1->size_local();
+  std::vector<bool> computed(num_owned_nodes, false);
+  std::vector<std::int32_t> rows, cols, offsets = {0};
+  std::vector<PetscScalar> values;
+  const graph::AdjacencyList<std::int32_t>& nodes0 = dofmap0->list_blocked();
+  const graph::AdjacencyList<std::int32_t>& nodes1 = dofmap1->list_blocked();
+  for (std::int32_t c = 0; c < num_cells1; ++c)
+  {
+    auto cell_nodes1 = nodes1.links(c);
+    bool new_rows = false;
+    for (int i = 0; i < num_nodes1; ++i)
+    {
+      const std::int32_t node = cell_nodes1[i];
+      new_rows = new_rows or (node < num_owned_nodes and !computed[node]);
+      xp.row(i) = x1->row(node);
+    }
+    if (!new_rows)
+      continue;
+
+    // Evaluate the coarse basis at the fine nodes in the parent cell
+    const std::int32_t p = parent_cells[c];
+    auto x_dofs = x_dofmap0.links(p);
+    for (int i = 0; i < num_dofs_g; ++i)
+      coordinate_dofs.row(i) = x_g0.row(x_dofs[i]).head(gdim);
+    cmap.compute_reference_geometry(X, J, detJ, K, xp, coordinate_dofs);
+    scalar_element0->evaluate_reference_basis(basis, X);
+
+    auto cell_nodes0 = nodes0.links(p);
+    for (int i = 0; i < num_nodes1; ++i)
+    {
+      const std::int32_t node = cell_nodes1[i];
+      if (node >= num_owned_nodes or computed[node])
+        continue;
+      computed[node] = true;
+      rows.push_back(node);
+      for (int j = 0; j < num_dofs0; ++j)
+      {
+        if (std::abs(basis(i, j, 0)) > 1.0e-12)
+        {
+          cols.push_back(cell_nodes0[j]);
+          values.push_back(basis(i, j, 0));
+        }
+      }
+      offsets.push_back(cols.size());
+    }
+  }
+
+  // Create the matrix, with a block of size bs for each pair of nodes
+  la::SparsityPattern pattern(mesh1->mpi_comm(),
+                              {dofmap1->index_map, dofmap0->index_map},
+                              bs > 1);
+  for (std::size_t r = 0; r < rows.size(); ++r)
+  {
+    pattern.insert(
+        Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>(
+            rows.data() + r, 1),
+        Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic, 1>>(
+            cols.data() + offsets[r], offsets[r + 1] - offsets[r]));
+  }
+  pattern.assemble();
+  la::PETScMatrix P(mesh1->mpi_comm(), pattern);
+
+  // Set the entries of each component
+  const std::function<int(std::int32_t, const std::int32_t*, std::int32_t,
+                          const std::int32_t*, const PetscScalar*)>
+      add = la::PETScMatrix::add_fn(P.mat());
+  std::vector<std::int32_t> component_cols;
+  for (std::size_t r = 0; r < rows.size(); ++r)
+  {
+    const std::int32_t num_cols = offsets[r + 1] - offsets[r];
+    component_cols.resize(num_cols);
+    for (int k = 0; k < bs; ++k)
+    {
+      const std::int32_t row = bs * rows[r] + k;
+      for (std::int32_t j = 0; j < num_cols; ++j)
+        component_cols[j] = bs * cols[offsets[r] + j] + k;
+      add(1, &row, num_cols, component_cols.data(),
+          values.data() + offsets[r]);
+    }
+  }
+  P.apply(la::PETScMatrix::AssemblyType::FINAL);
+
+  return P;
+}
+//-----------------------------------------------------------------------------
+void refinement::set_pcmg_interpolation(PC pc,
+                                        const std::vector<Mat>& prolongations)
+{
+  PetscErrorCode ierr = PCSetType(pc, PCMG);
+  if (ierr != 0)
+    la::petsc_error(ierr, __FILE__, "PCSetType");
+  ierr = PCMGSetLevels(pc, prolongations.size() + 1, nullptr);
+  if (ierr != 0)
+    la::petsc_error(ierr, __FILE__, "PCMGSetLevels");
+  for (std::size_t l = 0; l < prolongations.size(); ++l)
+  {
+    ierr = PCMGSetInterpolation(pc, l + 1, prolongations[l]);
+    if (ierr != 0)
+      la::petsc_error(ierr, __FILE__, "PCMGSetInterpolation");
+  }
+}
+//-----------------------------------------------------------------------------
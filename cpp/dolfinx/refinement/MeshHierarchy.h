@@ -0,0 +1,102 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "PlazaRefinementND.h"
+#include <cstdint>
+#include <memory>
+#include <petscmat.h>
+#include <petscpc.h>
+#include <vector>
+
+namespace dolfinx
+{
+namespace function
+{
+class FunctionSpace;
+}
+
+namespace la
+{
+class PETScMatrix;
+}
+
+namespace mesh
+{
+class Mesh;
+}
+
+namespace refinement
+{
+
+/// A hierarchy of nested meshes, created by uniform refinement of a
+/// coarse mesh without redistribution, with the parent cells of the
+/// cells of each refined mesh. The prolongation matrices between
+/// Lagrange spaces on consecutive levels (see create_prolongation) are
+/// the interpolation operators of geometric multigrid.
+
+class MeshHierarchy
+{
+public:
+  /// Create a hierarchy by uniform refinement (collective)
+  /// @param[in] mesh The coarsest mesh (level 0)
+  /// @param[in] num_refinements The number of refinements, i.e. the
+  ///   number of levels is num_refinements + 1
+  MeshHierarchy(std::shared_ptr<const mesh::Mesh> mesh, int num_refinements);
+
+  /// Number of levels (meshes)
+  int num_levels() const;
+
+  /// The mesh of a level
+  /// @param[in] level The level (0 is the coarsest mesh)
+  /// @return The mesh
+  std::shared_ptr<const mesh::Mesh> mesh(int level) const;
+
+  /// The parent cell (local index in the mesh of level - 1) of each
+  /// cell of the mesh of a level
+  /// @param[in] level The level (greater than zero)
+  /// @return The parent cells
+  const std::vector<std::int32_t>& parent_cells(int level) const;
+
+  /// The relations of the mesh of a level to the mesh of level - 1,
+  /// e.g. for the transfer of MeshTags (see refine_meshtags)
+  /// @param[in] level The level (greater than zero)
+  /// @return The parent maps
+  const PlazaRefinementND::ParentMaps& parents(int level) const;
+
+private:
+  std::vector<std::shared_ptr<const mesh::Mesh>> _meshes;
+  std::vector<PlazaRefinementND::ParentMaps> _parents;
+};
+
+/// Create the prolongation matrix P from a Lagrange space V0 on a mesh
+/// to a Lagrange space V1 on a refinement of the mesh (collective),
+/// i.e. P interpolates the functions of V0 at the dofs of V1. Entry
+/// (i, j) is basis function j of V0 evaluated at dof i of V1 (for the
+/// same component of a vector space). The entries are computed in the
+/// parent cells, without searches.
+/// @param[in] V0 The coarse space
+/// @param[in] V1 The fine space, on a mesh refined from the mesh of
+///   @p V0 without redistribution
+/// @param[in] parent_cells The parent cell in the mesh of @p V0 of each
+///   cell of the mesh of @p V1
+/// @return The prolongation matrix (rows are the dofs of @p V1)
+la::PETScMatrix
+create_prolongation(const function::FunctionSpace& V0,
+                    const function::FunctionSpace& V1,
+                    const std::vector<std::int32_t>& parent_cells);
+
+/// Set up a PETSc multigrid preconditioner (PCMG) with the levels and
+/// interpolation operators of a hierarchy. The operators of the levels
+/// can then be set, or computed with PCMGSetGalerkin.
+/// @param[in] pc The preconditioner. The type is set to PCMG.
+/// @param[in] prolongations The interpolation operator from level l to
+///   level l + 1, for l = 0, ..., the number of levels - 2
+void set_pcmg_interpolation(PC pc, const std::vector<Mat>& prolongations);
+
+} // namespace refinement
+} // namespace dolfinx
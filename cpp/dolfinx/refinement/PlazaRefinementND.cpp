@@ -6,14 +6,19 @@
 
 #include "PlazaRefinementND.h"
 #include "utils.h"
+#include <algorithm>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/ThreadPool.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
 #include <dolfinx/mesh/Topology.h>
+#include <dolfinx/mesh/cell_types.h>
 #include <limits>
 #include <map>
+#include <numeric>
+#include <utility>
 #include <vector>
 
 using namespace dolfinx;
@@ -25,6 +30,12 @@ namespace
 //-----------------------------------------------------------------------------
 // Propagate edge markers according to rules (longest edge of each
 // face must be marked, if any edge of face is marked)
+//
+// The markers are propagated locally to a fixed point between the
+// exchanges of the shared edges. The exchanges stop after a round in
+// which no process sent edges, which is detected by a non-blocking
+// reduction that overlaps with the exchange and the subsequent local
+// propagation, i.e. there is one (hidden) global reduction per round.
 void enforce_rules(
     const MPI_Comm& neighbor_comm,
     const std::map<std::int32_t, std::set<std::int32_t>>& shared_edges,
@@ -42,8 +53,11 @@ void enforce_rules(
   assert(map_f);
   const std::int32_t num_faces = map_f->size_local() + map_f->num_ghosts();
 
+  mesh.topology_mutable().create_connectivity(1, 2);
   auto f_to_e = mesh.topology().connectivity(2, 1);
   assert(f_to_e);
+  auto e_to_f = mesh.topology().connectivity(1, 2);
+  assert(e_to_f);
 
   // Get number of neighbors
   int indegree(-1), outdegree(-2), weighted(-1);
@@ -53,17 +67,32 @@ void enforce_rules(
   const int num_neighbors = indegree;
   std::vector<std::vector<std::int32_t>> marked_for_update(num_neighbors);
 
-  std::int32_t update_count = 1;
-  while (update_count > 0)
-  {
-    update_count = 0;
-    refinement::update_logical_edgefunction(neighbor_comm, marked_for_update,
-                                            marked_edges, *map_e);
-    for (int i = 0; i < num_neighbors; ++i)
-      marked_for_update[i].clear();
+  // Faces to check, initially all faces
+  std::vector<std::int32_t> faces(num_faces);
+  std::iota(faces.begin(), faces.end(), 0);
+  std::vector<bool> in_list(num_faces, true);
+  auto add_faces = [&](std::int32_t e) {
+    auto edge_faces = e_to_f->links(e);
+    for (int i = 0; i < edge_faces.rows(); ++i)
+    {
+      if (!in_list[edge_faces[i]])
+      {
+        in_list[edge_faces[i]] = true;
+        faces.push_back(edge_faces[i]);
+      }
+    }
+  };
 
-    for (int f = 0; f < num_faces; ++f)
+  // Mark the longest edge of the faces to check with a marked edge,
+  // until the rule holds for all faces. The faces of a newly marked
+  // edge are checked (again).
+  auto propagate = [&]() {
+    while (!faces.empty())
     {
+      const std::int32_t f = faces.back();
+      faces.pop_back();
+      in_list[f] = false;
+
       const std::int32_t long_e = long_edge[f];
       if (marked_edges[long_e])
         continue;
@@ -75,25 +104,44 @@ void enforce_rules(
 
       if (any_marked)
       {
-        if (!marked_edges[long_e])
-        {
-          marked_edges[long_e] = true;
+        marked_edges[long_e] = true;
+        add_faces(long_e);
 
-          // If it is a shared edge, add all sharing neighbors to update set
-          if (auto map_it = shared_edges.find(long_e);
-              map_it != shared_edges.end())
-          {
-            for (int p : map_it->second)
-              marked_for_update[p].push_back(long_e);
-          }
+        // If it is a shared edge, add all sharing neighbors to update set
+        if (auto map_it = shared_edges.find(long_e);
+            map_it != shared_edges.end())
+        {
+          for (int p : map_it->second)
+            marked_for_update[p].push_back(long_e);
         }
-        ++update_count;
       }
     }
+  };
 
-    const std::int32_t update_count_old = update_count;
-    MPI_Allreduce(&update_count_old, &update_count, 1, MPI_INT32_T, MPI_SUM,
-                  mesh.mpi_comm());
+  propagate();
+  int sent = 0, any_sent = 0;
+  while (true)
+  {
+    sent = std::any_of(marked_for_update.begin(), marked_for_update.end(),
+                       [](auto& edges) { return !edges.empty(); });
+    MPI_Request request;
+    MPI_Iallreduce(&sent, &any_sent, 1, MPI_INT, MPI_LOR, mesh.mpi_comm(),
+                   &request);
+
+    const std::vector<std::int32_t> received
+        = refinement::update_logical_edgefunction(
+            neighbor_comm, marked_for_update, marked_edges, *map_e);
+    for (int i = 0; i < num_neighbors; ++i)
+      marked_for_update[i].clear();
+    for (std::int32_t e : received)
+      add_faces(e);
+    propagate();
+
+    // If no process sent edges, no process received edges and the
+    // local propagation was already at a fixed point
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+    if (!any_sent)
+      break;
   }
 }
 //-----------------------------------------------------------------------------
@@ -382,26 +430,80 @@ face_long_edge(const mesh::Mesh& mesh)
   return std::pair(std::move(long_edge), std::move(edge_ratio_ok));
 }
 //-----------------------------------------------------------------------------
-// Convenient interface for both uniform and marker refinement
-mesh::Mesh compute_refinement(
+// Get the facets of a simplex cell containing the points of its
+// subdivision (see get_simplices), in the order [vertices][edges]
+Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+point_on_facet(mesh::CellType cell_type)
+{
+  const int tdim = mesh::cell_dim(cell_type);
+  const int num_vertices = tdim + 1;
+  const Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      edge_vertices = mesh::get_entity_vertices(cell_type, 1);
+
+  // Facet k (opposite vertex k) contains the vertices other than k,
+  // and the midpoints of the edges that do not have k as an end
+  Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      on_facet(num_vertices + edge_vertices.rows(), num_vertices);
+  on_facet = true;
+  for (int v = 0; v < num_vertices; ++v)
+    on_facet(v, v) = false;
+  for (int e = 0; e < edge_vertices.rows(); ++e)
+  {
+    on_facet(num_vertices + e, edge_vertices(e, 0)) = false;
+    on_facet(num_vertices + e, edge_vertices(e, 1)) = false;
+  }
+
+  return on_facet;
+}
+//-----------------------------------------------------------------------------
+// Find the facet of a parent cell that contains facet i (opposite point
+// i) of a new cell, for each facet of the new cell, or -1 if it is
+// interior. The points of the new cell are in the cell local indexing
+// [vertices][edges] of the parent cell.
+void parent_facets(
+    const std::int32_t* points,
+    const Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        on_facet,
+    std::int8_t* facets)
+{
+  const int num_cell_vertices = on_facet.cols();
+  for (int i = 0; i < num_cell_vertices; ++i)
+  {
+    std::int8_t facet = -1;
+    for (int k = 0; k < num_cell_vertices and facet < 0; ++k)
+    {
+      bool on_k = true;
+      for (int j = 0; j < num_cell_vertices; ++j)
+        on_k = on_k and (j == i or on_facet(points[j], k));
+      if (on_k)
+        facet = k;
+    }
+    facets[i] = facet;
+  }
+}
+//-----------------------------------------------------------------------------
+// Convenient interface for both uniform and marker refinement. The
+// parent maps are computed if compute_parents is true, which requires
+// that the mesh is not redistributed. The cells are subdivided, and the
+// new vertices created, on num_threads threads.
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps> compute_refinement(
     const MPI_Comm& neighbor_comm, const std::vector<bool>& marked_edges,
     const std::map<std::int32_t, std::set<std::int32_t>> shared_edges,
     const mesh::Mesh& mesh, const std::vector<std::int32_t>& long_edge,
-    const std::vector<bool>& edge_ratio_ok, bool redistribute)
+    const std::vector<bool>& edge_ratio_ok, bool redistribute,
+    bool compute_parents, int num_threads)
 {
   const std::int32_t tdim = mesh.topology().dim();
   const std::int32_t num_cell_edges = tdim * 3 - 3;
   const std::int32_t num_cell_vertices = tdim + 1;
 
   // Make new vertices in parallel
-  const auto [new_vertex_map, new_vertex_coordinates]
-      = refinement::create_new_vertices(neighbor_comm, shared_edges, mesh,
-                                        marked_edges);
-
-  std::vector<std::size_t> parent_cell;
-  std::vector<std::int64_t> indices(num_cell_vertices + num_cell_edges);
-  std::vector<int> marked_edge_list;
-  std::vector<std::int32_t> simplex_set;
+  const auto new_vertices = refinement::create_new_vertices(
+      neighbor_comm, shared_edges, mesh, marked_edges, num_threads);
+  const std::map<std::int32_t, std::int64_t>& new_vertex_map
+      = new_vertices.first;
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+      new_vertex_coordinates = new_vertices.second;
 
   auto map_c = mesh.topology().index_map(tdim);
   assert(map_c);
@@ -413,6 +515,9 @@ mesh::Mesh compute_refinement(
   auto c_to_f = mesh.topology().connectivity(tdim, 2);
   assert(c_to_f);
 
+  const Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      on_facet = point_on_facet(mesh.topology().cell_type());
+
   std::int32_t num_new_vertices_local = std::count(
       marked_edges.begin(),
       marked_edges.begin() + mesh.topology().index_map(1)->size_local(), true);
@@ -420,39 +525,60 @@ mesh::Mesh compute_refinement(
   std::vector<std::int64_t> global_indices = refinement::adjust_indices(
       mesh.topology().index_map(0), num_new_vertices_local);
 
+  // New cells of a contiguous chunk of the cells
+  struct Chunk
+  {
+    std::vector<std::int64_t> cell_topology;
+    std::vector<std::int32_t> parent_cell;
+    std::vector<std::int8_t> parent_facet;
+    int num_ghost_cells = 0;
+  };
+
+  // Subdivide the cells [c0, c1) into a chunk. The mesh data are only
+  // read, so chunks are subdivided concurrently.
   const int num_cells = map_c->size_local();
   const int num_ghost_cells = map_c->num_ghosts();
-  std::vector<std::int64_t> cell_topology;
-  int num_new_ghost_cells = 0;
-  for (int c = 0; c < num_cells + num_ghost_cells; ++c)
-  {
-    // Create vector of indices in the order [vertices][edges], 3+3 in
-    // 2D, 4+6 in 3D
-
-    // Copy vertices
-    auto vertices = c_to_v->links(c);
-    for (int v = 0; v < vertices.rows(); ++v)
-      indices[v] = global_indices[vertices[v]];
-
-    // Get cell-local indices of marked edges
-    marked_edge_list.clear();
-    auto edges = c_to_e->links(c);
-    for (int ei = 0; ei < edges.rows(); ++ei)
-      if (marked_edges[edges[ei]])
-        marked_edge_list.push_back(ei);
-
-    if (marked_edge_list.empty())
+  auto subdivide = [&](Chunk& chunk, std::int32_t c0, std::int32_t c1) {
+    std::vector<std::int64_t> indices(num_cell_vertices + num_cell_edges);
+    std::vector<int> marked_edge_list;
+    std::vector<bool> markers(num_cell_edges);
+    std::vector<std::int32_t> longest_edge, simplex_set;
+    for (std::int32_t c = c0; c < c1; ++c)
     {
-      // Copy over existing Cell to new topology
+      // Create vector of indices in the order [vertices][edges], 3+3
+      // in 2D, 4+6 in 3D
+
+      // Copy vertices
+      auto vertices = c_to_v->links(c);
       for (int v = 0; v < vertices.rows(); ++v)
-        cell_topology.push_back(global_indices[vertices[v]]);
-      parent_cell.push_back(c);
-    }
-    else
-    {
+        indices[v] = global_indices[vertices[v]];
+
+      // Get cell-local indices of marked edges
+      marked_edge_list.clear();
+      auto edges = c_to_e->links(c);
+      for (int ei = 0; ei < edges.rows(); ++ei)
+        if (marked_edges[edges[ei]])
+          marked_edge_list.push_back(ei);
+
+      if (marked_edge_list.empty())
+      {
+        // Copy over existing Cell to new topology
+        for (int v = 0; v < vertices.rows(); ++v)
+          chunk.cell_topology.push_back(global_indices[vertices[v]]);
+        chunk.parent_cell.push_back(c);
+        if (compute_parents)
+        {
+          for (int i = 0; i < num_cell_vertices; ++i)
+            chunk.parent_facet.push_back(i);
+        }
+        if (c >= num_cells)
+          ++chunk.num_ghost_cells;
+        continue;
+      }
+
       // Get the marked edge indices for new vertices and make bool
       // vector of marked edges
-      std::vector<bool> markers(num_cell_edges, false);
+      std::fill(markers.begin(), markers.end(), false);
       for (int p : marked_edge_list)
       {
         markers[p] = true;
@@ -464,13 +590,12 @@ mesh::Mesh compute_refinement(
       // Need longest edges of each face in cell local indexing.
       // NB in 2D the face is the cell itself, and there is just one
       // entry
-      std::vector<std::int32_t> longest_edge;
+      longest_edge.clear();
       auto faces = c_to_f->links(c);
       for (int f = 0; f < faces.rows(); ++f)
         longest_edge.push_back(long_edge[faces(f)]);
 
       // Convert to cell local index
-      auto edges = c_to_e->links(c);
       for (std::int32_t& p : longest_edge)
       {
         for (int ej = 0; ej < edges.rows(); ++ej)
@@ -491,30 +616,95 @@ mesh::Mesh compute_refinement(
       // Save parent index
       const std::int32_t ncells = simplex_set.size() / num_cell_vertices;
       for (std::int32_t i = 0; i < ncells; ++i)
-        parent_cell.push_back(c);
+        chunk.parent_cell.push_back(c);
 
       // Count up new ghost cells
       if (c >= num_cells)
-        num_new_ghost_cells += ncells;
+        chunk.num_ghost_cells += ncells;
 
       // Convert from cell local index to mesh index and add to cells
       for (std::int32_t v : simplex_set)
-        cell_topology.push_back(indices[v]);
+        chunk.cell_topology.push_back(indices[v]);
+
+      // Find the facet of the parent cell that contains all points of
+      // facet i (opposite point i) of each new cell, if any
+      if (compute_parents)
+      {
+        const std::size_t offset = chunk.parent_facet.size();
+        chunk.parent_facet.resize(offset + simplex_set.size());
+        for (std::size_t p = 0; p < simplex_set.size();
+             p += num_cell_vertices)
+        {
+          parent_facets(simplex_set.data() + p, on_facet,
+                        chunk.parent_facet.data() + offset + p);
+        }
+      }
     }
+  };
+
+  const std::int32_t num_cells_all = num_cells + num_ghost_cells;
+  const int num_chunks = std::max(1, std::min(num_threads, num_cells_all));
+  std::vector<Chunk> chunks(num_chunks);
+  common::parallel_for(num_chunks, num_cells_all,
+                       [&](int i, std::int32_t c0, std::int32_t c1) {
+                         subdivide(chunks[i], c0, c1);
+                       });
+
+  // Offsets of the new cells of the chunks (prefix sum of the counts).
+  // The new cells are in the order of the cells, as for the serial
+  // subdivision.
+  std::vector<std::size_t> offsets(num_chunks + 1, 0);
+  int num_new_ghost_cells = 0;
+  for (int i = 0; i < num_chunks; ++i)
+  {
+    offsets[i + 1] = offsets[i] + chunks[i].parent_cell.size();
+    num_new_ghost_cells += chunks[i].num_ghost_cells;
   }
 
-  const bool serial = (dolfinx::MPI::size(mesh.mpi_comm()) == 1);
-  if (serial)
-    return refinement::build_local(mesh, cell_topology, new_vertex_coordinates);
-  else
-    return refinement::partition(mesh, cell_topology, num_new_ghost_cells,
-                                 new_vertex_coordinates, redistribute);
+  // Copy the chunks into the preallocated arrays
+  const std::size_t num_new_cells = offsets.back();
+  std::vector<std::int64_t> cell_topology(num_new_cells * num_cell_vertices);
+  std::vector<std::int32_t> parent_cell(num_new_cells);
+  std::vector<std::int8_t> parent_facet(
+      compute_parents ? num_new_cells * num_cell_vertices : 0);
+  common::parallel_for(
+      num_chunks, num_chunks, [&](int, std::int32_t i0, std::int32_t i1) {
+        for (std::int32_t i = i0; i < i1; ++i)
+        {
+          const Chunk& chunk = chunks[i];
+          std::copy(chunk.cell_topology.begin(), chunk.cell_topology.end(),
+                    cell_topology.begin() + offsets[i] * num_cell_vertices);
+          std::copy(chunk.parent_cell.begin(), chunk.parent_cell.end(),
+                    parent_cell.begin() + offsets[i]);
+          std::copy(chunk.parent_facet.begin(), chunk.parent_facet.end(),
+                    parent_facet.begin() + offsets[i] * num_cell_vertices);
+        }
+      });
+  chunks.clear();
+
+  // The global indices of the vertices and of the new vertex of each
+  // edge
+  std::vector<std::vector<std::int64_t>> new_indices
+      = {std::move(global_indices),
+         std::vector<std::int64_t>(marked_edges.size(), -1)};
+  for (auto [e, v] : new_vertex_map)
+    new_indices[1][e] = v;
+
+  return refinement::create_refined_mesh(
+      mesh, cell_topology, num_new_ghost_cells, new_vertex_coordinates,
+      redistribute, compute_parents, std::move(parent_cell),
+      std::move(parent_facet), new_indices, num_threads);
 }
 //-----------------------------------------------------------------------------
-} // namespace
-
-//-----------------------------------------------------------------------------
-mesh::Mesh PlazaRefinementND::refine(const mesh::Mesh& mesh, bool redistribute)
+// Uniform refinement, with the same subdivision of every cell: 1:4 for
+// triangles (the regular subdivision) and 1:8 for tetrahedra (the
+// corner tetrahedra and the inner octahedron split along its shortest
+// diagonal). No edges are marked, and the global index of the new
+// vertex of each edge, owned or ghost, is computed from the vertex and
+// edge ranges of its owner (see create_new_vertex_indices).
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps>
+refine_uniform(const mesh::Mesh& mesh, bool redistribute, bool compute_parents,
+               int num_threads)
 {
   if (mesh.topology().cell_type() != mesh::CellType::triangle
       and mesh.topology().cell_type() != mesh::CellType::tetrahedron)
@@ -522,27 +712,157 @@ mesh::Mesh PlazaRefinementND::refine(const mesh::Mesh& mesh, bool redistribute)
     throw std::runtime_error("Cell type not supported");
   }
 
-  common::Timer t0("PLAZA: refine");
-
-  auto [neighbor_comm, shared_edges] = refinement::compute_edge_sharing(mesh);
+  common::Timer t0("PLAZA: refine uniform");
 
-  // Mark all edges
+  const int tdim = mesh.topology().dim();
+  const int num_cell_vertices = tdim + 1;
+  const int num_cell_edges = tdim * 3 - 3;
+  mesh.topology_mutable().create_entities(1);
+  mesh.topology_mutable().create_connectivity(tdim, 1);
   auto map_e = mesh.topology().index_map(1);
-  std::vector<bool> marked_edges(map_e->size_local() + map_e->num_ghosts(),
-                                 true);
+  assert(map_e);
+  auto map_c = mesh.topology().index_map(tdim);
+  assert(map_c);
+  auto c_to_v = mesh.topology().connectivity(tdim, 0);
+  assert(c_to_v);
+  auto c_to_e = mesh.topology().connectivity(tdim, 1);
+  assert(c_to_e);
 
-  const auto [long_edge, edge_ratio_ok] = face_long_edge(mesh);
-  mesh::Mesh new_mesh
-      = compute_refinement(neighbor_comm, marked_edges, shared_edges, mesh,
-                           long_edge, edge_ratio_ok, redistribute);
-  MPI_Comm_free(&neighbor_comm);
-  return new_mesh;
+  // Every edge has a new vertex, numbered after the vertices of its
+  // owner
+  const std::vector<std::vector<std::int64_t>> new_indices
+      = refinement::create_new_vertex_indices(mesh, 1);
+  const std::vector<std::int64_t>& vertex_index = new_indices[0];
+  const std::vector<std::int64_t>& new_vertex = new_indices[1];
+
+  // Owned vertices followed by the midpoints of the owned edges
+  std::vector<std::vector<std::int32_t>> entities(2);
+  for (int d = 0; d < 2; ++d)
+  {
+    entities[d].resize(mesh.topology().index_map(d)->size_local());
+    std::iota(entities[d].begin(), entities[d].end(), 0);
+  }
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      new_vertex_coordinates
+      = refinement::create_new_geometry(mesh, entities, num_threads);
+
+  // New cells of a cell, in the cell local indexing [vertices][edges],
+  // for each diagonal d of the octahedron in 3D (between the midpoints
+  // of the opposite edges d and 5 - d): the corner tetrahedra, and the
+  // tetrahedra around the diagonal, with the other midpoints in cyclic
+  // order
+  std::vector<std::vector<std::int32_t>> subdivisions;
+  if (tdim == 2)
+    subdivisions.push_back({0, 5, 4, 1, 3, 5, 2, 4, 3, 3, 4, 5});
+  else
+  {
+    for (int d = 0; d < 3; ++d)
+    {
+      std::vector<std::int32_t>& subdivision = subdivisions.emplace_back(
+          std::vector<std::int32_t>{0, 7, 8, 9, 1, 5, 6, 9, 2, 4, 6, 8, 3, 4,
+                                    5, 7});
+      const int d1 = (d + 1) % 3;
+      const int d2 = (d + 2) % 3;
+      const std::array<std::int32_t, 4> cycle
+          = {4 + d1, 4 + d2, 9 - d1, 9 - d2};
+      for (int k = 0; k < 4; ++k)
+      {
+        subdivision.insert(subdivision.end(),
+                           {4 + d, 9 - d, cycle[k], cycle[(k + 1) % 4]});
+      }
+    }
+  }
+  const int num_children = subdivisions[0].size() / num_cell_vertices;
+
+  // The end vertices of the opposite edges d and 5 - d
+  const int diagonal_vertices[3][4]
+      = {{2, 3, 0, 1}, {1, 3, 0, 2}, {1, 2, 0, 3}};
+
+  // The parent facets of the new cells of each subdivision
+  const Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      on_facet = point_on_facet(mesh.topology().cell_type());
+  std::vector<std::vector<std::int8_t>> subdivision_facets;
+  for (const std::vector<std::int32_t>& subdivision : subdivisions)
+  {
+    std::vector<std::int8_t>& facets = subdivision_facets.emplace_back(
+        subdivision.size());
+    for (std::size_t p = 0; p < subdivision.size(); p += num_cell_vertices)
+      parent_facets(subdivision.data() + p, on_facet, facets.data() + p);
+  }
+
+  // Subdivide the cells, with the new cells of a cell at a fixed offset
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
+      = mesh.geometry().x();
+  const std::int32_t num_cells = map_c->size_local() + map_c->num_ghosts();
+  const std::size_t num_new_cells = (std::size_t)num_cells * num_children;
+  std::vector<std::int64_t> cell_topology(num_new_cells * num_cell_vertices);
+  std::vector<std::int32_t> parent_cell(num_new_cells);
+  std::vector<std::int8_t> parent_facet(
+      compute_parents ? num_new_cells * num_cell_vertices : 0);
+  common::parallel_for(
+      num_threads, num_cells, [&](int, std::int32_t c0, std::int32_t c1) {
+        std::array<std::int64_t, 10> indices;
+        for (std::int32_t c = c0; c < c1; ++c)
+        {
+          auto vertices = c_to_v->links(c);
+          for (int v = 0; v < num_cell_vertices; ++v)
+            indices[v] = vertex_index[vertices[v]];
+          auto cell_edges = c_to_e->links(c);
+          for (int e = 0; e < num_cell_edges; ++e)
+            indices[num_cell_vertices + e] = new_vertex[cell_edges[e]];
+
+          // Shortest diagonal of the octahedron (twice the length)
+          // FIXME: We are making an assumption here on the
+          // ElementDofLayout
+          int d = 0;
+          if (tdim == 3)
+          {
+            auto x = x_dofmap.links(c);
+            double min_length = std::numeric_limits<double>::max();
+            for (int i = 0; i < 3; ++i)
+            {
+              const int* v = diagonal_vertices[i];
+              const double length
+                  = (x_g.row(x[v[0]]) + x_g.row(x[v[1]]) - x_g.row(x[v[2]])
+                     - x_g.row(x[v[3]]))
+                        .matrix()
+                        .norm();
+              if (length < min_length)
+              {
+                min_length = length;
+                d = i;
+              }
+            }
+          }
+
+          const std::vector<std::int32_t>& subdivision = subdivisions[d];
+          const std::size_t offset = (std::size_t)c * num_children;
+          for (std::size_t i = 0; i < subdivision.size(); ++i)
+            cell_topology[offset * num_cell_vertices + i]
+                = indices[subdivision[i]];
+          std::fill_n(parent_cell.begin() + offset, num_children, c);
+          if (compute_parents)
+          {
+            std::copy(subdivision_facets[d].begin(),
+                      subdivision_facets[d].end(),
+                      parent_facet.begin() + offset * num_cell_vertices);
+          }
+        }
+      });
+
+  return refinement::create_refined_mesh(
+      mesh, cell_topology, map_c->num_ghosts() * num_children,
+      new_vertex_coordinates, redistribute, compute_parents,
+      std::move(parent_cell), std::move(parent_facet), new_indices,
+      num_threads);
 }
 //-----------------------------------------------------------------------------
-mesh::Mesh
-PlazaRefinementND::refine(const mesh::Mesh& mesh,
-                          const mesh::MeshTags<std::int8_t>& refinement_marker,
-                          bool redistribute)
+// Refinement of marked entities
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps>
+refine_marked(const mesh::Mesh& mesh,
+              const mesh::MeshTags<std::int8_t>& refinement_marker,
+              bool redistribute, bool compute_parents, int num_threads)
 {
   if (mesh.topology().cell_type() != mesh::CellType::triangle
       and mesh.topology().cell_type() != mesh::CellType::tetrahedron)
@@ -607,10 +927,44 @@ PlazaRefinementND::refine(const mesh::Mesh& mesh,
   const auto [long_edge, edge_ratio_ok] = face_long_edge(mesh);
   enforce_rules(neighbor_comm, shared_edges, marked_edges, mesh, long_edge);
 
-  mesh::Mesh new_mesh
+  auto refined
       = compute_refinement(neighbor_comm, marked_edges, shared_edges, mesh,
-                           long_edge, edge_ratio_ok, redistribute);
+                           long_edge, edge_ratio_ok, redistribute,
+                           compute_parents, num_threads);
   MPI_Comm_free(&neighbor_comm);
-  return new_mesh;
+  return refined;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+mesh::Mesh PlazaRefinementND::refine(const mesh::Mesh& mesh, bool redistribute,
+                                     int num_threads)
+{
+  return refine_uniform(mesh, redistribute, false, num_threads).first;
+}
+//-----------------------------------------------------------------------------
+mesh::Mesh
+PlazaRefinementND::refine(const mesh::Mesh& mesh,
+                          const mesh::MeshTags<std::int8_t>& refinement_marker,
+                          bool redistribute, int num_threads)
+{
+  return refine_marked(mesh, refinement_marker, redistribute, false,
+                       num_threads)
+      .first;
+}
+//-----------------------------------------------------------------------------
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps>
+PlazaRefinementND::refine_with_parents(const mesh::Mesh& mesh)
+{
+  return refine_uniform(mesh, false, true, 1);
+}
+//-----------------------------------------------------------------------------
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps>
+PlazaRefinementND::refine_with_parents(
+    const mesh::Mesh& mesh,
+    const mesh::MeshTags<std::int8_t>& refinement_marker)
+{
+  return refine_marked(mesh, refinement_marker, false, true, 1);
 }
 //-----------------------------------------------------------------------------
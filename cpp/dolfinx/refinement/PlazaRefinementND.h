@@ -31,14 +31,41 @@ class ParallelRefinement;
 namespace PlazaRefinementND
 {
 
+/// Relations between the entities of a refined mesh and of the mesh it
+/// was refined from (the parent mesh), on each process, e.g. for the
+/// transfer of functions and data without searches
+struct ParentMaps
+{
+  /// The parent cell (local index in the parent mesh) of each cell of
+  /// the refined mesh
+  std::vector<std::int32_t> parent_cell;
+
+  /// The parent facets of the facets of the cells of the refined mesh.
+  /// Entry num_facets * c + i, with num_facets the number of facets of
+  /// a cell (tdim + 1 for simplices), is the index in its parent cell
+  /// of the facet of the parent cell that contains facet i of cell c,
+  /// or -1 if facet i is in the interior of the parent cell.
+  std::vector<std::int8_t> parent_facet;
+
+  /// The vertex of the refined mesh (local index) at the midpoint of
+  /// each (owned and ghost) edge of the parent mesh, or -1 if the edge
+  /// is not refined
+  std::vector<std::int32_t> edge_vertex;
+};
+
 /// Uniform refine, optionally redistributing and optionally
-/// calculating the parent-child relation for facets (in 2D)
+/// calculating the parent-child relation for facets (in 2D). Every
+/// cell is subdivided in the same way (1:4 for triangles and 1:8 for
+/// tetrahedra), without the marking of edges.
 ///
 /// @param[in] mesh Input mesh to be refined
 /// @param[in] redistribute Flag to call the Mesh Partitioner to
 ///   redistribute after refinement
+/// @param[in] num_threads The number of threads for the subdivision of
+///   the cells
 /// @return New mesh
-mesh::Mesh refine(const mesh::Mesh& mesh, bool redistribute);
+mesh::Mesh refine(const mesh::Mesh& mesh, bool redistribute,
+                  int num_threads = 1);
 
 /// Refine with markers, optionally redistributing
 ///
@@ -48,10 +75,31 @@ mesh::Mesh refine(const mesh::Mesh& mesh, bool redistribute);
 ///   any other value means "do not refine".
 /// @param[in] redistribute Flag to call the Mesh Partitioner to
 ///   redistribute after refinement
+/// @param[in] num_threads The number of threads for the subdivision of
+///   the cells
 /// @return New Mesh
 mesh::Mesh refine(const mesh::Mesh& mesh,
                   const mesh::MeshTags<std::int8_t>& refinement_marker,
-                  bool redistribute);
+                  bool redistribute, int num_threads = 1);
+
+/// Uniform refine without redistribution, and compute the relations
+/// of the refined mesh to the input mesh
+///
+/// @param[in] mesh Input mesh to be refined
+/// @return New mesh, and its relations to @p mesh
+std::pair<mesh::Mesh, ParentMaps> refine_with_parents(const mesh::Mesh& mesh);
+
+/// Refine with markers without redistribution, and compute the
+/// relations of the refined mesh to the input mesh
+///
+/// @param[in] mesh Input mesh to be refined
+/// @param[in] refinement_marker MeshTags listing mesh entities which
+///   should be split by this refinement. Value == 1 means "refine",
+///   any other value means "do not refine".
+/// @return New mesh, and its relations to @p mesh
+std::pair<mesh::Mesh, ParentMaps>
+refine_with_parents(const mesh::Mesh& mesh,
+                    const mesh::MeshTags<std::int8_t>& refinement_marker);
 
 } // namespace PlazaRefinementND
 } // namespace refinement
@@ -0,0 +1,249 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "TensorProductRefinement.h"
+#include "utils.h"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/ThreadPool.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <dolfinx/mesh/cell_types.h>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace dolfinx;
+using namespace dolfinx::refinement;
+
+namespace
+{
+
+// A point of the subdivision of a cell: a vertex, or the midpoint of an
+// edge, a face or the cell. The vertices of the entity are a bit mask
+// of the cell local vertices.
+struct Point
+{
+  int dim;
+  int entity;
+  int vertices;
+};
+
+//-----------------------------------------------------------------------------
+// Get the points of the subdivision of a quadrilateral or hexahedron,
+// which are on the lattice {0, 1, 2}^tdim (point i + 3j + 9k at (i, j,
+// k) / 2 on the reference cell). Vertex v of the cell is at the
+// lattice point with coordinate 2 * ((v >> a) & 1) in direction a.
+std::vector<Point> lattice_points(mesh::CellType cell_type)
+{
+  const int tdim = mesh::cell_dim(cell_type);
+  const int num_vertices = mesh::cell_num_entities(cell_type, 0);
+  int num_points = 1;
+  for (int a = 0; a < tdim; ++a)
+    num_points *= 3;
+
+  std::vector<Point> points(num_points);
+  for (int p = 0; p < num_points; ++p)
+  {
+    std::array<int, 3> x = {0, 0, 0};
+    for (int a = 0, q = p; a < tdim; ++a, q /= 3)
+      x[a] = q % 3;
+
+    // The entity is spanned by the vertices that agree with the point
+    // in the directions in which the point is not a midpoint
+    Point& point = points[p];
+    point.dim = std::count(x.begin(), x.begin() + tdim, 1);
+    point.vertices = 0;
+    for (int v = 0; v < num_vertices; ++v)
+    {
+      bool in_entity = true;
+      for (int a = 0; a < tdim; ++a)
+        in_entity = in_entity and (x[a] == 1 or ((v >> a) & 1) == x[a] / 2);
+      if (in_entity)
+        point.vertices |= 1 << v;
+    }
+
+    point.entity = 0;
+    if (point.dim < tdim)
+    {
+      const Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+          entity_vertices = mesh::get_entity_vertices(cell_type, point.dim);
+      point.entity = -1;
+      for (int e = 0; e < entity_vertices.rows() and point.entity < 0; ++e)
+      {
+        int vertices = 0;
+        for (int j = 0; j < entity_vertices.cols(); ++j)
+          vertices |= 1 << entity_vertices(e, j);
+        if (vertices == point.vertices)
+          point.entity = e;
+      }
+      assert(point.entity >= 0);
+    }
+  }
+
+  return points;
+}
+//-----------------------------------------------------------------------------
+// Get the lattice points of the vertices of the new cells of a cell.
+// New cell n is at the offset ((n >> a) & 1) in direction a, with the
+// vertices in the order of the reference cell.
+std::vector<std::int32_t> subdivision(int tdim)
+{
+  const int num_children = 1 << tdim;
+  std::vector<std::int32_t> children;
+  for (int n = 0; n < num_children; ++n)
+  {
+    for (int m = 0; m < num_children; ++m)
+    {
+      std::int32_t p = 0;
+      for (int a = 0, stride = 1; a < tdim; ++a, stride *= 3)
+        p += (((n >> a) & 1) + ((m >> a) & 1)) * stride;
+      children.push_back(p);
+    }
+  }
+
+  return children;
+}
+//-----------------------------------------------------------------------------
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps>
+refine_uniform(const mesh::Mesh& mesh, bool redistribute, bool compute_parents,
+               int num_threads)
+{
+  const mesh::CellType cell_type = mesh.topology().cell_type();
+  if (cell_type != mesh::CellType::quadrilateral
+      and cell_type != mesh::CellType::hexahedron)
+  {
+    throw std::runtime_error("Cell type not supported");
+  }
+
+  common::Timer t0("Tensor product refinement: refine uniform");
+
+  const int tdim = mesh.topology().dim();
+  std::vector<std::shared_ptr<const graph::AdjacencyList<std::int32_t>>>
+      c_to_e(tdim);
+  for (int d = 0; d < tdim; ++d)
+  {
+    mesh.topology_mutable().create_entities(d);
+    mesh.topology_mutable().create_connectivity(tdim, d);
+    c_to_e[d] = mesh.topology().connectivity(tdim, d);
+    assert(c_to_e[d]);
+  }
+  auto map_c = mesh.topology().index_map(tdim);
+  assert(map_c);
+
+  // A new vertex for every entity, numbered after the vertices of its
+  // owner
+  const std::vector<std::vector<std::int64_t>> new_indices
+      = refinement::create_new_vertex_indices(mesh, tdim);
+
+  // Owned vertices followed by the midpoints of the owned entities
+  std::vector<std::vector<std::int32_t>> entities(tdim + 1);
+  for (int d = 0; d <= tdim; ++d)
+  {
+    entities[d].resize(mesh.topology().index_map(d)->size_local());
+    std::iota(entities[d].begin(), entities[d].end(), 0);
+  }
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      new_vertex_coordinates
+      = refinement::create_new_geometry(mesh, entities, num_threads);
+
+  const std::vector<Point> points = lattice_points(cell_type);
+  const std::vector<std::int32_t> children = subdivision(tdim);
+  const int num_cell_vertices = mesh::cell_num_entities(cell_type, 0);
+  const int num_children = children.size() / num_cell_vertices;
+
+  // The parent facet of each facet of the new cells: a facet of a new
+  // cell is on a facet of the parent cell if the entities of all its
+  // points are
+  const Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      facet_vertices = mesh::get_entity_vertices(cell_type, tdim - 1);
+  const int num_facets = facet_vertices.rows();
+  std::vector<int> facet_masks(num_facets, 0);
+  for (int k = 0; k < num_facets; ++k)
+    for (int j = 0; j < facet_vertices.cols(); ++j)
+      facet_masks[k] |= 1 << facet_vertices(k, j);
+  std::vector<std::int8_t> facets(num_children * num_facets, -1);
+  for (int n = 0; n < num_children; ++n)
+  {
+    for (int i = 0; i < num_facets; ++i)
+    {
+      int vertices = 0;
+      for (int j = 0; j < facet_vertices.cols(); ++j)
+      {
+        vertices |= points[children[n * num_cell_vertices
+                                    + facet_vertices(i, j)]]
+                        .vertices;
+      }
+      for (int k = 0; k < num_facets; ++k)
+        if ((vertices & ~facet_masks[k]) == 0)
+          facets[n * num_facets + i] = k;
+    }
+  }
+
+  // Subdivide the cells, with the new cells of a cell at a fixed offset
+  const std::int32_t num_cells = map_c->size_local() + map_c->num_ghosts();
+  const std::size_t num_new_cells = (std::size_t)num_cells * num_children;
+  std::vector<std::int64_t> cell_topology(num_new_cells * num_cell_vertices);
+  std::vector<std::int32_t> parent_cell(num_new_cells);
+  std::vector<std::int8_t> parent_facet(
+      compute_parents ? num_new_cells * num_facets : 0);
+  common::parallel_for(
+      num_threads, num_cells, [&](int, std::int32_t c0, std::int32_t c1) {
+        std::vector<std::int64_t> indices(points.size());
+        for (std::int32_t c = c0; c < c1; ++c)
+        {
+          for (std::size_t p = 0; p < points.size(); ++p)
+          {
+            const int dim = points[p].dim;
+            const std::int32_t e
+                = dim < tdim ? c_to_e[dim]->links(c)[points[p].entity] : c;
+            indices[p] = new_indices[dim][e];
+          }
+
+          const std::size_t offset = (std::size_t)c * num_children;
+          for (std::size_t i = 0; i < children.size(); ++i)
+          {
+            cell_topology[offset * num_cell_vertices + i]
+                = indices[children[i]];
+          }
+          std::fill_n(parent_cell.begin() + offset, num_children, c);
+          if (compute_parents)
+          {
+            std::copy(facets.begin(), facets.end(),
+                      parent_facet.begin() + offset * num_facets);
+          }
+        }
+      });
+
+  return refinement::create_refined_mesh(
+      mesh, cell_topology, map_c->num_ghosts() * num_children,
+      new_vertex_coordinates, redistribute, compute_parents,
+      std::move(parent_cell), std::move(parent_facet), new_indices,
+      num_threads);
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+mesh::Mesh TensorProductRefinement::refine(const mesh::Mesh& mesh,
+                                           bool redistribute, int num_threads)
+{
+  return refine_uniform(mesh, redistribute, false, num_threads).first;
+}
+//-----------------------------------------------------------------------------
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps>
+TensorProductRefinement::refine_with_parents(const mesh::Mesh& mesh)
+{
+  return refine_uniform(mesh, false, true, 1);
+}
+//-----------------------------------------------------------------------------
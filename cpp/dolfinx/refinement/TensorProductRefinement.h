@@ -0,0 +1,53 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "PlazaRefinementND.h"
+#include <utility>
+
+namespace dolfinx
+{
+
+namespace mesh
+{
+class Mesh;
+} // namespace mesh
+
+namespace refinement
+{
+
+/// Uniform refinement of quadrilateral and hexahedral meshes, by the
+/// tensor product subdivision of each cell into 2^tdim cells. A new
+/// vertex is created at the midpoint of each edge and (hexahedra)
+/// face, and of each cell.
+
+namespace TensorProductRefinement
+{
+
+/// Uniform refine, optionally redistributing
+///
+/// @param[in] mesh Input mesh to be refined
+/// @param[in] redistribute Flag to call the Mesh Partitioner to
+///   redistribute after refinement
+/// @param[in] num_threads The number of threads for the subdivision of
+///   the cells
+/// @return New mesh
+mesh::Mesh refine(const mesh::Mesh& mesh, bool redistribute,
+                  int num_threads = 1);
+
+/// Uniform refine without redistribution, and compute the relations
+/// of the refined mesh to the input mesh (see
+/// PlazaRefinementND::ParentMaps)
+///
+/// @param[in] mesh Input mesh to be refined
+/// @return New mesh, and the parent maps
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps>
+refine_with_parents(const mesh::Mesh& mesh);
+
+} // namespace TensorProductRefinement
+} // namespace refinement
+} // namespace dolfinx
@@ -0,0 +1,457 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "coarsen.h"
+#include "utils.h"
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/fem/DofMap.h>
+#include <dolfinx/mesh/Geometry.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+using namespace dolfinx;
+using namespace dolfinx::refinement;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// The children (local indices in the refined mesh) of each parent cell
+graph::AdjacencyList<std::int32_t>
+compute_children(const std::vector<std::int32_t>& parent_cell,
+                 std::int32_t num_parents)
+{
+  std::vector<std::int32_t> offsets(num_parents + 1, 0);
+  for (std::int32_t p : parent_cell)
+    ++offsets[p + 1];
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<std::int32_t> children(parent_cell.size());
+  std::vector<std::int32_t> pos(offsets.begin(), offsets.end() - 1);
+  for (std::size_t c = 0; c < parent_cell.size(); ++c)
+    children[pos[parent_cell[c]]++] = c;
+  return graph::AdjacencyList<std::int32_t>(std::move(children),
+                                            std::move(offsets));
+}
+//-----------------------------------------------------------------------------
+// The geometry node of each vertex of a mesh
+// FIXME: We are making an assumption here on the ElementDofLayout
+std::vector<std::int32_t> vertex_to_node(const mesh::Mesh& mesh)
+{
+  const int tdim = mesh.topology().dim();
+  auto map_v = mesh.topology().index_map(0);
+  assert(map_v);
+  auto c_to_v = mesh.topology().connectivity(tdim, 0);
+  assert(c_to_v);
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
+  std::vector<std::int32_t> nodes(map_v->size_local() + map_v->num_ghosts());
+  for (int c = 0; c < c_to_v->num_nodes(); ++c)
+  {
+    auto vertices = c_to_v->links(c);
+    auto dofs = x_dofmap.links(c);
+    for (int i = 0; i < vertices.rows(); ++i)
+      nodes[vertices[i]] = dofs[i];
+  }
+  return nodes;
+}
+//-----------------------------------------------------------------------------
+// Decide which parent cells are restored. Children are merged if all
+// are marked, and the parent cells around a refined edge are either all
+// restored or all kept.
+std::vector<bool>
+compute_restored(const mesh::Mesh& parent_mesh,
+                 const PlazaRefinementND::ParentMaps& parents,
+                 const graph::AdjacencyList<std::int32_t>& children,
+                 const std::vector<bool>& marked)
+{
+  const int tdim = parent_mesh.topology().dim();
+  parent_mesh.topology_mutable().create_connectivity(tdim, 1);
+  parent_mesh.topology_mutable().create_connectivity(1, tdim);
+  auto c_to_e = parent_mesh.topology().connectivity(tdim, 1);
+  assert(c_to_e);
+  auto e_to_c = parent_mesh.topology().connectivity(1, tdim);
+  assert(e_to_c);
+  auto map_e = parent_mesh.topology().index_map(1);
+  assert(map_e);
+
+  const std::int32_t num_parents = children.num_nodes();
+  std::vector<bool> restored(num_parents, false);
+  std::vector<std::int32_t> kept;
+  for (std::int32_t p = 0; p < num_parents; ++p)
+  {
+    auto c = children.links(p);
+    restored[p] = c.rows() > 1;
+    for (int i = 0; i < c.rows(); ++i)
+      restored[p] = restored[p] and marked[c[i]];
+    if (!restored[p])
+      kept.push_back(p);
+  }
+
+  auto [neighbor_comm, shared_edges] = compute_edge_sharing(parent_mesh);
+  int indegree(-1), outdegree(-2), weighted(-1);
+  MPI_Dist_graph_neighbors_count(neighbor_comm, &indegree, &outdegree,
+                                 &weighted);
+  assert(indegree == outdegree);
+  std::vector<std::vector<std::int32_t>> marked_for_update(indegree);
+
+  // Refined edges of the kept parent cells (the refined mesh has a
+  // vertex on these edges)
+  std::vector<bool> kept_edges(map_e->size_local() + map_e->num_ghosts(),
+                               false);
+  auto keep_cells = [&](std::int32_t e) {
+    auto cells = e_to_c->links(e);
+    for (int i = 0; i < cells.rows(); ++i)
+    {
+      if (restored[cells[i]])
+      {
+        restored[cells[i]] = false;
+        kept.push_back(cells[i]);
+      }
+    }
+  };
+
+  // Keep the parent cells around the refined edges of the kept parent
+  // cells, locally to a fixed point and then with the sharing processes
+  while (true)
+  {
+    while (!kept.empty())
+    {
+      const std::int32_t p = kept.back();
+      kept.pop_back();
+      auto edges = c_to_e->links(p);
+      for (int i = 0; i < edges.rows(); ++i)
+      {
+        const std::int32_t e = edges[i];
+        if (parents.edge_vertex[e] < 0 or kept_edges[e])
+          continue;
+        kept_edges[e] = true;
+        if (auto it = shared_edges.find(e); it != shared_edges.end())
+        {
+          for (int r : it->second)
+            marked_for_update[r].push_back(e);
+        }
+        keep_cells(e);
+      }
+    }
+
+    int sent = std::any_of(marked_for_update.begin(), marked_for_update.end(),
+                           [](auto& edges) { return !edges.empty(); });
+    int any_sent = 0;
+    MPI_Allreduce(&sent, &any_sent, 1, MPI_INT, MPI_LOR,
+                  parent_mesh.mpi_comm());
+    if (!any_sent)
+      break;
+
+    const std::vector<std::int32_t> received = update_logical_edgefunction(
+        neighbor_comm, marked_for_update, kept_edges, *map_e);
+    for (auto& edges : marked_for_update)
+      edges.clear();
+    for (std::int32_t e : received)
+      keep_cells(e);
+  }
+
+  MPI_Comm_free(&neighbor_comm);
+  return restored;
+}
+//-----------------------------------------------------------------------------
+// The barycentric coordinates of a point in a simplex with vertices v
+Eigen::VectorXd
+barycentric(const Eigen::Ref<const Eigen::RowVectorXd>& x,
+            const Eigen::Ref<const Eigen::MatrixXd>& v)
+{
+  const int tdim = v.rows() - 1;
+  Eigen::MatrixXd J(v.cols(), tdim);
+  for (int i = 0; i < tdim; ++i)
+    J.col(i) = (v.row(i + 1) - v.row(0)).transpose();
+  const Eigen::VectorXd X
+      = J.colPivHouseholderQr().solve((x - v.row(0)).transpose());
+  Eigen::VectorXd lambda(tdim + 1);
+  lambda[0] = 1.0 - X.sum();
+  lambda.tail(tdim) = X;
+  return lambda;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+std::pair<mesh::Mesh, CoarseningMaps>
+refinement::coarsen(const mesh::Mesh& parent_mesh, const mesh::Mesh& mesh,
+                    const PlazaRefinementND::ParentMaps& parents,
+                    const mesh::MeshTags<std::int8_t>& cell_markers)
+{
+  common::Timer t0("Coarsen mesh");
+
+  const int tdim = mesh.topology().dim();
+  auto map_c0 = parent_mesh.topology().index_map(tdim);
+  assert(map_c0);
+  auto map_c1 = mesh.topology().index_map(tdim);
+  assert(map_c1);
+  if (map_c0->num_ghosts() > 0 or map_c1->num_ghosts() > 0)
+    throw std::runtime_error("Coarsening of ghosted meshes is not supported.");
+  const std::int32_t num_parents = map_c0->size_local();
+  const std::int32_t num_cells = map_c1->size_local();
+  if ((std::int32_t)parents.parent_cell.size() != num_cells)
+  {
+    throw std::runtime_error("Cannot coarsen mesh. The parent maps do not "
+                             "match the mesh.");
+  }
+  if (cell_markers.dim() != tdim)
+    throw std::runtime_error("Cannot coarsen mesh. Cells must be marked.");
+
+  std::vector<bool> marked(num_cells, false);
+  for (std::size_t i = 0; i < cell_markers.indices().size(); ++i)
+    marked[cell_markers.indices()[i]] = cell_markers.values()[i] == 1;
+
+  const graph::AdjacencyList<std::int32_t> children
+      = compute_children(parents.parent_cell, num_parents);
+  const std::vector<bool> restored
+      = compute_restored(parent_mesh, parents, children, marked);
+
+  // Vertices (global indices) and coordinates of the refined mesh,
+  // which has the vertices of the parent mesh
+  auto map_v = mesh.topology().index_map(0);
+  assert(map_v);
+  const std::vector<std::int64_t> global_vertices = map_v->global_indices(true);
+  const std::vector<std::int32_t> nodes1 = vertex_to_node(mesh);
+  const std::vector<std::int32_t> nodes0 = vertex_to_node(parent_mesh);
+  const int gdim = mesh.geometry().dim();
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x1
+      = mesh.geometry().x();
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x0
+      = parent_mesh.geometry().x();
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> x(
+      map_v->size_local(), gdim);
+  for (int v = 0; v < x.rows(); ++v)
+    x.row(v) = x1.row(nodes1[v]).head(gdim);
+
+  // Cells of the coarsened mesh, in the order of the parent cells. A
+  // restored parent cell has the vertices of the refined mesh at its
+  // vertices, in the same order.
+  auto c_to_v0 = parent_mesh.topology().connectivity(tdim, 0);
+  assert(c_to_v0);
+  auto c_to_v1 = mesh.topology().connectivity(tdim, 0);
+  assert(c_to_v1);
+  std::vector<std::int64_t> cell_topology;
+  CoarseningMaps maps;
+  for (std::int32_t p = 0; p < num_parents; ++p)
+  {
+    auto c = children.links(p);
+    if (!restored[p])
+    {
+      for (int i = 0; i < c.rows(); ++i)
+      {
+        auto vertices = c_to_v1->links(c[i]);
+        for (int j = 0; j < vertices.rows(); ++j)
+          cell_topology.push_back(global_vertices[vertices[j]]);
+        maps.fine_cell.push_back(c[i]);
+        maps.parent_cell.push_back(-1);
+      }
+      continue;
+    }
+
+    auto vertices0 = c_to_v0->links(p);
+    for (int k = 0; k < vertices0.rows(); ++k)
+    {
+      // Find the vertex of the children at vertex k
+      std::int32_t vertex = -1;
+      double min_dist = std::numeric_limits<double>::max();
+      for (int i = 0; i < c.rows(); ++i)
+      {
+        auto vertices = c_to_v1->links(c[i]);
+        for (int j = 0; j < vertices.rows(); ++j)
+        {
+          const double dist = (x1.row(nodes1[vertices[j]])
+                               - x0.row(nodes0[vertices0[k]]))
+                                  .matrix()
+                                  .squaredNorm();
+          if (dist < min_dist)
+          {
+            min_dist = dist;
+            vertex = vertices[j];
+          }
+        }
+      }
+      cell_topology.push_back(global_vertices[vertex]);
+    }
+    maps.fine_cell.push_back(-1);
+    maps.parent_cell.push_back(p);
+  }
+
+  // Without redistribution, the cells of the new mesh are in the order
+  // of cell_topology
+  mesh::Mesh coarse_mesh = partition(mesh, cell_topology, 0, x, false);
+  return {std::move(coarse_mesh), std::move(maps)};
+}
+//-----------------------------------------------------------------------------
+std::pair<Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>,
+          Eigen::Array<int, Eigen::Dynamic, 1>>
+refinement::transfer_points(const mesh::Mesh& mesh,
+                            const function::FunctionSpace& V,
+                            const PlazaRefinementND::ParentMaps& parents,
+                            const CoarseningMaps& maps)
+{
+  std::shared_ptr<const fem::DofMap> dofmap = V.dofmap();
+  assert(dofmap);
+  std::shared_ptr<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                                     Eigen::RowMajor>>
+      x_dofs = V.dof_coordinates();
+  assert(x_dofs);
+  const int gdim = x_dofs->cols();
+
+  const int tdim = mesh.topology().dim();
+  const std::int32_t num_parents
+      = parents.parent_cell.empty()
+            ? 0
+            : *std::max_element(parents.parent_cell.begin(),
+                                parents.parent_cell.end())
+                  + 1;
+  const graph::AdjacencyList<std::int32_t> children
+      = compute_children(parents.parent_cell, num_parents);
+  const std::vector<std::int32_t> nodes1 = vertex_to_node(mesh);
+  auto c_to_v1 = mesh.topology().connectivity(tdim, 0);
+  assert(c_to_v1);
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x1
+      = mesh.geometry().x();
+
+  Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> x
+      = Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>::Zero(
+          x_dofs->rows(), 3);
+  x.leftCols(gdim) = *x_dofs;
+  Eigen::Array<int, Eigen::Dynamic, 1> cells
+      = Eigen::Array<int, Eigen::Dynamic, 1>::Constant(x_dofs->rows(), -1);
+  Eigen::MatrixXd vertex_x(tdim + 1, gdim);
+  const graph::AdjacencyList<std::int32_t>& dofs = dofmap->list_blocked();
+  for (int c = 0; c < dofs.num_nodes(); ++c)
+  {
+    auto cell_dofs = dofs.links(c);
+    for (int i = 0; i < cell_dofs.rows(); ++i)
+    {
+      const std::int32_t dof = cell_dofs[i];
+      if (cells[dof] >= 0)
+        continue;
+      if (maps.fine_cell[c] >= 0)
+      {
+        cells[dof] = maps.fine_cell[c];
+        continue;
+      }
+
+      // Find the child of the parent cell that contains the point
+      auto c1 = children.links(maps.parent_cell[c]);
+      double max_lambda = -std::numeric_limits<double>::max();
+      for (int j = 0; j < c1.rows(); ++j)
+      {
+        auto vertices = c_to_v1->links(c1[j]);
+        for (int k = 0; k < vertices.rows(); ++k)
+          vertex_x.row(k) = x1.row(nodes1[vertices[k]]).head(gdim).matrix();
+        const double lambda
+            = barycentric(x_dofs->row(dof).matrix(), vertex_x).minCoeff();
+        if (lambda > max_lambda)
+        {
+          max_lambda = lambda;
+          cells[dof] = c1[j];
+        }
+      }
+    }
+  }
+
+  return {std::move(x), std::move(cells)};
+}
+//-----------------------------------------------------------------------------
+graph::AdjacencyList<std::int32_t> refinement::transfer_entities(
+    const mesh::Mesh& mesh, const mesh::Mesh& coarse_mesh, int dim,
+    const PlazaRefinementND::ParentMaps& parents, const CoarseningMaps& maps)
+{
+  const int tdim = mesh.topology().dim();
+  const std::int32_t num_parents
+      = parents.parent_cell.empty()
+            ? 0
+            : *std::max_element(parents.parent_cell.begin(),
+                                parents.parent_cell.end())
+                  + 1;
+  const graph::AdjacencyList<std::int32_t> children
+      = compute_children(parents.parent_cell, num_parents);
+  const std::int32_t num_coarse_cells = maps.fine_cell.size();
+
+  std::vector<std::int32_t> data, offsets = {0};
+  if (dim == tdim)
+  {
+    for (std::int32_t c = 0; c < num_coarse_cells; ++c)
+    {
+      if (maps.fine_cell[c] >= 0)
+        data.push_back(maps.fine_cell[c]);
+      else
+      {
+        auto c1 = children.links(maps.parent_cell[c]);
+        data.insert(data.end(), c1.data(), c1.data() + c1.rows());
+      }
+      offsets.push_back(data.size());
+    }
+    return graph::AdjacencyList<std::int32_t>(std::move(data),
+                                              std::move(offsets));
+  }
+  else if (dim != tdim - 1)
+  {
+    throw std::runtime_error(
+        "Only cell and facet data can be transferred to a coarsened mesh.");
+  }
+
+  mesh.topology_mutable().create_entities(tdim - 1);
+  mesh.topology_mutable().create_connectivity(tdim, tdim - 1);
+  coarse_mesh.topology_mutable().create_entities(tdim - 1);
+  coarse_mesh.topology_mutable().create_connectivity(tdim, tdim - 1);
+  auto c_to_f1 = mesh.topology().connectivity(tdim, tdim - 1);
+  assert(c_to_f1);
+  auto c_to_f = coarse_mesh.topology().connectivity(tdim, tdim - 1);
+  assert(c_to_f);
+  auto map_f = coarse_mesh.topology().index_map(tdim - 1);
+  assert(map_f);
+
+  // Facet i of a kept cell is facet i of the refined cell, and facet k
+  // of a parent cell contains the facets of its children with parent
+  // facet k. The facets are visited from one of their cells, since a
+  // facet between a parent cell and a kept cell is not refined.
+  std::vector<std::vector<std::int32_t>> facets(map_f->size_local()
+                                                + map_f->num_ghosts());
+  std::vector<bool> visited(facets.size(), false);
+  for (std::int32_t c = 0; c < num_coarse_cells; ++c)
+  {
+    auto cell_facets = c_to_f->links(c);
+    for (int k = 0; k < cell_facets.rows(); ++k)
+    {
+      const std::int32_t f = cell_facets[k];
+      if (visited[f])
+        continue;
+      visited[f] = true;
+      if (maps.fine_cell[c] >= 0)
+      {
+        facets[f].push_back(c_to_f1->links(maps.fine_cell[c])[k]);
+        continue;
+      }
+
+      auto c1 = children.links(maps.parent_cell[c]);
+      for (int j = 0; j < c1.rows(); ++j)
+      {
+        auto child_facets = c_to_f1->links(c1[j]);
+        for (int i = 0; i < child_facets.rows(); ++i)
+        {
+          if (parents.parent_facet[c1[j] * (tdim + 1) + i] == k)
+            facets[f].push_back(child_facets[i]);
+        }
+      }
+    }
+  }
+
+  for (const std::vector<std::int32_t>& f : facets)
+  {
+    data.insert(data.end(), f.begin(), f.end());
+    offsets.push_back(data.size());
+  }
+  return graph::AdjacencyList<std::int32_t>(std::move(data),
+                                            std::move(offsets));
+}
+//-----------------------------------------------------------------------------
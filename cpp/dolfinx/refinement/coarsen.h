@@ -0,0 +1,186 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include "PlazaRefinementND.h"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cstdint>
+#include <dolfinx/fem/FiniteElement.h>
+#include <dolfinx/function/Function.h>
+#include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/la/Vector.h>
+#include <dolfinx/mesh/MeshTags.h>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace dolfinx
+{
+
+namespace mesh
+{
+class Mesh;
+}
+
+namespace refinement
+{
+
+/// Relations between a coarsened mesh and the refined mesh it was
+/// coarsened from. A cell of the coarsened mesh is either a cell of the
+/// refined mesh (which was not coarsened) or a parent cell that
+/// replaces its children.
+struct CoarseningMaps
+{
+  /// The cell of the refined mesh (local index) of each cell of the
+  /// coarsened mesh, or -1 if the cell is a parent cell
+  std::vector<std::int32_t> fine_cell;
+
+  /// The parent cell (local index in the parent mesh) of each cell of
+  /// the coarsened mesh, or -1 if the cell is a cell of the refined
+  /// mesh
+  std::vector<std::int32_t> parent_cell;
+};
+
+/// Coarsen a mesh that was created by Plaza refinement (collective),
+/// by merging the children of parent cells back into the parent cells.
+/// The children of a parent cell are merged if all of them are marked,
+/// and if the coarsened mesh is then conforming, i.e. the parent cells
+/// around a refined edge are either all merged or all kept. The
+/// coarsened mesh is not redistributed.
+///
+/// @param[in] parent_mesh The mesh that was refined, without ghost
+///   cells
+/// @param[in] mesh The refined mesh
+/// @param[in] parents The relations of @p mesh to @p parent_mesh (see
+///   PlazaRefinementND::refine_with_parents)
+/// @param[in] cell_markers Cells of @p mesh that may be coarsened
+///   (value == 1), e.g. from an error indicator
+/// @return The coarsened mesh, and its relations to @p mesh and @p
+///   parent_mesh
+std::pair<mesh::Mesh, CoarseningMaps>
+coarsen(const mesh::Mesh& parent_mesh, const mesh::Mesh& mesh,
+        const PlazaRefinementND::ParentMaps& parents,
+        const mesh::MeshTags<std::int8_t>& cell_markers);
+
+/// Compute the points at which a function on a refined mesh is
+/// evaluated for the interpolation into a space on a coarsened mesh,
+/// i.e. the dof coordinates of the space, and the cell of the refined
+/// mesh that contains each point
+/// @param[in] mesh The refined mesh
+/// @param[in] V The space on the coarsened mesh (Lagrange)
+/// @param[in] parents The relations of @p mesh to the parent mesh
+/// @param[in] maps The relations of the coarsened mesh to @p mesh
+/// @return The points (a row for each node of @p V), and the cell of
+///   @p mesh of each point
+std::pair<Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>,
+          Eigen::Array<int, Eigen::Dynamic, 1>>
+transfer_points(const mesh::Mesh& mesh, const function::FunctionSpace& V,
+                const PlazaRefinementND::ParentMaps& parents,
+                const CoarseningMaps& maps);
+
+/// Compute the entities of a refined mesh from which the data
+/// (MeshTags) of each entity of a coarsened mesh is taken. A cell that
+/// was kept takes the data of its cell, and a parent cell takes the
+/// data of its children. A facet of a parent cell takes the data of the
+/// facets of its children on the facet.
+/// @param[in] mesh The refined mesh
+/// @param[in] coarse_mesh The coarsened mesh
+/// @param[in] dim The dimension of the entities (cells or facets)
+/// @param[in] parents The relations of @p mesh to the parent mesh
+/// @param[in] maps The relations of @p coarse_mesh to @p mesh
+/// @return The entities of @p mesh (local indices) of each entity of
+///   @p coarse_mesh, in order of preference
+graph::AdjacencyList<std::int32_t>
+transfer_entities(const mesh::Mesh& mesh, const mesh::Mesh& coarse_mesh,
+                  int dim, const PlazaRefinementND::ParentMaps& parents,
+                  const CoarseningMaps& maps);
+
+/// Interpolate a Lagrange function on a refined mesh into a space on a
+/// coarsened mesh
+/// @param[in] u The function on the refined mesh
+/// @param[in,out] u_coarse The function on the coarsened mesh
+/// @param[in] parents The relations of the refined mesh to the parent
+///   mesh
+/// @param[in] maps The relations of the coarsened mesh to the refined
+///   mesh
+template <typename T>
+void transfer_function(const function::Function<T>& u,
+                       function::Function<T>& u_coarse,
+                       const PlazaRefinementND::ParentMaps& parents,
+                       const CoarseningMaps& maps)
+{
+  std::shared_ptr<const function::FunctionSpace> V
+      = u_coarse.function_space();
+  assert(V);
+  std::shared_ptr<const mesh::Mesh> mesh = u.function_space()->mesh();
+  assert(mesh);
+  const int bs = V->dofmap()->bs();
+  if (V->element()->value_size() != bs)
+  {
+    throw std::runtime_error(
+        "Cannot transfer function. Value size and block size differ.");
+  }
+
+  const auto [x, cells] = transfer_points(*mesh, *V, parents, maps);
+  Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> values(
+      x.rows(), bs);
+  u.eval(x, cells, values);
+
+  Eigen::Matrix<T, Eigen::Dynamic, 1>& array = u_coarse.x()->array();
+  assert(array.size() == values.size());
+  std::copy(values.data(), values.data() + values.size(), array.data());
+}
+
+/// Transfer MeshTags (of cells or facets) on a refined mesh to a
+/// coarsened mesh (see transfer_entities). An entity of the coarsened
+/// mesh is tagged if one of its entities on the refined mesh is tagged.
+/// @param[in] tags The tags on the refined mesh
+/// @param[in] coarse_mesh The coarsened mesh
+/// @param[in] parents The relations of the refined mesh to the parent
+///   mesh
+/// @param[in] maps The relations of @p coarse_mesh to the refined mesh
+/// @return The tags on @p coarse_mesh
+template <typename T>
+mesh::MeshTags<T>
+transfer_meshtags(const mesh::MeshTags<T>& tags,
+                  const std::shared_ptr<const mesh::Mesh>& coarse_mesh,
+                  const PlazaRefinementND::ParentMaps& parents,
+                  const CoarseningMaps& maps)
+{
+  assert(tags.mesh());
+  assert(coarse_mesh);
+  const graph::AdjacencyList<std::int32_t> entities = transfer_entities(
+      *tags.mesh(), *coarse_mesh, tags.dim(), parents, maps);
+
+  const std::vector<std::int32_t>& fine_indices = tags.indices();
+  std::vector<std::int32_t> indices;
+  std::vector<T> values;
+  for (int e = 0; e < entities.num_nodes(); ++e)
+  {
+    auto fine_entities = entities.links(e);
+    for (int i = 0; i < fine_entities.rows(); ++i)
+    {
+      auto it = std::lower_bound(fine_indices.begin(), fine_indices.end(),
+                                 fine_entities[i]);
+      if (it != fine_indices.end() and *it == fine_entities[i])
+      {
+        indices.push_back(e);
+        values.push_back(tags.values()[it - fine_indices.begin()]);
+        break;
+      }
+    }
+  }
+
+  return mesh::MeshTags<T>(coarse_mesh, tags.dim(), std::move(indices),
+                           std::move(values));
+}
+
+} // namespace refinement
+} // namespace dolfinx
@@ -6,10 +6,15 @@ namespace dolfinx
     \brief Mesh refinement algorithms
 
     Methods for refining meshes uniformly, or with markers, using
-    edge bisection.
+    edge bisection, uniformly refining quadrilateral and hexahedral
+    meshes, marking cells from error indicators, and coarsening
+    refined meshes.
 */
 }
 
 // DOLFINX refinement interface
 
+#include <dolfinx/refinement/MeshHierarchy.h>
+#include <dolfinx/refinement/coarsen.h>
+#include <dolfinx/refinement/marking.h>
 #include <dolfinx/refinement/refine.h>
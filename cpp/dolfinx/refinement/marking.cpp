@@ -0,0 +1,159 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include "marking.h"
+#include <algorithm>
+#include <cstring>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/Timer.h>
+#include <dolfinx/mesh/Mesh.h>
+#include <dolfinx/mesh/Topology.h>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Check the indicators of the owned cells of a mesh
+void check_indicator(
+    const mesh::Mesh& mesh,
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, 1>>& indicator,
+    double theta)
+{
+  const int tdim = mesh.topology().dim();
+  auto map = mesh.topology().index_map(tdim);
+  assert(map);
+  if (indicator.rows() < map->size_local())
+    throw std::runtime_error("Too few error indicators for the owned cells.");
+  if ((indicator.head(map->size_local()) < 0.0).any())
+    throw std::runtime_error("Error indicators must be non-negative.");
+  if (theta < 0.0 or theta > 1.0)
+    throw std::runtime_error("Marking fraction must be in [0, 1].");
+}
+//-----------------------------------------------------------------------------
+// Create the markers of the owned cells with an indicator of at least
+// a threshold
+mesh::MeshTags<std::int8_t> create_markers(
+    const std::shared_ptr<const mesh::Mesh>& mesh,
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, 1>>& indicator,
+    double threshold)
+{
+  const int tdim = mesh->topology().dim();
+  const std::int32_t num_cells = mesh->topology().index_map(tdim)->size_local();
+  std::vector<std::int32_t> cells;
+  for (std::int32_t c = 0; c < num_cells; ++c)
+    if (indicator[c] >= threshold)
+      cells.push_back(c);
+  std::vector<std::int8_t> values(cells.size(), 1);
+
+  return mesh::MeshTags<std::int8_t>(mesh, tdim, std::move(cells),
+                                     std::move(values));
+}
+//-----------------------------------------------------------------------------
+// The threshold that marks no cells
+constexpr double inf = std::numeric_limits<double>::infinity();
+//-----------------------------------------------------------------------------
+// The non-negative doubles are ordered as their binary representations
+std::uint64_t to_bits(double x)
+{
+  std::uint64_t b;
+  std::memcpy(&b, &x, sizeof(b));
+  return b;
+}
+//-----------------------------------------------------------------------------
+double from_bits(std::uint64_t b)
+{
+  double x;
+  std::memcpy(&x, &b, sizeof(x));
+  return x;
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+mesh::MeshTags<std::int8_t> refinement::mark_maximum(
+    const std::shared_ptr<const mesh::Mesh>& mesh,
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, 1>>& indicator,
+    double theta)
+{
+  assert(mesh);
+  check_indicator(*mesh, indicator, theta);
+  const std::int32_t num_cells
+      = mesh->topology().index_map(mesh->topology().dim())->size_local();
+
+  const double local_max
+      = num_cells > 0 ? indicator.head(num_cells).maxCoeff() : 0.0;
+  double max = 0.0;
+  MPI_Allreduce(&local_max, &max, 1, MPI_DOUBLE, MPI_MAX, mesh->mpi_comm());
+
+  // Nothing to mark if there is no error
+  if (max == 0.0)
+    return create_markers(mesh, indicator, inf);
+
+  return create_markers(mesh, indicator, theta * max);
+}
+//-----------------------------------------------------------------------------
+mesh::MeshTags<std::int8_t> refinement::mark_dorfler(
+    const std::shared_ptr<const mesh::Mesh>& mesh,
+    const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, 1>>& indicator,
+    double theta)
+{
+  assert(mesh);
+  check_indicator(*mesh, indicator, theta);
+  common::Timer t0("Dorfler marking");
+  MPI_Comm comm = mesh->mpi_comm();
+  const std::int32_t num_cells
+      = mesh->topology().index_map(mesh->topology().dim())->size_local();
+
+  // Sort the local indicators in descending order, with the partial
+  // sums of their squares, such that the local sum of the squares of
+  // the indicators of at least a threshold is a binary search
+  std::vector<double> eta(indicator.data(), indicator.data() + num_cells);
+  std::sort(eta.begin(), eta.end(), std::greater<double>());
+  std::vector<double> sums(num_cells + 1, 0.0);
+  for (std::int32_t i = 0; i < num_cells; ++i)
+    sums[i + 1] = sums[i] + eta[i] * eta[i];
+  auto local_sum = [&eta, &sums](double t) {
+    auto it
+        = std::upper_bound(eta.begin(), eta.end(), t, std::greater<double>());
+    return sums[it - eta.begin()];
+  };
+
+  const double local_max = num_cells > 0 ? eta.front() : 0.0;
+  double max = 0.0;
+  MPI_Allreduce(&local_max, &max, 1, MPI_DOUBLE, MPI_MAX, comm);
+  double total = 0.0;
+  MPI_Allreduce(&sums.back(), &total, 1, MPI_DOUBLE, MPI_SUM, comm);
+
+  // Nothing to mark if there is no error
+  const double target = theta * total;
+  if (target == 0.0)
+    return create_markers(mesh, indicator, inf);
+
+  // Bisect for the largest threshold t with sum(eta^2, eta >= t) >=
+  // target. The sum at lo is at least the target, and at hi is less.
+  std::uint64_t lo = to_bits(0.0);
+  std::uint64_t hi = to_bits(max) + 1;
+  while (hi - lo > 1)
+  {
+    const std::uint64_t mid = lo + (hi - lo) / 2;
+    const double s_local = local_sum(from_bits(mid));
+    double s = 0.0;
+    MPI_Allreduce(&s_local, &s, 1, MPI_DOUBLE, MPI_SUM, comm);
+    if (s >= target)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  return create_markers(mesh, indicator, from_bits(lo));
+}
+//-----------------------------------------------------------------------------
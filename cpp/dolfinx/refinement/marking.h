@@ -0,0 +1,61 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <dolfinx/mesh/MeshTags.h>
+#include <memory>
+
+namespace dolfinx
+{
+
+namespace mesh
+{
+class Mesh;
+}
+
+namespace refinement
+{
+
+/// Mark the cells with an error indicator of at least theta times the
+/// largest indicator (maximum marking, collective)
+///
+/// @param[in] mesh The mesh
+/// @param[in] indicator The (non-negative) error indicator of each
+///   owned cell, e.g. the owned values of a DG0 function ordered by
+///   cell
+/// @param[in] theta The fraction of the largest indicator, in [0, 1]
+/// @return The cell markers (value 1) for refine
+mesh::MeshTags<std::int8_t>
+mark_maximum(const std::shared_ptr<const mesh::Mesh>& mesh,
+             const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, 1>>&
+                 indicator,
+             double theta);
+
+/// Mark the cells with the largest error indicators such that the sum
+/// of the squares of the marked indicators is at least theta times the
+/// sum over all cells (Dörfler marking, collective). Each process sorts
+/// its own indicators, and the threshold indicator is computed by a
+/// bisection on the binary representation of the indicators, with one
+/// reduction per step, i.e. at most 64 reductions and no global sort.
+/// Cells with an indicator equal to the threshold are all marked.
+///
+/// @param[in] mesh The mesh
+/// @param[in] indicator The (non-negative) error indicator of each
+///   owned cell, e.g. the owned values of a DG0 function ordered by
+///   cell
+/// @param[in] theta The fraction of the total squared error, in [0, 1]
+/// @return The cell markers (value 1) for refine
+mesh::MeshTags<std::int8_t>
+mark_dorfler(const std::shared_ptr<const mesh::Mesh>& mesh,
+             const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, 1>>&
+                 indicator,
+             double theta);
+
+} // namespace refinement
+} // namespace dolfinx
@@ -6,58 +6,256 @@
 
 #include "refine.h"
 #include "PlazaRefinementND.h"
+#include "TensorProductRefinement.h"
+#include "utils.h"
+#include <algorithm>
+#include <array>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/log.h>
+#include <dolfinx/mesh/Geometry.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
+#include <dolfinx/mesh/Topology.h>
+#include <limits>
 
 using namespace dolfinx;
 using namespace refinement;
 
+namespace
+{
 //-----------------------------------------------------------------------------
-mesh::Mesh dolfinx::refinement::refine(const mesh::Mesh& mesh,
-                                       bool redistribute)
+void check_cell_type(const mesh::Mesh& mesh)
 {
   if (mesh.topology().cell_type() != mesh::CellType::triangle
       and mesh.topology().cell_type() != mesh::CellType::tetrahedron)
   {
     throw std::runtime_error("Refinement only defined for simplices");
   }
-
-  mesh::Mesh refined_mesh = PlazaRefinementND::refine(mesh, redistribute);
-
-  // Report the number of refined cells
+}
+//-----------------------------------------------------------------------------
+bool is_tensor_product(const mesh::Mesh& mesh)
+{
+  return mesh.topology().cell_type() == mesh::CellType::quadrilateral
+         or mesh.topology().cell_type() == mesh::CellType::hexahedron;
+}
+//-----------------------------------------------------------------------------
+// Report the number of refined cells
+void report(const mesh::Mesh& mesh, const mesh::Mesh& refined_mesh)
+{
   const int D = mesh.topology().dim();
   const std::int64_t n0 = mesh.topology().index_map(D)->size_global();
   const std::int64_t n1 = refined_mesh.topology().index_map(D)->size_global();
   LOG(INFO) << "Number of cells increased from " << n0 << " to " << n1 << " ("
             << 100.0 * (static_cast<double>(n1) / static_cast<double>(n0) - 1.0)
             << "%% increase).";
+}
+//-----------------------------------------------------------------------------
+// Repartition a mesh that was refined without redistribution if the
+// largest number of cells on a process exceeds the mean by more than
+// the factor max_imbalance
+mesh::Mesh rebalance(mesh::Mesh&& mesh, double max_imbalance)
+{
+  if (max_imbalance == std::numeric_limits<double>::infinity())
+    return std::move(mesh);
+
+  const int tdim = mesh.topology().dim();
+  auto map_c = mesh.topology().index_map(tdim);
+  assert(map_c);
+  const std::int64_t num_cells = map_c->size_local();
+  std::int64_t max_cells = 0;
+  MPI_Allreduce(&num_cells, &max_cells, 1, MPI_INT64_T, MPI_MAX,
+                mesh.mpi_comm());
+  const double mean_cells = static_cast<double>(map_c->size_global())
+                            / dolfinx::MPI::size(mesh.mpi_comm());
+  if (max_cells <= max_imbalance * mean_cells)
+    return std::move(mesh);
+
+  LOG(INFO) << "Repartitioning refined mesh (imbalance "
+            << max_cells / mean_cells << ").";
+  return refinement::repartition(mesh);
+}
+//-----------------------------------------------------------------------------
+} // namespace
+
+//-----------------------------------------------------------------------------
+mesh::Mesh dolfinx::refinement::refine(const mesh::Mesh& mesh,
+                                       bool redistribute, int num_threads,
+                                       double max_imbalance)
+{
+  if (is_tensor_product(mesh))
+  {
+    mesh::Mesh refined_mesh
+        = TensorProductRefinement::refine(mesh, redistribute, num_threads);
+    report(mesh, refined_mesh);
+    return redistribute ? std::move(refined_mesh)
+                        : rebalance(std::move(refined_mesh), max_imbalance);
+  }
 
-  return refined_mesh;
+  check_cell_type(mesh);
+
+  mesh::Mesh refined_mesh
+      = PlazaRefinementND::refine(mesh, redistribute, num_threads);
+
+  report(mesh, refined_mesh);
+
+  return redistribute ? std::move(refined_mesh)
+                      : rebalance(std::move(refined_mesh), max_imbalance);
 }
 //-----------------------------------------------------------------------------
 mesh::Mesh
 dolfinx::refinement::refine(const mesh::Mesh& mesh,
                             const mesh::MeshTags<std::int8_t>& cell_markers,
-                            bool redistribute)
+                            bool redistribute, int num_threads,
+                            double max_imbalance)
 {
-  if (mesh.topology().cell_type() != mesh::CellType::triangle
-      and mesh.topology().cell_type() != mesh::CellType::tetrahedron)
+  check_cell_type(mesh);
+
+  mesh::Mesh refined_mesh = PlazaRefinementND::refine(
+      mesh, cell_markers, redistribute, num_threads);
+
+  report(mesh, refined_mesh);
+
+  return redistribute ? std::move(refined_mesh)
+                      : rebalance(std::move(refined_mesh), max_imbalance);
+}
+//-----------------------------------------------------------------------------
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps>
+dolfinx::refinement::refine_with_parents(const mesh::Mesh& mesh)
+{
+  if (is_tensor_product(mesh))
   {
-    throw std::runtime_error("Refinement only defined for simplices");
+    auto refined = TensorProductRefinement::refine_with_parents(mesh);
+    report(mesh, refined.first);
+    return refined;
   }
 
-  mesh::Mesh refined_mesh
-      = PlazaRefinementND::refine(mesh, cell_markers, redistribute);
+  check_cell_type(mesh);
+  auto refined = PlazaRefinementND::refine_with_parents(mesh);
+  report(mesh, refined.first);
+  return refined;
+}
+//-----------------------------------------------------------------------------
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps>
+dolfinx::refinement::refine_with_parents(
+    const mesh::Mesh& mesh, const mesh::MeshTags<std::int8_t>& cell_markers)
+{
+  check_cell_type(mesh);
+  auto refined = PlazaRefinementND::refine_with_parents(mesh, cell_markers);
+  report(mesh, refined.first);
+  return refined;
+}
+//-----------------------------------------------------------------------------
+std::vector<std::int32_t> dolfinx::refinement::parent_entities(
+    const mesh::Mesh& parent_mesh, const mesh::Mesh& mesh, int dim,
+    const PlazaRefinementND::ParentMaps& parents)
+{
+  check_cell_type(parent_mesh);
+  const int tdim = mesh.topology().dim();
+  mesh.topology_mutable().create_entities(dim);
+  mesh.topology_mutable().create_connectivity(dim, tdim);
+  parent_mesh.topology_mutable().create_entities(dim);
+  parent_mesh.topology_mutable().create_connectivity(tdim, dim);
+  auto map_v0 = parent_mesh.topology().index_map(0);
+  assert(map_v0);
+  auto map_v1 = mesh.topology().index_map(0);
+  assert(map_v1);
+  auto map_e0 = parent_mesh.topology().index_map(1);
+  assert(map_e0);
+  auto e_to_v0 = parent_mesh.topology().connectivity(1, 0);
+  assert(e_to_v0);
 
-  // Report the number of refined cells
-  const int D = mesh.topology().dim();
-  const std::int64_t n0 = mesh.topology().index_map(D)->size_global();
-  const std::int64_t n1 = refined_mesh.topology().index_map(D)->size_global();
-  LOG(INFO) << "Number of cells increased from " << n0 << " to " << n1 << " ("
-            << 100.0 * (static_cast<double>(n1) / static_cast<double>(n0) - 1.0)
-            << "%% increase).";
+  // The parent vertices that span each vertex of the refined mesh: a
+  // vertex of the parent mesh, or the two vertices of a refined edge.
+  // A vertex v of the parent mesh has the (input) index
+  // global_indices[v] in the refined mesh (see adjust_indices).
+  const std::int32_t num_new_vertices = std::count_if(
+      parents.edge_vertex.begin(),
+      parents.edge_vertex.begin() + map_e0->size_local(),
+      [](std::int32_t v) { return v >= 0; });
+  const std::vector<std::int64_t> global_indices
+      = refinement::adjust_indices(map_v0, num_new_vertices);
+  std::vector<std::pair<std::int64_t, std::int32_t>> input_to_vertex;
+  {
+    // FIXME: We are making an assumption here on the ElementDofLayout
+    auto c_to_v1 = mesh.topology().connectivity(tdim, 0);
+    assert(c_to_v1);
+    const graph::AdjacencyList<std::int32_t>& x_dofmap
+        = mesh.geometry().dofmap();
+    const std::vector<std::int64_t>& input_index
+        = mesh.geometry().input_global_indices();
+    for (int c = 0; c < c_to_v1->num_nodes(); ++c)
+    {
+      auto vertices = c_to_v1->links(c);
+      auto dofs = x_dofmap.links(c);
+      for (int i = 0; i < vertices.rows(); ++i)
+        input_to_vertex.push_back({input_index[dofs[i]], vertices[i]});
+    }
+    std::sort(input_to_vertex.begin(), input_to_vertex.end());
+  }
+
+  std::vector<std::array<std::int32_t, 2>> span(
+      map_v1->size_local() + map_v1->num_ghosts(), {-1, -1});
+  for (std::size_t v = 0; v < global_indices.size(); ++v)
+  {
+    auto it = std::lower_bound(
+        input_to_vertex.begin(), input_to_vertex.end(),
+        std::pair<std::int64_t, std::int32_t>(global_indices[v], -1));
+    if (it != input_to_vertex.end() and it->first == global_indices[v])
+      span[it->second] = {(std::int32_t)v, -1};
+  }
+  for (std::size_t e = 0; e < parents.edge_vertex.size(); ++e)
+  {
+    if (parents.edge_vertex[e] >= 0)
+    {
+      auto v = e_to_v0->links(e);
+      span[parents.edge_vertex[e]] = {v[0], v[1]};
+    }
+  }
+
+  // The entity of the parent cell (of a cell of the entity) with the
+  // vertices that span the vertices of each entity
+  auto e_to_v1 = mesh.topology().connectivity(dim, 0);
+  assert(e_to_v1);
+  auto e_to_c1 = mesh.topology().connectivity(dim, tdim);
+  assert(e_to_c1);
+  auto c_to_e0 = parent_mesh.topology().connectivity(tdim, dim);
+  assert(c_to_e0);
+  auto ent_to_v0 = parent_mesh.topology().connectivity(dim, 0);
+  assert(ent_to_v0);
+  std::vector<std::int32_t> parent(e_to_v1->num_nodes(), -1);
+  std::vector<std::int32_t> vertices0, entity_vertices0;
+  for (int e = 0; e < e_to_v1->num_nodes(); ++e)
+  {
+    vertices0.clear();
+    auto vertices = e_to_v1->links(e);
+    for (int i = 0; i < vertices.rows(); ++i)
+    {
+      for (std::int32_t v : span[vertices[i]])
+        if (v >= 0)
+          vertices0.push_back(v);
+    }
+    std::sort(vertices0.begin(), vertices0.end());
+    vertices0.erase(std::unique(vertices0.begin(), vertices0.end()),
+                    vertices0.end());
+    if ((int)vertices0.size() != dim + 1)
+      continue;
+
+    assert(e_to_c1->num_links(e) > 0);
+    auto entities0 = c_to_e0->links(parents.parent_cell[e_to_c1->links(e)[0]]);
+    for (int i = 0; i < entities0.rows(); ++i)
+    {
+      auto v0 = ent_to_v0->links(entities0[i]);
+      entity_vertices0.assign(v0.data(), v0.data() + v0.rows());
+      std::sort(entity_vertices0.begin(), entity_vertices0.end());
+      if (entity_vertices0 == vertices0)
+      {
+        parent[e] = entities0[i];
+        break;
+      }
+    }
+  }
 
-  return refined_mesh;
+  return parent;
 }
 //-----------------------------------------------------------------------------
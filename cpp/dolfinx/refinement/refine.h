@@ -6,7 +6,14 @@
 
 #pragma once
 
+#include "PlazaRefinementND.h"
+#include <algorithm>
 #include <cstdint>
+#include <dolfinx/mesh/MeshTags.h>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace dolfinx
 {
@@ -15,8 +22,6 @@ namespace mesh
 {
 // Forward declarations
 class Mesh;
-template <typename T>
-class MeshTags;
 } // namespace mesh
 
 namespace refinement
@@ -27,8 +32,15 @@ namespace refinement
 /// @param[in] mesh The mesh from which to build a refined Mesh
 /// @param[in] redistribute Optional argument to redistribute the
 ///     refined mesh if mesh is a distributed mesh.
+/// @param[in] num_threads The number of threads for the subdivision of
+///     the cells
+/// @param[in] max_imbalance If the mesh is not redistributed, it is
+///     repartitioned if the largest number of cells on a process
+///     exceeds the mean by more than this factor
 /// @return A refined mesh
-mesh::Mesh refine(const mesh::Mesh& mesh, bool redistribute = true);
+mesh::Mesh
+refine(const mesh::Mesh& mesh, bool redistribute = true, int num_threads = 1,
+       double max_imbalance = std::numeric_limits<double>::infinity());
 
 /// Create locally refined mesh
 ///
@@ -38,10 +50,102 @@ mesh::Mesh refine(const mesh::Mesh& mesh, bool redistribute = true);
 ///     (any other integer value)).
 /// @param[in] redistribute Optional argument to redistribute the
 ///     refined mesh if mesh is a distributed mesh.
+/// @param[in] num_threads The number of threads for the subdivision of
+///     the cells
+/// @param[in] max_imbalance If the mesh is not redistributed, it is
+///     repartitioned if the largest number of cells on a process
+///     exceeds the mean by more than this factor
 /// @return A locally refined mesh
-mesh::Mesh refine(const mesh::Mesh& mesh,
-                  const mesh::MeshTags<std::int8_t>& cell_markers,
-                  bool redistribute = true);
+mesh::Mesh
+refine(const mesh::Mesh& mesh, const mesh::MeshTags<std::int8_t>& cell_markers,
+       bool redistribute = true, int num_threads = 1,
+       double max_imbalance = std::numeric_limits<double>::infinity());
+
+/// Create uniformly refined mesh, without redistribution, and compute
+/// the relations of the cells, facets and edges of the refined mesh to
+/// the input mesh
+///
+/// @param[in] mesh The mesh from which to build a refined Mesh
+/// @return A refined mesh, and the parent cell and facet of each cell
+///   and facet of the refined mesh and the new vertex of each refined
+///   edge of @p mesh
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps>
+refine_with_parents(const mesh::Mesh& mesh);
+
+/// Create locally refined mesh, without redistribution, and compute
+/// the relations of the cells, facets and edges of the refined mesh to
+/// the input mesh
+///
+/// @param[in] mesh The mesh from which to build a refined Mesh
+/// @param[in] cell_markers A mesh function over integers specifying
+///     which cells should be refined (value == 1) (and which should not
+///     (any other integer value)).
+/// @return A locally refined mesh, and the parent cell and facet of
+///   each cell and facet of the refined mesh and the new vertex of each
+///   refined edge of @p mesh
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps>
+refine_with_parents(const mesh::Mesh& mesh,
+                    const mesh::MeshTags<std::int8_t>& cell_markers);
+
+/// Compute the entity of a parent mesh that contains each entity of a
+/// mesh refined from it (see refine_with_parents), without geometric
+/// searches (collective). The vertices of the refined mesh are the
+/// vertices of the parent mesh and the midpoints of its refined edges,
+/// and an entity of the refined mesh is contained in the parent entity
+/// (of the same dimension) with the vertices that span its vertices.
+///
+/// @param[in] parent_mesh The mesh that was refined
+/// @param[in] mesh The refined mesh
+/// @param[in] dim The dimension of the entities
+/// @param[in] parents The relations of @p mesh to @p parent_mesh
+/// @return The entity of @p parent_mesh (local index) that contains
+///   each entity of @p mesh, or -1 if the entity is not contained in an
+///   entity of dimension @p dim, e.g. for an entity in the interior of
+///   a parent cell
+std::vector<std::int32_t>
+parent_entities(const mesh::Mesh& parent_mesh, const mesh::Mesh& mesh,
+                int dim, const PlazaRefinementND::ParentMaps& parents);
+
+/// Transfer MeshTags on a mesh onto a mesh refined from it (see
+/// refine_with_parents), for entities of any dimension. An entity of
+/// the refined mesh takes the value of the entity of the parent mesh
+/// that contains it (see parent_entities).
+///
+/// @param[in] tags The tags on the parent mesh
+/// @param[in] mesh The refined mesh
+/// @param[in] parents The relations of @p mesh to the mesh of @p tags
+/// @return The tags on @p mesh
+template <typename T>
+mesh::MeshTags<T>
+refine_meshtags(const mesh::MeshTags<T>& tags,
+                const std::shared_ptr<const mesh::Mesh>& mesh,
+                const PlazaRefinementND::ParentMaps& parents)
+{
+  assert(tags.mesh());
+  assert(mesh);
+  const std::vector<std::int32_t> parent
+      = parent_entities(*tags.mesh(), *mesh, tags.dim(), parents);
+
+  // Value of each tagged parent entity
+  const std::vector<std::int32_t>& parent_indices = tags.indices();
+  std::vector<std::int32_t> indices;
+  std::vector<T> values;
+  for (std::size_t e = 0; e < parent.size(); ++e)
+  {
+    if (parent[e] < 0)
+      continue;
+    auto it = std::lower_bound(parent_indices.begin(), parent_indices.end(),
+                               parent[e]);
+    if (it != parent_indices.end() and *it == parent[e])
+    {
+      indices.push_back(e);
+      values.push_back(tags.values()[it - parent_indices.begin()]);
+    }
+  }
+
+  return mesh::MeshTags<T>(mesh, tags.dim(), std::move(indices),
+                           std::move(values));
+}
 
 } // namespace refinement
 } // namespace dolfinx
@@ -5,8 +5,13 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include "utils.h"
+#include <algorithm>
+#include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
+#include <dolfinx/common/ThreadPool.h>
+#include <dolfinx/common/Timer.h>
 #include <dolfinx/common/types.h>
+#include <dolfinx/fem/CoordinateElement.h>
 #include <dolfinx/fem/ElementDofLayout.h>
 #include <dolfinx/graph/Partitioning.h>
 #include <dolfinx/mesh/Geometry.h>
@@ -15,8 +20,13 @@
 #include <dolfinx/mesh/Partitioning.h>
 #include <dolfinx/mesh/Topology.h>
 #include <dolfinx/mesh/TopologyComputation.h>
+#include <dolfinx/mesh/cell_types.h>
 #include <dolfinx/mesh/utils.h>
 #include <map>
+#include <numeric>
+#include <set>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 using namespace dolfinx;
@@ -33,13 +43,6 @@ compute_vertex_exterior_markers(const mesh::Topology& topology_local)
 {
   // Get list of boundary vertices
   const int dim = topology_local.dim();
-  auto facet_cell = topology_local.connectivity(dim - 1, dim);
-  if (!facet_cell)
-  {
-    throw std::runtime_error(
-        "Need facet-cell connectivity to build distributed adjacency list.");
-  }
-
   auto facet_vertex = topology_local.connectivity(dim - 1, 0);
   if (!facet_vertex)
   {
@@ -52,15 +55,14 @@ compute_vertex_exterior_markers(const mesh::Topology& topology_local)
     throw std::runtime_error("Need vertex IndexMap from topology.");
   assert(map_vertex->num_ghosts() == 0);
 
+  // The local topology has no ghosts, so the exterior facets are the
+  // facets that are connected to one cell
   std::vector<bool> exterior_vertex(map_vertex->size_local(), false);
-  for (int f = 0; f < facet_cell->num_nodes(); ++f)
+  for (std::int32_t f : topology_local.exterior_facets())
   {
-    if (facet_cell->num_links(f) == 1)
-    {
-      auto vertices = facet_vertex->links(f);
-      for (int j = 0; j < vertices.rows(); ++j)
-        exterior_vertex[vertices[j]] = true;
-    }
+    auto vertices = facet_vertex->links(f);
+    for (int j = 0; j < vertices.rows(); ++j)
+      exterior_vertex[vertices[j]] = true;
   }
 
   return exterior_vertex;
@@ -87,63 +89,48 @@ std::int64_t local_to_global(std::int32_t local_index,
 }
 
 //-----------------------------------------------------------------------------
-// Create geometric points of new Mesh, from current Mesh and a edge_to_vertex
-// map listing the new local points (midpoints of those edges)
-// @param Mesh
-// @param local_edge_to_new_vertex
-// @return array of points
-Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-create_new_geometry(
-    const mesh::Mesh& mesh,
-    const std::map<std::int32_t, std::int64_t>& local_edge_to_new_vertex)
+// Get the vertex of a refined mesh (local index) at the midpoint of
+// each edge of the parent mesh (-1 if not refined), from the (global)
+// input index of the new vertex of each edge (-1 if not refined)
+std::vector<std::int32_t>
+edge_vertex(const mesh::Mesh& mesh, const mesh::Mesh& new_mesh,
+            const std::vector<std::int64_t>& new_vertex)
 {
-  // Build map from vertex -> geometry dof
-  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
-  const int tdim = mesh.topology().dim();
-  auto c_to_v = mesh.topology().connectivity(tdim, 0);
+  auto map_e = mesh.topology().index_map(1);
+  assert(map_e);
+  std::vector<std::int32_t> vertex(map_e->size_local() + map_e->num_ghosts(),
+                                   -1);
+  assert(new_vertex.size() == vertex.size());
+  std::map<std::int64_t, std::int32_t> vertex_to_edge;
+  for (std::size_t e = 0; e < new_vertex.size(); ++e)
+    if (new_vertex[e] >= 0)
+      vertex_to_edge.insert({new_vertex[e], e});
+
+  // The input index of a vertex is the input index of its geometry
+  // node
+  // FIXME: We are making an assumption here on the ElementDofLayout
+  const int tdim = new_mesh.topology().dim();
+  auto c_to_v = new_mesh.topology().connectivity(tdim, 0);
   assert(c_to_v);
-  auto map_v = mesh.topology().index_map(0);
-  assert(map_v);
-  std::vector<std::int32_t> vertex_to_x(map_v->size_local()
-                                        + map_v->num_ghosts());
-  auto map_c = mesh.topology().index_map(tdim);
-  assert(map_c);
-  for (int c = 0; c < map_c->size_local() + map_c->num_ghosts(); ++c)
+  const graph::AdjacencyList<std::int32_t>& x_dofmap
+      = new_mesh.geometry().dofmap();
+  const std::vector<std::int64_t>& input_index
+      = new_mesh.geometry().input_global_indices();
+  for (int c = 0; c < c_to_v->num_nodes(); ++c)
   {
     auto vertices = c_to_v->links(c);
     auto dofs = x_dofmap.links(c);
     for (int i = 0; i < vertices.rows(); ++i)
     {
-      // FIXME: We are making an assumption here on the
-      // ElementDofLayout. We should use an ElementDofLayout to map
-      // between local vertex index and x dof index.
-      vertex_to_x[vertices[i]] = dofs(i);
+      if (auto it = vertex_to_edge.find(input_index[dofs(i)]);
+          it != vertex_to_edge.end())
+      {
+        vertex[it->second] = vertices[i];
+      }
     }
   }
 
-  // Copy over existing mesh vertices
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
-      = mesh.geometry().x();
-
-  const std::int32_t num_vertices = map_v->size_local();
-  const std::int32_t num_new_vertices = local_edge_to_new_vertex.size();
-  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      new_vertex_coordinates(num_vertices + num_new_vertices, 3);
-
-  for (int v = 0; v < num_vertices; ++v)
-    new_vertex_coordinates.row(v) = x_g.row(vertex_to_x[v]);
-
-  Eigen::Array<int, Eigen::Dynamic, 1> edges(num_new_vertices);
-  int i = 0;
-  for (auto& e : local_edge_to_new_vertex)
-    edges[i++] = e.first;
-
-  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor> midpoints
-      = mesh::midpoints(mesh, 1, edges);
-  new_vertex_coordinates.bottomRows(num_new_vertices) = midpoints;
-
-  const int gdim = mesh.geometry().dim();
-  return new_vertex_coordinates.leftCols(gdim);
+  return vertex;
 }
 } // namespace
 
@@ -159,14 +146,14 @@ refinement::compute_edge_sharing(const mesh::Mesh& mesh)
 
   // Create shared edges, for both owned and ghost indices
   // returning edge -> set(global process numbers)
-  std::map<std::int32_t, std::set<int>> shared_edges_by_proc
-      = map_e->compute_shared_indices();
+  const common::IndexMap::SharedIndices& shared_edges_by_proc
+      = map_e->shared_index_ranks();
 
   // Compute a slightly wider neighborhood for direct communication of shared
   // edges
-  std::set<int> all_neighbor_set;
-  for (const auto& q : shared_edges_by_proc)
-    all_neighbor_set.insert(q.second.begin(), q.second.end());
+  const auto& edge_ranks = shared_edges_by_proc.ranks.array();
+  std::set<int> all_neighbor_set(edge_ranks.data(),
+                                 edge_ranks.data() + edge_ranks.rows());
   std::vector<int> neighbors(all_neighbor_set.begin(), all_neighbor_set.end());
 
   MPI_Comm neighbor_comm;
@@ -181,18 +168,20 @@ refinement::compute_edge_sharing(const mesh::Mesh& mesh)
     proc_to_neighbor.insert({neighbors[i], i});
 
   std::map<std::int32_t, std::set<int>> shared_edges;
-  for (auto& q : shared_edges_by_proc)
+  for (std::size_t i = 0; i < shared_edges_by_proc.indices.size(); ++i)
   {
+    auto ranks = shared_edges_by_proc.ranks.links(i);
     std::set<int> neighbor_set;
-    for (int r : q.second)
-      neighbor_set.insert(proc_to_neighbor[r]);
-    shared_edges.insert({q.first, neighbor_set});
+    for (int j = 0; j < ranks.rows(); ++j)
+      neighbor_set.insert(proc_to_neighbor[ranks[j]]);
+    shared_edges.insert(shared_edges.end(),
+                        {shared_edges_by_proc.indices[i], neighbor_set});
   }
 
   return {neighbor_comm, shared_edges};
 }
 //-----------------------------------------------------------------------------
-void refinement::update_logical_edgefunction(
+std::vector<std::int32_t> refinement::update_logical_edgefunction(
     const MPI_Comm& neighbor_comm,
     const std::vector<std::vector<std::int32_t>>& marked_for_update,
     std::vector<bool>& marked_edges, const common::IndexMap& map_e)
@@ -216,8 +205,141 @@ void refinement::update_logical_edgefunction(
 
   // Flatten received values and set marked_edges at each index received
   std::vector<std::int32_t> local_indices = map_e.global_to_local(data_to_recv);
+  std::vector<std::int32_t> new_edges;
   for (std::int32_t local_index : local_indices)
-    marked_edges[local_index] = true;
+  {
+    if (!marked_edges[local_index])
+    {
+      marked_edges[local_index] = true;
+      new_edges.push_back(local_index);
+    }
+  }
+
+  return new_edges;
+}
+//-----------------------------------------------------------------------------
+Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+refinement::create_new_geometry(
+    const mesh::Mesh& mesh,
+    const std::vector<std::vector<std::int32_t>>& entities, int num_threads)
+{
+  // Build map from vertex -> geometry dof
+  const graph::AdjacencyList<std::int32_t>& x_dofmap = mesh.geometry().dofmap();
+  const int tdim = mesh.topology().dim();
+  auto c_to_v = mesh.topology().connectivity(tdim, 0);
+  assert(c_to_v);
+  auto map_v = mesh.topology().index_map(0);
+  assert(map_v);
+  std::vector<std::int32_t> vertex_to_x(map_v->size_local()
+                                        + map_v->num_ghosts());
+  auto map_c = mesh.topology().index_map(tdim);
+  assert(map_c);
+  for (int c = 0; c < map_c->size_local() + map_c->num_ghosts(); ++c)
+  {
+    auto vertices = c_to_v->links(c);
+    auto dofs = x_dofmap.links(c);
+    for (int i = 0; i < vertices.rows(); ++i)
+    {
+      // FIXME: We are making an assumption here on the
+      // ElementDofLayout. We should use an ElementDofLayout to map
+      // between local vertex index and x dof index.
+      vertex_to_x[vertices[i]] = dofs(i);
+    }
+  }
+
+  const Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>& x_g
+      = mesh.geometry().x();
+  const int gdim = mesh.geometry().dim();
+
+  // Offsets of the points of the entities of each dimension
+  assert((int)entities.size() <= tdim + 1);
+  std::vector<std::int32_t> offsets = {0};
+  std::vector<std::shared_ptr<const graph::AdjacencyList<std::int32_t>>>
+      e_to_v;
+  for (std::size_t d = 0; d < entities.size(); ++d)
+  {
+    offsets.push_back(offsets.back() + entities[d].size());
+    e_to_v.push_back(mesh.topology().connectivity(d, 0));
+    assert(d == 0 or e_to_v.back());
+  }
+
+  // Copy over the existing mesh vertices, and add the midpoints of the
+  // entities (the mean of the vertices, as in mesh::midpoints)
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      new_vertex_coordinates(offsets.back(), gdim);
+  common::parallel_for(
+      num_threads, offsets.back(), [&](int, std::int32_t i0, std::int32_t i1) {
+        for (std::int32_t i = i0; i < i1; ++i)
+        {
+          const int d = std::upper_bound(offsets.begin(), offsets.end(), i)
+                        - offsets.begin() - 1;
+          const std::int32_t e = entities[d][i - offsets[d]];
+          if (d == 0)
+          {
+            new_vertex_coordinates.row(i) = x_g.row(vertex_to_x[e]).head(gdim);
+            continue;
+          }
+
+          auto v = e_to_v[d]->links(e);
+          new_vertex_coordinates.row(i) = 0.0;
+          for (int j = 0; j < v.rows(); ++j)
+          {
+            new_vertex_coordinates.row(i)
+                += x_g.row(vertex_to_x[v[j]]).head(gdim);
+          }
+          new_vertex_coordinates.row(i) /= v.rows();
+        }
+      });
+
+  return new_vertex_coordinates;
+}
+//-----------------------------------------------------------------------------
+std::vector<std::vector<std::int64_t>>
+refinement::create_new_vertex_indices(const mesh::Mesh& mesh, int dim)
+{
+  // Ranges of the vertices and entities of all processes
+  const MPI_Comm comm = mesh.mpi_comm();
+  const int rank = dolfinx::MPI::rank(comm);
+  const int size = dolfinx::MPI::size(comm);
+  std::vector<std::int64_t> range;
+  for (int d = 0; d <= dim; ++d)
+  {
+    auto map = mesh.topology().index_map(d);
+    if (!map)
+      throw std::runtime_error("Entities of dimension " + std::to_string(d)
+                               + " have not been created.");
+    range.insert(range.end(), {map->local_range()[0], map->local_range()[1]});
+  }
+  std::vector<std::int64_t> ranges(size * range.size());
+  MPI_Allgather(range.data(), range.size(), MPI_INT64_T, ranges.data(),
+                range.size(), MPI_INT64_T, comm);
+
+  // The vertices of process p are numbered from the sum of the range
+  // starts of p, i.e. an entity of dimension d with global index i has
+  // the index i plus the range ends of p below d and the range starts
+  // of p above d
+  std::vector<std::vector<std::int64_t>> indices;
+  for (int d = 0; d <= dim; ++d)
+  {
+    auto map = mesh.topology().index_map(d);
+    std::vector<std::int64_t> offset(size, 0);
+    for (int p = 0; p < size; ++p)
+    {
+      for (int d1 = 0; d1 <= dim; ++d1)
+        if (d1 != d)
+          offset[p] += ranges[p * range.size() + 2 * d1 + (d1 < d ? 1 : 0)];
+    }
+
+    std::vector<std::int64_t>& index
+        = indices.emplace_back(map->global_indices(true));
+    const Eigen::Array<int, Eigen::Dynamic, 1> owners
+        = map->ghost_owner_rank();
+    const std::int32_t size_local = map->size_local();
+    for (std::size_t i = 0; i < index.size(); ++i)
+      index[i] += offset[(int)i < size_local ? rank : owners[i - size_local]];
+  }
+
+  return indices;
 }
 //-----------------------------------------------------------------------------
 std::pair<std::map<std::int32_t, std::int64_t>,
@@ -225,7 +347,8 @@ std::pair<std::map<std::int32_t, std::int64_t>,
 refinement::create_new_vertices(
     const MPI_Comm& neighbor_comm,
     const std::map<std::int32_t, std::set<std::int32_t>>& shared_edges,
-    const mesh::Mesh& mesh, const std::vector<bool>& marked_edges)
+    const mesh::Mesh& mesh, const std::vector<bool>& marked_edges,
+    int num_threads)
 {
   // Take marked_edges and use to create new vertices
   const std::shared_ptr<const common::IndexMap> edge_index_map
@@ -252,9 +375,16 @@ refinement::create_new_vertices(
     e.second += global_offset;
 
   // Create actual points
+  std::vector<std::int32_t> vertices(
+      mesh.topology().index_map(0)->size_local());
+  std::iota(vertices.begin(), vertices.end(), 0);
+  std::vector<std::int32_t> edges;
+  edges.reserve(num_new_vertices);
+  for (auto& e : local_edge_to_new_vertex)
+    edges.push_back(e.first);
   Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
       new_vertex_coordinates
-      = create_new_geometry(mesh, local_edge_to_new_vertex);
+      = create_new_geometry(mesh, {vertices, edges}, num_threads);
 
   // If they are shared, then the new global vertex index needs to be
   // sent off-process.
@@ -345,13 +475,13 @@ std::vector<std::int64_t> refinement::adjust_indices(
   return global_indices;
 }
 //-----------------------------------------------------------------------------
-mesh::Mesh refinement::build_local(
+std::pair<mesh::Mesh, std::vector<std::int64_t>> refinement::build_local(
     const mesh::Mesh& old_mesh, const std::vector<std::int64_t>& cell_topology,
     const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         new_vertex_coordinates)
 {
-  const std::size_t tdim = old_mesh.topology().dim();
-  const std::size_t num_cell_vertices = tdim + 1;
+  const std::size_t num_cell_vertices
+      = mesh::cell_num_entities(old_mesh.topology().cell_type(), 0);
   assert(cell_topology.size() % num_cell_vertices == 0);
   const std::size_t num_cells = cell_topology.size() / num_cell_vertices;
 
@@ -359,12 +489,12 @@ mesh::Mesh refinement::build_local(
                                 Eigen::RowMajor>>
       cells(cell_topology.data(), num_cells, num_cell_vertices);
 
-  mesh::Mesh mesh = mesh::create_mesh(
+  auto [mesh, original_cell_index] = mesh::create_mesh_with_original_index(
       old_mesh.mpi_comm(), graph::AdjacencyList<std::int64_t>(cells),
       old_mesh.geometry().cmap(), new_vertex_coordinates,
       mesh::GhostMode::none);
   assert(mesh.geometry().dim() == old_mesh.geometry().dim());
-  return mesh;
+  return {std::move(mesh), std::move(original_cell_index)};
 }
 //-----------------------------------------------------------------------------
 mesh::Mesh refinement::partition(
@@ -463,13 +593,10 @@ mesh::Mesh refinement::partition(
       topology_local.set_index_map(tdim - 1, map0);
     if (fv)
       topology_local.set_connectivity(fv, tdim - 1, 0);
-    auto [fc, ignore] = mesh::TopologyComputation::compute_connectivity(
-        topology_local, tdim - 1, tdim);
-    if (fc)
-      topology_local.set_connectivity(fc, tdim - 1, tdim);
 
     // Get facets that are on the boundary of the local topology, i.e
-    // are connect to one cell only
+    // are connect to one cell only (counted from the cell-facet
+    // connectivity, without computing the facet-cell connectivity)
     const std::vector boundary = mesh::compute_boundary_facets(topology_local);
 
     // Build distributed cell-vertex AdjacencyList, IndexMap for
@@ -505,3 +632,206 @@ mesh::Mesh refinement::partition(
   return mesh::Mesh(comm, std::move(topology), std::move(geometry));
 }
 //-----------------------------------------------------------------------------
+std::pair<mesh::Mesh, refinement::PlazaRefinementND::ParentMaps>
+refinement::create_refined_mesh(
+    const mesh::Mesh& mesh, const std::vector<std::int64_t>& cell_topology,
+    int num_new_ghost_cells,
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>& new_vertex_coordinates,
+    bool redistribute, bool compute_parents,
+    std::vector<std::int32_t>&& parent_cell,
+    std::vector<std::int8_t>&& parent_facet,
+    const std::vector<std::vector<std::int64_t>>& new_indices,
+    int num_threads)
+{
+  const int tdim = mesh.topology().dim();
+  const int num_facets
+      = mesh::cell_num_entities(mesh.topology().cell_type(), tdim - 1);
+  refinement::PlazaRefinementND::ParentMaps parents;
+  if (dolfinx::MPI::size(mesh.mpi_comm()) > 1)
+  {
+    mesh::Mesh new_mesh
+        = redistribute
+              ? refinement::partition(mesh, cell_topology, num_new_ghost_cells,
+                                      new_vertex_coordinates, true)
+              : refinement::build_distributed(
+                  mesh, cell_topology, num_new_ghost_cells,
+                  new_vertex_coordinates, new_indices, num_threads);
+    if (compute_parents)
+    {
+      // Without redistribution, the cells of the new mesh are in the
+      // order of cell_topology
+      assert(!redistribute);
+      parents.parent_cell = std::move(parent_cell);
+      parents.parent_facet = std::move(parent_facet);
+      parents.edge_vertex = edge_vertex(mesh, new_mesh, new_indices[1]);
+    }
+    return {std::move(new_mesh), std::move(parents)};
+  }
+
+  auto [new_mesh, original_cell_index]
+      = refinement::build_local(mesh, cell_topology, new_vertex_coordinates);
+  if (compute_parents)
+  {
+    // The cells are reordered on creation of the mesh
+    const std::size_t num_new_cells = original_cell_index.size();
+    parents.parent_cell.resize(num_new_cells);
+    parents.parent_facet.resize(num_new_cells * num_facets);
+    for (std::size_t c = 0; c < num_new_cells; ++c)
+    {
+      const std::int64_t c0 = original_cell_index[c];
+      parents.parent_cell[c] = parent_cell[c0];
+      std::copy_n(parent_facet.begin() + c0 * num_facets, num_facets,
+                  parents.parent_facet.begin() + c * num_facets);
+    }
+    parents.edge_vertex = edge_vertex(mesh, new_mesh, new_indices[1]);
+  }
+  return {std::move(new_mesh), std::move(parents)};
+}
+//-----------------------------------------------------------------------------
+mesh::Mesh refinement::build_distributed(
+    const mesh::Mesh& old_mesh, const std::vector<std::int64_t>& cell_topology,
+    int num_ghost_cells,
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        new_vertex_coordinates,
+    const std::vector<std::vector<std::int64_t>>& new_indices, int num_threads)
+{
+  common::Timer t0("Build distributed refined mesh");
+
+  MPI_Comm comm = old_mesh.mpi_comm();
+  int max_ghost_cells = 0;
+  MPI_Allreduce(&num_ghost_cells, &max_ghost_cells, 1, MPI_INT, MPI_MAX,
+                comm);
+  if (max_ghost_cells > 0)
+  {
+    throw std::runtime_error("Refinement of ghosted meshes without "
+                             "re-partitioning is not supported yet.");
+  }
+
+  const mesh::CellType cell_type = old_mesh.topology().cell_type();
+  const int tdim = old_mesh.topology().dim();
+  const int num_cell_vertices = mesh::cell_num_entities(cell_type, 0);
+  const fem::CoordinateElement& cmap = old_mesh.geometry().cmap();
+  if (cmap.dof_layout().num_dofs() != num_cell_vertices)
+    throw std::runtime_error("Refinement requires an affine geometry.");
+
+  // The ghost vertices are the ghost vertices of the old mesh and the
+  // new vertices of ghost entities, owned by the owners of the entities
+  std::vector<std::int64_t> ghosts;
+  std::vector<int> ghost_owners;
+  std::vector<std::vector<std::int32_t>> ghost_entities(new_indices.size());
+  for (std::size_t d = 0; d < new_indices.size(); ++d)
+  {
+    auto map = old_mesh.topology().index_map(d);
+    assert(map);
+    const Eigen::Array<int, Eigen::Dynamic, 1> owners
+        = map->ghost_owner_rank();
+    const std::int32_t size_local = map->size_local();
+    for (std::int32_t i = 0; i < map->num_ghosts(); ++i)
+    {
+      if (const std::int64_t v = new_indices[d][size_local + i]; v >= 0)
+      {
+        ghosts.push_back(v);
+        ghost_owners.push_back(owners[i]);
+        ghost_entities[d].push_back(size_local + i);
+      }
+    }
+  }
+
+  const std::int32_t num_owned = new_vertex_coordinates.rows();
+  auto map_v = std::make_shared<common::IndexMap>(
+      comm, num_owned,
+      dolfinx::MPI::compute_graph_edges(
+          comm, std::set<int>(ghost_owners.begin(), ghost_owners.end())),
+      ghosts, ghost_owners, 1);
+
+  // Cell-vertex connectivity, with the owned vertices numbered in the
+  // order of their global index followed by the ghosts
+  const std::int64_t offset = map_v->local_range()[0];
+  std::unordered_map<std::int64_t, std::int32_t> ghost_to_local;
+  ghost_to_local.reserve(ghosts.size());
+  for (std::size_t i = 0; i < ghosts.size(); ++i)
+    ghost_to_local.insert({ghosts[i], num_owned + i});
+  const std::int32_t num_cells = cell_topology.size() / num_cell_vertices;
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> cells(cell_topology.size());
+  for (std::size_t i = 0; i < cell_topology.size(); ++i)
+  {
+    const std::int64_t v = cell_topology[i];
+    if (v >= offset and v < offset + num_owned)
+      cells[i] = v - offset;
+    else
+    {
+      auto it = ghost_to_local.find(v);
+      assert(it != ghost_to_local.end());
+      cells[i] = it->second;
+    }
+  }
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 1> offsets(num_cells + 1);
+  for (std::int32_t c = 0; c <= num_cells; ++c)
+    offsets[c] = c * num_cell_vertices;
+
+  mesh::Topology topology(comm, cell_type);
+  topology.set_index_map(0, map_v);
+  auto c0 = std::make_shared<graph::AdjacencyList<std::int32_t>>(
+      num_owned + ghosts.size());
+  topology.set_connectivity(c0, 0, 0);
+  topology.set_index_map(
+      tdim, std::make_shared<common::IndexMap>(
+                comm, num_cells, std::vector<int>(),
+                std::vector<std::int64_t>(), std::vector<int>(), 1));
+  topology.set_connectivity(
+      std::make_shared<graph::AdjacencyList<std::int32_t>>(cells, offsets),
+      tdim, 0);
+
+  // The geometry nodes are the vertices, with the coordinates of the
+  // ghosts computed from the old mesh
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      ghost_coordinates
+      = refinement::create_new_geometry(old_mesh, ghost_entities, num_threads);
+  Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> x(
+      num_owned + ghosts.size(), new_vertex_coordinates.cols());
+  x.topRows(num_owned) = new_vertex_coordinates;
+  x.bottomRows(ghosts.size()) = ghost_coordinates;
+  mesh::Geometry geometry(
+      map_v,
+      graph::AdjacencyList<std::int32_t>(std::move(cells), std::move(offsets)),
+      cmap, x, map_v->global_indices(true));
+
+  return mesh::Mesh(comm, std::move(topology), std::move(geometry));
+}
+//-----------------------------------------------------------------------------
+mesh::Mesh refinement::repartition(const mesh::Mesh& mesh)
+{
+  common::Timer t0("Repartition refined mesh");
+
+  // The owned cells (global vertex indices) and the coordinates of the
+  // owned vertices, in the order of their global index
+  const int tdim = mesh.topology().dim();
+  auto map_v = mesh.topology().index_map(0);
+  assert(map_v);
+  auto map_c = mesh.topology().index_map(tdim);
+  assert(map_c);
+  auto c_to_v = mesh.topology().connectivity(tdim, 0);
+  assert(c_to_v);
+  const std::vector<std::int64_t> global_indices = map_v->global_indices(true);
+  const int num_cell_vertices
+      = mesh::cell_num_entities(mesh.topology().cell_type(), 0);
+  Eigen::Array<std::int64_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      cells(map_c->size_local(), num_cell_vertices);
+  for (int c = 0; c < cells.rows(); ++c)
+  {
+    auto vertices = c_to_v->links(c);
+    for (int i = 0; i < num_cell_vertices; ++i)
+      cells(c, i) = global_indices[vertices[i]];
+  }
+
+  std::vector<std::int32_t> vertices(map_v->size_local());
+  std::iota(vertices.begin(), vertices.end(), 0);
+  const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      x = refinement::create_new_geometry(mesh, {vertices});
+
+  return mesh::create_mesh(mesh.mpi_comm(),
+                           graph::AdjacencyList<std::int64_t>(cells),
+                           mesh.geometry().cmap(), x, mesh::GhostMode::none);
+}
+//-----------------------------------------------------------------------------
@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include "PlazaRefinementND.h"
 #include <Eigen/Dense>
+#include <algorithm>
 #include <cstdint>
 #include <dolfinx/common/MPI.h>
 #include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
 namespace dolfinx
@@ -44,11 +47,43 @@ compute_edge_sharing(const mesh::Mesh& mesh);
 /// neighbor
 /// @param marked_edges Marked edges to be updated
 /// @param map_e IndexMap for edges
-void update_logical_edgefunction(
+/// @return The received edges that were not marked before (local
+///   indices)
+std::vector<std::int32_t> update_logical_edgefunction(
     const MPI_Comm& neighbor_comm,
     const std::vector<std::vector<std::int32_t>>& marked_for_update,
     std::vector<bool>& marked_edges, const common::IndexMap& map_e);
 
+/// Create the geometry of a refined mesh: copies of vertices of a mesh
+/// followed by the midpoints (the mean of the vertices) of entities of
+/// dimension 1, 2, ..., e.g. the owned vertices and the refined edges
+/// @param[in] mesh Existing mesh
+/// @param[in] entities The (local) entities with a vertex of the
+///   refined mesh, for each dimension from zero (vertices)
+/// @param[in] num_threads The number of threads
+/// @return The coordinates of the vertices of the refined mesh
+Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+create_new_geometry(const mesh::Mesh& mesh,
+                    const std::vector<std::vector<std::int32_t>>& entities,
+                    int num_threads = 1);
+
+/// Compute the global indices of the vertices of a refined mesh with a
+/// new vertex for every entity of dimension 1, ..., @p dim (uniform
+/// refinement). The vertices of a process are numbered in the order:
+/// its vertices, then the new vertices of its entities of dimension 1,
+/// ..., @p dim (in the order of the entities) as in adjust_indices, so
+/// that the index of a new vertex of a ghost entity follows from the
+/// ranges of its owner, with a single collective.
+/// @param[in] mesh Existing mesh, with the entities of dimension 1,
+///   ..., @p dim
+/// @param[in] dim The highest dimension of the entities with a new
+///   vertex
+/// @return The global index of each vertex (owned and ghost) of @p
+///   mesh, followed by the global index of the new vertex of each
+///   entity (owned and ghost) for the dimensions 1, ..., @p dim
+std::vector<std::vector<std::int64_t>>
+create_new_vertex_indices(const mesh::Mesh& mesh, int dim);
+
 /// Add new vertex for each marked edge, and create
 /// new_vertex_coordinates and global_edge->new_vertex map.
 /// Communicate new vertices with MPI to all affected processes.
@@ -56,13 +91,16 @@ void update_logical_edgefunction(
 /// @param[in] shared_edges
 /// @param[in] mesh Existing mesh
 /// @param[in] marked_edges
+/// @param[in] num_threads The number of threads for the computation of
+///   the geometry array
 /// @return edge_to_new_vertex map and geometry array
 std::pair<std::map<std::int32_t, std::int64_t>,
           Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
 create_new_vertices(
     const MPI_Comm& neighbor_comm,
     const std::map<std::int32_t, std::set<std::int32_t>>& shared_edges,
-    const mesh::Mesh& mesh, const std::vector<bool>& marked_edges);
+    const mesh::Mesh& mesh, const std::vector<bool>& marked_edges,
+    int num_threads = 1);
 
 /// Use vertex and topology data to partition new mesh across
 /// processes
@@ -80,16 +118,85 @@ partition(const mesh::Mesh& old_mesh,
                              Eigen::RowMajor>& new_vertex_coordinates,
           bool redistribute);
 
+/// Build a refined mesh without redistribution, incrementally from the
+/// distribution of the mesh that is refined (collective). The owned
+/// vertices of a process are its vertices in the mesh that is refined
+/// and the new vertices of its owned entities, and the ghost vertices
+/// are its ghost vertices and the new vertices of its ghost entities,
+/// owned by the owners of the entities. The vertex IndexMap, the
+/// topology and the geometry are built without the dual graph and the
+/// distribution of the geometry of mesh::create_mesh.
+/// @param[in] old_mesh The mesh that is refined, without ghost cells
+/// @param[in] cell_topology The (global) vertices of the new cells
+/// @param[in] num_ghost_cells Number of ghost cells (must be zero)
+/// @param[in] new_vertex_coordinates The coordinates of the owned
+///   vertices, in the order of their global index
+/// @param[in] new_indices The global indices of the vertices of @p
+///   old_mesh and of the new vertices of its entities (see
+///   create_new_vertex_indices)
+/// @param[in] num_threads The number of threads for the computation of
+///   the geometry of the ghost vertices
+/// @return The refined mesh, with the cells in the order of @p
+///   cell_topology
+mesh::Mesh build_distributed(
+    const mesh::Mesh& old_mesh, const std::vector<std::int64_t>& cell_topology,
+    int num_ghost_cells,
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
+        new_vertex_coordinates,
+    const std::vector<std::vector<std::int64_t>>& new_indices,
+    int num_threads = 1);
+
+/// Repartition a mesh without ghost cells, e.g. a mesh that was
+/// refined without redistribution and is imbalanced (collective)
+/// @param[in] mesh The mesh
+/// @return The repartitioned mesh
+mesh::Mesh repartition(const mesh::Mesh& mesh);
+
 /// Build local mesh from internal data when not running in parallel
 /// @param[in] old_mesh
 /// @param[in] cell_topology
 /// @param[in] new_vertex_coordinates
-/// @return A Mesh
-mesh::Mesh build_local(
+/// @return A Mesh, and the index in @p cell_topology of each cell of
+///   the mesh
+std::pair<mesh::Mesh, std::vector<std::int64_t>> build_local(
     const mesh::Mesh& old_mesh, const std::vector<std::int64_t>& cell_topology,
     const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>&
         new_vertex_coordinates);
 
+/// Create a refined mesh from the new cells and the coordinates of the
+/// owned vertices (collective), and the relations to the mesh if @p
+/// compute_parents is true
+/// @param[in] mesh The mesh that is refined
+/// @param[in] cell_topology The (global) vertices of the new cells,
+///   with the new ghost cells at the end
+/// @param[in] num_new_ghost_cells Number of new ghost cells
+/// @param[in] new_vertex_coordinates The coordinates of the owned
+///   vertices of the refined mesh
+/// @param[in] redistribute Redistribute the refined mesh
+/// @param[in] compute_parents Compute the parent maps, which requires
+///   that the mesh is not redistributed
+/// @param[in] parent_cell The parent cell of each new cell
+/// @param[in] parent_facet The parent facet of each facet of each new
+///   cell (see PlazaRefinementND::ParentMaps)
+/// @param[in] new_indices The global index in the refined mesh of
+///   each vertex of @p mesh, followed by the global index of the new
+///   vertex (or -1) of each entity of dimension 1, 2, ... (see
+///   create_new_vertex_indices)
+/// @param[in] num_threads The number of threads for the computation of
+///   the geometry
+/// @return The refined mesh and the parent maps (empty if @p
+///   compute_parents is false)
+std::pair<mesh::Mesh, PlazaRefinementND::ParentMaps> create_refined_mesh(
+    const mesh::Mesh& mesh, const std::vector<std::int64_t>& cell_topology,
+    int num_new_ghost_cells,
+    const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                       Eigen::RowMajor>& new_vertex_coordinates,
+    bool redistribute, bool compute_parents,
+    std::vector<std::int32_t>&& parent_cell,
+    std::vector<std::int8_t>&& parent_facet,
+    const std::vector<std::vector<std::int64_t>>& new_indices,
+    int num_threads = 1);
+
 /// Adjust indices to account for extra n values on each process This
 /// is a utility to help add new topological vertices on each process
 /// into the space of the index map.
@@ -0,0 +1,38 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for aligned storage
+
+#include <catch.hpp>
+#include <complex>
+#include <cstdint>
+#include <dolfinx/common/AlignedAllocator.h>
+
+using namespace dolfinx;
+
+namespace
+{
+template <typename T>
+void test_aligned_vector()
+{
+  for (std::size_t n : {1, 7, 8, 100})
+  {
+    common::aligned_vector<T> x(common::padded_size<T>(n));
+    CHECK(reinterpret_cast<std::uintptr_t>(x.data())
+              % common::cache_line_size
+          == 0);
+    CHECK(x.size() >= n);
+    CHECK((x.size() * sizeof(T)) % common::cache_line_size == 0);
+  }
+}
+} // namespace
+
+TEST_CASE("Aligned vector", "[aligned_allocator]")
+{
+  CHECK_NOTHROW(test_aligned_vector<double>());
+  CHECK_NOTHROW(test_aligned_vector<float>());
+  CHECK_NOTHROW(test_aligned_vector<std::complex<double>>());
+}
@@ -0,0 +1,101 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for the exact sum of floating point numbers
+
+#include <algorithm>
+#include <catch.hpp>
+#include <cmath>
+#include <complex>
+#include <dolfinx/common/ExactSum.h>
+#include <dolfinx/common/MPI.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+void test_order_independence()
+{
+  // Numbers of very different magnitudes, including subnormals
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  std::vector<double> x(10000);
+  for (double& v : x)
+    v = dist(engine) * std::pow(10.0, std::round(40.0 * dist(engine)));
+  x.insert(x.end(), {1.0e300, -1.0e300, 1.0e-310, -3.0e-320});
+
+  common::ExactSum<double> s0;
+  for (double v : x)
+    s0 += v;
+
+  // Sum of shuffled numbers, split into partial sums
+  std::shuffle(x.begin(), x.end(), engine);
+  common::ExactSum<double> s1, s2;
+  for (std::size_t i = 0; i < x.size() / 3; ++i)
+    s1 += x[i];
+  for (std::size_t i = x.size() / 3; i < x.size(); ++i)
+    s2 += x[i];
+  s2 += s1;
+  CHECK(s0.value() == s2.value());
+}
+
+void test_exact()
+{
+  // The rounding errors of the plain sum are not made
+  common::ExactSum<double> s0;
+  s0 += 0.1;
+  s0 += 0.2;
+  s0 += -0.3;
+  CHECK(s0.value() == (0.1 - 0.3) + 0.2);
+
+  common::ExactSum<double> s1;
+  s1 += 1.0;
+  s1 += 1.0e-30;
+  s1 += -1.0;
+  CHECK(s1.value() == 1.0e-30);
+
+  common::ExactSum<std::complex<double>> s2;
+  s2 += std::complex<double>(1.0, -2.0);
+  s2 += std::complex<double>(-1.0, 0.5);
+  CHECK(s2.value() == std::complex<double>(0.0, -1.5));
+
+  common::ExactSum<double> s3;
+  s3 += 1.0;
+  s3 += std::numeric_limits<double>::infinity();
+  CHECK(s3.value() == std::numeric_limits<double>::infinity());
+}
+
+void test_allreduce()
+{
+  // The reduced sum is the same on all processes and for any
+  // distribution of the numbers
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  std::vector<double> x(1000);
+  for (std::size_t i = 0; i < x.size(); ++i)
+    x[i] = std::sin(double(i)) * std::pow(2.0, double(i % 50));
+
+  common::ExactSum<double> s_ref;
+  for (double v : x)
+    s_ref += v;
+
+  common::ExactSum<double> s;
+  for (std::size_t i = mpi_rank; i < x.size(); i += mpi_size)
+    s += x[i];
+  s.allreduce(MPI_COMM_WORLD);
+  CHECK(s.value() == s_ref.value());
+}
+} // namespace
+
+TEST_CASE("Exact sum", "[exact_sum]")
+{
+  CHECK_NOTHROW(test_order_independence());
+  CHECK_NOTHROW(test_exact());
+  CHECK_NOTHROW(test_allreduce());
+}
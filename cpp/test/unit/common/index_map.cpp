@@ -5,6 +5,7 @@
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
 #include <catch.hpp>
+#include <complex>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/MPI.h>
 #include <numeric>
@@ -98,6 +99,108 @@ void test_scatter_rev()
   sum = std::accumulate(data_local.begin(), data_local.end(), 0);
   CHECK(sum == 2 * n * value * num_ghosts);
 }
+
+template <typename T>
+void test_scatter_begin_end()
+{
+  // Block size
+  auto n = GENERATE(1, 5);
+
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  const int size_local = 100;
+
+  // Create some ghost entries on next process
+  const int num_ghosts = (mpi_size - 1) * 3;
+  Eigen::Array<std::int64_t, Eigen::Dynamic, 1> ghosts(num_ghosts);
+  for (int i = 0; i < num_ghosts; ++i)
+    ghosts[i] = (mpi_rank + 1) % mpi_size * size_local + i;
+
+  std::vector<int> global_ghost_owner(ghosts.size(), (mpi_rank + 1) % mpi_size);
+
+  // Create an IndexMap
+  common::IndexMap idx_map(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD,
+          std::set<int>(global_ghost_owner.begin(), global_ghost_owner.end())),
+      ghosts, global_ghost_owner, 1);
+
+  // Create owned and ghost data in one array, as in a vector
+  const T val = 11;
+  std::vector<T> data(n * (size_local + num_ghosts), -1);
+  std::fill_n(data.begin(), n * size_local, val * T(mpi_rank));
+  T* data_ghost = data.data() + n * size_local;
+
+  // Scatter owned values to the ghost region in place
+  common::IndexMap::ScatterRequest<T> request;
+  idx_map.scatter_fwd_begin(data.data(), n, request);
+  idx_map.scatter_fwd_end(data_ghost, request);
+  CHECK(std::all_of(data_ghost, data_ghost + n * num_ghosts, [=](auto x) {
+    return x == val * T((mpi_rank + 1) % mpi_size);
+  }));
+
+  // Send ghost values back to the owner and accumulate
+  std::fill_n(data.begin(), n * size_local, 0);
+  std::fill_n(data_ghost, n * num_ghosts, 1);
+  idx_map.scatter_rev_begin(data_ghost, n, request);
+  idx_map.scatter_rev_end(data.data(), common::IndexMap::Mode::add, request);
+  T sum = std::accumulate(data.begin(), data.begin() + n * size_local, T(0));
+  CHECK(sum == T(n * num_ghosts));
+
+  // Repeat the reverse scatter, reusing the plan of the request
+  idx_map.scatter_rev_begin(data_ghost, n, request);
+  idx_map.scatter_rev_end(data.data(), common::IndexMap::Mode::add, request);
+  sum = std::accumulate(data.begin(), data.begin() + n * size_local, T(0));
+  CHECK(sum == T(2 * n * num_ghosts));
+}
+
+void test_shared_index_ranks()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  const int size_local = 100;
+
+  // Create some ghost entries on next process
+  const int num_ghosts = (mpi_size - 1) * 3;
+  Eigen::Array<std::int64_t, Eigen::Dynamic, 1> ghosts(num_ghosts);
+  for (int i = 0; i < num_ghosts; ++i)
+    ghosts[i] = (mpi_rank + 1) % mpi_size * size_local + i;
+
+  std::vector<int> global_ghost_owner(ghosts.size(), (mpi_rank + 1) % mpi_size);
+
+  // Create an IndexMap
+  common::IndexMap idx_map(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD,
+          std::set<int>(global_ghost_owner.begin(), global_ghost_owner.end())),
+      ghosts, global_ghost_owner, 1);
+
+  // The first num_ghosts owned indices are ghosts on the previous
+  // process, and the ghosts are owned by the next process
+  const common::IndexMap::SharedIndices& shared
+      = idx_map.shared_index_ranks();
+  CHECK(shared.indices.size() == std::size_t(2 * num_ghosts));
+  CHECK(shared.ranks.num_nodes() == 2 * num_ghosts);
+  CHECK(std::is_sorted(shared.indices.begin(), shared.indices.end()));
+  for (int i = 0; i < num_ghosts; ++i)
+  {
+    const std::int32_t pos0 = shared.find(i);
+    REQUIRE(pos0 != -1);
+    REQUIRE(shared.ranks.num_links(pos0) == 1);
+    CHECK(shared.ranks.links(pos0)[0] == (mpi_rank + mpi_size - 1) % mpi_size);
+
+    const std::int32_t pos1 = shared.find(size_local + i);
+    REQUIRE(pos1 != -1);
+    REQUIRE(shared.ranks.num_links(pos1) == 1);
+    CHECK(shared.ranks.links(pos1)[0] == (mpi_rank + 1) % mpi_size);
+  }
+  CHECK(shared.find(size_local - 1) == -1);
+
+  // The data is cached
+  CHECK(&idx_map.shared_index_ranks() == &shared);
+}
 } // namespace
 
 TEST_CASE("Scatter forward using IndexMap", "[index_map_scatter_fwd]")
@@ -109,3 +212,16 @@ TEST_CASE("Scatter reverse using IndexMap", "[index_map_scatter_rev]")
 {
   CHECK_NOTHROW(test_scatter_rev());
 }
+
+TEST_CASE("Split-phase scatter using IndexMap",
+          "[index_map_scatter_begin_end]")
+{
+  CHECK_NOTHROW(test_scatter_begin_end<float>());
+  CHECK_NOTHROW(test_scatter_begin_end<double>());
+  CHECK_NOTHROW(test_scatter_begin_end<std::complex<double>>());
+}
+
+TEST_CASE("Shared index ranks of IndexMap", "[index_map_shared_index_ranks]")
+{
+  CHECK_NOTHROW(test_shared_index_ranks());
+}
@@ -0,0 +1,104 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include <catch.hpp>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <set>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+void test_compute_graph_edges()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+
+  // Each rank has an edge to the next two ranks
+  std::set<int> edges
+      = {(mpi_rank + 1) % mpi_size, (mpi_rank + 2) % mpi_size};
+  const std::vector<int> in_edges
+      = dolfinx::MPI::compute_graph_edges(MPI_COMM_WORLD, edges);
+
+  std::set<int> expected
+      = {(mpi_rank - 1 + mpi_size) % mpi_size,
+         (mpi_rank - 2 + 2 * mpi_size) % mpi_size};
+  CHECK(in_edges == std::vector<int>(expected.begin(), expected.end()));
+}
+
+void test_sparse_all_to_all()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+
+  // Send (rank + 1) copies of the rank to the next rank only
+  std::vector<std::int64_t> data(mpi_rank + 1, mpi_rank);
+  std::vector<std::int32_t> offsets(mpi_size + 1, 0);
+  const int dest = (mpi_rank + 1) % mpi_size;
+  for (int p = dest; p < mpi_size; ++p)
+    offsets[p + 1] = data.size();
+
+  const graph::AdjacencyList<std::int64_t> recv = dolfinx::MPI::all_to_all(
+      MPI_COMM_WORLD, graph::AdjacencyList<std::int64_t>(data, offsets));
+
+  const int src = (mpi_rank - 1 + mpi_size) % mpi_size;
+  REQUIRE(recv.num_nodes() == mpi_size);
+  for (int p = 0; p < mpi_size; ++p)
+  {
+    if (p == src)
+    {
+      auto links = recv.links(p);
+      REQUIRE(links.rows() == src + 1);
+      CHECK((links == src).all());
+    }
+    else
+      CHECK(recv.num_links(p) == 0);
+  }
+}
+
+void test_sparse_exchange()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+
+  // Send the rank to the previous rank, and an empty message (which is
+  // not sent) to the next rank if it is another rank
+  std::vector<int> dests = {(mpi_rank - 1 + mpi_size) % mpi_size};
+  std::vector<std::int32_t> offsets = {0, 1};
+  if (mpi_size > 2)
+  {
+    dests.push_back((mpi_rank + 1) % mpi_size);
+    offsets.push_back(1);
+  }
+  const std::vector<std::int64_t> data = {mpi_rank};
+
+  const auto [srcs, recv] = dolfinx::MPI::sparse_exchange(
+      MPI_COMM_WORLD, dests, graph::AdjacencyList<std::int64_t>(data, offsets));
+
+  const int src = (mpi_rank + 1) % mpi_size;
+  REQUIRE(srcs == std::vector<int>{src});
+  REQUIRE(recv.num_nodes() == 1);
+  REQUIRE(recv.num_links(0) == 1);
+  CHECK(recv.links(0)[0] == src);
+}
+} // namespace
+
+TEST_CASE("Compute communication graph edges", "[mpi_graph_edges]")
+{
+  CHECK_NOTHROW(test_compute_graph_edges());
+}
+
+TEST_CASE("Sparse all-to-all", "[mpi_all_to_all]")
+{
+  CHECK_NOTHROW(test_sparse_all_to_all());
+}
+
+TEST_CASE("Sparse dynamic data exchange", "[mpi_sparse_exchange]")
+{
+  CHECK_NOTHROW(test_sparse_exchange());
+}
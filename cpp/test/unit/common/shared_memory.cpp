@@ -0,0 +1,43 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for the memory shared by the processes of a node
+
+#include <catch.hpp>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/common/SharedMemory.h>
+#include <numeric>
+
+using namespace dolfinx;
+
+namespace
+{
+void test_shared_memory()
+{
+  // The first process of each node writes the data, which is read by
+  // all processes of the node
+  const int n = 1000;
+  common::SharedMemory memory(MPI_COMM_WORLD, n * sizeof(double));
+  CHECK(memory.size() == n * sizeof(double));
+  double* x = memory.data<double>();
+  if (memory.is_node_root())
+    std::iota(x, x + n, 0.0);
+  memory.synchronize();
+
+  for (int i = 0; i < n; ++i)
+    CHECK(x[i] == double(i));
+
+  // The processes of a node are processes of the communicator
+  const int node_size = dolfinx::MPI::size(memory.node_comm());
+  CHECK(node_size >= 1);
+  CHECK(node_size <= dolfinx::MPI::size(MPI_COMM_WORLD));
+}
+} // namespace
+
+TEST_CASE("Shared memory", "[shared_memory]")
+{
+  CHECK_NOTHROW(test_shared_memory());
+}
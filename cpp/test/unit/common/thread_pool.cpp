@@ -0,0 +1,84 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+//
+// Unit tests for the thread pool
+
+#include <atomic>
+#include <catch.hpp>
+#include <dolfinx/common/ThreadPool.h>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+void test_parallel_for(int num_threads)
+{
+  common::ThreadPool pool(num_threads);
+  CHECK(pool.num_threads() == num_threads);
+
+  // Each index is visited once, by the chunk that contains it
+  const std::int32_t n = 1000;
+  std::vector<int> visits(n, 0);
+  std::vector<int> chunk(n, -1);
+  pool.parallel_for(7, n, [&](int i, std::int32_t c0, std::int32_t c1) {
+    for (std::int32_t j = c0; j < c1; ++j)
+    {
+      ++visits[j];
+      chunk[j] = i;
+    }
+  });
+  CHECK(std::all_of(visits.begin(), visits.end(),
+                    [](int v) { return v == 1; }));
+  CHECK(std::is_sorted(chunk.begin(), chunk.end()));
+  CHECK(chunk.front() == 0);
+  CHECK(chunk.back() == 6);
+
+  // Nested loops do not deadlock
+  std::atomic<int> count = 0;
+  pool.parallel_for(4, 4, [&](int, std::int32_t, std::int32_t) {
+    pool.parallel_for(4, 100, [&](int, std::int32_t c0, std::int32_t c1) {
+      count += c1 - c0;
+    });
+  });
+  CHECK(count == 400);
+
+  // Exceptions of a chunk are rethrown
+  CHECK_THROWS_AS(
+      pool.parallel_for(4, 4,
+                        [](int i, std::int32_t, std::int32_t) {
+                          if (i == 2)
+                            throw std::runtime_error("chunk");
+                        }),
+      std::runtime_error);
+}
+
+void test_submit(int num_threads)
+{
+  common::ThreadPool pool(num_threads);
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 10; ++i)
+    results.push_back(pool.submit([i]() { return i * i; }));
+  int sum = 0;
+  for (auto& r : results)
+    sum += r.get();
+  CHECK(sum == 285);
+}
+} // namespace
+
+TEST_CASE("Thread pool parallel for", "[thread_pool]")
+{
+  for (int num_threads : {1, 2, 4})
+    CHECK_NOTHROW(test_parallel_for(num_threads));
+}
+
+TEST_CASE("Thread pool tasks", "[thread_pool]")
+{
+  for (int num_threads : {1, 3})
+    CHECK_NOTHROW(test_submit(num_threads));
+}
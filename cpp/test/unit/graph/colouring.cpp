@@ -0,0 +1,108 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include <algorithm>
+#include <catch.hpp>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/graph/colouring.h>
+#include <set>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+// Graph of n nodes on a ring, each node linked to the nodes at
+// distance one and two
+graph::AdjacencyList<std::int32_t> create_ring(std::int32_t n)
+{
+  std::vector<std::vector<std::int32_t>> links(n);
+  for (std::int32_t i = 0; i < n; ++i)
+    for (std::int32_t d : {-2, -1, 1, 2})
+      links[i].push_back((i + d + n) % n);
+  return graph::AdjacencyList<std::int32_t>(links);
+}
+
+void test_colouring()
+{
+  const graph::AdjacencyList<std::int32_t> graph = create_ring(10000);
+  const std::vector<std::int32_t> colours = graph::compute_colouring(graph);
+  REQUIRE((std::int32_t)colours.size() == graph.num_nodes());
+  for (std::int32_t i = 0; i < graph.num_nodes(); ++i)
+  {
+    CHECK(colours[i] >= 0);
+    CHECK(colours[i] <= 4);
+    for (Eigen::Index j = 0; j < graph.num_links(i); ++j)
+      CHECK(colours[i] != colours[graph.links(i)[j]]);
+  }
+
+  // The colouring does not depend on the number of threads
+  CHECK(graph::compute_colouring(graph, 4) == colours);
+}
+
+void test_distributed_colouring()
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+
+  // Distribute a ring with m nodes per process
+  const std::int32_t m = 3000;
+  const std::int64_t n = m * mpi_size;
+  const std::int64_t offset = m * mpi_rank;
+  std::vector<std::int64_t> ghosts;
+  std::vector<int> ghost_owners;
+  for (std::int64_t i : {offset - 2, offset - 1, offset + m, offset + m + 1})
+  {
+    const std::int64_t g = (i + n) % n;
+    if (g < offset or g >= offset + m)
+    {
+      ghosts.push_back(g);
+      ghost_owners.push_back(g / m);
+    }
+  }
+  const common::IndexMap map(
+      MPI_COMM_WORLD, m,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD,
+          std::set<int>(ghost_owners.begin(), ghost_owners.end())),
+      ghosts, ghost_owners, 1);
+
+  // Graph for the owned nodes, with local indices
+  const std::vector<std::int64_t> global = map.global_indices();
+  std::vector<std::vector<std::int32_t>> links(m);
+  for (std::int32_t i = 0; i < m; ++i)
+  {
+    for (std::int64_t d : {-2, -1, 1, 2})
+    {
+      const std::int64_t g = (offset + i + d + n) % n;
+      const auto it = std::find(global.begin(), global.end(), g);
+      REQUIRE(it != global.end());
+      links[i].push_back(std::distance(global.begin(), it));
+    }
+  }
+  const std::vector<std::int32_t> colours = graph::compute_colouring(
+      graph::AdjacencyList<std::int32_t>(links), map, 2);
+
+  // The colouring is the serial colouring of the global graph
+  const std::vector<std::int32_t> colours_global
+      = graph::compute_colouring(create_ring(n));
+  REQUIRE(colours.size() == global.size());
+  for (std::size_t i = 0; i < global.size(); ++i)
+    CHECK(colours[i] == colours_global[global[i]]);
+}
+} // namespace
+
+TEST_CASE("Graph colouring", "[graph_colouring]")
+{
+  CHECK_NOTHROW(test_colouring());
+}
+
+TEST_CASE("Distributed graph colouring", "[graph_colouring]")
+{
+  CHECK_NOTHROW(test_distributed_colouring());
+}
@@ -0,0 +1,76 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include <catch.hpp>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/graph/AdjacencyList.h>
+#include <dolfinx/la/SparsityPattern.h>
+#include <memory>
+#include <set>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+// Check that inserting the entries coupling the blocks of entities at
+// once gives the same pattern as inserting the entities one by one
+void test_insert_entities(bool blocked)
+{
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  const int size_local = 20;
+  const int bs = 2;
+
+  // Create some ghost entries on next process
+  const int num_ghosts = (mpi_size - 1) * 3;
+  Eigen::Array<std::int64_t, Eigen::Dynamic, 1> ghosts(num_ghosts);
+  for (int i = 0; i < num_ghosts; ++i)
+    ghosts[i] = (mpi_rank + 1) % mpi_size * size_local + i;
+  std::vector<int> owners(ghosts.size(), (mpi_rank + 1) % mpi_size);
+  auto map = std::make_shared<common::IndexMap>(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD, std::set<int>(owners.begin(), owners.end())),
+      ghosts, owners, bs);
+
+  // Entities with three (block) indices each, which overlap and
+  // include ghosts
+  const int num_entities = 30;
+  const int size = size_local + num_ghosts;
+  Eigen::Array<std::int32_t, Eigen::Dynamic, 3, Eigen::RowMajor> entities(
+      num_entities, 3);
+  for (int e = 0; e < num_entities; ++e)
+    entities.row(e) << e % size, (7 * e + 3) % size, (e + 1) % size;
+  const graph::AdjacencyList<std::int32_t> list(entities);
+
+  la::SparsityPattern p0(MPI_COMM_WORLD, {map, map}, blocked);
+  la::SparsityPattern p1(MPI_COMM_WORLD, {map, map}, blocked);
+  const int bs_insert = blocked ? 1 : bs;
+  for (int e = 0; e < num_entities; ++e)
+  {
+    Eigen::Array<std::int32_t, Eigen::Dynamic, 1> dofs(bs_insert * 3);
+    for (int i = 0; i < 3; ++i)
+      for (int k = 0; k < bs_insert; ++k)
+        dofs[bs_insert * i + k] = bs_insert * entities(e, i) + k;
+    p0.insert(dofs, dofs);
+  }
+  p1.insert_entities(list, list, {bs, bs}, 3);
+  p0.assemble();
+  p1.assemble();
+
+  REQUIRE(p0.num_nonzeros() == p1.num_nonzeros());
+  CHECK(p0.diagonal_pattern() == p1.diagonal_pattern());
+  CHECK(p0.off_diagonal_pattern() == p1.off_diagonal_pattern());
+}
+} // namespace
+
+TEST_CASE("Insert entities into la::SparsityPattern", "[sparsity_pattern]")
+{
+  CHECK_NOTHROW(test_insert_entities(false));
+  CHECK_NOTHROW(test_insert_entities(true));
+}
@@ -0,0 +1,172 @@
+// Copyright (C) 2020 Garth N. Wells
+//
+// This file is part of DOLFINX (https://www.fenicsproject.org)
+//
+// SPDX-License-Identifier:    LGPL-3.0-or-later
+
+#include <catch.hpp>
+#include <cmath>
+#include <complex>
+#include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/MPI.h>
+#include <dolfinx/la/Vector.h>
+#include <dolfinx/la/VectorPool.h>
+#include <memory>
+#include <set>
+#include <vector>
+
+using namespace dolfinx;
+
+namespace
+{
+template <typename T>
+void test_vector_blas()
+{
+  using U = typename Eigen::NumTraits<T>::Real;
+  const int mpi_size = dolfinx::MPI::size(MPI_COMM_WORLD);
+  const int mpi_rank = dolfinx::MPI::rank(MPI_COMM_WORLD);
+  const int size_local = 10;
+  const int bs = 2;
+
+  // Create some ghost entries on next process
+  const int num_ghosts = (mpi_size - 1) * 3;
+  Eigen::Array<std::int64_t, Eigen::Dynamic, 1> ghosts(num_ghosts);
+  for (int i = 0; i < num_ghosts; ++i)
+    ghosts[i] = (mpi_rank + 1) % mpi_size * size_local + i;
+  std::vector<int> owners(ghosts.size(), (mpi_rank + 1) % mpi_size);
+  auto map = std::make_shared<common::IndexMap>(
+      MPI_COMM_WORLD, size_local,
+      dolfinx::MPI::compute_graph_edges(
+          MPI_COMM_WORLD, std::set<int>(owners.begin(), owners.end())),
+      ghosts, owners, bs);
+
+  // Set x = 1 and y = global index of the owned entries, and a ghost
+  // value that must not contribute
+  la::Vector<T> x(map), y(map);
+  const int n = bs * size_local;
+  const std::int64_t offset = bs * map->local_range()[0];
+  x.array().setConstant(1);
+  for (int i = 0; i < n; ++i)
+    y.array()[i] = offset + i;
+  y.array().tail(bs * num_ghosts).setConstant(-1000);
+
+  // Sums over the global indices 0, ..., N - 1
+  const double N = bs * size_local * mpi_size;
+  const double sum = N * (N - 1) / 2;
+  const double sum_sq = (N - 1) * N * (2 * N - 1) / 6;
+
+  CHECK(std::abs(la::inner_product(x, y) - T(sum)) < 1.0e-4 * sum);
+  CHECK(la::norm(y, la::Norm::l1) == Approx(sum));
+  CHECK(la::norm(y, la::Norm::l2) == Approx(std::sqrt(sum_sq)));
+  CHECK(la::norm(y, la::Norm::linf) == Approx(N - 1));
+
+  // Fused reductions
+  const std::vector<T> dots = la::inner_products<T>({{&x, &x}, {&x, &y}});
+  CHECK(std::abs(dots[0] - T(N)) < 1.0e-4 * N);
+  CHECK(std::abs(dots[1] - T(sum)) < 1.0e-4 * sum);
+  const std::vector<U> norms = la::norms<T>({&x, &y}, la::Norm::l2);
+  CHECK(norms[0] == Approx(std::sqrt(N)));
+  CHECK(norms[1] == Approx(std::sqrt(sum_sq)));
+
+  // Non-blocking reductions
+  la::Reduction<T> dots_pending
+      = la::inner_products_begin<T>({{&x, &x}, {&x, &y}});
+  la::Reduction<U> norms_pending = la::norms_begin<T>({&x, &y}, la::Norm::l2);
+  la::Reduction<U> max_pending = la::norms_begin<T>({&y}, la::Norm::linf);
+  CHECK(norms_pending.wait()[1] == Approx(std::sqrt(sum_sq)));
+  CHECK(norms_pending.wait()[0] == Approx(std::sqrt(N)));
+  CHECK(std::abs(dots_pending.wait()[1] - T(sum)) < 1.0e-4 * sum);
+  CHECK(max_pending.wait()[0] == Approx(N - 1));
+  CHECK(max_pending.test());
+
+  // y <- 2 (y - x)
+  la::axpy(y, T(-1), x);
+  la::scale(y, T(2));
+  CHECK(la::norm(y, la::Norm::l1) == Approx(2 * (sum - N + 2)));
+  CHECK(y.array()[0] == T(2 * (offset - 1)));
+}
+
+template <typename T>
+void test_vector_view()
+{
+  auto map = std::make_shared<common::IndexMap>(MPI_COMM_WORLD, 12, 1);
+  auto x = std::make_shared<la::Vector<T>>(map);
+  for (int i = 0; i < 12; ++i)
+    x->array()[i] = i;
+
+  // Equally spaced entries
+  la::VectorView<T> v0(
+      x, std::make_shared<const std::vector<std::int32_t>>(
+             std::vector<std::int32_t>{1, 4, 7, 10}));
+  CHECK(v0.stride() == 3);
+  CHECK(v0.strided()[2] == T(7));
+  CHECK(v0.array()[3] == T(10));
+
+  // Arbitrary entries
+  la::VectorView<T> v1(
+      x, std::make_shared<const std::vector<std::int32_t>>(
+             std::vector<std::int32_t>{5, 0, 2}));
+  CHECK(v1.stride() == 0);
+  CHECK_THROWS(v1.strided());
+  CHECK(v1.array()[0] == T(5));
+
+  // Set entries through the view
+  const std::int64_t version = x->version();
+  v1.set(Eigen::Matrix<T, Eigen::Dynamic, 1>::Constant(3, -1));
+  CHECK(x->array()[2] == T(-1));
+  CHECK(v1[1] == T(-1));
+  CHECK(x->version() > version);
+}
+
+void test_vector_pool()
+{
+  auto map0 = std::make_shared<common::IndexMap>(MPI_COMM_WORLD, 10, 1);
+  auto map1 = std::make_shared<common::IndexMap>(MPI_COMM_WORLD, 10, 1);
+  la::VectorPool<la::Vector<double>> pool(1);
+
+  // Released vectors are recycled for the same index map only
+  std::shared_ptr<la::Vector<double>> x0 = pool.get(map0);
+  const la::Vector<double>* ptr = x0.get();
+  x0.reset();
+  CHECK(pool.size() == 1);
+  CHECK(pool.get(map1).get() != ptr);
+  std::shared_ptr<la::Vector<double>> x1 = pool.get(map0);
+  CHECK(x1.get() == ptr);
+  CHECK(x1->map() == map0);
+  CHECK(pool.size() == 1);
+
+  // At most max_size free vectors are kept per map
+  std::shared_ptr<la::Vector<double>> x2 = pool.get(map0);
+  x1.reset();
+  x2.reset();
+  CHECK(pool.size() == 2);
+  pool.clear();
+  CHECK(pool.size() == 0);
+
+  // Vectors may outlive the pool
+  std::shared_ptr<la::Vector<double>> x3;
+  {
+    la::VectorPool<la::Vector<double>> tmp;
+    x3 = tmp.get(map0);
+  }
+  CHECK(x3->array().size() == 10);
+}
+} // namespace
+
+TEST_CASE("Pool of la::Vector", "[vector_pool]")
+{
+  CHECK_NOTHROW(test_vector_pool());
+}
+
+TEST_CASE("Views of la::Vector", "[vector_view]")
+{
+  CHECK_NOTHROW(test_vector_view<double>());
+  CHECK_NOTHROW(test_vector_view<std::complex<double>>());
+}
+
+TEST_CASE("BLAS-1 operations on la::Vector", "[vector_blas]")
+{
+  CHECK_NOTHROW(test_vector_blas<float>());
+  CHECK_NOTHROW(test_vector_blas<double>());
+  CHECK_NOTHROW(test_vector_blas<std::complex<double>>());
+}
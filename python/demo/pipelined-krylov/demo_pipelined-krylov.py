@@ -0,0 +1,130 @@
+#
+# .. _demo_pipelined_krylov:
+#
+# Pipelined Krylov methods
+# ========================
+#
+# This demo is implemented in a single Python file,
+# :download:`demo_pipelined-krylov.py`. It compares the solve times of
+# standard and pipelined (communication hiding) Krylov methods for the
+# Poisson equation, and can be used as a benchmark of the
+# reduction-latency trade-off.
+#
+# This demo illustrates how to:
+#
+# * Select a pipelined Krylov method for a PETSc KSP
+# * Time the setup and the iterations of a linear solver
+#
+# Each iteration of CG or GMRES needs one or more global reductions
+# (inner products and norms), which synchronise all processes. On many
+# processes with few unknowns per process, the latency of these
+# reductions dominates. Pipelined methods start the reductions without
+# blocking (``MPI_Iallreduce``) and overlap them with the matrix-vector
+# product and the preconditioner, at the cost of extra vector
+# operations and a weaker numerical stability. The overlap requires an
+# MPI implementation with asynchronous progress of non-blocking
+# collectives, e.g. with ``MPICH_ASYNC_PROGRESS=1``.
+#
+# Run the benchmark on the number of processes and with the number of
+# unknowns per process of the problem class of interest, e.g. ::
+#
+#     mpirun -np 1024 python3 demo_pipelined-krylov.py --n 256 --repeat 5
+#
+# Implementation
+# --------------
+#
+# The modules are imported, and the problem size is read from the
+# command line: ::
+
+import argparse
+
+import numpy as np
+from mpi4py import MPI
+from petsc4py import PETSc
+
+import ufl
+from dolfinx import DirichletBC, Function, FunctionSpace, UnitSquareMesh
+from dolfinx.cpp.la import PipelinedMethod, set_pipelined
+from dolfinx.fem import (apply_lifting, assemble_matrix, assemble_vector,
+                         locate_dofs_topological, set_bc)
+from dolfinx.mesh import locate_entities_boundary
+from ufl import dx, grad, inner
+
+parser = argparse.ArgumentParser(description="Compare standard and pipelined Krylov methods")
+parser.add_argument("--n", type=int, default=64, help="Number of cells in each direction")
+parser.add_argument("--repeat", type=int, default=3, help="Number of solves of each method")
+parser.add_argument("--pc", type=str, default="jacobi", help="PETSc preconditioner type")
+args = parser.parse_args()
+
+# The Poisson problem is assembled on a unit square, with a zero
+# Dirichlet condition on the whole boundary: ::
+
+mesh = UnitSquareMesh(MPI.COMM_WORLD, args.n, args.n)
+V = FunctionSpace(mesh, ("Lagrange", 1))
+u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+x = ufl.SpatialCoordinate(mesh)
+f = 10 * ufl.exp(-((x[0] - 0.5)**2 + (x[1] - 0.5)**2) / 0.02)
+a = inner(grad(u), grad(v)) * dx
+L = inner(f, v) * dx
+
+u0 = Function(V)
+facets = locate_entities_boundary(mesh, 1, lambda x: np.full(x.shape[1], True))
+bc = DirichletBC(u0, locate_dofs_topological(V, 1, facets))
+
+A = assemble_matrix(a, [bc])
+A.assemble()
+b = assemble_vector(L)
+apply_lifting(b, [a], [[bc]])
+b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+set_bc(b, [bc])
+
+# Each method is used to solve the system several times. The setup of
+# the preconditioner is timed separately from the iterations, and the
+# slowest process determines the time. A pipelined method is selected
+# with :py:func:`set_pipelined <dolfinx.cpp.la.set_pipelined>`, and a
+# standard method by its PETSc type: ::
+
+methods = [("cg", None), ("pipecg", PipelinedMethod.cg), ("groppcg", PipelinedMethod.gropp),
+           ("gmres", None), ("pgmres", PipelinedMethod.gmres), ("pipefgmres", PipelinedMethod.fgmres)]
+
+comm = mesh.mpi_comm()
+uh = Function(V)
+results = []
+for name, pipelined in methods:
+    solver = PETSc.KSP().create(comm)
+    solver.setOperators(A)
+    if pipelined is None:
+        solver.setType(name)
+    else:
+        set_pipelined(solver, pipelined)
+    solver.getPC().setType(args.pc)
+    solver.setTolerances(rtol=1.0e-8, max_it=10000)
+    solver.setNormType(PETSc.KSP.NormType.UNPRECONDITIONED)
+
+    t_setup = MPI.Wtime()
+    solver.setUp()
+    t_setup = comm.allreduce(MPI.Wtime() - t_setup, op=MPI.MAX)
+
+    times = []
+    for i in range(args.repeat):
+        with uh.vector.localForm() as u_local:
+            u_local.set(0.0)
+        comm.Barrier()
+        t = MPI.Wtime()
+        solver.solve(b, uh.vector)
+        times.append(comm.allreduce(MPI.Wtime() - t, op=MPI.MAX))
+    num_its = solver.getIterationNumber()
+    assert solver.getConvergedReason() > 0
+    results.append((name, num_its, t_setup, min(times), min(times) / max(num_its, 1)))
+    solver.destroy()
+
+# The results are printed on rank 0, with the time per iteration, which
+# shows the benefit of hiding the latency of the reductions when it
+# outweighs the extra vector operations: ::
+
+if comm.rank == 0:
+    print("Processes: {}, unknowns: {}".format(comm.size, V.dofmap.index_map.size_global))
+    print("{:>12} {:>10} {:>12} {:>12} {:>16}".format("method", "iterations", "setup (s)", "solve (s)",
+                                                   "iteration (s)"))
+    for name, num_its, t_setup, t_solve, t_it in results:
+        print("{:>12} {:>10d} {:>12.3e} {:>12.3e} {:>16.3e}".format(name, num_its, t_setup, t_solve, t_it))
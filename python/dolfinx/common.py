@@ -4,11 +4,15 @@
 #
 # SPDX-License-Identifier:    LGPL-3.0-or-later
 
+import atexit
 import functools
 
+from mpi4py import MPI
+
 from dolfinx import cpp
-from dolfinx.cpp.common import (git_commit_hash, has_debug, has_kahip,  # noqa
-                                has_parmetis, has_petsc_complex)
+from dolfinx.cpp.common import (git_commit_hash, has_adios2, has_debug,  # noqa
+                                has_kahip, has_parmetis, has_petsc_complex,
+                                has_zlib)
 
 TimingType = cpp.common.TimingType
 
@@ -25,6 +29,86 @@ def list_timings(mpi_comm, timing_types: list):
     return cpp.common.list_timings(mpi_comm, timing_types)
 
 
+def set_timing_enabled(enabled: bool):
+    """Enable or disable the registration of timings by named timers"""
+    cpp.common.set_timing_enabled(enabled)
+
+
+def set_cpu_timing(enabled: bool):
+    """Enable or disable the measurement of user and system times by timers"""
+    cpp.common.set_cpu_timing(enabled)
+
+
+def set_hardware_counters(enabled: bool) -> bool:
+    """Enable or disable the sampling of hardware performance counters
+    (cycles, instructions, cache references and misses, branch misses)
+    by named timers, which are tabulated per task by ``list_timings``.
+    Returns True if the counters can be read on this system (Linux
+    perf_event)."""
+    return cpp.common.set_hardware_counters(enabled)
+
+
+def set_memory_tracking(enabled: bool):
+    """Enable or disable the sampling of the memory usage of the process
+    by named timers. ``list_timings`` then reports the peak memory of
+    the process at the end of each task, the increase of the peak in the
+    task and the memory retained by the task."""
+    cpp.common.set_memory_tracking(enabled)
+
+
+def set_trace(enabled: bool, filename: str = None):
+    """Enable or disable the recording of the begin and end of each
+    timing, with timestamps per process and thread. If a filename is
+    given, the trace of all processes is written to it at exit (see
+    ``write_trace``), which must be reached by all processes."""
+    cpp.common.set_trace(enabled)
+    if enabled and filename is not None:
+        atexit.register(write_trace, MPI.COMM_WORLD, filename)
+
+
+def write_trace(mpi_comm, filename: str):
+    """Write the recorded timings of all processes in the Chrome trace
+    event format (JSON), e.g. to view the load imbalance over the ranks
+    in chrome://tracing or Perfetto (collective)"""
+    cpp.common.write_trace(mpi_comm, filename)
+
+
+def set_comm_profiling(enabled: bool):
+    """Enable or disable the recording of the neighbours, bytes and
+    time of the communication of instrumented call sites, e.g. the
+    ghost updates of vectors and index maps"""
+    cpp.common.set_comm_profiling(enabled)
+
+
+def comm_profile() -> dict:
+    """Return the (calls, neighbours, bytes sent, bytes received, time)
+    of the communication of each call site on this process"""
+    return cpp.common.comm_profile()
+
+
+def clear_comm_profile():
+    """Remove the records of communication"""
+    cpp.common.clear_comm_profile()
+
+
+def list_comm_profile(mpi_comm):
+    """Print the communication of each call site, averaged and maximised
+    over the processes (collective)"""
+    cpp.common.list_comm_profile(mpi_comm)
+
+
+def init_threads(num_threads: int = 0):
+    """Set up the thread pool of the library with a number of threads per
+    process. If num_threads is less than one, the number is chosen from
+    the processors available to each process (collective)"""
+    cpp.common.init_threads(num_threads)
+
+
+def num_threads() -> int:
+    """Return the number of threads of the thread pool of the library"""
+    return cpp.common.num_threads()
+
+
 class Timer:
     """A timer can be used for timing tasks. The basic usage is::
 
@@ -8,14 +8,18 @@
 
 from dolfinx.fem.assemble import (create_vector, create_vector_block, create_vector_nest,
                                   create_matrix, create_matrix_block, create_matrix_nest,
-                                  assemble_scalar,
-                                  assemble_vector, assemble_vector_nest, assemble_vector_block,
+                                  pack_coefficients, assemble_scalar, assemble_scalar_reproducible,
+                                  assemble_scalars,
+                                  assemble_vector, assemble_vectors, assemble_vector_nest, assemble_vector_block,
                                   assemble_matrix, assemble_matrix_nest, assemble_matrix_block,
+                                  create_matrix_position_map, create_matrix_free_operator,
+                                  assemble_system,
                                   set_bc, set_bc_nest,
                                   apply_lifting, apply_lifting_nest)
 from dolfinx.fem.coordinatemapping import create_coordinate_map
 from dolfinx.fem.dirichletbc import DirichletBC
 from dolfinx.fem.dofmap import DofMap
+from dolfinx.fem.expression import Expression
 from dolfinx.fem.form import Form
 from dolfinx.cpp.fem import IntegralType
 from dolfinx.fem.formmanipulations import (derivative, adjoint, increase_order,
@@ -26,11 +30,14 @@ from dolfinx.fem.dirichletbc import locate_dofs_geometrical, locate_dofs_topolog
 __all__ = [
     "create_vector", "create_vector_block", "create_vector_nest",
     "create_matrix", "create_matrix_block", "create_matrix_nest",
-    "apply_lifting", "apply_lifting_nest", "assemble_scalar", "assemble_vector",
+    "apply_lifting", "apply_lifting_nest", "pack_coefficients", "assemble_scalar",
+    "assemble_scalar_reproducible", "assemble_scalars",
+    "assemble_vector", "assemble_vectors",
     "assemble_vector_block", "assemble_vector_nest",
     "assemble_matrix_block", "assemble_matrix_nest",
-    "assemble_matrix", "set_bc", "set_bc_nest", "create_coordinate_map",
-    "DirichletBC", "DofMap", "Form", "IntegralType",
+    "assemble_matrix", "create_matrix_position_map", "create_matrix_free_operator", "assemble_system",
+    "set_bc", "set_bc_nest", "create_coordinate_map",
+    "DirichletBC", "DofMap", "Expression", "Form", "IntegralType",
     "derivative", "adjoint", "increase_order",
     "tear", "project", "solve", "locate_dofs_geometrical", "locate_dofs_topological"
 ]
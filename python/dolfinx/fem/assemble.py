@@ -9,6 +9,7 @@ import contextlib
 import functools
 import typing
 
+import numpy
 from petsc4py import PETSc
 
 import ufl
@@ -50,8 +51,22 @@ def create_vector_nest(L: typing.List[typing.Union[Form, cpp.fem.Form]]) -> PETS
 # -- Matrix instantiation ----------------------------------------------------
 
 
-def create_matrix(a: typing.Union[Form, cpp.fem.Form]) -> PETSc.Mat:
-    return cpp.fem.create_matrix(_create_cpp_form(a))
+def create_matrix(a: typing.Union[Form, cpp.fem.Form], mat_type: str = "",
+                  cache: cpp.fem.MatrixCache = None) -> PETSc.Mat:
+    """Create a matrix for a bilinear form. For vector-valued spaces the
+    matrix has the block size of the dofmaps, so a block sparse matrix
+    can be created with mat_type="baij", or with mat_type="sbaij" for a
+    symmetric form to store only the upper triangle. With mat_type="is" an
+    unassembled (MATIS) matrix is created, into which each process
+    assembles its local matrix without communication, e.g. for BDDC. If
+    mat_type is empty the default PETSc matrix type is used. If a cache is given, forms with
+    the same dofmaps and integral types share the sparsity pattern, and
+    the matrix duplicates the non-zero structure of the cached matrix.
+
+    """
+    if cache is not None:
+        return cache.create_matrix(_create_cpp_form(a), mat_type)
+    return cpp.fem.create_matrix(_create_cpp_form(a), mat_type)
 
 
 def create_matrix_block(a: typing.List[typing.List[typing.Union[Form, cpp.fem.Form]]]) -> PETSc.Mat:
@@ -62,43 +77,98 @@ def create_matrix_nest(a: typing.List[typing.List[typing.Union[Form, cpp.fem.For
     return cpp.fem.create_matrix_nest(_create_cpp_form(a))
 
 
+def pack_coefficients(form: typing.Union[Form, cpp.fem.Form]) -> numpy.ndarray:
+    """Pack the coefficients of a form for all cells, e.g. to pass them to
+    several assemble calls. The packed data is cached on the form and only
+    coefficients that have been modified since the previous call are
+    repacked.
+
+    """
+    return cpp.fem.pack_coefficients(_create_cpp_form(form))
+
+
 # -- Scalar assembly ---------------------------------------------------------
 
 
-def assemble_scalar(M: typing.Union[Form, cpp.fem.Form]) -> PETSc.ScalarType:
+def assemble_scalar(M: typing.Union[Form, cpp.fem.Form], coeffs=None) -> PETSc.ScalarType:
     """Assemble functional. The returned value is local and not accumulated
-    across processes.
+    across processes. Packed coefficients (see pack_coefficients) can be
+    supplied to avoid packing the coefficients of M.
 
     """
-    return cpp.fem.assemble_scalar(_create_cpp_form(M))
+    if coeffs is None:
+        return cpp.fem.assemble_scalar(_create_cpp_form(M))
+    else:
+        return cpp.fem.assemble_scalar(_create_cpp_form(M), coeffs)
+
+
+def assemble_scalar_reproducible(M: typing.Union[Form, cpp.fem.Form]) -> PETSc.ScalarType:
+    """Assemble functional and sum the value across processes. The
+    contributions of the cells and facets are summed exactly and the
+    exact sum is rounded once, such that the value is the same to the
+    last bit for any number of threads and processes.
+
+    """
+    return cpp.fem.assemble_scalar_reproducible(_create_cpp_form(M))
+
+
+def assemble_scalars(M: typing.List[typing.Union[Form, cpp.fem.Form]]) -> typing.List[PETSc.ScalarType]:
+    """Assemble functionals. The returned values are accumulated across
+    processes with a single collective reduction. Integrals of the
+    functionals over the same domain are evaluated in a single loop over
+    the domain.
+
+    """
+    return cpp.fem.assemble_scalars(_create_cpp_form(M))
 
 # -- Vector assembly ---------------------------------------------------------
 
 
 @functools.singledispatch
-def assemble_vector(L: typing.Union[Form, cpp.fem.Form]) -> PETSc.Vec:
+def assemble_vector(L: typing.Union[Form, cpp.fem.Form], coeffs=None) -> PETSc.Vec:
     """Assemble linear form into a new PETSc vector. The returned vector is
     not finalised, i.e. ghost values are not accumulated on the owning
-    processes.
+    processes. Packed coefficients (see pack_coefficients) can be
+    supplied to avoid packing the coefficients of L.
 
     """
     _L = _create_cpp_form(L)
     b = cpp.la.create_vector(_L.function_spaces[0].dofmap.index_map)
     with b.localForm() as b_local:
         b_local.set(0.0)
-        cpp.fem.assemble_vector(b_local.array_w, _L)
-    return b
+    return assemble_vector(b, _L, coeffs)
 
 
 @assemble_vector.register(PETSc.Vec)
-def _(b: PETSc.Vec, L: typing.Union[Form, cpp.fem.Form]) -> PETSc.Vec:
+def _(b: PETSc.Vec, L: typing.Union[Form, cpp.fem.Form], coeffs=None) -> PETSc.Vec:
     """Assemble linear form into an existing PETSc vector. The vector is not
     zeroed before assembly and it is not finalised, qi.e. ghost values are
     not accumulated on the owning processes.
 
     """
     with b.localForm() as b_local:
-        cpp.fem.assemble_vector(b_local.array_w, _create_cpp_form(L))
+        if coeffs is None:
+            cpp.fem.assemble_vector(b_local.array_w, _create_cpp_form(L))
+        else:
+            cpp.fem.assemble_vector(b_local.array_w, _create_cpp_form(L), coeffs)
+    return b
+
+
+def assemble_vectors(L: typing.List[typing.Union[Form, cpp.fem.Form]],
+                     b: typing.List[numpy.ndarray] = None) -> typing.List[numpy.ndarray]:
+    """Assemble linear forms into arrays, one for each form, in a single
+    call. The arrays hold the owned and ghost entries, and the ghost
+    values are not accumulated on the owning processes. If b is
+    supplied, the forms are assembled into these arrays, which must be
+    contiguous arrays of the scalar type of the size of the local form
+    vector and are not zeroed before assembly; otherwise new arrays are
+    returned.
+
+    """
+    _L = _create_cpp_form(L)
+    if b is None:
+        return cpp.fem.assemble_vectors(_L)
+    cpp.fem.assemble_vectors(b, _L)
     return b
 
 
@@ -194,32 +264,70 @@ def _(b: PETSc.Vec,
 @functools.singledispatch
 def assemble_matrix(a: typing.Union[Form, cpp.fem.Form],
                     bcs: typing.List[DirichletBC] = [],
-                    diagonal: float = 1.0) -> PETSc.Mat:
+                    diagonal: float = 1.0, coeffs=None) -> PETSc.Mat:
     """Assemble bilinear form into a matrix. The returned matrix is not
     finalised, i.e. ghost values are not accumulated.
 
     """
     A = cpp.fem.create_matrix(_create_cpp_form(a))
     A.zeroEntries()
-    return assemble_matrix(A, a, bcs, diagonal)
+    return assemble_matrix(A, a, bcs, diagonal, coeffs=coeffs)
 
 
 @assemble_matrix.register(PETSc.Mat)
 def _(A: PETSc.Mat,
       a: typing.Union[Form, cpp.fem.Form],
       bcs: typing.List[DirichletBC] = [],
-      diagonal: float = 1.0) -> PETSc.Mat:
+      diagonal: float = 1.0,
+      position_map: typing.Optional[cpp.fem.MatrixPositionMap] = None,
+      coeffs=None) -> PETSc.Mat:
     """Assemble bilinear form into a matrix. The returned matrix is not
-    finalised, i.e. ghost values are not accumulated.
+    finalised, i.e. ghost values are not accumulated. If a position map
+    (see create_matrix_position_map) is supplied, cell contributions are
+    added directly to the matrix values. Packed coefficients (see
+    pack_coefficients) can be supplied to avoid packing the coefficients
+    of a; they cannot be combined with a position map.
 
     """
     _a = _create_cpp_form(a)
-    cpp.fem.assemble_matrix_petsc(A, _a, bcs)
+    if position_map is not None:
+        if coeffs is not None:
+            raise RuntimeError("Packed coefficients cannot be combined with a position map.")
+        cpp.fem.assemble_matrix_petsc(A, _a, bcs, position_map)
+    elif coeffs is not None:
+        cpp.fem.assemble_matrix_petsc(A, _a, bcs, coeffs)
+    else:
+        cpp.fem.assemble_matrix_petsc(A, _a, bcs)
     if _a.function_spaces[0].id == _a.function_spaces[1].id:
         cpp.fem.add_diagonal(A, _a.function_spaces[0], bcs, diagonal)
     return A
 
 
+def create_matrix_position_map(A: PETSc.Mat, a: typing.Union[Form, cpp.fem.Form]) -> cpp.fem.MatrixPositionMap:
+    """Compute the positions of the cell element matrix entries of a
+    bilinear form in an AIJ matrix, for fast reassembly with the same
+    non-zero structure. If A has not been assembled, its non-zero
+    structure is fixed by assembling zeros.
+
+    """
+    return cpp.fem.create_matrix_position_map(A, _create_cpp_form(a))
+
+
+def create_matrix_free_operator(a: typing.Union[Form, cpp.fem.Form, cpp.fem.SumFactorisedOperator],
+                                bcs: typing.List[DirichletBC] = [],
+                                diagonal: float = 1.0) -> PETSc.Mat:
+    """Create a matrix-free (MATSHELL) operator for a bilinear form or a
+    sum-factorised operator. The matrix is not stored; matrix-vector
+    products are computed cell by cell. If the test and trial spaces
+    are the same, diagonal is set on boundary condition rows and the
+    operator supports getDiagonal, e.g. for Jacobi smoothing.
+
+    """
+    if isinstance(a, cpp.fem.SumFactorisedOperator):
+        return cpp.fem.create_matrix_free_operator(a, bcs, diagonal)
+    return cpp.fem.create_matrix_free_operator(_create_cpp_form(a), bcs, diagonal)
+
+
 # FIXME: Revise this interface
 @functools.singledispatch
 def assemble_matrix_nest(a: typing.List[typing.List[typing.Union[Form, cpp.fem.Form]]],
@@ -307,6 +415,43 @@ def _(A: PETSc.Mat,
     return A
 
 
+# -- System assembly ----------------------------------------------------------
+
+def assemble_system(a: typing.Union[Form, cpp.fem.Form],
+                    L: typing.Union[Form, cpp.fem.Form],
+                    bcs: typing.List[DirichletBC] = [],
+                    x0: typing.Optional[PETSc.Vec] = None,
+                    scale: float = 1.0,
+                    symmetric: bool = True,
+                    diagonal: float = 1.0) -> typing.Tuple[PETSc.Mat, PETSc.Vec]:
+    """Assemble a bilinear form into a matrix and a linear form into a
+    vector in a single pass over the cells. This is equivalent to
+    assemble_matrix, assemble_vector, apply_lifting and set_bc, i.e.
+
+        b <- L - scale * A (g - x0)
+
+    with b = scale * (g - x0) on boundary condition dofs. If symmetric
+    is true, the rows and columns of boundary condition dofs are zeroed
+    and the boundary conditions are lifted, otherwise only the rows are
+    zeroed and no lifting is applied. The diagonal of boundary
+    condition rows is set to diagonal. The returned matrix is not
+    finalised; the ghost contributions of the vector are accumulated.
+
+    """
+    _a, _L = _create_cpp_form(a), _create_cpp_form(L)
+    A = cpp.fem.create_matrix(_a)
+    A.zeroEntries()
+    b = cpp.la.create_vector(_L.function_spaces[0].dofmap.index_map)
+    with b.localForm() as b_local:
+        b_local.set(0.0)
+    cpp.fem.assemble_system_petsc(A, b, _a, _L, bcs, x0, scale, symmetric)
+    if _a.function_spaces[0].id == _a.function_spaces[1].id:
+        cpp.fem.add_diagonal(A, _a.function_spaces[0], bcs, diagonal)
+    b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    set_bc(b, bcs, x0, scale)
+    return A, b
+
+
 # -- Modifiers for Dirichlet conditions ---------------------------------------
 
 def apply_lifting(b: PETSc.Vec,
@@ -18,7 +18,7 @@ from dolfinx import cpp, function
 
 
 def locate_dofs_geometrical(V: typing.Iterable[typing.Union[cpp.function.FunctionSpace, function.FunctionSpace]],
-                            marker: types.FunctionType):
+                            marker: types.FunctionType, boundary_only: bool = False):
     """Locate degrees-of-freedom geometrically using a marker function.
 
     Parameters
@@ -32,6 +32,13 @@ def locate_dofs_geometrical(V: typing.Iterable[typing.Union[cpp.function.Functio
         ``num_points``, evaluating to ``True`` for entities whose
         degree-of-freedom should be returned.
 
+    boundary_only
+        If True, only degrees-of-freedom in the closure of the exterior
+        facets of the mesh are candidates, and the marker is evaluated
+        at their coordinates only. This is cheaper than evaluating the
+        marker at all degree-of-freedom coordinates when the marker
+        describes (part of) the boundary.
+
     Returns
     -------
     numpy.ndarray
@@ -60,7 +67,7 @@ def locate_dofs_geometrical(V: typing.Iterable[typing.Union[cpp.function.Functio
         except AttributeError:
             _V = [V]
 
-    return cpp.fem.locate_dofs_geometrical(_V, marker)
+    return cpp.fem.locate_dofs_geometrical(_V, marker, boundary_only)
 
 
 def locate_dofs_topological(V: typing.Iterable[typing.Union[cpp.function.FunctionSpace, function.FunctionSpace]],
@@ -32,3 +32,11 @@ class DofMap:
     @property
     def list(self):
         return self._cpp_object.list()
+
+    @property
+    def list_blocked(self):
+        return self._cpp_object.list_blocked()
+
+    @property
+    def bs(self):
+        return self._cpp_object.bs
@@ -0,0 +1,72 @@
+# Copyright (C) 2020 Garth N. Wells
+#
+# This file is part of DOLFINX (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+
+import cffi
+import numpy as np
+import ufl
+from dolfinx import cpp, jit
+from ufl.algorithms import extract_coefficients
+from ufl.algorithms.analysis import extract_constants
+from ufl.domain import extract_unique_domain
+
+
+class Expression:
+    def __init__(self, expression: ufl.core.expr.Expr, x: np.ndarray,
+                 form_compiler_parameters: dict = {}, jit_parameters: dict = {}):
+        """Create a dolfinx Expression, evaluated at fixed points on the
+        reference cell
+
+        Parameters
+        ----------
+        expression
+            Pure UFL expression
+        x
+            The points on the reference cell, with shape (num_points, tdim)
+        form_compiler_parameters
+            Parameters used in FFCX compilation of this expression
+        jit_parameters
+            Parameters controlling JIT compilation of C code
+
+        """
+        mesh = extract_unique_domain(expression).ufl_cargo()
+        x = np.asarray(x, dtype=np.float64)
+
+        # Compile UFL expression with JIT
+        ufc_expression = jit.ffcx_jit(
+            (expression, x),
+            form_compiler_parameters=form_compiler_parameters,
+            jit_parameters=jit_parameters,
+            mpi_comm=mesh.mpi_comm())
+
+        coefficients = [c._cpp_object for c in extract_coefficients(expression)]
+        constants = [c._cpp_object for c in extract_constants(expression)]
+
+        ffi = cffi.FFI()
+        self._cpp_object = cpp.fem.create_expression(ffi.cast("uintptr_t", ufc_expression),
+                                                     coefficients, constants, mesh)
+        self._ufl_expression = expression
+
+    def eval(self, cells: np.ndarray) -> np.ndarray:
+        """Evaluate the expression at the reference points of cells
+
+        Returns
+        -------
+        numpy.ndarray
+            The values with shape (num_cells, num_points, value_size)
+
+        """
+        values = self._cpp_object.eval(np.asarray(cells, dtype=np.int32))
+        return values.reshape(len(cells), self._cpp_object.num_points, self._cpp_object.value_size)
+
+    @property
+    def x(self) -> np.ndarray:
+        """The points on the reference cell"""
+        return self._cpp_object.x
+
+    @property
+    def ufl_expression(self):
+        """The UFL expression"""
+        return self._ufl_expression
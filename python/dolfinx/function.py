@@ -99,18 +99,31 @@ class Function(ufl.Coefficient):
         """Evaluate Function at points x, where x has shape (num_points, 3),
         and cells has shape (num_points,) and cell[i] is the index of the
         cell containing point x[i]. If the cell index is negative the
-        point is ignored."""
-
-        # Make sure input coordinates are a NumPy array
-        x = np.asarray(x, dtype=np.float)
+        point is ignored. cells can also be an AdjacencyList with the
+        cells of each point (see
+        ``geometry.compute_colliding_cells_points``), in which case the
+        first cell of each point is used. The points are evaluated
+        grouped by cell in a single call, without copies of contiguous
+        arrays."""
+
+        # Make sure input coordinates are a NumPy array (no copy for
+        # contiguous float64 arrays)
+        x = np.ascontiguousarray(x, dtype=np.float64)
         assert x.ndim < 3
         num_points = x.shape[0] if x.ndim == 2 else 1
         x = np.reshape(x, (num_points, -1))
         if x.shape[1] != 3:
             raise ValueError("Coordinate(s) for Function evaluation must have length 3.")
 
-        # Make sure cells are a NumPy array
-        cells = np.asarray(cells)
+        # Make sure cells are a NumPy array, with the first cell of each
+        # point of an AdjacencyList
+        if isinstance(cells, cpp.graph.AdjacencyList_int32):
+            offsets = cells.offsets
+            has_cell = offsets[1:] > offsets[:-1]
+            first = np.zeros(len(offsets) - 1, dtype=np.int32)
+            first[has_cell] = cells.array[offsets[:-1][has_cell]]
+            cells = np.where(has_cell, first, -1).astype(np.int32)
+        cells = np.ascontiguousarray(cells, dtype=np.int32)
         assert cells.ndim < 2
         num_points_c = cells.shape[0] if cells.ndim == 1 else 1
         cells = np.reshape(cells, num_points_c)
@@ -128,12 +141,18 @@ class Function(ufl.Coefficient):
             u = np.reshape(u, (-1, ))
         return u
 
-    def interpolate(self, u) -> None:
-        """Interpolate an expression"""
+    def interpolate(self, u, evaluator=None) -> None:
+        """Interpolate an expression or a Function. A Function on another
+        mesh is interpolated using the point evaluator (see
+        ``cpp.function.create_interpolation_evaluator``) if one is
+        passed, which allows the transfer to be repeated cheaply."""
         @singledispatch
         def _interpolate(u):
             try:
-                self._cpp_object.interpolate(u._cpp_object)
+                if evaluator is None:
+                    self._cpp_object.interpolate(u._cpp_object)
+                else:
+                    self._cpp_object.interpolate(u._cpp_object, evaluator)
             except AttributeError:
                 self._cpp_object.interpolate(u)
 
@@ -226,8 +245,18 @@ class FunctionSpace(ufl.FunctionSpace):
                  element: typing.Union[ufl.FiniteElementBase, ElementMetaData],
                  cppV: typing.Optional[cpp.function.FunctionSpace] = None,
                  form_compiler_parameters: dict = {},
-                 jit_parameters: dict = {}):
-        """Create a finite element function space."""
+                 jit_parameters: dict = {},
+                 dof_ordering: cpp.fem.DofOrdering = cpp.fem.DofOrdering.gps,
+                 cell_order: typing.Optional[np.ndarray] = None):
+        """Create a finite element function space.
+
+        The owned dofs are ordered with the strategy ``dof_ordering``.
+        For ``DofOrdering.cell``, the dofs are numbered in order of
+        first appearance over the cells in ``cell_order`` (default is
+        the local cell order). Passing the same ``cell_order``, e.g.
+        from ``cpp.mesh.compute_hilbert_order``, to several spaces on a
+        mesh gives consistent dof orderings.
+        """
 
         # Create function space from a UFL element and existing cpp
         # FunctionSpace
@@ -253,7 +282,9 @@ class FunctionSpace(ufl.FunctionSpace):
 
         ffi = cffi.FFI()
         cpp_element = cpp.fem.FiniteElement(ffi.cast("uintptr_t", ufc_element))
-        cpp_dofmap = cpp.fem.create_dofmap(mesh.mpi_comm(), ffi.cast("uintptr_t", ufc_dofmap_ptr), mesh.topology)
+        cpp_dofmap = cpp.fem.create_shared_dofmap(mesh.mpi_comm(), ffi.cast("uintptr_t", ufc_dofmap_ptr),
+                                                  mesh.topology, dof_ordering,
+                                                  [] if cell_order is None else cell_order)
 
         # Initialize the cpp.FunctionSpace
         self._cpp_object = cpp.function.FunctionSpace(mesh, cpp_element, cpp_dofmap)
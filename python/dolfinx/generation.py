@@ -18,9 +18,13 @@ __all__ = [
 ]
 
 
-def IntervalMesh(comm, nx: int, points: list, ghost_mode=cpp.mesh.GhostMode.shared_facet):
+def IntervalMesh(comm, nx: int, points: list, ghost_mode=cpp.mesh.GhostMode.shared_facet, grading: float = 1.0):
     """Create an interval mesh
 
+    On a communicator with a single process, e.g. ``MPI.COMM_SELF``,
+    the mesh is created without partitioning or collective
+    communication.
+
     Parameters
     ----------
     comm
@@ -30,11 +34,24 @@ def IntervalMesh(comm, nx: int, points: list, ghost_mode=cpp.mesh.GhostMode.shar
     point
         Coordinates of the end points
     ghost_mode
+    grading
+        Ratio of the lengths of consecutive cells. The cells are
+        uniform for 1.0, grow towards the second end point for values
+        larger than 1.0 and shrink for values smaller than 1.0.
 
     """
     domain = ufl.Mesh(ufl.VectorElement("Lagrange", "interval", 1))
     cmap = fem.create_coordinate_map(domain)
-    mesh = cpp.generation.IntervalMesh.create(comm, nx, points, cmap, ghost_mode)
+    if grading == 1.0:
+        mesh = cpp.generation.IntervalMesh.create(comm, nx, points, cmap, ghost_mode)
+    else:
+        if grading <= 0.0:
+            raise ValueError("Grading of interval mesh must be positive.")
+        if nx < 1:
+            raise ValueError("Number of cells of interval mesh must be at least 1.")
+        h = numpy.cumsum(numpy.concatenate(([0.0], grading ** numpy.arange(nx, dtype=numpy.float64))))
+        x = points[0] + (points[1] - points[0]) * h / h[-1]
+        mesh = cpp.generation.IntervalMesh.create(comm, x, cmap, ghost_mode)
     domain._ufl_cargo = mesh
     mesh._ufl_domain = domain
     return mesh
@@ -55,7 +72,7 @@ def UnitIntervalMesh(comm, nx, ghost_mode=cpp.mesh.GhostMode.shared_facet):
 
 
 def RectangleMesh(comm, points: typing.List[numpy.array], n: list, cell_type=cpp.mesh.CellType.triangle,
-                  ghost_mode=cpp.mesh.GhostMode.shared_facet, diagonal: str = "right"):
+                  ghost_mode=cpp.mesh.GhostMode.shared_facet, diagonal: str = "right", structured: bool = False):
     """Create rectangle mesh
 
     Parameters
@@ -68,18 +85,22 @@ def RectangleMesh(comm, points: typing.List[numpy.array], n: list, cell_type=cpp
         List of number of cells in each direction
     diagonal
         Direction of diagonal
+    structured
+        Partition the cells by index blocks of the grid, with each
+        process creating the cells of its block, instead of by the
+        graph partitioner
 
     """
     domain = ufl.Mesh(ufl.VectorElement("Lagrange", cpp.mesh.to_string(cell_type), 1))
     cmap = fem.create_coordinate_map(domain)
-    mesh = cpp.generation.RectangleMesh.create(comm, points, n, cmap, ghost_mode, diagonal)
+    mesh = cpp.generation.RectangleMesh.create(comm, points, n, cmap, ghost_mode, diagonal, structured)
     domain._ufl_cargo = mesh
     mesh._ufl_domain = domain
     return mesh
 
 
 def UnitSquareMesh(comm, nx, ny, cell_type=cpp.mesh.CellType.triangle,
-                   ghost_mode=cpp.mesh.GhostMode.shared_facet, diagonal="right"):
+                   ghost_mode=cpp.mesh.GhostMode.shared_facet, diagonal="right", structured=False):
     """Create a mesh of a unit square
 
     Parameters
@@ -92,16 +113,18 @@ def UnitSquareMesh(comm, nx, ny, cell_type=cpp.mesh.CellType.triangle,
         Number of cells in "y" direction
     diagonal
         Direction of diagonal
+    structured
+        Partition the cells by index blocks of the grid
 
     """
     return RectangleMesh(comm, [numpy.array([0.0, 0.0, 0.0]),
                                 numpy.array([1.0, 1.0, 0.0])], [nx, ny], cell_type, ghost_mode,
-                         diagonal)
+                         diagonal, structured)
 
 
 def BoxMesh(comm, points: typing.List[numpy.array], n: list,
             cell_type=cpp.mesh.CellType.tetrahedron,
-            ghost_mode=cpp.mesh.GhostMode.shared_facet):
+            ghost_mode=cpp.mesh.GhostMode.shared_facet, structured: bool = False):
     """Create box mesh
 
     Parameters
@@ -112,18 +135,22 @@ def BoxMesh(comm, points: typing.List[numpy.array], n: list,
         List of points representing vertices
     n
         List of cells in each direction
+    structured
+        Partition the cells by index blocks of the grid, with each
+        process creating the cells of its block, instead of by the
+        graph partitioner
 
     """
     domain = ufl.Mesh(ufl.VectorElement("Lagrange", cpp.mesh.to_string(cell_type), 1))
     cmap = fem.create_coordinate_map(domain)
-    mesh = cpp.generation.BoxMesh.create(comm, points, n, cmap, ghost_mode)
+    mesh = cpp.generation.BoxMesh.create(comm, points, n, cmap, ghost_mode, structured)
     domain._ufl_cargo = mesh
     mesh._ufl_domain = domain
     return mesh
 
 
 def UnitCubeMesh(comm, nx, ny, nz, cell_type=cpp.mesh.CellType.tetrahedron,
-                 ghost_mode=cpp.mesh.GhostMode.shared_facet):
+                 ghost_mode=cpp.mesh.GhostMode.shared_facet, structured=False):
     """Create a mesh of a unit cube
 
     Parameters
@@ -136,7 +163,9 @@ def UnitCubeMesh(comm, nx, ny, nz, cell_type=cpp.mesh.CellType.tetrahedron,
         Number of cells in "y" direction
     nz
         Number of cells in "z" direction
+    structured
+        Partition the cells by index blocks of the grid
 
     """
     return BoxMesh(comm, [numpy.array([0.0, 0.0, 0.0]), numpy.array(
-        [1.0, 1.0, 1.0])], [nx, ny, nz], cell_type, ghost_mode)
+        [1.0, 1.0, 1.0])], [nx, ny, nz], cell_type, ghost_mode, structured)
@@ -8,8 +8,20 @@ from dolfinx import cpp
 
 
 class BoundingBoxTree:
-    def __init__(self, obj, dim=None):
-        self._cpp_object = cpp.geometry.BoundingBoxTree(obj, dim)
+    def __init__(self, obj, dim=None, num_threads=1, method=cpp.geometry.BuildMethod.median,
+                 neighbour_processes=False, shared_memory=False):
+        """Create a bounding box tree of the entities of dimension dim of
+        a mesh, built on num_threads threads with the given method (see
+        cpp.geometry.BuildMethod). If neighbour_processes is True, only
+        the boxes of the neighbour processes are used to find the
+        processes that may collide with a point. If shared_memory is
+        True, the tree of the boxes of all processes is stored once per
+        shared memory node, and the tree must be destroyed collectively."""
+        if dim is None:
+            self._cpp_object = cpp.geometry.BoundingBoxTree(obj, num_threads)
+        else:
+            self._cpp_object = cpp.geometry.BoundingBoxTree(obj, dim, num_threads, method, neighbour_processes,
+                                                            shared_memory)
 
     @classmethod
     def create_midpoint_tree(cls, mesh):
@@ -18,25 +30,100 @@ class BoundingBoxTree:
         tree._cpp_object = cpp.geometry.create_midpoint_tree(mesh)
         return tree
 
+    def refit(self, mesh, rebuild_factor=0.0, num_threads=1):
+        """Recompute the bounding boxes after the geometry of the mesh
+        has moved, keeping the structure of the tree. If rebuild_factor
+        is positive, the tree is rebuilt when its cost exceeds the cost
+        when it was built by this factor. Returns True if the tree was
+        rebuilt."""
+        return self._cpp_object.refit(mesh, rebuild_factor, num_threads)
+
     def str(self):
         """Print for debugging"""
         return self._cpp_object.str()
 
 
+class CompactBoundingBoxTree:
+    """Compact (single precision, 4-ary) tree for fast point collision
+    queries, created from a BoundingBoxTree"""
+
+    def __init__(self, tree: BoundingBoxTree):
+        self._cpp_object = cpp.geometry.CompactBoundingBoxTree(tree._cpp_object)
+
+    @property
+    def bytes(self):
+        """Memory used by the nodes of the tree"""
+        return self._cpp_object.bytes
+
+
+class DistributedCollisions:
+    """Collision detection between the entities of two distributed
+    meshes. The communication pattern between the processes with
+    overlapping bounding boxes is cached between calls to compute."""
+
+    def __init__(self, comm):
+        self._cpp_object = cpp.geometry.DistributedCollisions(comm)
+
+    def compute(self, tree0: BoundingBoxTree, tree1: BoundingBoxTree):
+        """Compute the colliding entities (collective). Returns a list of
+        (entity0, rank, entity1), where entity0 is a local entity of the
+        first tree and entity1 is an entity of the second tree local to
+        process rank."""
+        return self._cpp_object.compute(tree0._cpp_object, tree1._cpp_object)
+
+
 def compute_closest_entity(tree: BoundingBoxTree, tree_midpoint, mesh, x):
     """Compute closest entity of the mesh to the point"""
     return cpp.geometry.compute_closest_entity(tree._cpp_object, tree_midpoint._cpp_object, mesh, x)
 
 
+def compute_closest_points(tree: BoundingBoxTree, x, k=1, num_threads=1):
+    """Compute the k closest points of a point cloud tree to each point
+    of x (an array with shape (num_points, 3)). Returns the point
+    indices and distances, each with shape (num_points, k) and sorted by
+    distance."""
+    return cpp.geometry.compute_closest_points(tree._cpp_object, x, k, num_threads)
+
+
+def compute_closest_entities(tree: BoundingBoxTree, mesh, x, k=1, num_threads=1):
+    """Compute the k closest mesh entities of the tree to each point of
+    x (an array with shape (num_points, 3)). Returns the entity indices
+    and distances, each with shape (num_points, k) and sorted by
+    distance."""
+    return cpp.geometry.compute_closest_entities(tree._cpp_object, mesh, x, k, num_threads)
+
+
 def compute_collisions_point(tree: BoundingBoxTree, x):
     """Compute collisions with the point"""
     return cpp.geometry.compute_collisions_point(tree._cpp_object, x)
 
 
-def compute_colliding_cells(tree: BoundingBoxTree, mesh, x, n=1):
-    """Return cells which the point x lies within"""
+def compute_collisions_points(tree: BoundingBoxTree, x, num_threads=1):
+    """Compute collisions with a batch of points (an array with shape
+    (num_points, 3)). Returns an AdjacencyList with the entities whose
+    bounding boxes contain each point."""
+    return cpp.geometry.compute_collisions_points(tree._cpp_object, x, num_threads)
+
+
+def compute_process_collisions(tree: BoundingBoxTree, x):
+    """Compute the processes whose bounding boxes contain the point"""
+    return cpp.geometry.compute_process_collisions(tree._cpp_object, x)
+
+
+def compute_colliding_cells(tree: BoundingBoxTree, mesh, x, n=1, tol=1e-10):
+    """Return cells which the point x lies within, up to the tolerance
+    tol relative to the cell size"""
     candidate_cells = cpp.geometry.compute_collisions_point(tree._cpp_object, x)
-    return cpp.geometry.select_colliding_cells(mesh, candidate_cells, x, n)
+    return cpp.geometry.select_colliding_cells(mesh, candidate_cells, x, n, tol)
+
+
+def compute_colliding_cells_points(tree: BoundingBoxTree, mesh, x, n=1, tol=1e-10, num_threads=1):
+    """Compute the cells, up to n, which each point of a batch of points
+    (an array with shape (num_points, 3)) lies within, up to the
+    tolerance tol relative to the cell size. Returns an AdjacencyList
+    with the cells of each point."""
+    candidate_cells = cpp.geometry.compute_collisions_points(tree._cpp_object, x, num_threads)
+    return cpp.geometry.select_colliding_cells(mesh, candidate_cells, x, n, tol, num_threads)
 
 
 def compute_collisions(tree0: BoundingBoxTree, tree1: BoundingBoxTree):
@@ -21,14 +21,27 @@ class VTKFile:
 
     """
 
-    def __init__(self, filename: str):
+    Encoding = cpp.io.VTKFile.Encoding
+
+    def __init__(self, filename: str, encoding=Encoding.ascii, compress: bool = False):
         """Open VTK file
         Parameters
         ----------
         filename
             Name of the file
+        encoding
+            Encoding of the data arrays (``VTKFile.Encoding.ascii``,
+            ``base64`` or ``raw``, or the name of the encoding). Binary
+            data is written to the AppendedData section of the .vtu
+            files. The name "compressed" is base64 with compression.
+        compress
+            Compress binary data arrays with zlib
         """
-        self._cpp_object = cpp.io.VTKFile(filename)
+        if isinstance(encoding, str):
+            if encoding == "compressed":
+                encoding, compress = "base64", True
+            encoding = getattr(cpp.io.VTKFile.Encoding, encoding)
+        self._cpp_object = cpp.io.VTKFile(filename, encoding, compress)
 
     def write(self, o, t=None) -> None:
         """Write object to file"""
@@ -39,12 +52,76 @@ class VTKFile:
             self._cpp_object.write(o_cpp, t)
 
 
+class ADIOS2Writer:
+    """Output of meshes and functions with ADIOS2 in the VTX schema,
+    which is read by ParaView. Requires DOLFINX to be built with ADIOS2
+    (see dolfinx.common.has_adios2).
+
+    The mesh geometry and topology are written in the first step only,
+    and again when the mesh geometry changes.
+
+    """
+
+    def __init__(self, comm, filename: str, output, engine="BP4", num_aggregators=0, async_write=False,
+                 parameters={}):
+        """Open an ADIOS2 file for writing
+
+        Parameters
+        ----------
+        comm
+            The MPI communicator
+        filename
+            Name of the file (directory), e.g. "u.bp"
+        output
+            A mesh, or a list of functions on the same mesh
+        engine
+            The ADIOS2 engine, "BP4" or "BP5"
+        num_aggregators
+            Number of processes that write to the file system (0 for the
+            ADIOS2 default)
+        async_write
+            Drain the buffered data to the file system asynchronously
+            (BP5 only)
+        parameters
+            Further ADIOS2 engine parameters
+
+        """
+        if not hasattr(cpp.io, "ADIOS2Writer"):
+            raise RuntimeError("DOLFINX has not been built with ADIOS2")
+        try:
+            output = [getattr(u, "_cpp_object", u) for u in output]
+        except TypeError:
+            pass
+        self._cpp_object = cpp.io.ADIOS2Writer(comm, filename, output, engine, num_aggregators, async_write,
+                                               parameters)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def write(self, t: float = 0.0) -> None:
+        """Write a step with the current values of the functions"""
+        self._cpp_object.write(t)
+
+    def close(self) -> None:
+        """Close the file"""
+        self._cpp_object.close()
+
+
 class XDMFFile(cpp.io.XDMFFile):
     def write_function(self, u, t=0.0, mesh_xpath="/Xdmf/Domain/Grid[@GridType='Uniform'][1]"):
         u_cpp = getattr(u, "_cpp_object", u)
         super().write_function(u_cpp, t, mesh_xpath)
 
-    def read_mesh(self, ghost_mode=cpp.mesh.GhostMode.shared_facet, name="mesh", xpath="/Xdmf/Domain"):
+    def read_mesh(self, ghost_mode=cpp.mesh.GhostMode.shared_facet, name="mesh", xpath="/Xdmf/Domain",
+                  partition_file=None):
+        """Read a mesh. If partition_file is given, the cell partition is
+        read from this HDF5 file when it was computed for the same mesh
+        data and number of processes, and is otherwise computed and
+        written to the file."""
+
         # Read mesh data from file
         cell_type = super().read_cell_type(name, xpath)
         cells = super().read_topology_data(name, xpath)
@@ -56,7 +133,12 @@ class XDMFFile(cpp.io.XDMFFile):
         cmap = fem.create_coordinate_map(domain)
 
         # Build the mesh
-        mesh = cpp.mesh.create_mesh(self.comm(), cpp.graph.AdjacencyList_int64(cells), cmap, x, ghost_mode)
+        cells = cpp.graph.AdjacencyList_int64(cells)
+        if partition_file is None:
+            mesh = cpp.mesh.create_mesh(self.comm(), cells, cmap, x, ghost_mode)
+        else:
+            dest = cpp.io.cell_destinations(self.comm(), partition_file, cells, cmap, x)
+            mesh = cpp.mesh.create_mesh(self.comm(), cells, cmap, x, ghost_mode, dest)
         mesh.name = name
         domain._ufl_cargo = mesh
         mesh._ufl_domain = domain
@@ -64,6 +146,61 @@ class XDMFFile(cpp.io.XDMFFile):
         return mesh
 
 
+class AsyncXDMFFile(cpp.io.AsyncXDMFFile):
+    """XDMF output of time series in a background I/O thread.
+    write_function takes a snapshot of the function values and returns
+    while the snapshot is written; at most max_queue_size snapshots are
+    pending. Requires MPI_THREAD_MULTIPLE."""
+
+    def write_function(self, u, t=0.0):
+        u_cpp = getattr(u, "_cpp_object", u)
+        super().write_function(u_cpp, t)
+
+
+def write_checkpoint(filename: str, mesh, functions={}):
+    """Write a mesh and functions, given as a dict of names and functions,
+    to a new checkpoint file"""
+    cpp.io.write_checkpoint_mesh(filename, mesh)
+    for name, u in functions.items():
+        cpp.io.write_checkpoint_function(filename, getattr(u, "_cpp_object", u), name)
+
+
+def read_checkpoint_mesh(comm, filename: str, domain: ufl.Mesh, ghost_mode=cpp.mesh.GhostMode.shared_facet):
+    """Read a mesh from a checkpoint file. On the number of processes of
+    the checkpoint the written distributed mesh is re-created, otherwise
+    the mesh is partitioned with the given ghost mode. Returns the mesh
+    and the original index of its cells, for read_checkpoint_function."""
+    cmap = fem.create_coordinate_map(domain)
+    mesh, original_cell_index = cpp.io.read_checkpoint_mesh(comm, filename, cmap, ghost_mode)
+    domain._ufl_cargo = mesh
+    mesh._ufl_domain = domain
+    return mesh, original_cell_index
+
+
+def read_checkpoint_function(filename: str, u, name: str, original_cell_index):
+    """Read the coefficients of a function from a checkpoint file. The
+    function must be on a space with the element of the written function,
+    on a mesh read by read_checkpoint_mesh."""
+    cpp.io.read_checkpoint_function(filename, getattr(u, "_cpp_object", u), name, original_cell_index)
+
+
+def write_binary_mesh(filename: str, mesh):
+    """Write a mesh to a native binary mesh file, which is memory mapped
+    by read_binary_mesh"""
+    cpp.io.write_binary_mesh(filename, mesh)
+
+
+def read_binary_mesh(comm, filename: str, domain: ufl.Mesh, ghost_mode=cpp.mesh.GhostMode.shared_facet):
+    """Read a mesh from a native binary mesh file. On the number of
+    processes that wrote the file the written distribution of the cells
+    is restored, otherwise the mesh is partitioned."""
+    cmap = fem.create_coordinate_map(domain)
+    mesh = cpp.io.read_binary_mesh(comm, filename, cmap, ghost_mode)
+    domain._ufl_cargo = mesh
+    mesh._ufl_domain = domain
+    return mesh
+
+
 def extract_gmsh_topology_and_markers(gmsh_model, model_name=None):
     """Extract all entities tagged with a physical marker
     in the gmsh model, and collects the data per cell type.
@@ -6,6 +6,7 @@
 
 import functools
 import os
+import tempfile
 from pathlib import Path
 
 from mpi4py import MPI
@@ -13,6 +14,7 @@ from mpi4py import MPI
 import dolfinx.pkgconfig
 import ffcx
 import ffcx.codegeneration.jit
+import ffcx.naming
 import ufl
 from dolfinx import common
 
@@ -89,19 +91,29 @@ def mpi_jit_decorator(local_jit, *args, **kwargs):
     return mpi_jit
 
 
-@mpi_jit_decorator
-def ffcx_jit(ufl_object, form_compiler_parameters={}, jit_parameters={}):
+# Compiled objects and their modules, keyed by the signature of the
+# UFL object and the parameters. The modules are kept alive such that
+# the objects remain valid.
+_jit_cache = {}
+
+
+def _jit_parameters(form_compiler_parameters, jit_parameters):
+    """Return the form compiler and JIT parameters, with the defaults
+    of DOLFINX and the environmental variable overrides"""
+
     # Prepare form compiler parameters with overrides from dolfinx
     p = ffcx.default_parameters()
     p["scalar_type"] = "double complex" if common.has_petsc_complex else "double"
     p.update(form_compiler_parameters)
 
     cache_dir_default = Path.joinpath(Path.home(), ".cache", "fenics")
+    node_cache_dir_default = Path(tempfile.gettempdir(), "fenics-{}".format(os.getuid()))
 
     # CFFI compiler options/flags
     jit_params = {"cffi_extra_compile_args": ["-O2", "-g0"],
                   "cffi_debug": False, "cffi_verbose": False,
-                  "cffi_libraries": None, "cache_dir": cache_dir_default, "timeout": 10}
+                  "cffi_libraries": None, "cache_dir": cache_dir_default, "timeout": 10,
+                  "node_cache_dir": node_cache_dir_default}
 
     jit_params.update(jit_parameters)
 
@@ -116,6 +128,18 @@ def ffcx_jit(ufl_object, form_compiler_parameters={}, jit_parameters={}):
     cache_dir = Path(cache_dir).expanduser()
     jit_params["cache_dir"] = cache_dir
 
+    # Set the node-local cache location (an empty value disables it)
+    node_cache_dir = os.getenv('DOLFINX_JIT_NODE_CACHE_DIR', jit_params["node_cache_dir"])
+    jit_params["node_cache_dir"] = Path(node_cache_dir).expanduser() if node_cache_dir else None
+
+    return p, jit_params
+
+
+def _compile(ufl_object, p, jit_params):
+    """Compile (or load from the cache directory) a UFL object, and
+    return the compiled object and its module"""
+    jit_params = {key: value for key, value in jit_params.items() if key != "node_cache_dir"}
+
     # Switch on type and compile, returning cffi object
     if isinstance(ufl_object, ufl.Form):
         r = ffcx.codegeneration.jit.compile_forms([ufl_object], parameters=p, **jit_params)
@@ -129,4 +153,111 @@ def ffcx_jit(ufl_object, form_compiler_parameters={}, jit_parameters={}):
     else:
         raise TypeError(type(ufl_object))
 
-    return r[0][0]
+    return r[0][0], r[1]
+
+
+def _write_module(node_cache_dir, filename, data):
+    """Write a compiled module to a cache directory, with the files that
+    mark it as compiled for FFCX"""
+    node_cache_dir.mkdir(exist_ok=True, parents=True)
+    module_name = filename.split(".")[0]
+
+    # Write to temporary files that are moved into place, such that a
+    # module is never loaded when it is partially written
+    for name, contents in ((filename, data), (module_name + ".c", b""), (module_name + ".c.cached", b"")):
+        path = node_cache_dir.joinpath(name)
+        with tempfile.NamedTemporaryFile(dir=node_cache_dir, delete=False) as f:
+            f.write(contents)
+        os.replace(f.name, path)
+
+
+def _mpi_compile(ufl_object, p, jit_params, mpi_comm):
+    """Compile a UFL object on process 0 and load it on the other
+    processes (collective)
+
+    The module that is compiled by process 0 is broadcast to one
+    process per node, which writes it to the node-local cache directory,
+    from which the processes of the node load it. This avoids that
+    all processes access the (shared) cache directory. If the node-local
+    cache is disabled, the processes load the module from the cache
+    directory.
+
+    """
+
+    # Compile first on process 0
+    status, error_msg, output = 0, None, None
+    if mpi_comm.rank == 0:
+        try:
+            output = _compile(ufl_object, p, jit_params)
+        except Exception as e:
+            status, error_msg = 1, str(e)
+
+    node_cache_dir = jit_params["node_cache_dir"]
+    if node_cache_dir is None:
+        status = mpi_comm.allreduce(status, op=MPI.MAX)
+        if status == 0 and mpi_comm.rank != 0:
+            output = _compile(ufl_object, p, jit_params)
+    else:
+        # Send the module from process 0 to the first process of each
+        # node, which writes it to the node-local cache
+        node_comm = mpi_comm.Split_type(MPI.COMM_TYPE_SHARED, key=mpi_comm.rank)
+        leader_comm = mpi_comm.Split(0 if node_comm.rank == 0 else MPI.UNDEFINED, key=mpi_comm.rank)
+        if leader_comm != MPI.COMM_NULL:
+            module = None
+            if status == 0 and mpi_comm.rank == 0:
+                filename = output[1].__file__
+                module = (Path(filename).name, Path(filename).read_bytes())
+            status, module = leader_comm.bcast((status, module), root=0)
+            if status == 0 and (mpi_comm.rank != 0 or node_comm.size > 1):
+                try:
+                    _write_module(node_cache_dir, *module)
+                except Exception as e:
+                    status, error_msg = 1, str(e)
+            leader_comm.Free()
+
+        # Wait until the modules are written, and load them
+        status = mpi_comm.allreduce(status, op=MPI.MAX)
+        if status == 0 and mpi_comm.rank != 0:
+            output = _compile(ufl_object, p, dict(jit_params, cache_dir=node_cache_dir))
+        node_comm.Free()
+
+    if status != 0:
+        # Fail simultaneously on all processes, to allow catching the
+        # error without deadlock
+        if error_msg is None:
+            error_msg = "Compilation failed on root node."
+        raise RuntimeError("Failed just-in-time compilation of form: {}".format(error_msg))
+
+    return output
+
+
+def ffcx_jit(ufl_object, form_compiler_parameters={}, jit_parameters={}, mpi_comm=MPI.COMM_WORLD):
+    """Compile a UFL form, element, coordinate map (mesh) or expression
+    (a tuple of an expression and points), and return the compiled
+    object (collective)
+
+    Compiled objects are cached in memory, such that compiling an
+    object with the same signature and parameters again does not access
+    the file system. In parallel, the object is compiled by process 0
+    and distributed via node-local storage (the JIT parameter
+    "node_cache_dir", or the environmental variable
+    DOLFINX_JIT_NODE_CACHE_DIR, which disables it if it is empty).
+
+    """
+    p, jit_params = _jit_parameters(form_compiler_parameters, jit_parameters)
+    key = (ffcx.naming.compute_signature([ufl_object], ""), str(p), str(jit_params))
+
+    # Use the in-memory cache only if all processes have the object, as
+    # the compilation is collective
+    cached = key in _jit_cache
+    if mpi_comm.size > 1:
+        cached = mpi_comm.allreduce(cached, op=MPI.LAND)
+    if cached:
+        return _jit_cache[key][0]
+
+    if mpi_comm.size == 1:
+        output = _compile(ufl_object, p, jit_params)
+    else:
+        output = _mpi_compile(ufl_object, p, jit_params, mpi_comm)
+    _jit_cache[key] = output
+    return output[0]
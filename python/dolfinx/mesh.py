@@ -12,7 +12,9 @@ from dolfinx import cpp, fem
 from dolfinx.cpp.mesh import create_meshtags
 
 __all__ = [
-    "locate_entities", "locate_entities_boundary", "refine", "create_mesh", "create_meshtags"
+    "locate_entities", "locate_entities_boundary", "refine", "refine_with_parents", "refine_meshtags", "MeshHierarchy",
+    "coarsen", "coarsen_function", "coarsen_meshtags", "mark_maximum", "mark_dorfler", "rebalance", "create_mesh",
+    "create_meshtags", "create_submesh"
 ]
 
 
@@ -86,24 +88,227 @@ _meshtags_types = {
 }
 
 
-def refine(mesh, cell_markers=None, redistribute=True):
-    """Refine a mesh"""
+def refine(mesh, cell_markers=None, redistribute=True, num_threads=1, meshtags=None, max_imbalance=None):
+    """Refine a mesh. The cells are subdivided on num_threads threads.
+    Meshes of quadrilaterals and hexahedra can only be refined
+    uniformly (cell_markers is None).
+
+    Without redistribution, the refined mesh keeps the distribution of
+    the input mesh. If max_imbalance is given, it is repartitioned if
+    the largest number of cells on a process exceeds the mean by more
+    than this factor.
+
+    If meshtags (a list of MeshTags on the mesh, of any dimension) is
+    given, the mesh is refined without redistribution, and the refined
+    mesh and the tags transferred onto it (see refine_meshtags) are
+    returned."""
+    if meshtags is not None:
+        mesh_refined, *parents = refine_with_parents(mesh, cell_markers)
+        return mesh_refined, [refine_meshtags(tags, mesh_refined, parents) for tags in meshtags]
+    if max_imbalance is None:
+        max_imbalance = float("inf")
     if cell_markers is None:
-        mesh_refined = cpp.refinement.refine(mesh, redistribute)
+        mesh_refined = cpp.refinement.refine(mesh, redistribute, num_threads, max_imbalance)
     else:
-        mesh_refined = cpp.refinement.refine(mesh, cell_markers, redistribute)
+        mesh_refined = cpp.refinement.refine(mesh, cell_markers, redistribute, num_threads, max_imbalance)
     mesh_refined._ufl_domain = mesh._ufl_domain
     return mesh_refined
 
 
-def create_mesh(comm, cells, x, domain, ghost_mode=cpp.mesh.GhostMode.shared_facet):
-    """Create a mesh from topology and geometry data"""
+def refine_with_parents(mesh, cell_markers=None):
+    """Refine a mesh without redistribution. Returns the refined mesh,
+    the parent cell (local index in the input mesh) of each cell, the
+    index in the parent cell of the parent facet of each facet of each
+    cell (-1 for facets interior to the parent cell), and the new vertex
+    of each edge of the input mesh (-1 for edges that are not refined)."""
+    if cell_markers is None:
+        refined = cpp.refinement.refine_with_parents(mesh)
+    else:
+        refined = cpp.refinement.refine_with_parents(mesh, cell_markers)
+    mesh_refined, parent_cell, parent_facet, edge_vertex = refined
+    mesh_refined._ufl_domain = mesh._ufl_domain
+    num_facets = mesh.topology.dim + 1
+    return mesh_refined, parent_cell, parent_facet.reshape(-1, num_facets), edge_vertex
+
+
+def refine_meshtags(tags, mesh, parents):
+    """Transfer MeshTags of any dimension onto a mesh refined from the
+    mesh of the tags, without geometric searches. An entity takes the
+    value of the parent entity (of the same dimension) that contains it.
+    The parents are the parent maps as returned by refine_with_parents."""
+    parent_cell, parent_facet, edge_vertex = parents
+    return cpp.refinement.refine_meshtags(tags, mesh, parent_cell, numpy.ravel(parent_facet), edge_vertex)
+
+
+def coarsen(parent_mesh, mesh, parents, cell_markers):
+    """Coarsen a mesh created by refine_with_parents, by merging the
+    children of the parent cells whose children are all marked (value 1)
+    in cell_markers, where the coarsened mesh stays conforming. The
+    parents are the parent maps as returned by refine_with_parents.
+    Returns the coarsened mesh and its relations to the refined mesh
+    (CoarseningMaps), for coarsen_function and coarsen_meshtags."""
+    parent_cell, parent_facet, edge_vertex = parents
+    coarse_mesh, maps = cpp.refinement.coarsen(parent_mesh, mesh, parent_cell, parent_facet.ravel(), edge_vertex,
+                                               cell_markers)
+    coarse_mesh._ufl_domain = mesh._ufl_domain
+    return coarse_mesh, maps
+
+
+def coarsen_function(u, u_coarse, parents, maps):
+    """Interpolate a Lagrange function on a refined mesh into u_coarse
+    on a mesh created by coarsen"""
+    parent_cell, parent_facet, edge_vertex = parents
+    cpp.refinement.transfer_function(u._cpp_object, u_coarse._cpp_object, parent_cell, parent_facet.ravel(),
+                                     edge_vertex, maps)
+
+
+def coarsen_meshtags(tags, coarse_mesh, parents, maps):
+    """Transfer MeshTags of cells or facets on a refined mesh to a mesh
+    created by coarsen"""
+    parent_cell, parent_facet, edge_vertex = parents
+    return cpp.refinement.transfer_meshtags(tags, coarse_mesh, parent_cell, parent_facet.ravel(), edge_vertex, maps)
+
+
+def _cell_indicator(mesh, indicator):
+    """The indicator of each owned cell, from a DG0 Function or an
+    array of the owned cell values"""
+    if hasattr(indicator, "function_space"):
+        dofs = indicator.function_space.dofmap.list.array
+        num_cells = mesh.topology.index_map(mesh.topology.dim).size_local
+        with indicator.vector.localForm() as values:
+            return numpy.abs(values.array[dofs[:num_cells]]).astype(numpy.double)
+    return numpy.asarray(indicator, dtype=numpy.double)
+
+
+def mark_maximum(mesh, indicator, theta):
+    """Mark the cells with an error indicator of at least theta times the
+    largest indicator. The indicator is a DG0 Function or an array of
+    the (non-negative) indicators of the owned cells. Returns the cell
+    markers for refine."""
+    return cpp.refinement.mark_maximum(mesh, _cell_indicator(mesh, indicator), theta)
+
+
+def mark_dorfler(mesh, indicator, theta):
+    """Mark the cells with the largest error indicators such that the sum
+    of their squares is at least theta times the total (Dörfler marking).
+    The indicator is a DG0 Function or an array of the (non-negative)
+    indicators of the owned cells. Returns the cell markers for
+    refine."""
+    return cpp.refinement.mark_dorfler(mesh, _cell_indicator(mesh, indicator), theta)
+
+
+class MeshHierarchy:
+    """A hierarchy of nested meshes for geometric multigrid, created by
+    uniform refinement of a coarse mesh without redistribution.
+
+    The prolongation matrices between Lagrange spaces on consecutive
+    levels are the interpolation operators of a PETSc multigrid
+    preconditioner, e.g. with petsc4py::
+
+        pc.setType("mg")
+        pc.setMGLevels(hierarchy.num_levels)
+        for level, P in enumerate(hierarchy.prolongations(spaces)):
+            pc.setMGInterpolation(level + 1, P)
+    """
+
+    def __init__(self, mesh, num_refinements: int):
+        self._cpp_object = cpp.refinement.MeshHierarchy(mesh, num_refinements)
+        self._meshes = [mesh]
+        for level in range(1, self._cpp_object.num_levels):
+            mesh_level = self._cpp_object.mesh(level)
+            mesh_level._ufl_domain = mesh._ufl_domain
+            self._meshes.append(mesh_level)
+
+    @property
+    def num_levels(self) -> int:
+        """Number of levels (meshes)"""
+        return len(self._meshes)
+
+    def mesh(self, level: int):
+        """The mesh of a level (0 is the coarsest mesh)"""
+        return self._meshes[level]
+
+    def parent_cells(self, level: int):
+        """The parent cell (local index in the mesh of level - 1) of each
+        cell of the mesh of a level (greater than zero)"""
+        return self._cpp_object.parent_cells(level)
+
+    def parents(self, level: int):
+        """The parent maps of the mesh of a level (greater than zero),
+        as returned by refine_with_parents"""
+        parent_cell, parent_facet, edge_vertex = self._cpp_object.parents(level)
+        return parent_cell, parent_facet.reshape(-1, self._meshes[0].topology.dim + 1), edge_vertex
+
+    def transfer_meshtags(self, tags):
+        """Transfer MeshTags on the coarsest mesh to all levels. Returns
+        the tags on each level."""
+        all_tags = [tags]
+        for level in range(1, self.num_levels):
+            all_tags.append(refine_meshtags(all_tags[-1], self._meshes[level], self.parents(level)))
+        return all_tags
+
+    def prolongation(self, V0, V1, level: int):
+        """Create the prolongation matrix from a space V0 on the mesh of
+        level - 1 to a space V1 on the mesh of a level"""
+        return cpp.refinement.create_prolongation(V0._cpp_object, V1._cpp_object, self.parent_cells(level))
+
+    def prolongations(self, spaces):
+        """Create the prolongation matrices between a space on each
+        level, from the coarsest to the finest level"""
+        if len(spaces) != self.num_levels:
+            raise RuntimeError("A space is required on each level.")
+        return [self.prolongation(spaces[level - 1], spaces[level], level) for level in range(1, self.num_levels)]
+
+
+def rebalance(mesh, weights=None, ghost_mode=cpp.mesh.GhostMode.shared_facet,
+              partitioner=cpp.mesh.CellPartitioner.graph):
+    """Redistribute a mesh such that the sum of the cell weights
+    (default: one per cell) is balanced across processes. Returns the
+    new mesh and, for each of its cells, the global index of the cell
+    in the cell index map of the input mesh."""
+    if weights is None:
+        weights = []
+    mesh_new, original_cell_index = cpp.mesh.rebalance(mesh, weights, ghost_mode, partitioner)
+    mesh_new._ufl_domain = mesh._ufl_domain
+    return mesh_new, original_cell_index
+
+
+def create_submesh(mesh, dim, entities):
+    """Create a mesh of the entities of dimension dim with the given
+    local indices, e.g. of a subdomain or of the boundary. The submesh
+    keeps the parallel distribution of the mesh. Returns the submesh
+    and, for each of its (owned and ghost) cells, vertices and geometry
+    nodes, the local index of the entity, vertex and geometry node of
+    the mesh. Data is restricted to the submesh by indexing with these
+    maps."""
+    e = mesh.ufl_domain().ufl_coordinate_element()
+    cell_type = cpp.mesh.cell_entity_type(mesh.topology.cell_type, dim)
+    cell = ufl.Cell(cpp.mesh.to_string(cell_type), geometric_dimension=mesh.geometry.dim)
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", cell, e.degree()))
+    cmap = fem.create_coordinate_map(domain)
+    submesh, entity_map, vertex_map, node_map = cpp.mesh.create_submesh(
+        mesh, dim, numpy.asarray(entities, dtype=numpy.int32), cmap)
+    domain._ufl_cargo = submesh
+    submesh._ufl_domain = domain
+    return submesh, entity_map, vertex_map, node_map
+
+
+def create_mesh(comm, cells, x, domain, ghost_mode=cpp.mesh.GhostMode.shared_facet, reorder_cells=False,
+                partitioner=cpp.mesh.CellPartitioner.graph):
+    """Create a mesh from topology and geometry data. If reorder_cells
+    is True, the owned cells on each process are re-ordered for data
+    locality after the cells are distributed. The cells are distributed
+    using a graph partitioner (default), with
+    partitioner=CellPartitioner.hilbert along a Hilbert curve through
+    the cell midpoints, or with partitioner=CellPartitioner.hierarchical
+    using a graph partitioner across the shared memory nodes and then
+    across the processes of each node."""
     cmap = fem.create_coordinate_map(domain)
     try:
-        mesh = cpp.mesh.create_mesh(comm, cells, cmap, x, ghost_mode)
+        mesh = cpp.mesh.create_mesh(comm, cells, cmap, x, ghost_mode, reorder_cells, partitioner)
     except TypeError:
         mesh = cpp.mesh.create_mesh(comm, cpp.graph.AdjacencyList_int64(numpy.cast['int64'](cells)),
-                                    cmap, x, ghost_mode)
+                                    cmap, x, ghost_mode, reorder_cells, partitioner)
 
     # Attach UFL data (used when passing a mesh into UFL functions)
     domain._ufl_cargo = mesh
@@ -9,9 +9,11 @@
 #include "caster_petsc.h"
 #include <Eigen/Dense>
 #include <complex>
+#include <dolfinx/common/CommProfiler.h>
 #include <dolfinx/common/IndexMap.h>
 #include <dolfinx/common/SubSystemsManager.h>
 #include <dolfinx/common/Table.h>
+#include <dolfinx/common/ThreadPool.h>
 #include <dolfinx/common/Timer.h>
 #include <dolfinx/common/defines.h>
 #include <dolfinx/common/timing.h>
@@ -33,6 +35,8 @@ void common(py::module& m)
   m.attr("has_debug") = dolfinx::has_debug();
   m.attr("has_parmetis") = dolfinx::has_parmetis();
   m.attr("has_kahip") = dolfinx::has_kahip();
+  m.attr("has_adios2") = dolfinx::has_adios2();
+  m.attr("has_zlib") = dolfinx::has_zlib();
   m.attr("has_petsc_complex") = dolfinx::has_petsc_complex();
   m.attr("has_slepc") = dolfinx::has_slepc();
 #ifdef HAS_PYBIND11_SLEPC4PY
@@ -74,7 +78,9 @@ void common(py::module& m)
                              "Return list of ghost indices")
       .def("global_indices", &dolfinx::common::IndexMap::global_indices)
       .def("indices", &dolfinx::common::IndexMap::indices,
-           "Return array of global indices for all indices on this process");
+           "Return array of global indices for all indices on this process")
+      .def("memory_usage", &dolfinx::common::IndexMap::memory_usage,
+           "Memory used by the map on this process (bytes)");
 
   // dolfinx::common::Timer
   py::class_<dolfinx::common::Timer, std::shared_ptr<dolfinx::common::Timer>>(
@@ -92,8 +98,71 @@ void common(py::module& m)
       .value("system", dolfinx::TimingType::system)
       .value("user", dolfinx::TimingType::user);
 
+  // dolfinx::Table
+  py::class_<dolfinx::Table, std::shared_ptr<dolfinx::Table>> table(
+      m, "Table", "Table of values with row and column names");
+  py::enum_<dolfinx::Table::Reduction>(table, "Reduction")
+      .value("average", dolfinx::Table::Reduction::average)
+      .value("max", dolfinx::Table::Reduction::max)
+      .value("min", dolfinx::Table::Reduction::min)
+      .value("sum", dolfinx::Table::Reduction::sum);
+  table.def(py::init<std::string, bool>(), py::arg("title") = "",
+            py::arg("right_justify") = true)
+      .def("get", &dolfinx::Table::get, "Get value of table entry")
+      .def(
+          "reduce",
+          [](const dolfinx::Table& self, const MPICommWrapper comm,
+             dolfinx::Table::Reduction reduction) {
+            return self.reduce(comm.get(), reduction);
+          },
+          "Reduce table values over processes (collective)")
+      .def("__str__", &dolfinx::Table::str);
+
   // dolfin/common free functions
   m.def("timing", &dolfinx::timing);
+  m.def("set_timing_enabled", &dolfinx::set_timing_enabled,
+        "Enable or disable the registration of timings");
+  m.def("set_cpu_timing", &dolfinx::set_cpu_timing,
+        "Enable or disable the measurement of user and system times");
+  m.def("set_comm_profiling", &dolfinx::common::CommProfiler::set_enabled,
+        "Enable or disable the recording of communication");
+  m.def(
+      "comm_profile",
+      []() {
+        std::map<std::string, std::tuple<std::int64_t, std::int64_t,
+                                         std::int64_t, std::int64_t, double>>
+            records;
+        for (auto& [site, r] : dolfinx::common::CommProfiler::records())
+        {
+          records[site] = {r.calls, r.neighbours, r.bytes_sent,
+                           r.bytes_received, r.time};
+        }
+        return records;
+      },
+      "The (calls, neighbours, bytes sent, bytes received, time) of the "
+      "communication of each call site on this process");
+  m.def("clear_comm_profile", &dolfinx::common::CommProfiler::clear,
+        "Remove the records of communication");
+  m.def(
+      "list_comm_profile",
+      [](const MPICommWrapper comm) {
+        dolfinx::common::CommProfiler::list(comm.get());
+      },
+      "Print the communication of each call site reduced over the "
+      "processes (collective)");
+  m.def("set_hardware_counters", &dolfinx::set_hardware_counters,
+        "Enable or disable the sampling of hardware counters by timers");
+  m.def("set_memory_tracking", &dolfinx::set_memory_tracking,
+        "Enable or disable the sampling of the memory usage by timers");
+  m.def("set_trace", &dolfinx::set_trace, py::arg("enabled"),
+        py::arg("filename") = "",
+        "Enable or disable the recording of timings for a trace");
+  m.def(
+      "write_trace",
+      [](const MPICommWrapper comm, std::string filename) {
+        dolfinx::write_trace(comm.get(), filename);
+      },
+      "Write the recorded timings as a Chrome trace (collective)");
   m.def("timings", [](std::vector<dolfinx::TimingType> type) {
     std::set<dolfinx::TimingType> _type(type.begin(), type.end());
     return dolfinx::timings(_type);
@@ -110,5 +179,13 @@ void common(py::module& m)
       argv[i] = const_cast<char*>(args[i].data());
     dolfinx::common::SubSystemsManager::init_logging(args.size(), argv.data());
   });
+
+  m.def("init_threads", &dolfinx::common::SubSystemsManager::init_threads,
+        py::arg("num_threads") = 0,
+        "Set up the thread pool of the library (collective)");
+  m.def(
+      "num_threads",
+      []() { return dolfinx::common::ThreadPool::instance().num_threads(); },
+      "Number of threads of the thread pool of the library");
 }
 } // namespace dolfinx_wrappers
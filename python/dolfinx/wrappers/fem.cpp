@@ -7,7 +7,9 @@
 #include "caster_mpi.h"
 #include "caster_petsc.h"
 #include <Eigen/Dense>
+#include <algorithm>
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/common/Table.h>
 #include <dolfinx/common/types.h>
 #include <dolfinx/fem/CoordinateElement.h>
 #include <dolfinx/fem/DirichletBC.h>
@@ -15,14 +17,19 @@
 #include <dolfinx/fem/DofMap.h>
 #include <dolfinx/fem/DofMapBuilder.h>
 #include <dolfinx/fem/ElementDofLayout.h>
+#include <dolfinx/fem/Expression.h>
 #include <dolfinx/fem/FiniteElement.h>
 #include <dolfinx/fem/Form.h>
+#include <dolfinx/fem/StaticCondensation.h>
+#include <dolfinx/fem/SumFactorisation.h>
 #include <dolfinx/fem/assembler.h>
 #include <dolfinx/fem/petsc.h>
 #include <dolfinx/fem/utils.h>
 #include <dolfinx/function/Constant.h>
 #include <dolfinx/function/Function.h>
 #include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/function/QuadratureData.h>
+#include <dolfinx/la/MatrixCSR.h>
 #include <dolfinx/la/PETScMatrix.h>
 #include <dolfinx/la/PETScVector.h>
 #include <dolfinx/la/SparsityPattern.h>
@@ -74,6 +81,12 @@ namespace dolfinx_wrappers
 {
 void fem(py::module& m)
 {
+  py::enum_<dolfinx::fem::DofOrdering>(m, "DofOrdering")
+      .value("gps", dolfinx::fem::DofOrdering::gps)
+      .value("cuthill_mckee", dolfinx::fem::DofOrdering::cuthill_mckee)
+      .value("cell", dolfinx::fem::DofOrdering::cell)
+      .value("random", dolfinx::fem::DofOrdering::random);
+
   // utils
   m.def(
       "create_vector_block",
@@ -98,22 +111,200 @@ void fem(py::module& m)
       "Create nested vector for multiple (stacked) linear forms.");
 
   m.def("create_sparsity_pattern",
-        &dolfinx::fem::create_sparsity_pattern<PetscScalar>,
-        "Create a sparsity pattern for bilinear form.");
+        &dolfinx::fem::create_sparsity_pattern<PetscScalar>, py::arg("a"),
+        py::arg("blocked") = false,
+        "Create a sparsity pattern for bilinear form. "
+        "The GIL is released.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("compute_partition_report", &dolfinx::fem::compute_partition_report,
+        py::arg("mesh"),
+        py::arg("spaces")
+        = std::vector<
+            std::shared_ptr<const dolfinx::function::FunctionSpace>>(),
+        "Compute partition quality and communication volume report.");
+  m.def("compute_subdomain_dofs", &dolfinx::fem::compute_subdomain_dofs,
+        py::arg("V"), py::arg("num_subdomains"), py::arg("overlap") = 1,
+        "Compute the global dofs of overlapping subdomains of the owned "
+        "cells, e.g. for PETSc PCASM/PCGASM.");
+  m.def("compute_patches", &dolfinx::fem::compute_patches, py::arg("V"),
+        py::arg("dim"), py::arg("interior") = false, py::arg("num_threads") = 1,
+        "Compute the cells and the local dofs of the patches of the owned "
+        "mesh entities of a dimension, e.g. for patch smoothers.");
   m.def("pack_coefficients", &dolfinx::fem::pack_coefficients<PetscScalar>,
-        "Pack coefficients for a UFL form.");
+        "Pack coefficients for a UFL form. "
+        "The GIL is released.",
+        py::call_guard<py::gil_scoped_release>());
   m.def("pack_constants", &dolfinx::fem::pack_constants<PetscScalar>,
         "Pack constants for a UFL form.");
+  py::class_<dolfinx::fem::MatrixPositionMap,
+             std::shared_ptr<dolfinx::fem::MatrixPositionMap>>(
+      m, "MatrixPositionMap",
+      "Positions of cell element matrix entries in a PETSc AIJ matrix");
+  m.def("create_matrix_position_map", &dolfinx::fem::create_matrix_position_map,
+        "Compute positions of cell element matrix entries in a matrix");
   m.def(
       "create_matrix",
-      [](const dolfinx::fem::Form<PetscScalar>& a) {
-        auto A = dolfinx::fem::create_matrix(a);
+      [](const dolfinx::fem::Form<PetscScalar>& a, const std::string& type) {
+        auto A = dolfinx::fem::create_matrix(a, type);
         Mat _A = A.mat();
         PetscObjectReference((PetscObject)_A);
         return _A;
       },
-      py::return_value_policy::take_ownership,
-      "Create a PETSc Mat for bilinear form.");
+      py::return_value_policy::take_ownership, py::arg("a"),
+      py::arg("type") = std::string(),
+      "Create a PETSc Mat for bilinear form. "
+      "The GIL is released while the sparsity pattern is built.",
+      py::call_guard<py::gil_scoped_release>());
+  py::class_<dolfinx::fem::MatrixCache,
+             std::shared_ptr<dolfinx::fem::MatrixCache>>(
+      m, "MatrixCache",
+      "Cache of matrix sparsity patterns shared by bilinear forms with the "
+      "same dofmaps and integral types")
+      .def(py::init<>())
+      .def(
+          "create_matrix",
+          [](dolfinx::fem::MatrixCache& self,
+             const dolfinx::fem::Form<PetscScalar>& a,
+             const std::string& type) {
+            auto A = self.create_matrix(a, type);
+            Mat _A = A.mat();
+            PetscObjectReference((PetscObject)_A);
+            return _A;
+          },
+          py::return_value_policy::take_ownership, py::arg("a"),
+          py::arg("type") = std::string(),
+          "Create a PETSc Mat for bilinear form, with the non-zero "
+          "structure of the cached matrix if there is one",
+          py::call_guard<py::gil_scoped_release>())
+      .def("sparsity_pattern", &dolfinx::fem::MatrixCache::sparsity_pattern,
+           py::arg("a"), "Sparsity pattern of bilinear form")
+      .def_property_readonly("size", &dolfinx::fem::MatrixCache::size)
+      .def("clear", &dolfinx::fem::MatrixCache::clear);
+  py::class_<dolfinx::fem::AssemblyStrategy>(
+      m, "AssemblyStrategy",
+      "Strategy for the execution of a matrix assembly plan")
+      .def(py::init<>())
+      .def_readwrite("num_threads",
+                     &dolfinx::fem::AssemblyStrategy::num_threads)
+      .def_readwrite("positions", &dolfinx::fem::AssemblyStrategy::positions);
+  py::class_<dolfinx::fem::AssemblyPlan,
+             std::shared_ptr<dolfinx::fem::AssemblyPlan>>(
+      m, "AssemblyPlan",
+      "Persistent plan for the repeated assembly of a form into a PETSc "
+      "Mat or Vec")
+      .def(py::init<std::shared_ptr<const dolfinx::fem::Form<PetscScalar>>,
+                    const std::vector<std::shared_ptr<
+                        const dolfinx::fem::DirichletBC<PetscScalar>>>&,
+                    Mat, PetscScalar>(),
+           py::arg("a"), py::arg("bcs"), py::arg("A"),
+           py::arg("diagonal") = 1.0)
+      .def(py::init<std::shared_ptr<const dolfinx::fem::Form<PetscScalar>>,
+                    Vec>(),
+           py::arg("L"), py::arg("b"))
+      .def("execute", &dolfinx::fem::AssemblyPlan::execute,
+           "Zero the tensor and assemble the form into it. The GIL is "
+           "released.",
+           py::call_guard<py::gil_scoped_release>())
+      .def("autotune", &dolfinx::fem::AssemblyPlan::autotune,
+           "Choose the fastest strategy for the execution of a matrix "
+           "assembly plan (collective). The GIL is released.",
+           py::arg("max_threads") = 1, py::arg("num_repeats") = 1,
+           py::arg("filename") = "",
+           py::call_guard<py::gil_scoped_release>())
+      .def_property("strategy", &dolfinx::fem::AssemblyPlan::strategy,
+                    &dolfinx::fem::AssemblyPlan::set_strategy)
+      .def_property_readonly("form", &dolfinx::fem::AssemblyPlan::form)
+      .def("memory_usage", &dolfinx::fem::AssemblyPlan::memory_usage,
+           "Memory used by the precomputed data of the plan, in bytes");
+  py::class_<dolfinx::fem::StaticCondensation<PetscScalar>,
+             std::shared_ptr<dolfinx::fem::StaticCondensation<PetscScalar>>>(
+      m, "StaticCondensation",
+      "Static condensation of the cell-interior dofs of a linear system")
+      .def(py::init<std::shared_ptr<const dolfinx::fem::Form<PetscScalar>>,
+                    std::shared_ptr<const dolfinx::fem::Form<PetscScalar>>>(),
+           py::arg("a"), py::arg("L"))
+      .def_property_readonly(
+          "index_map",
+          &dolfinx::fem::StaticCondensation<PetscScalar>::index_map)
+      .def_property_readonly(
+          "dofmap", &dolfinx::fem::StaticCondensation<PetscScalar>::dofmap)
+      .def(
+          "create_matrix",
+          [](const dolfinx::fem::StaticCondensation<PetscScalar>& self,
+             const std::string& type) {
+            dolfinx::la::SparsityPattern pattern
+                = self.create_sparsity_pattern(true);
+            pattern.assemble();
+            dolfinx::la::PETScMatrix A(self.mesh()->mpi_comm(), pattern,
+                                       type);
+            Mat _A = A.mat();
+            PetscObjectReference((PetscObject)_A);
+            return _A;
+          },
+          py::return_value_policy::take_ownership,
+          py::arg("type") = std::string(),
+          "Create a PETSc Mat for the condensed system")
+      .def(
+          "assemble_matrix",
+          [](const dolfinx::fem::StaticCondensation<PetscScalar>& self, Mat A,
+             const std::vector<std::shared_ptr<
+                 const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs) {
+            self.assemble_matrix(dolfinx::la::PETScMatrix::add_fn(A), bcs);
+          },
+          py::arg("A"), py::arg("bcs"),
+          "Assemble the condensed matrix into a PETSc Mat")
+      .def(
+          "add_diagonal",
+          [](const dolfinx::fem::StaticCondensation<PetscScalar>& self, Mat A,
+             const std::vector<std::shared_ptr<
+                 const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs,
+             PetscScalar diagonal) {
+            self.add_diagonal(dolfinx::la::PETScMatrix::add_fn(A), bcs,
+                              diagonal);
+          },
+          py::arg("A"), py::arg("bcs"), py::arg("diagonal") = 1.0,
+          "Add a value to the diagonal of the condensed matrix for the "
+          "constrained dofs")
+      .def("assemble_vector",
+           &dolfinx::fem::StaticCondensation<PetscScalar>::assemble_vector,
+           py::arg("b"), py::arg("bcs"),
+           "Assemble the condensed vector, with the lifting of the "
+           "boundary conditions applied")
+      .def("set_bc", &dolfinx::fem::StaticCondensation<PetscScalar>::set_bc,
+           py::arg("b"), py::arg("bcs"), py::arg("scale") = 1.0)
+      .def("recover", &dolfinx::fem::StaticCondensation<PetscScalar>::recover,
+           py::arg("x_interface"), py::arg("x"),
+           "Recover the full solution from the condensed solution");
+  m.def(
+      "create_matrix_free_operator",
+      [](std::shared_ptr<const dolfinx::fem::Form<PetscScalar>> a,
+         const std::vector<std::shared_ptr<
+             const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs,
+         PetscScalar diagonal) {
+        auto A = dolfinx::fem::create_matrix_free_operator(a, bcs, diagonal);
+        Mat _A = A.mat();
+        PetscObjectReference((PetscObject)_A);
+        return _A;
+      },
+      py::return_value_policy::take_ownership, py::arg("a"), py::arg("bcs"),
+      py::arg("diagonal") = 1.0,
+      "Create a matrix-free (MATSHELL) PETSc Mat for bilinear form.");
+  m.def(
+      "create_matrix_free_operator",
+      [](std::shared_ptr<const dolfinx::fem::SumFactorisedOperator<PetscScalar>>
+             a,
+         const std::vector<std::shared_ptr<
+             const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs,
+         PetscScalar diagonal) {
+        auto A = dolfinx::fem::create_matrix_free_operator(a, bcs, diagonal);
+        Mat _A = A.mat();
+        PetscObjectReference((PetscObject)_A);
+        return _A;
+      },
+      py::return_value_policy::take_ownership, py::arg("a"), py::arg("bcs"),
+      py::arg("diagonal") = 1.0,
+      "Create a matrix-free (MATSHELL) PETSc Mat for a sum-factorised "
+      "operator.");
   m.def(
       "create_matrix_block",
       [](const std::vector<std::vector<const dolfinx::fem::Form<PetscScalar>*>>&
@@ -125,7 +316,9 @@ void fem(py::module& m)
         return _A;
       },
       py::return_value_policy::take_ownership,
-      "Create monolithic sparse matrix for stacked bilinear forms.");
+      "Create monolithic sparse matrix for stacked bilinear forms. "
+      "The GIL is released while the sparsity pattern is built.",
+      py::call_guard<py::gil_scoped_release>());
   m.def(
       "create_matrix_nest",
       [](const std::vector<std::vector<const dolfinx::fem::Form<PetscScalar>*>>&
@@ -137,7 +330,9 @@ void fem(py::module& m)
         return _A;
       },
       py::return_value_policy::take_ownership,
-      "Create nested sparse matrix for bilinear forms.");
+      "Create nested sparse matrix for bilinear forms. "
+      "The GIL is released while the sparsity patterns are built.",
+      py::call_guard<py::gil_scoped_release>());
   m.def(
       "create_element_dof_layout",
       [](const std::uintptr_t dofmap, const dolfinx::mesh::CellType cell_type,
@@ -150,11 +345,33 @@ void fem(py::module& m)
   m.def(
       "create_dofmap",
       [](const MPICommWrapper comm, const std::uintptr_t dofmap,
-         dolfinx::mesh::Topology& topology) {
+         dolfinx::mesh::Topology& topology,
+         dolfinx::fem::DofOrdering ordering,
+         const std::vector<std::int32_t>& cell_order) {
         const ufc_dofmap* p = reinterpret_cast<const ufc_dofmap*>(dofmap);
-        return dolfinx::fem::create_dofmap(comm.get(), *p, topology);
+        return dolfinx::fem::create_dofmap(comm.get(), *p, topology, ordering,
+                                           cell_order);
       },
+      py::arg("comm"), py::arg("dofmap"), py::arg("topology"),
+      py::arg("ordering") = dolfinx::fem::DofOrdering::gps,
+      py::arg("cell_order") = std::vector<std::int32_t>(),
       "Create DofMap object from a pointer to ufc_dofmap.");
+  m.def(
+      "create_shared_dofmap",
+      [](const MPICommWrapper comm, const std::uintptr_t dofmap,
+         dolfinx::mesh::Topology& topology,
+         dolfinx::fem::DofOrdering ordering,
+         const std::vector<std::int32_t>& cell_order) {
+        const ufc_dofmap* p = reinterpret_cast<const ufc_dofmap*>(dofmap);
+        return std::const_pointer_cast<dolfinx::fem::DofMap>(
+            dolfinx::fem::create_shared_dofmap(comm.get(), *p, topology,
+                                               ordering, cell_order));
+      },
+      py::arg("comm"), py::arg("dofmap"), py::arg("topology"),
+      py::arg("ordering") = dolfinx::fem::DofOrdering::gps,
+      py::arg("cell_order") = std::vector<std::int32_t>(),
+      "Create DofMap object from a pointer to ufc_dofmap, sharing a DofMap "
+      "with an identical layout on the same topology if one exists.");
   m.def(
       "create_form",
       [](const std::uintptr_t form,
@@ -164,6 +381,23 @@ void fem(py::module& m)
         return dolfinx::fem::create_form<PetscScalar>(*p, spaces);
       },
       "Create Form from a pointer to ufc_form.");
+  m.def(
+      "create_expression",
+      [](const std::uintptr_t expression,
+         const std::vector<
+             std::shared_ptr<const dolfinx::function::Function<PetscScalar>>>&
+             coefficients,
+         const std::vector<
+             std::shared_ptr<const dolfinx::function::Constant<PetscScalar>>>&
+             constants,
+         std::shared_ptr<const dolfinx::mesh::Mesh> mesh) {
+        const ufc_expression* p
+            = reinterpret_cast<const ufc_expression*>(expression);
+        return dolfinx::fem::create_expression<PetscScalar>(*p, coefficients,
+                                                            constants, mesh);
+      },
+      py::arg("expression"), py::arg("coefficients"), py::arg("constants"),
+      py::arg("mesh"), "Create Expression from a pointer to ufc_expression.");
   m.def(
       "create_coordinate_map",
       [](std::uintptr_t cmap) {
@@ -175,13 +409,18 @@ void fem(py::module& m)
   m.def(
       "build_dofmap",
       [](const MPICommWrapper comm, const dolfinx::mesh::Topology& topology,
-         const dolfinx::fem::ElementDofLayout& element_dof_layout) {
+         const dolfinx::fem::ElementDofLayout& element_dof_layout,
+         dolfinx::fem::DofOrdering ordering,
+         const std::vector<std::int32_t>& cell_order) {
         // See https://github.com/pybind/pybind11/issues/1138 on why we need
         // to convert from a std::unique_ptr to a std::shard_ptr
         auto [map, dofmap] = dolfinx::fem::DofMapBuilder::build(
-            comm.get(), topology, element_dof_layout);
+            comm.get(), topology, element_dof_layout, ordering, cell_order);
         return std::pair(map, std::move(dofmap));
       },
+      py::arg("comm"), py::arg("topology"), py::arg("element_dof_layout"),
+      py::arg("ordering") = dolfinx::fem::DofOrdering::gps,
+      py::arg("cell_order") = std::vector<std::int32_t>(),
       "Build and dofmap on a mesh.");
   m.def("transpose_dofmap", &dolfinx::fem::transpose_dofmap,
         "Build the index to (cell, local index) map from a "
@@ -203,7 +442,14 @@ void fem(py::module& m)
                              &dolfinx::fem::FiniteElement::value_rank)
       .def("space_dimension", &dolfinx::fem::FiniteElement::space_dimension)
       .def("value_dimension", &dolfinx::fem::FiniteElement::value_dimension)
-      .def("signature", &dolfinx::fem::FiniteElement::signature);
+      .def("signature", &dolfinx::fem::FiniteElement::signature)
+      .def("pretabulate", &dolfinx::fem::FiniteElement::pretabulate,
+           py::arg("X"), py::arg("order") = 0,
+           "Tabulate the basis at reference points and keep it in the "
+           "tabulation cache")
+      .def("num_tabulations", &dolfinx::fem::FiniteElement::num_tabulations)
+      .def("clear_tabulations",
+           &dolfinx::fem::FiniteElement::clear_tabulations);
 
   // dolfinx::fem::ElementDofLayout
   py::class_<dolfinx::fem::ElementDofLayout,
@@ -236,8 +482,26 @@ void fem(py::module& m)
            py::arg("dofmap"))
       .def_readonly("index_map", &dolfinx::fem::DofMap::index_map)
       .def_readonly("dof_layout", &dolfinx::fem::DofMap::element_dof_layout)
-      .def("cell_dofs", &dolfinx::fem::DofMap::cell_dofs)
-      .def("list", &dolfinx::fem::DofMap::list);
+      .def(
+          "cell_dofs",
+          [](const dolfinx::fem::DofMap& self, int cell) {
+            auto dofs = self.cell_dofs(cell);
+            return Eigen::Map<const Eigen::Array<std::int32_t, Eigen::Dynamic,
+                                                 1>>(dofs.data(), dofs.size());
+          },
+          py::arg("cell"),
+          "Dofs of a cell, as a read-only view that keeps the dofmap alive",
+          py::return_value_policy::reference_internal)
+      .def("list", &dolfinx::fem::DofMap::list,
+           "Dofs of all cells. The list is not copied and keeps the dofmap "
+           "alive.",
+           py::return_value_policy::reference_internal)
+      .def("list_blocked", &dolfinx::fem::DofMap::list_blocked,
+           "Block indices of all cells. The list is not copied and keeps the "
+           "dofmap alive.",
+           py::return_value_policy::reference_internal)
+      .def_property_readonly("bs", &dolfinx::fem::DofMap::bs)
+      .def("memory_usage", &dolfinx::fem::DofMap::memory_usage);
 
   // dolfinx::fem::CoordinateElement
   py::class_<dolfinx::fem::CoordinateElement,
@@ -272,30 +536,295 @@ void fem(py::module& m)
           "function_space",
           &dolfinx::fem::DirichletBC<PetscScalar>::function_space)
       .def_property_readonly("value",
-                             &dolfinx::fem::DirichletBC<PetscScalar>::value);
+                             &dolfinx::fem::DirichletBC<PetscScalar>::value)
+      .def("update", &dolfinx::fem::DirichletBC<PetscScalar>::update,
+           py::arg("f"));
+
+  // dolfinx::fem::SumFactorisedOperator
+  py::class_<dolfinx::fem::SumFactorisedOperator<PetscScalar>,
+             std::shared_ptr<dolfinx::fem::SumFactorisedOperator<PetscScalar>>>(
+      m, "SumFactorisedOperator",
+      "Sum-factorised matrix-free operator for kappa grad(u).grad(v) + "
+      "sigma u v on quadrilaterals and hexahedra")
+      .def(py::init<std::shared_ptr<const dolfinx::function::FunctionSpace>,
+                    double, double, int>(),
+           py::arg("V"), py::arg("kappa"), py::arg("sigma"),
+           py::arg("num_points") = 0)
+      .def_property_readonly(
+          "function_space",
+          &dolfinx::fem::SumFactorisedOperator<PetscScalar>::function_space);
 
   // dolfinx::fem::assemble
   // Functional
-  m.def("assemble_scalar", &dolfinx::fem::assemble_scalar<PetscScalar>,
-        "Assemble functional over mesh");
+  m.def("assemble_scalar",
+        py::overload_cast<const dolfinx::fem::Form<PetscScalar>&>(
+            &dolfinx::fem::assemble_scalar<PetscScalar>),
+        "Assemble functional over mesh. "
+        "The GIL is released during assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_scalar",
+        py::overload_cast<const dolfinx::fem::Form<PetscScalar>&,
+                          const Eigen::Array<PetscScalar, Eigen::Dynamic,
+                                             Eigen::Dynamic, Eigen::RowMajor>&>(
+            &dolfinx::fem::assemble_scalar<PetscScalar>),
+        py::arg("M"), py::arg("coeffs"),
+        "Assemble functional over mesh using packed coefficients. "
+        "The GIL is released during assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_scalar_reproducible",
+        &dolfinx::fem::assemble_scalar_reproducible<PetscScalar>,
+        py::arg("M"),
+        "Assemble functional over mesh and sum the value across processes "
+        "with a reproducible (exact) reduction. "
+        "The GIL is released during assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_scalars",
+        &dolfinx::fem::assemble_scalars<PetscScalar>, py::arg("M"),
+        "Assemble functionals over mesh and sum the values across "
+        "processes. "
+        "The GIL is released during assembly.",
+        py::call_guard<py::gil_scoped_release>());
   // Vector
-  m.def("assemble_vector", &dolfinx::fem::assemble_vector<PetscScalar>,
+  m.def("assemble_vector",
+        py::overload_cast<
+            Eigen::Ref<Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>>,
+            const dolfinx::fem::Form<PetscScalar>&>(
+            &dolfinx::fem::assemble_vector<PetscScalar>),
+        py::arg("b"), py::arg("L"),
+        "Assemble linear form into an existing Eigen vector. "
+        "The GIL is released: b must not be accessed by other threads during "
+        "assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_vector",
+        py::overload_cast<
+            Eigen::Ref<Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>>,
+            const dolfinx::fem::Form<PetscScalar>&,
+            const Eigen::Array<PetscScalar, Eigen::Dynamic, Eigen::Dynamic,
+                               Eigen::RowMajor>&>(
+            &dolfinx::fem::assemble_vector<PetscScalar>),
+        py::arg("b"), py::arg("L"), py::arg("coeffs"),
+        "Assemble linear form into an existing Eigen vector using packed "
+        "coefficients. "
+        "The GIL is released: b must not be accessed by other threads during "
+        "assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_vector",
+        py::overload_cast<dolfinx::la::Vector<PetscScalar>&,
+                          const dolfinx::fem::Form<PetscScalar>&>(
+            &dolfinx::fem::assemble_vector<PetscScalar>),
         py::arg("b"), py::arg("L"),
-        "Assemble linear form into an existing Eigen vector");
+        "Assemble linear form into a distributed vector and accumulate "
+        "ghost contributions, overlapping communication and computation. "
+        "The GIL is released: b must not be accessed by other threads during "
+        "assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_vector",
+        py::overload_cast<
+            dolfinx::la::Vector<PetscScalar>&,
+            const dolfinx::fem::Form<PetscScalar>&,
+            const std::vector<
+                std::shared_ptr<const dolfinx::fem::Form<PetscScalar>>>&,
+            const std::vector<std::vector<std::shared_ptr<
+                const dolfinx::fem::DirichletBC<PetscScalar>>>>&,
+            const std::vector<Eigen::Ref<
+                const Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>>>&,
+            double>(&dolfinx::fem::assemble_vector<PetscScalar>),
+        py::arg("b"), py::arg("L"), py::arg("a"), py::arg("bcs"),
+        py::arg("x0"), py::arg("scale"),
+        "Assemble linear form into a distributed vector with lifting of "
+        "boundary conditions and accumulate ghost contributions, "
+        "overlapping communication and computation. "
+        "The GIL is released: b must not be accessed by other threads during "
+        "assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_vectors",
+        &dolfinx::fem::assemble_vectors<PetscScalar>, py::arg("b"),
+        py::arg("L"),
+        "Assemble linear forms into existing arrays (owned and ghost "
+        "entries), one for each form. The arrays must be contiguous and "
+        "of the scalar type, and are not zeroed before assembly. "
+        "The GIL is released: b must not be accessed by other threads during "
+        "assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "assemble_vectors",
+      [](const std::vector<const dolfinx::fem::Form<PetscScalar>*>& L) {
+        // Allocate the arrays, which are returned without a copy
+        std::vector<py::array_t<PetscScalar>> b;
+        std::vector<Eigen::Ref<Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>>>
+            _b;
+        for (const dolfinx::fem::Form<PetscScalar>* form : L)
+        {
+          std::shared_ptr<const dolfinx::common::IndexMap> map
+              = form->function_spaces().at(0)->dofmap()->index_map;
+          const std::int32_t size
+              = map->block_size() * (map->size_local() + map->num_ghosts());
+          b.emplace_back(size);
+          std::fill_n(b.back().mutable_data(), size, 0.0);
+          _b.emplace_back(
+              Eigen::Map<Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>>(
+                  b.back().mutable_data(), size));
+        }
+
+        {
+          py::gil_scoped_release release;
+          dolfinx::fem::assemble_vectors(_b, L);
+        }
+        return b;
+      },
+      py::arg("L"),
+      "Assemble linear forms into new arrays (owned and ghost entries), "
+      "one for each form. "
+      "The GIL is released during assembly.");
+  // Matrix-free
+  m.def("assemble_action",
+        py::overload_cast<
+            Eigen::Ref<Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>>,
+            const dolfinx::fem::Form<PetscScalar>&,
+            const Eigen::Ref<const Eigen::Matrix<PetscScalar, Eigen::Dynamic,
+                                                 1>>&,
+            const std::vector<std::shared_ptr<
+                const dolfinx::fem::DirichletBC<PetscScalar>>>&>(
+            &dolfinx::fem::assemble_action<PetscScalar>),
+        py::arg("y"), py::arg("a"), py::arg("x"), py::arg("bcs"),
+        "Add the action of a bilinear form on x to an existing Eigen vector. "
+        "The GIL is released: y must not be accessed by other threads during "
+        "assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_action",
+        py::overload_cast<
+            Eigen::Ref<Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>>,
+            const dolfinx::fem::SumFactorisedOperator<PetscScalar>&,
+            const Eigen::Ref<const Eigen::Matrix<PetscScalar, Eigen::Dynamic,
+                                                 1>>&,
+            const std::vector<std::shared_ptr<
+                const dolfinx::fem::DirichletBC<PetscScalar>>>&>(
+            &dolfinx::fem::assemble_action<PetscScalar>),
+        py::arg("y"), py::arg("a"), py::arg("x"), py::arg("bcs"),
+        "Add the action of a sum-factorised operator on x to an existing "
+        "Eigen vector. "
+        "The GIL is released: y must not be accessed by other threads during "
+        "assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_diagonal",
+        py::overload_cast<
+            Eigen::Ref<Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>>,
+            const dolfinx::fem::Form<PetscScalar>&,
+            const std::vector<std::shared_ptr<
+                const dolfinx::fem::DirichletBC<PetscScalar>>>&>(
+            &dolfinx::fem::assemble_diagonal<PetscScalar>),
+        py::arg("d"), py::arg("a"), py::arg("bcs"),
+        "Add the diagonal of a bilinear form to an existing Eigen vector. "
+        "The GIL is released: d must not be accessed by other threads during "
+        "assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_diagonal",
+        py::overload_cast<
+            const dolfinx::fem::Form<PetscScalar>&,
+            dolfinx::la::Vector<PetscScalar>&,
+            const std::vector<std::shared_ptr<
+                const dolfinx::fem::DirichletBC<PetscScalar>>>&>(
+            &dolfinx::fem::assemble_diagonal<PetscScalar>),
+        py::arg("a"), py::arg("d"), py::arg("bcs"),
+        "Add the diagonal of a bilinear form to a distributed vector and "
+        "accumulate ghost contributions. "
+        "The GIL is released: d must not be accessed by other threads during "
+        "assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_lumped",
+        py::overload_cast<
+            Eigen::Ref<Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>>,
+            const dolfinx::fem::Form<PetscScalar>&,
+            const std::vector<std::shared_ptr<
+                const dolfinx::fem::DirichletBC<PetscScalar>>>&>(
+            &dolfinx::fem::assemble_lumped<PetscScalar>),
+        py::arg("d"), py::arg("a"), py::arg("bcs"),
+        "Add the row sums of a bilinear form to an existing Eigen vector. "
+        "The GIL is released: d must not be accessed by other threads during "
+        "assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_lumped",
+        py::overload_cast<
+            const dolfinx::fem::Form<PetscScalar>&,
+            dolfinx::la::Vector<PetscScalar>&,
+            const std::vector<std::shared_ptr<
+                const dolfinx::fem::DirichletBC<PetscScalar>>>&>(
+            &dolfinx::fem::assemble_lumped<PetscScalar>),
+        py::arg("a"), py::arg("d"), py::arg("bcs"),
+        "Add the row sums of a bilinear form to a distributed vector and "
+        "accumulate ghost contributions. "
+        "The GIL is released: d must not be accessed by other threads during "
+        "assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_diagonal",
+        py::overload_cast<
+            Eigen::Ref<Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>>,
+            const dolfinx::fem::SumFactorisedOperator<PetscScalar>&,
+            const std::vector<std::shared_ptr<
+                const dolfinx::fem::DirichletBC<PetscScalar>>>&>(
+            &dolfinx::fem::assemble_diagonal<PetscScalar>),
+        py::arg("d"), py::arg("a"), py::arg("bcs"),
+        "Add the diagonal of a sum-factorised operator to an existing Eigen "
+        "vector. "
+        "The GIL is released: d must not be accessed by other threads during "
+        "assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  // Quadrature data
+  m.def("update_quadrature_data",
+        &dolfinx::fem::update_quadrature_data<PetscScalar>, py::arg("q"),
+        py::arg("form"),
+        "Update quadrature data in place with the cell kernels of a form");
   // Matrices
   m.def("assemble_matrix_petsc",
         [](Mat A, const dolfinx::fem::Form<PetscScalar>& a,
            const std::vector<std::shared_ptr<
                const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs) {
-          dolfinx::fem::assemble_matrix(dolfinx::la::PETScMatrix::add_fn(A), a,
+          dolfinx::fem::assemble_matrix(dolfinx::fem::add_fn_petsc(A, a), a,
                                         bcs);
-        });
+        },
+        "Assemble bilinear form into a PETSc matrix. The GIL is released: A "
+        "must not be accessed by other threads during assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_matrix_petsc",
+        [](Mat A, const dolfinx::fem::Form<PetscScalar>& a,
+           const std::vector<std::shared_ptr<
+               const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs,
+           const Eigen::Array<PetscScalar, Eigen::Dynamic, Eigen::Dynamic,
+                              Eigen::RowMajor>& coeffs) {
+          dolfinx::fem::assemble_matrix(dolfinx::fem::add_fn_petsc(A, a), a,
+                                        bcs, coeffs);
+        },
+        "Assemble bilinear form into a PETSc matrix. The GIL is released: A "
+        "must not be accessed by other threads during assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("assemble_matrix_petsc",
+        [](Mat A, const dolfinx::fem::Form<PetscScalar>& a,
+           const std::vector<std::shared_ptr<
+               const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs,
+           const dolfinx::fem::MatrixPositionMap& map) {
+          dolfinx::fem::assemble_matrix_petsc(A, a, bcs, map);
+        },
+        "Assemble bilinear form into a PETSc matrix. The GIL is released: A "
+        "must not be accessed by other threads during assembly.",
+        py::call_guard<py::gil_scoped_release>());
   m.def("assemble_matrix_petsc",
         [](Mat A, const dolfinx::fem::Form<PetscScalar>& a,
            const std::vector<bool>& rows0, const std::vector<bool>& rows1) {
-          dolfinx::fem::assemble_matrix(dolfinx::la::PETScMatrix::add_fn(A), a,
+          dolfinx::fem::assemble_matrix(dolfinx::fem::add_fn_petsc(A, a), a,
                                         rows0, rows1);
-        });
+        },
+        "Assemble bilinear form into a PETSc matrix. The GIL is released: A "
+        "must not be accessed by other threads during assembly.",
+        py::call_guard<py::gil_scoped_release>());
+  // Systems
+  m.def("assemble_system_petsc", &dolfinx::fem::assemble_system_petsc,
+        py::arg("A"), py::arg("b"), py::arg("a"), py::arg("L"),
+        py::arg("bcs"), py::arg("x0"), py::arg("scale"), py::arg("symmetric"),
+        "Assemble a bilinear and a linear form into a PETSc matrix and "
+        "vector in a single pass with lifting of boundary conditions. "
+        "The GIL is released: A and b must not be accessed by other threads "
+        "during assembly.",
+        py::call_guard<py::gil_scoped_release>());
   m.def("add_diagonal",
         [](Mat A, const dolfinx::function::FunctionSpace& V,
            const std::vector<std::shared_ptr<
@@ -304,18 +833,49 @@ void fem(py::module& m)
           dolfinx::fem::add_diagonal(dolfinx::la::PETScMatrix::add_fn(A), V,
                                      bcs, diagonal);
         });
+  m.def(
+      "assemble_matrix",
+      [](dolfinx::la::MatrixCSR<PetscScalar>& A,
+         const dolfinx::fem::Form<PetscScalar>& a,
+         const std::vector<std::shared_ptr<
+             const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs) {
+        dolfinx::fem::assemble_matrix(A.mat_add_values(), a, bcs);
+      },
+      py::arg("A"), py::arg("a"), py::arg("bcs"),
+      "Assemble bilinear form into a CSR matrix. The GIL is released: A "
+      "must not be accessed by other threads during assembly.",
+      py::call_guard<py::gil_scoped_release>());
+#ifndef PETSC_USE_COMPLEX
+  m.def(
+      "assemble_matrix",
+      [](dolfinx::la::MatrixCSR<float>& A,
+         const dolfinx::fem::Form<PetscScalar>& a,
+         const std::vector<std::shared_ptr<
+             const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs) {
+        dolfinx::fem::assemble_matrix(A.mat_add_values<PetscScalar>(), a,
+                                      bcs);
+      },
+      py::arg("A"), py::arg("a"), py::arg("bcs"),
+      "Assemble bilinear form into a single precision CSR matrix. The "
+      "element matrices are computed in double precision. The GIL is "
+      "released: A must not be accessed by other threads during assembly.",
+      py::call_guard<py::gil_scoped_release>());
+#endif
   m.def("assemble_matrix",
-        py::overload_cast<const std::function<int(
-                              std::int32_t, const std::int32_t*, std::int32_t,
-                              const std::int32_t*, const PetscScalar*)>&,
-                          const dolfinx::fem::Form<PetscScalar>&,
-                          const std::vector<std::shared_ptr<
-                              const dolfinx::fem::DirichletBC<PetscScalar>>>&>(
-            &dolfinx::fem::assemble_matrix<PetscScalar>));
+        [](const std::function<int(std::int32_t, const std::int32_t*,
+                                   std::int32_t, const std::int32_t*,
+                                   const PetscScalar*)>& fin,
+           const dolfinx::fem::Form<PetscScalar>& a,
+           const std::vector<std::shared_ptr<
+               const dolfinx::fem::DirichletBC<PetscScalar>>>& bcs) {
+          dolfinx::fem::assemble_matrix(fin, a, bcs);
+        });
 
   // BC modifiers
   m.def("apply_lifting", &dolfinx::fem::apply_lifting<PetscScalar>,
-        "Modify vector for lifted boundary conditions");
+        "Modify vector for lifted boundary conditions. "
+        "The GIL is released: b must not be accessed by other threads.",
+        py::call_guard<py::gil_scoped_release>());
   m.def(
       "set_bc",
       [](Eigen::Ref<Eigen::Matrix<PetscScalar, Eigen::Dynamic, 1>> b,
@@ -339,19 +899,56 @@ void fem(py::module& m)
   m.def("bcs_rows", &dolfinx::fem::bcs_rows<PetscScalar>);
   m.def("bcs_cols", &dolfinx::fem::bcs_cols<PetscScalar>);
 
-  //   // dolfinx::fem::DiscreteOperators
-  //   py::class_<dolfinx::fem::DiscreteOperators>(m, "DiscreteOperators")
-  //       .def_static(
-  //           "build_gradient",
-  //           [](const dolfinx::function::FunctionSpace& V0,
-  //              const dolfinx::function::FunctionSpace& V1) {
-  //             dolfinx::la::PETScMatrix A
-  //                 = dolfinx::fem::DiscreteOperators::build_gradient(V0, V1);
-  //             Mat _A = A.mat();
-  //             PetscObjectReference((PetscObject)_A);
-  //             return _A;
-  //           },
-  //           py::return_value_policy::take_ownership);
+  // dolfinx::fem::DiscreteOperators
+  py::class_<dolfinx::fem::DiscreteOperators>(m, "DiscreteOperators")
+      .def_static(
+          "build_gradient",
+          [](const dolfinx::function::FunctionSpace& V0,
+             const dolfinx::function::FunctionSpace& V1) {
+            dolfinx::la::PETScMatrix A
+                = dolfinx::fem::DiscreteOperators::build_gradient(V0, V1);
+            Mat _A = A.mat();
+            PetscObjectReference((PetscObject)_A);
+            return _A;
+          },
+          py::return_value_policy::take_ownership)
+      .def_static(
+          "build_interpolation",
+          [](const dolfinx::function::FunctionSpace& V0,
+             const dolfinx::function::FunctionSpace& V1) {
+            dolfinx::la::PETScMatrix A
+                = dolfinx::fem::DiscreteOperators::build_interpolation(V0,
+                                                                       V1);
+            Mat _A = A.mat();
+            PetscObjectReference((PetscObject)_A);
+            return _A;
+          },
+          py::return_value_policy::take_ownership);
+
+  // dolfinx::fem::Expression
+  py::class_<dolfinx::fem::Expression<PetscScalar>,
+             std::shared_ptr<dolfinx::fem::Expression<PetscScalar>>>(
+      m, "Expression", "An expression evaluated at reference points")
+      .def(
+          "eval",
+          [](const dolfinx::fem::Expression<PetscScalar>& self,
+             const Eigen::Ref<const Eigen::Array<std::int32_t, Eigen::Dynamic,
+                                                 1>>& cells) {
+            Eigen::Array<PetscScalar, Eigen::Dynamic, Eigen::Dynamic,
+                         Eigen::RowMajor>
+                values(cells.rows(), self.num_points() * self.value_size());
+            self.eval(cells, values);
+            return values;
+          },
+          py::arg("cells"),
+          "Evaluate the expression at the reference points of cells")
+      .def_property_readonly("x", &dolfinx::fem::Expression<PetscScalar>::x)
+      .def_property_readonly(
+          "num_points", &dolfinx::fem::Expression<PetscScalar>::num_points)
+      .def_property_readonly(
+          "value_size", &dolfinx::fem::Expression<PetscScalar>::value_size)
+      .def_property_readonly("mesh",
+                             &dolfinx::fem::Expression<PetscScalar>::mesh);
 
   // dolfinx::fem::FormIntegrals
   py::class_<dolfinx::fem::FormIntegrals<PetscScalar>,
@@ -410,6 +1007,11 @@ void fem(py::module& m)
            [](dolfinx::fem::Form<PetscScalar>& self, std::size_t i,
               std::shared_ptr<const dolfinx::function::Function<PetscScalar>>
                   f) { self.coefficients().set(i, f); })
+      .def("set_coefficient",
+           [](dolfinx::fem::Form<PetscScalar>& self, std::size_t i,
+              std::shared_ptr<
+                  const dolfinx::function::QuadratureData<PetscScalar>>
+                  q) { self.coefficients().set(i, q); })
       .def("set_constants",
            [](dolfinx::fem::Form<PetscScalar>& self,
               const std::vector<std::shared_ptr<
@@ -430,6 +1032,23 @@ void fem(py::module& m)
                  const std::uint32_t))addr.cast<std::uintptr_t>();
              self.set_tabulate_tensor(type, i, tabulate_tensor_ptr);
            })
+      .def("set_tabulate_tensor_batched",
+           [](dolfinx::fem::Form<PetscScalar>& self,
+              dolfinx::fem::IntegralType type, int i, py::object addr,
+              int batch_size) {
+             auto tabulate_tensor_ptr = (void (*)(
+                 PetscScalar*, const PetscScalar*, const PetscScalar*,
+                 const double*, const int*, const std::uint8_t*,
+                 const std::uint32_t*))addr.cast<std::uintptr_t>();
+             self.set_tabulate_tensor_batched(type, i, tabulate_tensor_ptr,
+                                              batch_size);
+           })
+      .def_property("num_threads",
+                    &dolfinx::fem::Form<PetscScalar>::num_threads,
+                    &dolfinx::fem::Form<PetscScalar>::set_num_threads)
+      .def_property("reuse_cell_tensors",
+                    &dolfinx::fem::Form<PetscScalar>::reuse_cell_tensors,
+                    &dolfinx::fem::Form<PetscScalar>::set_reuse_cell_tensors)
       .def_property_readonly("rank", &dolfinx::fem::Form<PetscScalar>::rank)
       .def_property_readonly("mesh", &dolfinx::fem::Form<PetscScalar>::mesh)
       .def_property_readonly("function_spaces",
@@ -438,6 +1057,7 @@ void fem(py::module& m)
   m.def("locate_dofs_topological", &dolfinx::fem::locate_dofs_topological,
         py::arg("V"), py::arg("dim"), py::arg("entities"),
         py::arg("remote") = true);
-  m.def("locate_dofs_geometrical", &dolfinx::fem::locate_dofs_geometrical);
+  m.def("locate_dofs_geometrical", &dolfinx::fem::locate_dofs_geometrical,
+        py::arg("V"), py::arg("marker"), py::arg("boundary_only") = false);
 }
 } // namespace dolfinx_wrappers
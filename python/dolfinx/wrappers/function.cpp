@@ -11,6 +11,8 @@
 #include <dolfinx/function/Constant.h>
 #include <dolfinx/function/Function.h>
 #include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/function/PointEvaluator.h>
+#include <dolfinx/function/QuadratureData.h>
 #include <dolfinx/function/interpolate.h>
 #include <dolfinx/geometry/BoundingBoxTree.h>
 #include <dolfinx/la/PETScVector.h>
@@ -39,6 +41,11 @@ void function(py::module& m)
            "Create a function on the given function space")
       .def(py::init<std::shared_ptr<dolfinx::function::FunctionSpace>,
                     std::shared_ptr<dolfinx::la::Vector<PetscScalar>>>())
+      .def(py::init<
+               std::shared_ptr<const dolfinx::function::FunctionSpace>,
+               dolfinx::la::VectorPool<dolfinx::la::Vector<PetscScalar>>&>(),
+           py::arg("V"), py::arg("pool"),
+           "Create a function with a vector from a pool")
       .def_readwrite("name", &dolfinx::function::Function<PetscScalar>::name)
       .def_property_readonly("id",
                              &dolfinx::function::Function<PetscScalar>::id)
@@ -46,6 +53,10 @@ void function(py::module& m)
            "Return sub-function (view into parent Function")
       .def("collapse", &dolfinx::function::Function<PetscScalar>::collapse,
            "Collapse sub-function view")
+      .def("collapsed_view",
+           &dolfinx::function::Function<PetscScalar>::collapsed_view,
+           "View of the coefficients of a sub-function in the order of the "
+           "collapsed space")
       .def("interpolate",
            py::overload_cast<const std::function<Eigen::Array<
                PetscScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>(
@@ -57,6 +68,15 @@ void function(py::module& m)
            py::overload_cast<const dolfinx::function::Function<PetscScalar>&>(
                &dolfinx::function::Function<PetscScalar>::interpolate),
            py::arg("u"), "Interpolate a finite element function")
+      .def(
+          "interpolate",
+          [](dolfinx::function::Function<PetscScalar>& self,
+             const dolfinx::function::Function<PetscScalar>& u,
+             dolfinx::function::PointEvaluator& evaluator) {
+            dolfinx::function::interpolate(self, u, evaluator);
+          },
+          py::arg("u"), py::arg("evaluator"),
+          "Interpolate a finite element function on another mesh")
       .def(
           "interpolate_ptr",
           [](dolfinx::function::Function<PetscScalar>& self,
@@ -86,7 +106,12 @@ void function(py::module& m)
           "Return the vector associated with the finite element Function")
       .def("eval", &dolfinx::function::Function<PetscScalar>::eval,
            py::arg("x"), py::arg("cells"), py::arg("values"),
-           "Evaluate Function")
+           "Evaluate Function at points, grouped by cell. x (float64, shape "
+           "(num_points, 3)) and cells (int32) are used without a copy if "
+           "they are contiguous, and values must be a contiguous array of "
+           "the scalar type. The GIL is released: the arrays must not be "
+           "accessed by other threads during the evaluation.",
+           py::call_guard<py::gil_scoped_release>())
       .def("compute_point_values",
            &dolfinx::function::Function<PetscScalar>::compute_point_values,
            "Compute values at all mesh points")
@@ -106,6 +131,12 @@ void function(py::module& m)
       .def("__eq__", &dolfinx::function::FunctionSpace::operator==)
       .def_property_readonly("dim", &dolfinx::function::FunctionSpace::dim)
       .def("collapse", &dolfinx::function::FunctionSpace::collapse)
+      .def("collapsed",
+           [](const dolfinx::function::FunctionSpace& self) {
+             auto [V, dofs] = self.collapsed();
+             return std::pair(V, py::array_t<std::int32_t>(dofs->size(),
+                                                           dofs->data()));
+           })
       .def("component", &dolfinx::function::FunctionSpace::component)
       .def("contains", &dolfinx::function::FunctionSpace::contains)
       .def_property_readonly("element",
@@ -114,6 +145,7 @@ void function(py::module& m)
       .def_property_readonly("dofmap",
                              &dolfinx::function::FunctionSpace::dofmap)
       .def("sub", &dolfinx::function::FunctionSpace::sub)
+      .def("memory_usage", &dolfinx::function::FunctionSpace::memory_usage)
       .def("tabulate_dof_coordinates",
            &dolfinx::function::FunctionSpace::tabulate_dof_coordinates);
 
@@ -129,5 +161,62 @@ void function(py::module& m)
             return py::array(self.shape, self.value.data(), py::none());
           },
           py::return_value_policy::reference_internal);
+
+  // dolfinx::function::QuadratureData
+  py::class_<dolfinx::function::QuadratureData<PetscScalar>,
+             std::shared_ptr<dolfinx::function::QuadratureData<PetscScalar>>>(
+      m, "QuadratureData", "Data at the quadrature points of mesh cells")
+      .def(py::init<std::shared_ptr<const dolfinx::mesh::Mesh>, int, int,
+                    PetscScalar>(),
+           py::arg("mesh"), py::arg("num_points"), py::arg("value_size"),
+           py::arg("value") = PetscScalar(0))
+      .def_property_readonly(
+          "mesh", &dolfinx::function::QuadratureData<PetscScalar>::mesh)
+      .def_property_readonly(
+          "num_points",
+          &dolfinx::function::QuadratureData<PetscScalar>::num_points)
+      .def_property_readonly(
+          "value_size",
+          &dolfinx::function::QuadratureData<PetscScalar>::value_size)
+      .def_property_readonly(
+          "version", &dolfinx::function::QuadratureData<PetscScalar>::version)
+      .def(
+          "values",
+          [](dolfinx::function::QuadratureData<PetscScalar>& self) {
+            auto& values = self.values();
+            return py::array_t<PetscScalar>(
+                {values.rows(), values.cols()}, values.data(), py::none());
+          },
+          py::return_value_policy::reference_internal,
+          "Return the values (cell, point * value_size + component). The "
+          "modification counter is increased by each call, so the array "
+          "should not be kept for modifications after assembly.")
+      .def("scatter_fwd",
+           &dolfinx::function::QuadratureData<PetscScalar>::scatter_fwd);
+
+  // dolfinx::function::PointEvaluator
+  py::class_<dolfinx::function::PointEvaluator,
+             std::shared_ptr<dolfinx::function::PointEvaluator>>(
+      m, "PointEvaluator", "Parallel evaluation of functions at points")
+      .def(py::init<std::shared_ptr<const dolfinx::mesh::Mesh>>(),
+           py::arg("mesh"))
+      .def("set_points", &dolfinx::function::PointEvaluator::set_points,
+           py::arg("x"))
+      .def_property_readonly("mesh",
+                             &dolfinx::function::PointEvaluator::mesh)
+      .def_property_readonly("num_points",
+                             &dolfinx::function::PointEvaluator::num_points)
+      .def_property_readonly("found",
+                             &dolfinx::function::PointEvaluator::found)
+      .def("eval", &dolfinx::function::PointEvaluator::eval<PetscScalar>,
+           py::arg("u"));
+
+  m.def("create_interpolation_evaluator",
+        &dolfinx::function::create_interpolation_evaluator, py::arg("V"),
+        py::arg("mesh"),
+        "Create a point evaluator for interpolation from another mesh");
+  m.def("eval_distributed",
+        &dolfinx::function::eval_distributed<PetscScalar>, py::arg("u"),
+        py::arg("x"), "Evaluate a function at points in parallel");
 }
 } // namespace dolfinx_wrappers
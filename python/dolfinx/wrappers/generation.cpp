@@ -18,6 +18,7 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <string>
+#include <vector>
 
 namespace py = pybind11;
 
@@ -39,7 +40,17 @@ void generation(py::module& m)
                 comm.get(), n, p, element, ghost_mode);
           },
           py::arg("comm"), py::arg("n"), py::arg("p"), py::arg("element"),
-          py::arg("ghost_mode"));
+          py::arg("ghost_mode"))
+      .def_static(
+          "create",
+          [](const MPICommWrapper comm, const std::vector<double>& x,
+             const dolfinx::fem::CoordinateElement& element,
+             dolfinx::mesh::GhostMode ghost_mode) {
+            return dolfinx::generation::IntervalMesh::create(
+                comm.get(), x, element, ghost_mode);
+          },
+          py::arg("comm"), py::arg("x"), py::arg("element"),
+          py::arg("ghost_mode"), "Create an interval mesh with given nodes");
 
   // dolfinx::RectangleMesh
   py::class_<dolfinx::generation::RectangleMesh,
@@ -50,12 +61,14 @@ void generation(py::module& m)
           [](const MPICommWrapper comm, std::array<Eigen::Vector3d, 2> p,
              std::array<std::size_t, 2> n,
              const dolfinx::fem::CoordinateElement& element,
-             dolfinx::mesh::GhostMode ghost_mode, std::string diagonal) {
+             dolfinx::mesh::GhostMode ghost_mode, std::string diagonal,
+             bool structured) {
             return dolfinx::generation::RectangleMesh::create(
-                comm.get(), p, n, element, ghost_mode, diagonal);
+                comm.get(), p, n, element, ghost_mode, diagonal, structured);
           },
           py::arg("comm"), py::arg("p"), py::arg("n"), py::arg("element"),
-          py::arg("ghost_mode"), py::arg("diagonal") = "right");
+          py::arg("ghost_mode"), py::arg("diagonal") = "right",
+          py::arg("structured") = false);
 
   // dolfinx::BoxMesh
   py::class_<dolfinx::generation::BoxMesh,
@@ -65,11 +78,11 @@ void generation(py::module& m)
           [](const MPICommWrapper comm, std::array<Eigen::Vector3d, 2> p,
              std::array<std::size_t, 3> n,
              const dolfinx::fem::CoordinateElement& element,
-             const dolfinx::mesh::GhostMode ghost_mode) {
-            return dolfinx::generation::BoxMesh::create(comm.get(), p, n,
-                                                        element, ghost_mode);
+             const dolfinx::mesh::GhostMode ghost_mode, bool structured) {
+            return dolfinx::generation::BoxMesh::create(
+                comm.get(), p, n, element, ghost_mode, structured);
           },
           py::arg("comm"), py::arg("p"), py::arg("n"), py::arg("element"),
-          py::arg("ghost_mode"));
+          py::arg("ghost_mode"), py::arg("structured") = false);
 }
 } // namespace dolfinx_wrappers
@@ -4,20 +4,62 @@
 //
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
+#include "MPICommWrapper.h"
+#include "caster_mpi.h"
 #include <Eigen/Dense>
+#include <array>
 #include <dolfinx/geometry/BoundingBoxTree.h>
+#include <dolfinx/geometry/CompactBoundingBoxTree.h>
+#include <dolfinx/geometry/DistributedCollisions.h>
 #include <dolfinx/geometry/GJK.h>
 #include <dolfinx/geometry/utils.h>
+#include <dolfinx/graph/AdjacencyList.h>
 #include <dolfinx/mesh/Mesh.h>
+#include <limits>
 #include <memory>
 #include <pybind11/eigen.h>
 #include <pybind11/numpy.h>
 #include <pybind11/operators.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <stdexcept>
+#include <vector>
 
 namespace py = pybind11;
 
+namespace
+{
+using ArrayXXd_RM
+    = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+// Compute the GJK distances of pairs of bodies with N points and with
+// m points
+template <int N>
+Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>
+compute_distances_gjk(const ArrayXXd_RM& p, const ArrayXXd_RM& q, int m,
+                      const std::vector<std::array<int, 2>>& pairs,
+                      double max_distance, int num_threads)
+{
+  switch (m)
+  {
+  case 2:
+    return dolfinx::geometry::compute_distances_gjk<N, 2>(
+        p, q, pairs, max_distance, num_threads);
+  case 3:
+    return dolfinx::geometry::compute_distances_gjk<N, 3>(
+        p, q, pairs, max_distance, num_threads);
+  case 4:
+    return dolfinx::geometry::compute_distances_gjk<N, 4>(
+        p, q, pairs, max_distance, num_threads);
+  case 8:
+    return dolfinx::geometry::compute_distances_gjk<N, 8>(
+        p, q, pairs, max_distance, num_threads);
+  default:
+    throw std::runtime_error("Unsupported number of points of the bodies.");
+  }
+}
+} // namespace
+
 namespace dolfinx_wrappers
 {
 void geometry(py::module& m)
@@ -43,24 +85,173 @@ void geometry(py::module& m)
           return std::make_pair(std::move(entities), std::move(distance));
         });
 
+  m.def("compute_closest_points", &dolfinx::geometry::compute_closest_points,
+        py::arg("tree"), py::arg("points"), py::arg("k") = 1,
+        py::arg("num_threads") = 1,
+        "The GIL is released.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("compute_closest_entities",
+        &dolfinx::geometry::compute_closest_entities, py::arg("tree"),
+        py::arg("mesh"), py::arg("points"), py::arg("k") = 1,
+        py::arg("num_threads") = 1,
+        "The GIL is released.",
+        py::call_guard<py::gil_scoped_release>());
+
   m.def("compute_collisions_point",
         py::overload_cast<const dolfinx::geometry::BoundingBoxTree&,
                           const Eigen::Vector3d&>(
             &dolfinx::geometry::compute_collisions));
+  m.def("compute_collisions_points",
+        py::overload_cast<const dolfinx::geometry::BoundingBoxTree&,
+                          const Eigen::Ref<const Eigen::Array<
+                              double, Eigen::Dynamic, 3, Eigen::RowMajor>>&,
+                          int>(&dolfinx::geometry::compute_collisions),
+        py::arg("tree"), py::arg("points"), py::arg("num_threads") = 1,
+        "The GIL is released: points must not be modified by other threads "
+        "during the search.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("compute_collisions_point",
+        py::overload_cast<const dolfinx::geometry::CompactBoundingBoxTree&,
+                          const Eigen::Vector3d&>(
+            &dolfinx::geometry::compute_collisions));
+  m.def("compute_collisions_points",
+        py::overload_cast<const dolfinx::geometry::CompactBoundingBoxTree&,
+                          const Eigen::Ref<const Eigen::Array<
+                              double, Eigen::Dynamic, 3, Eigen::RowMajor>>&,
+                          int>(&dolfinx::geometry::compute_collisions),
+        py::arg("tree"), py::arg("points"), py::arg("num_threads") = 1,
+        "The GIL is released: points must not be modified by other threads "
+        "during the search.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("compute_process_collisions",
+        &dolfinx::geometry::compute_process_collisions);
   m.def("compute_collisions",
         py::overload_cast<const dolfinx::geometry::BoundingBoxTree&,
                           const dolfinx::geometry::BoundingBoxTree&>(
-            &dolfinx::geometry::compute_collisions));
+            &dolfinx::geometry::compute_collisions),
+        "Compute the colliding pairs of bounding boxes of two trees. The GIL "
+        "is released.",
+        py::call_guard<py::gil_scoped_release>());
 
-  m.def("compute_distance_gjk", &dolfinx::geometry::compute_distance_gjk);
+  m.def("compute_distance_gjk", &dolfinx::geometry::compute_distance_gjk,
+        py::arg("p"), py::arg("q"),
+        py::arg("max_distance") = std::numeric_limits<double>::infinity());
+  m.def(
+      "compute_distances_gjk",
+      [](const ArrayXXd_RM& p, const ArrayXXd_RM& q,
+         const std::vector<std::array<int, 2>>& pairs, double max_distance,
+         int num_threads) {
+        if (p.cols() % 3 != 0 or q.cols() % 3 != 0)
+          throw std::runtime_error("Wrong shape of the points of the bodies.");
+        const int m = q.cols() / 3;
+        switch (p.cols() / 3)
+        {
+        case 2:
+          return compute_distances_gjk<2>(p, q, m, pairs, max_distance,
+                                          num_threads);
+        case 3:
+          return compute_distances_gjk<3>(p, q, m, pairs, max_distance,
+                                          num_threads);
+        case 4:
+          return compute_distances_gjk<4>(p, q, m, pairs, max_distance,
+                                          num_threads);
+        case 8:
+          return compute_distances_gjk<8>(p, q, m, pairs, max_distance,
+                                          num_threads);
+        default:
+          throw std::runtime_error(
+              "Unsupported number of points of the bodies.");
+        }
+      },
+      py::arg("p"), py::arg("q"), py::arg("pairs"),
+      py::arg("max_distance") = std::numeric_limits<double>::infinity(),
+      py::arg("num_threads") = 1,
+      "Compute the GJK distances of pairs of bodies with 2, 3, 4 or 8 "
+      "points each. The GIL is released.",
+      py::call_guard<py::gil_scoped_release>());
   m.def("squared_distance", &dolfinx::geometry::squared_distance);
-  m.def("select_colliding_cells", &dolfinx::geometry::select_colliding_cells);
+  m.def("select_colliding_cells",
+        py::overload_cast<const dolfinx::mesh::Mesh&, const std::vector<int>&,
+                          const Eigen::Vector3d&, int, double>(
+            &dolfinx::geometry::select_colliding_cells),
+        py::arg("mesh"), py::arg("candidate_cells"), py::arg("point"),
+        py::arg("n"), py::arg("tol") = 1e-10);
+  m.def("select_colliding_cells",
+        py::overload_cast<
+            const dolfinx::mesh::Mesh&,
+            const dolfinx::graph::AdjacencyList<std::int32_t>&,
+            const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, 3,
+                                                Eigen::RowMajor>>&,
+            int, double, int>(&dolfinx::geometry::select_colliding_cells),
+        py::arg("mesh"), py::arg("candidate_cells"), py::arg("points"),
+        py::arg("n"), py::arg("tol") = 1e-10, py::arg("num_threads") = 1,
+        "Select the colliding cells of a batch of points from their "
+        "candidate cells. The GIL is released: points must not be modified "
+        "by other threads during the search.",
+        py::call_guard<py::gil_scoped_release>());
+
+  // dolfinx::geometry::BuildMethod enums
+  py::enum_<dolfinx::geometry::BuildMethod>(m, "BuildMethod")
+      .value("median", dolfinx::geometry::BuildMethod::median)
+      .value("sah", dolfinx::geometry::BuildMethod::sah)
+      .value("linear", dolfinx::geometry::BuildMethod::linear);
 
   // dolfinx::geometry::BoundingBoxTree
   py::class_<dolfinx::geometry::BoundingBoxTree,
              std::shared_ptr<dolfinx::geometry::BoundingBoxTree>>(
       m, "BoundingBoxTree")
-      .def(py::init<const dolfinx::mesh::Mesh&, int>())
-      .def(py::init<const std::vector<Eigen::Vector3d>&>());
+      .def(py::init<const dolfinx::mesh::Mesh&, int, int,
+                    dolfinx::geometry::BuildMethod, bool, bool>(),
+           py::arg("mesh"), py::arg("tdim"), py::arg("num_threads") = 1,
+           py::arg("method") = dolfinx::geometry::BuildMethod::median,
+           py::arg("neighbour_processes") = false,
+           py::arg("shared_memory") = false,
+           "Build a tree of the entities of a mesh. The GIL is released: the "
+           "mesh must not be modified by other threads during the build.",
+           py::call_guard<py::gil_scoped_release>())
+      .def(py::init<const std::vector<Eigen::Vector3d>&, int>(),
+           py::arg("points"), py::arg("num_threads") = 1)
+      .def(py::init<const Eigen::Array<double, Eigen::Dynamic, 3,
+                                       Eigen::RowMajor>&,
+                    int>(),
+           py::arg("leaf_bboxes"), py::arg("num_threads") = 1)
+      .def("refit", &dolfinx::geometry::BoundingBoxTree::refit,
+           py::arg("mesh"), py::arg("rebuild_factor") = 0.0,
+           py::arg("num_threads") = 1,
+           "Refit the tree to the moved entities of a mesh. The GIL is "
+           "released: the mesh must not be modified by other threads during "
+           "the refit.",
+           py::call_guard<py::gil_scoped_release>())
+      .def("sah_cost", &dolfinx::geometry::BoundingBoxTree::sah_cost);
+
+  // dolfinx::geometry::DistributedCollisions
+  py::class_<dolfinx::geometry::DistributedCollisions,
+             std::shared_ptr<dolfinx::geometry::DistributedCollisions>>(
+      m, "DistributedCollisions")
+      .def(py::init([](const MPICommWrapper comm) {
+             return std::make_shared<dolfinx::geometry::DistributedCollisions>(
+                 comm.get());
+           }),
+           py::arg("comm"))
+      .def("compute", &dolfinx::geometry::DistributedCollisions::compute,
+           py::arg("tree0"), py::arg("tree1"),
+           "Compute the collisions of a tree and the trees of the other "
+           "processes (collective). The GIL is released.",
+           py::call_guard<py::gil_scoped_release>())
+      .def_property_readonly(
+          "destinations",
+          &dolfinx::geometry::DistributedCollisions::destinations)
+      .def_property_readonly(
+          "sources", &dolfinx::geometry::DistributedCollisions::sources);
+
+  // dolfinx::geometry::CompactBoundingBoxTree
+  py::class_<dolfinx::geometry::CompactBoundingBoxTree,
+             std::shared_ptr<dolfinx::geometry::CompactBoundingBoxTree>>(
+      m, "CompactBoundingBoxTree")
+      .def(py::init<const dolfinx::geometry::BoundingBoxTree&>())
+      .def_property_readonly(
+          "num_nodes", &dolfinx::geometry::CompactBoundingBoxTree::num_nodes)
+      .def_property_readonly("bytes",
+                             &dolfinx::geometry::CompactBoundingBoxTree::bytes);
 }
 } // namespace dolfinx_wrappers
@@ -31,15 +31,23 @@ void declare_adjacency_list(py::module& m, std::string type)
       .def(
           "links",
           [](const dolfinx::graph::AdjacencyList<T>& self, int i) {
-            return self.links(i);
+            // Return a map, which is cast to a view of the links rather
+            // than a copy as for a segment
+            auto links = self.links(i);
+            return Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>(
+                links.data(), links.size());
           },
-          "Links (edges) of a node",
+          "Links (edges) of a node, as a read-only view that keeps the list "
+          "alive",
           py::return_value_policy::reference_internal)
       .def_property_readonly("array", &dolfinx::graph::AdjacencyList<T>::array,
+                             "Links of all nodes, as a read-only view that "
+                             "keeps the list alive",
                              py::return_value_policy::reference_internal)
       .def_property_readonly("offsets",
                              &dolfinx::graph::AdjacencyList<T>::offsets,
-                             "Index to each node in the links array",
+                             "Index to each node in the links array, as a "
+                             "read-only view that keeps the list alive",
                              py::return_value_policy::reference_internal)
       .def_property_readonly("num_nodes",
                              &dolfinx::graph::AdjacencyList<T>::num_nodes)
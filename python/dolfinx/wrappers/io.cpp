@@ -8,13 +8,22 @@
 #include "caster_petsc.h"
 #include <dolfinx/function/Function.h>
 #include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/function/QuadratureData.h>
+#include <dolfinx/io/ADIOS2Writer.h>
+#include <dolfinx/io/AsyncXDMFFile.h>
 #include <dolfinx/io/VTKFile.h>
+#include <dolfinx/io/VTKWriter.h>
 #include <dolfinx/io/XDMFFile.h>
 #include <dolfinx/io/cells.h>
+#include <dolfinx/io/binary_mesh.h>
+#include <dolfinx/io/checkpoint.h>
+#include <dolfinx/io/partition_cache.h>
+#include <dolfinx/io/quadrature_data.h>
 #include <dolfinx/io/xdmf_utils.h>
 #include <dolfinx/la/PETScVector.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
+#include <map>
 #include <memory>
 #include <pybind11/eigen.h>
 #include <pybind11/numpy.h>
@@ -48,6 +57,111 @@ void io(py::module& m)
               mesh, entity_dim, entities, vals);
         });
 
+  m.def(
+      "cell_destinations",
+      [](const MPICommWrapper comm, const std::string& filename,
+         const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
+         const dolfinx::fem::CoordinateElement& element,
+         const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+                            Eigen::RowMajor>& x,
+         dolfinx::mesh::CellPartitioner partitioner) {
+        return dolfinx::io::partition_cache::cell_destinations(
+            comm.get(), filename, cells, element, x, partitioner);
+      },
+      py::arg("comm"), py::arg("filename"), py::arg("cells"),
+      py::arg("element"), py::arg("x"),
+      py::arg("partitioner") = dolfinx::mesh::CellPartitioner::graph,
+      "Read cell destinations from a partition file, or compute and write "
+      "them.");
+
+  m.def(
+      "write_quadrature_data",
+      [](const MPICommWrapper comm, const std::string& filename,
+         const std::string& name,
+         const dolfinx::function::QuadratureData<PetscScalar>& q,
+         const std::string& mode) {
+        dolfinx::io::quadrature_data::write(comm.get(), filename, name, q,
+                                            mode);
+      },
+      py::arg("comm"), py::arg("filename"), py::arg("name"), py::arg("q"),
+      py::arg("mode") = "w", "Write quadrature data to a HDF5 file.");
+  m.def(
+      "read_quadrature_data",
+      [](const MPICommWrapper comm, const std::string& filename,
+         const std::string& name,
+         dolfinx::function::QuadratureData<PetscScalar>& q) {
+        dolfinx::io::quadrature_data::read(comm.get(), filename, name, q);
+      },
+      py::arg("comm"), py::arg("filename"), py::arg("name"), py::arg("q"),
+      "Read quadrature data from a HDF5 file.");
+
+  // dolfinx::io::checkpoint
+  m.def("write_checkpoint_mesh", &dolfinx::io::checkpoint::write_mesh,
+        py::arg("filename"), py::arg("mesh"),
+        "Write a mesh to a new checkpoint file. "
+        "The GIL is released.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "read_checkpoint_mesh",
+      [](const MPICommWrapper comm, const std::string& filename,
+         const dolfinx::fem::CoordinateElement& element,
+         dolfinx::mesh::GhostMode ghost_mode) {
+        return dolfinx::io::checkpoint::read_mesh(comm.get(), filename,
+                                                  element, ghost_mode);
+      },
+      py::arg("comm"), py::arg("filename"), py::arg("element"),
+      py::arg("ghost_mode"),
+      "Read a mesh and the original index of its cells from a checkpoint "
+      "file. The GIL is released.",
+      py::call_guard<py::gil_scoped_release>());
+  m.def("write_checkpoint_function", &dolfinx::io::checkpoint::write_function,
+        py::arg("filename"), py::arg("u"), py::arg("name"),
+        "Write a function to a checkpoint file. "
+        "The GIL is released: u must not be modified by other threads while "
+        "it is written.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def("read_checkpoint_function", &dolfinx::io::checkpoint::read_function,
+        py::arg("filename"), py::arg("u"), py::arg("name"),
+        py::arg("original_cell_index"),
+        "Read the coefficients of a function from a checkpoint file. "
+        "The GIL is released: u must not be accessed by other threads while "
+        "it is read.",
+        py::call_guard<py::gil_scoped_release>());
+
+  // dolfinx::io::binary_mesh
+  m.def("write_binary_mesh", &dolfinx::io::binary_mesh::write_mesh,
+        py::arg("filename"), py::arg("mesh"),
+        "Write a mesh to a native binary mesh file. "
+        "The GIL is released.",
+        py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "read_binary_mesh",
+      [](const MPICommWrapper comm, const std::string& filename,
+         const dolfinx::fem::CoordinateElement& element,
+         dolfinx::mesh::GhostMode ghost_mode) {
+        return dolfinx::io::binary_mesh::read_mesh(comm.get(), filename,
+                                                   element, ghost_mode);
+      },
+      py::arg("comm"), py::arg("filename"), py::arg("element"),
+      py::arg("ghost_mode"),
+      "Read a mesh from a native binary mesh file. The GIL is released.",
+      py::call_guard<py::gil_scoped_release>());
+
+  // dolfinx::io::HDF5Properties
+  py::class_<dolfinx::io::HDF5Properties>(m, "HDF5Properties",
+                                          "HDF5 dataset and file properties")
+      .def(py::init<>())
+      .def_readwrite("chunk_size", &dolfinx::io::HDF5Properties::chunk_size)
+      .def_readwrite("deflate", &dolfinx::io::HDF5Properties::deflate)
+      .def_readwrite("shuffle", &dolfinx::io::HDF5Properties::shuffle)
+      .def_readwrite("alignment", &dolfinx::io::HDF5Properties::alignment)
+      .def_readwrite("alignment_threshold",
+                     &dolfinx::io::HDF5Properties::alignment_threshold)
+      .def_readwrite("mpi_hints", &dolfinx::io::HDF5Properties::mpi_hints)
+      .def_readwrite("collective", &dolfinx::io::HDF5Properties::collective)
+      .def_readwrite("aggregation",
+                     &dolfinx::io::HDF5Properties::aggregation);
+
   // dolfinx::io::XDMFFile
   py::class_<dolfinx::io::XDMFFile, std::shared_ptr<dolfinx::io::XDMFFile>>
       xdmf_file(m, "XDMFFile");
@@ -60,12 +174,14 @@ void io(py::module& m)
   xdmf_file
       .def(py::init([](const MPICommWrapper comm, const std::string filename,
                        const std::string file_mode,
-                       dolfinx::io::XDMFFile::Encoding encoding) {
+                       dolfinx::io::XDMFFile::Encoding encoding,
+                       const dolfinx::io::HDF5Properties& properties) {
              return std::make_unique<dolfinx::io::XDMFFile>(
-                 comm.get(), filename, file_mode, encoding);
+                 comm.get(), filename, file_mode, encoding, properties);
            }),
            py::arg("comm"), py::arg("filename"), py::arg("file_mode"),
-           py::arg("encoding") = dolfinx::io::XDMFFile::Encoding::HDF5)
+           py::arg("encoding") = dolfinx::io::XDMFFile::Encoding::HDF5,
+           py::arg("properties") = dolfinx::io::HDF5Properties())
       .def("__enter__",
            [](std::shared_ptr<dolfinx::io::XDMFFile>& self) { return self; })
       .def("__exit__",
@@ -73,24 +189,43 @@ void io(py::module& m)
               py::object exc_value, py::object traceback) { self.close(); })
       .def("close", &dolfinx::io::XDMFFile::close)
       .def("write_mesh", &dolfinx::io::XDMFFile::write_mesh, py::arg("mesh"),
-           py::arg("xpath") = "/Xdmf/Domain")
+           py::arg("xpath") = "/Xdmf/Domain",
+           "Write a mesh (collective). The GIL is released: the mesh must not "
+           "be modified by other threads while it is written.",
+           py::call_guard<py::gil_scoped_release>())
       .def("write_geometry", &dolfinx::io::XDMFFile::write_geometry,
            py::arg("geometry"), py::arg("name") = "geometry",
-           py::arg("xpath") = "/Xdmf/Domain")
+           py::arg("xpath") = "/Xdmf/Domain",
+           "Write a geometry (collective). The GIL is released.",
+           py::call_guard<py::gil_scoped_release>())
       .def("read_topology_data", &dolfinx::io::XDMFFile::read_topology_data,
-           py::arg("name") = "mesh", py::arg("xpath") = "/Xdmf/Domain")
+           py::arg("name") = "mesh", py::arg("xpath") = "/Xdmf/Domain",
+           "Read the topology data (collective). The GIL is released.",
+           py::call_guard<py::gil_scoped_release>())
       .def("read_geometry_data", &dolfinx::io::XDMFFile::read_geometry_data,
-           py::arg("name") = "mesh", py::arg("xpath") = "/Xdmf/Domain")
+           py::arg("name") = "mesh", py::arg("xpath") = "/Xdmf/Domain",
+           "Read the geometry data (collective). The GIL is released.",
+           py::call_guard<py::gil_scoped_release>())
       .def("read_cell_type", &dolfinx::io::XDMFFile::read_cell_type,
            py::arg("name") = "mesh", py::arg("xpath") = "/Xdmf/Domain")
-      .def("write_function", &dolfinx::io::XDMFFile::write_function,
-           py::arg("function"), py::arg("t"), py::arg("mesh_xpath"))
+      .def("write_function",
+           py::overload_cast<const dolfinx::function::Function<PetscScalar>&,
+                             double, std::string>(
+               &dolfinx::io::XDMFFile::write_function),
+           py::arg("function"), py::arg("t"), py::arg("mesh_xpath"),
+           "Write a function (collective). The GIL is released: the function "
+           "must not be modified by other threads while it is written.",
+           py::call_guard<py::gil_scoped_release>())
       .def("write_meshtags", &dolfinx::io::XDMFFile::write_meshtags,
            py::arg("meshtags"),
            py::arg("geometry_xpath") = "/Xdmf/Domain/Grid/Geometry",
-           py::arg("xpath") = "/Xdmf/Domain")
+           py::arg("xpath") = "/Xdmf/Domain",
+           "Write mesh tags (collective). The GIL is released.",
+           py::call_guard<py::gil_scoped_release>())
       .def("read_meshtags", &dolfinx::io::XDMFFile::read_meshtags,
-           py::arg("mesh"), py::arg("name"), py::arg("xpath") = "/Xdmf/Domain")
+           py::arg("mesh"), py::arg("name"), py::arg("xpath") = "/Xdmf/Domain",
+           "Read mesh tags (collective). The GIL is released.",
+           py::call_guard<py::gil_scoped_release>())
       .def("write_information", &dolfinx::io::XDMFFile::write_information,
            py::arg("name"), py::arg("value"), py::arg("xpath") = "/Xdmf/Domain")
       .def("read_information", &dolfinx::io::XDMFFile::read_information,
@@ -99,15 +234,74 @@ void io(py::module& m)
         return MPICommWrapper(self.comm());
       });
 
+  // dolfinx::io::AsyncXDMFFile
+  py::class_<dolfinx::io::AsyncXDMFFile,
+             std::shared_ptr<dolfinx::io::AsyncXDMFFile>>(m, "AsyncXDMFFile")
+      .def(py::init([](const MPICommWrapper comm, const std::string filename,
+                       const std::string file_mode,
+                       dolfinx::io::XDMFFile::Encoding encoding,
+                       const dolfinx::io::HDF5Properties& properties,
+                       std::size_t max_queue_size) {
+             return std::make_unique<dolfinx::io::AsyncXDMFFile>(
+                 comm.get(), filename, file_mode, encoding, properties,
+                 max_queue_size);
+           }),
+           py::arg("comm"), py::arg("filename"), py::arg("file_mode"),
+           py::arg("encoding") = dolfinx::io::XDMFFile::Encoding::HDF5,
+           py::arg("properties") = dolfinx::io::HDF5Properties(),
+           py::arg("max_queue_size") = 2)
+      .def("__enter__",
+           [](std::shared_ptr<dolfinx::io::AsyncXDMFFile>& self) {
+             return self;
+           })
+      .def("__exit__",
+           [](dolfinx::io::AsyncXDMFFile& self, py::object exc_type,
+              py::object exc_value, py::object traceback) { self.close(); })
+      .def("close", &dolfinx::io::AsyncXDMFFile::close,
+           "Wait until the queued writes are done and close the file. The GIL "
+           "is released while waiting.",
+           py::call_guard<py::gil_scoped_release>())
+      .def("flush", &dolfinx::io::AsyncXDMFFile::flush,
+           "Wait until the queued writes are done. The GIL is released while "
+           "waiting.",
+           py::call_guard<py::gil_scoped_release>())
+      .def("write_mesh", &dolfinx::io::AsyncXDMFFile::write_mesh,
+           py::arg("mesh"), py::arg("xpath") = "/Xdmf/Domain",
+           "Queue a copy of a mesh for writing (collective). The GIL is "
+           "released while the mesh is copied and while waiting for space in "
+           "the queue.",
+           py::call_guard<py::gil_scoped_release>())
+      .def("write_function", &dolfinx::io::AsyncXDMFFile::write_function,
+           py::arg("function"), py::arg("t"),
+           "Queue a copy of a function for writing (collective). The GIL is "
+           "released while the function is copied and while waiting for space "
+           "in the queue.",
+           py::call_guard<py::gil_scoped_release>())
+      .def_property_readonly("max_queue_size",
+                             &dolfinx::io::AsyncXDMFFile::max_queue_size)
+      .def("comm", [](dolfinx::io::AsyncXDMFFile& self) {
+        return MPICommWrapper(self.comm());
+      });
+
   // dolfinx::io::VTKFile
   py::class_<dolfinx::io::VTKFile, std::shared_ptr<dolfinx::io::VTKFile>>
       vtk_file(m, "VTKFile");
 
+  py::enum_<dolfinx::io::VTKWriter::Encoding>(vtk_file, "Encoding")
+      .value("ascii", dolfinx::io::VTKWriter::Encoding::ascii)
+      .value("base64", dolfinx::io::VTKWriter::Encoding::base64)
+      .value("raw", dolfinx::io::VTKWriter::Encoding::raw);
+
   vtk_file
-      .def(py::init([](std::string filename) {
-             return std::make_unique<dolfinx::io::VTKFile>(filename);
+      .def(py::init([](std::string filename,
+                       dolfinx::io::VTKWriter::Encoding encoding,
+                       bool compress) {
+             return std::make_unique<dolfinx::io::VTKFile>(filename, encoding,
+                                                           compress);
            }),
-           py::arg("filename"))
+           py::arg("filename"),
+           py::arg("encoding") = dolfinx::io::VTKWriter::Encoding::ascii,
+           py::arg("compress") = false)
       .def("write",
            py::overload_cast<const dolfinx::function::Function<PetscScalar>&>(
                &dolfinx::io::VTKFile::write),
@@ -116,5 +310,44 @@ void io(py::module& m)
            py::overload_cast<const dolfinx::mesh::Mesh&>(
                &dolfinx::io::VTKFile::write),
            py::arg("mesh"));
+
+#ifdef HAS_ADIOS2
+  // dolfinx::io::ADIOS2Writer
+  py::class_<dolfinx::io::ADIOS2Writer,
+             std::shared_ptr<dolfinx::io::ADIOS2Writer>>(m, "ADIOS2Writer")
+      .def(py::init([](const MPICommWrapper comm, const std::string& filename,
+                       std::shared_ptr<const dolfinx::mesh::Mesh> mesh,
+                       const std::string& engine, int num_aggregators,
+                       bool async,
+                       const std::map<std::string, std::string>& parameters) {
+             return std::make_unique<dolfinx::io::ADIOS2Writer>(
+                 comm.get(), filename, mesh, engine, num_aggregators, async,
+                 parameters);
+           }),
+           py::arg("comm"), py::arg("filename"), py::arg("mesh"),
+           py::arg("engine") = "BP4", py::arg("num_aggregators") = 0,
+           py::arg("async_write") = false,
+           py::arg("parameters") = std::map<std::string, std::string>())
+      .def(py::init(
+               [](const MPICommWrapper comm, const std::string& filename,
+                  const std::vector<std::shared_ptr<
+                      const dolfinx::function::Function<PetscScalar>>>& u,
+                  const std::string& engine, int num_aggregators, bool async,
+                  const std::map<std::string, std::string>& parameters) {
+                 return std::make_unique<dolfinx::io::ADIOS2Writer>(
+                     comm.get(), filename, u, engine, num_aggregators, async,
+                     parameters);
+               }),
+           py::arg("comm"), py::arg("filename"), py::arg("u"),
+           py::arg("engine") = "BP4", py::arg("num_aggregators") = 0,
+           py::arg("async_write") = false,
+           py::arg("parameters") = std::map<std::string, std::string>())
+      .def("write", &dolfinx::io::ADIOS2Writer::write, py::arg("t"),
+           "Write a step (collective). The GIL is released: the data must not "
+           "be modified by other threads while it is written, or until the "
+           "next write or close with asynchronous output.",
+           py::call_guard<py::gil_scoped_release>())
+      .def("close", &dolfinx::io::ADIOS2Writer::close);
+#endif
 }
 } // namespace dolfinx_wrappers
@@ -7,10 +7,13 @@
 #include "caster_mpi.h"
 #include "caster_petsc.h"
 #include <dolfinx/common/IndexMap.h>
+#include <dolfinx/la/MatrixCSR.h>
+#include <dolfinx/la/PETScKrylovSolver.h>
 #include <dolfinx/la/PETScMatrix.h>
 #include <dolfinx/la/PETScVector.h>
 #include <dolfinx/la/SparsityPattern.h>
 #include <dolfinx/la/Vector.h>
+#include <dolfinx/la/VectorPool.h>
 #include <dolfinx/la/VectorSpaceBasis.h>
 #include <dolfinx/la/utils.h>
 #include <memory>
@@ -24,6 +27,20 @@
 
 namespace py = pybind11;
 
+namespace
+{
+// Copy the values of the diagonal and off-diagonal blocks of the owned
+// rows of a CSR matrix
+template <typename T>
+py::tuple csr_values(const dolfinx::la::MatrixCSR<T>& A)
+{
+  const std::vector<T>& v0 = A.diagonal().values;
+  const std::vector<T>& v1 = A.off_diagonal().values;
+  return py::make_tuple(py::array_t<T>(v0.size(), v0.data()),
+                        py::array_t<T>(v1.size(), v1.data()));
+}
+} // namespace
+
 namespace dolfinx_wrappers
 {
 
@@ -36,9 +53,12 @@ void la(py::module& m)
       .def(py::init(
           [](const MPICommWrapper comm,
              std::array<std::shared_ptr<const dolfinx::common::IndexMap>, 2>
-                 index_maps) {
-            return dolfinx::la::SparsityPattern(comm.get(), index_maps);
-          }))
+                 index_maps,
+             bool blocked) {
+            return dolfinx::la::SparsityPattern(comm.get(), index_maps,
+                                                blocked);
+          }),
+          py::arg("comm"), py::arg("index_maps"), py::arg("blocked") = false)
       .def(py::init(
           [](const MPICommWrapper comm,
              const std::vector<std::vector<const dolfinx::la::SparsityPattern*>>
@@ -51,8 +71,11 @@ void la(py::module& m)
           }))
       .def("local_range", &dolfinx::la::SparsityPattern::local_range)
       .def("index_map", &dolfinx::la::SparsityPattern::index_map)
-      .def("assemble", &dolfinx::la::SparsityPattern::assemble)
+      .def_property_readonly("blocked", &dolfinx::la::SparsityPattern::blocked)
+      .def("assemble",
+           py::overload_cast<>(&dolfinx::la::SparsityPattern::assemble))
       .def("num_nonzeros", &dolfinx::la::SparsityPattern::num_nonzeros)
+      .def("memory_usage", &dolfinx::la::SparsityPattern::memory_usage)
       .def("insert", &dolfinx::la::SparsityPattern::insert)
       .def("insert_diagonal", &dolfinx::la::SparsityPattern::insert_diagonal)
       .def_property_readonly("diagonal_pattern",
@@ -61,7 +84,10 @@ void la(py::module& m)
       .def_property_readonly(
           "off_diagonal_pattern",
           &dolfinx::la::SparsityPattern::off_diagonal_pattern,
-          py::return_value_policy::reference_internal);
+          py::return_value_policy::reference_internal)
+      .def_property_readonly("ghost_pattern",
+                             &dolfinx::la::SparsityPattern::ghost_pattern,
+                             py::return_value_policy::reference_internal);
 
   // dolfinx::la::VectorSpaceBasis
   py::class_<dolfinx::la::VectorSpaceBasis,
@@ -84,7 +110,7 @@ void la(py::module& m)
            py::arg("A"), py::arg("tol") = 1.0e-10)
       .def("orthogonalize", &dolfinx::la::VectorSpaceBasis::orthogonalize)
       .def("orthonormalize", &dolfinx::la::VectorSpaceBasis::orthonormalize,
-           py::arg("tol") = 1.0e-10)
+           py::arg("tol") = 1.0e-10, py::arg("reorthogonalize") = true)
       .def("dim", &dolfinx::la::VectorSpaceBasis::dim)
       .def("__getitem__", [](const dolfinx::la::VectorSpaceBasis& self, int i) {
         return self[i]->vec();
@@ -96,6 +122,88 @@ void la(py::module& m)
       .def("array",
            py::overload_cast<>(&dolfinx::la::Vector<PetscScalar>::array));
 
+  // dolfinx::la::VectorPool
+  py::class_<dolfinx::la::VectorPool<dolfinx::la::Vector<PetscScalar>>,
+             std::shared_ptr<
+                 dolfinx::la::VectorPool<dolfinx::la::Vector<PetscScalar>>>>(
+      m, "VectorPool", "Pool for recycling vectors")
+      .def(py::init<std::size_t>(), py::arg("max_size") = 8)
+      .def("get",
+           &dolfinx::la::VectorPool<dolfinx::la::Vector<PetscScalar>>::get,
+           py::arg("map"))
+      .def("clear",
+           &dolfinx::la::VectorPool<dolfinx::la::Vector<PetscScalar>>::clear)
+      .def_property_readonly(
+          "size",
+          &dolfinx::la::VectorPool<dolfinx::la::Vector<PetscScalar>>::size)
+      .def_property_readonly(
+          "max_size",
+          &dolfinx::la::VectorPool<
+              dolfinx::la::Vector<PetscScalar>>::max_size);
+
+  // dolfinx::la::VectorView
+  py::class_<dolfinx::la::VectorView<PetscScalar>,
+             std::shared_ptr<dolfinx::la::VectorView<PetscScalar>>>(
+      m, "VectorView", "Non-owning view of entries of a vector")
+      .def_property_readonly("vector",
+                             &dolfinx::la::VectorView<PetscScalar>::vector)
+      .def_property_readonly(
+          "indices",
+          [](const dolfinx::la::VectorView<PetscScalar>& self) {
+            const std::vector<std::int32_t>& indices = self.indices();
+            return py::array_t<std::int32_t>(indices.size(), indices.data());
+          })
+      .def_property_readonly("size",
+                             &dolfinx::la::VectorView<PetscScalar>::size)
+      .def_property_readonly("stride",
+                             &dolfinx::la::VectorView<PetscScalar>::stride)
+      .def("array", &dolfinx::la::VectorView<PetscScalar>::array,
+           "Copy the entries of the view")
+      .def("set", &dolfinx::la::VectorView<PetscScalar>::set, py::arg("y"),
+           "Set the entries of the view");
+
+  // dolfinx::la::MatrixCSR
+  py::class_<dolfinx::la::MatrixCSR<PetscScalar>,
+             std::shared_ptr<dolfinx::la::MatrixCSR<PetscScalar>>>(
+      m, "MatrixCSR", "Distributed CSR matrix")
+      .def(py::init<const dolfinx::la::SparsityPattern&>(),
+           py::arg("pattern"))
+      .def("set",
+           py::overload_cast<PetscScalar>(
+               &dolfinx::la::MatrixCSR<PetscScalar>::set),
+           py::arg("x"))
+      .def("finalize", &dolfinx::la::MatrixCSR<PetscScalar>::finalize)
+      .def("mult", &dolfinx::la::MatrixCSR<PetscScalar>::mult, py::arg("x"),
+           py::arg("y"), py::arg("num_threads") = 1)
+      .def(
+          "to_petsc",
+          [](dolfinx::la::MatrixCSR<PetscScalar>& self,
+             const MPICommWrapper comm) {
+            return dolfinx::la::create_petsc_matrix(comm.get(), self);
+          },
+          py::return_value_policy::take_ownership,
+          "Create a PETSc Mat that uses the values of the matrix. The "
+          "matrix must outlive the PETSc Mat.")
+      .def("values", [](const dolfinx::la::MatrixCSR<PetscScalar>& self) {
+        return csr_values(self);
+      });
+
+#ifndef PETSC_USE_COMPLEX
+  // dolfinx::la::MatrixCSR (single precision, e.g. for preconditioners)
+  py::class_<dolfinx::la::MatrixCSR<float>,
+             std::shared_ptr<dolfinx::la::MatrixCSR<float>>>(
+      m, "MatrixCSR_float32", "Distributed single precision CSR matrix")
+      .def(py::init<const dolfinx::la::SparsityPattern&>(),
+           py::arg("pattern"))
+      .def("set",
+           py::overload_cast<float>(&dolfinx::la::MatrixCSR<float>::set),
+           py::arg("x"))
+      .def("finalize", &dolfinx::la::MatrixCSR<float>::finalize)
+      .def("values", [](const dolfinx::la::MatrixCSR<float>& self) {
+        return csr_values(self);
+      });
+#endif
+
   // utils
   m.def("create_vector",
         py::overload_cast<const dolfinx::common::IndexMap&>(
@@ -111,6 +219,27 @@ void la(py::module& m)
                                                 ghost_indices, block_size);
       },
       py::return_value_policy::take_ownership, "Create a PETSc Vec.");
+  m.def(
+      "scatter_forward",
+      [](const dolfinx::common::IndexMap& map, Vec x) {
+        dolfinx::common::IndexMap::ScatterRequest<PetscScalar> request;
+        dolfinx::la::scatter_fwd(map, x, request);
+      },
+      py::arg("map"), py::arg("x"),
+      "Update the ghost entries of a ghosted Vec with the scatter of an "
+      "index map.");
+  m.def(
+      "scatter_reverse",
+      [](const dolfinx::common::IndexMap& map, Vec x, bool add) {
+        dolfinx::common::IndexMap::ScatterRequest<PetscScalar> request;
+        dolfinx::la::scatter_rev(map, x,
+                                 add ? dolfinx::common::IndexMap::Mode::add
+                                     : dolfinx::common::IndexMap::Mode::insert,
+                                 request);
+      },
+      py::arg("map"), py::arg("x"), py::arg("add") = true,
+      "Sum (or set) the ghost entries of a ghosted Vec in the owned "
+      "entries with the scatter of an index map.");
   m.def(
       "create_matrix",
       [](const MPICommWrapper comm, const dolfinx::la::SparsityPattern& p) {
@@ -118,8 +247,107 @@ void la(py::module& m)
       },
       py::return_value_policy::take_ownership,
       "Create a PETSc Mat from sparsity pattern.");
+  m.def("set_fast_reassembly", &dolfinx::la::set_fast_reassembly,
+        py::arg("A"),
+        "Reuse the off-process communication pattern of the next assembly "
+        "of an assembled matrix for all later assemblies.");
+  py::enum_<dolfinx::la::PETScKrylovSolver::PreconditionerReuse>(
+      m, "PreconditionerReuse")
+      .value("none", dolfinx::la::PETScKrylovSolver::PreconditionerReuse::none)
+      .value("structure",
+             dolfinx::la::PETScKrylovSolver::PreconditionerReuse::structure)
+      .value("full", dolfinx::la::PETScKrylovSolver::PreconditionerReuse::full);
+  m.def(
+      "set_preconditioner_reuse",
+      [](KSP ksp,
+         dolfinx::la::PETScKrylovSolver::PreconditionerReuse reuse) {
+        dolfinx::la::PETScKrylovSolver(ksp, true).set_preconditioner_reuse(
+            reuse);
+      },
+      py::arg("ksp"), py::arg("reuse"),
+      "Set the reuse of the preconditioner of a KSP when the operators "
+      "change.");
+  py::enum_<dolfinx::la::PETScKrylovSolver::PipelinedMethod>(
+      m, "PipelinedMethod")
+      .value("cg", dolfinx::la::PETScKrylovSolver::PipelinedMethod::cg)
+      .value("cr", dolfinx::la::PETScKrylovSolver::PipelinedMethod::cr)
+      .value("gmres", dolfinx::la::PETScKrylovSolver::PipelinedMethod::gmres)
+      .value("fgmres", dolfinx::la::PETScKrylovSolver::PipelinedMethod::fgmres)
+      .value("bcgs", dolfinx::la::PETScKrylovSolver::PipelinedMethod::bcgs)
+      .value("gropp", dolfinx::la::PETScKrylovSolver::PipelinedMethod::gropp);
+  m.def(
+      "set_pipelined",
+      [](KSP ksp, dolfinx::la::PETScKrylovSolver::PipelinedMethod method,
+         int restart) {
+        dolfinx::la::PETScKrylovSolver(ksp, true).set_pipelined(method,
+                                                                restart);
+      },
+      py::arg("ksp"), py::arg("method"), py::arg("restart") = 30,
+      "Use a pipelined (communication hiding) Krylov method for a KSP.");
   m.def("create_petsc_index_sets", &dolfinx::la::create_petsc_index_sets,
         py::return_value_policy::take_ownership);
+  m.def(
+      "create_petsc_fieldsplit_index_sets",
+      [](const MPICommWrapper comm,
+         const std::vector<const dolfinx::common::IndexMap*>& maps) {
+        return dolfinx::la::create_petsc_fieldsplit_index_sets(comm.get(),
+                                                               maps);
+      },
+      py::return_value_policy::take_ownership,
+      "Create the global index sets of the fields of a block or nested "
+      "matrix.");
+  py::enum_<dolfinx::la::PETScKrylovSolver::FieldSplitType>(m,
+                                                            "FieldSplitType")
+      .value("additive",
+             dolfinx::la::PETScKrylovSolver::FieldSplitType::additive)
+      .value("multiplicative",
+             dolfinx::la::PETScKrylovSolver::FieldSplitType::multiplicative)
+      .value("symmetric_multiplicative",
+             dolfinx::la::PETScKrylovSolver::FieldSplitType::
+                 symmetric_multiplicative)
+      .value("schur", dolfinx::la::PETScKrylovSolver::FieldSplitType::schur);
+  py::enum_<dolfinx::la::PETScKrylovSolver::SchurFactorization>(
+      m, "SchurFactorization")
+      .value("diag", dolfinx::la::PETScKrylovSolver::SchurFactorization::diag)
+      .value("lower",
+             dolfinx::la::PETScKrylovSolver::SchurFactorization::lower)
+      .value("upper",
+             dolfinx::la::PETScKrylovSolver::SchurFactorization::upper)
+      .value("full", dolfinx::la::PETScKrylovSolver::SchurFactorization::full);
+  py::enum_<dolfinx::la::PETScKrylovSolver::SchurPreconditioner>(
+      m, "SchurPreconditioner")
+      .value("self", dolfinx::la::PETScKrylovSolver::SchurPreconditioner::self)
+      .value("selfp",
+             dolfinx::la::PETScKrylovSolver::SchurPreconditioner::selfp)
+      .value("a11", dolfinx::la::PETScKrylovSolver::SchurPreconditioner::a11)
+      .value("user", dolfinx::la::PETScKrylovSolver::SchurPreconditioner::user)
+      .value("full",
+             dolfinx::la::PETScKrylovSolver::SchurPreconditioner::full);
+  m.def(
+      "set_fieldsplit",
+      [](KSP ksp, const std::vector<const dolfinx::common::IndexMap*>& maps,
+         dolfinx::la::PETScKrylovSolver::FieldSplitType type,
+         const std::vector<std::string>& names) {
+        dolfinx::la::PETScKrylovSolver(ksp, true).set_fieldsplit(maps, type,
+                                                                 names);
+      },
+      py::arg("ksp"), py::arg("maps"),
+      py::arg("type")
+      = dolfinx::la::PETScKrylovSolver::FieldSplitType::additive,
+      py::arg("names") = std::vector<std::string>(),
+      "Use a field split preconditioner for a KSP with the fields of a list "
+      "of index maps.");
+  m.def(
+      "set_schur_complement",
+      [](KSP ksp,
+         dolfinx::la::PETScKrylovSolver::SchurFactorization factorization,
+         dolfinx::la::PETScKrylovSolver::SchurPreconditioner pre, Mat S) {
+        dolfinx::la::PETScKrylovSolver(ksp, true).set_schur_complement(
+            factorization, pre, S);
+      },
+      py::arg("ksp"), py::arg("factorization"), py::arg("pre"),
+      py::arg("S") = py::none(),
+      "Use a Schur complement field split preconditioner for a KSP.");
   m.def("scatter_local_vectors", &dolfinx::la::scatter_local_vectors,
         "Scatter the (ordered) list of sub vectors into a block vector.");
   m.def("get_local_vectors", &dolfinx::la::get_local_vectors,
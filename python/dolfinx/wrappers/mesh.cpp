@@ -51,6 +51,15 @@ void declare_meshtags(py::module& m, std::string type)
       .def_property_readonly("dim", &dolfinx::mesh::MeshTags<T>::dim)
       .def_property_readonly("mesh", &dolfinx::mesh::MeshTags<T>::mesh)
       .def("ufl_id", &dolfinx::mesh::MeshTags<T>::id)
+      .def("find", &dolfinx::mesh::MeshTags<T>::find, py::arg("value"))
+      .def("find_entity", &dolfinx::mesh::MeshTags<T>::find_entity,
+           py::arg("entity"))
+      .def_property_readonly(
+          "unique_values",
+          [](const dolfinx::mesh::MeshTags<T>& self) {
+            const std::vector<T>& values = self.unique_values();
+            return py::array_t<T>(values.size(), values.data());
+          })
       .def_property_readonly(
           "values",
           [](dolfinx::mesh::MeshTags<T>& self) {
@@ -111,6 +120,33 @@ void mesh(py::module& m)
   m.def("midpoints", &dolfinx::mesh::midpoints);
   m.def("compute_boundary_facets", &dolfinx::mesh::compute_boundary_facets);
 
+  // dolfinx::mesh::CellPartitioner enums (registered before use as a
+  // default argument)
+  py::enum_<dolfinx::mesh::CellPartitioner>(m, "CellPartitioner")
+      .value("graph", dolfinx::mesh::CellPartitioner::graph)
+      .value("hilbert", dolfinx::mesh::CellPartitioner::hilbert)
+      .value("hierarchical", dolfinx::mesh::CellPartitioner::hierarchical);
+
+  m.def(
+      "create_mesh",
+      [](const MPICommWrapper comm,
+         const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
+         const dolfinx::fem::CoordinateElement& element,
+         const Eigen::Ref<const Eigen::Array<
+             double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>& x,
+         dolfinx::mesh::GhostMode ghost_mode, bool reorder_cells,
+         dolfinx::mesh::CellPartitioner partitioner) {
+        return dolfinx::mesh::create_mesh(comm.get(), cells, element, x,
+                                          ghost_mode, reorder_cells,
+                                          partitioner);
+      },
+      py::arg("comm"), py::arg("cells"), py::arg("element"), py::arg("x"),
+      py::arg("ghost_mode"), py::arg("reorder_cells") = false,
+      py::arg("partitioner") = dolfinx::mesh::CellPartitioner::graph,
+      "Helper function for creating meshes. "
+      "The GIL is released: x must not be modified by other threads while the "
+      "mesh is created.",
+      py::call_guard<py::gil_scoped_release>());
   m.def(
       "create_mesh",
       [](const MPICommWrapper comm,
@@ -118,11 +154,37 @@ void mesh(py::module& m)
          const dolfinx::fem::CoordinateElement& element,
          const Eigen::Ref<const Eigen::Array<
              double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>& x,
-         dolfinx::mesh::GhostMode ghost_mode) {
+         dolfinx::mesh::GhostMode ghost_mode,
+         const dolfinx::graph::AdjacencyList<std::int32_t>& dest,
+         bool reorder_cells) {
         return dolfinx::mesh::create_mesh(comm.get(), cells, element, x,
-                                          ghost_mode);
+                                          ghost_mode, dest, reorder_cells);
       },
-      "Helper function for creating meshes.");
+      py::arg("comm"), py::arg("cells"), py::arg("element"), py::arg("x"),
+      py::arg("ghost_mode"), py::arg("dest"), py::arg("reorder_cells") = false,
+      "Create a mesh with given cell destination processes. "
+      "The GIL is released: x must not be modified by other threads while the "
+      "mesh is created.",
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "compute_cell_destinations",
+      [](const MPICommWrapper comm,
+         const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
+         const dolfinx::fem::CoordinateElement& element,
+         const Eigen::Ref<const Eigen::Array<
+             double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>& x,
+         dolfinx::mesh::CellPartitioner partitioner,
+         const std::vector<std::int32_t>& weights, int num_ghost_layers) {
+        return dolfinx::mesh::compute_cell_destinations(
+            comm.get(), cells, element, x, partitioner, weights,
+            num_ghost_layers);
+      },
+      py::arg("comm"), py::arg("cells"), py::arg("element"), py::arg("x"),
+      py::arg("partitioner") = dolfinx::mesh::CellPartitioner::graph,
+      py::arg("weights") = std::vector<std::int32_t>(),
+      py::arg("num_ghost_layers") = 1,
+      "Compute the destination processes of cells, with num_ghost_layers "
+      "layers of ghost cells.");
 
   // dolfinx::mesh::GhostMode enums
   py::enum_<dolfinx::mesh::GhostMode>(m, "GhostMode")
@@ -141,22 +203,68 @@ void mesh(py::module& m)
                     const std::vector<std::int64_t>&>())
       .def_property_readonly("dim", &dolfinx::mesh::Geometry::dim,
                              "Geometric dimension")
-      .def_property_readonly("dofmap", &dolfinx::mesh::Geometry::dofmap)
+      .def_property_readonly("dofmap", &dolfinx::mesh::Geometry::dofmap,
+                             "The dofmap of the cells. The list is not copied "
+                             "and keeps the geometry alive.")
       .def("index_map", &dolfinx::mesh::Geometry::index_map)
+      .def("memory_usage", &dolfinx::mesh::Geometry::memory_usage)
       .def_property(
           "x", py::overload_cast<>(&dolfinx::mesh::Geometry::x),
           [](dolfinx::mesh::Geometry& self,
-             const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
-                                Eigen::RowMajor>& values) {
-            self.x() = values;
+             const Eigen::Ref<const Eigen::Array<
+                 double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>&
+                 values) {
+            // Assign in place, such that views of the coordinates remain
+            // valid
+            auto& x = self.x();
+            if (values.rows() != x.rows() or values.cols() != x.cols())
+            {
+              throw std::runtime_error(
+                  "Coordinate array has wrong shape. It must not change the "
+                  "number of points.");
+            }
+            x = values;
           },
           py::return_value_policy::reference_internal,
-          "Return coordinates of all geometry points. Each row is the "
-          "coordinate of a point.")
+          "Coordinates of all geometry points, as a writable view (not a "
+          "copy) that keeps the geometry alive. Each row is the coordinate "
+          "of a point. Getting the view marks the coordinates as modified, "
+          "which invalidates the caches of data computed from them. Call "
+          "x_changed after writing through a view that is kept.")
+      .def(
+          "x_changed",
+          [](dolfinx::mesh::Geometry& self) { self.x(); },
+          "Mark the coordinates as modified, e.g. after writing through a "
+          "view of x that was obtained earlier, such that the caches of "
+          "data computed from the coordinates are invalidated.")
+      .def_property_readonly("x_version",
+                             &dolfinx::mesh::Geometry::x_version,
+                             "Counter of the modifications of the "
+                             "coordinates")
       .def_property_readonly("cmap", &dolfinx::mesh::Geometry::cmap,
                              "The coordinate map")
       .def_property_readonly("input_global_indices",
-                             &dolfinx::mesh::Geometry::input_global_indices);
+                             &dolfinx::mesh::Geometry::input_global_indices)
+      .def("clear_input_global_indices",
+           &dolfinx::mesh::Geometry::clear_input_global_indices,
+           "Release the storage of the input global indices")
+      .def(
+          "compact_x",
+          [](const dolfinx::mesh::Geometry& self, bool single_precision)
+              -> py::object {
+            if (single_precision)
+              return py::cast(self.compact_x<float>());
+            else
+              return py::cast(self.compact_x<double>());
+          },
+          py::arg("single_precision") = false,
+          "Copy of the coordinates with gdim components per node, in "
+          "double or single precision")
+      .def("set_cell_coordinates_cache",
+           &dolfinx::mesh::Geometry::set_cell_coordinates_cache,
+           py::arg("enable"),
+           "Enable or disable the cache of packed cell coordinates used in "
+           "assembly. The cache is invalidated when x is accessed.");
 
   // dolfinx::mesh::TopologyComputation
   m.def("compute_entities", [](const MPICommWrapper comm,
@@ -177,12 +285,26 @@ void mesh(py::module& m)
       }))
       .def("set_connectivity", &dolfinx::mesh::Topology::set_connectivity)
       .def("set_index_map", &dolfinx::mesh::Topology::set_index_map)
-      .def("create_entities", &dolfinx::mesh::Topology::create_entities)
+      .def("create_entities", &dolfinx::mesh::Topology::create_entities,
+           "Create entities of a dimension (collective). The GIL is released.",
+           py::call_guard<py::gil_scoped_release>())
       .def("create_entity_permutations",
            &dolfinx::mesh::Topology::create_entity_permutations)
-      .def("create_connectivity", &dolfinx::mesh::Topology::create_connectivity)
+      .def("create_cell_permutation_info",
+           &dolfinx::mesh::Topology::create_cell_permutation_info)
+      .def("create_facet_permutations",
+           &dolfinx::mesh::Topology::create_facet_permutations)
+      .def("create_connectivity", &dolfinx::mesh::Topology::create_connectivity,
+           py::arg("d0"), py::arg("d1"), py::arg("num_threads") = 1,
+           "Create the connectivity between two dimensions (collective). The "
+           "GIL is released.",
+           py::call_guard<py::gil_scoped_release>())
       .def("create_connectivity_all",
-           &dolfinx::mesh::Topology::create_connectivity_all)
+           &dolfinx::mesh::Topology::create_connectivity_all,
+           py::arg("num_threads") = 1,
+           "Create all entities and connectivities (collective). The GIL is "
+           "released.",
+           py::call_guard<py::gil_scoped_release>())
       .def("get_facet_permutations",
            &dolfinx::mesh::Topology::get_facet_permutations)
       .def("get_cell_permutation_info",
@@ -194,6 +316,20 @@ void mesh(py::module& m)
                                        py::const_))
       .def("hash", &dolfinx::mesh::Topology::hash)
       .def("index_map", &dolfinx::mesh::Topology::index_map)
+      .def("memory_usage", &dolfinx::mesh::Topology::memory_usage)
+      .def("exterior_facets",
+           [](const dolfinx::mesh::Topology& self) {
+             const std::vector<std::int32_t>& facets = self.exterior_facets();
+             return py::array_t<std::int32_t>(facets.size(), facets.data());
+           })
+      .def("is_derived_connectivity",
+           &dolfinx::mesh::Topology::is_derived_connectivity)
+      .def("release_connectivity",
+           &dolfinx::mesh::Topology::release_connectivity)
+      .def("release_derived_connectivity",
+           &dolfinx::mesh::Topology::release_derived_connectivity)
+      .def("set_connectivity_budget",
+           &dolfinx::mesh::Topology::set_connectivity_budget)
       .def_property_readonly("cell_type", &dolfinx::mesh::Topology::cell_type)
       .def("cell_name",
            [](const dolfinx::mesh::Topology& self) {
@@ -243,10 +379,67 @@ void mesh(py::module& m)
         [](const MPICommWrapper comm, int nparts,
            dolfinx::mesh::CellType cell_type,
            const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
-           dolfinx::mesh::GhostMode ghost_mode) {
+           dolfinx::mesh::GhostMode ghost_mode,
+           const std::vector<std::int32_t>& weights) {
           return dolfinx::mesh::Partitioning::partition_cells(
-              comm.get(), nparts, cell_type, cells, ghost_mode);
-        });
+              comm.get(), nparts, cell_type, cells, ghost_mode, weights);
+        },
+        py::arg("comm"), py::arg("nparts"), py::arg("cell_type"),
+        py::arg("cells"), py::arg("ghost_mode"),
+        py::arg("weights") = std::vector<std::int32_t>());
+  m.def(
+      "compute_ghost_layers",
+      [](const MPICommWrapper comm, dolfinx::mesh::CellType cell_type,
+         const dolfinx::graph::AdjacencyList<std::int64_t>& cells,
+         const dolfinx::graph::AdjacencyList<std::int32_t>& dest,
+         int num_layers) {
+        return dolfinx::mesh::Partitioning::compute_ghost_layers(
+            comm.get(), cell_type, cells, dest, num_layers);
+      },
+      py::arg("comm"), py::arg("cell_type"), py::arg("cells"),
+      py::arg("dest"), py::arg("num_layers"),
+      "Add layers of ghost processes to cell destinations.");
+  m.def("compute_hilbert_order",
+        &dolfinx::mesh::Partitioning::compute_hilbert_order,
+        py::arg("midpoints"),
+        "Compute the order of points along a Hilbert curve.");
+
+  m.def(
+      "rebalance",
+      [](const dolfinx::mesh::Mesh& mesh,
+         const std::vector<std::int32_t>& weights,
+         dolfinx::mesh::GhostMode ghost_mode,
+         dolfinx::mesh::CellPartitioner partitioner) {
+        py::gil_scoped_release release;
+        auto [mesh_new, original_cell_index]
+            = dolfinx::mesh::rebalance(mesh, weights, ghost_mode, partitioner);
+        py::gil_scoped_acquire acquire;
+        return std::pair(std::move(mesh_new),
+                         py::array_t<std::int64_t>(original_cell_index.size(),
+                                                   original_cell_index.data()));
+      },
+      py::arg("mesh"), py::arg("weights"), py::arg("ghost_mode"),
+      py::arg("partitioner") = dolfinx::mesh::CellPartitioner::graph,
+      "Redistribute a mesh with a weighted partition (collective). The GIL is "
+      "released while the mesh is redistributed.");
+
+  m.def(
+      "create_submesh",
+      [](const dolfinx::mesh::Mesh& mesh, int dim,
+         const std::vector<std::int32_t>& entities,
+         const dolfinx::fem::CoordinateElement& element) {
+        auto [submesh, entity_map, vertex_map, node_map]
+            = dolfinx::mesh::create_submesh(mesh, dim, entities, element);
+        return std::tuple(
+            std::move(submesh),
+            py::array_t<std::int32_t>(entity_map.size(), entity_map.data()),
+            py::array_t<std::int32_t>(vertex_map.size(), vertex_map.data()),
+            py::array_t<std::int32_t>(node_map.size(), node_map.data()));
+      },
+      py::arg("mesh"), py::arg("dim"), py::arg("entities"),
+      py::arg("element"),
+      "Create a mesh of a subset of the entities of a mesh, and the maps "
+      "from its cells, vertices and geometry nodes to the mesh (collective).");
 
   m.def("locate_entities", &dolfinx::mesh::locate_entities);
   m.def("locate_entities_boundary", &dolfinx::mesh::locate_entities_boundary);
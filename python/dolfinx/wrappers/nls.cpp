@@ -12,6 +12,7 @@
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <utility>
 
 #ifdef DEBUG
 // Needed for typeid(_p_Mat) in debug mode
@@ -69,19 +70,98 @@ void nls(py::module& m)
 
   // dolfinx::NewtonSolver
   py::class_<dolfinx::nls::NewtonSolver,
-             std::shared_ptr<dolfinx::nls::NewtonSolver>, PyNewtonSolver>(
-      m, "NewtonSolver")
+             std::shared_ptr<dolfinx::nls::NewtonSolver>, PyNewtonSolver>
+      newton_solver(m, "NewtonSolver");
+
+  py::enum_<dolfinx::nls::NewtonSolver::ForcingTerm>(newton_solver,
+                                                     "ForcingTerm")
+      .value("constant", dolfinx::nls::NewtonSolver::ForcingTerm::constant)
+      .value("eisenstat_walker_1",
+             dolfinx::nls::NewtonSolver::ForcingTerm::eisenstat_walker_1)
+      .value("eisenstat_walker_2",
+             dolfinx::nls::NewtonSolver::ForcingTerm::eisenstat_walker_2);
+
+  py::enum_<dolfinx::nls::NewtonSolver::LineSearch>(newton_solver,
+                                                    "LineSearch")
+      .value("none", dolfinx::nls::NewtonSolver::LineSearch::none)
+      .value("backtracking",
+             dolfinx::nls::NewtonSolver::LineSearch::backtracking)
+      .value("critical_point",
+             dolfinx::nls::NewtonSolver::LineSearch::critical_point);
+
+  py::class_<dolfinx::nls::NewtonSolver::IterationStatistics>(
+      newton_solver, "IterationStatistics",
+      "Wall times of the phases of a Newton iteration")
+      .def_readonly(
+          "residual",
+          &dolfinx::nls::NewtonSolver::IterationStatistics::residual)
+      .def_readonly(
+          "jacobian",
+          &dolfinx::nls::NewtonSolver::IterationStatistics::jacobian)
+      .def_readonly(
+          "preconditioner",
+          &dolfinx::nls::NewtonSolver::IterationStatistics::preconditioner)
+      .def_readonly(
+          "linear_solve",
+          &dolfinx::nls::NewtonSolver::IterationStatistics::linear_solve)
+      .def_readonly(
+          "krylov_iterations",
+          &dolfinx::nls::NewtonSolver::IterationStatistics::krylov_iterations)
+      .def_readonly("update",
+                    &dolfinx::nls::NewtonSolver::IterationStatistics::update);
+
+  newton_solver
       .def(py::init([](const MPICommWrapper comm) {
         return std::make_unique<PyNewtonSolver>(comm.get());
       }))
       .def("solve", &dolfinx::nls::NewtonSolver::solve)
+      .def_property_readonly("krylov_iterations",
+                             &dolfinx::nls::NewtonSolver::krylov_iterations)
+      .def_property_readonly("statistics",
+                             &dolfinx::nls::NewtonSolver::statistics)
+      .def("statistics_table", &dolfinx::nls::NewtonSolver::statistics_table,
+           "Statistics of the iterations of the last solve as a Table")
+      .def(
+          "get_krylov_solver",
+          [](dolfinx::nls::NewtonSolver& self) {
+            return self.get_krylov_solver().ksp();
+          },
+          "The linear solver (KSP) of the Newton iterations")
       .def("converged", &PyPublicNewtonSolver::converged)
       .def("update_solution", &PyPublicNewtonSolver::update_solution)
       .def_readwrite("atol", &dolfinx::nls::NewtonSolver::atol)
       .def_readwrite("rtol", &dolfinx::nls::NewtonSolver::rtol)
       .def_readwrite("max_it", &dolfinx::nls::NewtonSolver::max_it)
       .def_readwrite("convergence_criterion",
-                     &dolfinx::nls::NewtonSolver::convergence_criterion);
+                     &dolfinx::nls::NewtonSolver::convergence_criterion)
+      .def_readwrite("max_jacobian_age",
+                     &dolfinx::nls::NewtonSolver::max_jacobian_age)
+      .def_readwrite("max_preconditioner_age",
+                     &dolfinx::nls::NewtonSolver::max_preconditioner_age)
+      .def_readwrite("max_reuse_rate",
+                     &dolfinx::nls::NewtonSolver::max_reuse_rate)
+      .def_readwrite("forcing_term",
+                     &dolfinx::nls::NewtonSolver::forcing_term)
+      .def_readwrite("forcing_eta0", &dolfinx::nls::NewtonSolver::forcing_eta0)
+      .def_readwrite("forcing_eta_max",
+                     &dolfinx::nls::NewtonSolver::forcing_eta_max)
+      .def_readwrite("forcing_gamma",
+                     &dolfinx::nls::NewtonSolver::forcing_gamma)
+      .def_readwrite("forcing_alpha",
+                     &dolfinx::nls::NewtonSolver::forcing_alpha)
+      .def_readwrite("forcing_threshold",
+                     &dolfinx::nls::NewtonSolver::forcing_threshold)
+      .def_readwrite("relaxation_parameter",
+                     &dolfinx::nls::NewtonSolver::relaxation_parameter)
+      .def_readwrite("fused_assembly",
+                     &dolfinx::nls::NewtonSolver::fused_assembly)
+      .def_readwrite("line_search", &dolfinx::nls::NewtonSolver::line_search)
+      .def_readwrite("line_search_max_it",
+                     &dolfinx::nls::NewtonSolver::line_search_max_it)
+      .def_readwrite("line_search_c",
+                     &dolfinx::nls::NewtonSolver::line_search_c)
+      .def_readwrite("line_search_rtol",
+                     &dolfinx::nls::NewtonSolver::line_search_rtol);
 
   // dolfinx::NonlinearProblem 'trampoline' for overloading from
   // Python
@@ -107,6 +187,14 @@ void nls(py::module& m)
           "Tried to call pure virtual function dolfinx::NonlinearProblem::F");
     }
 
+    std::pair<Vec, Mat> FJ(const Vec x) override
+    {
+      typedef std::pair<Vec, Mat> VecMatPair;
+      PYBIND11_OVERLOAD_INT(VecMatPair, dolfinx::nls::NonlinearProblem, "FJ",
+                            x);
+      return dolfinx::nls::NonlinearProblem::FJ(x);
+    }
+
     void form(Vec x) override
     {
       PYBIND11_OVERLOAD_INT(void, dolfinx::nls::NonlinearProblem, "form", x);
@@ -121,6 +209,7 @@ void nls(py::module& m)
       .def(py::init<>())
       .def("F", &dolfinx::nls::NonlinearProblem::F)
       .def("J", &dolfinx::nls::NonlinearProblem::J)
+      .def("FJ", &dolfinx::nls::NonlinearProblem::FJ)
       .def("P", &dolfinx::nls::NonlinearProblem::P)
       .def("form", &dolfinx::nls::NonlinearProblem::form);
 }
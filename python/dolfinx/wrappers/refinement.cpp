@@ -4,13 +4,74 @@
 //
 // SPDX-License-Identifier:    LGPL-3.0-or-later
 
+#include "caster_petsc.h"
+#include <dolfinx/function/Function.h>
+#include <dolfinx/function/FunctionSpace.h>
+#include <dolfinx/la/PETScMatrix.h>
 #include <dolfinx/mesh/Mesh.h>
 #include <dolfinx/mesh/MeshTags.h>
+#include <dolfinx/refinement/MeshHierarchy.h>
+#include <dolfinx/refinement/coarsen.h>
+#include <dolfinx/refinement/marking.h>
 #include <dolfinx/refinement/refine.h>
+#include <limits>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <tuple>
+#include <utility>
 
 namespace py = pybind11;
 
+namespace
+{
+// The parent maps of a refinement from arrays (see refine_with_parents)
+dolfinx::refinement::PlazaRefinementND::ParentMaps
+create_parent_maps(const py::array_t<std::int32_t>& parent_cell,
+                   const py::array_t<std::int8_t>& parent_facet,
+                   const py::array_t<std::int32_t>& edge_vertex)
+{
+  dolfinx::refinement::PlazaRefinementND::ParentMaps parents;
+  parents.parent_cell.assign(parent_cell.data(),
+                             parent_cell.data() + parent_cell.size());
+  parents.parent_facet.assign(parent_facet.data(),
+                              parent_facet.data() + parent_facet.size());
+  parents.edge_vertex.assign(edge_vertex.data(),
+                             edge_vertex.data() + edge_vertex.size());
+  return parents;
+}
+
+template <typename T>
+void declare_transfer_meshtags(py::module& m)
+{
+  m.def(
+      "transfer_meshtags",
+      [](const dolfinx::mesh::MeshTags<T>& tags,
+         const std::shared_ptr<const dolfinx::mesh::Mesh>& coarse_mesh,
+         const py::array_t<std::int32_t>& parent_cell,
+         const py::array_t<std::int8_t>& parent_facet,
+         const py::array_t<std::int32_t>& edge_vertex,
+         const dolfinx::refinement::CoarseningMaps& maps) {
+        return dolfinx::refinement::transfer_meshtags(
+            tags, coarse_mesh,
+            create_parent_maps(parent_cell, parent_facet, edge_vertex), maps);
+      },
+      "Transfer MeshTags of cells or facets to a coarsened mesh.");
+  m.def(
+      "refine_meshtags",
+      [](const dolfinx::mesh::MeshTags<T>& tags,
+         const std::shared_ptr<const dolfinx::mesh::Mesh>& mesh,
+         const py::array_t<std::int32_t>& parent_cell,
+         const py::array_t<std::int8_t>& parent_facet,
+         const py::array_t<std::int32_t>& edge_vertex) {
+        return dolfinx::refinement::refine_meshtags(
+            tags, mesh,
+            create_parent_maps(parent_cell, parent_facet, edge_vertex));
+      },
+      "Transfer MeshTags onto a refined mesh.");
+}
+} // namespace
+
 namespace dolfinx_wrappers
 {
 
@@ -19,15 +80,172 @@ void refinement(py::module& m)
 
   // dolfinx::refinement::refine
   m.def("refine",
-        py::overload_cast<const dolfinx::mesh::Mesh&, bool>(
+        py::overload_cast<const dolfinx::mesh::Mesh&, bool, int, double>(
             &dolfinx::refinement::refine),
-        py::arg("mesh"), py::arg("redistribute") = true);
+        py::arg("mesh"), py::arg("redistribute") = true,
+        py::arg("num_threads") = 1,
+        py::arg("max_imbalance") = std::numeric_limits<double>::infinity(),
+        "Refine a mesh (collective). The GIL is released.",
+        py::call_guard<py::gil_scoped_release>());
 
   m.def("refine",
         py::overload_cast<const dolfinx::mesh::Mesh&,
-                          const dolfinx::mesh::MeshTags<std::int8_t>&, bool>(
-            &dolfinx::refinement::refine),
-        py::arg("mesh"), py::arg("marker"), py::arg("redistribute") = true);
+                          const dolfinx::mesh::MeshTags<std::int8_t>&, bool,
+                          int, double>(&dolfinx::refinement::refine),
+        py::arg("mesh"), py::arg("marker"), py::arg("redistribute") = true,
+        py::arg("num_threads") = 1,
+        py::arg("max_imbalance") = std::numeric_limits<double>::infinity(),
+        "Refine a mesh (collective). The GIL is released.",
+        py::call_guard<py::gil_scoped_release>());
+
+  // dolfinx::refinement::refine_with_parents
+  auto parents_to_arrays
+      = [](std::pair<dolfinx::mesh::Mesh,
+                     dolfinx::refinement::PlazaRefinementND::ParentMaps>&&
+               refined) {
+          const auto& p = refined.second;
+          return std::tuple(
+              std::move(refined.first),
+              py::array_t<std::int32_t>(p.parent_cell.size(),
+                                        p.parent_cell.data()),
+              py::array_t<std::int8_t>(p.parent_facet.size(),
+                                       p.parent_facet.data()),
+              py::array_t<std::int32_t>(p.edge_vertex.size(),
+                                        p.edge_vertex.data()));
+        };
+  m.def(
+      "refine_with_parents",
+      [parents_to_arrays](const dolfinx::mesh::Mesh& mesh) {
+        return parents_to_arrays(
+            dolfinx::refinement::refine_with_parents(mesh));
+      },
+      py::arg("mesh"),
+      "Refine a mesh without redistribution and return the parent cells, "
+      "parent facets and new vertices of the refined edges.");
+  m.def(
+      "refine_with_parents",
+      [parents_to_arrays](const dolfinx::mesh::Mesh& mesh,
+                          const dolfinx::mesh::MeshTags<std::int8_t>& marker) {
+        return parents_to_arrays(
+            dolfinx::refinement::refine_with_parents(mesh, marker));
+      },
+      py::arg("mesh"), py::arg("marker"),
+      "Refine a mesh with markers without redistribution and return the "
+      "parent cells, parent facets and new vertices of the refined edges.");
+
+  // dolfinx::refinement::MeshHierarchy
+  py::class_<dolfinx::refinement::MeshHierarchy,
+             std::shared_ptr<dolfinx::refinement::MeshHierarchy>>(
+      m, "MeshHierarchy", "Hierarchy of uniformly refined meshes")
+      .def(py::init<std::shared_ptr<const dolfinx::mesh::Mesh>, int>(),
+           py::arg("mesh"), py::arg("num_refinements"),
+           "Create a hierarchy by uniform refinement (collective). The GIL is "
+           "released.",
+           py::call_guard<py::gil_scoped_release>())
+      .def_property_readonly("num_levels",
+                             &dolfinx::refinement::MeshHierarchy::num_levels)
+      .def("mesh", &dolfinx::refinement::MeshHierarchy::mesh,
+           py::arg("level"))
+      .def(
+          "parent_cells",
+          [](const dolfinx::refinement::MeshHierarchy& self, int level) {
+            const std::vector<std::int32_t>& p = self.parent_cells(level);
+            return py::array_t<std::int32_t>(p.size(), p.data());
+          },
+          py::arg("level"))
+      .def(
+          "parents",
+          [](const dolfinx::refinement::MeshHierarchy& self, int level) {
+            const auto& p = self.parents(level);
+            return std::tuple(
+                py::array_t<std::int32_t>(p.parent_cell.size(),
+                                          p.parent_cell.data()),
+                py::array_t<std::int8_t>(p.parent_facet.size(),
+                                         p.parent_facet.data()),
+                py::array_t<std::int32_t>(p.edge_vertex.size(),
+                                          p.edge_vertex.data()));
+          },
+          py::arg("level"));
+
+  // dolfinx::refinement::create_prolongation
+  m.def(
+      "create_prolongation",
+      [](const dolfinx::function::FunctionSpace& V0,
+         const dolfinx::function::FunctionSpace& V1,
+         const std::vector<std::int32_t>& parent_cells) {
+        dolfinx::la::PETScMatrix P
+            = dolfinx::refinement::create_prolongation(V0, V1, parent_cells);
+        Mat _P = P.mat();
+        PetscObjectReference((PetscObject)_P);
+        return _P;
+      },
+      py::return_value_policy::take_ownership, py::arg("V0"), py::arg("V1"),
+      py::arg("parent_cells"),
+      "Create the prolongation matrix from a space on a mesh to a space on "
+      "a refinement of the mesh. "
+      "The GIL is released.",
+      py::call_guard<py::gil_scoped_release>());
+
+  // dolfinx::refinement::CoarseningMaps
+  py::class_<dolfinx::refinement::CoarseningMaps,
+             std::shared_ptr<dolfinx::refinement::CoarseningMaps>>(
+      m, "CoarseningMaps", "Relations of a coarsened mesh to a refined mesh")
+      .def_property_readonly(
+          "fine_cell",
+          [](const dolfinx::refinement::CoarseningMaps& self) {
+            return py::array_t<std::int32_t>(self.fine_cell.size(),
+                                             self.fine_cell.data());
+          })
+      .def_property_readonly(
+          "parent_cell", [](const dolfinx::refinement::CoarseningMaps& self) {
+            return py::array_t<std::int32_t>(self.parent_cell.size(),
+                                             self.parent_cell.data());
+          });
+
+  // dolfinx::refinement::coarsen
+  m.def(
+      "coarsen",
+      [](const dolfinx::mesh::Mesh& parent_mesh,
+         const dolfinx::mesh::Mesh& mesh,
+         const py::array_t<std::int32_t>& parent_cell,
+         const py::array_t<std::int8_t>& parent_facet,
+         const py::array_t<std::int32_t>& edge_vertex,
+         const dolfinx::mesh::MeshTags<std::int8_t>& cell_markers) {
+        return dolfinx::refinement::coarsen(
+            parent_mesh, mesh,
+            create_parent_maps(parent_cell, parent_facet, edge_vertex),
+            cell_markers);
+      },
+      "Coarsen a refined mesh by merging the marked children of parent "
+      "cells.");
+  m.def(
+      "transfer_function",
+      [](const dolfinx::function::Function<PetscScalar>& u,
+         dolfinx::function::Function<PetscScalar>& u_coarse,
+         const py::array_t<std::int32_t>& parent_cell,
+         const py::array_t<std::int8_t>& parent_facet,
+         const py::array_t<std::int32_t>& edge_vertex,
+         const dolfinx::refinement::CoarseningMaps& maps) {
+        dolfinx::refinement::transfer_function(
+            u, u_coarse,
+            create_parent_maps(parent_cell, parent_facet, edge_vertex), maps);
+      },
+      "Interpolate a function on a refined mesh into a space on a "
+      "coarsened mesh.");
+  declare_transfer_meshtags<std::int8_t>(m);
+  declare_transfer_meshtags<std::int32_t>(m);
+  declare_transfer_meshtags<std::int64_t>(m);
+  declare_transfer_meshtags<double>(m);
+
+  // dolfinx::refinement marking
+  m.def("mark_maximum", &dolfinx::refinement::mark_maximum,
+        py::arg("mesh"), py::arg("indicator"), py::arg("theta"),
+        "Mark the cells with an error indicator of at least theta times "
+        "the largest indicator.");
+  m.def("mark_dorfler", &dolfinx::refinement::mark_dorfler, py::arg("mesh"),
+        py::arg("indicator"), py::arg("theta"),
+        "Mark the cells with the largest error indicators that account "
+        "for the fraction theta of the total squared error.");
 }
 
 } // namespace dolfinx_wrappers
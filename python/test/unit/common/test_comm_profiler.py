@@ -0,0 +1,34 @@
+"""Unit tests for the communication profiler"""
+
+# Copyright (C) 2020 Garth N. Wells
+#
+# This file is part of DOLFINX (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+
+from mpi4py import MPI
+
+from dolfinx import UnitSquareMesh, common
+
+
+def test_comm_profile():
+    """Test that the communication of mesh creation is recorded only if
+    enabled"""
+    common.clear_comm_profile()
+    UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    assert len(common.comm_profile()) == 0
+
+    common.set_comm_profiling(True)
+    UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    common.set_comm_profiling(False)
+    records = common.comm_profile()
+    assert len(records) > 0
+    for calls, neighbours, sent, received, time in records.values():
+        assert calls > 0
+        assert neighbours >= 0
+        assert sent >= 0 and received >= 0
+        assert time >= 0.0
+    common.list_comm_profile(MPI.COMM_WORLD)
+
+    common.clear_comm_profile()
+    assert len(common.comm_profile()) == 0
@@ -6,10 +6,18 @@
 #
 # SPDX-License-Identifier:    LGPL-3.0-or-later
 
+import json
+import os
 import random
 from time import sleep
 
+import pytest
+from mpi4py import MPI
+
 from dolfinx import common
+from dolfinx_utils.test.fixtures import tempdir
+
+assert (tempdir)
 
 # Seed random generator for determinism
 random.seed(0)
@@ -41,3 +49,104 @@ def test_context_manager_anonymous():
     with common.Timer() as t:
         sleep(0.05)
         assert t.elapsed()[0] >= 0.05
+
+
+def test_nested_timers():
+    """Test that timers started in a running timer time sub-tasks"""
+    parent, child = get_random_task_name(), get_random_task_name()
+    with common.Timer(parent):
+        for i in range(3):
+            with common.Timer(child):
+                sleep(0.01)
+
+    # The sub-task is found by its name and by its path
+    t = common.timing(child)
+    assert t[0] == 3
+    assert t[1] >= 0.03
+    assert common.timing(parent + " > " + child)[0] == 3
+    assert common.timing(parent)[1] >= t[1]
+
+    table = common.timings([common.TimingType.wall])
+    assert table.get(parent + " > " + child, "reps") == 3
+
+
+def test_disabled_timing():
+    """Test that disabled timers measure time but do not register it"""
+    task = get_random_task_name()
+    common.set_timing_enabled(False)
+    try:
+        with common.Timer(task) as t:
+            sleep(0.01)
+            assert t.elapsed()[0] >= 0.01
+    finally:
+        common.set_timing_enabled(True)
+    with pytest.raises(RuntimeError):
+        common.timing(task)
+
+
+def test_cpu_timing():
+    """Test that user and system times are measured if enabled"""
+    common.set_cpu_timing(True)
+    try:
+        with common.Timer() as t:
+            sum(i * i for i in range(200000))
+            wall, user, system = t.elapsed()
+    finally:
+        common.set_cpu_timing(False)
+    assert user + system > 0.0
+
+
+def test_trace(tempdir):
+    """Test that the recorded timings are written as a Chrome trace"""
+    parent, child = get_random_task_name(), get_random_task_name()
+    common.set_trace(True)
+    try:
+        with common.Timer(parent):
+            with common.Timer(child):
+                sleep(0.01)
+    finally:
+        common.set_trace(False)
+
+    filename = os.path.join(tempdir, "trace.json")
+    comm = MPI.COMM_WORLD
+    common.write_trace(comm, filename)
+    if comm.rank == 0:
+        with open(filename) as f:
+            events = json.load(f)["traceEvents"]
+        for rank in range(comm.size):
+            e = {e["name"]: e for e in events if e["ph"] == "X" and e["pid"] == rank}
+            assert e[child]["dur"] >= 1.0e4
+            assert e[parent]["ts"] <= e[child]["ts"]
+            assert e[parent]["ts"] + e[parent]["dur"] >= e[child]["ts"] + e[child]["dur"]
+
+
+def test_hardware_counters():
+    """Test that timings are registered with hardware counters, if the
+    counters are available"""
+    task = get_random_task_name()
+    common.set_hardware_counters(True)
+    try:
+        with common.Timer(task):
+            sum(i * i for i in range(10000))
+        common.list_timings(MPI.COMM_WORLD, [common.TimingType.wall])
+    finally:
+        common.set_hardware_counters(False)
+    assert common.timing(task)[0] == 1
+
+
+def test_memory_tracking():
+    """Test that the memory retained by a task is registered"""
+    task = get_random_task_name()
+    common.set_memory_tracking(True)
+    try:
+        with common.Timer(task):
+            data = b"\x01" * (64 * 1024 * 1024)
+        common.list_timings(MPI.COMM_WORLD, [common.TimingType.wall])
+        table = common.timings([common.TimingType.wall])
+    finally:
+        common.set_memory_tracking(False)
+    del data
+    assert common.timing(task)[0] == 1
+    assert table.get(task, "mem peak MB") >= 0.0
+    if os.path.exists("/proc/self/statm"):
+        assert table.get(task, "mem +rss MB") > 60.0
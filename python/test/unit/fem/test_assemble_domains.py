@@ -161,6 +161,29 @@ def test_assembly_dS_domains(mode):
     assert val == pytest.approx(2 * (N - 1) + N * numpy.sqrt(2), 1.0e-7)
 
 
+@parametrize_ghost_mode
+def test_assembly_dS_marked_domains(mode):
+    N = 10
+    mesh = dolfinx.UnitSquareMesh(MPI.COMM_WORLD, N, N, ghost_mode=mode)
+    tdim = mesh.topology.dim
+    mesh.topology.create_connectivity(tdim - 1, tdim)
+    facets = dolfinx.mesh.locate_entities(mesh, tdim - 1, lambda x: numpy.isclose(x[0], 0.5))
+    marker = dolfinx.mesh.MeshTags(mesh, tdim - 1, facets, numpy.full(facets.shape, 1, numpy.intc))
+    dS = ufl.Measure('dS', subdomain_data=marker, domain=mesh)
+
+    # Assemble scalar over the marked interior facets
+    one = dolfinx.Constant(mesh, 1)
+    val = mesh.mpi_comm().allreduce(dolfinx.fem.assemble_scalar(one * dS(1)), op=MPI.SUM)
+    assert val == pytest.approx(1.0, 1.0e-12)
+
+    # Assemble vector over the marked interior facets
+    V = dolfinx.FunctionSpace(mesh, ("CG", 1))
+    v = ufl.TestFunction(V)
+    b = dolfinx.fem.assemble_vector(ufl.avg(v) * dS(1))
+    b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    assert b.sum() == pytest.approx(1.0, 1.0e-12)
+
+
 @parametrize_ghost_mode
 def test_additivity(mode):
     mesh = dolfinx.UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
@@ -195,3 +218,25 @@ def test_additivity(mode):
     assert (J1 + J3) == pytest.approx(J13)
     assert (J2 + J3) == pytest.approx(J23)
     assert (J1 + J2 + J3) == pytest.approx(J123)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_subdomain_coefficients(mode):
+    """Coefficients are packed only on the cells of the integrals, and
+    repacked when they change"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 8, 8, ghost_mode=mode)
+    cells = dolfinx.mesh.locate_entities(mesh, mesh.topology.dim, lambda x: x[0] <= 0.5 + 1.0e-10)
+    marker = dolfinx.mesh.MeshTags(mesh, mesh.topology.dim, cells, numpy.full(len(cells), 1, dtype=numpy.intc))
+    dx = ufl.Measure('dx', subdomain_data=marker, domain=mesh)
+    ds = ufl.Measure('ds', domain=mesh)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1.0 + x[0])
+    M = f * dx(1) + f * ds
+
+    def value(M):
+        return mesh.mpi_comm().allreduce(dolfinx.fem.assemble_scalar(M), op=MPI.SUM)
+
+    assert value(M) == pytest.approx(6.625)
+    f.interpolate(lambda x: 2.0 + 2.0 * x[0])
+    assert value(M) == pytest.approx(13.25)
@@ -6,6 +6,7 @@
 """Unit tests for assembly"""
 
 import math
+import os
 
 import dolfinx
 import numpy
@@ -14,10 +15,11 @@ import ufl
 from dolfinx import function
 from dolfinx.generation import UnitCubeMesh, UnitSquareMesh
 from dolfinx.mesh import create_mesh
+from dolfinx_utils.test.fixtures import tempdir  # noqa: F401
 from dolfinx_utils.test.skips import skip_in_parallel
 from mpi4py import MPI
 from petsc4py import PETSc
-from ufl import derivative, ds, dx, inner
+from ufl import avg, derivative, dS, ds, dx, inner
 
 
 def nest_matrix_norm(A):
@@ -57,6 +59,165 @@ def test_assemble_functional_ds(mode):
     assert value == pytest.approx(4.0, 1e-12)
 
 
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_assemble_functionals(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1.0 + x[0] * x[1])
+    x = ufl.SpatialCoordinate(mesh)
+    forms = [1.0 * dx(domain=mesh), x[0] * dx(domain=mesh), f * dx, f * f * ds,
+             1.0 * ds(domain=mesh), avg(f) * dS, f * dx + f * ds]
+    values = dolfinx.fem.assemble_scalars(forms)
+    assert len(values) == len(forms)
+    for M, value in zip(forms, values):
+        value_ref = mesh.mpi_comm().allreduce(dolfinx.fem.assemble_scalar(M), op=MPI.SUM)
+        assert value == pytest.approx(value_ref, 1e-12)
+    assert values[0] == pytest.approx(1.0, 1e-12)
+    assert values[4] == pytest.approx(4.0, 1e-12)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_assemble_scalar_reproducible(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: numpy.sin(10.0 * x[0]) * numpy.exp(x[1]))
+    M = dolfinx.fem.Form(f * f * dx + f * ds + avg(f) * dS)
+    values = []
+    for num_threads in [1, 2, 3]:
+        M._cpp_object.num_threads = num_threads
+        values.append(dolfinx.fem.assemble_scalar_reproducible(M))
+
+    # The values are equal to the last bit, and equal on all processes
+    assert values[0] == values[1] == values[2]
+    assert mesh.mpi_comm().allgather(values[0]) == [values[0]] * mesh.mpi_comm().size
+    value_ref = mesh.mpi_comm().allreduce(dolfinx.fem.assemble_scalar(M), op=MPI.SUM)
+    assert values[0] == pytest.approx(value_ref, 1e-12)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_assemble_vectors(mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    W = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 2))
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1.0 + x[0] * x[1])
+    v, w = ufl.TestFunction(V), ufl.TestFunction(W)
+    forms = [inner(f, v) * dx, inner(f, v) * ds, inner(ufl.grad(f), w) * dx]
+
+    def assemble_ref(L):
+        b = dolfinx.fem.assemble_vector(L)
+        with b.localForm() as b_local:
+            return b_local.array.copy()
+
+    values = dolfinx.fem.assemble_vectors(forms)
+    assert len(values) == len(forms)
+    for L, b in zip(forms, values):
+        assert numpy.allclose(b, assemble_ref(L))
+
+    # Assemble into existing arrays, which are not zeroed
+    b = [numpy.ones_like(value) for value in values]
+    assert dolfinx.fem.assemble_vectors(forms, b) is b
+    for value, b_i in zip(values, b):
+        assert numpy.allclose(b_i, value + 1.0)
+
+    with pytest.raises(RuntimeError):
+        dolfinx.fem.assemble_vectors(forms, b[:2])
+    with pytest.raises(RuntimeError):
+        dolfinx.fem.assemble_vectors(forms[::-1], b)
+
+
+@pytest.mark.parametrize("mat_type", ["", "baij"])
+def test_matrix_cache(mat_type):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    forms = [inner(u, v) * dx, inner(ufl.grad(u), ufl.grad(v)) * dx]
+
+    # Forms with the same dofmaps and integral types share patterns
+    cache = dolfinx.cpp.fem.MatrixCache()
+    for a in forms:
+        A = dolfinx.fem.create_matrix(a, mat_type, cache=cache)
+        A.zeroEntries()
+        dolfinx.fem.assemble_matrix(A, a)
+        A.assemble()
+        A_ref = dolfinx.fem.create_matrix(a, mat_type)
+        A_ref.zeroEntries()
+        dolfinx.fem.assemble_matrix(A_ref, a)
+        A_ref.assemble()
+        assert A.getType() == A_ref.getType()
+        assert A.getBlockSize() == A_ref.getBlockSize()
+        assert A.getInfo()["nz_used"] == A_ref.getInfo()["nz_used"]
+        assert A.norm() == pytest.approx(A_ref.norm(), rel=1.0e-12)
+    assert cache.size == 1
+    dolfinx.fem.create_matrix(inner(u, v) * ds, mat_type, cache=cache)
+    assert cache.size == 2
+    cache.clear()
+    assert cache.size == 0
+
+
+def test_assembly_plan():
+    """Check that repeated execution of assembly plans for a form with a
+    changing coefficient gives the same tensors as plain assembly"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    k = dolfinx.Function(V)
+    a = dolfinx.fem.Form(k * inner(ufl.grad(u), ufl.grad(v)) * dx + inner(u, v) * ds)
+    L = dolfinx.fem.Form(k * v * dx)
+
+    u_bc = dolfinx.Function(V)
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bcs = [dolfinx.DirichletBC(u_bc, dolfinx.fem.locate_dofs_topological(V, 1, facets))]
+
+    A = dolfinx.fem.create_matrix(a)
+    b = dolfinx.fem.create_vector(L)
+    plan_a = dolfinx.cpp.fem.AssemblyPlan(a._cpp_object, bcs, A, 2.0)
+    plan_L = dolfinx.cpp.fem.AssemblyPlan(L._cpp_object, b)
+    assert plan_a.memory_usage() > 0
+    for value in [1.0, 3.0]:
+        k.vector.set(value)
+        k.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+        plan_a.execute()
+        A.assemble()
+        A_ref = dolfinx.fem.assemble_matrix(a, bcs, diagonal=2.0)
+        A_ref.assemble()
+        A_ref.axpy(-1.0, A)
+        assert A_ref.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+        plan_L.execute()
+        b_ref = dolfinx.fem.assemble_vector(L)
+        b_ref.axpy(-1.0, b)
+        assert b_ref.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+def test_assembly_plan_autotune(tempdir):  # noqa: F811
+    """Check that an autotuned assembly plan gives the same matrix as plain
+    assembly, and that the stored strategy is reused"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(ufl.grad(u), ufl.grad(v)) * dx + inner(u, v) * ds)
+    A_ref = dolfinx.fem.assemble_matrix(a)
+    A_ref.assemble()
+
+    filename = MPI.COMM_WORLD.bcast(os.path.join(tempdir, "strategies.txt"), root=0)
+    A = dolfinx.fem.create_matrix(a)
+    plan = dolfinx.cpp.fem.AssemblyPlan(a._cpp_object, [], A)
+    strategy = plan.autotune(max_threads=2, num_repeats=2, filename=filename)
+    assert strategy.num_threads in (1, 2)
+    plan.execute()
+    A.assemble()
+    A.axpy(-1.0, A_ref)
+    assert A.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+    plan = dolfinx.cpp.fem.AssemblyPlan(a._cpp_object, [], A)
+    stored = plan.autotune(max_threads=2, filename=filename)
+    assert stored.num_threads == strategy.num_threads
+    assert stored.positions == strategy.positions
+
+
 def test_assemble_derivatives():
     """This test checks the original_coefficient_positions, which may change
     under differentiation (some coefficients and constants are
@@ -133,6 +294,589 @@ def test_basic_assembly(mode):
     assert 2.0 * normA == pytest.approx(A.norm())
 
 
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_assembly_position_map(mode):
+    """Check that reassembly with a precomputed position map matches
+    standard assembly"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: numpy.stack((1.0 + x[0], x[1] ** 2)))
+    a = dolfinx.fem.Form(inner(ufl.grad(u), ufl.grad(v)) * dx + inner(f, f) * inner(u, v) * dx
+                         + inner(u, v) * ds)
+
+    u_bc = dolfinx.Function(V)
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bdofs = dolfinx.fem.locate_dofs_topological(V, 1, facets)
+    bcs = [dolfinx.DirichletBC(u_bc, bdofs)]
+
+    A0 = dolfinx.fem.assemble_matrix(a, bcs)
+    A0.assemble()
+
+    A1 = dolfinx.fem.create_matrix(a)
+    position_map = dolfinx.fem.create_matrix_position_map(A1, a)
+    for i in range(2):
+        A1.zeroEntries()
+        dolfinx.fem.assemble_matrix(A1, a, bcs, position_map=position_map)
+        A1.assemble()
+        assert A1.norm() == pytest.approx(A0.norm(), rel=1.0e-12)
+
+    A1.axpy(-1.0, A0)
+    assert A1.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_fast_reassembly(mode):
+    """Check that reassembly reusing the off-process communication
+    pattern matches standard assembly"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(ufl.grad(u), ufl.grad(v)) * dx + inner(u, v) * ds)
+
+    A0 = dolfinx.fem.assemble_matrix(a)
+    A0.assemble()
+
+    A1 = dolfinx.fem.create_matrix(a)
+    with pytest.raises(RuntimeError):
+        dolfinx.cpp.la.set_fast_reassembly(A1)
+    A1.zeroEntries()
+    dolfinx.fem.assemble_matrix(A1, a)
+    A1.assemble()
+    dolfinx.cpp.la.set_fast_reassembly(A1)
+    for i in range(3):
+        A1.zeroEntries()
+        dolfinx.fem.assemble_matrix(A1, a)
+        A1.assemble()
+        assert A1.norm() == pytest.approx(A0.norm(), rel=1.0e-12)
+
+    A1.axpy(-1.0, A0)
+    assert A1.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_assemble_matrix_csr(mode):
+    """Check that assembly into a native CSR matrix matches assembly into a
+    PETSc matrix, and that the CSR matrix-vector product matches PETSc"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(ufl.grad(u), ufl.grad(v)) * dx + inner(u, v) * ds)
+
+    u_bc = dolfinx.Function(V)
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bcs = [dolfinx.DirichletBC(u_bc, dolfinx.fem.locate_dofs_topological(V, 1, facets))]
+
+    A0 = dolfinx.fem.assemble_matrix(a, bcs)
+    A0.assemble()
+
+    pattern = dolfinx.cpp.fem.create_sparsity_pattern(a._cpp_object)
+    pattern.assemble()
+    A = dolfinx.cpp.la.MatrixCSR(pattern)
+    for i in range(2):
+        A.set(0.0)
+        dolfinx.cpp.fem.assemble_matrix(A, a._cpp_object, bcs)
+        A.finalize()
+        A1 = A.to_petsc(mesh.mpi_comm())
+        A1.assemble()
+        assert A1.norm() == pytest.approx(A0.norm(), rel=1.0e-12)
+        A1.axpy(-1.0, A0)
+        assert A1.norm() == pytest.approx(0.0, abs=1.0e-10)
+        A1.destroy()
+
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1.0 + x[0] * x[1])
+    y0 = A0.createVecLeft()
+    A0.mult(f.vector, y0)
+    size_owned = V.dofmap.index_map.size_local * V.dofmap.index_map.block_size
+    y = dolfinx.Function(V)._cpp_object.x
+    for num_threads in [1, 3]:
+        A.mult(f._cpp_object.x, y, num_threads)
+        assert numpy.allclose(y.array()[:size_owned], y0.array_r)
+
+
+@pytest.mark.skipif(numpy.issubdtype(PETSc.ScalarType, numpy.complexfloating),
+                    reason="Single precision matrices are only supported for real scalars")
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_assemble_matrix_csr_float32(mode):
+    """Assemble a form with double precision kernels into a single
+    precision CSR matrix and compare with the double precision matrix"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(ufl.grad(u), ufl.grad(v)) * dx + inner(u, v) * ds)
+
+    u_bc = dolfinx.Function(V)
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bcs = [dolfinx.DirichletBC(u_bc, dolfinx.fem.locate_dofs_topological(V, 1, facets))]
+
+    pattern = dolfinx.cpp.fem.create_sparsity_pattern(a._cpp_object)
+    pattern.assemble()
+    A0 = dolfinx.cpp.la.MatrixCSR(pattern)
+    A1 = dolfinx.cpp.la.MatrixCSR_float32(pattern)
+    for A in (A0, A1):
+        A.set(0.0)
+        dolfinx.cpp.fem.assemble_matrix(A, a._cpp_object, bcs)
+        A.finalize()
+
+    for v0, v1 in zip(A0.values(), A1.values()):
+        assert v1.dtype == numpy.float32
+        assert numpy.allclose(v1, v0, rtol=1.0e-6, atol=1.0e-6 * numpy.abs(v0).max(initial=1.0))
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_assemble_matrix_baij(mode):
+    """Check that a blocked sparsity pattern and block (BAIJ) matrix for
+    a vector-valued space give the same matrix as scalar AIJ assembly"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8, ghost_mode=mode)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(ufl.sym(ufl.grad(u)), ufl.grad(v)) * dx + inner(u, v) * ds
+                         + inner(avg(u), avg(v)) * dS)
+
+    u_bc = dolfinx.Function(V)
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bcs = [dolfinx.DirichletBC(u_bc, dolfinx.fem.locate_dofs_topological(V, 1, facets))]
+
+    pattern0 = dolfinx.cpp.fem.create_sparsity_pattern(a._cpp_object)
+    pattern0.assemble()
+    pattern1 = dolfinx.cpp.fem.create_sparsity_pattern(a._cpp_object, True)
+    pattern1.assemble()
+    assert not pattern0.blocked
+    assert pattern1.blocked
+    assert pattern1.num_nonzeros() * 4 == pattern0.num_nonzeros()
+
+    # Reference matrix, with scalar insertion (the stacked index map of
+    # a block matrix has block size 1)
+    A0 = dolfinx.fem.assemble_matrix_block([[a]], bcs)
+    A0.assemble()
+
+    # Blockwise insertion into AIJ and BAIJ matrices
+    A1 = dolfinx.fem.create_matrix(a)
+    A2 = dolfinx.fem.create_matrix(a, "baij")
+    assert A2.getType().endswith("baij")
+    for A in [A1, A2]:
+        assert A.getBlockSize() == 2
+        A.zeroEntries()
+        dolfinx.fem.assemble_matrix(A, a, bcs)
+        A.assemble()
+        assert A.norm() == pytest.approx(A0.norm(), rel=1.0e-12)
+
+    A2.convert("aij")
+    A2.axpy(-1.0, A1)
+    assert A2.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_assemble_matrix_is(mode):
+    """Check that assembly into an unassembled (MATIS) matrix gives the
+    same matrix as assembly into an AIJ matrix"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8, ghost_mode=mode)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(ufl.sym(ufl.grad(u)), ufl.grad(v)) * dx + inner(u, v) * ds)
+
+    u_bc = dolfinx.Function(V)
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bcs = [dolfinx.DirichletBC(u_bc, dolfinx.fem.locate_dofs_topological(V, 1, facets))]
+
+    A0 = dolfinx.fem.assemble_matrix(a, bcs)
+    A0.assemble()
+
+    A1 = dolfinx.fem.create_matrix(a, "is")
+    assert A1.getType() == "is"
+    A1.zeroEntries()
+    dolfinx.fem.assemble_matrix(A1, a, bcs)
+    A1.assemble()
+
+    A1 = A1.convert("aij")
+    A1.axpy(-1.0, A0)
+    assert A1.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_assemble_matrix_sbaij(mode):
+    """Check that symmetric block (SBAIJ) storage of the upper triangle
+    gives the same operator as a full AIJ matrix"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8, ghost_mode=mode)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(ufl.sym(ufl.grad(u)), ufl.sym(ufl.grad(v))) * dx + inner(u, v) * ds)
+
+    u_bc = dolfinx.Function(V)
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bcs = [dolfinx.DirichletBC(u_bc, dolfinx.fem.locate_dofs_topological(V, 1, facets))]
+
+    A0 = dolfinx.fem.assemble_matrix(a, bcs)
+    A0.assemble()
+    A1 = dolfinx.fem.create_matrix(a, "sbaij")
+    assert A1.getType().endswith("sbaij")
+    A1.zeroEntries()
+    dolfinx.fem.assemble_matrix(A1, a, bcs)
+    A1.assemble()
+
+    # Only the upper triangle is stored
+    assert A1.getInfo()["nz_used"] < A0.getInfo()["nz_used"]
+
+    x, y0 = A0.createVecRight(), A0.createVecLeft()
+    x.setRandom()
+    A0.mult(x, y0)
+    y1 = y0.duplicate()
+    A1.mult(x, y1)
+    y1.axpy(-1.0, y0)
+    assert y1.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+def test_packed_coefficients():
+    """Check that cached coefficient packing detects modified and replaced
+    coefficients, and that packed coefficients can be passed to assembly"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    v = ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1.0 + x[0])
+    L = dolfinx.fem.Form(inner(f, v) * dx)
+
+    def assembled_norm(L, coeffs=None):
+        b = dolfinx.fem.assemble_vector(L, coeffs=coeffs)
+        b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+        return b.norm()
+
+    norm0 = assembled_norm(L)
+    assert assembled_norm(L, dolfinx.fem.pack_coefficients(L)) == pytest.approx(norm0)
+
+    # Modify the coefficient via its PETSc vector
+    with f.vector.localForm() as f_local:
+        f_local.scale(2.0)
+    assert assembled_norm(L) == pytest.approx(2.0 * norm0)
+
+    # Modify the coefficient via interpolation
+    f.interpolate(lambda x: 3.0 * (1.0 + x[0]))
+    assert assembled_norm(L) == pytest.approx(3.0 * norm0)
+
+    # Replace the coefficient
+    g = dolfinx.Function(V)
+    g.interpolate(lambda x: 1.0 + x[0])
+    L._cpp_object.set_coefficient(0, g._cpp_object)
+    assert assembled_norm(L) == pytest.approx(norm0)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_assemble_vector_overlap(mode):
+    """Check that assembly into a distributed vector with overlapped
+    ghost accumulation matches assembly into a PETSc vector"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1.0 + x[0] * x[1])
+    a = dolfinx.fem.Form(inner(ufl.grad(u), ufl.grad(v)) * dx)
+    L = dolfinx.fem.Form(inner(f, v) * dx + inner(f, v) * ds)
+
+    u_bc = dolfinx.Function(V)
+    u_bc.interpolate(lambda x: x[0] + 2.0 * x[1])
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bcs = [dolfinx.DirichletBC(u_bc, dolfinx.fem.locate_dofs_topological(V, 1, facets))]
+    size_owned = V.dofmap.index_map.size_local * V.dofmap.index_map.block_size
+
+    b0 = dolfinx.fem.assemble_vector(L)
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    x = dolfinx.Function(V)._cpp_object.x
+    dolfinx.cpp.fem.assemble_vector(x, L._cpp_object)
+    assert numpy.allclose(x.array()[:size_owned], b0.array_r)
+
+    b0 = dolfinx.fem.assemble_vector(L)
+    dolfinx.fem.apply_lifting(b0, [a], [bcs])
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    x = dolfinx.Function(V)._cpp_object.x
+    dolfinx.cpp.fem.assemble_vector(x, L._cpp_object, [a._cpp_object], [bcs], [], 1.0)
+    assert numpy.allclose(x.array()[:size_owned], b0.array_r)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_cell_coordinates_cache(mode):
+    """Check that assembly with the cell coordinate cache matches assembly
+    without it, and that the cache is rebuilt after the geometry changes"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = inner(ufl.grad(u), ufl.grad(v)) * dx + inner(u, v) * ds + inner(avg(u), avg(v)) * dS
+    L = inner(1.0, v) * dx + inner(1.0, v) * ds + inner(1.0, avg(v)) * dS
+    M = 1.0 * dx + 1.0 * ds + 1.0 * dS
+
+    def assemble():
+        A = dolfinx.fem.assemble_matrix(a)
+        A.assemble()
+        b = dolfinx.fem.assemble_vector(L)
+        b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+        m = mesh.mpi_comm().allreduce(dolfinx.fem.assemble_scalar(M), op=MPI.SUM)
+        return A.norm(), b.norm(), m
+
+    ref0 = assemble()
+    mesh.geometry.x[:, :2] *= 2.0
+    ref1 = assemble()
+    mesh.geometry.x[:, :2] *= 0.5
+
+    mesh.geometry.set_cell_coordinates_cache(True)
+    assert assemble() == pytest.approx(ref0)
+
+    # Modifying the geometry invalidates the cache
+    mesh.geometry.x[:, :2] *= 2.0
+    assert assemble() == pytest.approx(ref1)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_matrix_free_operator(mode):
+    """Check that the matrix-free operator action and diagonal match the
+    assembled matrix"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(ufl.grad(u), ufl.grad(v)) * dx + inner(u, v) * ds)
+
+    u_bc = dolfinx.Function(V)
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bdofs = dolfinx.fem.locate_dofs_topological(V, 1, facets)
+    bcs = [dolfinx.DirichletBC(u_bc, bdofs)]
+
+    A = dolfinx.fem.assemble_matrix(a, bcs)
+    A.assemble()
+    S = dolfinx.fem.create_matrix_free_operator(a, bcs)
+
+    x, y0 = A.createVecRight(), A.createVecLeft()
+    x.setRandom()
+    A.mult(x, y0)
+    y1 = y0.duplicate()
+    S.mult(x, y1)
+    assert y1.norm() == pytest.approx(y0.norm(), rel=1.0e-12)
+    y1.axpy(-1.0, y0)
+    assert y1.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+    d0, d1 = A.getDiagonal(), S.getDiagonal()
+    d1.axpy(-1.0, d0)
+    assert d1.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+@pytest.mark.parametrize("symmetric", [True, False])
+def test_assemble_system(symmetric):
+    """Check that fused system assembly matches separate matrix and
+    vector assembly with lifting"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1.0 + x[0] * x[1])
+    a = dolfinx.fem.Form(inner(f * ufl.grad(u), ufl.grad(v)) * dx + inner(u, v) * ds)
+    L = dolfinx.fem.Form(inner(f, v) * dx + inner(f, v) * ds)
+
+    u_bc = dolfinx.Function(V)
+    u_bc.interpolate(lambda x: x[1] ** 2)
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bdofs = dolfinx.fem.locate_dofs_topological(V, 1, facets)
+    bcs = [dolfinx.DirichletBC(u_bc, bdofs)]
+
+    x0 = dolfinx.fem.create_vector(L)
+    x0.setRandom()
+    x0.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+    A, b = dolfinx.fem.assemble_system(a, L, bcs, x0=x0, scale=-1.0, symmetric=symmetric)
+    A.assemble()
+
+    A0 = dolfinx.fem.assemble_matrix(a, bcs)
+    A0.assemble()
+    b0 = dolfinx.fem.assemble_vector(L)
+    dolfinx.fem.apply_lifting(b0, [a], [bcs], x0=[x0], scale=-1.0)
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    dolfinx.fem.set_bc(b0, bcs, x0, -1.0)
+
+    if symmetric:
+        assert A.norm() == pytest.approx(A0.norm(), rel=1.0e-12)
+        assert b.norm() == pytest.approx(b0.norm(), rel=1.0e-12)
+    else:
+        # Columns of the boundary condition dofs are kept
+        assert A.norm() > A0.norm()
+
+    # The systems have the same solution
+    def solve(A, b):
+        ksp = PETSc.KSP().create(mesh.mpi_comm())
+        ksp.setOperators(A)
+        ksp.setType("preonly")
+        ksp.getPC().setType("lu")
+        x = b.duplicate()
+        ksp.solve(b, x)
+        return x
+    x, x_ref = solve(A, b), solve(A0, b0)
+    x.axpy(-1.0, x_ref)
+    assert x.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+@pytest.mark.parametrize("mesh", [UnitSquareMesh(MPI.COMM_WORLD, 5, 7, dolfinx.cpp.mesh.CellType.quadrilateral),
+                                  UnitCubeMesh(MPI.COMM_WORLD, 3, 2, 4, dolfinx.cpp.mesh.CellType.hexahedron)])
+@pytest.mark.parametrize("degree", [1, 2, 3])
+def test_sum_factorised_operator(mesh, degree):
+    """Check that the sum-factorised operator action and diagonal match
+    the assembled matrix"""
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", degree))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    kappa, sigma = 2.0, 3.0
+    a = dolfinx.fem.Form(kappa * inner(ufl.grad(u), ufl.grad(v)) * dx + sigma * inner(u, v) * dx)
+
+    u_bc = dolfinx.Function(V)
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, mesh.topology.dim - 1, lambda x: numpy.isclose(x[0], 0.0))
+    bdofs = dolfinx.fem.locate_dofs_topological(V, mesh.topology.dim - 1, facets)
+    bcs = [dolfinx.DirichletBC(u_bc, bdofs)]
+
+    A = dolfinx.fem.assemble_matrix(a, bcs)
+    A.assemble()
+    op = dolfinx.cpp.fem.SumFactorisedOperator(V._cpp_object, kappa, sigma)
+    S = dolfinx.fem.create_matrix_free_operator(op, bcs)
+
+    x, y0 = A.createVecRight(), A.createVecLeft()
+    x.setRandom()
+    A.mult(x, y0)
+    y1 = y0.duplicate()
+    S.mult(x, y1)
+    y1.axpy(-1.0, y0)
+    assert y1.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+    d0, d1 = A.getDiagonal(), S.getDiagonal()
+    d1.axpy(-1.0, d0)
+    assert d1.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+@pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
+def test_assemble_diagonal_lumped(mode):
+    """Check that the diagonal and the row sums assembled without a
+    matrix match the assembled matrix"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(u, v) * dx + inner(ufl.grad(u), ufl.grad(v)) * dx)
+
+    u_bc = dolfinx.Function(V)
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bcs = [dolfinx.DirichletBC(u_bc, dolfinx.fem.locate_dofs_topological(V, 1, facets))]
+    size_owned = V.dofmap.index_map.size_local * V.dofmap.index_map.block_size
+
+    A = dolfinx.fem.assemble_matrix(a, bcs, diagonal=0.0)
+    A.assemble()
+    x = A.createVecRight()
+    x.set(1.0)
+    y = A.createVecLeft()
+    A.mult(x, y)
+
+    d = dolfinx.Function(V)._cpp_object.x
+    dolfinx.cpp.fem.assemble_diagonal(a._cpp_object, d, bcs)
+    assert numpy.allclose(d.array()[:size_owned], A.getDiagonal().array_r)
+
+    d = dolfinx.Function(V)._cpp_object.x
+    dolfinx.cpp.fem.assemble_lumped(a._cpp_object, d, bcs)
+    assert numpy.allclose(d.array()[:size_owned], y.array_r)
+
+
+@pytest.mark.parametrize("num_threads", [2, 3])
+def test_threaded_assembly(num_threads):
+    """Check that threaded cell assembly matches serial assembly"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1.0 + x[0] * x[1])
+
+    a = dolfinx.fem.Form(inner(f * u, v) * dx + inner(u, v) * ds)
+    L = dolfinx.fem.Form(inner(f, v) * dx)
+    M = dolfinx.fem.Form(f * dx)
+
+    A0 = dolfinx.fem.assemble_matrix(a)
+    A0.assemble()
+    b0 = dolfinx.fem.assemble_vector(L)
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    m0 = mesh.mpi_comm().allreduce(dolfinx.fem.assemble_scalar(M), op=MPI.SUM)
+
+    for form in (a, L, M):
+        form._cpp_object.num_threads = num_threads
+        assert form._cpp_object.num_threads == num_threads
+
+    A1 = dolfinx.fem.assemble_matrix(a)
+    A1.assemble()
+    b1 = dolfinx.fem.assemble_vector(L)
+    b1.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    m1 = mesh.mpi_comm().allreduce(dolfinx.fem.assemble_scalar(M), op=MPI.SUM)
+
+    A1.axpy(-1.0, A0)
+    assert A1.norm() == pytest.approx(0.0, abs=1.0e-12)
+    b1.axpy(-1.0, b0)
+    assert b1.norm() == pytest.approx(0.0, abs=1.0e-12)
+    assert m1 == pytest.approx(m0)
+
+    with pytest.raises(RuntimeError):
+        a._cpp_object.num_threads = 0
+
+
+@pytest.mark.parametrize("num_threads", [2, 3])
+def test_threaded_interior_facet_assembly(num_threads):
+    """Check that threaded interior facet assembly of DG forms matches
+    serial assembly"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 10, 8)
+    V = dolfinx.FunctionSpace(mesh, ("DG", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    f = dolfinx.Function(V)
+    f.interpolate(lambda x: 1.0 + x[0] * x[1])
+    n = ufl.FacetNormal(mesh)
+
+    a = dolfinx.fem.Form(inner(u, v) * dx + inner(ufl.jump(u, n), ufl.jump(v, n)) * dS)
+    L = dolfinx.fem.Form(inner(avg(f), ufl.jump(v)) * dS)
+
+    A0 = dolfinx.fem.assemble_matrix(a)
+    A0.assemble()
+    b0 = dolfinx.fem.assemble_vector(L)
+    b0.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+
+    a._cpp_object.num_threads = num_threads
+    L._cpp_object.num_threads = num_threads
+
+    A1 = dolfinx.fem.assemble_matrix(a)
+    A1.assemble()
+    b1 = dolfinx.fem.assemble_vector(L)
+    b1.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+
+    A1.axpy(-1.0, A0)
+    assert A1.norm() == pytest.approx(0.0, abs=1.0e-12)
+    b1.axpy(-1.0, b0)
+    assert b1.norm() == pytest.approx(0.0, abs=1.0e-12)
+
+
+@pytest.mark.parametrize("cell_type", [dolfinx.cpp.mesh.CellType.triangle, dolfinx.cpp.mesh.CellType.quadrilateral])
+def test_reuse_cell_tensors(cell_type):
+    """Check that matrix assembly with element tensors reused for
+    translated cells matches standard assembly"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 6, cell_type)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    k = dolfinx.Constant(mesh, 2.0)
+    a = dolfinx.fem.Form(k * inner(ufl.grad(u), ufl.grad(v)) * dx + inner(u, v) * dx + inner(u, v) * ds)
+
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bdofs = dolfinx.fem.locate_dofs_topological(V, 1, facets)
+    bcs = [dolfinx.DirichletBC(dolfinx.Function(V), bdofs)]
+
+    A0 = dolfinx.fem.assemble_matrix(a, bcs)
+    A0.assemble()
+    a._cpp_object.reuse_cell_tensors = True
+    assert a._cpp_object.reuse_cell_tensors
+    A1 = dolfinx.fem.assemble_matrix(a, bcs)
+    A1.assemble()
+    A1.axpy(-1.0, A0)
+    assert A1.norm() == pytest.approx(0.0, abs=1.0e-12)
+
+    # Reuse is not possible with coefficients
+    f = dolfinx.Function(V)
+    a = dolfinx.fem.Form(f * inner(u, v) * dx)
+    a._cpp_object.reuse_cell_tensors = True
+    with pytest.raises(RuntimeError):
+        dolfinx.fem.assemble_matrix(a)
+
+
 @pytest.mark.parametrize("mode", [dolfinx.cpp.mesh.GhostMode.none, dolfinx.cpp.mesh.GhostMode.shared_facet])
 def test_assembly_bcs(mode):
     mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12, ghost_mode=mode)
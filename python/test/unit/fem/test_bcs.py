@@ -40,3 +40,56 @@ def test_locate_dofs_geometrical():
         # Check correct dof returned in V
         coords_V = V.tabulate_dof_coordinates()
         assert np.isclose(coords_V[dofs[0][1]], [0, 0, 0]).all()
+
+
+def test_locate_dofs_geometrical_boundary():
+    """Test that restricting the search to the boundary gives the same
+    degrees of freedom as the full search for a boundary marker."""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 4, 6)
+    V = dolfinx.function.VectorFunctionSpace(mesh, ("Lagrange", 2))
+
+    def marker(x):
+        return np.logical_or(np.isclose(x[0], 0.0), np.isclose(x[1], 1.0))
+
+    dofs0 = dolfinx.fem.locate_dofs_geometrical(V, marker)
+    dofs1 = dolfinx.fem.locate_dofs_geometrical(V, marker, boundary_only=True)
+    assert np.array_equal(np.sort(dofs0), np.sort(dofs1))
+
+    # Interior dofs are not candidates
+    dofs = dolfinx.fem.locate_dofs_geometrical(V, lambda x: np.isclose(x[0], 0.5), boundary_only=True)
+    coords = V.tabulate_dof_coordinates()[dofs]
+    assert np.logical_or(np.isclose(coords[:, 1], 0.0), np.isclose(coords[:, 1], 1.0)).all()
+
+    # Two spaces
+    W = dolfinx.function.FunctionSpace(mesh, ufl.FiniteElement("Lagrange", mesh.ufl_cell(), 1)
+                                       * ufl.FiniteElement("Lagrange", mesh.ufl_cell(), 2))
+    Q = W.sub(1).collapse()
+    dofs0 = dolfinx.fem.locate_dofs_geometrical((W.sub(1), Q), marker)
+    dofs1 = dolfinx.fem.locate_dofs_geometrical((W.sub(1), Q), marker, boundary_only=True)
+    assert np.array_equal(dofs0, dofs1)
+
+
+def test_update_bc_values():
+    """Test that updating the values of a boundary condition from an
+    expression gives the values of the interpolated expression."""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = dolfinx.function.VectorFunctionSpace(mesh, ("Lagrange", 2))
+    dofs = dolfinx.fem.locate_dofs_geometrical(V, lambda x: np.isclose(x[0], 0.0))
+    u0 = dolfinx.function.Function(V)
+    bc = dolfinx.fem.DirichletBC(u0, dofs)
+
+    def f(t):
+        return lambda x: np.vstack((t * x[1], -t * x[1] ** 2))
+
+    u1 = dolfinx.function.Function(V)
+    for t in [1.0, 2.0]:
+        bc.update(f(t))
+        u1.interpolate(f(t))
+        b0 = u0.vector.copy()
+        dolfinx.fem.set_bc(b0, [bc])
+        b1 = u0.vector.copy()
+        dolfinx.fem.set_bc(b1, [dolfinx.fem.DirichletBC(u1, dofs)])
+        assert np.allclose(b0.array, b1.array)
+
+    # The function of the boundary condition is not modified
+    assert np.allclose(u0.vector.array, 0.0)
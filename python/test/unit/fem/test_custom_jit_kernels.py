@@ -6,16 +6,21 @@
 #
 # SPDX-License-Identifier:    LGPL-3.0-or-later
 
+import os
+
 import dolfinx
 import numba
 import numpy as np
 from dolfinx import (Function, FunctionSpace, TimingType, UnitSquareMesh, cpp,
                      list_timings)
 from dolfinx.fem import IntegralType
+from dolfinx_utils.test.fixtures import tempdir
 from dolfinx_utils.test.skips import skip_if_complex
 from mpi4py import MPI
 from petsc4py import PETSc
 
+assert (tempdir)
+
 c_signature = numba.types.void(
     numba.types.CPointer(numba.typeof(PETSc.ScalarType())),
     numba.types.CPointer(numba.typeof(PETSc.ScalarType())),
@@ -70,6 +75,46 @@ def tabulate_tensor_b_coeff(b_, w_, c_, coords_, local_index, orientation):
     b[:] = w[0] * Ae / 6.0
 
 
+@numba.cfunc(c_signature, nopython=True)
+def tabulate_state_update(q_, w_, c_, coords_, local_index, orientation):
+    # Increment the history variable at each of the 3 quadrature points
+    q = numba.carray(q_, (3), dtype=PETSc.ScalarType)
+    w = numba.carray(w_, (3), dtype=PETSc.ScalarType)
+    q[:] = w[:] + 1.0
+
+
+BATCH_SIZE = 4
+
+
+@numba.cfunc(c_signature, nopython=True)
+def tabulate_tensor_A_batched(A_, w_, c_, coords_, entity_local_index, cell_orientation):
+    # Interleaved layout: entry k of cell c is stored at k * BATCH_SIZE + c
+    A = numba.carray(A_, (3, 3, BATCH_SIZE), dtype=PETSc.ScalarType)
+    coordinate_dofs = numba.carray(coords_, (3, 2, BATCH_SIZE), dtype=np.float64)
+    for c in range(BATCH_SIZE):
+        x0, y0 = coordinate_dofs[0, 0, c], coordinate_dofs[0, 1, c]
+        x1, y1 = coordinate_dofs[1, 0, c], coordinate_dofs[1, 1, c]
+        x2, y2 = coordinate_dofs[2, 0, c], coordinate_dofs[2, 1, c]
+        Ae = abs((x0 - x1) * (y2 - y1) - (y0 - y1) * (x2 - x1))
+        B = np.array(
+            [y1 - y2, y2 - y0, y0 - y1, x2 - x1, x0 - x2, x1 - x0],
+            dtype=PETSc.ScalarType).reshape(2, 3)
+        A[:, :, c] = np.dot(B.T, B) / (2 * Ae)
+
+
+@numba.cfunc(c_signature, nopython=True)
+def tabulate_tensor_b_coeff_batched(b_, w_, c_, coords_, local_index, orientation):
+    b = numba.carray(b_, (3, BATCH_SIZE), dtype=PETSc.ScalarType)
+    w = numba.carray(w_, (1, BATCH_SIZE), dtype=PETSc.ScalarType)
+    coordinate_dofs = numba.carray(coords_, (3, 2, BATCH_SIZE), dtype=np.float64)
+    for c in range(BATCH_SIZE):
+        x0, y0 = coordinate_dofs[0, 0, c], coordinate_dofs[0, 1, c]
+        x1, y1 = coordinate_dofs[1, 0, c], coordinate_dofs[1, 1, c]
+        x2, y2 = coordinate_dofs[2, 0, c], coordinate_dofs[2, 1, c]
+        Ae = abs((x0 - x1) * (y2 - y1) - (y0 - y1) * (x2 - x1))
+        b[:, c] = w[0, c] * Ae / 6.0
+
+
 def test_numba_assembly():
     mesh = UnitSquareMesh(MPI.COMM_WORLD, 13, 13)
     V = FunctionSpace(mesh, ("Lagrange", 1))
@@ -238,3 +283,61 @@ def test_cffi_assembly():
     assert (np.isclose(bnorm, 0.0739710713711999))
 
     list_timings(MPI.COMM_WORLD, [TimingType.wall])
+
+
+def test_batched_assembly():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 13, 13)
+    V = FunctionSpace(mesh, ("Lagrange", 1))
+    DG0 = FunctionSpace(mesh, ("DG", 0))
+    vals = Function(DG0)
+    vals.vector.set(2.0)
+
+    # The batched kernel is used in place of the scalar kernel
+    a = cpp.fem.Form([V._cpp_object, V._cpp_object], False)
+    a.set_tabulate_tensor(IntegralType.cell, -1, tabulate_tensor_A.address)
+    a.set_tabulate_tensor_batched(IntegralType.cell, -1, tabulate_tensor_A_batched.address, BATCH_SIZE)
+
+    L = cpp.fem.Form([V._cpp_object], False)
+    L.set_tabulate_tensor(IntegralType.cell, -1, tabulate_tensor_b_coeff.address)
+    L.set_tabulate_tensor_batched(IntegralType.cell, -1, tabulate_tensor_b_coeff_batched.address,
+                                  BATCH_SIZE)
+    L.set_coefficient(0, vals._cpp_object)
+
+    A = dolfinx.fem.assemble_matrix(a)
+    A.assemble()
+    b = dolfinx.fem.assemble_vector(L)
+    b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+
+    assert (np.isclose(A.norm(PETSc.NormType.FROBENIUS), 56.124860801609124))
+    assert (np.isclose(b.norm(PETSc.NormType.N2), 2.0 * 0.0739710713711999))
+
+
+def test_quadrature_data(tempdir):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 13, 13)
+    V = FunctionSpace(mesh, ("Lagrange", 1))
+    q = cpp.function.QuadratureData(mesh, 3, 1)
+
+    # Update the data in place, with the previous values as coefficient
+    update = cpp.fem.Form([], False)
+    update.set_mesh(mesh)
+    update.set_tabulate_tensor(IntegralType.cell, -1, tabulate_state_update.address)
+    update.set_coefficient(0, q)
+    cpp.fem.update_quadrature_data(q, update)
+    cpp.fem.update_quadrature_data(q, update)
+    num_cells = mesh.topology.index_map(mesh.topology.dim).size_local
+    assert np.allclose(q.values()[:num_cells], 2.0)
+
+    # Use the data as a coefficient (the kernel uses the first point)
+    L = cpp.fem.Form([V._cpp_object], False)
+    L.set_tabulate_tensor(IntegralType.cell, -1, tabulate_tensor_b_coeff.address)
+    L.set_coefficient(0, q)
+    b = dolfinx.fem.assemble_vector(L)
+    b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    assert (np.isclose(b.norm(PETSc.NormType.N2), 2.0 * 0.0739710713711999))
+
+    # Checkpoint
+    filename = os.path.join(tempdir, "quadrature_data.h5")
+    cpp.io.write_quadrature_data(mesh.mpi_comm(), filename, "/state", q)
+    q.values()[:] = 0.0
+    cpp.io.read_quadrature_data(mesh.mpi_comm(), filename, "/state", q)
+    assert np.allclose(q.values(), 2.0)
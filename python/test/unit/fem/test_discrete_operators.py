@@ -6,55 +6,101 @@
 #
 # SPDX-License-Identifier:    LGPL-3.0-or-later
 
-# from math import sqrt
-
-# import pytest
-# from petsc4py import PETSc
-
-# from dolfinx FunctionSpace, UnitCubeMesh, UnitSquareMesh
-# from dolfinx.cpp.fem import DiscreteOperators
-# from dolfinx_utils.test.skips import skip_in_parallel
-
-
-# @skip_in_parallel
-# def test_gradient():
-#     """Test discrete gradient computation (typically used for curl-curl
-#     AMG preconditioners"""
-
-#     def compute_discrete_gradient(mesh):
-#         V = FunctionSpace(mesh, ("Lagrange", 1))
-#         W = FunctionSpace(mesh, ("Nedelec 1st kind H(curl)", 1))
-#         G = DiscreteOperators.build_gradient(W._cpp_object, V._cpp_object)
-#         assert G.getRefCount() == 1
-#         num_edges = mesh.topology.index_map(1).size_global
-#         m, n = G.getSize()
-#         assert m == num_edges
-#         assert n == mesh.topology.index_map(0).size_global
-#         assert round(
-#             G.norm(PETSc.NormType.FROBENIUS) - sqrt(2.0 * num_edges),
-#             8) == 0.0
-
-#     meshes = [
-#         UnitSquareMesh(MPI.COMM_WORLD, 11, 6),
-#         UnitCubeMesh(MPI.COMM_WORLD, 4, 3, 7)
-#     ]
-#     for mesh in meshes:
-#         compute_discrete_gradient(mesh)
-
-
-# def test_incompatible_spaces():
-#     "Test that error is thrown when function spaces are not compatible"
-
-#     mesh = UnitSquareMesh(MPI.COMM_WORLD, 13, 7)
-#     V = FunctionSpace(mesh, ("Lagrange", 1))
-#     W = FunctionSpace(mesh, ("Nedelec 1st kind H(curl)", 1))
-#     with pytest.raises(RuntimeError):
-#         DiscreteOperators.build_gradient(V._cpp_object, W._cpp_object)
-#     with pytest.raises(RuntimeError):
-#         DiscreteOperators.build_gradient(V._cpp_object, V._cpp_object)
-#     with pytest.raises(RuntimeError):
-#         DiscreteOperators.build_gradient(W._cpp_object, W._cpp_object)
-
-#     V = FunctionSpace(mesh, ("Lagrange", 2))
-#     with pytest.raises(RuntimeError):
-#         DiscreteOperators.build_gradient(W._cpp_object, V._cpp_object)
+from math import sqrt
+
+import numpy as np
+import pytest
+from mpi4py import MPI
+from petsc4py import PETSc
+
+from dolfinx import (Function, FunctionSpace, UnitCubeMesh, UnitSquareMesh,
+                     VectorFunctionSpace)
+from dolfinx.cpp.fem import DiscreteOperators
+
+
+@pytest.mark.parametrize("mesh", [UnitSquareMesh(MPI.COMM_WORLD, 11, 6),
+                                  UnitCubeMesh(MPI.COMM_WORLD, 4, 3, 7)])
+def test_gradient(mesh):
+    """Test discrete gradient computation (typically used for curl-curl
+    AMG preconditioners"""
+
+    V = FunctionSpace(mesh, ("Lagrange", 1))
+    W = FunctionSpace(mesh, ("Nedelec 1st kind H(curl)", 1))
+    G = DiscreteOperators.build_gradient(W._cpp_object, V._cpp_object)
+    assert G.getRefCount() == 1
+    num_edges = mesh.topology.index_map(1).size_global
+    m, n = G.getSize()
+    assert m == num_edges
+    assert n == mesh.topology.index_map(0).size_global
+    assert G.norm(PETSc.NormType.FROBENIUS) == pytest.approx(sqrt(2.0 * num_edges))
+
+    # The gradient of a constant is zero
+    u = Function(V)
+    u.vector.set(1.0)
+    w = Function(W)
+    G.mult(u.vector, w.vector)
+    assert w.vector.norm() == pytest.approx(0.0)
+
+
+def test_incompatible_spaces():
+    "Test that error is thrown when function spaces are not compatible"
+
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 13, 7)
+    V = FunctionSpace(mesh, ("Lagrange", 1))
+    W = FunctionSpace(mesh, ("Nedelec 1st kind H(curl)", 1))
+    with pytest.raises(RuntimeError):
+        DiscreteOperators.build_gradient(V._cpp_object, W._cpp_object)
+    with pytest.raises(RuntimeError):
+        DiscreteOperators.build_gradient(V._cpp_object, V._cpp_object)
+    with pytest.raises(RuntimeError):
+        DiscreteOperators.build_gradient(W._cpp_object, W._cpp_object)
+
+    V = FunctionSpace(mesh, ("Lagrange", 2))
+    with pytest.raises(RuntimeError):
+        DiscreteOperators.build_gradient(W._cpp_object, V._cpp_object)
+
+
+@pytest.mark.parametrize("mesh", [UnitSquareMesh(MPI.COMM_WORLD, 7, 5),
+                                  UnitCubeMesh(MPI.COMM_WORLD, 3, 2, 4)])
+def test_interpolation(mesh):
+    """Test the interpolation operator from P1 to P2, which is exact for
+    linear functions"""
+
+    def f(x):
+        return 1.0 + x[0] + 2.0 * x[1] - x[2]
+
+    V1 = FunctionSpace(mesh, ("Lagrange", 1))
+    V2 = FunctionSpace(mesh, ("Lagrange", 2))
+    P = DiscreteOperators.build_interpolation(V2._cpp_object, V1._cpp_object)
+    assert P.getSize() == (V2.dofmap.index_map.size_global, V1.dofmap.index_map.size_global)
+
+    u1, u2, u2_ref = Function(V1), Function(V2), Function(V2)
+    u1.interpolate(f)
+    u2_ref.interpolate(f)
+    P.mult(u1.vector, u2.vector)
+    assert np.allclose(u2.vector.array, u2_ref.vector.array)
+
+    # A function is interpolated into its own space by the identity
+    I1 = DiscreteOperators.build_interpolation(V1._cpp_object, V1._cpp_object)
+    assert I1.getInfo()["nz_used"] == pytest.approx(V1.dofmap.index_map.size_local, abs=0.5)
+
+
+def test_interpolation_vector():
+    """Test the interpolation operator between vector spaces"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 6, 5)
+
+    def f(x):
+        return np.vstack((x[0] - x[1], 2.0 * x[1]))
+
+    V1 = VectorFunctionSpace(mesh, ("Lagrange", 1))
+    V2 = VectorFunctionSpace(mesh, ("Lagrange", 2))
+    P = DiscreteOperators.build_interpolation(V2._cpp_object, V1._cpp_object)
+    u1, u2, u2_ref = Function(V1), Function(V2), Function(V2)
+    u1.interpolate(f)
+    u2_ref.interpolate(f)
+    P.mult(u1.vector, u2.vector)
+    assert np.allclose(u2.vector.array, u2_ref.vector.array)
+
+    W = FunctionSpace(mesh, ("Lagrange", 1))
+    with pytest.raises(RuntimeError):
+        DiscreteOperators.build_interpolation(V2._cpp_object, W._cpp_object)
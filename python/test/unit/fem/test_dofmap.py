@@ -17,6 +17,7 @@ from dolfinx.cpp.mesh import CellType
 from dolfinx.mesh import create_mesh
 from dolfinx_utils.test.skips import skip_in_parallel
 from mpi4py import MPI
+from petsc4py import PETSc
 from ufl import FiniteElement, MixedElement, VectorElement
 
 xfail = pytest.mark.xfail(strict=True)
@@ -390,3 +391,147 @@ def test_transpose_dofmap():
     dofmap = dolfinx.cpp.graph.AdjacencyList_int32(np.array([[0, 2, 1], [3, 2, 1], [4, 3, 1]]))
     transpose = dolfinx.cpp.fem.transpose_dofmap(dofmap, 3)
     assert np.array_equal(transpose.array, [0, 2, 5, 8, 1, 4, 3, 7, 6])
+
+
+@pytest.mark.parametrize("ordering", ["gps", "cuthill_mckee", "cell", "hilbert", "random"])
+def test_dof_ordering(ordering):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    map_c = mesh.topology.index_map(2)
+    num_cells = map_c.size_local + map_c.num_ghosts
+    cell_order = np.arange(num_cells, dtype=np.int32)
+    if ordering == "hilbert":
+        cell_order = cpp.mesh.compute_hilbert_order(cpp.mesh.midpoints(mesh, 2, cell_order))
+        assert np.array_equal(np.sort(cell_order), np.arange(num_cells))
+        dof_ordering = cpp.fem.DofOrdering.cell
+    else:
+        dof_ordering = getattr(cpp.fem.DofOrdering, ordering)
+    V = FunctionSpace(mesh, ("Lagrange", 2), dof_ordering=dof_ordering, cell_order=cell_order)
+
+    # Owned dofs are numbered in order of first appearance in the cells
+    if dof_ordering == cpp.fem.DofOrdering.cell and MPI.COMM_WORLD.size == 1:
+        assert np.array_equal(np.sort(V.dofmap.cell_dofs(cell_order[0])), np.arange(6))
+
+    b = fem.assemble_vector(ufl.TestFunction(V) * ufl.dx)
+    b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    assert b.sum() == pytest.approx(1.0)
+
+
+@pytest.mark.parametrize("overlap", [0, 1, 2])
+def test_subdomain_dofs(overlap):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    V = FunctionSpace(mesh, ("Lagrange", 1))
+    subdomains = cpp.fem.compute_subdomain_dofs(V._cpp_object, 4, overlap)
+    assert len(subdomains) == 4
+
+    # The subdomains cover the owned dofs
+    index_map = V.dofmap.index_map
+    r = index_map.local_range
+    dofs = np.unique(subdomains.array)
+    owned = dofs[(dofs >= r[0]) & (dofs < r[1])]
+    assert np.array_equal(owned, np.arange(r[0], r[1]))
+
+    # Overlapping subdomains contain the non-overlapping subdomains
+    subdomains0 = cpp.fem.compute_subdomain_dofs(V._cpp_object, 4, 0)
+    for i in range(4):
+        assert np.all(np.isin(subdomains0.links(i), subdomains.links(i)))
+
+    # The subdomains can be used by the PETSc additive Schwarz preconditioner
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    A = fem.assemble_matrix(u * v * ufl.dx)
+    A.assemble()
+    ksp = PETSc.KSP().create(MPI.COMM_WORLD)
+    ksp.setOperators(A)
+    ksp.getPC().setType("asm")
+    ksp.getPC().setASMLocalSubdomains(4, [PETSc.IS().createGeneral(subdomains.links(i)) for i in range(4)])
+    ksp.setUp()
+
+
+def test_shared_dofmap():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V0 = FunctionSpace(mesh, ("Lagrange", 2))
+    V1 = FunctionSpace(mesh, ("Lagrange", 2))
+    W = FunctionSpace(mesh, ("Lagrange", 1))
+    dofmap = V0._cpp_object.dofmap
+    assert V1._cpp_object.dofmap is dofmap
+    assert W._cpp_object.dofmap is not dofmap
+
+    # Dof maps with a different ordering or on another mesh are not shared
+    V2 = FunctionSpace(mesh, ("Lagrange", 2), dof_ordering=cpp.fem.DofOrdering.random)
+    assert V2._cpp_object.dofmap is not dofmap
+    mesh1 = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    assert FunctionSpace(mesh1, ("Lagrange", 2))._cpp_object.dofmap is not dofmap
+
+
+def test_blocked_dofmap():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = VectorFunctionSpace(mesh, ("Lagrange", 1))
+    assert V.dofmap.bs == 2
+    blocks = V.dofmap.list_blocked.array
+    dofs = V.dofmap.list.array
+    assert len(dofs) == 2 * len(blocks)
+    assert np.array_equal(dofs[0::2], 2 * blocks)
+    assert np.array_equal(dofs[1::2], 2 * blocks + 1)
+
+    # The dofmap of a subspace is not blocked
+    assert V.sub(0).dofmap.bs == 1
+
+
+def test_dofmap_views():
+    """Test that the dofmap arrays are read-only views that keep their
+    owner alive"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = FunctionSpace(mesh, ("Lagrange", 1))
+    dofmap = V.dofmap
+    dofs = dofmap.list.array
+    assert np.shares_memory(dofs, dofmap.list.array)
+    assert not dofs.flags.writeable
+    with pytest.raises(ValueError):
+        dofs[0] = 0
+
+    cell_dofs = dofmap.cell_dofs(1)
+    assert np.shares_memory(cell_dofs, dofs)
+    assert not cell_dofs.flags.writeable
+    assert np.array_equal(cell_dofs, dofmap.list.links(1))
+
+    # The views remain valid when the space is deleted
+    ref = dofs.copy()
+    del V, dofmap
+    assert np.array_equal(dofs, ref)
+
+
+@pytest.mark.parametrize("num_threads", [1, 3])
+def test_patches(num_threads):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 6, 5)
+    V = VectorFunctionSpace(mesh, ("Lagrange", 2))
+    tdim = mesh.topology.dim
+    mesh.topology.create_connectivity(0, tdim)
+    dofmap = V.dofmap.list
+
+    # Vertex stars
+    cells, dofs = cpp.fem.compute_patches(V._cpp_object, 0, False, num_threads)
+    v_to_c = mesh.topology.connectivity(0, tdim)
+    num_vertices = mesh.topology.index_map(0).size_local
+    assert cells.num_nodes == num_vertices
+    assert dofs.num_nodes == num_vertices
+    for v in range(num_vertices):
+        assert np.array_equal(cells.links(v), v_to_c.links(v))
+        patch_dofs = np.unique(np.hstack([dofmap.links(c) for c in v_to_c.links(v)]))
+        assert np.array_equal(dofs.links(v), patch_dofs)
+
+    # Interior dofs of the vertex stars are the dofs of the vertex and of
+    # the edges attached to it (if all neighbouring cells are on this
+    # process)
+    cells1, dofs1 = cpp.fem.compute_patches(V._cpp_object, 0, True, num_threads)
+    assert np.array_equal(cells1.array, cells.array)
+    for v in range(num_vertices):
+        assert np.all(np.isin(dofs1.links(v), dofs.links(v)))
+        if MPI.COMM_WORLD.size == 1 and len(v_to_c.links(v)) == 6:
+            # 2 x (1 vertex + 6 edges)
+            assert len(dofs1.links(v)) == 14
+
+    # Cell patches
+    cells, dofs = cpp.fem.compute_patches(V._cpp_object, tdim, False, num_threads)
+    num_cells = mesh.topology.index_map(tdim).size_local
+    assert np.array_equal(cells.array, np.arange(num_cells))
+    for c in range(num_cells):
+        assert np.array_equal(dofs.links(c), np.sort(dofmap.links(c)))
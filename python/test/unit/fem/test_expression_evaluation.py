@@ -97,3 +97,34 @@ def test_rank0():
     b2.interpolate(grad_expr1)
 
     assert np.isclose((b2.vector - b.vector).norm(), 0.0)
+
+
+def test_expression_eval_cells():
+    """Test batched evaluation of an expression at reference points on all
+    cells, against the exact gradient at the mapped points"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 4, 3)
+    P2 = dolfinx.FunctionSpace(mesh, ("P", 2))
+    f = dolfinx.Function(P2)
+    f.interpolate(lambda x: x[0] ** 2 + 2.0 * x[1] ** 2)
+    c = dolfinx.Constant(mesh, 3.0)
+
+    points = np.array([[0.0, 0.0], [1.0, 0.0], [0.0, 1.0], [1 / 3, 1 / 3]])
+    expr = dolfinx.fem.Expression(c * ufl.grad(f), points)
+    assert np.allclose(expr.x, points)
+
+    num_cells = mesh.topology.index_map(mesh.topology.dim).size_local
+    cells = np.arange(num_cells, dtype=np.int32)
+    values = expr.eval(cells)
+    assert values.shape == (num_cells, len(points), 2)
+
+    x_dofmap = mesh.geometry.dofmap
+    x = mesh.geometry.x
+    for cell in cells:
+        v = x[x_dofmap.links(cell), :2]
+        xp = v[0] + points @ np.vstack((v[1] - v[0], v[2] - v[0]))
+        assert np.allclose(values[cell], 3.0 * np.column_stack((2.0 * xp[:, 0], 4.0 * xp[:, 1])))
+
+    # Evaluation reflects changes of the coefficients and constants
+    f.interpolate(lambda x: x[0])
+    c.value = 2.0
+    assert np.allclose(expr.eval(cells[:1])[0], [[2.0, 0.0]] * len(points))
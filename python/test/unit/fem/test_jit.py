@@ -0,0 +1,44 @@
+# Copyright (C) 2020 Garth N. Wells
+#
+# This file is part of DOLFINX (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+"""Tests for the just-in-time compilation of forms"""
+
+import dolfinx
+import ufl
+from dolfinx import FunctionSpace, UnitSquareMesh
+from dolfinx_utils.test.fixtures import tempdir  # noqa: F401
+from mpi4py import MPI
+
+
+def test_jit_memory_cache():
+    """Test that a form that is compiled again is taken from the
+    in-memory cache"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = FunctionSpace(mesh, ("Lagrange", 1))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    ufc_form0 = dolfinx.jit.ffcx_jit(u * v * ufl.dx, mpi_comm=mesh.mpi_comm())
+
+    # A new but identical form has the same signature
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    ufc_form1 = dolfinx.jit.ffcx_jit(u * v * ufl.dx, mpi_comm=mesh.mpi_comm())
+    assert ufc_form1 == ufc_form0
+
+    # Different parameters give a different compiled form
+    ufc_form2 = dolfinx.jit.ffcx_jit(u * v * ufl.dx, mpi_comm=mesh.mpi_comm(),
+                                     jit_parameters={"cffi_extra_compile_args": ["-O1"]})
+    assert ufc_form2 != ufc_form0
+
+
+def test_jit_node_cache(tempdir):  # noqa: F811
+    """Test compilation with and without the node-local cache"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = FunctionSpace(mesh, ("Lagrange", 2))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    for node_cache_dir in (tempdir, None):
+        a = dolfinx.Form(ufl.inner(ufl.grad(u), ufl.grad(v)) * ufl.dx,
+                         jit_parameters={"node_cache_dir": node_cache_dir})
+        A = dolfinx.fem.assemble_matrix(a)
+        A.assemble()
+        assert A.norm() > 0.0
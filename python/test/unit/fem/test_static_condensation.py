@@ -0,0 +1,132 @@
+# Copyright (C) 2020 Garth N. Wells
+#
+# This file is part of DOLFINX (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+"""Unit tests for static condensation of cell-interior dofs"""
+
+import dolfinx
+import numpy
+import pytest
+import ufl
+from dolfinx import cpp
+from dolfinx.generation import UnitSquareMesh
+from mpi4py import MPI
+from petsc4py import PETSc
+from ufl import ds, dx, grad, inner
+
+
+def solve(A, b, x):
+    ksp = PETSc.KSP().create(A.getComm())
+    ksp.setOperators(A)
+    ksp.setType("preonly")
+    ksp.getPC().setType("lu")
+    ksp.solve(b, x)
+
+
+@pytest.mark.parametrize("mode", [cpp.mesh.GhostMode.none, cpp.mesh.GhostMode.shared_facet])
+@pytest.mark.parametrize("cell_type", [cpp.mesh.CellType.triangle, cpp.mesh.CellType.quadrilateral])
+@pytest.mark.parametrize("degree", [3, 4])
+def test_static_condensation_poisson(degree, cell_type, mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 6, 5, cell_type, ghost_mode=mode)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", degree))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    x = ufl.SpatialCoordinate(mesh)
+    a = dolfinx.fem.Form(inner(grad(u), grad(v)) * dx + inner(u, v) * dx)
+    L = dolfinx.fem.Form(inner(1.0 + x[0] * x[1], v) * dx)
+
+    u_bc = dolfinx.Function(V)
+    u_bc.interpolate(lambda x: 1.0 + x[1])
+    facets = dolfinx.mesh.locate_entities_boundary(mesh, 1, lambda x: numpy.isclose(x[0], 0.0))
+    bcs = [dolfinx.DirichletBC(u_bc, dolfinx.fem.locate_dofs_topological(V, 1, facets))]
+
+    # Solution of the full system
+    A = dolfinx.fem.assemble_matrix(a, bcs)
+    A.assemble()
+    b = dolfinx.fem.assemble_vector(L)
+    dolfinx.fem.apply_lifting(b, [a], [bcs])
+    b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    dolfinx.fem.set_bc(b, bcs)
+    u_ref = dolfinx.Function(V)
+    solve(A, b, u_ref.vector)
+    u_ref.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+
+    # Solution of the condensed system
+    sc = cpp.fem.StaticCondensation(a._cpp_object, L._cpp_object)
+    assert sc.index_map.size_global < V.dofmap.index_map.size_global
+    Ac = sc.create_matrix()
+    Ac.zeroEntries()
+    sc.assemble_matrix(Ac, bcs)
+    Ac.assemblyBegin(PETSc.Mat.AssemblyType.FLUSH)
+    Ac.assemblyEnd(PETSc.Mat.AssemblyType.FLUSH)
+    sc.add_diagonal(Ac, bcs)
+    Ac.assemble()
+
+    bc = cpp.la.create_vector(sc.index_map)
+    with bc.localForm() as b_local:
+        b_local.set(0.0)
+        sc.assemble_vector(b_local.array_w, bcs)
+    bc.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    sc.set_bc(bc.array_w, bcs)
+    xc = bc.duplicate()
+    solve(Ac, bc, xc)
+    xc.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+
+    uh = dolfinx.Function(V)
+    with xc.localForm() as x_local, uh.vector.localForm() as u_local:
+        sc.recover(x_local.array_r, u_local.array_w)
+    uh.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+
+    uh.vector.axpy(-1.0, u_ref.vector)
+    assert uh.vector.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+def test_static_condensation_vector():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 3)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 3))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(grad(u), grad(v)) * dx + inner(u, v) * dx)
+    L = dolfinx.fem.Form(inner(ufl.as_vector((1.0, -2.0)), v) * dx)
+
+    sc = cpp.fem.StaticCondensation(a._cpp_object, L._cpp_object)
+    assert sc.index_map.block_size == 2
+    assert sc.dofmap.cell_dofs(0).size == 2 * 9
+
+    A = dolfinx.fem.assemble_matrix(a)
+    A.assemble()
+    b = dolfinx.fem.assemble_vector(L)
+    b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    u_ref = dolfinx.Function(V)
+    solve(A, b, u_ref.vector)
+    u_ref.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+
+    Ac = sc.create_matrix()
+    Ac.zeroEntries()
+    sc.assemble_matrix(Ac, [])
+    Ac.assemble()
+    bc = cpp.la.create_vector(sc.index_map)
+    with bc.localForm() as b_local:
+        b_local.set(0.0)
+        sc.assemble_vector(b_local.array_w, [])
+    bc.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+    xc = bc.duplicate()
+    solve(Ac, bc, xc)
+    xc.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+
+    uh = dolfinx.Function(V)
+    with xc.localForm() as x_local, uh.vector.localForm() as u_local:
+        sc.recover(x_local.array_r, u_local.array_w)
+    uh.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+
+    uh.vector.axpy(-1.0, u_ref.vector)
+    assert uh.vector.norm() == pytest.approx(0.0, abs=1.0e-10)
+
+
+def test_static_condensation_facet_integral():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = dolfinx.FunctionSpace(mesh, ("Lagrange", 3))
+    u, v = ufl.TrialFunction(V), ufl.TestFunction(V)
+    a = dolfinx.fem.Form(inner(u, v) * dx + inner(u, v) * ds)
+    L = dolfinx.fem.Form(inner(1.0, v) * dx)
+    with pytest.raises(RuntimeError):
+        cpp.fem.StaticCondensation(a._cpp_object, L._cpp_object)
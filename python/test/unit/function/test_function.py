@@ -195,6 +195,92 @@ def test_eval_multiple(W):
     u.eval(x[0], cell)
 
 
+def test_eval_mixed_points_per_cell():
+    """Evaluate a mixed function at several points per cell and compare
+    with the evaluation of the collapsed sub-functions"""
+    mesh = dolfinx.UnitSquareMesh(MPI.COMM_WORLD, 4, 3)
+    P2 = ufl.VectorElement("Lagrange", mesh.ufl_cell(), 2)
+    P1 = ufl.FiniteElement("Lagrange", mesh.ufl_cell(), 1)
+    W = FunctionSpace(mesh, ufl.MixedElement([P2, P1]))
+    u = Function(W)
+    u.vector.setArray(np.random.rand(u.vector.getLocalSize()))
+    u.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+
+    # Points at convex combinations of the cell vertices, a varying
+    # number of points per cell, in a shuffled order
+    x_dofmap = mesh.geometry.dofmap
+    points, cells = [], []
+    for c in range(min(6, mesh.topology.index_map(2).size_local)):
+        xc = mesh.geometry.x[x_dofmap.links(c)]
+        for _ in range(c + 1):
+            w = np.random.rand(3)
+            points.append(w.dot(xc) / w.sum())
+            cells.append(c)
+    order = np.random.permutation(len(points))
+    points, cells = np.array(points)[order], np.array(cells, dtype=np.int32)[order]
+
+    values = u.eval(points, cells)
+    assert values.shape == (len(points), 3)
+    offset = 0
+    for i in range(2):
+        ui = u.sub(i).collapse()
+        vi = ui.eval(points, cells)
+        assert np.allclose(values[:, offset:offset + vi.shape[1]], vi)
+        offset += vi.shape[1]
+
+
+def test_eval_batched(W):
+    """Evaluate a function at a batch of points with the cells from the
+    batched collision queries"""
+    u = Function(W)
+    u.interpolate(lambda x: x)
+    mesh = W.mesh
+    tree = geometry.BoundingBoxTree(mesh, mesh.topology.dim)
+    points = np.vstack((np.random.rand(20, 3), [[2.0, 0.5, 0.5]]))
+    cells = geometry.compute_colliding_cells_points(tree, mesh, points, 1, 1e-10, 2)
+    assert cells.num_nodes == len(points)
+
+    values = u.eval(points, cells)
+    for i, x in enumerate(points):
+        if len(cells.links(i)) > 0:
+            assert np.allclose(values[i], x)
+            assert np.allclose(values[i], u.eval(x, cells.links(i)[0]))
+        else:
+            assert np.allclose(values[i], 0.0)
+    assert len(cells.links(len(points) - 1)) == 0
+
+
+def test_eval_distributed():
+    """Evaluate a function at points that are not on the calling
+    process"""
+    mesh = dolfinx.UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    V = dolfinx.VectorFunctionSpace(mesh, ("Lagrange", 1))
+    u = Function(V)
+    u.interpolate(lambda x: np.vstack((x[0] + 2 * x[1], 3 * x[0])))
+
+    # Each process evaluates at different points, including a point
+    # outside of the mesh
+    rank = mesh.mpi_comm().rank
+    x = np.zeros((5, 3))
+    x[:, 0] = np.linspace(0.1, 0.9, 5)
+    x[:, 1] = (0.13 * (rank + 1)) % 1.0
+    x = np.vstack((x, [2.0, 0.5, 0.0]))
+    exact = np.vstack((x[:, 0] + 2 * x[:, 1], 3 * x[:, 0])).T
+    exact[-1] = 0.0
+
+    values = dolfinx.cpp.function.eval_distributed(u._cpp_object, x)
+    assert np.allclose(values, exact)
+
+    evaluator = dolfinx.cpp.function.PointEvaluator(mesh)
+    evaluator.set_points(x)
+    assert evaluator.num_points == x.shape[0]
+    assert evaluator.found == [True] * 5 + [False]
+    assert np.allclose(evaluator.eval(u._cpp_object), exact)
+    u.vector.scale(2.0)
+    u.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+    assert np.allclose(evaluator.eval(u._cpp_object), 2 * exact)
+
+
 @skip_in_parallel
 def test_eval_manifold():
     # Simple two-triangle surface in 3d
@@ -376,3 +462,67 @@ def test_interpolation_function(mesh):
     uh = Function(Vh)
     uh.interpolate(u)
     assert np.allclose(uh.vector.array, 1)
+
+
+def test_function_vector_pool(V):
+    """Test that vectors of temporary functions are recycled by a pool"""
+    pool = cpp.la.VectorPool(max_size=2)
+    u = Function(V, pool.get(V.dofmap.index_map))
+    u.x.array()[:] = 1.0
+    del u
+    assert pool.size == 1
+
+    # The recycled vector is reset by the function constructor
+    u = cpp.function.Function(V._cpp_object, pool)
+    assert pool.size == 0
+    assert np.all(u.x.array() == 0.0)
+    del u
+    assert pool.size == 1
+
+
+@pytest.mark.parametrize("cell_type", [dolfinx.cpp.mesh.CellType.triangle,
+                                       dolfinx.cpp.mesh.CellType.quadrilateral])
+def test_eval_pull_back(cell_type):
+    """Evaluate a linear function at several points in each cell, which
+    uses the closed-form pull-back on (perturbed) triangles and Newton's
+    method on quadrilaterals"""
+    mesh = dolfinx.UnitSquareMesh(MPI.COMM_WORLD, 4, 4, cell_type)
+    if cell_type == dolfinx.cpp.mesh.CellType.triangle:
+        x = mesh.geometry.x
+        x[:, 0] += 0.05 * np.sin(np.pi * x[:, 0]) * np.sin(np.pi * x[:, 1])
+    V = FunctionSpace(mesh, ("Lagrange", 1))
+    u = Function(V)
+    u.interpolate(lambda x: 1.0 + 2.0 * x[0] - x[1])
+
+    x_dofmap = mesh.geometry.dofmap
+    points, cells = [], []
+    for c in range(mesh.topology.index_map(2).size_local):
+        xc = mesh.geometry.x[x_dofmap.links(c)]
+        for _ in range(4):
+            w = np.random.rand(len(xc))
+            points.append(w.dot(xc) / w.sum())
+            cells.append(c)
+    points, cells = np.array(points), np.array(cells, dtype=np.int32)
+    values = u.eval(points, cells)
+    assert np.allclose(values[:, 0], 1.0 + 2.0 * points[:, 0] - points[:, 1])
+
+
+def test_pretabulate_reference_basis(V):
+    """Test that pretabulated point sets are cached on the element and
+    do not change the values of eval"""
+    u = Function(V)
+    u.interpolate(lambda x: 1.0 + x[0] + 2.0 * x[1] - x[2])
+    mesh = V.mesh
+    points = np.array([mesh.geometry.x[mesh.geometry.dofmap.links(c)].mean(axis=0) for c in range(2)])
+    cells = np.array([0, 1], dtype=np.int32)
+    values = u.eval(points, cells)
+
+    element = V.element
+    element.clear_tabulations()
+    X = element.dof_reference_coordinates()
+    element.pretabulate(X, 1)
+    element.pretabulate(X)
+    assert element.num_tabulations() == 1
+    assert np.allclose(u.eval(points, cells), values)
+    element.clear_tabulations()
+    assert element.num_tabulations() == 0
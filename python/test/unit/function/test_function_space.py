@@ -5,6 +5,7 @@
 # SPDX-License-Identifier:    LGPL-3.0-or-later
 """Unit tests for the FunctionSpace class"""
 
+import numpy as np
 import pytest
 from dolfinx import Function, FunctionSpace, UnitCubeMesh, VectorFunctionSpace
 from mpi4py import MPI
@@ -167,6 +168,42 @@ def test_collapse(W, V):
     assert f0.vector.getSize() == f1.vector.getSize()
 
 
+def test_collapse_cached(W):
+    """Test that collapsed spaces are cached and that the collapsed view of
+    a sub-function matches the collapsed sub-function"""
+    Vs = W.sub(0)
+    V0, dofs0 = Vs._cpp_object.collapsed()
+    V1, dofs1 = W.sub(0)._cpp_object.collapsed()
+    assert V0.id == V1.id
+    assert np.array_equal(dofs0, dofs1)
+
+    u = Function(W)
+    u.interpolate(lambda x: np.vstack((x[0], 2 * x[1], 3 * x[2])))
+    for i in range(3):
+        ui = u.sub(i).collapse()
+        view = u.sub(i)._cpp_object.collapsed_view()
+        assert view.size == len(ui.x.array())
+        assert np.allclose(view.array(), ui.x.array())
+
+        # Writing through the view modifies the parent function
+        view.set(2 * view.array())
+        assert np.allclose(u.sub(i).collapse().x.array(), 2 * ui.x.array())
+
+
+def test_dof_coordinates_cached(mesh, V, W):
+    """Test that the cached dof coordinates are repeated for blocked
+    spaces and updated when the mesh is moved"""
+    x = V.tabulate_dof_coordinates()
+    xw = W.tabulate_dof_coordinates()
+    assert xw.shape[0] == 3 * x.shape[0]
+    for j in range(1, 3):
+        assert np.allclose(xw[0::3], xw[j::3])
+
+    mesh.geometry.x[:, 0] += 1.0
+    assert np.allclose(V.tabulate_dof_coordinates()[:, 0], x[:, 0] + 1.0)
+    assert np.allclose(W.tabulate_dof_coordinates()[0::3, 0], xw[0::3, 0] + 1.0)
+
+
 def test_argument_equality(mesh, V, V2, W, W2):
     """Placed this test here because it's mainly about detecting differing
     function spaces.
@@ -7,6 +7,7 @@
 
 import random
 
+import dolfinx
 import numpy as np
 import pytest
 import ufl
@@ -164,3 +165,99 @@ def test_mixed_interpolation(cell_type, order):
 
     for p, v in zip(points, values):
         assert np.allclose(v, f(p))
+
+
+def test_interpolation_moved_mesh():
+    """Test that repeated interpolation uses the current geometry after
+    the mesh has been moved"""
+    mesh = dolfinx.UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = FunctionSpace(mesh, ("Lagrange", 2))
+    W = FunctionSpace(mesh, ufl.MixedElement([ufl.FiniteElement("Lagrange", mesh.ufl_cell(), 1),
+                                              ufl.VectorElement("Lagrange", mesh.ufl_cell(), 2)]))
+    u, w = Function(V), Function(W)
+
+    def f(x):
+        return x[0] + 2 * x[1]
+
+    def g(x):
+        return np.vstack((x[0], x[1], 3 * x[0]))
+
+    for step in range(3):
+        u.interpolate(f)
+        w.interpolate(g)
+        x = V.tabulate_dof_coordinates()
+        n = u.vector.getLocalSize()
+        assert np.allclose(u.vector.array, f(x[:n].T))
+        cells = np.zeros(3, dtype=np.int32)
+        xc = mesh.geometry.x[mesh.geometry.dofmap.links(0)]
+        assert np.allclose(w.eval(xc, cells), g(xc.T).T)
+        mesh.geometry.x[:, :2] *= 1.5
+
+
+@pytest.mark.parametrize("degree", [1, 2])
+def test_interpolation_nonmatching_meshes(degree):
+    """Test interpolation between non-matching meshes in parallel, once
+    and repeatedly with a cached point evaluator"""
+    mesh0 = dolfinx.UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    mesh1 = dolfinx.UnitSquareMesh(MPI.COMM_WORLD, 5, 7, dolfinx.cpp.mesh.CellType.quadrilateral)
+    V0 = FunctionSpace(mesh0, ("Lagrange", degree))
+    V1 = FunctionSpace(mesh1, ("Lagrange", degree))
+    u0, u1 = Function(V0), Function(V1)
+
+    def f(x):
+        return 1 + x[0] + 2 * x[1]
+
+    u0.interpolate(f)
+    u1.interpolate(u0)
+    x = V1.tabulate_dof_coordinates()
+    n = u1.vector.getLocalSize()
+    assert np.allclose(u1.vector.array, f(x[:n].T))
+
+    evaluator = cpp.function.create_interpolation_evaluator(V1._cpp_object, mesh0)
+    for step in range(1, 3):
+        u0.interpolate(lambda x: 2**step * f(x))
+        u1.interpolate(u0, evaluator)
+        assert np.allclose(u1.vector.array, 2**step * f(x[:n].T))
+
+
+@pytest.mark.parametrize("cell_type", [CellType.triangle, CellType.quadrilateral])
+@pytest.mark.parametrize("degrees", [(2, 1), (1, 2), (1, 3), (3, 2)])
+def test_interpolation_same_mesh(cell_type, degrees):
+    """Test interpolation between different spaces on the same mesh with
+    local interpolation matrices, for scalar, vector and mixed subspaces"""
+    mesh = dolfinx.UnitSquareMesh(MPI.COMM_WORLD, 5, 4, cell_type)
+    p0, p1 = degrees
+    p = min(degrees)
+
+    def f(x):
+        return 1 + x[0]**p + 2 * x[1]
+
+    def g(x):
+        return np.vstack((x[0], x[1]**p - x[0]))
+
+    V0, V1 = FunctionSpace(mesh, ("Lagrange", p0)), FunctionSpace(mesh, ("Lagrange", p1))
+    u0, u1 = Function(V0), Function(V1)
+    u0.interpolate(f)
+    for step in range(2):
+        u1.interpolate(u0)
+        x = V1.tabulate_dof_coordinates()
+        n = u1.vector.getLocalSize()
+        assert np.allclose(u1.vector.array, f(x[:n].T))
+
+    W0, W1 = VectorFunctionSpace(mesh, ("Lagrange", p0)), VectorFunctionSpace(mesh, ("Lagrange", p1))
+    w0, w1 = Function(W0), Function(W1)
+    w0.interpolate(g)
+    w1.interpolate(w0)
+    x = W1.tabulate_dof_coordinates()
+    n = w1.vector.getLocalSize() // 2
+    assert np.allclose(w1.vector.array.reshape(-1, 2), g(x[:n].T).T)
+
+    # Interpolate from a subspace of a mixed space
+    Q = FunctionSpace(mesh, ufl.MixedElement([ufl.FiniteElement("Lagrange", mesh.ufl_cell(), p0),
+                                              ufl.VectorElement("Lagrange", mesh.ufl_cell(), p0)]))
+    q = Function(Q)
+    q.interpolate(lambda x: np.vstack((f(x), g(x))))
+    u1.interpolate(q.sub(0))
+    x = V1.tabulate_dof_coordinates()
+    n = u1.vector.getLocalSize()
+    assert np.allclose(u1.vector.array, f(x[:n].T))
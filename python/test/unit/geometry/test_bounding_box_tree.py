@@ -7,7 +7,8 @@
 
 import numpy
 import pytest
-from dolfinx import UnitCubeMesh, UnitIntervalMesh, UnitSquareMesh, geometry
+from dolfinx import UnitCubeMesh, UnitIntervalMesh, UnitSquareMesh, cpp, geometry
+from dolfinx.cpp.mesh import CellType
 from dolfinx.geometry import BoundingBoxTree
 from dolfinx_utils.test.skips import skip_in_parallel
 from mpi4py import MPI
@@ -137,3 +138,173 @@ def test_compute_closest_entity_3d():
     entity, distance = geometry.compute_closest_entity(tree, tree_mid, mesh, p)
     assert entity == reference[0]
     assert distance[0] == pytest.approx(reference[1], 1.0e-12)
+
+
+@pytest.mark.parametrize("method", [cpp.geometry.BuildMethod.median, cpp.geometry.BuildMethod.sah,
+                                    cpp.geometry.BuildMethod.linear])
+def test_build_threaded(method):
+    """Test that trees built on several threads, and with the other
+    build methods, find the same cells as the serial tree"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 12, 12, 12)
+    tdim = mesh.topology.dim
+    tree0 = BoundingBoxTree(mesh, tdim)
+    tree1 = BoundingBoxTree(mesh, tdim, num_threads=4, method=method)
+    for p in numpy.random.rand(20, 3):
+        entities0 = geometry.compute_collisions_point(tree0, p)
+        entities1 = geometry.compute_collisions_point(tree1, p)
+        assert set(entities0) == set(entities1)
+
+
+def test_refit():
+    """Test that a refitted tree finds the cells of the moved mesh"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    tree = BoundingBoxTree(mesh, mesh.topology.dim)
+    x = mesh.geometry.x
+    x[:, 0] = 2.0 * x[:, 0] + 0.5 * x[:, 1] ** 2
+    assert not tree.refit(mesh)
+
+    tree0 = BoundingBoxTree(mesh, mesh.topology.dim)
+    p = numpy.array([1.2, 0.7, 0.0])
+    entities0 = geometry.compute_collisions_point(tree0, p)
+    entities = geometry.compute_collisions_point(tree, p)
+    assert set(entities) == set(entities0)
+
+    # Shuffle the vertices to degrade the overlap of the boxes
+    numpy.random.seed(1)
+    x[:, :2] = x[numpy.random.permutation(x.shape[0]), :2]
+    assert tree.refit(mesh, rebuild_factor=1.5)
+
+
+def test_compute_collisions_points():
+    """Test that batched point queries find the same entities as
+    queries for single points"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 4, 4)
+    tree = BoundingBoxTree(mesh, mesh.topology.dim)
+    points = numpy.random.rand(37, 3)
+    for num_threads in [1, 2]:
+        entities = geometry.compute_collisions_points(tree, points, num_threads)
+        assert entities.num_nodes == points.shape[0]
+        for i, p in enumerate(points):
+            assert list(entities.links(i)) == geometry.compute_collisions_point(tree, p)
+
+
+def test_compact_tree():
+    """Test that a compact tree finds the same entities as the binary
+    tree"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 4, 4)
+    tree = BoundingBoxTree(mesh, mesh.topology.dim)
+    compact = geometry.CompactBoundingBoxTree(tree)
+    points = numpy.vstack((numpy.random.rand(37, 3), mesh.geometry.x[:5]))
+    entities = geometry.compute_collisions_points(compact, points, 2)
+    for i, p in enumerate(points):
+        reference = geometry.compute_collisions_point(tree, p)
+        assert sorted(geometry.compute_collisions_point(compact, p)) == sorted(reference)
+        assert sorted(entities.links(i)) == sorted(reference)
+
+
+def test_distributed_collisions():
+    """Test collisions between the cells of two overlapping distributed
+    meshes"""
+    mesh0 = UnitSquareMesh(MPI.COMM_WORLD, 6, 6)
+    mesh1 = UnitSquareMesh(MPI.COMM_WORLD, 5, 7)
+    mesh1.geometry.x[:, 0] += 0.5
+    tdim = mesh0.topology.dim
+    tree0 = BoundingBoxTree(mesh0, tdim)
+    tree1 = BoundingBoxTree(mesh1, tdim)
+
+    collisions = geometry.DistributedCollisions(MPI.COMM_WORLD)
+    pairs = collisions.compute(tree0, tree1)
+    assert pairs == collisions.compute(tree0, tree1)
+    if MPI.COMM_WORLD.size == 1:
+        reference = geometry.compute_collisions(tree0, tree1)
+        assert sorted([e0, 0, e1] for e0, e1 in reference) == pairs
+
+    # The cells of mesh0 that reach the left side of mesh1 collide
+    num_cells = mesh0.topology.index_map(tdim).size_local
+    x_dofs = mesh0.geometry.dofmap.array.reshape(-1, 3)[:num_cells]
+    xmax = mesh0.geometry.x[x_dofs, 0].max(axis=1)
+    found = set(e0 for e0, _, _ in pairs)
+    assert set(numpy.where(xmax > 0.5 - 1.0e-10)[0]) == found & set(range(num_cells))
+
+
+@pytest.mark.parametrize("k", [1, 4])
+def test_compute_closest_k(k):
+    """Test k-nearest queries against brute force distances"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 5, 5)
+    tdim = mesh.topology.dim
+    points = numpy.random.rand(23, 3) * 1.5 - 0.25
+    points[:, 2] = 0.0
+
+    x = mesh.geometry.x
+    tree = BoundingBoxTree(list(x))
+    indices, distances = geometry.compute_closest_points(tree, points, k, num_threads=2)
+    for p, i, d in zip(points, indices, distances):
+        reference = numpy.sort(numpy.linalg.norm(x - p, axis=1))[:k]
+        assert numpy.allclose(d, reference)
+        assert numpy.allclose(numpy.linalg.norm(x[i] - p, axis=1), d)
+
+    tree = BoundingBoxTree(mesh, tdim)
+    num_cells = mesh.topology.index_map(tdim).size_local + mesh.topology.index_map(tdim).num_ghosts
+    entities, distances = geometry.compute_closest_entities(tree, mesh, points, k)
+    for p, e, d in zip(points, entities, distances):
+        reference = sorted(numpy.sqrt(cpp.geometry.squared_distance(mesh, tdim, c, p)) for c in range(num_cells))
+        assert numpy.allclose(d, reference[:k])
+
+
+@pytest.mark.parametrize("neighbour_processes,shared_memory", [(False, False), (True, False), (False, True)])
+def test_process_tree(neighbour_processes, shared_memory):
+    """Test that the process trees of the trees of a mesh find the
+    processes that contain the mesh vertices"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 4, 4)
+    rank = MPI.COMM_WORLD.rank
+    trees = [BoundingBoxTree(mesh, dim, neighbour_processes=neighbour_processes, shared_memory=shared_memory)
+             for dim in range(1, 4)]
+    for x in mesh.geometry.x[:5]:
+        ranks = [geometry.compute_process_collisions(tree, x) for tree in trees]
+        assert rank in ranks[0]
+        assert ranks[0] == ranks[1] == ranks[2]
+
+
+@pytest.mark.parametrize("mesh", [UnitIntervalMesh(MPI.COMM_WORLD, 7),
+                                  UnitSquareMesh(MPI.COMM_WORLD, 4, 5),
+                                  UnitSquareMesh(MPI.COMM_WORLD, 4, 5, CellType.quadrilateral),
+                                  UnitCubeMesh(MPI.COMM_WORLD, 3, 4, 2),
+                                  UnitCubeMesh(MPI.COMM_WORLD, 3, 4, 2, CellType.hexahedron)])
+def test_select_colliding_cells(mesh):
+    """Test the closed-form point-in-cell tests against the distances to
+    the cells"""
+    tdim = mesh.topology.dim
+    tree = BoundingBoxTree(mesh, tdim)
+    points = numpy.zeros((20, 3))
+    points[:, :tdim] = numpy.random.rand(20, tdim)
+    points = numpy.vstack((points, mesh.geometry.x[:3]))
+    for p in points:
+        candidates = geometry.compute_collisions_point(tree, p)
+        cells = cpp.geometry.select_colliding_cells(mesh, candidates, p, 0)
+        reference = [c for c in candidates if cpp.geometry.squared_distance(mesh, tdim, c, p) < 1.0e-20]
+        assert cells == reference
+
+        # Points off the plane of the mesh
+        if tdim < 3:
+            p[2] = 1.0e-3
+            assert cpp.geometry.select_colliding_cells(mesh, candidates, p, 0) == []
+
+
+def test_select_colliding_cells_points():
+    """Test that the batched selection of colliding cells finds the same
+    cells as the selection for single points"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 4, 4)
+    tree = BoundingBoxTree(mesh, mesh.topology.dim)
+    points = numpy.vstack((numpy.random.rand(37, 3), mesh.geometry.x[:5]))
+    candidates = geometry.compute_collisions_points(tree, points)
+    for n in [0, 1]:
+        for num_threads in [1, 2]:
+            cells = cpp.geometry.select_colliding_cells(mesh, candidates, points, n, 1e-10, num_threads)
+            assert cells.num_nodes == points.shape[0]
+            for i, p in enumerate(points):
+                reference = cpp.geometry.select_colliding_cells(mesh, candidates.links(i), p, n)
+                assert list(cells.links(i)) == reference
+
+    cells = geometry.compute_colliding_cells_points(tree, mesh, points)
+    for i, p in enumerate(points):
+        assert list(cells.links(i)) == geometry.compute_colliding_cells(tree, mesh, p)
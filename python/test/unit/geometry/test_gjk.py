@@ -186,3 +186,27 @@ def test_collision_2nd_order_triangle():
     # point = np.array([0.25, 0.89320760, 0])
     distance = cpp.geometry.squared_distance(mesh, mesh.topology.dim - 1, 2, point)
     assert np.isclose(distance, 0)
+
+
+def test_batched_distances():
+    """Test that batched distances between tetrahedra and triangles
+    match the distances of the single pairs"""
+    np.random.seed(3)
+    tets = np.random.rand(20, 12)
+    triangles = np.random.rand(15, 9)
+    triangles[:, 0::3] += 1.0
+    pairs = [(i, j) for i in range(20) for j in range(15)]
+    for num_threads in [1, 2]:
+        v = cpp.geometry.compute_distances_gjk(tets, triangles, pairs, num_threads=num_threads)
+        for (i, j), vij in zip(pairs, v):
+            ref = compute_distance_gjk(tets[i].reshape(4, 3), triangles[j].reshape(3, 3))
+            assert np.allclose(vij, ref)
+
+    # Pairs further apart than max_distance only give a separation bound
+    v = cpp.geometry.compute_distances_gjk(tets, triangles, pairs, max_distance=0.2)
+    for (i, j), vij in zip(pairs, v):
+        ref = np.linalg.norm(compute_distance_gjk(tets[i].reshape(4, 3), triangles[j].reshape(3, 3)))
+        if ref <= 0.2:
+            assert np.isclose(np.linalg.norm(vij), ref)
+        else:
+            assert np.linalg.norm(vij) > 0.2
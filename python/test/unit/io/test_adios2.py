@@ -0,0 +1,54 @@
+# Copyright (C) 2020 Garth N. Wells
+#
+# This file is part of DOLFINX (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+
+import os
+
+import pytest
+from dolfinx import Function, FunctionSpace, UnitSquareMesh, VectorFunctionSpace
+from dolfinx.common import has_adios2
+from dolfinx.io import ADIOS2Writer
+from dolfinx_utils.test.fixtures import tempdir
+from mpi4py import MPI
+
+assert (tempdir)
+
+
+@pytest.mark.skipif(not has_adios2, reason="Requires ADIOS2")
+def test_adios2_mesh(tempdir):
+    filename = os.path.join(tempdir, "mesh.bp")
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    with ADIOS2Writer(mesh.mpi_comm(), filename, mesh) as f:
+        f.write(0.0)
+    assert os.path.exists(filename)
+
+
+@pytest.mark.skipif(not has_adios2, reason="Requires ADIOS2")
+def test_adios2_function_series(tempdir):
+    filename = os.path.join(tempdir, "u.bp")
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    u = Function(FunctionSpace(mesh, ("Lagrange", 1)))
+    v = Function(VectorFunctionSpace(mesh, ("Lagrange", 1)))
+    u.name, v.name = "u", "v"
+    with ADIOS2Writer(mesh.mpi_comm(), filename, [u, v]) as f:
+        for t in range(3):
+            u.vector.set(t)
+            v.vector.set(2 * t)
+            f.write(t)
+
+    # Moving the mesh writes the geometry again
+    with ADIOS2Writer(mesh.mpi_comm(), filename, [u]) as f:
+        f.write(0.0)
+        mesh.geometry.x[:, 0] += 1.0
+        f.write(1.0)
+    assert os.path.exists(filename)
+
+
+@pytest.mark.skipif(not has_adios2, reason="Requires ADIOS2")
+def test_adios2_async_requires_bp5(tempdir):
+    filename = os.path.join(tempdir, "u.bp")
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    with pytest.raises(RuntimeError):
+        ADIOS2Writer(mesh.mpi_comm(), filename, mesh, engine="BP4", async_write=True)
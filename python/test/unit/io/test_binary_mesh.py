@@ -0,0 +1,68 @@
+# Copyright (C) 2020 Garth N. Wells
+#
+# This file is part of DOLFINX (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+
+import os
+
+import numpy as np
+import pytest
+import ufl
+from dolfinx import UnitCubeMesh, UnitSquareMesh
+from dolfinx.cpp.mesh import GhostMode
+from dolfinx.io import read_binary_mesh, write_binary_mesh
+from dolfinx_utils.test.fixtures import tempdir
+from dolfinx_utils.test.skips import skip_in_serial
+from mpi4py import MPI
+
+assert (tempdir)
+
+
+def sum_x(mesh):
+    x = mesh.geometry.x[:mesh.geometry.index_map().size_local]
+    return mesh.mpi_comm().allreduce(x.sum(), op=MPI.SUM)
+
+
+@pytest.mark.parametrize("ghost_mode", [GhostMode.none, GhostMode.shared_facet])
+def test_binary_mesh_same_partition(tempdir, ghost_mode):
+    filename = os.path.join(tempdir, "mesh.bin")
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 4, 4, ghost_mode=ghost_mode)
+    write_binary_mesh(filename, mesh)
+
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", ufl.tetrahedron, 1))
+    mesh1 = read_binary_mesh(MPI.COMM_WORLD, filename, domain, ghost_mode)
+    tdim = mesh.topology.dim
+    for dim in (0, tdim):
+        assert mesh1.topology.index_map(dim).size_global == mesh.topology.index_map(dim).size_global
+    assert mesh1.topology.index_map(tdim).size_local == mesh.topology.index_map(tdim).size_local
+    assert mesh1.topology.index_map(tdim).num_ghosts == mesh.topology.index_map(tdim).num_ghosts
+    assert sum_x(mesh1) == pytest.approx(sum_x(mesh))
+
+
+@skip_in_serial
+def test_binary_mesh_repartition(tempdir):
+    # Write on one process and read on all processes
+    filename = os.path.join(tempdir, "mesh_serial.bin")
+    if MPI.COMM_WORLD.rank == 0:
+        mesh = UnitSquareMesh(MPI.COMM_SELF, 8, 8)
+        write_binary_mesh(filename, mesh)
+        size = (mesh.topology.index_map(2).size_global, sum_x(mesh))
+    else:
+        size = None
+    size = MPI.COMM_WORLD.bcast(size, root=0)
+
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", ufl.triangle, 1))
+    mesh1 = read_binary_mesh(MPI.COMM_WORLD, filename, domain)
+    assert mesh1.topology.index_map(2).size_global == size[0]
+    assert sum_x(mesh1) == pytest.approx(size[1])
+
+
+def test_binary_mesh_wrong_file(tempdir):
+    filename = os.path.join(tempdir, "not_a_mesh.bin")
+    if MPI.COMM_WORLD.rank == 0:
+        np.arange(100, dtype=np.int64).tofile(filename)
+    MPI.COMM_WORLD.barrier()
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", ufl.triangle, 1))
+    with pytest.raises(RuntimeError):
+        read_binary_mesh(MPI.COMM_WORLD, filename, domain)
@@ -0,0 +1,76 @@
+# Copyright (C) 2020 Garth N. Wells
+#
+# This file is part of DOLFINX (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+
+import os
+
+import numpy as np
+import pytest
+import ufl
+from dolfinx import Function, FunctionSpace, UnitSquareMesh
+from dolfinx.fem import assemble_scalar
+from dolfinx.io import (read_checkpoint_function, read_checkpoint_mesh,
+                        write_checkpoint)
+from dolfinx_utils.test.fixtures import tempdir
+from dolfinx_utils.test.skips import skip_in_serial
+from mpi4py import MPI
+
+assert (tempdir)
+
+
+def create_function(mesh):
+    V = FunctionSpace(mesh, ("Lagrange", 2))
+    u = Function(V)
+    u.interpolate(lambda x: 1.0 + x[0] * x[0] + 2.0 * x[0] * x[1])
+    return u
+
+
+def triangle_domain():
+    return ufl.Mesh(ufl.VectorElement("Lagrange", ufl.triangle, 1))
+
+
+def norm(u):
+    return u.function_space.mesh.mpi_comm().allreduce(assemble_scalar(u * u * ufl.dx), op=MPI.SUM)
+
+
+def test_checkpoint_same_partition(tempdir):
+    filename = os.path.join(tempdir, "checkpoint.h5")
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    u = create_function(mesh)
+    write_checkpoint(filename, mesh, {"u": u})
+
+    mesh1, cell_index = read_checkpoint_mesh(MPI.COMM_WORLD, filename, triangle_domain())
+    assert np.allclose(mesh1.geometry.x, mesh.geometry.x)
+    assert np.all(mesh1.geometry.dofmap.array == mesh.geometry.dofmap.array)
+    tdim = mesh.topology.dim
+    assert mesh1.topology.index_map(tdim).size_local == mesh.topology.index_map(tdim).size_local
+    assert mesh1.topology.index_map(tdim).num_ghosts == mesh.topology.index_map(tdim).num_ghosts
+
+    u1 = Function(FunctionSpace(mesh1, ("Lagrange", 2)))
+    read_checkpoint_function(filename, u1, "u", cell_index)
+    assert u1.vector.getSize() == u.vector.getSize()
+    assert norm(u1) == pytest.approx(norm(u), rel=1e-12)
+
+    with pytest.raises(RuntimeError):
+        read_checkpoint_function(filename, u1, "v", cell_index)
+
+
+@skip_in_serial
+def test_checkpoint_repartition(tempdir):
+    # Write on one process and restart on all processes
+    filename = os.path.join(tempdir, "checkpoint_serial.h5")
+    if MPI.COMM_WORLD.rank == 0:
+        mesh = UnitSquareMesh(MPI.COMM_SELF, 8, 8)
+        u = create_function(mesh)
+        write_checkpoint(filename, mesh, {"u": u})
+        norm0 = norm(u)
+    else:
+        norm0 = None
+    norm0 = MPI.COMM_WORLD.bcast(norm0, root=0)
+
+    mesh1, cell_index = read_checkpoint_mesh(MPI.COMM_WORLD, filename, triangle_domain())
+    u1 = Function(FunctionSpace(mesh1, ("Lagrange", 2)))
+    read_checkpoint_function(filename, u1, "u", cell_index)
+    assert norm(u1) == pytest.approx(norm0, rel=1e-12)
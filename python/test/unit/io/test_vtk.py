@@ -10,6 +10,7 @@ import pytest
 from dolfinx import (Function, FunctionSpace, TensorFunctionSpace,
                      UnitCubeMesh, UnitIntervalMesh, UnitSquareMesh,
                      VectorFunctionSpace)
+from dolfinx.common import has_zlib
 from dolfinx.cpp.mesh import CellType
 from dolfinx.io import VTKFile
 from dolfinx_utils.test.fixtures import tempdir
@@ -188,3 +189,53 @@ def test_save_3d_tensor(tempfile, file_options):
     f.write(u, 1.)
     for file_option in file_options:
         VTKFile(tempfile + "u.pvd", file_option).write(u)
+
+
+@pytest.mark.parametrize("encoding, compress", [("ascii", False), ("base64", False), ("raw", False),
+                                                ("base64", True), ("raw", True)])
+def test_save_binary(tempfile, encoding, compress):
+    if compress and not has_zlib:
+        pytest.skip("DOLFINX is not compiled with zlib")
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    u = Function(VectorFunctionSpace(mesh, ("Lagrange", 1)))
+    u.vector.set(1.0)
+    filename = tempfile + encoding + str(compress) + "u.pvd"
+    f = VTKFile(filename, getattr(VTKFile.Encoding, encoding), compress)
+    f.write(u, 0.)
+    f.write(u, 1.)
+
+    # Check the header and the appended data section of the .vtu files
+    rank, size = MPI.COMM_WORLD.rank, MPI.COMM_WORLD.size
+    proc = "_p{}_".format(rank) if size > 1 else ""
+    for step in range(2):
+        with open(tempfile + encoding + str(compress) + "u" + proc + "{:06d}.vtu".format(step), "rb") as vtu:
+            data = vtu.read()
+        assert data.endswith(b"</VTKFile>")
+        if encoding == "ascii":
+            assert b"AppendedData" not in data
+        else:
+            assert b'header_type="UInt64"' in data
+            assert 'AppendedData  encoding="{}"'.format(encoding).encode() in data
+            assert (b"vtkZLibDataCompressor" in data) == compress
+
+
+@pytest.mark.parametrize("degree", [1, 2])
+@pytest.mark.parametrize("family", ["Lagrange", "DG"])
+def test_save_dof_layout(tempfile, family, degree):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = VectorFunctionSpace(mesh, (family, degree))
+    u = Function(V)
+    u.vector.set(1.0)
+    filename = tempfile + family + str(degree) + "u.pvd"
+    VTKFile(filename).write(u)
+
+    # The points are the dofs of the scalar subspace and the point data
+    # are the expansion coefficients
+    rank, size = MPI.COMM_WORLD.rank, MPI.COMM_WORLD.size
+    proc = "_p{}_".format(rank) if size > 1 else ""
+    with open(tempfile + family + str(degree) + "u" + proc + "000000.vtu", "r") as vtu:
+        data = vtu.read()
+    num_points = V.dofmap.index_map.block_size * (V.dofmap.index_map.size_local
+                                                  + V.dofmap.index_map.num_ghosts) // 2
+    assert 'NumberOfPoints="{}"'.format(num_points) in data
+    assert "<PointData" in data and "<CellData" not in data
@@ -11,7 +11,7 @@ from dolfinx import (Function, FunctionSpace, TensorFunctionSpace,
                      UnitCubeMesh, UnitIntervalMesh, UnitSquareMesh,
                      VectorFunctionSpace, has_petsc_complex)
 from dolfinx.cpp.mesh import CellType
-from dolfinx.io import XDMFFile
+from dolfinx.io import AsyncXDMFFile, XDMFFile
 from dolfinx_utils.test.fixtures import tempdir
 from mpi4py import MPI
 
@@ -152,3 +152,52 @@ def test_save_3d_vector_series(tempdir, encoding, cell_type):
     with XDMFFile(mesh.mpi_comm(), filename, "a", encoding=encoding) as file:
         u.vector.set(3.0 + (3j if has_petsc_complex else 0))
         file.write_function(u, 0.3)
+
+
+@pytest.mark.parametrize("encoding", encodings)
+def test_save_series_incremental(tempdir, encoding):
+    import xml.etree.ElementTree as ET
+    filename = os.path.join(tempdir, "u_series.xdmf")
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = FunctionSpace(mesh, ("Lagrange", 1))
+    u, v = Function(V), Function(V)
+    u.name, v.name = "u", "v"
+    with XDMFFile(mesh.mpi_comm(), filename, "w", encoding=encoding) as file:
+        file.write_mesh(mesh)
+        for i in range(4):
+            file.write_function(u, i)
+        file.write_function(v, 0.0)
+        file.write_function(u, 4.0)
+        file.write_function(v, 1.0)
+        file.write_function(v, 2.0)
+
+    mesh.mpi_comm().barrier()
+    domain = ET.parse(filename).getroot().find("Domain")
+    series = {g.get("Name"): g for g in domain.findall("Grid") if g.get("GridType") == "Collection"}
+    times = {name: [float(s.find("Time").get("Value")) for s in g.findall("Grid")] for name, g in series.items()}
+    assert times["u"] == [0.0, 1.0, 2.0, 3.0, 4.0]
+    assert times["v"] == [0.0, 1.0, 2.0]
+
+
+@pytest.mark.skipif(MPI.Query_thread() < MPI.THREAD_MULTIPLE, reason="Requires MPI_THREAD_MULTIPLE")
+@pytest.mark.parametrize("max_queue_size", [1, 2])
+def test_save_series_async(tempdir, max_queue_size):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    V = FunctionSpace(mesh, ("Lagrange", 1))
+    u = Function(V)
+    filename_sync = os.path.join(tempdir, "u_sync.xdmf")
+    filename_async = os.path.join(tempdir, "u_async.xdmf")
+    with XDMFFile(mesh.mpi_comm(), filename_sync, "w") as file, \
+            AsyncXDMFFile(mesh.mpi_comm(), filename_async, "w", max_queue_size=max_queue_size) as async_file:
+        assert async_file.max_queue_size == max_queue_size
+        file.write_mesh(mesh)
+        async_file.write_mesh(mesh)
+        for i in range(4):
+            u.vector.set(float(i))
+            file.write_function(u, i)
+            async_file.write_function(u, i)
+        async_file.flush()
+
+    mesh.mpi_comm().barrier()
+    with open(filename_sync) as f0, open(filename_async) as f1:
+        assert f0.read() == f1.read().replace("u_async.h5", "u_sync.h5")
@@ -140,3 +140,72 @@ def test_read_write_p2_mesh(tempdir, encoding):
     assert mesh.topology.index_map(0).size_global == mesh2.topology.index_map(0).size_global
     assert mesh.topology.index_map(mesh.topology.dim).size_global == mesh2.topology.index_map(
         mesh.topology.dim).size_global
+
+
+def test_read_mesh_partition_file(tempdir):
+    filename = os.path.join(tempdir, "mesh.xdmf")
+    partition_file = os.path.join(tempdir, "mesh_partition.h5")
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12)
+    with XDMFFile(mesh.mpi_comm(), filename, "w") as file:
+        file.write_mesh(mesh)
+    if MPI.COMM_WORLD.rank == 0 and os.path.exists(partition_file):
+        os.remove(partition_file)
+    MPI.COMM_WORLD.barrier()
+
+    # The first read computes and stores the partition, and the second
+    # read reuses it
+    with XDMFFile(MPI.COMM_WORLD, filename, "r") as file:
+        mesh0 = file.read_mesh(partition_file=partition_file)
+    assert os.path.exists(partition_file)
+    with XDMFFile(MPI.COMM_WORLD, filename, "r") as file:
+        mesh1 = file.read_mesh(partition_file=partition_file)
+    for m in (mesh0, mesh1):
+        assert m.topology.index_map(2).size_global == mesh.topology.index_map(2).size_global
+    assert mesh0.topology.index_map(2).size_local == mesh1.topology.index_map(2).size_local
+    assert mesh0.topology.index_map(2).num_ghosts == mesh1.topology.index_map(2).num_ghosts
+
+    # A partition stored for different mesh data is not used
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    with XDMFFile(mesh.mpi_comm(), filename, "w") as file:
+        file.write_mesh(mesh)
+    with XDMFFile(MPI.COMM_WORLD, filename, "r") as file:
+        mesh2 = file.read_mesh(partition_file=partition_file)
+    assert mesh2.topology.index_map(2).size_global == mesh.topology.index_map(2).size_global
+
+
+def test_save_and_load_mesh_hdf5_properties(tempdir):
+    filename = os.path.join(tempdir, "mesh_compressed.xdmf")
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 6, 6, 6)
+    properties = cpp.io.HDF5Properties()
+    properties.deflate = 4
+    properties.shuffle = True
+    properties.alignment = 4096
+    properties.mpi_hints = [("romio_cb_write", "enable")]
+    with XDMFFile(mesh.mpi_comm(), filename, "w", properties=properties) as file:
+        file.write_mesh(mesh)
+
+    with XDMFFile(MPI.COMM_WORLD, filename, "r") as file:
+        mesh2 = file.read_mesh()
+    assert mesh.topology.index_map(0).size_global == mesh2.topology.index_map(0).size_global
+    assert mesh.topology.index_map(3).size_global == mesh2.topology.index_map(3).size_global
+
+
+@pytest.mark.parametrize("aggregation", [2, -1])
+def test_save_and_load_mesh_aggregated(tempdir, aggregation):
+    filename = os.path.join(tempdir, "mesh_aggregated.xdmf")
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 6, 6, 6)
+    properties = cpp.io.HDF5Properties()
+    properties.aggregation = aggregation
+    with XDMFFile(mesh.mpi_comm(), filename, "w", properties=properties) as file:
+        file.write_mesh(mesh)
+
+    with XDMFFile(MPI.COMM_WORLD, filename, "r") as file:
+        mesh2 = file.read_mesh()
+    assert mesh.topology.index_map(0).size_global == mesh2.topology.index_map(0).size_global
+    assert mesh.topology.index_map(3).size_global == mesh2.topology.index_map(3).size_global
+
+    def sum_x(mesh):
+        x = mesh.geometry.x[:mesh.geometry.index_map().size_local]
+        return mesh.mpi_comm().allreduce(x.sum(), op=MPI.SUM)
+    assert sum_x(mesh2) == pytest.approx(sum_x(mesh))
+
@@ -0,0 +1,50 @@
+# Copyright (C) 2020 Garth N. Wells
+#
+# This file is part of DOLFINX (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+"""Unit tests for ghost updates of PETSc vectors with index maps"""
+
+import numpy as np
+import pytest
+from dolfinx import FunctionSpace, UnitSquareMesh, VectorFunctionSpace, cpp
+from dolfinx.cpp.la import scatter_forward, scatter_reverse
+from mpi4py import MPI
+from petsc4py import PETSc
+
+
+@pytest.mark.parametrize("space", [("Lagrange", 1), ("Lagrange", 2)])
+@pytest.mark.parametrize("vector", [False, True])
+def test_scatter_forward(space, vector):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 7, 5)
+    V = VectorFunctionSpace(mesh, space) if vector else FunctionSpace(mesh, space)
+    index_map = V.dofmap.index_map
+
+    x0 = cpp.la.create_vector(index_map)
+    x1 = cpp.la.create_vector(index_map)
+    r0, r1 = x0.getOwnershipRange()
+    x0.array[:] = np.arange(r0, r1)
+    x1.array[:] = np.arange(r0, r1)
+
+    x0.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+    scatter_forward(index_map, x1)
+    with x0.localForm() as x0_local, x1.localForm() as x1_local:
+        assert np.array_equal(x0_local.array_r, x1_local.array_r)
+
+
+@pytest.mark.parametrize("add", [True, False])
+def test_scatter_reverse(add):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 7, 5)
+    V = VectorFunctionSpace(mesh, ("Lagrange", 1))
+    index_map = V.dofmap.index_map
+
+    x0 = cpp.la.create_vector(index_map)
+    x1 = cpp.la.create_vector(index_map)
+    for x in (x0, x1):
+        with x.localForm() as x_local:
+            x_local.set(1.0)
+
+    mode = PETSc.InsertMode.ADD if add else PETSc.InsertMode.INSERT
+    x0.ghostUpdate(addv=mode, mode=PETSc.ScatterMode.REVERSE)
+    scatter_reverse(index_map, x1, add)
+    assert np.array_equal(x0.array_r, x1.array_r)
@@ -13,7 +13,12 @@ import pytest
 import ufl
 from dolfinx import (DirichletBC, Function, FunctionSpace, UnitSquareMesh,
                      VectorFunctionSpace)
-from dolfinx.fem import (apply_lifting, assemble_matrix, assemble_vector,
+from dolfinx.cpp.la import (FieldSplitType, PreconditionerReuse,
+                            SchurFactorization, SchurPreconditioner,
+                            set_fieldsplit, set_preconditioner_reuse,
+                            set_schur_complement)
+from dolfinx.fem import (apply_lifting, assemble_matrix, assemble_matrix_block,
+                         assemble_vector, assemble_vector_block,
                          locate_dofs_topological, set_bc)
 from dolfinx.la import VectorSpaceBasis
 from dolfinx.mesh import locate_entities_boundary
@@ -52,6 +57,87 @@ def test_krylov_solver_lu():
     assert x.norm(PETSc.NormType.N2) == pytest.approx(norm, abs=1.0e-12)
 
 
+@pytest.mark.parametrize("reuse", ["none", "structure", "full"])
+def test_krylov_solver_preconditioner_reuse(reuse):
+    """Solve with operators that change between solves, reusing the
+    preconditioner"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 16, 16)
+    V = FunctionSpace(mesh, ("Lagrange", 1))
+    u, v = TrialFunction(V), TestFunction(V)
+    b = assemble_vector(inner(1.0, v) * dx)
+    b.ghostUpdate(addv=PETSc.InsertMode.ADD, mode=PETSc.ScatterMode.REVERSE)
+
+    solver = PETSc.KSP().create(mesh.mpi_comm())
+    solver.setType("cg")
+    solver.getPC().setType("gamg")
+    solver.setTolerances(rtol=1.0e-10)
+    set_preconditioner_reuse(solver, getattr(PreconditionerReuse, reuse))
+
+    A = None
+    for k in [1.0, 1.1, 1.2]:
+        a = inner(u, v) * dx + k * inner(grad(u), grad(v)) * dx
+        if A is None:
+            A = assemble_matrix(a)
+        else:
+            A.zeroEntries()
+            assemble_matrix(A, a)
+        A.assemble()
+        solver.setOperators(A)
+        x = A.createVecRight()
+        solver.solve(b, x)
+        assert solver.getConvergedReason() > 0
+
+        # Check the solution
+        r = A.createVecLeft()
+        A.mult(x, r)
+        r.axpy(-1.0, b)
+        assert r.norm() < 1.0e-8 * b.norm()
+
+
+@pytest.mark.parametrize("split", ["additive", "multiplicative", "schur"])
+def test_krylov_solver_fieldsplit(split):
+    """Solve a coupled two-field block system with a field split
+    preconditioner built from the index maps of the fields"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 12)
+    V0 = FunctionSpace(mesh, ("Lagrange", 2))
+    V1 = FunctionSpace(mesh, ("Lagrange", 1))
+    u, p = TrialFunction(V0), TrialFunction(V1)
+    v, q = TestFunction(V0), TestFunction(V1)
+    a = [[inner(u, v) * dx + inner(grad(u), grad(v)) * dx, 0.1 * inner(p, v) * dx],
+         [0.1 * inner(u, q) * dx, inner(p, q) * dx]]
+    L = [inner(1.0, v) * dx, inner(2.0, q) * dx]
+    A = assemble_matrix_block(a)
+    A.assemble()
+    b = assemble_vector_block(L, a)
+
+    solver = PETSc.KSP().create(mesh.mpi_comm())
+    solver.setOperators(A)
+    solver.setType("gmres")
+    solver.setTolerances(rtol=1.0e-10)
+    maps = [V0.dofmap.index_map, V1.dofmap.index_map]
+    for i in range(2):
+        # The index sets are kept by the second call
+        set_fieldsplit(solver, maps, getattr(FieldSplitType, split), ["u", "p"])
+        if split == "schur":
+            set_schur_complement(solver, SchurFactorization.full, SchurPreconditioner.selfp)
+        assert solver.getPC().getType() == "fieldsplit"
+        x = A.createVecRight()
+        solver.solve(b, x)
+        assert solver.getConvergedReason() > 0
+
+        # Check the solution
+        r = A.createVecLeft()
+        A.mult(x, r)
+        r.axpy(-1.0, b)
+        assert r.norm() < 1.0e-8 * b.norm()
+
+    # The splits have the owned rows of the fields
+    is_u, is_p = [solver.getPC().getFieldSplitSubIS(name) for name in ["u", "p"]]
+    assert is_u.getLocalSize() == V0.dofmap.index_map.size_local
+    assert is_p.getLocalSize() == V1.dofmap.index_map.size_local
+    assert is_u.getSize() + is_p.getSize() == A.getSize()[0]
+
+
 @pytest.mark.skip
 def test_krylov_samg_solver_elasticity():
     "Test PETScKrylovSolver with smoothed aggregation AMG"
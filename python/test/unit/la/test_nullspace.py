@@ -139,3 +139,22 @@ def test_nullspace_check(mesh, degree):
     assert not null_space.in_nullspace(A, tol=1.0e-8)
     null_space.orthonormalize()
     assert not null_space.in_nullspace(A, tol=1.0e-8)
+
+
+@pytest.mark.parametrize("reorthogonalize", [False, True])
+def test_nullspace_orthonormalize(reorthogonalize):
+    """Test orthonormalisation with and without reorthogonalisation,
+    and detection of linear dependency"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 12, 13)
+    V = VectorFunctionSpace(mesh, ('Lagrange', 2))
+    null_space = build_elastic_nullspace(V)
+    null_space.orthonormalize(reorthogonalize=reorthogonalize)
+    assert null_space.is_orthogonal()
+    assert null_space.is_orthonormal()
+
+    # A basis with two equal vectors is linearly dependent
+    x = [cpp.la.create_vector(V.dofmap.index_map) for i in range(2)]
+    for xi in x:
+        xi.set(1.0)
+    with pytest.raises(RuntimeError):
+        la.VectorSpaceBasis(x).orthonormalize(reorthogonalize=reorthogonalize)
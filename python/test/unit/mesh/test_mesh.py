@@ -10,10 +10,13 @@ import sys
 import FIAT
 import numpy as np
 import pytest
-from dolfinx import (BoxMesh, RectangleMesh, UnitCubeMesh, UnitIntervalMesh,
-                     UnitSquareMesh, cpp)
+import ufl
+from dolfinx import (BoxMesh, IntervalMesh, RectangleMesh, UnitCubeMesh,
+                     UnitIntervalMesh, UnitSquareMesh, VectorFunctionSpace,
+                     cpp, fem)
 from dolfinx.cpp.mesh import CellType, is_simplex
 from dolfinx.fem import assemble_scalar
+from dolfinx.mesh import create_mesh, rebalance
 from dolfinx_utils.test.fixtures import tempdir
 from dolfinx_utils.test.skips import skip_in_parallel
 from mpi4py import MPI
@@ -144,6 +147,31 @@ def test_UFLDomain(interval, square, rectangle, cube, box):
     _check_ufl_domain(box)
 
 
+def test_IntervalMeshLocal():
+    """Create many small interval meshes on a single process."""
+    for i in range(10):
+        mesh = IntervalMesh(MPI.COMM_SELF, 4 + i, [0.0, 2.0])
+        assert mesh.topology.index_map(0).size_local == 5 + i
+        assert mesh.topology.index_map(1).size_local == 4 + i
+        assert mesh.topology.index_map(1).num_ghosts == 0
+        assert np.isclose(mesh.mpi_comm().allreduce(assemble_scalar(1 * dx(domain=mesh)), MPI.SUM), 2.0)
+
+
+@pytest.mark.parametrize("comm", [MPI.COMM_SELF, MPI.COMM_WORLD])
+@pytest.mark.parametrize("grading", [0.5, 1.2])
+def test_IntervalMeshGraded(comm, grading):
+    """Create interval mesh with geometrically graded cell lengths."""
+    nx = 6
+    mesh = IntervalMesh(comm, nx, [1.0, 3.0], grading=grading)
+    assert mesh.topology.index_map(1).size_global == nx
+    x = np.sort(np.concatenate(comm.allgather(mesh.geometry.x[:, 0])))
+    x = np.unique(np.round(x, 12))
+    assert len(x) == nx + 1
+    assert np.isclose(x[0], 1.0) and np.isclose(x[-1], 3.0)
+    h = np.diff(x)
+    assert np.allclose(h[1:] / h[:-1], grading)
+
+
 def test_UnitSquareMeshDistributed():
     """Create mesh of unit square."""
     mesh = UnitSquareMesh(MPI.COMM_WORLD, 5, 7)
@@ -204,6 +232,39 @@ def test_hash():
     assert h1 != h2
 
 
+def test_hash_cached():
+    """Test that the cached hash is updated when the geometry changes"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    h0 = mesh.hash()
+    assert mesh.hash() == h0
+    mesh.geometry.x[:, 0] += 1.0
+    h1 = mesh.hash()
+    assert h1 != h0
+    assert mesh.hash() == h1
+    mesh.geometry.x[:, 0] -= 1.0
+    assert mesh.hash() == h0
+
+
+def test_geometry_x_view():
+    """Test that the coordinates are a writable view, and that writing
+    through a kept view is followed by a change notification"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    x = mesh.geometry.x
+    assert x.flags.writeable
+    assert np.shares_memory(x, mesh.geometry.x)
+    assert not mesh.geometry.dofmap.array.flags.writeable
+
+    h0 = mesh.hash()
+    version = mesh.geometry.x_version
+    x[:, 0] += 1.0
+    mesh.geometry.x_changed()
+    assert mesh.geometry.x_version > version
+    assert mesh.hash() != h0
+
+    with pytest.raises(RuntimeError):
+        mesh.geometry.x = x[:-1]
+
+
 @skip_in_parallel
 def test_GetCoordinates():
     """Get coordinates of vertices"""
@@ -212,7 +273,7 @@ def test_GetCoordinates():
 
 
 @skip_in_parallel
-def xtest_cell_inradius(c0, c1, c5):
+def test_cell_inradius(c0, c1, c5):
     assert cpp.mesh.inradius(c0[0], [c0[2]]) == pytest.approx((3.0 - math.sqrt(3.0)) / 6.0)
     assert cpp.mesh.inradius(c1[0], [c1[2]]) == pytest.approx(0.0)
     assert cpp.mesh.inradius(c5[0], [c5[2]]) == pytest.approx(math.sqrt(3.0) / 6.0)
@@ -355,3 +416,322 @@ def test_UnitHexMesh_assemble():
     vol = assemble_scalar(1 * dx(mesh))
     vol = mesh.mpi_comm().allreduce(vol, MPI.SUM)
     assert(vol == pytest.approx(1, rel=1e-9))
+
+
+@skip_in_parallel
+def test_create_mesh_reorder_cells():
+    n = 8
+    x = np.array([[i / n, j / n] for j in range(n + 1) for i in range(n + 1)], dtype=np.float64)
+    cells = np.array([[j * (n + 1) + i, j * (n + 1) + i + 1, (j + 1) * (n + 1) + i + 1]
+                      for j in range(n) for i in range(n)]
+                     + [[j * (n + 1) + i, (j + 1) * (n + 1) + i, (j + 1) * (n + 1) + i + 1]
+                        for j in range(n) for i in range(n)], dtype=np.int64)
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", ufl.Cell("triangle", geometric_dimension=2), 1))
+    mesh0 = create_mesh(MPI.COMM_WORLD, cells, x, domain)
+    mesh1 = create_mesh(MPI.COMM_WORLD, cells, x, domain, reorder_cells=True)
+    assert mesh1.topology.index_map(2).size_local == cells.shape[0]
+    assert assemble_scalar(1 * dx(mesh1)) == pytest.approx(assemble_scalar(1 * dx(mesh0)), rel=1e-12)
+
+    # The cells are permuted, but the set of cells is unchanged
+    def cell_midpoints(mesh):
+        dofs = mesh.geometry.dofmap
+        x = mesh.geometry.x[:, :2]
+        m = np.array([x[dofs.links(c)].mean(axis=0) for c in range(dofs.num_nodes)])
+        return m[np.lexsort(m.T)]
+    assert np.allclose(cell_midpoints(mesh0), cell_midpoints(mesh1))
+
+
+def test_create_mesh_hilbert_partitioner():
+    n = 8
+    x = np.array([[i / n, j / n] for j in range(n + 1) for i in range(n + 1)], dtype=np.float64)
+    cells = np.array([[j * (n + 1) + i, j * (n + 1) + i + 1, (j + 1) * (n + 1) + i + 1]
+                      for j in range(n) for i in range(n)]
+                     + [[j * (n + 1) + i, (j + 1) * (n + 1) + i, (j + 1) * (n + 1) + i + 1]
+                        for j in range(n) for i in range(n)], dtype=np.int64)
+    if MPI.COMM_WORLD.rank > 0:
+        x, cells = np.zeros((0, 2)), np.zeros((0, 3), dtype=np.int64)
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", ufl.Cell("triangle", geometric_dimension=2), 1))
+    mesh = create_mesh(MPI.COMM_WORLD, cells, x, domain, partitioner=cpp.mesh.CellPartitioner.hilbert)
+
+    # Each process gets (close to) the same number of cells
+    num_cells = mesh.topology.index_map(2).size_local
+    assert MPI.COMM_WORLD.allreduce(num_cells, MPI.SUM) == 2 * n * n
+    assert MPI.COMM_WORLD.allreduce(num_cells, MPI.MAX) <= 2 * n * n // MPI.COMM_WORLD.size + n
+    assert mesh.topology.index_map(0).size_global == (n + 1) * (n + 1)
+    assert MPI.COMM_WORLD.allreduce(assemble_scalar(1 * dx(mesh)), MPI.SUM) == pytest.approx(1.0, rel=1e-12)
+
+
+def test_create_mesh_hierarchical_partitioner():
+    n = 8
+    x = np.array([[i / n, j / n] for j in range(n + 1) for i in range(n + 1)], dtype=np.float64)
+    cells = np.array([[j * (n + 1) + i, j * (n + 1) + i + 1, (j + 1) * (n + 1) + i + 1]
+                      for j in range(n) for i in range(n)]
+                     + [[j * (n + 1) + i, (j + 1) * (n + 1) + i, (j + 1) * (n + 1) + i + 1]
+                        for j in range(n) for i in range(n)], dtype=np.int64)
+    if MPI.COMM_WORLD.rank > 0:
+        x, cells = np.zeros((0, 2)), np.zeros((0, 3), dtype=np.int64)
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", ufl.Cell("triangle", geometric_dimension=2), 1))
+    mesh = create_mesh(MPI.COMM_WORLD, cells, x, domain, partitioner=cpp.mesh.CellPartitioner.hierarchical)
+    assert mesh.topology.index_map(2).size_global == 2 * n * n
+    assert mesh.topology.index_map(0).size_global == (n + 1) * (n + 1)
+    assert MPI.COMM_WORLD.allreduce(assemble_scalar(1 * dx(mesh)), MPI.SUM) == pytest.approx(1.0, rel=1e-12)
+
+
+def test_create_mesh_ghost_layers():
+    n = 8
+    x = np.array([[i / n, j / n] for j in range(n + 1) for i in range(n + 1)], dtype=np.float64)
+    cells = np.array([[j * (n + 1) + i, j * (n + 1) + i + 1, (j + 1) * (n + 1) + i + 1]
+                      for j in range(n) for i in range(n)]
+                     + [[j * (n + 1) + i, (j + 1) * (n + 1) + i, (j + 1) * (n + 1) + i + 1]
+                        for j in range(n) for i in range(n)], dtype=np.int64)
+    if MPI.COMM_WORLD.rank > 0:
+        x, cells = np.zeros((0, 2)), np.zeros((0, 3), dtype=np.int64)
+    domain = ufl.Mesh(ufl.VectorElement("Lagrange", ufl.Cell("triangle", geometric_dimension=2), 1))
+    cmap = fem.create_coordinate_map(domain)
+    cells = cpp.graph.AdjacencyList_int64(cells)
+
+    def create(num_ghost_layers):
+        dest = cpp.mesh.compute_cell_destinations(MPI.COMM_WORLD, cells, cmap, x,
+                                                  num_ghost_layers=num_ghost_layers)
+        mesh = cpp.mesh.create_mesh(MPI.COMM_WORLD, cells, cmap, x, cpp.mesh.GhostMode.shared_facet, dest)
+        domain._ufl_cargo = mesh
+        mesh._ufl_domain = domain
+        return mesh
+
+    mesh1, mesh2 = create(1), create(2)
+    for mesh in (mesh1, mesh2):
+        assert mesh.topology.index_map(2).size_global == 2 * n * n
+        assert MPI.COMM_WORLD.allreduce(assemble_scalar(1 * dx(mesh)), MPI.SUM) == pytest.approx(1.0, rel=1e-12)
+
+    # A second layer adds ghost cells on a distributed mesh
+    num_ghosts1 = mesh1.topology.index_map(2).num_ghosts
+    num_ghosts2 = mesh2.topology.index_map(2).num_ghosts
+    if MPI.COMM_WORLD.size > 1:
+        assert MPI.COMM_WORLD.allreduce(num_ghosts2, MPI.SUM) > MPI.COMM_WORLD.allreduce(num_ghosts1, MPI.SUM)
+    else:
+        assert num_ghosts2 == 0
+
+    with pytest.raises(RuntimeError):
+        cpp.mesh.compute_cell_destinations(MPI.COMM_WORLD, cells, cmap, x, num_ghost_layers=0)
+
+
+@pytest.mark.parametrize("ghost_mode", [cpp.mesh.GhostMode.none, cpp.mesh.GhostMode.shared_facet])
+@pytest.mark.parametrize("cell_type", [CellType.triangle, CellType.quadrilateral,
+                                       CellType.tetrahedron, CellType.hexahedron])
+def test_structured_mesh(cell_type, ghost_mode):
+    """Test that a mesh partitioned by grid blocks is the mesh of the
+    graph partitioner"""
+    tdim = cpp.mesh.cell_dim(cell_type)
+    if tdim == 2:
+        meshes = [UnitSquareMesh(MPI.COMM_WORLD, 5, 4, cell_type, ghost_mode, structured=s) for s in (False, True)]
+    else:
+        meshes = [UnitCubeMesh(MPI.COMM_WORLD, 3, 4, 2, cell_type, ghost_mode, structured=s) for s in (False, True)]
+
+    def measures(mesh):
+        forms = [1 * dx(mesh), 1 * ufl.ds(mesh)]
+        if ghost_mode == cpp.mesh.GhostMode.shared_facet:
+            forms.append(1 * ufl.dS(mesh))
+        return [MPI.COMM_WORLD.allreduce(assemble_scalar(form), MPI.SUM) for form in forms]
+
+    mesh0, mesh1 = meshes
+    for d in (0, tdim):
+        assert mesh1.topology.index_map(d).size_global == mesh0.topology.index_map(d).size_global
+    assert measures(mesh1) == pytest.approx(measures(mesh0), rel=1e-12)
+    assert np.isclose(MPI.COMM_WORLD.allreduce(mesh1.geometry.x.min(), MPI.MIN), 0.0)
+    assert np.isclose(MPI.COMM_WORLD.allreduce(mesh1.geometry.x.max(), MPI.MAX), 1.0)
+
+
+@pytest.mark.parametrize("partitioner", [cpp.mesh.CellPartitioner.graph, cpp.mesh.CellPartitioner.hilbert,
+                                         cpp.mesh.CellPartitioner.hierarchical])
+def test_rebalance(partitioner):
+    def cell_weights(mesh):
+        # Weight 4 for cells with midpoint x < 0.25, otherwise 1
+        num_cells = mesh.topology.index_map(2).size_local
+        x_dofs = mesh.geometry.dofmap.array.reshape(-1, 3)[:num_cells]
+        midpoints = mesh.geometry.x[x_dofs].mean(axis=1)
+        return np.where(midpoints[:, 0] < 0.25, 4, 1).astype(np.int32)
+
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 16, 16)
+    weights = cell_weights(mesh)
+    mesh_new, original_cell_index = rebalance(mesh, weights, partitioner=partitioner)
+
+    # The owned cells of the new mesh are the cells of the original mesh
+    map_new = mesh_new.topology.index_map(2)
+    assert map_new.size_global == mesh.topology.index_map(2).size_global
+    assert len(original_cell_index) == map_new.size_local + map_new.num_ghosts
+    owned = MPI.COMM_WORLD.allgather(original_cell_index[:map_new.size_local])
+    assert np.array_equal(np.sort(np.concatenate(owned)), np.arange(map_new.size_global))
+    assert MPI.COMM_WORLD.allreduce(assemble_scalar(1 * dx(mesh_new)), MPI.SUM) == pytest.approx(1.0, rel=1e-12)
+
+    # The weighted number of cells is (close to) balanced
+    load = np.sum(cell_weights(mesh_new))
+    total = MPI.COMM_WORLD.allreduce(load, MPI.SUM)
+    assert total == MPI.COMM_WORLD.allreduce(np.sum(weights), MPI.SUM)
+    assert MPI.COMM_WORLD.allreduce(load, MPI.MAX) <= 1.1 * total / MPI.COMM_WORLD.size + 16
+
+
+@pytest.mark.parametrize("ghost_mode", [cpp.mesh.GhostMode.none, cpp.mesh.GhostMode.shared_facet])
+def test_partition_report(ghost_mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8, ghost_mode=ghost_mode)
+    V = VectorFunctionSpace(mesh, ("Lagrange", 1))
+    report = cpp.fem.compute_partition_report(mesh, [V._cpp_object])
+    num_cells = mesh.topology.index_map(2).size_local
+    assert report.get("cells", "owned") == num_cells
+    index_map = V.dofmap.index_map
+    assert report.get("space 0", "owned") == index_map.size_local * index_map.block_size
+
+    # The sum of the edge cut over processes is even, and zero in serial
+    total = report.reduce(MPI.COMM_WORLD, cpp.common.Table.Reduction.sum)
+    assert total.get("cells", "owned") == 128
+    assert total.get("cells", "edge cut") % 2 == 0
+    if MPI.COMM_WORLD.size == 1:
+        assert total.get("cells", "edge cut") == 0
+        assert total.get("space 0", "ghost") == 0
+
+
+def test_geometry_compact_x():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    x = mesh.geometry.compact_x()
+    assert x.shape == (mesh.geometry.x.shape[0], 2)
+    assert np.array_equal(x, mesh.geometry.x[:, :2])
+    x32 = mesh.geometry.compact_x(single_precision=True)
+    assert x32.dtype == np.float32
+    assert np.allclose(x32, x)
+
+
+def test_clear_input_global_indices():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    m0 = mesh.geometry.memory_usage()
+    num_indices = len(mesh.geometry.input_global_indices)
+    mesh.geometry.clear_input_global_indices()
+    assert mesh.geometry.memory_usage() <= m0 - 8 * num_indices
+    with pytest.raises(RuntimeError):
+        mesh.geometry.input_global_indices
+
+
+def test_memory_usage():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    topology = mesh.topology
+    tdim = topology.dim
+    m0 = topology.memory_usage()
+    assert m0 >= topology.connectivity(tdim, 0).array.nbytes
+    topology.create_connectivity(tdim - 1, tdim)
+    assert topology.memory_usage() > m0
+    assert mesh.geometry.memory_usage() >= mesh.geometry.x.nbytes
+
+    V = VectorFunctionSpace(mesh, ("Lagrange", 1))
+    dofmap = V.dofmap
+    assert dofmap.memory_usage() >= dofmap.list().array.nbytes
+    assert V.memory_usage() == dofmap.memory_usage() + dofmap.index_map.memory_usage()
+
+
+def test_release_connectivity():
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 3, 3, 3)
+    topology = mesh.topology
+    tdim = topology.dim
+    topology.create_connectivity(0, tdim)
+    c0 = topology.connectivity(0, tdim).array.copy()
+    assert topology.is_derived_connectivity(0, tdim)
+    topology.release_connectivity(0, tdim)
+    assert topology.connectivity(0, tdim) is None
+    topology.create_connectivity(0, tdim)
+    assert np.array_equal(topology.connectivity(0, tdim).array, c0)
+
+    # Connectivities that define the entities cannot be released
+    assert not topology.is_derived_connectivity(tdim, 0)
+    with pytest.raises(RuntimeError):
+        topology.release_connectivity(tdim, 0)
+    topology.release_derived_connectivity()
+    assert topology.connectivity(tdim, 0) is not None
+    assert topology.connectivity(0, tdim) is None
+
+    # With a small budget only the requested derived connectivity is kept
+    topology.set_connectivity_budget(1)
+    topology.create_connectivity(0, tdim)
+    topology.create_connectivity(tdim - 1, tdim)
+    assert topology.connectivity(tdim - 1, tdim) is not None
+    assert topology.connectivity(0, tdim) is None
+
+
+@pytest.mark.parametrize("cell_type", [CellType.tetrahedron, CellType.hexahedron])
+def test_create_connectivity_all_threads(cell_type):
+    mesh0 = UnitCubeMesh(MPI.COMM_WORLD, 3, 2, 2, cell_type)
+    mesh1 = UnitCubeMesh(MPI.COMM_WORLD, 3, 2, 2, cell_type)
+    mesh0.topology.create_connectivity_all()
+    mesh1.topology.create_connectivity_all(num_threads=4)
+    tdim = mesh0.topology.dim
+    for d0 in range(tdim + 1):
+        for d1 in range(tdim + 1):
+            c0 = mesh0.topology.connectivity(d0, d1)
+            c1 = mesh1.topology.connectivity(d0, d1)
+            assert np.array_equal(c0.array, c1.array)
+            assert np.array_equal(c0.offsets, c1.offsets)
+
+
+def test_exterior_facets():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 5, 4)
+    topology = mesh.topology
+    tdim = topology.dim
+    topology.create_connectivity(tdim - 1, tdim)
+    facets = topology.exterior_facets()
+    assert np.array_equal(facets, cpp.mesh.exterior_facet_indices(mesh))
+    marker = cpp.mesh.compute_boundary_facets(topology)
+    assert np.array_equal(facets, np.flatnonzero(marker))
+    num_facets = mesh.mpi_comm().allreduce(len(facets), MPI.SUM)
+    assert num_facets == 2 * (5 + 4)
+
+
+@pytest.mark.parametrize("num_threads", [2, 3])
+def test_create_connectivity_threads(num_threads):
+    mesh0 = UnitCubeMesh(MPI.COMM_WORLD, 3, 2, 2)
+    mesh1 = UnitCubeMesh(MPI.COMM_WORLD, 3, 2, 2)
+    tdim = mesh0.topology.dim
+    for d0, d1 in [(tdim, 1), (1, tdim), (0, tdim), (tdim - 1, tdim)]:
+        mesh0.topology.create_connectivity(d0, d1)
+        mesh1.topology.create_connectivity(d0, d1, num_threads=num_threads)
+        c0 = mesh0.topology.connectivity(d0, d1)
+        c1 = mesh1.topology.connectivity(d0, d1)
+        assert np.array_equal(c0.array, c1.array)
+        assert np.array_equal(c0.offsets, c1.offsets)
+
+
+def test_exterior_facets_from_cell_facets():
+    """Check that exterior facets are found from the cell-facet
+    connectivity when the facet-cell connectivity is missing"""
+    mesh0 = UnitSquareMesh(MPI.COMM_WORLD, 5, 4)
+    mesh1 = UnitSquareMesh(MPI.COMM_WORLD, 5, 4)
+    tdim = mesh0.topology.dim
+    mesh0.topology.create_connectivity(tdim - 1, tdim)
+    mesh1.topology.create_connectivity(tdim, tdim - 1)
+    assert mesh1.topology.connectivity(tdim - 1, tdim) is None
+    assert np.array_equal(mesh0.topology.exterior_facets(), mesh1.topology.exterior_facets())
+    assert mesh1.topology.connectivity(tdim - 1, tdim) is None
+
+
+@skip_in_parallel
+def test_cached_cell_metrics():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 2, 2)
+    assert mesh.hmax() == pytest.approx(math.sqrt(2.0) / 2.0)
+    assert mesh.rmin() == pytest.approx(1.0 / (2.0 * (2.0 + math.sqrt(2.0))))
+
+    # Modifying the coordinates invalidates the cached values
+    mesh.geometry.x[:] *= 2.0
+    assert mesh.hmax() == pytest.approx(math.sqrt(2.0))
+    assert mesh.rmin() == pytest.approx(1.0 / (2.0 + math.sqrt(2.0)))
+
+
+def test_lazy_permutations():
+    mesh0 = UnitCubeMesh(MPI.COMM_WORLD, 2, 2, 2)
+    mesh1 = UnitCubeMesh(MPI.COMM_WORLD, 2, 2, 2)
+
+    # The facet permutations need only the facets
+    mesh0.topology.create_facet_permutations()
+    assert mesh0.topology.index_map(1) is None
+    with pytest.raises(RuntimeError):
+        mesh0.topology.get_cell_permutation_info()
+
+    mesh1.topology.create_entity_permutations()
+    assert np.array_equal(mesh0.topology.get_facet_permutations(), mesh1.topology.get_facet_permutations())
+
+    mesh0.topology.create_cell_permutation_info()
+    assert np.array_equal(mesh0.topology.get_cell_permutation_info(), mesh1.topology.get_cell_permutation_info())
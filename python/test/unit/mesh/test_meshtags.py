@@ -24,3 +24,21 @@ def test_create(cell_type):
 
     mt = create_meshtags(mesh, 1, entities, values)
     assert mt.indices.shape == marked_lines.shape
+
+
+def test_find():
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 3, 3, 3)
+    num_cells = mesh.topology.index_map(3).size_local + mesh.topology.index_map(3).num_ghosts
+    indices = numpy.arange(0, num_cells, 2, dtype=numpy.int32)
+    values = (indices % 5).astype(numpy.int32)
+    mt = cpp.mesh.MeshTags_int32(mesh, 3, indices, values)
+
+    assert numpy.array_equal(mt.unique_values, numpy.unique(values))
+    for value in range(-1, 6):
+        assert numpy.array_equal(mt.find(value), indices[values == value])
+    for e in range(num_cells):
+        pos = mt.find_entity(e)
+        if e % 2 == 0:
+            assert mt.indices[pos] == e
+        else:
+            assert pos == -1
@@ -4,10 +4,16 @@
 #
 # SPDX-License-Identifier:    LGPL-3.0-or-later
 
-from dolfinx import FunctionSpace, UnitCubeMesh, UnitSquareMesh
-from dolfinx.cpp.mesh import GhostMode
-from dolfinx.mesh import refine
+import numpy as np
+import pytest
+from dolfinx import (Function, FunctionSpace, UnitCubeMesh, UnitSquareMesh,
+                     VectorFunctionSpace)
+from dolfinx.cpp.mesh import CellType, GhostMode
+from dolfinx.mesh import (MeshHierarchy, MeshTags, coarsen, coarsen_function,
+                          coarsen_meshtags, locate_entities, mark_dorfler,
+                          mark_maximum, refine, refine_with_parents)
 from mpi4py import MPI
+from petsc4py import PETSc
 
 
 def test_RefineUnitSquareMesh():
@@ -19,6 +25,66 @@ def test_RefineUnitSquareMesh():
     assert mesh.topology.index_map(2).size_global == 280
 
 
+@pytest.mark.parametrize("uniform", [True, False])
+def test_refine_threaded(uniform):
+    """Refinement on several threads gives the same mesh as on one thread"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 5, 4, 3, ghost_mode=GhostMode.none)
+    mesh.topology.create_entities(1)
+    if uniform:
+        markers = None
+    else:
+        cells = locate_entities(mesh, 3, lambda x: x[0] < 0.4)
+        markers = MeshTags(mesh, 3, cells, np.ones(len(cells), dtype=np.int8))
+    mesh0 = refine(mesh, markers, redistribute=False)
+    mesh1 = refine(mesh, markers, redistribute=False, num_threads=4)
+    assert np.allclose(mesh1.geometry.x, mesh0.geometry.x)
+    assert np.all(mesh1.geometry.dofmap.array == mesh0.geometry.dofmap.array)
+    assert np.all(mesh1.topology.connectivity(3, 0).array == mesh0.topology.connectivity(3, 0).array)
+
+
+@pytest.mark.parametrize("tdim", [2, 3])
+def test_refine_uniform_conforming(tdim):
+    """Uniform refinement subdivides every cell and gives a conforming
+    mesh, i.e. the Euler characteristic of the (refined) unit square or
+    cube is one"""
+    if tdim == 2:
+        mesh = UnitSquareMesh(MPI.COMM_WORLD, 5, 7, ghost_mode=GhostMode.none)
+    else:
+        mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 5, 3, ghost_mode=GhostMode.none)
+    num_cells = mesh.topology.index_map(tdim).size_global
+    mesh = refine(mesh, redistribute=False)
+    assert mesh.topology.index_map(tdim).size_global == 2**tdim * num_cells
+
+    euler = 0
+    for d in range(tdim + 1):
+        mesh.topology.create_entities(d)
+        euler += (-1)**d * mesh.topology.index_map(d).size_global
+    assert euler == 1
+
+
+@pytest.mark.parametrize("cell_type", [CellType.quadrilateral, CellType.hexahedron])
+def test_refine_tensor_product(cell_type):
+    """Uniform refinement of quadrilaterals and hexahedra is the
+    refinement of the structured mesh"""
+    if cell_type == CellType.quadrilateral:
+        n = [5, 7]
+        mesh = UnitSquareMesh(MPI.COMM_WORLD, *n, cell_type, ghost_mode=GhostMode.none)
+    else:
+        n = [3, 4, 2]
+        mesh = UnitCubeMesh(MPI.COMM_WORLD, *n, cell_type, ghost_mode=GhostMode.none)
+    tdim = mesh.topology.dim
+    mesh0 = refine(mesh, redistribute=False)
+    mesh1 = refine(mesh, redistribute=False, num_threads=3)
+    for m in (mesh0, mesh1):
+        assert m.topology.index_map(tdim).size_global == np.prod([2 * k for k in n])
+        assert m.topology.index_map(0).size_global == np.prod([2 * k + 1 for k in n])
+        euler = 0
+        for d in range(tdim + 1):
+            m.topology.create_entities(d)
+            euler += (-1)**d * m.topology.index_map(d).size_global
+        assert euler == 1
+
+
 def test_RefineUnitCubeMesh_repartition():
     """Refine mesh of unit cube."""
     mesh = UnitCubeMesh(MPI.COMM_WORLD, 5, 7, 9, ghost_mode=GhostMode.none)
@@ -48,8 +114,284 @@ def test_RefineUnitCubeMesh_keep_partition():
     assert(Q)
 
 
+def test_refine_keep_partition_ghosts():
+    """Without redistribution, the refined cells stay on the process of
+    their parent cell, and the ghost vertices have the coordinates of
+    their owners"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 3, 5, ghost_mode=GhostMode.none)
+    mesh.topology.create_entities(1)
+    cells = locate_entities(mesh, 3, lambda x: x[0] < 0.3)
+    markers = MeshTags(mesh, 3, cells, np.ones(len(cells), dtype=np.int8))
+    mesh_refined, parent_cell, _, _ = refine_with_parents(mesh, markers)
+    assert len(parent_cell) == mesh_refined.topology.index_map(3).size_local
+    assert mesh_refined.topology.index_map(0).size_global == refine(mesh, markers).topology.index_map(0).size_global
+
+    V = FunctionSpace(mesh_refined, ("Lagrange", 1))
+    u = Function(V)
+    u.interpolate(lambda x: x[0] + 2 * x[1] + 3 * x[2])
+    u.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+    x = V.tabulate_dof_coordinates()
+    with u.vector.localForm() as loc:
+        assert np.allclose(loc.array, x[:, 0] + 2 * x[:, 1] + 3 * x[:, 2])
+
+
+def test_refine_max_imbalance():
+    """Local refinement without redistribution is repartitioned if the
+    imbalance exceeds the threshold"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8, ghost_mode=GhostMode.none)
+    mesh.topology.create_entities(1)
+    cells = locate_entities(mesh, 2, lambda x: x[0] < 0.25)
+    markers = MeshTags(mesh, 2, cells, np.ones(len(cells), dtype=np.int8))
+    mesh0 = refine(mesh, markers, redistribute=False)
+    mesh1 = refine(mesh, markers, redistribute=False, max_imbalance=1.2)
+    assert mesh1.topology.index_map(2).size_global == mesh0.topology.index_map(2).size_global
+    assert mesh1.topology.index_map(0).size_global == mesh0.topology.index_map(0).size_global
+    num_cells = mesh.mpi_comm().allgather(mesh1.topology.index_map(2).size_local)
+    assert max(num_cells) <= max(mesh.mpi_comm().allgather(mesh0.topology.index_map(2).size_local))
+
+
+@pytest.mark.parametrize("theta", [0.0, 0.3, 0.7, 1.0])
+def test_mark_dorfler(theta):
+    """Dörfler marking marks the smallest set of cells with the largest
+    indicators, as from a global sort"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    mesh.topology.create_entities(1)
+    num_cells = mesh.topology.index_map(2).size_local
+    midpoints = mesh.geometry.x[mesh.geometry.dofmap.array].reshape(-1, 3, 3).mean(axis=1)[:num_cells]
+    eta = np.exp(-10 * ((midpoints[:, 0] - 0.3)**2 + midpoints[:, 1]**2))
+
+    markers = mark_dorfler(mesh, eta, theta)
+    assert np.all(markers.values == 1)
+    num_marked = mesh.mpi_comm().allreduce(len(markers.indices), op=MPI.SUM)
+
+    eta_all = np.sort(np.concatenate(mesh.mpi_comm().allgather(eta)))[::-1]
+    sums = np.cumsum(eta_all**2)
+    expected = np.searchsorted(sums, theta * sums[-1]) + 1 if theta > 0 else 0
+    assert num_marked == expected
+
+    # The marked cells have the largest indicators
+    threshold = mesh.mpi_comm().allreduce(eta[markers.indices].min() if len(markers.indices) > 0 else np.inf,
+                                          op=MPI.MIN)
+    assert np.all(np.delete(eta, markers.indices) < threshold)
+
+    mesh_refined = refine(mesh, markers)
+    assert mesh_refined.topology.index_map(2).size_global > mesh.topology.index_map(2).size_global or theta == 0
+
+
+def test_mark_maximum():
+    """Maximum marking from a DG0 indicator function"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8)
+    V = FunctionSpace(mesh, ("DG", 0))
+    eta = Function(V)
+    eta.interpolate(lambda x: x[0] + x[1])
+    markers = mark_maximum(mesh, eta, 0.75)
+    assert np.all(markers.values == 1)
+
+    num_cells = mesh.topology.index_map(2).size_local
+    midpoints = mesh.geometry.x[mesh.geometry.dofmap.array].reshape(-1, 3, 3).mean(axis=1)[:num_cells]
+    eta_cells = midpoints[:, 0] + midpoints[:, 1]
+    eta_max = mesh.mpi_comm().allreduce(eta_cells.max(), op=MPI.MAX)
+    assert np.all(eta_cells[markers.indices] >= 0.75 * eta_max - 1.0e-12)
+    assert np.all(np.delete(eta_cells, markers.indices) < 0.75 * eta_max + 1.0e-12)
+
+
 def xtest_refinement_gdim():
     """Test that 2D refinement is still 2D"""
     mesh = UnitSquareMesh(MPI.COMM_WORLD, 3, 4, ghost_mode=GhostMode.none)
     mesh2 = refine(mesh, redistribute=True)
     assert mesh.geometry.dim == mesh2.geometry.dim
+
+
+@pytest.mark.parametrize("uniform", [True, False])
+def test_refine_with_parents(uniform):
+    """Check the parent cells, parent facets and edge vertices of a
+    refined mesh"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 3, ghost_mode=GhostMode.none)
+    mesh.topology.create_entities(1)
+    tdim = mesh.topology.dim
+    if uniform:
+        mesh1, parent_cell, parent_facet, edge_vertex = refine_with_parents(mesh)
+    else:
+        cells = locate_entities(mesh, tdim, lambda x: x[0] < 0.5)
+        markers = MeshTags(mesh, tdim, cells, np.ones(len(cells), dtype=np.int8))
+        mesh1, parent_cell, parent_facet, edge_vertex = refine_with_parents(mesh, markers)
+
+    num_cells = mesh1.topology.index_map(tdim).size_local
+    assert parent_cell.shape == (num_cells, )
+    assert parent_facet.shape == (num_cells, tdim + 1)
+    if uniform:
+        assert np.all(np.bincount(parent_cell) == 4)
+
+    # Each child cell lies in its parent cell
+    x0 = mesh.geometry.x
+    x1 = mesh1.geometry.x
+    dofs0 = mesh.geometry.dofmap
+    dofs1 = mesh1.geometry.dofmap
+    for c in range(num_cells):
+        p = x0[dofs0.links(parent_cell[c])]
+        midpoint = x1[dofs1.links(c)].mean(axis=0)
+        area = abs(np.cross(p[1] - p[0], p[2] - p[0])[2])
+        sub_areas = sum(abs(np.cross(p[(i + 1) % 3] - midpoint, p[(i + 2) % 3] - midpoint)[2]) for i in range(3))
+        assert sub_areas == pytest.approx(area)
+
+        # A facet of the child on a parent facet has the vertices on the
+        # parent facet
+        v = x1[dofs1.links(c)]
+        for i in range(tdim + 1):
+            k = parent_facet[c, i]
+            if k >= 0:
+                e = p[[j for j in range(3) if j != k]]
+                for j in range(tdim + 1):
+                    if j != i:
+                        assert abs(np.cross(e[1] - e[0], v[j] - e[0])[2]) < 1.0e-12
+
+    # The new vertex of an edge is at the midpoint of the edge
+    c_to_v = mesh1.topology.connectivity(tdim, 0)
+    x_vertex = {}
+    for c in range(num_cells):
+        for v, d in zip(c_to_v.links(c), dofs1.links(c)):
+            x_vertex[v] = x1[d]
+    e_to_v = mesh.topology.connectivity(1, 0)
+    v_to_x = {}
+    for c in range(mesh.topology.index_map(tdim).size_local):
+        for v, d in zip(mesh.topology.connectivity(tdim, 0).links(c), dofs0.links(c)):
+            v_to_x[v] = x0[d]
+    for e, v in enumerate(edge_vertex):
+        if v >= 0:
+            midpoint = 0.5 * (v_to_x[e_to_v.links(e)[0]] + v_to_x[e_to_v.links(e)[1]])
+            assert np.allclose(x_vertex[v], midpoint)
+    if uniform:
+        assert np.all(edge_vertex >= 0)
+
+
+@pytest.mark.parametrize("cell_type", [CellType.triangle, CellType.quadrilateral])
+@pytest.mark.parametrize("degree", [1, 2])
+def test_mesh_hierarchy_prolongation(degree, cell_type):
+    """Prolongation is exact for functions in the coarse space"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 3, 4, cell_type, ghost_mode=GhostMode.none)
+    hierarchy = MeshHierarchy(mesh, 2)
+    assert hierarchy.num_levels == 3
+
+    def f(x):
+        return 1.0 + x[0] ** degree + 2.0 * x[0] * x[1] ** (degree - 1)
+
+    def g(x):
+        return np.stack((f(x), 2.0 * f(x)))
+
+    for create_space, expr in ((FunctionSpace, f), (VectorFunctionSpace, g)):
+        spaces = [create_space(hierarchy.mesh(level), ("Lagrange", degree)) for level in range(3)]
+        prolongations = hierarchy.prolongations(spaces)
+        assert len(prolongations) == 2
+        for level, P in enumerate(prolongations):
+            u0, u1 = Function(spaces[level]), Function(spaces[level + 1])
+            u0.interpolate(expr)
+            u1.interpolate(expr)
+            Pu0 = u1.vector.duplicate()
+            P.mult(u0.vector, Pu0)
+            assert np.allclose(Pu0.array, u1.vector.array)
+
+
+def test_coarsen():
+    """Coarsening merges the marked children and transfers data"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4, ghost_mode=GhostMode.none)
+    mesh.topology.create_entities(1)
+    mesh1, parent_cell, parent_facet, edge_vertex = refine_with_parents(mesh)
+    parents = (parent_cell, parent_facet, edge_vertex)
+    tdim = mesh.topology.dim
+
+    # Coarsening all cells restores the parent mesh
+    num_cells1 = mesh1.topology.index_map(tdim).size_local
+    all_cells = np.arange(num_cells1, dtype=np.int32)
+    markers = MeshTags(mesh1, tdim, all_cells, np.ones(num_cells1, dtype=np.int8))
+    mesh0, maps = coarsen(mesh, mesh1, parents, markers)
+    assert mesh0.topology.index_map(tdim).size_global == mesh.topology.index_map(tdim).size_global
+    assert np.all(maps.fine_cell == -1)
+
+    # Coarsen the cells in the left half. The parents next to the
+    # refined cells are kept, so that the mesh is conforming.
+    cells = locate_entities(mesh1, tdim, lambda x: x[0] < 0.5)
+    markers = MeshTags(mesh1, tdim, cells, np.ones(len(cells), dtype=np.int8))
+    mesh0, maps = coarsen(mesh, mesh1, parents, markers)
+    num_parents = np.count_nonzero(maps.parent_cell >= 0)
+    num_coarse_cells = mesh0.topology.index_map(tdim).size_local
+    assert num_coarse_cells == num_parents + np.count_nonzero(maps.fine_cell >= 0)
+    assert 0 < mesh0.mpi_comm().allreduce(num_parents, op=MPI.SUM) < mesh.topology.index_map(tdim).size_global
+    assert mesh0.mpi_comm().allreduce(num_coarse_cells, op=MPI.SUM) < mesh1.topology.index_map(tdim).size_global
+
+    # Restored cells are parents of the refined cells in the left half
+    for c in np.flatnonzero(maps.parent_cell >= 0):
+        assert np.all(np.isin(np.flatnonzero(parent_cell == maps.parent_cell[c]), cells))
+
+    # Quadratic functions are transferred exactly by P2 interpolation
+    def f(x):
+        return 1.0 + x[0] * x[0] + 2.0 * x[0] * x[1]
+
+    u1 = Function(FunctionSpace(mesh1, ("Lagrange", 2)))
+    u1.interpolate(f)
+    u0 = Function(FunctionSpace(mesh0, ("Lagrange", 2)))
+    coarsen_function(u1, u0, parents, maps)
+    u_exact = Function(u0.function_space)
+    u_exact.interpolate(f)
+    assert np.allclose(u0.vector.array, u_exact.vector.array)
+
+    # Boundary facets on the left and cells in the bottom half
+    mesh1.topology.create_entities(tdim - 1)
+    facets = locate_entities(mesh1, tdim - 1, lambda x: np.isclose(x[0], 0.0))
+    facet_tags = MeshTags(mesh1, tdim - 1, facets, np.full(len(facets), 3, dtype=np.int32))
+    facet_tags0 = coarsen_meshtags(facet_tags, mesh0, parents, maps)
+    assert np.all(facet_tags0.values == 3)
+    assert np.all(facet_tags0.indices == locate_entities(mesh0, tdim - 1, lambda x: np.isclose(x[0], 0.0)))
+
+    def bottom(mesh):
+        x = mesh.geometry.x
+        return x[mesh.geometry.dofmap.array.reshape(-1, tdim + 1), 1].mean(axis=1) < 0.5
+
+    cell_tags = MeshTags(mesh1, tdim, all_cells, np.where(bottom(mesh1), 1, 2).astype(np.int32))
+    cell_tags0 = coarsen_meshtags(cell_tags, mesh0, parents, maps)
+    assert len(cell_tags0.indices) == num_coarse_cells
+    assert np.all(bottom(mesh0) == (cell_tags0.values == 1))
+
+
+@pytest.mark.parametrize("dim", [0, 1, 2, 3])
+def test_refine_meshtags(dim):
+    """MeshTags of all dimensions are transferred to the refined mesh"""
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 4, 3, 2, ghost_mode=GhostMode.none)
+    mesh.topology.create_entities(1)
+    mesh.topology.create_entities(dim)
+    if dim == 3:
+        def marker(x):
+            return x[0] < 0.5 + 1.0e-10
+    else:
+        def marker(x):
+            return np.isclose(x[0], 0.0)
+    entities = locate_entities(mesh, dim, marker)
+    tags = MeshTags(mesh, dim, entities, np.full(len(entities), 7, dtype=np.int32))
+    mesh1, (tags1, ) = refine(mesh, meshtags=[tags])
+    assert np.all(tags1.values == 7)
+
+    def num_owned(m, indices):
+        n = np.count_nonzero(indices < m.topology.index_map(dim).size_local)
+        return m.mpi_comm().allreduce(n, op=MPI.SUM)
+
+    if dim >= 2:
+        # Entities on the boundary (facets) or in the subdomain (cells)
+        assert np.all(tags1.indices == locate_entities(mesh1, dim, marker))
+    elif dim == 1:
+        # Tagged edges are bisected
+        assert num_owned(mesh1, tags1.indices) == 2 * num_owned(mesh, tags.indices)
+    else:
+        # The new vertices are not in a vertex of the parent mesh
+        assert num_owned(mesh1, tags1.indices) == num_owned(mesh, tags.indices)
+
+
+def test_mesh_hierarchy_meshtags():
+    """Facet tags are transferred to all levels of a hierarchy"""
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 3, 3, ghost_mode=GhostMode.none)
+    hierarchy = MeshHierarchy(mesh, 2)
+    facets = locate_entities(mesh, 1, lambda x: np.isclose(x[1], 1.0))
+    tags = MeshTags(mesh, 1, facets, np.full(len(facets), 2, dtype=np.int32))
+    all_tags = hierarchy.transfer_meshtags(tags)
+    assert len(all_tags) == 3
+    for level, level_tags in enumerate(all_tags):
+        level_mesh = hierarchy.mesh(level)
+        assert np.all(level_tags.indices == locate_entities(level_mesh, 1, lambda x: np.isclose(x[1], 1.0)))
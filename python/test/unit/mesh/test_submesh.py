@@ -0,0 +1,69 @@
+# Copyright (C) 2020 Garth N. Wells
+#
+# This file is part of DOLFINX (https://www.fenicsproject.org)
+#
+# SPDX-License-Identifier:    LGPL-3.0-or-later
+
+import numpy as np
+import pytest
+import ufl
+from dolfinx import UnitCubeMesh, UnitSquareMesh, cpp
+from dolfinx.fem import assemble_scalar
+from dolfinx.mesh import create_submesh, locate_entities, locate_entities_boundary
+from mpi4py import MPI
+
+
+def num_owned(mesh, dim, entities):
+    return MPI.COMM_WORLD.allreduce(np.count_nonzero(entities < mesh.topology.index_map(dim).size_local), MPI.SUM)
+
+
+@pytest.mark.parametrize("ghost_mode", [cpp.mesh.GhostMode.none, cpp.mesh.GhostMode.shared_facet])
+@pytest.mark.parametrize("cell_type", [cpp.mesh.CellType.triangle, cpp.mesh.CellType.quadrilateral])
+def test_submesh_cells(cell_type, ghost_mode):
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 8, 8, cell_type, ghost_mode)
+    tdim = mesh.topology.dim
+    cells = locate_entities(mesh, tdim, lambda x: x[0] <= 0.5)
+    submesh, entity_map, vertex_map, node_map = create_submesh(mesh, tdim, cells)
+
+    assert submesh.topology.index_map(tdim).size_global == num_owned(mesh, tdim, cells)
+    assert np.array_equal(np.sort(entity_map), np.sort(cells))
+    assert np.allclose(submesh.geometry.x, mesh.geometry.x[node_map])
+    assert MPI.COMM_WORLD.allreduce(assemble_scalar(1 * ufl.dx(submesh)), MPI.SUM) == pytest.approx(0.5, rel=1e-12)
+
+    # The cells of the submesh are the cells of the mesh
+    for c, e in enumerate(entity_map):
+        assert np.array_equal(node_map[submesh.geometry.dofmap.links(c)], mesh.geometry.dofmap.links(e))
+
+    # Each vertex has a single owner
+    assert submesh.topology.index_map(0).size_global == 5 * 9
+
+
+def test_submesh_boundary():
+    mesh = UnitCubeMesh(MPI.COMM_WORLD, 3, 4, 2)
+    tdim = mesh.topology.dim
+    facets = locate_entities_boundary(mesh, tdim - 1, lambda x: np.isclose(x[2], 1.0))
+    submesh, entity_map, vertex_map, node_map = create_submesh(mesh, tdim - 1, facets)
+
+    assert submesh.topology.dim == tdim - 1
+    assert submesh.geometry.dim == 3
+    assert submesh.topology.index_map(tdim - 1).size_global == 2 * 3 * 4
+    assert submesh.topology.index_map(0).size_global == 4 * 5
+    assert np.allclose(submesh.geometry.x[:, 2], 1.0)
+    assert np.allclose(submesh.geometry.x, mesh.geometry.x[node_map])
+    assert MPI.COMM_WORLD.allreduce(assemble_scalar(1 * ufl.dx(submesh)), MPI.SUM) == pytest.approx(1.0, rel=1e-12)
+
+    # The vertices of the submesh cells are the vertices of the facets
+    submesh.topology.create_connectivity(tdim - 1, 0)
+    mesh.topology.create_connectivity(tdim - 1, 0)
+    c_to_v = submesh.topology.connectivity(tdim - 1, 0)
+    f_to_v = mesh.topology.connectivity(tdim - 1, 0)
+    for c, f in enumerate(entity_map):
+        assert np.array_equal(vertex_map[c_to_v.links(c)], f_to_v.links(f))
+
+
+def test_submesh_empty_process():
+    mesh = UnitSquareMesh(MPI.COMM_WORLD, 4, 4)
+    tdim = mesh.topology.dim
+    cells = locate_entities(mesh, tdim, lambda x: x[0] <= 0.25) if MPI.COMM_WORLD.rank == 0 else []
+    submesh, entity_map, _, _ = create_submesh(mesh, tdim, cells)
+    assert len(entity_map) == len(cells)
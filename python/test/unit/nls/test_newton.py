@@ -8,6 +8,7 @@
 import dolfinx
 import dolfinx.fem as fem
 import numpy as np
+import pytest
 import ufl
 from dolfinx import function
 from mpi4py import MPI
@@ -152,6 +153,16 @@ def test_nonlinear_pde():
     assert converged
     assert n < 6
 
+    # Statistics of the initial residual and each iteration
+    statistics = solver.statistics
+    assert len(statistics) == n + 1
+    assert sum(s.krylov_iterations for s in statistics) == solver.krylov_iterations
+    assert all(s.residual >= 0.0 and s.linear_solve >= 0.0 for s in statistics)
+    assert statistics[0].jacobian == 0.0
+    table = solver.statistics_table().reduce(MPI.COMM_WORLD, dolfinx.cpp.common.Table.Reduction.max)
+    if MPI.COMM_WORLD.rank == 0:
+        assert table.get("Iteration 1", "linear solve") >= statistics[1].linear_solve
+
     # Modify boundary condition and solve again
     u_bc.vector.set(0.5)
     u_bc.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
@@ -160,6 +171,170 @@ def test_nonlinear_pde():
     assert n < 6
 
 
+def test_nonlinear_pde_reuse():
+    """Test modified Newton (reused Jacobian) and a lagged
+    preconditioner for a simple nonlinear PDE"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 12, 5)
+    V = function.FunctionSpace(mesh, ("Lagrange", 1))
+    u = dolfinx.function.Function(V)
+    v = TestFunction(V)
+    F = inner(5.0, v) * dx - ufl.sqrt(u * u) * inner(grad(u), grad(v)) * dx - inner(u, v) * dx
+
+    def boundary(x):
+        """Define Dirichlet boundary (x = 0 or x = 1)."""
+        return np.logical_or(x[0] < 1.0e-8, x[0] > 1.0 - 1.0e-8)
+
+    u_bc = function.Function(V)
+    u_bc.vector.set(1.0)
+    u_bc.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+    bc = fem.DirichletBC(u_bc, fem.locate_dofs_geometrical(V, boundary))
+
+    class CountingProblem(NonlinearPDEProblem):
+        num_J = 0
+
+        def J(self, x):
+            self.num_J += 1
+            return super().J(x)
+
+    for max_jacobian_age, max_preconditioner_age in [(1, 1), (4, 1), (1, 4)]:
+        problem = CountingProblem(F, u, bc)
+        u.vector.set(0.9)
+        u.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+        solver = dolfinx.cpp.nls.NewtonSolver(MPI.COMM_WORLD)
+        solver.max_jacobian_age = max_jacobian_age
+        solver.max_preconditioner_age = max_preconditioner_age
+        solver.max_reuse_rate = 0.9
+        n, converged = solver.solve(problem, u.vector)
+        assert converged
+        if max_jacobian_age == 1:
+            assert problem.num_J == n
+        else:
+            assert problem.num_J < n
+
+
+def test_nonlinear_pde_eisenstat_walker():
+    """Test inexact Newton with Eisenstat-Walker forcing terms and an
+    iterative linear solver"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 24, 24)
+    V = function.FunctionSpace(mesh, ("Lagrange", 1))
+    u = dolfinx.function.Function(V)
+    v = TestFunction(V)
+    F = inner(5.0, v) * dx - ufl.sqrt(u * u) * inner(grad(u), grad(v)) * dx - inner(u, v) * dx
+
+    def boundary(x):
+        """Define Dirichlet boundary (x = 0 or x = 1)."""
+        return np.logical_or(x[0] < 1.0e-8, x[0] > 1.0 - 1.0e-8)
+
+    u_bc = function.Function(V)
+    u_bc.vector.set(1.0)
+    u_bc.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+    bc = fem.DirichletBC(u_bc, fem.locate_dofs_geometrical(V, boundary))
+    problem = NonlinearPDEProblem(F, u, bc)
+
+    ForcingTerm = dolfinx.cpp.nls.NewtonSolver.ForcingTerm
+    krylov_iterations = {}
+    for forcing_term in [ForcingTerm.constant, ForcingTerm.eisenstat_walker_1, ForcingTerm.eisenstat_walker_2]:
+        u.vector.set(0.9)
+        u.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+        solver = dolfinx.cpp.nls.NewtonSolver(MPI.COMM_WORLD)
+        ksp = solver.get_krylov_solver()
+        ksp.setType("cg")
+        ksp.getPC().setType("jacobi")
+        ksp.setTolerances(rtol=1.0e-10)
+        solver.forcing_term = forcing_term
+        solver.max_it = 20
+        n, converged = solver.solve(problem, u.vector)
+        assert converged
+        krylov_iterations[forcing_term] = solver.krylov_iterations
+
+        # The tolerance of the linear solver is restored
+        assert np.isclose(ksp.getTolerances()[0], 1.0e-10)
+
+    assert krylov_iterations[ForcingTerm.eisenstat_walker_1] < krylov_iterations[ForcingTerm.constant]
+    assert krylov_iterations[ForcingTerm.eisenstat_walker_2] < krylov_iterations[ForcingTerm.constant]
+
+
+@pytest.mark.parametrize("line_search", ["backtracking", "critical_point"])
+def test_nonlinear_pde_line_search(line_search):
+    """Test Newton solver with a line search for a simple nonlinear PDE,
+    from a poor initial guess"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 12, 5)
+    V = function.FunctionSpace(mesh, ("Lagrange", 1))
+    u = dolfinx.function.Function(V)
+    v = TestFunction(V)
+    F = inner(5.0, v) * dx - (1 + u**2) * inner(grad(u), grad(v)) * dx - inner(u, v) * dx
+
+    def boundary(x):
+        """Define Dirichlet boundary (x = 0 or x = 1)."""
+        return np.logical_or(x[0] < 1.0e-8, x[0] > 1.0 - 1.0e-8)
+
+    u_bc = function.Function(V)
+    u_bc.vector.set(1.0)
+    u_bc.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+    bc = fem.DirichletBC(u_bc, fem.locate_dofs_geometrical(V, boundary))
+    problem = NonlinearPDEProblem(F, u, bc)
+
+    u.vector.set(10.0)
+    u.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+    solver = dolfinx.cpp.nls.NewtonSolver(MPI.COMM_WORLD)
+    solver.line_search = getattr(dolfinx.cpp.nls.NewtonSolver.LineSearch, line_search)
+    n, converged = solver.solve(problem, u.vector)
+    assert converged
+    assert n < 20
+
+
+def test_nonlinear_pde_fused():
+    """Test Newton solver with fused residual and Jacobian assembly"""
+    mesh = dolfinx.generation.UnitSquareMesh(MPI.COMM_WORLD, 12, 5)
+    V = function.FunctionSpace(mesh, ("Lagrange", 1))
+    u = dolfinx.function.Function(V)
+    v = TestFunction(V)
+    F = inner(5.0, v) * dx - ufl.sqrt(u * u) * inner(grad(u), grad(v)) * dx - inner(u, v) * dx
+
+    def boundary(x):
+        """Define Dirichlet boundary (x = 0 or x = 1)."""
+        return np.logical_or(x[0] < 1.0e-8, x[0] > 1.0 - 1.0e-8)
+
+    u_bc = function.Function(V)
+    u_bc.vector.set(1.0)
+    u_bc.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+    bc = fem.DirichletBC(u_bc, fem.locate_dofs_geometrical(V, boundary))
+
+    class FusedProblem(NonlinearPDEProblem):
+        num_FJ, num_J = 0, 0
+
+        def J(self, x):
+            self.num_J += 1
+            return super().J(x)
+
+        def FJ(self, x):
+            self.num_FJ += 1
+            A, b = fem.assemble_system(self.a, self.L, [self.bc], x, -1.0)
+            A.assemble()
+            self._F, self._J = b, A
+            return b, A
+
+    u.vector.set(0.9)
+    u.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+    problem = NonlinearPDEProblem(F, u, bc)
+    solver = dolfinx.cpp.nls.NewtonSolver(MPI.COMM_WORLD)
+    n0, converged = solver.solve(problem, u.vector)
+    assert converged
+    u0 = u.vector.copy()
+
+    u.vector.set(0.9)
+    u.vector.ghostUpdate(addv=PETSc.InsertMode.INSERT, mode=PETSc.ScatterMode.FORWARD)
+    problem = FusedProblem(F, u, bc)
+    solver = dolfinx.cpp.nls.NewtonSolver(MPI.COMM_WORLD)
+    solver.fused_assembly = True
+    n, converged = solver.solve(problem, u.vector)
+    assert converged
+    assert n == n0
+    assert problem.num_J == 0
+    assert problem.num_FJ == n + 1
+    assert np.isclose((u.vector - u0).norm(), 0.0)
+
+
 def test_nonlinear_pde_snes():
     """Test Newton solver for a simple nonlinear PDE"""
     # Create mesh and function space